@@ -0,0 +1,101 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// buffer_pool_benchmark.cpp
+//
+// Identification: benchmark/buffer_pool_benchmark.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "buffer/buffer_pool_manager_instance.h"
+#include "buffer/parallel_buffer_pool_manager.h"
+#include "storage/disk/disk_manager.h"
+
+namespace bustub {
+
+namespace {
+
+/** The frames of the pool, whichever number of instances they are split between */
+constexpr size_t POOL_FRAMES = 1024;
+/** The number of random page picks each thread walks through, from an offset of its own */
+constexpr size_t NUM_PICKS = 1 << 16;
+
+DiskManager *disk_manager = nullptr;
+BufferPoolManager *bpm = nullptr;
+std::vector<page_id_t> page_ids;
+std::vector<size_t> picks;
+
+/**
+ * Creates a pool of state.range(0) instances, and state.range(1) pages on disk: fewer than the frames for the hit
+ * path, where every fetch finds its page cached, and more for the miss path, where most fetches read one.
+ */
+void SetUpPool(const benchmark::State &state) {
+  auto num_instances = static_cast<size_t>(state.range(0));
+  auto num_pages = static_cast<size_t>(state.range(1));
+  disk_manager = new DiskManager("bench.db");
+  if (num_instances == 1) {
+    bpm = new BufferPoolManagerInstance(POOL_FRAMES, disk_manager);
+  } else {
+    bpm = new ParallelBufferPoolManager(num_instances, POOL_FRAMES / num_instances, disk_manager);
+  }
+  page_ids.clear();
+  for (size_t i = 0; i < num_pages; i++) {
+    page_id_t page_id;
+    Page *page = bpm->NewPage(&page_id);
+    page->GetData()[0] = static_cast<char>(i);
+    bpm->UnpinPage(page_id, true);
+    page_ids.push_back(page_id);
+  }
+  // the pages are clean from here on, so that an eviction does not write one back
+  bpm->FlushAllPages();
+  std::mt19937 generator(42);
+  std::uniform_int_distribution<size_t> distribution(0, num_pages - 1);
+  picks.clear();
+  for (size_t i = 0; i < NUM_PICKS; i++) {
+    picks.push_back(distribution(generator));
+  }
+}
+
+void TearDownPool(const benchmark::State &state) {
+  delete bpm;
+  delete disk_manager;
+  bpm = nullptr;
+  disk_manager = nullptr;
+  remove("bench.db");
+  remove("bench.log");
+}
+
+}  // namespace
+
+/** Fetches and unpins pages at random, from several threads at once. */
+void BM_BufferPoolFetchUnpin(benchmark::State &state) {  // NOLINT
+  size_t next = static_cast<size_t>(state.thread_index()) * NUM_PICKS / static_cast<size_t>(state.threads());
+  for (auto _ : state) {
+    page_id_t page_id = page_ids[picks[next]];
+    next = (next + 1) % NUM_PICKS;
+    Page *page = bpm->FetchPage(page_id);
+    benchmark::DoNotOptimize(page->GetData()[0]);
+    bpm->UnpinPage(page_id, false);
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_BufferPoolFetchUnpin)
+    ->ArgNames({"instances", "pages"})
+    ->Args({1, POOL_FRAMES / 2})
+    ->Args({8, POOL_FRAMES / 2})
+    ->Args({1, POOL_FRAMES * 8})
+    ->Args({8, POOL_FRAMES * 8})
+    ->ThreadRange(1, 64)
+    ->UseRealTime()
+    ->Setup(SetUpPool)
+    ->Teardown(TearDownPool);
+
+}  // namespace bustub
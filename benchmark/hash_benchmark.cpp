@@ -0,0 +1,69 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// hash_benchmark.cpp
+//
+// Identification: benchmark/hash_benchmark.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <string>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "catalog/schema.h"
+#include "common/util/hash_util.h"
+#include "execution/vector/data_chunk.h"
+#include "execution/vector/hash_kernels.h"
+#include "type/value_factory.h"
+
+namespace bustub {
+
+/** Hashes a string of state.range(0) bytes. */
+void BM_HashBytes(benchmark::State &state) {  // NOLINT
+  std::string bytes(static_cast<size_t>(state.range(0)), 'x');
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(HashUtil::HashBytes(bytes.data(), bytes.size()));
+  }
+  state.SetBytesProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_HashBytes)->ArgName("bytes")->Arg(8)->Arg(32)->Arg(256)->Arg(4096);
+
+/** Hashes the rows of a chunk of two INTEGER columns a value at a time, as a hash table of keys of Values does. */
+void BM_HashValues(benchmark::State &state) {  // NOLINT
+  std::vector<Value> values;
+  for (int32_t i = 0; i < static_cast<int32_t>(DataChunk::DEFAULT_CAPACITY); i++) {
+    values.push_back(ValueFactory::GetIntegerValue(i));
+  }
+  for (auto _ : state) {
+    for (const Value &value : values) {
+      benchmark::DoNotOptimize(HashUtil::CombineHashes(HashUtil::CombineHashes(0, HashUtil::HashValue(&value)),
+                                                       HashUtil::HashValue(&value)));
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * values.size());
+}
+BENCHMARK(BM_HashValues);
+
+/** Hashes the rows of a chunk of two INTEGER columns a column at a time. */
+void BM_HashChunk(benchmark::State &state) {  // NOLINT
+  Schema schema({Column("a", TypeId::INTEGER), Column("b", TypeId::INTEGER)});
+  DataChunk chunk(&schema);
+  for (int32_t i = 0; i < static_cast<int32_t>(chunk.GetCapacity()); i++) {
+    chunk.GetColumn(0).GetData<int32_t>()[i] = i;
+    chunk.GetColumn(1).GetData<int32_t>()[i] = i;
+  }
+  chunk.SetSize(chunk.GetCapacity());
+  std::vector<hash_t> hashes(chunk.GetCapacity());
+  for (auto _ : state) {
+    HashChunk(chunk, {0, 1}, hashes.data());
+    benchmark::ClobberMemory();
+  }
+  state.SetItemsProcessed(state.iterations() * chunk.GetSize());
+}
+BENCHMARK(BM_HashChunk);
+
+}  // namespace bustub
@@ -0,0 +1,110 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// hash_table_benchmark.cpp
+//
+// Identification: benchmark/hash_table_benchmark.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "buffer/buffer_pool_manager_instance.h"
+#include "container/hash/linear_probe_hash_table.h"
+#include "storage/disk/disk_manager.h"
+
+namespace bustub {
+
+namespace {
+
+using IntHashTable = LinearProbeHashTable<int, int, IntComparator>;
+
+/** The slots of the table, whose block pages all stay cached in the pool */
+constexpr size_t NUM_SLOTS = 1 << 16;
+/** The inserts of a run of the insert benchmark, which take the table five points of load further */
+constexpr size_t INSERTS_PER_RUN = NUM_SLOTS / 20;
+
+DiskManager *disk_manager = nullptr;
+BufferPoolManagerInstance *bpm = nullptr;
+IntHashTable *table = nullptr;
+int num_keys = 0;
+
+/** Creates a table, and fills state.range(0) percent of its slots, with the keys 0, 1, ... */
+void SetUpTable(const benchmark::State &state) {
+  disk_manager = new DiskManager("bench.db");
+  bpm = new BufferPoolManagerInstance(1024, disk_manager);
+  table = new IntHashTable("bench", bpm, IntComparator(), NUM_SLOTS, HashFunction<int>());
+  num_keys = static_cast<int>(NUM_SLOTS * state.range(0) / 100);
+  for (int key = 0; key < num_keys; key++) {
+    table->Insert(nullptr, key, key);
+  }
+}
+
+void TearDownTable(const benchmark::State &state) {
+  delete table;
+  delete bpm;
+  delete disk_manager;
+  table = nullptr;
+  bpm = nullptr;
+  disk_manager = nullptr;
+  remove("bench.db");
+  remove("bench.log");
+}
+
+}  // namespace
+
+/**
+ * Inserts new keys into a table that is state.range(0) percent full. The number of inserts is fixed, so that every run
+ * measures the same stretch of load, which stays below that at which the table grows.
+ */
+void BM_HashTableInsert(benchmark::State &state) {  // NOLINT
+  int key = num_keys;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(table->Insert(nullptr, key, key));
+    key++;
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_HashTableInsert)
+    ->ArgName("load_percent")
+    ->Arg(0)
+    ->Arg(25)
+    ->Arg(50)
+    ->Arg(65)
+    ->Iterations(INSERTS_PER_RUN)
+    ->Setup(SetUpTable)
+    ->Teardown(TearDownTable);
+
+/** Looks up keys of a table that is state.range(0) percent full, at random; every one of them is there. */
+void BM_HashTableLookup(benchmark::State &state) {  // NOLINT
+  std::mt19937 generator(42);
+  std::uniform_int_distribution<int> distribution(0, num_keys - 1);
+  std::vector<int> keys(1 << 16);
+  for (auto &key : keys) {
+    key = distribution(generator);
+  }
+  size_t next = 0;
+  std::vector<int> result;
+  for (auto _ : state) {
+    result.clear();
+    table->GetValue(nullptr, keys[next], &result);
+    benchmark::DoNotOptimize(result.data());
+    next = (next + 1) % keys.size();
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_HashTableLookup)
+    ->ArgName("load_percent")
+    ->Arg(25)
+    ->Arg(50)
+    ->Arg(70)
+    ->Setup(SetUpTable)
+    ->Teardown(TearDownTable);
+
+}  // namespace bustub
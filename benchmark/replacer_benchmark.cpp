@@ -0,0 +1,124 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// replacer_benchmark.cpp
+//
+// Identification: benchmark/replacer_benchmark.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "buffer/replacer.h"
+
+namespace bustub {
+
+namespace {
+
+/** @return a replacer of a policy, with every one of its frames unpinned */
+std::unique_ptr<Replacer> MakeUnpinnedReplacer(ReplacerType type, size_t num_frames) {
+  std::unique_ptr<Replacer> replacer = MakeReplacer(type, num_frames);
+  for (size_t frame = 0; frame < num_frames; frame++) {
+    replacer->Unpin(static_cast<frame_id_t>(frame));
+  }
+  return replacer;
+}
+
+/** @return frames of a pool picked at random, the same ones on every run */
+std::vector<frame_id_t> PickFrames(size_t num_frames) {
+  std::mt19937 generator(42);
+  std::uniform_int_distribution<frame_id_t> distribution(0, static_cast<frame_id_t>(num_frames) - 1);
+  std::vector<frame_id_t> frames(1 << 16);
+  for (auto &frame : frames) {
+    frame = distribution(generator);
+  }
+  return frames;
+}
+
+/** The replacer the threads of BM_ReplacerConcurrentPinUnpin share. */
+std::unique_ptr<Replacer> shared_replacer;
+std::vector<frame_id_t> shared_frames;
+
+template <ReplacerType Type>
+void SetUpSharedReplacer(const benchmark::State &state) {
+  auto num_frames = static_cast<size_t>(state.range(0));
+  shared_replacer = MakeUnpinnedReplacer(Type, num_frames);
+  shared_frames = PickFrames(num_frames);
+}
+
+void TearDownSharedReplacer(const benchmark::State &state) { shared_replacer.reset(); }
+
+}  // namespace
+
+/** A miss of the buffer pool: the victim's frame is taken, and given back once the new page in it is unpinned. */
+template <ReplacerType Type>
+void BM_ReplacerVictimUnpin(benchmark::State &state) {  // NOLINT
+  auto num_frames = static_cast<size_t>(state.range(0));
+  std::unique_ptr<Replacer> replacer = MakeUnpinnedReplacer(Type, num_frames);
+  for (auto _ : state) {
+    frame_id_t frame;
+    replacer->Victim(&frame);
+    replacer->Unpin(frame);
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+/** A hit of the buffer pool: a cached page's frame is pinned, and unpinned once it has been read. */
+template <ReplacerType Type>
+void BM_ReplacerPinUnpin(benchmark::State &state) {  // NOLINT
+  auto num_frames = static_cast<size_t>(state.range(0));
+  std::unique_ptr<Replacer> replacer = MakeUnpinnedReplacer(Type, num_frames);
+  std::vector<frame_id_t> frames = PickFrames(num_frames);
+  size_t next = 0;
+  for (auto _ : state) {
+    frame_id_t frame = frames[next];
+    next = (next + 1) % frames.size();
+    replacer->Pin(frame);
+    replacer->Unpin(frame);
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+/** Hits of the buffer pool from several threads at once, each on frames of its own picks. */
+template <ReplacerType Type>
+void BM_ReplacerConcurrentPinUnpin(benchmark::State &state) {  // NOLINT
+  size_t next = static_cast<size_t>(state.thread_index()) * shared_frames.size() / static_cast<size_t>(state.threads());
+  for (auto _ : state) {
+    frame_id_t frame = shared_frames[next];
+    next = (next + 1) % shared_frames.size();
+    shared_replacer->Pin(frame);
+    shared_replacer->Unpin(frame);
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK_TEMPLATE(BM_ReplacerVictimUnpin, ReplacerType::CLOCK)->ArgName("frames")->Range(1 << 10, 1 << 16);
+BENCHMARK_TEMPLATE(BM_ReplacerVictimUnpin, ReplacerType::LRU)->ArgName("frames")->Range(1 << 10, 1 << 16);
+BENCHMARK_TEMPLATE(BM_ReplacerVictimUnpin, ReplacerType::LRU_K)->ArgName("frames")->Range(1 << 10, 1 << 16);
+BENCHMARK_TEMPLATE(BM_ReplacerVictimUnpin, ReplacerType::ATOMIC_CLOCK)->ArgName("frames")->Range(1 << 10, 1 << 16);
+BENCHMARK_TEMPLATE(BM_ReplacerPinUnpin, ReplacerType::CLOCK)->ArgName("frames")->Range(1 << 10, 1 << 16);
+BENCHMARK_TEMPLATE(BM_ReplacerPinUnpin, ReplacerType::LRU)->ArgName("frames")->Range(1 << 10, 1 << 16);
+BENCHMARK_TEMPLATE(BM_ReplacerPinUnpin, ReplacerType::LRU_K)->ArgName("frames")->Range(1 << 10, 1 << 16);
+BENCHMARK_TEMPLATE(BM_ReplacerPinUnpin, ReplacerType::ATOMIC_CLOCK)->ArgName("frames")->Range(1 << 10, 1 << 16);
+BENCHMARK_TEMPLATE(BM_ReplacerConcurrentPinUnpin, ReplacerType::CLOCK)
+    ->ArgName("frames")
+    ->Arg(1 << 12)
+    ->ThreadRange(1, 16)
+    ->UseRealTime()
+    ->Setup(SetUpSharedReplacer<ReplacerType::CLOCK>)
+    ->Teardown(TearDownSharedReplacer);
+BENCHMARK_TEMPLATE(BM_ReplacerConcurrentPinUnpin, ReplacerType::ATOMIC_CLOCK)
+    ->ArgName("frames")
+    ->Arg(1 << 12)
+    ->ThreadRange(1, 16)
+    ->UseRealTime()
+    ->Setup(SetUpSharedReplacer<ReplacerType::ATOMIC_CLOCK>)
+    ->Teardown(TearDownSharedReplacer);
+
+}  // namespace bustub
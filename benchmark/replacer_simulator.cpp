@@ -0,0 +1,144 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// replacer_simulator.cpp
+//
+// Identification: benchmark/replacer_simulator.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+// Replays the page references of a page trace against every replacement policy at a range of pool sizes, and prints
+// the hit ratio of each, a curve per policy:
+//
+//   bustub_replacer_sim --trace=ycsb.trace --pool_sizes=64,256,1024,4096 --replacers=clock,lru_k --threads=4
+//
+// The references are the fetches of the trace, or its reads if it has no fetches. Without --pool_sizes the pool sizes
+// are the powers of two from 16 frames up to the first one that holds every page referenced, at which every policy
+// only misses each page once. See ReplacementSimulator for what is simulated.
+
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "buffer/replacement_simulator.h"
+#include "storage/disk/page_trace.h"
+
+namespace bustub {
+
+namespace {
+
+struct Options {
+  std::string trace_;
+  std::vector<size_t> pool_sizes_;
+  std::vector<ReplacerType> replacer_types_{ALL_REPLACER_TYPES.begin(), ALL_REPLACER_TYPES.end()};
+  size_t threads_{std::max<size_t>(std::thread::hardware_concurrency(), 1)};
+};
+
+bool ParseOptions(int argc, char **argv, Options *options) {
+  for (int i = 1; i < argc; i++) {
+    std::string arg = argv[i];
+    size_t equals = arg.find('=');
+    if (arg.rfind("--", 0) != 0 || equals == std::string::npos) {
+      std::cerr << "bad argument " << arg << ", expected --name=value" << std::endl;
+      return false;
+    }
+    std::string name = arg.substr(2, equals - 2);
+    std::string value = arg.substr(equals + 1);
+    std::stringstream list(value);
+    std::string item;
+    if (name == "trace") {
+      options->trace_ = value;
+    } else if (name == "pool_sizes") {
+      options->pool_sizes_.clear();
+      while (std::getline(list, item, ',')) {
+        options->pool_sizes_.push_back(std::stoull(item));
+      }
+    } else if (name == "replacers") {
+      options->replacer_types_.clear();
+      while (std::getline(list, item, ',')) {
+        bool found = false;
+        for (ReplacerType type : ALL_REPLACER_TYPES) {
+          if (item == ReplacerTypeName(type)) {
+            options->replacer_types_.push_back(type);
+            found = true;
+          }
+        }
+        if (!found) {
+          std::cerr << "unknown replacer " << item << std::endl;
+          return false;
+        }
+      }
+    } else if (name == "threads") {
+      options->threads_ = std::stoull(value);
+    } else {
+      std::cerr << "unknown option --" << name << std::endl;
+      return false;
+    }
+  }
+  if (options->trace_.empty()) {
+    std::cerr << "--trace is the file of a page trace" << std::endl;
+    return false;
+  }
+  if (options->threads_ == 0 || options->replacer_types_.empty()) {
+    std::cerr << "--threads and --replacers are positive" << std::endl;
+    return false;
+  }
+  for (size_t pool_size : options->pool_sizes_) {
+    if (pool_size == 0) {
+      std::cerr << "--pool_sizes are positive" << std::endl;
+      return false;
+    }
+  }
+  return true;
+}
+
+}  // namespace
+
+}  // namespace bustub
+
+int main(int argc, char **argv) {
+  bustub::Options options;
+  if (!bustub::ParseOptions(argc, argv, &options)) {
+    return 1;
+  }
+  std::vector<bustub::PageAccess> accesses;
+  if (!bustub::PageTrace::Load(options.trace_, &accesses)) {
+    std::cerr << "cannot read the page trace " << options.trace_ << std::endl;
+    return 1;
+  }
+  bustub::ReplacementSimulator simulator(bustub::ReplacementSimulator::References(accesses));
+  size_t distinct_pages = simulator.GetNumDistinctPages();
+  if (options.pool_sizes_.empty()) {
+    for (size_t pool_size = 16;; pool_size *= 2) {
+      options.pool_sizes_.push_back(pool_size);
+      if (pool_size >= distinct_pages) {
+        break;
+      }
+    }
+  }
+  std::cout << "trace " << options.trace_ << ", " << simulator.GetNumReferences() << " references to "
+            << distinct_pages << " pages" << std::endl;
+
+  std::vector<bustub::SimulationResult> results =
+      simulator.RunAll(options.pool_sizes_, options.replacer_types_, options.threads_);
+  std::cout << std::setw(10) << "frames";
+  for (bustub::ReplacerType type : options.replacer_types_) {
+    std::cout << std::setw(10) << bustub::ReplacerTypeName(type);
+  }
+  std::cout << std::endl << std::fixed << std::setprecision(4);
+  for (size_t row = 0; row < options.pool_sizes_.size(); row++) {
+    std::cout << std::setw(10) << options.pool_sizes_[row];
+    for (size_t column = 0; column < options.replacer_types_.size(); column++) {
+      std::cout << std::setw(10) << results[row * options.replacer_types_.size() + column].HitRatio();
+    }
+    std::cout << std::endl;
+  }
+  return 0;
+}
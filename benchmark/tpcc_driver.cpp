@@ -0,0 +1,836 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// tpcc_driver.cpp
+//
+// Identification: benchmark/tpcc_driver.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+// Runs the NewOrder, Payment and OrderStatus transactions of TPC-C against a scaled TPC-C database, end to end:
+//
+//   bustub_tpcc --warehouses=2 --threads=8 --seconds=30 --deadlock_policy=wound_wait
+//
+// The tables are created through the Catalog, loaded, and indexed; each transaction is a real one of the
+// TransactionManager, under REPEATABLE_READ with the LockManager's row locks and the log on, whose statements are
+// plan nodes that the ExecutionEngine runs. The driver reports tpmC (the NewOrders committed per minute), how many
+// transactions of each kind committed and aborted, why they aborted, and the latencies of the transactions and of
+// their commits.
+//
+// It is TPC-C-like rather than TPC-C: every column is an integer, money in cents, and the keys made of several columns
+// are packed into a BIGINT of their own, as a key range scan is of an index of a single column. A district has
+// --customers customers, the initial order of each of them, and the spec's mix of the three transactions, without the
+// keying and think times; customers are picked by id, never by last name, and an aborted transaction is not retried.
+
+#include <algorithm>
+#include <chrono>  // NOLINT
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>  // NOLINT
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "buffer/parallel_buffer_pool_manager.h"
+#include "catalog/catalog.h"
+#include "common/contention.h"
+#include "common/tracer.h"
+#include "concurrency/lock_manager.h"
+#include "concurrency/transaction_manager.h"
+#include "execution/execution_engine.h"
+#include "execution/executor_context.h"
+#include "execution/executor_factory.h"
+#include "execution/expressions/column_value_expression.h"
+#include "execution/expressions/constant_value_expression.h"
+#include "execution/plans/index_scan_plan.h"
+#include "execution/plans/insert_plan.h"
+#include "execution/plans/update_plan.h"
+#include "recovery/log_manager.h"
+#include "storage/disk/disk_manager.h"
+#include "type/value_factory.h"
+
+namespace bustub {
+
+namespace {
+
+enum class TxnType { NEW_ORDER, PAYMENT, ORDER_STATUS };
+constexpr size_t NUM_TXN_TYPES = 3;
+const char *const TXN_NAMES[NUM_TXN_TYPES] = {"NEW_ORDER", "PAYMENT", "ORDER_STATUS"};
+/** The mix of the transactions, in the order of TxnType: the spec's, with the share of Delivery and StockLevel */
+const double TXN_MIX[NUM_TXN_TYPES] = {0.45, 0.43, 0.12};
+
+constexpr int64_t DISTRICTS_PER_WAREHOUSE = 10;
+/** The bits of the order id in the key of an order, and of the line number in that of an order line */
+constexpr int ORDER_ID_BITS = 24;
+constexpr int LINE_NUMBER_BITS = 4;
+
+struct Options {
+  int64_t warehouses_{1};
+  int64_t customers_{300};
+  int64_t items_{10000};
+  size_t threads_{4};
+  double seconds_{10};
+  size_t pool_frames_{8192};
+  size_t pool_instances_{1};
+  std::string deadlock_policy_{"detection"};
+  uint64_t seed_{42};
+  /** The file the run is traced into, as a Chrome trace; empty if it is not traced */
+  std::string trace_;
+};
+
+/** The keys of the rows, each packed into a BIGINT */
+int64_t DistrictKey(int64_t w, int64_t d) { return w * DISTRICTS_PER_WAREHOUSE + d; }
+int64_t CustomerKey(const Options &options, int64_t w, int64_t d, int64_t c) {
+  return DistrictKey(w, d) * options.customers_ + c;
+}
+int64_t StockKey(const Options &options, int64_t w, int64_t i) { return w * options.items_ + i; }
+int64_t OrderKey(int64_t district_key, int64_t o_id) { return (district_key << ORDER_ID_BITS) | o_id; }
+/** The key of an order in the index of the orders of a customer, by which the last of them is found */
+int64_t CustomerOrderKey(int64_t customer_key, int64_t o_id) { return (customer_key << ORDER_ID_BITS) | o_id; }
+int64_t OrderLineKey(int64_t order_key, int64_t ol_number) { return (order_key << LINE_NUMBER_BITS) | ol_number; }
+
+/** The columns of the rows that the statements read and update, each table's key being its column 0 */
+enum WarehouseColumn : uint32_t { W_KEY, W_TAX, W_YTD };
+enum DistrictColumn : uint32_t { D_KEY, D_TAX, D_YTD, D_NEXT_O_ID };
+enum CustomerColumn : uint32_t { C_KEY, C_DISCOUNT, C_BALANCE, C_YTD_PAYMENT, C_PAYMENT_CNT };
+enum ItemColumn : uint32_t { I_KEY, I_PRICE };
+enum StockColumn : uint32_t { S_KEY, S_QUANTITY, S_YTD, S_ORDER_CNT, S_REMOTE_CNT };
+enum OrderColumn : uint32_t { O_KEY, O_C_KEY, O_ENTRY_D, O_OL_CNT, O_ALL_LOCAL };
+
+/** The latencies of the transactions of a kind, or of the commits, in nanoseconds */
+using Latencies = std::vector<uint64_t>;
+
+/** @return a latency percentile of sorted latencies, in microseconds */
+double Percentile(const Latencies &sorted, double percentile) {
+  if (sorted.empty()) {
+    return 0;
+  }
+  auto rank = static_cast<size_t>(std::ceil(percentile / 100 * static_cast<double>(sorted.size())));
+  return static_cast<double>(sorted[std::max<size_t>(rank, 1) - 1]) / 1000;
+}
+
+/** What a thread counted, merged into the totals once it is done */
+struct ThreadStats {
+  uint64_t committed_[NUM_TXN_TYPES]{};
+  uint64_t aborted_[NUM_TXN_TYPES]{};
+  std::map<std::string, uint64_t> abort_reasons_;
+  Latencies latencies_[NUM_TXN_TYPES];
+  Latencies commit_latencies_;
+};
+
+/** A table, with its index on the key, and the schema that an index scan of it outputs whole rows in */
+struct Table {
+  TableMetadata *info_;
+  IndexInfo *pk_;
+  std::vector<std::unique_ptr<ColumnValueExpression>> columns_;
+  std::unique_ptr<Schema> output_schema_;
+};
+
+class Driver {
+ public:
+  explicit Driver(const Options &options) : options_(options) {
+    DeadlockPolicy policy = DeadlockPolicy::DETECTION;
+    if (options.deadlock_policy_ == "wound_wait") {
+      policy = DeadlockPolicy::WOUND_WAIT;
+    } else if (options.deadlock_policy_ == "wait_die") {
+      policy = DeadlockPolicy::WAIT_DIE;
+    }
+    disk_manager_ = std::make_unique<DiskManager>("tpcc.db");
+    log_manager_ = std::make_unique<LogManager>(disk_manager_.get());
+    bpm_ = std::make_unique<ParallelBufferPoolManager>(options.pool_instances_,
+                                                       options.pool_frames_ / options.pool_instances_,
+                                                       disk_manager_.get(), log_manager_.get());
+    // the B+ trees record their roots in the header page, page 0
+    page_id_t header_page_id;
+    bpm_->NewPage(&header_page_id);
+    bpm_->UnpinPage(header_page_id, true);
+    lock_manager_ = std::make_unique<LockManager>(policy);
+    txn_mgr_ = std::make_unique<TransactionManager>(lock_manager_.get(), log_manager_.get());
+    catalog_ = std::make_unique<Catalog>(bpm_.get(), lock_manager_.get(), log_manager_.get());
+    engine_ = std::make_unique<ExecutionEngine>(bpm_.get(), txn_mgr_.get(), catalog_.get());
+  }
+
+  ~Driver() {
+    log_manager_->StopFlushThread();
+    enable_logging = false;
+    engine_.reset();
+    catalog_.reset();
+    txn_mgr_.reset();
+    lock_manager_.reset();
+    bpm_.reset();
+    log_manager_.reset();
+    disk_manager_.reset();
+    remove("tpcc.db");
+    remove("tpcc.log");
+  }
+
+  /**
+   * Creates the tables and loads them in a transaction of its own, with the log and the locks off, then indexes them.
+   */
+  void Load() {
+    auto start = std::chrono::steady_clock::now();
+    std::mt19937_64 generator(options_.seed_);
+    Transaction *txn = txn_mgr_->Begin();
+    ExecutorContext exec_ctx(txn, catalog_.get(), bpm_.get(), txn_mgr_.get(), lock_manager_.get());
+    auto bigint = [](int64_t value) { return ValueFactory::GetBigIntValue(value); };
+    auto integer = [](int64_t value) { return ValueFactory::GetIntegerValue(static_cast<int32_t>(value)); };
+    auto uniform = [&](int64_t low, int64_t high) {
+      return std::uniform_int_distribution<int64_t>(low, high)(generator);
+    };
+
+    warehouse_ = CreateTable(txn, "warehouse",
+                             {{"w_key", TypeId::BIGINT}, {"w_tax", TypeId::INTEGER}, {"w_ytd", TypeId::BIGINT}});
+    district_ = CreateTable(txn, "district",
+                            {{"d_key", TypeId::BIGINT},
+                             {"d_tax", TypeId::INTEGER},
+                             {"d_ytd", TypeId::BIGINT},
+                             {"d_next_o_id", TypeId::INTEGER}});
+    customer_ = CreateTable(txn, "customer",
+                            {{"c_key", TypeId::BIGINT},
+                             {"c_discount", TypeId::INTEGER},
+                             {"c_balance", TypeId::BIGINT},
+                             {"c_ytd_payment", TypeId::BIGINT},
+                             {"c_payment_cnt", TypeId::INTEGER}});
+    item_ = CreateTable(txn, "item", {{"i_key", TypeId::BIGINT}, {"i_price", TypeId::INTEGER}});
+    stock_ = CreateTable(txn, "stock",
+                         {{"s_key", TypeId::BIGINT},
+                          {"s_quantity", TypeId::INTEGER},
+                          {"s_ytd", TypeId::INTEGER},
+                          {"s_order_cnt", TypeId::INTEGER},
+                          {"s_remote_cnt", TypeId::INTEGER}});
+    orders_ = CreateTable(txn, "orders",
+                          {{"o_key", TypeId::BIGINT},
+                           {"o_c_key", TypeId::BIGINT},
+                           {"o_entry_d", TypeId::BIGINT},
+                           {"o_ol_cnt", TypeId::INTEGER},
+                           {"o_all_local", TypeId::INTEGER}});
+    new_order_ = CreateTable(txn, "new_order", {{"no_key", TypeId::BIGINT}});
+    order_line_ = CreateTable(txn, "order_line",
+                              {{"ol_key", TypeId::BIGINT},
+                               {"ol_i_id", TypeId::INTEGER},
+                               {"ol_supply_w_id", TypeId::INTEGER},
+                               {"ol_quantity", TypeId::INTEGER},
+                               {"ol_amount", TypeId::BIGINT}});
+    history_ = CreateTable(txn, "history",
+                           {{"h_c_key", TypeId::BIGINT},
+                            {"h_d_key", TypeId::BIGINT},
+                            {"h_date", TypeId::BIGINT},
+                            {"h_amount", TypeId::BIGINT}});
+
+    Loader loader(this, &exec_ctx);
+    for (int64_t i = 0; i < options_.items_; i++) {
+      loader.Add(item_, {bigint(i), integer(uniform(100, 10000))});
+    }
+    for (int64_t w = 0; w < options_.warehouses_; w++) {
+      loader.Add(warehouse_, {bigint(w), integer(uniform(0, 2000)), bigint(30000000)});
+      for (int64_t i = 0; i < options_.items_; i++) {
+        loader.Add(stock_, {bigint(StockKey(options_, w, i)), integer(uniform(10, 100)), integer(0), integer(0),
+                            integer(0)});
+      }
+      for (int64_t d = 0; d < DISTRICTS_PER_WAREHOUSE; d++) {
+        int64_t district_key = DistrictKey(w, d);
+        loader.Add(district_, {bigint(district_key), integer(uniform(0, 2000)), bigint(3000000),
+                               integer(options_.customers_)});
+        for (int64_t c = 0; c < options_.customers_; c++) {
+          loader.Add(customer_, {bigint(CustomerKey(options_, w, d, c)), integer(uniform(0, 5000)), bigint(-1000),
+                                 bigint(1000), integer(1)});
+          loader.Add(history_, {bigint(CustomerKey(options_, w, d, c)), bigint(district_key), bigint(0), bigint(1000)});
+        }
+        // the initial orders are one per customer, in an order of their own; the last 30% of them are not delivered
+        std::vector<int64_t> customers(options_.customers_);
+        for (int64_t c = 0; c < options_.customers_; c++) {
+          customers[c] = c;
+        }
+        std::shuffle(customers.begin(), customers.end(), generator);
+        for (int64_t o_id = 0; o_id < options_.customers_; o_id++) {
+          int64_t order_key = OrderKey(district_key, o_id);
+          int64_t ol_cnt = uniform(5, 15);
+          loader.Add(orders_, {bigint(order_key),
+                               bigint(CustomerOrderKey(CustomerKey(options_, w, d, customers[o_id]), o_id)),
+                               bigint(0), integer(ol_cnt), integer(1)});
+          bool delivered = o_id < options_.customers_ * 7 / 10;
+          if (!delivered) {
+            loader.Add(new_order_, {bigint(order_key)});
+          }
+          for (int64_t ol_number = 0; ol_number < ol_cnt; ol_number++) {
+            loader.Add(order_line_,
+                       {bigint(OrderLineKey(order_key, ol_number)), integer(uniform(0, options_.items_ - 1)),
+                        integer(w), integer(5), bigint(delivered ? 0 : uniform(1, 999999))});
+          }
+        }
+      }
+    }
+    loader.Flush();
+
+    // the indexes are built from the loaded tables rather than kept up as they are loaded
+    for (Table *table : {&warehouse_, &district_, &customer_, &item_, &stock_, &orders_, &new_order_, &order_line_}) {
+      table->pk_ = CreateIndex(txn, table->info_->name_ + "_pk", table->info_->name_, 0);
+    }
+    customer_orders_ = CreateIndex(txn, "orders_customer", "orders", O_C_KEY);
+    txn_mgr_->Commit(txn);
+    txn_mgr_->Release(txn);
+
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "[LOAD] " << options_.warehouses_ << " warehouses, " << loader.rows_ << " rows in " << seconds << " s"
+              << std::endl;
+  }
+
+  /** Runs the mix of transactions from the threads for --seconds, and reports what came of them. */
+  void Run() {
+    // the run's transactions take locks and log their changes, which the commits wait to be flushed
+    log_manager_->RunFlushThread();
+    std::vector<ThreadStats> stats(options_.threads_);
+    BufferPoolStats before = bpm_->GetStats();
+    // the waits of the load are not the run's
+    ContentionProfiler::Reset();
+    if (!options_.trace_.empty()) {
+      Tracer::Enable();
+    }
+    auto start = std::chrono::steady_clock::now();
+    auto deadline = start + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                                std::chrono::duration<double>(options_.seconds_));
+    std::vector<std::thread> threads;
+    for (size_t thread = 0; thread < options_.threads_; thread++) {
+      threads.emplace_back([&, thread] {
+        std::mt19937_64 generator(options_.seed_ + 1 + thread);
+        while (std::chrono::steady_clock::now() < deadline) {
+          RunTransaction(NextTxnType(&generator), &generator, &stats[thread]);
+        }
+      });
+    }
+    for (auto &thread : threads) {
+      thread.join();
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    BufferPoolStats after = bpm_->GetStats();
+    Report(stats, seconds, after.hits_ - before.hits_, after.misses_ - before.misses_);
+    ReportContention();
+    if (!options_.trace_.empty()) {
+      // the rings keep the last spans of each thread, the end of the run
+      Tracer::Disable();
+      std::ofstream trace(options_.trace_);
+      Tracer::ExportChromeTrace(&trace);
+      std::cout << "trace written to " << options_.trace_ << std::endl;
+    }
+  }
+
+ private:
+  /** Collects the rows of the load into raw inserts of a batch of rows each, which the engine runs. */
+  class Loader {
+   public:
+    Loader(Driver *driver, ExecutorContext *exec_ctx) : driver_(driver), exec_ctx_(exec_ctx) {}
+
+    void Add(const Table &table, std::vector<Value> &&row) {
+      auto &batch = batches_[table.info_->oid_];
+      batch.push_back(std::move(row));
+      rows_++;
+      if (batch.size() == BATCH_SIZE) {
+        Insert(table.info_->oid_, &batch);
+      }
+    }
+
+    void Flush() {
+      for (auto &[oid, batch] : batches_) {
+        Insert(oid, &batch);
+      }
+    }
+
+    uint64_t rows_{0};
+
+   private:
+    static constexpr size_t BATCH_SIZE = 1024;
+
+    void Insert(table_oid_t oid, std::vector<std::vector<Value>> *batch) {
+      if (batch->empty()) {
+        return;
+      }
+      InsertPlanNode plan(std::move(*batch), oid);
+      driver_->engine_->Execute(&plan, nullptr, exec_ctx_->GetTransaction(), exec_ctx_);
+      batch->clear();
+    }
+
+    Driver *driver_;
+    ExecutorContext *exec_ctx_;
+    std::unordered_map<table_oid_t, std::vector<std::vector<Value>>> batches_;
+  };
+
+  Table CreateTable(Transaction *txn, const std::string &name,
+                    const std::vector<std::pair<std::string, TypeId>> &defs) {
+    Table table;
+    std::vector<Column> columns;
+    std::vector<Column> output_columns;
+    for (uint32_t i = 0; i < defs.size(); i++) {
+      columns.emplace_back(defs[i].first, defs[i].second);
+      table.columns_.push_back(std::make_unique<ColumnValueExpression>(0, i, defs[i].second));
+      output_columns.emplace_back(defs[i].first, defs[i].second, table.columns_.back().get());
+    }
+    table.info_ = catalog_->CreateTable(txn, name, Schema(columns));
+    table.pk_ = nullptr;
+    table.output_schema_ = std::make_unique<Schema>(output_columns);
+    return table;
+  }
+
+  IndexInfo *CreateIndex(Transaction *txn, const std::string &name, const std::string &table_name, uint32_t column) {
+    const Schema &schema = catalog_->GetTable(table_name)->schema_;
+    Schema key_schema(std::vector<Column>{schema.GetColumn(column)});
+    return catalog_->CreateIndex<GenericKey<8>, RID, GenericComparator<8>>(txn, name, table_name, schema, key_schema,
+                                                                           {column}, 8);
+  }
+
+  TxnType NextTxnType(std::mt19937_64 *generator) const {
+    double u = std::uniform_real_distribution<double>(0, 1)(*generator);
+    for (size_t type = 0; type < NUM_TXN_TYPES; type++) {
+      u -= TXN_MIX[type];
+      if (u < 0) {
+        return static_cast<TxnType>(type);
+      }
+    }
+    return TxnType::NEW_ORDER;
+  }
+
+  /**
+   * @return a number of [low, high] of the non-uniform distribution NURand of the spec, whose constant A is scaled
+   * to the range as that of the customer ids, 1023 of 3000, is
+   */
+  static int64_t NonUniform(std::mt19937_64 *generator, int64_t low, int64_t high) {
+    int64_t a = 1;
+    while (a < (high - low + 1) / 3) {
+      a = a * 2 + 1;
+    }
+    auto uniform = [&](int64_t x, int64_t y) { return std::uniform_int_distribution<int64_t>(x, y)(*generator); };
+    return ((uniform(0, a) | uniform(low, high)) % (high - low + 1)) + low;
+  }
+
+  /**
+   * Runs a transaction, and commits it if it got through, or aborts it: as the spec has it, or as a statement found it
+   * aborted by the deadlock policy.
+   */
+  void RunTransaction(TxnType type, std::mt19937_64 *generator, ThreadStats *stats) {
+    auto txn_start = std::chrono::steady_clock::now();
+    Transaction *txn = txn_mgr_->Begin();
+    std::string abort_reason;
+    {
+      ExecutorContext exec_ctx(txn, catalog_.get(), bpm_.get(), txn_mgr_.get(), lock_manager_.get());
+      try {
+        bool done = false;
+        switch (type) {
+          case TxnType::NEW_ORDER:
+            done = NewOrder(&exec_ctx, generator);
+            break;
+          case TxnType::PAYMENT:
+            done = Payment(&exec_ctx, generator);
+            break;
+          case TxnType::ORDER_STATUS:
+            done = OrderStatus(&exec_ctx, generator);
+            break;
+        }
+        if (!done) {
+          abort_reason = txn->GetState() == TransactionState::ABORTED ? PolicyAbortReason() : "user";
+        }
+      } catch (TransactionAbortException &e) {
+        abort_reason = e.GetAbortReason() == AbortReason::DEADLOCK ? PolicyAbortReason() : ReasonName(e);
+      }
+    }
+    // a transaction that is shrinking is let finish, so one that gets there before it is wounded commits
+    if (abort_reason.empty() && !txn->CompareAndSetState(TransactionState::GROWING, TransactionState::SHRINKING)) {
+      abort_reason = PolicyAbortReason();
+    }
+    auto type_index = static_cast<size_t>(type);
+    if (abort_reason.empty()) {
+      auto commit_start = std::chrono::steady_clock::now();
+      txn_mgr_->Commit(txn);
+      auto now = std::chrono::steady_clock::now();
+      stats->commit_latencies_.push_back(
+          std::chrono::duration_cast<std::chrono::nanoseconds>(now - commit_start).count());
+      stats->latencies_[type_index].push_back(
+          std::chrono::duration_cast<std::chrono::nanoseconds>(now - txn_start).count());
+      stats->committed_[type_index]++;
+    } else {
+      txn_mgr_->Abort(txn);
+      stats->aborted_[type_index]++;
+      stats->abort_reasons_[abort_reason]++;
+    }
+    txn_mgr_->Release(txn);
+  }
+
+  /** @return why the deadlock policy aborts a transaction, as its abort reason, DEADLOCK, does not say */
+  std::string PolicyAbortReason() const {
+    switch (lock_manager_->GetDeadlockPolicy()) {
+      case DeadlockPolicy::WOUND_WAIT:
+        return "wounded";
+      case DeadlockPolicy::WAIT_DIE:
+        return "died";
+      default:
+        return "deadlock victim";
+    }
+  }
+
+  /** @return the name of the reason of an abort that the deadlock policy did not cause */
+  static std::string ReasonName(TransactionAbortException &e) {
+    switch (e.GetAbortReason()) {
+      case AbortReason::UPGRADE_CONFLICT:
+        return "upgrade conflict";
+      case AbortReason::LOCK_ON_SHRINKING:
+        return "lock on shrinking";
+      default:
+        return "other";
+    }
+  }
+
+  /** @return false if the transaction is aborted */
+  static bool Alive(ExecutorContext *exec_ctx) {
+    return exec_ctx->GetTransaction()->GetState() != TransactionState::ABORTED;
+  }
+
+  /** Reads the rows of a table whose keys of an index are in [lower, upper], through an index scan. */
+  bool Read(ExecutorContext *exec_ctx, const Table &table, IndexInfo *index, int64_t lower, int64_t upper,
+            std::vector<Tuple> *rows) {
+    ConstantValueExpression lower_bound(ValueFactory::GetBigIntValue(lower));
+    ConstantValueExpression upper_bound(ValueFactory::GetBigIntValue(upper));
+    IndexKeyRange range{&lower_bound, true, lower == upper ? &lower_bound : &upper_bound, true};
+    IndexScanPlanNode plan(table.output_schema_.get(), nullptr, index->index_oid_, false, range);
+    engine_->Execute(&plan, rows, exec_ctx->GetTransaction(), exec_ctx);
+    return Alive(exec_ctx);
+  }
+
+  /** Reads the row of a key of a table, into row; false if the transaction is aborted or there is no such row. */
+  bool ReadRow(ExecutorContext *exec_ctx, const Table &table, int64_t key, Tuple *row) {
+    std::vector<Tuple> rows;
+    if (!Read(exec_ctx, table, table.pk_, key, key, &rows) || rows.empty()) {
+      return false;
+    }
+    *row = rows.front();
+    return true;
+  }
+
+  /** Adds to columns of the row of a key of a table, by an update whose child is an index scan of the key. */
+  bool Update(ExecutorContext *exec_ctx, const Table &table, int64_t key,
+              const std::unordered_map<uint32_t, UpdateInfo> &additions) {
+    ConstantValueExpression key_value(ValueFactory::GetBigIntValue(key));
+    IndexScanPlanNode scan(table.output_schema_.get(), nullptr, table.pk_->index_oid_, false,
+                           IndexKeyRange{&key_value, true, &key_value, true});
+    UpdatePlanNode update(&scan, table.info_->oid_, additions);
+    engine_->Execute(&update, nullptr, exec_ctx->GetTransaction(), exec_ctx);
+    return Alive(exec_ctx);
+  }
+
+  /** Inserts a row into a table, whose index entries the insert executor adds once the row is in. */
+  bool Insert(ExecutorContext *exec_ctx, const Table &table, std::vector<Value> &&values) {
+    InsertPlanNode plan(std::vector<std::vector<Value>>{std::move(values)}, table.info_->oid_);
+    engine_->Execute(&plan, nullptr, exec_ctx->GetTransaction(), exec_ctx);
+    return Alive(exec_ctx);
+  }
+
+  /** @return a warehouse other than w, or w if it is the only one */
+  int64_t RemoteWarehouse(std::mt19937_64 *generator, int64_t w) const {
+    if (options_.warehouses_ == 1) {
+      return w;
+    }
+    int64_t other = std::uniform_int_distribution<int64_t>(0, options_.warehouses_ - 2)(*generator);
+    return other >= w ? other + 1 : other;
+  }
+
+  /**
+   * Enters an order of 5 to 15 lines: takes the order id from the district, updates the stock of the items, and
+   * inserts the order and its lines. One in a hundred has an item that does not exist, and is rolled back.
+   */
+  bool NewOrder(ExecutorContext *exec_ctx, std::mt19937_64 *generator) {
+    auto uniform = [&](int64_t low, int64_t high) {
+      return std::uniform_int_distribution<int64_t>(low, high)(*generator);
+    };
+    int64_t w = uniform(0, options_.warehouses_ - 1);
+    int64_t d = uniform(0, DISTRICTS_PER_WAREHOUSE - 1);
+    int64_t c = NonUniform(generator, 0, options_.customers_ - 1);
+    int64_t ol_cnt = uniform(5, 15);
+    bool rollback = uniform(1, 100) == 1;
+
+    Tuple warehouse;
+    Tuple district;
+    Tuple customer;
+    if (!ReadRow(exec_ctx, warehouse_, w, &warehouse)) {
+      return false;
+    }
+    // the order id is taken by the update, which locks the district before it is read
+    int64_t district_key = DistrictKey(w, d);
+    if (!Update(exec_ctx, district_, district_key, {{D_NEXT_O_ID, UpdateInfo(UpdateType::Add, 1)}}) ||
+        !ReadRow(exec_ctx, district_, district_key, &district) ||
+        !ReadRow(exec_ctx, customer_, CustomerKey(options_, w, d, c), &customer)) {
+      return false;
+    }
+    int64_t o_id = district.GetValue(&district_.info_->schema_, D_NEXT_O_ID).GetAs<int32_t>() - 1;
+    int64_t order_key = OrderKey(district_key, o_id);
+
+    std::vector<int64_t> items(ol_cnt);
+    std::vector<int64_t> supply_warehouses(ol_cnt);
+    bool all_local = true;
+    for (int64_t ol_number = 0; ol_number < ol_cnt; ol_number++) {
+      items[ol_number] = NonUniform(generator, 0, options_.items_ - 1);
+      supply_warehouses[ol_number] = uniform(1, 100) == 1 ? RemoteWarehouse(generator, w) : w;
+      all_local = all_local && supply_warehouses[ol_number] == w;
+    }
+    if (rollback) {
+      items.back() = options_.items_;
+    }
+    auto now = std::chrono::system_clock::now().time_since_epoch().count();
+    if (!Insert(exec_ctx, orders_,
+                {ValueFactory::GetBigIntValue(order_key),
+                 ValueFactory::GetBigIntValue(CustomerOrderKey(CustomerKey(options_, w, d, c), o_id)),
+                 ValueFactory::GetBigIntValue(now), ValueFactory::GetIntegerValue(static_cast<int32_t>(ol_cnt)),
+                 ValueFactory::GetIntegerValue(all_local ? 1 : 0)}) ||
+        !Insert(exec_ctx, new_order_, {ValueFactory::GetBigIntValue(order_key)})) {
+      return false;
+    }
+
+    for (int64_t ol_number = 0; ol_number < ol_cnt; ol_number++) {
+      Tuple item;
+      if (!ReadRow(exec_ctx, item_, items[ol_number], &item)) {
+        // an item that is not there is the one of the rollback, unless the transaction was aborted
+        return false;
+      }
+      auto quantity = static_cast<int>(uniform(1, 10));
+      int64_t stock_key = StockKey(options_, supply_warehouses[ol_number], items[ol_number]);
+      Tuple stock;
+      if (!Update(exec_ctx, stock_, stock_key,
+                  {{S_QUANTITY, UpdateInfo(UpdateType::Add, -quantity)},
+                   {S_YTD, UpdateInfo(UpdateType::Add, quantity)},
+                   {S_ORDER_CNT, UpdateInfo(UpdateType::Add, 1)},
+                   {S_REMOTE_CNT, UpdateInfo(UpdateType::Add, supply_warehouses[ol_number] == w ? 0 : 1)}}) ||
+          !ReadRow(exec_ctx, stock_, stock_key, &stock)) {
+        return false;
+      }
+      // the stock is brought back up once it falls below 10
+      if (stock.GetValue(&stock_.info_->schema_, S_QUANTITY).GetAs<int32_t>() < 10 &&
+          !Update(exec_ctx, stock_, stock_key, {{S_QUANTITY, UpdateInfo(UpdateType::Add, 91)}})) {
+        return false;
+      }
+      int64_t amount = quantity * item.GetValue(&item_.info_->schema_, I_PRICE).GetAs<int32_t>();
+      if (!Insert(exec_ctx, order_line_,
+                  {ValueFactory::GetBigIntValue(OrderLineKey(order_key, ol_number)),
+                   ValueFactory::GetIntegerValue(static_cast<int32_t>(items[ol_number])),
+                   ValueFactory::GetIntegerValue(static_cast<int32_t>(supply_warehouses[ol_number])),
+                   ValueFactory::GetIntegerValue(quantity), ValueFactory::GetBigIntValue(amount)})) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  /**
+   * Pays an amount of a customer's balance: adds it to the year-to-date of the warehouse and the district, takes it off
+   * the balance of the customer, of a remote warehouse in 15% of the payments, and records it in the history.
+   */
+  bool Payment(ExecutorContext *exec_ctx, std::mt19937_64 *generator) {
+    auto uniform = [&](int64_t low, int64_t high) {
+      return std::uniform_int_distribution<int64_t>(low, high)(*generator);
+    };
+    int64_t w = uniform(0, options_.warehouses_ - 1);
+    int64_t d = uniform(0, DISTRICTS_PER_WAREHOUSE - 1);
+    bool remote = uniform(1, 100) <= 15;
+    int64_t c_w = remote ? RemoteWarehouse(generator, w) : w;
+    int64_t c_d = remote ? uniform(0, DISTRICTS_PER_WAREHOUSE - 1) : d;
+    int64_t customer_key = CustomerKey(options_, c_w, c_d, NonUniform(generator, 0, options_.customers_ - 1));
+    auto amount = static_cast<int>(uniform(100, 500000));
+
+    auto now = std::chrono::system_clock::now().time_since_epoch().count();
+    return Update(exec_ctx, warehouse_, w, {{W_YTD, UpdateInfo(UpdateType::Add, amount)}}) &&
+           Update(exec_ctx, district_, DistrictKey(w, d), {{D_YTD, UpdateInfo(UpdateType::Add, amount)}}) &&
+           Update(exec_ctx, customer_, customer_key,
+                  {{C_BALANCE, UpdateInfo(UpdateType::Add, -amount)},
+                   {C_YTD_PAYMENT, UpdateInfo(UpdateType::Add, amount)},
+                   {C_PAYMENT_CNT, UpdateInfo(UpdateType::Add, 1)}}) &&
+           Insert(exec_ctx, history_,
+                  {ValueFactory::GetBigIntValue(customer_key), ValueFactory::GetBigIntValue(DistrictKey(w, d)),
+                   ValueFactory::GetBigIntValue(now), ValueFactory::GetBigIntValue(amount)});
+  }
+
+  /** Reads a customer, their last order, and its lines. */
+  bool OrderStatus(ExecutorContext *exec_ctx, std::mt19937_64 *generator) {
+    auto uniform = [&](int64_t low, int64_t high) {
+      return std::uniform_int_distribution<int64_t>(low, high)(*generator);
+    };
+    int64_t customer_key = CustomerKey(options_, uniform(0, options_.warehouses_ - 1),
+                                       uniform(0, DISTRICTS_PER_WAREHOUSE - 1),
+                                       NonUniform(generator, 0, options_.customers_ - 1));
+    Tuple customer;
+    std::vector<Tuple> orders;
+    if (!ReadRow(exec_ctx, customer_, customer_key, &customer) ||
+        !Read(exec_ctx, orders_, customer_orders_, CustomerOrderKey(customer_key, 0),
+              CustomerOrderKey(customer_key, (1 << ORDER_ID_BITS) - 1), &orders) ||
+        orders.empty()) {
+      return false;
+    }
+    // the entries of a customer's orders are in the order of their ids, the last one last
+    int64_t order_key = orders.back().GetValue(&orders_.info_->schema_, O_KEY).GetAs<int64_t>();
+    std::vector<Tuple> lines;
+    return Read(exec_ctx, order_line_, order_line_.pk_, OrderLineKey(order_key, 0),
+                OrderLineKey(order_key, (1 << LINE_NUMBER_BITS) - 1), &lines);
+  }
+
+  void Report(const std::vector<ThreadStats> &stats, double seconds, uint64_t hits, uint64_t misses) const {
+    ThreadStats total;
+    for (const ThreadStats &thread : stats) {
+      for (size_t type = 0; type < NUM_TXN_TYPES; type++) {
+        total.committed_[type] += thread.committed_[type];
+        total.aborted_[type] += thread.aborted_[type];
+        total.latencies_[type].insert(total.latencies_[type].end(), thread.latencies_[type].begin(),
+                                      thread.latencies_[type].end());
+      }
+      for (const auto &[reason, count] : thread.abort_reasons_) {
+        total.abort_reasons_[reason] += count;
+      }
+      total.commit_latencies_.insert(total.commit_latencies_.end(), thread.commit_latencies_.begin(),
+                                     thread.commit_latencies_.end());
+    }
+    uint64_t committed = 0;
+    uint64_t aborted = 0;
+    for (size_t type = 0; type < NUM_TXN_TYPES; type++) {
+      committed += total.committed_[type];
+      aborted += total.aborted_[type];
+    }
+
+    std::cout << std::fixed << std::setprecision(2);
+    std::cout << "[RUN] " << committed + aborted << " transactions in " << seconds << " s, "
+              << static_cast<double>(committed) / seconds << " commits/s, tpmC "
+              << static_cast<double>(total.committed_[static_cast<size_t>(TxnType::NEW_ORDER)]) * 60 / seconds
+              << std::endl;
+    std::cout << "[RUN] buffer pool hit ratio " << std::setprecision(4)
+              << static_cast<double>(hits) / std::max<double>(1, static_cast<double>(hits + misses)) << ", " << misses
+              << " misses" << std::setprecision(2) << std::endl;
+    for (size_t type = 0; type < NUM_TXN_TYPES; type++) {
+      Latencies &latencies = total.latencies_[type];
+      std::sort(latencies.begin(), latencies.end());
+      uint64_t attempts = std::max<uint64_t>(1, total.committed_[type] + total.aborted_[type]);
+      std::cout << "[" << TXN_NAMES[type] << "] committed " << total.committed_[type] << ", aborted "
+                << total.aborted_[type] << " ("
+                << 100 * static_cast<double>(total.aborted_[type]) / static_cast<double>(attempts)
+                << "%), p50 " << Percentile(latencies, 50) << " us, p99 " << Percentile(latencies, 99) << " us"
+                << std::endl;
+    }
+    for (const auto &[reason, count] : total.abort_reasons_) {
+      std::cout << "[ABORT] " << reason << ": " << count << " ("
+                << 100 * static_cast<double>(count) / std::max<double>(1, static_cast<double>(committed + aborted))
+                << "% of the transactions)" << std::endl;
+    }
+    std::sort(total.commit_latencies_.begin(), total.commit_latencies_.end());
+    std::cout << "[COMMIT] p50 " << Percentile(total.commit_latencies_, 50) << " us, p99 "
+              << Percentile(total.commit_latencies_, 99) << " us, p99.9 " << Percentile(total.commit_latencies_, 99.9)
+              << " us" << std::endl;
+  }
+
+  /** Reports the latches and locks the run waited for the longest, and the rows it waited to lock the most. */
+  void ReportContention() const {
+    for (const ContentionStats &site : ContentionProfiler::Report()) {
+      std::cout << "[CONTENTION] " << site.name_ << ": waits " << site.waits_ << ", waited "
+                << static_cast<double>(site.wait_ns_) / 1000000 << " ms, mean " << site.MeanWaitNs() / 1000 << " us"
+                << std::endl;
+    }
+    for (const RowContention &row : lock_manager_->GetHotRids(5)) {
+      std::cout << "[HOT ROW] (" << row.rid_.GetPageId() << ", " << row.rid_.GetSlotNum() << "): waits " << row.waits_
+                << ", waited " << static_cast<double>(row.wait_ns_) / 1000000 << " ms" << std::endl;
+    }
+  }
+
+  const Options options_;
+  std::unique_ptr<DiskManager> disk_manager_;
+  std::unique_ptr<LogManager> log_manager_;
+  std::unique_ptr<ParallelBufferPoolManager> bpm_;
+  std::unique_ptr<LockManager> lock_manager_;
+  std::unique_ptr<TransactionManager> txn_mgr_;
+  std::unique_ptr<Catalog> catalog_;
+  std::unique_ptr<ExecutionEngine> engine_;
+  Table warehouse_;
+  Table district_;
+  Table customer_;
+  Table item_;
+  Table stock_;
+  Table orders_;
+  Table new_order_;
+  Table order_line_;
+  Table history_;
+  /** The index of the orders by customer, on O_C_KEY */
+  IndexInfo *customer_orders_{nullptr};
+};
+
+bool ParseOptions(int argc, char **argv, Options *options) {
+  for (int i = 1; i < argc; i++) {
+    std::string arg = argv[i];
+    size_t equals = arg.find('=');
+    if (arg.rfind("--", 0) != 0 || equals == std::string::npos) {
+      std::cerr << "bad argument " << arg << ", expected --name=value" << std::endl;
+      return false;
+    }
+    std::string name = arg.substr(2, equals - 2);
+    std::string value = arg.substr(equals + 1);
+    if (name == "warehouses") {
+      options->warehouses_ = std::stoll(value);
+    } else if (name == "customers") {
+      options->customers_ = std::stoll(value);
+    } else if (name == "items") {
+      options->items_ = std::stoll(value);
+    } else if (name == "threads") {
+      options->threads_ = std::stoull(value);
+    } else if (name == "seconds") {
+      options->seconds_ = std::stod(value);
+    } else if (name == "pool_frames") {
+      options->pool_frames_ = std::stoull(value);
+    } else if (name == "pool_instances") {
+      options->pool_instances_ = std::stoull(value);
+    } else if (name == "deadlock_policy") {
+      options->deadlock_policy_ = value;
+    } else if (name == "seed") {
+      options->seed_ = std::stoull(value);
+    } else if (name == "trace") {
+      options->trace_ = value;
+    } else {
+      std::cerr << "unknown option --" << name << std::endl;
+      return false;
+    }
+  }
+  if (options->deadlock_policy_ != "detection" && options->deadlock_policy_ != "wound_wait" &&
+      options->deadlock_policy_ != "wait_die") {
+    std::cerr << "--deadlock_policy is detection, wound_wait or wait_die" << std::endl;
+    return false;
+  }
+  if (options->warehouses_ < 1 || options->customers_ < 1 || options->items_ < 1 || options->threads_ == 0 ||
+      options->seconds_ <= 0 || options->pool_instances_ == 0 || options->pool_frames_ < options->pool_instances_) {
+    std::cerr << "--warehouses, --customers, --items, --threads, --seconds, --pool_frames and --pool_instances are "
+                 "positive"
+              << std::endl;
+    return false;
+  }
+  // the keys of the orders and their lines have to fit in a BIGINT
+  if (options->warehouses_ * DISTRICTS_PER_WAREHOUSE * options->customers_ >= (int64_t{1} << 30) ||
+      options->customers_ >= (int64_t{1} << 20) || options->items_ >= (int64_t{1} << 30)) {
+    std::cerr << "the scale is too large for the keys of the orders" << std::endl;
+    return false;
+  }
+  return true;
+}
+
+}  // namespace
+
+}  // namespace bustub
+
+int main(int argc, char **argv) {
+  bustub::Options options;
+  if (!bustub::ParseOptions(argc, argv, &options)) {
+    return 1;
+  }
+  std::cout << options.warehouses_ << " warehouses of " << options.customers_ << " customers per district and "
+            << options.items_ << " items, " << options.threads_ << " threads, " << options.pool_frames_
+            << " frames in " << options.pool_instances_ << " instances, " << options.deadlock_policy_ << std::endl;
+  bustub::Driver driver(options);
+  driver.Load();
+  driver.Run();
+  return 0;
+}
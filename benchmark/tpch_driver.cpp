@@ -0,0 +1,654 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// tpch_driver.cpp
+//
+// Identification: benchmark/tpch_driver.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+// Runs queries 1, 3, 5 and 6 of TPC-H against a scaled TPC-H database, as plan trees of the executors:
+//
+//   bustub_tpch --scale=0.1 --runs=5 --threads=4 --queries=1,6
+//
+// Q1 is a scan of lineitem into an aggregation of few groups, Q3 and Q5 are chains of hash joins under an aggregation,
+// the one into a top-10 and the other into a sort, and Q6 is a scan with a selective filter into a single sum. Every
+// query is run --runs times after a run that warms the buffer pool up, and the driver reports how many rows it returned
+// and its fastest, median and mean run times. The hash joins and the aggregations run on --threads threads.
+//
+// It is TPC-H-like rather than TPC-H: only the tables and the columns of the four queries are loaded, as the spec's
+// generator would fill them in distribution but not in content, dates are INTEGER days since 1992-01-01, and the plans
+// are the ones an optimizer would pick, written out by hand, the smaller side of every join being its left child.
+
+#include <algorithm>
+#include <chrono>  // NOLINT
+#include <cstdio>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "buffer/parallel_buffer_pool_manager.h"
+#include "catalog/catalog.h"
+#include "concurrency/transaction_manager.h"
+#include "execution/execution_engine.h"
+#include "execution/executor_context.h"
+#include "execution/expressions/aggregate_value_expression.h"
+#include "execution/expressions/arithmetic_expression.h"
+#include "execution/expressions/column_value_expression.h"
+#include "execution/expressions/comparison_expression.h"
+#include "execution/expressions/conjunction_expression.h"
+#include "execution/expressions/constant_value_expression.h"
+#include "execution/plans/aggregation_plan.h"
+#include "execution/plans/hash_join_plan.h"
+#include "execution/plans/insert_plan.h"
+#include "execution/plans/limit_plan.h"
+#include "execution/plans/seq_scan_plan.h"
+#include "execution/plans/sort_plan.h"
+#include "storage/disk/disk_manager.h"
+#include "type/value_factory.h"
+
+namespace bustub {
+
+namespace {
+
+struct Options {
+  double scale_{0.01};
+  size_t runs_{3};
+  size_t threads_{1};
+  size_t pool_frames_{16384};
+  size_t pool_instances_{1};
+  std::vector<int> queries_{1, 3, 5, 6};
+  uint64_t seed_{42};
+};
+
+/** The length of every VARCHAR column, the longest of the names of the nations */
+constexpr uint32_t NAME_LENGTH = 25;
+
+/** @return the day of a date, counted from 1992-01-01, the first of the orders */
+int32_t Date(int32_t year, int32_t month, int32_t day) {
+  // the days since 0000-03-01 of the civil calendar, whose leap day ends a year
+  auto days_from_civil = [](int32_t y, int32_t m, int32_t d) {
+    y -= m <= 2 ? 1 : 0;
+    int32_t era = y / 400;
+    int32_t year_of_era = y - era * 400;
+    int32_t day_of_year = (153 * (m + (m > 2 ? -3 : 9)) + 2) / 5 + d - 1;
+    return era * 146097 + year_of_era * 365 + year_of_era / 4 - year_of_era / 100 + day_of_year;
+  };
+  return days_from_civil(year, month, day) - days_from_civil(1992, 1, 1);
+}
+
+const char *const REGIONS[] = {"AFRICA", "AMERICA", "ASIA", "EUROPE", "MIDDLE EAST"};
+/** The nations of the spec, each with the region it is in */
+const std::pair<const char *, int32_t> NATIONS[] = {
+    {"ALGERIA", 0},      {"ARGENTINA", 1}, {"BRAZIL", 1},  {"CANADA", 1},       {"EGYPT", 4},
+    {"ETHIOPIA", 0},     {"FRANCE", 3},    {"GERMANY", 3}, {"INDIA", 2},        {"INDONESIA", 2},
+    {"IRAN", 4},         {"IRAQ", 4},      {"JAPAN", 2},   {"JORDAN", 4},       {"KENYA", 0},
+    {"MOROCCO", 0},      {"MOZAMBIQUE", 0}, {"PERU", 1},   {"CHINA", 2},        {"ROMANIA", 3},
+    {"SAUDI ARABIA", 4}, {"VIETNAM", 2},   {"RUSSIA", 3},  {"UNITED KINGDOM", 3}, {"UNITED STATES", 1}};
+const char *const SEGMENTS[] = {"AUTOMOBILE", "BUILDING", "FURNITURE", "HOUSEHOLD", "MACHINERY"};
+
+/**
+ * Owns the expressions, schemas and plan nodes of a query, which refer to each other by raw pointers, as the plans of
+ * the tests do; the columns are named after the schema they are read from.
+ */
+class PlanBuilder {
+ public:
+  /** @return the column of a schema, read from the left (0) or the right (1) tuple of a join */
+  const AbstractExpression *Col(const Schema &schema, const std::string &name, uint32_t tuple_idx = 0) {
+    uint32_t col_idx = schema.GetColIdx(name);
+    return Own(std::make_unique<ColumnValueExpression>(tuple_idx, col_idx, schema.GetColumn(col_idx).GetType()));
+  }
+
+  const AbstractExpression *Const(const Value &value) { return Own(std::make_unique<ConstantValueExpression>(value)); }
+
+  const AbstractExpression *Cmp(const AbstractExpression *left, const AbstractExpression *right, ComparisonType type) {
+    return Own(std::make_unique<ComparisonExpression>(left, right, type));
+  }
+
+  const AbstractExpression *And(std::vector<const AbstractExpression *> &&children) {
+    return Own(std::make_unique<ConjunctionExpression>(std::move(children)));
+  }
+
+  const AbstractExpression *Arith(const AbstractExpression *left, const AbstractExpression *right,
+                                  ArithmeticType type) {
+    return Own(std::make_unique<ArithmeticExpression>(left, right, type));
+  }
+
+  /** @return a group-by or an aggregate of an aggregation, for its output schema */
+  const AbstractExpression *Agg(bool is_group_by, uint32_t idx, TypeId type) {
+    return Own(std::make_unique<AggregateValueExpression>(is_group_by, idx, type));
+  }
+
+  /** @return a schema of named expressions, a VARCHAR one of NAME_LENGTH */
+  const Schema *Out(const std::vector<std::pair<std::string, const AbstractExpression *>> &columns) {
+    std::vector<Column> cols;
+    for (const auto &[name, expr] : columns) {
+      if (expr->GetReturnType() == TypeId::VARCHAR) {
+        cols.emplace_back(name, TypeId::VARCHAR, NAME_LENGTH, expr);
+      } else {
+        cols.emplace_back(name, expr->GetReturnType(), expr);
+      }
+    }
+    schemas_.push_back(std::make_unique<Schema>(cols));
+    return schemas_.back().get();
+  }
+
+  template <typename PlanType, typename... Args>
+  const PlanType *Plan(Args &&...args) {
+    auto plan = std::make_unique<PlanType>(std::forward<Args>(args)...);
+    const PlanType *raw = plan.get();
+    plans_.push_back(std::move(plan));
+    return raw;
+  }
+
+ private:
+  const AbstractExpression *Own(std::unique_ptr<AbstractExpression> expr) {
+    exprs_.push_back(std::move(expr));
+    return exprs_.back().get();
+  }
+
+  std::vector<std::unique_ptr<AbstractExpression>> exprs_;
+  std::vector<std::unique_ptr<Schema>> schemas_;
+  std::vector<std::unique_ptr<AbstractPlanNode>> plans_;
+};
+
+/** A query, with everything its plan refers to */
+struct Query {
+  int number_;
+  PlanBuilder builder_;
+  const AbstractPlanNode *plan_{nullptr};
+};
+
+class Driver {
+ public:
+  explicit Driver(const Options &options) : options_(options) {
+    disk_manager_ = std::make_unique<DiskManager>("tpch.db");
+    bpm_ = std::make_unique<ParallelBufferPoolManager>(
+        options.pool_instances_, options.pool_frames_ / options.pool_instances_, disk_manager_.get());
+    txn_mgr_ = std::make_unique<TransactionManager>(nullptr);
+    catalog_ = std::make_unique<Catalog>(bpm_.get(), nullptr, nullptr);
+    engine_ = std::make_unique<ExecutionEngine>(bpm_.get(), txn_mgr_.get(), catalog_.get());
+  }
+
+  ~Driver() {
+    engine_.reset();
+    catalog_.reset();
+    txn_mgr_.reset();
+    bpm_.reset();
+    disk_manager_.reset();
+    remove("tpch.db");
+    remove("tpch.log");
+  }
+
+  /** Creates the tables, and fills them as the spec's generator would at the scale. */
+  void Load() {
+    auto start = std::chrono::steady_clock::now();
+    std::mt19937_64 generator(options_.seed_);
+    auto uniform = [&](int64_t low, int64_t high) {
+      return std::uniform_int_distribution<int64_t>(low, high)(generator);
+    };
+    auto integer = [](int64_t value) { return ValueFactory::GetIntegerValue(static_cast<int32_t>(value)); };
+    auto decimal = [](double value) { return ValueFactory::GetDecimalValue(value); };
+    auto varchar = [](const std::string &value) { return ValueFactory::GetVarcharValue(value); };
+    Transaction *txn = txn_mgr_->Begin();
+    ExecutorContext exec_ctx(txn, catalog_.get(), bpm_.get(), txn_mgr_.get(), nullptr);
+    Loader loader(this, &exec_ctx);
+
+    auto num_suppliers = std::max<int64_t>(1, static_cast<int64_t>(10000 * options_.scale_));
+    auto num_customers = std::max<int64_t>(1, static_cast<int64_t>(150000 * options_.scale_));
+    auto num_orders = std::max<int64_t>(1, static_cast<int64_t>(1500000 * options_.scale_));
+    const int32_t current_date = Date(1995, 6, 17);
+    const int32_t last_order_date = Date(1998, 12, 31) - 151;
+
+    TableMetadata *region = CreateTable(txn, "region", {{"r_regionkey", TypeId::INTEGER}, {"r_name", TypeId::VARCHAR}});
+    for (int32_t r = 0; r < 5; r++) {
+      loader.Add(region, {integer(r), varchar(REGIONS[r])});
+    }
+    TableMetadata *nation = CreateTable(
+        txn, "nation",
+        {{"n_nationkey", TypeId::INTEGER}, {"n_name", TypeId::VARCHAR}, {"n_regionkey", TypeId::INTEGER}});
+    for (int32_t n = 0; n < 25; n++) {
+      loader.Add(nation, {integer(n), varchar(NATIONS[n].first), integer(NATIONS[n].second)});
+    }
+    TableMetadata *supplier = CreateTable(
+        txn, "supplier",
+        {{"s_suppkey", TypeId::INTEGER}, {"s_nationkey", TypeId::INTEGER}, {"s_acctbal", TypeId::DECIMAL}});
+    for (int64_t s = 0; s < num_suppliers; s++) {
+      loader.Add(supplier,
+                 {integer(s), integer(uniform(0, 24)), decimal(static_cast<double>(uniform(-99999, 999999)) / 100)});
+    }
+    TableMetadata *customer = CreateTable(
+        txn, "customer",
+        {{"c_custkey", TypeId::INTEGER}, {"c_mktsegment", TypeId::VARCHAR}, {"c_nationkey", TypeId::INTEGER}});
+    for (int64_t c = 0; c < num_customers; c++) {
+      loader.Add(customer, {integer(c), varchar(SEGMENTS[uniform(0, 4)]), integer(uniform(0, 24))});
+    }
+    TableMetadata *orders = CreateTable(txn, "orders",
+                                        {{"o_orderkey", TypeId::INTEGER},
+                                         {"o_custkey", TypeId::INTEGER},
+                                         {"o_orderdate", TypeId::INTEGER},
+                                         {"o_shippriority", TypeId::INTEGER}});
+    TableMetadata *lineitem = CreateTable(txn, "lineitem",
+                                          {{"l_orderkey", TypeId::INTEGER},
+                                           {"l_suppkey", TypeId::INTEGER},
+                                           {"l_quantity", TypeId::DECIMAL},
+                                           {"l_extendedprice", TypeId::DECIMAL},
+                                           {"l_discount", TypeId::DECIMAL},
+                                           {"l_tax", TypeId::DECIMAL},
+                                           {"l_returnflag", TypeId::VARCHAR},
+                                           {"l_linestatus", TypeId::VARCHAR},
+                                           {"l_shipdate", TypeId::INTEGER}});
+    for (int64_t o = 0; o < num_orders; o++) {
+      auto order_date = static_cast<int32_t>(uniform(0, last_order_date));
+      loader.Add(orders, {integer(o), integer(uniform(0, num_customers - 1)), integer(order_date), integer(0)});
+      int64_t lines = uniform(1, 7);
+      for (int64_t line = 0; line < lines; line++) {
+        int64_t quantity = uniform(1, 50);
+        double price = static_cast<double>(uniform(90000, 200000)) / 100;
+        int64_t ship_date = order_date + uniform(1, 121);
+        int64_t receipt_date = ship_date + uniform(1, 30);
+        std::string return_flag = receipt_date <= current_date ? (uniform(0, 1) == 0 ? "R" : "A") : "N";
+        loader.Add(lineitem, {integer(o), integer(uniform(0, num_suppliers - 1)),
+                              decimal(static_cast<double>(quantity)), decimal(static_cast<double>(quantity) * price),
+                              decimal(static_cast<double>(uniform(0, 10)) / 100),
+                              decimal(static_cast<double>(uniform(0, 8)) / 100), varchar(return_flag),
+                              varchar(ship_date > current_date ? "O" : "F"), integer(ship_date)});
+      }
+    }
+    loader.Flush();
+    txn_mgr_->Commit(txn);
+    txn_mgr_->Release(txn);
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "[LOAD] scale " << options_.scale_ << ", " << loader.rows_ << " rows in " << seconds << " s"
+              << std::endl;
+  }
+
+  /** Runs each of the queries, a run to warm up and then --runs timed ones, and reports their times. */
+  void Run() {
+    for (int number : options_.queries_) {
+      Query query;
+      query.number_ = number;
+      switch (number) {
+        case 1:
+          BuildQ1(&query);
+          break;
+        case 3:
+          BuildQ3(&query);
+          break;
+        case 5:
+          BuildQ5(&query);
+          break;
+        default:
+          BuildQ6(&query);
+          break;
+      }
+      size_t peak_bytes = 0;
+      size_t rows = RunQuery(query, &peak_bytes);
+      std::vector<double> times;
+      for (size_t run = 0; run < options_.runs_; run++) {
+        auto start = std::chrono::steady_clock::now();
+        RunQuery(query, nullptr);
+        times.push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+      }
+      std::sort(times.begin(), times.end());
+      double mean = 0;
+      for (double time : times) {
+        mean += time / static_cast<double>(times.size());
+      }
+      std::cout << std::fixed << std::setprecision(2) << "[Q" << number << "] " << rows << " rows, min " << times[0]
+                << " ms, median " << times[times.size() / 2] << " ms, mean " << mean << " ms over " << times.size()
+                << " runs, peak memory " << static_cast<double>(peak_bytes) / (1024 * 1024) << " MiB" << std::endl;
+    }
+  }
+
+ private:
+  /** Collects the rows of the load into raw inserts of a batch of rows each, which the engine runs. */
+  class Loader {
+   public:
+    Loader(Driver *driver, ExecutorContext *exec_ctx) : driver_(driver), exec_ctx_(exec_ctx) {}
+
+    void Add(TableMetadata *table, std::vector<Value> &&row) {
+      auto &batch = batches_[table->oid_];
+      batch.push_back(std::move(row));
+      rows_++;
+      if (batch.size() == BATCH_SIZE) {
+        Insert(table->oid_, &batch);
+      }
+    }
+
+    void Flush() {
+      for (auto &[oid, batch] : batches_) {
+        Insert(oid, &batch);
+      }
+    }
+
+    uint64_t rows_{0};
+
+   private:
+    static constexpr size_t BATCH_SIZE = 1024;
+
+    void Insert(table_oid_t oid, std::vector<std::vector<Value>> *batch) {
+      if (batch->empty()) {
+        return;
+      }
+      InsertPlanNode plan(std::move(*batch), oid);
+      driver_->engine_->Execute(&plan, nullptr, exec_ctx_->GetTransaction(), exec_ctx_);
+      batch->clear();
+    }
+
+    Driver *driver_;
+    ExecutorContext *exec_ctx_;
+    std::map<table_oid_t, std::vector<std::vector<Value>>> batches_;
+  };
+
+  TableMetadata *CreateTable(Transaction *txn, const std::string &name,
+                             const std::vector<std::pair<std::string, TypeId>> &defs) {
+    std::vector<Column> columns;
+    for (const auto &[column, type] : defs) {
+      if (type == TypeId::VARCHAR) {
+        columns.emplace_back(column, type, NAME_LENGTH);
+      } else {
+        columns.emplace_back(column, type);
+      }
+    }
+    return catalog_->CreateTable(txn, name, Schema(columns));
+  }
+
+  /** @return a scan of a table that outputs the named columns of the rows the predicate holds for */
+  const AbstractPlanNode *Scan(PlanBuilder *b, const std::string &table, const std::vector<std::string> &columns,
+                               const AbstractExpression *predicate = nullptr) {
+    TableMetadata *info = catalog_->GetTable(table);
+    std::vector<std::pair<std::string, const AbstractExpression *>> outputs;
+    for (const std::string &column : columns) {
+      outputs.emplace_back(column, b->Col(info->schema_, column));
+    }
+    return b->Plan<SeqScanPlanNode>(b->Out(outputs), predicate, info->oid_);
+  }
+
+  /**
+   * @return a hash join of the children on a key of each, the left the build side, that outputs the named columns of
+   * either
+   */
+  const AbstractPlanNode *Join(PlanBuilder *b, const AbstractPlanNode *left, const AbstractPlanNode *right,
+                               std::vector<std::pair<std::string, std::string>> &&keys,
+                               const std::vector<std::string> &left_columns,
+                               const std::vector<std::string> &right_columns) {
+    const Schema &left_schema = *left->OutputSchema();
+    const Schema &right_schema = *right->OutputSchema();
+    std::vector<const AbstractExpression *> left_keys;
+    std::vector<const AbstractExpression *> right_keys;
+    for (const auto &[left_key, right_key] : keys) {
+      left_keys.push_back(b->Col(left_schema, left_key));
+      right_keys.push_back(b->Col(right_schema, right_key));
+    }
+    std::vector<std::pair<std::string, const AbstractExpression *>> outputs;
+    for (const std::string &column : left_columns) {
+      outputs.emplace_back(column, b->Col(left_schema, column, 0));
+    }
+    for (const std::string &column : right_columns) {
+      outputs.emplace_back(column, b->Col(right_schema, column, 1));
+    }
+    return b->Plan<HashJoinPlanNode>(b->Out(outputs), std::vector<const AbstractPlanNode *>{left, right},
+                                     std::move(left_keys), std::move(right_keys), options_.threads_);
+  }
+
+  /** @return l_extendedprice * (1 - l_discount), of a schema with both */
+  static const AbstractExpression *Revenue(PlanBuilder *b, const Schema &schema) {
+    return b->Arith(b->Col(schema, "l_extendedprice"),
+                    b->Arith(b->Const(ValueFactory::GetDecimalValue(1)), b->Col(schema, "l_discount"),
+                             ArithmeticType::Minus),
+                    ArithmeticType::Multiply);
+  }
+
+  /** The pricing summary report: the lines shipped by 90 days before the last day, summed up by flag and status. */
+  void BuildQ1(Query *query) {
+    PlanBuilder *b = &query->builder_;
+    const Schema &lineitem = catalog_->GetTable("lineitem")->schema_;
+    const AbstractPlanNode *scan =
+        Scan(b, "lineitem",
+             {"l_returnflag", "l_linestatus", "l_quantity", "l_extendedprice", "l_discount", "l_tax"},
+             b->Cmp(b->Col(lineitem, "l_shipdate"), b->Const(ValueFactory::GetIntegerValue(Date(1998, 12, 1) - 90)),
+                    ComparisonType::LessThanOrEqual));
+    const Schema &in = *scan->OutputSchema();
+    const AbstractExpression *disc_price = Revenue(b, in);
+    const AbstractExpression *charge = b->Arith(
+        disc_price, b->Arith(b->Const(ValueFactory::GetDecimalValue(1)), b->Col(in, "l_tax"), ArithmeticType::Plus),
+        ArithmeticType::Multiply);
+    auto sum = [b](uint32_t idx) { return b->Agg(false, idx, TypeId::DECIMAL); };
+    const AbstractExpression *count = b->Agg(false, 5, TypeId::INTEGER);
+    const Schema *out = b->Out({{"l_returnflag", b->Agg(true, 0, TypeId::VARCHAR)},
+                                {"l_linestatus", b->Agg(true, 1, TypeId::VARCHAR)},
+                                {"sum_qty", sum(0)},
+                                {"sum_base_price", sum(1)},
+                                {"sum_disc_price", sum(2)},
+                                {"sum_charge", sum(3)},
+                                {"avg_qty", b->Arith(sum(0), count, ArithmeticType::Divide)},
+                                {"avg_price", b->Arith(sum(1), count, ArithmeticType::Divide)},
+                                {"avg_disc", b->Arith(sum(4), count, ArithmeticType::Divide)},
+                                {"count_order", count}});
+    const AbstractPlanNode *agg = b->Plan<AggregationPlanNode>(
+        out, scan, nullptr,
+        std::vector<const AbstractExpression *>{b->Col(in, "l_returnflag"), b->Col(in, "l_linestatus")},
+        std::vector<const AbstractExpression *>{b->Col(in, "l_quantity"), b->Col(in, "l_extendedprice"), disc_price,
+                                                charge, b->Col(in, "l_discount"), b->Col(in, "l_quantity")},
+        std::vector<AggregationType>{AggregationType::SumAggregate, AggregationType::SumAggregate,
+                                     AggregationType::SumAggregate, AggregationType::SumAggregate,
+                                     AggregationType::SumAggregate, AggregationType::CountAggregate},
+        options_.threads_);
+    query->plan_ = b->Plan<SortPlanNode>(
+        out, agg,
+        std::vector<std::pair<OrderByType, const AbstractExpression *>>{
+            {OrderByType::ASC, b->Col(*out, "l_returnflag")}, {OrderByType::ASC, b->Col(*out, "l_linestatus")}});
+  }
+
+  /** The shipping priority: the ten unshipped orders of the BUILDING segment of the most revenue on 1995-03-15. */
+  void BuildQ3(Query *query) {
+    PlanBuilder *b = &query->builder_;
+    const Value date = ValueFactory::GetIntegerValue(Date(1995, 3, 15));
+    const AbstractPlanNode *customer =
+        Scan(b, "customer", {"c_custkey"},
+             b->Cmp(b->Col(catalog_->GetTable("customer")->schema_, "c_mktsegment"),
+                    b->Const(ValueFactory::GetVarcharValue("BUILDING")), ComparisonType::Equal));
+    const AbstractPlanNode *orders =
+        Scan(b, "orders", {"o_orderkey", "o_custkey", "o_orderdate", "o_shippriority"},
+             b->Cmp(b->Col(catalog_->GetTable("orders")->schema_, "o_orderdate"), b->Const(date),
+                    ComparisonType::LessThan));
+    const AbstractPlanNode *lineitem =
+        Scan(b, "lineitem", {"l_orderkey", "l_extendedprice", "l_discount"},
+             b->Cmp(b->Col(catalog_->GetTable("lineitem")->schema_, "l_shipdate"), b->Const(date),
+                    ComparisonType::GreaterThan));
+    const AbstractPlanNode *customer_orders = Join(b, customer, orders, {{"c_custkey", "o_custkey"}}, {},
+                                                   {"o_orderkey", "o_orderdate", "o_shippriority"});
+    const AbstractPlanNode *lines =
+        Join(b, customer_orders, lineitem, {{"o_orderkey", "l_orderkey"}}, {"o_orderdate", "o_shippriority"},
+             {"l_orderkey", "l_extendedprice", "l_discount"});
+    const Schema &in = *lines->OutputSchema();
+    const Schema *out = b->Out({{"l_orderkey", b->Agg(true, 0, TypeId::INTEGER)},
+                                {"revenue", b->Agg(false, 0, TypeId::DECIMAL)},
+                                {"o_orderdate", b->Agg(true, 1, TypeId::INTEGER)},
+                                {"o_shippriority", b->Agg(true, 2, TypeId::INTEGER)}});
+    const AbstractPlanNode *agg = b->Plan<AggregationPlanNode>(
+        out, lines, nullptr,
+        std::vector<const AbstractExpression *>{b->Col(in, "l_orderkey"), b->Col(in, "o_orderdate"),
+                                                b->Col(in, "o_shippriority")},
+        std::vector<const AbstractExpression *>{Revenue(b, in)},
+        std::vector<AggregationType>{AggregationType::SumAggregate}, options_.threads_);
+    const AbstractPlanNode *sort = b->Plan<SortPlanNode>(
+        out, agg,
+        std::vector<std::pair<OrderByType, const AbstractExpression *>>{
+            {OrderByType::DESC, b->Col(*out, "revenue")}, {OrderByType::ASC, b->Col(*out, "o_orderdate")}});
+    query->plan_ = b->Plan<LimitPlanNode>(out, sort, 10, 0);
+  }
+
+  /** The local supplier volume: the revenue of 1994 in ASIA of the lines whose customer and supplier share a nation. */
+  void BuildQ5(Query *query) {
+    PlanBuilder *b = &query->builder_;
+    const Schema &orders_schema = catalog_->GetTable("orders")->schema_;
+    const AbstractPlanNode *region =
+        Scan(b, "region", {"r_regionkey"},
+             b->Cmp(b->Col(catalog_->GetTable("region")->schema_, "r_name"),
+                    b->Const(ValueFactory::GetVarcharValue("ASIA")), ComparisonType::Equal));
+    const AbstractPlanNode *nation = Scan(b, "nation", {"n_nationkey", "n_name", "n_regionkey"});
+    const AbstractPlanNode *supplier = Scan(b, "supplier", {"s_suppkey", "s_nationkey"});
+    const AbstractPlanNode *customer = Scan(b, "customer", {"c_custkey", "c_nationkey"});
+    const AbstractPlanNode *orders = Scan(
+        b, "orders", {"o_orderkey", "o_custkey"},
+        b->And({b->Cmp(b->Col(orders_schema, "o_orderdate"), b->Const(ValueFactory::GetIntegerValue(Date(1994, 1, 1))),
+                       ComparisonType::GreaterThanOrEqual),
+                b->Cmp(b->Col(orders_schema, "o_orderdate"), b->Const(ValueFactory::GetIntegerValue(Date(1995, 1, 1))),
+                       ComparisonType::LessThan)}));
+    const AbstractPlanNode *lineitem =
+        Scan(b, "lineitem", {"l_orderkey", "l_suppkey", "l_extendedprice", "l_discount"});
+
+    // the suppliers of the region, with the names of their nations
+    const AbstractPlanNode *nations =
+        Join(b, region, nation, {{"r_regionkey", "n_regionkey"}}, {}, {"n_nationkey", "n_name"});
+    const AbstractPlanNode *suppliers =
+        Join(b, nations, supplier, {{"n_nationkey", "s_nationkey"}}, {"n_name"}, {"s_suppkey", "s_nationkey"});
+    // the lines of the orders of the year, with the nations of their customers
+    const AbstractPlanNode *customer_orders =
+        Join(b, customer, orders, {{"c_custkey", "o_custkey"}}, {"c_nationkey"}, {"o_orderkey"});
+    const AbstractPlanNode *lines = Join(b, customer_orders, lineitem, {{"o_orderkey", "l_orderkey"}}, {"c_nationkey"},
+                                         {"l_suppkey", "l_extendedprice", "l_discount"});
+    const AbstractPlanNode *local =
+        Join(b, suppliers, lines, {{"s_suppkey", "l_suppkey"}, {"s_nationkey", "c_nationkey"}}, {"n_name"},
+             {"l_extendedprice", "l_discount"});
+    const Schema &in = *local->OutputSchema();
+    const Schema *out =
+        b->Out({{"n_name", b->Agg(true, 0, TypeId::VARCHAR)}, {"revenue", b->Agg(false, 0, TypeId::DECIMAL)}});
+    const AbstractPlanNode *agg = b->Plan<AggregationPlanNode>(
+        out, local, nullptr, std::vector<const AbstractExpression *>{b->Col(in, "n_name")},
+        std::vector<const AbstractExpression *>{Revenue(b, in)},
+        std::vector<AggregationType>{AggregationType::SumAggregate}, options_.threads_);
+    query->plan_ = b->Plan<SortPlanNode>(
+        out, agg,
+        std::vector<std::pair<OrderByType, const AbstractExpression *>>{{OrderByType::DESC, b->Col(*out, "revenue")}});
+  }
+
+  /** The forecasting revenue change: the discounts of 1994 on small quantities of 6% give or take a point. */
+  void BuildQ6(Query *query) {
+    PlanBuilder *b = &query->builder_;
+    const Schema &lineitem = catalog_->GetTable("lineitem")->schema_;
+    auto decimal = [b](double value) { return b->Const(ValueFactory::GetDecimalValue(value)); };
+    auto date = [b](int32_t value) { return b->Const(ValueFactory::GetIntegerValue(value)); };
+    const AbstractExpression *predicate = b->And({
+        b->Cmp(b->Col(lineitem, "l_shipdate"), date(Date(1994, 1, 1)), ComparisonType::GreaterThanOrEqual),
+        b->Cmp(b->Col(lineitem, "l_shipdate"), date(Date(1995, 1, 1)), ComparisonType::LessThan),
+        b->Cmp(b->Col(lineitem, "l_discount"), decimal(5.0 / 100), ComparisonType::GreaterThanOrEqual),
+        b->Cmp(b->Col(lineitem, "l_discount"), decimal(7.0 / 100), ComparisonType::LessThanOrEqual),
+        b->Cmp(b->Col(lineitem, "l_quantity"), decimal(24), ComparisonType::LessThan),
+    });
+    const AbstractPlanNode *scan = Scan(b, "lineitem", {"l_extendedprice", "l_discount"}, predicate);
+    const Schema &in = *scan->OutputSchema();
+    query->plan_ = b->Plan<AggregationPlanNode>(
+        b->Out({{"revenue", b->Agg(false, 0, TypeId::DECIMAL)}}), scan, nullptr,
+        std::vector<const AbstractExpression *>{},
+        std::vector<const AbstractExpression *>{
+            b->Arith(b->Col(in, "l_extendedprice"), b->Col(in, "l_discount"), ArithmeticType::Multiply)},
+        std::vector<AggregationType>{AggregationType::SumAggregate}, options_.threads_);
+  }
+
+  /**
+   * @param[out] peak_bytes the most memory the query's operators and arena held at once, if not nullptr
+   * @return the number of rows of a run of the query, each in a transaction of its own
+   */
+  size_t RunQuery(const Query &query, size_t *peak_bytes) {
+    Transaction *txn = txn_mgr_->Begin();
+    std::vector<Tuple> result;
+    {
+      ExecutorContext exec_ctx(txn, catalog_.get(), bpm_.get(), txn_mgr_.get(), nullptr);
+      engine_->Execute(query.plan_, &result, txn, &exec_ctx);
+      if (peak_bytes != nullptr) {
+        *peak_bytes = exec_ctx.GetMemoryTracker()->GetPeakTotal();
+      }
+    }
+    txn_mgr_->Commit(txn);
+    txn_mgr_->Release(txn);
+    return result.size();
+  }
+
+  const Options options_;
+  std::unique_ptr<DiskManager> disk_manager_;
+  std::unique_ptr<ParallelBufferPoolManager> bpm_;
+  std::unique_ptr<TransactionManager> txn_mgr_;
+  std::unique_ptr<Catalog> catalog_;
+  std::unique_ptr<ExecutionEngine> engine_;
+};
+
+bool ParseOptions(int argc, char **argv, Options *options) {
+  for (int i = 1; i < argc; i++) {
+    std::string arg = argv[i];
+    size_t equals = arg.find('=');
+    if (arg.rfind("--", 0) != 0 || equals == std::string::npos) {
+      std::cerr << "bad argument " << arg << ", expected --name=value" << std::endl;
+      return false;
+    }
+    std::string name = arg.substr(2, equals - 2);
+    std::string value = arg.substr(equals + 1);
+    if (name == "scale") {
+      options->scale_ = std::stod(value);
+    } else if (name == "runs") {
+      options->runs_ = std::stoull(value);
+    } else if (name == "threads") {
+      options->threads_ = std::stoull(value);
+    } else if (name == "pool_frames") {
+      options->pool_frames_ = std::stoull(value);
+    } else if (name == "pool_instances") {
+      options->pool_instances_ = std::stoull(value);
+    } else if (name == "queries") {
+      options->queries_.clear();
+      std::stringstream queries(value);
+      std::string query;
+      while (std::getline(queries, query, ',')) {
+        int number = std::stoi(query);
+        if (number != 1 && number != 3 && number != 5 && number != 6) {
+          std::cerr << "--queries is a list of 1, 3, 5 and 6" << std::endl;
+          return false;
+        }
+        options->queries_.push_back(number);
+      }
+    } else if (name == "seed") {
+      options->seed_ = std::stoull(value);
+    } else {
+      std::cerr << "unknown option --" << name << std::endl;
+      return false;
+    }
+  }
+  if (options->scale_ <= 0 || options->runs_ == 0 || options->threads_ == 0 || options->pool_instances_ == 0 ||
+      options->pool_frames_ < options->pool_instances_ || options->queries_.empty()) {
+    std::cerr << "--scale, --runs, --threads, --pool_frames, --pool_instances and --queries are positive" << std::endl;
+    return false;
+  }
+  // the keys of the orders are INTEGERs
+  if (options->scale_ > 1000) {
+    std::cerr << "the scale is too large for the keys of the orders" << std::endl;
+    return false;
+  }
+  return true;
+}
+
+}  // namespace
+
+}  // namespace bustub
+
+int main(int argc, char **argv) {
+  bustub::Options options;
+  if (!bustub::ParseOptions(argc, argv, &options)) {
+    return 1;
+  }
+  std::cout << "scale " << options.scale_ << ", " << options.runs_ << " runs, " << options.threads_ << " threads, "
+            << options.pool_frames_ << " frames in " << options.pool_instances_ << " instances" << std::endl;
+  bustub::Driver driver(options);
+  driver.Load();
+  driver.Run();
+  return 0;
+}
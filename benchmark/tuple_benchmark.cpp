@@ -0,0 +1,66 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// tuple_benchmark.cpp
+//
+// Identification: benchmark/tuple_benchmark.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <string>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "catalog/schema.h"
+#include "storage/table/tuple.h"
+
+namespace bustub {
+
+namespace {
+
+/** A row of a few fixed-length columns and a VARCHAR, which the benchmarks fill with state.range(0) characters */
+Schema MakeSchema() {
+  return Schema({Column("id", TypeId::INTEGER), Column("count", TypeId::BIGINT), Column("price", TypeId::DECIMAL),
+                 Column("name", TypeId::VARCHAR, 1024)});
+}
+
+Tuple MakeTuple(const Schema &schema, size_t varchar_length) {
+  return Tuple({Value(TypeId::INTEGER, 42), Value(TypeId::BIGINT, int64_t{1} << 40), Value(TypeId::DECIMAL, 3.25),
+                Value(TypeId::VARCHAR, std::string(varchar_length, 'x'))},
+               &schema);
+}
+
+}  // namespace
+
+/** Writes a tuple out as it is stored, its length first. */
+void BM_TupleSerialize(benchmark::State &state) {  // NOLINT
+  Schema schema = MakeSchema();
+  Tuple tuple = MakeTuple(schema, static_cast<size_t>(state.range(0)));
+  std::vector<char> storage(sizeof(int32_t) + tuple.GetLength());
+  for (auto _ : state) {
+    tuple.SerializeTo(storage.data());
+    benchmark::ClobberMemory();
+  }
+  state.SetBytesProcessed(state.iterations() * tuple.GetLength());
+}
+BENCHMARK(BM_TupleSerialize)->ArgName("varchar")->Arg(8)->Arg(64)->Arg(512);
+
+/** Reads a stored tuple back into a tuple of its own. */
+void BM_TupleDeserialize(benchmark::State &state) {  // NOLINT
+  Schema schema = MakeSchema();
+  Tuple tuple = MakeTuple(schema, static_cast<size_t>(state.range(0)));
+  std::vector<char> storage(sizeof(int32_t) + tuple.GetLength());
+  tuple.SerializeTo(storage.data());
+  for (auto _ : state) {
+    Tuple copy;
+    copy.DeserializeFrom(storage.data());
+    benchmark::DoNotOptimize(copy.GetData());
+  }
+  state.SetBytesProcessed(state.iterations() * tuple.GetLength());
+}
+BENCHMARK(BM_TupleDeserialize)->ArgName("varchar")->Arg(8)->Arg(64)->Arg(512);
+
+}  // namespace bustub
@@ -0,0 +1,432 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// ycsb_driver.cpp
+//
+// Identification: benchmark/ycsb_driver.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+// Runs the core workloads A-F of YCSB (Cooper et al., SoCC 2010) against an index, through the Index interface:
+//
+//   bustub_ycsb --index=bplus --workload=A --records=1000000 --operations=1000000 --threads=8 --pool_frames=4096
+//
+// The load phase inserts the records, the run phase runs the operations of the workload spread over the threads, and
+// the driver reports the throughput of each phase and the p50/p99/p99.9 latencies of each kind of operation. A pool
+// of fewer frames than the index has pages forces I/O. A record is an entry of the index, from its key to a RID that
+// an update replaces; the keys are hashes of the record numbers, so that inserts land all over the key space.
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <chrono>  // NOLINT
+#include <cmath>
+#include <cstdio>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <random>
+#include <string>
+#include <thread>  // NOLINT
+#include <unordered_map>
+#include <vector>
+
+#include "buffer/parallel_buffer_pool_manager.h"
+#include "catalog/schema.h"
+#include "storage/disk/disk_manager.h"
+#include "storage/index/b_plus_tree_index.h"
+#include "storage/index/linear_probe_hash_table_index.h"
+
+namespace bustub {
+
+namespace {
+
+using KeyType = GenericKey<8>;
+using BPlusIndex = BPlusTreeIndex<KeyType, RID, GenericComparator<8>>;
+using HashIndex = LinearProbeHashTableIndex<KeyType, RID, GenericComparator<8>>;
+
+enum class Operation { READ, UPDATE, INSERT, SCAN, READ_MODIFY_WRITE };
+constexpr size_t NUM_OPERATIONS = 5;
+const char *const OPERATION_NAMES[NUM_OPERATIONS] = {"READ", "UPDATE", "INSERT", "SCAN", "READ_MODIFY_WRITE"};
+
+/** The proportions of the operations of a workload, in the order of Operation, and how it picks the keys it reads */
+struct Workload {
+  double proportions_[NUM_OPERATIONS];
+  /** Whether reads go to the records inserted last rather than to those of the key distribution */
+  bool latest_;
+};
+
+/** The core workloads of YCSB */
+const std::unordered_map<char, Workload> WORKLOADS = {
+    {'A', {{0.50, 0.50, 0, 0, 0}, false}},  // update heavy
+    {'B', {{0.95, 0.05, 0, 0, 0}, false}},  // read mostly
+    {'C', {{1.00, 0, 0, 0, 0}, false}},     // read only
+    {'D', {{0.95, 0, 0.05, 0, 0}, true}},   // read latest
+    {'E', {{0, 0, 0.05, 0.95, 0}, false}},  // short ranges
+    {'F', {{0.50, 0, 0, 0, 0.50}, false}},  // read-modify-write
+};
+
+struct Options {
+  std::string index_{"bplus"};
+  char workload_{'A'};
+  uint64_t records_{100000};
+  uint64_t operations_{1000000};
+  size_t threads_{1};
+  size_t pool_frames_{4096};
+  size_t pool_instances_{1};
+  std::string distribution_{"zipfian"};
+  double zipfian_theta_{0.99};
+  uint64_t max_scan_length_{100};
+  uint64_t seed_{42};
+  /** The file to record the page accesses of the run in, none if empty */
+  std::string page_trace_;
+};
+
+/** @return the 64-bit FNV-1a hash of a number, which YCSB scrambles its keys with */
+uint64_t Fnv1a(uint64_t value) {
+  uint64_t hash = 0xCBF29CE484222325ULL;
+  for (int i = 0; i < 8; i++) {
+    hash ^= value & 0xFF;
+    hash *= 0x100000001B3ULL;
+    value >>= 8;
+  }
+  return hash;
+}
+
+/** @return the key of a record */
+int64_t KeyOf(uint64_t record) { return static_cast<int64_t>(Fnv1a(record) & INT64_MAX); }
+
+/** @return the RID of a version of a record, which an update of the record replaces with that of the next one */
+RID RidOf(uint64_t record, uint32_t version) { return RID(static_cast<page_id_t>(record & INT32_MAX), version); }
+
+/**
+ * The zipfian distribution over the items 0, ..., n - 1 of Gray et al. (SIGMOD 1994), as YCSB draws it: item 0 is the
+ * most popular, and theta says how skewed it is. The zeta constant takes O(n) to compute, once.
+ */
+class ZipfianGenerator {
+ public:
+  ZipfianGenerator(uint64_t num_items, double theta) : num_items_(num_items), theta_(theta) {
+    double zeta_2 = 1 + std::pow(0.5, theta);
+    zeta_n_ = 0;
+    for (uint64_t i = 1; i <= num_items; i++) {
+      zeta_n_ += 1 / std::pow(static_cast<double>(i), theta);
+    }
+    alpha_ = 1 / (1 - theta);
+    eta_ = (1 - std::pow(2.0 / static_cast<double>(num_items), 1 - theta)) / (1 - zeta_2 / zeta_n_);
+  }
+
+  uint64_t Next(std::mt19937_64 *generator) const {
+    double u = std::uniform_real_distribution<double>(0, 1)(*generator);
+    double uz = u * zeta_n_;
+    if (uz < 1) {
+      return 0;
+    }
+    if (uz < 1 + std::pow(0.5, theta_)) {
+      return 1;
+    }
+    auto item = static_cast<uint64_t>(static_cast<double>(num_items_) * std::pow(eta_ * u - eta_ + 1, alpha_));
+    return std::min(item, num_items_ - 1);
+  }
+
+ private:
+  uint64_t num_items_;
+  double theta_;
+  double zeta_n_;
+  double alpha_;
+  double eta_;
+};
+
+/** The latencies of the operations of a kind, in nanoseconds */
+using Latencies = std::vector<uint64_t>;
+
+/** @return a latency percentile of sorted latencies, in microseconds */
+double Percentile(const Latencies &sorted, double percentile) {
+  if (sorted.empty()) {
+    return 0;
+  }
+  auto rank = static_cast<size_t>(std::ceil(percentile / 100 * static_cast<double>(sorted.size())));
+  return static_cast<double>(sorted[std::max<size_t>(rank, 1) - 1]) / 1000;
+}
+
+class Driver {
+ public:
+  explicit Driver(const Options &options)
+      : options_(options),
+        workload_(WORKLOADS.at(options.workload_)),
+        zipfian_(options.records_, options.zipfian_theta_),
+        key_schema_(std::vector<Column>{Column("key", TypeId::BIGINT)}),
+        key_locks_(1024) {
+    disk_manager_ = std::make_unique<DiskManager>("ycsb.db");
+    bpm_ = std::make_unique<ParallelBufferPoolManager>(options.pool_instances_,
+                                                       options.pool_frames_ / options.pool_instances_,
+                                                       disk_manager_.get());
+    // the B+ tree records its root in the header page, page 0
+    page_id_t header_page_id;
+    bpm_->NewPage(&header_page_id);
+    bpm_->UnpinPage(header_page_id, true);
+    auto *metadata = new IndexMetadata("ycsb_idx", "usertable", &key_schema_, {0});
+    if (options.index_ == "bplus") {
+      bplus_index_ = new BPlusIndex(metadata, bpm_.get());
+      index_.reset(bplus_index_);
+    } else {
+      index_ = std::make_unique<HashIndex>(metadata, bpm_.get(), options.records_, HashFunction<KeyType>());
+    }
+  }
+
+  ~Driver() {
+    index_.reset();
+    bpm_.reset();
+    disk_manager_.reset();
+    remove("ycsb.db");
+    remove("ycsb.log");
+  }
+
+  /** Inserts the records, spread over the threads. */
+  void Load() {
+    auto start = std::chrono::steady_clock::now();
+    RunThreads([&](size_t thread) {
+      for (uint64_t record = thread; record < options_.records_; record += options_.threads_) {
+        index_->InsertEntry(KeyTuple(KeyOf(record)), RidOf(record, 0), nullptr);
+      }
+    });
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    next_record_ = options_.records_;
+    inserted_ = options_.records_;
+    std::cout << "[LOAD] " << options_.records_ << " records in " << seconds << " s, "
+              << static_cast<double>(options_.records_) / seconds << " ops/s" << std::endl;
+  }
+
+  /** Runs the operations of the workload, spread over the threads, and reports their latencies. */
+  void Run() {
+    std::vector<std::vector<Latencies>> latencies(options_.threads_, std::vector<Latencies>(NUM_OPERATIONS));
+    BufferPoolStats before = bpm_->GetStats();
+    if (!options_.page_trace_.empty() && !disk_manager_->StartPageTrace(options_.page_trace_)) {
+      std::cerr << "cannot write the page trace to " << options_.page_trace_ << std::endl;
+    }
+    auto start = std::chrono::steady_clock::now();
+    RunThreads([&](size_t thread) {
+      std::mt19937_64 generator(options_.seed_ + thread);
+      uint64_t num_operations = options_.operations_ / options_.threads_ +
+                                (thread < options_.operations_ % options_.threads_ ? 1 : 0);
+      for (uint64_t i = 0; i < num_operations; i++) {
+        Operation operation = NextOperation(&generator);
+        auto op_start = std::chrono::steady_clock::now();
+        Execute(operation, &generator);
+        auto nanos = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - op_start);
+        latencies[thread][static_cast<size_t>(operation)].push_back(nanos.count());
+      }
+    });
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    BufferPoolStats after = bpm_->GetStats();
+    disk_manager_->StopPageTrace();
+
+    std::cout << "[RUN] workload " << options_.workload_ << ", " << options_.operations_ << " operations in "
+              << seconds << " s, " << static_cast<double>(options_.operations_) / seconds << " ops/s" << std::endl;
+    std::cout << "[RUN] buffer pool hit ratio " << std::fixed << std::setprecision(4)
+              << static_cast<double>(after.hits_ - before.hits_) /
+                     std::max<double>(1, static_cast<double>(after.hits_ - before.hits_ + after.misses_ -
+                                                             before.misses_))
+              << ", " << after.misses_ - before.misses_ << " misses" << std::endl;
+    std::cout << std::setprecision(2);
+    for (size_t operation = 0; operation < NUM_OPERATIONS; operation++) {
+      Latencies all;
+      for (const auto &thread_latencies : latencies) {
+        all.insert(all.end(), thread_latencies[operation].begin(), thread_latencies[operation].end());
+      }
+      if (all.empty()) {
+        continue;
+      }
+      std::sort(all.begin(), all.end());
+      std::cout << "[" << OPERATION_NAMES[operation] << "] count " << all.size() << ", "
+                << static_cast<double>(all.size()) / seconds << " ops/s, p50 " << Percentile(all, 50) << " us, p99 "
+                << Percentile(all, 99) << " us, p99.9 " << Percentile(all, 99.9) << " us" << std::endl;
+    }
+  }
+
+ private:
+  template <typename Work>
+  void RunThreads(Work &&work) {
+    std::vector<std::thread> threads;
+    for (size_t thread = 0; thread < options_.threads_; thread++) {
+      threads.emplace_back([&, thread] { work(thread); });
+    }
+    for (auto &thread : threads) {
+      thread.join();
+    }
+  }
+
+  Tuple KeyTuple(int64_t key) const { return Tuple({Value(TypeId::BIGINT, key)}, &key_schema_); }
+
+  Operation NextOperation(std::mt19937_64 *generator) const {
+    double u = std::uniform_real_distribution<double>(0, 1)(*generator);
+    for (size_t operation = 0; operation < NUM_OPERATIONS; operation++) {
+      u -= workload_.proportions_[operation];
+      if (u < 0) {
+        return static_cast<Operation>(operation);
+      }
+    }
+    return Operation::READ;
+  }
+
+  /** @return the record of a read, an update or the start of a scan */
+  uint64_t NextRecord(std::mt19937_64 *generator) const {
+    uint64_t inserted = inserted_.load();
+    if (workload_.latest_) {
+      // the newest records are the most popular
+      return inserted - 1 - std::min(zipfian_.Next(generator), inserted - 1);
+    }
+    if (options_.distribution_ == "uniform") {
+      return std::uniform_int_distribution<uint64_t>(0, inserted - 1)(*generator);
+    }
+    // scrambled, so that the popular records are not the ones next to each other
+    return Fnv1a(zipfian_.Next(generator)) % options_.records_;
+  }
+
+  void Execute(Operation operation, std::mt19937_64 *generator) {
+    std::vector<RID> rids;
+    switch (operation) {
+      case Operation::READ:
+        index_->ScanKey(KeyTuple(KeyOf(NextRecord(generator))), &rids, nullptr);
+        break;
+      case Operation::UPDATE:
+      case Operation::READ_MODIFY_WRITE:
+        Update(NextRecord(generator));
+        break;
+      case Operation::INSERT: {
+        uint64_t record = next_record_++;
+        index_->InsertEntry(KeyTuple(KeyOf(record)), RidOf(record, 0), nullptr);
+        inserted_++;
+        break;
+      }
+      case Operation::SCAN:
+        Scan(NextRecord(generator), std::uniform_int_distribution<uint64_t>(1, options_.max_scan_length_)(*generator),
+             &rids);
+        break;
+    }
+  }
+
+  /**
+   * Moves a record to the RID of its next version: reads its entry, and replaces it. The record is locked meanwhile,
+   * as a row would be, so that two updates of a record do not leave two entries of it.
+   */
+  void Update(uint64_t record) {
+    Tuple key = KeyTuple(KeyOf(record));
+    std::scoped_lock lock{key_locks_[record % key_locks_.size()]};
+    std::vector<RID> rids;
+    index_->ScanKey(key, &rids, nullptr);
+    if (rids.empty()) {
+      return;
+    }
+    index_->DeleteEntry(key, rids.front(), nullptr);
+    index_->InsertEntry(key, RidOf(record, rids.front().GetSlotNum() + 1), nullptr);
+  }
+
+  /** Reads the entries of up to length keys, from the key of a record on, into rids. */
+  void Scan(uint64_t record, uint64_t length, std::vector<RID> *rids) {
+    auto iterator = bplus_index_->GetBeginIterator(bplus_index_->MakeSearchKey(KeyTuple(KeyOf(record))));
+    for (uint64_t i = 0; i < length && !iterator.isEnd(); i++, ++iterator) {
+      rids->push_back((*iterator).second);
+    }
+  }
+
+  const Options options_;
+  const Workload workload_;
+  const ZipfianGenerator zipfian_;
+  Schema key_schema_;
+  std::unique_ptr<DiskManager> disk_manager_;
+  std::unique_ptr<ParallelBufferPoolManager> bpm_;
+  std::unique_ptr<Index> index_;
+  /** index_ as a B+ tree, which scans need; nullptr for a hash index */
+  BPlusIndex *bplus_index_{nullptr};
+  /** The record the next insert inserts, and the number of records inserted so far */
+  std::atomic<uint64_t> next_record_{0};
+  std::atomic<uint64_t> inserted_{0};
+  /** The locks of the records, striped */
+  std::vector<std::mutex> key_locks_;
+};
+
+bool ParseOptions(int argc, char **argv, Options *options) {
+  for (int i = 1; i < argc; i++) {
+    std::string arg = argv[i];
+    size_t equals = arg.find('=');
+    if (arg.rfind("--", 0) != 0 || equals == std::string::npos) {
+      std::cerr << "bad argument " << arg << ", expected --name=value" << std::endl;
+      return false;
+    }
+    std::string name = arg.substr(2, equals - 2);
+    std::string value = arg.substr(equals + 1);
+    if (name == "index") {
+      options->index_ = value;
+    } else if (name == "workload") {
+      options->workload_ = static_cast<char>(std::toupper(value.empty() ? ' ' : value[0]));
+    } else if (name == "records") {
+      options->records_ = std::stoull(value);
+    } else if (name == "operations") {
+      options->operations_ = std::stoull(value);
+    } else if (name == "threads") {
+      options->threads_ = std::stoull(value);
+    } else if (name == "pool_frames") {
+      options->pool_frames_ = std::stoull(value);
+    } else if (name == "pool_instances") {
+      options->pool_instances_ = std::stoull(value);
+    } else if (name == "distribution") {
+      options->distribution_ = value;
+    } else if (name == "zipfian_theta") {
+      options->zipfian_theta_ = std::stod(value);
+    } else if (name == "max_scan_length") {
+      options->max_scan_length_ = std::stoull(value);
+    } else if (name == "seed") {
+      options->seed_ = std::stoull(value);
+    } else if (name == "page_trace") {
+      options->page_trace_ = value;
+    } else {
+      std::cerr << "unknown option --" << name << std::endl;
+      return false;
+    }
+  }
+  if (options->index_ != "bplus" && options->index_ != "hash") {
+    std::cerr << "--index is bplus or hash" << std::endl;
+    return false;
+  }
+  if (WORKLOADS.count(options->workload_) == 0) {
+    std::cerr << "--workload is one of A to F" << std::endl;
+    return false;
+  }
+  if (options->workload_ == 'E' && options->index_ == "hash") {
+    std::cerr << "workload E scans ranges of keys, which a hash index cannot" << std::endl;
+    return false;
+  }
+  if (options->distribution_ != "zipfian" && options->distribution_ != "uniform") {
+    std::cerr << "--distribution is zipfian or uniform" << std::endl;
+    return false;
+  }
+  if (options->records_ < 2 || options->threads_ == 0 || options->pool_instances_ == 0 ||
+      options->pool_frames_ < options->pool_instances_ || options->max_scan_length_ == 0) {
+    std::cerr << "--records, --threads, --pool_frames, --pool_instances and --max_scan_length are positive"
+              << std::endl;
+    return false;
+  }
+  return true;
+}
+
+}  // namespace
+
+}  // namespace bustub
+
+int main(int argc, char **argv) {
+  bustub::Options options;
+  if (!bustub::ParseOptions(argc, argv, &options)) {
+    return 1;
+  }
+  std::cout << "index " << options.index_ << ", workload " << options.workload_ << ", " << options.records_
+            << " records, " << options.threads_ << " threads, " << options.pool_frames_ << " frames in "
+            << options.pool_instances_ << " instances, " << options.distribution_ << " keys" << std::endl;
+  bustub::Driver driver(options);
+  driver.Load();
+  driver.Run();
+  return 0;
+}
@@ -76,6 +76,7 @@ install_mac() {
   brew ls --versions coreutils || brew install coreutils
   brew ls --versions doxygen || brew install doxygen
   brew ls --versions git || brew install git
+  brew ls --versions google-benchmark || brew install google-benchmark
   (brew ls --versions llvm | grep 8) || brew install llvm@8
 }
 
@@ -92,6 +93,7 @@ install_linux() {
       doxygen \
       git \
       g++-7 \
+      libbenchmark-dev \
       pkg-config \
       valgrind \
       zlib1g-dev
@@ -0,0 +1,73 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// atomic_clock_replacer.cpp
+//
+// Identification: src/buffer/atomic_clock_replacer.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/atomic_clock_replacer.h"
+
+#include "common/logger.h"
+
+namespace bustub {
+
+AtomicClockReplacer::AtomicClockReplacer(size_t num_pages)
+    : num_pages_(num_pages), states_(new std::atomic<uint8_t>[num_pages]) {
+  for (size_t i = 0; i < num_pages; i++) {
+    states_[i].store(0, std::memory_order_relaxed);
+  }
+}
+
+bool AtomicClockReplacer::Victim(frame_id_t *frame_id) {
+  // the size is checked at every step, so that Victim gives up once the last frame has been pinned or taken meanwhile
+  while (size_.load() > 0) {
+    size_t hand = clock_hand_.load();
+    std::atomic<uint8_t> &state = states_[hand];
+    uint8_t current = state.load();
+    // as in ClockReplacer, the hand stays on the frame it takes; a failed CAS means the frame was pinned, unpinned or
+    // taken meanwhile, and the hand moves on from it
+    if (current == IN_REPLACER && state.compare_exchange_strong(current, 0)) {
+      size_.fetch_sub(1);
+      *frame_id = static_cast<frame_id_t>(hand);
+      return true;
+    }
+    if (current == (IN_REPLACER | REFERENCED)) {
+      state.compare_exchange_strong(current, IN_REPLACER);
+    }
+    // another thread that moved the hand meanwhile moved it past this frame already
+    clock_hand_.compare_exchange_strong(hand, (hand + 1) % num_pages_);
+  }
+  return false;
+}
+
+void AtomicClockReplacer::Pin(frame_id_t frame_id) {
+  if (!IsValid(frame_id)) {
+    LOG_INFO("AtomicClockReplacer::Pin:Invalid frame id!");
+    return;
+  }
+  if ((states_[frame_id].exchange(0) & IN_REPLACER) != 0) {
+    size_.fetch_sub(1);
+  }
+}
+
+void AtomicClockReplacer::Unpin(frame_id_t frame_id) {
+  if (!IsValid(frame_id)) {
+    LOG_INFO("AtomicClockReplacer::Unpin:Invalid frame id!");
+    return;
+  }
+  if ((states_[frame_id].exchange(IN_REPLACER | REFERENCED) & IN_REPLACER) == 0) {
+    size_.fetch_add(1);
+  }
+}
+
+size_t AtomicClockReplacer::Size() {
+  int64_t size = size_.load();
+  return size > 0 ? static_cast<size_t>(size) : 0;
+}
+
+}  // namespace bustub
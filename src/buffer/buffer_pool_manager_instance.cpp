@@ -0,0 +1,750 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// buffer_pool_manager_instance.cpp
+//
+// Identification: src/buffer/buffer_pool_manager_instance.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/buffer_pool_manager_instance.h"
+
+#include <algorithm>
+#include <chrono>  // NOLINT
+#include <list>
+#include <unordered_map>
+#include <vector>
+
+#include "common/logger.h"
+#include "common/macros.h"
+#include "common/memory_tracker.h"
+#include "common/tracer.h"
+
+namespace bustub {
+
+BufferPoolManagerInstance::BufferPoolManagerInstance(size_t pool_size, DiskManager *disk_manager,
+                                                     LogManager *log_manager, ReplacerType replacer_type)
+    : BufferPoolManagerInstance(pool_size, 1, 0, disk_manager, log_manager, replacer_type) {}
+
+BufferPoolManagerInstance::BufferPoolManagerInstance(size_t pool_size, uint32_t num_instances, uint32_t instance_index,
+                                                     DiskManager *disk_manager, LogManager *log_manager,
+                                                     ReplacerType replacer_type, int numa_node)
+    : pool_size_(pool_size),
+      num_instances_(num_instances),
+      instance_index_(instance_index),
+      numa_node_(numa_node),
+      arena_(pool_size, numa_node),
+      disk_manager_(disk_manager),
+      log_manager_(log_manager),
+      page_table_(pool_size),
+      frame_state_(pool_size),
+      frame_cv_(pool_size) {
+  BUSTUB_ASSERT(num_instances > 0, "If BPI is not part of a pool, then the pool size should just be 1");
+  BUSTUB_ASSERT(
+      instance_index < num_instances,
+      "BPI index cannot be greater than the number of BPIs in the pool. In non-parallel case, index should just be 0.");
+  // We allocate a consecutive memory space for the buffer pool. The frame data lives apart from the page metadata, so
+  // that frames stay page aligned and can be backed by huge pages.
+  pages_ = new Page[pool_size_];
+  MemoryTracker::Global()->Allocate(MemoryCategory::BUFFER_POOL, pool_size_ * sizeof(Page));
+  for (size_t i = 0; i < pool_size_; ++i) {
+    pages_[i].data_ = arena_.GetFrame(i);
+  }
+  replacer_ = MakeReplacer(replacer_type, pool_size).release();
+
+  // Initially, every page is in the free list.
+  for (size_t i = 0; i < pool_size_; ++i) {
+    free_list_.emplace_back(static_cast<int>(i));
+    frame_state_[i] = FrameState::FREE;
+    pages_[i].pin_count_ = -1;
+  }
+}
+
+BufferPoolManagerInstance::~BufferPoolManagerInstance() {
+  StopBackgroundFlusher();
+  {
+    std::scoped_lock latch{latch_};
+    prefetcher_running_ = false;
+  }
+  if (prefetch_thread_ != nullptr) {
+    prefetch_cv_.notify_all();
+    prefetch_thread_->join();
+  }
+  delete[] pages_;
+  MemoryTracker::Global()->Free(MemoryCategory::BUFFER_POOL, pool_size_ * sizeof(Page));
+  delete replacer_;
+}
+
+bool BufferPoolManagerInstance::TryPin(frame_id_t frame_id) {
+  std::atomic<int> &pin_count = pages_[frame_id].pin_count_;
+  int pins = pin_count.load();
+  do {
+    if (pins < 0) {
+      return false;
+    }
+  } while (!pin_count.compare_exchange_weak(pins, pins + 1));
+  return true;
+}
+
+std::unique_lock<std::mutex> BufferPoolManagerInstance::AcquireLatch() {
+  std::unique_lock latch{latch_, std::defer_lock};
+  LockLatch(&latch);
+  return latch;
+}
+
+void BufferPoolManagerInstance::LockLatch(std::unique_lock<std::mutex> *latch) {
+  // only a contended acquire reads the clock
+  if (latch->try_lock()) {
+    return;
+  }
+  auto start = std::chrono::steady_clock::now();
+  latch->lock();
+  auto wait = std::chrono::steady_clock::now() - start;
+  counters_.AddLatchWait(wait);
+  latch_site_->RecordWait(wait);
+}
+
+void BufferPoolManagerInstance::ReleasePin(frame_id_t frame_id) {
+  if (pages_[frame_id].pin_count_.fetch_sub(1) == 1) {
+    replacer_->Unpin(frame_id);
+  }
+}
+
+bool BufferPoolManagerInstance::FindFreeFrame(frame_id_t *frame_id, page_id_t *dirty_page_id,
+                                              BufferAccessStrategy *strategy) {
+  std::vector<frame_id_t> *ring = nullptr;
+  size_t *cursor = nullptr;
+  bool from_ring = false;
+  if (strategy != nullptr) {
+    ring = &strategy->Ring(instance_index_);
+    cursor = &strategy->cursors_[instance_index_];
+    // the CAS fails for frames that someone pinned in the meantime, and for parked (i.e. free) ones
+    frame_id_t ring_frame = (*ring)[*cursor];
+    int unpinned = 0;
+    from_ring = ring_frame != -1 && pages_[ring_frame].pin_count_.compare_exchange_strong(unpinned, -1);
+    if (from_ring) {
+      *frame_id = ring_frame;
+    }
+  }
+
+  if (from_ring) {
+    // the ring's own frame is recycled, and the rest of the pool is left alone
+  } else if (!free_list_.empty()) {
+    *frame_id = free_list_.back();
+    free_list_.pop_back();
+  } else {
+    while (true) {
+      if (!replacer_->Victim(frame_id)) {
+        return false;
+      }
+      // park the pin count so that no hit can pin the frame while it changes hands
+      int unpinned = 0;
+      if (pages_[*frame_id].pin_count_.compare_exchange_strong(unpinned, -1)) {
+        break;
+      }
+      // pinned by a hit since it was last unpinned; dropping it is fine, its last unpin offers it again
+    }
+  }
+  if (ring != nullptr) {
+    (*ring)[*cursor] = *frame_id;
+    *cursor = (*cursor + 1) % ring->size();
+  }
+
+  Page *page = &pages_[*frame_id];
+  page_id_t page_id_rm = page->GetPageId();
+  *dirty_page_id = INVALID_PAGE_ID;
+  if (page_id_rm != INVALID_PAGE_ID) {
+    counters_.AddEviction();
+    page_table_.Erase(page_id_rm);
+    if (page->IsDirty()) {
+      // until the write-back completes, the copy on disk is stale; fetchers of page_id_rm wait on writeback_
+      *dirty_page_id = page_id_rm;
+      writeback_[page_id_rm] = *frame_id;
+    }
+  }
+  // hits that pinned the frame before it was parked must not mistake it for resident once it is handed out again
+  frame_state_[*frame_id] = *dirty_page_id != INVALID_PAGE_ID ? FrameState::EVICTING : FrameState::LOADING;
+  return true;
+}
+
+void BufferPoolManagerInstance::LoadFrames(std::unique_lock<std::mutex> *latch,
+                                           const std::vector<std::pair<frame_id_t, page_id_t>> &frames,
+                                           bool read_pages) {
+  bool has_writebacks = std::any_of(frames.begin(), frames.end(),
+                                    [](const auto &frame) { return frame.second != INVALID_PAGE_ID; });
+  if (has_writebacks) {
+    std::vector<std::pair<page_id_t, const char *>> writes;
+    for (const auto &[frame_id, dirty_page_id] : frames) {
+      if (dirty_page_id != INVALID_PAGE_ID) {
+        counters_.AddDirtyWriteback();
+        writes.emplace_back(dirty_page_id, pages_[frame_id].GetData());
+      }
+    }
+    latch->unlock();
+    for (const auto &[frame_id, dirty_page_id] : frames) {
+      if (dirty_page_id != INVALID_PAGE_ID) {
+        ForceLog(&pages_[frame_id]);
+      }
+    }
+    // all write-backs of the batch go to the I/O engine at once
+    if (!disk_manager_->WritePages(writes)) {
+      LOG_DEBUG("I/O error while writing back");
+    }
+    LockLatch(latch);
+    for (const auto &[frame_id, dirty_page_id] : frames) {
+      if (dirty_page_id != INVALID_PAGE_ID) {
+        writeback_.erase(dirty_page_id);
+        frame_state_[frame_id] = FrameState::LOADING;
+        frame_cv_[frame_id].notify_all();
+      }
+    }
+  }
+
+  // the frames are parked or pinned by us, so their page ids cannot change while unlatched
+  std::vector<frame_id_t> reads;
+  reads.reserve(frames.size());
+  for (const auto &frame : frames) {
+    reads.push_back(frame.first);
+  }
+  std::sort(reads.begin(), reads.end(),
+            [this](frame_id_t a, frame_id_t b) { return pages_[a].GetPageId() < pages_[b].GetPageId(); });
+  latch->unlock();
+  if (read_pages) {
+    std::vector<std::pair<page_id_t, char *>> page_reads;
+    page_reads.reserve(reads.size());
+    for (frame_id_t frame_id : reads) {
+      page_reads.emplace_back(pages_[frame_id].GetPageId(), pages_[frame_id].GetData());
+    }
+    if (!disk_manager_->ReadPages(page_reads)) {
+      LOG_DEBUG("I/O error while reading");
+    }
+  } else {
+    for (frame_id_t frame_id : reads) {
+      pages_[frame_id].ResetMemory();
+    }
+  }
+  LockLatch(latch);
+  for (frame_id_t frame_id : reads) {
+    frame_state_[frame_id] = FrameState::RESIDENT;
+    frame_cv_[frame_id].notify_all();
+  }
+}
+
+bool BufferPoolManagerInstance::PinIfCached(page_id_t page_id, frame_id_t *frame_id) {
+  // pin whatever frame the directory points at, then make sure it still holds the page
+  if (!page_table_.Find(page_id, frame_id) || !TryPin(*frame_id)) {
+    return false;
+  }
+  if (pages_[*frame_id].GetPageId() != page_id) {
+    ReleasePin(*frame_id);
+    return false;
+  }
+  return true;
+}
+
+void BufferPoolManagerInstance::WaitForIo(std::unique_lock<std::mutex> *latch, frame_id_t frame_id) {
+  if (frame_state_[frame_id] == FrameState::RESIDENT) {
+    return;
+  }
+  auto start = std::chrono::steady_clock::now();
+  frame_cv_[frame_id].wait(*latch, [&] { return frame_state_[frame_id] == FrameState::RESIDENT; });
+  counters_.AddPinWait(std::chrono::steady_clock::now() - start);
+}
+
+void BufferPoolManagerInstance::ValidatePageId(const page_id_t page_id) const {
+  BUSTUB_ASSERT(page_id % num_instances_ == instance_index_, "page id does not belong to this BPI");
+}
+
+Page *BufferPoolManagerInstance::FetchPageImpl(page_id_t page_id) { return FetchPageWithStrategy(page_id, nullptr); }
+
+Page *BufferPoolManagerInstance::FetchPageWithStrategy(page_id_t page_id, BufferAccessStrategy *strategy) {
+  // 1.     Search the page table for the requested page (P).
+  // 1.1    If P exists, pin it and return it immediately.
+  // 1.2    If P does not exist, find a replacement page (R) from either the free list or the replacer.
+  //        Note that pages are always found from the free list first.
+  // 2.     If R is dirty, write it back to the disk.
+  // 3.     Delete R from the page table and insert P.
+  // 4.     Update P's metadata, read in the page content from disk, and then return a pointer to P.
+
+  disk_manager_->TracePageAccess(page_id, PageAccessType::FETCH);
+  // Hits take no latch.
+  frame_id_t frame_id;
+  if (PinIfCached(page_id, &frame_id)) {
+    if (frame_state_[frame_id] == FrameState::RESIDENT) {
+      fetch_latency_.Record(std::chrono::nanoseconds(0));
+    } else {
+      // another thread is still reading P in; wait for that read instead of issuing our own
+      ScopedLatency latency(&fetch_latency_);
+      auto latch = AcquireLatch();
+      WaitForIo(&latch, frame_id);
+    }
+    counters_.AddHit();
+    return &pages_[frame_id];
+  }
+
+  ScopedLatency latency(&fetch_latency_);
+  auto latch = AcquireLatch();
+  while (true) {
+    // P might have been brought in since the lookup above; under the latch no frame is parked
+    if (page_table_.Find(page_id, &frame_id)) {
+      Page *page = &pages_[frame_id];
+      ++page->pin_count_;
+      WaitForIo(&latch, frame_id);
+      counters_.AddHit();
+      return page;
+    }
+
+    // P was just evicted and is still being written back; reading it now could return the old image
+    auto writeback = writeback_.find(page_id);
+    if (writeback == writeback_.end()) {
+      break;
+    }
+    auto start = std::chrono::steady_clock::now();
+    frame_cv_[writeback->second].wait(latch, [&] { return writeback_.count(page_id) == 0; });
+    counters_.AddPinWait(std::chrono::steady_clock::now() - start);
+  }
+
+  counters_.AddMiss();
+  TraceSpan span("page_miss", "buffer_pool");
+  span.SetArg("page_id", page_id);
+  page_id_t dirty_page_id;
+  if (!FindFreeFrame(&frame_id, &dirty_page_id, strategy)) {
+    return nullptr;
+  }
+
+  Page *page = &pages_[frame_id];
+  page->page_id_ = page_id;
+  page->is_dirty_ = false;
+  page->rec_lsn_ = INVALID_LSN;
+  page->pin_count_ = 1;
+  page_table_.Insert(page_id, frame_id);
+  LoadFrame(&latch, frame_id, dirty_page_id, true);
+  return page;
+}
+
+std::vector<Page *> BufferPoolManagerInstance::FetchPages(const std::vector<page_id_t> &page_ids) {
+  std::vector<Page *> result(page_ids.size(), nullptr);
+  // hits are pinned first, without the latch, in the same way as by FetchPage
+  std::vector<frame_id_t> frames(page_ids.size(), -1);
+  bool all_resident = true;
+  for (size_t i = 0; i < page_ids.size(); ++i) {
+    if (PinIfCached(page_ids[i], &frames[i])) {
+      counters_.AddHit();
+      all_resident = all_resident && frame_state_[frames[i]] == FrameState::RESIDENT;
+      result[i] = &pages_[frames[i]];
+    } else {
+      frames[i] = -1;
+    }
+  }
+  if (all_resident && std::find(frames.begin(), frames.end(), -1) == frames.end()) {
+    return result;
+  }
+
+  auto latch = AcquireLatch();
+  std::vector<std::pair<frame_id_t, page_id_t>> loads;
+  for (size_t i = 0; i < page_ids.size(); ++i) {
+    if (frames[i] != -1) {
+      continue;
+    }
+    page_id_t page_id = page_ids[i];
+    while (true) {
+      // a page listed twice maps to the frame the first occurrence is loading; it is waited on below, not here
+      if (page_table_.Find(page_id, &frames[i])) {
+        ++pages_[frames[i]].pin_count_;
+        counters_.AddHit();
+        break;
+      }
+      auto writeback = writeback_.find(page_id);
+      if (writeback == writeback_.end()) {
+        break;
+      }
+      auto start = std::chrono::steady_clock::now();
+      frame_cv_[writeback->second].wait(latch, [&] { return writeback_.count(page_id) == 0; });
+      counters_.AddPinWait(std::chrono::steady_clock::now() - start);
+    }
+    if (frames[i] != -1) {
+      result[i] = &pages_[frames[i]];
+      continue;
+    }
+
+    counters_.AddMiss();
+    frame_id_t frame_id;
+    page_id_t dirty_page_id;
+    if (!FindFreeFrame(&frame_id, &dirty_page_id)) {
+      continue;
+    }
+    Page *page = &pages_[frame_id];
+    page->page_id_ = page_id;
+    page->is_dirty_ = false;
+    page->rec_lsn_ = INVALID_LSN;
+    page->pin_count_ = 1;
+    page_table_.Insert(page_id, frame_id);
+    loads.emplace_back(frame_id, dirty_page_id);
+    frames[i] = frame_id;
+    result[i] = page;
+  }
+
+  if (!loads.empty()) {
+    LoadFrames(&latch, loads, true);
+  }
+  for (frame_id_t frame_id : frames) {
+    if (frame_id != -1) {
+      WaitForIo(&latch, frame_id);
+    }
+  }
+  return result;
+}
+
+bool BufferPoolManagerInstance::UnpinPageImpl(page_id_t page_id, bool is_dirty) {
+  // first, check if page_id in page_table_
+  frame_id_t frame_id;
+  if (!page_table_.Find(page_id, &frame_id)) {
+    return false;
+  }
+
+  // second, check the pin count for that page > 0; the caller's pin keeps the frame assigned to the page
+  Page *page = &pages_[frame_id];
+  if (page->GetPageId() != page_id) {
+    return false;
+  }
+
+  // finally, unpin the page; a clean unpin must not hide an earlier writer's changes
+  if (is_dirty) {
+    page->is_dirty_ = true;
+  }
+  int pins = page->pin_count_.load();
+  do {
+    if (pins <= 0) {
+      return false;
+    }
+  } while (!page->pin_count_.compare_exchange_weak(pins, pins - 1));
+  if (pins == 1) {
+    replacer_->Unpin(frame_id);
+  }
+  return true;
+}
+
+bool BufferPoolManagerInstance::FlushPageImpl(page_id_t page_id) {
+  // Make sure you call DiskManager::WritePage!
+  auto latch = AcquireLatch();
+
+  // first, check if the page_id in page_table_
+  frame_id_t frame_id;
+  if (page_id == INVALID_PAGE_ID || !page_table_.Find(page_id, &frame_id)) {
+    return false;
+  }
+
+  // flushing only writes the page back; it stays cached. The extra pin keeps it in its frame while unlatched.
+  Page *page = &pages_[frame_id];
+  ++page->pin_count_;
+  WaitForIo(&latch, frame_id);
+  latch.unlock();
+  // the read latch keeps writers out, so that the page is written (and checksummed) as one consistent image
+  page->RLatch();
+  if (page->is_dirty_.exchange(false)) {
+    page->rec_lsn_ = INVALID_LSN;
+    ForceLog(page);
+    disk_manager_->WritePage(page_id, page->GetData());
+  }
+  page->RUnlatch();
+  ReleasePin(frame_id);
+  return true;
+}
+
+Page *BufferPoolManagerInstance::CreatePage(std::unique_lock<std::mutex> *latch, page_id_t page_id,
+                                            BufferAccessStrategy *strategy) {
+  ValidatePageId(page_id);
+  frame_id_t frame_id;
+  while (true) {
+    // a reader may have cached the (empty) page before it is created, e.g. a backup that walks every allocated page,
+    // or a stale copy of a deleted page whose id is reused, which a B+ tree lookup without latches read back in; it is
+    // created in that frame then, as a second frame for the same id would hide the writes to one of them. The write
+    // latch moves the version on, which such a lookup validates against.
+    if (page_table_.Find(page_id, &frame_id)) {
+      Page *page = &pages_[frame_id];
+      ++page->pin_count_;
+      WaitForIo(latch, frame_id);
+      page->WLatch();
+      page->ResetMemory();
+      page->WUnlatch();
+      page->rec_lsn_ = INVALID_LSN;
+      return page;
+    }
+    auto writeback = writeback_.find(page_id);
+    if (writeback == writeback_.end()) {
+      break;
+    }
+    frame_cv_[writeback->second].wait(*latch, [&] { return writeback_.count(page_id) == 0; });
+  }
+
+  page_id_t dirty_page_id;
+  if (!FindFreeFrame(&frame_id, &dirty_page_id, strategy)) {
+    return nullptr;
+  }
+  Page *page = &pages_[frame_id];
+  page->page_id_ = page_id;
+  page->is_dirty_ = false;
+  page->rec_lsn_ = INVALID_LSN;
+  page->pin_count_ = 1;
+  page_table_.Insert(page_id, frame_id);
+  LoadFrame(latch, frame_id, dirty_page_id, false);
+  return page;
+}
+
+Page *BufferPoolManagerInstance::NewPageImpl(page_id_t *page_id) { return NewPageWithStrategy(page_id, nullptr); }
+
+Page *BufferPoolManagerInstance::NewPageWithStrategy(page_id_t *page_id, BufferAccessStrategy *strategy) {
+  // 0.   Make sure you call DiskManager::AllocatePage!
+  // 1.   If all the pages in the buffer pool are pinned, return nullptr.
+  // 2.   Pick a victim page P from either the free list or the replacer. Always pick from the free list first.
+  // 3.   Update P's metadata, zero out memory and add P to the page table.
+  // 4.   Set the page ID output parameter. Return a pointer to P.
+  auto latch = AcquireLatch();
+  page_id_t new_page_id = disk_manager_->AllocatePage();
+  Page *page = CreatePage(&latch, new_page_id, strategy);
+  if (page == nullptr) {
+    disk_manager_->DeallocatePage(new_page_id);
+    return nullptr;
+  }
+  *page_id = new_page_id;
+  return page;
+}
+
+Page *BufferPoolManagerInstance::NewPageWithId(page_id_t page_id, BufferAccessStrategy *strategy) {
+  auto latch = AcquireLatch();
+  return CreatePage(&latch, page_id, strategy);
+}
+
+bool BufferPoolManagerInstance::DeletePageImpl(page_id_t page_id) {
+  // 0.   Make sure you call DiskManager::DeallocatePage!
+  // 1.   Search the page table for the requested page (P).
+  // 1.   If P does not exist, return true.
+  // 2.   If P exists, but has a non-zero pin-count, return false. Someone is using the page.
+  // 3.   Otherwise, P can be deleted. Remove P from the page table, reset its metadata and return it to the free list.
+  {
+    auto latch = AcquireLatch();
+
+    // a page that was just evicted may still be on its way to disk; once its id is reused, that write would race the
+    // new page's
+    auto writeback = writeback_.find(page_id);
+    if (writeback != writeback_.end()) {
+      frame_cv_[writeback->second].wait(latch, [&] { return writeback_.count(page_id) == 0; });
+    }
+
+    // first, check if the page_id in page_table_
+    frame_id_t frame_id;
+    if (!page_table_.Find(page_id, &frame_id)) {
+      latch.unlock();
+      // the page may well be on disk only; it is free for reuse all the same
+      disk_manager_->DeallocatePage(page_id);
+      return true;
+    }
+
+    // a frame with I/O in flight is always pinned by whoever started it; parking the count also fends off hits
+    Page *page = &pages_[frame_id];
+    int unpinned = 0;
+    if (!page->pin_count_.compare_exchange_strong(unpinned, -1)) {
+      return false;
+    }
+    page_table_.Erase(page_id);
+    page->ResetMemory();
+    page->page_id_ = INVALID_PAGE_ID;
+    page->is_dirty_ = false;
+    page->rec_lsn_ = INVALID_LSN;
+    frame_state_[frame_id] = FrameState::FREE;
+    free_list_.push_back(frame_id);
+    replacer_->Pin(frame_id);
+  }
+
+  disk_manager_->DeallocatePage(page_id);
+  return true;
+}
+
+void BufferPoolManagerInstance::FlushAllPagesImpl() {
+  auto latch = AcquireLatch();
+
+  // pin every dirty resident page so that the writes below can run without the latch
+  std::vector<frame_id_t> dirty_frames;
+  for (size_t i = 0; i < pool_size_; ++i) {
+    auto frame_id = static_cast<frame_id_t>(i);
+    Page *page = &pages_[frame_id];
+    if (frame_state_[frame_id] == FrameState::RESIDENT && page->IsDirty()) {
+      ++page->pin_count_;
+      dirty_frames.push_back(frame_id);
+    }
+  }
+  latch.unlock();
+
+  for (frame_id_t frame_id : dirty_frames) {
+    Page *page = &pages_[frame_id];
+    page->RLatch();
+    if (page->is_dirty_.exchange(false)) {
+      page->rec_lsn_ = INVALID_LSN;
+      ForceLog(page);
+      disk_manager_->WritePage(page->GetPageId(), page->GetData());
+    }
+    page->RUnlatch();
+    ReleasePin(frame_id);
+  }
+}
+
+void BufferPoolManagerInstance::ForceLog(Page *page) {
+  if (!enable_logging || log_manager_ == nullptr) {
+    return;
+  }
+  // pages that are not logged may hold anything where the LSN would be, so no more than the log appended so far is
+  // waited for
+  log_manager_->WaitForPersistent(std::min(page->GetLSN(), log_manager_->GetNextLSN() - 1));
+}
+
+void BufferPoolManagerInstance::PrefetchPages(const std::vector<page_id_t> &page_ids, BufferAccessStrategy *strategy) {
+  auto latch = AcquireLatch();
+  size_t queued = 0;
+  for (page_id_t page_id : page_ids) {
+    frame_id_t frame_id;
+    page_id_t dirty_page_id;
+    // pages on their way out are skipped too; their write-back has to finish before anyone may read them
+    if (page_id == INVALID_PAGE_ID || page_table_.Find(page_id, &frame_id) || writeback_.count(page_id) != 0) {
+      continue;
+    }
+    // the caller must never wait on a prefetch, so give up as soon as every frame is pinned
+    if (!FindFreeFrame(&frame_id, &dirty_page_id, strategy)) {
+      break;
+    }
+
+    // the page is mapped right away with the prefetch thread's pin, so fetchers wait for its read like any other
+    ValidatePageId(page_id);
+    Page *page = &pages_[frame_id];
+    page->page_id_ = page_id;
+    page->is_dirty_ = false;
+    page->rec_lsn_ = INVALID_LSN;
+    page->pin_count_ = 1;
+    page_table_.Insert(page_id, frame_id);
+    prefetch_queue_.emplace_back(frame_id, dirty_page_id);
+    ++queued;
+  }
+
+  if (queued == 0) {
+    return;
+  }
+  if (prefetch_thread_ == nullptr) {
+    prefetcher_running_ = true;
+    prefetch_thread_ = std::make_unique<std::thread>(&BufferPoolManagerInstance::RunPrefetcher, this);
+  }
+  prefetch_cv_.notify_one();
+}
+
+BufferPoolStats BufferPoolManagerInstance::GetStats() { return counters_.Snapshot(); }
+
+std::vector<std::pair<page_id_t, lsn_t>> BufferPoolManagerInstance::GetDirtyPageTable() {
+  std::vector<std::pair<page_id_t, lsn_t>> dirty_pages;
+  auto latch = AcquireLatch();
+  for (size_t i = 0; i < pool_size_; ++i) {
+    Page *page = &pages_[i];
+    if (frame_state_[i] == FrameState::RESIDENT && page->IsDirty()) {
+      dirty_pages.emplace_back(page->GetPageId(), page->GetRecLSN());
+    }
+  }
+  return dirty_pages;
+}
+
+void BufferPoolManagerInstance::RunPrefetcher() {
+  std::unique_lock latch{latch_};
+  while (true) {
+    prefetch_cv_.wait(latch, [this] { return !prefetch_queue_.empty() || !prefetcher_running_; });
+    // queued frames are mapped and waited on, so they are loaded even when stopping
+    if (prefetch_queue_.empty()) {
+      return;
+    }
+    // everything queued so far goes out as one batch
+    std::vector<std::pair<frame_id_t, page_id_t>> frames(prefetch_queue_.begin(), prefetch_queue_.end());
+    prefetch_queue_.clear();
+    LoadFrames(&latch, frames, true);
+    for (const auto &frame : frames) {
+      ReleasePin(frame.first);
+    }
+  }
+}
+
+void BufferPoolManagerInstance::StartBackgroundFlusher() {
+  std::scoped_lock latch{latch_};
+  if (flusher_running_) {
+    return;
+  }
+  flusher_running_ = true;
+  flush_thread_ = std::make_unique<std::thread>([this] {
+    std::unique_lock latch{latch_};
+    while (!flusher_cv_.wait_for(latch, bg_flush_interval, [this] { return !flusher_running_; })) {
+      latch.unlock();
+      BackgroundFlush();
+      latch.lock();
+    }
+  });
+}
+
+void BufferPoolManagerInstance::StopBackgroundFlusher() {
+  {
+    std::scoped_lock latch{latch_};
+    if (!flusher_running_) {
+      return;
+    }
+    flusher_running_ = false;
+  }
+  flusher_cv_.notify_all();
+  flush_thread_->join();
+  flush_thread_.reset();
+}
+
+void BufferPoolManagerInstance::BackgroundFlush() {
+  std::vector<frame_id_t> flush_frames;
+  {
+    std::scoped_lock latch{latch_};
+
+    // count the frames a miss could take without a write-back, and collect the ones a write-back would free up
+    size_t clean_frames = free_list_.size();
+    std::vector<frame_id_t> dirty_frames;
+    for (size_t i = 0; i < pool_size_; ++i) {
+      auto frame_id = static_cast<frame_id_t>((flush_hand_ + i) % pool_size_);
+      Page *page = &pages_[frame_id];
+      if (frame_state_[frame_id] != FrameState::RESIDENT || page->pin_count_ != 0) {
+        continue;
+      }
+      if (page->IsDirty()) {
+        dirty_frames.push_back(frame_id);
+      } else {
+        ++clean_frames;
+      }
+    }
+
+    size_t clean_target = std::min(bg_flush_clean_target.load(), pool_size_);
+    size_t to_flush = clean_target > clean_frames ? clean_target - clean_frames : 0;
+    to_flush = std::min({to_flush, bg_flush_pages_per_round.load(), dirty_frames.size()});
+    for (size_t i = 0; i < to_flush; ++i) {
+      // the pin keeps the frame from being evicted while it is written back unlatched
+      ++pages_[dirty_frames[i]].pin_count_;
+      flush_frames.push_back(dirty_frames[i]);
+    }
+    if (!flush_frames.empty()) {
+      flush_hand_ = (flush_frames.back() + 1) % pool_size_;
+    }
+  }
+
+  for (frame_id_t frame_id : flush_frames) {
+    Page *page = &pages_[frame_id];
+    page->RLatch();
+    // WAL: the page may only reach disk once the log records up to its LSN have; otherwise retry on a later round
+    bool log_persisted =
+        !enable_logging || log_manager_ == nullptr || page->GetLSN() <= log_manager_->GetPersistentLSN();
+    if (log_persisted && page->is_dirty_.exchange(false)) {
+      page->rec_lsn_ = INVALID_LSN;
+      disk_manager_->WritePage(page->GetPageId(), page->GetData());
+    }
+    page->RUnlatch();
+    ReleasePin(frame_id);
+  }
+}
+
+}  // namespace bustub
@@ -0,0 +1,39 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// buffer_pool_stats.cpp
+//
+// Identification: src/buffer/buffer_pool_stats.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/buffer_pool_stats.h"
+
+#include <functional>
+#include <thread>  // NOLINT
+
+namespace bustub {
+
+BufferPoolCounters::Stripe &BufferPoolCounters::Local() {
+  // hashing the thread id is not free, so each thread does it once
+  thread_local const size_t stripe = std::hash<std::thread::id>{}(std::this_thread::get_id()) % NUM_STRIPES;
+  return stripes_[stripe];
+}
+
+BufferPoolStats BufferPoolCounters::Snapshot() const {
+  BufferPoolStats stats;
+  for (const Stripe &stripe : stripes_) {
+    stats.hits_ += stripe.hits_.load(std::memory_order_relaxed);
+    stats.misses_ += stripe.misses_.load(std::memory_order_relaxed);
+    stats.evictions_ += stripe.evictions_.load(std::memory_order_relaxed);
+    stats.dirty_writebacks_ += stripe.dirty_writebacks_.load(std::memory_order_relaxed);
+    stats.pin_wait_ns_ += stripe.pin_wait_ns_.load(std::memory_order_relaxed);
+    stats.latch_wait_ns_ += stripe.latch_wait_ns_.load(std::memory_order_relaxed);
+  }
+  return stats;
+}
+
+}  // namespace bustub
@@ -0,0 +1,82 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// frame_arena.cpp
+//
+// Identification: src/buffer/frame_arena.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/frame_arena.h"
+
+#include <sys/mman.h>
+
+#include <algorithm>
+#include <cstdint>
+
+#include "common/exception.h"
+#include "common/memory_tracker.h"
+#include "common/util/numa.h"
+
+namespace bustub {
+
+FrameArena::FrameArena(size_t num_frames, int numa_node) {
+  size_t size = std::max<size_t>(num_frames, 1) * PAGE_SIZE;
+  bool want_huge_pages = size >= HUGE_PAGE_SIZE;
+  size_t huge_size = (size + HUGE_PAGE_SIZE - 1) / HUGE_PAGE_SIZE * HUGE_PAGE_SIZE;
+
+#ifdef MAP_HUGETLB
+  if (want_huge_pages) {
+    // fails unless the administrator has reserved enough huge pages, which is the common case
+    void *mapping = mmap(nullptr, huge_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+    if (mapping != MAP_FAILED) {
+      mapping_ = mapping;
+      mapping_size_ = huge_size;
+      base_ = static_cast<char *>(mapping);
+      reserved_huge_pages_ = true;
+      MemoryTracker::Global()->Allocate(MemoryCategory::BUFFER_POOL, mapping_size_);
+      PlaceOnNode(numa_node);
+      return;
+    }
+  }
+#endif
+
+  // Transparent huge pages only back huge-page-aligned ranges, and PAGE_SIZE may be larger than the OS page, so
+  // over-allocate by one alignment unit and start the frames at the first boundary.
+  size_t alignment = want_huge_pages ? HUGE_PAGE_SIZE : PAGE_SIZE;
+  mapping_size_ = (want_huge_pages ? huge_size : size) + alignment;
+  mapping_ = mmap(nullptr, mapping_size_, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (mapping_ == MAP_FAILED) {
+    mapping_ = nullptr;
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "cannot map the buffer pool frames");
+  }
+  auto address = (reinterpret_cast<uintptr_t>(mapping_) + alignment - 1) / alignment * alignment;
+  if (want_huge_pages) {
+#ifdef MADV_HUGEPAGE
+    // only a hint: without THP support the arena just stays on regular pages
+    madvise(reinterpret_cast<void *>(address), huge_size, MADV_HUGEPAGE);
+#endif
+  }
+  base_ = reinterpret_cast<char *>(address);
+  MemoryTracker::Global()->Allocate(MemoryCategory::BUFFER_POOL, mapping_size_);
+  PlaceOnNode(numa_node);
+}
+
+void FrameArena::PlaceOnNode(int numa_node) {
+  // mmap only reserves the memory, so none of it is on a node yet
+  if (numa_node >= 0 && Numa::PreferNode(mapping_, mapping_size_, numa_node)) {
+    numa_node_ = numa_node;
+  }
+}
+
+FrameArena::~FrameArena() {
+  if (mapping_ != nullptr) {
+    munmap(mapping_, mapping_size_);
+    MemoryTracker::Global()->Free(MemoryCategory::BUFFER_POOL, mapping_size_);
+  }
+}
+
+}  // namespace bustub
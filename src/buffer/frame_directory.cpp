@@ -0,0 +1,85 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// frame_directory.cpp
+//
+// Identification: src/buffer/frame_directory.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/frame_directory.h"
+
+namespace bustub {
+
+FrameDirectory::FrameDirectory(size_t num_frames) {
+  // keep the load factor at or below 1/2 so that probe runs stay short
+  capacity_bits_ = 3;
+  while ((static_cast<size_t>(1) << capacity_bits_) < 2 * num_frames) {
+    ++capacity_bits_;
+  }
+  size_t capacity = static_cast<size_t>(1) << capacity_bits_;
+  mask_ = capacity - 1;
+  slots_ = std::make_unique<std::atomic<uint64_t>[]>(capacity);
+  for (size_t i = 0; i < capacity; ++i) {
+    slots_[i].store(EMPTY, std::memory_order_relaxed);
+  }
+}
+
+bool FrameDirectory::Find(page_id_t page_id, frame_id_t *frame_id) const {
+  size_t index = HomeSlot(page_id);
+  for (size_t probes = 0; probes <= mask_; ++probes, index = (index + 1) & mask_) {
+    uint64_t slot = slots_[index].load(std::memory_order_acquire);
+    if (slot == EMPTY) {
+      return false;
+    }
+    if (slot != TOMBSTONE && PageOf(slot) == page_id) {
+      *frame_id = FrameOf(slot);
+      return true;
+    }
+  }
+  return false;
+}
+
+void FrameDirectory::Insert(page_id_t page_id, frame_id_t frame_id) {
+  BUSTUB_ASSERT(page_id != INVALID_PAGE_ID, "cannot map the invalid page id");
+  size_t index = HomeSlot(page_id);
+  for (size_t probes = 0; probes <= mask_; ++probes, index = (index + 1) & mask_) {
+    uint64_t slot = slots_[index].load(std::memory_order_relaxed);
+    if (slot == EMPTY || slot == TOMBSTONE) {
+      slots_[index].store(Pack(page_id, frame_id), std::memory_order_release);
+      return;
+    }
+  }
+  UNREACHABLE("frame directory is full");
+}
+
+bool FrameDirectory::Erase(page_id_t page_id) {
+  size_t index = HomeSlot(page_id);
+  for (size_t probes = 0; probes <= mask_; ++probes, index = (index + 1) & mask_) {
+    uint64_t slot = slots_[index].load(std::memory_order_relaxed);
+    if (slot == EMPTY) {
+      return false;
+    }
+    if (slot == TOMBSTONE || PageOf(slot) != page_id) {
+      continue;
+    }
+
+    slots_[index].store(TOMBSTONE, std::memory_order_release);
+    // If the run ends right after this slot, no probe needs to walk past it any more, nor past the tombstones just
+    // before it. Turning them back into EMPTY keeps misses short without ever moving a live entry, which is what
+    // makes concurrent Find() safe.
+    if (slots_[(index + 1) & mask_].load(std::memory_order_relaxed) == EMPTY) {
+      while (slots_[index].load(std::memory_order_relaxed) == TOMBSTONE) {
+        slots_[index].store(EMPTY, std::memory_order_release);
+        index = (index - 1) & mask_;
+      }
+    }
+    return true;
+  }
+  return false;
+}
+
+}  // namespace bustub
@@ -0,0 +1,95 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// lru_k_replacer.cpp
+//
+// Identification: src/buffer/lru_k_replacer.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/lru_k_replacer.h"
+
+#include "common/logger.h"
+#include "common/macros.h"
+
+namespace bustub {
+
+LRUKReplacer::LRUKReplacer(size_t num_pages, size_t k) : frames_(num_pages), k_(k) {
+  BUSTUB_ASSERT(k > 0, "LRU-K needs k >= 1");
+}
+
+LRUKReplacer::~LRUKReplacer() = default;
+
+bool LRUKReplacer::Victim(frame_id_t *frame_id) {
+  std::scoped_lock latch{latch_};
+  if (size_ == 0) {
+    return false;
+  }
+
+  // Ordering key: frames with fewer than k accesses first, then whichever has the oldest relevant access, which is
+  // the k-th most recent one for full histories and the oldest known one (classic LRU) for the others.
+  bool found = false;
+  bool victim_full = true;
+  uint64_t victim_timestamp = UINT64_MAX;
+  for (size_t i = 0; i < frames_.size(); ++i) {
+    const FrameHistory &history = frames_[i];
+    if (!history.evictable_) {
+      continue;
+    }
+    bool full = history.accesses_.size() >= k_;
+    uint64_t timestamp = history.accesses_.front();
+    if (!found || (!full && victim_full) || (full == victim_full && timestamp < victim_timestamp)) {
+      found = true;
+      victim_full = full;
+      victim_timestamp = timestamp;
+      *frame_id = static_cast<frame_id_t>(i);
+    }
+  }
+
+  FrameHistory &victim = frames_[*frame_id];
+  victim.accesses_.clear();
+  victim.evictable_ = false;
+  --size_;
+  return true;
+}
+
+void LRUKReplacer::Pin(frame_id_t frame_id) {
+  if (frame_id < 0 || static_cast<size_t>(frame_id) >= frames_.size()) {
+    LOG_INFO("LRUKReplacer::Pin:Invalid frame id!");
+    return;
+  }
+  std::scoped_lock latch{latch_};
+  // the history is kept, so that a page that is pinned and unpinned over and over builds up its K accesses
+  FrameHistory &history = frames_[frame_id];
+  if (history.evictable_) {
+    history.evictable_ = false;
+    --size_;
+  }
+}
+
+void LRUKReplacer::Unpin(frame_id_t frame_id) {
+  if (frame_id < 0 || static_cast<size_t>(frame_id) >= frames_.size()) {
+    LOG_INFO("LRUKReplacer::Unpin:Invalid frame id!");
+    return;
+  }
+  std::scoped_lock latch{latch_};
+  FrameHistory &history = frames_[frame_id];
+  history.accesses_.push_back(current_timestamp_++);
+  if (history.accesses_.size() > k_) {
+    history.accesses_.pop_front();
+  }
+  if (!history.evictable_) {
+    history.evictable_ = true;
+    ++size_;
+  }
+}
+
+size_t LRUKReplacer::Size() {
+  std::scoped_lock latch{latch_};
+  return size_;
+}
+
+}  // namespace bustub
@@ -0,0 +1,126 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// mmap_buffer_pool_manager.cpp
+//
+// Identification: src/buffer/mmap_buffer_pool_manager.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/mmap_buffer_pool_manager.h"
+
+#include <sys/mman.h>
+
+#include <algorithm>
+
+#include "common/exception.h"
+#include "common/logger.h"
+
+namespace bustub {
+
+MmapBufferPoolManager::MmapBufferPoolManager(DiskManager *disk_manager)
+    : disk_manager_(disk_manager), num_pages_(static_cast<size_t>(disk_manager->GetNumPages())) {
+  if (num_pages_ > 0 && !disk_manager_->MapReadOnly()) {
+    throw Exception("cannot map the database file");
+  }
+  pages_ = std::make_unique<Page[]>(num_pages_);
+  loaded_ = std::make_unique<std::once_flag[]>(num_pages_);
+  copies_.resize(num_pages_);
+  for (size_t i = 0; i < num_pages_; ++i) {
+    pages_[i].page_id_ = static_cast<page_id_t>(i);
+  }
+}
+
+void MmapBufferPoolManager::LoadPage(page_id_t page_id) {
+  Page *page = &pages_[page_id];
+  const char *mapped = disk_manager_->GetMappedPage(page_id);
+  if (mapped != nullptr) {
+    // the mapping is read only, so writing through the page faults instead of corrupting the file
+    page->data_ = const_cast<char *>(mapped);
+    disk_manager_->VerifyPage(page_id, mapped);
+    return;
+  }
+  // ReadPage decompresses and verifies the page
+  copies_[page_id] = std::make_unique<char[]>(PAGE_SIZE);
+  disk_manager_->ReadPage(page_id, copies_[page_id].get());
+  page->data_ = copies_[page_id].get();
+}
+
+Page *MmapBufferPoolManager::FetchPageImpl(page_id_t page_id) {
+  if (page_id < 0 || static_cast<size_t>(page_id) >= num_pages_) {
+    return nullptr;
+  }
+  Page *page = &pages_[page_id];
+  if (page->data_ != nullptr) {
+    counters_.AddHit();
+  } else {
+    counters_.AddMiss();
+  }
+  std::call_once(loaded_[page_id], [this, page_id] { LoadPage(page_id); });
+  ++page->pin_count_;
+  return page;
+}
+
+Page *MmapBufferPoolManager::FetchPageWithStrategy(page_id_t page_id, BufferAccessStrategy *strategy) {
+  return FetchPageImpl(page_id);
+}
+
+std::vector<Page *> MmapBufferPoolManager::FetchPages(const std::vector<page_id_t> &page_ids) {
+  std::vector<Page *> pages;
+  pages.reserve(page_ids.size());
+  for (page_id_t page_id : page_ids) {
+    pages.push_back(FetchPageImpl(page_id));
+  }
+  return pages;
+}
+
+void MmapBufferPoolManager::PrefetchPages(const std::vector<page_id_t> &page_ids, BufferAccessStrategy *strategy) {
+  std::vector<const char *> mapped;
+  for (page_id_t page_id : page_ids) {
+    if (page_id >= 0 && static_cast<size_t>(page_id) < num_pages_) {
+      const char *data = disk_manager_->GetMappedPage(page_id);
+      if (data != nullptr) {
+        mapped.push_back(data);
+      }
+    }
+  }
+  // one hint per stretch of consecutive pages
+  std::sort(mapped.begin(), mapped.end());
+  for (size_t begin = 0, end = 0; begin < mapped.size(); begin = end) {
+    for (end = begin + 1; end < mapped.size() && mapped[end] == mapped[end - 1] + PAGE_SIZE; ++end) {
+    }
+    madvise(const_cast<char *>(mapped[begin]), (end - begin) * PAGE_SIZE, MADV_WILLNEED);
+  }
+}
+
+bool MmapBufferPoolManager::UnpinPageImpl(page_id_t page_id, bool is_dirty) {
+  if (page_id < 0 || static_cast<size_t>(page_id) >= num_pages_) {
+    return false;
+  }
+  if (is_dirty) {
+    LOG_WARN("page %d unpinned as dirty in a read-only buffer pool", page_id);
+    return false;
+  }
+  Page *page = &pages_[page_id];
+  int pin_count = page->pin_count_.load();
+  while (pin_count > 0 && !page->pin_count_.compare_exchange_weak(pin_count, pin_count - 1)) {
+  }
+  return pin_count > 0;
+}
+
+bool MmapBufferPoolManager::FlushPageImpl(page_id_t page_id) {
+  return page_id >= 0 && static_cast<size_t>(page_id) < num_pages_;
+}
+
+Page *MmapBufferPoolManager::NewPageImpl(page_id_t *page_id) { return nullptr; }
+
+Page *MmapBufferPoolManager::NewPageWithStrategy(page_id_t *page_id, BufferAccessStrategy *strategy) {
+  return nullptr;
+}
+
+bool MmapBufferPoolManager::DeletePageImpl(page_id_t page_id) { return false; }
+
+}  // namespace bustub
@@ -0,0 +1,82 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// page_guard.cpp
+//
+// Identification: src/buffer/page_guard.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/page_guard.h"
+
+#include <utility>
+
+#include "buffer/buffer_pool_manager.h"
+
+namespace bustub {
+
+ReadPageGuard::ReadPageGuard(ReadPageGuard &&that) noexcept
+    : bpm_(std::exchange(that.bpm_, nullptr)), page_(std::exchange(that.page_, nullptr)) {}
+
+ReadPageGuard &ReadPageGuard::operator=(ReadPageGuard &&that) noexcept {
+  if (this != &that) {
+    Drop();
+    bpm_ = std::exchange(that.bpm_, nullptr);
+    page_ = std::exchange(that.page_, nullptr);
+  }
+  return *this;
+}
+
+void ReadPageGuard::Drop() {
+  if (page_ == nullptr) {
+    return;
+  }
+  page_id_t page_id = page_->GetPageId();
+  page_->RUnlatch();
+  bpm_->UnpinPage(page_id, false);
+  page_ = nullptr;
+}
+
+page_id_t ReadPageGuard::PageId() const { return page_->GetPageId(); }
+
+const char *ReadPageGuard::GetData() const { return page_->GetData(); }
+
+WritePageGuard::WritePageGuard(WritePageGuard &&that) noexcept
+    : bpm_(std::exchange(that.bpm_, nullptr)),
+      page_(std::exchange(that.page_, nullptr)),
+      is_dirty_(std::exchange(that.is_dirty_, false)) {}
+
+WritePageGuard &WritePageGuard::operator=(WritePageGuard &&that) noexcept {
+  if (this != &that) {
+    Drop();
+    bpm_ = std::exchange(that.bpm_, nullptr);
+    page_ = std::exchange(that.page_, nullptr);
+    is_dirty_ = std::exchange(that.is_dirty_, false);
+  }
+  return *this;
+}
+
+void WritePageGuard::Drop() {
+  if (page_ == nullptr) {
+    return;
+  }
+  page_id_t page_id = page_->GetPageId();
+  page_->WUnlatch();
+  bpm_->UnpinPage(page_id, is_dirty_);
+  page_ = nullptr;
+  is_dirty_ = false;
+}
+
+page_id_t WritePageGuard::PageId() const { return page_->GetPageId(); }
+
+const char *WritePageGuard::GetData() const { return page_->GetData(); }
+
+char *WritePageGuard::GetDataMut() {
+  is_dirty_ = true;
+  return page_->GetData();
+}
+
+}  // namespace bustub
@@ -0,0 +1,186 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// parallel_buffer_pool_manager.cpp
+//
+// Identification: src/buffer/parallel_buffer_pool_manager.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/parallel_buffer_pool_manager.h"
+
+#include "common/macros.h"
+#include "common/util/numa.h"
+
+namespace bustub {
+
+ParallelBufferPoolManager::ParallelBufferPoolManager(size_t num_instances, size_t pool_size, DiskManager *disk_manager,
+                                                     LogManager *log_manager, ReplacerType replacer_type,
+                                                     size_t num_numa_nodes)
+    : pool_size_(pool_size), disk_manager_(disk_manager) {
+  BUSTUB_ASSERT(num_instances > 0, "a parallel buffer pool needs at least one instance");
+  if (num_numa_nodes == 0) {
+    num_numa_nodes = Numa::GetNodeCount();
+  }
+  // Allocate and create individual BufferPoolManagerInstances
+  instances_.reserve(num_instances);
+  for (size_t i = 0; i < num_instances; ++i) {
+    int numa_node = num_numa_nodes > 1 ? static_cast<int>(i % num_numa_nodes) : -1;
+    instances_.push_back(new BufferPoolManagerInstance(pool_size, num_instances, i, disk_manager, log_manager,
+                                                       replacer_type, numa_node));
+  }
+}
+
+ParallelBufferPoolManager::~ParallelBufferPoolManager() {
+  for (auto *instance : instances_) {
+    delete instance;
+  }
+}
+
+size_t ParallelBufferPoolManager::GetPoolSize() { return instances_.size() * pool_size_; }
+
+void ParallelBufferPoolManager::PrefetchPages(const std::vector<page_id_t> &page_ids, BufferAccessStrategy *strategy) {
+  std::vector<std::vector<page_id_t>> per_instance(instances_.size());
+  for (page_id_t page_id : page_ids) {
+    if (page_id != INVALID_PAGE_ID) {
+      per_instance[static_cast<size_t>(page_id) % instances_.size()].push_back(page_id);
+    }
+  }
+  for (size_t i = 0; i < instances_.size(); ++i) {
+    if (!per_instance[i].empty()) {
+      instances_[i]->PrefetchPages(per_instance[i], strategy);
+    }
+  }
+}
+
+BufferPoolStats ParallelBufferPoolManager::GetStats() {
+  BufferPoolStats stats;
+  for (auto *instance : instances_) {
+    stats += instance->GetStats();
+  }
+  return stats;
+}
+
+LatencySnapshot ParallelBufferPoolManager::GetFetchLatency() {
+  LatencySnapshot latency;
+  for (auto *instance : instances_) {
+    latency += instance->GetFetchLatency();
+  }
+  return latency;
+}
+
+std::vector<std::pair<page_id_t, lsn_t>> ParallelBufferPoolManager::GetDirtyPageTable() {
+  std::vector<std::pair<page_id_t, lsn_t>> dirty_pages;
+  for (auto *instance : instances_) {
+    auto instance_pages = instance->GetDirtyPageTable();
+    dirty_pages.insert(dirty_pages.end(), instance_pages.begin(), instance_pages.end());
+  }
+  return dirty_pages;
+}
+
+void ParallelBufferPoolManager::StartBackgroundFlusher() {
+  for (auto *instance : instances_) {
+    instance->StartBackgroundFlusher();
+  }
+}
+
+void ParallelBufferPoolManager::StopBackgroundFlusher() {
+  for (auto *instance : instances_) {
+    instance->StopBackgroundFlusher();
+  }
+}
+
+BufferPoolManagerInstance *ParallelBufferPoolManager::GetBufferPoolManager(page_id_t page_id) {
+  return instances_[static_cast<size_t>(page_id) % instances_.size()];
+}
+
+Page *ParallelBufferPoolManager::FetchPageImpl(page_id_t page_id) {
+  return GetBufferPoolManager(page_id)->FetchPage(page_id);
+}
+
+Page *ParallelBufferPoolManager::FetchPageWithStrategy(page_id_t page_id, BufferAccessStrategy *strategy) {
+  return GetBufferPoolManager(page_id)->FetchPageWithStrategy(page_id, strategy);
+}
+
+std::vector<Page *> ParallelBufferPoolManager::FetchPages(const std::vector<page_id_t> &page_ids) {
+  std::vector<std::vector<page_id_t>> per_instance(instances_.size());
+  std::vector<std::vector<size_t>> positions(instances_.size());
+  for (size_t i = 0; i < page_ids.size(); ++i) {
+    size_t instance = static_cast<size_t>(page_ids[i]) % instances_.size();
+    per_instance[instance].push_back(page_ids[i]);
+    positions[instance].push_back(i);
+  }
+
+  std::vector<Page *> result(page_ids.size(), nullptr);
+  for (size_t instance = 0; instance < instances_.size(); ++instance) {
+    if (per_instance[instance].empty()) {
+      continue;
+    }
+    std::vector<Page *> pages = instances_[instance]->FetchPages(per_instance[instance]);
+    for (size_t j = 0; j < pages.size(); ++j) {
+      result[positions[instance][j]] = pages[j];
+    }
+  }
+  return result;
+}
+
+bool ParallelBufferPoolManager::UnpinPageImpl(page_id_t page_id, bool is_dirty) {
+  return GetBufferPoolManager(page_id)->UnpinPage(page_id, is_dirty);
+}
+
+bool ParallelBufferPoolManager::FlushPageImpl(page_id_t page_id) {
+  if (page_id == INVALID_PAGE_ID) {
+    return false;
+  }
+  return GetBufferPoolManager(page_id)->FlushPage(page_id);
+}
+
+Page *ParallelBufferPoolManager::NewPageImpl(page_id_t *page_id) { return NewPageWithStrategy(page_id, nullptr); }
+
+Page *ParallelBufferPoolManager::NewPageWithStrategy(page_id_t *page_id, BufferAccessStrategy *strategy) {
+  // Reused page ids may land on any instance, but once the free ones are used up, fresh page ids come out of the disk
+  // manager in sequence and land on one instance after the other. Ids that did not fit are only given back at the
+  // end, so the disk manager moves on. Giving up after every instance was tried once means they all had all of
+  // their frames pinned.
+  Page *page = nullptr;
+  std::vector<page_id_t> rejected;
+  std::vector<bool> tried(instances_.size(), false);
+  size_t num_tried = 0;
+  while (page == nullptr && num_tried < instances_.size()) {
+    page_id_t new_page_id = disk_manager_->AllocatePage();
+    size_t instance = static_cast<size_t>(new_page_id) % instances_.size();
+    if (!tried[instance]) {
+      tried[instance] = true;
+      ++num_tried;
+      page = instances_[instance]->NewPageWithId(new_page_id, strategy);
+    }
+    if (page != nullptr) {
+      *page_id = new_page_id;
+    } else {
+      rejected.push_back(new_page_id);
+    }
+  }
+  for (page_id_t rejected_id : rejected) {
+    disk_manager_->DeallocatePage(rejected_id);
+  }
+  return page;
+}
+
+Page *ParallelBufferPoolManager::NewPageWithId(page_id_t page_id, BufferAccessStrategy *strategy) {
+  return GetBufferPoolManager(page_id)->NewPageWithId(page_id, strategy);
+}
+
+bool ParallelBufferPoolManager::DeletePageImpl(page_id_t page_id) {
+  return GetBufferPoolManager(page_id)->DeletePage(page_id);
+}
+
+void ParallelBufferPoolManager::FlushAllPagesImpl() {
+  for (auto *instance : instances_) {
+    instance->FlushAllPages();
+  }
+}
+
+}  // namespace bustub
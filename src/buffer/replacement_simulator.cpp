@@ -0,0 +1,96 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// replacement_simulator.cpp
+//
+// Identification: src/buffer/replacement_simulator.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/replacement_simulator.h"
+
+#include <algorithm>
+#include <atomic>
+#include <thread>  // NOLINT
+#include <unordered_map>
+#include <unordered_set>
+
+namespace bustub {
+
+std::vector<page_id_t> ReplacementSimulator::References(const std::vector<PageAccess> &accesses) {
+  std::vector<page_id_t> fetches;
+  std::vector<page_id_t> reads;
+  for (const PageAccess &access : accesses) {
+    if (access.type_ == PageAccessType::FETCH) {
+      fetches.push_back(access.page_id_);
+    } else if (access.type_ == PageAccessType::READ) {
+      reads.push_back(access.page_id_);
+    }
+  }
+  return fetches.empty() ? reads : fetches;
+}
+
+size_t ReplacementSimulator::GetNumDistinctPages() const {
+  return std::unordered_set<page_id_t>(references_.begin(), references_.end()).size();
+}
+
+SimulationResult ReplacementSimulator::Run(ReplacerType replacer_type, size_t pool_size) const {
+  SimulationResult result{replacer_type, pool_size};
+  if (pool_size == 0) {
+    result.misses_ = references_.size();
+    return result;
+  }
+  std::unique_ptr<Replacer> replacer = MakeReplacer(replacer_type, pool_size);
+  std::unordered_map<page_id_t, frame_id_t> page_table;
+  page_table.reserve(pool_size);
+  std::vector<page_id_t> frame_pages(pool_size, INVALID_PAGE_ID);
+  auto next_free = static_cast<frame_id_t>(0);
+
+  for (page_id_t page_id : references_) {
+    frame_id_t frame_id;
+    auto entry = page_table.find(page_id);
+    if (entry != page_table.end()) {
+      result.hits_++;
+      frame_id = entry->second;
+    } else {
+      result.misses_++;
+      if (static_cast<size_t>(next_free) < pool_size) {
+        frame_id = next_free++;
+      } else {
+        // every frame is unpinned, so there always is a victim
+        replacer->Victim(&frame_id);
+        page_table.erase(frame_pages[frame_id]);
+      }
+      frame_pages[frame_id] = page_id;
+      page_table.emplace(page_id, frame_id);
+    }
+    replacer->Unpin(frame_id);
+  }
+  return result;
+}
+
+std::vector<SimulationResult> ReplacementSimulator::RunAll(const std::vector<size_t> &pool_sizes,
+                                                           const std::vector<ReplacerType> &replacer_types,
+                                                           size_t num_threads) const {
+  std::vector<SimulationResult> results(pool_sizes.size() * replacer_types.size());
+  std::atomic<size_t> next{0};
+  auto work = [&] {
+    for (size_t run = next++; run < results.size(); run = next++) {
+      results[run] = Run(replacer_types[run % replacer_types.size()], pool_sizes[run / replacer_types.size()]);
+    }
+  };
+  std::vector<std::thread> threads;
+  for (size_t thread = 1; thread < std::min(num_threads, results.size()); thread++) {
+    threads.emplace_back(work);
+  }
+  work();
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  return results;
+}
+
+}  // namespace bustub
@@ -0,0 +1,50 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// replacer.cpp
+//
+// Identification: src/buffer/replacer.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/replacer.h"
+
+#include "buffer/atomic_clock_replacer.h"
+#include "buffer/clock_replacer.h"
+#include "buffer/lru_k_replacer.h"
+#include "buffer/lru_replacer.h"
+
+namespace bustub {
+
+std::unique_ptr<Replacer> MakeReplacer(ReplacerType type, size_t num_pages) {
+  switch (type) {
+    case ReplacerType::CLOCK:
+      return std::make_unique<ClockReplacer>(num_pages);
+    case ReplacerType::LRU:
+      return std::make_unique<LRUReplacer>(num_pages);
+    case ReplacerType::LRU_K:
+      return std::make_unique<LRUKReplacer>(num_pages, LRUK_REPLACER_K);
+    case ReplacerType::ATOMIC_CLOCK:
+      return std::make_unique<AtomicClockReplacer>(num_pages);
+  }
+  return nullptr;
+}
+
+const char *ReplacerTypeName(ReplacerType type) {
+  switch (type) {
+    case ReplacerType::CLOCK:
+      return "clock";
+    case ReplacerType::LRU:
+      return "lru";
+    case ReplacerType::LRU_K:
+      return "lru_k";
+    case ReplacerType::ATOMIC_CLOCK:
+      return "atomic_clock";
+  }
+  return "unknown";
+}
+
+}  // namespace bustub
@@ -0,0 +1,382 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// bulk_loader.cpp
+//
+// Identification: src/catalog/bulk_loader.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "catalog/bulk_loader.h"
+
+#include <atomic>
+#include <cctype>
+#include <charconv>
+#include <cstring>
+#include <exception>
+#include <fstream>
+#include <mutex>  // NOLINT
+
+#include "buffer/buffer_access_strategy.h"
+#include "common/exception.h"
+#include "type/value_factory.h"
+
+namespace bustub {
+
+BulkLoadStats BulkLoader::Load(const std::string &table_name, const std::vector<std::string> &files,
+                               const BulkLoadOptions &options) {
+  TableMetadata *table_info = catalog_->GetTable(table_name);
+  if (table_info->table_ == nullptr) {
+    throw Exception(ExceptionType::NOT_IMPLEMENTED, "only tables of the ROW layout are bulk loaded");
+  }
+  TableHeap *table = table_info->table_.get();
+  const Schema &schema = table_info->schema_;
+  std::vector<IndexInfo *> indexes = catalog_->GetTableIndexes(table_name);
+  std::vector<Chunk> chunks = Split(files, options);
+
+  size_t num_threads = std::clamp<size_t>(options.num_threads_, 1, std::max<size_t>(chunks.size(), 1));
+  // the entries of each index, kept apart by thread until the indexes are built
+  std::vector<std::vector<std::vector<std::pair<Tuple, RID>>>> entries(
+      num_threads, std::vector<std::vector<std::pair<Tuple, RID>>>(indexes.size()));
+  std::atomic<size_t> next_chunk{0};
+  std::atomic<uint64_t> rows{0};
+  std::atomic<uint64_t> pages{0};
+  std::atomic<uint64_t> bytes{0};
+  std::mutex error_latch;
+  std::exception_ptr error;
+  auto load = [&](size_t thread) {
+    BufferAccessStrategy strategy(BufferAccessStrategy::BulkRingSize(table->GetBufferPoolManager()->GetPoolSize()));
+    std::vector<Tuple> tuples;
+    std::vector<RID> rids;
+    for (size_t i = next_chunk++; i < chunks.size(); i = next_chunk++) {
+      const Chunk &chunk = chunks[i];
+      try {
+        tuples.clear();
+        if (options.format_ == BulkLoadFormat::CSV) {
+          ParseCsv(files[chunk.file_], chunk, schema, options, &tuples);
+        } else {
+          ReadBinary(files[chunk.file_], chunk, &tuples);
+        }
+        bool appended = table->AppendTuples(tuples, &rids, &strategy);
+        for (size_t index = 0; index < indexes.size(); index++) {
+          const std::vector<uint32_t> &key_attrs = indexes[index]->index_->GetKeyAttrs();
+          for (size_t row = 0; row < rids.size(); row++) {
+            entries[thread][index].emplace_back(
+                tuples[row].KeyFromTuple(schema, indexes[index]->key_schema_, key_attrs), rids[row]);
+          }
+        }
+        for (size_t row = 0; row < rids.size(); row++) {
+          if (row == 0 || rids[row].GetPageId() != rids[row - 1].GetPageId()) {
+            pages++;
+          }
+        }
+        rows += rids.size();
+        bytes += chunk.end_ - chunk.begin_;
+        if (!appended) {
+          throw Exception(ExceptionType::OUT_OF_MEMORY,
+                          "a row of " + files[chunk.file_] + " is too large for a page, or no frame was left for one");
+        }
+      } catch (...) {
+        std::scoped_lock latch{error_latch};
+        if (error == nullptr) {
+          error = std::current_exception();
+        }
+        // the other threads stop once they are done with their chunks
+        next_chunk = chunks.size();
+        return;
+      }
+    }
+  };
+  std::vector<std::thread> threads;
+  for (size_t thread = 1; thread < num_threads; thread++) {
+    threads.emplace_back(load, thread);
+  }
+  load(0);
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  // each index is built from all of its entries at once, the indexes side by side
+  std::atomic<size_t> next_index{0};
+  auto build = [&] {
+    for (size_t index = next_index++; index < indexes.size(); index = next_index++) {
+      std::vector<std::pair<Tuple, RID>> index_entries;
+      for (auto &thread_entries : entries) {
+        index_entries.insert(index_entries.end(), std::make_move_iterator(thread_entries[index].begin()),
+                             std::make_move_iterator(thread_entries[index].end()));
+        thread_entries[index] = {};
+      }
+      indexes[index]->index_->InsertEntries(index_entries, nullptr);
+    }
+  };
+  threads.clear();
+  for (size_t thread = 1; thread < std::min(num_threads, indexes.size()); thread++) {
+    threads.emplace_back(build);
+  }
+  build();
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  // nothing of the load is in the log, so its pages are written back before restart could need them
+  if (enable_logging) {
+    table->GetBufferPoolManager()->FlushAllPages();
+    if (checkpoint_manager_ != nullptr) {
+      checkpoint_manager_->FuzzyCheckpoint();
+    }
+  }
+  if (error != nullptr) {
+    std::rethrow_exception(error);
+  }
+  return {rows, pages, bytes};
+}
+
+bool BulkLoader::WriteBinary(const std::string &file_name, const std::vector<Tuple> &tuples) {
+  std::ofstream out(file_name, std::ios::binary | std::ios::trunc);
+  out.write(BINARY_MAGIC, sizeof(BINARY_MAGIC));
+  std::string block;
+  uint32_t num_tuples = 0;
+  auto write_block = [&] {
+    uint32_t header[2] = {num_tuples, static_cast<uint32_t>(block.size())};
+    out.write(reinterpret_cast<const char *>(header), sizeof(header));
+    out.write(block.data(), static_cast<std::streamsize>(block.size()));
+    block.clear();
+    num_tuples = 0;
+  };
+  for (const Tuple &tuple : tuples) {
+    size_t size = sizeof(int32_t) + tuple.GetLength();
+    if (num_tuples > 0 && block.size() + size > BINARY_BLOCK_SIZE) {
+      write_block();
+    }
+    block.resize(block.size() + size);
+    tuple.SerializeTo(block.data() + block.size() - size);
+    num_tuples++;
+  }
+  if (num_tuples > 0) {
+    write_block();
+  }
+  out.close();
+  return !out.fail();
+}
+
+std::vector<BulkLoader::Chunk> BulkLoader::Split(const std::vector<std::string> &files,
+                                                 const BulkLoadOptions &options) {
+  std::vector<Chunk> chunks;
+  uint64_t chunk_size = std::max<size_t>(options.chunk_size_, 1);
+  for (size_t file = 0; file < files.size(); file++) {
+    std::ifstream in(files[file], std::ios::binary | std::ios::ate);
+    if (!in) {
+      throw Exception("cannot open " + files[file] + " to load");
+    }
+    auto size = static_cast<uint64_t>(in.tellg());
+    if (options.format_ == BulkLoadFormat::CSV) {
+      for (uint64_t begin = 0; begin < size; begin += chunk_size) {
+        chunks.push_back({file, begin, std::min(begin + chunk_size, size)});
+      }
+      continue;
+    }
+
+    char magic[sizeof(BINARY_MAGIC)];
+    in.seekg(0);
+    if (!in.read(magic, sizeof(magic)) || std::memcmp(magic, BINARY_MAGIC, sizeof(BINARY_MAGIC)) != 0) {
+      throw Exception(ExceptionType::CONVERSION, files[file] + " is not a file of the BINARY format");
+    }
+    // only the headers of the blocks are read, to find where they are
+    uint64_t begin = sizeof(BINARY_MAGIC);
+    uint64_t end = begin;
+    while (end < size) {
+      uint32_t header[2];
+      in.seekg(static_cast<std::streamoff>(end));
+      if (!in.read(reinterpret_cast<char *>(header), sizeof(header)) || end + sizeof(header) + header[1] > size) {
+        throw Exception(ExceptionType::CONVERSION, files[file] + " ends in part of a block");
+      }
+      end += sizeof(header) + header[1];
+      if (end - begin >= chunk_size) {
+        chunks.push_back({file, begin, end});
+        begin = end;
+      }
+    }
+    if (end > begin) {
+      chunks.push_back({file, begin, end});
+    }
+  }
+  return chunks;
+}
+
+void BulkLoader::ParseCsv(const std::string &file_name, const Chunk &chunk, const Schema &schema,
+                          const BulkLoadOptions &options, std::vector<Tuple> *tuples) {
+  // the byte before the chunk tells whether a line starts with it
+  uint64_t read_begin = chunk.begin_ == 0 ? 0 : chunk.begin_ - 1;
+  std::ifstream in(file_name, std::ios::binary);
+  std::string data(chunk.end_ - read_begin, '\0');
+  in.seekg(static_cast<std::streamoff>(read_begin));
+  if (!in.read(data.data(), static_cast<std::streamsize>(data.size()))) {
+    throw Exception("cannot read " + file_name + " to load");
+  }
+  // the line that starts last in the chunk is read to its end, past the chunk
+  if (data.back() != '\n') {
+    char block[4096];
+    while (in.read(block, sizeof(block)) || in.gcount() > 0) {
+      auto count = static_cast<size_t>(in.gcount());
+      const void *newline = std::memchr(block, '\n', count);
+      if (newline != nullptr) {
+        data.append(block, static_cast<const char *>(newline) - block + 1);
+        break;
+      }
+      data.append(block, count);
+    }
+  }
+
+  size_t end = chunk.end_ - read_begin;
+  size_t pos = 0;
+  // a line that starts before the chunk is the chunk before's, and a header is nobody's
+  if (chunk.begin_ > 0 || options.header_) {
+    size_t newline = data.find('\n');
+    pos = newline == std::string::npos ? data.size() : newline + 1;
+  }
+  std::string line;
+  while (pos < end) {
+    size_t line_end = std::min(data.find('\n', pos), data.size());
+    line.assign(data, pos, line_end - pos);
+    if (!line.empty() && line.back() == '\r') {
+      line.pop_back();
+    }
+    if (!line.empty()) {
+      tuples->push_back(ParseCsvLine(line, read_begin + pos, file_name, schema, options.delimiter_));
+    }
+    pos = line_end + 1;
+  }
+}
+
+Tuple BulkLoader::ParseCsvLine(const std::string &line, uint64_t offset, const std::string &file_name,
+                               const Schema &schema, char delimiter) {
+  auto fail = [&](const std::string &what) {
+    throw Exception(ExceptionType::CONVERSION,
+                    file_name + ": the line at byte " + std::to_string(offset) + " " + what + ": " + line);
+  };
+  std::vector<Value> values;
+  values.reserve(schema.GetColumnCount());
+  std::string field;
+  size_t pos = 0;
+  while (true) {
+    field.clear();
+    bool quoted = pos < line.size() && line[pos] == '"';
+    if (quoted) {
+      bool closed = false;
+      for (pos++; pos < line.size(); pos++) {
+        if (line[pos] == '"') {
+          if (pos + 1 < line.size() && line[pos + 1] == '"') {
+            field += '"';
+            pos++;
+            continue;
+          }
+          closed = true;
+          pos++;
+          break;
+        }
+        field += line[pos];
+      }
+      if (!closed || (pos < line.size() && line[pos] != delimiter)) {
+        fail("has a quoted field that is not closed before its delimiter");
+      }
+    } else {
+      size_t field_end = std::min(line.find(delimiter, pos), line.size());
+      field.assign(line, pos, field_end - pos);
+      pos = field_end;
+    }
+    if (values.size() == schema.GetColumnCount()) {
+      fail("has more fields than the table has columns");
+    }
+    const Column &column = schema.GetColumn(values.size());
+    bool ok;
+    values.push_back(ParseField(field, quoted, column.GetType(), &ok));
+    if (!ok) {
+      fail("has a bad value of column " + column.GetName());
+    }
+    if (pos >= line.size()) {
+      break;
+    }
+    pos++;
+  }
+  if (values.size() != schema.GetColumnCount()) {
+    fail("has fewer fields than the table has columns");
+  }
+  return Tuple(values, &schema);
+}
+
+Value BulkLoader::ParseField(const std::string &field, bool quoted, TypeId type, bool *ok) {
+  *ok = true;
+  if (field.empty() && !quoted) {
+    return ValueFactory::GetNullValueByType(type);
+  }
+  const char *begin = field.data();
+  const char *end = begin + field.size();
+  auto parse = [&](auto number) {
+    auto [ptr, ec] = std::from_chars(begin, end, number);
+    *ok = ec == std::errc() && ptr == end;
+    return Value(type, number);
+  };
+  switch (type) {
+    case TypeId::BOOLEAN: {
+      std::string lower = field;
+      std::transform(lower.begin(), lower.end(), lower.begin(), [](unsigned char c) { return std::tolower(c); });
+      if (lower == "true" || lower == "t" || lower == "1") {
+        return Value(type, static_cast<int8_t>(1));
+      }
+      *ok = lower == "false" || lower == "f" || lower == "0";
+      return Value(type, static_cast<int8_t>(0));
+    }
+    case TypeId::TINYINT:
+      return parse(int8_t{0});
+    case TypeId::SMALLINT:
+      return parse(int16_t{0});
+    case TypeId::INTEGER:
+      return parse(int32_t{0});
+    case TypeId::BIGINT:
+      return parse(int64_t{0});
+    case TypeId::DECIMAL:
+      return parse(0.0);
+    case TypeId::TIMESTAMP:
+      return parse(uint64_t{0});
+    case TypeId::VARCHAR:
+      return Value(type, field);
+    default:
+      *ok = false;
+      return ValueFactory::GetNullValueByType(type);
+  }
+}
+
+void BulkLoader::ReadBinary(const std::string &file_name, const Chunk &chunk, std::vector<Tuple> *tuples) {
+  std::ifstream in(file_name, std::ios::binary);
+  std::string data(chunk.end_ - chunk.begin_, '\0');
+  in.seekg(static_cast<std::streamoff>(chunk.begin_));
+  if (!in.read(data.data(), static_cast<std::streamsize>(data.size()))) {
+    throw Exception("cannot read " + file_name + " to load");
+  }
+  size_t pos = 0;
+  while (pos < data.size()) {
+    uint32_t header[2];
+    std::memcpy(header, data.data() + pos, sizeof(header));
+    pos += sizeof(header);
+    size_t block_end = pos + header[1];
+    for (uint32_t i = 0; i < header[0]; i++) {
+      uint32_t size = 0;
+      if (pos + sizeof(size) <= block_end) {
+        std::memcpy(&size, data.data() + pos, sizeof(size));
+      }
+      if (pos + sizeof(size) + size > block_end || size == 0) {
+        throw Exception(ExceptionType::CONVERSION,
+                        file_name + ": the block at byte " + std::to_string(chunk.begin_ + pos) + " is corrupt");
+      }
+      tuples->emplace_back();
+      tuples->back().DeserializeFrom(data.data() + pos);
+      pos += sizeof(size) + size;
+    }
+    pos = block_end;
+  }
+}
+
+}  // namespace bustub
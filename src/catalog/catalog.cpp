@@ -0,0 +1,606 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// catalog.cpp
+//
+// Identification: src/catalog/catalog.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "catalog/catalog.h"
+
+#include <algorithm>
+#include <cstring>
+#include <optional>
+#include <thread>  // NOLINT
+#include <unordered_map>
+#include <unordered_set>
+
+#include "buffer/buffer_access_strategy.h"
+#include "storage/index/generic_key.h"
+#include "storage/table/parallel_table_scan.h"
+
+namespace bustub {
+
+namespace {
+
+/** Appends the metadata to a buffer, field by field */
+class CatalogWriter {
+ public:
+  template <typename T>
+  void Put(T value) {
+    bytes_.append(reinterpret_cast<const char *>(&value), sizeof(T));
+  }
+
+  void PutString(const std::string &str) {
+    Put(static_cast<uint32_t>(str.size()));
+    bytes_.append(str);
+  }
+
+  void PutSchema(const Schema &schema) {
+    Put(schema.GetColumnCount());
+    for (const Column &column : schema.GetColumns()) {
+      PutString(column.GetName());
+      Put(column.GetType());
+      Put(column.GetVariableLength());
+    }
+  }
+
+  void PutValue(const Value &value) {
+    // a fixed-width value takes at most 8 bytes, a VARCHAR its length field and its bytes
+    size_t size = value.GetTypeId() != TypeId::VARCHAR
+                      ? sizeof(uint64_t)
+                      : sizeof(uint32_t) + (value.IsNull() ? 0 : value.GetLength());
+    std::string storage(size, '\0');
+    value.SerializeTo(storage.data());
+    PutString(storage);
+  }
+
+  const std::string &GetBytes() const { return bytes_; }
+
+ private:
+  std::string bytes_;
+};
+
+/** Reads the metadata back, in the order it was written */
+class CatalogReader {
+ public:
+  explicit CatalogReader(const std::string &bytes) : bytes_(bytes) {}
+
+  template <typename T>
+  T Get() {
+    BUSTUB_ASSERT(offset_ + sizeof(T) <= bytes_.size(), "the catalog pages end early");
+    T value;
+    memcpy(&value, bytes_.data() + offset_, sizeof(T));
+    offset_ += sizeof(T);
+    return value;
+  }
+
+  std::string GetString() {
+    auto size = Get<uint32_t>();
+    BUSTUB_ASSERT(offset_ + size <= bytes_.size(), "the catalog pages end early");
+    std::string str = bytes_.substr(offset_, size);
+    offset_ += size;
+    return str;
+  }
+
+  Schema GetSchema() {
+    auto column_count = Get<uint32_t>();
+    std::vector<Column> columns;
+    for (uint32_t i = 0; i < column_count; i++) {
+      std::string name = GetString();
+      auto type = Get<TypeId>();
+      auto length = Get<uint32_t>();
+      if (type == TypeId::VARCHAR) {
+        columns.emplace_back(name, type, length);
+      } else {
+        columns.emplace_back(name, type);
+      }
+    }
+    return Schema(columns);
+  }
+
+  Value GetValue(TypeId type) {
+    std::string storage = GetString();
+    return Value::DeserializeFrom(storage.data(), type);
+  }
+
+ private:
+  const std::string &bytes_;
+  size_t offset_{0};
+};
+
+/** @return the index of the key size CreateIndex was given, reattached to its tree */
+template <size_t KeySize>
+std::unique_ptr<Index> ReopenIndex(IndexMetadata *metadata, BufferPoolManager *bpm, LockManager *lock_manager,
+                                   index_oid_t oid) {
+  auto index = std::make_unique<BPlusTreeIndex<GenericKey<KeySize>, RID, GenericComparator<KeySize>>>(metadata, bpm);
+  // an index whose tree has no root yet has no record either, and stays empty
+  index->Reopen();
+  index->SetLockManager(lock_manager, oid);
+  return index;
+}
+
+std::unique_ptr<Index> ReopenIndex(IndexMetadata *metadata, BufferPoolManager *bpm, LockManager *lock_manager,
+                                   index_oid_t oid, size_t key_size) {
+  switch (key_size) {
+    case 4:
+      return ReopenIndex<4>(metadata, bpm, lock_manager, oid);
+    case 8:
+      return ReopenIndex<8>(metadata, bpm, lock_manager, oid);
+    case 16:
+      return ReopenIndex<16>(metadata, bpm, lock_manager, oid);
+    case 32:
+      return ReopenIndex<32>(metadata, bpm, lock_manager, oid);
+    case 64:
+      return ReopenIndex<64>(metadata, bpm, lock_manager, oid);
+    default:
+      delete metadata;
+      throw Exception(ExceptionType::NOT_IMPLEMENTED, "indexes are of keys of 4, 8, 16, 32 or 64 bytes");
+  }
+}
+
+}  // namespace
+
+void Catalog::Open() {
+  BUSTUB_ASSERT(tables_.empty() && indexes_.empty(), "a catalog is opened before any table is created");
+  persistent_ = true;
+  Page *page = bpm_->FetchPage(HEADER_PAGE_ID);
+  if (page == nullptr) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "cannot fetch the header page");
+  }
+  page->RLatch();
+  bool found = static_cast<HeaderPage *>(page)->GetRootId(CATALOG_RECORD_NAME, &catalog_page_id_);
+  page->RUnlatch();
+  bpm_->UnpinPage(HEADER_PAGE_ID, false);
+  if (!found) {
+    catalog_page_id_ = INVALID_PAGE_ID;
+    return;
+  }
+
+  std::string bytes;
+  for (page_id_t page_id = catalog_page_id_; page_id != INVALID_PAGE_ID;) {
+    auto catalog_page = static_cast<CatalogPage *>(bpm_->FetchPage(page_id));
+    if (catalog_page == nullptr) {
+      throw Exception(ExceptionType::OUT_OF_MEMORY, "cannot fetch a catalog page");
+    }
+    bytes.append(catalog_page->GetPayload(), catalog_page->GetSize());
+    page_id_t next_page_id = catalog_page->GetNextPageId();
+    bpm_->UnpinPage(page_id, false);
+    page_id = next_page_id;
+  }
+
+  CatalogReader reader(bytes);
+  next_table_oid_ = reader.Get<table_oid_t>();
+  next_index_oid_ = reader.Get<index_oid_t>();
+  auto table_count = reader.Get<uint32_t>();
+  for (uint32_t i = 0; i < table_count; i++) {
+    auto oid = reader.Get<table_oid_t>();
+    std::string name = reader.GetString();
+    auto layout = reader.Get<TableLayout>();
+    auto first_page_id = reader.Get<page_id_t>();
+    auto table_info = std::make_unique<TableMetadata>(reader.GetSchema(), name, nullptr, oid);
+    table_info->layout_ = layout;
+    if (reader.Get<bool>()) {
+      PartitionScheme scheme;
+      scheme.method_ = reader.Get<PartitionMethod>();
+      scheme.key_idx_ = reader.Get<uint32_t>();
+      scheme.num_partitions_ = reader.Get<uint64_t>();
+      auto bound_count = reader.Get<uint32_t>();
+      for (uint32_t b = 0; b < bound_count; b++) {
+        scheme.bounds_.push_back(reader.GetValue(table_info->schema_.GetColumn(scheme.key_idx_).GetType()));
+      }
+      std::vector<page_id_t> first_page_ids;
+      for (size_t p = 0; p < scheme.num_partitions_; p++) {
+        first_page_ids.push_back(reader.Get<page_id_t>());
+      }
+      table_info->partitions_ = std::make_unique<PartitionedTable>(bpm_, lock_manager_, log_manager_,
+                                                                   &table_info->schema_, std::move(scheme), oid,
+                                                                   first_page_ids);
+      for (TableHeap *heap : table_info->GetHeaps()) {
+        heap->AddWriteObserver(&index_rollback_);
+      }
+    } else if (layout == TableLayout::PAX) {
+      table_info->pax_table_ = std::make_unique<PaxTableHeap>(bpm_, &table_info->schema_, first_page_id);
+    } else if (layout == TableLayout::CLUSTERED) {
+      // the tree is found by its name in the header page, and has no record there until the first insert
+      auto key_idx = reader.Get<uint32_t>();
+      table_info->clustered_table_ = std::make_unique<ClusteredTable>(bpm_, &table_info->schema_, key_idx, oid);
+      table_info->clustered_table_->Reopen();
+    } else {
+      table_info->table_ = std::make_unique<TableHeap>(bpm_, lock_manager_, log_manager_, first_page_id);
+      table_info->table_->EnableToast(&table_info->schema_);
+      table_info->table_->SetTableOid(oid);
+      table_info->table_->AddWriteObserver(&index_rollback_);
+    }
+    if (reader.Get<bool>()) {
+      auto row_count = reader.Get<uint64_t>();
+      std::vector<ColumnStatistics> columns;
+      for (const Column &column : table_info->schema_.GetColumns()) {
+        auto null_fraction = reader.Get<double>();
+        auto distinct_count = reader.Get<double>();
+        std::vector<Value> bounds;
+        auto bound_count = reader.Get<uint32_t>();
+        for (uint32_t b = 0; b < bound_count; b++) {
+          bounds.push_back(reader.GetValue(column.GetType()));
+        }
+        columns.emplace_back(null_fraction, distinct_count, std::move(bounds));
+      }
+      table_info->statistics_ = std::make_unique<TableStatistics>(row_count, std::move(columns));
+    }
+    names_[name] = oid;
+    tables_[oid] = std::move(table_info);
+  }
+
+  auto index_count = reader.Get<uint32_t>();
+  for (uint32_t i = 0; i < index_count; i++) {
+    auto oid = reader.Get<index_oid_t>();
+    std::string name = reader.GetString();
+    std::string table_name = reader.GetString();
+    auto key_size = reader.Get<uint64_t>();
+    Schema key_schema = reader.GetSchema();
+    auto key_attr_count = reader.Get<uint32_t>();
+    std::vector<uint32_t> key_attrs;
+    for (uint32_t k = 0; k < key_attr_count; k++) {
+      key_attrs.push_back(reader.Get<uint32_t>());
+    }
+    auto *metadata = new IndexMetadata(name, table_name, &GetTable(table_name)->schema_, key_attrs);
+    std::unique_ptr<Index> index = ReopenIndex(metadata, bpm_, lock_manager_, oid, key_size);
+    indexes_[oid] = std::make_unique<IndexInfo>(key_schema, name, std::move(index), oid, table_name, key_size);
+    index_names_[table_name][name] = oid;
+  }
+}
+
+void Catalog::InsertIndexEntry(IndexInfo *index_info, const Tuple &key, const RID &rid, Transaction *txn) {
+  LogIndexEntry(LogRecordType::INDEXINSERT, index_info, key, rid, txn);
+  if (index_info->building_.load() && CaptureIndexEntries(index_info, true, {{key, rid}})) {
+    return;
+  }
+  index_info->index_->InsertEntry(key, rid, txn);
+}
+
+void Catalog::DeleteIndexEntry(IndexInfo *index_info, const Tuple &key, const RID &rid, Transaction *txn) {
+  LogIndexEntry(LogRecordType::INDEXDELETE, index_info, key, rid, txn);
+  if (index_info->building_.load() && CaptureIndexEntries(index_info, false, {{key, rid}})) {
+    return;
+  }
+  index_info->index_->DeleteEntry(key, rid, txn);
+}
+
+void Catalog::InsertIndexEntries(IndexInfo *index_info, const std::vector<std::pair<Tuple, RID>> &entries,
+                                 Transaction *txn) {
+  for (const auto &[key, rid] : entries) {
+    LogIndexEntry(LogRecordType::INDEXINSERT, index_info, key, rid, txn);
+  }
+  if (index_info->building_.load() && CaptureIndexEntries(index_info, true, entries)) {
+    return;
+  }
+  index_info->index_->InsertEntries(entries, txn);
+}
+
+void Catalog::DeleteIndexEntries(IndexInfo *index_info, const std::vector<std::pair<Tuple, RID>> &entries,
+                                 Transaction *txn) {
+  for (const auto &[key, rid] : entries) {
+    LogIndexEntry(LogRecordType::INDEXDELETE, index_info, key, rid, txn);
+  }
+  if (index_info->building_.load() && CaptureIndexEntries(index_info, false, entries)) {
+    return;
+  }
+  index_info->index_->DeleteEntries(entries, txn);
+}
+
+IndexInfo *Catalog::RegisterIndex(std::unique_ptr<IndexInfo> index_info) {
+  std::unique_lock latch(index_latch_);
+  BUSTUB_ASSERT(index_names_[index_info->table_name_].count(index_info->name_) == 0,
+                "Index names should be unique per table!");
+  IndexInfo *registered = index_info.get();
+  registered->building_ = true;
+  index_names_[registered->table_name_][registered->name_] = registered->index_oid_;
+  indexes_[registered->index_oid_] = std::move(index_info);
+  index_version_++;
+  return registered;
+}
+
+void Catalog::FinishIndexBuild(IndexInfo *index_info) {
+  // the writers wait for the changes before theirs to be applied, which are few next to the rows of the table
+  std::scoped_lock latch(index_info->build_latch_);
+  for (const auto &[insert, key, rid] : index_info->build_log_) {
+    if (insert) {
+      index_info->index_->InsertEntry(key, rid, nullptr);
+    } else {
+      index_info->index_->DeleteEntry(key, rid, nullptr);
+    }
+  }
+  index_info->build_log_.clear();
+  index_info->build_log_.shrink_to_fit();
+  index_info->building_ = false;
+}
+
+bool Catalog::CaptureIndexEntries(IndexInfo *index_info, bool insert,
+                                  const std::vector<std::pair<Tuple, RID>> &entries) {
+  std::scoped_lock latch(index_info->build_latch_);
+  // the build may have finished since the caller looked
+  if (!index_info->building_.load()) {
+    return false;
+  }
+  for (const auto &[key, rid] : entries) {
+    index_info->build_log_.emplace_back(insert, key, rid);
+  }
+  return true;
+}
+
+std::vector<std::pair<Tuple, RID>> Catalog::ScanIndexEntries(TableMetadata *table_info, const Schema &schema,
+                                                             const Schema &key_schema,
+                                                             const std::vector<uint32_t> &key_attrs,
+                                                             size_t num_threads) {
+  num_threads = std::max<size_t>(num_threads, 1);
+  std::vector<std::vector<std::pair<Tuple, RID>>> runs(num_threads);
+  for (TableHeap *table : table_info->GetHeaps()) {
+    ParallelTableScan scan(table, ParallelTableScan::PAGES_PER_MORSEL, nullptr, num_threads);
+    auto work = [&](size_t worker) {
+      // every worker reads through a ring of its own, so that the build does not flush the buffer pool
+      BufferPoolManager *bpm = table->GetBufferPoolManager();
+      BufferAccessStrategy strategy(BufferAccessStrategy::BulkRingSize(bpm->GetPoolSize()));
+      std::vector<page_id_t> morsel;
+      Tuple view;
+      while (scan.NextMorsel(&morsel, worker)) {
+        // no transaction, so no row locks: the rows that change meanwhile have their changes logged
+        TablePageScanner scanner(table, nullptr, morsel, &strategy);
+        while (scanner.Next(&view)) {
+          runs[worker].emplace_back(view.KeyFromTuple(schema, key_schema, key_attrs), view.GetRid());
+        }
+      }
+    };
+    std::vector<std::thread> threads;
+    for (size_t worker = 1; worker < num_threads; worker++) {
+      threads.emplace_back(work, worker);
+    }
+    work(0);
+    for (std::thread &thread : threads) {
+      thread.join();
+    }
+
+    // the pages linked since the scan started are scanned as well, for the rows appended there by writers that do
+    // not go through InsertIndexEntries, e.g. a BulkLoader that looked the indexes up before this one was registered
+    const std::vector<page_id_t> &scanned = scan.GetPageIds();
+    std::unordered_set<page_id_t> scanned_pages(scanned.begin(), scanned.end());
+    std::vector<page_id_t> appended;
+    for (page_id_t page_id : table->GetPageIds()) {
+      if (scanned_pages.count(page_id) == 0) {
+        appended.push_back(page_id);
+      }
+    }
+    TablePageScanner scanner(table, nullptr, appended);
+    Tuple view;
+    while (scanner.Next(&view)) {
+      runs[0].emplace_back(view.KeyFromTuple(schema, key_schema, key_attrs), view.GetRid());
+    }
+  }
+  std::vector<std::pair<Tuple, RID>> entries = std::move(runs[0]);
+  for (size_t worker = 1; worker < num_threads; worker++) {
+    entries.insert(entries.end(), std::make_move_iterator(runs[worker].begin()),
+                   std::make_move_iterator(runs[worker].end()));
+  }
+  return entries;
+}
+
+void Catalog::LogIndexEntry(LogRecordType type, IndexInfo *index_info, const Tuple &key, const RID &rid,
+                            Transaction *txn) {
+  if (!enable_logging || log_manager_ == nullptr || txn == nullptr) {
+    return;
+  }
+  // logged before the index has it, as the page records are
+  LogRecord record(txn->GetTransactionId(), txn->GetPrevLSN(), type, index_info->index_oid_, rid, key);
+  txn->SetPrevLSN(log_manager_->AppendLogRecord(&record));
+}
+
+void Catalog::Persist() {
+  if (!persistent_) {
+    return;
+  }
+  CatalogWriter writer;
+  writer.Put<table_oid_t>(next_table_oid_);
+  writer.Put<index_oid_t>(next_index_oid_);
+  // the in-memory tables, and their indexes, are left out, as their rows are gone at the next Open
+  auto persisted = [](const TableMetadata &table_info) { return table_info.layout_ != TableLayout::MEMORY; };
+  writer.Put(static_cast<uint32_t>(
+      std::count_if(tables_.begin(), tables_.end(), [&](const auto &table) { return persisted(*table.second); })));
+  for (const auto &[oid, table_info] : tables_) {
+    if (!persisted(*table_info)) {
+      continue;
+    }
+    writer.Put(oid);
+    writer.PutString(table_info->name_);
+    writer.Put(table_info->layout_);
+    const PartitionedTable *partitions = table_info->partitions_.get();
+    // a partitioned table has a first page per partition, which follow its schema; a clustered one has the column of
+    // its primary key there instead, as its tree is found by its name
+    page_id_t first_page_id = INVALID_PAGE_ID;
+    if (partitions == nullptr && table_info->layout_ != TableLayout::CLUSTERED) {
+      first_page_id = table_info->layout_ == TableLayout::PAX ? table_info->pax_table_->GetFirstPageId()
+                                                              : table_info->table_->GetFirstPageId();
+    }
+    writer.Put(first_page_id);
+    writer.PutSchema(table_info->schema_);
+    writer.Put(partitions != nullptr);
+    if (partitions != nullptr) {
+      const PartitionScheme &scheme = partitions->GetScheme();
+      writer.Put(scheme.method_);
+      writer.Put(scheme.key_idx_);
+      writer.Put(static_cast<uint64_t>(scheme.num_partitions_));
+      writer.Put(static_cast<uint32_t>(scheme.bounds_.size()));
+      for (const Value &bound : scheme.bounds_) {
+        writer.PutValue(bound);
+      }
+      for (TableHeap *heap : partitions->GetPartitions()) {
+        writer.Put(heap->GetFirstPageId());
+      }
+    } else if (table_info->layout_ == TableLayout::CLUSTERED) {
+      writer.Put(table_info->clustered_table_->GetKeyIdx());
+    }
+    const TableStatistics *statistics = table_info->statistics_.get();
+    writer.Put(statistics != nullptr);
+    if (statistics != nullptr) {
+      writer.Put(statistics->GetRowCount());
+      for (uint32_t i = 0; i < table_info->schema_.GetColumnCount(); i++) {
+        const ColumnStatistics &column = statistics->GetColumn(i);
+        writer.Put(column.GetNullFraction());
+        writer.Put(column.GetDistinctCount());
+        writer.Put(static_cast<uint32_t>(column.GetHistogramBounds().size()));
+        for (const Value &bound : column.GetHistogramBounds()) {
+          writer.PutValue(bound);
+        }
+      }
+    }
+  }
+  // so are the indexes that are in memory only
+  auto index_persisted = [&](const IndexInfo &index_info) {
+    return !index_info.in_memory_ && persisted(*GetTable(index_info.table_name_));
+  };
+  writer.Put(static_cast<uint32_t>(std::count_if(indexes_.begin(), indexes_.end(),
+                                                 [&](const auto &index) { return index_persisted(*index.second); })));
+  for (const auto &[oid, index_info] : indexes_) {
+    if (!index_persisted(*index_info)) {
+      continue;
+    }
+    writer.Put(oid);
+    writer.PutString(index_info->name_);
+    writer.PutString(index_info->table_name_);
+    writer.Put(static_cast<uint64_t>(index_info->key_size_));
+    writer.PutSchema(index_info->key_schema_);
+    const std::vector<uint32_t> &key_attrs = index_info->index_->GetKeyAttrs();
+    writer.Put(static_cast<uint32_t>(key_attrs.size()));
+    for (uint32_t key_attr : key_attrs) {
+      writer.Put(key_attr);
+    }
+  }
+
+  // the pages of the chain are overwritten in order, and more are added at its end as the catalog grows
+  const std::string &bytes = writer.GetBytes();
+  size_t offset = 0;
+  page_id_t page_id = catalog_page_id_;
+  CatalogPage *prev = nullptr;
+  while (true) {
+    CatalogPage *page;
+    if (page_id == INVALID_PAGE_ID) {
+      page = static_cast<CatalogPage *>(bpm_->NewPage(&page_id));
+      if (page == nullptr) {
+        throw Exception(ExceptionType::OUT_OF_MEMORY, "cannot allocate a catalog page");
+      }
+      page->Init();
+      if (prev != nullptr) {
+        prev->SetNextPageId(page_id);
+      } else {
+        catalog_page_id_ = page_id;
+        Page *header_page = bpm_->FetchPage(HEADER_PAGE_ID);
+        if (header_page == nullptr) {
+          throw Exception(ExceptionType::OUT_OF_MEMORY, "cannot fetch the header page");
+        }
+        header_page->WLatch();
+        static_cast<HeaderPage *>(header_page)->InsertRecord(CATALOG_RECORD_NAME, catalog_page_id_);
+        header_page->WUnlatch();
+        bpm_->UnpinPage(HEADER_PAGE_ID, true);
+      }
+    } else {
+      page = static_cast<CatalogPage *>(bpm_->FetchPage(page_id));
+      if (page == nullptr) {
+        throw Exception(ExceptionType::OUT_OF_MEMORY, "cannot fetch a catalog page");
+      }
+    }
+    if (prev != nullptr) {
+      bpm_->UnpinPage(prev->GetPageId(), true);
+    }
+    auto size = static_cast<uint32_t>(std::min(CatalogPage::PAYLOAD_SIZE, bytes.size() - offset));
+    page->SetPayload(bytes.data() + offset, size);
+    offset += size;
+    prev = page;
+    if (offset == bytes.size()) {
+      break;
+    }
+    page_id = page->GetNextPageId();
+  }
+
+  // the pages past the end of a catalog that became shorter are freed
+  page_id_t rest = prev->GetNextPageId();
+  prev->SetNextPageId(INVALID_PAGE_ID);
+  bpm_->UnpinPage(prev->GetPageId(), true);
+  while (rest != INVALID_PAGE_ID) {
+    auto page = static_cast<CatalogPage *>(bpm_->FetchPage(rest));
+    if (page == nullptr) {
+      throw Exception(ExceptionType::OUT_OF_MEMORY, "cannot fetch a catalog page");
+    }
+    page_id_t next_page_id = page->GetNextPageId();
+    bpm_->UnpinPage(rest, false);
+    bpm_->DeletePage(rest);
+    rest = next_page_id;
+  }
+}
+
+void IndexRollback::OnAbort(Transaction *txn, const std::vector<const TableWriteRecord *> &records) {
+  TableHeap *heap = records.front()->table_;
+  TableMetadata *table_info = catalog_->GetTable(heap->GetTableOid());
+  std::vector<IndexInfo *> indexes = catalog_->GetTableIndexes(table_info->name_);
+  if (indexes.empty()) {
+    return;
+  }
+  // the entries the transaction wrote itself are rolled back from its index write set
+  std::unordered_map<RID, std::unordered_set<index_oid_t>> written;
+  for (const auto &item : *txn->GetIndexWriteSet()) {
+    if (item.catalog_ == catalog_ && item.table_oid_ == table_info->oid_) {
+      written[item.rid_].insert(item.index_oid_);
+    }
+  }
+  // the tuples each row held while the transaction wrote it: the one before its first write, if any, and the ones it
+  // wrote, any of which a build scan may have seen
+  std::unordered_map<RID, std::pair<std::optional<Tuple>, std::vector<Tuple>>> rows;
+  std::vector<RID> order;
+  for (const TableWriteRecord *record : records) {
+    auto [it, first] = rows.try_emplace(record->rid_);
+    if (first) {
+      order.push_back(record->rid_);
+    }
+    Tuple current;
+    bool deleted;
+    if (first && record->wtype_ == WType::DELETE && heap->ReadWrittenTuple(record->rid_, &current, &deleted)) {
+      it->second.first = std::move(current);
+    } else if (record->wtype_ == WType::UPDATE) {
+      if (first) {
+        it->second.first = record->tuple_;
+      } else {
+        it->second.second.push_back(record->tuple_);
+      }
+    }
+  }
+  for (const RID &rid : order) {
+    auto &[before, images] = rows[rid];
+    Tuple current;
+    bool deleted;
+    // a tuple deleted after it was written still holds what was written
+    if (heap->ReadWrittenTuple(rid, &current, &deleted)) {
+      images.push_back(std::move(current));
+    }
+    for (IndexInfo *index_info : indexes) {
+      auto covered = written.find(rid);
+      if (covered != written.end() && covered->second.count(index_info->index_oid_) != 0) {
+        continue;
+      }
+      Index *index = index_info->index_.get();
+      // the entries are of the key and the RID, so that those of tuples that were never indexed are not there to delete
+      for (const Tuple &image : images) {
+        catalog_->DeleteIndexEntry(
+            index_info, image.KeyFromTuple(table_info->schema_, index_info->key_schema_, index->GetKeyAttrs()), rid,
+            txn);
+      }
+      if (before.has_value()) {
+        catalog_->InsertIndexEntry(
+            index_info, before->KeyFromTuple(table_info->schema_, index_info->key_schema_, index->GetKeyAttrs()), rid,
+            txn);
+      }
+    }
+  }
+}
+
+}  // namespace bustub
@@ -0,0 +1,400 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// materialized_view.cpp
+//
+// Identification: src/catalog/materialized_view.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "catalog/materialized_view.h"
+
+#include <utility>
+
+#include "common/exception.h"
+#include "storage/table/table_page_scanner.h"
+#include "type/value_factory.h"
+
+namespace bustub {
+
+namespace {
+
+/** @return the type of an aggregate of a column of a type, as AggregationExecutor has it */
+TypeId AggregateType(AggregationType type, TypeId input_type) {
+  if (type == AggregationType::CountAggregate) {
+    return TypeId::INTEGER;
+  }
+  if (input_type == TypeId::DECIMAL || input_type == TypeId::BIGINT) {
+    return input_type;
+  }
+  if (input_type == TypeId::TIMESTAMP) {
+    return type == AggregationType::SumAggregate ? TypeId::BIGINT : input_type;
+  }
+  return TypeId::INTEGER;
+}
+
+/** @return the name of the column of an aggregate in the schema of the view */
+std::string AggregateName(AggregationType type, const std::string &column_name) {
+  switch (type) {
+    case AggregationType::CountAggregate:
+      return "count_" + column_name;
+    case AggregationType::SumAggregate:
+      return "sum_" + column_name;
+    case AggregationType::MinAggregate:
+      return "min_" + column_name;
+    default:
+      return "max_" + column_name;
+  }
+}
+
+/** @return a value of an integer type, or a timestamp, as an int64_t */
+int64_t AsInteger(const Value &value) {
+  switch (value.GetTypeId()) {
+    case TypeId::BOOLEAN:
+    case TypeId::TINYINT:
+      return value.GetAs<int8_t>();
+    case TypeId::SMALLINT:
+      return value.GetAs<int16_t>();
+    case TypeId::INTEGER:
+      return value.GetAs<int32_t>();
+    case TypeId::BIGINT:
+      return value.GetAs<int64_t>();
+    default:
+      return static_cast<int64_t>(value.GetAs<uint64_t>());
+  }
+}
+
+/** @return an int64_t state as a value of the type of its aggregate */
+Value IntegerAs(int64_t state, TypeId type) {
+  switch (type) {
+    case TypeId::INTEGER:
+      if (state < BUSTUB_INT32_MIN || state > BUSTUB_INT32_MAX) {
+        throw Exception(ExceptionType::OUT_OF_RANGE, "the aggregate overflows an INTEGER");
+      }
+      return Value(type, static_cast<int32_t>(state));
+    case TypeId::BIGINT:
+      return Value(type, state);
+    default:
+      return Value(type, static_cast<uint64_t>(state));
+  }
+}
+
+bool IsExtreme(AggregationType type) {
+  return type == AggregationType::MinAggregate || type == AggregationType::MaxAggregate;
+}
+
+}  // namespace
+
+MaterializedView::MaterializedView(std::string name, std::vector<TableHeap *> heaps, const Schema *schema,
+                                   std::vector<uint32_t> group_by_idxs, std::vector<ViewAggregate> aggregates)
+    : name_(std::move(name)),
+      heaps_(std::move(heaps)),
+      table_schema_(schema),
+      group_by_idxs_(std::move(group_by_idxs)),
+      aggregates_(std::move(aggregates)) {
+  std::vector<Column> columns;
+  for (uint32_t idx : group_by_idxs_) {
+    columns.push_back(table_schema_->GetColumn(idx));
+  }
+  for (const ViewAggregate &aggregate : aggregates_) {
+    const Column &column = table_schema_->GetColumn(aggregate.column_idx_);
+    if (aggregate.type_ != AggregationType::CountAggregate && aggregate.type_ != AggregationType::SumAggregate &&
+        !IsExtreme(aggregate.type_)) {
+      throw Exception(ExceptionType::NOT_IMPLEMENTED, "a materialized view keeps COUNT, SUM, MIN and MAX only");
+    }
+    if (aggregate.type_ != AggregationType::CountAggregate && column.GetType() == TypeId::VARCHAR) {
+      throw Exception(ExceptionType::NOT_IMPLEMENTED, "only COUNT aggregates VARCHARs");
+    }
+    columns.emplace_back(AggregateName(aggregate.type_, column.GetName()),
+                         AggregateType(aggregate.type_, column.GetType()));
+    decimal_.push_back(column.GetType() == TypeId::DECIMAL);
+  }
+  schema_ = std::make_unique<Schema>(columns);
+  group_by_schema_.reset(Schema::CopySchema(table_schema_, group_by_idxs_));
+  if (group_by_idxs_.empty()) {
+    NewGroup("", {});
+  }
+}
+
+MaterializedView::Group *MaterializedView::NewGroup(const std::string &key, std::vector<Value> &&group_bys) {
+  Group &group = groups_[key];
+  group.group_bys_ = std::move(group_bys);
+  group.states_.resize(aggregates_.size());
+  group.id_ = next_group_id_++;
+  return &group;
+}
+
+std::string MaterializedView::GroupKey(const Tuple &tuple, std::vector<Value> *group_bys) const {
+  if (group_by_idxs_.empty()) {
+    return "";
+  }
+  for (uint32_t idx : group_by_idxs_) {
+    group_bys->push_back(tuple.GetValue(table_schema_, idx));
+  }
+  Tuple key(*group_bys, group_by_schema_.get());
+  return std::string(key.GetData(), key.GetLength());
+}
+
+MaterializedView::Number MaterializedView::AsNumber(const Value &value, uint32_t aggregate) const {
+  Number number;
+  if (decimal_[aggregate]) {
+    number.decimal_ = value.GetAs<double>();
+  } else {
+    number.integer_ = AsInteger(value);
+  }
+  return number;
+}
+
+bool MaterializedView::Better(uint32_t aggregate, const Number &a, const Number &b) const {
+  bool min = aggregates_[aggregate].type_ == AggregationType::MinAggregate;
+  if (decimal_[aggregate]) {
+    return min ? a.decimal_ < b.decimal_ : a.decimal_ > b.decimal_;
+  }
+  return min ? a.integer_ < b.integer_ : a.integer_ > b.integer_;
+}
+
+void MaterializedView::KeepBest(uint32_t aggregate, const Number &value, std::optional<Number> *best) const {
+  if (!best->has_value() || Better(aggregate, value, best->value())) {
+    *best = value;
+  }
+}
+
+void MaterializedView::Apply(const Tuple &tuple, int sign) {
+  std::vector<Value> group_bys;
+  std::string key = GroupKey(tuple, &group_bys);
+  auto it = groups_.find(key);
+  Group *group = it != groups_.end() ? &it->second : NewGroup(key, std::move(group_bys));
+  group->rows_ += sign;
+  for (uint32_t i = 0; i < aggregates_.size(); i++) {
+    Value value = tuple.GetValue(table_schema_, aggregates_[i].column_idx_);
+    if (value.IsNull()) {
+      continue;
+    }
+    AggregateState *state = &group->states_[i];
+    state->count_ += sign;
+    if (aggregates_[i].type_ == AggregationType::CountAggregate) {
+      continue;
+    }
+    Number number = AsNumber(value, i);
+    if (aggregates_[i].type_ == AggregationType::SumAggregate) {
+      // wraps around rather than overflows, as a sum that goes out of range may come back in
+      uint64_t delta = static_cast<uint64_t>(sign) * static_cast<uint64_t>(number.integer_);
+      state->value_.integer_ = static_cast<int64_t>(static_cast<uint64_t>(state->value_.integer_) + delta);
+      state->value_.decimal_ += sign * number.decimal_;
+    } else if (sign > 0) {
+      if (state->stale_) {
+        KeepBest(i, number, &state->added_);
+      } else if (state->count_ == 1 || Better(i, number, state->value_)) {
+        state->value_ = number;
+      }
+    } else if (state->count_ == 0) {
+      state->stale_ = false;
+    } else if (state->stale_) {
+      KeepBest(i, number, &state->removed_);
+    } else if (!Better(i, state->value_, number)) {
+      // the extreme may have been this row's alone
+      state->stale_ = true;
+    }
+  }
+  if (group->rows_ == 0 && !group_by_idxs_.empty()) {
+    groups_.erase(key);
+  }
+}
+
+std::optional<Tuple> MaterializedView::RowBefore(const TableWriteRecord *first) {
+  Tuple tuple;
+  bool deleted;
+  switch (first->wtype_) {
+    case WType::INSERT:
+      return std::nullopt;
+    case WType::UPDATE: {
+      // the tuple as its page had it, whose toasted values are freed only once the commit applies the update
+      ToastStore *toast = first->table_->GetToastStore();
+      if (toast != nullptr && toast->IsToasted(first->tuple_)) {
+        toast->Detoast(first->tuple_, &tuple);
+        return tuple;
+      }
+      return first->tuple_;
+    }
+    default:
+      if (!first->table_->ReadWrittenTuple(first->rid_, &tuple, &deleted)) {
+        return std::nullopt;
+      }
+      return tuple;
+  }
+}
+
+std::optional<Tuple> MaterializedView::RowAfter(const TableWriteRecord *last) {
+  Tuple tuple;
+  bool deleted;
+  if (last->wtype_ == WType::DELETE || !last->table_->ReadWrittenTuple(last->rid_, &tuple, &deleted) || deleted) {
+    return std::nullopt;
+  }
+  return tuple;
+}
+
+void MaterializedView::OnCommit(const std::vector<const TableWriteRecord *> &records) {
+  // a row written more than once in the transaction went from the row before its first write to the row after its last
+  std::unordered_map<int64_t, std::pair<const TableWriteRecord *, const TableWriteRecord *>> writes;
+  for (const TableWriteRecord *record : records) {
+    auto [it, inserted] = writes.try_emplace(record->rid_.Get(), record, record);
+    if (!inserted) {
+      it->second.second = record;
+    }
+  }
+  std::vector<std::pair<std::optional<Tuple>, std::optional<Tuple>>> changes;
+  changes.reserve(writes.size());
+  for (const auto &[rid, write] : writes) {
+    changes.emplace_back(RowBefore(write.first), RowAfter(write.second));
+  }
+  std::scoped_lock lock(latch_);
+  for (const auto &[before, after] : changes) {
+    if (before.has_value()) {
+      Apply(*before, -1);
+    }
+    if (after.has_value()) {
+      Apply(*after, 1);
+    }
+  }
+}
+
+template <typename Visit>
+void MaterializedView::ScanTable(Transaction *txn, Visit &&visit) {
+  Tuple view;
+  Tuple detoasted;
+  for (TableHeap *heap : heaps_) {
+    // the rows are read as the scans of the table read them, with the versions, locks or read set of the transaction,
+    // and with their toasted values read back in
+    TablePageScanner scanner(heap, txn);
+    ToastStore *toast = heap->GetToastStore();
+    while (scanner.Next(&view)) {
+      if (toast != nullptr && toast->IsToasted(view)) {
+        toast->Detoast(view, &detoasted);
+        visit(detoasted);
+      } else {
+        visit(view);
+      }
+    }
+  }
+}
+
+void MaterializedView::Refresh(Transaction *txn) {
+  std::scoped_lock lock(latch_);
+  groups_.clear();
+  if (group_by_idxs_.empty()) {
+    NewGroup("", {});
+  }
+  ScanTable(txn, [this](const Tuple &tuple) { Apply(tuple, 1); });
+}
+
+void MaterializedView::ReadStaleExtremes(Transaction *txn) {
+  // the stale groups, by the ids they have now; the rows committed while the table is read are kept track of in
+  // added_ and removed_
+  std::unordered_map<std::string, uint64_t> targets;
+  {
+    std::scoped_lock lock(latch_);
+    for (auto &[key, group] : groups_) {
+      for (AggregateState &state : group.states_) {
+        if (state.stale_) {
+          targets.emplace(key, group.id_);
+          state.added_.reset();
+          state.removed_.reset();
+        }
+      }
+    }
+  }
+  std::unordered_map<std::string, std::vector<std::optional<Number>>> bests;
+  ScanTable(txn, [&](const Tuple &tuple) {
+    std::vector<Value> group_bys;
+    std::string key = GroupKey(tuple, &group_bys);
+    if (targets.count(key) == 0) {
+      return;
+    }
+    auto &best = bests[key];
+    best.resize(aggregates_.size());
+    for (uint32_t i = 0; i < aggregates_.size(); i++) {
+      Value value = tuple.GetValue(table_schema_, aggregates_[i].column_idx_);
+      if (IsExtreme(aggregates_[i].type_) && !value.IsNull()) {
+        KeepBest(i, AsNumber(value, i), &best[i]);
+      }
+    }
+  });
+
+  std::scoped_lock lock(latch_);
+  for (const auto &[key, id] : targets) {
+    auto it = groups_.find(key);
+    if (it == groups_.end() || it->second.id_ != id) {
+      continue;
+    }
+    auto best_it = bests.find(key);
+    for (uint32_t i = 0; i < aggregates_.size(); i++) {
+      AggregateState *state = &it->second.states_[i];
+      if (!state->stale_) {
+        continue;
+      }
+      std::optional<Number> candidate;
+      if (best_it != bests.end()) {
+        candidate = best_it->second[i];
+      }
+      if (state->added_.has_value()) {
+        KeepBest(i, *state->added_, &candidate);
+      }
+      // a row taken out meanwhile that may have been read holds the extreme, unless it is worse than the candidate
+      if (!candidate.has_value() || (state->removed_.has_value() && !Better(i, *candidate, *state->removed_))) {
+        continue;
+      }
+      state->value_ = *candidate;
+      state->stale_ = false;
+    }
+  }
+}
+
+Value MaterializedView::AggregateValue(const Group &group, uint32_t aggregate) const {
+  const AggregateState &state = group.states_[aggregate];
+  TypeId type = schema_->GetColumn(group_by_idxs_.size() + aggregate).GetType();
+  if (aggregates_[aggregate].type_ == AggregationType::CountAggregate) {
+    return IntegerAs(state.count_, type);
+  }
+  if (state.count_ == 0) {
+    return ValueFactory::GetNullValueByType(type);
+  }
+  if (decimal_[aggregate]) {
+    return Value(type, state.value_.decimal_);
+  }
+  return IntegerAs(state.value_.integer_, type);
+}
+
+void MaterializedView::Scan(Transaction *txn, std::vector<Tuple> *result) {
+  while (true) {
+    {
+      std::scoped_lock lock(latch_);
+      bool stale = false;
+      for (const auto &[key, group] : groups_) {
+        for (const AggregateState &state : group.states_) {
+          stale = stale || state.stale_;
+        }
+      }
+      if (!stale) {
+        for (const auto &[key, group] : groups_) {
+          std::vector<Value> values = group.group_bys_;
+          for (uint32_t i = 0; i < aggregates_.size(); i++) {
+            values.push_back(AggregateValue(group, i));
+          }
+          result->emplace_back(values, schema_.get());
+        }
+        return;
+      }
+    }
+    ReadStaleExtremes(txn);
+  }
+}
+
+size_t MaterializedView::GetGroupCount() {
+  std::scoped_lock lock(latch_);
+  return groups_.size();
+}
+
+}  // namespace bustub
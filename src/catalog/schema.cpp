@@ -29,6 +29,8 @@ Schema::Schema(const std::vector<Column> &columns) : tuple_is_inlined_(true) {
     }
     // set column offset
     column.column_offset_ = curr_offset;
+    offsets_.push_back(curr_offset);
+    types_.push_back(column.GetType());
     curr_offset += column.GetFixedLength();
 
     // add column
@@ -0,0 +1,204 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// table_statistics.cpp
+//
+// Identification: src/catalog/table_statistics.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "catalog/table_statistics.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#include "common/macros.h"
+#include "murmur3/MurmurHash3.h"
+
+namespace bustub {
+
+namespace {
+
+// The finalizer of MurmurHash3, which spreads the bits of the hashes of small integers over the whole word
+uint64_t Mix(uint64_t hash) {
+  hash ^= hash >> 33;
+  hash *= 0xff51afd7ed558ccdULL;
+  hash ^= hash >> 33;
+  hash *= 0xc4ceb9fe1a85ec53ULL;
+  hash ^= hash >> 33;
+  return hash;
+}
+
+bool Less(const Value &left, const Value &right) { return left.CompareLessThan(right) == CmpBool::CmpTrue; }
+
+}  // namespace
+
+HyperLogLog::HyperLogLog(uint32_t precision) : precision_(precision), registers_(size_t{1} << precision, 0) {
+  BUSTUB_ASSERT(precision >= 4 && precision <= 16, "the precision of a HyperLogLog is between 4 and 16 bits");
+}
+
+hash_t HyperLogLog::HashValue(const Value &value) {
+  switch (value.GetTypeId()) {
+    case TypeId::BOOLEAN:
+    case TypeId::TINYINT:
+      return static_cast<hash_t>(value.GetAs<int8_t>());
+    case TypeId::SMALLINT:
+      return static_cast<hash_t>(value.GetAs<int16_t>());
+    case TypeId::INTEGER:
+      return static_cast<hash_t>(value.GetAs<int32_t>());
+    case TypeId::BIGINT:
+      return static_cast<hash_t>(value.GetAs<int64_t>());
+    case TypeId::DECIMAL: {
+      auto decimal = value.GetAs<double>();
+      hash_t bits;
+      memcpy(&bits, &decimal, sizeof(bits));
+      return bits;
+    }
+    case TypeId::TIMESTAMP:
+      return value.GetAs<uint64_t>();
+    default: {
+      uint64_t hash[2];
+      murmur3::MurmurHash3_x64_128(value.GetData(), static_cast<int>(value.GetLength()), 0, hash);
+      return hash[0];
+    }
+  }
+}
+
+void HyperLogLog::Add(hash_t hash) {
+  uint64_t mixed = Mix(hash);
+  size_t index = mixed >> (64 - precision_);
+  // the rank is the position of the first set bit of the rest, which a sentinel bit bounds
+  uint64_t rest = (mixed << precision_) | (uint64_t{1} << (precision_ - 1));
+  auto rank = static_cast<uint8_t>(__builtin_clzll(rest) + 1);
+  registers_[index] = std::max(registers_[index], rank);
+}
+
+void HyperLogLog::Merge(const HyperLogLog &other) {
+  BUSTUB_ASSERT(precision_ == other.precision_, "only HyperLogLogs of the same precision merge");
+  for (size_t i = 0; i < registers_.size(); i++) {
+    registers_[i] = std::max(registers_[i], other.registers_[i]);
+  }
+}
+
+double HyperLogLog::Estimate() const {
+  auto m = static_cast<double>(registers_.size());
+  double sum = 0;
+  size_t zeros = 0;
+  for (uint8_t rank : registers_) {
+    sum += std::ldexp(1.0, -rank);
+    zeros += rank == 0 ? 1 : 0;
+  }
+  double alpha = 0.7213 / (1 + 1.079 / m);
+  double estimate = alpha * m * m / sum;
+  // few distinct values leave registers empty, and counting those is more accurate then
+  if (estimate <= 2.5 * m && zeros != 0) {
+    return m * std::log(m / static_cast<double>(zeros));
+  }
+  return estimate;
+}
+
+double ColumnStatistics::EstimateEquals(const Value &value) const {
+  if (value.IsNull() || distinct_count_ < 1) {
+    return 0;
+  }
+  double non_null = 1 - null_fraction_;
+  if (bounds_.empty()) {
+    return non_null / distinct_count_;
+  }
+  if (Less(value, bounds_.front()) || Less(bounds_.back(), value)) {
+    return 0;
+  }
+  // a value that bounds several buckets fills the buckets between its bounds
+  auto range = std::equal_range(bounds_.begin(), bounds_.end(), value, Less);
+  auto equal_bounds = static_cast<double>(range.second - range.first);
+  double buckets = static_cast<double>(bounds_.size() - 1);
+  return std::max(non_null / distinct_count_, equal_bounds > 1 ? non_null * (equal_bounds - 1) / buckets : 0);
+}
+
+double ColumnStatistics::EstimateLessThan(const Value &value) const {
+  if (value.IsNull()) {
+    return 0;
+  }
+  if (bounds_.size() < 2) {
+    return DEFAULT_SELECTIVITY;
+  }
+  double non_null = 1 - null_fraction_;
+  if (!Less(bounds_.front(), value)) {
+    return 0;
+  }
+  if (Less(bounds_.back(), value)) {
+    return non_null;
+  }
+  // the buckets before the one the value is in are below it, and half of that one is taken to be
+  auto bound = std::lower_bound(bounds_.begin(), bounds_.end(), value, Less);
+  auto below = static_cast<double>(bound - bounds_.begin()) - 0.5;
+  return non_null * below / static_cast<double>(bounds_.size() - 1);
+}
+
+StatisticsCollector::StatisticsCollector(const Schema *schema, size_t sample_size, uint64_t seed)
+    : schema_(schema),
+      sample_size_(sample_size),
+      random_(seed),
+      null_counts_(schema->GetColumnCount(), 0),
+      distinct_(schema->GetColumnCount()) {
+  sample_.reserve(sample_size);
+}
+
+void StatisticsCollector::Add(const std::vector<Value> &row) {
+  BUSTUB_ASSERT(row.size() == schema_->GetColumnCount(), "a row has a value for every column");
+  row_count_++;
+  for (uint32_t i = 0; i < row.size(); i++) {
+    if (row[i].IsNull()) {
+      null_counts_[i]++;
+    } else {
+      distinct_[i].Add(HyperLogLog::HashValue(row[i]));
+    }
+  }
+  // reservoir sampling: the n-th row replaces a sampled one with probability sample_size / n
+  if (sample_.size() < sample_size_) {
+    sample_.push_back(row);
+    return;
+  }
+  uint64_t slot = random_() % row_count_;
+  if (slot < sample_size_) {
+    sample_[slot] = row;
+  }
+}
+
+TableStatistics StatisticsCollector::Finish(size_t num_buckets, double scale) const {
+  std::vector<ColumnStatistics> columns;
+  columns.reserve(schema_->GetColumnCount());
+  for (uint32_t i = 0; i < schema_->GetColumnCount(); i++) {
+    double null_fraction = row_count_ == 0 ? 0 : static_cast<double>(null_counts_[i]) / row_count_;
+    double non_null_count = static_cast<double>(row_count_ - null_counts_[i]);
+    double distinct_count = std::min(distinct_[i].Estimate(), non_null_count);
+    if (distinct_count >= UNIQUE_FRACTION * non_null_count) {
+      distinct_count *= scale;
+    }
+
+    std::vector<Value> bounds;
+    if (schema_->GetColumn(i).GetType() != TypeId::TIMESTAMP) {
+      std::vector<Value> values;
+      for (const std::vector<Value> &row : sample_) {
+        if (!row[i].IsNull()) {
+          values.push_back(row[i]);
+        }
+      }
+      std::sort(values.begin(), values.end(), Less);
+      // the bounds are the quantiles of the sample, the smallest and largest values included
+      size_t buckets = std::min(num_buckets, values.empty() ? 0 : values.size() - 1);
+      for (size_t b = 0; buckets != 0 && b <= buckets; b++) {
+        bounds.push_back(values[b * (values.size() - 1) / buckets]);
+      }
+    }
+    columns.emplace_back(null_fraction, distinct_count, std::move(bounds));
+  }
+  auto row_count = static_cast<uint64_t>(std::llround(static_cast<double>(row_count_) * scale));
+  return TableStatistics(row_count, std::move(columns));
+}
+
+}  // namespace bustub
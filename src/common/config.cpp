@@ -18,6 +18,18 @@ std::atomic<bool> enable_logging(false);
 
 std::chrono::duration<int64_t> log_timeout = std::chrono::seconds(1);
 
+std::chrono::milliseconds async_commit_delay = std::chrono::milliseconds(10);
+
 std::chrono::milliseconds cycle_detection_interval = std::chrono::milliseconds(50);
 
+std::chrono::milliseconds bg_flush_interval = std::chrono::milliseconds(10);
+
+std::atomic<size_t> bg_flush_clean_target(BUFFER_POOL_SIZE / 4);
+
+std::atomic<size_t> bg_flush_pages_per_round(BUFFER_POOL_SIZE / 4);
+
+std::chrono::milliseconds vacuum_interval = std::chrono::milliseconds(100);
+
+std::atomic<size_t> vacuum_pages_per_round(64);
+
 }  // namespace bustub
@@ -0,0 +1,88 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// contention.cpp
+//
+// Identification: src/common/contention.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "common/contention.h"
+
+#include <algorithm>
+#include <iomanip>
+#include <map>
+#include <memory>
+
+namespace bustub {
+
+namespace {
+
+/** The sites by name, which are created as objects with latches are, in whatever order static objects are. */
+struct Sites {
+  std::mutex latch_;
+  std::map<std::string, std::unique_ptr<ContentionSite>> sites_;
+};
+
+Sites &AllSites() {
+  static Sites sites;
+  return sites;
+}
+
+}  // namespace
+
+ContentionSite *ContentionProfiler::Site(const std::string &name) {
+  Sites &sites = AllSites();
+  std::scoped_lock lock(sites.latch_);
+  auto &site = sites.sites_[name];
+  if (site == nullptr) {
+    site = std::make_unique<ContentionSite>(name);
+  }
+  return site.get();
+}
+
+std::vector<ContentionStats> ContentionProfiler::Report() {
+  std::vector<ContentionStats> report;
+  {
+    Sites &sites = AllSites();
+    std::scoped_lock lock(sites.latch_);
+    for (const auto &[name, site] : sites.sites_) {
+      ContentionStats stats = site->GetStats();
+      if (stats.waits_ != 0) {
+        report.push_back(std::move(stats));
+      }
+    }
+  }
+  std::stable_sort(report.begin(), report.end(),
+                   [](const ContentionStats &a, const ContentionStats &b) { return a.wait_ns_ > b.wait_ns_; });
+  return report;
+}
+
+void ContentionProfiler::Reset() {
+  Sites &sites = AllSites();
+  std::scoped_lock lock(sites.latch_);
+  for (const auto &[name, site] : sites.sites_) {
+    site->Reset();
+  }
+}
+
+void ContentionProfiler::Dump(std::ostream *out, size_t limit) {
+  auto us = [](double ns) { return ns / 1000; };
+  std::ios::fmtflags flags = out->flags();
+  std::streamsize precision = out->precision();
+  *out << std::fixed << std::setprecision(1);
+  std::vector<ContentionStats> report = Report();
+  for (size_t i = 0; i < std::min(limit, report.size()); i++) {
+    const ContentionStats &stats = report[i];
+    *out << stats.name_ << ": waits " << stats.waits_ << ", waited " << us(static_cast<double>(stats.wait_ns_))
+         << " us, mean " << us(stats.MeanWaitNs()) << " us, max " << us(static_cast<double>(stats.max_wait_ns_))
+         << " us\n";
+  }
+  out->flags(flags);
+  out->precision(precision);
+}
+
+}  // namespace bustub
@@ -0,0 +1,129 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// latency_histogram.cpp
+//
+// Identification: src/common/latency_histogram.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "common/latency_histogram.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <thread>  // NOLINT
+
+namespace bustub {
+
+size_t LatencySnapshot::BucketOf(uint64_t ns) {
+  ns = std::min(ns, MAX_LATENCY_NS);
+  if (ns < SUB_BUCKETS) {
+    return ns;
+  }
+  // the highest bit picks the power of two, and the SUB_BUCKET_BITS bits below it the bucket within it
+  auto magnitude = static_cast<uint32_t>(63 - __builtin_clzll(ns));
+  uint64_t sub_bucket = (ns >> (magnitude - SUB_BUCKET_BITS)) & (SUB_BUCKETS - 1);
+  return SUB_BUCKETS * (magnitude - SUB_BUCKET_BITS + 1) + sub_bucket;
+}
+
+uint64_t LatencySnapshot::BucketUpperBound(size_t bucket) {
+  if (bucket < SUB_BUCKETS) {
+    return bucket;
+  }
+  uint32_t shift = bucket / SUB_BUCKETS - 1;
+  uint64_t lower = (SUB_BUCKETS + bucket % SUB_BUCKETS) << shift;
+  return lower + (uint64_t{1} << shift) - 1;
+}
+
+uint64_t LatencySnapshot::PercentileNs(double percentile) const {
+  if (count_ == 0) {
+    return 0;
+  }
+  auto rank = static_cast<uint64_t>(std::ceil(std::clamp(percentile, 0.0, 100.0) / 100 * static_cast<double>(count_)));
+  rank = std::max<uint64_t>(rank, 1);
+  uint64_t seen = 0;
+  for (size_t bucket = 0; bucket < NUM_BUCKETS; bucket++) {
+    seen += counts_[bucket];
+    if (seen >= rank) {
+      // the bucket's range is all that is known of its latencies, none of which is past the highest one recorded
+      return std::min(std::max(BucketUpperBound(bucket), min_ns_), max_ns_);
+    }
+  }
+  return max_ns_;
+}
+
+LatencySnapshot &LatencySnapshot::operator+=(const LatencySnapshot &other) {
+  for (size_t bucket = 0; bucket < NUM_BUCKETS; bucket++) {
+    counts_[bucket] += other.counts_[bucket];
+  }
+  count_ += other.count_;
+  sum_ns_ += other.sum_ns_;
+  min_ns_ = std::min(min_ns_, other.min_ns_);
+  max_ns_ = std::max(max_ns_, other.max_ns_);
+  return *this;
+}
+
+LatencyHistogram::Stripe &LatencyHistogram::Local() {
+  // hashing the thread id is not free, so each thread does it once
+  thread_local const size_t stripe = std::hash<std::thread::id>{}(std::this_thread::get_id()) % NUM_STRIPES;
+  return stripes_[stripe];
+}
+
+void LatencyHistogram::Record(std::chrono::nanoseconds latency) {
+  uint64_t ns = std::min<uint64_t>(std::max<int64_t>(latency.count(), 0), LatencySnapshot::MAX_LATENCY_NS);
+  Stripe &stripe = Local();
+  stripe.counts_[LatencySnapshot::BucketOf(ns)].fetch_add(1, std::memory_order_relaxed);
+  stripe.sum_ns_.fetch_add(ns, std::memory_order_relaxed);
+  // the extremes rarely move, so they are read before they are written
+  uint64_t min = stripe.min_ns_.load(std::memory_order_relaxed);
+  while (ns < min && !stripe.min_ns_.compare_exchange_weak(min, ns, std::memory_order_relaxed)) {
+  }
+  uint64_t max = stripe.max_ns_.load(std::memory_order_relaxed);
+  while (ns > max && !stripe.max_ns_.compare_exchange_weak(max, ns, std::memory_order_relaxed)) {
+  }
+}
+
+LatencySnapshot LatencyHistogram::Snapshot() const {
+  LatencySnapshot snapshot;
+  for (const Stripe &stripe : stripes_) {
+    for (size_t bucket = 0; bucket < LatencySnapshot::NUM_BUCKETS; bucket++) {
+      uint64_t count = stripe.counts_[bucket].load(std::memory_order_relaxed);
+      snapshot.counts_[bucket] += count;
+      snapshot.count_ += count;
+    }
+    snapshot.sum_ns_ += stripe.sum_ns_.load(std::memory_order_relaxed);
+    snapshot.min_ns_ = std::min(snapshot.min_ns_, stripe.min_ns_.load(std::memory_order_relaxed));
+    snapshot.max_ns_ = std::max(snapshot.max_ns_, stripe.max_ns_.load(std::memory_order_relaxed));
+  }
+  return snapshot;
+}
+
+std::vector<std::pair<std::string, LatencySnapshot>> LatencyRegistry::Snapshot() const {
+  std::vector<std::pair<std::string, LatencySnapshot>> snapshots;
+  snapshots.reserve(sources_.size());
+  for (const auto &[name, source] : sources_) {
+    snapshots.emplace_back(name, source());
+  }
+  return snapshots;
+}
+
+void LatencyRegistry::Dump(std::ostream *out) const {
+  auto us = [](double ns) { return ns / 1000; };
+  std::ios::fmtflags flags = out->flags();
+  std::streamsize precision = out->precision();
+  *out << std::fixed << std::setprecision(1);
+  for (const auto &[name, snapshot] : Snapshot()) {
+    *out << name << ": count " << snapshot.count_ << ", mean " << us(snapshot.MeanNs()) << " us, p50 "
+         << us(snapshot.PercentileNs(50)) << " us, p99 " << us(snapshot.PercentileNs(99)) << " us, p99.9 "
+         << us(snapshot.PercentileNs(99.9)) << " us, max " << us(snapshot.count_ == 0 ? 0 : snapshot.max_ns_)
+         << " us\n";
+  }
+  out->flags(flags);
+  out->precision(precision);
+}
+
+}  // namespace bustub
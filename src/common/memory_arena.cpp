@@ -0,0 +1,62 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// memory_arena.cpp
+//
+// Identification: src/common/memory_arena.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "common/memory_arena.h"
+
+#include <cstdint>
+#include <utility>
+
+namespace bustub {
+
+char *MemoryArena::Allocate(size_t size, size_t alignment) {
+  auto aligned = (reinterpret_cast<uintptr_t>(next_) + alignment - 1) & ~(alignment - 1);
+  if (next_ != nullptr && aligned + size <= reinterpret_cast<uintptr_t>(end_)) {
+    next_ = reinterpret_cast<char *>(aligned + size);
+    return reinterpret_cast<char *>(aligned);
+  }
+  // new[] aligns to max_align_t; room is made for more than that
+  size_t padded_size = size + (alignment > alignof(std::max_align_t) ? alignment : 0);
+  if (padded_size > BLOCK_SIZE / 4) {
+    // a large allocation gets a block of its own, so that the rest of the current block is not wasted
+    blocks_.push_back(std::make_unique<char[]>(padded_size));
+    capacity_ += padded_size;
+    tracker_->Allocate(MemoryCategory::QUERY_ARENA, padded_size);
+    return reinterpret_cast<char *>((reinterpret_cast<uintptr_t>(blocks_.back().get()) + alignment - 1) &
+                                    ~(alignment - 1));
+  }
+  blocks_.push_back(std::make_unique<char[]>(BLOCK_SIZE));
+  capacity_ += BLOCK_SIZE;
+  tracker_->Allocate(MemoryCategory::QUERY_ARENA, BLOCK_SIZE);
+  next_ = blocks_.back().get();
+  end_ = next_ + BLOCK_SIZE;
+  return Allocate(size, alignment);
+}
+
+void MemoryArena::Reset() {
+  // the block allocations currently go into is kept
+  std::unique_ptr<char[]> current;
+  for (auto &block : blocks_) {
+    if (end_ != nullptr && block.get() == end_ - BLOCK_SIZE) {
+      current = std::move(block);
+    }
+  }
+  blocks_.clear();
+  size_t kept = current != nullptr ? BLOCK_SIZE : 0;
+  tracker_->Free(MemoryCategory::QUERY_ARENA, capacity_ - kept);
+  capacity_ = kept;
+  if (current != nullptr) {
+    next_ = current.get();
+    blocks_.push_back(std::move(current));
+  }
+}
+
+}  // namespace bustub
@@ -0,0 +1,152 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// memory_tracker.cpp
+//
+// Identification: src/common/memory_tracker.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "common/memory_tracker.h"
+
+#include <algorithm>
+#include <iomanip>
+
+namespace bustub {
+
+namespace {
+
+/** The bytes the calling thread accounted for by category that it has not passed on to the global tracker yet. */
+struct LocalBatches {
+  std::array<int64_t, NUM_MEMORY_CATEGORIES> bytes_{};
+
+  ~LocalBatches() {
+    for (size_t category = 0; category < NUM_MEMORY_CATEGORIES; category++) {
+      if (bytes_[category] > 0) {
+        MemoryTracker::Global()->Allocate(static_cast<MemoryCategory>(category), bytes_[category]);
+      } else if (bytes_[category] < 0) {
+        MemoryTracker::Global()->Free(static_cast<MemoryCategory>(category), -bytes_[category]);
+      }
+    }
+  }
+};
+
+thread_local LocalBatches local_batches;
+
+size_t NotBelowZero(int64_t bytes) { return static_cast<size_t>(std::max<int64_t>(bytes, 0)); }
+
+}  // namespace
+
+const char *MemoryCategoryName(MemoryCategory category) {
+  switch (category) {
+    case MemoryCategory::BUFFER_POOL:
+      return "buffer_pool";
+    case MemoryCategory::LOCK_TABLE:
+      return "lock_table";
+    case MemoryCategory::AGGREGATION:
+      return "aggregation";
+    case MemoryCategory::HASH_JOIN:
+      return "hash_join";
+    case MemoryCategory::SORT:
+      return "sort";
+    case MemoryCategory::QUERY_ARENA:
+      return "query_arena";
+    case MemoryCategory::TUPLES:
+      return "tuples";
+    case MemoryCategory::CATALOG:
+      return "catalog";
+    case MemoryCategory::OTHER:
+      return "other";
+  }
+  return "unknown";
+}
+
+MemoryTracker *MemoryTracker::Global() {
+  // never destroyed, as threads that exit while the static objects are destroyed still pass their batches on to it
+  static auto *global = new MemoryTracker();
+  return global;
+}
+
+void MemoryTracker::Allocate(MemoryCategory category, size_t bytes) { Add(category, static_cast<int64_t>(bytes)); }
+
+void MemoryTracker::Free(MemoryCategory category, size_t bytes) { Add(category, -static_cast<int64_t>(bytes)); }
+
+void MemoryTracker::AllocateLocal(MemoryCategory category, size_t bytes) {
+  int64_t &batch = local_batches.bytes_[static_cast<size_t>(category)];
+  batch += static_cast<int64_t>(bytes);
+  if (batch >= LOCAL_BATCH) {
+    Global()->Add(category, batch);
+    batch = 0;
+  }
+}
+
+void MemoryTracker::FreeLocal(MemoryCategory category, size_t bytes) {
+  int64_t &batch = local_batches.bytes_[static_cast<size_t>(category)];
+  batch -= static_cast<int64_t>(bytes);
+  if (batch <= -LOCAL_BATCH) {
+    Global()->Add(category, batch);
+    batch = 0;
+  }
+}
+
+void MemoryTracker::Add(MemoryCategory category, int64_t bytes) {
+  auto index = static_cast<size_t>(category);
+  int64_t current = current_[index].fetch_add(bytes, std::memory_order_relaxed) + bytes;
+  int64_t total = total_.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+  if (bytes > 0) {
+    int64_t peak = peak_[index].load(std::memory_order_relaxed);
+    while (current > peak && !peak_[index].compare_exchange_weak(peak, current, std::memory_order_relaxed)) {
+    }
+    int64_t peak_total = peak_total_.load(std::memory_order_relaxed);
+    while (total > peak_total && !peak_total_.compare_exchange_weak(peak_total, total, std::memory_order_relaxed)) {
+    }
+  }
+  if (parent_ != nullptr) {
+    parent_->Add(category, bytes);
+  }
+}
+
+size_t MemoryTracker::GetCurrent(MemoryCategory category) const {
+  return NotBelowZero(current_[static_cast<size_t>(category)].load(std::memory_order_relaxed));
+}
+
+size_t MemoryTracker::GetPeak(MemoryCategory category) const {
+  return NotBelowZero(peak_[static_cast<size_t>(category)].load(std::memory_order_relaxed));
+}
+
+size_t MemoryTracker::GetTotal() const { return NotBelowZero(total_.load(std::memory_order_relaxed)); }
+
+size_t MemoryTracker::GetPeakTotal() const { return NotBelowZero(peak_total_.load(std::memory_order_relaxed)); }
+
+std::vector<MemoryUsage> MemoryTracker::Report() const {
+  std::vector<MemoryUsage> report;
+  for (size_t index = 0; index < NUM_MEMORY_CATEGORIES; index++) {
+    auto category = static_cast<MemoryCategory>(index);
+    MemoryUsage usage{category, GetCurrent(category), GetPeak(category)};
+    if (usage.peak_ != 0) {
+      report.push_back(usage);
+    }
+  }
+  std::stable_sort(report.begin(), report.end(),
+                   [](const MemoryUsage &a, const MemoryUsage &b) { return a.current_ > b.current_; });
+  return report;
+}
+
+void MemoryTracker::Dump(std::ostream *out) const {
+  auto mib = [](size_t bytes) { return static_cast<double>(bytes) / (1024 * 1024); };
+  std::ios::fmtflags flags = out->flags();
+  std::streamsize precision = out->precision();
+  *out << std::fixed << std::setprecision(2);
+  for (const MemoryUsage &usage : Report()) {
+    *out << MemoryCategoryName(usage.category_) << ": " << mib(usage.current_) << " MiB, peak " << mib(usage.peak_)
+         << " MiB\n";
+  }
+  *out << "total: " << mib(GetTotal()) << " MiB, peak " << mib(GetPeakTotal()) << " MiB\n";
+  out->flags(flags);
+  out->precision(precision);
+}
+
+}  // namespace bustub
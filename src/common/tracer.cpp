@@ -0,0 +1,171 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// tracer.cpp
+//
+// Identification: src/common/tracer.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "common/tracer.h"
+
+#include <algorithm>
+#include <iomanip>
+#include <iterator>
+#include <memory>
+#include <mutex>  // NOLINT
+
+namespace bustub {
+
+std::atomic<bool> Tracer::enabled{false};
+
+namespace {
+
+/** The ring of the spans of one thread. */
+struct TraceRing {
+  /** Taken by the thread as it records, and by whoever reads or resizes the ring. */
+  std::mutex latch_;
+  std::vector<TraceEvent> events_;
+  /** Where the next span goes, and whether the ring went round, so that the ones from there on are the oldest. */
+  size_t next_{0};
+  bool wrapped_{false};
+  /** Whether a thread records into the ring; guarded by rings_latch. */
+  bool in_use_{false};
+  uint32_t thread_{0};
+};
+
+std::mutex rings_latch;
+std::vector<std::unique_ptr<TraceRing>> rings;
+size_t ring_size = Tracer::DEFAULT_EVENTS_PER_THREAD;
+uint32_t next_thread = 1;
+/** The time the spans start from. */
+const std::chrono::steady_clock::time_point epoch = std::chrono::steady_clock::now();
+
+/** Hands the ring of a thread back as the thread exits. */
+struct RingHandle {
+  TraceRing *ring_{nullptr};
+
+  ~RingHandle() {
+    if (ring_ != nullptr) {
+      std::scoped_lock lock(rings_latch);
+      ring_->in_use_ = false;
+    }
+  }
+};
+
+thread_local RingHandle handle;
+
+/** @return the ring of the calling thread, a free one or a new one the first time it traces */
+TraceRing *LocalRing() {
+  if (handle.ring_ == nullptr) {
+    std::scoped_lock lock(rings_latch);
+    auto free = std::find_if(rings.begin(), rings.end(), [](const auto &ring) { return !ring->in_use_; });
+    if (free == rings.end()) {
+      rings.push_back(std::make_unique<TraceRing>());
+      free = std::prev(rings.end());
+    }
+    TraceRing *ring = free->get();
+    std::scoped_lock ring_lock(ring->latch_);
+    ring->in_use_ = true;
+    ring->thread_ = next_thread++;
+    if (ring->events_.size() != ring_size) {
+      ring->events_.assign(ring_size, TraceEvent{});
+      ring->next_ = 0;
+      ring->wrapped_ = false;
+    }
+    handle.ring_ = ring;
+  }
+  return handle.ring_;
+}
+
+uint64_t SinceEpoch(std::chrono::steady_clock::time_point time) {
+  return std::max<int64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(time - epoch).count(), 0);
+}
+
+}  // namespace
+
+void Tracer::Enable(size_t events_per_thread) {
+  std::scoped_lock lock(rings_latch);
+  ring_size = std::max<size_t>(events_per_thread, 1);
+  for (auto &ring : rings) {
+    std::scoped_lock ring_lock(ring->latch_);
+    if (ring->events_.size() != ring_size) {
+      ring->events_.assign(ring_size, TraceEvent{});
+      ring->next_ = 0;
+      ring->wrapped_ = false;
+    }
+  }
+  enabled.store(true);
+}
+
+void Tracer::Disable() { enabled.store(false); }
+
+void Tracer::Clear() {
+  std::scoped_lock lock(rings_latch);
+  for (auto &ring : rings) {
+    std::scoped_lock ring_lock(ring->latch_);
+    ring->next_ = 0;
+    ring->wrapped_ = false;
+  }
+}
+
+void Tracer::AddSpan(const char *name, const char *category, std::chrono::steady_clock::time_point start,
+                     std::chrono::steady_clock::time_point end, const char *arg_name, int64_t arg) {
+  if (!IsEnabled()) {
+    return;
+  }
+  TraceRing *ring = LocalRing();
+  uint64_t start_ns = SinceEpoch(start);
+  uint64_t end_ns = std::max(SinceEpoch(end), start_ns);
+  std::scoped_lock lock(ring->latch_);
+  ring->events_[ring->next_] = {name, category, ring->thread_, start_ns, end_ns - start_ns, arg_name, arg};
+  if (++ring->next_ == ring->events_.size()) {
+    ring->next_ = 0;
+    ring->wrapped_ = true;
+  }
+}
+
+std::vector<TraceEvent> Tracer::GetEvents() {
+  std::vector<TraceEvent> events;
+  {
+    std::scoped_lock lock(rings_latch);
+    for (auto &ring : rings) {
+      std::scoped_lock ring_lock(ring->latch_);
+      size_t count = ring->wrapped_ ? ring->events_.size() : ring->next_;
+      size_t first = ring->wrapped_ ? ring->next_ : 0;
+      for (size_t i = 0; i < count; i++) {
+        events.push_back(ring->events_[(first + i) % ring->events_.size()]);
+      }
+    }
+  }
+  std::stable_sort(events.begin(), events.end(),
+                   [](const TraceEvent &a, const TraceEvent &b) { return a.start_ns_ < b.start_ns_; });
+  return events;
+}
+
+void Tracer::ExportChromeTrace(std::ostream *out) {
+  std::ios::fmtflags flags = out->flags();
+  std::streamsize precision = out->precision();
+  *out << std::fixed << std::setprecision(3) << "{\"traceEvents\":[";
+  bool first = true;
+  for (const TraceEvent &event : GetEvents()) {
+    // the names are literals of the code, which need no escaping
+    *out << (first ? "\n" : ",\n") << "{\"name\":\"" << event.name_ << "\",\"cat\":\"" << event.category_
+         << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << event.thread_
+         << ",\"ts\":" << static_cast<double>(event.start_ns_) / 1000
+         << ",\"dur\":" << static_cast<double>(event.duration_ns_) / 1000;
+    if (event.arg_name_ != nullptr) {
+      *out << ",\"args\":{\"" << event.arg_name_ << "\":" << event.arg_ << "}";
+    }
+    *out << "}";
+    first = false;
+  }
+  *out << "\n],\"displayTimeUnit\":\"ns\"}\n";
+  out->flags(flags);
+  out->precision(precision);
+}
+
+}  // namespace bustub
@@ -0,0 +1,89 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// crc32c.cpp
+//
+// Identification: src/common/util/crc32c.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "common/util/crc32c.h"
+
+#include <array>
+#include <cstring>
+
+#if defined(__x86_64__)
+#include <nmmintrin.h>
+#endif
+
+namespace bustub {
+
+namespace {
+
+/** The CRC-32C polynomial, bit-reflected. */
+constexpr uint32_t CRC32C_POLYNOMIAL = 0x82F63B78;
+
+constexpr std::array<uint32_t, 256> MakeTable() {
+  std::array<uint32_t, 256> table{};
+  for (uint32_t i = 0; i < 256; ++i) {
+    uint32_t crc = i;
+    for (int bit = 0; bit < 8; ++bit) {
+      crc = (crc >> 1) ^ ((crc & 1) != 0 ? CRC32C_POLYNOMIAL : 0);
+    }
+    table[i] = crc;
+  }
+  return table;
+}
+
+constexpr std::array<uint32_t, 256> CRC32C_TABLE = MakeTable();
+
+uint32_t ComputeSoftware(const char *data, size_t length, uint32_t crc) {
+  for (size_t i = 0; i < length; ++i) {
+    crc = (crc >> 8) ^ CRC32C_TABLE[(crc ^ static_cast<uint8_t>(data[i])) & 0xFF];
+  }
+  return crc;
+}
+
+#if defined(__x86_64__)
+__attribute__((target("sse4.2"))) uint32_t ComputeHardware(const char *data, size_t length, uint32_t crc) {
+  uint64_t crc64 = crc;
+  size_t i = 0;
+  for (; i + sizeof(uint64_t) <= length; i += sizeof(uint64_t)) {
+    uint64_t word;
+    memcpy(&word, data + i, sizeof(word));
+    crc64 = _mm_crc32_u64(crc64, word);
+  }
+  auto crc32 = static_cast<uint32_t>(crc64);
+  for (; i < length; ++i) {
+    crc32 = _mm_crc32_u8(crc32, static_cast<uint8_t>(data[i]));
+  }
+  return crc32;
+}
+
+// runs during static initialization, before the CPU model would be set up otherwise
+const bool HAS_SSE42 = [] {
+  __builtin_cpu_init();
+  return __builtin_cpu_supports("sse4.2") != 0;
+}();
+#else
+const bool HAS_SSE42 = false;
+#endif
+
+}  // namespace
+
+uint32_t Crc32c::Compute(const char *data, size_t length, uint32_t crc) {
+  crc = ~crc;
+#if defined(__x86_64__)
+  if (HAS_SSE42) {
+    return ~ComputeHardware(data, length, crc);
+  }
+#endif
+  return ~ComputeSoftware(data, length, crc);
+}
+
+bool Crc32c::IsHardwareAccelerated() { return HAS_SSE42; }
+
+}  // namespace bustub
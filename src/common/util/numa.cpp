@@ -0,0 +1,101 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// numa.cpp
+//
+// Identification: src/common/util/numa.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "common/util/numa.h"
+
+#ifdef __linux__
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+namespace bustub {
+
+namespace {
+/** @return the CPUs of a cpulist of sysfs, e.g. "0-3,8-11" */
+std::vector<int> ParseCpuList(const std::string &list) {
+  std::vector<int> cpus;
+  std::stringstream stream(list);
+  std::string item;
+  while (std::getline(stream, item, ',')) {
+    if (item.empty()) {
+      continue;
+    }
+    size_t dash = item.find('-');
+    int first = std::stoi(item.substr(0, dash));
+    int last = dash == std::string::npos ? first : std::stoi(item.substr(dash + 1));
+    for (int cpu = first; cpu <= last; cpu++) {
+      cpus.push_back(cpu);
+    }
+  }
+  return cpus;
+}
+
+/** @return the cpulist of a node, false if sysfs does not have the node */
+bool ReadCpuList(int node, std::string *list) {
+  std::ifstream file("/sys/devices/system/node/node" + std::to_string(node) + "/cpulist");
+  return file && std::getline(file, *list);
+}
+}  // namespace
+
+size_t Numa::GetNodeCount() {
+  size_t count = 0;
+  std::string list;
+  while (ReadCpuList(static_cast<int>(count), &list)) {
+    count++;
+  }
+  return std::max<size_t>(count, 1);
+}
+
+std::vector<int> Numa::GetCpusOfNode(int node) {
+  std::string list;
+  if (node < 0 || !ReadCpuList(node, &list)) {
+    return {};
+  }
+  return ParseCpuList(list);
+}
+
+int Numa::GetNodeOfCpu(int cpu) {
+  std::string list;
+  for (int node = 0; ReadCpuList(node, &list); node++) {
+    std::vector<int> cpus = ParseCpuList(list);
+    if (std::find(cpus.begin(), cpus.end(), cpu) != cpus.end()) {
+      return node;
+    }
+  }
+  return -1;
+}
+
+bool Numa::PreferNode(void *address, size_t size, int node) {
+#if defined(__linux__) && defined(SYS_mbind)
+  // MPOL_PREFERRED of <numaif.h>, which is libnuma's header rather than the kernel's
+  constexpr int mpol_preferred = 1;
+  constexpr size_t mask_bits = sizeof(unsigned long) * 8;  // NOLINT
+  // the kernel reads one bit less of the mask than it is told to
+  if (node < 0 || static_cast<size_t>(node) >= mask_bits - 1) {
+    return false;
+  }
+  unsigned long node_mask = 1UL << node;  // NOLINT
+  return syscall(SYS_mbind, address, size, mpol_preferred, &node_mask, mask_bits, 0) == 0;
+#else
+  (void)address;
+  (void)size;
+  (void)node;
+  return false;
+#endif
+}
+
+}  // namespace bustub
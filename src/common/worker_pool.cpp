@@ -0,0 +1,143 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// worker_pool.cpp
+//
+// Identification: src/common/worker_pool.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "common/worker_pool.h"
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+#include <algorithm>
+
+#include "common/util/numa.h"
+
+namespace bustub {
+
+WorkerPool::WorkerPool(bool pin_threads) : pin_threads_(pin_threads), cpus_(CpusInNumaOrder()) {
+  for (int cpu : cpus_) {
+    nodes_.push_back(Numa::GetNodeOfCpu(cpu));
+  }
+}
+
+WorkerPool::~WorkerPool() {
+  {
+    std::scoped_lock lock{latch_};
+    stop_ = true;
+  }
+  work_cv_.notify_all();
+  for (auto &thread : threads_) {
+    thread.join();
+  }
+}
+
+WorkerPool *WorkerPool::Instance() {
+  static WorkerPool pool;
+  return &pool;
+}
+
+std::vector<int> WorkerPool::CpusInNumaOrder() {
+  std::vector<int> allowed;
+#ifdef __linux__
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  if (sched_getaffinity(0, sizeof(set), &set) == 0) {
+    for (int cpu = 0; cpu < CPU_SETSIZE; cpu++) {
+      if (CPU_ISSET(cpu, &set)) {
+        allowed.push_back(cpu);
+      }
+    }
+  }
+#endif
+  std::vector<int> cpus;
+  int num_nodes = static_cast<int>(Numa::GetNodeCount());
+  for (int node = 0; node < num_nodes; node++) {
+    for (int cpu : Numa::GetCpusOfNode(node)) {
+      if (std::find(allowed.begin(), allowed.end(), cpu) != allowed.end() &&
+          std::find(cpus.begin(), cpus.end(), cpu) == cpus.end()) {
+        cpus.push_back(cpu);
+      }
+    }
+  }
+  // without NUMA nodes to tell, or with CPUs of none, the CPUs are in their order
+  for (int cpu : allowed) {
+    if (std::find(cpus.begin(), cpus.end(), cpu) == cpus.end()) {
+      cpus.push_back(cpu);
+    }
+  }
+  return cpus;
+}
+
+int WorkerPool::GetWorkerNode(size_t index) const {
+  return pin_threads_ && index < nodes_.size() ? nodes_[index] : -1;
+}
+
+size_t WorkerPool::GetWorkerCount() {
+  std::scoped_lock lock{latch_};
+  return threads_.size();
+}
+
+void WorkerPool::Run(size_t num_workers, const std::function<void(size_t)> &work) {
+  std::scoped_lock run_lock{run_latch_};
+  std::unique_lock lock{latch_};
+  while (threads_.size() < num_workers) {
+    threads_.emplace_back([this, index = threads_.size()] { WorkerLoop(index); });
+  }
+  work_ = &work;
+  num_active_ = num_workers;
+  remaining_ = num_workers;
+  error_ = nullptr;
+  generation_++;
+  work_cv_.notify_all();
+  done_cv_.wait(lock, [this] { return remaining_ == 0; });
+  work_ = nullptr;
+  if (error_ != nullptr) {
+    std::rethrow_exception(error_);
+  }
+}
+
+void WorkerPool::WorkerLoop(size_t index) {
+#ifdef __linux__
+  // a thread beyond the CPUs is left to the scheduler, rather than sharing a CPU with another one
+  if (pin_threads_ && index < cpus_.size()) {
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpus_[index], &set);
+    pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+  }
+#endif
+  uint64_t seen = 0;
+  for (;;) {
+    std::unique_lock lock{latch_};
+    work_cv_.wait(lock, [&] { return stop_ || (generation_ != seen && index < num_active_); });
+    if (stop_) {
+      return;
+    }
+    seen = generation_;
+    const std::function<void(size_t)> *work = work_;
+    lock.unlock();
+    try {
+      (*work)(index);
+    } catch (...) {
+      std::scoped_lock error_lock{latch_};
+      if (error_ == nullptr) {
+        error_ = std::current_exception();
+      }
+    }
+    lock.lock();
+    if (--remaining_ == 0) {
+      done_cv_.notify_all();
+    }
+  }
+}
+
+}  // namespace bustub
@@ -12,49 +12,755 @@
 
 #include "concurrency/lock_manager.h"
 
+#include <algorithm>
+#include <functional>
+#include <unordered_set>
 #include <utility>
 #include <vector>
 
+#include "common/tracer.h"
+
 namespace bustub {
 
-bool LockManager::LockShared(Transaction *txn, const RID &rid) {
+LockManager::LockRequestQueue &LockManager::LockTableShard::QueueOf(const RID &rid) {
+  auto queue = lock_table_.find(rid);
+  if (queue != lock_table_.end()) {
+    return queue->second;
+  }
+  if (free_queues_.empty()) {
+    return lock_table_[rid];
+  }
+  auto node = std::move(free_queues_.back());
+  free_queues_.pop_back();
+  node.key() = rid;
+  node.mapped().upgrading_ = false;
+  return lock_table_.insert(std::move(node)).position->second;
+}
+
+LockManager::RequestList::iterator LockManager::LockTableShard::AddRequest(
+    LockRequestQueue *queue, RequestList::iterator position, Transaction *txn, LockMode lock_mode) {
+  if (free_requests_.empty()) {
+    return queue->request_queue_.emplace(position, txn, lock_mode);
+  }
+  // a spliced node keeps its iterator
+  auto request = free_requests_.begin();
+  *request = LockRequest(txn, lock_mode);
+  queue->request_queue_.splice(position, free_requests_, request);
+  return request;
+}
+
+void LockManager::LockTableShard::DropRequests(LockRequestQueue *queue, txn_id_t txn_id) {
+  for (auto request = queue->request_queue_.begin(); request != queue->request_queue_.end();) {
+    auto next = std::next(request);
+    if (request->txn_id_ == txn_id) {
+      DropRequest(queue, request);
+    }
+    request = next;
+  }
+}
+
+void LockManager::LockTableShard::RecordRowWait(const RID &rid, std::chrono::nanoseconds wait) {
+  auto ns = static_cast<uint64_t>(std::max<int64_t>(wait.count(), 0));
+  auto row =
+      std::find_if(hot_rows_.begin(), hot_rows_.end(), [&](const RowContention &hot) { return hot.rid_ == rid; });
+  if (row != hot_rows_.end()) {
+    row->waits_++;
+    row->wait_ns_ += ns;
+  } else if (hot_rows_.size() < HOT_ROWS_PER_SHARD) {
+    hot_rows_.push_back({rid, 1, ns});
+  } else {
+    row = std::min_element(hot_rows_.begin(), hot_rows_.end(),
+                           [](const RowContention &a, const RowContention &b) { return a.waits_ < b.waits_; });
+    *row = {rid, row->waits_ + 1, ns};
+  }
+}
+
+bool LockManager::AreCompatible(LockMode first, LockMode second) {
+  if (first == LockMode::EXCLUSIVE || second == LockMode::EXCLUSIVE) {
+    return false;
+  }
+  if (first == LockMode::INTENTION_SHARED || second == LockMode::INTENTION_SHARED) {
+    return true;
+  }
+  // of the rest, two shared locks allow each other, as do two intentions to write
+  return first == second && first != LockMode::SHARED_INTENTION_EXCLUSIVE;
+}
+
+bool LockManager::Covers(LockMode held, LockMode mode) {
+  switch (mode) {
+    case LockMode::INTENTION_SHARED:
+      return true;
+    case LockMode::INTENTION_EXCLUSIVE:
+      return held == LockMode::INTENTION_EXCLUSIVE || held == LockMode::SHARED_INTENTION_EXCLUSIVE ||
+             held == LockMode::EXCLUSIVE;
+    case LockMode::SHARED:
+      return held == LockMode::SHARED || held == LockMode::SHARED_INTENTION_EXCLUSIVE || held == LockMode::EXCLUSIVE;
+    case LockMode::SHARED_INTENTION_EXCLUSIVE:
+      return held == LockMode::SHARED_INTENTION_EXCLUSIVE || held == LockMode::EXCLUSIVE;
+    case LockMode::EXCLUSIVE:
+      return held == LockMode::EXCLUSIVE;
+  }
+  return false;
+}
+
+bool LockManager::HoldsTableLock(Transaction *txn, table_oid_t oid, LockMode mode) {
+  auto held = txn->GetTableLockSet()->find(oid);
+  return held != txn->GetTableLockSet()->end() && Covers(held->second, mode);
+}
+
+bool LockManager::CheckGrowing(Transaction *txn) {
+  if (txn->GetState() == TransactionState::ABORTED) {
+    return false;
+  }
+  if (txn->GetState() == TransactionState::SHRINKING) {
+    txn->SetState(TransactionState::ABORTED);
+    throw TransactionAbortException(txn->GetTransactionId(), AbortReason::LOCK_ON_SHRINKING);
+  }
+  return true;
+}
+
+bool LockManager::IsGrantable(const LockRequestQueue &queue, RequestList::iterator request) {
+  // an upgrade goes ahead of granted requests that are compatible with the lock it replaces, which it waits for too
+  bool ahead = true;
+  for (auto other = queue.request_queue_.begin(); other != queue.request_queue_.end(); ++other) {
+    if (other == request) {
+      ahead = false;
+    } else if (WaitsFor(*request, *other, ahead)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool LockManager::PreventDeadlock(std::unique_lock<std::mutex> *lock, LockTableShard *shard, LockRequestQueue *queue,
+                                  RequestList::iterator request) {
+  std::vector<txn_id_t> wounded;
+  bool ahead = true;
+  for (auto other = queue->request_queue_.begin(); other != queue->request_queue_.end(); ++other) {
+    if (other == request) {
+      ahead = false;
+      continue;
+    }
+    if (!WaitsFor(*request, *other, ahead)) {
+      continue;
+    }
+    if (policy_ == DeadlockPolicy::WAIT_DIE && other->txn_id_ < request->txn_id_) {
+      request->txn_->SetState(TransactionState::ABORTED);
+      return false;
+    }
+    // a shrinking transaction waits for nothing, and is let finish
+    if (policy_ == DeadlockPolicy::WOUND_WAIT && other->txn_id_ > request->txn_id_ &&
+        other->txn_->CompareAndSetState(TransactionState::GROWING, TransactionState::ABORTED)) {
+      wounded.push_back(other->txn_id_);
+    }
+  }
+  if (wounded.empty()) {
+    return false;
+  }
+
+  // the wounded transactions that wait are woken up under the latch of the shard they wait in, after their state is
+  // set, so that none of them checks its state before and waits after
+  queue->cv_.notify_all();
+  std::vector<RID> elsewhere;
+  {
+    auto graph_lock = graph_latch_site_->Acquire(&latch_);
+    for (txn_id_t txn_id : wounded) {
+      auto waiter = waiters_.find(txn_id);
+      if (waiter == waiters_.end()) {
+        continue;
+      }
+      const RID &rid = waiter->second.rid_;
+      if (&ShardOf(rid) != shard) {
+        elsewhere.push_back(rid);
+      } else if (auto other = shard->lock_table_.find(rid); other != shard->lock_table_.end()) {
+        other->second.cv_.notify_all();
+      }
+    }
+  }
+  if (elsewhere.empty()) {
+    return false;
+  }
+  lock->unlock();
+  for (const RID &rid : elsewhere) {
+    LockTableShard &other_shard = ShardOf(rid);
+    auto other_lock = shard_latch_site_->Acquire(&other_shard.latch_);
+    if (auto other = other_shard.lock_table_.find(rid); other != other_shard.lock_table_.end()) {
+      other->second.cv_.notify_all();
+    }
+  }
+  shard_latch_site_->Lock(lock);
+  return true;
+}
+
+void LockManager::WaitForGrant(std::unique_lock<std::mutex> *lock, LockTableShard *shard, const RID &rid,
+                               RequestList::iterator request, bool upgrade) {
+  LockRequestQueue &queue = shard->lock_table_.at(rid);
+  Transaction *txn = request->txn_;
+  bool waited = false;
+  std::chrono::steady_clock::time_point wait_start;
+  while (txn->GetState() != TransactionState::ABORTED && !IsGrantable(queue, request)) {
+    if (!waited) {
+      // a transaction that wounds this one looks it up after it set its state, which is checked again below
+      waited = true;
+      wait_start = std::chrono::steady_clock::now();
+      auto graph_lock = graph_latch_site_->Acquire(&latch_);
+      size_t locks_held =
+          txn->GetSharedLockSet()->size() + txn->GetExclusiveLockSet()->size() + txn->GetTableLockSet()->size();
+      waiters_[txn->GetTransactionId()] = Waiter{txn, rid, locks_held};
+      if (policy_ == DeadlockPolicy::DETECTION) {
+        UpdateWaitsFor(queue);
+      }
+    }
+    if (policy_ != DeadlockPolicy::DETECTION && (PreventDeadlock(lock, shard, &queue, request) ||
+                                                 txn->GetState() == TransactionState::ABORTED)) {
+      continue;
+    }
+    queue.cv_.wait(*lock);
+  }
+  if (waited) {
+    auto wait_end = std::chrono::steady_clock::now();
+    lock_wait_latency_.Record(wait_end - wait_start);
+    // a table is locked under INVALID_PAGE_ID, and the key ranges of the indexes under the page ids below it
+    if (rid.GetPageId() >= 0) {
+      row_lock_site_->RecordWait(wait_end - wait_start);
+      shard->RecordRowWait(rid, wait_end - wait_start);
+    } else if (rid.GetPageId() == INVALID_PAGE_ID) {
+      table_lock_site_->RecordWait(wait_end - wait_start);
+    } else {
+      key_range_lock_site_->RecordWait(wait_end - wait_start);
+    }
+    Tracer::AddSpan("lock_wait", "lock", wait_start, wait_end, "txn_id", txn->GetTransactionId());
+    auto graph_lock = graph_latch_site_->Acquire(&latch_);
+    waiters_.erase(txn->GetTransactionId());
+    waits_for_.erase(txn->GetTransactionId());
+  }
+  if (upgrade) {
+    queue.upgrading_ = false;
+  }
+  if (txn->GetState() != TransactionState::ABORTED) {
+    request->granted_ = true;
+    return;
+  }
+  // the transaction was aborted by the deadlock policy, and its request may have held up the ones behind it
+  shard->DropRequest(&queue, request);
+  if (queue.request_queue_.empty()) {
+    shard->DropQueue(rid);
+  } else {
+    queue.cv_.notify_all();
+    if (policy_ == DeadlockPolicy::DETECTION) {
+      auto graph_lock = graph_latch_site_->Acquire(&latch_);
+      UpdateWaitsFor(queue);
+    }
+  }
+  throw TransactionAbortException(txn->GetTransactionId(), AbortReason::DEADLOCK);
+}
+
+bool LockManager::LockShared(Transaction *txn, const RID &rid, table_oid_t oid) {
+  if (!CheckGrowing(txn)) {
+    return false;
+  }
+  if (txn->GetIsolationLevel() == IsolationLevel::READ_UNCOMMITTED) {
+    txn->SetState(TransactionState::ABORTED);
+    throw TransactionAbortException(txn->GetTransactionId(), AbortReason::LOCKSHARED_ON_READ_UNCOMMITTED);
+  }
+  if (txn->IsSharedLocked(rid) || txn->IsExclusiveLocked(rid)) {
+    return true;
+  }
+  if (oid != INVALID_TABLE_OID) {
+    if (HoldsTableLock(txn, oid, LockMode::SHARED)) {
+      return true;
+    }
+    if (!LockTable(txn, oid, LockMode::INTENTION_SHARED)) {
+      return false;
+    }
+  }
+  LockTableShard &shard = ShardOf(rid);
+  auto lock = shard_latch_site_->Acquire(&shard.latch_);
+  LockRequestQueue &queue = shard.QueueOf(rid);
+  auto request = shard.AddRequest(&queue, queue.request_queue_.end(), txn, LockMode::SHARED);
+  WaitForGrant(&lock, &shard, rid, request, false);
+  lock.unlock();
   txn->GetSharedLockSet()->emplace(rid);
+  if (oid != INVALID_TABLE_OID) {
+    (*txn->GetTableRowLockSet())[oid].emplace(rid);
+    MaybeEscalate(txn, oid);
+  }
+  return true;
+}
+
+bool LockManager::LockExclusive(Transaction *txn, const RID &rid, table_oid_t oid) {
+  if (!CheckGrowing(txn)) {
+    return false;
+  }
+  if (txn->IsExclusiveLocked(rid)) {
+    return true;
+  }
+  if (txn->IsSharedLocked(rid)) {
+    return LockUpgrade(txn, rid, oid);
+  }
+  if (oid != INVALID_TABLE_OID) {
+    if (HoldsTableLock(txn, oid, LockMode::EXCLUSIVE)) {
+      return true;
+    }
+    if (!LockTable(txn, oid, LockMode::INTENTION_EXCLUSIVE)) {
+      return false;
+    }
+  }
+  LockTableShard &shard = ShardOf(rid);
+  auto lock = shard_latch_site_->Acquire(&shard.latch_);
+  LockRequestQueue &queue = shard.QueueOf(rid);
+  auto request = shard.AddRequest(&queue, queue.request_queue_.end(), txn, LockMode::EXCLUSIVE);
+  WaitForGrant(&lock, &shard, rid, request, false);
+  lock.unlock();
+  txn->GetExclusiveLockSet()->emplace(rid);
+  if (oid != INVALID_TABLE_OID) {
+    (*txn->GetTableRowLockSet())[oid].emplace(rid);
+    MaybeEscalate(txn, oid);
+  }
   return true;
 }
 
-bool LockManager::LockExclusive(Transaction *txn, const RID &rid) {
+bool LockManager::LockNewTuple(Transaction *txn, const RID &rid, table_oid_t oid) {
+  if (oid != INVALID_TABLE_OID && HoldsTableLock(txn, oid, LockMode::EXCLUSIVE)) {
+    return true;
+  }
+  {
+    LockTableShard &shard = ShardOf(rid);
+    auto lock = shard_latch_site_->Acquire(&shard.latch_);
+    LockRequestQueue &queue = shard.QueueOf(rid);
+    if (!queue.request_queue_.empty()) {
+      return false;
+    }
+    shard.AddRequest(&queue, queue.request_queue_.end(), txn, LockMode::EXCLUSIVE)->granted_ = true;
+  }
   txn->GetExclusiveLockSet()->emplace(rid);
+  if (oid != INVALID_TABLE_OID && HoldsTableLock(txn, oid, LockMode::INTENTION_EXCLUSIVE)) {
+    (*txn->GetTableRowLockSet())[oid].emplace(rid);
+    MaybeEscalate(txn, oid);
+  }
   return true;
 }
 
-bool LockManager::LockUpgrade(Transaction *txn, const RID &rid) {
+bool LockManager::LockUpgrade(Transaction *txn, const RID &rid, table_oid_t oid) {
+  if (!CheckGrowing(txn)) {
+    return false;
+  }
+  if (txn->IsExclusiveLocked(rid)) {
+    return true;
+  }
+  if (!txn->IsSharedLocked(rid)) {
+    return false;
+  }
+  if (oid != INVALID_TABLE_OID) {
+    if (HoldsTableLock(txn, oid, LockMode::EXCLUSIVE)) {
+      return true;
+    }
+    if (!LockTable(txn, oid, LockMode::INTENTION_EXCLUSIVE)) {
+      return false;
+    }
+  }
+  UpgradeRequest(txn, rid, LockMode::EXCLUSIVE);
   txn->GetSharedLockSet()->erase(rid);
   txn->GetExclusiveLockSet()->emplace(rid);
   return true;
 }
 
+bool LockManager::UpgradeRequest(Transaction *txn, const RID &rid, LockMode mode, bool wait) {
+  LockTableShard &shard = ShardOf(rid);
+  auto lock = shard_latch_site_->Acquire(&shard.latch_);
+  LockRequestQueue &queue = shard.lock_table_.at(rid);
+  if (!wait) {
+    // the upgrade goes ahead of the waiting requests, so it is granted at once if the granted ones are compatible
+    bool grantable = !queue.upgrading_ && std::all_of(queue.request_queue_.begin(), queue.request_queue_.end(),
+                                                      [txn, mode](const LockRequest &request) {
+                                                        return !request.granted_ ||
+                                                               request.txn_id_ == txn->GetTransactionId() ||
+                                                               AreCompatible(request.lock_mode_, mode);
+                                                      });
+    if (!grantable) {
+      return false;
+    }
+  }
+  if (queue.upgrading_) {
+    txn->SetState(TransactionState::ABORTED);
+    throw TransactionAbortException(txn->GetTransactionId(), AbortReason::UPGRADE_CONFLICT);
+  }
+  // the stronger request takes the place of the granted one, after the granted requests and ahead of the waiting
+  // ones, which a new request would have been behind anyway
+  RequestList &requests = queue.request_queue_;
+  shard.DropRequests(&queue, txn->GetTransactionId());
+  auto waiting = std::find_if(requests.begin(), requests.end(), [](const LockRequest &request) {
+    return !request.granted_;
+  });
+  auto request = shard.AddRequest(&queue, waiting, txn, mode);
+  queue.upgrading_ = true;
+  // the requests that wait now wait for this one too, which the policy may have to break
+  queue.cv_.notify_all();
+  if (policy_ == DeadlockPolicy::DETECTION) {
+    auto graph_lock = graph_latch_site_->Acquire(&latch_);
+    UpdateWaitsFor(queue);
+  }
+  WaitForGrant(&lock, &shard, rid, request, true);
+  return true;
+}
+
+void LockManager::RemoveRequest(Transaction *txn, const RID &rid) {
+  LockTableShard &shard = ShardOf(rid);
+  auto lock = shard_latch_site_->Acquire(&shard.latch_);
+  auto queue = shard.lock_table_.find(rid);
+  if (queue == shard.lock_table_.end()) {
+    return;
+  }
+  shard.DropRequests(&queue->second, txn->GetTransactionId());
+  if (queue->second.request_queue_.empty()) {
+    shard.DropQueue(rid);
+    return;
+  }
+  queue->second.cv_.notify_all();
+  if (policy_ == DeadlockPolicy::DETECTION) {
+    auto graph_lock = graph_latch_site_->Acquire(&latch_);
+    UpdateWaitsFor(queue->second);
+  }
+}
+
 bool LockManager::Unlock(Transaction *txn, const RID &rid) {
-  txn->GetSharedLockSet()->erase(rid);
-  txn->GetExclusiveLockSet()->erase(rid);
+  bool shared = txn->GetSharedLockSet()->erase(rid) != 0;
+  bool exclusive = txn->GetExclusiveLockSet()->erase(rid) != 0;
+  if (!shared && !exclusive) {
+    return false;
+  }
+  std::unordered_map<table_oid_t, std::unordered_set<RID>> &table_rows = *txn->GetTableRowLockSet();
+  for (auto rows = table_rows.begin(); rows != table_rows.end(); ++rows) {
+    if (rows->second.erase(rid) != 0) {
+      if (rows->second.empty()) {
+        table_rows.erase(rows);
+      }
+      break;
+    }
+  }
+  RemoveRequest(txn, rid);
+  // a READ_COMMITTED transaction lets go of the shared lock of each record once it read it, and keeps growing
+  if (txn->GetState() == TransactionState::GROWING &&
+      (exclusive || txn->GetIsolationLevel() != IsolationLevel::READ_COMMITTED)) {
+    txn->SetState(TransactionState::SHRINKING);
+  }
+  return true;
+}
+
+bool LockManager::LockTable(Transaction *txn, table_oid_t oid, LockMode mode) {
+  if (!CheckGrowing(txn)) {
+    return false;
+  }
+  if (txn->GetIsolationLevel() == IsolationLevel::READ_UNCOMMITTED && mode != LockMode::EXCLUSIVE &&
+      mode != LockMode::INTENTION_EXCLUSIVE) {
+    txn->SetState(TransactionState::ABORTED);
+    throw TransactionAbortException(txn->GetTransactionId(), AbortReason::LOCKSHARED_ON_READ_UNCOMMITTED);
+  }
+  std::unordered_map<table_oid_t, LockMode> &table_locks = *txn->GetTableLockSet();
+  const RID rid = TableRid(oid);
+  auto held = table_locks.find(oid);
+  if (held == table_locks.end()) {
+    LockTableShard &shard = ShardOf(rid);
+    auto lock = shard_latch_site_->Acquire(&shard.latch_);
+    LockRequestQueue &queue = shard.QueueOf(rid);
+    auto request = shard.AddRequest(&queue, queue.request_queue_.end(), txn, mode);
+    WaitForGrant(&lock, &shard, rid, request, false);
+    table_locks.emplace(oid, mode);
+    return true;
+  }
+  if (Covers(held->second, mode)) {
+    return true;
+  }
+  LockMode upgraded = Combine(held->second, mode);
+  UpgradeRequest(txn, rid, upgraded);
+  held->second = upgraded;
+  return true;
+}
+
+void LockManager::MaybeEscalate(Transaction *txn, table_oid_t oid) {
+  auto rows = txn->GetTableRowLockSet()->find(oid);
+  size_t threshold = escalation_threshold_;
+  if (threshold == 0 || rows->second.size() % threshold != 0) {
+    return;
+  }
+  bool exclusive = std::any_of(rows->second.begin(), rows->second.end(),
+                               [txn](const RID &rid) { return txn->IsExclusiveLocked(rid); });
+  // the records were locked with the table, so the transaction holds an intention lock of it already
+  LockMode &table_mode = txn->GetTableLockSet()->at(oid);
+  LockMode escalated = Combine(table_mode, exclusive ? LockMode::EXCLUSIVE : LockMode::SHARED);
+  if (!UpgradeRequest(txn, TableRid(oid), escalated, false)) {
+    return;
+  }
+  table_mode = escalated;
+  for (const RID &rid : rows->second) {
+    txn->GetSharedLockSet()->erase(rid);
+    txn->GetExclusiveLockSet()->erase(rid);
+    RemoveRequest(txn, rid);
+  }
+  txn->GetTableRowLockSet()->erase(rows);
+}
+
+bool LockManager::UnlockTable(Transaction *txn, table_oid_t oid) {
+  auto held = txn->GetTableLockSet()->find(oid);
+  if (held == txn->GetTableLockSet()->end()) {
+    return false;
+  }
+  LockMode mode = held->second;
+  txn->GetTableLockSet()->erase(held);
+  RemoveRequest(txn, TableRid(oid));
+  // an intention lock locks no records, and a READ_COMMITTED transaction may let go of a shared lock as it may of a
+  // record's
+  bool shrinks = mode == LockMode::EXCLUSIVE || mode == LockMode::SHARED_INTENTION_EXCLUSIVE ||
+                 (mode == LockMode::SHARED && txn->GetIsolationLevel() != IsolationLevel::READ_COMMITTED);
+  if (txn->GetState() == TransactionState::GROWING && shrinks) {
+    txn->SetState(TransactionState::SHRINKING);
+  }
+  return true;
+}
+
+bool LockManager::LockKeyRange(Transaction *txn, const RID &range, LockMode mode, bool instant) {
+  if (!instant || txn->IsSharedLocked(range)) {
+    return mode == LockMode::SHARED ? LockShared(txn, range) : LockExclusive(txn, range);
+  }
+  if (!CheckGrowing(txn)) {
+    return false;
+  }
+  if (txn->IsExclusiveLocked(range)) {
+    return true;
+  }
+  LockTableShard &shard = ShardOf(range);
+  auto lock = shard_latch_site_->Acquire(&shard.latch_);
+  LockRequestQueue &queue = shard.QueueOf(range);
+  auto request = shard.AddRequest(&queue, queue.request_queue_.end(), txn, mode);
+  WaitForGrant(&lock, &shard, range, request, false);
+  lock.unlock();
+  RemoveRequest(txn, range);
+  return true;
+}
+
+bool LockManager::TryLockKeyRange(Transaction *txn, const RID &range, LockMode mode) {
+  if (txn->IsExclusiveLocked(range) || (mode == LockMode::SHARED && txn->IsSharedLocked(range))) {
+    return true;
+  }
+  if (txn->GetState() != TransactionState::GROWING || txn->IsSharedLocked(range)) {
+    // a shrinking transaction throws, and an upgrade may wait, on the way that waits
+    return false;
+  }
+  LockTableShard &shard = ShardOf(range);
+  auto lock = shard_latch_site_->Acquire(&shard.latch_);
+  LockRequestQueue &queue = shard.QueueOf(range);
+  auto request = shard.AddRequest(&queue, queue.request_queue_.end(), txn, mode);
+  if (!IsGrantable(queue, request)) {
+    shard.DropRequest(&queue, request);
+    if (queue.request_queue_.empty()) {
+      shard.DropQueue(range);
+    }
+    return false;
+  }
+  request->granted_ = true;
+  if (mode == LockMode::SHARED) {
+    txn->GetSharedLockSet()->emplace(range);
+  } else {
+    txn->GetExclusiveLockSet()->emplace(range);
+  }
   return true;
 }
 
-void LockManager::AddEdge(txn_id_t t1, txn_id_t t2) {}
+std::vector<RowContention> LockManager::GetHotRids(size_t limit) {
+  std::vector<RowContention> rows;
+  for (LockTableShard &shard : shards_) {
+    auto lock = shard_latch_site_->Acquire(&shard.latch_);
+    rows.insert(rows.end(), shard.hot_rows_.begin(), shard.hot_rows_.end());
+  }
+  std::sort(rows.begin(), rows.end(), [](const RowContention &a, const RowContention &b) {
+    return a.waits_ != b.waits_ ? a.waits_ > b.waits_ : a.wait_ns_ > b.wait_ns_;
+  });
+  rows.resize(std::min(limit, rows.size()));
+  return rows;
+}
+
+void LockManager::AddEdge(txn_id_t t1, txn_id_t t2) {
+  auto lock = graph_latch_site_->Acquire(&latch_);
+  std::vector<txn_id_t> &edges = waits_for_[t1];
+  if (std::find(edges.begin(), edges.end(), t2) == edges.end()) {
+    edges.push_back(t2);
+  }
+}
 
-void LockManager::RemoveEdge(txn_id_t t1, txn_id_t t2) {}
+void LockManager::RemoveEdge(txn_id_t t1, txn_id_t t2) {
+  auto lock = graph_latch_site_->Acquire(&latch_);
+  auto edges = waits_for_.find(t1);
+  if (edges == waits_for_.end()) {
+    return;
+  }
+  edges->second.erase(std::remove(edges->second.begin(), edges->second.end(), t2), edges->second.end());
+  if (edges->second.empty()) {
+    waits_for_.erase(edges);
+  }
+}
 
-bool LockManager::HasCycle(txn_id_t *txn_id) { return false; }
+bool LockManager::HasCycle(txn_id_t *txn_id) {
+  auto lock = graph_latch_site_->Acquire(&latch_);
+  return FindCycle(waits_for_, txn_id);
+}
 
-std::vector<std::pair<txn_id_t, txn_id_t>> LockManager::GetEdgeList() { return {}; }
+std::vector<std::pair<txn_id_t, txn_id_t>> LockManager::GetEdgeList() {
+  auto lock = graph_latch_site_->Acquire(&latch_);
+  std::vector<std::pair<txn_id_t, txn_id_t>> edges;
+  for (const auto &[from, tos] : waits_for_) {
+    for (txn_id_t to : tos) {
+      edges.emplace_back(from, to);
+    }
+  }
+  return edges;
+}
+
+bool LockManager::FindCycle(const WaitsForGraph &graph, txn_id_t *txn_id) {
+  // a depth-first search from the oldest transaction, which follows the older of the edges first, so the cycles are
+  // found in the same order every time
+  std::vector<txn_id_t> nodes;
+  nodes.reserve(graph.size());
+  for (const auto &[node, edges] : graph) {
+    nodes.push_back(node);
+  }
+  std::sort(nodes.begin(), nodes.end());
+  std::unordered_set<txn_id_t> visited;
+  std::vector<txn_id_t> path;
+  std::function<bool(txn_id_t)> visit = [&](txn_id_t node) {
+    auto on_path = std::find(path.begin(), path.end(), node);
+    if (on_path != path.end()) {
+      *txn_id = *std::max_element(on_path, path.end());
+      return true;
+    }
+    if (!visited.insert(node).second) {
+      return false;
+    }
+    path.push_back(node);
+    if (auto edges = graph.find(node); edges != graph.end()) {
+      std::vector<txn_id_t> next = edges->second;
+      std::sort(next.begin(), next.end());
+      for (txn_id_t to : next) {
+        if (visit(to)) {
+          return true;
+        }
+      }
+    }
+    path.pop_back();
+    return false;
+  };
+  for (txn_id_t node : nodes) {
+    if (visit(node)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+bool LockManager::FindCycleThrough(const WaitsForGraph &graph, txn_id_t start, std::vector<txn_id_t> *cycle) {
+  std::unordered_set<txn_id_t> visited;
+  cycle->clear();
+  std::function<bool(txn_id_t)> visit = [&](txn_id_t node) {
+    cycle->push_back(node);
+    if (auto edges = graph.find(node); edges != graph.end()) {
+      for (txn_id_t to : edges->second) {
+        if (to == start || (visited.insert(to).second && visit(to))) {
+          return true;
+        }
+      }
+    }
+    cycle->pop_back();
+    return false;
+  };
+  visited.insert(start);
+  return visit(start);
+}
+
+void LockManager::UpdateWaitsFor(const LockRequestQueue &queue) {
+  for (auto waiter = queue.request_queue_.begin(); waiter != queue.request_queue_.end(); ++waiter) {
+    if (waiter->granted_ || waiters_.count(waiter->txn_id_) == 0) {
+      // a request that has not started to wait yet sets its edges as it does
+      continue;
+    }
+    std::vector<txn_id_t> edges;
+    bool ahead = true;
+    for (auto other = queue.request_queue_.begin(); other != queue.request_queue_.end(); ++other) {
+      if (other == waiter) {
+        ahead = false;
+      } else if (WaitsFor(*waiter, *other, ahead)) {
+        edges.push_back(other->txn_id_);
+      }
+    }
+    std::vector<txn_id_t> &old_edges = waits_for_[waiter->txn_id_];
+    for (txn_id_t to : edges) {
+      if (std::find(old_edges.begin(), old_edges.end(), to) == old_edges.end()) {
+        newly_blocked_.insert(waiter->txn_id_);
+        break;
+      }
+    }
+    if (edges.empty()) {
+      waits_for_.erase(waiter->txn_id_);
+    } else {
+      old_edges = std::move(edges);
+    }
+  }
+}
+
+void LockManager::BreakDeadlocks() {
+  std::vector<std::pair<txn_id_t, RID>> victims;
+  {
+    auto graph_lock = graph_latch_site_->Acquire(&latch_);
+    std::vector<txn_id_t> starts(newly_blocked_.begin(), newly_blocked_.end());
+    newly_blocked_.clear();
+    std::sort(starts.begin(), starts.end());
+    std::vector<txn_id_t> cycle;
+    for (txn_id_t start : starts) {
+      if (waiters_.count(start) == 0 || !FindCycleThrough(waits_for_, start, &cycle)) {
+        continue;
+      }
+      // the waiters of a cycle hold their locks till one of them is aborted; a cycle of edges of the graph API alone
+      // has none
+      const Waiter *victim = nullptr;
+      for (txn_id_t txn_id : cycle) {
+        auto waiter = waiters_.find(txn_id);
+        if (waiter != waiters_.end() &&
+            (victim == nullptr || waiter->second.locks_held_ < victim->locks_held_ ||
+             (waiter->second.locks_held_ == victim->locks_held_ && txn_id > victim->txn_->GetTransactionId()))) {
+          victim = &waiter->second;
+        }
+      }
+      if (victim == nullptr) {
+        continue;
+      }
+      // the other cycles through the victim are broken with it
+      txn_id_t victim_id = victim->txn_->GetTransactionId();
+      victims.emplace_back(victim_id, victim->rid_);
+      waits_for_.erase(victim_id);
+    }
+  }
+
+  for (const auto &[victim, rid] : victims) {
+    // the victim is aborted only if it still waits, as it may have been granted, and be gone, since the graph was
+    // looked at
+    LockTableShard &shard = ShardOf(rid);
+    auto lock = shard_latch_site_->Acquire(&shard.latch_);
+    auto queue = shard.lock_table_.find(rid);
+    if (queue == shard.lock_table_.end()) {
+      continue;
+    }
+    for (LockRequest &request : queue->second.request_queue_) {
+      if (request.txn_id_ == victim && !request.granted_) {
+        request.txn_->SetState(TransactionState::ABORTED);
+        queue->second.cv_.notify_all();
+        break;
+      }
+    }
+  }
+}
 
 void LockManager::RunCycleDetection() {
   while (enable_cycle_detection_) {
     std::this_thread::sleep_for(cycle_detection_interval);
-    {
-      std::unique_lock<std::mutex> l(latch_);
-      // TODO(student): remove the continue and add your cycle detection and abort code here
-      continue;
-    }
+    BreakDeadlocks();
   }
 }
 
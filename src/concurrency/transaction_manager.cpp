@@ -12,54 +12,240 @@
 
 #include "concurrency/transaction_manager.h"
 
+#include <algorithm>
+#include <tuple>
 #include <unordered_map>
 #include <unordered_set>
+#include <utility>
+#include <vector>
 
 #include "catalog/catalog.h"
+#include "common/tracer.h"
 #include "storage/table/table_heap.h"
 
 namespace bustub {
 
-std::unordered_map<txn_id_t, Transaction *> TransactionManager::txn_map = {};
+TransactionRegistry TransactionManager::txn_registry;
 
 Transaction *TransactionManager::Begin(Transaction *txn, IsolationLevel isolation_level) {
   // Acquire the global transaction latch in shared mode.
   global_txn_latch_.RLock();
 
   if (txn == nullptr) {
-    txn = new Transaction(next_txn_id_++, isolation_level);
+    txn = Allocate(isolation_level);
   }
 
-  txn_map[txn->GetTransactionId()] = txn;
+  {
+    std::scoped_lock lock(ts_latch_);
+    txn->SetReadTs(last_commit_ts_);
+    if (free_read_ts_.empty()) {
+      active_read_ts_.insert(last_commit_ts_);
+    } else {
+      free_read_ts_.value() = last_commit_ts_;
+      active_read_ts_.insert(std::move(free_read_ts_));
+    }
+  }
+
+  txn_registry.Register(txn);
   return txn;
 }
 
 void TransactionManager::Commit(Transaction *txn) {
+  auto start = std::chrono::steady_clock::now();
+  if (txn->GetIsolationLevel() == IsolationLevel::OPTIMISTIC && !txn->IsValidated() && !CommitOptimistic(txn)) {
+    Abort(txn);
+    throw TransactionAbortException(txn->GetTransactionId(), AbortReason::VALIDATION_FAILED);
+  }
   txn->SetState(TransactionState::COMMITTED);
 
-  // Perform all deletes before we commit.
+  // Stamp the versions of the writes with the commit timestamp before it is published, so that a transaction that
+  // begins after the commit sees them all, and any that began before sees none.
   auto write_set = txn->GetWriteSet();
+  std::unordered_set<TableHeap *> written;
+  if (txn->GetReadTs() != INVALID_TS) {
+    std::scoped_lock lock(ts_latch_);
+    if (!write_set->empty()) {
+      timestamp_t commit_ts = last_commit_ts_ + 1;
+      for (const auto &item : *write_set) {
+        item.table_->GetVersionStore()->Commit(item.rid_, txn->GetTransactionId(), commit_ts);
+        written.insert(item.table_);
+      }
+      last_commit_ts_ = commit_ts;
+      txn->SetCommitTs(commit_ts);
+    }
+    DropReadTs(txn->GetReadTs());
+  }
+
+  // The observers of the tables, such as materialized views, read the tuples deleted before the deletes take them out.
+  NotifyWriteObservers(txn, true);
+  BumpModificationCounts(txn);
+
+  // Perform all deletes before we commit.
   while (!write_set->empty()) {
     auto &item = write_set->back();
     auto table = item.table_;
     if (item.wtype_ == WType::DELETE) {
       // Note that this also releases the lock when holding the page latch.
       table->ApplyDelete(item.rid_, txn);
+    } else if (item.wtype_ == WType::UPDATE) {
+      table->ApplyUpdate(item.tuple_);
     }
     write_set->pop_back();
   }
   write_set->clear();
+  CollectVersions(written);
+
+  // The locks are released once the commit record is in the log buffer rather than on disk, so that the next
+  // transaction to write a hot record does not wait for the flush. A transaction that took one of the locks since can
+  // only commit after this one's record, so it waits for a later LSN to be persistent anyway; one that logged
+  // nothing waits for the last commit record appended before it finished.
+  lsn_t durable_lsn = last_commit_lsn_;
+  if (enable_logging && log_manager_ != nullptr && txn->GetPrevLSN() != INVALID_LSN) {
+    LogRecord commit_record(txn->GetTransactionId(), txn->GetPrevLSN(), LogRecordType::COMMIT);
+    durable_lsn = log_manager_->AppendLogRecord(&commit_record);
+    txn->SetPrevLSN(durable_lsn);
+    lsn_t last = last_commit_lsn_;
+    while (last < durable_lsn && !last_commit_lsn_.compare_exchange_weak(last, durable_lsn)) {
+    }
+  }
 
   // Release all the locks.
   ReleaseLocks(txn);
+  txn_registry.Unregister(txn->GetTransactionId());
   // Release the global transaction latch.
   global_txn_latch_.RUnlock();
+
+  // The commit is acknowledged, by returning, only once it and the commits it depends on are durable, but for an
+  // asynchronous one, which the flush thread makes durable within async_commit_delay.
+  if (enable_logging && log_manager_ != nullptr) {
+    if (txn->IsAsyncCommit()) {
+      log_manager_->FlushWithin(durable_lsn, async_commit_delay);
+    } else {
+      log_manager_->WaitForPersistent(durable_lsn);
+    }
+  }
+  auto end = std::chrono::steady_clock::now();
+  commit_latency_.Record(end - start);
+  Tracer::AddSpan("commit", "transaction", start, end, "txn_id", txn->GetTransactionId());
+}
+
+void TransactionManager::NotifyWriteObservers(Transaction *txn, bool commit) {
+  std::unordered_map<TableHeap *, std::vector<const TableWriteRecord *>> observed;
+  for (const auto &item : *txn->GetWriteSet()) {
+    if (!item.table_->GetWriteObservers().empty()) {
+      observed[item.table_].push_back(&item);
+    }
+  }
+  for (const auto &[table, records] : observed) {
+    for (TableWriteObserver *observer : table->GetWriteObservers()) {
+      if (commit) {
+        observer->OnCommit(records);
+      } else {
+        observer->OnAbort(txn, records);
+      }
+    }
+  }
+}
+
+void TransactionManager::BumpModificationCounts(Transaction *txn) {
+  // before the writes are applied or undone, and their locks released, so that a result read meanwhile is stale
+  TableHeap *last = nullptr;
+  for (const auto &item : *txn->GetWriteSet()) {
+    if (item.table_ != last) {
+      item.table_->BumpModificationCount();
+      last = item.table_;
+    }
+  }
+}
+
+bool TransactionManager::CommitOptimistic(Transaction *txn) {
+  // The updates and deletes come out of the write set, which their undo records go onto as they are installed; the
+  // inserts are in the tables already, and get locked and stamped with the rest.
+  auto write_set = txn->GetWriteSet();
+  std::vector<TableWriteRecord> buffered;
+  std::vector<std::pair<TableHeap *, RID>> locked;
+  for (auto item = write_set->begin(); item != write_set->end();) {
+    locked.emplace_back(item->table_, item->rid_);
+    if (item->wtype_ == WType::INSERT) {
+      ++item;
+      continue;
+    }
+    buffered.push_back(std::move(*item));
+    item = write_set->erase(item);
+  }
+  auto order = [](const std::pair<TableHeap *, RID> &a, const std::pair<TableHeap *, RID> &b) {
+    return std::make_tuple(a.first, a.second.GetPageId(), a.second.GetSlotNum()) <
+           std::make_tuple(b.first, b.second.GetPageId(), b.second.GetSlotNum());
+  };
+  std::sort(locked.begin(), locked.end(), order);
+  locked.erase(std::unique(locked.begin(), locked.end()), locked.end());
+  auto unlock = [&locked](size_t count, uint64_t tid) {
+    for (size_t i = 0; i < count; i++) {
+      locked[i].first->GetTidTable()->Unlock(locked[i].second, tid);
+    }
+  };
+
+  // Lock the tuples to write; one that another transaction is committing aborts this one rather than waiting for it,
+  // as the inserts were locked out of order.
+  size_t held = 0;
+  while (held < locked.size() && locked[held].first->GetTidTable()->TryLock(locked[held].second)) {
+    held++;
+  }
+  if (held < locked.size()) {
+    unlock(held, 0);
+    return false;
+  }
+
+  // Validate the reads: each tuple still has the TID it was read with, and is not being installed by another commit.
+  uint64_t tid = CurrentEpoch() << 32;
+  for (const auto &read : *txn->GetReadSet()) {
+    uint64_t current = read.table_->GetTidTable()->Get(read.rid_);
+    bool mine = std::binary_search(locked.begin(), locked.end(), std::make_pair(read.table_, read.rid_), order);
+    if ((read.tid_ & TidTable::LOCK_BIT) != 0 || (current & ~TidTable::LOCK_BIT) != read.tid_ ||
+        ((current & TidTable::LOCK_BIT) != 0 && !mine)) {
+      unlock(held, 0);
+      return false;
+    }
+    tid = std::max(tid, read.tid_ + 1);
+  }
+  for (const auto &[table, rid] : locked) {
+    tid = std::max(tid, (table->GetTidTable()->Get(rid) & ~TidTable::LOCK_BIT) + 1);
+  }
+
+  // Install the writes, which go to the tables once the transaction is validated.
+  txn->SetValidated();
+  bool installed = true;
+  for (const auto &item : buffered) {
+    installed = item.wtype_ == WType::DELETE ? item.table_->MarkDelete(item.rid_, txn)
+                                             : item.table_->UpdateTuple(item.tuple_, item.rid_, txn);
+    if (!installed) {
+      break;
+    }
+  }
+  unlock(held, installed ? tid : 0);
+  return installed;
+}
+
+uint64_t TransactionManager::CurrentEpoch() {
+  auto now = std::chrono::steady_clock::now().time_since_epoch();
+  return std::chrono::duration_cast<std::chrono::milliseconds>(now) / EPOCH_LENGTH;
 }
 
 void TransactionManager::Abort(Transaction *txn) {
+  // the updates and deletes of an optimistic transaction that was not validated never got to the tables
+  if (txn->GetIsolationLevel() == IsolationLevel::OPTIMISTIC && !txn->IsValidated()) {
+    auto write_set = txn->GetWriteSet();
+    write_set->erase(std::remove_if(write_set->begin(), write_set->end(),
+                                    [](const TableWriteRecord &item) { return item.wtype_ != WType::INSERT; }),
+                     write_set->end());
+  }
   txn->SetState(TransactionState::ABORTED);
+  // the observers, such as the indexes built while the transaction ran, see its writes before they are rolled back
+  NotifyWriteObservers(txn, false);
+  BumpModificationCounts(txn);
   // Rollback before releasing the lock.
   auto table_write_set = txn->GetWriteSet();
+  std::unordered_set<TableHeap *> written;
   while (!table_write_set->empty()) {
     auto &item = table_write_set->back();
     auto table = item.table_;
@@ -71,8 +257,18 @@ void TransactionManager::Abort(Transaction *txn) {
     } else if (item.wtype_ == WType::UPDATE) {
       table->UpdateTuple(item.tuple_, item.rid_, txn);
     }
+    // the page holds the version before the write again, so its undo record is of no more use
+    if (txn->GetReadTs() != INVALID_TS) {
+      table->GetVersionStore()->Abort(item.rid_, txn->GetTransactionId());
+      written.insert(table);
+    }
     table_write_set->pop_back();
   }
+  if (txn->GetReadTs() != INVALID_TS) {
+    std::scoped_lock lock(ts_latch_);
+    DropReadTs(txn->GetReadTs());
+  }
+  CollectVersions(written);
   table_write_set->clear();
   // Rollback index updates
   auto index_write_set = txn->GetIndexWriteSet();
@@ -84,28 +280,109 @@ void TransactionManager::Abort(Transaction *txn) {
     IndexInfo *index_info = catalog->GetIndex(item.index_oid_);
     auto new_key = item.tuple_.KeyFromTuple(table_info->schema_, *(index_info->index_->GetKeySchema()),
                                             index_info->index_->GetKeyAttrs());
+    // the rollback is logged as the changes were, ahead of the abort record
     if (item.wtype_ == WType::DELETE) {
-      index_info->index_->InsertEntry(new_key, item.rid_, txn);
+      catalog->InsertIndexEntry(index_info, new_key, item.rid_, txn);
     } else if (item.wtype_ == WType::INSERT) {
-      index_info->index_->DeleteEntry(new_key, item.rid_, txn);
+      catalog->DeleteIndexEntry(index_info, new_key, item.rid_, txn);
     } else if (item.wtype_ == WType::UPDATE) {
       // Delete the new key and insert the old key
-      index_info->index_->DeleteEntry(new_key, item.rid_, txn);
+      catalog->DeleteIndexEntry(index_info, new_key, item.rid_, txn);
       auto old_key = item.old_tuple_.KeyFromTuple(table_info->schema_, *(index_info->index_->GetKeySchema()),
                                                   index_info->index_->GetKeyAttrs());
-      index_info->index_->InsertEntry(old_key, item.rid_, txn);
+      catalog->InsertIndexEntry(index_info, old_key, item.rid_, txn);
     }
     index_write_set->pop_back();
   }
   table_write_set->clear();
   index_write_set->clear();
 
+  // the records of the rollback undid the transaction's, so that recovery is not to undo it again
+  if (enable_logging && log_manager_ != nullptr && txn->GetPrevLSN() != INVALID_LSN) {
+    LogRecord abort_record(txn->GetTransactionId(), txn->GetPrevLSN(), LogRecordType::ABORT);
+    txn->SetPrevLSN(log_manager_->AppendLogRecord(&abort_record));
+  }
+
   // Release all the locks.
   ReleaseLocks(txn);
+  txn_registry.Unregister(txn->GetTransactionId());
   // Release the global transaction latch.
   global_txn_latch_.RUnlock();
 }
 
+TransactionManager::~TransactionManager() {
+  for (Transaction *txn : free_txns_) {
+    delete txn;
+  }
+}
+
+Transaction *TransactionManager::Allocate(IsolationLevel isolation_level) {
+  {
+    std::scoped_lock lock(pool_latch_);
+    if (!free_txns_.empty()) {
+      Transaction *txn = free_txns_.back();
+      free_txns_.pop_back();
+      txn->Reset(next_txn_id_++, isolation_level);
+      return txn;
+    }
+  }
+  return new Transaction(next_txn_id_++, isolation_level);
+}
+
+void TransactionManager::Release(Transaction *txn) {
+  {
+    std::scoped_lock lock(pool_latch_);
+    if (free_txns_.size() < MAX_POOLED_TRANSACTIONS) {
+      free_txns_.push_back(txn);
+      return;
+    }
+  }
+  delete txn;
+}
+
+void TransactionManager::DropReadTs(timestamp_t read_ts) {
+  auto active = active_read_ts_.find(read_ts);
+  if (free_read_ts_.empty()) {
+    free_read_ts_ = active_read_ts_.extract(active);
+  } else {
+    active_read_ts_.erase(active);
+  }
+}
+
+timestamp_t TransactionManager::GetWatermark() {
+  std::scoped_lock lock(ts_latch_);
+  return Watermark();
+}
+
+void TransactionManager::CollectVersions(const std::unordered_set<TableHeap *> &tables) {
+  if (tables.empty()) {
+    return;
+  }
+  timestamp_t watermark = GetWatermark();
+  for (TableHeap *table : tables) {
+    table->GetVersionStore()->Collect(watermark);
+  }
+}
+
+std::vector<std::pair<txn_id_t, lsn_t>> TransactionManager::GetActiveTransactionTable() {
+  std::vector<std::pair<txn_id_t, lsn_t>> active_txns;
+  txn_registry.ForEach([&active_txns](Transaction *txn) {
+    active_txns.emplace_back(txn->GetTransactionId(), txn->GetPrevLSN());
+  });
+  return active_txns;
+}
+
+lsn_t TransactionManager::GetOldestActiveLSN() {
+  lsn_t oldest = INVALID_LSN;
+  txn_registry.ForEach([&oldest](Transaction *txn) {
+    lsn_t first_lsn = txn->GetFirstLSN();
+    if (first_lsn != INVALID_LSN && (oldest == INVALID_LSN || first_lsn < oldest)) {
+      oldest = first_lsn;
+    }
+  });
+  return oldest;
+}
+
 void TransactionManager::BlockAllTransactions() { global_txn_latch_.WLock(); }
 
 void TransactionManager::ResumeTransactions() { global_txn_latch_.WUnlock(); }
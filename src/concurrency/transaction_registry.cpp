@@ -0,0 +1,72 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// transaction_registry.cpp
+//
+// Identification: src/concurrency/transaction_registry.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "concurrency/transaction_registry.h"
+
+#include <utility>
+
+#include "concurrency/transaction.h"
+
+namespace bustub {
+
+void TransactionRegistry::Register(Transaction *txn) {
+  Shard &shard = ShardOf(txn->GetTransactionId());
+  std::scoped_lock lock(shard.latch_);
+  if (shard.free_node_.empty()) {
+    shard.txns_[txn->GetTransactionId()] = txn;
+    return;
+  }
+  shard.free_node_.key() = txn->GetTransactionId();
+  shard.free_node_.mapped() = txn;
+  auto inserted = shard.txns_.insert(std::move(shard.free_node_));
+  if (!inserted.inserted) {
+    inserted.position->second = txn;
+  }
+  shard.free_node_ = std::move(inserted.node);
+}
+
+void TransactionRegistry::Unregister(txn_id_t txn_id) {
+  Shard &shard = ShardOf(txn_id);
+  std::scoped_lock lock(shard.latch_);
+  if (shard.free_node_.empty()) {
+    shard.free_node_ = shard.txns_.extract(txn_id);
+  } else {
+    shard.txns_.erase(txn_id);
+  }
+}
+
+Transaction *TransactionRegistry::Find(txn_id_t txn_id) const {
+  const Shard &shard = ShardOf(txn_id);
+  std::scoped_lock lock(shard.latch_);
+  auto txn = shard.txns_.find(txn_id);
+  return txn == shard.txns_.end() ? nullptr : txn->second;
+}
+
+size_t TransactionRegistry::Size() const {
+  size_t size = 0;
+  for (const Shard &shard : shards_) {
+    std::scoped_lock lock(shard.latch_);
+    size += shard.txns_.size();
+  }
+  return size;
+}
+
+void TransactionRegistry::ForEach(const std::function<void(Transaction *)> &visit) const {
+  for (const Shard &shard : shards_) {
+    std::scoped_lock lock(shard.latch_);
+    for (const auto &[txn_id, txn] : shard.txns_) {
+      visit(txn);
+    }
+  }
+}
+
+}  // namespace bustub
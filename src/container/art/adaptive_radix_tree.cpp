@@ -0,0 +1,981 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// adaptive_radix_tree.cpp
+//
+// Identification: src/container/art/adaptive_radix_tree.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <cstring>
+#include <string>
+#include <thread>  // NOLINT
+#include <utility>
+#include <vector>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#include "common/rid.h"
+#include "container/art/adaptive_radix_tree.h"
+
+namespace bustub {
+
+#define ART_TYPE AdaptiveRadixTree<ValueType>
+
+/*****************************************************************************
+ * NODE VERSIONS
+ *****************************************************************************/
+template <typename ValueType>
+uint64_t ART_TYPE::Node::ReadLockOrRestart(bool *restart) const {
+  uint64_t version = version_.load();
+  while ((version & LOCKED_BIT) != 0) {
+    std::this_thread::yield();
+    version = version_.load();
+  }
+  if ((version & OBSOLETE_BIT) != 0) {
+    *restart = true;
+  }
+  return version;
+}
+
+template <typename ValueType>
+void ART_TYPE::Node::UpgradeToWriteLockOrRestart(uint64_t *version, bool *restart) {
+  if (version_.compare_exchange_strong(*version, *version + LOCKED_BIT)) {
+    *version += LOCKED_BIT;
+  } else {
+    *restart = true;
+  }
+}
+
+template <typename ValueType>
+void ART_TYPE::Node::WriteLockOrRestart(bool *restart) {
+  while (true) {
+    uint64_t version = ReadLockOrRestart(restart);
+    if (*restart) {
+      return;
+    }
+    bool changed = false;
+    UpgradeToWriteLockOrRestart(&version, &changed);
+    if (!changed) {
+      return;
+    }
+  }
+}
+
+template <typename ValueType>
+void ART_TYPE::Node::SetPrefix(const uint8_t *prefix, uint32_t length) {
+  std::memcpy(prefix_, prefix, std::min(length, MAX_STORED_PREFIX));
+  prefix_length_ = length;
+}
+
+template <typename ValueType>
+void ART_TYPE::Node::PrependPrefix(const Node *parent, uint8_t key_byte) {
+  uint8_t prefix[MAX_STORED_PREFIX];
+  uint32_t length = std::min(parent->prefix_length_, MAX_STORED_PREFIX);
+  std::memcpy(prefix, parent->prefix_, length);
+  if (length < MAX_STORED_PREFIX) {
+    prefix[length++] = key_byte;
+  }
+  uint32_t own_length = std::min(prefix_length_, MAX_STORED_PREFIX - length);
+  std::memcpy(prefix + length, prefix_, own_length);
+  SetPrefix(prefix, parent->prefix_length_ + 1 + prefix_length_);
+}
+
+/*****************************************************************************
+ * NODES
+ *****************************************************************************/
+template <typename ValueType>
+typename ART_TYPE::Node *ART_TYPE::GetChild(const Node *node, uint8_t key_byte) {
+  switch (node->type_) {
+    case NodeType::N4: {
+      auto n4 = static_cast<const Node4 *>(node);
+      for (uint16_t i = 0; i < n4->count_; ++i) {
+        if (n4->keys_[i] == key_byte) {
+          return n4->children_[i];
+        }
+      }
+      return nullptr;
+    }
+    case NodeType::N16: {
+      auto n16 = static_cast<const Node16 *>(node);
+#ifdef __SSE2__
+      __m128i cmp = _mm_cmpeq_epi8(_mm_set1_epi8(static_cast<char>(key_byte)),
+                                   _mm_loadu_si128(reinterpret_cast<const __m128i *>(n16->keys_)));
+      uint32_t mask = static_cast<uint32_t>(_mm_movemask_epi8(cmp)) & ((1U << n16->count_) - 1);
+      return mask == 0 ? nullptr : n16->children_[__builtin_ctz(mask)];
+#else
+      for (uint16_t i = 0; i < n16->count_; ++i) {
+        if (n16->keys_[i] == key_byte) {
+          return n16->children_[i];
+        }
+      }
+      return nullptr;
+#endif
+    }
+    case NodeType::N48: {
+      auto n48 = static_cast<const Node48 *>(node);
+      uint8_t index = n48->child_index_[key_byte];
+      return index == Node48::EMPTY ? nullptr : n48->children_[index];
+    }
+    case NodeType::N256:
+      return static_cast<const Node256 *>(node)->children_[key_byte];
+  }
+  return nullptr;
+}
+
+template <typename ValueType>
+void ART_TYPE::GetChildren(const Node *node, std::vector<std::pair<uint8_t, Node *>> *children) {
+  switch (node->type_) {
+    case NodeType::N4: {
+      auto n4 = static_cast<const Node4 *>(node);
+      for (uint16_t i = 0; i < n4->count_; ++i) {
+        children->emplace_back(n4->keys_[i], n4->children_[i]);
+      }
+      break;
+    }
+    case NodeType::N16: {
+      auto n16 = static_cast<const Node16 *>(node);
+      for (uint16_t i = 0; i < n16->count_; ++i) {
+        children->emplace_back(n16->keys_[i], n16->children_[i]);
+      }
+      break;
+    }
+    case NodeType::N48: {
+      auto n48 = static_cast<const Node48 *>(node);
+      for (uint32_t key_byte = 0; key_byte < 256; ++key_byte) {
+        uint8_t index = n48->child_index_[key_byte];
+        if (index != Node48::EMPTY) {
+          children->emplace_back(key_byte, n48->children_[index]);
+        }
+      }
+      break;
+    }
+    case NodeType::N256: {
+      auto n256 = static_cast<const Node256 *>(node);
+      for (uint32_t key_byte = 0; key_byte < 256; ++key_byte) {
+        if (n256->children_[key_byte] != nullptr) {
+          children->emplace_back(key_byte, n256->children_[key_byte]);
+        }
+      }
+      break;
+    }
+  }
+}
+
+template <typename ValueType>
+typename ART_TYPE::Node *ART_TYPE::AnyChild(const Node *node) {
+  switch (node->type_) {
+    case NodeType::N4:
+      return node->count_ == 0 ? nullptr : static_cast<const Node4 *>(node)->children_[0];
+    case NodeType::N16:
+      return node->count_ == 0 ? nullptr : static_cast<const Node16 *>(node)->children_[0];
+    case NodeType::N48:
+      for (Node *child : static_cast<const Node48 *>(node)->children_) {
+        if (child != nullptr) {
+          return child;
+        }
+      }
+      return nullptr;
+    case NodeType::N256:
+      for (Node *child : static_cast<const Node256 *>(node)->children_) {
+        if (child != nullptr) {
+          return child;
+        }
+      }
+      return nullptr;
+  }
+  return nullptr;
+}
+
+template <typename ValueType>
+bool ART_TYPE::IsFull(const Node *node) {
+  switch (node->type_) {
+    case NodeType::N4:
+      return node->count_ == 4;
+    case NodeType::N16:
+      return node->count_ == 16;
+    case NodeType::N48:
+      return node->count_ == 48;
+    case NodeType::N256:
+      return false;
+  }
+  return false;
+}
+
+template <typename ValueType>
+bool ART_TYPE::IsUnderfull(const Node *node) {
+  // a Node4 never gets below two children, the last but one leaves it in its parent's place
+  switch (node->type_) {
+    case NodeType::N4:
+      return false;
+    case NodeType::N16:
+      return node->count_ == 3;
+    case NodeType::N48:
+      return node->count_ == 12;
+    case NodeType::N256:
+      return node->count_ == 37;
+  }
+  return false;
+}
+
+template <typename ValueType>
+void ART_TYPE::AddChild(Node *node, uint8_t key_byte, Node *child) {
+  switch (node->type_) {
+    case NodeType::N4:
+    case NodeType::N16: {
+      uint8_t *keys =
+          node->type_ == NodeType::N4 ? static_cast<Node4 *>(node)->keys_ : static_cast<Node16 *>(node)->keys_;
+      Node **children =
+          node->type_ == NodeType::N4 ? static_cast<Node4 *>(node)->children_ : static_cast<Node16 *>(node)->children_;
+      uint16_t pos = 0;
+      while (pos < node->count_ && keys[pos] < key_byte) {
+        ++pos;
+      }
+      std::memmove(keys + pos + 1, keys + pos, node->count_ - pos);
+      std::memmove(children + pos + 1, children + pos, (node->count_ - pos) * sizeof(Node *));
+      keys[pos] = key_byte;
+      children[pos] = child;
+      break;
+    }
+    case NodeType::N48: {
+      auto n48 = static_cast<Node48 *>(node);
+      // removes leave holes behind, so the slot after the last one may be taken
+      uint8_t pos = n48->count_;
+      if (n48->children_[pos] != nullptr) {
+        pos = 0;
+        while (n48->children_[pos] != nullptr) {
+          ++pos;
+        }
+      }
+      n48->children_[pos] = child;
+      n48->child_index_[key_byte] = pos;
+      break;
+    }
+    case NodeType::N256:
+      static_cast<Node256 *>(node)->children_[key_byte] = child;
+      break;
+  }
+  ++node->count_;
+}
+
+template <typename ValueType>
+void ART_TYPE::ChangeChild(Node *node, uint8_t key_byte, Node *child) {
+  switch (node->type_) {
+    case NodeType::N4: {
+      auto n4 = static_cast<Node4 *>(node);
+      for (uint16_t i = 0; i < n4->count_; ++i) {
+        if (n4->keys_[i] == key_byte) {
+          n4->children_[i] = child;
+          return;
+        }
+      }
+      break;
+    }
+    case NodeType::N16: {
+      auto n16 = static_cast<Node16 *>(node);
+      for (uint16_t i = 0; i < n16->count_; ++i) {
+        if (n16->keys_[i] == key_byte) {
+          n16->children_[i] = child;
+          return;
+        }
+      }
+      break;
+    }
+    case NodeType::N48: {
+      auto n48 = static_cast<Node48 *>(node);
+      n48->children_[n48->child_index_[key_byte]] = child;
+      break;
+    }
+    case NodeType::N256:
+      static_cast<Node256 *>(node)->children_[key_byte] = child;
+      break;
+  }
+}
+
+template <typename ValueType>
+void ART_TYPE::RemoveChild(Node *node, uint8_t key_byte) {
+  switch (node->type_) {
+    case NodeType::N4:
+    case NodeType::N16: {
+      uint8_t *keys =
+          node->type_ == NodeType::N4 ? static_cast<Node4 *>(node)->keys_ : static_cast<Node16 *>(node)->keys_;
+      Node **children =
+          node->type_ == NodeType::N4 ? static_cast<Node4 *>(node)->children_ : static_cast<Node16 *>(node)->children_;
+      uint16_t pos = 0;
+      while (keys[pos] != key_byte) {
+        ++pos;
+      }
+      std::memmove(keys + pos, keys + pos + 1, node->count_ - pos - 1);
+      std::memmove(children + pos, children + pos + 1, (node->count_ - pos - 1) * sizeof(Node *));
+      break;
+    }
+    case NodeType::N48: {
+      auto n48 = static_cast<Node48 *>(node);
+      n48->children_[n48->child_index_[key_byte]] = nullptr;
+      n48->child_index_[key_byte] = Node48::EMPTY;
+      break;
+    }
+    case NodeType::N256:
+      static_cast<Node256 *>(node)->children_[key_byte] = nullptr;
+      break;
+  }
+  --node->count_;
+}
+
+template <typename ValueType>
+typename ART_TYPE::Node *ART_TYPE::Resize(const Node *node, bool grow) {
+  Node *resized = nullptr;
+  switch (node->type_) {
+    case NodeType::N4:
+      resized = new Node16();
+      break;
+    case NodeType::N16:
+      resized = grow ? static_cast<Node *>(new Node48()) : static_cast<Node *>(new Node4());
+      break;
+    case NodeType::N48:
+      resized = grow ? static_cast<Node *>(new Node256()) : static_cast<Node *>(new Node16());
+      break;
+    case NodeType::N256:
+      resized = new Node48();
+      break;
+  }
+  resized->SetPrefix(node->prefix_, node->prefix_length_);
+  std::vector<std::pair<uint8_t, Node *>> children;
+  GetChildren(node, &children);
+  for (const auto &[key_byte, child] : children) {
+    AddChild(resized, key_byte, child);
+  }
+  return resized;
+}
+
+template <typename ValueType>
+std::pair<typename ART_TYPE::Node *, uint8_t> ART_TYPE::GetSecondChild(const Node *node, uint8_t key_byte) {
+  auto n4 = static_cast<const Node4 *>(node);
+  return n4->keys_[0] == key_byte ? std::make_pair(n4->children_[1], n4->keys_[1])
+                                  : std::make_pair(n4->children_[0], n4->keys_[0]);
+}
+
+template <typename ValueType>
+void ART_TYPE::FreeNode(Node *node) {
+  if (IsLeaf(node)) {
+    delete AsLeaf(node);
+    return;
+  }
+  switch (node->type_) {
+    case NodeType::N4:
+      delete static_cast<Node4 *>(node);
+      break;
+    case NodeType::N16:
+      delete static_cast<Node16 *>(node);
+      break;
+    case NodeType::N48:
+      delete static_cast<Node48 *>(node);
+      break;
+    case NodeType::N256:
+      delete static_cast<Node256 *>(node);
+      break;
+  }
+}
+
+template <typename ValueType>
+void ART_TYPE::FreeTree(Node *node) {
+  if (!IsLeaf(node)) {
+    std::vector<std::pair<uint8_t, Node *>> children;
+    GetChildren(node, &children);
+    for (const auto &child : children) {
+      FreeTree(child.second);
+    }
+  }
+  FreeNode(node);
+}
+
+/*****************************************************************************
+ * PREFIXES
+ *****************************************************************************/
+template <typename ValueType>
+typename ART_TYPE::Leaf *ART_TYPE::AnyLeaf(const Node *node, bool *restart) {
+  while (true) {
+    uint64_t version = node->ReadLockOrRestart(restart);
+    if (*restart) {
+      return nullptr;
+    }
+    Node *child = AnyChild(node);
+    node->CheckOrRestart(version, restart);
+    if (*restart) {
+      return nullptr;
+    }
+    if (child == nullptr) {
+      // only the root can be empty, and it has no prefix to look up
+      *restart = true;
+      return nullptr;
+    }
+    if (IsLeaf(child)) {
+      return AsLeaf(child);
+    }
+    node = child;
+  }
+}
+
+template <typename ValueType>
+bool ART_TYPE::CheckPrefix(const Node *node, const std::string &key, uint32_t *level) {
+  uint32_t stored = std::min(node->prefix_length_, MAX_STORED_PREFIX);
+  for (uint32_t i = 0; i < stored; ++i) {
+    if (*level + i >= key.size() || node->prefix_[i] != static_cast<uint8_t>(key[*level + i])) {
+      return false;
+    }
+  }
+  *level += node->prefix_length_;
+  return *level < key.size();
+}
+
+template <typename ValueType>
+bool ART_TYPE::CheckPrefixPessimistic(const Node *node, const std::string &key, uint32_t *level,
+                                      uint8_t *mismatch_byte, uint8_t *remaining_prefix, bool *restart) {
+  uint32_t start = *level;
+  const Leaf *leaf = nullptr;
+  for (uint32_t i = 0; i < node->prefix_length_; ++i) {
+    if (*level >= key.size()) {
+      // a prefix as long as the key can only have been read from a node that is changing
+      *restart = true;
+      return false;
+    }
+    if (i == MAX_STORED_PREFIX) {
+      leaf = AnyLeaf(node, restart);
+      if (*restart) {
+        return false;
+      }
+    }
+    uint8_t byte = i < MAX_STORED_PREFIX ? node->prefix_[i] : static_cast<uint8_t>(leaf->key_[*level]);
+    if (byte != static_cast<uint8_t>(key[*level])) {
+      *mismatch_byte = byte;
+      uint32_t remaining = node->prefix_length_ - i - 1;
+      if (node->prefix_length_ <= MAX_STORED_PREFIX) {
+        std::memcpy(remaining_prefix, node->prefix_ + i + 1, remaining);
+        return false;
+      }
+      if (leaf == nullptr) {
+        leaf = AnyLeaf(node, restart);
+        if (*restart) {
+          return false;
+        }
+      }
+      std::memcpy(remaining_prefix, leaf->key_.data() + start + i + 1, std::min(remaining, MAX_STORED_PREFIX));
+      return false;
+    }
+    ++*level;
+  }
+  return true;
+}
+
+/*****************************************************************************
+ * CONSTRUCTION
+ *****************************************************************************/
+template <typename ValueType>
+ART_TYPE::AdaptiveRadixTree(uint32_t key_size) : root_(new Node256()), key_size_(key_size) {}
+
+template <typename ValueType>
+ART_TYPE::~AdaptiveRadixTree() {
+  FreeTree(root_);
+  for (const auto &retired : retired_) {
+    FreeNode(retired.second);
+  }
+}
+
+/*****************************************************************************
+ * SEARCH
+ *****************************************************************************/
+template <typename ValueType>
+bool ART_TYPE::GetValue(const std::string &key, ValueType *value) {
+  if (key.size() != key_size_) {
+    return false;
+  }
+  uint64_t epoch = EnterEpoch();
+  while (true) {
+    bool restart = false;
+    bool found = TryGetValue(key, value, &restart);
+    if (!restart) {
+      ExitEpoch(epoch);
+      return found;
+    }
+  }
+}
+
+template <typename ValueType>
+bool ART_TYPE::TryGetValue(const std::string &key, ValueType *value, bool *restart) {
+  const Node *node = root_;
+  uint64_t version = node->ReadLockOrRestart(restart);
+  if (*restart) {
+    return false;
+  }
+  uint32_t level = 0;
+  while (true) {
+    if (!CheckPrefix(node, key, &level)) {
+      node->CheckOrRestart(version, restart);
+      return false;
+    }
+    Node *child = GetChild(node, key[level]);
+    // the child is only safe to look at if the node did not change while it was read
+    node->CheckOrRestart(version, restart);
+    if (*restart || child == nullptr) {
+      return false;
+    }
+    if (IsLeaf(child)) {
+      // leaves never change, they are replaced
+      const Leaf *leaf = AsLeaf(child);
+      if (leaf->key_ != key) {
+        return false;
+      }
+      *value = leaf->value_;
+      return true;
+    }
+    ++level;
+    version = child->ReadLockOrRestart(restart);
+    if (*restart) {
+      return false;
+    }
+    node = child;
+  }
+}
+
+template <typename ValueType>
+bool ART_TYPE::ScanPrefix(const std::string &prefix, std::vector<ValueType> *result) {
+  if (prefix.size() > key_size_) {
+    return false;
+  }
+  uint64_t epoch = EnterEpoch();
+  size_t old_size = result->size();
+  while (true) {
+    bool restart = false;
+    TryScanPrefix(prefix, result, &restart);
+    if (!restart) {
+      break;
+    }
+    result->resize(old_size);
+  }
+  ExitEpoch(epoch);
+  return result->size() > old_size;
+}
+
+template <typename ValueType>
+void ART_TYPE::TryScanPrefix(const std::string &prefix, std::vector<ValueType> *result, bool *restart) {
+  const Node *node = root_;
+  uint64_t version = node->ReadLockOrRestart(restart);
+  if (*restart) {
+    return;
+  }
+  uint32_t level = 0;
+  while (true) {
+    // the bytes of the node's prefix that are not stored are checked against the leaves
+    uint32_t stored = std::min(node->prefix_length_, MAX_STORED_PREFIX);
+    for (uint32_t i = 0; i < stored && level + i < prefix.size(); ++i) {
+      if (node->prefix_[i] != static_cast<uint8_t>(prefix[level + i])) {
+        node->CheckOrRestart(version, restart);
+        return;
+      }
+    }
+    level += node->prefix_length_;
+    if (level >= prefix.size()) {
+      Collect(node, version, prefix, result, restart);
+      return;
+    }
+    Node *child = GetChild(node, prefix[level]);
+    node->CheckOrRestart(version, restart);
+    if (*restart || child == nullptr) {
+      return;
+    }
+    if (IsLeaf(child)) {
+      const Leaf *leaf = AsLeaf(child);
+      if (leaf->key_.compare(0, prefix.size(), prefix) == 0) {
+        result->push_back(leaf->value_);
+      }
+      return;
+    }
+    ++level;
+    version = child->ReadLockOrRestart(restart);
+    if (*restart) {
+      return;
+    }
+    node = child;
+  }
+}
+
+template <typename ValueType>
+void ART_TYPE::Collect(const Node *node, uint64_t version, const std::string &prefix, std::vector<ValueType> *result,
+                       bool *restart) {
+  std::vector<std::pair<uint8_t, Node *>> children;
+  GetChildren(node, &children);
+  node->CheckOrRestart(version, restart);
+  if (*restart) {
+    return;
+  }
+  for (const auto &child : children) {
+    if (IsLeaf(child.second)) {
+      const Leaf *leaf = AsLeaf(child.second);
+      if (leaf->key_.compare(0, prefix.size(), prefix) == 0) {
+        result->push_back(leaf->value_);
+      }
+      continue;
+    }
+    uint64_t child_version = child.second->ReadLockOrRestart(restart);
+    if (*restart) {
+      return;
+    }
+    Collect(child.second, child_version, prefix, result, restart);
+    if (*restart) {
+      return;
+    }
+  }
+}
+
+/*****************************************************************************
+ * INSERTION
+ *****************************************************************************/
+template <typename ValueType>
+bool ART_TYPE::Insert(const std::string &key, const ValueType &value) {
+  if (key.size() != key_size_) {
+    return false;
+  }
+  Node *leaf = AsChild(new Leaf{key, value});
+  uint64_t epoch = EnterEpoch();
+  bool inserted;
+  while (true) {
+    bool restart = false;
+    inserted = TryInsert(key, leaf, &restart);
+    if (!restart) {
+      break;
+    }
+  }
+  ExitEpoch(epoch);
+  if (inserted) {
+    ++size_;
+  } else {
+    FreeNode(leaf);
+  }
+  return inserted;
+}
+
+template <typename ValueType>
+bool ART_TYPE::TryInsert(const std::string &key, Node *leaf, bool *restart) {
+  Node *parent = nullptr;
+  Node *node = nullptr;
+  Node *next = root_;
+  uint8_t parent_key = 0;
+  uint8_t node_key = 0;
+  uint64_t parent_version = 0;
+  uint32_t level = 0;
+  while (true) {
+    parent = node;
+    parent_key = node_key;
+    node = next;
+    uint64_t version = node->ReadLockOrRestart(restart);
+    if (*restart) {
+      return false;
+    }
+
+    uint32_t next_level = level;
+    uint8_t mismatch_byte = 0;
+    uint8_t remaining_prefix[MAX_STORED_PREFIX];
+    bool match = CheckPrefixPessimistic(node, key, &next_level, &mismatch_byte, remaining_prefix, restart);
+    if (*restart) {
+      return false;
+    }
+    if (!match) {
+      // the key leaves the node's prefix: a new node with the common part of it takes the node and the leaf, and the
+      // node keeps what is left after the byte they differ in (the root has no prefix, so there is a parent)
+      parent->UpgradeToWriteLockOrRestart(&parent_version, restart);
+      if (*restart) {
+        return false;
+      }
+      node->UpgradeToWriteLockOrRestart(&version, restart);
+      if (*restart) {
+        parent->WriteUnlock();
+        return false;
+      }
+      auto *split = new Node4();
+      split->SetPrefix(node->prefix_, next_level - level);
+      AddChild(split, key[next_level], leaf);
+      AddChild(split, mismatch_byte, node);
+      ChangeChild(parent, parent_key, split);
+      parent->WriteUnlock();
+      node->SetPrefix(remaining_prefix, node->prefix_length_ - (next_level - level) - 1);
+      node->WriteUnlock();
+      return true;
+    }
+
+    level = next_level;
+    if (level >= key.size()) {
+      *restart = true;
+      return false;
+    }
+    node_key = key[level];
+    next = GetChild(node, node_key);
+    node->CheckOrRestart(version, restart);
+    if (*restart) {
+      return false;
+    }
+    if (next == nullptr) {
+      InsertAndUnlock(node, version, parent, parent_version, parent_key, node_key, leaf, restart);
+      return true;
+    }
+    if (parent != nullptr) {
+      parent->CheckOrRestart(parent_version, restart);
+      if (*restart) {
+        return false;
+      }
+    }
+
+    if (IsLeaf(next)) {
+      node->UpgradeToWriteLockOrRestart(&version, restart);
+      if (*restart) {
+        return false;
+      }
+      const Leaf *existing = AsLeaf(next);
+      if (existing->key_ == key) {
+        node->WriteUnlock();
+        return false;
+      }
+      // the keys agree up to the byte they differ in, which becomes the prefix of a new node over both leaves
+      ++level;
+      uint32_t prefix_length = 0;
+      while (existing->key_[level + prefix_length] == key[level + prefix_length]) {
+        ++prefix_length;
+      }
+      auto *split = new Node4();
+      split->SetPrefix(reinterpret_cast<const uint8_t *>(key.data()) + level, prefix_length);
+      AddChild(split, key[level + prefix_length], leaf);
+      AddChild(split, existing->key_[level + prefix_length], next);
+      ChangeChild(node, node_key, split);
+      node->WriteUnlock();
+      return true;
+    }
+    ++level;
+    parent_version = version;
+  }
+}
+
+template <typename ValueType>
+void ART_TYPE::InsertAndUnlock(Node *node, uint64_t version, Node *parent, uint64_t parent_version,
+                               uint8_t parent_key, uint8_t key_byte, Node *leaf, bool *restart) {
+  if (!IsFull(node)) {
+    node->UpgradeToWriteLockOrRestart(&version, restart);
+    if (*restart) {
+      return;
+    }
+    if (parent != nullptr) {
+      parent->CheckOrRestart(parent_version, restart);
+      if (*restart) {
+        node->WriteUnlock();
+        return;
+      }
+    }
+    AddChild(node, key_byte, leaf);
+    node->WriteUnlock();
+    return;
+  }
+
+  // a full node is replaced by a larger copy, in its parent (the root never fills up, so there is one)
+  parent->UpgradeToWriteLockOrRestart(&parent_version, restart);
+  if (*restart) {
+    return;
+  }
+  node->UpgradeToWriteLockOrRestart(&version, restart);
+  if (*restart) {
+    parent->WriteUnlock();
+    return;
+  }
+  Node *grown = Resize(node, true);
+  AddChild(grown, key_byte, leaf);
+  ChangeChild(parent, parent_key, grown);
+  parent->WriteUnlock();
+  node->WriteUnlockObsolete();
+  Retire(node);
+}
+
+/*****************************************************************************
+ * REMOVE
+ *****************************************************************************/
+template <typename ValueType>
+bool ART_TYPE::Remove(const std::string &key) {
+  if (key.size() != key_size_) {
+    return false;
+  }
+  uint64_t epoch = EnterEpoch();
+  bool removed;
+  while (true) {
+    bool restart = false;
+    removed = TryRemove(key, &restart);
+    if (!restart) {
+      break;
+    }
+  }
+  ExitEpoch(epoch);
+  if (removed) {
+    --size_;
+  }
+  return removed;
+}
+
+template <typename ValueType>
+bool ART_TYPE::TryRemove(const std::string &key, bool *restart) {
+  Node *parent = nullptr;
+  Node *node = nullptr;
+  Node *next = root_;
+  uint8_t parent_key = 0;
+  uint8_t node_key = 0;
+  uint64_t parent_version = 0;
+  uint32_t level = 0;
+  while (true) {
+    parent = node;
+    parent_key = node_key;
+    node = next;
+    uint64_t version = node->ReadLockOrRestart(restart);
+    if (*restart) {
+      return false;
+    }
+    if (!CheckPrefix(node, key, &level)) {
+      node->CheckOrRestart(version, restart);
+      return false;
+    }
+    node_key = key[level];
+    next = GetChild(node, node_key);
+    uint16_t count = node->count_;
+    node->CheckOrRestart(version, restart);
+    if (*restart || next == nullptr) {
+      return false;
+    }
+    if (!IsLeaf(next)) {
+      ++level;
+      parent_version = version;
+      continue;
+    }
+    if (AsLeaf(next)->key_ != key) {
+      return false;
+    }
+
+    if (parent != nullptr && count == 2) {
+      // only a Node4 gets down to two children; the other child takes its place in the parent
+      parent->UpgradeToWriteLockOrRestart(&parent_version, restart);
+      if (*restart) {
+        return false;
+      }
+      node->UpgradeToWriteLockOrRestart(&version, restart);
+      if (*restart) {
+        parent->WriteUnlock();
+        return false;
+      }
+      auto [second, second_key] = GetSecondChild(node, node_key);
+      if (IsLeaf(second)) {
+        ChangeChild(parent, parent_key, second);
+        parent->WriteUnlock();
+      } else {
+        second->WriteLockOrRestart(restart);
+        if (*restart) {
+          node->WriteUnlock();
+          parent->WriteUnlock();
+          return false;
+        }
+        ChangeChild(parent, parent_key, second);
+        parent->WriteUnlock();
+        second->PrependPrefix(node, second_key);
+        second->WriteUnlock();
+      }
+      node->WriteUnlockObsolete();
+      Retire(node);
+    } else {
+      RemoveAndUnlock(node, version, parent, parent_version, parent_key, node_key, restart);
+      if (*restart) {
+        return false;
+      }
+    }
+    Retire(next);
+    return true;
+  }
+}
+
+template <typename ValueType>
+void ART_TYPE::RemoveAndUnlock(Node *node, uint64_t version, Node *parent, uint64_t parent_version,
+                               uint8_t parent_key, uint8_t key_byte, bool *restart) {
+  if (parent == nullptr || !IsUnderfull(node)) {
+    node->UpgradeToWriteLockOrRestart(&version, restart);
+    if (*restart) {
+      return;
+    }
+    if (parent != nullptr) {
+      parent->CheckOrRestart(parent_version, restart);
+      if (*restart) {
+        node->WriteUnlock();
+        return;
+      }
+    }
+    RemoveChild(node, key_byte);
+    node->WriteUnlock();
+    return;
+  }
+
+  // an underfull node is replaced by a smaller copy, in its parent
+  parent->UpgradeToWriteLockOrRestart(&parent_version, restart);
+  if (*restart) {
+    return;
+  }
+  node->UpgradeToWriteLockOrRestart(&version, restart);
+  if (*restart) {
+    parent->WriteUnlock();
+    return;
+  }
+  Node *shrunk = Resize(node, false);
+  RemoveChild(shrunk, key_byte);
+  ChangeChild(parent, parent_key, shrunk);
+  parent->WriteUnlock();
+  node->WriteUnlockObsolete();
+  Retire(node);
+}
+
+/*****************************************************************************
+ * EPOCHS
+ *****************************************************************************/
+template <typename ValueType>
+uint64_t ART_TYPE::EnterEpoch() {
+  while (true) {
+    uint64_t epoch = epoch_.load();
+    active_[epoch & 1].fetch_add(1);
+    // the epoch may have advanced before the operation was counted, then it counts in the new one
+    if (epoch_.load() == epoch) {
+      return epoch;
+    }
+    active_[epoch & 1].fetch_sub(1);
+  }
+}
+
+template <typename ValueType>
+void ART_TYPE::Retire(Node *node) {
+  std::vector<Node *> freed;
+  {
+    std::scoped_lock guard(retired_latch_);
+    uint64_t epoch = epoch_.load();
+    retired_.emplace_back(epoch, node);
+    // once the operations of the previous epoch are gone, no operation can hold a node retired before the current one
+    if (active_[(epoch + 1) & 1].load() == 0) {
+      epoch_.store(++epoch);
+    }
+    auto keep = std::partition(retired_.begin(), retired_.end(),
+                               [epoch](const auto &retired) { return retired.first + 2 > epoch; });
+    for (auto it = keep; it != retired_.end(); ++it) {
+      freed.push_back(it->second);
+    }
+    retired_.erase(keep, retired_.end());
+  }
+  for (Node *retired : freed) {
+    FreeNode(retired);
+  }
+}
+
+template class AdaptiveRadixTree<int>;
+template class AdaptiveRadixTree<RID>;
+
+}  // namespace bustub
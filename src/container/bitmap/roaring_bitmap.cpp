@@ -0,0 +1,252 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// roaring_bitmap.cpp
+//
+// Identification: src/container/bitmap/roaring_bitmap.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "container/bitmap/roaring_bitmap.h"
+
+#include <algorithm>
+#include <iterator>
+
+namespace bustub {
+
+size_t RoaringBitmap::LowerBound(uint64_t high) const {
+  auto iter = std::lower_bound(containers_.begin(), containers_.end(), high,
+                               [](const auto &container, uint64_t key) { return container.first < key; });
+  return iter - containers_.begin();
+}
+
+void RoaringBitmap::Normalize(Container *container) {
+  if (!container->IsBitmap() && container->cardinality_ > ARRAY_MAX_SIZE) {
+    container->bits_.assign(BITMAP_WORDS, 0);
+    for (uint16_t low : container->array_) {
+      container->bits_[low >> 6] |= uint64_t{1} << (low & 63);
+    }
+    container->array_.clear();
+    container->array_.shrink_to_fit();
+  } else if (container->IsBitmap() && container->cardinality_ <= ARRAY_MAX_SIZE) {
+    container->array_.clear();
+    container->array_.reserve(container->cardinality_);
+    for (uint32_t word = 0; word < BITMAP_WORDS; word++) {
+      for (uint64_t bits = container->bits_[word]; bits != 0; bits &= bits - 1) {
+        container->array_.push_back(static_cast<uint16_t>(word * 64 + __builtin_ctzll(bits)));
+      }
+    }
+    container->bits_.clear();
+    container->bits_.shrink_to_fit();
+  }
+}
+
+bool RoaringBitmap::Add(uint64_t value) {
+  uint64_t high = HighOf(value);
+  uint16_t low = LowOf(value);
+  size_t index = LowerBound(high);
+  if (index == containers_.size() || containers_[index].first != high) {
+    containers_.insert(containers_.begin() + index, {high, Container{}});
+  }
+  Container &container = containers_[index].second;
+  if (container.IsBitmap()) {
+    uint64_t &word = container.bits_[low >> 6];
+    uint64_t bit = uint64_t{1} << (low & 63);
+    if ((word & bit) != 0) {
+      return false;
+    }
+    word |= bit;
+  } else {
+    auto iter = std::lower_bound(container.array_.begin(), container.array_.end(), low);
+    if (iter != container.array_.end() && *iter == low) {
+      return false;
+    }
+    container.array_.insert(iter, low);
+  }
+  container.cardinality_++;
+  Normalize(&container);
+  return true;
+}
+
+bool RoaringBitmap::Remove(uint64_t value) {
+  uint64_t high = HighOf(value);
+  uint16_t low = LowOf(value);
+  size_t index = LowerBound(high);
+  if (index == containers_.size() || containers_[index].first != high) {
+    return false;
+  }
+  Container &container = containers_[index].second;
+  if (container.IsBitmap()) {
+    uint64_t &word = container.bits_[low >> 6];
+    uint64_t bit = uint64_t{1} << (low & 63);
+    if ((word & bit) == 0) {
+      return false;
+    }
+    word &= ~bit;
+  } else {
+    auto iter = std::lower_bound(container.array_.begin(), container.array_.end(), low);
+    if (iter == container.array_.end() || *iter != low) {
+      return false;
+    }
+    container.array_.erase(iter);
+  }
+  if (--container.cardinality_ == 0) {
+    containers_.erase(containers_.begin() + index);
+  } else {
+    Normalize(&container);
+  }
+  return true;
+}
+
+bool RoaringBitmap::Contains(uint64_t value) const {
+  uint64_t high = HighOf(value);
+  uint16_t low = LowOf(value);
+  size_t index = LowerBound(high);
+  if (index == containers_.size() || containers_[index].first != high) {
+    return false;
+  }
+  const Container &container = containers_[index].second;
+  if (container.IsBitmap()) {
+    return (container.bits_[low >> 6] & (uint64_t{1} << (low & 63))) != 0;
+  }
+  return std::binary_search(container.array_.begin(), container.array_.end(), low);
+}
+
+uint64_t RoaringBitmap::Cardinality() const {
+  uint64_t cardinality = 0;
+  for (const auto &[high, container] : containers_) {
+    cardinality += container.cardinality_;
+  }
+  return cardinality;
+}
+
+RoaringBitmap::Container RoaringBitmap::Intersect(const Container &lhs, const Container &rhs) {
+  Container result;
+  if (!lhs.IsBitmap() && !rhs.IsBitmap()) {
+    std::set_intersection(lhs.array_.begin(), lhs.array_.end(), rhs.array_.begin(), rhs.array_.end(),
+                          std::back_inserter(result.array_));
+    result.cardinality_ = result.array_.size();
+    return result;
+  }
+  if (!lhs.IsBitmap() || !rhs.IsBitmap()) {
+    // the values of the array that the bitmap has
+    const Container &array = lhs.IsBitmap() ? rhs : lhs;
+    const Container &bitmap = lhs.IsBitmap() ? lhs : rhs;
+    for (uint16_t low : array.array_) {
+      if ((bitmap.bits_[low >> 6] & (uint64_t{1} << (low & 63))) != 0) {
+        result.array_.push_back(low);
+      }
+    }
+    result.cardinality_ = result.array_.size();
+    return result;
+  }
+  result.bits_.resize(BITMAP_WORDS);
+  for (uint32_t word = 0; word < BITMAP_WORDS; word++) {
+    result.bits_[word] = lhs.bits_[word] & rhs.bits_[word];
+    result.cardinality_ += __builtin_popcountll(result.bits_[word]);
+  }
+  Normalize(&result);
+  return result;
+}
+
+RoaringBitmap::Container RoaringBitmap::Union(const Container &lhs, const Container &rhs) {
+  Container result;
+  if (!lhs.IsBitmap() && !rhs.IsBitmap()) {
+    std::set_union(lhs.array_.begin(), lhs.array_.end(), rhs.array_.begin(), rhs.array_.end(),
+                   std::back_inserter(result.array_));
+    result.cardinality_ = result.array_.size();
+    Normalize(&result);
+    return result;
+  }
+  result.bits_.assign(BITMAP_WORDS, 0);
+  for (const Container *container : {&lhs, &rhs}) {
+    if (container->IsBitmap()) {
+      for (uint32_t word = 0; word < BITMAP_WORDS; word++) {
+        result.bits_[word] |= container->bits_[word];
+      }
+    } else {
+      for (uint16_t low : container->array_) {
+        result.bits_[low >> 6] |= uint64_t{1} << (low & 63);
+      }
+    }
+  }
+  for (uint64_t word : result.bits_) {
+    result.cardinality_ += __builtin_popcountll(word);
+  }
+  return result;
+}
+
+void RoaringBitmap::IntersectWith(const RoaringBitmap &other) {
+  std::vector<std::pair<uint64_t, Container>> containers;
+  size_t i = 0;
+  size_t j = 0;
+  // only the chunks that both bitmaps have can have values in common
+  while (i < containers_.size() && j < other.containers_.size()) {
+    if (containers_[i].first < other.containers_[j].first) {
+      i++;
+    } else if (containers_[i].first > other.containers_[j].first) {
+      j++;
+    } else {
+      Container container = Intersect(containers_[i].second, other.containers_[j].second);
+      if (container.cardinality_ != 0) {
+        containers.emplace_back(containers_[i].first, std::move(container));
+      }
+      i++;
+      j++;
+    }
+  }
+  containers_ = std::move(containers);
+}
+
+void RoaringBitmap::UnionWith(const RoaringBitmap &other) {
+  std::vector<std::pair<uint64_t, Container>> containers;
+  containers.reserve(containers_.size() + other.containers_.size());
+  size_t i = 0;
+  size_t j = 0;
+  while (i < containers_.size() || j < other.containers_.size()) {
+    if (j == other.containers_.size() ||
+        (i < containers_.size() && containers_[i].first < other.containers_[j].first)) {
+      containers.push_back(std::move(containers_[i++]));
+    } else if (i == containers_.size() || containers_[i].first > other.containers_[j].first) {
+      containers.push_back(other.containers_[j++]);
+    } else {
+      containers.emplace_back(containers_[i].first, Union(containers_[i].second, other.containers_[j].second));
+      i++;
+      j++;
+    }
+  }
+  containers_ = std::move(containers);
+}
+
+std::vector<uint64_t> RoaringBitmap::ToVector() const {
+  std::vector<uint64_t> values;
+  values.reserve(Cardinality());
+  for (const auto &[high, container] : containers_) {
+    uint64_t base = high << 16;
+    if (!container.IsBitmap()) {
+      for (uint16_t low : container.array_) {
+        values.push_back(base | low);
+      }
+      continue;
+    }
+    for (uint32_t word = 0; word < BITMAP_WORDS; word++) {
+      for (uint64_t bits = container.bits_[word]; bits != 0; bits &= bits - 1) {
+        values.push_back(base | (word * 64 + __builtin_ctzll(bits)));
+      }
+    }
+  }
+  return values;
+}
+
+size_t RoaringBitmap::GetMemoryUsage() const {
+  size_t bytes = containers_.capacity() * sizeof(containers_[0]);
+  for (const auto &[high, container] : containers_) {
+    bytes += container.array_.capacity() * sizeof(uint16_t) + container.bits_.capacity() * sizeof(uint64_t);
+  }
+  return bytes;
+}
+
+}  // namespace bustub
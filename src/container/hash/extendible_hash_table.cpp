@@ -0,0 +1,344 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// extendible_hash_table.cpp
+//
+// Identification: src/container/hash/extendible_hash_table.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "common/exception.h"
+#include "common/logger.h"
+#include "common/rid.h"
+#include "container/hash/extendible_hash_table.h"
+
+namespace bustub {
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+EXTENDIBLE_HASH_TABLE_TYPE::ExtendibleHashTable(const std::string &name, BufferPoolManager *buffer_pool_manager,
+                                                const KeyComparator &comparator, HashFunction<KeyType> hash_fn)
+    : buffer_pool_manager_(buffer_pool_manager), comparator_(comparator), hash_fn_(std::move(hash_fn)) {
+  Page *page = buffer_pool_manager_->NewPage(&directory_page_id_);
+  BUSTUB_ASSERT(page != nullptr, "every frame is pinned");
+  // a new page is all zeroes, i.e. a directory of global depth 0
+  directory_frame_ = page;
+  directory_page_ = reinterpret_cast<HashTableDirectoryPage *>(page->GetData());
+  directory_page_->SetPageId(directory_page_id_);
+
+  page_id_t bucket_page_id;
+  Page *bucket_page = buffer_pool_manager_->NewPage(&bucket_page_id);
+  BUSTUB_ASSERT(bucket_page != nullptr, "every frame is pinned");
+  directory_page_->SetBucketPageId(0, bucket_page_id);
+  directory_page_->SetLocalDepth(0, 0);
+  buffer_pool_manager_->UnpinPage(bucket_page_id, true);
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+uint32_t EXTENDIBLE_HASH_TABLE_TYPE::Hash(const KeyType &key) {
+  return static_cast<uint32_t>(hash_fn_.GetHash(key));
+}
+
+/*****************************************************************************
+ * SEARCH
+ *****************************************************************************/
+template <typename KeyType, typename ValueType, typename KeyComparator>
+bool EXTENDIBLE_HASH_TABLE_TYPE::GetValue(Transaction *transaction, const KeyType &key,
+                                          std::vector<ValueType> *result) {
+  const size_t found_before = result->size();
+  for (int attempt = 0; attempt < MAX_OPTIMISTIC_READS; attempt++) {
+    if (TryOptimisticGetValue(key, result)) {
+      return result->size() > found_before;
+    }
+  }
+  // the directory or the bucket kept changing under the reads, so wait for the writers on the latches
+  table_latch_.RLock();
+  bool found = false;
+  ReadPageGuard guard = buffer_pool_manager_->FetchPageRead(directory_page_->GetBucketPageId(KeyToDirectoryIndex(key)));
+  if (guard.IsValid()) {
+    found = guard.As<HASH_TABLE_BUCKET_TYPE>()->GetValue(key, comparator_, result);
+  }
+  guard.Drop();
+  table_latch_.RUnlock();
+  return found;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+void EXTENDIBLE_HASH_TABLE_TYPE::GetValues(Transaction *transaction, const std::vector<KeyType> &keys,
+                                           std::vector<std::vector<ValueType>> *results) {
+  results->resize(keys.size());
+  std::vector<page_id_t> bucket_page_ids;
+  for (size_t begin = 0; begin < keys.size(); begin += PROBE_GROUP_SIZE) {
+    size_t end = std::min(keys.size(), begin + PROBE_GROUP_SIZE);
+    bucket_page_ids.clear();
+    table_latch_.RLock();
+    for (size_t i = begin; i < end; i++) {
+      bucket_page_ids.push_back(directory_page_->GetBucketPageId(KeyToDirectoryIndex(keys[i])));
+    }
+    table_latch_.RUnlock();
+    // only a hint: a bucket that splits meanwhile is read by its lookup as usual
+    buffer_pool_manager_->PrefetchPages(bucket_page_ids);
+    for (size_t i = begin; i < end; i++) {
+      GetValue(transaction, keys[i], &(*results)[i]);
+    }
+  }
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+bool EXTENDIBLE_HASH_TABLE_TYPE::TryOptimisticGetValue(const KeyType &key, std::vector<ValueType> *result) {
+  uint64_t directory_version;
+  if (!directory_frame_->ReadVersion(&directory_version)) {
+    return false;
+  }
+  page_id_t bucket_page_id = directory_page_->GetBucketPageId(KeyToDirectoryIndex(key));
+  if (!directory_frame_->ValidateVersion(directory_version)) {
+    return false;
+  }
+  Page *page = buffer_pool_manager_->FetchPage(bucket_page_id);
+  if (page == nullptr) {
+    return false;
+  }
+  // the bucket is pinned before the directory is validated again, so that it cannot have been merged away and
+  // deleted if the directory still points at it
+  uint64_t version;
+  std::vector<ValueType> values;
+  bool valid = page->ReadVersion(&version) && directory_frame_->ValidateVersion(directory_version);
+  if (valid) {
+    reinterpret_cast<HASH_TABLE_BUCKET_TYPE *>(page->GetData())->GetValue(key, comparator_, &values);
+    valid = page->ValidateVersion(version);
+  }
+  buffer_pool_manager_->UnpinPage(bucket_page_id, false);
+  if (valid) {
+    result->insert(result->end(), values.begin(), values.end());
+  }
+  return valid;
+}
+
+/*****************************************************************************
+ * INSERTION
+ *****************************************************************************/
+template <typename KeyType, typename ValueType, typename KeyComparator>
+bool EXTENDIBLE_HASH_TABLE_TYPE::Insert(Transaction *transaction, const KeyType &key, const ValueType &value) {
+  // the directory only changes under the exclusive latch, so a shared one and the bucket's write latch do for inserts
+  // that fit into their bucket
+  table_latch_.RLock();
+  WritePageGuard guard =
+      buffer_pool_manager_->FetchPageWrite(directory_page_->GetBucketPageId(KeyToDirectoryIndex(key)));
+  bool split = false;
+  bool res = false;
+  if (guard.IsValid()) {
+    auto bucket_page = guard.As<HASH_TABLE_BUCKET_TYPE>();
+    if (bucket_page->Contains(key, value, comparator_)) {
+      res = false;
+    } else if (bucket_page->IsFull()) {
+      split = true;
+    } else {
+      guard.AsMut<HASH_TABLE_BUCKET_TYPE>()->Insert(key, value);
+      res = true;
+    }
+  }
+  guard.Drop();
+  table_latch_.RUnlock();
+  if (!split) {
+    return res;
+  }
+
+  table_latch_.WLock();
+  directory_frame_->WLatch();
+  res = SplitInsert(key, value);
+  directory_frame_->WUnlatch();
+  table_latch_.WUnlock();
+  return res;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+bool EXTENDIBLE_HASH_TABLE_TYPE::SplitInsert(const KeyType &key, const ValueType &value) {
+  while (true) {
+    // the bucket may have been split or have lost pairs since the shared latch was let go
+    uint32_t bucket_idx = KeyToDirectoryIndex(key);
+    page_id_t bucket_page_id = directory_page_->GetBucketPageId(bucket_idx);
+    WritePageGuard guard = buffer_pool_manager_->FetchPageWrite(bucket_page_id);
+    if (!guard.IsValid()) {
+      return false;
+    }
+    auto bucket_page = guard.As<HASH_TABLE_BUCKET_TYPE>();
+    if (bucket_page->Contains(key, value, comparator_)) {
+      return false;
+    }
+    if (!bucket_page->IsFull()) {
+      guard.AsMut<HASH_TABLE_BUCKET_TYPE>()->Insert(key, value);
+      return true;
+    }
+
+    uint32_t local_depth = directory_page_->GetLocalDepth(bucket_idx);
+    if (local_depth == directory_page_->GetGlobalDepth()) {
+      if (local_depth == MAX_GLOBAL_DEPTH) {
+        LOG_WARN("bucket page %d cannot be split any further", bucket_page_id);
+        return false;
+      }
+      directory_page_->IncrGlobalDepth();
+    }
+
+    page_id_t image_page_id;
+    Page *page = buffer_pool_manager_->NewPage(&image_page_id);
+    if (page == nullptr) {
+      return false;
+    }
+    auto image_page = reinterpret_cast<HASH_TABLE_BUCKET_TYPE *>(page->GetData());
+
+    // the pairs whose hash has the next bit set move to the split image, and so do the entries for them
+    uint32_t high_bit = 1U << local_depth;
+    for (uint32_t i = 0; i < directory_page_->Size(); ++i) {
+      if (directory_page_->GetBucketPageId(i) == bucket_page_id) {
+        directory_page_->SetLocalDepth(i, local_depth + 1);
+        if ((i & high_bit) != 0) {
+          directory_page_->SetBucketPageId(i, image_page_id);
+        }
+      }
+    }
+    auto split_page = guard.AsMut<HASH_TABLE_BUCKET_TYPE>();
+    for (uint32_t i = split_page->NumPairs(); i-- > 0;) {
+      if ((Hash(split_page->KeyAt(i)) & high_bit) != 0) {
+        image_page->Insert(split_page->KeyAt(i), split_page->ValueAt(i));
+        split_page->RemoveAt(i);
+      }
+    }
+    buffer_pool_manager_->UnpinPage(image_page_id, true);
+    // all pairs may have gone the same way, in which case the loop splits again
+  }
+}
+
+/*****************************************************************************
+ * REMOVE
+ *****************************************************************************/
+template <typename KeyType, typename ValueType, typename KeyComparator>
+bool EXTENDIBLE_HASH_TABLE_TYPE::Remove(Transaction *transaction, const KeyType &key, const ValueType &value) {
+  table_latch_.RLock();
+  WritePageGuard guard =
+      buffer_pool_manager_->FetchPageWrite(directory_page_->GetBucketPageId(KeyToDirectoryIndex(key)));
+  bool res = false;
+  bool empty = false;
+  if (guard.IsValid() && guard.As<HASH_TABLE_BUCKET_TYPE>()->Contains(key, value, comparator_)) {
+    auto bucket_page = guard.AsMut<HASH_TABLE_BUCKET_TYPE>();
+    res = bucket_page->Remove(key, value, comparator_);
+    empty = bucket_page->IsEmpty();
+  }
+  guard.Drop();
+  table_latch_.RUnlock();
+
+  if (empty) {
+    table_latch_.WLock();
+    directory_frame_->WLatch();
+    Merge(key);
+    directory_frame_->WUnlatch();
+    table_latch_.WUnlock();
+  }
+  return res;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+void EXTENDIBLE_HASH_TABLE_TYPE::Merge(const KeyType &key) {
+  // a merged bucket may merge on with its own split image, one level up
+  while (true) {
+    uint32_t bucket_idx = KeyToDirectoryIndex(key);
+    uint32_t local_depth = directory_page_->GetLocalDepth(bucket_idx);
+    if (local_depth == 0) {
+      break;
+    }
+    // only buckets of the same depth are split images of each other
+    uint32_t image_idx = directory_page_->GetSplitImageIndex(bucket_idx);
+    if (directory_page_->GetLocalDepth(image_idx) != local_depth) {
+      break;
+    }
+    page_id_t bucket_page_id = directory_page_->GetBucketPageId(bucket_idx);
+    page_id_t image_page_id = directory_page_->GetBucketPageId(image_idx);
+    page_id_t empty_page_id;
+    {
+      // an insert may have refilled the bucket since the shared latch was let go
+      ReadPageGuard guard = buffer_pool_manager_->FetchPageRead(bucket_page_id);
+      ReadPageGuard image_guard = buffer_pool_manager_->FetchPageRead(image_page_id);
+      if (!guard.IsValid() || !image_guard.IsValid()) {
+        break;
+      }
+      if (guard.As<HASH_TABLE_BUCKET_TYPE>()->IsEmpty()) {
+        empty_page_id = bucket_page_id;
+      } else if (image_guard.As<HASH_TABLE_BUCKET_TYPE>()->IsEmpty()) {
+        empty_page_id = image_page_id;
+      } else {
+        break;
+      }
+    }
+
+    page_id_t kept_page_id = empty_page_id == bucket_page_id ? image_page_id : bucket_page_id;
+    for (uint32_t i = 0; i < directory_page_->Size(); ++i) {
+      page_id_t page_id = directory_page_->GetBucketPageId(i);
+      if (page_id == bucket_page_id || page_id == image_page_id) {
+        directory_page_->SetBucketPageId(i, kept_page_id);
+        directory_page_->SetLocalDepth(i, local_depth - 1);
+      }
+    }
+    buffer_pool_manager_->DeletePage(empty_page_id);
+  }
+  while (directory_page_->CanShrink()) {
+    directory_page_->DecrGlobalDepth();
+  }
+}
+
+/*****************************************************************************
+ * GETGLOBALDEPTH
+ *****************************************************************************/
+template <typename KeyType, typename ValueType, typename KeyComparator>
+uint32_t EXTENDIBLE_HASH_TABLE_TYPE::GetGlobalDepth() {
+  table_latch_.RLock();
+  uint32_t global_depth = directory_page_->GetGlobalDepth();
+  table_latch_.RUnlock();
+  return global_depth;
+}
+
+/*****************************************************************************
+ * VERIFY INTEGRITY
+ *****************************************************************************/
+template <typename KeyType, typename ValueType, typename KeyComparator>
+void EXTENDIBLE_HASH_TABLE_TYPE::VerifyIntegrity() {
+  table_latch_.RLock();
+  uint32_t global_depth = directory_page_->GetGlobalDepth();
+  std::unordered_map<page_id_t, uint32_t> num_entries;
+  std::unordered_map<page_id_t, uint32_t> local_depths;
+  for (uint32_t i = 0; i < directory_page_->Size(); ++i) {
+    page_id_t page_id = directory_page_->GetBucketPageId(i);
+    uint32_t local_depth = directory_page_->GetLocalDepth(i);
+    BUSTUB_ASSERT(local_depth <= global_depth, "a bucket cannot be deeper than the directory");
+    auto it = local_depths.find(page_id);
+    BUSTUB_ASSERT(it == local_depths.end() || it->second == local_depth,
+                  "the entries of a bucket have to agree on its local depth");
+    local_depths[page_id] = local_depth;
+    ++num_entries[page_id];
+    // the entries of a bucket agree in the low local depth bits
+    uint32_t first_idx = i & ((1U << local_depth) - 1);
+    BUSTUB_ASSERT(directory_page_->GetBucketPageId(first_idx) == page_id,
+                  "the entries of a bucket have to agree in its low local depth bits");
+  }
+  for (const auto &[page_id, count] : num_entries) {
+    BUSTUB_ASSERT(count == (1U << (global_depth - local_depths[page_id])),
+                  "a bucket has to have 2^(global depth - local depth) entries");
+  }
+  table_latch_.RUnlock();
+}
+
+template class ExtendibleHashTable<int, int, IntComparator>;
+
+template class ExtendibleHashTable<GenericKey<4>, RID, GenericComparator<4>>;
+template class ExtendibleHashTable<GenericKey<8>, RID, GenericComparator<8>>;
+template class ExtendibleHashTable<GenericKey<16>, RID, GenericComparator<16>>;
+template class ExtendibleHashTable<GenericKey<32>, RID, GenericComparator<32>>;
+template class ExtendibleHashTable<GenericKey<64>, RID, GenericComparator<64>>;
+
+}  // namespace bustub
@@ -10,7 +10,11 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <algorithm>
+#include <array>
+#include <mutex>  // NOLINT
 #include <iostream>
+#include <numeric>
 #include <string>
 #include <utility>
 #include <vector>
@@ -22,20 +26,116 @@
 
 namespace bustub {
 
+/** The number of block page ids a header page has room for. */
+static constexpr size_t MAX_BLOCK_PAGES = (PAGE_SIZE - sizeof(HashTableHeaderPage)) / sizeof(page_id_t);
+
+/** The table grows once more than this share of its slots has been occupied, counting tombstones. */
+static constexpr double MAX_LOAD_FACTOR = 0.75;
+
+/** The number of block pages of the old generation every insert migrates while the table grows. */
+static constexpr size_t MIGRATION_BLOCKS_PER_INSERT = 2;
+
 template <typename KeyType, typename ValueType, typename KeyComparator>
 HASH_TABLE_TYPE::LinearProbeHashTable(const std::string &name, BufferPoolManager *buffer_pool_manager,
                                       const KeyComparator &comparator, size_t num_buckets,
                                       HashFunction<KeyType> hash_fn)
     : buffer_pool_manager_(buffer_pool_manager), comparator_(comparator), hash_fn_(std::move(hash_fn)) {
-  header_page_id_ = INVALID_PAGE_ID;
-  header_page_ = reinterpret_cast<HashTableHeaderPage *>(buffer_pool_manager_->NewPage(&header_page_id_)->GetData());
-  header_page_->SetSize(num_buckets);
-  header_page_->SetPageId(header_page_id_);
+  // num_buckets is the number of slots asked for, rounded up to whole block pages
+  size_t num_blocks = std::max<size_t>((num_buckets + BLOCK_ARRAY_SIZE - 1) / BLOCK_ARRAY_SIZE, 1);
+  BUSTUB_ASSERT(num_blocks <= MAX_BLOCK_PAGES, "the block page ids have to fit into the header page");
+  header_page_ = NewGeneration(num_blocks, &header_page_id_);
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+HashTableHeaderPage *HASH_TABLE_TYPE::NewGeneration(size_t num_blocks, page_id_t *header_page_id) {
+  Page *page = buffer_pool_manager_->NewPage(header_page_id);
+  BUSTUB_ASSERT(page != nullptr, "every frame is pinned");
+  // the header page stays pinned for as long as its generation is in use
+  auto header_page = reinterpret_cast<HashTableHeaderPage *>(page->GetData());
+  header_page->SetSize(num_blocks * BLOCK_ARRAY_SIZE);
+  header_page->SetPageId(*header_page_id);
   page_id_t block_page_id;
-  for (size_t i = 0; i < num_buckets; ++i) {
-    buffer_pool_manager_->NewPage(&block_page_id);
-    header_page_->AddBlockPageId(block_page_id);
+  for (size_t i = 0; i < num_blocks; ++i) {
+    Page *block_page = buffer_pool_manager_->NewPage(&block_page_id);
+    BUSTUB_ASSERT(block_page != nullptr, "every frame is pinned");
+    header_page->AddBlockPageId(block_page_id);
+    // a new page is all zeroes, i.e. a block without occupied slots
+    buffer_pool_manager_->UnpinPage(block_page_id, true);
+  }
+  return header_page;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+template <typename Visit>
+size_t HASH_TABLE_TYPE::Probe(HashTableHeaderPage *header_page, uint32_t hash, Visit &&visit,
+                              size_t *first_tombstone) {
+  size_t num_slots = header_page->GetSize();
+  uint8_t tag = HASH_TABLE_BLOCK_TYPE::Tag(hash);
+  size_t slot = hash % num_slots;
+  size_t probed = 0;
+  size_t end = num_slots;
+  while (probed < num_slots) {
+    // a lookup leaves the block clean, so it is never written back on its account
+    ReadPageGuard guard = buffer_pool_manager_->FetchPageRead(header_page->GetBlockPageId(slot / BLOCK_ARRAY_SIZE));
+    if (!guard.IsValid()) {
+      return num_slots;
+    }
+    if (ProbeBlock(guard.As<HASH_TABLE_BLOCK_TYPE>(), tag, num_slots, &slot, &probed, visit, first_tombstone, &end)) {
+      return end;
+    }
+    if (slot == num_slots) {
+      slot = 0;
+    }
   }
+  return num_slots;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+template <typename Visit>
+bool HASH_TABLE_TYPE::ProbeBlock(const HASH_TABLE_BLOCK_TYPE *block_page, uint8_t tag, size_t num_slots, size_t *slot,
+                                 size_t *probed, Visit &&visit, size_t *first_tombstone, size_t *end) {
+  // a group at a time; only the slots whose tag matches are worth a key comparison
+  for (size_t offset = *slot % BLOCK_ARRAY_SIZE; offset < BLOCK_ARRAY_SIZE && *probed < num_slots;) {
+    auto group = block_page->MatchGroup(offset, tag);
+    size_t width = std::min({static_cast<size_t>(BLOCK_GROUP_SIZE), BLOCK_ARRAY_SIZE - offset, num_slots - *probed});
+    uint32_t run = (uint32_t{1} << width) - 1;
+    if ((group.empty_ & run) != 0) {
+      // the run ends at the first slot that was never occupied
+      run = (group.empty_ & run & -(group.empty_ & run)) - 1;
+    }
+    if (first_tombstone != nullptr && *first_tombstone == num_slots && (group.deleted_ & run) != 0) {
+      *first_tombstone = *slot + __builtin_ctz(group.deleted_ & run);
+    }
+    for (uint32_t match = group.match_ & run; match != 0; match &= match - 1) {
+      if (visit(block_page, *slot + __builtin_ctz(match))) {
+        *end = num_slots;
+        return true;
+      }
+    }
+    if ((group.empty_ & ((uint32_t{1} << width) - 1)) != 0) {
+      *end = *slot + __builtin_ctz(group.empty_);
+      return true;
+    }
+    offset += width;
+    *probed += width;
+    *slot += width;
+  }
+  return false;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+size_t HASH_TABLE_TYPE::FindPair(HashTableHeaderPage *header_page, const KeyType &key, const ValueType &value,
+                                 uint32_t hash) {
+  size_t found = header_page->GetSize();
+  Probe(header_page, hash, [&](const HASH_TABLE_BLOCK_TYPE *block_page, size_t slot) {
+    size_t offset = slot % BLOCK_ARRAY_SIZE;
+    if (comparator_(block_page->KeyAt(offset), key) == 0 && block_page->ValueAt(offset) == value) {
+      found = slot;
+      return true;
+    }
+    return false;
+  });
+  return found;
 }
 
 /*****************************************************************************
@@ -43,77 +143,365 @@ HASH_TABLE_TYPE::LinearProbeHashTable(const std::string &name, BufferPoolManager
  *****************************************************************************/
 template <typename KeyType, typename ValueType, typename KeyComparator>
 bool HASH_TABLE_TYPE::GetValue(Transaction *transaction, const KeyType &key, std::vector<ValueType> *result) {
+  table_latch_.RLock();
   bool found = false;
-  auto hash_ind = hash_fn_.GetHash(key) % GetSize();
-  auto blk_pg_id = header_page_->GetBlockPageId(hash_ind);
-  auto block_page = reinterpret_cast<HashTableBlockPage<KeyType, ValueType, KeyComparator> *>(buffer_pool_manager_->FetchPage(blk_pg_id));
-  for (size_t i = 0; i < (BLOCK_ARRAY_SIZE - 1) / 8 + 1; ++i) {
-    if (!block_page->IsOccupied(i)) {
-      break;
-    } else if (block_page->IsReadable(i) && comparator_(block_page->KeyAt(i), key) == 0) {
-      result->push_back(block_page->ValueAt(i));
+  auto collect = [&](const HASH_TABLE_BLOCK_TYPE *block_page, size_t slot) {
+    size_t offset = slot % BLOCK_ARRAY_SIZE;
+    if (comparator_(block_page->KeyAt(offset), key) == 0) {
+      result->push_back(block_page->ValueAt(offset));
       found = true;
     }
+    return false;
+  };
+  uint32_t hash = Hash(key);
+  Probe(header_page_, hash, collect);
+  // while the table grows, the pairs not migrated yet are only in the old generation
+  if (old_header_page_ != nullptr) {
+    Probe(old_header_page_, hash, collect);
   }
-  buffer_pool_manager_->UnpinPage(blk_pg_id, true);
+  table_latch_.RUnlock();
   return found;
 }
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+void HASH_TABLE_TYPE::GetValues(Transaction *transaction, const std::vector<KeyType> &keys,
+                                std::vector<std::vector<ValueType>> *results) {
+  results->resize(keys.size());
+  std::vector<uint32_t> hashes(keys.size());
+  for (size_t i = 0; i < keys.size(); ++i) {
+    hashes[i] = Hash(keys[i]);
+  }
+  for (size_t begin = 0; begin < keys.size(); begin += PROBE_BATCH_SIZE) {
+    size_t end = std::min(keys.size(), begin + PROBE_BATCH_SIZE);
+    // the latch is taken per batch, so that a long one does not hold up the growth of the table
+    table_latch_.RLock();
+    ProbeBatch(header_page_, keys, hashes, begin, end, results);
+    // while the table grows, the pairs not migrated yet are only in the old generation
+    if (old_header_page_ != nullptr) {
+      ProbeBatch(old_header_page_, keys, hashes, begin, end, results);
+    }
+    table_latch_.RUnlock();
+  }
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+void HASH_TABLE_TYPE::ProbeBatch(HashTableHeaderPage *header_page, const std::vector<KeyType> &keys,
+                                 const std::vector<uint32_t> &hashes, size_t begin, size_t end,
+                                 std::vector<std::vector<ValueType>> *results) {
+  size_t num_slots = header_page->GetSize();
+  auto block_of = [&](size_t i) { return hashes[i] % num_slots / BLOCK_ARRAY_SIZE; };
+  auto collect_into = [&](size_t i) {
+    return [this, &key = keys[i], result = &(*results)[i]](const HASH_TABLE_BLOCK_TYPE *block_page, size_t slot) {
+      size_t offset = slot % BLOCK_ARRAY_SIZE;
+      if (comparator_(block_page->KeyAt(offset), key) == 0) {
+        result->push_back(block_page->ValueAt(offset));
+      }
+      return false;
+    };
+  };
+
+  // the keys in the order of the block pages their runs start in, so that those of a page come one after the other
+  std::vector<size_t> order(end - begin);
+  std::iota(order.begin(), order.end(), begin);
+  std::sort(order.begin(), order.end(), [&](size_t a, size_t b) { return block_of(a) < block_of(b); });
+  std::vector<page_id_t> block_page_ids;
+  for (size_t i : order) {
+    page_id_t block_page_id = header_page->GetBlockPageId(block_of(i));
+    if (block_page_ids.empty() || block_page_ids.back() != block_page_id) {
+      block_page_ids.push_back(block_page_id);
+    }
+  }
+  // the pages that are not in the buffer pool are read meanwhile, while the keys of the first ones are probed
+  buffer_pool_manager_->PrefetchPages(block_page_ids);
+
+  std::vector<size_t> spilled;
+  for (size_t next = 0; next < order.size();) {
+    size_t block = block_of(order[next]);
+    ReadPageGuard guard = buffer_pool_manager_->FetchPageRead(header_page->GetBlockPageId(block));
+    for (; next < order.size() && block_of(order[next]) == block; ++next) {
+      size_t i = order[next];
+      if (!guard.IsValid()) {
+        continue;
+      }
+      std::vector<ValueType> *result = &(*results)[i];
+      size_t found = result->size();
+      size_t slot = hashes[i] % num_slots;
+      size_t probed = 0;
+      size_t run_end;
+      if (!ProbeBlock(guard.As<HASH_TABLE_BLOCK_TYPE>(), HASH_TABLE_BLOCK_TYPE::Tag(hashes[i]), num_slots, &slot,
+                      &probed, collect_into(i), nullptr, &run_end)) {
+        result->erase(result->begin() + found, result->end());
+        spilled.push_back(i);
+      }
+    }
+  }
+  // the few runs that go on past the block page they start in are probed again in whole, one page at a time
+  for (size_t i : spilled) {
+    Probe(header_page, hashes[i], collect_into(i));
+  }
+}
+
 /*****************************************************************************
  * INSERTION
  *****************************************************************************/
 template <typename KeyType, typename ValueType, typename KeyComparator>
 bool HASH_TABLE_TYPE::Insert(Transaction *transaction, const KeyType &key, const ValueType &value) {
-  bool res = false;
-  auto hash_ind = hash_fn_.GetHash(key) % GetSize();
-  auto blk_pg_id = header_page_->GetBlockPageId(hash_ind);
-  auto block_page = reinterpret_cast<HashTableBlockPage<KeyType, ValueType, KeyComparator> *>(buffer_pool_manager_->FetchPage(blk_pg_id));
-  for (size_t i = 0; i < (BLOCK_ARRAY_SIZE - 1) / 8 + 1; ++i) {
-    if (!block_page->IsOccupied(i))
-      break;
-    if (block_page->IsReadable(i) && comparator_(block_page->KeyAt(i),key) == 0 && block_page->ValueAt(i) == value) {
-      buffer_pool_manager_->UnpinPage(blk_pg_id, true);
-      return false;
+  table_latch_.RLock();
+  if (old_header_page_ != nullptr || OverLoadFactor()) {
+    // migrating and growing move pairs between generations, which takes the table to itself
+    table_latch_.RUnlock();
+    table_latch_.WLock();
+    if (old_header_page_ != nullptr) {
+      MigrateBlocks(MIGRATION_BLOCKS_PER_INSERT);
+    } else if (OverLoadFactor()) {
+      Grow(GetSize());
     }
+    table_latch_.WUnlock();
+    table_latch_.RLock();
   }
-  for (size_t i = 0; i < (BLOCK_ARRAY_SIZE - 1) / 8 + 1; ++i) {
-    if (!block_page->IsReadable(i)) {
-      block_page->Insert(i, key, value);
-      res = true;
-      break;
+
+  // inserts of the same key take the same insert latch, so no two of them both find the pair missing and insert it
+  // the key is hashed once, for the insert latch and every probe, retries included
+  uint32_t hash = Hash(key);
+  std::unique_lock insert_latch{insert_latches_[hash % NUM_INSERT_LATCHES]};
+  bool res = false;
+  if (old_header_page_ == nullptr || FindPair(old_header_page_, key, value, hash) == old_header_page_->GetSize()) {
+    InsertResult result = InsertInto(key, value, hash);
+    if (result == InsertResult::FULL) {
+      // a run covering the whole table, which growing breaks up; the insert latch is let go first, as other inserts
+      // may wait for it while they hold the table latch shared
+      insert_latch.unlock();
+      table_latch_.RUnlock();
+      table_latch_.WLock();
+      Grow(GetSize());
+      result = InsertInto(key, value, hash);
+      table_latch_.WUnlock();
+      return result == InsertResult::INSERTED;
     }
+    res = result == InsertResult::INSERTED;
   }
-  buffer_pool_manager_->UnpinPage(blk_pg_id, true);
+  insert_latch.unlock();
+  table_latch_.RUnlock();
   return res;
 }
 
+template <typename KeyType, typename ValueType, typename KeyComparator>
+bool HASH_TABLE_TYPE::OverLoadFactor() {
+  return static_cast<double>(num_occupied_.load() + 1) > MAX_LOAD_FACTOR * static_cast<double>(GetSize());
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+typename HASH_TABLE_TYPE::InsertResult HASH_TABLE_TYPE::InsertInto(const KeyType &key, const ValueType &value,
+                                                                   uint32_t hash) {
+  size_t num_slots = GetSize();
+  while (true) {
+    bool duplicate = false;
+    // the first tombstone of the run, which can be reused, or else the slot that ends the run
+    size_t free_slot = num_slots;
+    size_t end = Probe(
+        header_page_, hash,
+        [&](const HASH_TABLE_BLOCK_TYPE *block_page, size_t slot) {
+          size_t offset = slot % BLOCK_ARRAY_SIZE;
+          duplicate = comparator_(block_page->KeyAt(offset), key) == 0 && block_page->ValueAt(offset) == value;
+          return duplicate;
+        },
+        &free_slot);
+    if (duplicate) {
+      return InsertResult::DUPLICATE;
+    }
+    if (free_slot == num_slots) {
+      free_slot = end;
+    }
+    if (free_slot == num_slots) {
+      return InsertResult::FULL;
+    }
+
+    page_id_t block_page_id = header_page_->GetBlockPageId(free_slot / BLOCK_ARRAY_SIZE);
+    WritePageGuard guard = buffer_pool_manager_->FetchPageWrite(block_page_id);
+    if (!guard.IsValid()) {
+      return InsertResult::FULL;
+    }
+    // the probe let go of the block's latch, so an insert of another key may have taken the slot meanwhile; then the
+    // run is probed again, it may have grown past the slot
+    size_t offset = free_slot % BLOCK_ARRAY_SIZE;
+    bool was_occupied = guard.As<HASH_TABLE_BLOCK_TYPE>()->IsOccupied(offset);
+    if (guard.AsMut<HASH_TABLE_BLOCK_TYPE>()->Insert(offset, key, value, hash)) {
+      if (!was_occupied) {
+        ++num_occupied_;
+      }
+      return InsertResult::INSERTED;
+    }
+  }
+}
+
 /*****************************************************************************
- * REMOVE
+ * BULK INSERTION
  *****************************************************************************/
 template <typename KeyType, typename ValueType, typename KeyComparator>
-bool HASH_TABLE_TYPE::Remove(Transaction *transaction, const KeyType &key, const ValueType &value) {
-  bool res = false;
-  auto hash_ind = hash_fn_.GetHash(key) % GetSize();
-  auto blk_pg_id = header_page_->GetBlockPageId(hash_ind);
-  auto block_page = reinterpret_cast<HashTableBlockPage<KeyType, ValueType, KeyComparator> *>(buffer_pool_manager_->FetchPage(blk_pg_id));
-  for (size_t i = 0; i < (BLOCK_ARRAY_SIZE - 1) / 8 + 1; ++i) {
-    if (!block_page->IsOccupied(i)) {
-      break;
+size_t HASH_TABLE_TYPE::BulkInsert(Transaction *transaction, const std::vector<std::pair<KeyType, ValueType>> &pairs) {
+  table_latch_.WLock();
+  // grow to hold all pairs up front, and finish migrating, so that the slots do not move while the pairs go in
+  double needed = static_cast<double>(num_occupied_.load() + pairs.size()) / MAX_LOAD_FACTOR;
+  if (needed > static_cast<double>(GetSize())) {
+    Grow(static_cast<size_t>(needed / 2) + 1);
+  }
+  if (old_header_page_ != nullptr) {
+    MigrateBlocks(old_header_page_->NumBlocks());
+  }
+
+  // hashed once each, then sorted by home slot, so that the block pages are visited in order
+  size_t num_slots = GetSize();
+  std::vector<uint32_t> hashes(pairs.size());
+  std::vector<std::pair<size_t, size_t>> order(pairs.size());
+  for (size_t i = 0; i < pairs.size(); ++i) {
+    hashes[i] = Hash(pairs[i].first);
+    order[i] = {hashes[i] % num_slots, i};
+  }
+  std::sort(order.begin(), order.end());
+
+  size_t num_inserted = 0;
+  size_t num_blocks = header_page_->NumBlocks();
+  WritePageGuard guard;
+  size_t guard_block = num_blocks;
+  auto latch_block = [&](size_t block) {
+    if (block != guard_block) {
+      guard = buffer_pool_manager_->FetchPageWrite(header_page_->GetBlockPageId(block));
+      BUSTUB_ASSERT(guard.IsValid(), "every frame is pinned");
+      guard_block = block;
+    }
+    return guard.As<HASH_TABLE_BLOCK_TYPE>();
+  };
+  for (const auto &[home_slot, i] : order) {
+    const auto &[key, value] = pairs[i];
+    // the run from the home slot on, as Probe walks it, but with the block pages kept latched from pair to pair
+    size_t free_slot = num_slots;
+    bool duplicate = false;
+    size_t slot = home_slot;
+    for (size_t probed = 0; probed < num_slots && !duplicate; ++probed, slot = slot + 1 == num_slots ? 0 : slot + 1) {
+      auto block_page = latch_block(slot / BLOCK_ARRAY_SIZE);
+      size_t offset = slot % BLOCK_ARRAY_SIZE;
+      if (!block_page->IsReadable(offset)) {
+        free_slot = free_slot == num_slots ? slot : free_slot;
+        if (!block_page->IsOccupied(offset)) {
+          break;
+        }
+      } else if (block_page->HashAt(offset) == hashes[i] && comparator_(block_page->KeyAt(offset), key) == 0 &&
+                 block_page->ValueAt(offset) == value) {
+        duplicate = true;
+      }
+    }
+    if (duplicate || free_slot == num_slots) {
+      continue;
     }
-    if (block_page->IsReadable(i) && comparator_(block_page->KeyAt(i), key) == 0 && block_page->ValueAt(i) == value) {
-      block_page->Remove(i);
-      res = true;
-      break;
+    latch_block(free_slot / BLOCK_ARRAY_SIZE);
+    auto block_page = guard.AsMut<HASH_TABLE_BLOCK_TYPE>();
+    size_t offset = free_slot % BLOCK_ARRAY_SIZE;
+    if (!block_page->IsOccupied(offset)) {
+      ++num_occupied_;
     }
+    block_page->Insert(offset, key, value, hashes[i]);
+    ++num_inserted;
   }
-  buffer_pool_manager_->UnpinPage(blk_pg_id, true);
+  guard.Drop();
+  table_latch_.WUnlock();
+  return num_inserted;
+}
+
+/*****************************************************************************
+ * REMOVE
+ *****************************************************************************/
+template <typename KeyType, typename ValueType, typename KeyComparator>
+bool HASH_TABLE_TYPE::Remove(Transaction *transaction, const KeyType &key, const ValueType &value) {
+  table_latch_.RLock();
+  uint32_t hash = Hash(key);
+  bool res = RemoveFrom(header_page_, key, value, hash);
+  if (!res && old_header_page_ != nullptr) {
+    res = RemoveFrom(old_header_page_, key, value, hash);
+  }
+  table_latch_.RUnlock();
   return res;
 }
 
+template <typename KeyType, typename ValueType, typename KeyComparator>
+bool HASH_TABLE_TYPE::RemoveFrom(HashTableHeaderPage *header_page, const KeyType &key, const ValueType &value,
+                                 uint32_t hash) {
+  // find the pair under read latches, then clear it under a write latch of its block if it is still there
+  size_t found = FindPair(header_page, key, value, hash);
+  if (found == header_page->GetSize()) {
+    return false;
+  }
+  size_t offset = found % BLOCK_ARRAY_SIZE;
+  WritePageGuard guard = buffer_pool_manager_->FetchPageWrite(header_page->GetBlockPageId(found / BLOCK_ARRAY_SIZE));
+  if (!guard.IsValid()) {
+    return false;
+  }
+  auto block_page = guard.As<HASH_TABLE_BLOCK_TYPE>();
+  if (!block_page->IsReadable(offset) || comparator_(block_page->KeyAt(offset), key) != 0 ||
+      !(block_page->ValueAt(offset) == value)) {
+    return false;
+  }
+  guard.AsMut<HASH_TABLE_BLOCK_TYPE>()->Remove(offset);
+  return true;
+}
+
 /*****************************************************************************
  * RESIZE
  *****************************************************************************/
 template <typename KeyType, typename ValueType, typename KeyComparator>
-void HASH_TABLE_TYPE::Resize(size_t initial_size) {}
+void HASH_TABLE_TYPE::Resize(size_t initial_size) {
+  table_latch_.WLock();
+  Grow(initial_size);
+  table_latch_.WUnlock();
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+void HASH_TABLE_TYPE::Grow(size_t initial_size) {
+  // one growth at a time
+  if (old_header_page_ != nullptr) {
+    MigrateBlocks(old_header_page_->NumBlocks());
+  }
+  size_t num_blocks = std::min((2 * initial_size + BLOCK_ARRAY_SIZE - 1) / BLOCK_ARRAY_SIZE, MAX_BLOCK_PAGES);
+  if (num_blocks <= header_page_->NumBlocks()) {
+    return;
+  }
+  // lookups probe both generations from here on
+  old_header_page_ = header_page_;
+  old_header_page_id_ = header_page_id_;
+  header_page_ = NewGeneration(num_blocks, &header_page_id_);
+  num_migrated_blocks_ = 0;
+  num_occupied_.store(0);
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+void HASH_TABLE_TYPE::MigrateBlocks(size_t num_blocks) {
+  size_t old_num_blocks = old_header_page_ == nullptr ? 0 : old_header_page_->NumBlocks();
+  for (size_t i = 0; i < num_blocks && num_migrated_blocks_ < old_num_blocks; ++i, ++num_migrated_blocks_) {
+    WritePageGuard guard = buffer_pool_manager_->FetchPageWrite(old_header_page_->GetBlockPageId(num_migrated_blocks_));
+    BUSTUB_ASSERT(guard.IsValid(), "every frame is pinned");
+    auto block_page = guard.AsMut<HASH_TABLE_BLOCK_TYPE>();
+    for (size_t offset = 0; offset < BLOCK_ARRAY_SIZE; ++offset) {
+      if (block_page->IsReadable(offset)) {
+        // a tombstone keeps the runs of the old generation that go through this block intact; the pair moves by the
+        // hash stored with it, without the key being hashed again
+        InsertResult result =
+            InsertInto(block_page->KeyAt(offset), block_page->ValueAt(offset), block_page->HashAt(offset));
+        BUSTUB_ASSERT(result != InsertResult::FULL, "the new generation is twice the size of the old one");
+        block_page->Remove(offset);
+      }
+    }
+  }
+  if (old_header_page_ == nullptr || num_migrated_blocks_ < old_num_blocks) {
+    return;
+  }
+  // the old generation is empty now
+  for (size_t i = 0; i < old_num_blocks; ++i) {
+    buffer_pool_manager_->DeletePage(old_header_page_->GetBlockPageId(i));
+  }
+  buffer_pool_manager_->UnpinPage(old_header_page_id_, false);
+  buffer_pool_manager_->DeletePage(old_header_page_id_);
+  old_header_page_ = nullptr;
+  old_header_page_id_ = INVALID_PAGE_ID;
+}
 
 /*****************************************************************************
  * GETSIZE
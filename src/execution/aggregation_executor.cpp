@@ -1,29 +1,869 @@
-//===----------------------------------------------------------------------===//
-//
-//                         BusTub
-//
-// aggregation_executor.cpp
-//
-// Identification: src/execution/aggregation_executor.cpp
-//
-// Copyright (c) 2015-19, Carnegie Mellon University Database Group
-//
-//===----------------------------------------------------------------------===//
-#include <memory>
-#include <vector>
-
-#include "execution/executors/aggregation_executor.h"
-
-namespace bustub {
-
-AggregationExecutor::AggregationExecutor(ExecutorContext *exec_ctx, const AggregationPlanNode *plan,
-                                         std::unique_ptr<AbstractExecutor> &&child)
-    : AbstractExecutor(exec_ctx) {}
-
-const AbstractExecutor *AggregationExecutor::GetChildExecutor() const { return child_.get(); }
-
-void AggregationExecutor::Init() {}
-
-bool AggregationExecutor::Next(Tuple *tuple, RID *rid) { return false; }
-
-}  // namespace bustub
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// aggregation_executor.cpp
+//
+// Identification: src/execution/aggregation_executor.cpp
+//
+// Copyright (c) 2015-19, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "execution/executors/aggregation_executor.h"
+
+#include "buffer/buffer_access_strategy.h"
+#include "catalog/catalog.h"
+#include "execution/compiled_predicate.h"
+#include "execution/executors/seq_scan_executor.h"
+#include "execution/expressions/column_value_expression.h"
+#include "execution/pipeline_scheduler.h"
+#include "execution/push_pipeline.h"
+#include "execution/plans/seq_scan_plan.h"
+#include "storage/table/table_page_scanner.h"
+#include "type/fixed_decimal.h"
+
+namespace bustub {
+
+namespace {
+
+template <typename T>
+T Load(const char *storage) {
+  T value;
+  memcpy(&value, storage, sizeof(T));
+  return value;
+}
+
+template <typename T>
+void Store(char *storage, T value) {
+  memcpy(storage, &value, sizeof(T));
+}
+
+/** The flags of an aggregate: whether it has seen an input that is not NULL, and whether its SUM of decimals has
+ * left DecimalSum, and so is a double */
+constexpr char SEEN = 1;
+constexpr char INEXACT_SUM = 2;
+
+/** The state of a SUM of decimals while its inputs and their sum fit it, which adds them up exactly */
+using DecimalSum = FixedDecimal<18, 6>;
+
+DecimalSum LoadDecimalSum(const char *state) {
+  DecimalSum sum;
+  DecimalSum::FromUnscaled(Load<int64_t>(state), &sum);
+  return sum;
+}
+
+double DecimalSumAsDouble(const char *state, char flags) {
+  return (flags & INEXACT_SUM) != 0 ? Load<double>(state) : LoadDecimalSum(state).ToDouble();
+}
+
+/**
+ * Adds to the state of a SUM of decimals, which stays a DecimalSum while the addends are exact and their sum fits,
+ * and is a double from then on.
+ * @param exact_addend the addend as a DecimalSum, or nullptr if it is not one
+ * @param addend the addend as a double
+ */
+void AddDecimalSum(char *state, char *flags, const DecimalSum *exact_addend, double addend) {
+  DecimalSum sum;
+  if ((*flags & INEXACT_SUM) == 0 && exact_addend != nullptr && LoadDecimalSum(state).Add(*exact_addend, &sum)) {
+    Store(state, static_cast<int64_t>(sum.GetUnscaled()));
+    return;
+  }
+  Store(state, DecimalSumAsDouble(state, *flags) + addend);
+  *flags |= INEXACT_SUM;
+}
+
+/** @return the bytes of a group-by of fixed width in a key */
+size_t FixedWidth(TypeId type) {
+  switch (type) {
+    case TypeId::BOOLEAN:
+    case TypeId::TINYINT:
+      return 1;
+    case TypeId::SMALLINT:
+      return 2;
+    case TypeId::INTEGER:
+      return 4;
+    default:
+      return 8;
+  }
+}
+
+/** Writes a value of fixed width as a tuple keeps it; a NULL is its type's null value */
+void StoreFixed(const Value &value, TypeId type, char *storage) {
+  switch (type) {
+    case TypeId::BOOLEAN:
+    case TypeId::TINYINT:
+      Store(storage, value.GetAs<int8_t>());
+      break;
+    case TypeId::SMALLINT:
+      Store(storage, value.GetAs<int16_t>());
+      break;
+    case TypeId::INTEGER:
+      Store(storage, value.GetAs<int32_t>());
+      break;
+    case TypeId::BIGINT:
+      Store(storage, value.GetAs<int64_t>());
+      break;
+    case TypeId::DECIMAL:
+      Store(storage, value.GetAs<double>());
+      break;
+    default:
+      Store(storage, value.GetAs<uint64_t>());
+      break;
+  }
+}
+
+Value LoadFixed(const char *storage, TypeId type) {
+  switch (type) {
+    case TypeId::BOOLEAN:
+    case TypeId::TINYINT:
+      return Value(type, Load<int8_t>(storage));
+    case TypeId::SMALLINT:
+      return Value(type, Load<int16_t>(storage));
+    case TypeId::INTEGER:
+      return Value(type, Load<int32_t>(storage));
+    case TypeId::BIGINT:
+      return Value(type, Load<int64_t>(storage));
+    case TypeId::DECIMAL:
+      return Value(type, Load<double>(storage));
+    default:
+      return Value(type, Load<uint64_t>(storage));
+  }
+}
+
+/** @return an input of an integer type, or a timestamp, as the int64_t of an aggregate state */
+int64_t AsInteger(const Value &value) {
+  switch (value.GetTypeId()) {
+    case TypeId::BOOLEAN:
+    case TypeId::TINYINT:
+      return value.GetAs<int8_t>();
+    case TypeId::SMALLINT:
+      return value.GetAs<int16_t>();
+    case TypeId::INTEGER:
+      return value.GetAs<int32_t>();
+    case TypeId::BIGINT:
+      return value.GetAs<int64_t>();
+    default:
+      return static_cast<int64_t>(value.GetAs<uint64_t>());
+  }
+}
+
+/** @return an int64_t state as a value of the type of its aggregate */
+Value IntegerAs(int64_t state, TypeId type) {
+  switch (type) {
+    case TypeId::INTEGER:
+      if (state < BUSTUB_INT32_MIN || state > BUSTUB_INT32_MAX) {
+        throw Exception(ExceptionType::OUT_OF_RANGE, "the aggregate overflows an INTEGER");
+      }
+      return Value(type, static_cast<int32_t>(state));
+    case TypeId::BIGINT:
+      return Value(type, state);
+    default:
+      return Value(type, static_cast<uint64_t>(state));
+  }
+}
+
+}  // namespace
+
+SimpleAggregationHashTable::SimpleAggregationHashTable(const std::vector<const AbstractExpression *> &group_bys,
+                                                       const std::vector<const AbstractExpression *> &agg_exprs,
+                                                       const std::vector<AggregationType> &agg_types,
+                                                       std::vector<double> percentiles)
+    : agg_exprs_{agg_exprs}, agg_types_{agg_types}, group_bys_{group_bys}, percentiles_(std::move(percentiles)) {
+  // the group-bys of fixed width come first, and the VARCHARs after them
+  for (const AbstractExpression *group_by : group_bys_) {
+    group_by_types_.push_back(group_by->GetReturnType());
+  }
+  group_by_offsets_.resize(group_by_types_.size());
+  for (uint32_t i = 0; i < group_by_types_.size(); i++) {
+    if (group_by_types_[i] != TypeId::VARCHAR) {
+      group_by_offsets_[i] = fixed_key_size_;
+      fixed_key_size_ += FixedWidth(group_by_types_[i]);
+    }
+  }
+  fixed_key_size_ = (fixed_key_size_ + sizeof(uint64_t) - 1) / sizeof(uint64_t) * sizeof(uint64_t);
+  key_size_ = fixed_key_size_;
+  for (uint32_t i = 0; i < group_by_types_.size(); i++) {
+    if (group_by_types_[i] == TypeId::VARCHAR) {
+      group_by_offsets_[i] = key_size_;
+      key_size_ += sizeof(VarcharSlot);
+    }
+  }
+
+  for (uint32_t i = 0; i < agg_exprs_.size(); i++) {
+    TypeId input_type = agg_exprs_[i]->GetReturnType();
+    AggregationType agg_type = agg_types_[i];
+    if (agg_type != AggregationType::CountAggregate && agg_type != AggregationType::ApproxCountDistinctAggregate &&
+        input_type == TypeId::VARCHAR) {
+      throw Exception(ExceptionType::NOT_IMPLEMENTED, "only COUNT and APPROX_COUNT_DISTINCT aggregate VARCHARs");
+    }
+    if (agg_type == AggregationType::ApproxPercentileAggregate &&
+        (i >= percentiles_.size() || !(percentiles_[i] >= 0 && percentiles_[i] <= 1))) {
+      throw Exception(ExceptionType::INVALID, "APPROX_PERCENTILE needs a fraction between 0 and 1");
+    }
+    decimal_states_.push_back((agg_type == AggregationType::SumAggregate || agg_type == AggregationType::MinAggregate ||
+                               agg_type == AggregationType::MaxAggregate) &&
+                              input_type == TypeId::DECIMAL);
+  }
+  states_offset_ = key_size_;
+  flags_offset_ = states_offset_ + agg_exprs_.size() * sizeof(int64_t);
+  record_size_ = (flags_offset_ + agg_exprs_.size() + sizeof(uint64_t) - 1) / sizeof(uint64_t) * sizeof(uint64_t);
+
+  key_.assign(key_size_ / sizeof(uint64_t), 0);
+  group_by_values_.resize(group_bys_.size());
+  aggregate_values_.resize(agg_exprs_.size());
+  slots_.assign(INITIAL_SLOTS, 0);
+}
+
+void SimpleAggregationHashTable::Clear() {
+  // the memory is released as well, as the memory usage of a table cleared for other groups starts over
+  records_.clear();
+  records_.shrink_to_fit();
+  size_ = 0;
+  slots_.assign(INITIAL_SLOTS, 0);
+  slots_.shrink_to_fit();
+  strings_.Reset();
+  distinct_sketches_.clear();
+  distinct_sketches_.shrink_to_fit();
+  quantile_sketches_.clear();
+  quantile_sketches_.shrink_to_fit();
+}
+
+template <typename Sketch>
+Sketch *SimpleAggregationHashTable::SketchOf(char *state, char *seen, std::vector<std::unique_ptr<Sketch>> *sketches) {
+  if (*seen == 0) {
+    Store(state, static_cast<int64_t>(sketches->size()));
+    sketches->push_back(std::make_unique<Sketch>());
+    *seen = 1;
+  }
+  return (*sketches)[Load<int64_t>(state)].get();
+}
+
+void SimpleAggregationHashTable::InsertCombine(const Tuple &tuple, const Schema *schema) {
+  for (uint32_t i = 0; i < group_bys_.size(); i++) {
+    group_by_values_[i] = group_bys_[i]->Evaluate(&tuple, schema);
+  }
+  for (uint32_t i = 0; i < agg_exprs_.size(); i++) {
+    aggregate_values_[i] = agg_exprs_[i]->Evaluate(&tuple, schema);
+  }
+  Combine(group_by_values_, aggregate_values_, true);
+}
+
+bool SimpleAggregationHashTable::CombineExisting(const Tuple &tuple, const Schema *schema) {
+  for (uint32_t i = 0; i < group_bys_.size(); i++) {
+    group_by_values_[i] = group_bys_[i]->Evaluate(&tuple, schema);
+  }
+  for (uint32_t i = 0; i < agg_exprs_.size(); i++) {
+    aggregate_values_[i] = agg_exprs_[i]->Evaluate(&tuple, schema);
+  }
+  return Combine(group_by_values_, aggregate_values_, false);
+}
+
+void SimpleAggregationHashTable::InsertCombine(const DataChunk &chunk, uint32_t row) {
+  for (uint32_t i = 0; i < group_bys_.size(); i++) {
+    group_by_values_[i] = group_bys_[i]->EvaluateRow(chunk, row);
+  }
+  for (uint32_t i = 0; i < agg_exprs_.size(); i++) {
+    aggregate_values_[i] = agg_exprs_[i]->EvaluateRow(chunk, row);
+  }
+  Combine(group_by_values_, aggregate_values_, true);
+}
+
+bool SimpleAggregationHashTable::CombineExisting(const DataChunk &chunk, uint32_t row) {
+  for (uint32_t i = 0; i < group_bys_.size(); i++) {
+    group_by_values_[i] = group_bys_[i]->EvaluateRow(chunk, row);
+  }
+  for (uint32_t i = 0; i < agg_exprs_.size(); i++) {
+    aggregate_values_[i] = agg_exprs_[i]->EvaluateRow(chunk, row);
+  }
+  return Combine(group_by_values_, aggregate_values_, false);
+}
+
+void SimpleAggregationHashTable::InsertCombine(const AggregateKey &agg_key, const AggregateValue &agg_val) {
+  Combine(agg_key.group_bys_, agg_val.aggregates_, true);
+}
+
+void SimpleAggregationHashTable::Merge(const SimpleAggregationHashTable &other, size_t index) {
+  // the key's VARCHARs point into the other table's arena, and are copied if the group is new here
+  const char *partial = other.Record(index);
+  memcpy(key_.data(), partial, key_size_);
+  char *record = FindOrInsert();
+  for (uint32_t i = 0; i < agg_types_.size(); i++) {
+    if (partial[flags_offset_ + i] == 0) {
+      continue;
+    }
+    char *state = record + states_offset_ + i * sizeof(int64_t);
+    const char *other_state = partial + states_offset_ + i * sizeof(int64_t);
+    char *seen = record + flags_offset_ + i;
+    switch (agg_types_[i]) {
+      case AggregationType::CountAggregate:
+        Store(state, Load<int64_t>(state) + Load<int64_t>(other_state));
+        break;
+      case AggregationType::SumAggregate:
+        if (decimal_states_[i]) {
+          char other_flags = partial[flags_offset_ + i];
+          DecimalSum addend = LoadDecimalSum(other_state);
+          AddDecimalSum(state, seen, (other_flags & INEXACT_SUM) == 0 ? &addend : nullptr,
+                        DecimalSumAsDouble(other_state, other_flags));
+        } else {
+          int64_t sum;
+          if (__builtin_add_overflow(Load<int64_t>(state), Load<int64_t>(other_state), &sum)) {
+            throw Exception(ExceptionType::OUT_OF_RANGE, "SUM overflows a BIGINT");
+          }
+          Store(state, sum);
+        }
+        break;
+      case AggregationType::MinAggregate:
+        if (decimal_states_[i]) {
+          double value = Load<double>(other_state);
+          Store(state, *seen != 0 ? std::min(Load<double>(state), value) : value);
+        } else {
+          int64_t value = Load<int64_t>(other_state);
+          Store(state, *seen != 0 ? std::min(Load<int64_t>(state), value) : value);
+        }
+        break;
+      case AggregationType::MaxAggregate:
+        if (decimal_states_[i]) {
+          double value = Load<double>(other_state);
+          Store(state, *seen != 0 ? std::max(Load<double>(state), value) : value);
+        } else {
+          int64_t value = Load<int64_t>(other_state);
+          Store(state, *seen != 0 ? std::max(Load<int64_t>(state), value) : value);
+        }
+        break;
+      case AggregationType::ApproxCountDistinctAggregate:
+        SketchOf(state, seen, &distinct_sketches_)->Merge(*other.distinct_sketches_[Load<int64_t>(other_state)]);
+        break;
+      case AggregationType::ApproxPercentileAggregate:
+        SketchOf(state, seen, &quantile_sketches_)->Merge(*other.quantile_sketches_[Load<int64_t>(other_state)]);
+        break;
+    }
+    *seen |= SEEN;
+  }
+}
+
+void SimpleAggregationHashTable::InsertEmptyGroup() {
+  BUSTUB_ASSERT(group_bys_.empty(), "only an aggregation without group-bys has a row of no tuples");
+  FindOrInsert();
+}
+
+bool SimpleAggregationHashTable::Combine(const std::vector<Value> &group_bys, const std::vector<Value> &aggregates,
+                                         bool insert) {
+  char *key = reinterpret_cast<char *>(key_.data());
+  for (uint32_t i = 0; i < group_by_types_.size(); i++) {
+    const Value &value = group_bys[i];
+    if (group_by_types_[i] != TypeId::VARCHAR) {
+      StoreFixed(value.GetTypeId() == group_by_types_[i] ? value : value.CastAs(group_by_types_[i]),
+                 group_by_types_[i], key + group_by_offsets_[i]);
+      continue;
+    }
+    VarcharSlot slot{nullptr, BUSTUB_VALUE_NULL, 0};
+    if (!value.IsNull()) {
+      slot.data_ = value.GetData();
+      slot.length_ = value.GetLength();
+    }
+    Store(key + group_by_offsets_[i], slot);
+  }
+
+  char *record = FindOrInsert(insert);
+  if (record == nullptr) {
+    return false;
+  }
+  for (uint32_t i = 0; i < agg_types_.size(); i++) {
+    const Value &input = aggregates[i];
+    if (input.IsNull()) {
+      continue;
+    }
+    char *state = record + states_offset_ + i * sizeof(int64_t);
+    char *seen = record + flags_offset_ + i;
+    switch (agg_types_[i]) {
+      case AggregationType::CountAggregate:
+        Store(state, Load<int64_t>(state) + 1);
+        break;
+      case AggregationType::SumAggregate:
+        if (decimal_states_[i]) {
+          // a decimal with more digits after the point than a DecimalSum keeps is added as a double
+          double value = input.GetAs<double>();
+          DecimalSum addend;
+          bool exact = DecimalSum::FromDouble(value, &addend) && addend.ToDouble() == value;
+          AddDecimalSum(state, seen, exact ? &addend : nullptr, value);
+        } else {
+          int64_t sum;
+          if (__builtin_add_overflow(Load<int64_t>(state), AsInteger(input), &sum)) {
+            throw Exception(ExceptionType::OUT_OF_RANGE, "SUM overflows a BIGINT");
+          }
+          Store(state, sum);
+        }
+        break;
+      case AggregationType::MinAggregate:
+        if (decimal_states_[i]) {
+          Store(state, *seen != 0 ? std::min(Load<double>(state), input.GetAs<double>()) : input.GetAs<double>());
+        } else {
+          Store(state, *seen != 0 ? std::min(Load<int64_t>(state), AsInteger(input)) : AsInteger(input));
+        }
+        break;
+      case AggregationType::MaxAggregate:
+        if (decimal_states_[i]) {
+          Store(state, *seen != 0 ? std::max(Load<double>(state), input.GetAs<double>()) : input.GetAs<double>());
+        } else {
+          Store(state, *seen != 0 ? std::max(Load<int64_t>(state), AsInteger(input)) : AsInteger(input));
+        }
+        break;
+      case AggregationType::ApproxCountDistinctAggregate:
+        SketchOf(state, seen, &distinct_sketches_)->Add(HyperLogLog::HashValue(input));
+        break;
+      case AggregationType::ApproxPercentileAggregate:
+        SketchOf(state, seen, &quantile_sketches_)
+            ->Insert(input.GetTypeId() == TypeId::DECIMAL ? input.GetAs<double>()
+                                                          : static_cast<double>(AsInteger(input)));
+        break;
+    }
+    *seen |= SEEN;
+  }
+  return true;
+}
+
+hash_t SimpleAggregationHashTable::HashKey(const char *key) const {
+  // the fixed-width part of the key is hashed as one run of words, and each VARCHAR by its bytes
+  hash_t hash = HashUtil::HashBytes(key, fixed_key_size_);
+  for (size_t offset = fixed_key_size_; offset < key_size_; offset += sizeof(VarcharSlot)) {
+    auto slot = Load<VarcharSlot>(key + offset);
+    hash = HashUtil::MixWord(hash, slot.length_ == BUSTUB_VALUE_NULL ? HashUtil::NULL_HASH
+                                                                      : HashUtil::HashBytes(slot.data_, slot.length_));
+  }
+  return HashUtil::Finish(hash);
+}
+
+bool SimpleAggregationHashTable::KeyEquals(const char *record) const {
+  const char *key = reinterpret_cast<const char *>(key_.data());
+  if (memcmp(record, key, fixed_key_size_) != 0) {
+    return false;
+  }
+  for (size_t offset = fixed_key_size_; offset < key_size_; offset += sizeof(VarcharSlot)) {
+    auto left = Load<VarcharSlot>(record + offset);
+    auto right = Load<VarcharSlot>(key + offset);
+    if (left.length_ != right.length_ ||
+        (left.length_ != BUSTUB_VALUE_NULL && memcmp(left.data_, right.data_, left.length_) != 0)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+char *SimpleAggregationHashTable::FindOrInsert(bool insert) {
+  if (insert && (size_ + 1) * 2 > slots_.size()) {
+    Grow();
+  }
+  last_hash_ = HashKey(reinterpret_cast<const char *>(key_.data()));
+  auto hash = static_cast<uint32_t>(last_hash_);
+  const size_t mask = slots_.size() - 1;
+  for (size_t pos = hash & mask;; pos = (pos + 1) & mask) {
+    uint64_t slot = slots_[pos];
+    if (slot == 0) {
+      if (!insert) {
+        return nullptr;
+      }
+      // a new group: its key, with its VARCHARs copied, and the states of no inputs
+      records_.resize(records_.size() + record_size_ / sizeof(uint64_t), 0);
+      char *record = Record(size_);
+      memcpy(record, key_.data(), key_size_);
+      for (size_t offset = fixed_key_size_; offset < key_size_; offset += sizeof(VarcharSlot)) {
+        auto varchar = Load<VarcharSlot>(record + offset);
+        if (varchar.length_ != BUSTUB_VALUE_NULL) {
+          char *data = strings_.Allocate(varchar.length_, 1);
+          memcpy(data, varchar.data_, varchar.length_);
+          varchar.data_ = data;
+          Store(record + offset, varchar);
+        }
+      }
+      slots_[pos] = (static_cast<uint64_t>(hash) << 32) | (size_ + 1);
+      return Record(size_++);
+    }
+    if (static_cast<uint32_t>(slot >> 32) == hash) {
+      char *record = Record(static_cast<uint32_t>(slot) - 1);
+      if (KeyEquals(record)) {
+        return record;
+      }
+    }
+  }
+}
+
+void SimpleAggregationHashTable::Grow() {
+  std::vector<uint64_t> slots(slots_.size() * 2, 0);
+  const size_t mask = slots.size() - 1;
+  for (uint64_t slot : slots_) {
+    if (slot == 0) {
+      continue;
+    }
+    size_t pos = (slot >> 32) & mask;
+    while (slots[pos] != 0) {
+      pos = (pos + 1) & mask;
+    }
+    slots[pos] = slot;
+  }
+  slots_ = std::move(slots);
+}
+
+Value SimpleAggregationHashTable::GetGroupBy(const char *record, uint32_t idx) const {
+  if (group_by_types_[idx] != TypeId::VARCHAR) {
+    return LoadFixed(record + group_by_offsets_[idx], group_by_types_[idx]);
+  }
+  auto slot = Load<VarcharSlot>(record + group_by_offsets_[idx]);
+  if (slot.length_ == BUSTUB_VALUE_NULL) {
+    return ValueFactory::GetNullValueByType(TypeId::VARCHAR);
+  }
+  return Value(TypeId::VARCHAR, slot.data_, slot.length_, true);
+}
+
+TypeId SimpleAggregationHashTable::GetAggregateType(uint32_t idx) const {
+  TypeId input_type = agg_exprs_[idx]->GetReturnType();
+  if (agg_types_[idx] == AggregationType::CountAggregate ||
+      agg_types_[idx] == AggregationType::ApproxCountDistinctAggregate) {
+    return TypeId::INTEGER;
+  }
+  if (input_type == TypeId::DECIMAL || input_type == TypeId::BIGINT) {
+    return input_type;
+  }
+  if (input_type == TypeId::TIMESTAMP) {
+    return agg_types_[idx] == AggregationType::SumAggregate ? TypeId::BIGINT : input_type;
+  }
+  return TypeId::INTEGER;
+}
+
+Value SimpleAggregationHashTable::GetAggregate(const char *record, uint32_t idx) const {
+  const char *state = record + states_offset_ + idx * sizeof(int64_t);
+  TypeId type = GetAggregateType(idx);
+  bool seen = record[flags_offset_ + idx] != 0;
+  if (agg_types_[idx] == AggregationType::ApproxCountDistinctAggregate) {
+    return IntegerAs(seen ? std::llround(distinct_sketches_[Load<int64_t>(state)]->Estimate()) : 0, type);
+  }
+  if (agg_types_[idx] != AggregationType::CountAggregate && !seen) {
+    return ValueFactory::GetNullValueByType(type);
+  }
+  if (agg_types_[idx] == AggregationType::ApproxPercentileAggregate) {
+    double quantile = quantile_sketches_[Load<int64_t>(state)]->Quantile(percentiles_[idx]);
+    return type == TypeId::DECIMAL ? Value(type, quantile) : IntegerAs(std::llround(quantile), type);
+  }
+  if (decimal_states_[idx] && agg_types_[idx] == AggregationType::SumAggregate) {
+    return Value(TypeId::DECIMAL, DecimalSumAsDouble(state, record[flags_offset_ + idx]));
+  }
+  if (decimal_states_[idx]) {
+    return Value(TypeId::DECIMAL, Load<double>(state));
+  }
+  return IntegerAs(Load<int64_t>(state), type);
+}
+
+AggregateKey SimpleAggregationHashTable::Iterator::Key() const {
+  std::vector<Value> group_bys;
+  group_bys.reserve(table_->group_by_types_.size());
+  for (uint32_t i = 0; i < table_->group_by_types_.size(); i++) {
+    group_bys.push_back(table_->GetGroupBy(table_->Record(index_), i));
+  }
+  return {group_bys};
+}
+
+AggregateValue SimpleAggregationHashTable::Iterator::Val() const {
+  std::vector<Value> aggregates;
+  aggregates.reserve(table_->agg_types_.size());
+  for (uint32_t i = 0; i < table_->agg_types_.size(); i++) {
+    aggregates.push_back(table_->GetAggregate(table_->Record(index_), i));
+  }
+  return {aggregates};
+}
+
+AggregationExecutor::AggregationExecutor(ExecutorContext *exec_ctx, const AggregationPlanNode *plan,
+                                         std::unique_ptr<AbstractExecutor> &&child)
+    : AbstractExecutor(exec_ctx),
+      plan_(plan),
+      child_(std::move(child)),
+      aht_(plan->GetGroupBys(), plan->GetAggregates(), plan->GetAggregateTypes(), plan->GetPercentiles()),
+      table_(&aht_),
+      aht_iterator_(aht_.Begin()),
+      memory_(exec_ctx, MemoryCategory::AGGREGATION) {}
+
+const AbstractExecutor *AggregationExecutor::GetChildExecutor() const { return child_.get(); }
+
+size_t AggregationExecutor::PartitionOf(hash_t hash, uint32_t depth, size_t num_partitions) {
+  // the table places the groups by the same hash, so it is mixed with the depth
+  return HashUtil::Finish(hash + (depth + 1) * HashUtil::HASH_MULTIPLIER) % num_partitions;
+}
+
+void AggregationExecutor::Aggregate(TmpTupleList *input, uint32_t depth) {
+  aht_.Clear();
+  memory_.Resize(0);
+  std::vector<std::unique_ptr<TmpTupleList>> spills;
+  // a row goes into its group, until the table outgrows the budget; then it goes into its group if that is there
+  auto aggregate = [&](auto &&insert_combine, auto &&combine_existing, auto &&make_tuple) {
+    if (spills.empty()) {
+      insert_combine();
+      if (!memory_.Resize(aht_.GetMemoryUsage()) && depth < MAX_DEPTH) {
+        for (size_t i = 0; i < NUM_PARTITIONS; i++) {
+          spills.push_back(
+              std::make_unique<TmpTupleList>(exec_ctx_->GetBufferPoolManager(), exec_ctx_->GetSpillCounter()));
+        }
+      }
+    } else if (!combine_existing()) {
+      spills[PartitionOf(aht_.GetLastHash(), depth)]->Append(make_tuple());
+    }
+  };
+
+  if (input != nullptr) {
+    const Schema *schema = child_->GetOutputSchema();
+    TmpTupleList::Reader reader(input);
+    Tuple tuple;
+    while (reader.Next(&tuple)) {
+      aggregate([&] { aht_.InsertCombine(tuple, schema); }, [&] { return aht_.CombineExisting(tuple, schema); },
+                [&]() -> const Tuple & { return tuple; });
+    }
+  } else {
+    DataChunk chunk(child_->GetOutputSchema());
+    while (child_->NextBatch(&chunk)) {
+      for (size_t i = 0; i < chunk.GetSelectedCount(); i++) {
+        uint32_t row = chunk.GetSelectedRow(i);
+        aggregate([&] { aht_.InsertCombine(chunk, row); }, [&] { return aht_.CombineExisting(chunk, row); },
+                  [&] { return chunk.GetTuple(row); });
+      }
+    }
+  }
+  for (auto &spill : spills) {
+    if (spill->GetSize() != 0) {
+      partitions_.push_back({std::move(spill), depth + 1});
+    }
+  }
+  table_ = &aht_;
+  aht_iterator_ = aht_.Begin();
+}
+
+bool AggregationExecutor::AggregateParallel() {
+  const auto *scan_plan = dynamic_cast<const SeqScanPlanNode *>(plan_->GetChildPlan());
+  if (plan_->GetNumThreads() <= 1 || scan_plan == nullptr) {
+    return false;
+  }
+  TableMetadata *table_info = exec_ctx_->GetCatalog()->GetTable(scan_plan->GetTableOid());
+  if (table_info->layout_ != TableLayout::ROW) {
+    return false;
+  }
+  std::vector<TableHeap *> heaps = SeqScanExecutor::ScannedHeaps(table_info, scan_plan->GetPredicate());
+  const size_t num_threads = plan_->GetNumThreads();
+  const size_t num_partitions = num_threads * PARTITIONS_PER_THREAD;
+  // the tables of the workers take half of the budget, which leaves the other half to the tables they merge into
+  const size_t thread_budget = exec_ctx_->GetMemoryBudget() / 2 / num_threads;
+  const Schema *schema = child_->GetOutputSchema();
+  const Schema *table_schema = &table_info->schema_;
+  // the workers read rows of the table, which are rows of the output schema only if it is the table's columns in order
+  bool projects = schema->GetColumnCount() != table_schema->GetColumnCount();
+  for (uint32_t i = 0; !projects && i < schema->GetColumnCount(); i++) {
+    const auto *column = dynamic_cast<const ColumnValueExpression *>(schema->GetColumn(i).GetExpr());
+    projects = schema->GetColumn(i).GetExpr() != nullptr && (column == nullptr || column->GetColIdx() != i);
+  }
+  const AbstractExpression *predicate = scan_plan->GetPredicate();
+  std::unique_ptr<CompiledPredicate> compiled =
+      predicate == nullptr ? nullptr : CompiledPredicate::Compile(predicate, table_schema);
+  auto *bpm = exec_ctx_->GetBufferPoolManager();
+
+  // the workers pre-aggregate the morsels they claim, each into a table of its own
+  PipelineScheduler scheduler(exec_ctx_, num_threads);
+  std::vector<std::unique_ptr<SimpleAggregationHashTable>> local_tables(num_threads);
+  std::vector<std::unique_ptr<BufferAccessStrategy>> strategies(num_threads);
+  std::vector<std::unique_ptr<MemoryReservation>> reservations(num_threads);
+  auto start_thread = [&](size_t thread) {
+    if (local_tables[thread] == nullptr) {
+      local_tables[thread] = std::make_unique<SimpleAggregationHashTable>(
+          plan_->GetGroupBys(), plan_->GetAggregates(), plan_->GetAggregateTypes(), plan_->GetPercentiles());
+      strategies[thread] =
+          std::make_unique<BufferAccessStrategy>(BufferAccessStrategy::BulkRingSize(bpm->GetPoolSize()));
+      reservations[thread] =
+          std::make_unique<MemoryReservation>(exec_ctx_, MemoryCategory::AGGREGATION, thread_budget);
+    }
+  };
+  auto aggregate = [&](size_t thread, TablePageScanner *scanner, ToastStore *toast) {
+    SimpleAggregationHashTable *local = local_tables[thread].get();
+    if (compiled != nullptr) {
+      scanner->SetFilter(compiled->GetFunction());
+    }
+    Tuple view;
+    Tuple detoasted;
+    Tuple projected;
+    std::vector<Value> values;
+    while (scanner->Next(&view)) {
+      const Tuple *row = &view;
+      if (toast != nullptr && toast->IsToasted(view)) {
+        toast->Detoast(view, &detoasted);
+        row = &detoasted;
+      }
+      if (compiled == nullptr && predicate != nullptr && !predicate->Evaluate(row, table_schema).GetAs<bool>()) {
+        continue;
+      }
+      if (projects) {
+        // the group-bys and the aggregates refer to the columns of the scan's output schema, not to the table's
+        values.clear();
+        for (uint32_t i = 0; i < schema->GetColumnCount(); i++) {
+          const AbstractExpression *expr = schema->GetColumn(i).GetExpr();
+          values.push_back(expr != nullptr ? expr->Evaluate(row, table_schema) : row->GetValue(table_schema, i));
+        }
+        projected = Tuple(values, schema);
+        row = &projected;
+      }
+      local->InsertCombine(*row, schema);
+      if (!reservations[thread]->Resize(local->GetMemoryUsage())) {
+        return false;
+      }
+    }
+    return true;
+  };
+  bool fits;
+  if (table_info->partitions_ == nullptr) {
+    fits = scheduler.RunScan(heaps[0], [&](size_t thread, const std::vector<page_id_t> &morsel) {
+      start_thread(thread);
+      TablePageScanner scanner(heaps[0], exec_ctx_->GetTransaction(), morsel, strategies[thread].get());
+      return aggregate(thread, &scanner, heaps[0]->GetToastStore());
+    });
+  } else {
+    // each partition the predicate leaves is a task, which a worker scans whole
+    fits = scheduler.RunTasks(heaps.size(), [&](size_t thread, size_t partition) {
+      start_thread(thread);
+      TablePageScanner scanner(heaps[partition], exec_ctx_->GetTransaction(), strategies[thread].get());
+      return aggregate(thread, &scanner, heaps[partition]->GetToastStore());
+    });
+  }
+  if (!fits) {
+    return false;
+  }
+
+  // the indexes of the groups of every table are sorted into the partitions, and then the workers merge the partial
+  // states of the groups of one partition after the other
+  std::vector<std::vector<std::vector<uint32_t>>> groups(num_threads);
+  scheduler.RunTasks(num_threads, [&](size_t /*thread*/, size_t table_idx) {
+    groups[table_idx].resize(num_partitions);
+    if (local_tables[table_idx] != nullptr) {
+      const SimpleAggregationHashTable &local = *local_tables[table_idx];
+      for (size_t i = 0; i < local.GetSize(); i++) {
+        groups[table_idx][PartitionOf(local.GetHash(i), 0, num_partitions)].push_back(i);
+      }
+    }
+    return true;
+  });
+  parallel_tables_.clear();
+  parallel_tables_.resize(num_partitions);
+  scheduler.RunTasks(num_partitions, [&](size_t /*thread*/, size_t partition) {
+    auto merged = std::make_unique<SimpleAggregationHashTable>(plan_->GetGroupBys(), plan_->GetAggregates(),
+                                                               plan_->GetAggregateTypes(), plan_->GetPercentiles());
+    for (size_t table_idx = 0; table_idx < num_threads; table_idx++) {
+      for (uint32_t index : groups[table_idx][partition]) {
+        merged->Merge(*local_tables[table_idx], index);
+      }
+    }
+    parallel_tables_[partition] = std::move(merged);
+    return true;
+  });
+  return true;
+}
+
+namespace {
+/** The sink of a push pipeline below an aggregation, which takes its rows straight into the aggregation's table */
+class AggregateSink : public PushStage {
+ public:
+  AggregateSink(SimpleAggregationHashTable *table, MemoryReservation *memory) : table_(table), memory_(memory) {}
+
+  bool Consume(DataChunk *chunk) override {
+    for (size_t i = 0; i < chunk->GetSelectedCount(); i++) {
+      table_->InsertCombine(*chunk, chunk->GetSelectedRow(i));
+    }
+    return memory_->Resize(table_->GetMemoryUsage());
+  }
+
+ private:
+  SimpleAggregationHashTable *table_;
+  MemoryReservation *memory_;
+};
+}  // namespace
+
+bool AggregationExecutor::AggregatePushed() {
+  // a scan alone is aggregated a batch at a time as it is, and that spills rather than starts over
+  if (!exec_ctx_->IsPushExecutionEnabled() || plan_->GetChildPlan()->GetType() != PlanType::HashJoin) {
+    return false;
+  }
+  auto pipeline = PushPipeline::Compile(exec_ctx_, plan_->GetChildPlan());
+  if (pipeline == nullptr) {
+    return false;
+  }
+  AggregateSink sink(&aht_, &memory_);
+  if (!pipeline->Run(&sink)) {
+    aht_.Clear();
+    memory_.Resize(0);
+    return false;
+  }
+  return true;
+}
+
+void AggregationExecutor::Init() {
+  partitions_.clear();
+  parallel_tables_.clear();
+  next_table_ = 0;
+  aht_.Clear();
+  memory_.Resize(0);
+  table_ = &aht_;
+  if (!AggregateParallel()) {
+    parallel_tables_.clear();
+    if (!AggregatePushed()) {
+      child_->Init();
+      Aggregate(nullptr, 0);
+    }
+  }
+  bool empty = aht_.GetSize() == 0;
+  for (const auto &parallel_table : parallel_tables_) {
+    empty = empty && parallel_table->GetSize() == 0;
+  }
+  if (empty && plan_->GetGroupBys().empty()) {
+    aht_.InsertEmptyGroup();
+  }
+  aht_iterator_ = aht_.Begin();
+}
+
+bool AggregationExecutor::Next(Tuple *tuple, RID *rid) {
+  while (true) {
+    if (aht_iterator_ == table_->End()) {
+      if (next_table_ < parallel_tables_.size()) {
+        table_ = parallel_tables_[next_table_++].get();
+        aht_iterator_ = table_->Begin();
+        continue;
+      }
+      if (partitions_.empty()) {
+        return false;
+      }
+      Partition partition = std::move(partitions_.back());
+      partitions_.pop_back();
+      Aggregate(partition.tuples_.get(), partition.depth_);
+      continue;
+    }
+    AggregateKey key = aht_iterator_.Key();
+    AggregateValue val = aht_iterator_.Val();
+    ++aht_iterator_;
+    if (plan_->GetHaving() != nullptr) {
+      Value having = plan_->GetHaving()->EvaluateAggregate(key.group_bys_, val.aggregates_);
+      if (having.IsNull() || !having.GetAs<bool>()) {
+        continue;
+      }
+    }
+    std::vector<Value> values;
+    values.reserve(GetOutputSchema()->GetColumnCount());
+    for (const Column &column : GetOutputSchema()->GetColumns()) {
+      Value value = column.GetExpr()->EvaluateAggregate(key.group_bys_, val.aggregates_);
+      if (value.GetTypeId() != column.GetType()) {
+        value = value.IsNull() ? ValueFactory::GetNullValueByType(column.GetType()) : value.CastAs(column.GetType());
+      }
+      values.push_back(std::move(value));
+    }
+    *tuple = Tuple(values, GetOutputSchema());
+    *rid = tuple->GetRid();
+    return true;
+  }
+}
+
+}  // namespace bustub
@@ -0,0 +1,105 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// bitmap_scan_executor.cpp
+//
+// Identification: src/execution/bitmap_scan_executor.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "execution/executors/bitmap_scan_executor.h"
+
+#include <utility>
+#include <vector>
+
+#include "common/exception.h"
+
+namespace bustub {
+
+BitmapScanExecutor::BitmapScanExecutor(ExecutorContext *exec_ctx, const BitmapScanPlanNode *plan)
+    : AbstractExecutor(exec_ctx), plan_(plan) {}
+
+void BitmapScanExecutor::Init() {
+  auto *catalog = GetExecutorContext()->GetCatalog();
+  table_info_ = catalog->GetTable(plan_->GetTableOid());
+  // the rows are locked as by a sequential scan: by one shared lock of the table under REPEATABLE_READ, which keeps
+  // them as they were read, and under SERIALIZABLE, which keeps rows from being inserted as well
+  Transaction *txn = GetExecutorContext()->GetTransaction();
+  LockManager *lock_manager = GetExecutorContext()->GetLockManager();
+  bool locks_table = txn->GetIsolationLevel() == IsolationLevel::REPEATABLE_READ ||
+                     txn->GetIsolationLevel() == IsolationLevel::SERIALIZABLE;
+  if (enable_logging && lock_manager != nullptr && locks_table &&
+      !lock_manager->LockTable(txn, table_info_->oid_, LockMode::SHARED)) {
+    throw TransactionAbortException(txn->GetTransactionId(), AbortReason::DEADLOCK);
+  }
+  rids_.clear();
+  position_ = 0;
+  returned_ = 0;
+
+  RoaringBitmap result;
+  bool first = true;
+  for (const BitmapCondition &condition : plan_->GetConditions()) {
+    IndexInfo *index_info = catalog->GetIndex(condition.index_oid_);
+    auto *index = index_info != nullptr ? dynamic_cast<BitmapIndex *>(index_info->index_.get()) : nullptr;
+    if (index == nullptr || index_info->table_name_ != table_info_->name_) {
+      throw Exception(ExceptionType::INVALID, "a bitmap scan reads bitmap indexes of its table only");
+    }
+    // the keys are looked up by their bytes, so they are made of values of the types of the key columns
+    const Schema *key_schema = index->GetKeySchema();
+    std::vector<Tuple> keys;
+    keys.reserve(condition.keys_.size());
+    for (const std::vector<Value> &key : condition.keys_) {
+      std::vector<Value> values;
+      values.reserve(key.size());
+      for (uint32_t i = 0; i < key.size(); i++) {
+        values.push_back(key[i].CastAs(key_schema->GetColumn(i).GetType()));
+      }
+      keys.emplace_back(std::move(values), key_schema);
+    }
+    RoaringBitmap bitmap = index->GetBitmap(keys);
+    if (first) {
+      result = std::move(bitmap);
+      first = false;
+    } else {
+      result.IntersectWith(bitmap);
+    }
+    if (result.IsEmpty()) {
+      break;
+    }
+  }
+  if (first) {
+    throw Exception(ExceptionType::INVALID, "a bitmap scan has a condition at least");
+  }
+  rids_ = result.ToVector();
+}
+
+bool BitmapScanExecutor::Next(Tuple *tuple, RID *rid) {
+  const Schema *output_schema = GetOutputSchema();
+  Transaction *txn = GetExecutorContext()->GetTransaction();
+  while (returned_ < row_limit_ && position_ < rids_.size()) {
+    RID row_rid = BitmapIndex::ToRid(rids_[position_++]);
+    Tuple row;
+    if (!table_info_->GetTuple(row_rid, &row, txn)) {
+      continue;
+    }
+    if (plan_->GetPredicate() != nullptr &&
+        !plan_->GetPredicate()->Evaluate(&row, &table_info_->schema_).GetAs<bool>()) {
+      continue;
+    }
+    std::vector<Value> values;
+    values.reserve(output_schema->GetColumnCount());
+    for (const Column &column : output_schema->GetColumns()) {
+      values.push_back(column.GetExpr()->Evaluate(&row, &table_info_->schema_));
+    }
+    *tuple = Tuple(values, output_schema, GetExecutorContext()->GetArena());
+    *rid = row_rid;
+    returned_++;
+    return true;
+  }
+  return false;
+}
+
+}  // namespace bustub
@@ -0,0 +1,242 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// compiled_predicate.cpp
+//
+// Identification: src/execution/compiled_predicate.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "execution/compiled_predicate.h"
+
+#include <algorithm>
+#include <cstring>
+#include <functional>
+#include <optional>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "execution/expressions/column_value_expression.h"
+#include "execution/expressions/comparison_expression.h"
+#include "execution/expressions/conjunction_expression.h"
+#include "execution/expressions/constant_value_expression.h"
+#include "execution/expressions/parameter_value_expression.h"
+
+namespace bustub {
+
+namespace {
+
+/** Where a column is in the tuples of a schema */
+struct ColumnSlot {
+  uint32_t offset_;
+  /** The byte of the null bitmap the column's bit is in, counted back from the end of the tuple */
+  uint32_t null_byte_from_end_;
+  char null_mask_;
+};
+
+/** An operand of a comparison: a column, or the constant value_ if type_ is INVALID */
+struct Operand {
+  TypeId type_{TypeId::INVALID};
+  ColumnSlot slot_{};
+  Value value_;
+};
+
+/** Reads a column of the C++ type T into a value of the type N the comparison is made in; false if it is NULL */
+template <typename T, typename N>
+inline bool Load(const char *data, uint32_t length, const ColumnSlot &slot, N *value) {
+  if ((data[length - slot.null_byte_from_end_] & slot.null_mask_) != 0) {
+    return false;
+  }
+  T raw;
+  memcpy(&raw, data + slot.offset_, sizeof(T));
+  *value = static_cast<N>(raw);
+  return true;
+}
+
+template <typename N>
+using Loader = bool (*)(const char *, uint32_t, const ColumnSlot &, N *);
+
+template <typename N>
+Loader<N> LoaderOf(TypeId type) {
+  switch (type) {
+    case TypeId::TINYINT:
+      return Load<int8_t, N>;
+    case TypeId::SMALLINT:
+      return Load<int16_t, N>;
+    case TypeId::INTEGER:
+      return Load<int32_t, N>;
+    case TypeId::BIGINT:
+      return Load<int64_t, N>;
+    default:
+      return Load<double, N>;
+  }
+}
+
+/** column op constant, with the type of the column built in */
+template <typename Op, typename T, typename N>
+CompiledPredicate::Function ColumnConstant(ColumnSlot slot, N constant) {
+  return [slot, constant](const Tuple &tuple) {
+    N value;
+    return Load<T, N>(tuple.GetData(), tuple.GetLength(), slot, &value) && Op{}(value, constant);
+  };
+}
+
+/** column op column, which reads the columns through the loaders of their types */
+template <typename Op, typename N>
+CompiledPredicate::Function ColumnColumn(const Operand &left, const Operand &right) {
+  return [load_left = LoaderOf<N>(left.type_), left_slot = left.slot_, load_right = LoaderOf<N>(right.type_),
+          right_slot = right.slot_](const Tuple &tuple) {
+    N x;
+    N y;
+    const char *data = tuple.GetData();
+    uint32_t length = tuple.GetLength();
+    return load_left(data, length, left_slot, &x) && load_right(data, length, right_slot, &y) && Op{}(x, y);
+  };
+}
+
+/** @return the closure of (left op right), where left is a column */
+template <typename Op, typename N>
+CompiledPredicate::Function Bind(const Operand &left, const Operand &right) {
+  if (right.type_ != TypeId::INVALID) {
+    return ColumnColumn<Op, N>(left, right);
+  }
+  Value cast = right.value_.CastAs(std::is_integral_v<N> ? TypeId::BIGINT : TypeId::DECIMAL);
+  N constant = cast.GetAs<N>();
+  switch (left.type_) {
+    case TypeId::TINYINT:
+      return ColumnConstant<Op, int8_t, N>(left.slot_, constant);
+    case TypeId::SMALLINT:
+      return ColumnConstant<Op, int16_t, N>(left.slot_, constant);
+    case TypeId::INTEGER:
+      return ColumnConstant<Op, int32_t, N>(left.slot_, constant);
+    case TypeId::BIGINT:
+      return ColumnConstant<Op, int64_t, N>(left.slot_, constant);
+    default:
+      return ColumnConstant<Op, double, N>(left.slot_, constant);
+  }
+}
+
+template <typename N>
+CompiledPredicate::Function BindComparison(ComparisonType comp_type, const Operand &left, const Operand &right) {
+  switch (comp_type) {
+    case ComparisonType::Equal:
+      return Bind<std::equal_to<>, N>(left, right);
+    case ComparisonType::NotEqual:
+      return Bind<std::not_equal_to<>, N>(left, right);
+    case ComparisonType::LessThan:
+      return Bind<std::less<>, N>(left, right);
+    case ComparisonType::LessThanOrEqual:
+      return Bind<std::less_equal<>, N>(left, right);
+    case ComparisonType::GreaterThan:
+      return Bind<std::greater<>, N>(left, right);
+    case ComparisonType::GreaterThanOrEqual:
+      return Bind<std::greater_equal<>, N>(left, right);
+  }
+  return nullptr;
+}
+
+/** @return the comparison of (right comp_type left) that is the same as (left comp_type right) */
+ComparisonType Mirror(ComparisonType comp_type) {
+  switch (comp_type) {
+    case ComparisonType::LessThan:
+      return ComparisonType::GreaterThan;
+    case ComparisonType::LessThanOrEqual:
+      return ComparisonType::GreaterThanOrEqual;
+    case ComparisonType::GreaterThan:
+      return ComparisonType::LessThan;
+    case ComparisonType::GreaterThanOrEqual:
+      return ComparisonType::LessThanOrEqual;
+    default:
+      return comp_type;
+  }
+}
+
+bool IsNumeric(TypeId type) {
+  return type == TypeId::TINYINT || type == TypeId::SMALLINT || type == TypeId::INTEGER || type == TypeId::BIGINT ||
+         type == TypeId::DECIMAL;
+}
+
+/** @return the operand of an expression, if it is a numeric column of the schema or a numeric constant */
+std::optional<Operand> OperandOf(const AbstractExpression *expr, const Schema *schema) {
+  Operand operand;
+  if (const auto *column = dynamic_cast<const ColumnValueExpression *>(expr); column != nullptr) {
+    uint32_t col_idx = column->GetColIdx();
+    if (column->GetTupleIdx() != 0 || col_idx >= schema->GetColumnCount() || !IsNumeric(schema->GetType(col_idx))) {
+      return std::nullopt;
+    }
+    operand.type_ = schema->GetType(col_idx);
+    operand.slot_ = {schema->GetOffset(col_idx), Tuple::NullBitmapSize(schema) - col_idx / 8,
+                     static_cast<char>(1 << (col_idx % 8))};
+    return operand;
+  }
+  // a parameter is a constant for as long as the predicate compiled with its value is used, i.e. a run of the plan
+  if (dynamic_cast<const ConstantValueExpression *>(expr) != nullptr ||
+      dynamic_cast<const ParameterValueExpression *>(expr) != nullptr) {
+    operand.value_ = expr->Evaluate(nullptr, nullptr);
+    if (!IsNumeric(operand.value_.GetTypeId())) {
+      return std::nullopt;
+    }
+    return operand;
+  }
+  return std::nullopt;
+}
+
+}  // namespace
+
+std::unique_ptr<CompiledPredicate> CompiledPredicate::Compile(const AbstractExpression *predicate,
+                                                              const Schema *schema) {
+  if (const auto *conjunction = dynamic_cast<const ConjunctionExpression *>(predicate); conjunction != nullptr) {
+    std::vector<Function> functions;
+    for (const AbstractExpression *child : conjunction->GetChildren()) {
+      std::unique_ptr<CompiledPredicate> compiled = Compile(child, schema);
+      if (compiled == nullptr) {
+        return nullptr;
+      }
+      functions.push_back(std::move(compiled->function_));
+    }
+    return std::unique_ptr<CompiledPredicate>(new CompiledPredicate([functions](const Tuple &tuple) {
+      return std::all_of(functions.begin(), functions.end(), [&tuple](const Function &function) {
+        return function(tuple);
+      });
+    }));
+  }
+  const auto *comparison = dynamic_cast<const ComparisonExpression *>(predicate);
+  if (comparison == nullptr) {
+    return nullptr;
+  }
+  std::optional<Operand> left = OperandOf(comparison->GetChildAt(0), schema);
+  std::optional<Operand> right = OperandOf(comparison->GetChildAt(1), schema);
+  if (!left.has_value() || !right.has_value()) {
+    return nullptr;
+  }
+  ComparisonType comp_type = comparison->GetComparisonType();
+  if (left->type_ == TypeId::INVALID) {
+    if (right->type_ == TypeId::INVALID) {
+      // a comparison of two constants is folded into its result
+      Value result = comparison->Evaluate(nullptr, nullptr);
+      bool holds = !result.IsNull() && result.GetAs<bool>();
+      return std::unique_ptr<CompiledPredicate>(
+          new CompiledPredicate([holds](const Tuple & /*tuple*/) { return holds; }));
+    }
+    // a constant on the left is moved to the right
+    std::swap(left, right);
+    comp_type = Mirror(comp_type);
+  }
+  if (right->type_ == TypeId::INVALID && right->value_.IsNull()) {
+    // nothing compares with a NULL
+    return std::unique_ptr<CompiledPredicate>(
+        new CompiledPredicate([](const Tuple & /*tuple*/) { return false; }));
+  }
+
+  TypeId right_type = right->type_ == TypeId::INVALID ? right->value_.GetTypeId() : right->type_;
+  Function function = left->type_ == TypeId::DECIMAL || right_type == TypeId::DECIMAL
+                          ? BindComparison<double>(comp_type, *left, *right)
+                          : BindComparison<int64_t>(comp_type, *left, *right);
+  return std::unique_ptr<CompiledPredicate>(new CompiledPredicate(std::move(function)));
+}
+
+}  // namespace bustub
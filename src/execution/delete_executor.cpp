@@ -10,6 +10,10 @@
 //
 //===----------------------------------------------------------------------===//
 #include <memory>
+#include <memory>
+#include <unordered_map>
+#include <utility>
+#include <vector>
 
 #include "execution/executors/delete_executor.h"
 
@@ -17,10 +21,79 @@ namespace bustub {
 
 DeleteExecutor::DeleteExecutor(ExecutorContext *exec_ctx, const DeletePlanNode *plan,
                                std::unique_ptr<AbstractExecutor> &&child_executor)
-    : AbstractExecutor(exec_ctx) {}
+    : AbstractExecutor(exec_ctx), plan_(plan), child_executor_(std::move(child_executor)) {}
+
+void DeleteExecutor::Init() {
+  auto *catalog = GetExecutorContext()->GetCatalog();
+  table_info_ = catalog->GetTable(plan_->TableOid());
+  index_updates_ = std::make_unique<IndexUpdateBuffer>(GetExecutorContext(), table_info_);
+  child_executor_->Init();
+}
 
-void DeleteExecutor::Init() {}
+bool DeleteExecutor::Next([[maybe_unused]] Tuple *tuple, RID *rid) {
+  // the tuples are only kept for the index keys, even of a table without indexes, as one may be created meanwhile
+  std::vector<Tuple> batch;
+  std::vector<RID> rids;
+  Tuple t;
+  RID r;
+  while (rids.size() < BATCH_SIZE && child_executor_->Next(&t, &r)) {
+    rids.push_back(r);
+    if (t.IsAllocated()) {
+      batch.push_back(std::move(t));
+    } else {
+      batch.emplace_back().CopyFrom(t);
+    }
+  }
+  if (rids.empty() || !DeleteBatch(rids)) {
+    index_updates_->Flush();
+    return false;
+  }
+  for (size_t i = 0; i < rids.size(); i++) {
+    index_updates_->Delete(batch[i], rids[i]);
+  }
+  *rid = rids.back();
+  return true;
+}
 
-bool DeleteExecutor::Next([[maybe_unused]] Tuple *tuple, RID *rid) { return false; }
+bool DeleteExecutor::DeleteBatch(const std::vector<RID> &rids) {
+  Transaction *txn = GetExecutorContext()->GetTransaction();
+  if (table_info_->layout_ == TableLayout::PAX) {
+    for (const RID &delete_rid : rids) {
+      if (!table_info_->pax_table_->MarkDelete(delete_rid, txn)) {
+        return false;
+      }
+    }
+  } else if (table_info_->layout_ == TableLayout::MEMORY) {
+    for (const RID &delete_rid : rids) {
+      if (!table_info_->memory_table_->MarkDelete(delete_rid, txn)) {
+        return false;
+      }
+    }
+  } else if (table_info_->layout_ == TableLayout::CLUSTERED) {
+    for (const RID &delete_rid : rids) {
+      if (!table_info_->clustered_table_->MarkDelete(delete_rid, txn)) {
+        return false;
+      }
+    }
+  } else if (table_info_->partitions_ != nullptr) {
+    // the rows of each partition are marked in its heap, as a batch
+    std::unordered_map<TableHeap *, std::vector<RID>> partition_rids;
+    for (const RID &delete_rid : rids) {
+      TableHeap *heap = table_info_->partitions_->HeapOf(delete_rid);
+      if (heap == nullptr) {
+        return false;
+      }
+      partition_rids[heap].push_back(delete_rid);
+    }
+    for (const auto &[heap, heap_rids] : partition_rids) {
+      if (!heap->MarkDeletes(heap_rids, txn)) {
+        return false;
+      }
+    }
+  } else if (!table_info_->table_->MarkDeletes(rids, txn)) {
+    return false;
+  }
+  return true;
+}
 
 }  // namespace bustub
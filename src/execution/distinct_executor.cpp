@@ -0,0 +1,116 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// distinct_executor.cpp
+//
+// Identification: src/execution/distinct_executor.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "execution/executors/distinct_executor.h"
+
+#include <memory>
+#include <utility>
+
+namespace bustub {
+
+DistinctExecutor::DistinctExecutor(ExecutorContext *exec_ctx, const DistinctPlanNode *plan,
+                                   std::unique_ptr<AbstractExecutor> &&child)
+    : AbstractExecutor(exec_ctx),
+      plan_(plan),
+      child_(std::move(child)),
+      memory_(exec_ctx, MemoryCategory::AGGREGATION) {}
+
+DistinctKey DistinctExecutor::MakeKey(const Tuple &tuple) {
+  const Schema *schema = child_->GetOutputSchema();
+  DistinctKey key;
+  key.values_.reserve(schema->GetColumnCount());
+  for (uint32_t i = 0; i < schema->GetColumnCount(); i++) {
+    key.values_.push_back(tuple.GetValue(schema, i));
+  }
+  return key;
+}
+
+size_t DistinctExecutor::EntryBytes(const DistinctKey &key) {
+  size_t bytes = sizeof(DistinctKey) + 2 * sizeof(void *) + key.values_.capacity() * sizeof(Value);
+  for (const auto &value : key.values_) {
+    if (!value.IsNull() && value.GetTypeId() == TypeId::VARCHAR) {
+      bytes += value.GetLength();
+    }
+  }
+  return bytes;
+}
+
+void DistinctExecutor::ClearSet() {
+  set_.clear();
+  set_bytes_ = 0;
+  memory_.Resize(0);
+}
+
+void DistinctExecutor::Init() {
+  child_->Init();
+  ClearSet();
+  child_done_ = false;
+  partitions_.clear();
+  next_partition_ = 0;
+  reader_.reset();
+}
+
+bool DistinctExecutor::Next(Tuple *tuple, RID *rid) {
+  while (!child_done_) {
+    if (!child_->Next(tuple, rid)) {
+      child_done_ = true;
+      break;
+    }
+    DistinctKey key = MakeKey(*tuple);
+    if (set_.count(key) != 0) {
+      continue;
+    }
+    size_t bytes = EntryBytes(key);
+    if (partitions_.empty() && memory_.Resize(set_bytes_ + bytes)) {
+      set_bytes_ += bytes;
+      set_.insert(std::move(key));
+      return true;
+    }
+    // the set is full, and stays as it is, so that a tuple not in it now never is
+    if (partitions_.empty()) {
+      for (size_t i = 0; i < NUM_PARTITIONS; i++) {
+        partitions_.push_back(
+            std::make_unique<TmpTupleList>(exec_ctx_->GetBufferPoolManager(), exec_ctx_->GetSpillCounter()));
+      }
+    }
+    partitions_[std::hash<DistinctKey>()(key) % NUM_PARTITIONS]->Append(*tuple);
+  }
+
+  while (true) {
+    if (reader_.has_value() && reader_->Next(tuple)) {
+      DistinctKey key = MakeKey(*tuple);
+      if (set_.count(key) != 0) {
+        continue;
+      }
+      // a list is deduplicated in memory whatever its size, the reservation only accounts for it
+      set_bytes_ += EntryBytes(key);
+      memory_.Resize(set_bytes_);
+      set_.insert(std::move(key));
+      *rid = tuple->GetRid();
+      return true;
+    }
+    if (next_partition_ == partitions_.size()) {
+      reader_.reset();
+      ClearSet();
+      return false;
+    }
+    // the tuples of the next list are in neither the first set nor the one of another list
+    ClearSet();
+    reader_.reset();
+    if (next_partition_ != 0) {
+      partitions_[next_partition_ - 1].reset();
+    }
+    reader_.emplace(partitions_[next_partition_++].get());
+  }
+}
+
+}  // namespace bustub
@@ -14,15 +14,27 @@
 
 #include <memory>
 #include <utility>
+
+#include "common/tracer.h"
 #include "execution/executors/abstract_executor.h"
 #include "execution/executors/aggregation_executor.h"
+#include "execution/executors/bitmap_scan_executor.h"
 #include "execution/executors/delete_executor.h"
+#include "execution/executors/distinct_executor.h"
+#include "execution/executors/hash_join_executor.h"
 #include "execution/executors/index_scan_executor.h"
 #include "execution/executors/insert_executor.h"
 #include "execution/executors/limit_executor.h"
+#include "execution/executors/merge_join_executor.h"
 #include "execution/executors/nested_index_join_executor.h"
 #include "execution/executors/nested_loop_join_executor.h"
+#include "execution/executors/profiling_executor.h"
+#include "execution/executors/projection_executor.h"
+#include "execution/executors/sample_scan_executor.h"
 #include "execution/executors/seq_scan_executor.h"
+#include "execution/executors/sort_executor.h"
+#include "execution/executors/topn_executor.h"
+#include "execution/executors/tracing_executor.h"
 #include "execution/executors/update_executor.h"
 #include "storage/index/generic_key.h"
 
@@ -30,16 +42,37 @@ namespace bustub {
 
 std::unique_ptr<AbstractExecutor> ExecutorFactory::CreateExecutor(ExecutorContext *exec_ctx,
                                                                   const AbstractPlanNode *plan) {
+  std::unique_ptr<AbstractExecutor> executor = MakeExecutor(exec_ctx, plan);
+  // the checks are all that the profiling and the tracing cost a query that is neither profiled nor traced
+  if (exec_ctx->GetProfile() != nullptr) {
+    executor = std::make_unique<ProfilingExecutor>(exec_ctx, plan, std::move(executor));
+  }
+  if (Tracer::IsEnabled()) {
+    executor = std::make_unique<TracingExecutor>(exec_ctx, plan, std::move(executor));
+  }
+  return executor;
+}
+
+std::unique_ptr<AbstractExecutor> ExecutorFactory::MakeExecutor(ExecutorContext *exec_ctx,
+                                                                const AbstractPlanNode *plan) {
   switch (plan->GetType()) {
     // Create a new sequential scan executor.
     case PlanType::SeqScan: {
       return std::make_unique<SeqScanExecutor>(exec_ctx, dynamic_cast<const SeqScanPlanNode *>(plan));
     }
 
+    case PlanType::SampleScan: {
+      return std::make_unique<SampleScanExecutor>(exec_ctx, dynamic_cast<const SampleScanPlanNode *>(plan));
+    }
+
     case PlanType::IndexScan: {
       return std::make_unique<IndexScanExecutor>(exec_ctx, dynamic_cast<const IndexScanPlanNode *>(plan));
     }
 
+    case PlanType::BitmapScan: {
+      return std::make_unique<BitmapScanExecutor>(exec_ctx, dynamic_cast<const BitmapScanPlanNode *>(plan));
+    }
+
     // Create a new insert executor.
     case PlanType::Insert: {
       auto insert_plan = dynamic_cast<const InsertPlanNode *>(plan);
@@ -62,6 +95,12 @@ std::unique_ptr<AbstractExecutor> ExecutorFactory::CreateExecutor(ExecutorContex
 
     case PlanType::Limit: {
       auto limit_plan = dynamic_cast<const LimitPlanNode *>(plan);
+      // a limit over a sort keeps just the tuples it returns
+      if (limit_plan->GetChildPlan()->GetType() == PlanType::Sort) {
+        auto sort_plan = dynamic_cast<const SortPlanNode *>(limit_plan->GetChildPlan());
+        auto child_executor = ExecutorFactory::CreateExecutor(exec_ctx, sort_plan->GetChildPlan());
+        return std::make_unique<TopNExecutor>(exec_ctx, limit_plan, sort_plan, std::move(child_executor));
+      }
       auto child_executor = ExecutorFactory::CreateExecutor(exec_ctx, limit_plan->GetChildPlan());
       return std::make_unique<LimitExecutor>(exec_ctx, limit_plan, std::move(child_executor));
     }
@@ -87,6 +126,38 @@ std::unique_ptr<AbstractExecutor> ExecutorFactory::CreateExecutor(ExecutorContex
       return std::make_unique<NestIndexJoinExecutor>(exec_ctx, nested_index_join_plan, std::move(left));
     }
 
+    case PlanType::HashJoin: {
+      auto hash_join_plan = dynamic_cast<const HashJoinPlanNode *>(plan);
+      auto left = ExecutorFactory::CreateExecutor(exec_ctx, hash_join_plan->GetLeftPlan());
+      auto right = ExecutorFactory::CreateExecutor(exec_ctx, hash_join_plan->GetRightPlan());
+      return std::make_unique<HashJoinExecutor>(exec_ctx, hash_join_plan, std::move(left), std::move(right));
+    }
+
+    case PlanType::MergeJoin: {
+      auto merge_join_plan = dynamic_cast<const MergeJoinPlanNode *>(plan);
+      auto left = ExecutorFactory::CreateExecutor(exec_ctx, merge_join_plan->GetLeftPlan());
+      auto right = ExecutorFactory::CreateExecutor(exec_ctx, merge_join_plan->GetRightPlan());
+      return std::make_unique<MergeJoinExecutor>(exec_ctx, merge_join_plan, std::move(left), std::move(right));
+    }
+
+    case PlanType::Sort: {
+      auto sort_plan = dynamic_cast<const SortPlanNode *>(plan);
+      auto child_executor = ExecutorFactory::CreateExecutor(exec_ctx, sort_plan->GetChildPlan());
+      return std::make_unique<SortExecutor>(exec_ctx, sort_plan, std::move(child_executor));
+    }
+
+    case PlanType::Projection: {
+      auto projection_plan = dynamic_cast<const ProjectionPlanNode *>(plan);
+      auto child_executor = ExecutorFactory::CreateExecutor(exec_ctx, projection_plan->GetChildPlan());
+      return std::make_unique<ProjectionExecutor>(exec_ctx, projection_plan, std::move(child_executor));
+    }
+
+    case PlanType::Distinct: {
+      auto distinct_plan = dynamic_cast<const DistinctPlanNode *>(plan);
+      auto child_executor = ExecutorFactory::CreateExecutor(exec_ctx, distinct_plan->GetChildPlan());
+      return std::make_unique<DistinctExecutor>(exec_ctx, distinct_plan, std::move(child_executor));
+    }
+
     default: {
       BUSTUB_ASSERT(false, "Unsupported plan type.");
     }
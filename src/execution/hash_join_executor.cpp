@@ -0,0 +1,591 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// hash_join_executor.cpp
+//
+// Identification: src/execution/hash_join_executor.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "execution/executors/hash_join_executor.h"
+
+#include <algorithm>
+#include <atomic>
+
+#include "execution/executors/profiling_executor.h"
+#include "execution/executors/seq_scan_executor.h"
+#include "execution/expressions/column_value_expression.h"
+#include "execution/pipeline_scheduler.h"
+
+namespace bustub {
+
+namespace {
+
+// the finalizer of MurmurHash3, which spreads the bits of a hash over all of its bits
+uint64_t Mix(uint64_t hash) {
+  hash = (hash ^ (hash >> 33)) * 0xff51afd7ed558ccdULL;
+  hash = (hash ^ (hash >> 33)) * 0xc4ceb9fe1a85ec53ULL;
+  return hash ^ (hash >> 33);
+}
+
+}  // namespace
+
+HashJoinExecutor::HashJoinExecutor(ExecutorContext *exec_ctx, const HashJoinPlanNode *plan,
+                                   std::unique_ptr<AbstractExecutor> &&left_executor,
+                                   std::unique_ptr<AbstractExecutor> &&right_executor)
+    : AbstractExecutor(exec_ctx),
+      plan_(plan),
+      left_executor_(std::move(left_executor)),
+      right_executor_(std::move(right_executor)),
+      memory_(exec_ctx, MemoryCategory::HASH_JOIN) {}
+
+bool HashJoinExecutor::MakeKey(const Tuple &tuple, const Schema *schema,
+                               const std::vector<const AbstractExpression *> &exprs, HashJoinKey *key) {
+  key->keys_.clear();
+  for (const AbstractExpression *expr : exprs) {
+    key->keys_.push_back(expr->Evaluate(&tuple, schema));
+    if (key->keys_.back().IsNull()) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool HashJoinExecutor::MakeKey(const DataChunk &chunk, uint32_t row,
+                               const std::vector<const AbstractExpression *> &exprs, HashJoinKey *key) {
+  key->keys_.clear();
+  for (const AbstractExpression *expr : exprs) {
+    key->keys_.push_back(expr->EvaluateRow(chunk, row));
+    if (key->keys_.back().IsNull()) {
+      return false;
+    }
+  }
+  return true;
+}
+
+size_t HashJoinExecutor::PartitionOf(const HashJoinKey &key, uint32_t depth) {
+  // the hash of the key is the same at every depth, so it is mixed with the depth
+  return Mix(std::hash<HashJoinKey>{}(key) + (depth + 1) * 0x9e3779b97f4a7c15ULL) % NUM_PARTITIONS;
+}
+
+bool HashJoinExecutor::Build(Tuple &&tuple, HashJoinKey *key) {
+  if (!MakeKey(tuple, left_executor_->GetOutputSchema(), plan_->GetLeftKeys(), key)) {
+    return false;
+  }
+  table_bytes_ += TableBytes(tuple);
+  hash_table_[*key].push_back(std::move(tuple));
+  return true;
+}
+
+void HashJoinExecutor::Init() {
+  hash_table_.clear();
+  table_bytes_ = 0;
+  memory_.Resize(0);
+  spilled_ = false;
+  partitions_.clear();
+  partition_ = Partition{};
+  right_reader_.reset();
+  right_tuples_.clear();
+  next_right_tuple_ = 0;
+  parallel_ = false;
+  parallel_left_.clear();
+  parallel_right_.clear();
+  left_buffers_.clear();
+  right_buffers_.clear();
+  input_bytes_ = 0;
+  pending_partitions_.clear();
+  results_.clear();
+  joined_ = 0;
+  next_result_partition_ = 0;
+  next_result_ = 0;
+  matches_ = nullptr;
+  next_match_ = 0;
+  if (right_chunk_ != nullptr) {
+    right_chunk_->Reset();
+  }
+  next_probe_row_ = 0;
+
+  // a scan on the right side takes a filter of the keys of the left side, which are hashed as the left side is read
+  auto *probe_scan = plan_->GetJoinType() == JoinType::ANTI
+                         ? nullptr
+                         : dynamic_cast<SeqScanExecutor *>(ProfilingExecutor::Unwrap(right_executor_.get()));
+  std::vector<hash_t> key_hashes;
+  std::vector<hash_t> *key_hashes_of_left = probe_scan != nullptr ? &key_hashes : nullptr;
+
+  // a parallel join keeps the tuples of the left side as they are, for its threads to partition
+  bool parallel = plan_->GetNumThreads() > 1;
+  std::vector<Tuple> left_tuples;
+  left_executor_->Init();
+  Tuple tuple;
+  RID rid;
+  HashJoinKey key;
+  bool fits = true;
+  while (fits && left_executor_->Next(&tuple, &rid)) {
+    if (parallel) {
+      if (probe_scan != nullptr && MakeKey(tuple, left_executor_->GetOutputSchema(), plan_->GetLeftKeys(), &key)) {
+        key_hashes.push_back(std::hash<HashJoinKey>{}(key));
+      }
+      table_bytes_ += TableBytes(tuple);
+      left_tuples.push_back(std::move(tuple));
+    } else if (Build(std::move(tuple), &key) && probe_scan != nullptr) {
+      key_hashes.push_back(std::hash<HashJoinKey>{}(key));
+    }
+    fits = memory_.Resize(table_bytes_);
+  }
+  if (parallel && !fits) {
+    parallel = false;
+    table_bytes_ = 0;
+    for (Tuple &left_tuple : left_tuples) {
+      Build(std::move(left_tuple), &key);
+    }
+  }
+  if (!fits) {
+    SpillLeft(key_hashes_of_left);
+  }
+
+  if (probe_scan != nullptr) {
+    join_filter_ = std::make_unique<JoinKeyFilter>(key_hashes.size(), &plan_->GetRightKeys());
+    for (hash_t key_hash : key_hashes) {
+      join_filter_->Insert(key_hash);
+    }
+    probe_scan->SetJoinKeyFilter(join_filter_.get());
+  }
+  right_executor_->Init();
+  if (spilled_) {
+    SpillRight();
+    return;
+  }
+
+  if (parallel) {
+    size_t bytes = table_bytes_;
+    std::vector<Tuple> right_tuples;
+    while (fits && right_executor_->Next(&tuple, &rid)) {
+      bytes += TableBytes(tuple);
+      right_tuples.push_back(std::move(tuple));
+      fits = memory_.Resize(bytes);
+    }
+    if (fits) {
+      parallel_ = true;
+      input_bytes_ = bytes;
+      parallel_left_ = std::move(left_tuples);
+      parallel_right_ = std::move(right_tuples);
+      RadixPartition();
+      return;
+    }
+    // both sides do not fit at once, so the join is the serial one, which probes with the drained right tuples first
+    table_bytes_ = 0;
+    for (Tuple &left_tuple : left_tuples) {
+      Build(std::move(left_tuple), &key);
+    }
+    memory_.Resize(table_bytes_);
+    right_tuples_ = std::move(right_tuples);
+  }
+}
+
+void HashJoinExecutor::RadixPartition() {
+  const Schema *left_schema = left_executor_->GetOutputSchema();
+  const Schema *right_schema = right_executor_->GetOutputSchema();
+  const size_t num_threads = plan_->GetNumThreads();
+  uint32_t radix_bits = 1;
+  while (radix_bits < MAX_RADIX_BITS &&
+         ((size_t{1} << radix_bits) < 4 * num_threads || (table_bytes_ >> radix_bits) > RADIX_PARTITION_BYTES)) {
+    radix_bits++;
+  }
+  const size_t num_partitions = size_t{1} << radix_bits;
+  auto radix = [radix_bits](const HashJoinKey &key) {
+    return Mix(std::hash<HashJoinKey>{}(key)) >> (64 - radix_bits);
+  };
+
+  // every worker partitions a slice of each side, into buffers of the indexes of the tuples of the slice's own; the
+  // right tuples with a null key, which an ANTI join keeps, go to the first partition, and match nothing there
+  const JoinType join_type = plan_->GetJoinType();
+  left_buffers_.assign(num_threads, Buffers(num_partitions));
+  right_buffers_.assign(num_threads, Buffers(num_partitions));
+  PipelineScheduler scheduler(exec_ctx_, num_threads);
+  scheduler.RunTasks(num_threads, [&](size_t /* worker */, size_t slice) {
+    HashJoinKey key;
+    for (size_t i = slice * parallel_left_.size() / num_threads;
+         i < (slice + 1) * parallel_left_.size() / num_threads; i++) {
+      if (MakeKey(parallel_left_[i], left_schema, plan_->GetLeftKeys(), &key)) {
+        left_buffers_[slice][radix(key)].push_back(i);
+      }
+    }
+    for (size_t i = slice * parallel_right_.size() / num_threads;
+         i < (slice + 1) * parallel_right_.size() / num_threads; i++) {
+      if (MakeKey(parallel_right_[i], right_schema, plan_->GetRightKeys(), &key)) {
+        right_buffers_[slice][radix(key)].push_back(i);
+      } else if (join_type == JoinType::ANTI) {
+        right_buffers_[slice][0].push_back(i);
+      }
+    }
+    return true;
+  });
+  for (size_t partition = 0; partition < num_partitions; partition++) {
+    pending_partitions_.push_back(partition);
+  }
+}
+
+bool HashJoinExecutor::RadixJoin() {
+  if (pending_partitions_.empty() || joined_ >= row_limit_) {
+    return false;
+  }
+  const Schema *left_schema = left_executor_->GetOutputSchema();
+  const Schema *right_schema = right_executor_->GetOutputSchema();
+  const size_t num_threads = plan_->GetNumThreads();
+  const JoinType join_type = plan_->GetJoinType();
+
+  // the workers join the pending partitions they claim, each with a hash table of the left tuples in the buffers of
+  // all slices, till the output of the round takes up what the budget leaves beside both sides, or the partitions
+  // joined so far have made as many tuples as the parent takes; every partition claimed is joined whole
+  const size_t budget = exec_ctx_->GetMemoryBudget();
+  const size_t room = budget > input_bytes_ ? budget - input_bytes_ : 0;
+  results_.assign(pending_partitions_.size(), {});
+  std::vector<char> done(pending_partitions_.size(), 0);
+  std::atomic<size_t> round_bytes{0};
+  std::atomic<size_t> joined{joined_};
+  std::vector<std::unordered_map<HashJoinKey, std::vector<uint32_t>>> hash_tables(num_threads);
+  PipelineScheduler scheduler(exec_ctx_, num_threads);
+  scheduler.RunTasks(pending_partitions_.size(), [&](size_t worker, size_t task) {
+    const size_t partition = pending_partitions_[task];
+    std::vector<Tuple> &results = results_[task];
+    std::unordered_map<HashJoinKey, std::vector<uint32_t>> &hash_table = hash_tables[worker];
+    HashJoinKey key;
+    hash_table.clear();
+    for (const Buffers &buffers : left_buffers_) {
+      for (uint32_t i : buffers[partition]) {
+        MakeKey(parallel_left_[i], left_schema, plan_->GetLeftKeys(), &key);
+        hash_table[key].push_back(i);
+      }
+    }
+    done[task] = 1;
+    if (hash_table.empty() && join_type != JoinType::ANTI) {
+      return true;
+    }
+    size_t bytes = 0;
+    for (const Buffers &buffers : right_buffers_) {
+      for (uint32_t i : buffers[partition]) {
+        bool has_key = MakeKey(parallel_right_[i], right_schema, plan_->GetRightKeys(), &key);
+        auto bucket = has_key ? hash_table.find(key) : hash_table.end();
+        if (join_type != JoinType::INNER) {
+          if (KeepsOuter(bucket != hash_table.end())) {
+            results.push_back(MakeOutput(nullptr, parallel_right_[i]));
+            bytes += TableBytes(results.back());
+          }
+          continue;
+        }
+        if (bucket != hash_table.end()) {
+          for (uint32_t match : bucket->second) {
+            results.push_back(MakeOutput(&parallel_left_[match], parallel_right_[i]));
+            bytes += TableBytes(results.back());
+          }
+        }
+      }
+    }
+    bool fits = round_bytes.fetch_add(bytes) + bytes < room;
+    return joined.fetch_add(results.size()) + results.size() < row_limit_ && fits;
+  });
+  joined_ = joined.load();
+  // the output of the round is held on top of both sides, till Next has handed it out
+  memory_.Resize(input_bytes_ + round_bytes.load());
+
+  std::vector<size_t> pending;
+  for (size_t task = 0; task < pending_partitions_.size(); task++) {
+    if (done[task] == 0) {
+      pending.push_back(pending_partitions_[task]);
+    }
+  }
+  pending_partitions_ = std::move(pending);
+  next_result_partition_ = 0;
+  next_result_ = 0;
+  return true;
+}
+
+void HashJoinExecutor::SpillLeft(std::vector<hash_t> *key_hashes) {
+  spilled_ = true;
+  BufferPoolManager *bpm = exec_ctx_->GetBufferPoolManager();
+  partitions_.resize(NUM_PARTITIONS);
+  for (Partition &partition : partitions_) {
+    partition.left_ = std::make_unique<TmpTupleList>(bpm, exec_ctx_->GetSpillCounter());
+    partition.right_ = std::make_unique<TmpTupleList>(bpm, exec_ctx_->GetSpillCounter());
+    partition.depth_ = 0;
+  }
+
+  for (auto &[key, tuples] : hash_table_) {
+    TmpTupleList *list = partitions_[PartitionOf(key, 0)].left_.get();
+    for (const Tuple &tuple : tuples) {
+      list->Append(tuple);
+    }
+  }
+  hash_table_.clear();
+  table_bytes_ = 0;
+  memory_.Resize(0);
+
+  Tuple tuple;
+  RID rid;
+  HashJoinKey key;
+  while (left_executor_->Next(&tuple, &rid)) {
+    if (MakeKey(tuple, left_executor_->GetOutputSchema(), plan_->GetLeftKeys(), &key)) {
+      partitions_[PartitionOf(key, 0)].left_->Append(tuple);
+      if (key_hashes != nullptr) {
+        key_hashes->push_back(std::hash<HashJoinKey>{}(key));
+      }
+    }
+  }
+}
+
+void HashJoinExecutor::SpillRight() {
+  Tuple tuple;
+  RID rid;
+  HashJoinKey key;
+  while (right_executor_->Next(&tuple, &rid)) {
+    if (MakeKey(tuple, right_executor_->GetOutputSchema(), plan_->GetRightKeys(), &key)) {
+      partitions_[PartitionOf(key, 0)].right_->Append(tuple);
+    } else if (plan_->GetJoinType() == JoinType::ANTI) {
+      // a null key matches nothing in whichever partition it is
+      partitions_[0].right_->Append(tuple);
+    }
+  }
+
+  // the partitions that one side has no tuples of join nothing, but the right tuples of an ANTI join
+  std::vector<Partition> partitions = std::move(partitions_);
+  partitions_.clear();
+  for (Partition &partition : partitions) {
+    if (MayJoin(partition)) {
+      partitions_.push_back(std::move(partition));
+    }
+  }
+}
+
+bool HashJoinExecutor::NextPartition() {
+  const Schema *left_schema = left_executor_->GetOutputSchema();
+  const Schema *right_schema = right_executor_->GetOutputSchema();
+  hash_table_.clear();
+  table_bytes_ = 0;
+  memory_.Resize(0);
+  right_reader_.reset();
+  partition_ = Partition{};
+
+  while (!partitions_.empty()) {
+    Partition partition = std::move(partitions_.back());
+    partitions_.pop_back();
+    size_t bytes = partition.left_->GetTupleBytes() + partition.left_->GetSize() * sizeof(Tuple);
+    if (memory_.Resize(bytes) || partition.depth_ == MAX_DEPTH) {
+      partition_ = std::move(partition);
+      break;
+    }
+
+    // split the partition by the hash of the next depth, unless all of its left keys hash to the same partition
+    BufferPoolManager *bpm = exec_ctx_->GetBufferPoolManager();
+    std::vector<Partition> splits(NUM_PARTITIONS);
+    for (Partition &split : splits) {
+      split.left_ = std::make_unique<TmpTupleList>(bpm, exec_ctx_->GetSpillCounter());
+      split.right_ = std::make_unique<TmpTupleList>(bpm, exec_ctx_->GetSpillCounter());
+      split.depth_ = partition.depth_ + 1;
+    }
+    Tuple tuple;
+    HashJoinKey key;
+    TmpTupleList::Reader left_reader(partition.left_.get());
+    while (left_reader.Next(&tuple)) {
+      MakeKey(tuple, left_schema, plan_->GetLeftKeys(), &key);
+      splits[PartitionOf(key, splits[0].depth_)].left_->Append(tuple);
+    }
+    auto split = std::find_if(splits.begin(), splits.end(), [&partition](const Partition &split) {
+      return split.left_->GetSize() == partition.left_->GetSize();
+    });
+    if (split != splits.end()) {
+      partition_ = std::move(partition);
+      break;
+    }
+    TmpTupleList::Reader right_reader(partition.right_.get());
+    while (right_reader.Next(&tuple)) {
+      MakeKey(tuple, right_schema, plan_->GetRightKeys(), &key);
+      splits[PartitionOf(key, splits[0].depth_)].right_->Append(tuple);
+    }
+    for (Partition &split : splits) {
+      if (MayJoin(split)) {
+        partitions_.push_back(std::move(split));
+      }
+    }
+  }
+  if (partition_.left_ == nullptr) {
+    return false;
+  }
+
+  Tuple tuple;
+  HashJoinKey key;
+  TmpTupleList::Reader left_reader(partition_.left_.get());
+  while (left_reader.Next(&tuple)) {
+    Build(std::move(tuple), &key);
+  }
+  right_reader_ = std::make_unique<TmpTupleList::Reader>(partition_.right_.get());
+  return true;
+}
+
+bool HashJoinExecutor::NextRightTuple(Tuple *tuple) {
+  if (!spilled_) {
+    if (next_right_tuple_ < right_tuples_.size()) {
+      *tuple = std::move(right_tuples_[next_right_tuple_++]);
+      return true;
+    }
+    RID rid;
+    return right_executor_->Next(tuple, &rid);
+  }
+  while (right_reader_ == nullptr || !right_reader_->Next(tuple)) {
+    if (!NextPartition()) {
+      return false;
+    }
+  }
+  return true;
+}
+
+Tuple HashJoinExecutor::MakeOutput(const Tuple *left_tuple, const Tuple &right_tuple) {
+  const Schema *left_schema = left_executor_->GetOutputSchema();
+  const Schema *right_schema = right_executor_->GetOutputSchema();
+  std::vector<Value> values;
+  values.reserve(GetOutputSchema()->GetColumnCount());
+  for (const Column &column : GetOutputSchema()->GetColumns()) {
+    values.push_back(column.GetExpr()->EvaluateJoin(left_tuple, left_schema, &right_tuple, right_schema));
+  }
+  return Tuple(values, GetOutputSchema());
+}
+
+bool HashJoinExecutor::Next(Tuple *tuple, RID *rid) {
+  if (parallel_) {
+    do {
+      for (; next_result_partition_ < results_.size(); next_result_partition_++, next_result_ = 0) {
+        std::vector<Tuple> &results = results_[next_result_partition_];
+        if (next_result_ < results.size()) {
+          *tuple = std::move(results[next_result_++]);
+          *rid = tuple->GetRid();
+          return true;
+        }
+        // the output of a partition is let go of once it has been returned
+        results = std::vector<Tuple>{};
+      }
+    } while (RadixJoin());
+    return false;
+  }
+
+  HashJoinKey key;
+  while (matches_ == nullptr || next_match_ == matches_->size()) {
+    matches_ = nullptr;
+    next_match_ = 0;
+    if (!NextRightTuple(&right_tuple_)) {
+      return false;
+    }
+    if (MakeKey(right_tuple_, right_executor_->GetOutputSchema(), plan_->GetRightKeys(), &key)) {
+      auto bucket = hash_table_.find(key);
+      if (bucket != hash_table_.end()) {
+        matches_ = &bucket->second;
+      }
+    }
+    if (plan_->GetJoinType() != JoinType::INNER) {
+      bool matched = matches_ != nullptr;
+      matches_ = nullptr;
+      if (KeepsOuter(matched)) {
+        *tuple = MakeOutput(nullptr, right_tuple_);
+        *rid = tuple->GetRid();
+        return true;
+      }
+    }
+  }
+
+  *tuple = MakeOutput(&(*matches_)[next_match_++], right_tuple_);
+  *rid = tuple->GetRid();
+  return true;
+}
+
+bool HashJoinExecutor::NextRightChunk() {
+  if (next_right_tuple_ == right_tuples_.size()) {
+    return right_executor_->NextBatch(right_chunk_.get());
+  }
+  // the tuples that were drained while the join tried to run in parallel are batched up here
+  right_chunk_->Reset();
+  while (!right_chunk_->IsFull() && next_right_tuple_ < right_tuples_.size()) {
+    right_chunk_->Append(right_tuples_[next_right_tuple_++]);
+  }
+  return true;
+}
+
+void HashJoinExecutor::MakeOutput(const Schema *output_schema, const Schema *left_schema,
+                                  const std::vector<const Tuple *> &left_tuples, const DataChunk &right_chunk,
+                                  const std::vector<uint32_t> &right_rows, DataChunk *chunk) {
+  const Schema *right_schema = right_chunk.GetSchema();
+  size_t count = right_rows.size();
+  for (uint32_t i = 0; i < output_schema->GetColumnCount(); i++) {
+    const AbstractExpression *expr = output_schema->GetColumn(i).GetExpr();
+    ColumnVector *output = &chunk->GetColumn(i);
+    if (const auto *column = dynamic_cast<const ColumnValueExpression *>(expr); column != nullptr) {
+      if (column->GetTupleIdx() == 1) {
+        output->Gather(right_chunk.GetColumn(column->GetColIdx()), right_rows.data(), count);
+      } else {
+        for (size_t j = 0; j < count; j++) {
+          output->SetValue(j, left_tuples[j]->GetValue(left_schema, column->GetColIdx()));
+        }
+      }
+      continue;
+    }
+    for (size_t j = 0; j < count; j++) {
+      Tuple right_tuple = right_chunk.GetTuple(right_rows[j]);
+      output->SetValue(j, expr->EvaluateJoin(left_tuples[j], left_schema, &right_tuple, right_schema));
+    }
+  }
+  chunk->SetSize(count);
+}
+
+bool HashJoinExecutor::NextBatch(DataChunk *chunk) {
+  // the output of a parallel join is made a round of partitions at a time, and a batch of a spilled one must not span
+  // its partitions
+  if (parallel_ || spilled_) {
+    return AbstractExecutor::NextBatch(chunk);
+  }
+  if (right_chunk_ == nullptr) {
+    right_chunk_ = std::make_unique<DataChunk>(right_executor_->GetOutputSchema());
+  }
+  chunk->Reset();
+  batch_left_.clear();
+  batch_right_rows_.clear();
+  HashJoinKey key;
+  while (batch_right_rows_.size() < chunk->GetCapacity()) {
+    if (matches_ != nullptr && next_match_ < matches_->size()) {
+      batch_left_.push_back(&(*matches_)[next_match_++]);
+      batch_right_rows_.push_back(right_chunk_->GetSelectedRow(next_probe_row_ - 1));
+      continue;
+    }
+    matches_ = nullptr;
+    next_match_ = 0;
+    if (next_probe_row_ == right_chunk_->GetSelectedCount()) {
+      // the matches so far refer to the rows of the right chunk, so they go out before it is refilled
+      if (!batch_right_rows_.empty() || !NextRightChunk()) {
+        break;
+      }
+      next_probe_row_ = 0;
+      continue;
+    }
+    uint32_t row = right_chunk_->GetSelectedRow(next_probe_row_++);
+    if (MakeKey(*right_chunk_, row, plan_->GetRightKeys(), &key)) {
+      auto bucket = hash_table_.find(key);
+      if (bucket != hash_table_.end()) {
+        matches_ = &bucket->second;
+      }
+    }
+    if (plan_->GetJoinType() != JoinType::INNER) {
+      if (KeepsOuter(matches_ != nullptr)) {
+        batch_left_.push_back(nullptr);
+        batch_right_rows_.push_back(row);
+      }
+      matches_ = nullptr;
+    }
+  }
+  if (batch_right_rows_.empty()) {
+    return false;
+  }
+  MakeOutput(GetOutputSchema(), left_executor_->GetOutputSchema(), batch_left_, *right_chunk_, batch_right_rows_,
+             chunk);
+  return true;
+}
+
+}  // namespace bustub
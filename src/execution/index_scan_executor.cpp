@@ -9,14 +9,293 @@
 // Copyright (c) 2015-19, Carnegie Mellon University Database Group
 //
 //===----------------------------------------------------------------------===//
+#include <memory>
+#include <optional>
+#include <vector>
+
+#include "common/exception.h"
 #include "execution/executors/index_scan_executor.h"
+#include "storage/index/b_plus_tree_index.h"
 
 namespace bustub {
+
+class IndexScanExecutor::IndexCursor {
+ public:
+  virtual ~IndexCursor() = default;
+
+  /**
+   * Moves on to the next entry of the index.
+   * @param key_schema the schema of the key
+   * @param[out] key the key of the entry, as a tuple of the key schema; nullptr if it is not needed
+   * @param[out] rid the RID of the entry
+   * @return false if there are no more entries
+   */
+  virtual bool Next(Schema *key_schema, Tuple *key, RID *rid) = 0;
+
+  /**
+   * Lets go of the leaf the cursor is in, so that the row of the last entry can be waited for without a latch held;
+   * the next call to Next finds its place again.
+   */
+  virtual void LetGo() {}
+};
+
+namespace {
+
+template <size_t KeySize>
+class BPlusTreeCursor : public IndexScanExecutor::IndexCursor {
+ public:
+  using TreeIndex = BPlusTreeIndex<GenericKey<KeySize>, RID, GenericComparator<KeySize>>;
+
+  /**
+   * Walks the entries between the key tuples, either of which is nullptr if its side is unbounded. The index locks the
+   * key ranges the walk goes through for the transaction if it is SERIALIZABLE, up to the entry past the upper bound.
+   */
+  BPlusTreeCursor(TreeIndex *index, const Tuple *lower, bool lower_inclusive, const Tuple *upper, bool upper_inclusive,
+                  Transaction *txn)
+      : index_(index),
+        txn_(txn),
+        has_upper_(upper != nullptr),
+        upper_inclusive_(upper_inclusive),
+        lower_inclusive_(lower_inclusive) {
+    if (upper != nullptr) {
+      upper_ = index->MakeSearchKey(*upper);
+    }
+    if (lower == nullptr) {
+      iter_ = index->GetBeginIterator();
+      return;
+    }
+    lower_ = index->MakeSearchKey(*lower);
+    has_lower_ = true;
+    from_ = lower_;
+    has_from_ = true;
+    iter_ = index->GetBeginIterator(lower_);
+  }
+
+  bool Next(Schema *key_schema, Tuple *key, RID *rid) override {
+    if (let_go_) {
+      let_go_ = false;
+      iter_ = index_->GetResumeIterator(has_from_ ? &from_ : nullptr, from_inclusive_);
+    }
+    while (true) {
+      index_->LockScanPosition(&iter_, has_from_ ? &from_ : nullptr, from_inclusive_, txn_);
+      if (iter_.isEnd()) {
+        return false;
+      }
+      const auto &entry = *iter_;
+      if (has_upper_) {
+        int cmp = index_->CompareKeyColumns(entry.first, upper_);
+        if (cmp > 0 || (cmp == 0 && !upper_inclusive_)) {
+          return false;
+        }
+      }
+      bool skipped = has_lower_ && !lower_inclusive_ && index_->CompareKeyColumns(entry.first, lower_) == 0;
+      // the walk goes on after this entry, should its leaf be let go of
+      from_ = entry.first;
+      has_from_ = true;
+      from_inclusive_ = false;
+      if (skipped) {
+        ++iter_;
+        continue;
+      }
+      if (key != nullptr) {
+        std::vector<Value> values;
+        values.reserve(key_schema->GetColumnCount());
+        for (uint32_t i = 0; i < key_schema->GetColumnCount(); i++) {
+          values.push_back(entry.first.ToValue(key_schema, i));
+        }
+        *key = Tuple(values, key_schema);
+      }
+      *rid = entry.second;
+      ++iter_;
+      return true;
+    }
+  }
+
+  void LetGo() override {
+    iter_ = IndexIterator<GenericKey<KeySize>, RID, GenericComparator<KeySize>>();
+    let_go_ = true;
+  }
+
+ private:
+  TreeIndex *index_;
+  Transaction *txn_;
+  IndexIterator<GenericKey<KeySize>, RID, GenericComparator<KeySize>> iter_;
+  GenericKey<KeySize> upper_;
+  GenericKey<KeySize> lower_;
+  bool has_lower_{false};
+  bool has_upper_;
+  bool upper_inclusive_;
+  bool lower_inclusive_;
+  /** The key the walk is past, or at if from_inclusive_, nullptr if it starts at the beginning of the index */
+  GenericKey<KeySize> from_;
+  bool has_from_{false};
+  bool from_inclusive_{true};
+  /** Whether the leaf was let go of, and iter_ is to be found again from from_ */
+  bool let_go_{false};
+};
+
+/** Walks the entries of a single key, which any index can look up */
+class KeyCursor : public IndexScanExecutor::IndexCursor {
+ public:
+  KeyCursor(Index *index, const Tuple &key, Transaction *txn) : key_(key) { index->ScanKey(key_, &rids_, txn); }
+
+  bool Next(Schema *key_schema, Tuple *key, RID *rid) override {
+    if (next_ == rids_.size()) {
+      return false;
+    }
+    if (key != nullptr) {
+      *key = key_;
+    }
+    *rid = rids_[next_++];
+    return true;
+  }
+
+ private:
+  Tuple key_;
+  std::vector<RID> rids_;
+  size_t next_{0};
+};
+
+/** Walks nothing, for a range that no key is in */
+class EmptyCursor : public IndexScanExecutor::IndexCursor {
+ public:
+  bool Next(Schema *key_schema, Tuple *key, RID *rid) override { return false; }
+};
+
+template <size_t KeySize>
+std::unique_ptr<IndexScanExecutor::IndexCursor> MakeCursor(Index *index, const std::optional<Tuple> &lower,
+                                                            bool lower_inclusive, const std::optional<Tuple> &upper,
+                                                            bool upper_inclusive, Transaction *txn) {
+  auto *tree_index = dynamic_cast<BPlusTreeIndex<GenericKey<KeySize>, RID, GenericComparator<KeySize>> *>(index);
+  if (tree_index == nullptr) {
+    throw Exception(ExceptionType::NOT_IMPLEMENTED, "index scans of more than a key need a B+ tree index");
+  }
+  return std::make_unique<BPlusTreeCursor<KeySize>>(tree_index, lower.has_value() ? &*lower : nullptr,
+                                                    lower_inclusive, upper.has_value() ? &*upper : nullptr,
+                                                    upper_inclusive, txn);
+}
+
+/**
+ * Makes the key tuple of a bound of a key range.
+ * @return false if the bound is NULL, which no key compares with
+ */
+bool MakeBound(const AbstractExpression *expr, Schema *key_schema, std::optional<Tuple> *bound) {
+  if (expr == nullptr) {
+    return true;
+  }
+  Value value = expr->Evaluate(nullptr, nullptr);
+  if (value.IsNull()) {
+    return false;
+  }
+  TypeId key_type = key_schema->GetColumn(0).GetType();
+  if (value.GetTypeId() != key_type) {
+    try {
+      value = value.CastAs(key_type);
+    } catch (const Exception &) {
+      // a bound out of the range of the key type bounds nothing, and the predicate sorts the rest out
+      return true;
+    }
+  }
+  bound->emplace(std::vector<Value>{value}, key_schema);
+  return true;
+}
+
+}  // namespace
+
 IndexScanExecutor::IndexScanExecutor(ExecutorContext *exec_ctx, const IndexScanPlanNode *plan)
-    : AbstractExecutor(exec_ctx) {}
+    : AbstractExecutor(exec_ctx), plan_(plan) {}
+
+IndexScanExecutor::~IndexScanExecutor() = default;
+
+void IndexScanExecutor::Init() {
+  returned_ = 0;
+  auto *catalog = GetExecutorContext()->GetCatalog();
+  index_info_ = catalog->GetIndex(plan_->GetIndexOid());
+  if (index_info_ == nullptr) {
+    throw Exception(ExceptionType::INVALID, "the index to scan does not exist");
+  }
+  table_info_ = catalog->GetTable(index_info_->table_name_);
+  // normalized keys cannot be turned back into values
+  index_only_ = plan_->IsIndexOnly() && !index_info_->index_->GetMetadata()->HasNormalizedKeys();
 
-void IndexScanExecutor::Init() {}
+  Index *index = index_info_->index_.get();
+  Schema *key_schema = index->GetKeySchema();
+  const IndexKeyRange &range = plan_->GetKeyRange();
+  if ((range.lower_ != nullptr || range.upper_ != nullptr) && key_schema->GetColumnCount() != 1) {
+    throw Exception(ExceptionType::INVALID, "a key range is of an index of a single key column");
+  }
+  // the bounds are evaluated here rather than in the plan, as they may be parameters
+  std::optional<Tuple> lower;
+  std::optional<Tuple> upper;
+  if (!MakeBound(range.lower_, key_schema, &lower) || !MakeBound(range.upper_, key_schema, &upper)) {
+    cursor_ = std::make_unique<EmptyCursor>();
+    return;
+  }
+  if (range.IsEquality() && lower.has_value()) {
+    cursor_ = std::make_unique<KeyCursor>(index, *lower, GetExecutorContext()->GetTransaction());
+    return;
+  }
+  bool lower_inclusive = range.lower_inclusive_;
+  bool upper_inclusive = range.upper_inclusive_;
+  Transaction *txn = GetExecutorContext()->GetTransaction();
+  switch (index_info_->key_size_) {
+    case 4:
+      cursor_ = MakeCursor<4>(index, lower, lower_inclusive, upper, upper_inclusive, txn);
+      break;
+    case 8:
+      cursor_ = MakeCursor<8>(index, lower, lower_inclusive, upper, upper_inclusive, txn);
+      break;
+    case 16:
+      cursor_ = MakeCursor<16>(index, lower, lower_inclusive, upper, upper_inclusive, txn);
+      break;
+    case 32:
+      cursor_ = MakeCursor<32>(index, lower, lower_inclusive, upper, upper_inclusive, txn);
+      break;
+    case 64:
+      cursor_ = MakeCursor<64>(index, lower, lower_inclusive, upper, upper_inclusive, txn);
+      break;
+    default:
+      throw Exception(ExceptionType::NOT_IMPLEMENTED, "index scans need a key size of 4, 8, 16, 32 or 64");
+  }
+}
 
-bool IndexScanExecutor::Next(Tuple *tuple, RID *rid) { return false; }
+bool IndexScanExecutor::Next(Tuple *tuple, RID *rid) {
+  Schema *key_schema = index_info_->index_->GetKeySchema();
+  const Schema *output_schema = GetOutputSchema();
+  Tuple key;
+  RID entry_rid;
+  while (returned_ < row_limit_ && cursor_->Next(key_schema, index_only_ ? &key : nullptr, &entry_rid)) {
+    Tuple table_tuple;
+    const Tuple *input = &key;
+    const Schema *input_schema = key_schema;
+    if (!index_only_) {
+      Transaction *txn = GetExecutorContext()->GetTransaction();
+      // the row's lock may be held by a transaction whose rollback latches the leaf, to take its entry out again
+      if (enable_logging) {
+        cursor_->LetGo();
+      }
+      bool found = table_info_->GetTuple(entry_rid, &table_tuple, txn);
+      if (!found) {
+        continue;
+      }
+      input = &table_tuple;
+      input_schema = &table_info_->schema_;
+    }
+    if (plan_->GetPredicate() != nullptr && !plan_->GetPredicate()->Evaluate(input, input_schema).GetAs<bool>()) {
+      continue;
+    }
+    std::vector<Value> values;
+    values.reserve(output_schema->GetColumnCount());
+    for (const Column &column : output_schema->GetColumns()) {
+      values.push_back(column.GetExpr()->Evaluate(input, input_schema));
+    }
+    // the rows that pass go into the query's arena instead of memory of their own
+    *tuple = Tuple(values, output_schema, GetExecutorContext()->GetArena());
+    *rid = entry_rid;
+    returned_++;
+    return true;
+  }
+  return false;
+}
 
 }  // namespace bustub
@@ -0,0 +1,140 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// index_update_buffer.cpp
+//
+// Identification: src/execution/index_update_buffer.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "execution/index_update_buffer.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace bustub {
+
+IndexUpdateBuffer::IndexUpdateBuffer(ExecutorContext *exec_ctx, const TableMetadata *table_info)
+    : exec_ctx_(exec_ctx), table_info_(table_info) {
+  // read before the indexes, so that one added in between is looked up again
+  index_version_ = exec_ctx_->GetCatalog()->GetIndexVersion();
+  indexes_ = exec_ctx_->GetCatalog()->GetTableIndexes(table_info_->name_);
+  pending_.resize(indexes_.size());
+}
+
+void IndexUpdateBuffer::RefreshIndexes() {
+  auto *catalog = exec_ctx_->GetCatalog();
+  uint64_t version = catalog->GetIndexVersion();
+  if (version == index_version_) {
+    return;
+  }
+  index_version_ = version;
+  // the indexes kept keep their pending changes, wherever they come in the new list
+  std::vector<IndexInfo *> indexes = catalog->GetTableIndexes(table_info_->name_);
+  std::vector<PendingChanges> pending(indexes.size());
+  for (size_t i = 0; i < indexes.size(); i++) {
+    auto kept = std::find(indexes_.begin(), indexes_.end(), indexes[i]);
+    if (kept != indexes_.end()) {
+      pending[i] = std::move(pending_[kept - indexes_.begin()]);
+    }
+  }
+  indexes_ = std::move(indexes);
+  pending_ = std::move(pending);
+}
+
+Tuple IndexUpdateBuffer::KeyOf(const Tuple &tuple, const IndexInfo *index_info) const {
+  return tuple.KeyFromTuple(table_info_->schema_, index_info->key_schema_, index_info->index_->GetKeyAttrs());
+}
+
+void IndexUpdateBuffer::Insert(const Tuple &tuple, const RID &rid) {
+  RefreshIndexes();
+  if (indexes_.empty()) {
+    return;
+  }
+  auto *catalog = exec_ctx_->GetCatalog();
+  for (size_t i = 0; i < indexes_.size(); i++) {
+    pending_[i].inserts_.emplace_back(KeyOf(tuple, indexes_[i]), rid);
+    pending_[i].records_.emplace_back(rid, table_info_->oid_, WType::INSERT, tuple, indexes_[i]->index_oid_, catalog);
+  }
+  AddRow();
+}
+
+void IndexUpdateBuffer::Delete(const Tuple &tuple, const RID &rid) {
+  RefreshIndexes();
+  if (indexes_.empty()) {
+    return;
+  }
+  auto *catalog = exec_ctx_->GetCatalog();
+  for (size_t i = 0; i < indexes_.size(); i++) {
+    pending_[i].deletes_.emplace_back(KeyOf(tuple, indexes_[i]), rid);
+    pending_[i].records_.emplace_back(rid, table_info_->oid_, WType::DELETE, tuple, indexes_[i]->index_oid_, catalog);
+  }
+  AddRow();
+}
+
+void IndexUpdateBuffer::Update(const Tuple &old_tuple, const Tuple &new_tuple, const RID &rid, const RID &new_rid) {
+  RefreshIndexes();
+  if (indexes_.empty()) {
+    return;
+  }
+  auto *catalog = exec_ctx_->GetCatalog();
+  bool moved = !(new_rid == rid);
+  for (size_t i = 0; i < indexes_.size(); i++) {
+    Tuple old_key = KeyOf(old_tuple, indexes_[i]);
+    Tuple new_key = KeyOf(new_tuple, indexes_[i]);
+    if (!moved && old_key.GetLength() == new_key.GetLength() &&
+        std::memcmp(old_key.GetData(), new_key.GetData(), old_key.GetLength()) == 0) {
+      continue;
+    }
+    PendingChanges *pending = &pending_[i];
+    index_oid_t index_oid = indexes_[i]->index_oid_;
+    pending->deletes_.emplace_back(std::move(old_key), rid);
+    pending->inserts_.emplace_back(std::move(new_key), new_rid);
+    if (moved) {
+      // a rollback of an update puts the entry back under the same RID, so a move is undone as a delete and an insert
+      pending->records_.emplace_back(rid, table_info_->oid_, WType::DELETE, old_tuple, index_oid, catalog);
+      pending->records_.emplace_back(new_rid, table_info_->oid_, WType::INSERT, new_tuple, index_oid, catalog);
+    } else {
+      pending->records_.emplace_back(rid, table_info_->oid_, WType::UPDATE, new_tuple, index_oid, catalog);
+      pending->records_.back().old_tuple_ = old_tuple;
+    }
+  }
+  AddRow();
+}
+
+void IndexUpdateBuffer::AddRow() {
+  if (++pending_rows_ >= MAX_PENDING_ROWS) {
+    Flush();
+  }
+}
+
+void IndexUpdateBuffer::Flush() {
+  Transaction *txn = exec_ctx_->GetTransaction();
+  auto *catalog = exec_ctx_->GetCatalog();
+  bool aborted = txn->GetState() == TransactionState::ABORTED;
+  for (size_t i = 0; i < indexes_.size(); i++) {
+    PendingChanges changes = std::move(pending_[i]);
+    pending_[i] = PendingChanges();
+    if (aborted || changes.records_.empty()) {
+      continue;
+    }
+    // recorded before they are applied, so that changes an abort cuts short are rolled back as well; rolling back
+    // one that was not applied finds nothing to undo
+    auto *index_write_set = txn->GetIndexWriteSet().get();
+    for (IndexWriteRecord &record : changes.records_) {
+      index_write_set->push_back(std::move(record));
+    }
+    if (!changes.deletes_.empty()) {
+      catalog->DeleteIndexEntries(indexes_[i], changes.deletes_, txn);
+    }
+    if (!changes.inserts_.empty()) {
+      catalog->InsertIndexEntries(indexes_[i], changes.inserts_, txn);
+    }
+  }
+  pending_rows_ = 0;
+}
+
+}  // namespace bustub
@@ -1,49 +1,145 @@
-//===----------------------------------------------------------------------===//
-//
-//                         BusTub
-//
-// insert_executor.cpp
-//
-// Identification: src/execution/insert_executor.cpp
-//
-// Copyright (c) 2015-19, Carnegie Mellon University Database Group
-//
-//===----------------------------------------------------------------------===//
-#include <memory>
-
-#include "execution/executors/insert_executor.h"
-
-namespace bustub {
-
-InsertExecutor::InsertExecutor(ExecutorContext *exec_ctx, const InsertPlanNode *plan,
-                               std::unique_ptr<AbstractExecutor> &&child_executor)
-    : AbstractExecutor(exec_ctx), plan_(plan), child_executor_(std::move(child_executor)), index_(0) {}
-
-void InsertExecutor::Init() {
-  const auto &catalog = GetExecutorContext()->GetCatalog();
-  table_ = catalog->GetTable(plan_->TableOid())->table_.get();
-  if (!plan_->IsRawInsert()) {
-    child_executor_->Init();
-  }
-}
-
-bool InsertExecutor::Next([[maybe_unused]] Tuple *tuple, RID *rid) {
-  Tuple t;
-  RID r;
-  if (plan_->IsRawInsert()) {
-    auto numTups = plan_->RawValues().size();
-    if (index_ >= numTups) return false;
-    const auto &catalog = GetExecutorContext()->GetCatalog();
-    const Schema *schema = &catalog->GetTable(plan_->TableOid())->schema_;
-    t = Tuple(plan_->RawValuesAt(index_++), schema);
-    auto success = table_->InsertTuple(t, &r, GetExecutorContext()->GetTransaction());
-    return success;
-  }
-  if (child_executor_->Next(&t, &r)) {
-    auto success = table_->InsertTuple(t, &r, GetExecutorContext()->GetTransaction());
-    return success;
-  }
-  return false;
-}
-
-}  // namespace bustub
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// insert_executor.cpp
+//
+// Identification: src/execution/insert_executor.cpp
+//
+// Copyright (c) 2015-19, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "execution/executors/insert_executor.h"
+
+namespace bustub {
+
+InsertExecutor::InsertExecutor(ExecutorContext *exec_ctx, const InsertPlanNode *plan,
+                               std::unique_ptr<AbstractExecutor> &&child_executor)
+    : AbstractExecutor(exec_ctx), plan_(plan), child_executor_(std::move(child_executor)), index_(0) {}
+
+void InsertExecutor::Init() {
+  const auto &catalog = GetExecutorContext()->GetCatalog();
+  TableMetadata *table_info = catalog->GetTable(plan_->TableOid());
+  table_ = table_info->table_.get();
+  pax_table_ = table_info->pax_table_.get();
+  memory_table_ = table_info->memory_table_.get();
+  clustered_table_ = table_info->clustered_table_.get();
+  partitions_ = table_info->partitions_.get();
+  index_updates_ = std::make_unique<IndexUpdateBuffer>(GetExecutorContext(), table_info);
+  auto *bpm = GetExecutorContext()->GetBufferPoolManager();
+  strategy_ = std::make_unique<BufferAccessStrategy>(BufferAccessStrategy::BulkRingSize(bpm->GetPoolSize()));
+  if (plan_->IsRawInsert()) {
+    tuple_builder_ = std::make_unique<TupleBuilder>(&table_info->schema_);
+  } else {
+    child_executor_->Init();
+  }
+}
+
+bool InsertExecutor::Next([[maybe_unused]] Tuple *tuple, RID *rid) {
+  // the tuples are inserted in batches, which fill a page at a time
+  std::vector<Tuple> batch;
+  batch.reserve(BATCH_SIZE);
+  bool exhausted = false;
+  if (plan_->IsRawInsert()) {
+    while (batch.size() < BATCH_SIZE && index_ < plan_->RawValues().size()) {
+      batch.push_back(tuple_builder_->Build(plan_->RawValuesAt(index_++)));
+    }
+    exhausted = index_ == plan_->RawValues().size();
+  } else {
+    Tuple t;
+    RID r;
+    while (batch.size() < BATCH_SIZE) {
+      if (!child_executor_->Next(&t, &r)) {
+        exhausted = true;
+        break;
+      }
+      // the child may hand out a view of a buffer it reuses
+      if (t.IsAllocated()) {
+        batch.push_back(std::move(t));
+      } else {
+        batch.emplace_back().CopyFrom(t);
+      }
+    }
+  }
+  if (batch.empty()) {
+    index_updates_->Flush();
+    return false;
+  }
+
+  // the index entries of the rows inserted wait for the end of the statement, which is the last batch or a failure
+  std::vector<RID> rids;
+  bool inserted = InsertBatch(batch, &rids);
+  for (size_t i = 0; i < rids.size(); i++) {
+    index_updates_->Insert(batch[i], rids[i]);
+  }
+  if (!inserted || exhausted) {
+    index_updates_->Flush();
+  }
+  if (!rids.empty()) {
+    *rid = rids.back();
+  }
+  return inserted;
+}
+
+bool InsertExecutor::InsertBatch(const std::vector<Tuple> &batch, std::vector<RID> *rids) {
+  Transaction *txn = GetExecutorContext()->GetTransaction();
+  RID rid;
+  if (pax_table_ != nullptr) {
+    for (const Tuple &tuple : batch) {
+      if (!pax_table_->InsertTuple(tuple, &rid, txn, strategy_.get())) {
+        return false;
+      }
+      rids->push_back(rid);
+    }
+    return true;
+  }
+  if (memory_table_ != nullptr) {
+    for (const Tuple &tuple : batch) {
+      memory_table_->InsertTuple(tuple, &rid, txn);
+      rids->push_back(rid);
+    }
+    return true;
+  }
+  if (clustered_table_ != nullptr) {
+    // a row whose key is taken fails the insert, as it would a unique index
+    for (const Tuple &tuple : batch) {
+      if (!clustered_table_->InsertTuple(tuple, &rid, txn)) {
+        return false;
+      }
+      rids->push_back(rid);
+    }
+    return true;
+  }
+  if (partitions_ != nullptr) {
+    // the tuples of each partition go in as a batch of their own, and their RIDs are handed back in batch order
+    std::vector<std::vector<Tuple>> partition_batches(partitions_->GetPartitionCount());
+    std::vector<std::vector<size_t>> partition_rows(partitions_->GetPartitionCount());
+    for (size_t i = 0; i < batch.size(); i++) {
+      size_t partition = partitions_->PartitionOf(batch[i]);
+      partition_batches[partition].push_back(batch[i].AsView());
+      partition_rows[partition].push_back(i);
+    }
+    std::vector<RID> batch_rids(batch.size());
+    bool inserted = true;
+    for (size_t partition = 0; partition < partition_batches.size() && inserted; partition++) {
+      std::vector<RID> partition_rids;
+      inserted = partition_batches[partition].empty() ||
+                 partitions_->GetPartition(partition)->InsertTuples(partition_batches[partition], &partition_rids,
+                                                                    txn, strategy_.get());
+      for (size_t i = 0; i < partition_rids.size(); i++) {
+        batch_rids[partition_rows[partition][i]] = partition_rids[i];
+      }
+    }
+    if (inserted) {
+      *rids = std::move(batch_rids);
+    }
+    return inserted;
+  }
+  return table_->InsertTuples(batch, rids, txn, strategy_.get());
+}
+
+}  // namespace bustub
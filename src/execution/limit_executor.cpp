@@ -12,14 +12,38 @@
 
 #include "execution/executors/limit_executor.h"
 
+#include <algorithm>
+#include <cstdint>
+
 namespace bustub {
 
 LimitExecutor::LimitExecutor(ExecutorContext *exec_ctx, const LimitPlanNode *plan,
                              std::unique_ptr<AbstractExecutor> &&child_executor)
-    : AbstractExecutor(exec_ctx) {}
+    : AbstractExecutor(exec_ctx), plan_(plan), child_executor_(std::move(child_executor)) {
+  SetRowLimit(plan_->GetLimit());
+}
+
+void LimitExecutor::SetRowLimit(size_t limit) {
+  // the child makes the skipped tuples as well as the ones returned
+  size_t taken = std::min(limit, plan_->GetLimit());
+  child_executor_->SetRowLimit(taken > SIZE_MAX - plan_->GetOffset() ? SIZE_MAX : plan_->GetOffset() + taken);
+}
 
-void LimitExecutor::Init() {}
+void LimitExecutor::Init() {
+  child_executor_->Init();
+  count_ = 0;
+  Tuple skipped;
+  RID rid;
+  for (size_t i = 0; i < plan_->GetOffset() && child_executor_->Next(&skipped, &rid); i++) {
+  }
+}
 
-bool LimitExecutor::Next(Tuple *tuple, RID *rid) { return false; }
+bool LimitExecutor::Next(Tuple *tuple, RID *rid) {
+  if (count_ == plan_->GetLimit() || !child_executor_->Next(tuple, rid)) {
+    return false;
+  }
+  count_++;
+  return true;
+}
 
 }  // namespace bustub
@@ -0,0 +1,103 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// memory_manager.cpp
+//
+// Identification: src/execution/memory_manager.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "execution/memory_manager.h"
+
+#include <algorithm>
+
+#include "execution/executor_context.h"
+
+namespace bustub {
+
+size_t MemoryManager::GetReserved() const {
+  std::scoped_lock lock(latch_);
+  return reserved_;
+}
+
+size_t MemoryManager::GetPeakReserved() const {
+  std::scoped_lock lock(latch_);
+  return peak_reserved_;
+}
+
+bool MemoryManager::Grant(MemoryReservation *reservation, size_t bytes) {
+  std::scoped_lock lock(latch_);
+  if (reserved_ + bytes > limit_) {
+    // the largest holder that has not been asked yet spills the next time it grows
+    MemoryReservation *largest = nullptr;
+    size_t largest_bytes = 0;
+    for (const auto &[holder, held] : holders_) {
+      if (holder != reservation && held > largest_bytes && !holder->IsRevoked()) {
+        largest = holder;
+        largest_bytes = held;
+      }
+    }
+    if (largest != nullptr) {
+      largest->revoked_.store(true, std::memory_order_relaxed);
+    }
+    return false;
+  }
+  reserved_ += bytes;
+  peak_reserved_ = std::max(peak_reserved_, reserved_);
+  holders_[reservation] += bytes;
+  return true;
+}
+
+void MemoryManager::Release(MemoryReservation *reservation, size_t bytes) {
+  std::scoped_lock lock(latch_);
+  reserved_ -= bytes;
+  auto holder = holders_.find(reservation);
+  holder->second -= bytes;
+  if (holder->second == 0) {
+    holders_.erase(holder);
+  }
+}
+
+bool MemoryReservation::Resize(size_t bytes) {
+  const size_t limit = fixed_ ? limit_ : exec_ctx_->GetMemoryBudget();
+  if (bytes > bytes_ && (bytes > limit || IsRevoked())) {
+    return false;
+  }
+  // the grant is rounded up to whole units, but not past the limit
+  size_t granted = 0;
+  if (bytes != 0) {
+    granted = std::max(bytes, std::min((bytes + GRANT_UNIT - 1) / GRANT_UNIT * GRANT_UNIT, limit));
+  }
+  if ((bytes > granted_ || granted < granted_) && !Grant(granted)) {
+    return false;
+  }
+  bytes_ = bytes;
+  return true;
+}
+
+bool MemoryReservation::Grant(size_t granted) {
+  MemoryManager *manager = manager_ != nullptr ? manager_ : exec_ctx_->GetMemoryManager();
+  if (granted > granted_) {
+    if (manager != nullptr && !manager->Grant(this, granted - granted_)) {
+      return false;
+    }
+    exec_ctx_->ReserveMemory(category_, granted - granted_);
+  } else {
+    if (manager != nullptr) {
+      manager->Release(this, granted_ - granted);
+    }
+    exec_ctx_->ReleaseMemory(category_, granted_ - granted);
+  }
+  granted_ = granted;
+  manager_ = granted == 0 ? nullptr : manager;
+  if (granted == 0) {
+    // everything was given back, which is what a revocation asks for
+    revoked_.store(false, std::memory_order_relaxed);
+  }
+  return true;
+}
+
+}  // namespace bustub
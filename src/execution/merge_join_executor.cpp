@@ -0,0 +1,110 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// merge_join_executor.cpp
+//
+// Identification: src/execution/merge_join_executor.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "execution/executors/merge_join_executor.h"
+
+namespace bustub {
+
+MergeJoinExecutor::MergeJoinExecutor(ExecutorContext *exec_ctx, const MergeJoinPlanNode *plan,
+                                     std::unique_ptr<AbstractExecutor> &&left_executor,
+                                     std::unique_ptr<AbstractExecutor> &&right_executor)
+    : AbstractExecutor(exec_ctx),
+      plan_(plan),
+      left_executor_(std::move(left_executor)),
+      right_executor_(std::move(right_executor)) {}
+
+bool MergeJoinExecutor::Advance(AbstractExecutor *executor, const std::vector<const AbstractExpression *> &key_exprs,
+                                Tuple *tuple, std::vector<Value> *keys) {
+  RID rid;
+  while (executor->Next(tuple, &rid)) {
+    keys->clear();
+    bool null = false;
+    for (const AbstractExpression *expr : key_exprs) {
+      keys->push_back(expr->Evaluate(tuple, executor->GetOutputSchema()));
+      null = null || keys->back().IsNull();
+    }
+    if (!null) {
+      return true;
+    }
+  }
+  return false;
+}
+
+int MergeJoinExecutor::CompareKeys(const std::vector<Value> &left, const std::vector<Value> &right) {
+  for (size_t i = 0; i < left.size(); i++) {
+    if (left[i].CompareLessThan(right[i]) == CmpBool::CmpTrue) {
+      return -1;
+    }
+    if (left[i].CompareGreaterThan(right[i]) == CmpBool::CmpTrue) {
+      return 1;
+    }
+  }
+  return 0;
+}
+
+void MergeJoinExecutor::Init() {
+  left_executor_->Init();
+  right_executor_->Init();
+  group_.clear();
+  next_in_group_ = 0;
+  has_left_ = Advance(left_executor_.get(), plan_->GetLeftKeys(), &left_tuple_, &left_keys_);
+  has_right_ = Advance(right_executor_.get(), plan_->GetRightKeys(), &right_tuple_, &right_keys_);
+}
+
+bool MergeJoinExecutor::Next(Tuple *tuple, RID *rid) {
+  while (true) {
+    if (next_in_group_ < group_.size()) {
+      *tuple = MakeOutput(left_tuple_, group_[next_in_group_++]);
+      *rid = tuple->GetRid();
+      return true;
+    }
+    if (!group_.empty()) {
+      // the next left tuple of the same key joins the group again
+      has_left_ = Advance(left_executor_.get(), plan_->GetLeftKeys(), &left_tuple_, &left_keys_);
+      next_in_group_ = 0;
+      if (has_left_ && CompareKeys(left_keys_, group_keys_) == 0) {
+        continue;
+      }
+      group_.clear();
+    }
+    if (!has_left_ || !has_right_) {
+      return false;
+    }
+    int result = CompareKeys(left_keys_, right_keys_);
+    if (result < 0) {
+      has_left_ = Advance(left_executor_.get(), plan_->GetLeftKeys(), &left_tuple_, &left_keys_);
+    } else if (result > 0) {
+      has_right_ = Advance(right_executor_.get(), plan_->GetRightKeys(), &right_tuple_, &right_keys_);
+    } else {
+      // the right tuples may be views of memory their child reuses, so the group is of copies
+      group_keys_ = right_keys_;
+      do {
+        group_.emplace_back();
+        group_.back().CopyFrom(right_tuple_);
+        has_right_ = Advance(right_executor_.get(), plan_->GetRightKeys(), &right_tuple_, &right_keys_);
+      } while (has_right_ && CompareKeys(right_keys_, group_keys_) == 0);
+    }
+  }
+}
+
+Tuple MergeJoinExecutor::MakeOutput(const Tuple &left_tuple, const Tuple &right_tuple) {
+  const Schema *left_schema = left_executor_->GetOutputSchema();
+  const Schema *right_schema = right_executor_->GetOutputSchema();
+  std::vector<Value> values;
+  values.reserve(GetOutputSchema()->GetColumnCount());
+  for (const Column &column : GetOutputSchema()->GetColumns()) {
+    values.push_back(column.GetExpr()->EvaluateJoin(&left_tuple, left_schema, &right_tuple, right_schema));
+  }
+  return Tuple(values, GetOutputSchema());
+}
+
+}  // namespace bustub
@@ -12,14 +12,267 @@
 
 #include "execution/executors/nested_index_join_executor.h"
 
+#include <algorithm>
+#include <cstdint>
+
+#include "common/exception.h"
+#include "execution/expressions/column_value_expression.h"
+#include "execution/expressions/comparison_expression.h"
+#include "storage/table/table_page_scanner.h"
+#include "storage/table/toast_store.h"
+
 namespace bustub {
 
 NestIndexJoinExecutor::NestIndexJoinExecutor(ExecutorContext *exec_ctx, const NestedIndexJoinPlanNode *plan,
                                              std::unique_ptr<AbstractExecutor> &&child_executor)
-    : AbstractExecutor(exec_ctx) {}
+    : AbstractExecutor(exec_ctx),
+      plan_(plan),
+      child_(std::move(child_executor)),
+      memory_(exec_ctx, MemoryCategory::HASH_JOIN) {}
+
+void NestIndexJoinExecutor::Init() {
+  auto *catalog = GetExecutorContext()->GetCatalog();
+  table_info_ = catalog->GetTable(plan_->GetInnerTableOid());
+  if (table_info_ == nullptr) {
+    throw Exception(ExceptionType::INVALID, "the inner table of the index join does not exist");
+  }
+  index_info_ = catalog->GetIndex(plan_->GetIndexName(), table_info_->name_);
+  if (index_info_ == nullptr) {
+    throw Exception(ExceptionType::INVALID, "the index of the index join does not exist");
+  }
+  if (index_info_->index_->GetIndexColumnCount() != 1) {
+    throw Exception(ExceptionType::NOT_IMPLEMENTED, "index joins need a single-column index");
+  }
+
+  // the outer key is the side of the equality that is not the inner column
+  const auto *comparison = dynamic_cast<const ComparisonExpression *>(plan_->Predicate());
+  if (comparison == nullptr || comparison->GetComparisonType() != ComparisonType::Equal) {
+    throw Exception(ExceptionType::NOT_IMPLEMENTED, "index joins need an equality predicate");
+  }
+  const auto *left_column = dynamic_cast<const ColumnValueExpression *>(comparison->GetChildAt(0));
+  bool left_is_inner = left_column != nullptr && left_column->GetTupleIdx() == 1;
+  outer_key_ = comparison->GetChildAt(left_is_inner ? 1 : 0);
+
+  // a table of another layout is never scanned into a hash table
+  outer_rows_ = 0;
+  switch_rows_ = SIZE_MAX;
+  if (table_info_->layout_ == TableLayout::ROW) {
+    switch_rows_ = table_info_->statistics_ != nullptr ? table_info_->statistics_->GetRowCount() / SWITCH_RATIO
+                                                       : BATCH_SIZE * SWITCH_RATIO;
+  }
+  hash_join_ = false;
+  inner_table_.clear();
+  memory_.Resize(0);
+
+  child_->Init();
+  output_.clear();
+  output_idx_ = 0;
+}
+
+bool NestIndexJoinExecutor::Next(Tuple *tuple, RID *rid) {
+  while (output_idx_ == output_.size()) {
+    if (!JoinBatch()) {
+      return false;
+    }
+  }
+  *tuple = std::move(output_[output_idx_++]);
+  *rid = tuple->GetRid();
+  return true;
+}
+
+bool NestIndexJoinExecutor::JoinBatch() {
+  output_.clear();
+  output_idx_ = 0;
+  if (outer_rows_ >= switch_rows_) {
+    // the join tries once, from the batch at which the outer side reached the threshold on
+    hash_join_ = BuildInnerTable();
+    switch_rows_ = SIZE_MAX;
+  }
+  const Schema *outer_schema = child_->GetOutputSchema();
+  TypeId key_type = index_info_->index_->GetKeySchema()->GetColumn(0).GetType();
+
+  // a batch ends where the outer side reaches the threshold, so that the join switches right there
+  size_t batch_size = BATCH_SIZE;
+  if (switch_rows_ != SIZE_MAX) {
+    batch_size = std::max<size_t>(std::min(BATCH_SIZE, switch_rows_ - outer_rows_), 1);
+  }
+  std::vector<Tuple> outer_tuples;
+  std::vector<Value> keys;
+  std::vector<size_t> key_owners;
+  Tuple tuple;
+  RID rid;
+  const JoinType join_type = plan_->GetJoinType();
+  while (outer_tuples.size() < batch_size && child_->Next(&tuple, &rid)) {
+    outer_rows_++;
+    Value key = outer_key_->Evaluate(&tuple, outer_schema);
+    if (key.IsNull()) {
+      // a null key matches nothing, which an ANTI join makes a row of all the same
+      if (join_type != JoinType::ANTI) {
+        continue;
+      }
+    } else {
+      keys.push_back(key.CastAs(key_type));
+      key_owners.push_back(outer_tuples.size());
+    }
+    if (tuple.IsAllocated()) {
+      outer_tuples.push_back(std::move(tuple));
+    } else {
+      outer_tuples.emplace_back().CopyFrom(tuple);
+    }
+  }
+  if (outer_tuples.empty()) {
+    return false;
+  }
+
+  std::vector<bool> matched(outer_tuples.size(), false);
+  if (hash_join_) {
+    ProbeBatch(outer_tuples, keys, key_owners, &matched);
+  } else {
+    LookUpBatch(outer_tuples, keys, key_owners, &matched);
+  }
+
+  if (join_type != JoinType::INNER) {
+    const Schema *inner_schema = &table_info_->schema_;
+    const Schema *output_schema = GetOutputSchema();
+    for (size_t i = 0; i < outer_tuples.size(); i++) {
+      if (matched[i] != (join_type == JoinType::SEMI)) {
+        continue;
+      }
+      std::vector<Value> values;
+      values.reserve(output_schema->GetColumnCount());
+      for (const Column &column : output_schema->GetColumns()) {
+        values.push_back(column.GetExpr()->EvaluateJoin(&outer_tuples[i], outer_schema, nullptr, inner_schema));
+      }
+      output_.emplace_back(values, output_schema);
+      output_.back().SetRid(outer_tuples[i].GetRid());
+    }
+  }
+  return true;
+}
+
+void NestIndexJoinExecutor::LookUpBatch(const std::vector<Tuple> &outer_tuples, const std::vector<Value> &keys,
+                                        const std::vector<size_t> &key_owners, std::vector<bool> *matched) {
+  Schema *key_schema = index_info_->index_->GetKeySchema();
+  std::vector<Tuple> key_tuples;
+  key_tuples.reserve(keys.size());
+  for (const Value &key : keys) {
+    key_tuples.emplace_back(std::vector<Value>{key}, key_schema);
+  }
+  Transaction *txn = GetExecutorContext()->GetTransaction();
+  std::vector<std::vector<RID>> results;
+  index_info_->index_->ScanKeys(key_tuples, &results, txn);
+
+  // the matches are fetched page by page, rather than in the order of the outer tuples
+  std::vector<std::pair<RID, size_t>> matches;
+  for (size_t i = 0; i < results.size(); i++) {
+    for (const RID &inner_rid : results[i]) {
+      matches.emplace_back(inner_rid, key_owners[i]);
+    }
+  }
+  std::sort(matches.begin(), matches.end(), [](const auto &a, const auto &b) {
+    if (a.first.GetPageId() != b.first.GetPageId()) {
+      return a.first.GetPageId() < b.first.GetPageId();
+    }
+    return a.first.GetSlotNum() < b.first.GetSlotNum();
+  });
+  if (table_info_->layout_ == TableLayout::ROW) {
+    // the RIDs of a ROW table are its pages, which are read all at once, as the first ones are joined
+    std::vector<page_id_t> page_ids;
+    for (const auto &match : matches) {
+      if (page_ids.empty() || page_ids.back() != match.first.GetPageId()) {
+        page_ids.push_back(match.first.GetPageId());
+      }
+    }
+    GetExecutorContext()->GetBufferPoolManager()->PrefetchPages(page_ids);
+  }
+
+  const bool inner_join = plan_->GetJoinType() == JoinType::INNER;
+  Tuple inner_tuple;
+  for (const auto &[inner_rid, outer_idx] : matches) {
+    if (!inner_join && (*matched)[outer_idx]) {
+      continue;
+    }
+    if (table_info_->GetTuple(inner_rid, &inner_tuple, txn)) {
+      JoinPair(outer_tuples[outer_idx], outer_idx, inner_tuple, inner_rid, matched);
+    }
+  }
+}
+
+void NestIndexJoinExecutor::ProbeBatch(const std::vector<Tuple> &outer_tuples, const std::vector<Value> &keys,
+                                       const std::vector<size_t> &key_owners, std::vector<bool> *matched) {
+  const bool inner_join = plan_->GetJoinType() == JoinType::INNER;
+  HashJoinKey key;
+  for (size_t i = 0; i < keys.size(); i++) {
+    key.keys_ = {keys[i]};
+    auto it = inner_table_.find(key);
+    if (it == inner_table_.end()) {
+      continue;
+    }
+    const size_t outer_idx = key_owners[i];
+    for (const Tuple &inner_tuple : it->second) {
+      JoinPair(outer_tuples[outer_idx], outer_idx, inner_tuple, inner_tuple.GetRid(), matched);
+      if (!inner_join && (*matched)[outer_idx]) {
+        break;
+      }
+    }
+  }
+}
 
-void NestIndexJoinExecutor::Init() {}
+void NestIndexJoinExecutor::JoinPair(const Tuple &outer_tuple, size_t outer_idx, const Tuple &inner_tuple,
+                                     const RID &inner_rid, std::vector<bool> *matched) {
+  const Schema *outer_schema = child_->GetOutputSchema();
+  const Schema *inner_schema = &table_info_->schema_;
+  if (!plan_->Predicate()->EvaluateJoin(&outer_tuple, outer_schema, &inner_tuple, inner_schema).GetAs<bool>()) {
+    return;
+  }
+  if (plan_->GetJoinType() != JoinType::INNER) {
+    (*matched)[outer_idx] = true;
+    return;
+  }
+  const Schema *output_schema = GetOutputSchema();
+  std::vector<Value> values;
+  values.reserve(output_schema->GetColumnCount());
+  for (const Column &column : output_schema->GetColumns()) {
+    values.push_back(column.GetExpr()->EvaluateJoin(&outer_tuple, outer_schema, &inner_tuple, inner_schema));
+  }
+  output_.emplace_back(values, output_schema);
+  output_.back().SetRid(inner_rid);
+}
 
-bool NestIndexJoinExecutor::Next(Tuple *tuple, RID *rid) { return false; }
+bool NestIndexJoinExecutor::BuildInnerTable() {
+  Transaction *txn = GetExecutorContext()->GetTransaction();
+  const Schema *inner_schema = &table_info_->schema_;
+  const uint32_t key_column = index_info_->index_->GetKeyAttrs()[0];
+  size_t table_bytes = 0;
+  HashJoinKey key;
+  Tuple view;
+  Tuple detoasted;
+  for (TableHeap *heap : table_info_->GetHeaps()) {
+    // the scanner reads the rows as the lookups do, the versions a snapshot sees and the locks or read set of the
+    // transaction, and the values of the rows are detoasted as they are read
+    TablePageScanner scanner(heap, txn);
+    ToastStore *toast = heap->GetToastStore();
+    while (scanner.Next(&view)) {
+      const Tuple *row = &view;
+      if (toast != nullptr && toast->IsToasted(view)) {
+        toast->Detoast(view, &detoasted);
+        row = &detoasted;
+      }
+      Value value = row->GetValue(inner_schema, key_column);
+      if (value.IsNull()) {
+        continue;
+      }
+      table_bytes += sizeof(Tuple) + row->GetLength();
+      if (!memory_.Resize(table_bytes)) {
+        inner_table_.clear();
+        memory_.Resize(0);
+        return false;
+      }
+      key.keys_ = {std::move(value)};
+      inner_table_[key].emplace_back().CopyFrom(*row);
+    }
+  }
+  return true;
+}
 
 }  // namespace bustub
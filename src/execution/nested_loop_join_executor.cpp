@@ -17,10 +17,104 @@ namespace bustub {
 NestedLoopJoinExecutor::NestedLoopJoinExecutor(ExecutorContext *exec_ctx, const NestedLoopJoinPlanNode *plan,
                                                std::unique_ptr<AbstractExecutor> &&left_executor,
                                                std::unique_ptr<AbstractExecutor> &&right_executor)
-    : AbstractExecutor(exec_ctx) {}
+    : AbstractExecutor(exec_ctx),
+      plan_(plan),
+      left_executor_(std::move(left_executor)),
+      right_executor_(std::move(right_executor)),
+      memory_(exec_ctx, MemoryCategory::OTHER) {}
 
-void NestedLoopJoinExecutor::Init() {}
+void NestedLoopJoinExecutor::Init() {
+  left_executor_->Init();
+  block_.clear();
+  memory_.Resize(0);
+  has_pending_ = false;
+  left_done_ = false;
+  num_blocks_ = 0;
+  matches_.clear();
+  next_match_ = 0;
+  LoadBlock();
+}
 
-bool NestedLoopJoinExecutor::Next(Tuple *tuple, RID *rid) { return false; }
+bool NestedLoopJoinExecutor::LoadBlock() {
+  block_.clear();
+  memory_.Resize(0);
+  size_t bytes = 0;
+  if (has_pending_) {
+    bytes += sizeof(Tuple) + pending_.GetLength();
+    memory_.Resize(bytes);
+    block_.push_back(std::move(pending_));
+    has_pending_ = false;
+  }
+  Tuple tuple;
+  RID rid;
+  while (!left_done_) {
+    if (!left_executor_->Next(&tuple, &rid)) {
+      left_done_ = true;
+      break;
+    }
+    // the first tuple of a block is always taken, so that the join goes on however small the budget is
+    size_t tuple_bytes = sizeof(Tuple) + tuple.GetLength();
+    if (!block_.empty() && !memory_.Resize(bytes + tuple_bytes)) {
+      pending_.CopyFrom(tuple);
+      has_pending_ = true;
+      break;
+    }
+    if (block_.empty()) {
+      memory_.Resize(tuple_bytes);
+    }
+    bytes += tuple_bytes;
+    block_.emplace_back().CopyFrom(tuple);
+  }
+  if (block_.empty()) {
+    return false;
+  }
+  num_blocks_++;
+  right_executor_->Init();
+  return true;
+}
+
+bool NestedLoopJoinExecutor::Next(Tuple *tuple, RID *rid) {
+  const Schema *left_schema = left_executor_->GetOutputSchema();
+  const Schema *right_schema = right_executor_->GetOutputSchema();
+  const AbstractExpression *predicate = plan_->Predicate();
+  while (true) {
+    if (next_match_ < matches_.size()) {
+      *tuple = MakeOutput(block_[matches_[next_match_++]], right_tuple_);
+      *rid = tuple->GetRid();
+      return true;
+    }
+    if (block_.empty()) {
+      return false;
+    }
+    RID right_rid;
+    if (!right_executor_->Next(&right_tuple_, &right_rid)) {
+      // the right side is done with this block
+      if (!LoadBlock()) {
+        return false;
+      }
+      continue;
+    }
+    // the predicate over the whole block at once, for one right tuple
+    matches_.clear();
+    next_match_ = 0;
+    for (uint32_t i = 0; i < block_.size(); i++) {
+      if (predicate == nullptr ||
+          predicate->EvaluateJoin(&block_[i], left_schema, &right_tuple_, right_schema).GetAs<bool>()) {
+        matches_.push_back(i);
+      }
+    }
+  }
+}
+
+Tuple NestedLoopJoinExecutor::MakeOutput(const Tuple &left_tuple, const Tuple &right_tuple) {
+  const Schema *left_schema = left_executor_->GetOutputSchema();
+  const Schema *right_schema = right_executor_->GetOutputSchema();
+  std::vector<Value> values;
+  values.reserve(GetOutputSchema()->GetColumnCount());
+  for (const Column &column : GetOutputSchema()->GetColumns()) {
+    values.push_back(column.GetExpr()->EvaluateJoin(&left_tuple, left_schema, &right_tuple, right_schema));
+  }
+  return Tuple(values, GetOutputSchema());
+}
 
 }  // namespace bustub
@@ -0,0 +1,71 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// pipeline_scheduler.cpp
+//
+// Identification: src/execution/pipeline_scheduler.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "execution/pipeline_scheduler.h"
+
+#include <atomic>
+
+#include "common/exception.h"
+#include "common/util/morsel_queue.h"
+#include "storage/table/parallel_table_scan.h"
+
+namespace bustub {
+
+bool PipelineScheduler::Run(const std::function<bool(size_t, bool *)> &claim_and_run) {
+  std::atomic<bool> stopped{false};
+  pool_->Run(num_workers_, [&](size_t worker) {
+    bool keep_going = true;
+    while (!stopped.load(std::memory_order_relaxed) && !exec_ctx_->IsCancelled()) {
+      if (!claim_and_run(worker, &keep_going)) {
+        break;
+      }
+      if (!keep_going) {
+        stopped = true;
+      }
+    }
+  });
+  if (exec_ctx_->IsCancelled()) {
+    throw Exception(ExceptionType::CANCELLED, "the query was cancelled");
+  }
+  return !stopped;
+}
+
+bool PipelineScheduler::RunScan(TableHeap *table,
+                                const std::function<bool(size_t, const std::vector<page_id_t> &)> &consume) {
+  std::vector<int> worker_nodes;
+  for (size_t worker = 0; worker < num_workers_; worker++) {
+    worker_nodes.push_back(pool_->GetWorkerNode(worker));
+  }
+  ParallelTableScan scan(table, ParallelTableScan::PAGES_PER_MORSEL, nullptr, num_workers_, worker_nodes);
+  return Run([&](size_t worker, bool *keep_going) {
+    std::vector<page_id_t> morsel;
+    if (!scan.NextMorsel(&morsel, worker)) {
+      return false;
+    }
+    *keep_going = consume(worker, morsel);
+    return true;
+  });
+}
+
+bool PipelineScheduler::RunTasks(size_t num_tasks, const std::function<bool(size_t, size_t)> &run) {
+  MorselQueue tasks(num_tasks, num_workers_);
+  return Run([&](size_t worker, bool *keep_going) {
+    size_t task;
+    if (!tasks.Next(worker, &task)) {
+      return false;
+    }
+    *keep_going = run(worker, task);
+    return true;
+  });
+}
+
+}  // namespace bustub
@@ -0,0 +1,90 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// prepared_statement.cpp
+//
+// Identification: src/execution/prepared_statement.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "execution/prepared_statement.h"
+
+#include <utility>
+
+#include "common/exception.h"
+#include "common/tracer.h"
+
+namespace bustub {
+
+PreparedStatement::PreparedStatement(ExecutorContext *exec_ctx, std::unique_ptr<AbstractExecutor> executor,
+                                     std::vector<Value> *parameters)
+    : exec_ctx_(exec_ctx), executor_(std::move(executor)), parameters_(parameters) {}
+
+bool PreparedStatement::ExecuteStreaming(const std::vector<Value> &values, const ResultCallback &on_row) {
+  size_t num_parameters = parameters_ == nullptr ? 0 : parameters_->size();
+  if (values.size() != num_parameters) {
+    throw Exception(ExceptionType::INVALID, "the statement is run with the wrong number of parameters");
+  }
+  if (parameters_ != nullptr) {
+    *parameters_ = values;
+  }
+  // nothing of the last run is still in use, the results it handed out of the arena included
+  exec_ctx_->GetArena()->Reset();
+  return Run(executor_.get(), exec_ctx_, on_row);
+}
+
+bool PreparedStatement::Execute(const std::vector<Value> &values, std::vector<Tuple> *result_set) {
+  return ExecuteStreaming(values, CollectInto(result_set));
+}
+
+bool PreparedStatement::Run(AbstractExecutor *executor, ExecutorContext *exec_ctx, const ResultCallback &on_row) {
+  TraceSpan span("query", "query");
+  // prepare; the pipelines an executor runs in Init stop once the query is cancelled
+  try {
+    executor->Init();
+  } catch (Exception &e) {
+    if (e.GetType() != ExceptionType::CANCELLED) {
+      throw;
+    }
+    return false;
+  }
+
+  // execute; as in Init, a cancelled query has no result, and any other error goes to the caller
+  try {
+    Tuple tuple;
+    RID rid;
+    while (!exec_ctx->IsCancelled() && executor->Next(&tuple, &rid)) {
+      if (!on_row(tuple)) {
+        break;
+      }
+    }
+  } catch (Exception &e) {
+    if (e.GetType() != ExceptionType::CANCELLED) {
+      throw;
+    }
+    return false;
+  }
+
+  // a cancelled query has no result
+  return !exec_ctx->IsCancelled();
+}
+
+PreparedStatement::ResultCallback PreparedStatement::CollectInto(std::vector<Tuple> *result_set) {
+  if (result_set == nullptr) {
+    return [](Tuple & /*tuple*/) { return true; };
+  }
+  return [result_set](Tuple &tuple) {
+    if (tuple.IsAllocated()) {
+      result_set->push_back(std::move(tuple));
+    } else {
+      // the results outlive the query, and with it the arena the tuple may be in
+      result_set->emplace_back().CopyFrom(tuple);
+    }
+    return true;
+  };
+}
+
+}  // namespace bustub
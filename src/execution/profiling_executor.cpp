@@ -0,0 +1,109 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// profiling_executor.cpp
+//
+// Identification: src/execution/profiling_executor.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "execution/executors/profiling_executor.h"
+
+#include <time.h>  // NOLINT
+
+#include <chrono>  // NOLINT
+#include <utility>
+
+#include "buffer/buffer_pool_manager.h"
+#include "execution/executors/tracing_executor.h"
+
+namespace bustub {
+
+class ProfilingExecutor::Measurement {
+ public:
+  explicit Measurement(ExecutorContext *exec_ctx)
+      : exec_ctx_(exec_ctx),
+        bpm_stats_(Stats(exec_ctx)),
+        spilled_bytes_(exec_ctx->GetSpillCounter()->load(std::memory_order_relaxed)),
+        cpu_ns_(ThreadCpuNs()),
+        start_(std::chrono::steady_clock::now()) {}
+
+  /** Adds what happened since the measurement was started to the counters */
+  void AddTo(OperatorCounters *counters) const {
+    auto wall = std::chrono::steady_clock::now() - start_;
+    uint64_t cpu_ns = ThreadCpuNs();
+    BufferPoolStats bpm_stats = Stats(exec_ctx_);
+    counters->wall_ns_.fetch_add(std::chrono::duration_cast<std::chrono::nanoseconds>(wall).count(),
+                                 std::memory_order_relaxed);
+    counters->cpu_ns_.fetch_add(cpu_ns - cpu_ns_, std::memory_order_relaxed);
+    counters->page_hits_.fetch_add(bpm_stats.hits_ - bpm_stats_.hits_, std::memory_order_relaxed);
+    counters->page_misses_.fetch_add(bpm_stats.misses_ - bpm_stats_.misses_, std::memory_order_relaxed);
+    counters->spilled_bytes_.fetch_add(exec_ctx_->GetSpillCounter()->load(std::memory_order_relaxed) - spilled_bytes_,
+                                       std::memory_order_relaxed);
+  }
+
+ private:
+  static BufferPoolStats Stats(ExecutorContext *exec_ctx) {
+    BufferPoolManager *bpm = exec_ctx->GetBufferPoolManager();
+    return bpm != nullptr ? bpm->GetStats() : BufferPoolStats{};
+  }
+
+  static uint64_t ThreadCpuNs() {
+    timespec now{};
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &now);
+    return static_cast<uint64_t>(now.tv_sec) * 1000000000 + static_cast<uint64_t>(now.tv_nsec);
+  }
+
+  ExecutorContext *exec_ctx_;
+  BufferPoolStats bpm_stats_;
+  uint64_t spilled_bytes_;
+  uint64_t cpu_ns_;
+  std::chrono::steady_clock::time_point start_;
+};
+
+ProfilingExecutor::ProfilingExecutor(ExecutorContext *exec_ctx, const AbstractPlanNode *plan,
+                                     std::unique_ptr<AbstractExecutor> &&executor)
+    : AbstractExecutor(exec_ctx), executor_(std::move(executor)), counters_(exec_ctx->GetProfile()->GetCounters(plan)) {
+  counters_->executors_.fetch_add(1, std::memory_order_relaxed);
+}
+
+void ProfilingExecutor::Init() {
+  Measurement measurement(exec_ctx_);
+  executor_->Init();
+  measurement.AddTo(counters_);
+}
+
+bool ProfilingExecutor::Next(Tuple *tuple, RID *rid) {
+  Measurement measurement(exec_ctx_);
+  bool produced = executor_->Next(tuple, rid);
+  measurement.AddTo(counters_);
+  counters_->calls_.fetch_add(1, std::memory_order_relaxed);
+  if (produced) {
+    counters_->rows_.fetch_add(1, std::memory_order_relaxed);
+  }
+  return produced;
+}
+
+bool ProfilingExecutor::NextBatch(DataChunk *chunk) {
+  Measurement measurement(exec_ctx_);
+  bool produced = executor_->NextBatch(chunk);
+  measurement.AddTo(counters_);
+  counters_->calls_.fetch_add(1, std::memory_order_relaxed);
+  if (produced) {
+    counters_->rows_.fetch_add(chunk->GetSelectedCount(), std::memory_order_relaxed);
+  }
+  return produced;
+}
+
+AbstractExecutor *ProfilingExecutor::Unwrap(AbstractExecutor *executor) {
+  if (auto *tracing = dynamic_cast<TracingExecutor *>(executor); tracing != nullptr) {
+    executor = tracing->GetExecutor();
+  }
+  auto *profiling = dynamic_cast<ProfilingExecutor *>(executor);
+  return profiling != nullptr ? profiling->executor_.get() : executor;
+}
+
+}  // namespace bustub
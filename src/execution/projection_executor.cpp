@@ -0,0 +1,96 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// projection_executor.cpp
+//
+// Identification: src/execution/projection_executor.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "execution/executors/projection_executor.h"
+
+#include <vector>
+
+#include "execution/expressions/column_value_expression.h"
+
+namespace bustub {
+
+ProjectionExecutor::ProjectionExecutor(ExecutorContext *exec_ctx, const ProjectionPlanNode *plan,
+                                       std::unique_ptr<AbstractExecutor> &&child)
+    : AbstractExecutor(exec_ctx), plan_(plan), child_(std::move(child)) {}
+
+void ProjectionExecutor::Init() {
+  child_->Init();
+  sources_ = SharedColumns(GetOutputSchema());
+}
+
+bool ProjectionExecutor::Next(Tuple *tuple, RID *rid) {
+  Tuple input;
+  if (!child_->Next(&input, rid)) {
+    return false;
+  }
+  const Schema *output_schema = GetOutputSchema();
+  std::vector<Value> values;
+  values.reserve(output_schema->GetColumnCount());
+  for (uint32_t i = 0; i < output_schema->GetColumnCount(); i++) {
+    if (sources_[i] != i) {
+      values.push_back(values[sources_[i]]);
+      continue;
+    }
+    const AbstractExpression *expr = output_schema->GetColumn(i).GetExpr();
+    values.push_back(expr != nullptr ? expr->Evaluate(&input, child_->GetOutputSchema())
+                                     : input.GetValue(child_->GetOutputSchema(), i));
+  }
+  *tuple = Tuple(std::move(values), output_schema);
+  tuple->SetRid(*rid);
+  return true;
+}
+
+bool ProjectionExecutor::NextBatch(DataChunk *chunk) {
+  if (child_chunk_ == nullptr || child_chunk_->GetCapacity() != chunk->GetCapacity()) {
+    child_chunk_ = std::make_unique<DataChunk>(child_->GetOutputSchema(), chunk->GetCapacity());
+  }
+  chunk->Reset();
+  if (!child_->NextBatch(child_chunk_.get())) {
+    return false;
+  }
+  Project(GetOutputSchema(), *child_chunk_, chunk);
+  return true;
+}
+
+void ProjectionExecutor::Project(const Schema *output_schema, const DataChunk &rows, DataChunk *chunk) {
+  size_t count = rows.GetSelectedCount();
+  const uint32_t *selection = rows.HasSelection() ? rows.GetSelection().data() : nullptr;
+  for (uint32_t i = 0; i < output_schema->GetColumnCount(); i++) {
+    const AbstractExpression *expr = output_schema->GetColumn(i).GetExpr();
+    const auto *column = dynamic_cast<const ColumnValueExpression *>(expr);
+    if (expr == nullptr || column != nullptr) {
+      chunk->GetColumn(i).Gather(rows.GetColumn(column != nullptr ? column->GetColIdx() : i), selection, count);
+      continue;
+    }
+    for (size_t j = 0; j < count; j++) {
+      chunk->GetColumn(i).SetValue(j, expr->EvaluateRow(rows, rows.GetSelectedRow(j)));
+    }
+  }
+  chunk->SetSize(count);
+}
+
+std::vector<uint32_t> ProjectionExecutor::SharedColumns(const Schema *output_schema) {
+  std::vector<uint32_t> sources(output_schema->GetColumnCount());
+  for (uint32_t i = 0; i < sources.size(); i++) {
+    const AbstractExpression *expr = output_schema->GetColumn(i).GetExpr();
+    sources[i] = i;
+    for (uint32_t j = 0; expr != nullptr && j < i; j++) {
+      if (output_schema->GetColumn(j).GetExpr() == expr) {
+        sources[i] = j;
+        break;
+      }
+    }
+  }
+  return sources;
+}
+
+}  // namespace bustub
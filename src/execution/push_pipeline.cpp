@@ -0,0 +1,171 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// push_pipeline.cpp
+//
+// Identification: src/execution/push_pipeline.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "execution/push_pipeline.h"
+
+#include <unordered_map>
+#include <utility>
+
+#include "execution/executor_factory.h"
+#include "execution/executors/hash_join_executor.h"
+#include "execution/executors/seq_scan_executor.h"
+#include "execution/memory_manager.h"
+
+namespace bustub {
+
+class PushPipeline::ProbeStage : public PushStage {
+ public:
+  ProbeStage(ExecutorContext *exec_ctx, const HashJoinPlanNode *plan)
+      : exec_ctx_(exec_ctx),
+        plan_(plan),
+        memory_(exec_ctx, MemoryCategory::HASH_JOIN),
+        output_(plan->OutputSchema()) {}
+
+  void SetNext(PushStage *next) { next_ = next; }
+
+  /**
+   * Builds the hash table of the left child, by running it as an executor.
+   * @return false if the table outgrew the memory budget
+   */
+  bool Build() {
+    hash_table_.clear();
+    memory_.Resize(0);
+    auto left_executor = ExecutorFactory::CreateExecutor(exec_ctx_, plan_->GetLeftPlan());
+    left_executor->Init();
+    const Schema *left_schema = left_executor->GetOutputSchema();
+    size_t bytes = 0;
+    Tuple tuple;
+    RID rid;
+    HashJoinKey key;
+    while (left_executor->Next(&tuple, &rid)) {
+      key.keys_.clear();
+      bool has_null = false;
+      for (const AbstractExpression *expr : plan_->GetLeftKeys()) {
+        key.keys_.push_back(expr->Evaluate(&tuple, left_schema));
+        has_null = has_null || key.keys_.back().IsNull();
+      }
+      if (has_null) {
+        continue;
+      }
+      bytes += sizeof(Tuple) + tuple.GetLength();
+      if (!memory_.Resize(bytes)) {
+        return false;
+      }
+      std::vector<Tuple> &bucket = hash_table_[key];
+      if (tuple.IsAllocated()) {
+        bucket.push_back(std::move(tuple));
+      } else {
+        bucket.emplace_back().CopyFrom(tuple);
+      }
+    }
+    left_schema_ = left_schema;
+    return true;
+  }
+
+  bool Consume(DataChunk *chunk) override {
+    HashJoinKey key;
+    for (size_t i = 0; i < chunk->GetSelectedCount(); i++) {
+      uint32_t row = chunk->GetSelectedRow(i);
+      bool has_key = HashJoinExecutor::MakeKey(*chunk, row, plan_->GetRightKeys(), &key);
+      auto bucket = has_key ? hash_table_.find(key) : hash_table_.end();
+      if (plan_->GetJoinType() != JoinType::INNER) {
+        // a row of a SEMI or an ANTI join is of the probing row alone
+        if ((bucket != hash_table_.end()) == (plan_->GetJoinType() == JoinType::SEMI)) {
+          left_tuples_.push_back(nullptr);
+          right_rows_.push_back(row);
+          if (right_rows_.size() == output_.GetCapacity() && !Flush(*chunk)) {
+            return false;
+          }
+        }
+        continue;
+      }
+      if (bucket == hash_table_.end()) {
+        continue;
+      }
+      for (const Tuple &left_tuple : bucket->second) {
+        left_tuples_.push_back(&left_tuple);
+        right_rows_.push_back(row);
+        if (right_rows_.size() == output_.GetCapacity() && !Flush(*chunk)) {
+          return false;
+        }
+      }
+    }
+    // the matches refer to the rows of the batch, so they go on before it is let go of
+    return right_rows_.empty() || Flush(*chunk);
+  }
+
+ private:
+  bool Flush(const DataChunk &chunk) {
+    output_.Reset();
+    HashJoinExecutor::MakeOutput(plan_->OutputSchema(), left_schema_, left_tuples_, chunk, right_rows_, &output_);
+    left_tuples_.clear();
+    right_rows_.clear();
+    return next_->Consume(&output_);
+  }
+
+  ExecutorContext *exec_ctx_;
+  const HashJoinPlanNode *plan_;
+  const Schema *left_schema_{nullptr};
+  PushStage *next_{nullptr};
+  std::unordered_map<HashJoinKey, std::vector<Tuple>> hash_table_;
+  MemoryReservation memory_;
+  /** The matches that make up the next output batch, which is pushed into next_ */
+  std::vector<const Tuple *> left_tuples_;
+  std::vector<uint32_t> right_rows_;
+  DataChunk output_;
+};
+
+PushPipeline::PushPipeline(ExecutorContext *exec_ctx, const SeqScanPlanNode *scan_plan, const Schema *output_schema)
+    : exec_ctx_(exec_ctx), scan_plan_(scan_plan), output_schema_(output_schema) {}
+
+PushPipeline::~PushPipeline() = default;
+
+std::unique_ptr<PushPipeline> PushPipeline::Compile(ExecutorContext *exec_ctx, const AbstractPlanNode *plan) {
+  std::vector<const HashJoinPlanNode *> joins;
+  const AbstractPlanNode *source = plan;
+  while (source->GetType() == PlanType::HashJoin) {
+    const auto *join_plan = dynamic_cast<const HashJoinPlanNode *>(source);
+    joins.push_back(join_plan);
+    source = join_plan->GetRightPlan();
+  }
+  if (source->GetType() != PlanType::SeqScan) {
+    return nullptr;
+  }
+  std::unique_ptr<PushPipeline> pipeline(
+      new PushPipeline(exec_ctx, dynamic_cast<const SeqScanPlanNode *>(source), plan->OutputSchema()));
+  for (auto join = joins.rbegin(); join != joins.rend(); ++join) {
+    pipeline->probes_.push_back(std::make_unique<ProbeStage>(exec_ctx, *join));
+  }
+  return pipeline;
+}
+
+bool PushPipeline::Run(PushStage *sink) {
+  for (size_t i = 0; i < probes_.size(); i++) {
+    if (!probes_[i]->Build()) {
+      return false;
+    }
+    probes_[i]->SetNext(i + 1 < probes_.size() ? static_cast<PushStage *>(probes_[i + 1].get()) : sink);
+  }
+  PushStage *first = probes_.empty() ? sink : probes_.front().get();
+
+  SeqScanExecutor scan(exec_ctx_, scan_plan_);
+  scan.Init();
+  DataChunk chunk(scan_plan_->OutputSchema());
+  while (scan.NextBatch(&chunk)) {
+    if (!first->Consume(&chunk)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+}  // namespace bustub
@@ -0,0 +1,112 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// quantile_sketch.cpp
+//
+// Identification: src/execution/quantile_sketch.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "execution/quantile_sketch.h"
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+#include "common/macros.h"
+
+namespace bustub {
+
+size_t QuantileSketch::Capacity(size_t level) const {
+  size_t depth = levels_.size() - 1 - level;
+  return std::max<size_t>(2, static_cast<size_t>(static_cast<double>(K) * std::pow(2.0 / 3.0, depth)));
+}
+
+void QuantileSketch::Insert(double value) {
+  if (levels_.empty()) {
+    levels_.emplace_back();
+  }
+  levels_[0].push_back(value);
+  min_ = count_ == 0 ? value : std::min(min_, value);
+  max_ = count_ == 0 ? value : std::max(max_, value);
+  count_++;
+  if (levels_[0].size() >= Capacity(0)) {
+    Compress();
+  }
+}
+
+void QuantileSketch::Merge(const QuantileSketch &other) {
+  if (levels_.size() < other.levels_.size()) {
+    levels_.resize(other.levels_.size());
+  }
+  for (size_t level = 0; level < other.levels_.size(); level++) {
+    levels_[level].insert(levels_[level].end(), other.levels_[level].begin(), other.levels_[level].end());
+  }
+  if (other.count_ != 0) {
+    min_ = count_ == 0 ? other.min_ : std::min(min_, other.min_);
+    max_ = count_ == 0 ? other.max_ : std::max(max_, other.max_);
+  }
+  count_ += other.count_;
+  Compress();
+}
+
+void QuantileSketch::Compress() {
+  size_t level = 0;
+  while (level < levels_.size()) {
+    if (levels_[level].size() < Capacity(level)) {
+      level++;
+      continue;
+    }
+    if (level + 1 == levels_.size()) {
+      // the capacities of the levels below shrink with the new top, so they are looked at again
+      levels_.emplace_back();
+      level = 0;
+      continue;
+    }
+    // an odd one out, the smallest, stays where it is, so that the weight of the values is kept
+    std::vector<double> &compactor = levels_[level];
+    std::sort(compactor.begin(), compactor.end());
+    size_t keep = compactor.size() % 2;
+    // a toggle per level, as one shared by all would pick the same positions at levels that compact one after another
+    odd_.resize(levels_.size(), false);
+    for (size_t i = keep + (odd_[level] ? 1 : 0); i < compactor.size(); i += 2) {
+      levels_[level + 1].push_back(compactor[i]);
+    }
+    odd_[level] = !odd_[level];
+    compactor.resize(keep);
+    level++;
+  }
+}
+
+double QuantileSketch::Quantile(double fraction) const {
+  BUSTUB_ASSERT(count_ != 0, "an empty sketch has no quantiles");
+  if (fraction <= 0) {
+    return min_;
+  }
+  if (fraction >= 1) {
+    return max_;
+  }
+  std::vector<std::pair<double, uint64_t>> weighted;
+  uint64_t total = 0;
+  for (size_t level = 0; level < levels_.size(); level++) {
+    for (double value : levels_[level]) {
+      weighted.emplace_back(value, uint64_t{1} << level);
+      total += uint64_t{1} << level;
+    }
+  }
+  std::sort(weighted.begin(), weighted.end());
+  const double target = fraction * static_cast<double>(total);
+  uint64_t rank = 0;
+  for (const auto &[value, weight] : weighted) {
+    rank += weight;
+    if (static_cast<double>(rank) >= target) {
+      return value;
+    }
+  }
+  return max_;
+}
+
+}  // namespace bustub
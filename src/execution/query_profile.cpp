@@ -0,0 +1,124 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// query_profile.cpp
+//
+// Identification: src/execution/query_profile.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "execution/query_profile.h"
+
+#include <sstream>
+
+namespace bustub {
+
+const char *PlanTypeName(PlanType type) {
+  switch (type) {
+    case PlanType::SeqScan:
+      return "SeqScan";
+    case PlanType::SampleScan:
+      return "SampleScan";
+    case PlanType::IndexScan:
+      return "IndexScan";
+    case PlanType::BitmapScan:
+      return "BitmapScan";
+    case PlanType::Insert:
+      return "Insert";
+    case PlanType::Update:
+      return "Update";
+    case PlanType::Delete:
+      return "Delete";
+    case PlanType::Aggregation:
+      return "Aggregation";
+    case PlanType::Limit:
+      return "Limit";
+    case PlanType::NestedLoopJoin:
+      return "NestedLoopJoin";
+    case PlanType::NestedIndexJoin:
+      return "NestedIndexJoin";
+    case PlanType::HashJoin:
+      return "HashJoin";
+    case PlanType::MergeJoin:
+      return "MergeJoin";
+    case PlanType::Sort:
+      return "Sort";
+    case PlanType::Projection:
+      return "Projection";
+    case PlanType::Distinct:
+      return "Distinct";
+  }
+  return "Unknown";
+}
+
+namespace {
+
+void Print(const OperatorProfile &profile, size_t depth, std::ostringstream *os) {
+  *os << std::string(depth * 2, ' ') << PlanTypeName(profile.type_);
+  if (profile.executors_ == 0) {
+    *os << " (not run on its own)\n";
+  } else {
+    *os << " (rows=" << profile.rows_ << " calls=" << profile.calls_ << " time=" << profile.wall_ns_ / 1000
+        << "us self=" << profile.GetSelfWallNs() / 1000 << "us cpu=" << profile.cpu_ns_ / 1000
+        << "us hits=" << profile.page_hits_ << " misses=" << profile.page_misses_
+        << " spilled=" << profile.spilled_bytes_ << "B)\n";
+  }
+  for (const OperatorProfile &child : profile.children_) {
+    Print(child, depth + 1, os);
+  }
+}
+
+}  // namespace
+
+uint64_t OperatorProfile::GetSelfWallNs() const {
+  uint64_t children_ns = 0;
+  for (const OperatorProfile &child : children_) {
+    children_ns += child.wall_ns_;
+  }
+  // the children of a pipeline breaker may run on other threads, alongside it
+  return wall_ns_ > children_ns ? wall_ns_ - children_ns : 0;
+}
+
+std::string OperatorProfile::ToString() const {
+  std::ostringstream os;
+  Print(*this, 0, &os);
+  return os.str();
+}
+
+OperatorCounters *QueryProfile::GetCounters(const AbstractPlanNode *plan) {
+  std::scoped_lock lock(latch_);
+  std::unique_ptr<OperatorCounters> &counters = counters_[plan];
+  if (counters == nullptr) {
+    counters = std::make_unique<OperatorCounters>();
+  }
+  return counters.get();
+}
+
+OperatorProfile QueryProfile::Report(const AbstractPlanNode *plan) const {
+  OperatorProfile profile;
+  profile.type_ = plan->GetType();
+  {
+    std::scoped_lock lock(latch_);
+    auto counters = counters_.find(plan);
+    if (counters != counters_.end()) {
+      const OperatorCounters &c = *counters->second;
+      profile.executors_ = c.executors_.load(std::memory_order_relaxed);
+      profile.rows_ = c.rows_.load(std::memory_order_relaxed);
+      profile.calls_ = c.calls_.load(std::memory_order_relaxed);
+      profile.wall_ns_ = c.wall_ns_.load(std::memory_order_relaxed);
+      profile.cpu_ns_ = c.cpu_ns_.load(std::memory_order_relaxed);
+      profile.page_hits_ = c.page_hits_.load(std::memory_order_relaxed);
+      profile.page_misses_ = c.page_misses_.load(std::memory_order_relaxed);
+      profile.spilled_bytes_ = c.spilled_bytes_.load(std::memory_order_relaxed);
+    }
+  }
+  for (const AbstractPlanNode *child : plan->GetChildren()) {
+    profile.children_.push_back(Report(child));
+  }
+  return profile;
+}
+
+}  // namespace bustub
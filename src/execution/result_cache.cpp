@@ -0,0 +1,360 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// result_cache.cpp
+//
+// Identification: src/execution/result_cache.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "execution/result_cache.h"
+
+#include <algorithm>
+#include <cstring>
+#include <utility>
+
+#include "execution/expressions/aggregate_value_expression.h"
+#include "execution/expressions/arithmetic_expression.h"
+#include "execution/expressions/column_value_expression.h"
+#include "execution/expressions/comparison_expression.h"
+#include "execution/expressions/conjunction_expression.h"
+#include "execution/expressions/constant_value_expression.h"
+#include "execution/expressions/parameter_value_expression.h"
+#include "execution/plans/aggregation_plan.h"
+#include "execution/plans/bitmap_scan_plan.h"
+#include "execution/plans/hash_join_plan.h"
+#include "execution/plans/index_scan_plan.h"
+#include "execution/plans/limit_plan.h"
+#include "execution/plans/merge_join_plan.h"
+#include "execution/plans/nested_index_join_plan.h"
+#include "execution/plans/nested_loop_join_plan.h"
+#include "execution/plans/seq_scan_plan.h"
+#include "execution/plans/sort_plan.h"
+
+namespace bustub {
+
+namespace {
+
+/**
+ * Writes the fingerprint of a plan: a tag and the attributes of each node and expression, in the order of a walk of
+ * the tree, each of fixed width or preceded by its length, so that two plans have the same fingerprint only if they
+ * are the same.
+ */
+class FingerprintWriter {
+ public:
+  explicit FingerprintWriter(Catalog *catalog) : catalog_(catalog) {}
+
+  /** @return false if the plan cannot be cached */
+  bool Plan(const AbstractPlanNode *plan) {
+    Int(static_cast<uint64_t>(plan->GetType()));
+    if (!OutputSchema(plan->OutputSchema())) {
+      return false;
+    }
+    bool ok = true;
+    switch (plan->GetType()) {
+      case PlanType::SeqScan: {
+        auto scan = dynamic_cast<const SeqScanPlanNode *>(plan);
+        ok = Expr(scan->GetPredicate()) && Table(scan->GetTableOid());
+        break;
+      }
+      case PlanType::IndexScan: {
+        auto scan = dynamic_cast<const IndexScanPlanNode *>(plan);
+        IndexInfo *index_info = catalog_->GetIndex(scan->GetIndexOid());
+        const IndexKeyRange &range = scan->GetKeyRange();
+        Int(scan->GetIndexOid());
+        Int(scan->IsIndexOnly());
+        Int(range.IsEquality());
+        Int(range.lower_inclusive_);
+        Int(range.upper_inclusive_);
+        ok = Expr(scan->GetPredicate()) && Expr(range.lower_) && Expr(range.upper_) &&
+             Table(catalog_->GetTable(index_info->table_name_)->oid_);
+        break;
+      }
+      case PlanType::BitmapScan: {
+        auto scan = dynamic_cast<const BitmapScanPlanNode *>(plan);
+        Int(scan->GetConditions().size());
+        for (const BitmapCondition &condition : scan->GetConditions()) {
+          Int(condition.index_oid_);
+          Int(condition.keys_.size());
+          for (const std::vector<Value> &key : condition.keys_) {
+            Literals(key);
+          }
+        }
+        ok = Expr(scan->GetPredicate()) && Table(scan->GetTableOid());
+        break;
+      }
+      case PlanType::Aggregation: {
+        auto aggregation = dynamic_cast<const AggregationPlanNode *>(plan);
+        for (AggregationType type : aggregation->GetAggregateTypes()) {
+          Int(static_cast<uint64_t>(type));
+        }
+        for (double percentile : aggregation->GetPercentiles()) {
+          Double(percentile);
+        }
+        Int(aggregation->GetNumThreads());
+        ok = Expr(aggregation->GetHaving()) && Exprs(aggregation->GetGroupBys()) &&
+             Exprs(aggregation->GetAggregates());
+        break;
+      }
+      case PlanType::Limit: {
+        auto limit = dynamic_cast<const LimitPlanNode *>(plan);
+        Int(limit->GetLimit());
+        Int(limit->GetOffset());
+        break;
+      }
+      case PlanType::NestedLoopJoin:
+        ok = Expr(dynamic_cast<const NestedLoopJoinPlanNode *>(plan)->Predicate());
+        break;
+      case PlanType::NestedIndexJoin: {
+        auto join = dynamic_cast<const NestedIndexJoinPlanNode *>(plan);
+        Int(static_cast<uint64_t>(join->GetJoinType()));
+        String(join->GetIndexName());
+        ok = Expr(join->Predicate()) && OutputSchema(join->OuterTableSchema()) &&
+             OutputSchema(join->InnerTableSchema()) && Table(join->GetInnerTableOid());
+        break;
+      }
+      case PlanType::HashJoin: {
+        auto join = dynamic_cast<const HashJoinPlanNode *>(plan);
+        Int(static_cast<uint64_t>(join->GetJoinType()));
+        Int(join->GetNumThreads());
+        ok = Exprs(join->GetLeftKeys()) && Exprs(join->GetRightKeys());
+        break;
+      }
+      case PlanType::MergeJoin: {
+        auto join = dynamic_cast<const MergeJoinPlanNode *>(plan);
+        ok = Exprs(join->GetLeftKeys()) && Exprs(join->GetRightKeys());
+        break;
+      }
+      case PlanType::Sort: {
+        auto sort = dynamic_cast<const SortPlanNode *>(plan);
+        Int(sort->GetOrderBys().size());
+        for (const auto &[type, expr] : sort->GetOrderBys()) {
+          Int(static_cast<uint64_t>(type));
+          ok = ok && Expr(expr);
+        }
+        break;
+      }
+      case PlanType::Projection:
+      case PlanType::Distinct:
+        break;
+      default:
+        // writes, and samples, which differ from run to run
+        return false;
+    }
+    Int(plan->GetChildren().size());
+    for (const AbstractPlanNode *child : plan->GetChildren()) {
+      ok = ok && Plan(child);
+    }
+    return ok;
+  }
+
+  std::string fingerprint_;
+  std::vector<TableHeap *> heaps_;
+
+ private:
+  void Int(uint64_t value) { fingerprint_.append(reinterpret_cast<const char *>(&value), sizeof(value)); }
+
+  void Double(double value) {
+    uint64_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    Int(bits);
+  }
+
+  void String(const std::string &value) {
+    Int(value.size());
+    fingerprint_.append(value);
+  }
+
+  void Literal(const Value &value) {
+    Int(static_cast<uint64_t>(value.GetTypeId()));
+    Int(value.IsNull());
+    if (value.IsNull()) {
+      return;
+    }
+    std::string bytes(value.GetTypeId() == TypeId::VARCHAR ? sizeof(uint32_t) + value.GetLength()
+                                                           : Type::GetTypeSize(value.GetTypeId()),
+                      '\0');
+    value.SerializeTo(bytes.data());
+    String(bytes);
+  }
+
+  void Literals(const std::vector<Value> &values) {
+    Int(values.size());
+    for (const Value &value : values) {
+      Literal(value);
+    }
+  }
+
+  /** @return false if an expression is of a kind the writer does not know */
+  bool Expr(const AbstractExpression *expr) {
+    if (expr == nullptr) {
+      Int(0);
+      return true;
+    }
+    if (auto column = dynamic_cast<const ColumnValueExpression *>(expr); column != nullptr) {
+      Int(1);
+      Int(column->GetTupleIdx());
+      Int(column->GetColIdx());
+    } else if (auto constant = dynamic_cast<const ConstantValueExpression *>(expr); constant != nullptr) {
+      Int(2);
+      Literal(constant->Evaluate(nullptr, nullptr));
+    } else if (auto parameter = dynamic_cast<const ParameterValueExpression *>(expr); parameter != nullptr) {
+      // the value bound, so that the runs of a plan with other values are told apart
+      Int(3);
+      Literal(parameter->GetValue());
+    } else if (auto comparison = dynamic_cast<const ComparisonExpression *>(expr); comparison != nullptr) {
+      Int(4);
+      Int(static_cast<uint64_t>(comparison->GetComparisonType()));
+    } else if (auto arithmetic = dynamic_cast<const ArithmeticExpression *>(expr); arithmetic != nullptr) {
+      Int(5);
+      Int(static_cast<uint64_t>(arithmetic->GetArithmeticType()));
+    } else if (dynamic_cast<const ConjunctionExpression *>(expr) != nullptr) {
+      Int(6);
+    } else if (auto aggregate = dynamic_cast<const AggregateValueExpression *>(expr); aggregate != nullptr) {
+      Int(7);
+      Int(aggregate->IsGroupByTerm());
+      Int(aggregate->GetTermIdx());
+    } else {
+      return false;
+    }
+    Int(static_cast<uint64_t>(expr->GetReturnType()));
+    return Exprs(expr->GetChildren());
+  }
+
+  bool Exprs(const std::vector<const AbstractExpression *> &exprs) {
+    Int(exprs.size());
+    return std::all_of(exprs.begin(), exprs.end(), [this](const AbstractExpression *expr) { return Expr(expr); });
+  }
+
+  bool OutputSchema(const Schema *schema) {
+    Int(schema->GetColumnCount());
+    for (const Column &column : schema->GetColumns()) {
+      String(column.GetName());
+      Int(static_cast<uint64_t>(column.GetType()));
+      Int(column.GetLength());
+      if (!Expr(column.GetExpr())) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  /** @return false if the table is of another layout than ROW */
+  bool Table(table_oid_t table_oid) {
+    TableMetadata *table_info = catalog_->GetTable(table_oid);
+    if (table_info->layout_ != TableLayout::ROW) {
+      return false;
+    }
+    Int(table_oid);
+    for (TableHeap *heap : table_info->GetHeaps()) {
+      heaps_.push_back(heap);
+    }
+    return true;
+  }
+
+  Catalog *catalog_;
+};
+
+}  // namespace
+
+std::optional<ResultCache::CacheablePlan> ResultCache::Fingerprint(const AbstractPlanNode *plan, Catalog *catalog) {
+  FingerprintWriter writer(catalog);
+  if (!writer.Plan(plan)) {
+    return std::nullopt;
+  }
+  std::sort(writer.heaps_.begin(), writer.heaps_.end());
+  writer.heaps_.erase(std::unique(writer.heaps_.begin(), writer.heaps_.end()), writer.heaps_.end());
+  return CacheablePlan{std::move(writer.fingerprint_), std::move(writer.heaps_)};
+}
+
+bool ResultCache::CanUse(Transaction *txn, const CacheablePlan &plan) {
+  // a hit takes no locks, which a transaction that holds its read locks to the end would need to
+  if (txn->GetIsolationLevel() != IsolationLevel::READ_COMMITTED) {
+    return false;
+  }
+  // the transaction's own writes are not in the results of others, nor may its results go to others
+  return std::none_of(txn->GetWriteSet()->begin(), txn->GetWriteSet()->end(), [&](const TableWriteRecord &record) {
+    return std::binary_search(plan.heaps_.begin(), plan.heaps_.end(), record.table_);
+  });
+}
+
+std::vector<uint64_t> ResultCache::Versions(const CacheablePlan &plan) {
+  std::vector<uint64_t> versions;
+  versions.reserve(plan.heaps_.size());
+  for (TableHeap *heap : plan.heaps_) {
+    versions.push_back(heap->GetModificationCount());
+  }
+  return versions;
+}
+
+bool ResultCache::Lookup(const CacheablePlan &plan, std::vector<Tuple> *rows) {
+  std::scoped_lock lock(latch_);
+  auto it = index_.find(plan.fingerprint_);
+  if (it == index_.end()) {
+    stats_.misses_++;
+    return false;
+  }
+  if (it->second->versions_ != Versions(plan)) {
+    Erase(it->second);
+    stats_.misses_++;
+    return false;
+  }
+  entries_.splice(entries_.begin(), entries_, it->second);
+  rows->insert(rows->end(), it->second->rows_.begin(), it->second->rows_.end());
+  stats_.hits_++;
+  return true;
+}
+
+void ResultCache::Insert(const CacheablePlan &plan, std::vector<uint64_t> versions, std::vector<Tuple> rows) {
+  // a commit while the plan ran may or may not be in its rows
+  if (versions != Versions(plan)) {
+    return;
+  }
+  size_t bytes = plan.fingerprint_.size();
+  for (const Tuple &row : rows) {
+    bytes += sizeof(Tuple) + row.GetLength();
+  }
+  if (bytes > capacity_) {
+    return;
+  }
+  std::scoped_lock lock(latch_);
+  if (auto it = index_.find(plan.fingerprint_); it != index_.end()) {
+    Erase(it->second);
+  }
+  while (size_ + bytes > capacity_) {
+    Erase(std::prev(entries_.end()));
+    stats_.evictions_++;
+  }
+  entries_.push_front(Entry{plan.fingerprint_, std::move(versions), std::move(rows), bytes});
+  index_[plan.fingerprint_] = entries_.begin();
+  size_ += bytes;
+  stats_.inserts_++;
+}
+
+void ResultCache::Erase(std::list<Entry>::iterator it) {
+  size_ -= it->bytes_;
+  index_.erase(it->fingerprint_);
+  entries_.erase(it);
+}
+
+void ResultCache::Clear() {
+  std::scoped_lock lock(latch_);
+  entries_.clear();
+  index_.clear();
+  size_ = 0;
+}
+
+size_t ResultCache::GetSize() {
+  std::scoped_lock lock(latch_);
+  return size_;
+}
+
+ResultCacheStats ResultCache::GetStats() {
+  std::scoped_lock lock(latch_);
+  return stats_;
+}
+
+}  // namespace bustub
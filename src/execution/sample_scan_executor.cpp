@@ -0,0 +1,89 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// sample_scan_executor.cpp
+//
+// Identification: src/execution/sample_scan_executor.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+#include "execution/executors/sample_scan_executor.h"
+
+#include <utility>
+#include <vector>
+
+#include "common/exception.h"
+
+namespace bustub {
+
+SampleScanExecutor::SampleScanExecutor(ExecutorContext *exec_ctx, const SampleScanPlanNode *plan)
+    : AbstractExecutor(exec_ctx), plan_(plan) {}
+
+void SampleScanExecutor::Init() {
+  TableMetadata *table_info = GetExecutorContext()->GetCatalog()->GetTable(plan_->GetTableOid());
+  if (table_info->layout_ != TableLayout::ROW || table_info->partitions_ != nullptr) {
+    throw Exception(ExceptionType::NOT_IMPLEMENTED, "only tables of rows that are not partitioned are sampled");
+  }
+  const double fraction = plan_->GetFraction();
+  if (!(fraction >= 0 && fraction <= 1)) {
+    throw Exception(ExceptionType::INVALID, "the fraction of a sample is between 0 and 1");
+  }
+  table_schema_ = &table_info->schema_;
+  TableHeap *table = table_info->table_.get();
+  toast_ = table->GetToastStore();
+  auto *bpm = GetExecutorContext()->GetBufferPoolManager();
+  Transaction *txn = GetExecutorContext()->GetTransaction();
+  // a scan started over lets go of its pages before the strategy they came through
+  scanner_.reset();
+  strategy_ = std::make_unique<BufferAccessStrategy>(BufferAccessStrategy::BulkRingSize(bpm->GetPoolSize()));
+
+  random_.seed(plan_->GetSeed());
+  if (plan_->GetMethod() == SampleMethod::SYSTEM) {
+    pick_ = std::bernoulli_distribution(1);
+    scanner_ = std::make_unique<TablePageScanner>(
+        table, txn, table->GetSampledPageIds(fraction, plan_->GetSeed(), strategy_.get()), strategy_.get());
+  } else {
+    pick_ = std::bernoulli_distribution(fraction);
+    scanner_ = std::make_unique<TablePageScanner>(table, txn, strategy_.get());
+  }
+}
+
+bool SampleScanExecutor::Next(Tuple *tuple, RID *rid) {
+  const Schema *output_schema = plan_->OutputSchema();
+  Tuple view;
+  Tuple detoasted;
+  while (scanner_->Next(&view)) {
+    // every row is picked or not, whether it passes the predicate or not, so that the sample does not depend on it
+    if (!pick_(random_)) {
+      continue;
+    }
+    const Tuple *row = &view;
+    if (toast_ != nullptr && toast_->IsToasted(view)) {
+      toast_->Detoast(view, &detoasted);
+      row = &detoasted;
+    }
+    if (plan_->GetPredicate() != nullptr) {
+      Value result = plan_->GetPredicate()->Evaluate(row, table_schema_);
+      if (result.IsNull() || !result.GetAs<bool>()) {
+        continue;
+      }
+    }
+    std::vector<Value> values;
+    values.reserve(output_schema->GetColumnCount());
+    for (uint32_t i = 0; i < output_schema->GetColumnCount(); i++) {
+      const AbstractExpression *expr = output_schema->GetColumn(i).GetExpr();
+      values.push_back(expr != nullptr ? expr->Evaluate(row, table_schema_) : row->GetValue(table_schema_, i));
+    }
+    *tuple = Tuple(std::move(values), output_schema);
+    *rid = row->GetRid();
+    tuple->SetRid(*rid);
+    // the page is let go of before the caller may write to it
+    scanner_->Release();
+    return true;
+  }
+  return false;
+}
+
+}  // namespace bustub
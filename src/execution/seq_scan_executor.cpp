@@ -11,31 +11,413 @@
 //===----------------------------------------------------------------------===//
 #include "execution/executors/seq_scan_executor.h"
 
+#include <algorithm>
+#include <cstdint>
+#include <optional>
+#include <utility>
+#include <vector>
+
+#include "execution/expressions/column_value_expression.h"
+#include "execution/expressions/comparison_expression.h"
+#include "execution/expressions/constant_value_expression.h"
+#include "execution/executors/projection_executor.h"
+#include "type/value_factory.h"
+
 namespace bustub {
 
-SeqScanExecutor::SeqScanExecutor(ExecutorContext *exec_ctx, const SeqScanPlanNode *plan) : AbstractExecutor(exec_ctx), plan_(plan) {}
+namespace {
+/** Marks the columns an expression reads. */
+void CollectColumns(const AbstractExpression *expr, std::vector<bool> *used) {
+  if (const auto *column = dynamic_cast<const ColumnValueExpression *>(expr); column != nullptr) {
+    (*used)[column->GetColIdx()] = true;
+  }
+  for (const AbstractExpression *child : expr->GetChildren()) {
+    CollectColumns(child, used);
+  }
+}
+
+/**
+ * @return the range of a column that a predicate of the form "column op constant", or "constant op column", limits
+ * the rows to, if it is of that form
+ */
+std::optional<ZoneRange> RangeOf(const AbstractExpression *predicate) {
+  const auto *comparison = dynamic_cast<const ComparisonExpression *>(predicate);
+  if (comparison == nullptr) {
+    return std::nullopt;
+  }
+  ComparisonType type = comparison->GetComparisonType();
+  const auto *column = dynamic_cast<const ColumnValueExpression *>(comparison->GetChildAt(0));
+  const auto *constant = dynamic_cast<const ConstantValueExpression *>(comparison->GetChildAt(1));
+  if (column == nullptr) {
+    // constant < column is column > constant
+    column = dynamic_cast<const ColumnValueExpression *>(comparison->GetChildAt(1));
+    constant = dynamic_cast<const ConstantValueExpression *>(comparison->GetChildAt(0));
+    switch (type) {
+      case ComparisonType::LessThan:
+        type = ComparisonType::GreaterThan;
+        break;
+      case ComparisonType::LessThanOrEqual:
+        type = ComparisonType::GreaterThanOrEqual;
+        break;
+      case ComparisonType::GreaterThan:
+        type = ComparisonType::LessThan;
+        break;
+      case ComparisonType::GreaterThanOrEqual:
+        type = ComparisonType::LessThanOrEqual;
+        break;
+      default:
+        break;
+    }
+  }
+  if (column == nullptr || constant == nullptr) {
+    return std::nullopt;
+  }
+  Value value = constant->Evaluate(nullptr, nullptr);
+  if (value.IsNull()) {
+    return std::nullopt;
+  }
+  // the bounds are inclusive, which keeps the pages of a strict comparison's constant too
+  ZoneRange range{column->GetColIdx(), std::nullopt, std::nullopt};
+  switch (type) {
+    case ComparisonType::Equal:
+      range.min_ = value;
+      range.max_ = value;
+      break;
+    case ComparisonType::LessThan:
+    case ComparisonType::LessThanOrEqual:
+      range.max_ = value;
+      break;
+    case ComparisonType::GreaterThan:
+    case ComparisonType::GreaterThanOrEqual:
+      range.min_ = value;
+      break;
+    default:
+      return std::nullopt;
+  }
+  return range;
+}
+}  // namespace
+
+std::vector<TableHeap *> SeqScanExecutor::ScannedHeaps(TableMetadata *table_info,
+                                                       const AbstractExpression *predicate) {
+  if (table_info->partitions_ == nullptr) {
+    return {table_info->table_.get()};
+  }
+  PartitionedTable *partitions = table_info->partitions_.get();
+  std::optional<ZoneRange> range = predicate != nullptr ? RangeOf(predicate) : std::nullopt;
+  if (!range.has_value()) {
+    return partitions->GetPartitions();
+  }
+  std::vector<TableHeap *> heaps;
+  for (size_t partition : partitions->PartitionsOf(*range)) {
+    heaps.push_back(partitions->GetPartition(partition));
+  }
+  return heaps;
+}
+
+SeqScanExecutor::SeqScanExecutor(ExecutorContext *exec_ctx, const SeqScanPlanNode *plan)
+    : AbstractExecutor(exec_ctx), plan_(plan) {}
 
 void SeqScanExecutor::Init() {
   const auto &catalog = GetExecutorContext()->GetCatalog();
-  table_ = catalog->GetTable(plan_->GetTableOid())->table_.get();
-  iter_ = std::make_unique<TableIterator>(table_->Begin(GetExecutorContext()->GetTransaction()));
+  TableMetadata *table_info = catalog->GetTable(plan_->GetTableOid());
+  auto *bpm = GetExecutorContext()->GetBufferPoolManager();
+  // a REPEATABLE_READ scan keeps every record it reads locked, which one shared lock of the table does for all of them;
+  // a SERIALIZABLE one keeps rows from being inserted as well, which the lock of the table does too
+  Transaction *txn = GetExecutorContext()->GetTransaction();
+  LockManager *lock_manager = GetExecutorContext()->GetLockManager();
+  bool locks_table = txn->GetIsolationLevel() == IsolationLevel::REPEATABLE_READ ||
+                     txn->GetIsolationLevel() == IsolationLevel::SERIALIZABLE;
+  if (enable_logging && lock_manager != nullptr && locks_table &&
+      !lock_manager->LockTable(txn, table_info->oid_, LockMode::SHARED)) {
+    throw TransactionAbortException(txn->GetTransactionId(), AbortReason::DEADLOCK);
+  }
+  // a scan started over lets go of its pages before the strategy they came through
+  scanner_.reset();
+  pax_scanner_.reset();
+  memory_table_ = nullptr;
+  memory_position_ = 0;
+  clustered_scanner_.reset();
+  returned_ = 0;
+  strategy_ = std::make_unique<BufferAccessStrategy>(BufferAccessStrategy::BulkRingSize(bpm->GetPoolSize()));
+
+  table_schema_ = &table_info->schema_;
+  std::vector<bool> used(table_schema_->GetColumnCount(), false);
+  for (const Column &column : GetOutputSchema()->GetColumns()) {
+    if (column.GetExpr() == nullptr) {
+      // an output column that does not say what it is made of may be any of them
+      used.assign(used.size(), true);
+      break;
+    }
+    CollectColumns(column.GetExpr(), &used);
+  }
+  compiled_predicate_.reset();
+  if (plan_->GetPredicate() != nullptr) {
+    CollectColumns(plan_->GetPredicate(), &used);
+    // the rows are tuples of the table's layout, whether views of its pages or partial ones
+    compiled_predicate_ = CompiledPredicate::Compile(plan_->GetPredicate(), table_schema_);
+  }
+  read_columns_.clear();
+  for (uint32_t i = 0; i < used.size(); i++) {
+    if (used[i]) {
+      read_columns_.push_back(i);
+    }
+  }
+
+  // a copy of a tuple is the row of the output schema as it is if the output columns are the first columns of the
+  // table, in their order and with their null bits where they are; only fixed-width columns may be left out of it
+  const Schema *output_schema = GetOutputSchema();
+  sources_ = ProjectionExecutor::SharedColumns(output_schema);
+  copy_rows_ = output_schema->GetColumnCount() <= table_schema_->GetColumnCount() &&
+               Tuple::NullBitmapSize(output_schema) == Tuple::NullBitmapSize(table_schema_);
+  for (uint32_t i = 0; copy_rows_ && i < table_schema_->GetColumnCount(); i++) {
+    if (i >= output_schema->GetColumnCount()) {
+      copy_rows_ = table_schema_->GetColumn(i).IsInlined();
+      continue;
+    }
+    const AbstractExpression *expr = output_schema->GetColumn(i).GetExpr();
+    const auto *column = dynamic_cast<const ColumnValueExpression *>(expr);
+    copy_rows_ = (expr == nullptr || (column != nullptr && column->GetColIdx() == i)) &&
+                 output_schema->GetType(i) == table_schema_->GetType(i);
+  }
+
+  if (table_info->layout_ == TableLayout::ROW) {
+    heaps_ = ScannedHeaps(table_info, plan_->GetPredicate());
+    next_heap_ = 0;
+    OpenNextHeap();
+    return;
+  }
+  if (table_info->layout_ == TableLayout::MEMORY) {
+    memory_table_ = table_info->memory_table_.get();
+    return;
+  }
+  if (table_info->layout_ == TableLayout::CLUSTERED) {
+    std::optional<ZoneRange> range = plan_->GetPredicate() != nullptr ? RangeOf(plan_->GetPredicate()) : std::nullopt;
+    clustered_scanner_ = std::make_unique<ClusteredTableScanner>(table_info->clustered_table_.get(), range);
+    return;
+  }
+  pax_scanner_ = std::make_unique<PaxColumnScanner>(table_info->pax_table_.get(), read_columns_, strategy_.get());
+}
+
+bool SeqScanExecutor::OpenNextHeap() {
+  if (next_heap_ == heaps_.size()) {
+    return false;
+  }
+  TableHeap *table = heaps_[next_heap_++];
+  std::vector<ZoneRange> ranges;
+  if (table->GetZoneMap() != nullptr && plan_->GetPredicate() != nullptr) {
+    if (auto range = RangeOf(plan_->GetPredicate());
+        range.has_value() && table->GetZoneMap()->Covers(range->column_idx_)) {
+      ranges.push_back(std::move(*range));
+    }
+  }
+  toast_ = table->GetToastStore();
+  Transaction *txn = GetExecutorContext()->GetTransaction();
+  // the scan of the heap before lets go of its pages first
+  scanner_.reset();
+  if (ranges.empty()) {
+    // a scan of the whole table joins the ones in progress, and reads the pages they just brought in
+    scanner_ = TablePageScanner::Synchronized(table, txn, strategy_.get());
+  } else {
+    scanner_ = std::make_unique<TablePageScanner>(table, txn, strategy_.get(), std::move(ranges));
+  }
+  if (compiled_predicate_ != nullptr) {
+    // the predicate reads only columns that are never toasted, so it runs on the tuples in their pages
+    scanner_->SetFilter(compiled_predicate_->GetFunction());
+  }
+  return true;
+}
+
+bool SeqScanExecutor::NextView(Tuple *view) {
+  while (!scanner_->Next(view)) {
+    if (!OpenNextHeap()) {
+      return false;
+    }
+  }
+  return true;
+}
+
+Tuple SeqScanExecutor::PartialRow(const std::vector<Value> &columns) const {
+  std::vector<Value> values;
+  values.reserve(table_schema_->GetColumnCount());
+  for (const Column &column : table_schema_->GetColumns()) {
+    values.push_back(ValueFactory::GetNullValueByType(column.GetType()));
+  }
+  for (uint32_t i = 0; i < read_columns_.size(); i++) {
+    values[read_columns_[i]] = columns[i];
+  }
+  return Tuple(std::move(values), table_schema_);
+}
+
+bool SeqScanExecutor::Passes(const Tuple &row, Tuple *tuple) const {
+  if (compiled_predicate_ != nullptr) {
+    // the scanner of a table of rows has run it already
+    if (scanner_ == nullptr && !compiled_predicate_->Evaluate(row)) {
+      return false;
+    }
+  } else if (plan_->GetPredicate() != nullptr) {
+    Value result = plan_->GetPredicate()->Evaluate(&row, table_schema_);
+    if (result.IsNull() || !result.GetAs<bool>()) {
+      return false;
+    }
+  }
+  ProjectRow(row, tuple);
+  return join_filter_ == nullptr || join_filter_->MayMatch(*tuple, plan_->OutputSchema());
+}
+
+void SeqScanExecutor::ProjectRow(const Tuple &row, Tuple *tuple) const {
+  if (copy_rows_) {
+    tuple->CopyFrom(row);
+    return;
+  }
+  const Schema *output_schema = plan_->OutputSchema();
+  std::vector<Value> values;
+  values.reserve(output_schema->GetColumnCount());
+  for (uint32_t i = 0; i < output_schema->GetColumnCount(); i++) {
+    if (sources_[i] != i) {
+      values.push_back(values[sources_[i]]);
+      continue;
+    }
+    const AbstractExpression *expr = output_schema->GetColumn(i).GetExpr();
+    values.push_back(expr != nullptr ? expr->Evaluate(&row, table_schema_) : row.GetValue(table_schema_, i));
+  }
+  *tuple = Tuple(std::move(values), output_schema);
+  tuple->SetRid(row.GetRid());
 }
 
 bool SeqScanExecutor::Next(Tuple *tuple, RID *rid) {
-  auto &iter = *iter_;
-  while (iter != table_->End()) {
-    auto tup = *(iter++);
-    auto eval = true;
-    if (plan_->GetPredicate() != nullptr) {
-      eval = plan_->GetPredicate()->Evaluate(&tup, GetOutputSchema()).GetAs<bool>();
-    }
-    if (eval) {
-      *tuple = Tuple(tup);
+  if (returned_ == row_limit_) {
+    return false;
+  }
+  if (pax_scanner_ != nullptr) {
+    std::vector<Value> columns;
+    while (pax_scanner_->Next(rid, &columns)) {
+      Tuple row = PartialRow(columns);
+      row.SetRid(*rid);
+      if (Passes(row, tuple)) {
+        returned_++;
+        return true;
+      }
+    }
+    return false;
+  }
+  if (memory_table_ != nullptr) {
+    Tuple view;
+    while (memory_table_->Next(&memory_position_, &view)) {
+      if (Passes(view, tuple)) {
+        *rid = view.GetRid();
+        returned_++;
+        return true;
+      }
+    }
+    return false;
+  }
+  if (clustered_scanner_ != nullptr) {
+    Tuple view;
+    while (clustered_scanner_->Next(&view)) {
+      if (Passes(view, tuple)) {
+        *rid = view.GetRid();
+        returned_++;
+        return true;
+      }
+    }
+    return false;
+  }
+
+  Tuple view;
+  Tuple detoasted;
+  while (NextView(&view)) {
+    const Tuple *row = &view;
+    if (toast_ != nullptr && toast_->IsToasted(view)) {
+      std::vector<Value> columns;
+      columns.reserve(read_columns_.size());
+      for (uint32_t column_idx : read_columns_) {
+        columns.push_back(toast_->GetValue(view, column_idx));
+      }
+      detoasted = PartialRow(columns);
+      detoasted.SetRid(view.GetRid());
+      row = &detoasted;
+    }
+    // the match is copied into the caller's buffer, and the page let go of before the caller may write to it
+    if (Passes(*row, tuple)) {
       *rid = tuple->GetRid();
+      scanner_->Release();
+      returned_++;
       return true;
     }
   }
   return false;
 }
 
+void SeqScanExecutor::Project(const DataChunk &rows, DataChunk *chunk) const {
+  // a column that does not say what it is made of is the column of the table at its index, as in Next
+  ProjectionExecutor::Project(plan_->OutputSchema(), rows, chunk);
+}
+
+bool SeqScanExecutor::NextBatch(DataChunk *chunk) {
+  if (scanner_ == nullptr) {
+    return AbstractExecutor::NextBatch(chunk);
+  }
+  chunk->Reset();
+  if (returned_ == row_limit_) {
+    return false;
+  }
+  if (table_chunk_ == nullptr || table_chunk_->GetCapacity() != chunk->GetCapacity()) {
+    table_chunk_ = std::make_unique<DataChunk>(table_schema_, chunk->GetCapacity());
+  }
+  Tuple view;
+  // when every row passes, the rows left to return are all the batch reads of the table
+  const bool all_pass = plan_->GetPredicate() == nullptr && join_filter_ == nullptr;
+  // a batch that no row of passes is followed by the next one, rather than handed out empty
+  while (chunk->GetSize() == 0) {
+    table_chunk_->Reset();
+    const size_t rows = all_pass ? std::min(table_chunk_->GetCapacity(), row_limit_ - returned_) : SIZE_MAX;
+    while (!table_chunk_->IsFull() && table_chunk_->GetSize() < rows && NextView(&view)) {
+      if (toast_ != nullptr && toast_->IsToasted(view)) {
+        std::vector<Value> columns;
+        columns.reserve(read_columns_.size());
+        for (uint32_t column_idx : read_columns_) {
+          columns.push_back(toast_->GetValue(view, column_idx));
+        }
+        table_chunk_->Append(PartialRow(columns));
+      } else if (join_filter_ == nullptr) {
+        table_chunk_->Append(view, read_columns_);
+      } else {
+        // the keys of the join filter may be any of the columns
+        table_chunk_->Append(view);
+      }
+    }
+    // the rows of the batch are copies, so the page is let go of before the caller gets them
+    scanner_->Release();
+    if (table_chunk_->GetSize() == 0) {
+      return false;
+    }
+
+    if (plan_->GetPredicate() != nullptr && compiled_predicate_ == nullptr) {
+      plan_->GetPredicate()->EvaluateBatch(table_chunk_.get());
+    }
+    if (join_filter_ != nullptr) {
+      std::vector<uint32_t> selection;
+      selection.reserve(table_chunk_->GetSelectedCount());
+      for (size_t i = 0; i < table_chunk_->GetSelectedCount(); i++) {
+        uint32_t row = table_chunk_->GetSelectedRow(i);
+        if (join_filter_->MayMatch(*table_chunk_, row)) {
+          selection.push_back(row);
+        }
+      }
+      table_chunk_->SetSelection(std::move(selection));
+    }
+    if (table_chunk_->GetSelectedCount() > row_limit_ - returned_) {
+      std::vector<uint32_t> selection;
+      for (size_t i = 0; i < row_limit_ - returned_; i++) {
+        selection.push_back(table_chunk_->GetSelectedRow(i));
+      }
+      table_chunk_->SetSelection(std::move(selection));
+    }
+    Project(*table_chunk_, chunk);
+    returned_ += chunk->GetSize();
+  }
+  return true;
+}
+
 }  // namespace bustub
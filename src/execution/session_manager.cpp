@@ -0,0 +1,212 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// session_manager.cpp
+//
+// Identification: src/execution/session_manager.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "execution/session_manager.h"
+
+#include <exception>
+#include <utility>
+
+namespace bustub {
+
+Session::~Session() {
+  // the last reference goes once the requests of the session have run, so nothing else touches its transaction
+  if (txn_ != nullptr) {
+    manager_->txn_mgr_->Abort(txn_);
+    delete txn_;
+  }
+  std::lock_guard<std::mutex> guard(manager_->latch_);
+  manager_->num_sessions_--;
+}
+
+std::future<SessionResponse> Session::Query(const AbstractPlanNode *plan) { return Submit(RequestType::QUERY, plan); }
+
+std::future<SessionResponse> Session::Begin() { return Submit(RequestType::BEGIN, nullptr); }
+
+std::future<SessionResponse> Session::Commit() { return Submit(RequestType::COMMIT, nullptr); }
+
+std::future<SessionResponse> Session::Abort() { return Submit(RequestType::ABORT, nullptr); }
+
+void Session::Cancel() {
+  std::lock_guard<std::mutex> guard(manager_->latch_);
+  if (running_ != nullptr) {
+    running_->Cancel();
+  }
+}
+
+std::future<SessionResponse> Session::Submit(RequestType type, const AbstractPlanNode *plan) {
+  std::promise<SessionResponse> promise;
+  std::future<SessionResponse> future = promise.get_future();
+  std::unique_lock<std::mutex> guard(manager_->latch_);
+  if (manager_->num_queued_ >= manager_->limits_.max_queued_requests_) {
+    manager_->stats_.requests_refused_++;
+    guard.unlock();
+    promise.set_value(SessionResponse{false, "too many requests queued", {}});
+    return future;
+  }
+  manager_->num_queued_++;
+  requests_.push_back(Request{type, plan, std::move(promise)});
+  // a session with requests already is queued or running, and is put back once its request is done
+  if (requests_.size() == 1) {
+    manager_->runnable_.push_back(shared_from_this());
+    manager_->work_cv_.notify_one();
+  }
+  return future;
+}
+
+SessionResponse Session::Run(const Request &request) {
+  TransactionManager *txn_mgr = manager_->txn_mgr_;
+  switch (request.type_) {
+    case RequestType::QUERY:
+      return RunQuery(request.plan_);
+    case RequestType::BEGIN:
+      if (txn_ != nullptr) {
+        return SessionResponse{false, "a transaction is open already", {}};
+      }
+      txn_ = txn_mgr->Begin(nullptr, isolation_level_);
+      return SessionResponse{};
+    case RequestType::COMMIT:
+    case RequestType::ABORT:
+      if (txn_ == nullptr) {
+        return SessionResponse{false, "no transaction is open", {}};
+      }
+      if (request.type_ == RequestType::COMMIT && txn_->GetState() != TransactionState::ABORTED) {
+        txn_mgr->Commit(txn_);
+      } else {
+        txn_mgr->Abort(txn_);
+      }
+      delete txn_;
+      txn_ = nullptr;
+      return SessionResponse{};
+  }
+  UNREACHABLE("unknown request type");
+}
+
+SessionResponse Session::RunQuery(const AbstractPlanNode *plan) {
+  TransactionManager *txn_mgr = manager_->txn_mgr_;
+  bool autocommit = txn_ == nullptr;
+  Transaction *txn = autocommit ? txn_mgr->Begin(nullptr, isolation_level_) : txn_;
+  ExecutorContext exec_ctx(txn, manager_->catalog_, manager_->bpm_, txn_mgr, manager_->lock_mgr_);
+  exec_ctx.SetMemoryManager(manager_->memory_manager_);
+  {
+    std::lock_guard<std::mutex> guard(manager_->latch_);
+    running_ = &exec_ctx;
+  }
+
+  SessionResponse response;
+  try {
+    if (!manager_->engine_.Execute(plan, &response.rows_, txn, &exec_ctx)) {
+      response = SessionResponse{false, "the query was cancelled", {}};
+    } else if (txn->GetState() == TransactionState::ABORTED) {
+      response = SessionResponse{false, "the transaction was aborted", {}};
+    }
+  } catch (TransactionAbortException &e) {
+    response = SessionResponse{false, e.GetInfo(), {}};
+  } catch (std::exception &e) {
+    response = SessionResponse{false, e.what(), {}};
+  }
+  {
+    std::lock_guard<std::mutex> guard(manager_->latch_);
+    running_ = nullptr;
+  }
+
+  // a query that failed may have done a part of its writes, which only the abort of its transaction takes back
+  if (!response.ok_) {
+    txn_mgr->Abort(txn);
+    delete txn;
+    txn_ = nullptr;
+  } else if (autocommit) {
+    txn_mgr->Commit(txn);
+    delete txn;
+  }
+  return response;
+}
+
+SessionManager::SessionManager(Catalog *catalog, BufferPoolManager *bpm, TransactionManager *txn_mgr,
+                               LockManager *lock_mgr, size_t num_threads, SessionLimits limits,
+                               MemoryManager *memory_manager)
+    : catalog_(catalog),
+      bpm_(bpm),
+      txn_mgr_(txn_mgr),
+      lock_mgr_(lock_mgr),
+      limits_(limits),
+      memory_manager_(memory_manager),
+      engine_(bpm, txn_mgr, catalog) {
+  for (size_t i = 0; i < num_threads; i++) {
+    threads_.emplace_back(&SessionManager::WorkerLoop, this);
+  }
+}
+
+SessionManager::~SessionManager() {
+  {
+    std::lock_guard<std::mutex> guard(latch_);
+    stop_ = true;
+  }
+  work_cv_.notify_all();
+  for (std::thread &thread : threads_) {
+    thread.join();
+  }
+}
+
+std::shared_ptr<Session> SessionManager::OpenSession(IsolationLevel isolation_level) {
+  std::lock_guard<std::mutex> guard(latch_);
+  if (num_sessions_ >= limits_.max_sessions_) {
+    stats_.sessions_refused_++;
+    return nullptr;
+  }
+  num_sessions_++;
+  stats_.sessions_opened_++;
+  return std::shared_ptr<Session>(new Session(this, isolation_level));
+}
+
+size_t SessionManager::GetSessionCount() {
+  std::lock_guard<std::mutex> guard(latch_);
+  return num_sessions_;
+}
+
+SessionManagerStats SessionManager::GetStats() {
+  std::lock_guard<std::mutex> guard(latch_);
+  return stats_;
+}
+
+void SessionManager::WorkerLoop() {
+  std::unique_lock<std::mutex> guard(latch_);
+  while (true) {
+    work_cv_.wait(guard, [this] { return stop_ || !runnable_.empty(); });
+    if (runnable_.empty()) {
+      // stopped, with every request queued run
+      return;
+    }
+    std::shared_ptr<Session> session = std::move(runnable_.front());
+    runnable_.pop_front();
+    // the request stays first in the queue while it runs, so that a request submitted meanwhile does not queue the
+    // session a second time; a deque keeps the references to its elements as it grows at the back
+    Session::Request &request = session->requests_.front();
+    guard.unlock();
+    SessionResponse response = session->Run(request);
+    guard.lock();
+    std::promise<SessionResponse> promise = std::move(request.response_);
+    session->requests_.pop_front();
+    num_queued_--;
+    stats_.requests_run_++;
+    if (!session->requests_.empty()) {
+      runnable_.push_back(session);
+      work_cv_.notify_one();
+    }
+    guard.unlock();
+    promise.set_value(std::move(response));
+    // the session may go away with the last reference, which takes the latch
+    session.reset();
+    guard.lock();
+  }
+}
+
+}  // namespace bustub
@@ -0,0 +1,218 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// sort_executor.cpp
+//
+// Identification: src/execution/sort_executor.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "execution/executors/sort_executor.h"
+
+#include <algorithm>
+#include <cstring>
+#include <iterator>
+
+#include "common/util/radix_sort.h"
+#include "execution/loser_tree.h"
+
+namespace bustub {
+
+namespace {
+
+/**
+ * A spilled tuple is a record of its key and itself:
+ * | KEY LENGTH (4) | RID (8) | KEY | TUPLE |
+ */
+constexpr size_t RECORD_HEADER = sizeof(uint32_t) + sizeof(int64_t);
+
+uint32_t RecordKeyLength(const Tuple &record) {
+  uint32_t length;
+  memcpy(&length, record.GetData(), sizeof(length));
+  return length;
+}
+
+const char *RecordKey(const Tuple &record) { return record.GetData() + RECORD_HEADER; }
+
+}  // namespace
+
+class SortExecutor::RunMerger {
+ public:
+  /** @param runs the runs to merge, the earlier ones first */
+  explicit RunMerger(std::vector<std::unique_ptr<TmpTupleList>> runs) : runs_(std::move(runs)) {
+    readers_.reserve(runs_.size());
+    heads_.resize(runs_.size());
+    for (size_t i = 0; i < runs_.size(); i++) {
+      readers_.emplace_back(runs_[i].get());
+      exhausted_.push_back(!readers_[i].Next(&heads_[i]));
+    }
+    tree_ = std::make_unique<LoserTree<HeadLess>>(runs_.size(), HeadLess{this});
+  }
+
+  /** @return false once every record of the runs has been merged; otherwise the next one, in record */
+  bool Next(Tuple *record) {
+    size_t top = tree_->Top();
+    if (exhausted_[top]) {
+      return false;
+    }
+    std::swap(*record, heads_[top]);
+    exhausted_[top] = !readers_[top].Next(&heads_[top]);
+    tree_->Replay();
+    return true;
+  }
+
+ private:
+  /** Orders the heads of the runs by their keys; an exhausted run goes last, and a tie to the earlier run */
+  struct HeadLess {
+    const RunMerger *merger_;
+
+    bool operator()(size_t left, size_t right) const {
+      if (merger_->exhausted_[left]) {
+        return false;
+      }
+      if (merger_->exhausted_[right]) {
+        return true;
+      }
+      const Tuple &a = merger_->heads_[left];
+      const Tuple &b = merger_->heads_[right];
+      int result = SortKeyEncoder::Compare(RecordKey(a), RecordKeyLength(a), RecordKey(b), RecordKeyLength(b));
+      return result < 0 || (result == 0 && left < right);
+    }
+  };
+
+  std::vector<std::unique_ptr<TmpTupleList>> runs_;
+  std::vector<TmpTupleList::Reader> readers_;
+  std::vector<Tuple> heads_;
+  std::vector<bool> exhausted_;
+  std::unique_ptr<LoserTree<HeadLess>> tree_;
+};
+
+SortExecutor::SortExecutor(ExecutorContext *exec_ctx, const SortPlanNode *plan,
+                           std::unique_ptr<AbstractExecutor> &&child)
+    : AbstractExecutor(exec_ctx),
+      plan_(plan),
+      child_(std::move(child)),
+      encoder_(plan->GetOrderBys()),
+      memory_(exec_ctx, MemoryCategory::SORT) {}
+
+SortExecutor::~SortExecutor() = default;
+
+size_t SortExecutor::FanIn() const {
+  return std::clamp<size_t>(exec_ctx_->GetMemoryBudget() / PAGE_SIZE, 2, MAX_FAN_IN);
+}
+
+void SortExecutor::Add(Tuple &&tuple) {
+  auto offset = static_cast<uint32_t>(keys_.size());
+  encoder_.Encode(tuple, child_->GetOutputSchema(), &keys_);
+  auto length = static_cast<uint32_t>(keys_.size() - offset);
+  entries_.push_back(SortEntry{SortKeyEncoder::Prefix(keys_.data() + offset, length), offset, length,
+                               static_cast<uint32_t>(tuples_.size())});
+  run_bytes_ += length + tuple.GetLength() + sizeof(SortEntry) + sizeof(Tuple);
+  tuples_.push_back(std::move(tuple));
+}
+
+void SortExecutor::SortRun() {
+  RadixSortByPrefix(&entries_, [this](const SortEntry &left, const SortEntry &right) {
+    int result = SortKeyEncoder::Compare(keys_.data() + left.key_offset_, left.key_length_,
+                                         keys_.data() + right.key_offset_, right.key_length_);
+    return result < 0 || (result == 0 && left.tuple_index_ < right.tuple_index_);
+  });
+}
+
+void SortExecutor::SpillRun() {
+  SortRun();
+  auto run = std::make_unique<TmpTupleList>(exec_ctx_->GetBufferPoolManager(), exec_ctx_->GetSpillCounter());
+  for (const SortEntry &entry : entries_) {
+    const Tuple &tuple = tuples_[entry.tuple_index_];
+    record_.resize(RECORD_HEADER + entry.key_length_ + tuple.GetLength());
+    char *data = record_.data();
+    int64_t rid = tuple.GetRid().Get();
+    memcpy(data, &entry.key_length_, sizeof(uint32_t));
+    memcpy(data + sizeof(uint32_t), &rid, sizeof(rid));
+    memcpy(data + RECORD_HEADER, keys_.data() + entry.key_offset_, entry.key_length_);
+    memcpy(data + RECORD_HEADER + entry.key_length_, tuple.GetData(), tuple.GetLength());
+    run->Append(Tuple(RID(), data, static_cast<uint32_t>(record_.size())));
+  }
+  runs_.push_back(std::move(run));
+  keys_.clear();
+  entries_.clear();
+  tuples_.clear();
+  run_bytes_ = 0;
+  memory_.Resize(0);
+}
+
+void SortExecutor::Init() {
+  child_->Init();
+  keys_.clear();
+  entries_.clear();
+  tuples_.clear();
+  run_bytes_ = 0;
+  memory_.Resize(0);
+  next_entry_ = 0;
+  runs_.clear();
+  merger_.reset();
+
+  Tuple tuple;
+  RID rid;
+  while (child_->Next(&tuple, &rid)) {
+    Add(std::move(tuple));
+    if (!memory_.Resize(run_bytes_)) {
+      SpillRun();
+    }
+  }
+  if (runs_.empty()) {
+    SortRun();
+    return;
+  }
+  if (!entries_.empty()) {
+    SpillRun();
+  }
+
+  // passes merge consecutive runs, which keeps the runs in the order of the tuples, till a single merge is left
+  const size_t fan_in = FanIn();
+  while (runs_.size() > fan_in) {
+    std::vector<std::unique_ptr<TmpTupleList>> merged;
+    for (size_t begin = 0; begin < runs_.size(); begin += fan_in) {
+      size_t end = std::min(begin + fan_in, runs_.size());
+      if (end - begin == 1) {
+        merged.push_back(std::move(runs_[begin]));
+        continue;
+      }
+      RunMerger merger({std::make_move_iterator(runs_.begin() + begin), std::make_move_iterator(runs_.begin() + end)});
+      auto run = std::make_unique<TmpTupleList>(exec_ctx_->GetBufferPoolManager(), exec_ctx_->GetSpillCounter());
+      while (merger.Next(&spilled_)) {
+        run->Append(spilled_);
+      }
+      merged.push_back(std::move(run));
+    }
+    runs_ = std::move(merged);
+  }
+  merger_ = std::make_unique<RunMerger>(std::move(runs_));
+  runs_.clear();
+}
+
+bool SortExecutor::Next(Tuple *tuple, RID *rid) {
+  if (merger_ == nullptr) {
+    if (next_entry_ == entries_.size()) {
+      return false;
+    }
+    *tuple = std::move(tuples_[entries_[next_entry_++].tuple_index_]);
+    *rid = tuple->GetRid();
+    return true;
+  }
+  if (!merger_->Next(&spilled_)) {
+    return false;
+  }
+  uint32_t key_length = RecordKeyLength(spilled_);
+  int64_t spilled_rid;
+  memcpy(&spilled_rid, spilled_.GetData() + sizeof(uint32_t), sizeof(spilled_rid));
+  tuple->CopyFrom(Tuple(RID(spilled_rid), spilled_.GetData() + RECORD_HEADER + key_length,
+                        spilled_.GetLength() - RECORD_HEADER - key_length));
+  *rid = tuple->GetRid();
+  return true;
+}
+
+}  // namespace bustub
@@ -0,0 +1,120 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// sort_key.cpp
+//
+// Identification: src/execution/sort_key.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "execution/sort_key.h"
+
+#include <algorithm>
+#include <cstring>
+#include <type_traits>
+
+namespace bustub {
+
+namespace {
+
+/** Appends the low bytes of an unsigned integer, the most significant first */
+template <typename T>
+void AppendBigEndian(T value, std::string *key) {
+  for (int shift = (sizeof(T) - 1) * 8; shift >= 0; shift -= 8) {
+    key->push_back(static_cast<char>(static_cast<uint8_t>(value >> shift)));
+  }
+}
+
+/** Appends a signed integer, whose flipped sign bit makes the negative ones sort before the others */
+template <typename Signed>
+void AppendSigned(Signed value, std::string *key) {
+  using Unsigned = std::make_unsigned_t<Signed>;
+  AppendBigEndian(static_cast<Unsigned>(static_cast<Unsigned>(value) ^ (Unsigned{1} << (sizeof(Unsigned) * 8 - 1))),
+                  key);
+}
+
+}  // namespace
+
+void SortKeyEncoder::Encode(const Tuple &tuple, const Schema *schema, std::string *key) const {
+  for (const auto &[type, expr] : order_bys_) {
+    EncodeValue(expr->Evaluate(&tuple, schema), type == OrderByType::DESC, key);
+  }
+}
+
+void SortKeyEncoder::EncodeValue(const Value &value, bool descending, std::string *key) {
+  const size_t begin = key->size();
+  if (value.IsNull()) {
+    key->push_back(1);
+  } else {
+    key->push_back(0);
+    switch (value.GetTypeId()) {
+      case TypeId::BOOLEAN:
+      case TypeId::TINYINT:
+        AppendSigned(value.GetAs<int8_t>(), key);
+        break;
+      case TypeId::SMALLINT:
+        AppendSigned(value.GetAs<int16_t>(), key);
+        break;
+      case TypeId::INTEGER:
+        AppendSigned(value.GetAs<int32_t>(), key);
+        break;
+      case TypeId::BIGINT:
+        AppendSigned(value.GetAs<int64_t>(), key);
+        break;
+      case TypeId::DECIMAL: {
+        // a negative double orders backwards as its bits do, and -0.0 is 0.0
+        double decimal = value.GetAs<double>();
+        if (decimal == 0) {
+          decimal = 0;
+        }
+        uint64_t bits;
+        memcpy(&bits, &decimal, sizeof(bits));
+        AppendBigEndian((bits >> 63) != 0 ? ~bits : bits | (uint64_t{1} << 63), key);
+        break;
+      }
+      case TypeId::TIMESTAMP:
+        AppendBigEndian(value.GetAs<uint64_t>(), key);
+        break;
+      default: {
+        const char *data = value.GetData();
+        uint32_t length = value.GetLength();
+        // the length of a VARCHAR Value counts its terminating NUL
+        if (length > 0 && data[length - 1] == '\0') {
+          length--;
+        }
+        for (uint32_t i = 0; i < length; i++) {
+          key->push_back(data[i]);
+          if (data[i] == '\0') {
+            key->push_back(static_cast<char>(0xFF));
+          }
+        }
+        key->append(2, '\0');
+        break;
+      }
+    }
+  }
+  if (descending) {
+    std::for_each(key->begin() + begin, key->end(), [](char &byte) { byte = static_cast<char>(~byte); });
+  }
+}
+
+uint64_t SortKeyEncoder::Prefix(const char *key, size_t length) {
+  uint64_t prefix = 0;
+  for (size_t i = 0; i < sizeof(prefix); i++) {
+    prefix = (prefix << 8) | (i < length ? static_cast<uint8_t>(key[i]) : 0);
+  }
+  return prefix;
+}
+
+int SortKeyEncoder::Compare(const char *left, size_t left_length, const char *right, size_t right_length) {
+  int result = memcmp(left, right, std::min(left_length, right_length));
+  if (result != 0) {
+    return result;
+  }
+  return left_length < right_length ? -1 : (left_length > right_length ? 1 : 0);
+}
+
+}  // namespace bustub
@@ -0,0 +1,77 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// topn_executor.cpp
+//
+// Identification: src/execution/topn_executor.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "execution/executors/topn_executor.h"
+
+#include <algorithm>
+
+namespace bustub {
+
+TopNExecutor::TopNExecutor(ExecutorContext *exec_ctx, const LimitPlanNode *limit_plan, const SortPlanNode *sort_plan,
+                           std::unique_ptr<AbstractExecutor> &&child)
+    : AbstractExecutor(exec_ctx),
+      limit_plan_(limit_plan),
+      child_(std::move(child)),
+      encoder_(sort_plan->GetOrderBys()) {}
+
+bool TopNExecutor::Before(const std::string &key, size_t position, const Entry &entry) {
+  int result = SortKeyEncoder::Compare(key.data(), key.size(), entry.key_.data(), entry.key_.size());
+  return result < 0 || (result == 0 && position < entry.position_);
+}
+
+void TopNExecutor::Init() {
+  child_->Init();
+  entries_.clear();
+  next_entry_ = 0;
+  const size_t capacity = limit_plan_->GetLimit() + limit_plan_->GetOffset();
+  if (capacity == 0) {
+    return;
+  }
+  auto less = [](const Entry &left, const Entry &right) { return Before(left.key_, left.position_, right); };
+  entries_.reserve(capacity);
+
+  Tuple tuple;
+  RID rid;
+  std::string key;
+  for (size_t position = 0; child_->Next(&tuple, &rid); position++) {
+    key.clear();
+    encoder_.Encode(tuple, child_->GetOutputSchema(), &key);
+    if (entries_.size() < capacity) {
+      entries_.push_back(Entry{key, position, std::move(tuple)});
+      std::push_heap(entries_.begin(), entries_.end(), less);
+      continue;
+    }
+    // the top of the heap is the last of the tuples kept, which a tuple has to go before to be kept instead
+    if (!Before(key, position, entries_.front())) {
+      continue;
+    }
+    std::pop_heap(entries_.begin(), entries_.end(), less);
+    Entry &last = entries_.back();
+    std::swap(last.key_, key);
+    last.position_ = position;
+    last.tuple_ = std::move(tuple);
+    std::push_heap(entries_.begin(), entries_.end(), less);
+  }
+  std::sort_heap(entries_.begin(), entries_.end(), less);
+  next_entry_ = std::min(limit_plan_->GetOffset(), entries_.size());
+}
+
+bool TopNExecutor::Next(Tuple *tuple, RID *rid) {
+  if (next_entry_ == entries_.size()) {
+    return false;
+  }
+  *tuple = std::move(entries_[next_entry_++].tuple_);
+  *rid = tuple->GetRid();
+  return true;
+}
+
+}  // namespace bustub
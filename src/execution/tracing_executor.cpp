@@ -0,0 +1,51 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// tracing_executor.cpp
+//
+// Identification: src/execution/tracing_executor.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "execution/executors/tracing_executor.h"
+
+#include <utility>
+
+#include "common/tracer.h"
+#include "execution/query_profile.h"
+
+namespace bustub {
+
+TracingExecutor::TracingExecutor(ExecutorContext *exec_ctx, const AbstractPlanNode *plan,
+                                 std::unique_ptr<AbstractExecutor> &&executor)
+    : AbstractExecutor(exec_ctx), executor_(std::move(executor)), name_(PlanTypeName(plan->GetType())) {}
+
+void TracingExecutor::Init() {
+  TraceSpan span(name_, "executor.Init");
+  executor_->Init();
+}
+
+bool TracingExecutor::Next(Tuple *tuple, RID *rid) {
+  if (!Tracer::IsEnabled()) {
+    return executor_->Next(tuple, rid);
+  }
+  auto start = std::chrono::steady_clock::now();
+  bool produced = executor_->Next(tuple, rid);
+  auto end = std::chrono::steady_clock::now();
+  if (end - start >= MIN_NEXT_SPAN) {
+    Tracer::AddSpan(name_, "executor.Next", start, end);
+  }
+  return produced;
+}
+
+bool TracingExecutor::NextBatch(DataChunk *chunk) {
+  TraceSpan span(name_, "executor.NextBatch");
+  bool produced = executor_->NextBatch(chunk);
+  span.SetArg("rows", produced ? static_cast<int64_t>(chunk->GetSelectedCount()) : 0);
+  return produced;
+}
+
+}  // namespace bustub
@@ -10,16 +10,105 @@
 //
 //===----------------------------------------------------------------------===//
 #include <memory>
+#include <utility>
+#include <vector>
 
+#include "common/exception.h"
 #include "execution/executors/update_executor.h"
 
 namespace bustub {
 
 UpdateExecutor::UpdateExecutor(ExecutorContext *exec_ctx, const UpdatePlanNode *plan,
                                std::unique_ptr<AbstractExecutor> &&child_executor)
-    : AbstractExecutor(exec_ctx) {}
+    : AbstractExecutor(exec_ctx), plan_(plan), table_info_(nullptr), child_executor_(std::move(child_executor)) {}
 
-void UpdateExecutor::Init() {}
+void UpdateExecutor::Init() {
+  auto *catalog = GetExecutorContext()->GetCatalog();
+  table_info_ = catalog->GetTable(plan_->TableOid());
+  if (table_info_->layout_ != TableLayout::ROW && table_info_->layout_ != TableLayout::CLUSTERED) {
+    throw Exception(ExceptionType::NOT_IMPLEMENTED, "updates of PAX and MEMORY tables are not supported");
+  }
+  index_updates_ = std::make_unique<IndexUpdateBuffer>(GetExecutorContext(), table_info_);
+  child_executor_->Init();
+}
+
+bool UpdateExecutor::Next([[maybe_unused]] Tuple *tuple, RID *rid) {
+  std::vector<Tuple> old_tuples;
+  std::vector<Tuple> new_tuples;
+  std::vector<RID> rids;
+  Tuple t;
+  RID r;
+  while (rids.size() < BATCH_SIZE && child_executor_->Next(&t, &r)) {
+    new_tuples.push_back(GenerateUpdatedTuple(t));
+    rids.push_back(r);
+    // kept for the index keys, even of a table without indexes, as one may be created meanwhile
+    if (t.IsAllocated()) {
+      old_tuples.push_back(std::move(t));
+    } else {
+      old_tuples.emplace_back().CopyFrom(t);
+    }
+  }
+  if (rids.empty()) {
+    index_updates_->Flush();
+    return false;
+  }
+
+  std::vector<RID> new_rids(rids);
+  if (!UpdateBatch(new_tuples, rids, &new_rids)) {
+    index_updates_->Flush();
+    return false;
+  }
+  for (size_t i = 0; i < rids.size(); i++) {
+    index_updates_->Update(old_tuples[i], new_tuples[i], rids[i], new_rids[i]);
+  }
+  *rid = new_rids.back();
+  return true;
+}
+
+bool UpdateExecutor::UpdateBatch(const std::vector<Tuple> &new_tuples, const std::vector<RID> &rids,
+                                 std::vector<RID> *new_rids) {
+  Transaction *txn = GetExecutorContext()->GetTransaction();
+  if (table_info_->layout_ == TableLayout::CLUSTERED) {
+    for (size_t i = 0; i < rids.size(); i++) {
+      if (!table_info_->clustered_table_->UpdateTuple(new_tuples[i], rids[i], &(*new_rids)[i], txn)) {
+        return false;
+      }
+    }
+  } else if (table_info_->partitions_ != nullptr) {
+    // a tuple whose new key is of another partition moves to its heap, as one that outgrew its page moves elsewhere
+    PartitionedTable *partitions = table_info_->partitions_.get();
+    for (size_t i = 0; i < rids.size(); i++) {
+      TableHeap *table = partitions->HeapOf(rids[i]);
+      TableHeap *target = partitions->GetPartition(partitions->PartitionOf(new_tuples[i]));
+      if (table == nullptr) {
+        return false;
+      }
+      if (table == target && table->UpdateTuple(new_tuples[i], rids[i], txn)) {
+        continue;
+      }
+      if (txn->GetState() == TransactionState::ABORTED || !table->MarkDelete(rids[i], txn) ||
+          !target->InsertTuple(new_tuples[i], &(*new_rids)[i], txn)) {
+        return false;
+      }
+    }
+  } else {
+    TableHeap *table = table_info_->table_.get();
+    std::vector<bool> updated;
+    if (!table->UpdateTuples(new_tuples, rids, txn, &updated)) {
+      return false;
+    }
+    // the tuples that outgrew their pages move elsewhere
+    for (size_t i = 0; i < rids.size(); i++) {
+      if (updated[i]) {
+        continue;
+      }
+      if (txn->GetState() == TransactionState::ABORTED || !table->MarkDelete(rids[i], txn) ||
+          !table->InsertTuple(new_tuples[i], &(*new_rids)[i], txn)) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
 
-bool UpdateExecutor::Next([[maybe_unused]] Tuple *tuple, RID *rid) { return false; }
 }  // namespace bustub
@@ -0,0 +1,147 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// column_vector.cpp
+//
+// Identification: src/execution/vector/column_vector.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "execution/vector/column_vector.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "common/exception.h"
+#include "type/value_factory.h"
+
+namespace bustub {
+
+ColumnVector::ColumnVector(TypeId type, size_t capacity)
+    : type_(type),
+      capacity_(capacity),
+      width_(GetWidth(type)),
+      data_(new uint64_t[(capacity * width_ + sizeof(uint64_t) - 1) / sizeof(uint64_t)]()),
+      validity_((capacity + 63) / 64, ~uint64_t{0}),
+      arena_(std::make_unique<MemoryArena>()) {}
+
+size_t ColumnVector::GetWidth(TypeId type) {
+  switch (type) {
+    case TypeId::BOOLEAN:
+    case TypeId::TINYINT:
+      return sizeof(int8_t);
+    case TypeId::SMALLINT:
+      return sizeof(int16_t);
+    case TypeId::INTEGER:
+      return sizeof(int32_t);
+    case TypeId::BIGINT:
+      return sizeof(int64_t);
+    case TypeId::DECIMAL:
+      return sizeof(double);
+    case TypeId::TIMESTAMP:
+      return sizeof(uint64_t);
+    case TypeId::VARCHAR:
+      return sizeof(StringSlice);
+    default:
+      throw Exception(ExceptionType::UNKNOWN_TYPE, "a column vector cannot hold values of this type");
+  }
+}
+
+void ColumnVector::SetString(size_t row, const char *data, uint32_t length) {
+  char *bytes = arena_->Allocate(length, 1);
+  memcpy(bytes, data, length);
+  GetData<StringSlice>()[row] = StringSlice{bytes, length};
+  SetValid(row, true);
+}
+
+void ColumnVector::SetValue(size_t row, const Value &value) {
+  BUSTUB_ASSERT(value.GetTypeId() == type_, "the value is not of the column's type");
+  if (value.IsNull()) {
+    SetValid(row, false);
+    return;
+  }
+  switch (type_) {
+    case TypeId::BOOLEAN:
+    case TypeId::TINYINT:
+      GetData<int8_t>()[row] = value.GetAs<int8_t>();
+      break;
+    case TypeId::SMALLINT:
+      GetData<int16_t>()[row] = value.GetAs<int16_t>();
+      break;
+    case TypeId::INTEGER:
+      GetData<int32_t>()[row] = value.GetAs<int32_t>();
+      break;
+    case TypeId::BIGINT:
+      GetData<int64_t>()[row] = value.GetAs<int64_t>();
+      break;
+    case TypeId::DECIMAL:
+      GetData<double>()[row] = value.GetAs<double>();
+      break;
+    case TypeId::TIMESTAMP:
+      GetData<uint64_t>()[row] = value.GetAs<uint64_t>();
+      break;
+    case TypeId::VARCHAR:
+      SetString(row, value.GetData(), value.GetLength());
+      return;
+    default:
+      break;
+  }
+  SetValid(row, true);
+}
+
+void ColumnVector::Gather(const ColumnVector &source, const uint32_t *rows, size_t count, size_t offset) {
+  BUSTUB_ASSERT(source.type_ == type_, "the vectors are not of the same type");
+  BUSTUB_ASSERT(offset + count <= capacity_, "the rows do not fit the vector");
+  const char *from = reinterpret_cast<const char *>(source.data_.get());
+  char *to = reinterpret_cast<char *>(data_.get());
+  for (size_t i = 0; i < count; i++) {
+    size_t row = rows == nullptr ? i : rows[i];
+    if (!source.IsValid(row)) {
+      SetValid(offset + i, false);
+    } else if (type_ == TypeId::VARCHAR) {
+      // the bytes are copied, as the source may be reset before this vector is read
+      const StringSlice &slice = source.GetData<StringSlice>()[row];
+      SetString(offset + i, slice.data_, slice.length_);
+    } else {
+      memcpy(to + (offset + i) * width_, from + row * width_, width_);
+      SetValid(offset + i, true);
+    }
+  }
+}
+
+Value ColumnVector::GetValue(size_t row) const {
+  if (!IsValid(row)) {
+    // a null Value holds the type's null sentinel, so that it is serialized into a tuple as a null
+    return type_ == TypeId::TIMESTAMP ? Value(type_, static_cast<uint64_t>(BUSTUB_TIMESTAMP_NULL))
+                                      : ValueFactory::GetNullValueByType(type_);
+  }
+  switch (type_) {
+    case TypeId::BOOLEAN:
+    case TypeId::TINYINT:
+      return Value(type_, GetData<int8_t>()[row]);
+    case TypeId::SMALLINT:
+      return Value(type_, GetData<int16_t>()[row]);
+    case TypeId::INTEGER:
+      return Value(type_, GetData<int32_t>()[row]);
+    case TypeId::BIGINT:
+      return Value(type_, GetData<int64_t>()[row]);
+    case TypeId::DECIMAL:
+      return Value(type_, GetData<double>()[row]);
+    case TypeId::TIMESTAMP:
+      return Value(type_, GetData<uint64_t>()[row]);
+    default: {
+      const StringSlice &slice = GetData<StringSlice>()[row];
+      return Value(type_, slice.data_, slice.length_, true);
+    }
+  }
+}
+
+void ColumnVector::Reset() {
+  std::fill(validity_.begin(), validity_.end(), ~uint64_t{0});
+  arena_->Reset();
+}
+
+}  // namespace bustub
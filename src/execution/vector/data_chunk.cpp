@@ -0,0 +1,138 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// data_chunk.cpp
+//
+// Identification: src/execution/vector/data_chunk.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "execution/vector/data_chunk.h"
+
+#include <cstring>
+#include <utility>
+
+namespace bustub {
+
+namespace {
+
+// Copies a fixed-width value out of the tuple; the type's null sentinel makes the row null
+template <typename T>
+void DecodeFixed(const char *storage, T null_value, ColumnVector *column, size_t row) {
+  T value;
+  memcpy(&value, storage, sizeof(T));
+  column->GetData<T>()[row] = value;
+  column->SetValid(row, value != null_value);
+}
+
+}  // namespace
+
+DataChunk::DataChunk(const Schema *schema, size_t capacity) : schema_(schema), capacity_(capacity) {
+  columns_.reserve(schema->GetColumnCount());
+  for (const Column &column : schema->GetColumns()) {
+    columns_.emplace_back(column.GetType(), capacity);
+  }
+}
+
+bool DataChunk::Append(const Tuple &tuple) {
+  if (IsFull()) {
+    return false;
+  }
+  for (uint32_t i = 0; i < columns_.size(); i++) {
+    DecodeColumn(tuple.GetData(), i);
+  }
+  size_++;
+  return true;
+}
+
+bool DataChunk::Append(const Tuple &tuple, const std::vector<uint32_t> &columns) {
+  if (IsFull()) {
+    return false;
+  }
+  for (ColumnVector &column : columns_) {
+    column.SetValid(size_, false);
+  }
+  for (uint32_t i : columns) {
+    DecodeColumn(tuple.GetData(), i);
+  }
+  size_++;
+  return true;
+}
+
+void DataChunk::DecodeColumn(const char *data, uint32_t column_idx) {
+  ColumnVector *column = &columns_[column_idx];
+  const char *storage = data + schema_->GetOffset(column_idx);
+  switch (column->GetType()) {
+    case TypeId::BOOLEAN:
+      DecodeFixed<int8_t>(storage, BUSTUB_BOOLEAN_NULL, column, size_);
+      break;
+    case TypeId::TINYINT:
+      DecodeFixed<int8_t>(storage, BUSTUB_INT8_NULL, column, size_);
+      break;
+    case TypeId::SMALLINT:
+      DecodeFixed<int16_t>(storage, BUSTUB_INT16_NULL, column, size_);
+      break;
+    case TypeId::INTEGER:
+      DecodeFixed<int32_t>(storage, BUSTUB_INT32_NULL, column, size_);
+      break;
+    case TypeId::BIGINT:
+      DecodeFixed<int64_t>(storage, BUSTUB_INT64_NULL, column, size_);
+      break;
+    case TypeId::DECIMAL:
+      DecodeFixed<double>(storage, BUSTUB_DECIMAL_NULL, column, size_);
+      break;
+    case TypeId::TIMESTAMP:
+      DecodeFixed<uint64_t>(storage, BUSTUB_TIMESTAMP_NULL, column, size_);
+      break;
+    default: {
+      // the column holds the offset of the value, which is its length followed by its bytes
+      uint32_t offset;
+      memcpy(&offset, storage, sizeof(uint32_t));
+      uint32_t length;
+      memcpy(&length, data + offset, sizeof(uint32_t));
+      BUSTUB_ASSERT(length != Tuple::TOASTED_LENGTH, "toasted values have to be detoasted first");
+      if (length == BUSTUB_VALUE_NULL) {
+        column->SetValid(size_, false);
+      } else {
+        column->SetString(size_, data + offset + sizeof(uint32_t), length);
+      }
+      break;
+    }
+  }
+}
+
+Tuple DataChunk::GetTuple(size_t row) const {
+  std::vector<Value> values;
+  values.reserve(columns_.size());
+  for (const ColumnVector &column : columns_) {
+    values.push_back(column.GetValue(row));
+  }
+  return Tuple(values, schema_);
+}
+
+void DataChunk::GetTuples(std::vector<Tuple> *tuples) const {
+  size_t count = GetSelectedCount();
+  tuples->reserve(tuples->size() + count);
+  for (size_t i = 0; i < count; i++) {
+    tuples->push_back(GetTuple(GetSelectedRow(i)));
+  }
+}
+
+void DataChunk::SetSelection(std::vector<uint32_t> selection) {
+  BUSTUB_ASSERT(selection.size() <= GetSelectedCount(), "a selection can only narrow the live rows");
+  selection_ = std::move(selection);
+  has_selection_ = true;
+}
+
+void DataChunk::Reset() {
+  for (ColumnVector &column : columns_) {
+    column.Reset();
+  }
+  size_ = 0;
+  ClearSelection();
+}
+
+}  // namespace bustub
@@ -0,0 +1,138 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// hash_kernels.cpp
+//
+// Identification: src/execution/vector/hash_kernels.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "execution/vector/hash_kernels.h"
+
+#include <algorithm>
+#include <cstring>
+#include <type_traits>
+
+namespace bustub {
+
+namespace {
+
+/** @return the word a value of a column is hashed as, the one HashUtil::HashValue hashes */
+template <typename T>
+uint64_t WordOf(T value) {
+  if constexpr (std::is_floating_point_v<T>) {
+    uint64_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    return bits;
+  } else {
+    // the integer types are widened to int64_t, so that they hash alike
+    return static_cast<uint64_t>(static_cast<int64_t>(value));
+  }
+}
+
+/** Hashes the rows of a fixed-width column; the loop is split by combine and selection, to leave no branch in it */
+template <typename T, bool COMBINE>
+void HashFixed(const ColumnVector &column, const uint32_t *selection, size_t count, hash_t *hashes) {
+  const T *data = column.GetData<T>();
+  for (size_t i = 0; i < count; ++i) {
+    uint32_t row = selection == nullptr ? static_cast<uint32_t>(i) : selection[i];
+    hash_t hash = HashUtil::HashWord(WordOf(data[row]));
+    hashes[i] = COMBINE ? HashUtil::CombineHashes(hashes[i], hash) : hash;
+  }
+}
+
+/** Hashes the rows of a VARCHAR column, whose null rows have no bytes to hash */
+template <bool COMBINE>
+void HashStrings(const ColumnVector &column, const uint32_t *selection, size_t count, hash_t *hashes) {
+  const auto *data = column.GetData<StringSlice>();
+  for (size_t i = 0; i < count; ++i) {
+    uint32_t row = selection == nullptr ? static_cast<uint32_t>(i) : selection[i];
+    hash_t hash =
+        column.IsValid(row) ? HashUtil::HashBytes(data[row].data_, data[row].length_) : HashUtil::NULL_HASH;
+    hashes[i] = COMBINE ? HashUtil::CombineHashes(hashes[i], hash) : hash;
+  }
+}
+
+template <bool COMBINE>
+void HashFixedRows(const ColumnVector &column, const uint32_t *selection, size_t count, hash_t *hashes) {
+  switch (column.GetType()) {
+    case TypeId::BOOLEAN:
+    case TypeId::TINYINT:
+      HashFixed<int8_t, COMBINE>(column, selection, count, hashes);
+      break;
+    case TypeId::SMALLINT:
+      HashFixed<int16_t, COMBINE>(column, selection, count, hashes);
+      break;
+    case TypeId::INTEGER:
+      HashFixed<int32_t, COMBINE>(column, selection, count, hashes);
+      break;
+    case TypeId::BIGINT:
+      HashFixed<int64_t, COMBINE>(column, selection, count, hashes);
+      break;
+    case TypeId::DECIMAL:
+      HashFixed<double, COMBINE>(column, selection, count, hashes);
+      break;
+    case TypeId::TIMESTAMP:
+      HashFixed<uint64_t, COMBINE>(column, selection, count, hashes);
+      break;
+    default:
+      BUSTUB_ASSERT(false, "Unsupported type.");
+  }
+}
+
+}  // namespace
+
+void HashColumn(const ColumnVector &column, const uint32_t *selection, size_t count, hash_t *hashes, bool combine) {
+  if (column.GetType() == TypeId::VARCHAR) {
+    if (combine) {
+      HashStrings<true>(column, selection, count, hashes);
+    } else {
+      HashStrings<false>(column, selection, count, hashes);
+    }
+    return;
+  }
+
+  // the slots of null rows hold no particular value, so the hashes of all rows are taken first and those of the null
+  // rows replaced after, which keeps the validity bitmap out of the loops; most vectors have no nulls to replace
+  size_t rows = count == 0 ? 0 : (selection == nullptr ? count : selection[count - 1] + 1);
+  const uint64_t *validity = column.GetValidity();
+  bool has_nulls = false;
+  for (size_t row = 0; row < rows && !has_nulls; row += 64) {
+    size_t bits = std::min<size_t>(64, rows - row);
+    uint64_t mask = bits == 64 ? ~uint64_t{0} : (uint64_t{1} << bits) - 1;
+    has_nulls = (validity[row / 64] & mask) != mask;
+  }
+  std::vector<hash_t> before;
+  if (has_nulls && combine) {
+    before.assign(hashes, hashes + count);
+  }
+
+  if (combine) {
+    HashFixedRows<true>(column, selection, count, hashes);
+  } else {
+    HashFixedRows<false>(column, selection, count, hashes);
+  }
+
+  if (has_nulls) {
+    for (size_t i = 0; i < count; ++i) {
+      uint32_t row = selection == nullptr ? static_cast<uint32_t>(i) : selection[i];
+      if (!column.IsValid(row)) {
+        hashes[i] = combine ? HashUtil::CombineHashes(before[i], HashUtil::NULL_HASH) : HashUtil::NULL_HASH;
+      }
+    }
+  }
+}
+
+void HashChunk(const DataChunk &chunk, const std::vector<uint32_t> &columns, hash_t *hashes) {
+  const uint32_t *selection = chunk.HasSelection() ? chunk.GetSelection().data() : nullptr;
+  size_t count = chunk.GetSelectedCount();
+  std::fill(hashes, hashes + count, 0);
+  for (uint32_t column_idx : columns) {
+    HashColumn(chunk.GetColumn(column_idx), selection, count, hashes, true);
+  }
+}
+
+}  // namespace bustub
@@ -0,0 +1,70 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// atomic_clock_replacer.h
+//
+// Identification: src/include/buffer/atomic_clock_replacer.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+#include "buffer/replacer.h"
+#include "common/config.h"
+
+namespace bustub {
+
+/**
+ * AtomicClockReplacer implements the same clock policy as ClockReplacer, without a latch. Every frame has a state byte
+ * of its own, which says whether the frame is in the replacer and whether it was unpinned since the hand last passed
+ * it. Pin and Unpin are one atomic exchange of that byte each, so the threads that pin and unpin frames on the hit path
+ * of the buffer pool do not wait on each other, nor on Victim. Victim advances the hand with a CAS, clears the
+ * reference bits it passes with a CAS, and takes its victim with one, so that a frame pinned meanwhile is not taken.
+ *
+ * Size is kept in a counter of its own, which may run behind the state bytes for the time between an exchange and the
+ * update of the counter.
+ */
+class AtomicClockReplacer : public Replacer {
+ public:
+  /**
+   * Create a new AtomicClockReplacer.
+   * @param num_pages the maximum number of pages the AtomicClockReplacer will be required to store
+   */
+  explicit AtomicClockReplacer(size_t num_pages);
+
+  ~AtomicClockReplacer() override = default;
+
+  bool Victim(frame_id_t *frame_id) override;
+
+  void Pin(frame_id_t frame_id) override;
+
+  void Unpin(frame_id_t frame_id) override;
+
+  size_t Size() override;
+
+ private:
+  /** The frame is in the replacer. */
+  static constexpr uint8_t IN_REPLACER = 1;
+  /** The frame was unpinned since the hand last passed it. */
+  static constexpr uint8_t REFERENCED = 2;
+
+  bool IsValid(frame_id_t frame_id) const {
+    return frame_id >= 0 && static_cast<size_t>(frame_id) < num_pages_;
+  }
+
+  const size_t num_pages_;
+  /** A byte per frame, so that frames next to each other do not share a word that is written as a whole. */
+  std::unique_ptr<std::atomic<uint8_t>[]> states_;
+  /** Signed, as the Victim that takes a frame may count it out before the Unpin that put it in counts it in */
+  std::atomic<int64_t> size_{0};
+  std::atomic<size_t> clock_hand_{0};
+};
+
+}  // namespace bustub
@@ -0,0 +1,70 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// buffer_access_strategy.h
+//
+// Identification: src/include/buffer/buffer_access_strategy.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <algorithm>
+#include <vector>
+
+#include "common/config.h"
+
+namespace bustub {
+
+/**
+ * BufferAccessStrategy confines a bulk operation, such as a sequential scan or a bulk load, to a small ring of
+ * frames. A miss made through the strategy recycles the frame it used ring_size misses ago, as long as nobody has
+ * it pinned, instead of taking a victim from the rest of the pool. Hits are not affected.
+ *
+ * A strategy belongs to a single operation and is not thread safe.
+ */
+class BufferAccessStrategy {
+  friend class BufferPoolManagerInstance;
+
+ public:
+  /**
+   * Creates a strategy with an (initially empty) ring of the given size in every buffer pool instance.
+   * @param ring_size how many frames the operation may cycle through per instance
+   */
+  explicit BufferAccessStrategy(size_t ring_size) : ring_size_(std::max<size_t>(ring_size, 1)) {}
+
+  /**
+   * @param pool_size the size of the buffer pool the operation runs against
+   * @return the ring size for bulk operations: BULK_RING_SIZE, but never more than an eighth of the pool
+   */
+  static size_t BulkRingSize(size_t pool_size) {
+    return std::max<size_t>(1, std::min<size_t>(BULK_RING_SIZE, pool_size / 8));
+  }
+
+  /** @return how many frames the operation may cycle through per instance */
+  size_t GetRingSize() const { return ring_size_; }
+
+ private:
+  /** @return the ring of the given buffer pool instance, allocating it on first use */
+  std::vector<frame_id_t> &Ring(size_t instance_index) {
+    if (rings_.size() <= instance_index) {
+      rings_.resize(instance_index + 1);
+      cursors_.resize(instance_index + 1, 0);
+    }
+    if (rings_[instance_index].empty()) {
+      rings_[instance_index].assign(ring_size_, -1);
+    }
+    return rings_[instance_index];
+  }
+
+  size_t ring_size_;
+  /** Frames used so far, per buffer pool instance; -1 marks a slot that has not been filled yet. */
+  std::vector<std::vector<frame_id_t>> rings_;
+  /** The ring slot the next miss uses, per buffer pool instance. */
+  std::vector<size_t> cursors_;
+};
+
+}  // namespace bustub
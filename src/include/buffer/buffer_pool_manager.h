@@ -12,11 +12,14 @@
 
 #pragma once
 
-#include <list>
-#include <mutex>  // NOLINT
-#include <unordered_map>
+#include <utility>
+#include <vector>
 
+#include "buffer/buffer_access_strategy.h"
+#include "buffer/buffer_pool_stats.h"
+#include "buffer/page_guard.h"
 #include "buffer/clock_replacer.h"
+#include "common/latency_histogram.h"
 #include "recovery/log_manager.h"
 #include "storage/disk/disk_manager.h"
 #include "storage/page/page.h"
@@ -24,25 +27,21 @@
 namespace bustub {
 
 /**
- * BufferPoolManager reads disk pages to and from its internal buffer pool.
+ * BufferPoolManager is the interface through which the rest of the system reads disk pages to and from memory.
+ * BufferPoolManagerInstance implements it over a single set of frames, and ParallelBufferPoolManager spreads
+ * pages over several independent instances.
  */
 class BufferPoolManager {
  public:
   enum class CallbackType { BEFORE, AFTER };
   using bufferpool_callback_fn = void (*)(enum CallbackType, const page_id_t page_id);
 
-  /**
-   * Creates a new BufferPoolManager.
-   * @param pool_size the size of the buffer pool
-   * @param disk_manager the disk manager
-   * @param log_manager the log manager (for testing only: nullptr = disable logging)
-   */
-  BufferPoolManager(size_t pool_size, DiskManager *disk_manager, LogManager *log_manager = nullptr);
+  BufferPoolManager() = default;
 
   /**
    * Destroys an existing BufferPoolManager.
    */
-  ~BufferPoolManager();
+  virtual ~BufferPoolManager() = default;
 
   /** Grading function. Do not modify! */
   Page *FetchPage(page_id_t page_id, bufferpool_callback_fn callback = nullptr) {
@@ -91,11 +90,119 @@ class BufferPoolManager {
     GradingCallback(callback, CallbackType::AFTER, INVALID_PAGE_ID);
   }
 
-  /** @return pointer to all the pages in the buffer pool */
-  Page *GetPages() { return pages_; }
+  /**
+   * Fetches a page and read-latches it.
+   * @param page_id id of page to be fetched
+   * @return a guard that unlatches and unpins the page when dropped; invalid if every frame is pinned
+   */
+  ReadPageGuard FetchPageRead(page_id_t page_id) {
+    Page *page = FetchPageImpl(page_id);
+    if (page != nullptr) {
+      page->RLatch();
+    }
+    return ReadPageGuard(this, page);
+  }
+
+  /**
+   * Fetches a page and write-latches it.
+   * @param page_id id of page to be fetched
+   * @return a guard that unlatches and unpins the page when dropped; invalid if every frame is pinned
+   */
+  WritePageGuard FetchPageWrite(page_id_t page_id) {
+    Page *page = FetchPageImpl(page_id);
+    if (page != nullptr) {
+      page->WLatch();
+    }
+    return WritePageGuard(this, page);
+  }
+
+  /**
+   * Fetches several pages at once. Unlike calling FetchPage for each, the misses are looked up under a single latch
+   * acquisition and read from disk together.
+   * @param page_ids the pages to fetch; a page listed twice is pinned twice
+   * @return the pages in the order of page_ids, with nullptr for those that no frame was left for
+   */
+  virtual std::vector<Page *> FetchPages(const std::vector<page_id_t> &page_ids) = 0;
+
+  /**
+   * Unpins several pages, e.g. the ones returned by FetchPages.
+   * @param page_ids the pages to unpin
+   * @param is_dirty true if the pages should be marked as dirty
+   * @return false if any of the pages was not cached or not pinned
+   */
+  bool UnpinPages(const std::vector<page_id_t> &page_ids, bool is_dirty) {
+    bool all_unpinned = true;
+    for (page_id_t page_id : page_ids) {
+      all_unpinned = UnpinPageImpl(page_id, is_dirty) && all_unpinned;
+    }
+    return all_unpinned;
+  }
+
+  /**
+   * Fetches a page like FetchPage, except that on a miss the frame is taken from the strategy's ring.
+   * @param page_id id of page to be fetched
+   * @param strategy the bulk operation's access strategy, nullptr to behave exactly like FetchPage
+   * @return the requested page, nullptr if every frame is pinned
+   */
+  virtual Page *FetchPageWithStrategy(page_id_t page_id, BufferAccessStrategy *strategy) = 0;
+
+  /**
+   * Creates a page like NewPage, except that the frame is taken from the strategy's ring.
+   * @param[out] page_id id of created page
+   * @param strategy the bulk operation's access strategy, nullptr to behave exactly like NewPage
+   * @return nullptr if no new pages could be created, otherwise pointer to new page
+   */
+  virtual Page *NewPageWithStrategy(page_id_t *page_id, BufferAccessStrategy *strategy) = 0;
+
+  /**
+   * Allocates an extent of pages on disk that are contiguous in the database file, for a caller that creates them one
+   * by one with NewPageWithId as it fills them, e.g. a table heap, so that reading them in order later makes for
+   * large sequential reads.
+   * @param num_pages the size of the extent, a power of two
+   * @return the id of the first page of the extent, INVALID_PAGE_ID if the buffer pool cannot create pages
+   */
+  virtual page_id_t AllocateExtent(size_t num_pages) = 0;
+
+  /**
+   * Creates a page like NewPageWithStrategy, under an id the caller allocated, e.g. one of an extent. If a reader
+   * cached the page before it was created, the page is created in that frame.
+   * @param page_id id of the page to create
+   * @param strategy the bulk operation's access strategy, nullptr for a plain NewPage
+   * @return nullptr if no frame was left for the page, otherwise pointer to new page
+   */
+  virtual Page *NewPageWithId(page_id_t page_id, BufferAccessStrategy *strategy) = 0;
+
+  /**
+   * Asks for pages to be read into the buffer pool in the background, ahead of the caller needing them. Pages that
+   * are already cached, or that there is no free frame for, are skipped; the pages are not pinned for the caller.
+   * @param page_ids the pages that are about to be fetched
+   * @param strategy the access strategy whose ring the frames come from, if any
+   */
+  virtual void PrefetchPages(const std::vector<page_id_t> &page_ids, BufferAccessStrategy *strategy = nullptr) = 0;
+
+  /** @return a snapshot of the counters of the buffer pool, summed over all of its instances */
+  virtual BufferPoolStats GetStats() = 0;
+
+  /**
+   * @return the latencies of FetchPage, merged over all of the instances; a hit that did not wait for another
+   * thread's I/O is recorded as taking no time, which keeps the clock off the hit path
+   */
+  virtual LatencySnapshot GetFetchLatency() = 0;
 
   /** @return size of the buffer pool */
-  size_t GetPoolSize() { return pool_size_; }
+  virtual size_t GetPoolSize() = 0;
+
+  /**
+   * @return the dirty page table of a fuzzy checkpoint: the dirty pages in the pool, with their recovery LSNs, as of
+   * some moment while it ran; the pages are not written back or latched
+   */
+  virtual std::vector<std::pair<page_id_t, lsn_t>> GetDirtyPageTable() = 0;
+
+  /**
+   * @param page_id the page to look up
+   * @return the NUMA node whose memory the pool caches the page in, -1 if the pool is not placed on nodes
+   */
+  virtual int GetNumaNode(page_id_t page_id) { return -1; }
 
  protected:
   /**
@@ -116,7 +223,7 @@ class BufferPoolManager {
    * @param page_id id of page to be fetched
    * @return the requested page
    */
-  Page *FetchPageImpl(page_id_t page_id);
+  virtual Page *FetchPageImpl(page_id_t page_id) = 0;
 
   /**
    * Unpin the target page from the buffer pool.
@@ -124,50 +231,33 @@ class BufferPoolManager {
    * @param is_dirty true if the page should be marked as dirty, false otherwise
    * @return false if the page pin count is <= 0 before this call, true otherwise
    */
-  bool UnpinPageImpl(page_id_t page_id, bool is_dirty);
+  virtual bool UnpinPageImpl(page_id_t page_id, bool is_dirty) = 0;
 
   /**
    * Flushes the target page to disk.
    * @param page_id id of page to be flushed, cannot be INVALID_PAGE_ID
    * @return false if the page could not be found in the page table, true otherwise
    */
-  bool FlushPageImpl(page_id_t page_id);
+  virtual bool FlushPageImpl(page_id_t page_id) = 0;
 
   /**
    * Creates a new page in the buffer pool.
    * @param[out] page_id id of created page
    * @return nullptr if no new pages could be created, otherwise pointer to new page
    */
-  Page *NewPageImpl(page_id_t *page_id);
+  virtual Page *NewPageImpl(page_id_t *page_id) = 0;
 
   /**
    * Deletes a page from the buffer pool.
    * @param page_id id of page to be deleted
    * @return false if the page exists but could not be deleted, true if the page didn't exist or deletion succeeded
    */
-  bool DeletePageImpl(page_id_t page_id);
+  virtual bool DeletePageImpl(page_id_t page_id) = 0;
 
   /**
    * Flushes all the pages in the buffer pool to disk.
    */
-  void FlushAllPagesImpl();
-
-  /** Number of pages in the buffer pool. */
-  size_t pool_size_;
-  /** Array of buffer pool pages. */
-  Page *pages_;
-  /** Pointer to the disk manager. */
-  DiskManager *disk_manager_ __attribute__((__unused__));
-  /** Pointer to the log manager. */
-  LogManager *log_manager_ __attribute__((__unused__));
-  /** Page table for keeping track of buffer pool pages. */
-  std::unordered_map<page_id_t, frame_id_t> page_table_;
-  /** Replacer to find unpinned pages for replacement. */
-  Replacer *replacer_;
-  /** List of free pages. */
-  std::list<frame_id_t> free_list_;
-  /** This latch protects shared data structures. We recommend updating this comment to describe what it protects. */
-  std::mutex latch_;
+  virtual void FlushAllPagesImpl() = 0;
 };
 }  // namespace bustub
 
@@ -0,0 +1,330 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// buffer_pool_manager_instance.h
+//
+// Identification: src/include/buffer/buffer_pool_manager_instance.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>  // NOLINT
+#include <deque>
+#include <list>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <thread>  // NOLINT
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "buffer/buffer_pool_stats.h"
+#include "buffer/clock_replacer.h"
+#include "buffer/frame_arena.h"
+#include "buffer/frame_directory.h"
+#include "buffer/replacer.h"
+#include "common/contention.h"
+#include "recovery/log_manager.h"
+#include "storage/disk/disk_manager.h"
+#include "storage/page/page.h"
+
+namespace bustub {
+
+/**
+ * BufferPoolManagerInstance reads disk pages to and from its internal buffer pool.
+ * It may either stand alone, or be one of several instances owned by a ParallelBufferPoolManager. In the latter
+ * case it only ever caches pages whose id maps to its own index.
+ */
+class BufferPoolManagerInstance : public BufferPoolManager {
+ public:
+  /**
+   * Creates a new stand-alone BufferPoolManagerInstance.
+   * @param pool_size the size of the buffer pool
+   * @param disk_manager the disk manager
+   * @param log_manager the log manager (for testing only: nullptr = disable logging)
+   * @param replacer_type the replacement policy, LRU_K for pools that must survive large scans
+   */
+  BufferPoolManagerInstance(size_t pool_size, DiskManager *disk_manager, LogManager *log_manager = nullptr,
+                            ReplacerType replacer_type = ReplacerType::CLOCK);
+
+  /**
+   * Creates a new BufferPoolManagerInstance that is part of a parallel buffer pool.
+   * @param pool_size the size of the buffer pool
+   * @param num_instances total number of instances in the parallel buffer pool
+   * @param instance_index index of this instance in the parallel buffer pool
+   * @param disk_manager the disk manager
+   * @param log_manager the log manager (for testing only: nullptr = disable logging)
+   * @param replacer_type the replacement policy
+   * @param numa_node the NUMA node to place the frames on, -1 to leave them to the OS
+   */
+  BufferPoolManagerInstance(size_t pool_size, uint32_t num_instances, uint32_t instance_index,
+                            DiskManager *disk_manager, LogManager *log_manager = nullptr,
+                            ReplacerType replacer_type = ReplacerType::CLOCK, int numa_node = -1);
+
+  /**
+   * Destroys an existing BufferPoolManagerInstance.
+   */
+  ~BufferPoolManagerInstance() override;
+
+  /** @return pointer to all the pages in the buffer pool */
+  Page *GetPages() { return pages_; }
+
+  /** @return size of the buffer pool */
+  size_t GetPoolSize() override { return pool_size_; }
+
+  /**
+   * Creates a new page in the buffer pool under an id that the caller already allocated on disk.
+   * ParallelBufferPoolManager allocates ids itself so that it can pick the instance a new page lands in.
+   * @param page_id id of the page to create, must map to this instance
+   * @param strategy the access strategy to take the frame from, if any
+   * @return nullptr if all frames are pinned, otherwise pointer to the new page
+   */
+  Page *NewPageWithId(page_id_t page_id, BufferAccessStrategy *strategy) override;
+
+  page_id_t AllocateExtent(size_t num_pages) override { return disk_manager_->AllocateExtent(num_pages); }
+
+  Page *FetchPageWithStrategy(page_id_t page_id, BufferAccessStrategy *strategy) override;
+
+  std::vector<Page *> FetchPages(const std::vector<page_id_t> &page_ids) override;
+
+  Page *NewPageWithStrategy(page_id_t *page_id, BufferAccessStrategy *strategy) override;
+
+  void PrefetchPages(const std::vector<page_id_t> &page_ids, BufferAccessStrategy *strategy = nullptr) override;
+
+  BufferPoolStats GetStats() override;
+
+  LatencySnapshot GetFetchLatency() override { return fetch_latency_.Snapshot(); }
+
+  std::vector<std::pair<page_id_t, lsn_t>> GetDirtyPageTable() override;
+
+  /** @return the NUMA node the frames of the instance were placed on, whichever page it is */
+  int GetNumaNode(page_id_t page_id) override { return numa_node_; }
+
+  /**
+   * Starts the background flusher. Every bg_flush_interval it writes back up to bg_flush_pages_per_round dirty,
+   * unpinned pages, until bg_flush_clean_target frames are clean, so that misses rarely have to write back a victim.
+   * With logging enabled, pages whose LSN has not yet been persisted are left for a later round.
+   */
+  void StartBackgroundFlusher();
+
+  /**
+   * Stops and joins the background flusher, if it is running.
+   */
+  void StopBackgroundFlusher();
+
+ protected:
+  /**
+   * Fetch the requested page from the buffer pool.
+   * @param page_id id of page to be fetched
+   * @return the requested page
+   */
+  Page *FetchPageImpl(page_id_t page_id) override;
+
+  /**
+   * Unpin the target page from the buffer pool.
+   * @param page_id id of page to be unpinned
+   * @param is_dirty true if the page should be marked as dirty, false otherwise
+   * @return false if the page pin count is <= 0 before this call, true otherwise
+   */
+  bool UnpinPageImpl(page_id_t page_id, bool is_dirty) override;
+
+  /**
+   * Flushes the target page to disk.
+   * @param page_id id of page to be flushed, cannot be INVALID_PAGE_ID
+   * @return false if the page could not be found in the page table, true otherwise
+   */
+  bool FlushPageImpl(page_id_t page_id) override;
+
+  /**
+   * Creates a new page in the buffer pool.
+   * @param[out] page_id id of created page
+   * @return nullptr if no new pages could be created, otherwise pointer to new page
+   */
+  Page *NewPageImpl(page_id_t *page_id) override;
+
+  /**
+   * Deletes a page from the buffer pool.
+   * @param page_id id of page to be deleted
+   * @return false if the page exists but could not be deleted, true if the page didn't exist or deletion succeeded
+   */
+  bool DeletePageImpl(page_id_t page_id) override;
+
+  /**
+   * Flushes all the pages in the buffer pool to disk.
+   */
+  void FlushAllPagesImpl() override;
+
+  /**
+   * Lifecycle of a frame. Disk I/O on a frame happens without latch_ held, and only while the frame is EVICTING
+   * (its old page is being written back) or LOADING (its new page is being read in or zeroed).
+   */
+  enum class FrameState { FREE, EVICTING, LOADING, RESIDENT };
+
+  /**
+   * Finds a frame to hold a new page, preferring the free list over the replacer, and removes the old page from the
+   * page table. A dirty old page is registered in writeback_ rather than written here. Caller must hold latch_.
+   * The frame comes back with its pin count parked at -1 and its state set to EVICTING or LOADING.
+   * @param[out] frame_id the frame that was found
+   * @param[out] dirty_page_id the old page that still has to be written back, or INVALID_PAGE_ID
+   * @param strategy if not null, the frame in the current slot of its ring is reused when unpinned, and the frame
+   * found is recorded in that slot
+   * @return false if every frame is pinned
+   */
+  bool FindFreeFrame(frame_id_t *frame_id, page_id_t *dirty_page_id, BufferAccessStrategy *strategy = nullptr);
+
+  /**
+   * Brings a frame picked by FindFreeFrame into the RESIDENT state: writes back its old page if needed, then zeroes
+   * the frame and optionally reads the new page. latch_ is released around the I/O and held again on return.
+   * @param latch the caller's lock on latch_
+   * @param frame_id the frame, already pinned and mapped to its new page id
+   * @param dirty_page_id the old page to write back first, or INVALID_PAGE_ID
+   * @param read_page true to read the new page from disk, false for a brand new page
+   */
+  void LoadFrame(std::unique_lock<std::mutex> *latch, frame_id_t frame_id, page_id_t dirty_page_id, bool read_page) {
+    LoadFrames(latch, {{frame_id, dirty_page_id}}, read_page);
+  }
+
+  /**
+   * LoadFrame for a batch of frames, with one round of write-backs followed by one round of reads in page id order.
+   * @param latch the caller's lock on latch_
+   * @param frames each frame with the old page to write back first, or INVALID_PAGE_ID
+   * @param read_pages true to read the new pages from disk, false for brand new pages
+   */
+  void LoadFrames(std::unique_lock<std::mutex> *latch, const std::vector<std::pair<frame_id_t, page_id_t>> &frames,
+                  bool read_pages);
+
+  /**
+   * WAL: blocks until the log records up to the page LSN are on disk, before the page is written back; the caller holds
+   * the page still, and not latch_.
+   */
+  void ForceLog(Page *page);
+
+  /**
+   * Pins the frame holding a page without latch_, if the page is cached. The frame may still be loading.
+   * @param page_id the page to look for
+   * @param[out] frame_id the frame that was pinned
+   * @return true if the page was found and pinned
+   */
+  bool PinIfCached(page_id_t page_id, frame_id_t *frame_id);
+
+  /**
+   * Blocks until the frame's in-flight I/O, if any, is finished. The caller must have pinned the frame.
+   * @param latch the caller's lock on latch_
+   * @param frame_id the frame to wait on
+   */
+  void WaitForIo(std::unique_lock<std::mutex> *latch, frame_id_t frame_id);
+
+  /**
+   * Shared body of NewPageImpl and NewPageWithId: pins a frame for a brand new page and zeroes it, in the frame that
+   * already holds the id if a reader cached it before the page was created.
+   * @param latch the caller's lock on latch_, released around any write-back
+   * @param page_id id of the new page, allocated on disk already
+   * @param strategy the access strategy to take the frame from, if any
+   * @return nullptr if all frames are pinned, otherwise pointer to the new page
+   */
+  Page *CreatePage(std::unique_lock<std::mutex> *latch, page_id_t page_id, BufferAccessStrategy *strategy);
+
+  /**
+   * Pins a frame without latch_, unless it is parked (free or being repurposed).
+   * @param frame_id the frame to pin
+   * @return true if the pin count was incremented
+   */
+  bool TryPin(frame_id_t frame_id);
+
+  /**
+   * Drops one pin, handing the frame back to the replacer when it was the last one. Needs no latch.
+   * @param frame_id the frame to unpin, which must be pinned
+   */
+  void ReleasePin(frame_id_t frame_id);
+
+  /**
+   * One round of the background flusher.
+   */
+  void BackgroundFlush();
+
+  /**
+   * Body of the prefetch thread: loads the frames queued by PrefetchPages one at a time, then unpins them.
+   */
+  void RunPrefetcher();
+
+  /** @return a lock on latch_, with any time spent blocked on it accounted as latch wait */
+  std::unique_lock<std::mutex> AcquireLatch();
+
+  /**
+   * Re-acquires latch_ for a lock that was released around I/O, accounting any time spent blocked on it.
+   * @param latch the lock to acquire, which must not be held
+   */
+  void LockLatch(std::unique_lock<std::mutex> *latch);
+
+  /**
+   * Asserts that the page id belongs to this instance of the parallel buffer pool.
+   * @param page_id the page id to check
+   */
+  void ValidatePageId(page_id_t page_id) const;
+
+  /** Number of pages in the buffer pool. */
+  size_t pool_size_;
+  /** How many instances are in the parallel BPM (if present, otherwise just 1 BPI) */
+  const uint32_t num_instances_ = 1;
+  /** Index of this BPI in the parallel BPM (if present, otherwise just 0) */
+  const uint32_t instance_index_ = 0;
+  /** The NUMA node the frames are placed on, -1 if none */
+  const int numa_node_;
+  /** The page data of all frames, page aligned and possibly on huge pages. */
+  FrameArena arena_;
+  /** Array of buffer pool pages, i.e. the metadata and latch of each frame; frame i's data is arena_.GetFrame(i). */
+  Page *pages_;
+  /** Pointer to the disk manager. */
+  DiskManager *disk_manager_ __attribute__((__unused__));
+  /** Pointer to the log manager. */
+  LogManager *log_manager_ __attribute__((__unused__));
+  /** Page table for keeping track of buffer pool pages. Modified under latch_, read by hits without it. */
+  FrameDirectory page_table_;
+  /**
+   * Replacer to find unpinned pages for replacement. Hits do not tell it about their pins, so it may offer a frame
+   * that has been pinned since; FindFreeFrame skips those, and their last unpin offers them again.
+   */
+  Replacer *replacer_;
+  /** List of free pages. */
+  std::list<frame_id_t> free_list_;
+  /** State of every frame, indexed by frame id. Changed under latch_, read by hits without it. */
+  std::vector<std::atomic<FrameState>> frame_state_;
+  /** Signalled whenever a frame leaves EVICTING or LOADING, indexed by frame id. */
+  std::vector<std::condition_variable> frame_cv_;
+  /** Pages that have left the page table but whose write-back is still in flight, mapped to their frame. */
+  std::unordered_map<page_id_t, frame_id_t> writeback_;
+  /** The background flusher thread, if running. */
+  std::unique_ptr<std::thread> flush_thread_;
+  /** Tells the background flusher to keep going; cleared (under latch_) to stop it. */
+  bool flusher_running_ = false;
+  /** Wakes the background flusher up early when it is being stopped. */
+  std::condition_variable flusher_cv_;
+  /** Where the background flusher's next scan over the frames starts. */
+  size_t flush_hand_ = 0;
+  /** The prefetch thread, started by the first PrefetchPages call that has work for it. */
+  std::unique_ptr<std::thread> prefetch_thread_;
+  /** Tells the prefetch thread to keep going; cleared (under latch_) to stop it once its queue has drained. */
+  bool prefetcher_running_ = false;
+  /** Frames the prefetch thread still has to load, each with the dirty page it must write back first (if any). */
+  std::deque<std::pair<frame_id_t, page_id_t>> prefetch_queue_;
+  /** Wakes the prefetch thread up when frames are queued or it is being stopped. */
+  std::condition_variable prefetch_cv_;
+  /**
+   * Serializes changes to page_table_, free_list_, frame_state_, writeback_ and frame page ids. Hits and unpins
+   * only use atomics and do not take it, and it is never held across disk I/O.
+   */
+  std::mutex latch_;
+  /** Where the waits for latch_ are counted, with the ones of the other instances. */
+  ContentionSite *latch_site_{ContentionProfiler::Site("buffer_pool.latch")};
+  /** Hits, misses, evictions and wait times of this instance. */
+  BufferPoolCounters counters_;
+  /** The latencies of FetchPage on this instance. */
+  LatencyHistogram fetch_latency_;
+};
+}  // namespace bustub
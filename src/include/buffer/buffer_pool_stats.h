@@ -0,0 +1,97 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// buffer_pool_stats.h
+//
+// Identification: src/include/buffer/buffer_pool_stats.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>  // NOLINT
+#include <cstdint>
+
+#include "common/config.h"
+
+namespace bustub {
+
+/**
+ * A point-in-time copy of the counters of one buffer pool instance, or the sum over several.
+ */
+struct BufferPoolStats {
+  /** Fetches of a page that was already cached. */
+  uint64_t hits_{0};
+  /** Fetches that had to read the page from disk. */
+  uint64_t misses_{0};
+  /** Cached pages that were dropped to make room for another page. */
+  uint64_t evictions_{0};
+  /** Evicted pages that were dirty and had to be written back first. */
+  uint64_t dirty_writebacks_{0};
+  /** Time spent waiting for another thread's I/O on a frame, e.g. for a page it is still reading in. */
+  uint64_t pin_wait_ns_{0};
+  /** Time spent blocked on the buffer pool latch. */
+  uint64_t latch_wait_ns_{0};
+
+  /** @return the hits as a fraction of all fetches, 0 if nothing was fetched yet */
+  double HitRatio() const {
+    uint64_t fetches = hits_ + misses_;
+    return fetches == 0 ? 0 : static_cast<double>(hits_) / static_cast<double>(fetches);
+  }
+
+  BufferPoolStats &operator+=(const BufferPoolStats &other) {
+    hits_ += other.hits_;
+    misses_ += other.misses_;
+    evictions_ += other.evictions_;
+    dirty_writebacks_ += other.dirty_writebacks_;
+    pin_wait_ns_ += other.pin_wait_ns_;
+    latch_wait_ns_ += other.latch_wait_ns_;
+    return *this;
+  }
+};
+
+/**
+ * BufferPoolCounters is the live counterpart of BufferPoolStats. The counters are striped over a few cache lines,
+ * and every thread updates the stripe its id hashes to, so that the hit path of concurrent fetches does not bounce
+ * a single line between cores. Updates are relaxed; a snapshot is not a consistent cut across counters.
+ */
+class BufferPoolCounters {
+ public:
+  void AddHit() { Local().hits_.fetch_add(1, std::memory_order_relaxed); }
+  void AddMiss() { Local().misses_.fetch_add(1, std::memory_order_relaxed); }
+  void AddEviction() { Local().evictions_.fetch_add(1, std::memory_order_relaxed); }
+  void AddDirtyWriteback() { Local().dirty_writebacks_.fetch_add(1, std::memory_order_relaxed); }
+  void AddPinWait(std::chrono::nanoseconds wait) {
+    Local().pin_wait_ns_.fetch_add(wait.count(), std::memory_order_relaxed);
+  }
+  void AddLatchWait(std::chrono::nanoseconds wait) {
+    Local().latch_wait_ns_.fetch_add(wait.count(), std::memory_order_relaxed);
+  }
+
+  /** @return the sum of all stripes */
+  BufferPoolStats Snapshot() const;
+
+ private:
+  static constexpr size_t NUM_STRIPES = 16;
+
+  struct alignas(CACHE_LINE_SIZE) Stripe {
+    std::atomic<uint64_t> hits_{0};
+    std::atomic<uint64_t> misses_{0};
+    std::atomic<uint64_t> evictions_{0};
+    std::atomic<uint64_t> dirty_writebacks_{0};
+    std::atomic<uint64_t> pin_wait_ns_{0};
+    std::atomic<uint64_t> latch_wait_ns_{0};
+  };
+
+  /** @return the stripe of the calling thread */
+  Stripe &Local();
+
+  std::array<Stripe, NUM_STRIPES> stripes_;
+};
+
+}  // namespace bustub
@@ -0,0 +1,71 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// frame_arena.h
+//
+// Identification: src/include/buffer/frame_arena.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstddef>
+
+#include "common/config.h"
+#include "common/macros.h"
+
+namespace bustub {
+
+/**
+ * FrameArena is the memory that holds the page data of a buffer pool, one PAGE_SIZE frame after the other.
+ *
+ * The arena is mapped straight from the OS, and every frame starts on a PAGE_SIZE boundary (as direct I/O requires).
+ * Pools of at least HUGE_PAGE_SIZE are backed by huge pages where the OS provides them: explicitly reserved ones if
+ * there are any, transparent huge pages otherwise. Either way a multi-GB pool needs far fewer TLB entries.
+ *
+ * An arena may be placed on a NUMA node, before any of it is touched, rather than on the node of the thread that
+ * happens to touch each of its pages first.
+ */
+class FrameArena {
+ public:
+  /**
+   * Maps a zeroed arena.
+   * @param num_frames the number of frames in the arena
+   * @param numa_node the NUMA node to place the arena on, -1 to leave it to the OS
+   * @throws Exception OUT_OF_MEMORY if the memory cannot be mapped
+   */
+  explicit FrameArena(size_t num_frames, int numa_node = -1);
+
+  ~FrameArena();
+
+  DISALLOW_COPY_AND_MOVE(FrameArena);
+
+  /**
+   * @param frame_id the frame to look up
+   * @return the PAGE_SIZE bytes of the frame
+   */
+  char *GetFrame(size_t frame_id) { return base_ + frame_id * PAGE_SIZE; }
+
+  /** @return true if the arena is backed by reserved (hugetlbfs) huge pages */
+  bool UsesReservedHugePages() const { return reserved_huge_pages_; }
+
+  /** @return the NUMA node the arena was placed on, -1 if it was left to the OS */
+  int GetNumaNode() const { return numa_node_; }
+
+ private:
+  /** Places the mapping on a NUMA node, if it is one and the OS takes the hint. */
+  void PlaceOnNode(int numa_node);
+
+  /** Start of the first frame. */
+  char *base_ = nullptr;
+  /** Start and length of the whole mapping, which may extend beyond the frames. */
+  void *mapping_ = nullptr;
+  size_t mapping_size_ = 0;
+  bool reserved_huge_pages_ = false;
+  int numa_node_ = -1;
+};
+
+}  // namespace bustub
@@ -0,0 +1,89 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// frame_directory.h
+//
+// Identification: src/include/buffer/frame_directory.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+#include "common/config.h"
+#include "common/macros.h"
+
+namespace bustub {
+
+/**
+ * FrameDirectory maps the ids of the pages held by a buffer pool instance to their frames. It is an open-addressing
+ * (linear probing) table whose slots are single atomic words, so Find() takes no lock and may race with anything.
+ * Insert() and Erase() must be serialized by the caller; the buffer pool does them under its latch.
+ *
+ * A lock-free Find() can return an entry that is erased right after, so callers must pin the frame and re-check its
+ * page id before trusting the result.
+ */
+class FrameDirectory {
+ public:
+  /**
+   * Creates an empty directory.
+   * @param num_frames the most entries the directory will ever hold at once
+   */
+  explicit FrameDirectory(size_t num_frames);
+
+  ~FrameDirectory() = default;
+
+  DISALLOW_COPY_AND_MOVE(FrameDirectory);
+
+  /**
+   * Look up the frame that holds a page. Safe to call without any latch.
+   * @param page_id the page to look for
+   * @param[out] frame_id the frame the page was found in
+   * @return true if the page was found
+   */
+  bool Find(page_id_t page_id, frame_id_t *frame_id) const;
+
+  /**
+   * Add a mapping. The page must not be in the directory already.
+   * @param page_id the page id
+   * @param frame_id the frame holding the page
+   */
+  void Insert(page_id_t page_id, frame_id_t frame_id);
+
+  /**
+   * Remove a mapping.
+   * @param page_id the page id
+   * @return true if the page was in the directory
+   */
+  bool Erase(page_id_t page_id);
+
+ private:
+  /** A slot packs the page id in its high half and the frame id in its low half. */
+  static constexpr uint64_t EMPTY = ~static_cast<uint64_t>(0);
+  /** Left behind by Erase() so that probes for keys further along the run keep going. */
+  static constexpr uint64_t TOMBSTONE = EMPTY - 1;
+
+  static uint64_t Pack(page_id_t page_id, frame_id_t frame_id) {
+    return (static_cast<uint64_t>(static_cast<uint32_t>(page_id)) << 32) | static_cast<uint32_t>(frame_id);
+  }
+  static page_id_t PageOf(uint64_t slot) { return static_cast<page_id_t>(slot >> 32); }
+  static frame_id_t FrameOf(uint64_t slot) { return static_cast<frame_id_t>(slot & 0xFFFFFFFF); }
+
+  /** @return the slot a probe for page_id starts at */
+  size_t HomeSlot(page_id_t page_id) const {
+    return static_cast<size_t>((static_cast<uint64_t>(static_cast<uint32_t>(page_id)) * 0x9E3779B97F4A7C15ULL) >>
+                               (64 - capacity_bits_));
+  }
+
+  size_t capacity_bits_;
+  size_t mask_;
+  std::unique_ptr<std::atomic<uint64_t>[]> slots_;
+};
+
+}  // namespace bustub
@@ -0,0 +1,74 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// lru_k_replacer.h
+//
+// Identification: src/include/buffer/lru_k_replacer.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <mutex>  // NOLINT
+#include <vector>
+
+#include "buffer/replacer.h"
+#include "common/config.h"
+
+namespace bustub {
+
+/**
+ * LRUKReplacer implements the LRU-K replacement policy.
+ *
+ * Every Unpin counts as an access to the frame. The victim is the unpinned frame whose K-th most recent access lies
+ * furthest in the past. Frames with fewer than K accesses count as infinitely far and go first, oldest access
+ * first. A page touched once, e.g. by a sequential scan, is therefore given up before any page that has been
+ * re-referenced, which keeps a large scan from flushing the working set.
+ */
+class LRUKReplacer : public Replacer {
+ public:
+  /**
+   * Create a new LRUKReplacer.
+   * @param num_pages the maximum number of pages the LRUKReplacer will be required to store
+   * @param k how many past accesses of each frame are taken into account
+   */
+  LRUKReplacer(size_t num_pages, size_t k);
+
+  /**
+   * Destroys the LRUKReplacer.
+   */
+  ~LRUKReplacer() override;
+
+  bool Victim(frame_id_t *frame_id) override;
+
+  void Pin(frame_id_t frame_id) override;
+
+  void Unpin(frame_id_t frame_id) override;
+
+  size_t Size() override;
+
+ private:
+  struct FrameHistory {
+    /** Up to k_ access timestamps, oldest at the front. */
+    std::deque<uint64_t> accesses_;
+    /** True while the frame is unpinned and may be victimized. */
+    bool evictable_ = false;
+  };
+
+  /** Access history of every frame, indexed by frame id. Cleared when the frame is victimized. */
+  std::vector<FrameHistory> frames_;
+  /** Number of evictable frames. */
+  size_t size_ = 0;
+  /** Logical clock, advanced on every access. */
+  uint64_t current_timestamp_ = 0;
+  const size_t k_;
+  /** Protects everything above. */
+  std::mutex latch_;
+};
+
+}  // namespace bustub
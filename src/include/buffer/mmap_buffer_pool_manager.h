@@ -0,0 +1,127 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// mmap_buffer_pool_manager.h
+//
+// Identification: src/include/buffer/mmap_buffer_pool_manager.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <memory>
+#include <mutex>  // NOLINT
+#include <utility>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "buffer/buffer_pool_stats.h"
+#include "storage/disk/disk_manager.h"
+#include "storage/page/page.h"
+
+namespace bustub {
+
+/**
+ * MmapBufferPoolManager serves a database read only, e.g. on a reporting replica, straight out of a read-only mapping
+ * of the database file. Every page of the file has a Page whose data points into the mapping, so nothing is ever
+ * copied, evicted or written back, and a warm OS page cache makes the pool warm right away. Pages stored compressed
+ * are the exception: they are decompressed into memory of their own the first time they are fetched.
+ *
+ * Pages are checked against their checksums when they are first fetched. Pages may be pinned and read latched as
+ * usual, but not modified: NewPage and DeletePage fail, and unpinning a page as dirty is an error. The file must not
+ * be written while the pool exists.
+ */
+class MmapBufferPoolManager : public BufferPoolManager {
+ public:
+  /**
+   * Maps the database file and sets up a page for each page in it.
+   * @param disk_manager the disk manager of the database file
+   */
+  explicit MmapBufferPoolManager(DiskManager *disk_manager);
+
+  ~MmapBufferPoolManager() override = default;
+
+  DISALLOW_COPY_AND_MOVE(MmapBufferPoolManager);
+
+  /** @return the number of pages in the database file */
+  size_t GetPoolSize() override { return num_pages_; }
+
+  /**
+   * Tells the kernel the pages are about to be read, so that it reads them ahead.
+   * @param page_ids the pages that are about to be fetched
+   * @param strategy ignored; nothing is ever evicted
+   */
+  void PrefetchPages(const std::vector<page_id_t> &page_ids, BufferAccessStrategy *strategy = nullptr) override;
+
+  /** Same as FetchPage: there is no eviction for a strategy to confine. */
+  Page *FetchPageWithStrategy(page_id_t page_id, BufferAccessStrategy *strategy) override;
+
+  /**
+   * @param page_ids the pages to fetch
+   * @return the pages in the order of page_ids, with nullptr for those that are not in the file
+   */
+  std::vector<Page *> FetchPages(const std::vector<page_id_t> &page_ids) override;
+
+  /** Fails: the pool is read only. */
+  Page *NewPageWithStrategy(page_id_t *page_id, BufferAccessStrategy *strategy) override;
+
+  /** Fails: the pool is read only. */
+  page_id_t AllocateExtent(size_t num_pages) override { return INVALID_PAGE_ID; }
+
+  /** Fails: the pool is read only. */
+  Page *NewPageWithId(page_id_t page_id, BufferAccessStrategy *strategy) override { return nullptr; }
+
+  /** @return the fetches so far, with the first fetch of each page counted as a miss */
+  BufferPoolStats GetStats() override { return counters_.Snapshot(); }
+
+  /** @return nothing; a fetch is the address of the page in the mapping, whose page faults are not seen */
+  LatencySnapshot GetFetchLatency() override { return {}; }
+
+  /** @return nothing; no page is ever dirty */
+  std::vector<std::pair<page_id_t, lsn_t>> GetDirtyPageTable() override { return {}; }
+
+ protected:
+  /**
+   * @param page_id id of page to be fetched
+   * @return the page, pinned, or nullptr if it is not in the file
+   */
+  Page *FetchPageImpl(page_id_t page_id) override;
+
+  /**
+   * @param page_id id of page to be unpinned
+   * @param is_dirty must be false
+   * @return false if the page was not pinned or is_dirty is true
+   */
+  bool UnpinPageImpl(page_id_t page_id, bool is_dirty) override;
+
+  /** @return true if the page is in the file; there is never anything to flush */
+  bool FlushPageImpl(page_id_t page_id) override;
+
+  /** Fails: the pool is read only. */
+  Page *NewPageImpl(page_id_t *page_id) override;
+
+  /** Fails: the pool is read only. */
+  bool DeletePageImpl(page_id_t page_id) override;
+
+  /** Does nothing; no page is ever dirty. */
+  void FlushAllPagesImpl() override {}
+
+ private:
+  /** Points the page at its data and verifies it; runs once per page, on its first fetch. */
+  void LoadPage(page_id_t page_id);
+
+  DiskManager *disk_manager_;
+  size_t num_pages_;
+  /** One page per page of the file, indexed by page id. */
+  std::unique_ptr<Page[]> pages_;
+  /** Guards the first fetch of each page. */
+  std::unique_ptr<std::once_flag[]> loaded_;
+  /** The decompressed copies of the pages that are stored compressed. */
+  std::vector<std::unique_ptr<char[]>> copies_;
+  BufferPoolCounters counters_;
+};
+
+}  // namespace bustub
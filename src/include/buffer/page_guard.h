@@ -0,0 +1,125 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// page_guard.h
+//
+// Identification: src/include/buffer/page_guard.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include "common/config.h"
+#include "common/macros.h"
+
+namespace bustub {
+
+class BufferPoolManager;
+class Page;
+
+/**
+ * ReadPageGuard holds a pinned and read-latched page, obtained from BufferPoolManager::FetchPageRead. Dropping the
+ * guard, explicitly or by destroying it, releases the latch and unpins the page as clean.
+ */
+class ReadPageGuard {
+ public:
+  /** Creates an invalid guard, which holds no page. */
+  ReadPageGuard() = default;
+
+  /**
+   * @param bpm the buffer pool the page is pinned in
+   * @param page the page, already pinned and read-latched; nullptr for an invalid guard
+   */
+  ReadPageGuard(BufferPoolManager *bpm, Page *page) : bpm_(bpm), page_(page) {}
+
+  ReadPageGuard(ReadPageGuard &&that) noexcept;
+
+  ReadPageGuard &operator=(ReadPageGuard &&that) noexcept;
+
+  DISALLOW_COPY(ReadPageGuard);
+
+  ~ReadPageGuard() { Drop(); }
+
+  /** Releases the page early; the guard is invalid afterwards. */
+  void Drop();
+
+  /** @return true if the guard holds a page */
+  bool IsValid() const { return page_ != nullptr; }
+
+  /** @return the id of the page held */
+  page_id_t PageId() const;
+
+  /** @return the data of the page held */
+  const char *GetData() const;
+
+  /** @return the data of the page held, viewed as a T */
+  template <class T>
+  const T *As() const {
+    return reinterpret_cast<const T *>(GetData());
+  }
+
+ private:
+  BufferPoolManager *bpm_ = nullptr;
+  Page *page_ = nullptr;
+};
+
+/**
+ * WritePageGuard holds a pinned and write-latched page, obtained from BufferPoolManager::FetchPageWrite. Dropping the
+ * guard releases the latch and unpins the page, as dirty only if its data was accessed through GetDataMut or AsMut.
+ */
+class WritePageGuard {
+ public:
+  /** Creates an invalid guard, which holds no page. */
+  WritePageGuard() = default;
+
+  /**
+   * @param bpm the buffer pool the page is pinned in
+   * @param page the page, already pinned and write-latched; nullptr for an invalid guard
+   */
+  WritePageGuard(BufferPoolManager *bpm, Page *page) : bpm_(bpm), page_(page) {}
+
+  WritePageGuard(WritePageGuard &&that) noexcept;
+
+  WritePageGuard &operator=(WritePageGuard &&that) noexcept;
+
+  DISALLOW_COPY(WritePageGuard);
+
+  ~WritePageGuard() { Drop(); }
+
+  /** Releases the page early; the guard is invalid afterwards. */
+  void Drop();
+
+  /** @return true if the guard holds a page */
+  bool IsValid() const { return page_ != nullptr; }
+
+  /** @return the id of the page held */
+  page_id_t PageId() const;
+
+  /** @return the data of the page held, for reading only */
+  const char *GetData() const;
+
+  /** @return the data of the page held, which marks the page dirty */
+  char *GetDataMut();
+
+  /** @return the data of the page held, viewed as a T */
+  template <class T>
+  const T *As() const {
+    return reinterpret_cast<const T *>(GetData());
+  }
+
+  /** @return the data of the page held, viewed as a T, which marks the page dirty */
+  template <class T>
+  T *AsMut() {
+    return reinterpret_cast<T *>(GetDataMut());
+  }
+
+ private:
+  BufferPoolManager *bpm_ = nullptr;
+  Page *page_ = nullptr;
+  bool is_dirty_ = false;
+};
+
+}  // namespace bustub
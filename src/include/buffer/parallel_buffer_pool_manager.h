@@ -0,0 +1,176 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// parallel_buffer_pool_manager.h
+//
+// Identification: src/include/buffer/parallel_buffer_pool_manager.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <utility>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "buffer/buffer_pool_manager_instance.h"
+#include "recovery/log_manager.h"
+#include "storage/disk/disk_manager.h"
+#include "storage/page/page.h"
+
+namespace bustub {
+
+/**
+ * ParallelBufferPoolManager splits its frames over several BufferPoolManagerInstances, each with its own latch,
+ * page table, free list and replacer. Page P always lives in instance (P % num_instances), so threads working on
+ * different pages mostly contend on different latches.
+ *
+ * On a machine of several NUMA nodes the frames of instance i are placed on node (i % num_nodes), rather than all on
+ * the node of the thread that creates the pool, so that the pages are spread evenly over the nodes; GetNumaNode tells
+ * a worker which pages are local to it.
+ */
+class ParallelBufferPoolManager : public BufferPoolManager {
+ public:
+  /**
+   * Creates a new ParallelBufferPoolManager.
+   * @param num_instances the number of individual BufferPoolManagerInstances to store
+   * @param pool_size the pool size of each BufferPoolManagerInstance
+   * @param disk_manager the disk manager
+   * @param log_manager the log manager (for testing only: nullptr = disable logging)
+   * @param replacer_type the replacement policy of every instance
+   * @param num_numa_nodes the number of NUMA nodes to spread the instances over, 0 for those of the machine; with
+   * a single one the frames are left to the OS
+   */
+  ParallelBufferPoolManager(size_t num_instances, size_t pool_size, DiskManager *disk_manager,
+                            LogManager *log_manager = nullptr, ReplacerType replacer_type = ReplacerType::CLOCK,
+                            size_t num_numa_nodes = 0);
+
+  /**
+   * Destroys an existing ParallelBufferPoolManager.
+   */
+  ~ParallelBufferPoolManager() override;
+
+  /** @return size of the buffer pool, i.e. the combined size of all the instances */
+  size_t GetPoolSize() override;
+
+  /**
+   * Hands each page to the prefetcher of the instance responsible for it.
+   * @param page_ids the pages that are about to be fetched
+   * @param strategy the access strategy whose rings the frames come from, if any
+   */
+  void PrefetchPages(const std::vector<page_id_t> &page_ids, BufferAccessStrategy *strategy = nullptr) override;
+
+  /**
+   * Fetch a page through the responsible instance, taking frames from the strategy's ring in that instance.
+   * @param page_id id of page to be fetched
+   * @param strategy the bulk operation's access strategy, nullptr for a plain fetch
+   * @return the requested page, nullptr if the instance has every frame pinned
+   */
+  Page *FetchPageWithStrategy(page_id_t page_id, BufferAccessStrategy *strategy) override;
+
+  /**
+   * Splits the batch up by instance, and fetches each part as one batch of its instance.
+   * @param page_ids the pages to fetch
+   * @return the pages in the order of page_ids, with nullptr for those that no frame was left for
+   */
+  std::vector<Page *> FetchPages(const std::vector<page_id_t> &page_ids) override;
+
+  /**
+   * Create a page like NewPageImpl, taking frames from the strategy's ring in the instance the page lands on.
+   * @param[out] page_id id of created page
+   * @param strategy the bulk operation's access strategy, nullptr for a plain NewPage
+   * @return nullptr if no new pages could be created, otherwise pointer to new page
+   */
+  Page *NewPageWithStrategy(page_id_t *page_id, BufferAccessStrategy *strategy) override;
+
+  /** An extent spans all instances, its pages landing on one instance after the other. */
+  page_id_t AllocateExtent(size_t num_pages) override { return disk_manager_->AllocateExtent(num_pages); }
+
+  /**
+   * Create a page under a given id in the instance responsible for it.
+   * @param page_id id of the page to create
+   * @param strategy the bulk operation's access strategy, nullptr for a plain NewPage
+   * @return nullptr if the instance has every frame pinned, otherwise pointer to new page
+   */
+  Page *NewPageWithId(page_id_t page_id, BufferAccessStrategy *strategy) override;
+
+  /** @return the counters of all instances added up */
+  BufferPoolStats GetStats() override;
+
+  /** @return the fetch latencies of all instances merged */
+  LatencySnapshot GetFetchLatency() override;
+
+  /** @return the dirty page tables of all instances together */
+  std::vector<std::pair<page_id_t, lsn_t>> GetDirtyPageTable() override;
+
+  /** @return the NUMA node of the instance responsible for the page */
+  int GetNumaNode(page_id_t page_id) override { return GetBufferPoolManager(page_id)->GetNumaNode(page_id); }
+
+  /** Starts the background flusher of every instance. */
+  void StartBackgroundFlusher();
+
+  /** Stops the background flusher of every instance. */
+  void StopBackgroundFlusher();
+
+ protected:
+  /**
+   * @param page_id id of page
+   * @return pointer to the BufferPoolManagerInstance responsible for handling given page id
+   */
+  BufferPoolManagerInstance *GetBufferPoolManager(page_id_t page_id);
+
+  /**
+   * Fetch the requested page from the responsible BufferPoolManagerInstance.
+   * @param page_id id of page to be fetched
+   * @return the requested page
+   */
+  Page *FetchPageImpl(page_id_t page_id) override;
+
+  /**
+   * Unpin the target page from the responsible BufferPoolManagerInstance.
+   * @param page_id id of page to be unpinned
+   * @param is_dirty true if the page should be marked as dirty, false otherwise
+   * @return false if the page pin count is <= 0 before this call, true otherwise
+   */
+  bool UnpinPageImpl(page_id_t page_id, bool is_dirty) override;
+
+  /**
+   * Flushes the target page to disk.
+   * @param page_id id of page to be flushed, cannot be INVALID_PAGE_ID
+   * @return false if the page could not be found in the page table, true otherwise
+   */
+  bool FlushPageImpl(page_id_t page_id) override;
+
+  /**
+   * Creates a new page. The id allocated on disk picks the instance, so consecutive new pages go round robin over
+   * the instances; if that instance has every frame pinned, the id is given back and the next one is tried, up to
+   * once per instance.
+   * @param[out] page_id id of created page
+   * @return nullptr if no new pages could be created, otherwise pointer to new page
+   */
+  Page *NewPageImpl(page_id_t *page_id) override;
+
+  /**
+   * Deletes a page from the responsible BufferPoolManagerInstance.
+   * @param page_id id of page to be deleted
+   * @return false if the page exists but could not be deleted, true if the page didn't exist or deletion succeeded
+   */
+  bool DeletePageImpl(page_id_t page_id) override;
+
+  /**
+   * Flushes all the pages in every instance to disk.
+   */
+  void FlushAllPagesImpl() override;
+
+ private:
+  /** The individual buffer pools; instances_[i] caches exactly the pages with id % instances_.size() == i. */
+  std::vector<BufferPoolManagerInstance *> instances_;
+  /** Number of frames in each instance. */
+  size_t pool_size_;
+  /** Pointer to the disk manager, which hands out the page ids of new pages. */
+  DiskManager *disk_manager_;
+};
+}  // namespace bustub
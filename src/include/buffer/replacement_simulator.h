@@ -0,0 +1,80 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// replacement_simulator.h
+//
+// Identification: src/include/buffer/replacement_simulator.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "buffer/replacer.h"
+#include "common/config.h"
+#include "storage/disk/page_trace.h"
+
+namespace bustub {
+
+/** The hits and misses of a run of a ReplacementSimulator with one policy and pool size. */
+struct SimulationResult {
+  ReplacerType replacer_type_;
+  size_t pool_size_;
+  uint64_t hits_{0};
+  uint64_t misses_{0};
+
+  /** @return the share of the references that hit, 0 if there were none */
+  double HitRatio() const {
+    return hits_ + misses_ == 0 ? 0 : static_cast<double>(hits_) / static_cast<double>(hits_ + misses_);
+  }
+};
+
+/**
+ * ReplacementSimulator replays the page references of a workload against a replacement policy and a pool size,
+ * without pages or I/O, to tell what hit ratio a buffer pool of that policy and size would have had.
+ *
+ * It makes the replacer the calls BufferPoolManagerInstance makes: a miss takes a free frame, or a victim once there
+ * are none, and every reference unpins the page's frame, as the page is taken to be unpinned before the next one.
+ */
+class ReplacementSimulator {
+ public:
+  /** @param references the ids of the pages referenced, in order */
+  explicit ReplacementSimulator(std::vector<page_id_t> references) : references_(std::move(references)) {}
+
+  /**
+   * @param accesses the records of a page trace
+   * @return the pages the trace fetched, or those it read if it fetched none, as from a disk manager without a
+   * buffer pool on top
+   */
+  static std::vector<page_id_t> References(const std::vector<PageAccess> &accesses);
+
+  /** @return the number of references */
+  size_t GetNumReferences() const { return references_.size(); }
+
+  /** @return the number of different pages referenced, which a pool of as many frames only misses once each */
+  size_t GetNumDistinctPages() const;
+
+  /** @return the hits and misses of the references with a policy and a pool size */
+  SimulationResult Run(ReplacerType replacer_type, size_t pool_size) const;
+
+  /**
+   * Runs every policy with every pool size.
+   * @param pool_sizes the pool sizes, in frames
+   * @param replacer_types the policies
+   * @param num_threads the number of runs to carry out at once
+   * @return the results, by pool size and then by policy, in the order given
+   */
+  std::vector<SimulationResult> RunAll(const std::vector<size_t> &pool_sizes,
+                                       const std::vector<ReplacerType> &replacer_types, size_t num_threads) const;
+
+ private:
+  const std::vector<page_id_t> references_;
+};
+
+}  // namespace bustub
@@ -12,10 +12,23 @@
 
 #pragma once
 
+#include <array>
+#include <memory>
+
 #include "common/config.h"
 
 namespace bustub {
 
+/** The replacement policies a buffer pool can be built with. */
+enum class ReplacerType { CLOCK, LRU, LRU_K, ATOMIC_CLOCK };
+
+/**
+ * Every replacement policy, e.g. for trying each on a workload. ATOMIC_CLOCK is left out, as it makes the same
+ * choices as CLOCK, without a latch.
+ */
+constexpr std::array<ReplacerType, 3> ALL_REPLACER_TYPES = {ReplacerType::CLOCK, ReplacerType::LRU,
+                                                             ReplacerType::LRU_K};
+
 /**
  * Replacer is an abstract class that tracks page usage.
  */
@@ -47,4 +60,14 @@ class Replacer {
   virtual size_t Size() = 0;
 };
 
+/**
+ * @param type the replacement policy
+ * @param num_pages the number of frames the replacer tracks
+ * @return a replacer of the policy, as buffer pools are built with
+ */
+std::unique_ptr<Replacer> MakeReplacer(ReplacerType type, size_t num_pages);
+
+/** @return the name of a replacement policy, e.g. "lru_k" */
+const char *ReplacerTypeName(ReplacerType type);
+
 }  // namespace bustub
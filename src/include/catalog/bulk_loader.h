@@ -0,0 +1,144 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// bulk_loader.h
+//
+// Identification: src/include/catalog/bulk_loader.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <thread>  // NOLINT
+#include <utility>
+#include <vector>
+
+#include "catalog/catalog.h"
+#include "recovery/checkpoint_manager.h"
+#include "storage/table/tuple.h"
+
+namespace bustub {
+
+/** The formats of the files a BulkLoader reads. */
+enum class BulkLoadFormat {
+  /**
+   * A row per line, its fields in the order of the columns and apart by a delimiter. A field may be quoted in double
+   * quotes, to hold the delimiter, with a double quote in it doubled; it may not hold a line break. An empty field
+   * that is not quoted is NULL.
+   */
+  CSV,
+  /** The tuples of the table as written by BulkLoader::WriteBinary, which need no parsing. */
+  BINARY,
+};
+
+/** How a BulkLoader reads its files. */
+struct BulkLoadOptions {
+  BulkLoadFormat format_{BulkLoadFormat::CSV};
+  /** the separator of the fields of a CSV line */
+  char delimiter_{','};
+  /** whether the first line of each CSV file names the columns, and is skipped */
+  bool header_{false};
+  /** the number of chunks parsed and appended at once */
+  size_t num_threads_{std::max<size_t>(std::thread::hardware_concurrency(), 1)};
+  /** the bytes of input in a chunk, which a thread parses in one go and appends as one batch */
+  size_t chunk_size_{16 << 20};
+};
+
+/** What a bulk load did. */
+struct BulkLoadStats {
+  /** the rows appended to the table */
+  uint64_t rows_{0};
+  /** the pages the rows were appended in */
+  uint64_t pages_{0};
+  /** the bytes of input read */
+  uint64_t bytes_{0};
+};
+
+/**
+ * BulkLoader loads the rows of files into a table of the ROW layout, far faster than inserts one row at a time: the
+ * files are split into chunks, which threads parse at once into batches of tuples, and each batch is appended to the
+ * table in new pages of its own (see TableHeap::AppendTuples). The entries of the rows are kept aside, and each index
+ * of the table is built from all of them at the end, from the bottom up where it can be (see Index::InsertEntries).
+ *
+ * The load is unlogged: its rows are in no transaction, and neither their pages nor the index pages are logged. With
+ * logging on, the buffer pool is flushed once the load is done, and a checkpoint is taken if there is a checkpoint
+ * manager, after which the load is as durable as logged inserts would have made it; a load cut short by a crash
+ * leaves the table to be loaded again. The rows of different chunks are appended in the order the chunks finish in.
+ */
+class BulkLoader {
+ public:
+  /**
+   * @param catalog the catalog of the tables loaded
+   * @param checkpoint_manager the checkpoint manager to take a checkpoint with after a load, nullptr for none
+   */
+  explicit BulkLoader(Catalog *catalog, CheckpointManager *checkpoint_manager = nullptr)
+      : catalog_(catalog), checkpoint_manager_(checkpoint_manager) {}
+
+  /**
+   * Appends the rows of files to a table. A row that cannot be read fails the load with an Exception, once the
+   * chunks being loaded are done; the rows loaded by then stay, with their index entries.
+   * @param table_name the table, of the ROW layout
+   * @param files the files to load, all of the format of the options
+   * @param options how to read the files
+   * @return what the load did
+   */
+  BulkLoadStats Load(const std::string &table_name, const std::vector<std::string> &files,
+                     const BulkLoadOptions &options = {});
+
+  /**
+   * Writes tuples to a file of the BINARY format, for a table of their schema.
+   * @return false if the file could not be written
+   */
+  static bool WriteBinary(const std::string &file_name, const std::vector<Tuple> &tuples);
+
+  /** The first bytes of a file of the BINARY format. */
+  static constexpr char BINARY_MAGIC[8] = {'B', 'T', 'B', 'U', 'L', 'K', '0', '1'};
+
+  /**
+   * The bytes of tuples in a block of a file of the BINARY format, at most, or those of its only tuple if it is
+   * larger. The file is split between blocks, each of which starts with the number of its tuples and its bytes.
+   */
+  static constexpr size_t BINARY_BLOCK_SIZE = 1 << 20;
+
+ private:
+  /** A range of bytes of a file that a thread loads. */
+  struct Chunk {
+    size_t file_;
+    uint64_t begin_;
+    uint64_t end_;
+  };
+
+  /**
+   * Splits files into chunks of about options.chunk_size_ bytes; the chunks of a CSV file are split between lines
+   * by the threads that read them, those of a BINARY file between its blocks.
+   */
+  static std::vector<Chunk> Split(const std::vector<std::string> &files, const BulkLoadOptions &options);
+
+  /**
+   * Parses the lines of a CSV file that start in a chunk.
+   * @param[out] tuples the rows of the lines are appended here
+   */
+  static void ParseCsv(const std::string &file_name, const Chunk &chunk, const Schema &schema,
+                       const BulkLoadOptions &options, std::vector<Tuple> *tuples);
+
+  /** Parses a line of a CSV file, which starts at offset in the file, into a row. */
+  static Tuple ParseCsvLine(const std::string &line, uint64_t offset, const std::string &file_name,
+                            const Schema &schema, char delimiter);
+
+  /** @return the value of a field of a CSV line for a column of a type; ok is set to whether the field is one */
+  static Value ParseField(const std::string &field, bool quoted, TypeId type, bool *ok);
+
+  /** Reads the tuples of the blocks of a BINARY file in a chunk, appending them to tuples. */
+  static void ReadBinary(const std::string &file_name, const Chunk &chunk, std::vector<Tuple> *tuples);
+
+  Catalog *catalog_;
+  CheckpointManager *checkpoint_manager_;
+};
+
+}  // namespace bustub
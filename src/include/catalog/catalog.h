@@ -1,16 +1,38 @@
 #pragma once
 
+#include <algorithm>
+#include <atomic>
 #include <memory>
+#include <mutex>  // NOLINT
+#include <numeric>
+#include <shared_mutex>
 #include <string>
 #include <unordered_map>
+#include <unordered_set>
+#include <tuple>
 #include <utility>
 #include <vector>
 
 #include "buffer/buffer_pool_manager.h"
+#include "catalog/materialized_view.h"
 #include "catalog/schema.h"
+#include "catalog/table_statistics.h"
+#include "common/exception.h"
+#include "common/macros.h"
+#include "common/memory_tracker.h"
+#include "recovery/log_manager.h"
 #include "storage/index/b_plus_tree_index.h"
+#include "storage/index/bitmap_index.h"
 #include "storage/index/index.h"
+#include "storage/page/catalog_page.h"
+#include "storage/page/header_page.h"
+#include "storage/table/clustered_table.h"
+#include "storage/table/memory_table.h"
+#include "storage/table/pax_column_scanner.h"
+#include "storage/table/partitioned_table.h"
+#include "storage/table/pax_table_heap.h"
 #include "storage/table/table_heap.h"
+#include "storage/table/table_page_scanner.h"
 
 namespace bustub {
 
@@ -22,15 +44,65 @@ using column_oid_t = uint32_t;
 using index_oid_t = uint32_t;
 
 /**
- * Metadata about a table.
+ * How the rows of a table are stored: ROW tables are TableHeaps of slotted pages, PAX tables are PaxTableHeaps, whose
+ * pages keep every column apart, for scans that read a few columns of wide tables, and MEMORY tables are MemoryTables,
+ * whose rows are on the heap rather than in the buffer pool, for small tables that are read far more than written, and
+ * CLUSTERED tables are ClusteredTables, whose rows are in the leaves of a B+ tree by their primary key, for tables that
+ * are read by that key, whether one row or a range of them.
+ */
+enum class TableLayout { ROW, PAX, MEMORY, CLUSTERED };
+
+/**
+ * Metadata about a table. Of table_, pax_table_, memory_table_ and clustered_table_, only the one of the table's layout
+ * is set; a
+ * partitioned table is of the ROW layout, and has partitions_ instead of table_. statistics_ is set once the table is
+ * analyzed, and is as of the last Catalog::Analyze.
  */
 struct TableMetadata {
   TableMetadata(Schema schema, std::string name, std::unique_ptr<TableHeap> &&table, table_oid_t oid)
-      : schema_(std::move(schema)), name_(std::move(name)), table_(std::move(table)), oid_(oid) {}
+      : schema_(std::move(schema)),
+        name_(std::move(name)),
+        table_(std::move(table)),
+        oid_(oid),
+        catalog_bytes_(sizeof(TableMetadata) + schema_.GetColumnCount() * sizeof(Column) + name_.capacity()) {
+    MemoryTracker::Global()->Allocate(MemoryCategory::CATALOG, catalog_bytes_);
+  }
+
+  ~TableMetadata() { MemoryTracker::Global()->Free(MemoryCategory::CATALOG, catalog_bytes_); }
+
+  DISALLOW_COPY_AND_MOVE(TableMetadata);
+
   Schema schema_;
   std::string name_;
   std::unique_ptr<TableHeap> table_;
   table_oid_t oid_;
+  TableLayout layout_{TableLayout::ROW};
+  std::unique_ptr<PaxTableHeap> pax_table_;
+  std::unique_ptr<MemoryTable> memory_table_;
+  std::unique_ptr<ClusteredTable> clustered_table_;
+  std::unique_ptr<PartitionedTable> partitions_;
+  std::unique_ptr<TableStatistics> statistics_;
+  /** The bytes of the metadata itself, its schema and its name, which are accounted for as CATALOG memory */
+  const size_t catalog_bytes_;
+
+  /** @return the heaps of a table of the ROW layout: table_, or the heap of every partition */
+  std::vector<TableHeap *> GetHeaps() const {
+    return partitions_ != nullptr ? partitions_->GetPartitions() : std::vector<TableHeap *>{table_.get()};
+  }
+
+  /** Reads a tuple from the table of the layout, as an index lookup does. @return true if the tuple exists */
+  bool GetTuple(const RID &rid, Tuple *tuple, Transaction *txn) {
+    switch (layout_) {
+      case TableLayout::PAX:
+        return pax_table_->GetTuple(rid, tuple, txn);
+      case TableLayout::MEMORY:
+        return memory_table_->GetTuple(rid, tuple, txn);
+      case TableLayout::CLUSTERED:
+        return clustered_table_->GetTuple(rid, tuple, txn);
+      default:
+        return partitions_ != nullptr ? partitions_->GetTuple(rid, tuple, txn) : table_->GetTuple(rid, tuple, txn);
+    }
+  }
 };
 
 /**
@@ -44,18 +116,65 @@ struct IndexInfo {
         index_(std::move(index)),
         index_oid_(index_oid),
         table_name_(std::move(table_name)),
-        key_size_(key_size) {}
+        key_size_(key_size),
+        catalog_bytes_(sizeof(IndexInfo) + key_schema_.GetColumnCount() * sizeof(Column) + name_.capacity() +
+                       table_name_.capacity()) {
+    MemoryTracker::Global()->Allocate(MemoryCategory::CATALOG, catalog_bytes_);
+  }
+
+  ~IndexInfo() { MemoryTracker::Global()->Free(MemoryCategory::CATALOG, catalog_bytes_); }
+
+  DISALLOW_COPY_AND_MOVE(IndexInfo);
+
   Schema key_schema_;
   std::string name_;
   std::unique_ptr<Index> index_;
   index_oid_t index_oid_;
   std::string table_name_;
   const size_t key_size_;
+  /** Whether the index is in memory only, as a bitmap index is, which the catalog does not write out */
+  bool in_memory_{false};
+
+  /** @return false while the index is being built, when it is not to be read yet */
+  bool IsValid() const { return !building_.load(); }
+
+  /** Whether the index is being built, see Catalog::CreateIndex; the changes to it go to build_log_ meanwhile */
+  std::atomic<bool> building_{false};
+  /** Guards build_log_, and the end of the build */
+  std::mutex build_latch_;
+  /** The changes made to the index while it was being built, in order: true for an insert, the key and the RID */
+  std::vector<std::tuple<bool, Tuple, RID>> build_log_;
+  /** The bytes of the metadata itself, its key schema and its names, which are accounted for as CATALOG memory */
+  const size_t catalog_bytes_;
+};
+
+class Catalog;
+
+/**
+ * IndexRollback takes the writes of an aborting transaction back out of the indexes of a table that the transaction
+ * did not write to itself: those created while it ran, whose build scan may have indexed the rows it had written but
+ * not committed (see Catalog::CreateIndex). The catalog observes every heap of rows it makes with one.
+ */
+class IndexRollback : public TableWriteObserver {
+ public:
+  explicit IndexRollback(Catalog *catalog) : catalog_(catalog) {}
+
+  void OnCommit(const std::vector<const TableWriteRecord *> & /*records*/) override {}
+
+  void OnAbort(Transaction *txn, const std::vector<const TableWriteRecord *> &records) override;
+
+ private:
+  Catalog *catalog_;
 };
 
 /**
- * Catalog is a non-persistent catalog that is designed for the executor to use.
+ * Catalog is a catalog that is designed for the executor to use.
  * It handles table creation and table lookup.
+ *
+ * A catalog is in memory only, unless it is opened: an opened catalog loads the metadata it kept on disk before, and
+ * writes it out again, to catalog pages that the header page records, whenever a table or an index is created or a
+ * table is analyzed. Loading reads the catalog pages only; tables and indexes are reattached by their page ids, so
+ * that it takes as long for a large database as for a small one.
  */
 class Catalog {
  public:
@@ -68,18 +187,154 @@ class Catalog {
   Catalog(BufferPoolManager *bpm, LockManager *lock_manager, LogManager *log_manager)
       : bpm_{bpm}, lock_manager_{lock_manager}, log_manager_{log_manager} {}
 
+  /** The name of the header page record of the first catalog page */
+  static constexpr const char *CATALOG_RECORD_NAME = "__catalog";
+
+  /**
+   * Makes the catalog persistent, and loads the tables, indexes and statistics it had when it was last written out,
+   * if it ever was. Page HEADER_PAGE_ID has to be the header page, as it is for the B+ trees; this is called before
+   * any table is created.
+   */
+  void Open();
+
   /**
    * Create a new table and return its metadata.
    * @param txn the transaction in which the table is being created
    * @param table_name the name of the new table
    * @param schema the schema of the new table
+   * @param layout how the rows of the table are stored; a MEMORY table, and its indexes, are not written out with an
+   * opened catalog, as its rows do not outlive the process
    * @return a pointer to the metadata of the new table
    */
-  TableMetadata *CreateTable(Transaction *txn, const std::string &table_name, const Schema &schema) {
+  TableMetadata *CreateTable(Transaction *txn, const std::string &table_name, const Schema &schema,
+                             TableLayout layout = TableLayout::ROW) {
     BUSTUB_ASSERT(names_.count(table_name) == 0, "Table names should be unique!");
     names_[table_name] = next_table_oid_;
+    if (layout == TableLayout::PAX) {
+      auto table_info = std::make_unique<TableMetadata>(schema, table_name, nullptr, next_table_oid_);
+      table_info->layout_ = TableLayout::PAX;
+      // the heap keeps a pointer to the schema, so it is made for the schema in the metadata
+      table_info->pax_table_ = std::make_unique<PaxTableHeap>(bpm_, &table_info->schema_);
+      TableMetadata *pax_table_info = table_info.get();
+      tables_[next_table_oid_++] = std::move(table_info);
+      Persist();
+      return pax_table_info;
+    }
+    if (layout == TableLayout::MEMORY) {
+      auto table_info = std::make_unique<TableMetadata>(schema, table_name, nullptr, next_table_oid_);
+      table_info->layout_ = TableLayout::MEMORY;
+      table_info->memory_table_ = std::make_unique<MemoryTable>();
+      TableMetadata *memory_table_info = table_info.get();
+      tables_[next_table_oid_++] = std::move(table_info);
+      return memory_table_info;
+    }
     tables_[next_table_oid_] = std::make_unique<TableMetadata> (schema, table_name, std::make_unique<TableHeap>(bpm_, lock_manager_, log_manager_, txn), next_table_oid_);
-    return tables_[next_table_oid_++].get();
+    // large values are moved out of the tuples, into overflow chains, rather than failing the insert
+    tables_[next_table_oid_]->table_->EnableToast(&tables_[next_table_oid_]->schema_);
+    tables_[next_table_oid_]->table_->SetTableOid(next_table_oid_);
+    tables_[next_table_oid_]->table_->AddWriteObserver(&index_rollback_);
+    TableMetadata *table_info = tables_[next_table_oid_++].get();
+    Persist();
+    return table_info;
+  }
+
+  /**
+   * Create a new table of the CLUSTERED layout, whose rows are kept in a B+ tree by their primary key, and return its
+   * metadata.
+   * @param txn the transaction in which the table is being created
+   * @param table_name the name of the new table
+   * @param schema the schema of the new table
+   * @param key_idx the column of the primary key, of an integer type
+   * @return a pointer to the metadata of the new table
+   */
+  TableMetadata *CreateClusteredTable(Transaction *txn, const std::string &table_name, const Schema &schema,
+                                      uint32_t key_idx) {
+    BUSTUB_ASSERT(names_.count(table_name) == 0, "Table names should be unique!");
+    if (key_idx >= schema.GetColumnCount() || !ClusteredTable::IsKeyType(schema.GetColumn(key_idx).GetType())) {
+      throw Exception(ExceptionType::MISMATCH_TYPE, "the primary key of a clustered table is an integer column");
+    }
+    names_[table_name] = next_table_oid_;
+    auto table_info = std::make_unique<TableMetadata>(schema, table_name, nullptr, next_table_oid_);
+    table_info->layout_ = TableLayout::CLUSTERED;
+    table_info->clustered_table_ =
+        std::make_unique<ClusteredTable>(bpm_, &table_info->schema_, key_idx, next_table_oid_);
+    TableMetadata *clustered_table_info = table_info.get();
+    tables_[next_table_oid_++] = std::move(table_info);
+    Persist();
+    return clustered_table_info;
+  }
+
+  /**
+   * Create a new table whose rows are kept in partitions by the value of a column, and return its metadata.
+   * @param txn the transaction in which the table is being created
+   * @param table_name the name of the new table
+   * @param schema the schema of the new table
+   * @param scheme the partitions of the table, and the column of its partition key
+   * @return a pointer to the metadata of the new table
+   */
+  TableMetadata *CreatePartitionedTable(Transaction *txn, const std::string &table_name, const Schema &schema,
+                                        PartitionScheme scheme) {
+    BUSTUB_ASSERT(names_.count(table_name) == 0, "Table names should be unique!");
+    BUSTUB_ASSERT(scheme.key_idx_ < schema.GetColumnCount(), "the partition key is a column of the table");
+    // the bounds are compared with, and written out as, values of the key's type
+    for (Value &bound : scheme.bounds_) {
+      bound = bound.CastAs(schema.GetColumn(scheme.key_idx_).GetType());
+    }
+    names_[table_name] = next_table_oid_;
+    auto table_info = std::make_unique<TableMetadata>(schema, table_name, nullptr, next_table_oid_);
+    table_info->partitions_ = std::make_unique<PartitionedTable>(
+        bpm_, lock_manager_, log_manager_, &table_info->schema_, std::move(scheme), next_table_oid_, txn);
+    for (TableHeap *heap : table_info->GetHeaps()) {
+      heap->AddWriteObserver(&index_rollback_);
+    }
+    TableMetadata *partitioned_table_info = table_info.get();
+    tables_[next_table_oid_++] = std::move(table_info);
+    Persist();
+    return partitioned_table_info;
+  }
+
+  /**
+   * Empty a partition of a partitioned table as a whole, e.g. to drop the oldest range of a time series: the entries
+   * of its rows are taken out of the indexes of the table, and the pages of the partition are freed (see
+   * PartitionedTable::Truncate). The partition stays in the table, empty, and takes the rows of its keys again. The
+   * changes of txn to the rows of the partition go with them, to be neither applied nor undone when it ends.
+   * @param txn the transaction in which the partition is being dropped
+   * @param table_name the name of the partitioned table
+   * @param partition the partition to drop
+   */
+  void DropPartition(Transaction *txn, const std::string &table_name, size_t partition) {
+    TableMetadata *table_info = GetTable(table_name);
+    if (table_info->partitions_ == nullptr || partition >= table_info->partitions_->GetPartitionCount()) {
+      throw Exception(ExceptionType::OUT_OF_RANGE, "no such partition of the table");
+    }
+    TableHeap *heap = table_info->partitions_->GetPartition(partition);
+    std::vector<page_id_t> page_ids = heap->GetPageIds();
+    std::unordered_set<page_id_t> pages(page_ids.begin(), page_ids.end());
+    auto index_write_set = txn->GetIndexWriteSet();
+    index_write_set->erase(std::remove_if(index_write_set->begin(), index_write_set->end(),
+                                          [&](const IndexWriteRecord &item) {
+                                            return item.table_oid_ == table_info->oid_ &&
+                                                   pages.count(item.rid_.GetPageId()) != 0;
+                                          }),
+                           index_write_set->end());
+    std::vector<IndexInfo *> indexes = GetTableIndexes(table_name);
+    if (!indexes.empty()) {
+      for (auto iter = heap->Begin(txn); iter != heap->End(); ++iter) {
+        for (IndexInfo *index_info : indexes) {
+          Index *index = index_info->index_.get();
+          index->DeleteEntry(iter->KeyFromTuple(table_info->schema_, index_info->key_schema_, index->GetKeyAttrs()),
+                             iter->GetRid(), txn);
+        }
+      }
+    }
+    table_info->partitions_->Truncate(partition, txn);
+    for (auto &[name, view] : views_) {
+      const std::vector<TableHeap *> &heaps = view->GetHeaps();
+      if (std::find(heaps.begin(), heaps.end(), heap) != heaps.end()) {
+        view->Refresh(txn);
+      }
+    }
+    Persist();
   }
 
   /** @return table metadata by name */
@@ -96,8 +351,176 @@ class Catalog {
     return tables_[table_oid].get(); 
   }
 
+  /**
+   * Start keeping a zone map of some columns of a table, which sequential scans skip pages by.
+   * @param txn the transaction in which the zone map is being created
+   * @param table_name the name of the table, of the ROW layout; each partition of a partitioned one keeps its own
+   * @param column_idxs the columns to keep zones of
+   */
+  void CreateZoneMap(Transaction *txn, const std::string &table_name, const std::vector<uint32_t> &column_idxs) {
+    TableMetadata *table_info = GetTable(table_name);
+    if (table_info->layout_ != TableLayout::ROW) {
+      throw Exception(ExceptionType::NOT_IMPLEMENTED, "zone maps are kept for tables of the ROW layout only");
+    }
+    for (TableHeap *heap : table_info->GetHeaps()) {
+      heap->CreateZoneMap(&table_info->schema_, column_idxs, txn);
+    }
+  }
+
+  /**
+   * Create a materialized view of a table, SELECT g1, .., COUNT(c1), SUM(c2), .. FROM t GROUP BY g1, .., which is
+   * built by a scan of the table and kept up to date by the transactions that commit from then on (see
+   * MaterializedView). The views are kept in memory only.
+   * @param txn the transaction in which the table is read, which no other transaction writes to meanwhile
+   * @param view_name the name of the view
+   * @param table_name the name of the table, of the ROW layout
+   * @param group_by_idxs the columns of the table to group by
+   * @param aggregates the aggregates of each group, COUNT, SUM, MIN or MAX of columns of the table
+   * @return the view
+   */
+  MaterializedView *CreateMaterializedView(Transaction *txn, const std::string &view_name,
+                                           const std::string &table_name, const std::vector<uint32_t> &group_by_idxs,
+                                           const std::vector<ViewAggregate> &aggregates) {
+    TableMetadata *table_info = GetTable(table_name);
+    if (table_info->layout_ != TableLayout::ROW) {
+      throw Exception(ExceptionType::NOT_IMPLEMENTED, "materialized views are kept of tables of the ROW layout only");
+    }
+    if (views_.count(view_name) != 0) {
+      throw Exception(ExceptionType::INVALID, "the materialized view already exists");
+    }
+    auto view = std::make_unique<MaterializedView>(view_name, table_info->GetHeaps(), &table_info->schema_,
+                                                   group_by_idxs, aggregates);
+    view->Refresh(txn);
+    for (TableHeap *heap : table_info->GetHeaps()) {
+      heap->AddWriteObserver(view.get());
+    }
+    return (views_[view_name] = std::move(view)).get();
+  }
+
+  /** @return the materialized view of a name */
+  MaterializedView *GetMaterializedView(const std::string &view_name) {
+    auto it = views_.find(view_name);
+    if (it == views_.end()) {
+      throw std::out_of_range("Materialized view shouldn't exist yet");
+    }
+    return it->second.get();
+  }
+
+  /**
+   * Collect the statistics of a table, as ANALYZE does: the row count, and the null fraction, distinct count and
+   * histogram of every column. They replace the statistics the table had. A table of rows may be analyzed from a
+   * random sample of its pages rather than all of them, whose counts are scaled up to the whole table (see
+   * StatisticsCollector::Finish); a PAX, MEMORY or CLUSTERED table is read whole.
+   * @param txn the transaction in which the table is read
+   * @param table_name the name of the table
+   * @param num_buckets the most buckets of a histogram
+   * @param sample_size the number of rows the histograms are made of
+   * @param page_fraction the fraction of the pages of a table of rows to read, 1 for all of them
+   * @return the statistics of the table
+   */
+  const TableStatistics *Analyze(Transaction *txn, const std::string &table_name,
+                                 size_t num_buckets = StatisticsCollector::DEFAULT_NUM_BUCKETS,
+                                 size_t sample_size = StatisticsCollector::DEFAULT_SAMPLE_SIZE,
+                                 double page_fraction = 1) {
+    TableMetadata *table_info = GetTable(table_name);
+    const Schema *schema = &table_info->schema_;
+    StatisticsCollector collector(schema, sample_size);
+    std::vector<Value> row;
+    double scale = 1;
+    if (table_info->layout_ == TableLayout::PAX) {
+      std::vector<uint32_t> column_idxs(schema->GetColumnCount());
+      std::iota(column_idxs.begin(), column_idxs.end(), 0);
+      PaxColumnScanner scanner(table_info->pax_table_.get(), column_idxs);
+      RID rid;
+      while (scanner.Next(&rid, &row)) {
+        collector.Add(row);
+      }
+    } else if (table_info->layout_ == TableLayout::MEMORY) {
+      uint64_t position = 0;
+      Tuple tuple;
+      while (table_info->memory_table_->Next(&position, &tuple)) {
+        row.clear();
+        for (uint32_t i = 0; i < schema->GetColumnCount(); i++) {
+          row.push_back(tuple.GetValue(schema, i));
+        }
+        collector.Add(row);
+      }
+    } else if (table_info->layout_ == TableLayout::CLUSTERED) {
+      ClusteredTableScanner scanner(table_info->clustered_table_.get());
+      Tuple tuple;
+      while (scanner.Next(&tuple)) {
+        row.clear();
+        for (uint32_t i = 0; i < schema->GetColumnCount(); i++) {
+          row.push_back(tuple.GetValue(schema, i));
+        }
+        collector.Add(row);
+      }
+    } else if (page_fraction < 1) {
+      // the pages of every partition are sampled alike
+      size_t num_pages = 0;
+      size_t num_sampled_pages = 0;
+      for (TableHeap *table : table_info->GetHeaps()) {
+        ToastStore *toast = table->GetToastStore();
+        size_t table_pages = table->GetPageIds().size();
+        std::vector<page_id_t> page_ids = table->GetSampledPageIds(page_fraction, 0);
+        if (page_ids.empty() && table_pages != 0) {
+          // a table too small for any of its pages to be picked is read whole
+          page_ids = table->GetPageIds();
+        }
+        num_pages += table_pages;
+        num_sampled_pages += page_ids.size();
+        TablePageScanner scanner(table, txn, std::move(page_ids));
+        Tuple view;
+        Tuple detoasted;
+        while (scanner.Next(&view)) {
+          const Tuple *tuple = &view;
+          if (toast != nullptr && toast->IsToasted(view)) {
+            toast->Detoast(view, &detoasted);
+            tuple = &detoasted;
+          }
+          row.clear();
+          for (uint32_t i = 0; i < schema->GetColumnCount(); i++) {
+            row.push_back(tuple->GetValue(schema, i));
+          }
+          collector.Add(row);
+        }
+      }
+      scale = num_sampled_pages == 0 ? 1 : static_cast<double>(num_pages) / static_cast<double>(num_sampled_pages);
+    } else {
+      for (TableHeap *table : table_info->GetHeaps()) {
+        ToastStore *toast = table->GetToastStore();
+        for (auto iter = table->Begin(txn); iter != table->End(); ++iter) {
+          row.clear();
+          for (uint32_t i = 0; i < schema->GetColumnCount(); i++) {
+            row.push_back(toast != nullptr && iter->IsToasted(schema, i) ? toast->GetValue(*iter, i)
+                                                                          : iter->GetValue(schema, i));
+          }
+          collector.Add(row);
+        }
+      }
+    }
+    table_info->statistics_ = std::make_unique<TableStatistics>(collector.Finish(num_buckets, scale));
+    Persist();
+    return table_info->statistics_.get();
+  }
+
+  /** @return the statistics of a table as of its last Analyze, nullptr if it was never analyzed */
+  const TableStatistics *GetTableStatistics(const std::string &table_name) {
+    return GetTable(table_name)->statistics_.get();
+  }
+
   /**
    * Create a new index, populate existing data of the table and return its metadata.
+   *
+   * The index is built online, without holding off the writers of the table. It is registered first, as one that is
+   * being built, so that the changes that writers make to it from then on are logged by InsertIndexEntry and
+   * DeleteIndexEntry rather than applied. The pages of a table of rows are then scanned by num_threads threads, a
+   * morsel at a time (see ParallelTableScan), without taking row locks, then the pages linked since the scan started,
+   * and the entries of the rows are bulk loaded into the index. At last the changes logged meanwhile are applied to
+   * the index in order, which makes up for the rows the scan saw before or after they changed, and the index is marked
+   * valid, for the optimizer to use. Writers that looked the indexes of the table up before it was registered look
+   * them up again, see IndexUpdateBuffer. The scan sees the uncommitted rows of the writers too, which IndexRollback
+   * takes back out of the index if their writer aborts.
    * @param txn the transaction in which the table is being created
    * @param index_name the name of the new index
    * @param table_name the name of the table
@@ -105,37 +528,193 @@ class Catalog {
    * @param key_schema the schema of the key
    * @param key_attrs key attributes
    * @param keysize size of the key
+   * @param num_threads the threads that scan a table of rows
    * @return a pointer to the metadata of the new table
    */
   template <class KeyType, class ValueType, class KeyComparator>
   IndexInfo *CreateIndex(Transaction *txn, const std::string &index_name, const std::string &table_name,
                          const Schema &schema, const Schema &key_schema, const std::vector<uint32_t> &key_attrs,
-                         size_t keysize) {
-    return nullptr;
+                         size_t keysize, size_t num_threads = 1) {
+    TableMetadata *table_info = GetTable(table_name);
+    auto index = std::make_unique<BPlusTreeIndex<KeyType, ValueType, KeyComparator>>(
+        new IndexMetadata(index_name, table_name, &schema, key_attrs), bpm_);
+    index_oid_t index_oid = next_index_oid_++;
+    index->SetLockManager(lock_manager_, index_oid);
+    IndexInfo *index_info = RegisterIndex(
+        std::make_unique<IndexInfo>(key_schema, index_name, std::move(index), index_oid, table_name, keysize));
+    FillIndex(txn, table_info, index_info->index_.get(), schema, key_schema, key_attrs, num_threads);
+    FinishIndexBuild(index_info);
+    Persist();
+    return index_info;
+  }
+
+  /**
+   * Create a new bitmap index of a table, for columns of few distinct values, populate it with the rows of the table
+   * and return its metadata. The index is kept in memory only (see BitmapIndex), and is not written out with an opened
+   * catalog.
+   * @param txn the transaction in which the index is being created
+   * @param index_name the name of the new index
+   * @param table_name the name of the table
+   * @param schema the schema of the table
+   * @param key_schema the schema of the key
+   * @param key_attrs key attributes
+   * @return a pointer to the metadata of the new index
+   */
+  IndexInfo *CreateBitmapIndex(Transaction *txn, const std::string &index_name, const std::string &table_name,
+                               const Schema &schema, const Schema &key_schema, const std::vector<uint32_t> &key_attrs) {
+    TableMetadata *table_info = GetTable(table_name);
+    auto index =
+        std::make_unique<BitmapIndex>(new IndexMetadata(index_name, table_name, &schema, key_attrs, false));
+    index_oid_t index_oid = next_index_oid_++;
+    auto info = std::make_unique<IndexInfo>(key_schema, index_name, std::move(index), index_oid, table_name,
+                                            key_schema.GetLength());
+    info->in_memory_ = true;
+    IndexInfo *index_info = RegisterIndex(std::move(info));
+    FillIndex(txn, table_info, index_info->index_.get(), schema, key_schema, key_attrs, 1);
+    FinishIndexBuild(index_info);
+    return index_info;
+  }
+
+  /** @return index metadata by index and table name, nullptr if there is no such index */
+  IndexInfo *GetIndex(const std::string &index_name, const std::string &table_name) {
+    std::shared_lock latch(index_latch_);
+    auto table_indexes = index_names_.find(table_name);
+    if (table_indexes == index_names_.end()) {
+      return nullptr;
+    }
+    auto index_oid = table_indexes->second.find(index_name);
+    return index_oid == table_indexes->second.end() ? nullptr : GetIndex(index_oid->second);
+  }
+
+  /** @return index metadata by oid, nullptr if there is no such index */
+  IndexInfo *GetIndex(index_oid_t index_oid) {
+    std::shared_lock latch(index_latch_);
+    auto index_info = indexes_.find(index_oid);
+    return index_info == indexes_.end() ? nullptr : index_info->second.get();
+  }
+
+  /**
+   * @return a number that changes whenever an index is added, which callers that keep the indexes of a table, as
+   * IndexUpdateBuffer does, check to tell when to look them up again
+   */
+  uint64_t GetIndexVersion() const { return index_version_.load(); }
+
+  /**
+   * @return the metadata of all indexes on a table, including those being built, which writers change as the others,
+   * but which are not to be read (see IndexInfo::IsValid)
+   */
+  std::vector<IndexInfo *> GetTableIndexes(const std::string &table_name) {
+    std::shared_lock latch(index_latch_);
+    std::vector<IndexInfo *> table_indexes;
+    auto index_oids = index_names_.find(table_name);
+    if (index_oids != index_names_.end()) {
+      for (const auto &index_oid : index_oids->second) {
+        table_indexes.push_back(indexes_.at(index_oid.second).get());
+      }
+    }
+    return table_indexes;
   }
 
-  IndexInfo *GetIndex(const std::string &index_name, const std::string &table_name) { return nullptr; }
+  /**
+   * Inserts an entry into an index, and logs the insert for redo, and undo, in the transaction if logging is on.
+   * The changes of the executors, and of rolling them back, to an index go through here and DeleteIndexEntry.
+   */
+  void InsertIndexEntry(IndexInfo *index_info, const Tuple &key, const RID &rid, Transaction *txn);
 
-  IndexInfo *GetIndex(index_oid_t index_oid) { return nullptr; }
+  /** Deletes an entry from an index, and logs the delete as InsertIndexEntry does the insert. */
+  void DeleteIndexEntry(IndexInfo *index_info, const Tuple &key, const RID &rid, Transaction *txn);
 
-  std::vector<IndexInfo *> GetTableIndexes(const std::string &table_name) { return std::vector<IndexInfo *>(); }
+  /** Inserts many entries into an index at once, see Index::InsertEntries, each logged as by InsertIndexEntry. */
+  void InsertIndexEntries(IndexInfo *index_info, const std::vector<std::pair<Tuple, RID>> &entries, Transaction *txn);
+
+  /** Deletes many entries from an index at once, see Index::DeleteEntries, each logged as by DeleteIndexEntry. */
+  void DeleteIndexEntries(IndexInfo *index_info, const std::vector<std::pair<Tuple, RID>> &entries, Transaction *txn);
 
  private:
-  [[maybe_unused]] BufferPoolManager *bpm_;
+  /** Adds an index that is being built to the catalog. @return its metadata */
+  IndexInfo *RegisterIndex(std::unique_ptr<IndexInfo> index_info);
+
+  /** Applies the changes logged while the index was being built to it, and marks it valid. */
+  void FinishIndexBuild(IndexInfo *index_info);
+
+  /**
+   * Logs changes to an index that is being built, to be applied once it is.
+   * @return false if the index is not being built, and the changes are to be applied now
+   */
+  bool CaptureIndexEntries(IndexInfo *index_info, bool insert, const std::vector<std::pair<Tuple, RID>> &entries);
+
+  /** @return the entries of the rows of a table of rows for an index, read by num_threads threads without locks */
+  static std::vector<std::pair<Tuple, RID>> ScanIndexEntries(TableMetadata *table_info, const Schema &schema,
+                                                             const Schema &key_schema,
+                                                             const std::vector<uint32_t> &key_attrs,
+                                                             size_t num_threads);
+
+  /** Inserts the entries of the rows of a table into a new index of it. */
+  void FillIndex(Transaction *txn, TableMetadata *table_info, Index *index, const Schema &schema,
+                 const Schema &key_schema, const std::vector<uint32_t> &key_attrs, size_t num_threads) {
+    if (table_info->layout_ == TableLayout::PAX) {
+      // only the key columns are read, straight into the key
+      PaxColumnScanner scanner(table_info->pax_table_.get(), key_attrs);
+      RID rid;
+      std::vector<Value> key_values;
+      while (scanner.Next(&rid, &key_values)) {
+        index->InsertEntry(Tuple(key_values, &key_schema), rid, txn);
+      }
+    } else if (table_info->layout_ == TableLayout::MEMORY) {
+      uint64_t position = 0;
+      Tuple tuple;
+      while (table_info->memory_table_->Next(&position, &tuple)) {
+        index->InsertEntry(tuple.KeyFromTuple(schema, key_schema, key_attrs), tuple.GetRid(), txn);
+      }
+    } else if (table_info->layout_ == TableLayout::CLUSTERED) {
+      // the entries point at the rows by their primary keys, see ClusteredTable::RidOf
+      ClusteredTableScanner scanner(table_info->clustered_table_.get());
+      Tuple tuple;
+      while (scanner.Next(&tuple)) {
+        index->InsertEntry(tuple.KeyFromTuple(schema, key_schema, key_attrs), tuple.GetRid(), txn);
+      }
+    } else {
+      // in one batch, which a B+ tree bulk loads
+      index->InsertEntries(ScanIndexEntries(table_info, schema, key_schema, key_attrs, num_threads), nullptr);
+    }
+  }
+
+  /** Writes the metadata out to the catalog pages, if the catalog is opened */
+  void Persist();
+
+  /** Logs a change of an index entry in the transaction, if logging is on */
+  void LogIndexEntry(LogRecordType type, IndexInfo *index_info, const Tuple &key, const RID &rid, Transaction *txn);
+
+  BufferPoolManager *bpm_;
   [[maybe_unused]] LockManager *lock_manager_;
-  [[maybe_unused]] LogManager *log_manager_;
+  LogManager *log_manager_;
 
+  /** Observes the heaps of tables_, which go before it */
+  IndexRollback index_rollback_{this};
   /** tables_ : table identifiers -> table metadata. Note that tables_ owns all table metadata. */
   std::unordered_map<table_oid_t, std::unique_ptr<TableMetadata>> tables_;
   /** names_ : table names -> table identifiers */
   std::unordered_map<std::string, table_oid_t> names_;
   /** The next table identifier to be used. */
   std::atomic<table_oid_t> next_table_oid_{0};
+  /**
+   * Guards indexes_ and index_names_, so that writers may look the indexes of a table up while one is created; the
+   * statements that change the catalog run one at a time
+   */
+  mutable std::shared_mutex index_latch_;
   /** indexes_: index identifiers -> index metadata. Note that indexes_ owns all index metadata */
   std::unordered_map<index_oid_t, std::unique_ptr<IndexInfo>> indexes_;
   /** index_names_: table name -> index names -> index identifiers */
   std::unordered_map<std::string, std::unordered_map<std::string, index_oid_t>> index_names_;
   /** The next index identifier to be used */
   std::atomic<index_oid_t> next_index_oid_{0};
+  /** Bumped by every index registered, see GetIndexVersion */
+  std::atomic<uint64_t> index_version_{0};
+  /** views_: view names -> the materialized views, which go before the tables they observe */
+  std::unordered_map<std::string, std::unique_ptr<MaterializedView>> views_;
+  /** Whether the catalog is opened */
+  bool persistent_{false};
+  /** The first catalog page, INVALID_PAGE_ID until the catalog is first written out */
+  page_id_t catalog_page_id_{INVALID_PAGE_ID};
 };
 }  // namespace bustub
@@ -0,0 +1,180 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// materialized_view.h
+//
+// Identification: src/include/catalog/materialized_view.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "catalog/schema.h"
+#include "execution/plans/aggregation_plan.h"
+#include "storage/table/table_heap.h"
+#include "storage/table/tuple.h"
+
+namespace bustub {
+
+/** An aggregate of a column of its table that a MaterializedView keeps for each group. */
+struct ViewAggregate {
+  /** COUNT, SUM, MIN or MAX */
+  AggregationType type_;
+  uint32_t column_idx_;
+};
+
+/**
+ * MaterializedView keeps the result of a GROUP BY aggregation of a table, SELECT g1, .., COUNT(c1), SUM(c2), ..
+ * FROM t GROUP BY g1, .., so that reading it costs a row per group rather than a scan of the table. The view is built
+ * by a scan of the table, and is kept up to date from then on by the writes of the transactions that commit, which it
+ * is told of as a TableWriteObserver: each row a transaction inserted, deleted or updated takes its values out of the
+ * aggregates of the group it was in and adds its new ones to those of the group it is in, so that a commit costs the
+ * view as much as the rows it wrote.
+ *
+ * COUNT and SUM take deltas either way. MIN and MAX take those of the rows added, but a row taken out that held the
+ * extreme of its group leaves the group stale, and its extreme is read again from the table by the next Scan; the
+ * rows committed meanwhile are taken into account, and a group whose extreme goes meanwhile is read once more. A group
+ * without rows left goes away, but for the only group of a view without group-bys, which is always there, as the
+ * result of an aggregation without GROUP BY is.
+ *
+ * The aggregates are those of AggregationExecutor, of the same types and NULLs: COUNT counts the values that are not
+ * NULL, and SUM, MIN and MAX of no values are NULL. A SUM of integers wraps around meanwhile, and is only out of range
+ * if the sum of all the rows is. The groups are kept in memory, and are built again when the view is created again;
+ * the catalog does not write views out, as with in-memory tables. A write that is in no transaction, e.g. a bulk
+ * load, is not seen; Refresh builds the view again after it.
+ */
+class MaterializedView : public TableWriteObserver {
+ public:
+  /**
+   * Creates a view of a table of the ROW layout, empty until Refresh builds it.
+   * @param name the name of the view
+   * @param heaps the heaps of the table, those of its partitions if it is partitioned
+   * @param schema the schema of the table, which has to outlive the view
+   * @param group_by_idxs the columns of the table to group by
+   * @param aggregates the aggregates of the groups, of the columns of the table
+   * @throw Exception if an aggregate is not a COUNT, SUM, MIN or MAX, or the SUM, MIN or MAX of a VARCHAR
+   */
+  MaterializedView(std::string name, std::vector<TableHeap *> heaps, const Schema *schema,
+                   std::vector<uint32_t> group_by_idxs, std::vector<ViewAggregate> aggregates);
+
+  /** @return the name of the view */
+  const std::string &GetName() const { return name_; }
+
+  /** @return the heaps of the table of the view */
+  const std::vector<TableHeap *> &GetHeaps() const { return heaps_; }
+
+  /** @return the schema of the rows of the view: the group-by columns, then the aggregates, in order */
+  const Schema &GetSchema() const { return *schema_; }
+
+  /**
+   * Builds the view again from a scan of its table, which has to be written to by no one else meanwhile.
+   * @param txn the transaction the table is read in
+   */
+  void Refresh(Transaction *txn);
+
+  /**
+   * Reads the rows of the view, one per group, in no particular order. The extremes of the stale groups are read
+   * from the table first.
+   * @param txn the transaction the table is read in, which locks what it reads (REPEATABLE_READ, READ_COMMITTED or
+   * SERIALIZABLE), so that it reads the rows as they were committed
+   * @param[out] result the rows, in the schema of the view
+   */
+  void Scan(Transaction *txn, std::vector<Tuple> *result);
+
+  /** @return the number of groups of the view */
+  size_t GetGroupCount();
+
+  void OnCommit(const std::vector<const TableWriteRecord *> &records) override;
+
+ private:
+  /** A value as the state of an aggregate: an int64_t, or a double if its column is a DECIMAL. */
+  struct Number {
+    int64_t integer_{0};
+    double decimal_{0};
+  };
+
+  /** An aggregate of a group. */
+  struct AggregateState {
+    /** the values aggregated that are not NULL */
+    int64_t count_{0};
+    /** the sum of a SUM, the extreme of a MIN or MAX */
+    Number value_;
+    /** a MIN or MAX whose extreme was taken out, which is read again from the table */
+    bool stale_{false};
+    /** the best value added and the best one taken out since a stale extreme began to be read again */
+    std::optional<Number> added_;
+    std::optional<Number> removed_;
+  };
+
+  /** A group of the view. */
+  struct Group {
+    std::vector<Value> group_bys_;
+    /** the rows of the table in the group */
+    int64_t rows_{0};
+    std::vector<AggregateState> states_;
+    /** tells the groups of a key apart, as the group of a key may go away and come back while its extremes are read */
+    uint64_t id_;
+  };
+
+  /** @return the key of the groups_ of a row of the table, the bytes of its group-by values */
+  std::string GroupKey(const Tuple &tuple, std::vector<Value> *group_bys) const;
+
+  /** Adds a row of the table to its group, or takes it out if sign is -1; under latch_. */
+  void Apply(const Tuple &tuple, int sign);
+
+  /** @return a value of the column of an aggregate as its state */
+  Number AsNumber(const Value &value, uint32_t aggregate) const;
+
+  /** @return true if a is a better extreme than b for a MIN or a MAX aggregate, i.e. smaller or greater */
+  bool Better(uint32_t aggregate, const Number &a, const Number &b) const;
+
+  /** Keeps the better extreme of best and a value, for a MIN or a MAX aggregate */
+  void KeepBest(uint32_t aggregate, const Number &value, std::optional<Number> *best) const;
+
+  /** @return the row of the table a write record of a committing transaction left, nullopt if there is none */
+  static std::optional<Tuple> RowAfter(const TableWriteRecord *last);
+
+  /** @return the row of the table before the first write record of a committing transaction, nullopt if none */
+  static std::optional<Tuple> RowBefore(const TableWriteRecord *first);
+
+  /** Calls visit with each row of the table that the transaction reads. */
+  template <typename Visit>
+  void ScanTable(Transaction *txn, Visit &&visit);
+
+  /** @return the value of an aggregate of a group, of the type of its column of the schema */
+  Value AggregateValue(const Group &group, uint32_t aggregate) const;
+
+  /** Reads the extremes of the stale groups from the table; a group whose extreme went meanwhile stays stale. */
+  void ReadStaleExtremes(Transaction *txn);
+
+  /** @return a new group of a key */
+  Group *NewGroup(const std::string &key, std::vector<Value> &&group_bys);
+
+  const std::string name_;
+  const std::vector<TableHeap *> heaps_;
+  const Schema *table_schema_;
+  const std::vector<uint32_t> group_by_idxs_;
+  const std::vector<ViewAggregate> aggregates_;
+  std::unique_ptr<Schema> schema_;
+  std::unique_ptr<Schema> group_by_schema_;
+  /** whether the state of each aggregate is a double, rather than an int64_t */
+  std::vector<bool> decimal_;
+
+  std::mutex latch_;
+  std::unordered_map<std::string, Group> groups_;
+  uint64_t next_group_id_{0};
+};
+
+}  // namespace bustub
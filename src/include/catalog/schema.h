@@ -68,6 +68,15 @@ class Schema {
     UNREACHABLE("Column does not exist");
   }
 
+  /**
+   * @return the offset of a column in a tuple of the schema, from a table of the offsets kept next to each other, so
+   * that reading a column does not go through its Column
+   */
+  inline uint32_t GetOffset(const uint32_t col_idx) const { return offsets_[col_idx]; }
+
+  /** @return the type of a column, from a table of the types kept next to each other */
+  inline TypeId GetType(const uint32_t col_idx) const { return types_[col_idx]; }
+
   /** @return the indices of non-inlined columns */
   const std::vector<uint32_t> &GetUnlinedColumns() const { return uninlined_columns_; }
 
@@ -98,6 +107,10 @@ class Schema {
 
   /** Indices of all uninlined columns. */
   std::vector<uint32_t> uninlined_columns_;
+
+  /** The offsets and types of the columns, by column index. */
+  std::vector<uint32_t> offsets_;
+  std::vector<TypeId> types_;
 };
 
 }  // namespace bustub
@@ -0,0 +1,155 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// table_statistics.h
+//
+// Identification: src/include/catalog/table_statistics.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstdint>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include "catalog/schema.h"
+#include "common/util/hash_util.h"
+#include "type/value.h"
+
+namespace bustub {
+
+/**
+ * HyperLogLog estimates the number of distinct hashes it is given, within about 1.04 / sqrt(2^precision), in a byte
+ * per register: every hash goes to one of the 2^precision registers by its top bits, which keeps the longest run of
+ * leading zeros of the rest it has seen. Two of the same precision merge into the one of all of their hashes, so that
+ * the sketches of the parts of an input, e.g. of the threads of a parallel aggregation, add up to that of the whole.
+ */
+class HyperLogLog {
+ public:
+  static constexpr uint32_t DEFAULT_PRECISION = 12;
+
+  /** @param precision the number of bits that pick a register, between 4 and 16 */
+  explicit HyperLogLog(uint32_t precision = DEFAULT_PRECISION);
+
+  /**
+   * @return the hash a value is counted by: integers are their own hash, which Add mixes, and strings are murmured
+   */
+  static hash_t HashValue(const Value &value);
+
+  /** Adds a hash; it is mixed again, so that e.g. an integer can be its own hash */
+  void Add(hash_t hash);
+
+  /** Takes in the hashes of another HyperLogLog of the same precision */
+  void Merge(const HyperLogLog &other);
+
+  /** @return the estimated number of distinct hashes added */
+  double Estimate() const;
+
+  /** @return the bytes the HyperLogLog takes */
+  size_t GetMemoryUsage() const { return sizeof(HyperLogLog) + registers_.size(); }
+
+ private:
+  uint32_t precision_;
+  std::vector<uint8_t> registers_;
+};
+
+/**
+ * What ANALYZE knows about a column: the fraction of its values that are null, the estimated number of distinct
+ * non-null values, and an equi-depth histogram of a sample of them, whose bounds split the sample into buckets of
+ * the same number of values. Columns of TIMESTAMP, whose Values do not compare, have no histogram.
+ */
+class ColumnStatistics {
+ public:
+  /** The selectivity of predicates the statistics cannot tell anything about */
+  static constexpr double DEFAULT_SELECTIVITY = 1.0 / 3;
+
+  ColumnStatistics(double null_fraction, double distinct_count, std::vector<Value> bounds)
+      : null_fraction_(null_fraction), distinct_count_(distinct_count), bounds_(std::move(bounds)) {}
+
+  /** @return the fraction of the rows that are null in the column */
+  double GetNullFraction() const { return null_fraction_; }
+
+  /** @return the estimated number of distinct non-null values */
+  double GetDistinctCount() const { return distinct_count_; }
+
+  /** @return the bounds of the histogram buckets, from the smallest value of the sample to the largest */
+  const std::vector<Value> &GetHistogramBounds() const { return bounds_; }
+
+  /** @return the estimated fraction of the rows whose value is the given one */
+  double EstimateEquals(const Value &value) const;
+
+  /** @return the estimated fraction of the rows whose value is less than the given one */
+  double EstimateLessThan(const Value &value) const;
+
+ private:
+  double null_fraction_;
+  double distinct_count_;
+  std::vector<Value> bounds_;
+};
+
+/** The statistics of a table that ANALYZE collected: its number of rows, and the statistics of each of its columns. */
+class TableStatistics {
+ public:
+  TableStatistics(uint64_t row_count, std::vector<ColumnStatistics> columns)
+      : row_count_(row_count), columns_(std::move(columns)) {}
+
+  /** @return the number of rows of the table when it was analyzed */
+  uint64_t GetRowCount() const { return row_count_; }
+
+  /** @return the statistics of a column */
+  const ColumnStatistics &GetColumn(uint32_t column_idx) const { return columns_[column_idx]; }
+
+ private:
+  uint64_t row_count_;
+  std::vector<ColumnStatistics> columns_;
+};
+
+/**
+ * StatisticsCollector makes the TableStatistics of the rows it is given, one at a time. The hashes of every value go
+ * into a HyperLogLog per column, and the rows into a reservoir sample of a fixed size, which the histograms are made
+ * of when it finishes.
+ */
+class StatisticsCollector {
+ public:
+  static constexpr size_t DEFAULT_SAMPLE_SIZE = 30000;
+  static constexpr size_t DEFAULT_NUM_BUCKETS = 100;
+  /** The fraction of distinct values a column of a sample has at least, to be taken to be unique by Finish */
+  static constexpr double UNIQUE_FRACTION = 0.9;
+
+  /**
+   * @param schema the schema of the rows
+   * @param sample_size the number of rows to make histograms of
+   * @param seed the seed of the sampling, for a deterministic sample
+   */
+  explicit StatisticsCollector(const Schema *schema, size_t sample_size = DEFAULT_SAMPLE_SIZE, uint64_t seed = 0);
+
+  /** Adds a row, the values of every column of the schema */
+  void Add(const std::vector<Value> &row);
+
+  /**
+   * @param num_buckets the most buckets of a histogram
+   * @param scale the number of rows of the table each row added stands for, more than 1 if the rows are a sample of
+   * the pages of the table. The row count is scaled by it; a column whose values the sample finds nearly all distinct
+   * is taken to be unique, and its distinct count scaled as well, while that of any other column is not, as its
+   * values mostly recur on the pages that were not read.
+   * @return the statistics of the rows added, with histograms of up to num_buckets buckets
+   */
+  TableStatistics Finish(size_t num_buckets = DEFAULT_NUM_BUCKETS, double scale = 1) const;
+
+ private:
+  const Schema *schema_;
+  size_t sample_size_;
+  std::mt19937_64 random_;
+  uint64_t row_count_{0};
+  std::vector<uint64_t> null_counts_;
+  std::vector<HyperLogLog> distinct_;
+  /** The sampled rows */
+  std::vector<std::vector<Value>> sample_;
+};
+
+}  // namespace bustub
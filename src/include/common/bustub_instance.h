@@ -10,10 +10,16 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <ostream>
 #include <string>
+#include <utility>
+#include <vector>
 
-#include "buffer/buffer_pool_manager.h"
+#include "buffer/buffer_pool_manager_instance.h"
 #include "common/config.h"
+#include "common/contention.h"
+#include "common/latency_histogram.h"
+#include "common/memory_tracker.h"
 #include "concurrency/lock_manager.h"
 #include "recovery/checkpoint_manager.h"
 #include "recovery/log_manager.h"
@@ -23,16 +29,22 @@ namespace bustub {
 
 class BustubInstance {
  public:
-  explicit BustubInstance(const std::string &db_file_name) {
+  /**
+   * @param db_file_name the database file
+   * @param pool_size the number of frames in the buffer pool
+   * @param compress_log whether the log is written compressed
+   */
+  explicit BustubInstance(const std::string &db_file_name, size_t pool_size = BUFFER_POOL_SIZE,
+                          bool compress_log = false) {
     enable_logging = false;
 
     // storage related
     disk_manager_ = new DiskManager(db_file_name);
 
     // log related
-    log_manager_ = new LogManager(disk_manager_);
+    log_manager_ = new LogManager(disk_manager_, compress_log);
 
-    buffer_pool_manager_ = new BufferPoolManager(BUFFER_POOL_SIZE, disk_manager_, log_manager_);
+    buffer_pool_manager_ = new BufferPoolManagerInstance(pool_size, disk_manager_, log_manager_);
 
     // txn related
     lock_manager_ = new LockManager();
@@ -40,6 +52,15 @@ class BustubInstance {
 
     // checkpoints
     checkpoint_manager_ = new CheckpointManager(transaction_manager_, log_manager_, buffer_pool_manager_);
+
+    // latencies
+    latency_registry_.Register("buffer_pool.fetch_page", [this] { return buffer_pool_manager_->GetFetchLatency(); });
+    latency_registry_.Register("disk.read_page", [this] { return disk_manager_->GetReadLatency(); });
+    latency_registry_.Register("disk.write_page", [this] { return disk_manager_->GetWriteLatency(); });
+    latency_registry_.Register("lock.wait", [this] { return lock_manager_->GetLockWaitLatency(); });
+    latency_registry_.Register("log.flush", [this] { return log_manager_->GetFlushLatency(); });
+    latency_registry_.Register("log.write", [this] { return disk_manager_->GetLogWriteLatency(); });
+    latency_registry_.Register("txn.commit", [this] { return transaction_manager_->GetCommitLatency(); });
   }
 
   ~BustubInstance() {
@@ -54,12 +75,36 @@ class BustubInstance {
     delete disk_manager_;
   }
 
+  /** @return the latencies of the core operations so far, by name, each merged over the threads that recorded it */
+  std::vector<std::pair<std::string, LatencySnapshot>> GetLatencies() const { return latency_registry_.Snapshot(); }
+
+  /** Writes a line of the count, mean, percentiles and maximum of each of the latencies of GetLatencies to out */
+  void DumpLatencies(std::ostream *out) const { latency_registry_.Dump(out); }
+
+  /**
+   * Writes the lock sites that waited the longest, see ContentionProfiler, then the records whose locks were waited
+   * for the most, a line each.
+   * @param out the stream to write to
+   * @param limit the most sites, and the most records, to write
+   */
+  void DumpContention(std::ostream *out, size_t limit = 10) const {
+    ContentionProfiler::Dump(out, limit);
+    for (const RowContention &row : lock_manager_->GetHotRids(limit)) {
+      *out << "row (" << row.rid_.GetPageId() << ", " << row.rid_.GetSlotNum() << "): waits " << row.waits_
+           << ", waited " << row.wait_ns_ / 1000 << " us\n";
+    }
+  }
+
+  /** Writes the memory of the process by category, now and at its peak, see MemoryTracker::Global */
+  void DumpMemory(std::ostream *out) const { MemoryTracker::Global()->Dump(out); }
+
   DiskManager *disk_manager_;
   BufferPoolManager *buffer_pool_manager_;
   LockManager *lock_manager_;
   TransactionManager *transaction_manager_;
   LogManager *log_manager_;
   CheckpointManager *checkpoint_manager_;
+  LatencyRegistry latency_registry_;
 };
 
 }  // namespace bustub
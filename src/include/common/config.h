@@ -14,6 +14,7 @@
 
 #include <atomic>
 #include <chrono>  // NOLINT
+#include <cstddef>
 #include <cstdint>
 
 namespace bustub {
@@ -27,20 +28,59 @@ extern std::atomic<bool> enable_logging;
 /** If ENABLE_LOGGING is true, the log should be flushed to disk every LOG_TIMEOUT. */
 extern std::chrono::duration<int64_t> log_timeout;
 
+/** The commit of an asynchronous-commit transaction is on disk at most ASYNC_COMMIT_DELAY after it returned. */
+extern std::chrono::milliseconds async_commit_delay;
+
+/** The buffer pool's background flusher, when running, wakes up every BG_FLUSH_INTERVAL milliseconds. */
+extern std::chrono::milliseconds bg_flush_interval;
+
+/** The background flusher tries to keep this many frames per buffer pool instance clean and unpinned. */
+extern std::atomic<size_t> bg_flush_clean_target;
+
+/** The background flusher writes at most this many pages per buffer pool instance on each wake-up. */
+extern std::atomic<size_t> bg_flush_pages_per_round;
+
+/** The background vacuum, when running, wakes up every VACUUM_INTERVAL milliseconds. */
+extern std::chrono::milliseconds vacuum_interval;
+
+/** The background vacuum compacts at most this many pages per table on each wake-up. */
+extern std::atomic<size_t> vacuum_pages_per_round;
+
+// The page size is fixed at build time (cmake -DBUSTUB_PAGE_SIZE=16384), since page layouts are sized off it. A
+// database file can only be opened by a build with the page size it was created with.
+#ifndef BUSTUB_PAGE_SIZE
+#define BUSTUB_PAGE_SIZE 4096
+#endif
+
 static constexpr int INVALID_PAGE_ID = -1;                                    // invalid page id
 static constexpr int INVALID_TXN_ID = -1;                                     // invalid transaction id
 static constexpr int INVALID_LSN = -1;                                        // invalid log sequence number
+static constexpr int64_t INVALID_TS = -1;                                     // invalid commit timestamp
 static constexpr int HEADER_PAGE_ID = 0;                                      // the header page id
-static constexpr int PAGE_SIZE = 4096;                                        // size of a data page in byte
-static constexpr int BUFFER_POOL_SIZE = 10;                                   // size of buffer pool
+static constexpr int PAGE_SIZE = BUSTUB_PAGE_SIZE;                            // size of a data page in byte
+static constexpr int BUFFER_POOL_SIZE = 10;                                   // default size of buffer pool
 static constexpr int LOG_BUFFER_SIZE = ((BUFFER_POOL_SIZE + 1) * PAGE_SIZE);  // size of a log buffer in byte
+static constexpr int64_t LOG_SEGMENT_SIZE = 16 * 1024 * 1024;                 // size of a segment file of the log
 static constexpr int BUCKET_SIZE = 50;                                        // size of extendible hash bucket
+static constexpr int LRUK_REPLACER_K = 2;                                     // lookback window of the LRU-K replacer
+static constexpr int BULK_RING_SIZE = 32;                                     // ring frames per instance for bulk ops
+static constexpr size_t CACHE_LINE_SIZE = 64;                                 // padding for contended atomics
+static constexpr size_t L2_CACHE_SIZE = 1024 * 1024;                          // size of a core's L2 cache in byte
+static constexpr size_t HUGE_PAGE_SIZE = 2 * 1024 * 1024;                     // size of an OS huge page in byte
+static constexpr size_t IO_QUEUE_DEPTH = 32;                                  // page I/Os in flight per disk manager
+static constexpr int TABLE_HEAP_EXTENT_SIZE = 64;                             // pages a table heap allocates at once
+static constexpr size_t QUERY_MEMORY_BUDGET = 64 * 1024 * 1024;               // bytes an operator holds before spilling
+
+static_assert(PAGE_SIZE >= 4096 && PAGE_SIZE <= 65536 && (PAGE_SIZE & (PAGE_SIZE - 1)) == 0,
+              "the page size must be a power of two between 4KB and 64KB");
 
-using frame_id_t = int32_t;    // frame id type
-using page_id_t = int32_t;     // page id type
-using txn_id_t = int32_t;      // transaction id type
-using lsn_t = int32_t;         // log sequence number type
-using slot_offset_t = size_t;  // slot offset type
+using frame_id_t = int32_t;       // frame id type
+using page_id_t = int32_t;        // page id type
+using tablespace_id_t = int32_t;  // tablespace id type
+using txn_id_t = int32_t;         // transaction id type
+using lsn_t = int32_t;            // log sequence number type
+using timestamp_t = int64_t;      // commit timestamp type
+using slot_offset_t = size_t;     // slot offset type
 using oid_t = uint16_t;
 
 }  // namespace bustub
@@ -0,0 +1,136 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// contention.h
+//
+// Identification: src/include/common/contention.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>  // NOLINT
+#include <cstdint>
+#include <mutex>  // NOLINT
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace bustub {
+
+/** What the waits at one lock site came to, as ContentionProfiler reports them. */
+struct ContentionStats {
+  std::string name_;
+  /** The acquires that had to wait, and how long they waited in all and at most. */
+  uint64_t waits_{0};
+  uint64_t wait_ns_{0};
+  uint64_t max_wait_ns_{0};
+
+  /** @return the mean wait of the acquires that waited, 0 if none did */
+  double MeanWaitNs() const { return waits_ == 0 ? 0 : static_cast<double>(wait_ns_) / static_cast<double>(waits_); }
+};
+
+/**
+ * ContentionSite counts the waits at one kind of latch or lock, e.g. the latches of the buffer pool instances or the
+ * queues of the row locks, over all the objects that have one. Only an acquire that finds the latch held reads the
+ * clock and counts, so a latch nobody contends for costs what it did; the counters are plain atomics, which only the
+ * threads that waited anyway touch.
+ */
+class ContentionSite {
+ public:
+  explicit ContentionSite(std::string name) : name_(std::move(name)) {}
+
+  /** Counts an acquire that waited for as long as wait. */
+  void RecordWait(std::chrono::nanoseconds wait) {
+    auto ns = static_cast<uint64_t>(std::max<int64_t>(wait.count(), 0));
+    waits_.fetch_add(1, std::memory_order_relaxed);
+    wait_ns_.fetch_add(ns, std::memory_order_relaxed);
+    uint64_t max = max_wait_ns_.load(std::memory_order_relaxed);
+    while (ns > max && !max_wait_ns_.compare_exchange_weak(max, ns, std::memory_order_relaxed)) {
+    }
+  }
+
+  /**
+   * Locks a lock, e.g. a std::unique_lock, counting the time it waited if the latch was held.
+   * @param lock the lock to acquire, which must not be held
+   */
+  template <typename LockType>
+  void Lock(LockType *lock) {
+    if (lock->try_lock()) {
+      return;
+    }
+    auto start = std::chrono::steady_clock::now();
+    lock->lock();
+    RecordWait(std::chrono::steady_clock::now() - start);
+  }
+
+  /** @return a lock on a mutex, acquired as Lock does */
+  std::unique_lock<std::mutex> Acquire(std::mutex *mutex) {
+    std::unique_lock lock{*mutex, std::defer_lock};
+    Lock(&lock);
+    return lock;
+  }
+
+  /** @return the waits counted so far */
+  ContentionStats GetStats() const {
+    return {name_, waits_.load(std::memory_order_relaxed), wait_ns_.load(std::memory_order_relaxed),
+            max_wait_ns_.load(std::memory_order_relaxed)};
+  }
+
+  /** Forgets the waits counted so far. */
+  void Reset() {
+    waits_.store(0, std::memory_order_relaxed);
+    wait_ns_.store(0, std::memory_order_relaxed);
+    max_wait_ns_.store(0, std::memory_order_relaxed);
+  }
+
+ private:
+  const std::string name_;
+  std::atomic<uint64_t> waits_{0};
+  std::atomic<uint64_t> wait_ns_{0};
+  std::atomic<uint64_t> max_wait_ns_{0};
+};
+
+/**
+ * ContentionProfiler keeps the lock sites of the process by name, so that the waits at a kind of latch add up over
+ * all its objects and all the instances of the system, and reports which sites cost the most waiting: the latch to
+ * break up next. A site is created the first time its name is asked for and lives as long as the process.
+ *
+ * The sites of the system are:
+ * - buffer_pool.latch, the latch of a buffer pool instance
+ * - page.latch, the reader-writer latch of a page in the buffer pool
+ * - lock_manager.shard_latch and lock_manager.graph_latch, the latches of the lock table's shards and of its
+ *   waits-for graph
+ * - lock.row, lock.table and lock.key_range, the waits in the request queues of the lock manager for a lock to be
+ *   granted; LockManager::GetHotRids reports the rows waited for the most
+ * - log_manager.latch and log_manager.persistent_latch, the latch of the log flushes and the one of the waits for
+ *   the persistent LSN
+ * - b_plus_tree.root_latch, hash_table.table_latch, transaction_manager.global_txn_latch and rwlatch, the
+ *   reader-writer latches of the indexes, of checkpoints and of everything else
+ */
+class ContentionProfiler {
+ public:
+  /** @return the site of a name, which is created if there is none */
+  static ContentionSite *Site(const std::string &name);
+
+  /** @return the stats of the sites that waited at all, the longest waited first */
+  static std::vector<ContentionStats> Report();
+
+  /** Forgets the waits of all sites, e.g. the ones of loading data before a run. */
+  static void Reset();
+
+  /**
+   * Writes a line of the waits, the wait time and the mean and longest wait of each site of Report.
+   * @param out the stream to write to
+   * @param limit the most sites to write
+   */
+  static void Dump(std::ostream *out, size_t limit = SIZE_MAX);
+};
+
+}  // namespace bustub
@@ -47,6 +47,8 @@ enum class ExceptionType {
   OUT_OF_MEMORY = 9,
   /** Method not implemented. */
   NOT_IMPLEMENTED = 11,
+  /** The query was cancelled. */
+  CANCELLED = 12,
 };
 
 class Exception : public std::runtime_error {
@@ -63,6 +65,9 @@ class Exception : public std::runtime_error {
     std::cerr << exception_message;
   }
 
+  /** @return the type of the exception */
+  ExceptionType GetType() const { return type_; }
+
   std::string ExpectionTypeToString(ExceptionType type) {
     switch (type) {
       case ExceptionType::INVALID:
@@ -85,6 +90,8 @@ class Exception : public std::runtime_error {
         return "Out of Memory";
       case ExceptionType::NOT_IMPLEMENTED:
         return "Not implemented";
+      case ExceptionType::CANCELLED:
+        return "Cancelled";
       default:
         return "Unknown";
     }
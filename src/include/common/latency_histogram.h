@@ -0,0 +1,141 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// latency_histogram.h
+//
+// Identification: src/include/common/latency_histogram.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>  // NOLINT
+#include <cstdint>
+#include <functional>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "common/config.h"
+
+namespace bustub {
+
+/**
+ * A point-in-time copy of a LatencyHistogram. The buckets are log-linear, as in an HDR histogram: the values below
+ * SUB_BUCKETS nanoseconds have a bucket each, and every power of two above that is split into SUB_BUCKETS buckets, so
+ * that a value is known to within 1/SUB_BUCKETS of itself up to MAX_LATENCY_NS, which the longer ones are counted at.
+ */
+struct LatencySnapshot {
+  static constexpr uint32_t SUB_BUCKET_BITS = 4;
+  static constexpr uint64_t SUB_BUCKETS = uint64_t{1} << SUB_BUCKET_BITS;
+  /** The powers of two the buckets go up to; 2^40 ns is over 18 minutes. */
+  static constexpr uint32_t MAX_MAGNITUDE = 40;
+  static constexpr uint64_t MAX_LATENCY_NS = (uint64_t{1} << MAX_MAGNITUDE) - 1;
+  static constexpr size_t NUM_BUCKETS = SUB_BUCKETS * (MAX_MAGNITUDE - SUB_BUCKET_BITS + 1);
+
+  /** @return the bucket a latency is counted in */
+  static size_t BucketOf(uint64_t ns);
+
+  /** @return the highest latency that is counted in a bucket */
+  static uint64_t BucketUpperBound(size_t bucket);
+
+  /** The number of latencies recorded in each bucket. */
+  std::vector<uint64_t> counts_ = std::vector<uint64_t>(NUM_BUCKETS, 0);
+  /** The number of latencies recorded, their sum, and the lowest and the highest of them. */
+  uint64_t count_{0};
+  uint64_t sum_ns_{0};
+  uint64_t min_ns_{UINT64_MAX};
+  uint64_t max_ns_{0};
+
+  /** @return the mean latency, 0 if none was recorded */
+  double MeanNs() const { return count_ == 0 ? 0 : static_cast<double>(sum_ns_) / static_cast<double>(count_); }
+
+  /**
+   * @param percentile between 0 and 100
+   * @return the latency that percentile of the recorded ones are at or below, to within the precision of a bucket;
+   * 0 if none was recorded
+   */
+  uint64_t PercentileNs(double percentile) const;
+
+  LatencySnapshot &operator+=(const LatencySnapshot &other);
+};
+
+/**
+ * LatencyHistogram records the latencies of one kind of operation. Like BufferPoolCounters, the buckets are striped
+ * over NUM_STRIPES copies, and every thread records into the stripe its id hashes to, so that threads recording at
+ * once rarely share a cache line; Snapshot merges the stripes. Recording takes a few relaxed atomic adds, and no lock.
+ */
+class LatencyHistogram {
+ public:
+  /** Records one latency; negative ones count as 0 and the ones past MAX_LATENCY_NS as that */
+  void Record(std::chrono::nanoseconds latency);
+
+  /** @return the merge of all stripes; it is not a consistent cut against the records that go on meanwhile */
+  LatencySnapshot Snapshot() const;
+
+ private:
+  static constexpr size_t NUM_STRIPES = 8;
+
+  struct alignas(CACHE_LINE_SIZE) Stripe {
+    std::array<std::atomic<uint64_t>, LatencySnapshot::NUM_BUCKETS> counts_{};
+    std::atomic<uint64_t> sum_ns_{0};
+    std::atomic<uint64_t> min_ns_{UINT64_MAX};
+    std::atomic<uint64_t> max_ns_{0};
+  };
+
+  /** @return the stripe of the calling thread */
+  Stripe &Local();
+
+  std::array<Stripe, NUM_STRIPES> stripes_;
+};
+
+/**
+ * ScopedLatency records the time from its construction to its destruction into a histogram.
+ */
+class ScopedLatency {
+ public:
+  explicit ScopedLatency(LatencyHistogram *histogram)
+      : histogram_(histogram), start_(std::chrono::steady_clock::now()) {}
+
+  ~ScopedLatency() { histogram_->Record(std::chrono::steady_clock::now() - start_); }
+
+  ScopedLatency(const ScopedLatency &) = delete;
+  ScopedLatency &operator=(const ScopedLatency &) = delete;
+
+ private:
+  LatencyHistogram *histogram_;
+  std::chrono::steady_clock::time_point start_;
+};
+
+/**
+ * LatencyRegistry names the latency histograms of the components of an instance. A source is asked for its snapshot
+ * only when the registry is read, so that a component of several parts, like a parallel buffer pool, merges the
+ * histograms of its parts then.
+ */
+class LatencyRegistry {
+ public:
+  using Source = std::function<LatencySnapshot()>;
+
+  /** Adds a source under a name; the source must stay valid for as long as the registry is read. */
+  void Register(const std::string &name, Source source) { sources_.emplace_back(name, std::move(source)); }
+
+  /** @return the snapshots of the sources, in the order they were registered in */
+  std::vector<std::pair<std::string, LatencySnapshot>> Snapshot() const;
+
+  /**
+   * Writes a line per source: the number of latencies, their mean, p50, p99, p99.9 and maximum, in microseconds.
+   * @param out the stream to write to
+   */
+  void Dump(std::ostream *out) const;
+
+ private:
+  std::vector<std::pair<std::string, Source>> sources_;
+};
+
+}  // namespace bustub
@@ -0,0 +1,63 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// memory_arena.h
+//
+// Identification: src/include/common/memory_arena.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+#include "common/macros.h"
+#include "common/memory_tracker.h"
+
+namespace bustub {
+
+/**
+ * MemoryArena hands out memory for objects that all die at the same time, e.g. the tuples and VARCHAR payloads of a
+ * query. Allocation bumps a pointer through blocks of BLOCK_SIZE bytes, and nothing is freed on its own: Reset and
+ * the destructor release everything at once. An arena is meant for a single thread and does no locking. Its blocks are
+ * accounted for as QUERY_ARENA memory in a MemoryTracker.
+ */
+class MemoryArena {
+ public:
+  static constexpr size_t BLOCK_SIZE = 64 * 1024;
+
+  /** @param tracker the tracker the blocks of the arena are accounted for in, e.g. the one of its query */
+  explicit MemoryArena(MemoryTracker *tracker = MemoryTracker::Global()) : tracker_(tracker) {}
+
+  DISALLOW_COPY_AND_MOVE(MemoryArena);
+
+  ~MemoryArena() { tracker_->Free(MemoryCategory::QUERY_ARENA, capacity_); }
+
+  /**
+   * @param size the number of bytes to allocate
+   * @param alignment the alignment of the memory, a power of two
+   * @return size bytes, valid until the arena is reset or destroyed
+   */
+  char *Allocate(size_t size, size_t alignment = alignof(std::max_align_t));
+
+  /** Releases everything allocated so far, keeping the first block for what comes next. */
+  void Reset();
+
+  /** @return the number of bytes of the blocks the arena holds */
+  size_t GetCapacity() const { return capacity_; }
+
+ private:
+  MemoryTracker *tracker_;
+  // the blocks in the order they were allocated; allocations go into the last one
+  std::vector<std::unique_ptr<char[]>> blocks_;
+  char *next_{nullptr};
+  char *end_{nullptr};
+  size_t capacity_{0};
+};
+
+}  // namespace bustub
@@ -0,0 +1,162 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// memory_tracker.h
+//
+// Identification: src/include/common/memory_tracker.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <ostream>
+#include <vector>
+
+#include "common/macros.h"
+
+namespace bustub {
+
+/** The subsystems whose memory a MemoryTracker accounts for apart. */
+enum class MemoryCategory : uint8_t {
+  /** The frames of the buffer pools and the metadata of their pages */
+  BUFFER_POOL,
+  /** The request queues and requests of the lock tables */
+  LOCK_TABLE,
+  /** The hash tables of the aggregations and the sets of DISTINCT, as their MemoryReservations hold them */
+  AGGREGATION,
+  /** The hash tables of the left sides of the hash joins, as their MemoryReservations hold them */
+  HASH_JOIN,
+  /** The tuples of the sorts, as their MemoryReservations hold them */
+  SORT,
+  /** The blocks of the MemoryArenas of the queries */
+  QUERY_ARENA,
+  /** The data of the Tuples that own a copy of it */
+  TUPLES,
+  /** The tables, indexes and schemas of the catalogs */
+  CATALOG,
+  /** What the MemoryReservations of any other operators hold */
+  OTHER,
+};
+
+constexpr size_t NUM_MEMORY_CATEGORIES = static_cast<size_t>(MemoryCategory::OTHER) + 1;
+
+/** @return the name of a category, as reports show it */
+const char *MemoryCategoryName(MemoryCategory category);
+
+/** The memory of one category, as MemoryTracker::Report has it. */
+struct MemoryUsage {
+  MemoryCategory category_;
+  /** The bytes held now, and the most held at once */
+  size_t current_;
+  size_t peak_;
+};
+
+/**
+ * MemoryTracker accounts for the bytes a part of the system holds, by category, now and at their peak. The global
+ * tracker, Global, has the memory of the whole process; a query's tracker (ExecutorContext::GetMemoryTracker) has
+ * the memory of the query's operators and arena, and passes it on to the global one, its parent, as well.
+ *
+ * Allocate and Free are exact, and cost an atomic update of the tracker and its parent each; they are for blocks,
+ * frames and grants, which are large and few. Allocations that are small and many, as the copies of tuples and the
+ * nodes of the lock table are, go through AllocateLocal and FreeLocal instead, which add up in a counter of the
+ * calling thread, and only pass it on to the global tracker once it reaches LOCAL_BATCH bytes either way; the global
+ * counts are then off by less than LOCAL_BATCH per thread and category, and a peak may be missed by as much.
+ */
+class MemoryTracker {
+ public:
+  /** The bytes a thread accounts for by itself before AllocateLocal and FreeLocal pass them on */
+  static constexpr int64_t LOCAL_BATCH = 64 * 1024;
+
+  /** @param parent the tracker that what this one accounts for is passed on to, nullptr if none */
+  explicit MemoryTracker(MemoryTracker *parent = nullptr) : parent_(parent) {}
+
+  DISALLOW_COPY_AND_MOVE(MemoryTracker);
+
+  /** @return the tracker of the memory of the whole process */
+  static MemoryTracker *Global();
+
+  /** Accounts for bytes allocated in a category, here and in the parent. */
+  void Allocate(MemoryCategory category, size_t bytes);
+
+  /** Accounts for bytes of a category being freed, here and in the parent. */
+  void Free(MemoryCategory category, size_t bytes);
+
+  /** Accounts for a small allocation in the global tracker, in a batch of the calling thread. */
+  static void AllocateLocal(MemoryCategory category, size_t bytes);
+
+  /** Accounts for a small allocation being freed in the global tracker, in a batch of the calling thread. */
+  static void FreeLocal(MemoryCategory category, size_t bytes);
+
+  /** @return the bytes of a category held now */
+  size_t GetCurrent(MemoryCategory category) const;
+
+  /** @return the most bytes of a category held at once */
+  size_t GetPeak(MemoryCategory category) const;
+
+  /** @return the bytes of all categories held now */
+  size_t GetTotal() const;
+
+  /** @return the most bytes of all categories held at once */
+  size_t GetPeakTotal() const;
+
+  /** @return the memory of the categories that held any, the most held now first */
+  std::vector<MemoryUsage> Report() const;
+
+  /** Writes a line of the current and peak MiB of each category of Report, and of the total. */
+  void Dump(std::ostream *out) const;
+
+ private:
+  /** Adds a signed number of bytes to a category and the total, and to those of the parent */
+  void Add(MemoryCategory category, int64_t bytes);
+
+  MemoryTracker *const parent_;
+  /** The counts go below zero for a while when one thread frees what another allocated, before it passed it on */
+  std::array<std::atomic<int64_t>, NUM_MEMORY_CATEGORIES> current_{};
+  std::array<std::atomic<int64_t>, NUM_MEMORY_CATEGORIES> peak_{};
+  std::atomic<int64_t> total_{0};
+  std::atomic<int64_t> peak_total_{0};
+};
+
+/**
+ * TrackedAllocator is a std::allocator whose allocations are accounted for in a category of the global
+ * MemoryTracker, with AllocateLocal and FreeLocal, for the nodes of containers. It has no state, so that all of a
+ * category are equal, and nodes may be spliced from one container to another.
+ */
+template <typename T, MemoryCategory category>
+class TrackedAllocator {
+ public:
+  using value_type = T;
+
+  template <typename U>
+  struct rebind {
+    using other = TrackedAllocator<U, category>;
+  };
+
+  TrackedAllocator() = default;
+
+  template <typename U>
+  TrackedAllocator(const TrackedAllocator<U, category> & /* other */) {}  // NOLINT
+
+  T *allocate(size_t n) {
+    MemoryTracker::AllocateLocal(category, n * sizeof(T));
+    return std::allocator<T>{}.allocate(n);
+  }
+
+  void deallocate(T *p, size_t n) {
+    MemoryTracker::FreeLocal(category, n * sizeof(T));
+    std::allocator<T>{}.deallocate(p, n);
+  }
+
+  friend bool operator==(const TrackedAllocator & /* a */, const TrackedAllocator & /* b */) { return true; }
+  friend bool operator!=(const TrackedAllocator & /* a */, const TrackedAllocator & /* b */) { return false; }
+};
+
+}  // namespace bustub
@@ -12,16 +12,20 @@
 
 #pragma once
 
+#include <chrono>  // NOLINT
 #include <climits>
 #include <condition_variable>  // NOLINT
 #include <mutex>               // NOLINT
+#include <string>
 
+#include "common/contention.h"
 #include "common/macros.h"
 
 namespace bustub {
 
 /**
- * Reader-Writer latch backed by std::mutex.
+ * Reader-Writer latch backed by std::mutex. The time an acquire waits for the latch is counted at the ContentionSite
+ * of the latch, by the kind of object it is of.
  */
 class ReaderWriterLatch {
   using mutex_t = std::mutex;
@@ -29,7 +33,8 @@ class ReaderWriterLatch {
   static const uint32_t MAX_READERS = UINT_MAX;
 
  public:
-  ReaderWriterLatch() = default;
+  /** @param site the name of the ContentionSite that the waits for the latch are counted at */
+  explicit ReaderWriterLatch(const std::string &site = "rwlatch") : site_(ContentionProfiler::Site(site)) {}
   ~ReaderWriterLatch() { std::lock_guard<mutex_t> guard(mutex_); }
 
   DISALLOW_COPY(ReaderWriterLatch);
@@ -39,6 +44,11 @@ class ReaderWriterLatch {
    */
   void WLock() {
     std::unique_lock<mutex_t> latch(mutex_);
+    if (!writer_entered_ && reader_count_ == 0) {
+      writer_entered_ = true;
+      return;
+    }
+    auto start = std::chrono::steady_clock::now();
     while (writer_entered_) {
       reader_.wait(latch);
     }
@@ -46,6 +56,7 @@ class ReaderWriterLatch {
     while (reader_count_ > 0) {
       writer_.wait(latch);
     }
+    site_->RecordWait(std::chrono::steady_clock::now() - start);
   }
 
   /**
@@ -62,10 +73,27 @@ class ReaderWriterLatch {
    */
   void RLock() {
     std::unique_lock<mutex_t> latch(mutex_);
-    while (writer_entered_ || reader_count_ == MAX_READERS) {
-      reader_.wait(latch);
+    if (writer_entered_ || reader_count_ == MAX_READERS) {
+      auto start = std::chrono::steady_clock::now();
+      while (writer_entered_ || reader_count_ == MAX_READERS) {
+        reader_.wait(latch);
+      }
+      site_->RecordWait(std::chrono::steady_clock::now() - start);
+    }
+    reader_count_++;
+  }
+
+  /**
+   * Acquire a read latch if that does not mean waiting.
+   * @return true if the latch was acquired
+   */
+  bool TryRLock() {
+    std::lock_guard<mutex_t> guard(mutex_);
+    if (writer_entered_ || reader_count_ == MAX_READERS) {
+      return false;
     }
     reader_count_++;
+    return true;
   }
 
   /**
@@ -86,6 +114,7 @@ class ReaderWriterLatch {
   }
 
  private:
+  ContentionSite *site_;
   mutex_t mutex_;
   cond_t writer_;
   cond_t reader_;
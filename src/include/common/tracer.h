@@ -0,0 +1,132 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// tracer.h
+//
+// Identification: src/include/common/tracer.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <atomic>
+#include <chrono>  // NOLINT
+#include <cstdint>
+#include <ostream>
+#include <vector>
+
+namespace bustub {
+
+/** One span of a trace: a named stretch of time on one thread. */
+struct TraceEvent {
+  /** What the span is of, and the group it is in; both are string literals, which the events point at. */
+  const char *name_;
+  const char *category_;
+  /** The thread the span was on, numbered from 1 in the order the threads first traced anything. */
+  uint32_t thread_;
+  /** When the span started, from the start of the process, and how long it took. */
+  uint64_t start_ns_;
+  uint64_t duration_ns_;
+  /** A number the span is about, e.g. the page of a miss, under a name that is a string literal; nullptr if none. */
+  const char *arg_name_;
+  int64_t arg_;
+};
+
+/**
+ * Tracer keeps the spans of what the threads of the process spend their time on: the Init and NextBatch calls of
+ * the executors, buffer pool misses, disk reads and writes, lock waits, log flushes and commits. Every thread records
+ * into a ring of its own, which keeps the last events_per_thread spans and drops the older ones; ExportChromeTrace
+ * writes the spans of all threads as one timeline, in the Chrome trace event format that chrome://tracing and
+ * Perfetto load, which shows where one thread stalled on another.
+ *
+ * Tracing is off until Enable, and a span costs a relaxed load of a flag then. A thread takes the latch of its own
+ * ring as it records, which only an export contends for. A thread that exits hands its ring, with its spans, to the
+ * next thread that starts tracing.
+ */
+class Tracer {
+ public:
+  static constexpr size_t DEFAULT_EVENTS_PER_THREAD = 16384;
+
+  /**
+   * Starts recording spans.
+   * @param events_per_thread the spans each thread keeps; a ring of another size is emptied
+   */
+  static void Enable(size_t events_per_thread = DEFAULT_EVENTS_PER_THREAD);
+
+  /** Stops recording spans; the ones recorded stay until Clear. */
+  static void Disable();
+
+  /** @return whether spans are being recorded */
+  static bool IsEnabled() { return enabled.load(std::memory_order_relaxed); }
+
+  /** Drops the spans recorded so far. */
+  static void Clear();
+
+  /**
+   * Records a span of the calling thread, if tracing is enabled.
+   * @param name what the span is of, a string literal
+   * @param category the group of the span, a string literal
+   * @param start when the span started
+   * @param end when it ended
+   * @param arg_name the name of a number the span is about, a string literal; nullptr if there is none
+   * @param arg the number
+   */
+  static void AddSpan(const char *name, const char *category, std::chrono::steady_clock::time_point start,
+                      std::chrono::steady_clock::time_point end, const char *arg_name = nullptr, int64_t arg = 0);
+
+  /** @return the spans of all threads that are still in their rings, by the time they started */
+  static std::vector<TraceEvent> GetEvents();
+
+  /**
+   * Writes the spans as a Chrome trace: a JSON object whose traceEvents are complete ("X") events, in microseconds.
+   * @param out the stream to write to
+   */
+  static void ExportChromeTrace(std::ostream *out);
+
+ private:
+  static std::atomic<bool> enabled;
+};
+
+/**
+ * TraceSpan records the span from its construction to its destruction, if tracing was enabled as it was constructed.
+ */
+class TraceSpan {
+ public:
+  /**
+   * @param name what the span is of, a string literal
+   * @param category the group of the span, a string literal
+   */
+  TraceSpan(const char *name, const char *category) : name_(name), category_(category), enabled_(Tracer::IsEnabled()) {
+    if (enabled_) {
+      start_ = std::chrono::steady_clock::now();
+    }
+  }
+
+  ~TraceSpan() {
+    if (enabled_) {
+      Tracer::AddSpan(name_, category_, start_, std::chrono::steady_clock::now(), arg_name_, arg_);
+    }
+  }
+
+  TraceSpan(const TraceSpan &) = delete;
+  TraceSpan &operator=(const TraceSpan &) = delete;
+
+  /** Sets the number the span is about, which may be known only as it ends; arg_name is a string literal */
+  void SetArg(const char *arg_name, int64_t arg) {
+    arg_name_ = arg_name;
+    arg_ = arg;
+  }
+
+ private:
+  const char *name_;
+  const char *category_;
+  bool enabled_;
+  std::chrono::steady_clock::time_point start_;
+  const char *arg_name_{nullptr};
+  int64_t arg_{0};
+};
+
+}  // namespace bustub
@@ -0,0 +1,88 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// bloom_filter.h
+//
+// Identification: src/include/common/util/bloom_filter.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+#include "common/config.h"
+#include "common/util/hash_util.h"
+
+namespace bustub {
+
+/**
+ * BloomFilter is a split block Bloom filter of hashes: a hash sets a bit in each of the eight 64-bit words of a single
+ * cache line, picked by its top bits, so that an insert or a lookup touches one cache line, and compares its eight
+ * words at once. At BITS_PER_KEY bits per key, well under 1% of the hashes that were not inserted pass it.
+ */
+class BloomFilter {
+ public:
+  static constexpr size_t BITS_PER_KEY = 12;
+
+  /** @param num_keys the number of hashes that are to be inserted */
+  explicit BloomFilter(size_t num_keys)
+      : blocks_(std::max<size_t>(1, (num_keys * BITS_PER_KEY + BITS_PER_BLOCK - 1) / BITS_PER_BLOCK)) {}
+
+  void Insert(hash_t hash) {
+    hash = Mix(hash);
+    Block &block = blocks_[BlockOf(hash)];
+    for (size_t i = 0; i < WORDS_PER_BLOCK; i++) {
+      block.words_[i] |= BitOf(hash, i);
+    }
+  }
+
+  /** @return false if the hash was not inserted; true if it was, or, rarely, if it was not */
+  bool MayContain(hash_t hash) const {
+    hash = Mix(hash);
+    const Block &block = blocks_[BlockOf(hash)];
+    bool contains = true;
+    for (size_t i = 0; i < WORDS_PER_BLOCK; i++) {
+      contains &= (block.words_[i] & BitOf(hash, i)) != 0;
+    }
+    return contains;
+  }
+
+  /** @return the size of the filter in bytes */
+  size_t GetByteSize() const { return blocks_.size() * sizeof(Block); }
+
+ private:
+  static constexpr size_t WORDS_PER_BLOCK = 8;
+  static constexpr size_t BITS_PER_BLOCK = WORDS_PER_BLOCK * 64;
+  static_assert(BITS_PER_BLOCK == CACHE_LINE_SIZE * 8, "a block is a cache line");
+
+  struct alignas(CACHE_LINE_SIZE) Block {
+    uint64_t words_[WORDS_PER_BLOCK]{};
+  };
+
+  /** the finalizer of MurmurHash3, since the hashes of small integers are all in their low bits */
+  static hash_t Mix(hash_t hash) {
+    hash = (hash ^ (hash >> 33)) * 0xff51afd7ed558ccdULL;
+    hash = (hash ^ (hash >> 33)) * 0xc4ceb9fe1a85ec53ULL;
+    return hash ^ (hash >> 33);
+  }
+
+  /** @return the block of the top 32 bits of the hash, scaled to the number of blocks without a division */
+  size_t BlockOf(hash_t hash) const { return ((hash >> 32) * blocks_.size()) >> 32; }
+
+  /** @return the bit of a word that the low 32 bits of the hash set, by an odd multiplier of the word */
+  static uint64_t BitOf(hash_t hash, size_t word) {
+    static constexpr uint32_t SALTS[WORDS_PER_BLOCK] = {0x47b6137bU, 0x44974d91U, 0x8824ad5bU, 0xa2b7289dU,
+                                                        0x705495c7U, 0x2df1424bU, 0x9efc4947U, 0x5c6bfb31U};
+    return uint64_t{1} << ((static_cast<uint32_t>(hash) * SALTS[word]) >> 26);
+  }
+
+  std::vector<Block> blocks_;
+};
+
+}  // namespace bustub
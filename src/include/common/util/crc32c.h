@@ -0,0 +1,38 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// crc32c.h
+//
+// Identification: src/include/common/util/crc32c.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace bustub {
+
+/**
+ * CRC-32C (Castagnoli), the checksum that SSE4.2 computes in hardware. CPUs without SSE4.2 get a table-driven
+ * implementation, picked once at start-up.
+ */
+class Crc32c {
+ public:
+  /**
+   * @param data the bytes to checksum
+   * @param length the number of bytes
+   * @param crc the checksum of the bytes before, to checksum data in pieces
+   * @return the checksum of the bytes
+   */
+  static uint32_t Compute(const char *data, size_t length, uint32_t crc = 0);
+
+  /** @return true if Compute uses the SSE4.2 crc32 instruction */
+  static bool IsHardwareAccelerated();
+};
+
+}  // namespace bustub
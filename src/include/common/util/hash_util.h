@@ -13,7 +13,9 @@
 #pragma once
 
 #include <algorithm>
+#include <cstdint>
 #include <cstdlib>
+#include <cstring>
 #include <iostream>
 #include <string>
 
@@ -24,26 +26,69 @@ namespace bustub {
 
 using hash_t = std::size_t;
 
+/**
+ * HashUtil hashes bytes a word at a time: every 8 bytes are mixed into the hash with a multiplication, and the result
+ * is finished with the finalizer of MurmurHash3, which spreads every bit of the input over the whole hash. Inputs of
+ * 32 bytes and more are mixed in four independent lanes, so that the multiplications of a long string overlap.
+ */
 class HashUtil {
  private:
   static const hash_t prime_factor = 10000019;
 
+  /** @return the 8 bytes at bytes, in any alignment */
+  static inline uint64_t LoadWord(const char *bytes) {
+    uint64_t word;
+    std::memcpy(&word, bytes, sizeof(word));
+    return word;
+  }
+
  public:
+  /** The odd multiplier MixWord mixes words with, 2^64 over the golden ratio */
+  static constexpr hash_t HASH_MULTIPLIER = 0x9e3779b97f4a7c15ULL;
+  /** The hash of a null value, of any type */
+  static constexpr hash_t NULL_HASH = 0x5bd1e9955bd1e995ULL;
+
+  /** @return a running hash with a word mixed into it; Finish makes a hash of it */
+  static inline hash_t MixWord(hash_t hash, uint64_t word) {
+    hash = (hash ^ word) * HASH_MULTIPLIER;
+    return hash ^ (hash >> 29);
+  }
+
+  /** @return the hash of a running hash, through the finalizer of MurmurHash3 */
+  static inline hash_t Finish(hash_t hash) {
+    hash = (hash ^ (hash >> 33)) * 0xff51afd7ed558ccdULL;
+    hash = (hash ^ (hash >> 33)) * 0xc4ceb9fe1a85ec53ULL;
+    return hash ^ (hash >> 33);
+  }
+
+  /** @return the hash of a word, the same as that of its 8 bytes */
+  static inline hash_t HashWord(uint64_t word) { return Finish(MixWord(sizeof(uint64_t), word)); }
+
   static inline hash_t HashBytes(const char *bytes, size_t length) {
-    // https://github.com/greenplum-db/gpos/blob/b53c1acd6285de94044ff91fbee91589543feba1/libgpos/src/utils.cpp#L126
     hash_t hash = length;
-    for (size_t i = 0; i < length; ++i) {
-      hash = ((hash << 5) ^ (hash >> 27)) ^ bytes[i];
+    size_t i = 0;
+    if (length >= 4 * sizeof(uint64_t)) {
+      hash_t lanes[4] = {hash, hash ^ HASH_MULTIPLIER, hash + HASH_MULTIPLIER, ~hash};
+      for (; i + 4 * sizeof(uint64_t) <= length; i += 4 * sizeof(uint64_t)) {
+        for (size_t lane = 0; lane < 4; ++lane) {
+          lanes[lane] = MixWord(lanes[lane], LoadWord(bytes + i + lane * sizeof(uint64_t)));
+        }
+      }
+      hash = MixWord(MixWord(MixWord(lanes[0], lanes[1]), lanes[2]), lanes[3]);
+    }
+    for (; i + sizeof(uint64_t) <= length; i += sizeof(uint64_t)) {
+      hash = MixWord(hash, LoadWord(bytes + i));
     }
-    return hash;
+    if (i < length) {
+      uint64_t tail = 0;
+      std::memcpy(&tail, bytes + i, length - i);
+      hash = MixWord(hash, tail);
+    }
+    return Finish(hash);
   }
 
-  static inline hash_t CombineHashes(hash_t l, hash_t r) {
-    hash_t both[2];
-    both[0] = l;
-    both[1] = r;
-    return HashBytes(reinterpret_cast<char *>(both), sizeof(hash_t) * 2);
-  }
+  /** @return a hash of two hashes, which depends on their order */
+  static inline hash_t CombineHashes(hash_t l, hash_t r) { return Finish((l * HASH_MULTIPLIER) ^ r); }
 
   static inline hash_t SumHashes(hash_t l, hash_t r) { return (l % prime_factor + r % prime_factor) % prime_factor; }
 
@@ -57,32 +102,35 @@ class HashUtil {
     return HashBytes(reinterpret_cast<const char *>(&ptr), sizeof(void *));
   }
 
-  /** @return the hash of the value */
+  /**
+   * @return the hash of the value; the integer types hash alike, as the same int64_t, and a null value of any type
+   * hashes to NULL_HASH
+   */
   static inline hash_t HashValue(const Value *val) {
+    if (val->IsNull()) {
+      return NULL_HASH;
+    }
     switch (val->GetTypeId()) {
       case TypeId::TINYINT: {
-        auto raw = static_cast<int64_t>(val->GetAs<int8_t>());
-        return Hash<int64_t>(&raw);
+        return HashWord(static_cast<int64_t>(val->GetAs<int8_t>()));
       }
       case TypeId::SMALLINT: {
-        auto raw = static_cast<int64_t>(val->GetAs<int16_t>());
-        return Hash<int64_t>(&raw);
+        return HashWord(static_cast<int64_t>(val->GetAs<int16_t>()));
       }
       case TypeId::INTEGER: {
-        auto raw = static_cast<int64_t>(val->GetAs<int32_t>());
-        return Hash<int64_t>(&raw);
+        return HashWord(static_cast<int64_t>(val->GetAs<int32_t>()));
       }
       case TypeId::BIGINT: {
-        auto raw = static_cast<int64_t>(val->GetAs<int64_t>());
-        return Hash<int64_t>(&raw);
+        return HashWord(val->GetAs<int64_t>());
       }
       case TypeId::BOOLEAN: {
-        auto raw = val->GetAs<bool>();
-        return Hash<bool>(&raw);
+        return HashWord(static_cast<int64_t>(val->GetAs<int8_t>()));
       }
       case TypeId::DECIMAL: {
         auto raw = val->GetAs<double>();
-        return Hash<double>(&raw);
+        uint64_t bits;
+        std::memcpy(&bits, &raw, sizeof(bits));
+        return HashWord(bits);
       }
       case TypeId::VARCHAR: {
         auto raw = val->GetData();
@@ -90,8 +138,7 @@ class HashUtil {
         return HashBytes(raw, len);
       }
       case TypeId::TIMESTAMP: {
-        auto raw = val->GetAs<uint64_t>();
-        return Hash<uint64_t>(&raw);
+        return HashWord(val->GetAs<uint64_t>());
       }
       default: {
         BUSTUB_ASSERT(false, "Unsupported type.");
@@ -0,0 +1,116 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// morsel_queue.h
+//
+// Identification: src/include/common/util/morsel_queue.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "common/macros.h"
+
+namespace bustub {
+
+/**
+ * MorselQueue hands out the indexes 0, ..., num_morsels - 1 of the morsels of a pipeline to its workers, each once.
+ * Every worker starts out with a range of consecutive morsels of its own, which it takes from the front of, so that
+ * it reads its part of a table sequentially. A worker whose range is empty steals from the back of the others', one
+ * morsel at a time, which keeps the workers busy until the last morsel even when some of them are slower. It steals
+ * from the workers after it first, which are those of its own NUMA node while the workers are numbered node by node.
+ *
+ * A range is a single atomic word, of its next morsel in the high 32 bits and its end in the low ones, so that a take
+ * from its front and a steal from its back race on one compare-and-swap; neither ever blocks.
+ */
+class MorselQueue {
+ public:
+  /**
+   * @param num_morsels the number of morsels, below 2^32
+   * @param num_workers the number of workers, which the morsels are split between evenly
+   */
+  MorselQueue(size_t num_morsels, size_t num_workers) : ranges_(num_workers) {
+    BUSTUB_ASSERT(num_workers > 0, "a queue has to have workers");
+    for (size_t i = 0; i < num_workers; i++) {
+      ranges_[i].store(Pack(i * num_morsels / num_workers, (i + 1) * num_morsels / num_workers));
+    }
+  }
+
+  /**
+   * @param ranges the morsels each worker starts out with, [first, second) for worker i, which must not overlap,
+   * e.g. the morsels of the pages on the NUMA node of the worker
+   */
+  explicit MorselQueue(const std::vector<std::pair<size_t, size_t>> &ranges) : ranges_(ranges.size()) {
+    BUSTUB_ASSERT(!ranges.empty(), "a queue has to have workers");
+    for (size_t i = 0; i < ranges.size(); i++) {
+      ranges_[i].store(Pack(ranges[i].first, ranges[i].second));
+    }
+  }
+
+  DISALLOW_COPY_AND_MOVE(MorselQueue);
+
+  /**
+   * Claims the next morsel of a worker, stealing one if its own range is empty; safe to call from many threads.
+   * @param worker the worker, of the number of workers the queue was made for
+   * @param[out] morsel the index of the morsel
+   * @return false once every morsel has been claimed
+   */
+  bool Next(size_t worker, size_t *morsel) {
+    worker %= ranges_.size();
+    if (TakeFront(&ranges_[worker], morsel)) {
+      return true;
+    }
+    for (size_t i = 1; i < ranges_.size(); i++) {
+      if (TakeBack(&ranges_[(worker + i) % ranges_.size()], morsel)) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+ private:
+  static uint64_t Pack(uint64_t next, uint64_t end) { return next << 32 | end; }
+
+  static bool TakeFront(std::atomic<uint64_t> *range, size_t *morsel) {
+    uint64_t packed = range->load();
+    for (;;) {
+      uint64_t next = packed >> 32;
+      uint64_t end = packed & UINT32_MAX;
+      if (next >= end) {
+        return false;
+      }
+      if (range->compare_exchange_weak(packed, Pack(next + 1, end))) {
+        *morsel = next;
+        return true;
+      }
+    }
+  }
+
+  static bool TakeBack(std::atomic<uint64_t> *range, size_t *morsel) {
+    uint64_t packed = range->load();
+    for (;;) {
+      uint64_t next = packed >> 32;
+      uint64_t end = packed & UINT32_MAX;
+      if (next >= end) {
+        return false;
+      }
+      if (range->compare_exchange_weak(packed, Pack(next, end - 1))) {
+        *morsel = end - 1;
+        return true;
+      }
+    }
+  }
+
+  std::vector<std::atomic<uint64_t>> ranges_;
+};
+
+}  // namespace bustub
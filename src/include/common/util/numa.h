@@ -0,0 +1,46 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// numa.h
+//
+// Identification: src/include/common/util/numa.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+namespace bustub {
+
+/**
+ * The NUMA nodes of the machine, as Linux tells them in sysfs, and the placement of memory on them, without libnuma.
+ * A machine that does not tell its nodes, e.g. one that is not Linux, has a single node 0 with all of its CPUs.
+ */
+class Numa {
+ public:
+  /** @return the number of NUMA nodes, at least 1 */
+  static size_t GetNodeCount();
+
+  /** @return the CPUs of a node, whether or not the process may run on them; empty if the node is not known */
+  static std::vector<int> GetCpusOfNode(int node);
+
+  /** @return the node of a CPU, -1 if it is not known */
+  static int GetNodeOfCpu(int cpu);
+
+  /**
+   * Asks for the pages of a range of memory to be placed on a node when they are first touched, falling back to
+   * other nodes once it is full. It is only a hint: the memory stays where the OS puts it if the call fails.
+   * @param address the start of the range, on an OS page boundary, of memory that is not touched yet
+   * @param size the length of the range
+   * @param node the node to place the memory on
+   * @return true if the OS took the hint
+   */
+  static bool PreferNode(void *address, size_t size, int node);
+};
+
+}  // namespace bustub
@@ -0,0 +1,85 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// radix_sort.h
+//
+// Identification: src/include/common/util/radix_sort.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace bustub {
+
+/**
+ * Sorts entries by the normalized prefixes of their keys: a prefix_ of type uint64_t that every entry has, and which
+ * orders as the keys do, but may tie for keys that differ. The entries are sorted by their prefixes with an LSD radix
+ * sort, a byte at a time, which moves each of them once per byte and never calls a comparator; the bytes every prefix
+ * has the same, as the high bytes of small integers, are skipped, as the counts of all the bytes are made in one pass.
+ * Only the runs of entries whose prefixes tie are then sorted by tie_less, which compares their full keys, and is to
+ * break the ties of equal keys as well if the sort is to be stable. A handful of entries are sorted with the
+ * comparator alone.
+ *
+ * @param entries the entries, of a small type, e.g. a prefix and where the rest of the key and the row are
+ * @param tie_less whether the key of an entry goes before that of another with the same prefix
+ */
+template <typename Entry, typename TieLess>
+void RadixSortByPrefix(std::vector<Entry> *entries, TieLess tie_less) {
+  constexpr size_t MIN_RADIX_SORT = 256;
+  constexpr size_t NUM_BYTES = sizeof(uint64_t);
+  if (entries->size() < MIN_RADIX_SORT) {
+    std::sort(entries->begin(), entries->end(), [&tie_less](const Entry &a, const Entry &b) {
+      return a.prefix_ != b.prefix_ ? a.prefix_ < b.prefix_ : tie_less(a, b);
+    });
+    return;
+  }
+
+  std::vector<std::array<size_t, 256>> counts(NUM_BYTES);
+  for (auto &count : counts) {
+    count.fill(0);
+  }
+  for (const Entry &entry : *entries) {
+    for (size_t byte = 0; byte < NUM_BYTES; byte++) {
+      counts[byte][(entry.prefix_ >> (byte * 8)) & 0xFF]++;
+    }
+  }
+  std::vector<Entry> scratch(entries->size());
+  for (size_t byte = 0; byte < NUM_BYTES; byte++) {
+    std::array<size_t, 256> &count = counts[byte];
+    if (std::find(count.begin(), count.end(), entries->size()) != count.end()) {
+      continue;
+    }
+    size_t offset = 0;
+    for (size_t &slot : count) {
+      size_t bucket = slot;
+      slot = offset;
+      offset += bucket;
+    }
+    for (const Entry &entry : *entries) {
+      scratch[count[(entry.prefix_ >> (byte * 8)) & 0xFF]++] = entry;
+    }
+    entries->swap(scratch);
+  }
+
+  for (size_t begin = 0; begin < entries->size();) {
+    size_t end = begin + 1;
+    while (end < entries->size() && (*entries)[end].prefix_ == (*entries)[begin].prefix_) {
+      end++;
+    }
+    if (end - begin > 1) {
+      std::sort(entries->begin() + begin, entries->begin() + end, tie_less);
+    }
+    begin = end;
+  }
+}
+
+}  // namespace bustub
@@ -0,0 +1,55 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// thread_util.h
+//
+// Identification: src/include/common/util/thread_util.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstddef>
+#include <exception>
+#include <mutex>   // NOLINT
+#include <thread>  // NOLINT
+#include <vector>
+
+namespace bustub {
+
+/**
+ * Runs work(0), ..., work(num_threads - 1) on threads of their own, and waits for all of them.
+ * @param num_threads the number of threads
+ * @param work the work of a thread, given the number of the thread
+ * @throw the first exception a thread threw, once all of them are done
+ */
+template <typename Work>
+void RunThreads(size_t num_threads, Work &&work) {
+  std::vector<std::thread> threads;
+  std::mutex latch;
+  std::exception_ptr error;
+  threads.reserve(num_threads);
+  for (size_t i = 0; i < num_threads; i++) {
+    threads.emplace_back([&, i] {
+      try {
+        work(i);
+      } catch (...) {
+        std::scoped_lock lock{latch};
+        if (error == nullptr) {
+          error = std::current_exception();
+        }
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  if (error != nullptr) {
+    std::rethrow_exception(error);
+  }
+}
+
+}  // namespace bustub
@@ -0,0 +1,90 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// worker_pool.h
+//
+// Identification: src/include/common/worker_pool.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <condition_variable>  // NOLINT
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <mutex>   // NOLINT
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "common/macros.h"
+
+namespace bustub {
+
+/**
+ * WorkerPool keeps the threads that the pipelines of queries run on, so that a pipeline does not pay for starting
+ * threads of its own. The threads are started as the first Run that needs them asks for them, and each is pinned to
+ * a CPU of its own while there are CPUs enough: the CPUs of one NUMA node after those of the one before, so that the
+ * workers of a pipeline of a few of them share a node, and the memory they touch.
+ *
+ * Run hands out one piece of work to the first num_workers threads and waits for all of them; one Run is on the pool
+ * at a time, so the work of a Run must not Run on the pool itself.
+ */
+class WorkerPool {
+ public:
+  /** @param pin_threads whether the threads are pinned to CPUs */
+  explicit WorkerPool(bool pin_threads = true);
+
+  DISALLOW_COPY_AND_MOVE(WorkerPool);
+
+  /** Stops and joins the threads */
+  ~WorkerPool();
+
+  /** @return the pool of the process, which the pipelines of all queries share */
+  static WorkerPool *Instance();
+
+  /**
+   * Runs work(0), ..., work(num_workers - 1) on threads of the pool, and waits for all of them.
+   * @throw the first exception a piece of work threw, once all of them are done
+   */
+  void Run(size_t num_workers, const std::function<void(size_t)> &work);
+
+  /** @return the number of threads the pool has started */
+  size_t GetWorkerCount();
+
+  /** @return the NUMA node that the thread of an index runs on, -1 if it is not pinned or the node is not known */
+  int GetWorkerNode(size_t index) const;
+
+  /** @return the CPUs the process may run on, those of NUMA node 0 first, then those of node 1, and so on */
+  static std::vector<int> CpusInNumaOrder();
+
+ private:
+  void WorkerLoop(size_t index);
+
+  const bool pin_threads_;
+  /** The CPUs the threads are pinned to, in the order of the threads */
+  const std::vector<int> cpus_;
+  /** The NUMA nodes of cpus_ */
+  std::vector<int> nodes_;
+  /** Held by the Run that is on the pool */
+  std::mutex run_latch_;
+
+  /** Guards the rest */
+  std::mutex latch_;
+  std::condition_variable work_cv_;
+  std::condition_variable done_cv_;
+  std::vector<std::thread> threads_;
+  /** The work of the Run, which the threads of an index below num_active_ take part in */
+  const std::function<void(size_t)> *work_{nullptr};
+  size_t num_active_{0};
+  /** The number of Runs so far, which tells a thread that there is new work */
+  uint64_t generation_{0};
+  size_t remaining_{0};
+  std::exception_ptr error_;
+  bool stop_{false};
+};
+
+}  // namespace bustub
@@ -13,14 +13,20 @@
 #pragma once
 
 #include <algorithm>
+#include <array>
+#include <atomic>
 #include <condition_variable>  // NOLINT
 #include <list>
 #include <memory>
 #include <mutex>  // NOLINT
 #include <unordered_map>
+#include <unordered_set>
 #include <utility>
 #include <vector>
 
+#include "common/contention.h"
+#include "common/latency_histogram.h"
+#include "common/memory_tracker.h"
 #include "common/rid.h"
 #include "concurrency/transaction.h"
 
@@ -29,44 +35,188 @@ namespace bustub {
 class TransactionManager;
 
 /**
- * LockManager handles transactions asking for locks on records.
+ * How the LockManager keeps transactions that wait for each other's locks from waiting forever. DETECTION lets them
+ * wait, and aborts the newest transaction of each cycle of the waits-for graph, which a background thread builds every
+ * cycle_detection_interval. WOUND_WAIT and WAIT_DIE resolve a conflict as a request is made instead, by the ids of the
+ * transactions, which are older the smaller they are: under WOUND_WAIT, a request aborts (wounds) the younger
+ * transactions whose requests ahead of it conflict with it and waits for the older ones; under WAIT_DIE, a request
+ * waits for younger transactions only, and aborts its own transaction (dies) if an older one is ahead of it. Either
+ * way, a transaction only ever waits for older ones, or only for younger ones, so the waits cannot form a cycle.
  */
-class LockManager {
-  enum class LockMode { SHARED, EXCLUSIVE };
+enum class DeadlockPolicy { DETECTION, WOUND_WAIT, WAIT_DIE };
+
+/** A record that transactions waited to lock, and how many times and how long they waited for it. */
+struct RowContention {
+  RID rid_;
+  uint64_t waits_;
+  uint64_t wait_ns_;
+};
 
+/**
+ * LockManager handles transactions asking for locks on records and tables, under strict two-phase locking: a
+ * transaction takes no lock once it released one, but for the shared locks a READ_COMMITTED transaction releases as it
+ * reads, and the intention locks of tables, which lock no data of their own.
+ *
+ * Locks are hierarchical: a transaction that locks a table SHARED or EXCLUSIVE has all of its records locked so, and
+ * one that locks records of a table holds an intention lock on the table, which conflicts with the locks of other
+ * transactions on the whole table that do not allow the records' locks. A record locked with the oid of its table is
+ * not locked on its own if the lock of the table covers it, so that a scan takes one lock instead of one per record;
+ * else the intention lock of the table is taken first, or a lock of the table is upgraded to cover it too, as a
+ * shared lock with an exclusive record is to SHARED_INTENTION_EXCLUSIVE.
+ *
+ * A transaction that holds the escalation threshold of record locks of a table, or a multiple of it, trades them for
+ * a SHARED or EXCLUSIVE lock of the table, as it would have taken for a scan, if that lock can be granted at once. If
+ * it cannot, as another transaction works on the table too, the transaction keeps its record locks, and tries again
+ * once it holds another threshold of them. The record locks are given up without ending the growing phase, as the
+ * table lock keeps what they locked locked.
+ *
+ * The lock table is split into NUM_SHARDS shards by the hash of the RID, each with a latch of its own, so that
+ * transactions locking different records rarely wait on the same latch; a table is locked under the RID of
+ * INVALID_PAGE_ID and its oid, which no record has. A shard keeps a queue of requests per RID, which are granted in
+ * order: a request once its mode is compatible with the ones of every request ahead of it and every granted one. A
+ * request that is not granted waits on the condition variable of its queue, which every unlock of the RID notifies. An
+ * upgrade takes the place of the transaction's request after the granted ones, ahead of every request that waits;
+ * only one transaction of a queue may wait to upgrade at a time.
+ *
+ * Deadlocks are dealt with as the DeadlockPolicy of the lock manager says. Under DETECTION, the waits-for graph is
+ * kept as requests block and unblock: a waiting request waits for the requests of its queue that it has to wait for,
+ * and its edges are set again whenever its queue changes. Every cycle_detection_interval, a background thread looks
+ * for cycles through the transactions that got new edges since it last looked, as any new cycle goes through one of
+ * them, with a search of just what they reach, so that its cost is of the waiters rather than of the lock table. Of
+ * each cycle, the transaction that held the fewest locks as it started to wait, the one with the least work to throw
+ * away, or else the newest one, is aborted, and woken up to throw a TransactionAbortException. The edges of the graph
+ * API (AddEdge, HasCycle, ...) go into the same graph; HasCycle reports the newest transaction of a cycle of the
+ * whole graph. Under WOUND_WAIT and WAIT_DIE, a request checks the requests it waits for each time it wakes up, so
+ * also after an upgrade went ahead of it; there is no background thread. A wounded transaction that waits is woken up
+ * to throw, one that runs finds out at its next request, which returns false.
+ *
+ * An index locks its key ranges here too, under RIDs of their own (see KeyRangeRid), in SHARED and EXCLUSIVE mode only;
+ * they take no lock of the table, as the records they cover are locked with it.
+ */
+class LockManager {
   class LockRequest {
    public:
-    LockRequest(txn_id_t txn_id, LockMode lock_mode) : txn_id_(txn_id), lock_mode_(lock_mode), granted_(false) {}
+    LockRequest(Transaction *txn, LockMode lock_mode)
+        : txn_(txn), txn_id_(txn->GetTransactionId()), lock_mode_(lock_mode), granted_(false) {}
 
+    Transaction *txn_;
     txn_id_t txn_id_;
     LockMode lock_mode_;
     bool granted_;
   };
 
+  /** The requests of a queue, whose nodes are accounted for as LOCK_TABLE memory, as those of the queues are */
+  using RequestList = std::list<LockRequest, TrackedAllocator<LockRequest, MemoryCategory::LOCK_TABLE>>;
+
   class LockRequestQueue {
    public:
-    std::list<LockRequest> request_queue_;
+    RequestList request_queue_;
     std::condition_variable cv_;  // for notifying blocked transactions on this rid
     bool upgrading_ = false;
   };
 
+  /**
+   * A part of the lock table, of the RIDs that hash to it, and the latch that guards it. The requests and the queues
+   * that are let go of are kept for the next ones, which take them over instead of allocating, so that a steady load of
+   * locking allocates nothing; the shard keeps as many as it ever held at once.
+   */
+  struct LockTableShard {
+    using QueueTable =
+        std::unordered_map<RID, LockRequestQueue, std::hash<RID>, std::equal_to<RID>,
+                           TrackedAllocator<std::pair<const RID, LockRequestQueue>, MemoryCategory::LOCK_TABLE>>;
+
+    /** @return the queue of a RID, which is added, out of a kept one if there is one, if the RID has none */
+    LockRequestQueue &QueueOf(const RID &rid);
+
+    /** Drops the queue of a RID, which has no requests left, and keeps it */
+    void DropQueue(const RID &rid) { free_queues_.push_back(lock_table_.extract(rid)); }
+
+    /** @return a new request of a transaction, put into a queue before a position, out of a kept one if there is one */
+    RequestList::iterator AddRequest(LockRequestQueue *queue, RequestList::iterator position,
+                                                Transaction *txn, LockMode lock_mode);
+
+    /** Drops a request of a queue, and keeps it */
+    void DropRequest(LockRequestQueue *queue, RequestList::iterator request) {
+      free_requests_.splice(free_requests_.end(), queue->request_queue_, request);
+    }
+
+    /** Drops the requests of a transaction of a queue, and keeps them */
+    void DropRequests(LockRequestQueue *queue, txn_id_t txn_id);
+
+    /** Counts a wait for the lock of a record in hot_rows_ */
+    void RecordRowWait(const RID &rid, std::chrono::nanoseconds wait);
+
+    std::mutex latch_;
+    QueueTable lock_table_;
+    RequestList free_requests_;
+    std::vector<QueueTable::node_type> free_queues_;
+    /**
+     * The records of the shard waited for the most, at most HOT_ROWS_PER_SHARD of them. A record that is not kept
+     * takes the place of the one with the fewest waits, and its count on top of it (the space-saving sketch): a count
+     * may be too high by the waits of the record it replaced, but a record with more than a HOT_ROWS_PER_SHARD-th of
+     * the waits of the shard is never dropped.
+     */
+    std::vector<RowContention> hot_rows_;
+  };
+
+  /** A waits-for graph, of the transactions each transaction waits for */
+  using WaitsForGraph = std::unordered_map<txn_id_t, std::vector<txn_id_t>>;
+
+  /** A transaction that waits for a lock */
+  struct Waiter {
+    Transaction *txn_;
+    RID rid_;
+    /** The locks it held as it started to wait, the work that aborting it throws away */
+    size_t locks_held_;
+  };
+
  public:
   /**
-   * Creates a new lock manager configured for the deadlock detection policy.
+   * Creates a new lock manager configured for a deadlock policy.
+   * @param policy how deadlocks are dealt with, by detection in the background by default
    */
-  LockManager() {
-    enable_cycle_detection_ = true;
-    cycle_detection_thread_ = new std::thread(&LockManager::RunCycleDetection, this);
-    LOG_INFO("Cycle detection thread launched");
+  explicit LockManager(DeadlockPolicy policy = DeadlockPolicy::DETECTION) : policy_(policy) {
+    enable_cycle_detection_ = policy_ == DeadlockPolicy::DETECTION;
+    if (enable_cycle_detection_) {
+      cycle_detection_thread_ = new std::thread(&LockManager::RunCycleDetection, this);
+      LOG_INFO("Cycle detection thread launched");
+    }
   }
 
   ~LockManager() {
-    enable_cycle_detection_ = false;
-    cycle_detection_thread_->join();
-    delete cycle_detection_thread_;
-    LOG_INFO("Cycle detection thread stopped");
+    if (cycle_detection_thread_ != nullptr) {
+      enable_cycle_detection_ = false;
+      cycle_detection_thread_->join();
+      delete cycle_detection_thread_;
+      LOG_INFO("Cycle detection thread stopped");
+    }
   }
 
+  /** @return how deadlocks are dealt with */
+  DeadlockPolicy GetDeadlockPolicy() const { return policy_; }
+
+  /** @return the latencies of the lock requests that had to wait, up to their grant or their abort */
+  LatencySnapshot GetLockWaitLatency() const { return lock_wait_latency_.Snapshot(); }
+
+  /**
+   * @param limit the most records to return
+   * @return the records that lock requests waited for the most since the lock manager was created, the most waited
+   * for first; the counts are estimates once a shard waited for more than HOT_ROWS_PER_SHARD different records
+   */
+  std::vector<RowContention> GetHotRids(size_t limit);
+
+  /** The records of each shard of the lock table whose waits are kept for GetHotRids */
+  static constexpr size_t HOT_ROWS_PER_SHARD = 32;
+
+  /** The record locks of one table a transaction holds before they are escalated to a lock of the table by default */
+  static constexpr size_t DEFAULT_ESCALATION_THRESHOLD = 5000;
+
+  /** Sets the record locks of one table a transaction holds before they are escalated, 0 to never escalate */
+  void SetEscalationThreshold(size_t threshold) { escalation_threshold_ = threshold; }
+
+  /** @return the record locks of one table a transaction holds before they are escalated, 0 if they never are */
+  size_t GetEscalationThreshold() const { return escalation_threshold_; }
+
   /*
    * [LOCK_NOTE]: For all locking functions, we:
    * 1. return false if the transaction is aborted; and
@@ -79,25 +229,41 @@ class LockManager {
    * Acquire a lock on RID in shared mode. See [LOCK_NOTE] in header file.
    * @param txn the transaction requesting the shared lock
    * @param rid the RID to be locked in shared mode
+   * @param oid the table of the record, whose lock may cover it, or else is taken in INTENTION_SHARED mode first
    * @return true if the lock is granted, false otherwise
    */
-  bool LockShared(Transaction *txn, const RID &rid);
+  bool LockShared(Transaction *txn, const RID &rid, table_oid_t oid = INVALID_TABLE_OID);
 
   /**
    * Acquire a lock on RID in exclusive mode. See [LOCK_NOTE] in header file.
    * @param txn the transaction requesting the exclusive lock
    * @param rid the RID to be locked in exclusive mode
+   * @param oid the table of the record, whose lock may cover it, or else is taken in INTENTION_EXCLUSIVE mode first
    * @return true if the lock is granted, false otherwise
    */
-  bool LockExclusive(Transaction *txn, const RID &rid);
+  bool LockExclusive(Transaction *txn, const RID &rid, table_oid_t oid = INVALID_TABLE_OID);
 
   /**
    * Upgrade a lock from a shared lock to an exclusive lock.
    * @param txn the transaction requesting the lock upgrade
    * @param rid the RID that should already be locked in shared mode by the requesting transaction
+   * @param oid the table of the record, as for LockExclusive
    * @return true if the upgrade is successful, false otherwise
    */
-  bool LockUpgrade(Transaction *txn, const RID &rid);
+  bool LockUpgrade(Transaction *txn, const RID &rid, table_oid_t oid = INVALID_TABLE_OID);
+
+  /**
+   * Acquire a lock on the RID of a tuple being inserted in exclusive mode, if it can be granted at once. The slot of a
+   * tuple that is gone may still be locked, or waited for, by a transaction that read its RID before and waits for the
+   * latch of the page to find the tuple gone; the insert, which holds that latch, takes another slot rather than wait.
+   * A transaction that was aborted meanwhile is granted the lock too, for its rollback to delete the tuple under.
+   * @param txn the transaction inserting the tuple
+   * @param rid the RID of the slot the tuple is to go into
+   * @param oid the table of the record, which the transaction locked INTENTION_EXCLUSIVE before it latched the page,
+   * as nothing here waits; INVALID_TABLE_OID if the record belongs to no table lock
+   * @return true if the lock is granted, false if another transaction holds or waits for it
+   */
+  bool LockNewTuple(Transaction *txn, const RID &rid, table_oid_t oid = INVALID_TABLE_OID);
 
   /**
    * Release the lock held by the transaction.
@@ -107,6 +273,63 @@ class LockManager {
    */
   bool Unlock(Transaction *txn, const RID &rid);
 
+  /**
+   * Acquire a lock on a table. A table the transaction locked already is upgraded to a mode that covers both its lock
+   * and the one asked for, if its lock does not cover it already. See [LOCK_NOTE] in header file.
+   * @param txn the transaction requesting the lock
+   * @param oid the table to be locked
+   * @param mode the mode to lock the table in; a READ_UNCOMMITTED transaction takes exclusive modes only
+   * @return true if the lock is granted, false otherwise
+   */
+  bool LockTable(Transaction *txn, table_oid_t oid, LockMode mode);
+
+  /**
+   * Release the lock on a table held by the transaction. Releasing an intention lock does not end the growing phase.
+   * @param txn the transaction releasing the lock
+   * @param oid the table that is locked by the transaction
+   * @return true if the unlock is successful, false otherwise
+   */
+  bool UnlockTable(Transaction *txn, table_oid_t oid);
+
+  /**
+   * Acquire a lock on a key range of an index, see KeyRangeRid. A held range is in the transaction's lock sets like a
+   * record, and is let go of with Unlock. See [LOCK_NOTE] in header file.
+   * @param txn the transaction requesting the lock
+   * @param range the key range to be locked
+   * @param mode SHARED or EXCLUSIVE
+   * @param instant true to let go of the lock as soon as it is granted, as an insert does that only has to know that
+   * no scan holds the range it inserts into; an instant lock does not end the growing phase. A range the transaction
+   * holds shared is locked exclusive until the transaction ends instead.
+   * @return true if the lock is granted, false otherwise
+   */
+  bool LockKeyRange(Transaction *txn, const RID &range, LockMode mode, bool instant = false);
+
+  /**
+   * Acquire a lock on a key range of an index if it can be granted at once, as a scan that holds the latch of a leaf
+   * asks, which must not wait for a writer that may wait for the latch.
+   * @return true if the lock is granted, false if it would have to be waited for or the transaction is aborted
+   */
+  bool TryLockKeyRange(Transaction *txn, const RID &range, LockMode mode);
+
+  /**
+   * @return the RID a key range of an index is locked under: the range from the entry before an entry up to it, which
+   * next-key locking locks with the entry, by the hash of the entry's key. Ranges are told apart by the 32 bits of the
+   * hash only, so two that share them are locked as one, which makes a transaction wait for nothing at worst. The page
+   * id is below INVALID_PAGE_ID, which no record and no table has.
+   */
+  static RID KeyRangeRid(index_oid_t index_oid, uint32_t key_hash) {
+    return RID(INVALID_PAGE_ID - 1 - static_cast<page_id_t>(index_oid), key_hash);
+  }
+
+  /** @return the RID the key range after the last entry of an index is locked under */
+  static RID EndOfIndexRid(index_oid_t index_oid) { return KeyRangeRid(index_oid, UINT32_MAX); }
+
+  /** @return true if a lock in the first mode and one in the second may be held by two transactions at once */
+  static bool AreCompatible(LockMode first, LockMode second);
+
+  /** @return true if a lock in the first mode allows everything that one in the second mode does */
+  static bool Covers(LockMode held, LockMode mode);
+
   /*** Graph API ***/
   /**
    * Adds edge t1->t2
@@ -131,15 +354,126 @@ class LockManager {
   /** Runs cycle detection in the background. */
   void RunCycleDetection();
 
+  /** The number of shards the lock table is split into, by the top bits of the mixed hash of a RID */
+  static constexpr size_t SHARD_BITS = 6;
+  static constexpr size_t NUM_SHARDS = size_t{1} << SHARD_BITS;
+
  private:
+  /** @return the shard of the lock table that a RID is in */
+  LockTableShard &ShardOf(const RID &rid) {
+    // the hash of a RID is its page id and slot, whose high bits the multiplication spreads over the shards
+    return shards_[(std::hash<RID>{}(rid) * 0x9E3779B97F4A7C15ULL) >> (64 - SHARD_BITS)];
+  }
+
+  /** @return the RID under which a table is locked */
+  static RID TableRid(table_oid_t oid) { return RID(INVALID_PAGE_ID, oid); }
+
+  /** @return true if the transaction holds a lock on the table that covers the mode */
+  static bool HoldsTableLock(Transaction *txn, table_oid_t oid, LockMode mode);
+
+  /** @return the weakest mode that covers both a lock held and the one asked for */
+  static LockMode Combine(LockMode held, LockMode mode) {
+    if (Covers(held, mode)) {
+      return held;
+    }
+    // both of a shared lock and an intention to write are SHARED_INTENTION_EXCLUSIVE
+    return Covers(mode, held) ? mode : LockMode::SHARED_INTENTION_EXCLUSIVE;
+  }
+
+  /** Trades the record locks of a table the transaction holds for a lock of the table, if it holds enough of them */
+  void MaybeEscalate(Transaction *txn, table_oid_t oid);
+
+  /**
+   * Checks that the transaction may take a lock, and aborts it if not.
+   * @return false if the transaction was aborted already
+   * @throw TransactionAbortException if the transaction is shrinking
+   */
+  bool CheckGrowing(Transaction *txn);
+
+  /**
+   * @param ahead whether the other request is ahead of the request in their queue
+   * @return true if the request has to wait for the other one, which is ahead of it or granted, and conflicts with it
+   */
+  static bool WaitsFor(const LockRequest &request, const LockRequest &other, bool ahead) {
+    return (ahead || other.granted_) && !AreCompatible(request.lock_mode_, other.lock_mode_);
+  }
+
+  /** @return true if the request of the transaction in the queue may be granted, as the other requests allow */
+  static bool IsGrantable(const LockRequestQueue &queue, RequestList::iterator request);
+
+  /**
+   * Replaces the granted request of the transaction for a RID with one in a stronger mode, and waits till it is
+   * granted.
+   * @param wait false to give up rather than wait, or throw, if the request cannot be granted at once
+   * @return false if the request was given up
+   * @throw TransactionAbortException if another transaction waits to upgrade in the same queue, or on a deadlock
+   */
+  bool UpgradeRequest(Transaction *txn, const RID &rid, LockMode mode, bool wait = true);
+
+  /** Drops the requests of the transaction for a RID, and wakes up the ones that may be granted now */
+  void RemoveRequest(Transaction *txn, const RID &rid);
+
+  /**
+   * Applies the WOUND_WAIT or WAIT_DIE policy to a request that cannot be granted yet: wounds the younger
+   * transactions it waits for, or aborts its own transaction if it waits for an older one.
+   * @param lock the lock on the latch of the shard of the RID, which is let go of while wounded transactions that
+   * wait in other shards are woken up
+   * @return true if the latch was let go of, so that the queue may have changed since
+   */
+  bool PreventDeadlock(std::unique_lock<std::mutex> *lock, LockTableShard *shard, LockRequestQueue *queue,
+                       RequestList::iterator request);
+
+  /**
+   * Waits till a request in the queue of a RID is granted, or its transaction is aborted.
+   * @param lock the lock on the latch of the shard of the RID
+   * @param upgrade whether the request is the upgrade of the queue
+   * @throw TransactionAbortException if the transaction was aborted as it waited, whose request is then dropped
+   */
+  void WaitForGrant(std::unique_lock<std::mutex> *lock, LockTableShard *shard, const RID &rid,
+                    RequestList::iterator request, bool upgrade);
+
+  /** @return true if the graph has a cycle, with the newest transaction of the first one found in txn_id */
+  static bool FindCycle(const WaitsForGraph &graph, txn_id_t *txn_id);
+
+  /**
+   * @param[out] cycle the transactions of a cycle through the start, in the order of their edges
+   * @return true if the graph has a cycle through the start, which is searched for among what the start reaches only
+   */
+  static bool FindCycleThrough(const WaitsForGraph &graph, txn_id_t start, std::vector<txn_id_t> *cycle);
+
+  /**
+   * Sets the edges of the waiting requests of a queue to the requests they wait for, and marks the
+   * transactions that got new ones as newly blocked. Both the latch of the queue's shard and latch_ are held.
+   */
+  void UpdateWaitsFor(const LockRequestQueue &queue);
+
+  /** Aborts a transaction of each cycle through the newly blocked transactions */
+  void BreakDeadlocks();
+
+  const DeadlockPolicy policy_;
+  size_t escalation_threshold_{DEFAULT_ESCALATION_THRESHOLD};
   std::mutex latch_;
   std::atomic<bool> enable_cycle_detection_;
-  std::thread *cycle_detection_thread_;
+  std::thread *cycle_detection_thread_{nullptr};
 
-  /** Lock table for lock requests. */
-  std::unordered_map<RID, LockRequestQueue> lock_table_;
-  /** Waits-for graph representation. */
-  std::unordered_map<txn_id_t, std::vector<txn_id_t>> waits_for_;
+  /** Lock table for lock requests, in shards. */
+  std::array<LockTableShard, NUM_SHARDS> shards_;
+  /**
+   * Waits-for graph representation, of the waiting requests under DETECTION and of the graph API, which latch_
+   * guards, as it does the waiters and the newly blocked ones. latch_ is taken after the latch of a shard, if both are.
+   */
+  WaitsForGraph waits_for_;
+  /** The transactions that wait for a lock, to abort or to wake up when they are wounded */
+  std::unordered_map<txn_id_t, Waiter> waiters_;
+  /** The waiting transactions that got new edges since the cycle detection last looked */
+  std::unordered_set<txn_id_t> newly_blocked_;
+  LatencyHistogram lock_wait_latency_;
+  /** Where the waits for the latches and in the request queues are counted, with those of other lock managers */
+  ContentionSite *shard_latch_site_{ContentionProfiler::Site("lock_manager.shard_latch")};
+  ContentionSite *graph_latch_site_{ContentionProfiler::Site("lock_manager.graph_latch")};
+  ContentionSite *row_lock_site_{ContentionProfiler::Site("lock.row")};
+  ContentionSite *table_lock_site_{ContentionProfiler::Site("lock.table")};
+  ContentionSite *key_range_lock_site_{ContentionProfiler::Site("lock.key_range")};
 };
 
 }  // namespace bustub
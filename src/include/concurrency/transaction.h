@@ -17,6 +17,7 @@
 #include <memory>
 #include <string>
 #include <thread>  // NOLINT
+#include <unordered_map>
 #include <unordered_set>
 
 #include "common/config.h"
@@ -44,19 +45,39 @@ namespace bustub {
 enum class TransactionState { GROWING, SHRINKING, COMMITTED, ABORTED };
 
 /**
- * Transaction isolation level.
+ * Transaction isolation level. A SNAPSHOT transaction reads the tables as the transactions that committed before it
+ * began left them, from the versions the tables keep, without taking locks to read; of two SNAPSHOT transactions that
+ * write the same tuple, the one that writes it second aborts.
+ *
+ * An OPTIMISTIC transaction takes no locks to read either: it records the TID of each tuple it reads in its read set,
+ * and keeps its updates and deletes in its write set until it commits; it commits only if none of the tuples it read
+ * was written since, and aborts otherwise.
+ *
+ * A SERIALIZABLE transaction locks like a REPEATABLE_READ one, and also locks the key ranges of the B+ tree indexes it
+ * scans (see BPlusTreeIndex), so that no other transaction inserts a row into a range it read: no phantoms appear
+ * without the whole table being locked.
  */
-enum class IsolationLevel { READ_UNCOMMITTED, REPEATABLE_READ, READ_COMMITTED };
+enum class IsolationLevel { READ_UNCOMMITTED, REPEATABLE_READ, READ_COMMITTED, SNAPSHOT, OPTIMISTIC, SERIALIZABLE };
 
 /**
  * Type of write operation.
  */
 enum class WType { INSERT = 0, DELETE, UPDATE };
 
+/**
+ * Modes of the locks the LockManager grants. A record is locked SHARED or EXCLUSIVE. A table is locked in those modes
+ * too, which cover all of its records, or in an intention mode, which says how the transaction locks some of its
+ * records: INTENTION_SHARED shared, INTENTION_EXCLUSIVE exclusive, and SHARED_INTENTION_EXCLUSIVE exclusive while it
+ * holds all of them shared.
+ */
+enum class LockMode { SHARED, EXCLUSIVE, INTENTION_SHARED, INTENTION_EXCLUSIVE, SHARED_INTENTION_EXCLUSIVE };
+
 class TableHeap;
 class Catalog;
 using table_oid_t = uint32_t;
 using index_oid_t = uint32_t;
+/** The oid of no table, for records that are locked without their table */
+static constexpr table_oid_t INVALID_TABLE_OID = UINT32_MAX;
 
 /**
  * WriteRecord tracks information related to a write.
@@ -74,6 +95,19 @@ class TableWriteRecord {
   TableHeap *table_;
 };
 
+/**
+ * ReadRecord tracks a read of an OPTIMISTIC transaction, which it validates as it commits.
+ */
+class TableReadRecord {
+ public:
+  TableReadRecord(RID rid, uint64_t tid, TableHeap *table) : rid_(rid), tid_(tid), table_(table) {}
+
+  RID rid_;
+  /** The TID of the tuple when it was read. */
+  uint64_t tid_;
+  TableHeap *table_;
+};
+
 /**
  * WriteRecord tracks information related to a write.
  */
@@ -107,7 +141,8 @@ enum class AbortReason {
   UNLOCK_ON_SHRINKING,
   UPGRADE_CONFLICT,
   DEADLOCK,
-  LOCKSHARED_ON_READ_UNCOMMITTED
+  LOCKSHARED_ON_READ_UNCOMMITTED,
+  VALIDATION_FAILED
 };
 
 /**
@@ -137,6 +172,9 @@ class TransactionAbortException : public std::exception {
         return "Transaction " + std::to_string(txn_id_) + " aborted on deadlock\n";
       case AbortReason::LOCKSHARED_ON_READ_UNCOMMITTED:
         return "Transaction " + std::to_string(txn_id_) + " aborted on lockshared on READ_UNCOMMITTED\n";
+      case AbortReason::VALIDATION_FAILED:
+        return "Transaction " + std::to_string(txn_id_) +
+               " aborted as a tuple it read was written before it committed\n";
     }
     // Todo: Should fail with unreachable.
     return "";
@@ -155,9 +193,12 @@ class Transaction {
         txn_id_(txn_id),
         prev_lsn_(INVALID_LSN),
         shared_lock_set_{new std::unordered_set<RID>},
-        exclusive_lock_set_{new std::unordered_set<RID>} {
+        exclusive_lock_set_{new std::unordered_set<RID>},
+        table_lock_set_{new std::unordered_map<table_oid_t, LockMode>},
+        table_row_lock_set_{new std::unordered_map<table_oid_t, std::unordered_set<RID>>} {
     // Initialize the sets that will be tracked.
     table_write_set_ = std::make_shared<std::deque<TableWriteRecord>>();
+    table_read_set_ = std::make_shared<std::deque<TableReadRecord>>();
     index_write_set_ = std::make_shared<std::deque<IndexWriteRecord>>();
     page_set_ = std::make_shared<std::deque<bustub::Page *>>();
     deleted_page_set_ = std::make_shared<std::unordered_set<page_id_t>>();
@@ -167,6 +208,34 @@ class Transaction {
 
   DISALLOW_COPY(Transaction);
 
+  /**
+   * Makes a finished transaction a new one, as the TransactionManager reuses it; its sets are emptied but keep the
+   * memory they grew to, so that a transaction that begins on a recycled object does not allocate them again.
+   * @param txn_id the id of the new transaction
+   * @param isolation_level the isolation level of the new transaction
+   */
+  void Reset(txn_id_t txn_id, IsolationLevel isolation_level) {
+    state_ = TransactionState::GROWING;
+    isolation_level_ = isolation_level;
+    thread_id_ = std::this_thread::get_id();
+    txn_id_ = txn_id;
+    prev_lsn_ = INVALID_LSN;
+    first_lsn_ = INVALID_LSN;
+    read_ts_ = INVALID_TS;
+    commit_ts_ = INVALID_TS;
+    validated_ = false;
+    async_commit_ = false;
+    table_write_set_->clear();
+    table_read_set_->clear();
+    index_write_set_->clear();
+    page_set_->clear();
+    deleted_page_set_->clear();
+    shared_lock_set_->clear();
+    exclusive_lock_set_->clear();
+    table_lock_set_->clear();
+    table_row_lock_set_->clear();
+  }
+
   /** @return the id of the thread running the transaction */
   inline std::thread::id GetThreadId() const { return thread_id_; }
 
@@ -176,9 +245,45 @@ class Transaction {
   /** @return the isolation level of this transaction */
   inline IsolationLevel GetIsolationLevel() const { return isolation_level_; }
 
+  /**
+   * @return the timestamp of the last commit before the transaction began, whose writes and those of the ones before
+   * it a SNAPSHOT transaction sees; INVALID_TS if no TransactionManager began it, and its writes keep no versions
+   */
+  inline timestamp_t GetReadTs() const { return read_ts_; }
+
+  /** Sets the timestamp the transaction reads at, as it begins. */
+  inline void SetReadTs(timestamp_t read_ts) { read_ts_ = read_ts; }
+
+  /** @return the timestamp the transaction committed at, INVALID_TS until it did */
+  inline timestamp_t GetCommitTs() const { return commit_ts_; }
+
+  /** Sets the timestamp the transaction commits at. */
+  inline void SetCommitTs(timestamp_t commit_ts) { commit_ts_ = commit_ts; }
+
   /** @return the list of table write records of this transaction */
   inline std::shared_ptr<std::deque<TableWriteRecord>> GetWriteSet() { return table_write_set_; }
 
+  /** @return the tuples an OPTIMISTIC transaction read, with their TIDs then */
+  inline std::shared_ptr<std::deque<TableReadRecord>> GetReadSet() { return table_read_set_; }
+
+  /**
+   * @return true once an OPTIMISTIC transaction passed validation as it commits, and its updates and deletes go to
+   * the tables rather than the write set
+   */
+  inline bool IsValidated() const { return validated_; }
+
+  /** Marks an OPTIMISTIC transaction as validated. */
+  inline void SetValidated() { validated_ = true; }
+
+  /**
+   * @return true if the commit of the transaction returns once its commit record is appended, rather than once it is
+   * on disk, which it is at most async_commit_delay later; a crash in between loses the transaction
+   */
+  inline bool IsAsyncCommit() const { return async_commit_; }
+
+  /** Sets whether the transaction commits asynchronously, e.g. for the tables that can lose their last commits. */
+  inline void SetAsyncCommit(bool async_commit) { async_commit_ = async_commit; }
+
   /** @return the list of index write records of this transaction */
   inline std::shared_ptr<std::deque<IndexWriteRecord>> GetIndexWriteSet() { return index_write_set_; }
 
@@ -222,6 +327,14 @@ class Transaction {
   /** @return the set of resources under an exclusive lock */
   inline std::shared_ptr<std::unordered_set<RID>> GetExclusiveLockSet() { return exclusive_lock_set_; }
 
+  /** @return the tables under a lock, by the mode they are locked in */
+  inline std::shared_ptr<std::unordered_map<table_oid_t, LockMode>> GetTableLockSet() { return table_lock_set_; }
+
+  /** @return the locked records that were locked with the oid of their table, by their table */
+  inline std::shared_ptr<std::unordered_map<table_oid_t, std::unordered_set<RID>>> GetTableRowLockSet() {
+    return table_row_lock_set_;
+  }
+
   /** @return true if rid is shared locked by this transaction */
   bool IsSharedLocked(const RID &rid) { return shared_lock_set_->find(rid) != shared_lock_set_->end(); }
 
@@ -237,6 +350,14 @@ class Transaction {
    */
   inline void SetState(TransactionState state) { state_ = state; }
 
+  /**
+   * Sets the state of the transaction if it is still the expected one, e.g. to abort it from another thread.
+   * @return false if the state was another one, which is left as it is
+   */
+  inline bool CompareAndSetState(TransactionState expected, TransactionState state) {
+    return state_.compare_exchange_strong(expected, state);
+  }
+
   /** @return the previous LSN */
   inline lsn_t GetPrevLSN() { return prev_lsn_; }
 
@@ -244,11 +365,19 @@ class Transaction {
    * Set the previous LSN.
    * @param prev_lsn new previous lsn
    */
-  inline void SetPrevLSN(lsn_t prev_lsn) { prev_lsn_ = prev_lsn; }
+  inline void SetPrevLSN(lsn_t prev_lsn) {
+    if (first_lsn_ == INVALID_LSN) {
+      first_lsn_ = prev_lsn;
+    }
+    prev_lsn_ = prev_lsn;
+  }
+
+  /** @return the LSN of the first record written by the transaction, the oldest that its rollback reads */
+  inline lsn_t GetFirstLSN() { return first_lsn_; }
 
  private:
-  /** The current transaction state. */
-  TransactionState state_;
+  /** The current transaction state, which the lock manager may abort from another thread. */
+  std::atomic<TransactionState> state_;
   /** The isolation level of the transaction. */
   IsolationLevel isolation_level_;
   /** The thread ID, used in single-threaded transactions. */
@@ -258,10 +387,19 @@ class Transaction {
 
   /** The undo set of table tuples. */
   std::shared_ptr<std::deque<TableWriteRecord>> table_write_set_;
+  /** OCC: the read set of tuples, and whether the transaction was validated. */
+  std::shared_ptr<std::deque<TableReadRecord>> table_read_set_;
+  bool validated_{false};
+  /** Whether the commit returns before it is durable. */
+  bool async_commit_{false};
   /** The undo set of indexes. */
   std::shared_ptr<std::deque<IndexWriteRecord>> index_write_set_;
-  /** The LSN of the last record written by the transaction. */
+  /** The LSN of the last record written by the transaction, and of the first one. */
   lsn_t prev_lsn_;
+  lsn_t first_lsn_{INVALID_LSN};
+  /** MVCC: the timestamp the transaction reads at, and the one it committed at. */
+  timestamp_t read_ts_{INVALID_TS};
+  timestamp_t commit_ts_{INVALID_TS};
 
   /** Concurrent index: the pages that were latched during index operation. */
   std::shared_ptr<std::deque<Page *>> page_set_;
@@ -272,6 +410,10 @@ class Transaction {
   std::shared_ptr<std::unordered_set<RID>> shared_lock_set_;
   /** LockManager: the set of exclusive-locked tuples held by this transaction. */
   std::shared_ptr<std::unordered_set<RID>> exclusive_lock_set_;
+  /** LockManager: the tables locked by this transaction, and their modes. */
+  std::shared_ptr<std::unordered_map<table_oid_t, LockMode>> table_lock_set_;
+  /** LockManager: the records of each table among the locked ones, which the lock escalation counts. */
+  std::shared_ptr<std::unordered_map<table_oid_t, std::unordered_set<RID>>> table_row_lock_set_;
 };
 
 }  // namespace bustub
@@ -13,12 +13,18 @@
 #pragma once
 
 #include <atomic>
+#include <chrono>  // NOLINT
+#include <mutex>   // NOLINT
+#include <set>
 #include <unordered_map>
 #include <unordered_set>
+#include <vector>
 
 #include "common/config.h"
+#include "common/latency_histogram.h"
 #include "concurrency/lock_manager.h"
 #include "concurrency/transaction.h"
+#include "concurrency/transaction_registry.h"
 #include "recovery/log_manager.h"
 
 namespace bustub {
@@ -26,24 +32,50 @@ class LockManager;
 
 /**
  * TransactionManager keeps track of all the transactions running in the system.
+ *
+ * Each transaction it begins reads as of the timestamp of the last commit, and the writes of one that commits get the
+ * next timestamp, which keeps the versions of the tuples they wrote in the VersionStores of the tables apart; the
+ * versions the oldest snapshot still running no longer reaches are collected as the transactions that wrote a table
+ * finish.
+ *
+ * An OPTIMISTIC transaction commits as in Silo: it locks the TIDs of the tuples it writes, in a global order, and
+ * validates that the tuples it read still have the TIDs it read, under short page latches and without the
+ * LockManager; it then installs its updates and deletes, and gives the tuples a TID of the current epoch that is
+ * greater than any it saw. The epochs are the EPOCH_LENGTH periods of a steady clock, so that no thread advances them.
  */
 class TransactionManager {
  public:
   explicit TransactionManager(LockManager *lock_manager, LogManager *log_manager = nullptr)
       : lock_manager_(lock_manager), log_manager_(log_manager) {}
 
-  ~TransactionManager() = default;
+  ~TransactionManager();
 
   /**
    * Begins a new transaction.
-   * @param txn an optional transaction object to be initialized, otherwise a new transaction is created.
+   * @param txn an optional transaction object to be initialized, otherwise one released before is reused, or a new
+   * one created.
    * @param isolation_level an optional isolation level of the transaction.
    * @return an initialized transaction
    */
   Transaction *Begin(Transaction *txn = nullptr, IsolationLevel isolation_level = IsolationLevel::REPEATABLE_READ);
 
   /**
-   * Commits a transaction.
+   * Makes the ids of the transactions begun go on from txn_id, past those of the log that recovery read, so that the
+   * losers it rolls back while the new transactions run keep ids of their own, older than theirs.
+   */
+  void SetNextTxnId(txn_id_t txn_id) { next_txn_id_ = txn_id; }
+
+  /** The length of an epoch of the commit TIDs of the OPTIMISTIC transactions */
+  static constexpr std::chrono::milliseconds EPOCH_LENGTH{40};
+
+  /**
+   * Commits a transaction. An OPTIMISTIC transaction that fails validation, or has an update that no longer fits the
+   * page of its tuple, is aborted instead, and a TransactionAbortException thrown.
+   *
+   * With logging enabled, the locks are released as soon as the commit record is appended to the log buffer, and the
+   * call returns once that record, and the commit record of any transaction whose locks this one may have taken
+   * before they were durable, is persistent; an asynchronous-commit transaction returns right away instead, and is
+   * durable within async_commit_delay.
    * @param txn the transaction to commit
    */
   void Commit(Transaction *txn);
@@ -55,23 +87,24 @@ class TransactionManager {
   void Abort(Transaction *txn);
 
   /**
-   * Global list of running transactions
+   * Hands a transaction that committed or aborted back, for Begin to reuse. Whoever began the transaction may call
+   * this instead of deleting it, and must not use it afterwards.
+   * @param txn the transaction that ended
    */
+  void Release(Transaction *txn);
+
+  /** The most transactions kept for reuse; the ones released beyond it are deleted */
+  static constexpr size_t MAX_POOLED_TRANSACTIONS = 1024;
 
-  /** The transaction map is a global list of all the running transactions in the system. */
-  static std::unordered_map<txn_id_t, Transaction *> txn_map;
+  /** The registry of all the running transactions in the system. */
+  static TransactionRegistry txn_registry;
 
   /**
    * Locates and returns the transaction with the given transaction ID.
-   * @param txn_id the id of the transaction to be found, it must exist!
-   * @return the transaction with the given transaction id
+   * @param txn_id the id of the transaction to be found
+   * @return the transaction with the given transaction id, nullptr if it is not running
    */
-  static Transaction *GetTransaction(txn_id_t txn_id) {
-    assert(TransactionManager::txn_map.find(txn_id) != TransactionManager::txn_map.end());
-    auto *res = TransactionManager::txn_map[txn_id];
-    assert(res != nullptr);
-    return res;
-  }
+  static Transaction *GetTransaction(txn_id_t txn_id) { return txn_registry.Find(txn_id); }
 
   /** Prevents all transactions from performing operations, used for checkpointing. */
   void BlockAllTransactions();
@@ -79,30 +112,87 @@ class TransactionManager {
   /** Resumes all transactions, used for checkpointing. */
   void ResumeTransactions();
 
+  /**
+   * @return the active transaction table of a fuzzy checkpoint: the transactions running, with the LSNs of their last
+   * log records, which does not wait for them
+   */
+  static std::vector<std::pair<txn_id_t, lsn_t>> GetActiveTransactionTable();
+
+  /** @return the LSN of the first record of the oldest running transaction that wrote one, INVALID_LSN if none did */
+  static lsn_t GetOldestActiveLSN();
+
+  /** @return the oldest read timestamp of the transactions running, or that of the last commit if none are */
+  timestamp_t GetWatermark();
+
+  /** @return the latencies of the commits, up to their acknowledgement; the ones that abort are not recorded */
+  LatencySnapshot GetCommitLatency() const { return commit_latency_.Snapshot(); }
+
  private:
   /**
    * Releases all the locks held by the given transaction.
    * @param txn the transaction whose locks should be released
    */
   void ReleaseLocks(Transaction *txn) {
-    std::unordered_set<RID> lock_set;
-    for (auto item : *txn->GetExclusiveLockSet()) {
-      lock_set.emplace(item);
+    // Unlock takes each lock out of the sets, which are not copied so that the commit allocates nothing
+    while (!txn->GetExclusiveLockSet()->empty()) {
+      RID rid = *txn->GetExclusiveLockSet()->begin();
+      lock_manager_->Unlock(txn, rid);
     }
-    for (auto item : *txn->GetSharedLockSet()) {
-      lock_set.emplace(item);
+    while (!txn->GetSharedLockSet()->empty()) {
+      RID rid = *txn->GetSharedLockSet()->begin();
+      lock_manager_->Unlock(txn, rid);
     }
-    for (auto locked_rid : lock_set) {
-      lock_manager_->Unlock(txn, locked_rid);
+    // the tables are let go of after their records, which their intention locks are for
+    while (!txn->GetTableLockSet()->empty()) {
+      table_oid_t oid = txn->GetTableLockSet()->begin()->first;
+      lock_manager_->UnlockTable(txn, oid);
     }
   }
 
+  /** @return a transaction released before, reset to a new id, or a new one if there is none */
+  Transaction *Allocate(IsolationLevel isolation_level);
+
+  /** Takes a read timestamp out of the active ones, under ts_latch_, keeping a node for the next Begin */
+  void DropReadTs(timestamp_t read_ts);
+
+  /**
+   * Validates an OPTIMISTIC transaction and installs its writes.
+   * @return false if it did not commit, and is to be aborted
+   */
+  bool CommitOptimistic(Transaction *txn);
+
+  /** @return the epoch of the clock now */
+  static uint64_t CurrentEpoch();
+
+  /** @return the watermark, under ts_latch_ */
+  timestamp_t Watermark() const { return active_read_ts_.empty() ? last_commit_ts_ : *active_read_ts_.begin(); }
+
+  /** Tells the observers of the tables the transaction wrote to what it wrote to them, as it commits or aborts */
+  static void NotifyWriteObservers(Transaction *txn, bool commit);
+
+  /** Bumps the modification counts of the tables the transaction wrote to, as it commits or aborts */
+  static void BumpModificationCounts(Transaction *txn);
+
+  /** Drops the versions the transactions running no longer reach from the tables the transaction wrote */
+  void CollectVersions(const std::unordered_set<TableHeap *> &tables);
+
   std::atomic<txn_id_t> next_txn_id_{0};
+  /** The LSN of the last commit record appended, which a transaction that logged nothing waits for as it commits */
+  std::atomic<lsn_t> last_commit_lsn_{INVALID_LSN};
+  /** Hands out the timestamps, and keeps the read timestamps of the transactions running */
+  std::mutex ts_latch_;
+  timestamp_t last_commit_ts_{0};
+  std::multiset<timestamp_t> active_read_ts_;
+  std::multiset<timestamp_t>::node_type free_read_ts_;
+  /** The transactions released for reuse */
+  std::mutex pool_latch_;
+  std::vector<Transaction *> free_txns_;
   LockManager *lock_manager_ __attribute__((__unused__));
   LogManager *log_manager_ __attribute__((__unused__));
 
   /** The global transaction latch is used for checkpointing. */
-  ReaderWriterLatch global_txn_latch_;
+  ReaderWriterLatch global_txn_latch_{"transaction_manager.global_txn_latch"};
+  LatencyHistogram commit_latency_;
 };
 
 }  // namespace bustub
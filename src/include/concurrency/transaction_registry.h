@@ -0,0 +1,80 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// transaction_registry.h
+//
+// Identification: src/include/concurrency/transaction_registry.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <array>
+#include <functional>
+#include <mutex>  // NOLINT
+#include <unordered_map>
+
+#include "common/config.h"
+#include "common/macros.h"
+
+namespace bustub {
+
+class Transaction;
+
+/**
+ * TransactionRegistry maps the ids of the running transactions to the transactions. It is split into NUM_SHARDS
+ * shards by the id, each with a latch of its own, so that transactions that begin and end on different threads, and
+ * the lookups of the deadlock handling and the recovery, do not wait on one another. A transaction is in the registry
+ * from when it begins until it commits or aborts, so that it holds only the transactions running.
+ *
+ * The registry does not own the transactions: whoever began one deletes or releases it once it ended, so that a
+ * transaction found in the registry may be used only while it is known to be running, e.g. while it waits for a lock.
+ */
+class TransactionRegistry {
+ public:
+  TransactionRegistry() = default;
+
+  DISALLOW_COPY_AND_MOVE(TransactionRegistry);
+
+  ~TransactionRegistry() = default;
+
+  /** Adds a transaction that begins */
+  void Register(Transaction *txn);
+
+  /** Removes the transaction with the id, as it ends */
+  void Unregister(txn_id_t txn_id);
+
+  /** @return the running transaction with the id, nullptr if there is none */
+  Transaction *Find(txn_id_t txn_id) const;
+
+  /** @return the number of transactions running */
+  size_t Size() const;
+
+  /** Calls visit on each running transaction, under the latch of its shard, one shard at a time */
+  void ForEach(const std::function<void(Transaction *)> &visit) const;
+
+  /** The number of shards the registry is split into */
+  static constexpr size_t NUM_SHARDS = 64;
+
+ private:
+  /**
+   * A part of the registry, of the ids that map to it, and the latch that guards it. The node of the last transaction
+   * that ended is kept for the next one to begin, so that a transaction that begins as another ends allocates none.
+   */
+  struct Shard {
+    mutable std::mutex latch_;
+    std::unordered_map<txn_id_t, Transaction *> txns_;
+    std::unordered_map<txn_id_t, Transaction *>::node_type free_node_;
+  };
+
+  /** @return the shard of the registry that an id is in; the ids are handed out in turn, so they spread evenly */
+  Shard &ShardOf(txn_id_t txn_id) { return shards_[static_cast<size_t>(txn_id) % NUM_SHARDS]; }
+  const Shard &ShardOf(txn_id_t txn_id) const { return shards_[static_cast<size_t>(txn_id) % NUM_SHARDS]; }
+
+  std::array<Shard, NUM_SHARDS> shards_;
+};
+
+}  // namespace bustub
@@ -0,0 +1,280 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// adaptive_radix_tree.h
+//
+// Identification: src/include/container/art/adaptive_radix_tree.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>  // NOLINT
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace bustub {
+
+/**
+ * An adaptive radix tree (Leis et al., ICDE 2013) that lives in memory only. Keys are byte strings, and values are
+ * found by walking the tree a byte at a time. Inner nodes come in four sizes (4, 16, 48 and 256 children) and grow and
+ * shrink with the number of their children; a chain of inner nodes with a single child each is collapsed into a
+ * prefix of the node below it.
+ *
+ * All keys of a tree have the same length, so no key is a prefix of another; normalized GenericKeys are a natural fit.
+ *
+ * Concurrency control is optimistic lock coupling (Leis et al., DaMoN 2016): every node has a version that writers
+ * bump, readers never write to shared memory and restart if a version they read has changed, and writers lock only
+ * the (at most two) nodes they change. Nodes that are replaced or removed are retired and freed by an epoch scheme
+ * once no operation that could still be reading them is running.
+ */
+template <typename ValueType>
+class AdaptiveRadixTree {
+ public:
+  /**
+   * Creates a new, empty AdaptiveRadixTree.
+   * @param key_size the length in bytes of every key of the tree
+   */
+  explicit AdaptiveRadixTree(uint32_t key_size);
+
+  ~AdaptiveRadixTree();
+
+  AdaptiveRadixTree(const AdaptiveRadixTree &) = delete;
+  AdaptiveRadixTree &operator=(const AdaptiveRadixTree &) = delete;
+
+  /**
+   * Inserts a key-value pair into the tree.
+   * @param key the key to insert
+   * @param value the value to be associated with the key
+   * @return true if insert succeeded, false if the key is in the tree already or not of the tree's key size
+   */
+  bool Insert(const std::string &key, const ValueType &value);
+
+  /**
+   * Removes a key and its value.
+   * @param key the key to remove
+   * @return true if the key was in the tree
+   */
+  bool Remove(const std::string &key);
+
+  /**
+   * Performs a point query on the tree.
+   * @param key the key to look up
+   * @param[out] value the value of the key
+   * @return true if the key was found
+   */
+  bool GetValue(const std::string &key, ValueType *value);
+
+  /**
+   * Collects the values of all keys that start with a prefix, in key order.
+   * @param prefix the prefix the keys start with
+   * @param[out] result the values are appended here
+   * @return true if at least one value was found
+   */
+  bool ScanPrefix(const std::string &prefix, std::vector<ValueType> *result);
+
+  /**
+   * @return the number of keys in the tree
+   */
+  size_t Size() const { return size_.load(); }
+
+ private:
+  enum class NodeType : uint8_t { N4, N16, N48, N256 };
+
+  // only that many bytes of a node's prefix are stored in the node; longer prefixes are checked against a leaf below it
+  static constexpr uint32_t MAX_STORED_PREFIX = 8;
+
+  // bit 1 of a version is the lock, bit 0 marks a node that has been replaced or removed
+  static constexpr uint64_t LOCKED_BIT = 0b10;
+  static constexpr uint64_t OBSOLETE_BIT = 0b01;
+
+  struct Leaf {
+    std::string key_;
+    ValueType value_;
+  };
+
+  struct Node {
+    explicit Node(NodeType type) : type_(type) {}
+
+    /** Waits for the node to be unlocked. @return its version, or sets restart if it is obsolete */
+    uint64_t ReadLockOrRestart(bool *restart) const;
+
+    /** Sets restart if the node changed since version was read */
+    void CheckOrRestart(uint64_t version, bool *restart) const { *restart = *restart || version != version_.load(); }
+
+    /** Locks the node if it has not changed since version was read, and sets restart otherwise */
+    void UpgradeToWriteLockOrRestart(uint64_t *version, bool *restart);
+
+    /** Locks the node the way UpgradeToWriteLockOrRestart does, whatever version it is at */
+    void WriteLockOrRestart(bool *restart);
+
+    void WriteUnlock() { version_.fetch_add(LOCKED_BIT); }
+
+    /** Unlocks the node and marks it obsolete, so that readers that still hold it restart */
+    void WriteUnlockObsolete() { version_.fetch_add(LOCKED_BIT | OBSOLETE_BIT); }
+
+    /** Copies the first length bytes of a prefix into the node */
+    void SetPrefix(const uint8_t *prefix, uint32_t length);
+
+    /** Prepends the prefix of parent and the key byte that led from parent to the node to the node's prefix */
+    void PrependPrefix(const Node *parent, uint8_t key_byte);
+
+    // starts unlocked and not obsolete, at a non-zero version
+    std::atomic<uint64_t> version_{0b100};
+    const NodeType type_;
+    uint16_t count_{0};
+    // the full length of the prefix; only the first MAX_STORED_PREFIX bytes of it are in prefix_
+    uint32_t prefix_length_{0};
+    uint8_t prefix_[MAX_STORED_PREFIX]{};
+  };
+
+  struct Node4 : Node {
+    Node4() : Node(NodeType::N4) {}
+    // sorted
+    uint8_t keys_[4]{};
+    Node *children_[4]{};
+  };
+
+  struct Node16 : Node {
+    Node16() : Node(NodeType::N16) {}
+    // sorted
+    uint8_t keys_[16]{};
+    Node *children_[16]{};
+  };
+
+  struct Node48 : Node {
+    static constexpr uint8_t EMPTY = 48;
+    Node48() : Node(NodeType::N48) {
+      for (auto &index : child_index_) {
+        index = EMPTY;
+      }
+    }
+    // the slot in children_ of the child for each key byte, EMPTY if there is none
+    uint8_t child_index_[256];
+    Node *children_[48]{};
+  };
+
+  struct Node256 : Node {
+    Node256() : Node(NodeType::N256) {}
+    Node *children_[256]{};
+  };
+
+  // Leaves are not Nodes; the pointers to them are tagged in their lowest bit
+  static bool IsLeaf(const Node *node) { return (reinterpret_cast<uintptr_t>(node) & 1) != 0; }
+  static Leaf *AsLeaf(const Node *node) { return reinterpret_cast<Leaf *>(reinterpret_cast<uintptr_t>(node) & ~1ULL); }
+  static Node *AsChild(Leaf *leaf) { return reinterpret_cast<Node *>(reinterpret_cast<uintptr_t>(leaf) | 1); }
+
+  /** @return the child of the node for the key byte, nullptr if there is none */
+  static Node *GetChild(const Node *node, uint8_t key_byte);
+
+  /** Collects the children of the node and their key bytes, in key order */
+  static void GetChildren(const Node *node, std::vector<std::pair<uint8_t, Node *>> *children);
+
+  /** @return any child of the node, nullptr if it has none */
+  static Node *AnyChild(const Node *node);
+
+  /** @return true if the node is full */
+  static bool IsFull(const Node *node);
+
+  /** @return true if removing a child should shrink the node to the next smaller type */
+  static bool IsUnderfull(const Node *node);
+
+  /** Adds a child to a node that is not full */
+  static void AddChild(Node *node, uint8_t key_byte, Node *child);
+
+  /** Replaces the child of the node for the key byte */
+  static void ChangeChild(Node *node, uint8_t key_byte, Node *child);
+
+  /** Removes the child of the node for the key byte */
+  static void RemoveChild(Node *node, uint8_t key_byte);
+
+  /** @return a copy of the node of the next larger type, or of the next smaller type if grow is false */
+  static Node *Resize(const Node *node, bool grow);
+
+  /** @return the other child of a Node4 with two children, and its key byte */
+  static std::pair<Node *, uint8_t> GetSecondChild(const Node *node, uint8_t key_byte);
+
+  /** Deletes a node or leaf, without its children */
+  static void FreeNode(Node *node);
+
+  /** Deletes a node and everything below it */
+  static void FreeTree(Node *node);
+
+  /**
+   * @return a leaf below the node, for the bytes of its prefix that are not stored in it, or nullptr with restart set
+   */
+  static Leaf *AnyLeaf(const Node *node, bool *restart);
+
+  /**
+   * Checks the stored bytes of the node's prefix against the key, skipping the rest of the prefix. The caller checks
+   * the full key against the leaf it ends at.
+   * @param[in,out] level the position in key of the prefix, advanced past it
+   * @return false if the prefix does not match, or leaves no byte of the key to look up the next child by
+   */
+  static bool CheckPrefix(const Node *node, const std::string &key, uint32_t *level);
+
+  /**
+   * Checks the full prefix of the node against the key, reading the bytes that are not stored in it from a leaf.
+   * @param[in,out] level the position in key of the prefix, advanced up to the first mismatching byte
+   * @param[out] mismatch_byte the byte of the prefix that does not match the key
+   * @param[out] remaining_prefix the bytes of the prefix after mismatch_byte
+   * @return false if the prefix does not match; restart is set if a leaf could not be read
+   */
+  static bool CheckPrefixPessimistic(const Node *node, const std::string &key, uint32_t *level, uint8_t *mismatch_byte,
+                                     uint8_t *remaining_prefix, bool *restart);
+
+  // A Try* operation runs a single attempt of the public operation of its name. It sets restart if it ran into a node
+  // that changed under it and has to start over, in which case nothing has changed and its result is meaningless.
+  bool TryInsert(const std::string &key, Node *leaf, bool *restart);
+  bool TryRemove(const std::string &key, bool *restart);
+  bool TryGetValue(const std::string &key, ValueType *value, bool *restart);
+  void TryScanPrefix(const std::string &prefix, std::vector<ValueType> *result, bool *restart);
+
+  /**
+   * Adds a leaf below node, growing it into a copy of the next larger type if it is full. The node is read locked
+   * at version, its parent at parent_version.
+   */
+  void InsertAndUnlock(Node *node, uint64_t version, Node *parent, uint64_t parent_version, uint8_t parent_key,
+                       uint8_t key_byte, Node *leaf, bool *restart);
+
+  /**
+   * Removes the child for key_byte from the node, shrinking it into a copy of the next smaller type if it is
+   * underfull. The node is read locked at version, its parent at parent_version.
+   */
+  void RemoveAndUnlock(Node *node, uint64_t version, Node *parent, uint64_t parent_version, uint8_t parent_key,
+                       uint8_t key_byte, bool *restart);
+
+  /**
+   * Collects the values of all leaves below the node that start with prefix. The node is read locked at version.
+   */
+  void Collect(const Node *node, uint64_t version, const std::string &prefix, std::vector<ValueType> *result,
+               bool *restart);
+
+  /** Registers an operation in the current epoch. @return the epoch to pass to ExitEpoch */
+  uint64_t EnterEpoch();
+
+  void ExitEpoch(uint64_t epoch) { active_[epoch & 1].fetch_sub(1); }
+
+  /** Frees the node or leaf once no operation that could still be reading it is running */
+  void Retire(Node *node);
+
+  // the root is a Node256 without a prefix, so it never grows, shrinks or gets replaced
+  Node *root_;
+  const uint32_t key_size_;
+  std::atomic<size_t> size_{0};
+
+  // Operations run in the current epoch or the one before; active_ counts them by the parity of their epoch. A node
+  // retired in epoch e can be freed once the epoch has advanced to e + 2.
+  std::atomic<uint64_t> epoch_{0};
+  std::atomic<uint64_t> active_[2]{};
+  std::mutex retired_latch_;
+  std::vector<std::pair<uint64_t, Node *>> retired_;
+};
+
+}  // namespace bustub
@@ -0,0 +1,92 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// roaring_bitmap.h
+//
+// Identification: src/include/container/bitmap/roaring_bitmap.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace bustub {
+
+/**
+ * A compressed bitmap of 64-bit values, after Roaring (Chambi et al., SPE 2016). The values are split by their high
+ * 48 bits into chunks of 2^16, and each chunk that has any value keeps its low 16 bits in a container of its own: a
+ * sorted array while it holds up to ARRAY_MAX_SIZE values, and a plain bitmap of 2^16 bits beyond that, which is
+ * smaller then. Sparse chunks thus take two bytes a value and dense ones a bit, and intersections and unions go a
+ * container at a time, by merging arrays, probing a bitmap with an array, or combining bitmaps a word at a time.
+ *
+ * The values come out in ascending order. The bitmap is not thread-safe.
+ */
+class RoaringBitmap {
+ public:
+  /** The most values an array container holds; the array would be larger than a bitmap past it */
+  static constexpr uint32_t ARRAY_MAX_SIZE = 4096;
+
+  RoaringBitmap() = default;
+
+  /** Adds a value. @return false if the bitmap had it already */
+  bool Add(uint64_t value);
+
+  /** Removes a value. @return false if the bitmap did not have it */
+  bool Remove(uint64_t value);
+
+  /** @return true if the bitmap has the value */
+  bool Contains(uint64_t value) const;
+
+  /** @return the number of values in the bitmap */
+  uint64_t Cardinality() const;
+
+  bool IsEmpty() const { return containers_.empty(); }
+
+  /** Keeps just the values that the other bitmap has too. */
+  void IntersectWith(const RoaringBitmap &other);
+
+  /** Adds all the values of the other bitmap. */
+  void UnionWith(const RoaringBitmap &other);
+
+  /** @return the values of the bitmap, in ascending order */
+  std::vector<uint64_t> ToVector() const;
+
+  /** @return the bytes the containers take, for comparing the size of the bitmap with that of its values */
+  size_t GetMemoryUsage() const;
+
+ private:
+  /** The low 16 bits of the values of a chunk: array_ is sorted, or else bits_ has BITMAP_WORDS words */
+  struct Container {
+    std::vector<uint16_t> array_;
+    std::vector<uint64_t> bits_;
+    uint32_t cardinality_{0};
+
+    bool IsBitmap() const { return !bits_.empty(); }
+  };
+
+  static constexpr uint32_t BITMAP_WORDS = (1U << 16) / 64;
+
+  static uint64_t HighOf(uint64_t value) { return value >> 16; }
+  static uint16_t LowOf(uint64_t value) { return static_cast<uint16_t>(value); }
+
+  /** @return the index of the first container of a chunk at or after high */
+  size_t LowerBound(uint64_t high) const;
+
+  /** Turns an array container into a bitmap one, or the other way around, whichever its cardinality calls for. */
+  static void Normalize(Container *container);
+
+  static Container Intersect(const Container &lhs, const Container &rhs);
+  static Container Union(const Container &lhs, const Container &rhs);
+
+  /** The containers of the chunks that have values, by the high bits of the chunk, in ascending order */
+  std::vector<std::pair<uint64_t, Container>> containers_;
+};
+
+}  // namespace bustub
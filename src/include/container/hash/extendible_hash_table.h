@@ -0,0 +1,154 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// extendible_hash_table.h
+//
+// Identification: src/include/container/hash/extendible_hash_table.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "concurrency/transaction.h"
+#include "container/hash/hash_function.h"
+#include "container/hash/hash_table.h"
+#include "storage/index/generic_key.h"
+#include "storage/page/hash_table_bucket_page.h"
+#include "storage/page/hash_table_directory_page.h"
+#include "storage/page/hash_table_page_defs.h"
+
+namespace bustub {
+
+#define EXTENDIBLE_HASH_TABLE_TYPE ExtendibleHashTable<KeyType, ValueType, KeyComparator>
+
+/**
+ * Implementation of extendible hashing that is backed by a buffer pool
+ * manager. Non-unique keys are supported. Supports insert and delete. The
+ * table grows by splitting the bucket that overflows, and doubles its
+ * directory when that bucket is as deep as the directory. Buckets that
+ * become empty are merged with their split image, and the directory halves
+ * again once no bucket needs all of its bits.
+ *
+ * Unlike LinearProbeHashTable, growing never rehashes more than one bucket,
+ * so no insert waits for the whole table to be migrated.
+ */
+template <typename KeyType, typename ValueType, typename KeyComparator>
+class ExtendibleHashTable : public HashTable<KeyType, ValueType, KeyComparator> {
+ public:
+  /**
+   * Creates a new ExtendibleHashTable with a single, empty bucket.
+   *
+   * @param name the name of the table
+   * @param buffer_pool_manager buffer pool manager to be used
+   * @param comparator comparator for keys
+   * @param hash_fn the hash function
+   */
+  explicit ExtendibleHashTable(const std::string &name, BufferPoolManager *buffer_pool_manager,
+                               const KeyComparator &comparator, HashFunction<KeyType> hash_fn);
+
+  /**
+   * Inserts a key-value pair into the hash table.
+   * @param transaction the current transaction
+   * @param key the key to create
+   * @param value the value to be associated with the key
+   * @return true if insert succeeded, false if the pair is there already or its bucket cannot be split any further
+   */
+  bool Insert(Transaction *transaction, const KeyType &key, const ValueType &value) override;
+
+  /**
+   * Deletes the associated value for the given key.
+   * @param transaction the current transaction
+   * @param key the key to delete
+   * @param value the value to delete
+   * @return true if remove succeeded, false otherwise
+   */
+  bool Remove(Transaction *transaction, const KeyType &key, const ValueType &value) override;
+
+  /**
+   * Performs a point query on the hash table.
+   * @param transaction the current transaction
+   * @param key the key to look up
+   * @param[out] result the value(s) associated with a given key
+   * @return the value(s) associated with the given key
+   */
+  bool GetValue(Transaction *transaction, const KeyType &key, std::vector<ValueType> *result) override;
+
+  /**
+   * Looks many keys up at once, e.g. the probes of an index join. The keys go in groups of PROBE_GROUP_SIZE: the
+   * bucket pages the keys of a group map to are prefetched together, then the keys are looked up one by one as
+   * GetValue does, so that the reads of the group overlap rather than every lookup waiting for its own.
+   * @param transaction the current transaction
+   * @param keys the keys to look up
+   * @param[out] results the values of each key, in the order of the keys, appended to
+   */
+  void GetValues(Transaction *transaction, const std::vector<KeyType> &keys,
+                 std::vector<std::vector<ValueType>> *results);
+
+  /**
+   * @return the global depth of the directory
+   */
+  uint32_t GetGlobalDepth();
+
+  /**
+   * Checks that the directory is consistent: every bucket is as deep as the directory or shallower, and exactly the
+   * 2^(GlobalDepth - LocalDepth) entries that agree in the bucket's low LocalDepth bits point to it. Aborts if not.
+   */
+  void VerifyIntegrity();
+
+ private:
+  /** @return the low 32 bits of the key's hash, the bits the directory is indexed by */
+  uint32_t Hash(const KeyType &key);
+
+  /** @return the directory index of the key */
+  uint32_t KeyToDirectoryIndex(const KeyType &key) { return Hash(key) & directory_page_->GetGlobalDepthMask(); }
+
+  /** The keys GetValues prefetches the bucket pages of at once. */
+  static constexpr size_t PROBE_GROUP_SIZE = 8;
+
+  /** The optimistic reads GetValue tries before it falls back to the latches */
+  static constexpr int MAX_OPTIMISTIC_READS = 8;
+
+  /**
+   * Looks a key up without latching, validating the versions of the directory and the bucket instead.
+   * @return false if a writer got in the way, in which case result is left as it was
+   */
+  bool TryOptimisticGetValue(const KeyType &key, std::vector<ValueType> *result);
+
+  /**
+   * Inserts a pair, splitting its bucket for as long as it is full. The caller holds table_latch_ exclusively, and the
+   * write latch of the directory.
+   * @return true if the pair was inserted
+   */
+  bool SplitInsert(const KeyType &key, const ValueType &value);
+
+  /**
+   * Merges the bucket of the key with its split image for as long as one of the two is empty, then shrinks the
+   * directory as far as it goes. The caller holds table_latch_ exclusively, and the write latch of the directory.
+   * @param key a key of the bucket that became empty
+   */
+  void Merge(const KeyType &key);
+
+  // the directory stays pinned for the lifetime of the table; it is changed under the write latch of its frame as well
+  // as under table_latch_, so that lookups can read it optimistically
+  page_id_t directory_page_id_;
+  Page *directory_frame_;
+  HashTableDirectoryPage *directory_page_;
+  BufferPoolManager *buffer_pool_manager_;
+  KeyComparator comparator_;
+
+  // Readers are the lookups that fall back to latching, and inserts and removes that fit into their bucket; writers
+  // split or merge buckets
+  ReaderWriterLatch table_latch_{"hash_table.table_latch"};
+
+  // Hash function
+  HashFunction<KeyType> hash_fn_;
+};
+
+}  // namespace bustub
@@ -12,8 +12,12 @@
 
 #pragma once
 
+#include <array>
+#include <atomic>
+#include <mutex>  // NOLINT
 #include <queue>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "buffer/buffer_pool_manager.h"
@@ -32,6 +36,22 @@ namespace bustub {
  * Implementation of linear probing hash table that is backed by a buffer pool
  * manager. Non-unique keys are supported. Supports insert and delete. The
  * table dynamically grows once full.
+ *
+ * The slots of all block pages form one array: a key hashes to a slot of it,
+ * and probing goes on into the next block page, wrapping around from the last
+ * block page to the first, until it reaches a slot that was never occupied.
+ *
+ * The table grows incrementally. Growing allocates a new generation, a header
+ * page and block pages with twice the slots, and every insert then migrates
+ * the pairs of a few block pages of the old generation into the new one, until
+ * the old generation is empty and is deleted. Meanwhile lookups and removes
+ * look into both generations.
+ *
+ * Lookups, inserts and removes share the table latch; they latch one block
+ * page at a time, for reading while they probe and for writing while they
+ * change a slot. Inserts of the same key also take the same insert latch, so
+ * that they do not both find the pair missing. Growing and migrating take the
+ * table latch exclusively.
  */
 template <typename KeyType, typename ValueType, typename KeyComparator>
 class LinearProbeHashTable : public HashTable<KeyType, ValueType, KeyComparator> {
@@ -75,26 +95,136 @@ class LinearProbeHashTable : public HashTable<KeyType, ValueType, KeyComparator>
   bool GetValue(Transaction *transaction, const KeyType &key, std::vector<ValueType> *result) override;
 
   /**
-   * Resizes the table to at least twice the initial size provided.
+   * Looks many keys up at once, e.g. the probes of an index join. The keys are hashed first, then go in batches of
+   * PROBE_BATCH_SIZE, sorted by the block page their runs start in: the block pages of a batch are prefetched together,
+   * so that their reads overlap, and each is pinned and latched once for all the keys of the batch that start in it,
+   * rather than once per key. The keys whose runs go on into the next block page are probed again on their own.
+   * @param transaction the current transaction
+   * @param keys the keys to look up
+   * @param[out] results the values of each key, in the order of the keys, appended to
+   */
+  void GetValues(Transaction *transaction, const std::vector<KeyType> &keys,
+                 std::vector<std::vector<ValueType>> *results);
+
+  /**
+   * Inserts many pairs at once, e.g. to build an index over a table that has tuples already. The table first grows
+   * to hold them all, then the pairs are placed in the order of their slots, so that every block page is latched and
+   * written about once rather than once per pair. Pairs that are in the table already, or come twice, are skipped.
+   * @param transaction the current transaction
+   * @param pairs the pairs to insert, in any order
+   * @return the number of pairs inserted
+   */
+  size_t BulkInsert(Transaction *transaction, const std::vector<std::pair<KeyType, ValueType>> &pairs);
+
+  /**
+   * Resizes the table to at least twice the initial size provided. The pairs are migrated by later inserts.
    * @param initial_size the initial size of the hash table
    */
   void Resize(size_t initial_size);
 
   /**
    * Gets the size of the hash table
-   * @return current size of the hash table
+   * @return current size of the hash table, i.e. the number of slots
    */
   size_t GetSize();
 
  private:
+  /** The keys GetValues probes under one hold of the table latch, and prefetches the block pages of at once. */
+  static constexpr size_t PROBE_BATCH_SIZE = 256;
+
+  /** What InsertInto did. */
+  enum class InsertResult { INSERTED, DUPLICATE, FULL };
+
+  /**
+   * Creates the header page and block pages of a generation.
+   * @param num_blocks the number of block pages
+   * @param[out] header_page_id the id of the header page, which stays pinned
+   * @return the header page
+   */
+  HashTableHeaderPage *NewGeneration(size_t num_blocks, page_id_t *header_page_id);
+
+  /** @return the hash of a key as block pages store it with the pair; the slot of the key is this modulo the size */
+  uint32_t Hash(const KeyType &key) { return static_cast<uint32_t>(hash_fn_.GetHash(key)); }
+
+  /**
+   * Visits the pairs of the run of a hash whose tag matches the hash's, in probe order.
+   * @param header_page the header page of the generation to probe
+   * @param hash the hash of the key whose run to probe
+   * @param visit called with each block page and slot in it, until it returns true
+   * @param[in,out] first_tombstone if not nullptr and the size of the generation, set to the first tombstone of the
+   * run, if it has one before visit stops the probe
+   * @return the first slot past the run, which was never occupied; the size of the generation if the run covers all
+   * of it or visit stopped the probe
+   */
+  template <typename Visit>
+  size_t Probe(HashTableHeaderPage *header_page, uint32_t hash, Visit &&visit, size_t *first_tombstone = nullptr);
+
+  /**
+   * Visits the pairs of the run of a hash in one block page, as Probe does, from *slot on.
+   * @param tag the tag of the hash
+   * @param[in,out] slot the slot to start at, advanced past the slots probed
+   * @param[in,out] probed the slots of the run probed so far, advanced as slot is
+   * @param[out] end set as Probe returns it, if the probe is over
+   * @return true if the probe is over, as the run ended in the block page or visit stopped it; false if the run goes
+   * on in the next block page
+   */
+  template <typename Visit>
+  bool ProbeBlock(const HASH_TABLE_BLOCK_TYPE *block_page, uint8_t tag, size_t num_slots, size_t *slot,
+                  size_t *probed, Visit &&visit, size_t *first_tombstone, size_t *end);
+
+  /** Appends the values of the keys [begin, end) in the generation to their results, see GetValues. */
+  void ProbeBatch(HashTableHeaderPage *header_page, const std::vector<KeyType> &keys,
+                  const std::vector<uint32_t> &hashes, size_t begin, size_t end,
+                  std::vector<std::vector<ValueType>> *results);
+
+  /** @return the slot of the pair in the generation, its size if the pair is not there */
+  size_t FindPair(HashTableHeaderPage *header_page, const KeyType &key, const ValueType &value, uint32_t hash);
+
+  /** @return true if one more occupied slot would take the current generation past MAX_LOAD_FACTOR */
+  bool OverLoadFactor();
+
+  /**
+   * Inserts a pair into the current generation. The caller holds table_latch_ exclusively, or shared and the insert
+   * latch of the key.
+   */
+  InsertResult InsertInto(const KeyType &key, const ValueType &value, uint32_t hash);
+
+  /** @return true if the pair was in the generation and has been removed */
+  bool RemoveFrom(HashTableHeaderPage *header_page, const KeyType &key, const ValueType &value, uint32_t hash);
+
+  /**
+   * Starts growing the table, after finishing the growth in progress if there is one. The caller holds table_latch_
+   * exclusively.
+   * @param initial_size the table grows to at least twice this size, if the header page has room for that
+   */
+  void Grow(size_t initial_size);
+
+  /**
+   * Migrates the pairs of block pages of the old generation, deleting it once they all are. The caller holds
+   * table_latch_ exclusively.
+   * @param num_blocks the most block pages to migrate
+   */
+  void MigrateBlocks(size_t num_blocks);
+
   // member variable
   page_id_t header_page_id_;
   HashTableHeaderPage *header_page_;
+  // the generation being migrated from while the table grows, nullptr otherwise
+  page_id_t old_header_page_id_{INVALID_PAGE_ID};
+  HashTableHeaderPage *old_header_page_{nullptr};
+  // the block pages of the old generation migrated so far, in order
+  size_t num_migrated_blocks_{0};
+  // the slots of the current generation ever occupied, i.e. pairs and tombstones
+  std::atomic<size_t> num_occupied_{0};
   BufferPoolManager *buffer_pool_manager_;
   KeyComparator comparator_;
 
-  // Readers includes inserts and removes, writer is only resize
-  ReaderWriterLatch table_latch_;
+  // Readers are lookups, inserts and removes, writers grow the table or migrate pairs
+  ReaderWriterLatch table_latch_{"hash_table.table_latch"};
+
+  // Inserts take the latch their key hashes to
+  static constexpr size_t NUM_INSERT_LATCHES = 64;
+  std::array<std::mutex, NUM_INSERT_LATCHES> insert_latches_;
 
   // Hash function
   HashFunction<KeyType> hash_fn_;
@@ -0,0 +1,62 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// compiled_predicate.h
+//
+// Identification: src/include/execution/compiled_predicate.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <functional>
+#include <memory>
+#include <utility>
+
+#include "catalog/schema.h"
+#include "execution/expressions/abstract_expression.h"
+#include "storage/table/tuple.h"
+
+namespace bustub {
+
+/**
+ * CompiledPredicate is a predicate compiled into a closure over the bytes of the tuples of a table, in place of the
+ * virtual walk of its expression tree that Evaluate does, which makes a Value of every column and constant of it for
+ * every row. A comparison of two numeric operands, each a column or a constant, compiles into a single closure that
+ * the types of the columns, their offsets and the comparison are built into: it reads the columns out of the tuple
+ * with a memcpy, checks their bits of the null bitmap, and compares them as 64-bit integers, or as doubles if either
+ * of them is a DECIMAL, as the Value methods would. A conjunction of such comparisons compiles into a closure that
+ * runs theirs in turn, up to the first that does not hold.
+ *
+ * A predicate that is NULL for a tuple does not hold for it, as with EvaluateBatch. Compile returns nullptr for the
+ * predicates it does not cover, which the caller keeps to Evaluate for. The parameters of a prepared statement are
+ * compiled in as constants, so a predicate of them is compiled again for each run, e.g. in the Init of a scan.
+ */
+class CompiledPredicate {
+ public:
+  /** The closure, over a tuple of the schema */
+  using Function = std::function<bool(const Tuple &tuple)>;
+
+  /**
+   * @param predicate the predicate, whose columns are of tuple index 0
+   * @param schema the schema of the tuples it is to be evaluated on, in the layout they are stored in
+   * @return the compiled predicate, or nullptr if it is not one that compiles
+   */
+  static std::unique_ptr<CompiledPredicate> Compile(const AbstractExpression *predicate, const Schema *schema);
+
+  /** @return true if the predicate holds for the tuple, false if it does not or is NULL */
+  bool Evaluate(const Tuple &tuple) const { return function_(tuple); }
+
+  /** @return the closure, e.g. for a TablePageScanner to filter the tuples of its pages with */
+  const Function &GetFunction() const { return function_; }
+
+ private:
+  explicit CompiledPredicate(Function function) : function_(std::move(function)) {}
+
+  Function function_;
+};
+
+}  // namespace bustub
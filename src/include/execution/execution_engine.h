@@ -12,6 +12,10 @@
 
 #pragma once
 
+#include <chrono>  // NOLINT
+#include <memory>
+#include <optional>
+#include <utility>
 #include <vector>
 
 #include "buffer/buffer_pool_manager.h"
@@ -20,43 +24,134 @@
 #include "execution/executor_context.h"
 #include "execution/executor_factory.h"
 #include "execution/plans/abstract_plan.h"
+#include "execution/prepared_statement.h"
+#include "execution/query_profile.h"
+#include "execution/result_cache.h"
 #include "storage/table/tuple.h"
 namespace bustub {
+/**
+ * ExecutionEngine runs the executor tree of a plan on the calling thread, and hands its output to the caller as it
+ * comes: to a callback, once per row, or collected into a vector. The executors that are pipeline breakers run the
+ * pipelines below them on the PipelineScheduler, in their Init. Execute returns false if the query was cancelled
+ * through its ExecutorContext.
+ *
+ * A plan that is run many times is prepared instead, into a PreparedStatement that keeps its executor tree. A plan
+ * that is run with a QueryProfile has the rows, time, page fetches and spilled bytes of each of its nodes counted into
+ * it, for a report of where the time of the query went.
+ *
+ * With a ResultCache, set by EnableResultCache, a read-only plan that was run before against tables that have not
+ * changed since gets the rows of its last run back without being run again.
+ */
 class ExecutionEngine {
  public:
+  using ResultCallback = PreparedStatement::ResultCallback;
+
   ExecutionEngine(BufferPoolManager *bpm, TransactionManager *txn_mgr, Catalog *catalog)
       : bpm_(bpm), txn_mgr_(txn_mgr), catalog_(catalog) {}
 
   DISALLOW_COPY_AND_MOVE(ExecutionEngine);
 
+  /**
+   * Runs the plan, collecting its rows.
+   * @param[out] result_set the rows, nullptr if they are not kept
+   * @param[out] profile the profile to count the executors of the plan into, as EXPLAIN ANALYZE does; nullptr to run
+   * the plan without the instrumentation
+   */
   bool Execute(const AbstractPlanNode *plan, std::vector<Tuple> *result_set, Transaction *txn,
-               ExecutorContext *exec_ctx) {
-    // construct executor
-    auto executor = ExecutorFactory::CreateExecutor(exec_ctx, plan);
-
-    // prepare
-    executor->Init();
+               ExecutorContext *exec_ctx, QueryProfile *profile = nullptr) {
+    return ExecuteStreaming(plan, PreparedStatement::CollectInto(result_set), txn, exec_ctx, profile);
+  }
 
-    // execute
-    try {
-      Tuple tuple;
-      RID rid;
-      while (executor->Next(&tuple, &rid)) {
-        if (result_set != nullptr) {
-          result_set->push_back(tuple);
-        }
+  /**
+   * Runs the plan, streaming its rows into a callback as the executors produce them, so that the first row reaches
+   * the caller without waiting for the last, and the rows of a large result need not all be held at once.
+   * @param on_row the callback, which stops the query early when it returns false
+   * @param[out] profile the profile to count the executors of the plan into, nullptr if none
+   */
+  bool ExecuteStreaming(const AbstractPlanNode *plan, const ResultCallback &on_row, Transaction *txn,
+                        ExecutorContext *exec_ctx, QueryProfile *profile = nullptr) {
+    if (profile == nullptr && result_cache_ != nullptr) {
+      std::optional<ResultCache::CacheablePlan> cacheable = ResultCache::Fingerprint(plan, catalog_);
+      if (cacheable.has_value() && ResultCache::CanUse(txn, *cacheable)) {
+        return ExecuteCached(plan, *cacheable, on_row, exec_ctx);
       }
-    } catch (Exception &e) {
-      // TODO(student): handle exceptions
     }
+    if (profile == nullptr) {
+      auto executor = ExecutorFactory::CreateExecutor(exec_ctx, plan);
+      return PreparedStatement::Run(executor.get(), exec_ctx, on_row);
+    }
+    // the profile stays on for the run, as some executors make those of their children only as they run
+    auto start = std::chrono::steady_clock::now();
+    exec_ctx->SetProfile(profile);
+    profile->SetPlan(plan);
+    bool completed;
+    try {
+      auto executor = ExecutorFactory::CreateExecutor(exec_ctx, plan);
+      completed = PreparedStatement::Run(executor.get(), exec_ctx, on_row);
+    } catch (...) {
+      exec_ctx->SetProfile(nullptr);
+      throw;
+    }
+    exec_ctx->SetProfile(nullptr);
+    profile->SetTotalWallNs(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count());
+    return completed;
+  }
 
-    return true;
+  /**
+   * Builds the executor tree of a plan, to be run as a statement many times.
+   * @param plan the plan, which has to outlive the statement
+   * @param parameters the values its ParameterValueExpressions read, which the statement binds before each run;
+   * nullptr if it has none
+   * @param exec_ctx the context the statement runs in, which has to outlive it
+   */
+  std::unique_ptr<PreparedStatement> Prepare(const AbstractPlanNode *plan, std::vector<Value> *parameters,
+                                             ExecutorContext *exec_ctx) {
+    return std::make_unique<PreparedStatement>(exec_ctx, ExecutorFactory::CreateExecutor(exec_ctx, plan), parameters);
   }
 
+  /**
+   * Keeps the results of the read-only plans run from now on, for their runs again (see ResultCache).
+   * @param capacity the bytes of rows the cache holds at most
+   */
+  void EnableResultCache(size_t capacity) { result_cache_ = std::make_unique<ResultCache>(capacity); }
+
+  /** @return the result cache, nullptr if results are not cached */
+  ResultCache *GetResultCache() { return result_cache_.get(); }
+
  private:
+  /** Runs a plan that can be cached, from the cache if it has its result, and keeps the result otherwise. */
+  bool ExecuteCached(const AbstractPlanNode *plan, const ResultCache::CacheablePlan &cacheable,
+                     const ResultCallback &on_row, ExecutorContext *exec_ctx) {
+    std::vector<Tuple> rows;
+    if (result_cache_->Lookup(cacheable, &rows)) {
+      for (Tuple &row : rows) {
+        if (!on_row(row)) {
+          break;
+        }
+      }
+      return true;
+    }
+    // the counts before the run, so that a commit while it runs leaves the result stale
+    std::vector<uint64_t> versions = ResultCache::Versions(cacheable);
+    bool stopped = false;
+    auto executor = ExecutorFactory::CreateExecutor(exec_ctx, plan);
+    bool completed = PreparedStatement::Run(executor.get(), exec_ctx, [&](Tuple &tuple) {
+      // the cache outlives the query, and with it the arena the tuple may be in
+      rows.emplace_back().CopyFrom(tuple);
+      stopped = !on_row(tuple);
+      return !stopped;
+    });
+    if (completed && !stopped) {
+      result_cache_->Insert(cacheable, std::move(versions), std::move(rows));
+    }
+    return completed;
+  }
+
   [[maybe_unused]] BufferPoolManager *bpm_;
   [[maybe_unused]] TransactionManager *txn_mgr_;
-  [[maybe_unused]] Catalog *catalog_;
+  Catalog *catalog_;
+  std::unique_ptr<ResultCache> result_cache_;
 };
 
 }  // namespace bustub
@@ -12,17 +12,25 @@
 
 #pragma once
 
+#include <atomic>
 #include <unordered_set>
 #include <utility>
 #include <vector>
 
 #include "catalog/catalog.h"
+#include "common/memory_arena.h"
+#include "common/memory_tracker.h"
 #include "concurrency/transaction.h"
 #include "storage/page/tmp_tuple_page.h"
 
 namespace bustub {
+
+class MemoryManager;
+class QueryProfile;
+
 /**
- * ExecutorContext stores all the context necessary to run an executor.
+ * ExecutorContext stores all the context necessary to run an executor. It lives as long as the query, and so does the
+ * memory of its arena.
  */
 class ExecutorContext {
  public:
@@ -60,12 +68,95 @@ class ExecutorContext {
   /** @return the transaction manager */
   TransactionManager *GetTransactionManager() { return txn_mgr_; }
 
+  /** @return the arena for the tuples and values the query's executors produce, see MemoryArena */
+  MemoryArena *GetArena() { return &arena_; }
+
+  /**
+   * @return the tracker of the memory of the query, by category: what its MemoryReservations hold and the blocks of its
+   * arena, now and at their peak; all of it is accounted for in MemoryTracker::Global as well
+   */
+  MemoryTracker *GetMemoryTracker() { return &memory_tracker_; }
+
+  /** @return the bytes of tuples an executor of the query may hold in memory before it spills them to temp pages */
+  size_t GetMemoryBudget() const { return memory_budget_; }
+
+  /** @param memory_budget the bytes of tuples an executor of the query may hold before it spills them */
+  void SetMemoryBudget(size_t memory_budget) { memory_budget_ = memory_budget; }
+
+  /** @return the manager of the memory the query shares with the others running alongside, nullptr if none */
+  MemoryManager *GetMemoryManager() const { return memory_manager_; }
+
+  /**
+   * @param memory_manager the manager the MemoryReservations of the operators take their memory from, on top of the
+   * budget of each; nullptr for just the budget
+   */
+  void SetMemoryManager(MemoryManager *memory_manager) { memory_manager_ = memory_manager; }
+
+  /** @return the bytes the MemoryReservations of the query's operators hold now */
+  size_t GetMemoryUsage() const { return memory_usage_.load(std::memory_order_relaxed); }
+
+  /** @return the most bytes the MemoryReservations of the query's operators held at once */
+  size_t GetPeakMemoryUsage() const { return peak_memory_usage_.load(std::memory_order_relaxed); }
+
+  /** Accounts bytes granted to a MemoryReservation of the query, of a category; safe to call from any thread */
+  void ReserveMemory(MemoryCategory category, size_t bytes) {
+    memory_tracker_.Allocate(category, bytes);
+    size_t usage = memory_usage_.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+    size_t peak = peak_memory_usage_.load(std::memory_order_relaxed);
+    while (usage > peak && !peak_memory_usage_.compare_exchange_weak(peak, usage, std::memory_order_relaxed)) {
+    }
+  }
+
+  /** Accounts bytes given back by a MemoryReservation of the query, of a category */
+  void ReleaseMemory(MemoryCategory category, size_t bytes) {
+    memory_tracker_.Free(category, bytes);
+    memory_usage_.fetch_sub(bytes, std::memory_order_relaxed);
+  }
+
+  /** @return true if the pipelines of the query below its breakers may run push-based, as PushPipelines */
+  bool IsPushExecutionEnabled() const { return push_execution_; }
+
+  /** @param push_execution whether the pipelines below breakers may run as PushPipelines, or only as executors */
+  void SetPushExecution(bool push_execution) { push_execution_ = push_execution; }
+
+  /**
+   * Cancels the query; safe to call from any thread. The ExecutionEngine stops at the next tuple, and the workers of
+   * a pipeline at the next morsel they would claim.
+   */
+  void Cancel() { cancelled_.store(true, std::memory_order_relaxed); }
+
+  /** @return true if the query was cancelled */
+  bool IsCancelled() const { return cancelled_.load(std::memory_order_relaxed); }
+
+  /** @return the counter of the bytes of tuples the executors of the query spilled to temp pages */
+  std::atomic<uint64_t> *GetSpillCounter() { return &spilled_bytes_; }
+
+  /** @return the profile the executors of the query are counted into, nullptr if it is not profiled */
+  QueryProfile *GetProfile() const { return profile_; }
+
+  /**
+   * @param profile the profile to count the executors made from now on into, see ExecutorFactory; nullptr to make
+   * them without the instrumentation
+   */
+  void SetProfile(QueryProfile *profile) { profile_ = profile; }
+
  private:
   Transaction *transaction_;
   Catalog *catalog_;
   BufferPoolManager *bpm_;
   TransactionManager *txn_mgr_;
   LockManager *lock_mgr_;
+  /** Declared before the arena, which accounts for its blocks in it */
+  MemoryTracker memory_tracker_{MemoryTracker::Global()};
+  MemoryArena arena_{&memory_tracker_};
+  size_t memory_budget_{QUERY_MEMORY_BUDGET};
+  MemoryManager *memory_manager_{nullptr};
+  std::atomic<size_t> memory_usage_{0};
+  std::atomic<size_t> peak_memory_usage_{0};
+  bool push_execution_{true};
+  std::atomic<bool> cancelled_{false};
+  std::atomic<uint64_t> spilled_bytes_{0};
+  QueryProfile *profile_{nullptr};
 };
 
 }  // namespace bustub
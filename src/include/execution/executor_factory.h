@@ -19,7 +19,8 @@
 
 namespace bustub {
 /**
- * ExecutorFactory creates executors for arbitrary plan nodes.
+ * ExecutorFactory creates executors for arbitrary plan nodes. The executors of a query that is profiled (see
+ * ExecutorContext::SetProfile) are each wrapped in a ProfilingExecutor.
  */
 class ExecutorFactory {
  public:
@@ -30,5 +31,9 @@ class ExecutorFactory {
    * @return an executor for the given plan and context
    */
   static std::unique_ptr<AbstractExecutor> CreateExecutor(ExecutorContext *exec_ctx, const AbstractPlanNode *plan);
+
+ private:
+  /** @return the executor of the plan node, without the profiling */
+  static std::unique_ptr<AbstractExecutor> MakeExecutor(ExecutorContext *exec_ctx, const AbstractPlanNode *plan);
 };
 }  // namespace bustub
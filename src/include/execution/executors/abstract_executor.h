@@ -12,12 +12,19 @@
 
 #pragma once
 
+#include <memory>
+
 #include "execution/executor_context.h"
+#include "execution/vector/data_chunk.h"
 #include "storage/table/tuple.h"
 
 namespace bustub {
 /**
- * AbstractExecutor implements the Volcano tuple-at-a-time iterator model.
+ * AbstractExecutor implements the Volcano tuple-at-a-time iterator model, and a batch-at-a-time one next to it, in
+ * which a call hands out a DataChunk of rows instead of a single tuple, so that the virtual call and the interpretation
+ * of the plan are paid for once per DataChunk::DEFAULT_CAPACITY rows. Either is adapted to the other by default: the
+ * default NextBatch fills the chunk from Next, and NextFromBatch lets an executor's Next hand out the rows of its own
+ * batches. An executor is driven through one of the two, not both.
  */
 class AbstractExecutor {
  public:
@@ -44,13 +51,70 @@ class AbstractExecutor {
    */
   virtual bool Next(Tuple *tuple, RID *rid) = 0;
 
+  /**
+   * Produces the next batch of tuples from this executor, as the live rows of a chunk of its output schema. The rows
+   * carry no RIDs.
+   * @param[out] chunk a chunk of the output schema, which is reset first
+   * @return true if the chunk has a live row, false if there are no more tuples
+   */
+  virtual bool NextBatch(DataChunk *chunk) {
+    chunk->Reset();
+    Tuple tuple;
+    RID rid;
+    while (!chunk->IsFull() && Next(&tuple, &rid)) {
+      chunk->Append(tuple);
+    }
+    return chunk->GetSize() != 0;
+  }
+
   /** @return the schema of the tuples that this executor produces */
   virtual const Schema *GetOutputSchema() = 0;
 
+  /**
+   * Tells the executor, before its Init, that its parent takes no more than a number of its tuples, e.g. a limit, so
+   * that it can stop its work once it has made them: a scan stops reading its table, and a parallel hash join stops
+   * joining its partitions. An executor that makes a tuple of each tuple of its child, and of nothing else, passes the
+   * limit on to the child. The default ignores it.
+   * @param limit the most tuples the parent takes, which only ever narrows the limit of an earlier call
+   */
+  virtual void SetRowLimit(size_t /* limit */) {}
+
   /** @return the executor context in which this executor runs */
   ExecutorContext *GetExecutorContext() { return exec_ctx_; }
 
  protected:
+  /**
+   * Produces the next tuple from the batches of NextBatch, for an executor that works a batch at a time to override
+   * Next with; its Init has to call ResetBatchRows.
+   */
+  bool NextFromBatch(Tuple *tuple, RID *rid) {
+    if (row_batch_ == nullptr) {
+      row_batch_ = std::make_unique<DataChunk>(GetOutputSchema());
+    }
+    while (next_batch_row_ == row_batch_->GetSelectedCount()) {
+      next_batch_row_ = 0;
+      if (!NextBatch(row_batch_.get())) {
+        return false;
+      }
+    }
+    *tuple = row_batch_->GetTuple(row_batch_->GetSelectedRow(next_batch_row_++));
+    *rid = tuple->GetRid();
+    return true;
+  }
+
+  /** Drops the rest of the batch of NextFromBatch */
+  void ResetBatchRows() {
+    if (row_batch_ != nullptr) {
+      row_batch_->Reset();
+    }
+    next_batch_row_ = 0;
+  }
+
   ExecutorContext *exec_ctx_;
+
+ private:
+  /** The batch that NextFromBatch hands out the rows of, and the next of them */
+  std::unique_ptr<DataChunk> row_batch_;
+  size_t next_batch_row_{0};
 };
 }  // namespace bustub
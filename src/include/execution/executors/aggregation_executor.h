@@ -17,140 +17,259 @@
 #include <utility>
 #include <vector>
 
+#include "catalog/table_statistics.h"
+#include "common/macros.h"
+#include "common/memory_arena.h"
 #include "common/util/hash_util.h"
 #include "container/hash/hash_function.h"
 #include "execution/executor_context.h"
 #include "execution/executors/abstract_executor.h"
 #include "execution/expressions/abstract_expression.h"
+#include "execution/memory_manager.h"
 #include "execution/plans/aggregation_plan.h"
+#include "execution/quantile_sketch.h"
+#include "storage/table/tmp_tuple_list.h"
 #include "storage/table/tuple.h"
 #include "type/value_factory.h"
 
 namespace bustub {
 /**
- * A simplified hash table that has all the necessary functionality for aggregations.
+ * A simplified hash table that has all the necessary functionality for aggregations: a flat table of open addressing,
+ * by linear probing, of the indexes of records that each hold the group key of a group, serialized at a fixed width,
+ * followed by the states of its aggregates. A slot also holds the 32 bits of the hash of its record's key that its
+ * position comes from, which rule out the records of the other keys without a look at them, and let the table grow
+ * without hashing the keys again.
+ *
+ * The group-by values of fixed width are kept as they are in a tuple, so that a NULL is its type's null value; a
+ * VARCHAR group-by is its length and a pointer to its bytes, which the table copies into an arena of its own. The
+ * state of a COUNT, and of a SUM, MIN or MAX of integers, is an int64_t; of a MIN or MAX of decimals, a double. A SUM
+ * of decimals is exact, a FixedDecimal of 6 digits after the point, until an input has more of them or the sum
+ * leaves its 18 digits, and a double from then on, as its flags say. SUM, MIN and MAX have a flag of whether they
+ * have seen an input that is not NULL, as they are NULL until they have.
+ * The state of an APPROX_COUNT_DISTINCT or an APPROX_PERCENTILE is the index of its sketch among those the table
+ * holds, which is made with the first input that is not NULL, as the flag says.
+ *
+ * The aggregates come out as INTEGERs, as the expressions over them expect, but those of BIGINTs, DECIMALs and
+ * TIMESTAMPs, which come out as their inputs; a SUM of TIMESTAMPs is a BIGINT. COUNT counts the inputs that are not
+ * NULL, and so does APPROX_COUNT_DISTINCT, of the distinct ones; APPROX_PERCENTILE comes out as MIN and MAX do.
  */
 class SimpleAggregationHashTable {
  public:
   /**
    * Create a new simplified aggregation hash table.
+   * @param group_bys the group-by expressions
    * @param agg_exprs the aggregation expressions
    * @param agg_types the types of aggregations
+   * @param percentiles the fractions of the APPROX_PERCENTILE aggregates, by the index of the aggregate
    */
-  SimpleAggregationHashTable(const std::vector<const AbstractExpression *> &agg_exprs,
-                             const std::vector<AggregationType> &agg_types)
-      : agg_exprs_{agg_exprs}, agg_types_{agg_types} {}
-
-  /** @return the initial aggregrate value for this aggregation executor */
-  AggregateValue GenerateInitialAggregateValue() {
-    std::vector<Value> values;
-    for (const auto &agg_type : agg_types_) {
-      switch (agg_type) {
-        case AggregationType::CountAggregate:
-          // Count starts at zero.
-          values.emplace_back(ValueFactory::GetIntegerValue(0));
-          break;
-        case AggregationType::SumAggregate:
-          // Sum starts at zero.
-          values.emplace_back(ValueFactory::GetIntegerValue(0));
-          break;
-        case AggregationType::MinAggregate:
-          // Min starts at INT_MAX.
-          values.emplace_back(ValueFactory::GetIntegerValue(BUSTUB_INT32_MAX));
-          break;
-        case AggregationType::MaxAggregate:
-          // Max starts at INT_MIN.
-          values.emplace_back(ValueFactory::GetIntegerValue(BUSTUB_INT32_MIN));
-          break;
-      }
-    }
-    return {values};
-  }
+  SimpleAggregationHashTable(const std::vector<const AbstractExpression *> &group_bys,
+                             const std::vector<const AbstractExpression *> &agg_exprs,
+                             const std::vector<AggregationType> &agg_types, std::vector<double> percentiles = {});
 
-  /** Combines the input into the aggregation result. */
-  void CombineAggregateValues(AggregateValue *result, const AggregateValue &input) {
-    for (uint32_t i = 0; i < agg_exprs_.size(); i++) {
-      switch (agg_types_[i]) {
-        case AggregationType::CountAggregate:
-          // Count increases by one.
-          result->aggregates_[i] = result->aggregates_[i].Add(ValueFactory::GetIntegerValue(1));
-          break;
-        case AggregationType::SumAggregate:
-          // Sum increases by addition.
-          result->aggregates_[i] = result->aggregates_[i].Add(input.aggregates_[i]);
-          break;
-        case AggregationType::MinAggregate:
-          // Min is just the min.
-          result->aggregates_[i] = result->aggregates_[i].Min(input.aggregates_[i]);
-          break;
-        case AggregationType::MaxAggregate:
-          // Max is just the max.
-          result->aggregates_[i] = result->aggregates_[i].Max(input.aggregates_[i]);
-          break;
-      }
-    }
-  }
+  DISALLOW_COPY_AND_MOVE(SimpleAggregationHashTable);
+
+  ~SimpleAggregationHashTable() = default;
+
+  /**
+   * Evaluates the group-bys and the aggregates over a tuple, and combines it into its group.
+   * @param tuple the tuple to aggregate
+   * @param schema the schema of the tuple
+   */
+  void InsertCombine(const Tuple &tuple, const Schema *schema);
+
+  /**
+   * Evaluates the group-bys and the aggregates over a tuple, and combines it into its group if that is in the table.
+   * @param tuple the tuple to aggregate
+   * @param schema the schema of the tuple
+   * @return false if the group of the tuple is not in the table, which it is not inserted into
+   */
+  bool CombineExisting(const Tuple &tuple, const Schema *schema);
+
+  /** The same as InsertCombine, of a row of a chunk, whose column vectors the expressions read the values from */
+  void InsertCombine(const DataChunk &chunk, uint32_t row);
+
+  /** The same as CombineExisting, of a row of a chunk */
+  bool CombineExisting(const DataChunk &chunk, uint32_t row);
+
+  /** @return the hash of the group key of the tuple combined last, which does not depend on the table's size */
+  hash_t GetLastHash() const { return last_hash_; }
 
   /**
    * Inserts a value into the hash table and then combines it with the current aggregation.
    * @param agg_key the key to be inserted
    * @param agg_val the value to be inserted
    */
-  void InsertCombine(const AggregateKey &agg_key, const AggregateValue &agg_val) {
-    if (ht.count(agg_key) == 0) {
-      ht.insert({agg_key, GenerateInitialAggregateValue()});
-    }
-    CombineAggregateValues(&ht[agg_key], agg_val);
+  void InsertCombine(const AggregateKey &agg_key, const AggregateValue &agg_val);
+
+  /**
+   * Merges a group of another table of the same aggregation, as partial states of another part of the inputs, into
+   * its group in this table.
+   * @param other the other table
+   * @param index the index of the group in the other table, in the order the groups were inserted there
+   */
+  void Merge(const SimpleAggregationHashTable &other, size_t index);
+
+  /** @return the hash of the group key of the group of the index, the same in every table of the aggregation */
+  hash_t GetHash(size_t index) const { return HashKey(Record(index)); }
+
+  /** Inserts the group of an aggregation without group-bys, of no inputs, as that has a row even of no tuples */
+  void InsertEmptyGroup();
+
+  /** @return the number of groups */
+  size_t GetSize() const { return size_; }
+
+  /** @return the bytes that the records, the slots, the VARCHAR group-bys and the sketches take */
+  size_t GetMemoryUsage() const {
+    return records_.capacity() * sizeof(uint64_t) + slots_.capacity() * sizeof(uint64_t) + strings_.GetCapacity() +
+           (distinct_sketches_.empty() ? 0 : distinct_sketches_.size() * distinct_sketches_[0]->GetMemoryUsage()) +
+           quantile_sketches_.size() * QuantileSketch::MemoryUsage();
   }
 
+  /** Drops all groups, and releases the memory they took */
+  void Clear();
+
   /**
-   * An iterator through the simplified aggregation hash table.
+   * An iterator through the simplified aggregation hash table, in the order the groups were inserted.
    */
   class Iterator {
    public:
-    /** Creates an iterator for the aggregate map. */
-    explicit Iterator(std::unordered_map<AggregateKey, AggregateValue>::const_iterator iter) : iter_(iter) {}
+    /** Creates an iterator at the record of the given index. */
+    Iterator(const SimpleAggregationHashTable *table, size_t index) : table_(table), index_(index) {}
 
     /** @return the key of the iterator */
-    const AggregateKey &Key() { return iter_->first; }
+    AggregateKey Key() const;
 
     /** @return the value of the iterator */
-    const AggregateValue &Val() { return iter_->second; }
+    AggregateValue Val() const;
 
-    /** @return the iterator before it is incremented */
+    /** @return the iterator after it is incremented */
     Iterator &operator++() {
-      ++iter_;
+      ++index_;
       return *this;
     }
 
     /** @return true if both iterators are identical */
-    bool operator==(const Iterator &other) { return this->iter_ == other.iter_; }
+    bool operator==(const Iterator &other) const { return table_ == other.table_ && index_ == other.index_; }
 
     /** @return true if both iterators are different */
-    bool operator!=(const Iterator &other) { return this->iter_ != other.iter_; }
+    bool operator!=(const Iterator &other) const { return !(*this == other); }
 
    private:
-    /** Aggregates map. */
-    std::unordered_map<AggregateKey, AggregateValue>::const_iterator iter_;
+    const SimpleAggregationHashTable *table_;
+    size_t index_;
   };
 
   /** @return iterator to the start of the hash table */
-  Iterator Begin() { return Iterator{ht.cbegin()}; }
+  Iterator Begin() const { return Iterator{this, 0}; }
 
   /** @return iterator to the end of the hash table */
-  Iterator End() { return Iterator{ht.cend()}; }
+  Iterator End() const { return Iterator{this, size_}; }
 
  private:
-  /** The hash table is just a map from aggregate keys to aggregate values. */
-  std::unordered_map<AggregateKey, AggregateValue> ht{};
+  /** Where a VARCHAR group-by is in a key; a NULL has a length of BUSTUB_VALUE_NULL */
+  struct VarcharSlot {
+    const char *data_;
+    uint32_t length_;
+    uint32_t padding_;
+  };
+
+  static constexpr size_t INITIAL_SLOTS = 16;
+
+  /**
+   * Serializes the group-bys into key_, combines the aggregates into the state of its group.
+   * @return false if the group is not in the table and insert is false
+   */
+  bool Combine(const std::vector<Value> &group_bys, const std::vector<Value> &aggregates, bool insert);
+
+  /** @return the hash of the key of the record, or of key_ */
+  hash_t HashKey(const char *key) const;
+
+  /** @return true if the record's key is key_ */
+  bool KeyEquals(const char *record) const;
+
+  /** @return the record of the group of key_, which is inserted if it is not yet there and insert is true */
+  char *FindOrInsert(bool insert = true);
+
+  /** Doubles the slots */
+  void Grow();
+
+  char *Record(size_t index) { return reinterpret_cast<char *>(records_.data()) + index * record_size_; }
+  const char *Record(size_t index) const {
+    return reinterpret_cast<const char *>(records_.data()) + index * record_size_;
+  }
+
+  /** @return the group-by of a record */
+  Value GetGroupBy(const char *record, uint32_t idx) const;
+
+  /** @return the type of an aggregate */
+  TypeId GetAggregateType(uint32_t idx) const;
+
+  /** @return the aggregate of a record */
+  Value GetAggregate(const char *record, uint32_t idx) const;
+
+  /** @return the sketch of the state of an aggregate, which is made if the aggregate has seen no input yet */
+  template <typename Sketch>
+  static Sketch *SketchOf(char *state, char *seen, std::vector<std::unique_ptr<Sketch>> *sketches);
+
+  /** The types of the group-bys, and where they are in a key */
+  std::vector<TypeId> group_by_types_;
+  std::vector<size_t> group_by_offsets_;
+  /** The bytes of a key that are compared as they are: the group-bys of fixed width, padded to 8 bytes */
+  size_t fixed_key_size_{0};
+  size_t key_size_{0};
+  size_t record_size_{0};
+  /** Where the states of the aggregates, and their flags, are in a record */
+  size_t states_offset_{0};
+  size_t flags_offset_{0};
+
   /** The aggregate expressions that we have. */
   const std::vector<const AbstractExpression *> &agg_exprs_;
   /** The types of aggregations that we have. */
   const std::vector<AggregationType> &agg_types_;
+  /** The group-by expressions that we have. */
+  const std::vector<const AbstractExpression *> &group_bys_;
+  /** Whether each SUM, MIN or MAX is of decimals, whose state is a double or, of a SUM, a DecimalSum */
+  std::vector<bool> decimal_states_;
+  std::vector<double> percentiles_;
+  /** The sketches of the APPROX_COUNT_DISTINCT and APPROX_PERCENTILE aggregates of the groups */
+  std::vector<std::unique_ptr<HyperLogLog>> distinct_sketches_;
+  std::vector<std::unique_ptr<QuantileSketch>> quantile_sketches_;
+
+  /** The records, of record_size_ bytes each, in the order they were inserted */
+  std::vector<uint64_t> records_;
+  size_t size_{0};
+  /** The slots: the index of a record plus one, or 0 for an empty one, in the low 32 bits, and its hash above */
+  std::vector<uint64_t> slots_;
+  MemoryArena strings_;
+  /** The key of the tuple being combined, and its group-bys and aggregates */
+  std::vector<uint64_t> key_;
+  std::vector<Value> group_by_values_;
+  std::vector<Value> aggregate_values_;
+  hash_t last_hash_{0};
 };
 
 /**
  * AggregationExecutor executes an aggregation operation (e.g. COUNT, SUM, MIN, MAX) on the tuples of a child executor.
+ * Init aggregates all of them into a SimpleAggregationHashTable, and Next returns its groups that pass the having
+ * clause, with every output value cast to the type of its column.
+ *
+ * The table is kept within the memory budget of the query: once it outgrows that, or its MemoryReservation is refused
+ * or revoked, the groups in it still take their tuples, but the tuples of any other group are spilled to temp pages,
+ * split by the hash of their group key into NUM_PARTITIONS partitions. Every group is thus either in the table or in
+ * a single partition, whole. Next returns the groups of the table, then aggregates the partitions one at a time into
+ * it, each of which may be split again, up to MAX_DEPTH times; a partition that deep is aggregated in memory
+ * regardless. The child is read a batch at a time, through NextBatch, and only the rows that are spilled are made
+ * tuples of.
+ *
+ * A child that is a chain of hash joins down to a sequential scan is run as a PushPipeline instead, whose sink is the
+ * table, while that fits the memory budget; once it does not, the aggregation starts over with the executors.
+ *
+ * A plan of more than one thread over a sequential scan of a table of rows aggregates in two pipelines of the
+ * PipelineScheduler. Every worker claims morsels of the table, and pre-aggregates the rows of them into a table of its
+ * own, which no other worker touches. The groups of those tables are then split by their hash into
+ * PARTITIONS_PER_THREAD partitions per thread, which the workers claim one at a time, and merge the partial states of
+ * into a table of the partition. Should the tables of the workers outgrow the memory budget, the aggregation starts
+ * over, on a single thread, as it would have.
  */
 class AggregationExecutor : public AbstractExecutor {
  public:
@@ -191,13 +310,61 @@ class AggregationExecutor : public AbstractExecutor {
   }
 
  private:
+  static constexpr size_t NUM_PARTITIONS = 16;
+  /** The times a partition can be split again before it is aggregated in memory regardless */
+  static constexpr uint32_t MAX_DEPTH = 4;
+  /** The partitions of the merge of a parallel aggregation per thread, so that the threads stay busy till the end */
+  static constexpr size_t PARTITIONS_PER_THREAD = 4;
+
+  /** The tuples of the groups that did not fit the table, of a hash partition */
+  struct Partition {
+    std::unique_ptr<TmpTupleList> tuples_;
+    /** The times the tuples were split */
+    uint32_t depth_;
+  };
+
+  /** @return the partition, of num_partitions, of a group key's hash, at a depth of splits */
+  static size_t PartitionOf(hash_t hash, uint32_t depth, size_t num_partitions = NUM_PARTITIONS);
+
+  /**
+   * Aggregates tuples into the cleared table, spilling those that do not fit into partitions of one depth more.
+   * @param input the spilled tuples to aggregate, or nullptr for the tuples of the child
+   * @param depth the times the tuples were split
+   */
+  void Aggregate(TmpTupleList *input, uint32_t depth);
+
+  /**
+   * Aggregates the table of the sequential scan child on the threads of the plan, into parallel_tables_: morsels of
+   * the pages of a table of rows, or the partitions of a partitioned one that the predicate of the scan leaves, a
+   * worker each.
+   * @return false if the plan is of a single thread, the child is not a scan of a table of rows, or the groups do not
+   * fit the memory budget
+   */
+  bool AggregateParallel();
+
+  /**
+   * Aggregates the rows of a child that is a chain of hash joins down to a scan into the table, pushed through a
+   * PushPipeline.
+   * @return false if push execution is off, the child is not of that shape, or the table outgrew the memory budget
+   */
+  bool AggregatePushed();
+
   /** The aggregation plan node. */
   const AggregationPlanNode *plan_;
   /** The child executor whose tuples we are aggregating. */
   std::unique_ptr<AbstractExecutor> child_;
   /** Simple aggregation hash table. */
-  // Uncomment me! SimpleAggregationHashTable aht_;
+  SimpleAggregationHashTable aht_;
+  /** The tables of the partitions of a parallel aggregation, and the next one to return the groups of */
+  std::vector<std::unique_ptr<SimpleAggregationHashTable>> parallel_tables_;
+  size_t next_table_{0};
+  /** The table whose groups are being returned */
+  const SimpleAggregationHashTable *table_;
   /** Simple aggregation hash table iterator. */
-  // Uncomment me! SimpleAggregationHashTable::Iterator aht_iterator_;
+  SimpleAggregationHashTable::Iterator aht_iterator_;
+  /** The partitions yet to be aggregated */
+  std::vector<Partition> partitions_;
+  /** The memory of aht_ */
+  MemoryReservation memory_;
 };
 }  // namespace bustub
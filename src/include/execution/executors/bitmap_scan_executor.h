@@ -0,0 +1,62 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// bitmap_scan_executor.h
+//
+// Identification: src/include/execution/executors/bitmap_scan_executor.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+#include "catalog/catalog.h"
+#include "execution/executor_context.h"
+#include "execution/executors/abstract_executor.h"
+#include "execution/plans/bitmap_scan_plan.h"
+#include "storage/table/tuple.h"
+
+namespace bustub {
+
+/**
+ * BitmapScanExecutor executes a bitmap scan over a table. Init unions the bitmaps of the keys of each condition and
+ * intersects those of the conditions, so the rows that fail any of them are ruled out before the table is read at
+ * all; the RIDs that are left come out in page order, and each row is read by its RID, the rows of a page one after
+ * the other. The predicate is tested on the rows that are read.
+ */
+class BitmapScanExecutor : public AbstractExecutor {
+ public:
+  /**
+   * Creates a new bitmap scan executor.
+   * @param exec_ctx the executor context
+   * @param plan the bitmap scan plan to be executed
+   */
+  BitmapScanExecutor(ExecutorContext *exec_ctx, const BitmapScanPlanNode *plan);
+
+  const Schema *GetOutputSchema() override { return plan_->OutputSchema(); };
+
+  void Init() override;
+
+  bool Next(Tuple *tuple, RID *rid) override;
+
+  void SetRowLimit(size_t limit) override { row_limit_ = std::min(row_limit_, limit); }
+
+ private:
+  /** The bitmap scan plan node to be executed. */
+  const BitmapScanPlanNode *plan_;
+  TableMetadata *table_info_{nullptr};
+  /** The bitmap values of the RIDs of the rows that hold for the conditions, in ascending order */
+  std::vector<uint64_t> rids_;
+  size_t position_{0};
+  /** The most tuples the parent takes, and the number returned since Init */
+  size_t row_limit_{SIZE_MAX};
+  size_t returned_{0};
+};
+
+}  // namespace bustub
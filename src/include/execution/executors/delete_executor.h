@@ -16,8 +16,10 @@
 #include <utility>
 #include <vector>
 
+#include "catalog/catalog.h"
 #include "execution/executor_context.h"
 #include "execution/executors/abstract_executor.h"
+#include "execution/index_update_buffer.h"
 #include "execution/plans/delete_plan.h"
 #include "storage/table/tuple.h"
 
@@ -25,6 +27,10 @@ namespace bustub {
 /**
  * Delete executes a delete from a table.
  * Deleted tuple info come from a child executor.
+ *
+ * The rows are deleted in batches: the tuples of a batch are marked deleted a page at a time (see
+ * TableHeap::MarkDeletes), and their entries are removed from the indexes at the end of the statement, see
+ * IndexUpdateBuffer.
  */
 class DeleteExecutor : public AbstractExecutor {
  public:
@@ -42,14 +48,25 @@ class DeleteExecutor : public AbstractExecutor {
   void Init() override;
 
   // Note that Delete does not make use of the tuple pointer being passed in.
-  // We throw exception if the delete failed for any reason, and return false if all delete succeeded.
-  // Delete from indexes if necessary.
+  // Each call deletes a batch of up to BATCH_SIZE tuples, and rid is set to the last of them.
+  // We return false if the delete failed for any reason or there was nothing left to delete, and true otherwise.
+  // The call that finds nothing left to delete, or fails, removes the index entries of every row deleted.
   bool Next([[maybe_unused]] Tuple *tuple, RID *rid) override;
 
  private:
+  /** The number of tuples each call to Next deletes at most. */
+  static constexpr size_t BATCH_SIZE = 512;
+
+  /** Marks a batch of tuples deleted in the table, whichever its layout. */
+  bool DeleteBatch(const std::vector<RID> &rids);
+
   /** The delete plan node to be executed. */
   const DeletePlanNode *plan_;
   /** The child executor to obtain rid from. */
   std::unique_ptr<AbstractExecutor> child_executor_;
+  /** Metadata identifying the table that should be deleted from. */
+  TableMetadata *table_info_{nullptr};
+  /** The index entries of the rows deleted, until the end of the statement. */
+  std::unique_ptr<IndexUpdateBuffer> index_updates_;
 };
 }  // namespace bustub
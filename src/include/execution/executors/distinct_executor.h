@@ -0,0 +1,87 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// distinct_executor.h
+//
+// Identification: src/include/execution/executors/distinct_executor.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <memory>
+#include <optional>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include "execution/executor_context.h"
+#include "execution/executors/abstract_executor.h"
+#include "execution/memory_manager.h"
+#include "execution/plans/distinct_plan.h"
+#include "storage/table/tmp_tuple_list.h"
+#include "storage/table/tuple.h"
+
+namespace bustub {
+
+/**
+ * DistinctExecutor returns the tuples of its child that it has not returned yet, as a hash DISTINCT. Each tuple of
+ * the child is looked up in a hash set of the ones seen so far, and is returned right away if it is new, so the first
+ * tuples come out before the child is done, and a LimitExecutor above it stops the child early.
+ *
+ * Once the set outgrows the memory budget of the query, or its MemoryReservation is refused or revoked, it stops
+ * growing: the tuples that are not in it are spilled to one of NUM_PARTITIONS temp lists by their hash instead. Once
+ * the child is done, each list is deduplicated in turn, with a set of its own; a tuple that repeats another one goes
+ * to the same list, and no spilled tuple is in the first set.
+ */
+class DistinctExecutor : public AbstractExecutor {
+ public:
+  /** The number of temp lists the tuples are spilled to once the set is full */
+  static constexpr size_t NUM_PARTITIONS = 16;
+
+  /**
+   * Creates a new distinct executor.
+   * @param exec_ctx the executor context
+   * @param plan the distinct plan to be executed
+   * @param child the child executor whose repeated tuples are dropped
+   */
+  DistinctExecutor(ExecutorContext *exec_ctx, const DistinctPlanNode *plan, std::unique_ptr<AbstractExecutor> &&child);
+
+  const Schema *GetOutputSchema() override { return plan_->OutputSchema(); }
+
+  void Init() override;
+
+  bool Next(Tuple *tuple, RID *rid) override;
+
+ private:
+  /** @return the distinct key of a tuple of the child */
+  DistinctKey MakeKey(const Tuple &tuple);
+
+  /** @return the bytes an entry of the set takes */
+  static size_t EntryBytes(const DistinctKey &key);
+
+  /** Makes the set empty and gives its memory back. */
+  void ClearSet();
+
+  /** The distinct plan node to be executed. */
+  const DistinctPlanNode *plan_;
+  /** The child executor whose repeated tuples are dropped. */
+  std::unique_ptr<AbstractExecutor> child_;
+
+  /** The tuples seen so far, of the child or of the list being deduplicated */
+  std::unordered_set<DistinctKey> set_;
+  size_t set_bytes_{0};
+  MemoryReservation memory_;
+  bool child_done_{false};
+
+  /** The lists the tuples are spilled to, by their hash, once the set is full; empty until then */
+  std::vector<std::unique_ptr<TmpTupleList>> partitions_;
+  /** The next list to deduplicate, and the reader of the one being deduplicated */
+  size_t next_partition_{0};
+  std::optional<TmpTupleList::Reader> reader_;
+};
+
+}  // namespace bustub
@@ -0,0 +1,237 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// hash_join_executor.h
+//
+// Identification: src/include/execution/executors/hash_join_executor.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "execution/executor_context.h"
+#include "execution/executors/abstract_executor.h"
+#include "execution/join_key_filter.h"
+#include "execution/memory_manager.h"
+#include "execution/plans/hash_join_plan.h"
+#include "storage/table/tmp_tuple_list.h"
+#include "storage/table/tuple.h"
+
+namespace bustub {
+
+/**
+ * HashJoinExecutor joins the tuples of two children on equal keys. Init builds a hash table of the tuples of the left
+ * child, by their keys, and Next probes it with the tuples of the right child, one at a time, so that only the left
+ * side is held in memory. Tuples with a null key join nothing, as NULL equals nothing.
+ *
+ * When the left side outgrows the memory budget of the query, or its MemoryReservation is refused or revoked while it
+ * is built, the join turns into a Grace hash join: both sides are split by the hash of their keys into NUM_PARTITIONS
+ * partitions, which are spilled to temp pages, and joined a partition at a time, as above. A partition whose left side
+ * still does not fit is split again, by another hash, up to MAX_DEPTH times; one that many keys are the same in
+ * cannot be split, and is joined in memory regardless.
+ *
+ * A plan of more than one thread makes it a parallel radix join, as long as both sides fit the budget together. The
+ * children are drained first, as they are not thread-safe, and then the workers of the PipelineScheduler split a
+ * slice of each side each into partitions by the top bits of the hash of the keys, in partition buffers of their own.
+ * Then the workers claim the partitions one after the other, and join each with a hash table of their own; there are
+ * enough partitions for every worker to have a few, and for the left side of a partition to fit in an L2 cache with
+ * room to spare. The partitions are joined in rounds, as Next runs out of the output of the last: a round ends once
+ * its output takes up what the budget leaves beside both sides, and the partitions the workers have claimed by then
+ * are joined, so that the output held is bounded by the budget and a partition a worker. A parallel join that its
+ * parent takes only so many tuples of (see SetRowLimit) joins no more partitions once they have made that many.
+ *
+ * If the right child is a sequential scan, the keys of the left side go into a JoinKeyFilter, which the scan drops the
+ * rows that cannot join with before they are copied out of their pages; but for an ANTI join, which keeps just those.
+ *
+ * A SEMI or an ANTI join probes the hash table with each right tuple once, and makes a row of it alone if any left
+ * tuple matches it, or if none does, rather than one per match; the right tuples with a null key are kept by an ANTI
+ * join, in every way the join may run.
+ *
+ * NextBatch probes the hash table with a chunk of right rows at a time, and makes the output chunk of the matches
+ * column by column: the columns of the right side are gathered from the right chunk's vectors, those of the left side
+ * are read from the left tuples. The left side is built from tuples all the same, as the hash table holds tuples; a
+ * parallel or spilled join hands out its batches through Next.
+ */
+class HashJoinExecutor : public AbstractExecutor {
+ public:
+  /**
+   * Creates a new hash join executor.
+   * @param exec_ctx the executor context
+   * @param plan the hash join plan to be executed
+   * @param left_executor the child executor whose tuples the hash table is built of
+   * @param right_executor the child executor whose tuples probe the hash table
+   */
+  HashJoinExecutor(ExecutorContext *exec_ctx, const HashJoinPlanNode *plan,
+                   std::unique_ptr<AbstractExecutor> &&left_executor,
+                   std::unique_ptr<AbstractExecutor> &&right_executor);
+
+  const Schema *GetOutputSchema() override { return plan_->OutputSchema(); };
+
+  void Init() override;
+
+  bool Next(Tuple *tuple, RID *rid) override;
+
+  bool NextBatch(DataChunk *chunk) override;
+
+  void SetRowLimit(size_t limit) override { row_limit_ = std::min(row_limit_, limit); }
+
+  /**
+   * @param[out] key the key of a row of a chunk by the expressions
+   * @return false if a value of the key is null
+   */
+  static bool MakeKey(const DataChunk &chunk, uint32_t row, const std::vector<const AbstractExpression *> &exprs,
+                      HashJoinKey *key);
+
+  /**
+   * Makes the rows of a chunk of a join's output schema, column by column, of the matches of left tuples with rows
+   * of a right chunk: the i-th row is of the i-th left tuple and the i-th right row. The left tuples are nullptr for
+   * the rows of a SEMI or an ANTI join, whose output schema is of the right side only.
+   */
+  static void MakeOutput(const Schema *output_schema, const Schema *left_schema,
+                         const std::vector<const Tuple *> &left_tuples, const DataChunk &right_chunk,
+                         const std::vector<uint32_t> &right_rows, DataChunk *chunk);
+
+ private:
+  /** The number of partitions that a side, or a partition of it, is split into */
+  static constexpr size_t NUM_PARTITIONS = 16;
+  /** The number of times a partition is split at most */
+  static constexpr uint32_t MAX_DEPTH = 4;
+
+  /** The bytes of left tuples a partition of a parallel join is sized to */
+  static constexpr size_t RADIX_PARTITION_BYTES = L2_CACHE_SIZE / 2;
+  /** The number of bits of the hash that pick a partition of a parallel join, at most */
+  static constexpr uint32_t MAX_RADIX_BITS = 12;
+
+  /** The tuples of both sides whose keys hash to a partition, spilled */
+  struct Partition {
+    std::unique_ptr<TmpTupleList> left_;
+    std::unique_ptr<TmpTupleList> right_;
+    uint32_t depth_;
+  };
+
+  /** @return the bytes a tuple takes in the hash table */
+  static size_t TableBytes(const Tuple &tuple) { return sizeof(Tuple) + tuple.GetLength(); }
+
+  /** @return the partition of a key at the depth, by a hash that differs from depth to depth */
+  static size_t PartitionOf(const HashJoinKey &key, uint32_t depth);
+
+  /**
+   * Adds a tuple of the left side to the hash table, if its key has no nulls.
+   * @param[out] key the key of the tuple
+   * @return false if the key has a null
+   */
+  bool Build(Tuple &&tuple, HashJoinKey *key);
+
+  /**
+   * Moves the hash table, and then the rest of the left side, into the partitions to join.
+   * @param[out] key_hashes the hashes of the keys of the rest of the left side are appended to it, unless nullptr
+   */
+  void SpillLeft(std::vector<hash_t> *key_hashes);
+
+  /** Moves the right side into the partitions to join, and drops the partitions that cannot join */
+  void SpillRight();
+
+  /**
+   * Loads the left side of the next partition to join into the hash table, splitting the partitions that do not fit.
+   * @return false if every partition has been joined
+   */
+  bool NextPartition();
+
+  /** @return false if the right side has no tuple left */
+  bool NextRightTuple(Tuple *tuple);
+
+  /** @return false if the right side has no row left; otherwise the next batch of it is in right_chunk_ */
+  bool NextRightChunk();
+
+  /** Splits the tuples of both sides into the partitions of a parallel join, with the threads of the plan */
+  void RadixPartition();
+
+  /**
+   * Joins a round of the partitions not joined yet with the threads of the plan, into results_.
+   * @return false if no partition is left to join, or the parent takes no more tuples
+   */
+  bool RadixJoin();
+
+  /**
+   * @return the tuple of the output schema that two matching tuples join into, or that a right tuple makes on its own
+   * if left_tuple is nullptr, as of a SEMI or an ANTI join
+   */
+  Tuple MakeOutput(const Tuple *left_tuple, const Tuple &right_tuple);
+
+  /** @return true if a right tuple that did or did not match makes a row of a SEMI or an ANTI join */
+  bool KeepsOuter(bool matched) const { return matched == (plan_->GetJoinType() == JoinType::SEMI); }
+
+  /** @return true if a partition of a spilled join may make rows */
+  bool MayJoin(const Partition &partition) const {
+    return partition.right_->GetSize() != 0 &&
+           (partition.left_->GetSize() != 0 || plan_->GetJoinType() == JoinType::ANTI);
+  }
+
+  /**
+   * @param[out] key the key of the tuple by the expressions
+   * @return false if a value of the key is null
+   */
+  static bool MakeKey(const Tuple &tuple, const Schema *schema, const std::vector<const AbstractExpression *> &exprs,
+                      HashJoinKey *key);
+
+  /** The hash join plan node to be executed. */
+  const HashJoinPlanNode *plan_;
+  std::unique_ptr<AbstractExecutor> left_executor_;
+  std::unique_ptr<AbstractExecutor> right_executor_;
+  /** The filter of the keys of the left side that is pushed down into a scan on the right side */
+  std::unique_ptr<JoinKeyFilter> join_filter_;
+  /** The tuples of the left child, by their keys */
+  std::unordered_map<HashJoinKey, std::vector<Tuple>> hash_table_;
+  size_t table_bytes_{0};
+  MemoryReservation memory_;
+  /** Whether the join spilled, and the partitions it has not joined yet */
+  bool spilled_{false};
+  std::vector<Partition> partitions_;
+  /** The partition being joined, and where its right side is read to */
+  Partition partition_;
+  std::unique_ptr<TmpTupleList::Reader> right_reader_;
+  /** Right tuples that were drained, but are to be probed with, before the rest of the right child */
+  std::vector<Tuple> right_tuples_;
+  size_t next_right_tuple_{0};
+  /**
+   * Whether the join runs in parallel; the tuples of both sides, the bytes they hold, and the indexes of them in each
+   * partition, by the slice that split them
+   */
+  bool parallel_{false};
+  using Buffers = std::vector<std::vector<uint32_t>>;
+  std::vector<Tuple> parallel_left_;
+  std::vector<Tuple> parallel_right_;
+  size_t input_bytes_{0};
+  std::vector<Buffers> left_buffers_;
+  std::vector<Buffers> right_buffers_;
+  /** The partitions not joined yet, and the output of those of the last round, by their place in the round */
+  std::vector<size_t> pending_partitions_;
+  std::vector<std::vector<Tuple>> results_;
+  /** The most tuples the parent takes, past which a parallel join stops joining partitions, and those made so far */
+  size_t row_limit_{SIZE_MAX};
+  size_t joined_{0};
+  size_t next_result_partition_{0};
+  size_t next_result_{0};
+  /** The tuple of the right child that is being joined, and the left tuples it is joined with */
+  Tuple right_tuple_;
+  const std::vector<Tuple> *matches_{nullptr};
+  size_t next_match_{0};
+  /** The batch of the right side that NextBatch is probing with, and the next of its live rows to probe with */
+  std::unique_ptr<DataChunk> right_chunk_;
+  size_t next_probe_row_{0};
+  /** The pairs of matches that make up a batch of output */
+  std::vector<const Tuple *> batch_left_;
+  std::vector<uint32_t> batch_right_rows_;
+};
+
+}  // namespace bustub
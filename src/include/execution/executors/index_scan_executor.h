@@ -12,8 +12,12 @@
 
 #pragma once
 
+#include <algorithm>
+#include <cstdint>
+#include <memory>
 #include <vector>
 
+#include "catalog/catalog.h"
 #include "common/rid.h"
 #include "execution/executor_context.h"
 #include "execution/executors/abstract_executor.h"
@@ -23,9 +27,14 @@
 namespace bustub {
 
 /**
- * IndexScanExecutor executes an index scan over a table.
+ * IndexScanExecutor executes an index scan over a table, in key order. The index has to be a B+ tree index, except for
+ * a scan of a single key (see IndexKeyRange::IsEquality), which looks the key up in an index of any kind. A scan of a
+ * key range starts at its lower bound and stops at its upper one. An index-only scan (see
+ * IndexScanPlanNode::IsIndexOnly) reads its tuples from the index keys; every other scan looks up the table tuple of
+ * each entry. A scan that its parent takes only so many tuples of (see SetRowLimit) stops walking the index once it
+ * returned them. A scan of a B+ tree index by a SERIALIZABLE transaction locks the key ranges it reads (see
+ * BPlusTreeIndex), so that no row is inserted into its range until the transaction ends.
  */
-
 class IndexScanExecutor : public AbstractExecutor {
  public:
   /**
@@ -35,14 +44,29 @@ class IndexScanExecutor : public AbstractExecutor {
    */
   IndexScanExecutor(ExecutorContext *exec_ctx, const IndexScanPlanNode *plan);
 
+  ~IndexScanExecutor() override;
+
   const Schema *GetOutputSchema() override { return plan_->OutputSchema(); };
 
   void Init() override;
 
   bool Next(Tuple *tuple, RID *rid) override;
 
+  void SetRowLimit(size_t limit) override { row_limit_ = std::min(row_limit_, limit); }
+
+  /** Walks the entries of the key range of the index. */
+  class IndexCursor;
+
  private:
   /** The index scan plan node to be executed. */
   const IndexScanPlanNode *plan_;
+  const IndexInfo *index_info_{nullptr};
+  TableMetadata *table_info_{nullptr};
+  /** True if the tuples are built from the index keys. */
+  bool index_only_{false};
+  std::unique_ptr<IndexCursor> cursor_;
+  /** The most tuples the parent takes, and the number returned since Init */
+  size_t row_limit_{SIZE_MAX};
+  size_t returned_{0};
 };
 }  // namespace bustub
@@ -14,16 +14,22 @@
 
 #include <memory>
 #include <utility>
+#include <vector>
 
+#include "buffer/buffer_access_strategy.h"
 #include "execution/executor_context.h"
 #include "execution/executors/abstract_executor.h"
+#include "execution/index_update_buffer.h"
 #include "execution/plans/insert_plan.h"
 #include "storage/table/tuple.h"
+#include "storage/table/tuple_builder.h"
 
 namespace bustub {
 /**
  * InsertExecutor executes an insert into a table.
  * Inserted values can either be embedded in the plan itself ("raw insert") or come from a child executor.
+ * The rows of a partitioned table go into the heaps of their partitions. The index entries of the rows are added at
+ * the end of the statement, see IndexUpdateBuffer.
  */
 class InsertExecutor : public AbstractExecutor {
  public:
@@ -41,14 +47,36 @@ class InsertExecutor : public AbstractExecutor {
   void Init() override;
 
   // Note that Insert does not make use of the tuple pointer being passed in.
-  // We return false if the insert failed for any reason, and return true if all inserts succeeded.
+  // Each call inserts a batch of up to BATCH_SIZE tuples, and rid is set to the last of them. The call that inserts
+  // the last batch, or fails, adds the index entries of every row inserted.
+  // We return false if the insert failed for any reason or there was nothing left to insert, and true otherwise.
   bool Next([[maybe_unused]] Tuple *tuple, RID *rid) override;
 
  private:
+  /** The number of tuples each call to Next inserts at most. */
+  static constexpr size_t BATCH_SIZE = 128;
+
+  /**
+   * Inserts a batch of tuples into the table, whichever its layout.
+   * @param[out] rids the RIDs of the tuples inserted, in batch order; those of a partitioned table only if all were
+   */
+  bool InsertBatch(const std::vector<Tuple> &batch, std::vector<RID> *rids);
+
   /** The insert plan node to be executed. */
   const InsertPlanNode *plan_;
+  /** The table, of which only the heap of its layout is set; a partitioned table has partitions_ instead of table_. */
   TableHeap *table_;
+  PaxTableHeap *pax_table_;
+  MemoryTable *memory_table_;
+  ClusteredTable *clustered_table_;
+  PartitionedTable *partitions_;
   std::unique_ptr<AbstractExecutor> child_executor_;
   size_t index_;
+  /** Confines the pages the insert creates or fills to a small ring instead of the whole buffer pool. */
+  std::unique_ptr<BufferAccessStrategy> strategy_;
+  /** Serializes the rows of a raw insert, in the layout of the table's schema. */
+  std::unique_ptr<TupleBuilder> tuple_builder_;
+  /** The index entries of the rows inserted, until the end of the statement. */
+  std::unique_ptr<IndexUpdateBuffer> index_updates_;
 };
 }  // namespace bustub
@@ -20,7 +20,9 @@
 
 namespace bustub {
 /**
- * LimitExecutor limits the number of output tuples with an optional offset.
+ * LimitExecutor limits the number of output tuples with an optional offset. A limit over a sort is run as a
+ * TopNExecutor instead, which ExecutorFactory makes of the two. The child is told how many of its tuples the limit
+ * takes, the offset and the limit, so that it stops its work there (see AbstractExecutor::SetRowLimit).
  */
 class LimitExecutor : public AbstractExecutor {
  public:
@@ -39,10 +41,14 @@ class LimitExecutor : public AbstractExecutor {
 
   bool Next(Tuple *tuple, RID *rid) override;
 
+  void SetRowLimit(size_t limit) override;
+
  private:
   /** The limit plan node to be executed. */
   const LimitPlanNode *plan_;
   /** The child executor to obtain value from. */
   std::unique_ptr<AbstractExecutor> child_executor_;
+  /** The number of tuples returned so far. */
+  size_t count_{0};
 };
 }  // namespace bustub
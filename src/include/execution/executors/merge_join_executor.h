@@ -0,0 +1,83 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// merge_join_executor.h
+//
+// Identification: src/include/execution/executors/merge_join_executor.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "execution/executor_context.h"
+#include "execution/executors/abstract_executor.h"
+#include "execution/plans/merge_join_plan.h"
+#include "storage/table/tuple.h"
+
+namespace bustub {
+
+/**
+ * MergeJoinExecutor joins two children that return their tuples in ascending order of their keys. It steps through
+ * both at once, moving on the side of the smaller key, and when the keys meet it copies out the right tuples of that
+ * key, the only ones it holds, which every left tuple of the key is joined with in turn. Keys compare as Values, so
+ * that e.g. a SMALLINT key joins an INTEGER one; tuples with a null key join nothing, wherever their children put them.
+ */
+class MergeJoinExecutor : public AbstractExecutor {
+ public:
+  /**
+   * Creates a new merge join executor.
+   * @param exec_ctx the executor context
+   * @param plan the merge join plan to be executed
+   * @param left_executor the child executor of the left side
+   * @param right_executor the child executor of the right side
+   */
+  MergeJoinExecutor(ExecutorContext *exec_ctx, const MergeJoinPlanNode *plan,
+                    std::unique_ptr<AbstractExecutor> &&left_executor,
+                    std::unique_ptr<AbstractExecutor> &&right_executor);
+
+  const Schema *GetOutputSchema() override { return plan_->OutputSchema(); }
+
+  void Init() override;
+
+  bool Next(Tuple *tuple, RID *rid) override;
+
+ private:
+  /**
+   * Moves a side on to its next tuple whose keys are not null.
+   * @return false at the end of the side
+   */
+  static bool Advance(AbstractExecutor *executor, const std::vector<const AbstractExpression *> &key_exprs,
+                      Tuple *tuple, std::vector<Value> *keys);
+
+  /** @return less than, equal to or greater than 0 as the left keys go before, with or after the right ones */
+  static int CompareKeys(const std::vector<Value> &left, const std::vector<Value> &right);
+
+  /** @return the output tuple of a left and a right tuple that join */
+  Tuple MakeOutput(const Tuple &left_tuple, const Tuple &right_tuple);
+
+  const MergeJoinPlanNode *plan_;
+  std::unique_ptr<AbstractExecutor> left_executor_;
+  std::unique_ptr<AbstractExecutor> right_executor_;
+
+  /** The left tuple being joined, and its keys */
+  Tuple left_tuple_;
+  std::vector<Value> left_keys_;
+  bool has_left_{false};
+  /** The next right tuple that is not in the group, and its keys */
+  Tuple right_tuple_;
+  std::vector<Value> right_keys_;
+  bool has_right_{false};
+  /** The right tuples of the key of the left tuple, the next one to join it with, and their keys */
+  std::vector<Tuple> group_;
+  size_t next_in_group_{0};
+  std::vector<Value> group_keys_;
+};
+
+}  // namespace bustub
@@ -18,9 +18,12 @@
 #include <utility>
 #include <vector>
 
+#include "catalog/catalog.h"
 #include "execution/executor_context.h"
 #include "execution/executors/abstract_executor.h"
 #include "execution/expressions/abstract_expression.h"
+#include "execution/memory_manager.h"
+#include "execution/plans/hash_join_plan.h"
 #include "execution/plans/nested_index_join_plan.h"
 #include "storage/table/tmp_tuple.h"
 #include "storage/table/tuple.h"
@@ -28,10 +31,34 @@
 namespace bustub {
 
 /**
- * IndexJoinExecutor executes index join operations.
+ * IndexJoinExecutor executes index join operations. The predicate is an equality of an expression over the outer
+ * tuple and the key column of a single-column index of the inner table, which the inner tuples are looked up in.
+ *
+ * The outer tuples are taken in batches rather than one at a time: the keys of a batch are looked up all at once (see
+ * Index::ScanKeys), which a B+ tree does in key order, on from the leaf of the last key; and the inner tuples they
+ * match are then fetched in the order of their pages, so that each page of the inner table is fetched about once per
+ * batch instead of once per match. The rows of a batch come out in that order too, not in the order of the outer
+ * tuples.
+ *
+ * A SEMI or an ANTI join makes a row of each outer tuple of a batch that some inner tuple matches, or that none does,
+ * in the order of the outer tuples; once an outer tuple has matched, the rest of its matches are not fetched.
+ *
+ * The optimizer picks an index join when it expects the outer side to be small next to the inner table, which it may
+ * not be if the statistics are off. So the join counts the outer tuples it has seen, and once they reach the rows of
+ * the inner table over SWITCH_RATIO, i.e. the point past which the optimizer would not have picked it, it turns into a
+ * hash join: the inner table is scanned once into a hash table by its key column, which the outer tuples from then on
+ * are probed with instead of being looked up in the index. The rows made so far stay as they are, as every outer tuple
+ * is joined exactly once, one way or the other. The hash table is held in the memory budget of the query; if the inner
+ * table does not fit, the join goes on with the index. Only a table of the ROW layout is scanned so; over one that
+ * is not analyzed, the join switches after SWITCH_RATIO batches.
  */
 class NestIndexJoinExecutor : public AbstractExecutor {
  public:
+  /** The number of outer tuples whose keys are looked up at once */
+  static constexpr size_t BATCH_SIZE = 1024;
+  /** The rows of the inner table per outer tuple past which the join turns into a hash join, see the optimizer */
+  static constexpr size_t SWITCH_RATIO = 4;
+
   /**
    * Creates a new nested index join executor.
    * @param exec_ctx the context that the hash join should be performed in
@@ -47,8 +74,61 @@ class NestIndexJoinExecutor : public AbstractExecutor {
 
   bool Next(Tuple *tuple, RID *rid) override;
 
+  /** @return the outer tuples the join has seen so far */
+  size_t GetOuterRows() const { return outer_rows_; }
+
+  /** @return true if the join turned into a hash join, as the outer side outgrew the estimate */
+  bool IsHashJoin() const { return hash_join_; }
+
  private:
+  /**
+   * Joins the next batch of outer tuples into output_.
+   * @return false if the child has no more tuples
+   */
+  bool JoinBatch();
+
+  /**
+   * Looks up the keys of a batch in the index, and joins the outer tuples with the inner tuples they match.
+   * @param keys the key of each outer tuple that has one, in order
+   * @param key_owners the outer tuple of each key
+   */
+  void LookUpBatch(const std::vector<Tuple> &outer_tuples, const std::vector<Value> &keys,
+                   const std::vector<size_t> &key_owners, std::vector<bool> *matched);
+
+  /** Joins the outer tuples of a batch with the inner tuples their keys find in inner_table_, see LookUpBatch. */
+  void ProbeBatch(const std::vector<Tuple> &outer_tuples, const std::vector<Value> &keys,
+                  const std::vector<size_t> &key_owners, std::vector<bool> *matched);
+
+  /**
+   * Joins the outer tuple of a batch at outer_idx with an inner tuple that its key matches, if the predicate holds: an
+   * INNER join makes a row of them, a SEMI or an ANTI join marks the outer tuple as matched.
+   */
+  void JoinPair(const Tuple &outer_tuple, size_t outer_idx, const Tuple &inner_tuple, const RID &inner_rid,
+                std::vector<bool> *matched);
+
+  /**
+   * Scans the inner table into inner_table_, by the key column of the index, with the rows read as the lookups read
+   * them: as the transaction sees them, and detoasted.
+   * @return false if it does not fit in the memory budget, in which case inner_table_ is left empty
+   */
+  bool BuildInnerTable();
+
   /** The nested index join plan node. */
   const NestedIndexJoinPlanNode *plan_;
+  std::unique_ptr<AbstractExecutor> child_;
+  TableMetadata *table_info_{nullptr};
+  IndexInfo *index_info_{nullptr};
+  /** The side of the predicate that is evaluated on the outer tuples to get the keys to look up */
+  const AbstractExpression *outer_key_{nullptr};
+  /** The outer tuples seen, and the number of them past which the join turns into a hash join */
+  size_t outer_rows_{0};
+  size_t switch_rows_{0};
+  /** Whether the join turned into a hash join, and the inner tuples it probes, by their keys */
+  bool hash_join_{false};
+  std::unordered_map<HashJoinKey, std::vector<Tuple>> inner_table_;
+  MemoryReservation memory_;
+  /** The joined rows of the current batch, and the next of them to hand out */
+  std::vector<Tuple> output_;
+  size_t output_idx_{0};
 };
 }  // namespace bustub
@@ -14,16 +14,24 @@
 
 #include <memory>
 #include <utility>
+#include <vector>
 
 #include "execution/executor_context.h"
 #include "execution/executors/abstract_executor.h"
+#include "execution/memory_manager.h"
 #include "execution/plans/nested_loop_join_plan.h"
 #include "storage/table/tuple.h"
 
 namespace bustub {
 /**
- * NestedLoopJoinExecutor joins two tables using nested loop.
- * The child executor can either be a sequential scan
+ * NestedLoopJoinExecutor joins two children on any predicate, for the joins that the optimizer cannot turn into a hash,
+ * merge or index join. It is a block nested loop: it copies the left tuples into a block as long as they fit the
+ * memory budget of the query (see MemoryReservation), then scans the right child once for the whole block, and starts
+ * the scan over for the next block. The right side is scanned once per block rather than once per left tuple.
+ *
+ * For each right tuple, the predicate is evaluated over the whole block in one tight loop, which collects the left
+ * tuples that match; those are then joined with it one per call of Next. The output comes in the order of the right
+ * tuples within a block. A block holds at least one left tuple, however small the budget.
  */
 class NestedLoopJoinExecutor : public AbstractExecutor {
  public:
@@ -45,8 +53,37 @@ class NestedLoopJoinExecutor : public AbstractExecutor {
 
   bool Next(Tuple *tuple, RID *rid) override;
 
+  /** @return the blocks of left tuples, i.e. the scans of the right side, so far */
+  size_t GetNumBlocks() const { return num_blocks_; }
+
  private:
+  /**
+   * Fills the block with the next left tuples, and starts the scan of the right side over.
+   * @return false if the left side has no tuples left
+   */
+  bool LoadBlock();
+
+  /** @return the output tuple of a left and a right tuple that join */
+  Tuple MakeOutput(const Tuple &left_tuple, const Tuple &right_tuple);
+
   /** The NestedLoop plan node to be executed. */
   const NestedLoopJoinPlanNode *plan_;
+  std::unique_ptr<AbstractExecutor> left_executor_;
+  std::unique_ptr<AbstractExecutor> right_executor_;
+
+  /** The left tuples of the block, copies, as the left child may hand out views of memory it reuses */
+  std::vector<Tuple> block_;
+  /** The bytes of the block, against the budget */
+  MemoryReservation memory_;
+  /** The left tuple read past the end of the last block, as it did not fit; it starts the next one */
+  Tuple pending_;
+  bool has_pending_{false};
+  bool left_done_{false};
+  size_t num_blocks_{0};
+
+  /** The right tuple being joined, and the indexes of the tuples of the block that it joins, the next one to output */
+  Tuple right_tuple_;
+  std::vector<uint32_t> matches_;
+  size_t next_match_{0};
 };
 }  // namespace bustub
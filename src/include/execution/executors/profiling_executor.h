@@ -0,0 +1,60 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// profiling_executor.h
+//
+// Identification: src/include/execution/executors/profiling_executor.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <memory>
+
+#include "execution/executors/abstract_executor.h"
+#include "execution/plans/abstract_plan.h"
+#include "execution/query_profile.h"
+
+namespace bustub {
+/**
+ * ProfilingExecutor wraps the executor of a plan node of a profiled query, and counts the rows, the wall and CPU time,
+ * the page fetches and the spilled bytes of each call on it into the counters of the node (see QueryProfile). The
+ * executors of a query that is not profiled are not wrapped, so they pay nothing for it.
+ */
+class ProfilingExecutor : public AbstractExecutor {
+ public:
+  /**
+   * @param exec_ctx the executor context, which has the profile
+   * @param plan the plan node the executor is of
+   * @param executor the executor to count the calls of
+   */
+  ProfilingExecutor(ExecutorContext *exec_ctx, const AbstractPlanNode *plan,
+                    std::unique_ptr<AbstractExecutor> &&executor);
+
+  const Schema *GetOutputSchema() override { return executor_->GetOutputSchema(); }
+
+  void Init() override;
+
+  bool Next(Tuple *tuple, RID *rid) override;
+
+  bool NextBatch(DataChunk *chunk) override;
+
+  void SetRowLimit(size_t limit) override { executor_->SetRowLimit(limit); }
+
+  /**
+   * @return the executor that does the work of the given one: the one it wraps if it is a ProfilingExecutor, under
+   * the TracingExecutor that wraps that if the query is traced too
+   */
+  static AbstractExecutor *Unwrap(AbstractExecutor *executor);
+
+ private:
+  /** The counters of a call, from before it to after it */
+  class Measurement;
+
+  std::unique_ptr<AbstractExecutor> executor_;
+  OperatorCounters *counters_;
+};
+}  // namespace bustub
@@ -0,0 +1,76 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// projection_executor.h
+//
+// Identification: src/include/execution/executors/projection_executor.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "execution/executor_context.h"
+#include "execution/executors/abstract_executor.h"
+#include "execution/plans/projection_plan.h"
+#include "execution/vector/data_chunk.h"
+#include "storage/table/tuple.h"
+
+namespace bustub {
+
+/**
+ * ProjectionExecutor makes the tuples of its output schema of the tuples of its child. Next reads just the columns that
+ * the expressions refer to out of the child's tuple, one GetValue each; NextBatch copies a column that is a column of
+ * the child a vector at a time, and evaluates the others row by row. Next evaluates an expression that several output
+ * columns share (see Optimizer::Simplify) once per tuple, for the first of them.
+ */
+class ProjectionExecutor : public AbstractExecutor {
+ public:
+  /**
+   * Creates a new projection executor.
+   * @param exec_ctx the executor context
+   * @param plan the projection plan to be executed
+   * @param child the child executor whose tuples are projected
+   */
+  ProjectionExecutor(ExecutorContext *exec_ctx, const ProjectionPlanNode *plan,
+                     std::unique_ptr<AbstractExecutor> &&child);
+
+  const Schema *GetOutputSchema() override { return plan_->OutputSchema(); }
+
+  void Init() override;
+
+  bool Next(Tuple *tuple, RID *rid) override;
+
+  bool NextBatch(DataChunk *chunk) override;
+
+  void SetRowLimit(size_t limit) override { child_->SetRowLimit(limit); }
+
+  /**
+   * Evaluates the columns of an output schema over the live rows of a chunk into the rows of the output chunk. A
+   * column of the output schema without an expression is the column of the chunk at its index.
+   */
+  static void Project(const Schema *output_schema, const DataChunk &rows, DataChunk *chunk);
+
+  /**
+   * @return for each column of an output schema, the first column that has the same expression, whose value it takes;
+   * the column itself if it is the first, or has no expression
+   */
+  static std::vector<uint32_t> SharedColumns(const Schema *output_schema);
+
+ private:
+  /** The projection plan node to be executed. */
+  const ProjectionPlanNode *plan_;
+  std::unique_ptr<AbstractExecutor> child_;
+  /** The batches of the child, which NextBatch projects */
+  std::unique_ptr<DataChunk> child_chunk_;
+  /** The column each output column takes its value from, see SharedColumns */
+  std::vector<uint32_t> sources_;
+};
+
+}  // namespace bustub
@@ -0,0 +1,61 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// sample_scan_executor.h
+//
+// Identification: src/include/execution/executors/sample_scan_executor.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <memory>
+#include <random>
+
+#include "buffer/buffer_access_strategy.h"
+#include "execution/executor_context.h"
+#include "execution/executors/abstract_executor.h"
+#include "execution/plans/sample_scan_plan.h"
+#include "storage/table/table_page_scanner.h"
+#include "storage/table/tuple.h"
+
+namespace bustub {
+
+/**
+ * SampleScanExecutor executes a scan of a random sample of a table of rows. A SYSTEM sample picks the pages of the
+ * table with TableHeap::GetSampledPageIds and scans just those, as the morsel of a TablePageScanner, so that it reads
+ * about fraction of the table; a BERNOULLI sample scans every page, and picks each row on its own. The picks are made
+ * by a generator seeded with the seed of the plan, in the order of the pages of the table, so a scan with the same
+ * seed returns the same rows of a table that did not change. The predicate is evaluated on the rows picked.
+ */
+class SampleScanExecutor : public AbstractExecutor {
+ public:
+  /**
+   * Creates a new sample scan executor.
+   * @param exec_ctx the executor context
+   * @param plan the sample scan plan to be executed
+   */
+  SampleScanExecutor(ExecutorContext *exec_ctx, const SampleScanPlanNode *plan);
+
+  void Init() override;
+
+  bool Next(Tuple *tuple, RID *rid) override;
+
+  const Schema *GetOutputSchema() override { return plan_->OutputSchema(); }
+
+ private:
+  /** The sample scan plan node to be executed. */
+  const SampleScanPlanNode *plan_;
+  const Schema *table_schema_{nullptr};
+  /** Keeps the scan from flushing the rest of the buffer pool; must outlive scanner_. */
+  std::unique_ptr<BufferAccessStrategy> strategy_;
+  std::unique_ptr<TablePageScanner> scanner_;
+  ToastStore *toast_{nullptr};
+  /** The picks of the rows of a BERNOULLI sample */
+  std::mt19937_64 random_;
+  std::bernoulli_distribution pick_;
+};
+}  // namespace bustub
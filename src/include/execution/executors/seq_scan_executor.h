@@ -12,17 +12,49 @@
 
 #pragma once
 
+#include <algorithm>
+#include <cstdint>
+#include <memory>
 #include <vector>
 
+#include "buffer/buffer_access_strategy.h"
+#include "execution/compiled_predicate.h"
 #include "execution/executor_context.h"
 #include "execution/executors/abstract_executor.h"
+#include "execution/join_key_filter.h"
 #include "execution/plans/seq_scan_plan.h"
+#include "storage/table/clustered_table.h"
+#include "storage/table/memory_table.h"
+#include "storage/table/pax_column_scanner.h"
+#include "storage/table/table_page_scanner.h"
 #include "storage/table/tuple.h"
 
 namespace bustub {
 
 /**
- * SeqScanExecutor executes a sequential scan over a table.
+ * SeqScanExecutor executes a sequential scan over a table. The predicate is evaluated on views of the tuples in their
+ * pages, and only the tuples that pass it are copied out: as they are, if the output schema is the first columns of
+ * the table, or else just the columns the output schema is made of, a GetValue each. A predicate that compares a
+ * column the table keeps a zone map of with a constant skips the pages the zone map rules out. A scan of a PAX table
+ * reads just the columns that the output schema and the predicate refer to, and one of a MEMORY table reads views of
+ * its rows, with no page to fetch; so does a scan of a tuple with toasted
+ * values, which fetches only the overflow chains of those columns. A hash join that the scan is the probe side
+ * of may push down a JoinKeyFilter, which drops the rows that cannot join as the predicate does. A predicate that
+ * compiles into a CompiledPredicate is pushed down into the TablePageScanner of a table of rows, which runs it over
+ * the bytes of the tuples in their pages, so that only the rows that pass it are handed to the scan at all. A scan of
+ * a whole large table of rows is a synchronized one, which starts where the scans of the table in progress are and
+ * wraps around (see TablePageScanner::Synchronized), so the rows of such a scan may come in any order while others run.
+ *
+ * A scan of a partitioned table reads the partitions one after the other, only those that a predicate that compares
+ * the partition key with a constant does not rule out. A scan of a CLUSTERED table reads its rows in key order, and
+ * such a predicate on the primary key makes it read just the leaves of the keys in range, as a lookup would.
+ *
+ * NextBatch decodes the columns it reads of the tuples of a table of rows straight from their pages into a chunk of
+ * the table's schema, a chunk at a time, filters it with the predicate's kernels over the column vectors, unless the
+ * scanner did already, and projects the rows that pass into the output schema a column at a time.
+ *
+ * A scan that its parent takes only so many tuples of (see SetRowLimit) stops reading the table once it returned them,
+ * and a batch of a scan that every row passes decodes no more rows than are left to return.
  */
 class SeqScanExecutor : public AbstractExecutor {
  public:
@@ -37,12 +69,74 @@ class SeqScanExecutor : public AbstractExecutor {
 
   bool Next(Tuple *tuple, RID *rid) override;
 
+  bool NextBatch(DataChunk *chunk) override;
+
   const Schema *GetOutputSchema() override { return plan_->OutputSchema(); }
 
+  /** @param filter the filter of the keys of the hash join the scan is the probe side of, which outlives the scan */
+  void SetJoinKeyFilter(JoinKeyFilter *filter) { join_filter_ = filter; }
+
+  void SetRowLimit(size_t limit) override { row_limit_ = std::min(row_limit_, limit); }
+
+  /**
+   * @return the heaps that a scan of a table of the ROW layout with a predicate reads: its heap, or the heaps of the
+   * partitions of a partitioned one that the predicate does not rule out, if it bounds the partition key
+   */
+  static std::vector<TableHeap *> ScannedHeaps(TableMetadata *table_info, const AbstractExpression *predicate);
+
  private:
+  /** Opens scanner_ over the next heap of heaps_. @return false if there is none */
+  bool OpenNextHeap();
+
+  /** Reads the next tuple of scanner_, or of the heaps after it once it runs out. @return false once all ran out */
+  bool NextView(Tuple *view);
+
+  /**
+   * Projects a row of table_schema_ into a tuple of the output schema if it passes the predicate.
+   * @return true if the row passes the predicate, and the tuple the join key filter, if there is one
+   */
+  bool Passes(const Tuple &row, Tuple *tuple) const;
+
+  /** Makes the tuple of the output schema of a row of table_schema_, of just the columns it is made of */
+  void ProjectRow(const Tuple &row, Tuple *tuple) const;
+
+  /** Evaluates the output columns over the live rows of a chunk of table_schema_ into the rows of the output chunk */
+  void Project(const DataChunk &rows, DataChunk *chunk) const;
+
+  /** @return a tuple of table_schema_ with the values of read_columns_, in their order, and NULL elsewhere */
+  Tuple PartialRow(const std::vector<Value> &columns) const;
+
   /** The sequential scan plan node to be executed. */
   const SeqScanPlanNode *plan_;
-  TableHeap *table_;
-  std::unique_ptr<TableIterator> iter_;
+  /** Keeps the scan from flushing the rest of the buffer pool; must outlive scanner_. */
+  std::unique_ptr<BufferAccessStrategy> strategy_;
+  std::unique_ptr<TablePageScanner> scanner_;
+  /** The heaps of a table of rows to scan, one after the other, and the index of the one after that of scanner_ */
+  std::vector<TableHeap *> heaps_;
+  size_t next_heap_{0};
+  /** The toasted values of the tuples of scanner_ are fetched through this, nullptr if the table keeps none. */
+  ToastStore *toast_{nullptr};
+  /** The scan of a PAX table, of the columns in read_columns_, instead of scanner_. */
+  std::unique_ptr<PaxColumnScanner> pax_scanner_;
+  /** The MEMORY table scanned instead, and the place of the next row of it to read */
+  MemoryTable *memory_table_{nullptr};
+  uint64_t memory_position_{0};
+  /** The scan of a CLUSTERED table instead */
+  std::unique_ptr<ClusteredTableScanner> clustered_scanner_;
+  /** The columns the output schema and the predicate refer to, of table_schema_. */
+  std::vector<uint32_t> read_columns_;
+  const Schema *table_schema_{nullptr};
+  /** Whether a copy of a tuple of the table is the row of the output schema, which ProjectRow makes otherwise */
+  bool copy_rows_{false};
+  /** The output column each output column takes its value from in ProjectRow, see ProjectionExecutor::SharedColumns */
+  std::vector<uint32_t> sources_;
+  /** The predicate compiled over tuples of table_schema_, which scanner_ runs; nullptr if it does not compile */
+  std::unique_ptr<CompiledPredicate> compiled_predicate_;
+  /** The rows of the table that NextBatch filters, before they are projected */
+  std::unique_ptr<DataChunk> table_chunk_;
+  JoinKeyFilter *join_filter_{nullptr};
+  /** The most tuples the parent takes, and the number returned since Init */
+  size_t row_limit_{SIZE_MAX};
+  size_t returned_{0};
 };
 }  // namespace bustub
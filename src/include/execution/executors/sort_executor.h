@@ -0,0 +1,112 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// sort_executor.h
+//
+// Identification: src/include/execution/executors/sort_executor.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "execution/executor_context.h"
+#include "execution/executors/abstract_executor.h"
+#include "execution/memory_manager.h"
+#include "execution/plans/sort_plan.h"
+#include "execution/sort_key.h"
+#include "storage/table/tmp_tuple_list.h"
+#include "storage/table/tuple.h"
+
+namespace bustub {
+
+/**
+ * SortExecutor returns the tuples of its child in the order of the ORDER BY keys of its plan, as an external merge
+ * sort. Init collects the tuples of the child with their normalized keys (see SortKeyEncoder), and sorts them by those
+ * keys: a radix sort orders the entries by the first 8 bytes of their keys, which every entry has a copy of, and only
+ * the entries whose first 8 bytes tie are compared by their whole keys, with a memcmp (see RadixSortByPrefix).
+ *
+ * Once the tuples outgrow the memory budget of the query, or their MemoryReservation is refused or revoked, they are
+ * sorted into a run, which is spilled to temp pages, and the next tuples start another one. The runs are then merged,
+ * as many of them at a time as a LoserTree of the budget's pages merges, FanIn, until no more than that are left,
+ * which Next merges as it returns their tuples. A tie between keys goes to the earlier tuple of the child, in memory
+ * as in a merge, so the sort is stable.
+ */
+class SortExecutor : public AbstractExecutor {
+ public:
+  /**
+   * Creates a new sort executor.
+   * @param exec_ctx the executor context
+   * @param plan the sort plan to be executed
+   * @param child the child executor whose tuples are sorted
+   */
+  SortExecutor(ExecutorContext *exec_ctx, const SortPlanNode *plan, std::unique_ptr<AbstractExecutor> &&child);
+
+  ~SortExecutor() override;
+
+  const Schema *GetOutputSchema() override { return plan_->OutputSchema(); }
+
+  void Init() override;
+
+  bool Next(Tuple *tuple, RID *rid) override;
+
+ private:
+  /** The most runs merged at once */
+  static constexpr size_t MAX_FAN_IN = 128;
+
+  /** A tuple with its normalized key, in keys_ */
+  struct SortEntry {
+    /** The first 8 bytes of the key, big-endian */
+    uint64_t prefix_;
+    uint32_t key_offset_;
+    uint32_t key_length_;
+    uint32_t tuple_index_;
+  };
+
+  /** Merges sorted runs with a LoserTree */
+  class RunMerger;
+
+  /** Adds a tuple of the child to the run in memory. */
+  void Add(Tuple &&tuple);
+
+  /** Sorts the entries of the run in memory, by their prefixes, then their keys, then the order of their tuples. */
+  void SortRun();
+
+  /** Sorts the run in memory and spills it to temp pages, as a run of runs_. */
+  void SpillRun();
+
+  /** @return the number of runs to merge at once, each of which is read a page at a time */
+  size_t FanIn() const;
+
+  /** The sort plan node to be executed. */
+  const SortPlanNode *plan_;
+  /** The child executor whose tuples are sorted. */
+  std::unique_ptr<AbstractExecutor> child_;
+  SortKeyEncoder encoder_;
+
+  /** The run in memory: the keys of its tuples, one after the other, its entries and its tuples */
+  std::string keys_;
+  std::vector<SortEntry> entries_;
+  std::vector<Tuple> tuples_;
+  size_t run_bytes_{0};
+  MemoryReservation memory_;
+  /** The next entry of the run in memory to return, if nothing was spilled */
+  size_t next_entry_{0};
+
+  /** The spilled runs, in the order of the child's tuples */
+  std::vector<std::unique_ptr<TmpTupleList>> runs_;
+  /** The merge of the last runs, which Next returns the tuples of */
+  std::unique_ptr<RunMerger> merger_;
+  /** The record of a spilled tuple being made or read */
+  std::string record_;
+  Tuple spilled_;
+};
+
+}  // namespace bustub
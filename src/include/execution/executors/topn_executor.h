@@ -0,0 +1,72 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// topn_executor.h
+//
+// Identification: src/include/execution/executors/topn_executor.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "execution/executor_context.h"
+#include "execution/executors/abstract_executor.h"
+#include "execution/plans/limit_plan.h"
+#include "execution/plans/sort_plan.h"
+#include "execution/sort_key.h"
+#include "storage/table/tuple.h"
+
+namespace bustub {
+
+/**
+ * TopNExecutor runs a limit over a sort, ORDER BY ... LIMIT k OFFSET m, without sorting all of the tuples: Init keeps
+ * the first k + m tuples of the order in a max-heap by their normalized keys, whose top is the last of them, and a
+ * tuple that goes after the top is dropped with a single comparison of its key; so the work is O(N log(k + m)), in
+ * O(k + m) memory. Next skips the first m of them. Tuples of the same keys keep the order of the child, as a sort has.
+ */
+class TopNExecutor : public AbstractExecutor {
+ public:
+  /**
+   * Creates a new top-n executor.
+   * @param exec_ctx the executor context
+   * @param limit_plan the limit plan to be executed
+   * @param sort_plan the child plan of the limit, whose keys the tuples are ordered by
+   * @param child the executor of the child of the sort
+   */
+  TopNExecutor(ExecutorContext *exec_ctx, const LimitPlanNode *limit_plan, const SortPlanNode *sort_plan,
+               std::unique_ptr<AbstractExecutor> &&child);
+
+  const Schema *GetOutputSchema() override { return limit_plan_->OutputSchema(); }
+
+  void Init() override;
+
+  bool Next(Tuple *tuple, RID *rid) override;
+
+ private:
+  /** A tuple with its normalized key, and its position in the child, which makes every entry a different one */
+  struct Entry {
+    std::string key_;
+    size_t position_;
+    Tuple tuple_;
+  };
+
+  /** @return true if the key and the position go before those of the entry */
+  static bool Before(const std::string &key, size_t position, const Entry &entry);
+
+  const LimitPlanNode *limit_plan_;
+  std::unique_ptr<AbstractExecutor> child_;
+  SortKeyEncoder encoder_;
+  /** The heap of the first tuples of the order, and after Init, the tuples in order */
+  std::vector<Entry> entries_;
+  size_t next_entry_{0};
+};
+
+}  // namespace bustub
@@ -0,0 +1,60 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// tracing_executor.h
+//
+// Identification: src/include/execution/executors/tracing_executor.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <chrono>  // NOLINT
+#include <memory>
+
+#include "execution/executors/abstract_executor.h"
+#include "execution/plans/abstract_plan.h"
+
+namespace bustub {
+/**
+ * TracingExecutor wraps the executor of a plan node of a query that runs while tracing is enabled, and records a span
+ * of the Tracer for each call of Init and NextBatch on it, named after the plan node, with the rows of the batch. A
+ * tuple-at-a-time Next call gets one only if it took MIN_NEXT_SPAN or longer, e.g. as it waited for a page or a lock,
+ * as the rings could not keep a span for every row. The executors made while tracing is off are not wrapped, so they
+ * pay nothing for it.
+ */
+class TracingExecutor : public AbstractExecutor {
+ public:
+  /**
+   * @param exec_ctx the executor context
+   * @param plan the plan node the executor is of
+   * @param executor the executor to trace the calls of
+   */
+  TracingExecutor(ExecutorContext *exec_ctx, const AbstractPlanNode *plan,
+                  std::unique_ptr<AbstractExecutor> &&executor);
+
+  const Schema *GetOutputSchema() override { return executor_->GetOutputSchema(); }
+
+  void Init() override;
+
+  bool Next(Tuple *tuple, RID *rid) override;
+
+  bool NextBatch(DataChunk *chunk) override;
+
+  void SetRowLimit(size_t limit) override { executor_->SetRowLimit(limit); }
+
+  /** @return the executor it wraps */
+  AbstractExecutor *GetExecutor() { return executor_.get(); }
+
+  /** The shortest Next call that is kept as a span */
+  static constexpr std::chrono::microseconds MIN_NEXT_SPAN{10};
+
+ private:
+  std::unique_ptr<AbstractExecutor> executor_;
+  /** The name of the spans, that of the type of the plan node */
+  const char *name_;
+};
+}  // namespace bustub
@@ -16,8 +16,10 @@
 #include <utility>
 #include <vector>
 
+#include "catalog/catalog.h"
 #include "execution/executor_context.h"
 #include "execution/executors/abstract_executor.h"
+#include "execution/index_update_buffer.h"
 #include "execution/plans/update_plan.h"
 #include "storage/table/tuple.h"
 #include "type/value_factory.h"
@@ -26,7 +28,13 @@ namespace bustub {
 
 /**
  * UpdateExecutor executes an update in a table.
- * Updated values from a child executor.
+ * Updated values from a child executor, which hands out whole tuples of the table.
+ *
+ * The rows are updated in batches: the tuples of a batch are updated a page at a time (see
+ * TableHeap::UpdateTuples), and the indexes whose keys the update touches are brought up to date at the end of the
+ * statement, see IndexUpdateBuffer. A tuple that no longer fits in its page is deleted and inserted again instead,
+ * under a new RID. A row of a CLUSTERED table whose primary key the update changes moves to the new key, and the RID
+ * of that key.
  */
 class UpdateExecutor : public AbstractExecutor {
   friend class UpdatePlanNode;
@@ -44,6 +52,10 @@ class UpdateExecutor : public AbstractExecutor {
 
   void Init() override;
 
+  // Note that Update does not make use of the tuple pointer being passed in.
+  // Each call updates a batch of up to BATCH_SIZE tuples, and rid is set to the last of them. The call that finds
+  // nothing left to update, or fails, brings the indexes up to date with every row updated.
+  // We return false if the update failed for any reason or there was nothing left to update, and true otherwise.
   bool Next([[maybe_unused]] Tuple *tuple, RID *rid) override;
 
   /*
@@ -76,11 +88,19 @@ class UpdateExecutor : public AbstractExecutor {
   }
 
  private:
+  /** The number of tuples each call to Next updates at most. */
+  static constexpr size_t BATCH_SIZE = 512;
+
+  /** Updates a batch of tuples in the table, whichever its layout; new_rids are set to where the tuples end up. */
+  bool UpdateBatch(const std::vector<Tuple> &new_tuples, const std::vector<RID> &rids, std::vector<RID> *new_rids);
+
   /** The update plan node to be executed. */
   const UpdatePlanNode *plan_;
   /** Metadata identifying the table that should be updated. */
   const TableMetadata *table_info_;
   /** The child executor to obtain value from. */
   std::unique_ptr<AbstractExecutor> child_executor_;
+  /** The index changes of the rows updated, until the end of the statement. */
+  std::unique_ptr<IndexUpdateBuffer> index_updates_;
 };
 }  // namespace bustub
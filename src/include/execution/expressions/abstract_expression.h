@@ -16,6 +16,7 @@
 #include <vector>
 
 #include "catalog/schema.h"
+#include "execution/vector/data_chunk.h"
 #include "storage/table/tuple.h"
 
 namespace bustub {
@@ -58,6 +59,35 @@ class AbstractExpression {
    */
   virtual Value EvaluateAggregate(const std::vector<Value> &group_bys, const std::vector<Value> &aggregates) const = 0;
 
+  /**
+   * Returns the value obtained by evaluating a row of a chunk of the schema the expression refers to. Expressions that
+   * cannot read the column vectors themselves evaluate the row as a tuple.
+   * @param chunk the chunk
+   * @param row the row of the chunk, which need not be live
+   * @return the value obtained by evaluating the row
+   */
+  virtual Value EvaluateRow(const DataChunk &chunk, uint32_t row) const {
+    Tuple tuple = chunk.GetTuple(row);
+    return Evaluate(&tuple, chunk.GetSchema());
+  }
+
+  /**
+   * Evaluates a predicate on the live rows of a chunk of the schema the expression refers to, and narrows the chunk's
+   * selection down to the rows it is true for. Predicates without a kernel over column vectors go row by row.
+   */
+  virtual void EvaluateBatch(DataChunk *chunk) const {
+    std::vector<uint32_t> selection;
+    selection.reserve(chunk->GetSelectedCount());
+    for (size_t i = 0; i < chunk->GetSelectedCount(); i++) {
+      uint32_t row = chunk->GetSelectedRow(i);
+      Value result = EvaluateRow(*chunk, row);
+      if (!result.IsNull() && result.GetAs<bool>()) {
+        selection.push_back(row);
+      }
+    }
+    chunk->SetSelection(std::move(selection));
+  }
+
   /** @return the child_idx'th child of this expression */
   const AbstractExpression *GetChildAt(uint32_t child_idx) const { return children_[child_idx]; }
 
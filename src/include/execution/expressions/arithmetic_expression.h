@@ -0,0 +1,77 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// arithmetic_expression.h
+//
+// Identification: src/include/execution/expressions/arithmetic_expression.h
+//
+// Copyright (c) 2015-19, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <algorithm>
+#include <vector>
+
+#include "execution/expressions/abstract_expression.h"
+
+namespace bustub {
+
+/** ArithmeticType represents the operator of an arithmetic expression. */
+enum class ArithmeticType { Plus, Minus, Multiply, Divide };
+
+/**
+ * ArithmeticExpression represents (left op right) of two numeric expressions, computed by the Value methods: it is
+ * NULL if either side is, and of the wider of the two types, a DECIMAL if either of them is one. Over aggregates, it
+ * makes the AVG of a group out of its SUM and COUNT, which the AggregationPlanNode has no aggregate of its own for.
+ */
+class ArithmeticExpression : public AbstractExpression {
+ public:
+  /** Creates a new arithmetic expression representing (left arith_type right). */
+  ArithmeticExpression(const AbstractExpression *left, const AbstractExpression *right, ArithmeticType arith_type)
+      : AbstractExpression({left, right}, std::max(left->GetReturnType(), right->GetReturnType())),
+        arith_type_{arith_type} {}
+
+  /** @return the operator of the expression */
+  ArithmeticType GetArithmeticType() const { return arith_type_; }
+
+  Value Evaluate(const Tuple *tuple, const Schema *schema) const override {
+    return Compute(GetChildAt(0)->Evaluate(tuple, schema), GetChildAt(1)->Evaluate(tuple, schema));
+  }
+
+  Value EvaluateJoin(const Tuple *left_tuple, const Schema *left_schema, const Tuple *right_tuple,
+                     const Schema *right_schema) const override {
+    return Compute(GetChildAt(0)->EvaluateJoin(left_tuple, left_schema, right_tuple, right_schema),
+                   GetChildAt(1)->EvaluateJoin(left_tuple, left_schema, right_tuple, right_schema));
+  }
+
+  Value EvaluateRow(const DataChunk &chunk, uint32_t row) const override {
+    return Compute(GetChildAt(0)->EvaluateRow(chunk, row), GetChildAt(1)->EvaluateRow(chunk, row));
+  }
+
+  Value EvaluateAggregate(const std::vector<Value> &group_bys, const std::vector<Value> &aggregates) const override {
+    return Compute(GetChildAt(0)->EvaluateAggregate(group_bys, aggregates),
+                   GetChildAt(1)->EvaluateAggregate(group_bys, aggregates));
+  }
+
+ private:
+  Value Compute(const Value &lhs, const Value &rhs) const {
+    switch (arith_type_) {
+      case ArithmeticType::Plus:
+        return lhs.Add(rhs);
+      case ArithmeticType::Minus:
+        return lhs.Subtract(rhs);
+      case ArithmeticType::Multiply:
+        return lhs.Multiply(rhs);
+      case ArithmeticType::Divide:
+        return lhs.Divide(rhs);
+    }
+    UNREACHABLE("unknown arithmetic type");
+  }
+
+  ArithmeticType arith_type_;
+};
+
+}  // namespace bustub
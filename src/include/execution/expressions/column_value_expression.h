@@ -41,6 +41,10 @@ class ColumnValueExpression : public AbstractExpression {
                            : right_tuple->GetValue(right_schema, col_idx_);
   }
 
+  Value EvaluateRow(const DataChunk &chunk, uint32_t row) const override {
+    return chunk.GetColumn(col_idx_).GetValue(row);
+  }
+
   Value EvaluateAggregate(const std::vector<Value> &group_bys, const std::vector<Value> &aggregates) const override {
     BUSTUB_ASSERT(false, "Aggregation should only refer to group-by and aggregates.");
   }
@@ -17,8 +17,13 @@
 
 #include "catalog/schema.h"
 #include "execution/expressions/abstract_expression.h"
+#include "execution/expressions/column_value_expression.h"
+#include "execution/expressions/constant_value_expression.h"
+#include "execution/vector/data_chunk.h"
+#include "execution/vector/filter_kernels.h"
 #include "storage/table/tuple.h"
 #include "type/value_factory.h"
+#include "type/value_kernels.h"
 
 namespace bustub {
 
@@ -26,13 +31,22 @@ namespace bustub {
 enum class ComparisonType { Equal, NotEqual, LessThan, LessThanOrEqual, GreaterThan, GreaterThanOrEqual };
 
 /**
- * ComparisonExpression represents two expressions being compared.
+ * ComparisonExpression represents two expressions being compared. If both are of the same fixed-width numeric type,
+ * the comparison is bound to its kernel when the expression is built. A comparison of a column with a constant or
+ * with another column of its type is also bound to a filter kernel, which EvaluateBatch runs over column vectors.
  */
 class ComparisonExpression : public AbstractExpression {
  public:
   /** Creates a new comparison expression representing (left comp_type right). */
   ComparisonExpression(const AbstractExpression *left, const AbstractExpression *right, ComparisonType comp_type)
-      : AbstractExpression({left, right}, TypeId::BOOLEAN), comp_type_{comp_type} {}
+      : AbstractExpression({left, right}, TypeId::BOOLEAN),
+        comp_type_{comp_type},
+        kernel_{BindKernel(comp_type, left->GetReturnType(), right->GetReturnType())} {
+    BindFilterKernel(left, right);
+  }
+
+  /** @return the type of comparison */
+  ComparisonType GetComparisonType() const { return comp_type_; }
 
   Value Evaluate(const Tuple *tuple, const Schema *schema) const override {
     Value lhs = GetChildAt(0)->Evaluate(tuple, schema);
@@ -47,14 +61,126 @@ class ComparisonExpression : public AbstractExpression {
     return ValueFactory::GetBooleanValue(PerformComparison(lhs, rhs));
   }
 
+  Value EvaluateRow(const DataChunk &chunk, uint32_t row) const override {
+    Value lhs = GetChildAt(0)->EvaluateRow(chunk, row);
+    Value rhs = GetChildAt(1)->EvaluateRow(chunk, row);
+    return ValueFactory::GetBooleanValue(PerformComparison(lhs, rhs));
+  }
+
   Value EvaluateAggregate(const std::vector<Value> &group_bys, const std::vector<Value> &aggregates) const override {
     Value lhs = GetChildAt(0)->EvaluateAggregate(group_bys, aggregates);
     Value rhs = GetChildAt(1)->EvaluateAggregate(group_bys, aggregates);
     return ValueFactory::GetBooleanValue(PerformComparison(lhs, rhs));
   }
 
+  /** Comparisons that have no filter kernel go row by row. */
+  void EvaluateBatch(DataChunk *chunk) const override {
+    std::vector<uint32_t> selection(chunk->GetSelectedCount());
+    size_t selected = 0;
+    if (filter_kernel_ != nullptr) {
+      const ColumnVector *right = filter_constant_ ? nullptr : &chunk->GetColumn(filter_right_col_);
+      const uint32_t *rows = chunk->HasSelection() ? chunk->GetSelection().data() : nullptr;
+      selected = filter_kernel_(chunk->GetColumn(filter_left_col_), right, filter_value_, rows,
+                                chunk->GetSelectedCount(), selection.data());
+    } else {
+      for (size_t i = 0; i < chunk->GetSelectedCount(); i++) {
+        uint32_t row = chunk->GetSelectedRow(i);
+        Value result = EvaluateRow(*chunk, row);
+        if (!result.IsNull() && result.GetAs<bool>()) {
+          selection[selected++] = row;
+        }
+      }
+    }
+    selection.resize(selected);
+    chunk->SetSelection(std::move(selection));
+  }
+
  private:
+  /** @return the comparison of (right comp_type left) that is the same as (left comp_type right) */
+  static ComparisonType Mirror(ComparisonType comp_type) {
+    switch (comp_type) {
+      case ComparisonType::LessThan:
+        return ComparisonType::GreaterThan;
+      case ComparisonType::LessThanOrEqual:
+        return ComparisonType::GreaterThanOrEqual;
+      case ComparisonType::GreaterThan:
+        return ComparisonType::LessThan;
+      case ComparisonType::GreaterThanOrEqual:
+        return ComparisonType::LessThanOrEqual;
+      default:
+        return comp_type;
+    }
+  }
+
+  static FilterKernel BindFilter(ComparisonType comp_type, TypeId left, TypeId right) {
+    switch (comp_type) {
+      case ComparisonType::Equal:
+        return bustub::BindFilter<std::equal_to<>>(left, right);
+      case ComparisonType::NotEqual:
+        return bustub::BindFilter<std::not_equal_to<>>(left, right);
+      case ComparisonType::LessThan:
+        return bustub::BindFilter<std::less<>>(left, right);
+      case ComparisonType::LessThanOrEqual:
+        return bustub::BindFilter<std::less_equal<>>(left, right);
+      case ComparisonType::GreaterThan:
+        return bustub::BindFilter<std::greater<>>(left, right);
+      case ComparisonType::GreaterThanOrEqual:
+        return bustub::BindFilter<std::greater_equal<>>(left, right);
+    }
+    return nullptr;
+  }
+
+  /** Binds the filter kernel if the comparison is of a column with a constant or with another column */
+  void BindFilterKernel(const AbstractExpression *left, const AbstractExpression *right) {
+    const auto *left_column = dynamic_cast<const ColumnValueExpression *>(left);
+    const auto *right_column = dynamic_cast<const ColumnValueExpression *>(right);
+    ComparisonType comp_type = comp_type_;
+    if (left_column == nullptr && right_column != nullptr) {
+      // a constant on the left is moved to the right
+      std::swap(left, right);
+      std::swap(left_column, right_column);
+      comp_type = Mirror(comp_type);
+    }
+    if (left_column == nullptr || left_column->GetTupleIdx() != 0) {
+      return;
+    }
+    filter_left_col_ = left_column->GetColIdx();
+    if (right_column != nullptr) {
+      if (right_column->GetTupleIdx() != 0) {
+        return;
+      }
+      filter_right_col_ = right_column->GetColIdx();
+    } else if (dynamic_cast<const ConstantValueExpression *>(right) != nullptr) {
+      filter_constant_ = true;
+      filter_value_ = right->Evaluate(nullptr, nullptr);
+    } else {
+      return;
+    }
+    filter_kernel_ = BindFilter(comp_type, left->GetReturnType(), right->GetReturnType());
+  }
+
+  static CompareKernel BindKernel(ComparisonType comp_type, TypeId left, TypeId right) {
+    switch (comp_type) {
+      case ComparisonType::Equal:
+        return BindCompare<std::equal_to<>>(left, right);
+      case ComparisonType::NotEqual:
+        return BindCompare<std::not_equal_to<>>(left, right);
+      case ComparisonType::LessThan:
+        return BindCompare<std::less<>>(left, right);
+      case ComparisonType::LessThanOrEqual:
+        return BindCompare<std::less_equal<>>(left, right);
+      case ComparisonType::GreaterThan:
+        return BindCompare<std::greater<>>(left, right);
+      case ComparisonType::GreaterThanOrEqual:
+        return BindCompare<std::greater_equal<>>(left, right);
+    }
+    return nullptr;
+  }
+
   CmpBool PerformComparison(const Value &lhs, const Value &rhs) const {
+    if (kernel_ != nullptr) {
+      return kernel_(lhs, rhs);
+    }
     switch (comp_type_) {
       case ComparisonType::Equal:
         return lhs.CompareEquals(rhs);
@@ -75,5 +201,14 @@ class ComparisonExpression : public AbstractExpression {
 
   std::vector<const AbstractExpression *> children_;
   ComparisonType comp_type_;
+  /** the kernel of the comparison, nullptr to compare through the Value methods */
+  CompareKernel kernel_;
+  /** the filter kernel of EvaluateBatch, nullptr to evaluate batches row by row */
+  FilterKernel filter_kernel_{nullptr};
+  /** the columns it compares, or the column on the left and filter_value_ if filter_constant_ */
+  uint32_t filter_left_col_{0};
+  uint32_t filter_right_col_{0};
+  bool filter_constant_{false};
+  Value filter_value_;
 };
 }  // namespace bustub
@@ -0,0 +1,80 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// conjunction_expression.h
+//
+// Identification: src/include/execution/expressions/conjunction_expression.h
+//
+// Copyright (c) 2015-19, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <utility>
+#include <vector>
+
+#include "execution/expressions/abstract_expression.h"
+#include "type/value_factory.h"
+
+namespace bustub {
+
+/**
+ * ConjunctionExpression is the AND of its children, which are predicates. It is false if any of them is false, NULL
+ * if none is false but one is NULL, and true otherwise. EvaluateBatch narrows the selection of a chunk by each child in
+ * turn, so every comparison with a filter kernel runs as one over column vectors, on the rows the ones before it left.
+ */
+class ConjunctionExpression : public AbstractExpression {
+ public:
+  /** Creates a new conjunction of the predicates, which are evaluated in the order they are given in */
+  explicit ConjunctionExpression(std::vector<const AbstractExpression *> &&children)
+      : AbstractExpression(std::move(children), TypeId::BOOLEAN) {}
+
+  Value Evaluate(const Tuple *tuple, const Schema *schema) const override {
+    return Combine([&](const AbstractExpression *child) { return child->Evaluate(tuple, schema); });
+  }
+
+  Value EvaluateJoin(const Tuple *left_tuple, const Schema *left_schema, const Tuple *right_tuple,
+                     const Schema *right_schema) const override {
+    return Combine([&](const AbstractExpression *child) {
+      return child->EvaluateJoin(left_tuple, left_schema, right_tuple, right_schema);
+    });
+  }
+
+  Value EvaluateRow(const DataChunk &chunk, uint32_t row) const override {
+    return Combine([&](const AbstractExpression *child) { return child->EvaluateRow(chunk, row); });
+  }
+
+  Value EvaluateAggregate(const std::vector<Value> &group_bys, const std::vector<Value> &aggregates) const override {
+    return Combine([&](const AbstractExpression *child) { return child->EvaluateAggregate(group_bys, aggregates); });
+  }
+
+  /** A row that is NULL for a child is dropped as one it is false for, as a conjunction that is NULL is dropped. */
+  void EvaluateBatch(DataChunk *chunk) const override {
+    for (const AbstractExpression *child : GetChildren()) {
+      if (chunk->GetSelectedCount() == 0) {
+        return;
+      }
+      child->EvaluateBatch(chunk);
+    }
+  }
+
+ private:
+  /** @return the conjunction of the values of the children, stopping at the first that is false */
+  template <typename EvaluateChild>
+  Value Combine(EvaluateChild evaluate_child) const {
+    bool is_null = false;
+    for (const AbstractExpression *child : GetChildren()) {
+      Value value = evaluate_child(child);
+      if (value.IsNull()) {
+        is_null = true;
+      } else if (!value.GetAs<bool>()) {
+        return ValueFactory::GetBooleanValue(false);
+      }
+    }
+    return is_null ? ValueFactory::GetNullValueByType(TypeId::BOOLEAN) : ValueFactory::GetBooleanValue(true);
+  }
+};
+
+}  // namespace bustub
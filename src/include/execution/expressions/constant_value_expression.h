@@ -32,6 +32,8 @@ class ConstantValueExpression : public AbstractExpression {
     return val_;
   }
 
+  Value EvaluateRow(const DataChunk &chunk, uint32_t row) const override { return val_; }
+
   Value EvaluateAggregate(const std::vector<Value> &group_bys, const std::vector<Value> &aggregates) const override {
     return val_;
   }
@@ -0,0 +1,58 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// parameter_value_expression.h
+//
+// Identification: src/include/execution/expressions/parameter_value_expression.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <vector>
+
+#include "execution/expressions/abstract_expression.h"
+
+namespace bustub {
+/**
+ * ParameterValueExpression represents a parameter placeholder of a prepared statement, the "?" of SQL. It evaluates to
+ * whatever value the parameter is bound to when it is evaluated, which is the same for every tuple of a run of the
+ * statement; see PreparedStatement.
+ */
+class ParameterValueExpression : public AbstractExpression {
+ public:
+  /**
+   * Creates a new parameter value expression.
+   * @param parameters the values of the parameters of the statement, which the statement binds before each run
+   * @param param_idx the index of the parameter in them
+   * @param ret_type the type of the parameter
+   */
+  ParameterValueExpression(const std::vector<Value> *parameters, uint32_t param_idx, TypeId ret_type)
+      : AbstractExpression({}, ret_type), parameters_(parameters), param_idx_(param_idx) {}
+
+  Value Evaluate(const Tuple *tuple, const Schema *schema) const override { return GetValue(); }
+
+  Value EvaluateJoin(const Tuple *left_tuple, const Schema *left_schema, const Tuple *right_tuple,
+                     const Schema *right_schema) const override {
+    return GetValue();
+  }
+
+  Value EvaluateRow(const DataChunk &chunk, uint32_t row) const override { return GetValue(); }
+
+  Value EvaluateAggregate(const std::vector<Value> &group_bys, const std::vector<Value> &aggregates) const override {
+    return GetValue();
+  }
+
+  /** @return the value the parameter is bound to */
+  const Value &GetValue() const { return (*parameters_)[param_idx_]; }
+
+  uint32_t GetParamIdx() const { return param_idx_; }
+
+ private:
+  const std::vector<Value> *parameters_;
+  uint32_t param_idx_;
+};
+}  // namespace bustub
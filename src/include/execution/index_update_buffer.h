@@ -0,0 +1,95 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// index_update_buffer.h
+//
+// Identification: src/include/execution/index_update_buffer.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <utility>
+#include <vector>
+
+#include "catalog/catalog.h"
+#include "concurrency/transaction.h"
+#include "execution/executor_context.h"
+#include "storage/table/tuple.h"
+
+namespace bustub {
+
+/**
+ * IndexUpdateBuffer defers the index changes of the rows a statement writes to the end of the statement: the entries
+ * the rows add to and remove from each index are kept aside, and are applied an index at a time by Flush, through
+ * Catalog::DeleteIndexEntries and Catalog::InsertIndexEntries, which a B+ tree applies in key order. A large INSERT ...
+ * SELECT then descends to each leaf about once per batch rather than once per row, and fills an empty index from the
+ * bottom up.
+ *
+ * The removals of an index are applied before its additions, so that a statement that swaps the keys of rows never
+ * has two entries of a key in a unique index at once. The entries are put in the transaction's index write set as
+ * they are applied, to be rolled back as the executors' always were; the changes of an aborted transaction are
+ * dropped, as its rows are rolled back. Until Flush, the statement does not see its own index changes, which no
+ * executor reads back. The buffer flushes itself once MAX_PENDING_ROWS rows wait, to bound its memory.
+ *
+ * The indexes of the table are looked up again as a row is recorded whenever the catalog has added one since, so that
+ * an index created while the statement runs, which the catalog logs the changes to while it is built, gets those of
+ * the rows written from then on. The rows written before were in the table when its build started scanning it.
+ */
+class IndexUpdateBuffer {
+ public:
+  /**
+   * @param exec_ctx the context of the statement, of its transaction
+   * @param table_info the table the rows are written to
+   */
+  IndexUpdateBuffer(ExecutorContext *exec_ctx, const TableMetadata *table_info);
+
+  /** Adds the entries of a row inserted. */
+  void Insert(const Tuple &tuple, const RID &rid);
+
+  /** Removes the entries of a row deleted. */
+  void Delete(const Tuple &tuple, const RID &rid);
+
+  /**
+   * Moves the entries of an updated row, of the indexes whose key the update changed, or of every index if the row
+   * moved to a new RID.
+   */
+  void Update(const Tuple &old_tuple, const Tuple &new_tuple, const RID &rid, const RID &new_rid);
+
+  /** Applies the changes kept aside, if the transaction is not aborted, and forgets them. */
+  void Flush();
+
+  /** The number of rows whose changes are kept aside before the buffer flushes itself. */
+  static constexpr size_t MAX_PENDING_ROWS = 1 << 16;
+
+ private:
+  /** The changes to an index waiting for Flush, and the write records that roll them back. */
+  struct PendingChanges {
+    std::vector<std::pair<Tuple, RID>> deletes_;
+    std::vector<std::pair<Tuple, RID>> inserts_;
+    std::vector<IndexWriteRecord> records_;
+  };
+
+  /** @return the key of a row in an index */
+  Tuple KeyOf(const Tuple &tuple, const IndexInfo *index_info) const;
+
+  /** Counts a row written, and flushes once MAX_PENDING_ROWS are. */
+  void AddRow();
+
+  /** Looks the indexes of the table up again if the catalog has added an index since they were. */
+  void RefreshIndexes();
+
+  ExecutorContext *exec_ctx_;
+  const TableMetadata *table_info_;
+  std::vector<IndexInfo *> indexes_;
+  /** The catalog's index version that indexes_ were looked up at */
+  uint64_t index_version_;
+  /** pending_[i] are the changes to indexes_[i] */
+  std::vector<PendingChanges> pending_;
+  size_t pending_rows_{0};
+};
+
+}  // namespace bustub
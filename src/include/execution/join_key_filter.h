@@ -0,0 +1,89 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// join_key_filter.h
+//
+// Identification: src/include/execution/join_key_filter.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <vector>
+
+#include "common/util/bloom_filter.h"
+#include "execution/plans/hash_join_plan.h"
+
+namespace bustub {
+
+/**
+ * JoinKeyFilter is what a hash join pushes down into the scan of its probe side: a Bloom filter of the keys of its
+ * build side, which the scan checks the probe keys of its rows against, to drop the rows that cannot join before they
+ * are copied out of their pages. A row with a null key joins nothing either.
+ *
+ * A filter that lets nearly every row through costs more than it saves, so it turns itself off once it has passed
+ * more than MAX_PASS_RATE of the first SAMPLE_SIZE rows it checked.
+ */
+class JoinKeyFilter {
+ public:
+  static constexpr size_t SAMPLE_SIZE = 1024;
+  static constexpr double MAX_PASS_RATE = 0.9;
+
+  /**
+   * @param num_keys the number of build keys that are to be inserted
+   * @param probe_keys the key expressions over the rows of the probe side
+   */
+  JoinKeyFilter(size_t num_keys, const std::vector<const AbstractExpression *> *probe_keys)
+      : filter_(num_keys), probe_keys_(probe_keys) {}
+
+  /** Inserts the std::hash of a key of the build side */
+  void Insert(hash_t key_hash) { filter_.Insert(key_hash); }
+
+  /** @return false if the row of the probe side cannot join */
+  bool MayMatch(const Tuple &row, const Schema *schema) {
+    return MayMatchKey([&](const AbstractExpression *expr) { return expr->Evaluate(&row, schema); });
+  }
+
+  /** @return false if the row of a chunk of the probe side cannot join */
+  bool MayMatch(const DataChunk &chunk, uint32_t row) {
+    return MayMatchKey([&](const AbstractExpression *expr) { return expr->EvaluateRow(chunk, row); });
+  }
+
+  /** @return whether the filter still drops rows */
+  bool IsEnabled() const { return enabled_; }
+
+ private:
+  /** @return false if the probe key that evaluate makes of the key expressions cannot join */
+  template <typename Evaluate>
+  bool MayMatchKey(Evaluate evaluate) {
+    if (!enabled_) {
+      return true;
+    }
+    key_.keys_.clear();
+    for (const AbstractExpression *expr : *probe_keys_) {
+      key_.keys_.push_back(evaluate(expr));
+      if (key_.keys_.back().IsNull()) {
+        return false;
+      }
+    }
+    bool passed = filter_.MayContain(std::hash<HashJoinKey>{}(key_));
+    passed_ += passed ? 1 : 0;
+    if (++checked_ == SAMPLE_SIZE && passed_ > MAX_PASS_RATE * SAMPLE_SIZE) {
+      enabled_ = false;
+    }
+    return passed;
+  }
+
+  BloomFilter filter_;
+  const std::vector<const AbstractExpression *> *probe_keys_;
+  /** The key of the row that was checked last, kept for the memory of its values */
+  HashJoinKey key_;
+  size_t checked_{0};
+  size_t passed_{0};
+  bool enabled_{true};
+};
+
+}  // namespace bustub
@@ -0,0 +1,77 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// loser_tree.h
+//
+// Identification: src/include/execution/loser_tree.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+#include "common/macros.h"
+
+namespace bustub {
+
+/**
+ * LoserTree picks the least of the heads of k sorted sources, for a k-way merge. It is a tournament tree whose inner
+ * nodes keep the loser of the match played there, and whose root keeps the winner; when the winner's source moves on to
+ * its next head, the new head replays just the matches on the path from its leaf to the root, against the losers kept
+ * there, which is log2(k) comparisons, and half those of a binary heap.
+ *
+ * Less(a, b) tells whether the head of source a goes before that of source b. A source that is exhausted has to go
+ * after every other one, so that it loses all its matches, and the merge is done once the winner is exhausted.
+ */
+template <typename Less>
+class LoserTree {
+ public:
+  /**
+   * Creates a tree of the sources, which have their first heads.
+   * @param num_sources the number of sources, at least one
+   * @param less the order of the heads of sources
+   */
+  LoserTree(size_t num_sources, Less less) : num_sources_(num_sources), less_(std::move(less)), tree_(num_sources) {
+    BUSTUB_ASSERT(num_sources_ > 0, "a merge has sources");
+    // every source climbs till it finds a node no one is at yet, and waits there for the winner of the other side
+    tree_.assign(num_sources_, NONE);
+    for (size_t source = num_sources_; source-- > 0;) {
+      Replay(source, true);
+    }
+  }
+
+  /** @return the source of the least head */
+  size_t Top() const { return tree_[0]; }
+
+  /** Replays the matches of the source of the least head, once it has moved on to its next one. */
+  void Replay() { Replay(tree_[0], false); }
+
+ private:
+  static constexpr size_t NONE = static_cast<size_t>(-1);
+
+  void Replay(size_t winner, bool building) {
+    for (size_t node = (winner + num_sources_) / 2; node > 0; node /= 2) {
+      if (building && tree_[node] == NONE) {
+        tree_[node] = winner;
+        return;
+      }
+      if (less_(tree_[node], winner)) {
+        std::swap(winner, tree_[node]);
+      }
+    }
+    tree_[0] = winner;
+  }
+
+  size_t num_sources_;
+  Less less_;
+  /** The winner at 0, and the losers of the matches at the inner nodes 1 to num_sources - 1 */
+  std::vector<size_t> tree_;
+};
+
+}  // namespace bustub
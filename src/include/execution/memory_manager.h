@@ -0,0 +1,137 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// memory_manager.h
+//
+// Identification: src/include/execution/memory_manager.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <mutex>  // NOLINT
+#include <unordered_map>
+
+#include "common/macros.h"
+#include "common/memory_tracker.h"
+
+namespace bustub {
+
+class ExecutorContext;
+class MemoryReservation;
+
+/**
+ * MemoryManager grants the memory of a budget that the queries running at the same time share, to the
+ * MemoryReservations of their operators. When a grant would take more than is left, it is refused, and the
+ * operator that asked spills instead; the largest reservation of another operator is revoked as well, so that it
+ * spills the next time it grows, and gives the memory back. Revocation is cooperative: an operator keeps what it
+ * holds until it next asks for more.
+ */
+class MemoryManager {
+ public:
+  /** @param limit the bytes the reservations of all queries may hold at once */
+  explicit MemoryManager(size_t limit) : limit_(limit) {}
+
+  DISALLOW_COPY_AND_MOVE(MemoryManager);
+
+  ~MemoryManager() = default;
+
+  /** @return the bytes the reservations of all queries may hold at once */
+  size_t GetLimit() const { return limit_; }
+
+  /** @return the bytes granted now */
+  size_t GetReserved() const;
+
+  /** @return the most bytes that were granted at once */
+  size_t GetPeakReserved() const;
+
+ private:
+  friend class MemoryReservation;
+
+  /**
+   * Grants the reservation bytes more, or refuses and revokes the largest other reservation.
+   * @return false if the grant was refused
+   */
+  bool Grant(MemoryReservation *reservation, size_t bytes);
+
+  /** Takes back bytes of what the reservation was granted, and forgets it if it holds nothing any more */
+  void Release(MemoryReservation *reservation, size_t bytes);
+
+  const size_t limit_;
+  mutable std::mutex latch_;
+  size_t reserved_{0};
+  size_t peak_reserved_{0};
+  /** The reservations that hold memory, and how much, from which the one to revoke is picked */
+  std::unordered_map<MemoryReservation *, size_t> holders_;
+};
+
+/**
+ * MemoryReservation accounts for the memory an operator holds, e.g. in its hash table or its sort run, against the
+ * memory budget of its query (ExecutorContext::GetMemoryBudget), or a part of it, and against the MemoryManager of the
+ * query if it has one. The operator reports the bytes it holds with Resize as they change, and spills when Resize
+ * refuses them; what it held is given back when it resizes to less or the reservation is destroyed.
+ *
+ * The reservation takes memory from the manager in units of GRANT_UNIT, so that most calls of Resize do not touch
+ * it. A reservation is for a single thread; a parallel operator has one per thread.
+ */
+class MemoryReservation {
+ public:
+  /** The size of the steps in which memory is taken from the MemoryManager */
+  static constexpr size_t GRANT_UNIT = 64 * 1024;
+
+  /**
+   * @param exec_ctx the context of the query, whose budget limits the reservation
+   * @param category what the memory is of, as the MemoryTracker of the query accounts for it
+   */
+  explicit MemoryReservation(ExecutorContext *exec_ctx, MemoryCategory category = MemoryCategory::OTHER)
+      : exec_ctx_(exec_ctx), category_(category) {}
+
+  /**
+   * @param exec_ctx the context of the query
+   * @param category what the memory is of
+   * @param limit the bytes the reservation may hold, instead of the budget of the query
+   */
+  MemoryReservation(ExecutorContext *exec_ctx, MemoryCategory category, size_t limit)
+      : exec_ctx_(exec_ctx), category_(category), limit_(limit), fixed_(true) {}
+
+  DISALLOW_COPY_AND_MOVE(MemoryReservation);
+
+  ~MemoryReservation() { Resize(0); }
+
+  /**
+   * Reports the bytes the operator holds from now on.
+   * @return false if the operator is to spill instead of holding them: they are over its limit, the manager refused
+   * them, or the reservation was revoked; the reservation then stays at what it held before
+   */
+  bool Resize(size_t bytes);
+
+  /** @return the bytes granted to the reservation, which are at least those it last accepted */
+  size_t GetGranted() const { return granted_; }
+
+  /** @return true if the manager asked the operator to give its memory back */
+  bool IsRevoked() const { return revoked_.load(std::memory_order_relaxed); }
+
+ private:
+  friend class MemoryManager;
+
+  /** Sets the granted bytes, which are accounted to the query and taken from or given back to the manager */
+  bool Grant(size_t granted);
+
+  ExecutorContext *exec_ctx_;
+  const MemoryCategory category_;
+  size_t limit_{0};
+  bool fixed_{false};
+  /** The bytes the operator last reported, and the ones granted for them */
+  size_t bytes_{0};
+  size_t granted_{0};
+  /** The manager the memory was taken from, which is the one of the query when it was first taken */
+  MemoryManager *manager_{nullptr};
+  std::atomic<bool> revoked_{false};
+};
+
+}  // namespace bustub
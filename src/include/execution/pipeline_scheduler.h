@@ -0,0 +1,80 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// pipeline_scheduler.h
+//
+// Identification: src/include/execution/pipeline_scheduler.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <functional>
+#include <vector>
+
+#include "common/worker_pool.h"
+#include "execution/executor_context.h"
+#include "storage/table/table_heap.h"
+
+namespace bustub {
+
+/**
+ * PipelineScheduler runs the pipelines of a query on the threads of a WorkerPool, morsel by morsel. A plan is split
+ * into pipelines at its breakers, the operators that take in all of their input before they put out any, e.g. the
+ * build of a hash join, an aggregation or a sort. The breaker runs the pipeline below it in its Init, through one of:
+ *
+ * - RunScan, a pipeline whose source is a scan of a table: the workers claim morsels of pages of the table through a
+ *   ParallelTableScan, those of a stretch of the table of their own first, or of the pages on their NUMA node, then
+ *   those they steal from each other, and push the rows of each through the pipeline into a sink of their own, e.g.
+ *   a hash table of partial aggregates.
+ * - RunTasks, a pipeline whose source is the output of a breaker already split into tasks, e.g. the partitions of
+ *   the partial aggregates to merge, which the workers claim and steal the same way.
+ *
+ * The workers check whether the query was cancelled before they claim a morsel or a task, and stop if it was; the
+ * pipeline then throws an Exception of ExceptionType::CANCELLED, once all of them have stopped. A worker can also
+ * stop the whole pipeline early, e.g. once its sink outgrows the memory budget, by returning false.
+ */
+class PipelineScheduler {
+ public:
+  /**
+   * @param exec_ctx the context of the query
+   * @param num_workers the number of workers that run each pipeline
+   * @param pool the pool of the threads of the workers
+   */
+  PipelineScheduler(ExecutorContext *exec_ctx, size_t num_workers, WorkerPool *pool = WorkerPool::Instance())
+      : exec_ctx_(exec_ctx), num_workers_(num_workers), pool_(pool) {}
+
+  /** @return the number of workers that run each pipeline */
+  size_t GetWorkerCount() const { return num_workers_; }
+
+  /**
+   * Runs a pipeline over the morsels of a table.
+   * @param table the table to scan
+   * @param consume the pipeline, over the pages of a morsel, given the number of the worker; false stops the pipeline
+   * @return false if the pipeline was stopped
+   * @throw Exception of ExceptionType::CANCELLED if the query was cancelled
+   */
+  bool RunScan(TableHeap *table, const std::function<bool(size_t, const std::vector<page_id_t> &)> &consume);
+
+  /**
+   * Runs a pipeline over tasks.
+   * @param num_tasks the number of tasks
+   * @param run the pipeline, over the task of an index, given the number of the worker; false stops the pipeline
+   * @return false if the pipeline was stopped
+   * @throw Exception of ExceptionType::CANCELLED if the query was cancelled
+   */
+  bool RunTasks(size_t num_tasks, const std::function<bool(size_t, size_t)> &run);
+
+ private:
+  /** Runs claim_and_run on the workers, until it returns false, or the pipeline is stopped or cancelled */
+  bool Run(const std::function<bool(size_t, bool *)> &claim_and_run);
+
+  ExecutorContext *exec_ctx_;
+  size_t num_workers_;
+  WorkerPool *pool_;
+};
+
+}  // namespace bustub
@@ -20,7 +20,33 @@
 namespace bustub {
 
 /** PlanType represents the types of plans that we have in our system. */
-enum class PlanType { SeqScan, IndexScan, Insert, Update, Delete, Aggregation, Limit, NestedLoopJoin, NestedIndexJoin };
+enum class PlanType {
+  SeqScan,
+  SampleScan,
+  IndexScan,
+  BitmapScan,
+  Insert,
+  Update,
+  Delete,
+  Aggregation,
+  Limit,
+  NestedLoopJoin,
+  NestedIndexJoin,
+  HashJoin,
+  MergeJoin,
+  Sort,
+  Projection,
+  Distinct
+};
+
+/**
+ * The kinds of joins a join plan may be. An INNER join makes a row of every pair of matching rows of its sides. A
+ * SEMI join, as of EXISTS or IN (subquery), makes a row of each outer row that matches any row of the other side,
+ * once however many it matches, and an ANTI join, as of NOT EXISTS, one of each outer row that matches none; the
+ * output schema of both is made of the columns of the outer side only. An outer row with a null key matches nothing,
+ * so an ANTI join keeps it, as NOT EXISTS does; NOT IN, which drops it, has to filter the nulls out first.
+ */
+enum class JoinType { INNER, SEMI, ANTI };
 
 /**
  * AbstractPlanNode represents all the possible types of plan nodes in our system.
@@ -12,6 +12,7 @@
 
 #pragma once
 
+#include <algorithm>
 #include <utility>
 #include <vector>
 
@@ -21,8 +22,19 @@
 
 namespace bustub {
 
-/** AggregationType enumerates all the possible aggregation functions in our system. */
-enum class AggregationType { CountAggregate, SumAggregate, MinAggregate, MaxAggregate };
+/**
+ * AggregationType enumerates all the possible aggregation functions in our system. APPROX_COUNT_DISTINCT and
+ * APPROX_PERCENTILE are estimated by sketches (see HyperLogLog and QuantileSketch) of a fixed size, however many
+ * rows they aggregate.
+ */
+enum class AggregationType {
+  CountAggregate,
+  SumAggregate,
+  MinAggregate,
+  MaxAggregate,
+  ApproxCountDistinctAggregate,
+  ApproxPercentileAggregate
+};
 
 /**
  * AggregationPlanNode represents the various SQL aggregation functions.
@@ -39,15 +51,22 @@ class AggregationPlanNode : public AbstractPlanNode {
    * @param group_bys the group by clause of the aggregation
    * @param aggregates the expressions that we are aggregating
    * @param agg_types the types that we are aggregating
+   * @param num_threads the number of threads to aggregate with; more than one pre-aggregates a sequential scan child
+   * in parallel
+   * @param percentiles the fraction, in [0, 1], of each APPROX_PERCENTILE aggregate, by the index of the aggregate;
+   * empty if there are none
    */
   AggregationPlanNode(const Schema *output_schema, const AbstractPlanNode *child, const AbstractExpression *having,
                       std::vector<const AbstractExpression *> &&group_bys,
-                      std::vector<const AbstractExpression *> &&aggregates, std::vector<AggregationType> &&agg_types)
+                      std::vector<const AbstractExpression *> &&aggregates, std::vector<AggregationType> &&agg_types,
+                      size_t num_threads = 1, std::vector<double> &&percentiles = {})
       : AbstractPlanNode(output_schema, {child}),
         having_(having),
         group_bys_(std::move(group_bys)),
         aggregates_(std::move(aggregates)),
-        agg_types_(std::move(agg_types)) {}
+        agg_types_(std::move(agg_types)),
+        num_threads_(std::max<size_t>(num_threads, 1)),
+        percentiles_(std::move(percentiles)) {}
 
   PlanType GetType() const override { return PlanType::Aggregation; }
 
@@ -75,11 +94,19 @@ class AggregationPlanNode : public AbstractPlanNode {
   /** @return the aggregate types */
   const std::vector<AggregationType> &GetAggregateTypes() const { return agg_types_; }
 
+  /** @return the number of threads to aggregate with */
+  size_t GetNumThreads() const { return num_threads_; }
+
+  /** @return the fractions of the APPROX_PERCENTILE aggregates, by the index of the aggregate */
+  const std::vector<double> &GetPercentiles() const { return percentiles_; }
+
  private:
   const AbstractExpression *having_;
   std::vector<const AbstractExpression *> group_bys_;
   std::vector<const AbstractExpression *> aggregates_;
   std::vector<AggregationType> agg_types_;
+  size_t num_threads_;
+  std::vector<double> percentiles_;
 };
 
 struct AggregateKey {
@@ -0,0 +1,73 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// bitmap_scan_plan.h
+//
+// Identification: src/include/execution/plans/bitmap_scan_plan.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <utility>
+#include <vector>
+
+#include "catalog/catalog.h"
+#include "execution/expressions/abstract_expression.h"
+#include "execution/plans/abstract_plan.h"
+
+namespace bustub {
+
+/**
+ * A condition of a bitmap scan: the rows whose key in a bitmap index is any of keys_, as of "status IN (...)", each
+ * key the values of the key columns of the index, in their order.
+ */
+struct BitmapCondition {
+  index_oid_t index_oid_;
+  std::vector<std::vector<Value>> keys_;
+};
+
+/**
+ * BitmapScanPlanNode identifies a table whose rows that hold for all of some conditions on its bitmap indexes should
+ * be scanned, with an optional predicate for what the conditions do not cover, as of "WHERE region IN ('EU', 'US')
+ * AND status = 'open'".
+ */
+class BitmapScanPlanNode : public AbstractPlanNode {
+ public:
+  /**
+   * Creates a new bitmap scan plan node.
+   * @param output the output format of this scan plan node
+   * @param predicate the predicate to scan with, tuples are returned if predicate(tuple) = true or predicate = nullptr
+   * @param table_oid the identifier of table to be scanned
+   * @param conditions the conditions on the bitmap indexes of the table, all of which the rows hold for
+   */
+  BitmapScanPlanNode(const Schema *output, const AbstractExpression *predicate, table_oid_t table_oid,
+                     std::vector<BitmapCondition> conditions)
+      : AbstractPlanNode(output, {}),
+        predicate_{predicate},
+        table_oid_(table_oid),
+        conditions_(std::move(conditions)) {}
+
+  PlanType GetType() const override { return PlanType::BitmapScan; }
+
+  /** @return the predicate to test tuples against; tuples should only be returned if they evaluate to true */
+  const AbstractExpression *GetPredicate() const { return predicate_; }
+
+  /** @return the identifier of the table that should be scanned */
+  table_oid_t GetTableOid() const { return table_oid_; }
+
+  /** @return the conditions on the bitmap indexes */
+  const std::vector<BitmapCondition> &GetConditions() const { return conditions_; }
+
+ private:
+  /** The predicate that all returned tuples must satisfy. */
+  const AbstractExpression *predicate_;
+  /** The table whose tuples should be scanned. */
+  table_oid_t table_oid_;
+  std::vector<BitmapCondition> conditions_;
+};
+
+}  // namespace bustub
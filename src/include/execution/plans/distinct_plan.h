@@ -0,0 +1,87 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// distinct_plan.h
+//
+// Identification: src/include/execution/plans/distinct_plan.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <vector>
+
+#include "common/util/hash_util.h"
+#include "execution/plans/abstract_plan.h"
+
+namespace bustub {
+
+/**
+ * DistinctPlanNode drops the tuples of its child that repeat an earlier one, as SELECT DISTINCT does. Two tuples are
+ * the same if every value of one equals the one of the other, or both are null. Its output schema is the one of the
+ * child.
+ */
+class DistinctPlanNode : public AbstractPlanNode {
+ public:
+  /**
+   * Creates a new distinct plan node.
+   * @param output_schema the output format of this distinct node, the one of the child
+   * @param child the child plan whose repeated tuples are dropped
+   */
+  DistinctPlanNode(const Schema *output_schema, const AbstractPlanNode *child)
+      : AbstractPlanNode(output_schema, {child}) {}
+
+  PlanType GetType() const override { return PlanType::Distinct; }
+
+  /** @return the child of this distinct plan node */
+  const AbstractPlanNode *GetChildPlan() const {
+    BUSTUB_ASSERT(GetChildren().size() == 1, "Distinct expected to only have one child.");
+    return GetChildAt(0);
+  }
+};
+
+/** The values of a tuple of a distinct. */
+struct DistinctKey {
+  std::vector<Value> values_;
+
+  /**
+   * Compares two distinct keys for equality.
+   * @param other the other distinct key to be compared with
+   * @return true if every value equals the other's, or both are null
+   */
+  bool operator==(const DistinctKey &other) const {
+    for (uint32_t i = 0; i < other.values_.size(); i++) {
+      if (values_[i].IsNull() || other.values_[i].IsNull()) {
+        if (values_[i].IsNull() != other.values_[i].IsNull()) {
+          return false;
+        }
+      } else if (values_[i].CompareEquals(other.values_[i]) != CmpBool::CmpTrue) {
+        return false;
+      }
+    }
+    return true;
+  }
+};
+
+}  // namespace bustub
+
+namespace std {
+
+/** Implements std::hash on DistinctKey. */
+template <>
+struct hash<bustub::DistinctKey> {
+  std::size_t operator()(const bustub::DistinctKey &distinct_key) const {
+    size_t curr_hash = 0;
+    for (const auto &value : distinct_key.values_) {
+      if (!value.IsNull()) {
+        curr_hash = bustub::HashUtil::CombineHashes(curr_hash, bustub::HashUtil::HashValue(&value));
+      }
+    }
+    return curr_hash;
+  }
+};
+
+}  // namespace std
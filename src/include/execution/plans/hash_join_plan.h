@@ -0,0 +1,124 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// hash_join_plan.h
+//
+// Identification: src/include/execution/plans/hash_join_plan.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+#include "common/util/hash_util.h"
+#include "execution/expressions/abstract_expression.h"
+#include "execution/plans/abstract_plan.h"
+
+namespace bustub {
+
+/**
+ * HashJoinPlanNode joins the tuples of two children whose keys are equal: the tuples of the left child are put in a
+ * hash table by their left keys first, and the tuples of the right child look theirs up by their right keys. The right
+ * child is the outer side of a SEMI or an ANTI join (see JoinType).
+ */
+class HashJoinPlanNode : public AbstractPlanNode {
+ public:
+  /**
+   * Creates a new hash join plan node.
+   * @param output_schema the output format of this hash join node, of expressions over both children
+   * @param children the left and the right child plans, the left one by convention the smaller one
+   * @param left_keys the key expressions over the tuples of the left child
+   * @param right_keys the key expressions over the tuples of the right child, as many as there are left keys
+   * @param num_threads the number of threads to join with; more than one makes it a parallel radix join
+   * @param join_type the kind of join, of which the right child is the outer side
+   */
+  HashJoinPlanNode(const Schema *output_schema, std::vector<const AbstractPlanNode *> &&children,
+                   std::vector<const AbstractExpression *> &&left_keys,
+                   std::vector<const AbstractExpression *> &&right_keys, size_t num_threads = 1,
+                   JoinType join_type = JoinType::INNER)
+      : AbstractPlanNode(output_schema, std::move(children)),
+        left_keys_(std::move(left_keys)),
+        right_keys_(std::move(right_keys)),
+        num_threads_(std::max<size_t>(num_threads, 1)),
+        join_type_(join_type) {
+    BUSTUB_ASSERT(left_keys_.size() == right_keys_.size(), "both sides of a hash join have as many keys");
+  }
+
+  PlanType GetType() const override { return PlanType::HashJoin; }
+
+  /** @return the key expressions over the tuples of the left child */
+  const std::vector<const AbstractExpression *> &GetLeftKeys() const { return left_keys_; }
+
+  /** @return the key expressions over the tuples of the right child */
+  const std::vector<const AbstractExpression *> &GetRightKeys() const { return right_keys_; }
+
+  /** @return the number of threads to join with */
+  size_t GetNumThreads() const { return num_threads_; }
+
+  /** @return the kind of join */
+  JoinType GetJoinType() const { return join_type_; }
+
+  /** @return the left plan node of the hash join, the one the hash table is built of */
+  const AbstractPlanNode *GetLeftPlan() const {
+    BUSTUB_ASSERT(GetChildren().size() == 2, "Hash joins should have exactly two children plans.");
+    return GetChildAt(0);
+  }
+
+  /** @return the right plan node of the hash join, the one that probes the hash table */
+  const AbstractPlanNode *GetRightPlan() const {
+    BUSTUB_ASSERT(GetChildren().size() == 2, "Hash joins should have exactly two children plans.");
+    return GetChildAt(1);
+  }
+
+ private:
+  std::vector<const AbstractExpression *> left_keys_;
+  std::vector<const AbstractExpression *> right_keys_;
+  size_t num_threads_;
+  JoinType join_type_;
+};
+
+/** The key values of a tuple of a hash join. */
+struct HashJoinKey {
+  std::vector<Value> keys_;
+
+  /**
+   * Compares two join keys for equality.
+   * @param other the other join key to be compared with
+   * @return true if every value equals the other's
+   */
+  bool operator==(const HashJoinKey &other) const {
+    for (uint32_t i = 0; i < other.keys_.size(); i++) {
+      if (keys_[i].CompareEquals(other.keys_[i]) != CmpBool::CmpTrue) {
+        return false;
+      }
+    }
+    return true;
+  }
+};
+
+}  // namespace bustub
+
+namespace std {
+
+/**
+ * Implements std::hash on HashJoinKey. The integer types hash alike, so that e.g. an INTEGER key finds its SMALLINT
+ * match.
+ */
+template <>
+struct hash<bustub::HashJoinKey> {
+  std::size_t operator()(const bustub::HashJoinKey &join_key) const {
+    size_t curr_hash = 0;
+    for (const auto &key : join_key.keys_) {
+      curr_hash = bustub::HashUtil::CombineHashes(curr_hash, bustub::HashUtil::HashValue(&key));
+    }
+    return curr_hash;
+  }
+};
+
+}  // namespace std
@@ -17,8 +17,31 @@
 #include "execution/plans/abstract_plan.h"
 
 namespace bustub {
+
+/**
+ * The range of keys an index scan reads, for an index of a single key column: the entries whose key is between the
+ * bounds, each a constant or a parameter, or unbounded on its side if it is nullptr. A scan of the default range reads
+ * the whole index. The predicate of the scan is tested on the entries of the range as on any others, so the range
+ * only has to hold the entries the predicate holds for.
+ */
+struct IndexKeyRange {
+  const AbstractExpression *lower_{nullptr};
+  bool lower_inclusive_{true};
+  const AbstractExpression *upper_{nullptr};
+  bool upper_inclusive_{true};
+
+  /** @return true if the range is of a single key */
+  bool IsEquality() const { return lower_ != nullptr && lower_ == upper_ && lower_inclusive_ && upper_inclusive_; }
+};
+
 /**
  * IndexScanPlanNode identifies a table that should be scanned with an optional predicate.
+ *
+ * A scan is index-only (covering) if everything it outputs and tests is in the index key: the tuples are then built
+ * from the keys in the index and the table heap is never read. The predicate and the expressions of the output schema
+ * of an index-only scan are evaluated against the key tuple, so their column indexes refer to the key schema
+ * (IndexMetadata::GetKeyAttrs maps them back to the columns of the table). Indexes with normalized keys cannot be read
+ * back, so they are always scanned through the heap.
  */
 class IndexScanPlanNode : public AbstractPlanNode {
  public:
@@ -27,10 +50,17 @@ class IndexScanPlanNode : public AbstractPlanNode {
    * @param output the output format of this scan plan node
    * @param predicate the predicate to scan with, tuples are returned if predicate(tuple) == true or predicate ==
    * nullptr
-   * @param table_oid the identifier of table to be scanned
+   * @param index_oid the identifier of the index to be scanned
+   * @param index_only true if the output and predicate only need the key columns, see the class comment
+   * @param key_range the range of keys to read
    */
-  IndexScanPlanNode(const Schema *output, const AbstractExpression *predicate, index_oid_t index_oid)
-      : AbstractPlanNode(output, {}), predicate_{predicate}, index_oid_(index_oid) {}
+  IndexScanPlanNode(const Schema *output, const AbstractExpression *predicate, index_oid_t index_oid,
+                    bool index_only = false, IndexKeyRange key_range = {})
+      : AbstractPlanNode(output, {}),
+        predicate_{predicate},
+        index_oid_(index_oid),
+        index_only_(index_only),
+        key_range_(key_range) {}
 
   PlanType GetType() const override { return PlanType::IndexScan; }
 
@@ -40,11 +70,21 @@ class IndexScanPlanNode : public AbstractPlanNode {
   /** @return the identifier of the table that should be scanned */
   index_oid_t GetIndexOid() const { return index_oid_; }
 
+  /** @return true if the scan builds its tuples from the index keys, without reading the table heap */
+  bool IsIndexOnly() const { return index_only_; }
+
+  /** @return the range of keys to read */
+  const IndexKeyRange &GetKeyRange() const { return key_range_; }
+
  private:
   /** The predicate that all returned tuples must satisfy. */
   const AbstractExpression *predicate_;
   /** The table whose tuples should be scanned. */
   index_oid_t index_oid_;
+  /** True if the scan is covered by the index key. */
+  bool index_only_;
+  /** The range of keys the scan reads. */
+  IndexKeyRange key_range_;
 };
 
 }  // namespace bustub
@@ -0,0 +1,71 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// merge_join_plan.h
+//
+// Identification: src/include/execution/plans/merge_join_plan.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <utility>
+#include <vector>
+
+#include "execution/expressions/abstract_expression.h"
+#include "execution/plans/abstract_plan.h"
+
+namespace bustub {
+
+/**
+ * MergeJoinPlanNode joins the tuples of two children whose keys are equal, where both children return their tuples in
+ * ascending order of those keys, e.g. index scans of B+ trees on them, or sorts. The two are merged as they stream in,
+ * so that only the right tuples of a single key are ever held.
+ */
+class MergeJoinPlanNode : public AbstractPlanNode {
+ public:
+  /**
+   * Creates a new merge join plan node.
+   * @param output_schema the output format of this merge join node, of expressions over both children
+   * @param children the left and the right child plans, both in ascending order of their keys
+   * @param left_keys the key expressions over the tuples of the left child
+   * @param right_keys the key expressions over the tuples of the right child, as many as there are left keys
+   */
+  MergeJoinPlanNode(const Schema *output_schema, std::vector<const AbstractPlanNode *> &&children,
+                    std::vector<const AbstractExpression *> &&left_keys,
+                    std::vector<const AbstractExpression *> &&right_keys)
+      : AbstractPlanNode(output_schema, std::move(children)),
+        left_keys_(std::move(left_keys)),
+        right_keys_(std::move(right_keys)) {
+    BUSTUB_ASSERT(left_keys_.size() == right_keys_.size(), "both sides of a merge join have as many keys");
+  }
+
+  PlanType GetType() const override { return PlanType::MergeJoin; }
+
+  /** @return the key expressions over the tuples of the left child */
+  const std::vector<const AbstractExpression *> &GetLeftKeys() const { return left_keys_; }
+
+  /** @return the key expressions over the tuples of the right child */
+  const std::vector<const AbstractExpression *> &GetRightKeys() const { return right_keys_; }
+
+  /** @return the left plan node of the merge join */
+  const AbstractPlanNode *GetLeftPlan() const {
+    BUSTUB_ASSERT(GetChildren().size() == 2, "Merge joins should have exactly two children plans.");
+    return GetChildAt(0);
+  }
+
+  /** @return the right plan node of the merge join, the tuples of a key of which are held */
+  const AbstractPlanNode *GetRightPlan() const {
+    BUSTUB_ASSERT(GetChildren().size() == 2, "Merge joins should have exactly two children plans.");
+    return GetChildAt(1);
+  }
+
+ private:
+  std::vector<const AbstractExpression *> left_keys_;
+  std::vector<const AbstractExpression *> right_keys_;
+};
+
+}  // namespace bustub
@@ -25,19 +25,22 @@ namespace bustub {
 /**
  * NestedIndexJoinPlanNode is used to represent performing a nested index join between two tables
  * The outer table tuples are propogated using a child executor, but the inner table tuples should be
- * obtained using the outer table tuples as well as the index from the catalog.
+ * obtained using the outer table tuples as well as the index from the catalog. A SEMI or an ANTI join (see JoinType)
+ * makes rows of the outer tuples only.
  */
 class NestedIndexJoinPlanNode : public AbstractPlanNode {
  public:
   NestedIndexJoinPlanNode(const Schema *output_schema, std::vector<const AbstractPlanNode *> &&children,
                           const AbstractExpression *predicate, table_oid_t inner_table_oid, std::string index_name,
-                          const Schema *outer_table_schema, const Schema *inner_table_schema)
+                          const Schema *outer_table_schema, const Schema *inner_table_schema,
+                          JoinType join_type = JoinType::INNER)
       : AbstractPlanNode(output_schema, std::move(children)),
         predicate_(predicate),
         inner_table_oid_(inner_table_oid),
         index_name_(std::move(index_name)),
         outer_table_schema_(outer_table_schema),
-        inner_table_schema_(inner_table_schema) {}
+        inner_table_schema_(inner_table_schema),
+        join_type_(join_type) {}
 
   PlanType GetType() const override { return PlanType::NestedIndexJoin; }
 
@@ -59,6 +62,9 @@ class NestedIndexJoinPlanNode : public AbstractPlanNode {
   /** @return Schema with needed columns in from the inner table */
   const Schema *InnerTableSchema() const { return inner_table_schema_; }
 
+  /** @return the kind of join */
+  JoinType GetJoinType() const { return join_type_; }
+
  private:
   /** The nested index join predicate. */
   const AbstractExpression *predicate_;
@@ -66,5 +72,6 @@ class NestedIndexJoinPlanNode : public AbstractPlanNode {
   const std::string index_name_;
   const Schema *outer_table_schema_;
   const Schema *inner_table_schema_;
+  JoinType join_type_;
 };
 }  // namespace bustub
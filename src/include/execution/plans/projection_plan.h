@@ -0,0 +1,42 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// projection_plan.h
+//
+// Identification: src/include/execution/plans/projection_plan.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include "execution/plans/abstract_plan.h"
+
+namespace bustub {
+
+/**
+ * ProjectionPlanNode evaluates the expressions of the columns of its output schema, over the tuples of its child,
+ * into tuples of just those columns. The columns of the child that no expression refers to are left behind.
+ */
+class ProjectionPlanNode : public AbstractPlanNode {
+ public:
+  /**
+   * Creates a new projection plan node.
+   * @param output_schema the output format of this projection node, whose columns' expressions are over the child
+   * @param child the child plan whose tuples are projected
+   */
+  ProjectionPlanNode(const Schema *output_schema, const AbstractPlanNode *child)
+      : AbstractPlanNode(output_schema, {child}) {}
+
+  PlanType GetType() const override { return PlanType::Projection; }
+
+  /** @return the child of this projection plan node */
+  const AbstractPlanNode *GetChildPlan() const {
+    BUSTUB_ASSERT(GetChildren().size() == 1, "Projection expected to only have one child.");
+    return GetChildAt(0);
+  }
+};
+
+}  // namespace bustub
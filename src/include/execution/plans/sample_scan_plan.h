@@ -0,0 +1,80 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// sample_scan_plan.h
+//
+// Identification: src/include/execution/plans/sample_scan_plan.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstdint>
+
+#include "catalog/catalog.h"
+#include "execution/expressions/abstract_expression.h"
+#include "execution/plans/abstract_plan.h"
+
+namespace bustub {
+
+/**
+ * How a TABLESAMPLE picks its rows: SYSTEM picks whole pages, and reads only those, BERNOULLI picks each row on its
+ * own, which samples the rows more evenly but reads every page.
+ */
+enum class SampleMethod { SYSTEM, BERNOULLI };
+
+/**
+ * SampleScanPlanNode identifies a table a random sample of which should be scanned, with an optional predicate, as
+ * SELECT ... FROM table TABLESAMPLE method (fraction) REPEATABLE (seed) does.
+ */
+class SampleScanPlanNode : public AbstractPlanNode {
+ public:
+  /**
+   * Creates a new sample scan plan node.
+   * @param output the output format of this scan plan node
+   * @param predicate the predicate to scan with, tuples are returned if predicate(tuple) = true or predicate = nullptr
+   * @param table_oid the identifier of table to be scanned
+   * @param method whether pages or rows are picked
+   * @param fraction the probability of each page or row to be picked, in [0, 1]
+   * @param seed the seed of the picks; a scan of the same table with the same seed picks the same rows
+   */
+  SampleScanPlanNode(const Schema *output, const AbstractExpression *predicate, table_oid_t table_oid,
+                     SampleMethod method, double fraction, uint64_t seed = 0)
+      : AbstractPlanNode(output, {}),
+        predicate_{predicate},
+        table_oid_(table_oid),
+        method_(method),
+        fraction_(fraction),
+        seed_(seed) {}
+
+  PlanType GetType() const override { return PlanType::SampleScan; }
+
+  /** @return the predicate to test tuples against; tuples should only be returned if they evaluate to true */
+  const AbstractExpression *GetPredicate() const { return predicate_; }
+
+  /** @return the identifier of the table that should be scanned */
+  table_oid_t GetTableOid() const { return table_oid_; }
+
+  /** @return whether pages or rows are picked */
+  SampleMethod GetMethod() const { return method_; }
+
+  /** @return the probability of each page or row to be picked */
+  double GetFraction() const { return fraction_; }
+
+  /** @return the seed of the picks */
+  uint64_t GetSeed() const { return seed_; }
+
+ private:
+  /** The predicate that all returned tuples must satisfy. */
+  const AbstractExpression *predicate_;
+  /** The table whose tuples should be scanned. */
+  table_oid_t table_oid_;
+  SampleMethod method_;
+  double fraction_;
+  uint64_t seed_;
+};
+
+}  // namespace bustub
@@ -0,0 +1,57 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// sort_plan.h
+//
+// Identification: src/include/execution/plans/sort_plan.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <utility>
+#include <vector>
+
+#include "execution/expressions/abstract_expression.h"
+#include "execution/plans/abstract_plan.h"
+
+namespace bustub {
+
+/** OrderByType is the direction of a key of an ORDER BY; NULLs are the largest values, last when ascending. */
+enum class OrderByType { ASC, DESC };
+
+/**
+ * SortPlanNode orders the tuples of its child by its ORDER BY keys, the first one first. The tuples come out as they
+ * are, so its output schema is that of the child, and tuples of the same keys keep the order the child had them in.
+ */
+class SortPlanNode : public AbstractPlanNode {
+ public:
+  /**
+   * Creates a new sort plan node.
+   * @param output_schema the output format of this sort node, the schema of the child
+   * @param child the child plan whose tuples are sorted
+   * @param order_bys the directions and the expressions, over the tuples of the child, of the keys to sort by
+   */
+  SortPlanNode(const Schema *output_schema, const AbstractPlanNode *child,
+               std::vector<std::pair<OrderByType, const AbstractExpression *>> &&order_bys)
+      : AbstractPlanNode(output_schema, {child}), order_bys_(std::move(order_bys)) {}
+
+  PlanType GetType() const override { return PlanType::Sort; }
+
+  /** @return the child of this sort plan node */
+  const AbstractPlanNode *GetChildPlan() const {
+    BUSTUB_ASSERT(GetChildren().size() == 1, "Sort expected to only have one child.");
+    return GetChildAt(0);
+  }
+
+  /** @return the keys to sort by */
+  const std::vector<std::pair<OrderByType, const AbstractExpression *>> &GetOrderBys() const { return order_bys_; }
+
+ private:
+  std::vector<std::pair<OrderByType, const AbstractExpression *>> order_bys_;
+};
+
+}  // namespace bustub
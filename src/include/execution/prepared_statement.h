@@ -0,0 +1,87 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// prepared_statement.h
+//
+// Identification: src/include/execution/prepared_statement.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "execution/executor_context.h"
+#include "execution/executors/abstract_executor.h"
+#include "storage/table/tuple.h"
+
+namespace bustub {
+
+/**
+ * PreparedStatement is a plan whose executor tree is built once, by ExecutionEngine::Prepare, and then run again and
+ * again, with new values of its parameters (see ParameterValueExpression) each time. A run starts the tree over with
+ * Init instead of building a new one, so statements that are run many times do not pay for making their executors and
+ * plan-derived state on every run.
+ *
+ * The statement runs in the ExecutorContext it was prepared with, whose arena each run resets: the tuples a run hands
+ * out of the arena are only good until the next one.
+ */
+class PreparedStatement {
+ public:
+  /**
+   * Takes in a row of the output, which the callback may move out of if it owns its data (see Tuple::IsAllocated);
+   * otherwise the tuple is only good until the callback returns.
+   * @return false to stop the query, which needs no more rows
+   */
+  using ResultCallback = std::function<bool(Tuple &tuple)>;
+
+  /**
+   * @param exec_ctx the context the executors were made in
+   * @param executor the root of the executor tree
+   * @param parameters the values the ParameterValueExpressions of the plan read, nullptr if it has none
+   */
+  PreparedStatement(ExecutorContext *exec_ctx, std::unique_ptr<AbstractExecutor> executor,
+                    std::vector<Value> *parameters);
+
+  DISALLOW_COPY_AND_MOVE(PreparedStatement);
+
+  /** @return the schema of the rows of the statement */
+  const Schema *GetOutputSchema() { return executor_->GetOutputSchema(); }
+
+  /**
+   * Binds the parameters, and runs the statement, streaming its rows into a callback.
+   * @param values the values of the parameters, as many as the statement was prepared with
+   * @param on_row the callback, which stops the run early when it returns false
+   * @return false if the query was cancelled
+   */
+  bool ExecuteStreaming(const std::vector<Value> &values, const ResultCallback &on_row);
+
+  /**
+   * Binds the parameters, and runs the statement, collecting its rows.
+   * @param values the values of the parameters
+   * @param[out] result_set the rows, nullptr if they are not kept
+   * @return false if the query was cancelled
+   */
+  bool Execute(const std::vector<Value> &values, std::vector<Tuple> *result_set);
+
+  /**
+   * Runs an executor tree from the start, handing its rows to a callback.
+   * @return false if the query was cancelled
+   */
+  static bool Run(AbstractExecutor *executor, ExecutorContext *exec_ctx, const ResultCallback &on_row);
+
+  /** @return a callback that collects the rows into a result set, or drops them if it is nullptr */
+  static ResultCallback CollectInto(std::vector<Tuple> *result_set);
+
+ private:
+  ExecutorContext *exec_ctx_;
+  std::unique_ptr<AbstractExecutor> executor_;
+  std::vector<Value> *parameters_;
+};
+
+}  // namespace bustub
@@ -0,0 +1,84 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// push_pipeline.h
+//
+// Identification: src/include/execution/push_pipeline.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "execution/executor_context.h"
+#include "execution/plans/abstract_plan.h"
+#include "execution/plans/seq_scan_plan.h"
+#include "execution/vector/data_chunk.h"
+
+namespace bustub {
+
+/**
+ * A stage of a PushPipeline, that the stage before it pushes its batches into. A stage is called once per batch, not
+ * once per row, and pushes its own batches into the next stage the same way; the last one is the sink of the pipeline.
+ */
+class PushStage {
+ public:
+  virtual ~PushStage() = default;
+
+  /**
+   * Takes in the live rows of a batch, which are good until the call returns.
+   * @return false to stop the pipeline, e.g. when the stage outgrew the memory budget
+   */
+  virtual bool Consume(DataChunk *chunk) = 0;
+};
+
+/**
+ * PushPipeline is the push-based alternative to pulling the rows of a plan through a tree of executors: it compiles a
+ * chain of hash joins down to a sequential scan, which is the probe side of each of them, into a single loop. The scan
+ * decodes the rows of its pages into a batch and filters and projects them in place, as SeqScanExecutor::NextBatch
+ * does; the batch is then pushed through a probe stage per join, each of which pushes the batches of its matches on,
+ * into the sink, e.g. the hash table of an aggregation. No executor sits between the stages, and no row of the
+ * pipeline is made a Tuple, only the build sides, which are run as executors of their own before the scan starts.
+ *
+ * The hash tables of the build sides are kept in memory; a pipeline whose build side outgrows the memory budget does
+ * not run, and its plan is left to the executors, which spill.
+ */
+class PushPipeline {
+ public:
+  /** A hash join whose build side is built, and whose probe side is the batches pushed into it */
+  class ProbeStage;
+
+  /**
+   * @return the pipeline of the plan, or nullptr if the plan is not a chain of hash joins, each the right child of the
+   * one above it, down to a sequential scan
+   */
+  static std::unique_ptr<PushPipeline> Compile(ExecutorContext *exec_ctx, const AbstractPlanNode *plan);
+
+  ~PushPipeline();
+
+  /** @return the schema of the batches that the pipeline pushes into its sink */
+  const Schema *GetOutputSchema() const { return output_schema_; }
+
+  /**
+   * Builds the hash tables of the joins, and then pushes every row of the scan through the pipeline into the sink.
+   * @return false if a hash table outgrew the memory budget or the sink stopped the pipeline, which it may then have
+   * taken in part of the rows of
+   */
+  bool Run(PushStage *sink);
+
+ private:
+  PushPipeline(ExecutorContext *exec_ctx, const SeqScanPlanNode *scan_plan, const Schema *output_schema);
+
+  ExecutorContext *exec_ctx_;
+  const SeqScanPlanNode *scan_plan_;
+  const Schema *output_schema_;
+  /** The probe stages, the one of the join right above the scan first */
+  std::vector<std::unique_ptr<ProbeStage>> probes_;
+};
+
+}  // namespace bustub
@@ -0,0 +1,67 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// quantile_sketch.h
+//
+// Identification: src/include/execution/quantile_sketch.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace bustub {
+
+/**
+ * QuantileSketch estimates the quantiles of the values it was given, as a KLL sketch: a stack of compactors, the
+ * values of the one at level h each standing for 2^h values of the input. A compactor that fills up is sorted, and
+ * every other one of its values is moved up a level, from the first or the second in turn; the capacities shrink by
+ * 2/3 per level down from the top, where it is K. The rank of the value returned for a quantile is off by about
+ * 1.7 / K of the count, i.e. under 1% when K is 200, and the sketch holds no more than about 3 * K values.
+ *
+ * Two sketches merge into the sketch of all of their values, as their compactors are stacked and compacted again.
+ */
+class QuantileSketch {
+ public:
+  static constexpr size_t K = 200;
+
+  void Insert(double value);
+
+  /** Takes in the values of another sketch */
+  void Merge(const QuantileSketch &other);
+
+  /**
+   * @param fraction the quantile, in [0, 1]: 0 for the smallest value, 0.5 for the median, 1 for the largest
+   * @return a value of the input whose rank is about fraction of the count; the sketch must not be empty
+   */
+  double Quantile(double fraction) const;
+
+  /** @return the number of values the sketch was given */
+  uint64_t GetCount() const { return count_; }
+
+  /** @return about the most bytes a sketch takes, however many values it is given */
+  static constexpr size_t MemoryUsage() { return sizeof(QuantileSketch) + 3 * K * sizeof(double); }
+
+ private:
+  /** @return the number of values the compactor at the level holds before it is compacted */
+  size_t Capacity(size_t level) const;
+
+  /** Compacts the compactors that are full, bottom up */
+  void Compress();
+
+  std::vector<std::vector<double>> levels_;
+  uint64_t count_{0};
+  /** The smallest and the largest value, which are kept apart as compactions may drop them */
+  double min_{0};
+  double max_{0};
+  /** Whether the next compaction of each level moves up the values at odd positions rather than those at even ones */
+  std::vector<bool> odd_;
+};
+
+}  // namespace bustub
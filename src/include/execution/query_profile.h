@@ -0,0 +1,104 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// query_profile.h
+//
+// Identification: src/include/execution/query_profile.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "execution/plans/abstract_plan.h"
+
+namespace bustub {
+
+/** @return the name of a plan type, as the profile and the trace of a query show it */
+const char *PlanTypeName(PlanType type);
+
+/**
+ * The live counters of a plan node, which its ProfilingExecutors add to. Each counts what happened in the calls of
+ * Init, Next and NextBatch on the executors of the node, and so includes what the executors below it did in them.
+ */
+struct OperatorCounters {
+  /** The executors made of the node, e.g. more than one if a join makes its inner side again */
+  std::atomic<uint64_t> executors_{0};
+  std::atomic<uint64_t> rows_{0};
+  /** The calls of Next and NextBatch */
+  std::atomic<uint64_t> calls_{0};
+  std::atomic<uint64_t> wall_ns_{0};
+  /** The CPU time of the thread that made the calls, which leaves out the work of pipelines on other threads */
+  std::atomic<uint64_t> cpu_ns_{0};
+  /** The page fetches of the buffer pool, which counts those of every query running alongside as well */
+  std::atomic<uint64_t> page_hits_{0};
+  std::atomic<uint64_t> page_misses_{0};
+  std::atomic<uint64_t> spilled_bytes_{0};
+};
+
+/**
+ * The report of a plan node: its counters, summed over its executors, and the reports of its children, in the order
+ * of the children of the node. A node without executors was folded into the executor of its parent, as a sort is into
+ * the top-N of a limit over it, or not run at all.
+ */
+struct OperatorProfile {
+  PlanType type_;
+  uint64_t executors_{0};
+  uint64_t rows_{0};
+  uint64_t calls_{0};
+  uint64_t wall_ns_{0};
+  uint64_t cpu_ns_{0};
+  uint64_t page_hits_{0};
+  uint64_t page_misses_{0};
+  uint64_t spilled_bytes_{0};
+  std::vector<OperatorProfile> children_;
+
+  /** @return the wall time of the node less that of its children, i.e. of the work of its own executors */
+  uint64_t GetSelfWallNs() const;
+
+  /** @return the report as lines of text, one per node, indented by their depth in the plan */
+  std::string ToString() const;
+};
+
+/**
+ * QueryProfile collects the counters of the plan nodes of a query that is run with it, as EXPLAIN ANALYZE does (see
+ * ExecutionEngine::Execute). The counters are kept by plan node rather than by executor, so that the executors a node
+ * has over the query add up in its report.
+ */
+class QueryProfile {
+ public:
+  /** @return the counters of the node, made on first use; safe to call from any thread */
+  OperatorCounters *GetCounters(const AbstractPlanNode *plan);
+
+  /** @param plan the root of the plan that was run */
+  void SetPlan(const AbstractPlanNode *plan) { plan_ = plan; }
+
+  /** @param wall_ns the wall time of the whole run, including the time its callback took */
+  void SetTotalWallNs(uint64_t wall_ns) { total_wall_ns_ = wall_ns; }
+
+  /** @return the wall time of the whole run */
+  uint64_t GetTotalWallNs() const { return total_wall_ns_; }
+
+  /** @return the report of the plan that was run, of the shape of the plan */
+  OperatorProfile GetReport() const { return Report(plan_); }
+
+ private:
+  OperatorProfile Report(const AbstractPlanNode *plan) const;
+
+  mutable std::mutex latch_;
+  std::unordered_map<const AbstractPlanNode *, std::unique_ptr<OperatorCounters>> counters_;
+  const AbstractPlanNode *plan_{nullptr};
+  uint64_t total_wall_ns_{0};
+};
+
+}  // namespace bustub
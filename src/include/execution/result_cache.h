@@ -0,0 +1,120 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// result_cache.h
+//
+// Identification: src/include/execution/result_cache.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstdint>
+#include <list>
+#include <mutex>  // NOLINT
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "catalog/catalog.h"
+#include "concurrency/transaction.h"
+#include "execution/plans/abstract_plan.h"
+#include "storage/table/tuple.h"
+
+namespace bustub {
+
+/** What a ResultCache did, since it was made. */
+struct ResultCacheStats {
+  uint64_t hits_{0};
+  uint64_t misses_{0};
+  /** the results put in the cache, and those taken out to make room for others */
+  uint64_t inserts_{0};
+  uint64_t evictions_{0};
+};
+
+/**
+ * ResultCache keeps the rows of the read-only queries that ExecutionEngine ran, so that a query run again, as of a
+ * dashboard that polls, is answered without running its plan. A result is found by the fingerprint of its plan (see
+ * Fingerprint): the types and attributes of its nodes and the expressions they evaluate, with the values the
+ * parameters of the plan are bound to. It is of no use once any of the tables the plan reads has changed since: each
+ * result keeps the modification counts of those tables as they were before the query ran (see
+ * TableHeap::GetModificationCount), which a commit that wrote to a table bumps.
+ *
+ * The cache holds up to capacity bytes of rows; the result least recently used goes when a new one needs the room,
+ * and one larger than the whole cache is not kept. Only READ_COMMITTED transactions use the cache, whose reads see
+ * the latest commits and hold no locks after them, as a hit takes none, and only for plans of tables they did not
+ * write to themselves. Plans that write, that sample, or that read tables of another layout than ROW are not cached.
+ */
+class ResultCache {
+ public:
+  /** A plan that can be cached, by its fingerprint, and the heaps of the tables it reads. */
+  struct CacheablePlan {
+    std::string fingerprint_;
+    std::vector<TableHeap *> heaps_;
+  };
+
+  /** @param capacity the bytes of rows the cache holds at most */
+  explicit ResultCache(size_t capacity) : capacity_(capacity) {}
+
+  DISALLOW_COPY_AND_MOVE(ResultCache);
+
+  /**
+   * @param plan the plan, with its parameters bound
+   * @param catalog the catalog of the tables of the plan
+   * @return the fingerprint of the plan and the tables it reads, nullopt if it cannot be cached
+   */
+  static std::optional<CacheablePlan> Fingerprint(const AbstractPlanNode *plan, Catalog *catalog);
+
+  /** @return true if a transaction may use the cache for a plan: it is READ_COMMITTED, and wrote to no table of it */
+  static bool CanUse(Transaction *txn, const CacheablePlan &plan);
+
+  /** @return the modification counts of the tables of a plan, as a result of it is kept with */
+  static std::vector<uint64_t> Versions(const CacheablePlan &plan);
+
+  /**
+   * Looks a result up, and makes it the most recently used.
+   * @param[out] rows the rows of the result, appended to
+   * @return false if there is no result of the plan, or it is of tables that changed since
+   */
+  bool Lookup(const CacheablePlan &plan, std::vector<Tuple> *rows);
+
+  /**
+   * Keeps the result of a plan, unless its tables changed while it was run.
+   * @param versions the modification counts of the tables before the plan was run
+   * @param rows the rows of the result
+   */
+  void Insert(const CacheablePlan &plan, std::vector<uint64_t> versions, std::vector<Tuple> rows);
+
+  /** Forgets every result. */
+  void Clear();
+
+  /** @return the bytes of the results held */
+  size_t GetSize();
+
+  ResultCacheStats GetStats();
+
+ private:
+  struct Entry {
+    std::string fingerprint_;
+    std::vector<uint64_t> versions_;
+    std::vector<Tuple> rows_;
+    size_t bytes_;
+  };
+
+  /** Takes an entry out; under latch_. */
+  void Erase(std::list<Entry>::iterator it);
+
+  const size_t capacity_;
+  std::mutex latch_;
+  /** the entries, the most recently used first */
+  std::list<Entry> entries_;
+  std::unordered_map<std::string, std::list<Entry>::iterator> index_;
+  size_t size_{0};
+  ResultCacheStats stats_;
+};
+
+}  // namespace bustub
@@ -0,0 +1,210 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// session_manager.h
+//
+// Identification: src/include/execution/session_manager.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <condition_variable>  // NOLINT
+#include <cstdint>
+#include <deque>
+#include <future>  // NOLINT
+#include <memory>
+#include <mutex>  // NOLINT
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "catalog/catalog.h"
+#include "common/macros.h"
+#include "concurrency/lock_manager.h"
+#include "concurrency/transaction.h"
+#include "concurrency/transaction_manager.h"
+#include "execution/execution_engine.h"
+#include "execution/executor_context.h"
+#include "execution/memory_manager.h"
+#include "execution/plans/abstract_plan.h"
+#include "storage/table/tuple.h"
+
+namespace bustub {
+
+class SessionManager;
+
+/** What a request of a Session came to. */
+struct SessionResponse {
+  /** false if the request failed, or was refused */
+  bool ok_{true};
+  /** why it failed */
+  std::string error_;
+  /** the rows of a query */
+  std::vector<Tuple> rows_;
+};
+
+/** How much a SessionManager admits at once. */
+struct SessionLimits {
+  /** the sessions open at once; OpenSession refuses more */
+  size_t max_sessions_{64};
+  /** the requests of all sessions queued or running at once; the ones past it are refused */
+  size_t max_queued_requests_{1024};
+};
+
+/**
+ * Session is the state of one client of a SessionManager: its transaction, and the requests it submitted that have not
+ * run yet. The requests of a session run one after the other, in the order they were submitted, on the threads of the
+ * manager, while the client submits more; a client need not wait for a response before it sends the next request, and
+ * gets each one from its future. The requests of different sessions run at the same time, one per thread.
+ *
+ * A query outside of a transaction runs in one of its own, which commits once it is done. Begin starts a transaction
+ * that the queries after it run in, until Commit or Abort. A query that fails, or is cancelled, aborts the transaction
+ * it ran in, as its writes may have been done in part; the requests after it run outside of a transaction. A session
+ * that goes away aborts the transaction it has open, once its requests have run.
+ */
+class Session : public std::enable_shared_from_this<Session> {
+ public:
+  DISALLOW_COPY_AND_MOVE(Session);
+
+  ~Session();
+
+  /**
+   * Submits a query.
+   * @param plan the plan, which has to outlive the request
+   * @return the response, with the rows of the query
+   */
+  std::future<SessionResponse> Query(const AbstractPlanNode *plan);
+
+  /** Submits the start of a transaction, which fails if one is open already. */
+  std::future<SessionResponse> Begin();
+
+  /** Submits the commit of the open transaction, which fails if there is none. */
+  std::future<SessionResponse> Commit();
+
+  /** Submits the abort of the open transaction, which fails if there is none. */
+  std::future<SessionResponse> Abort();
+
+  /** Cancels the query of the session that is running, if there is one; the requests queued after it still run. */
+  void Cancel();
+
+  /** @return the isolation level of the transactions of the session */
+  IsolationLevel GetIsolationLevel() const { return isolation_level_; }
+
+ private:
+  friend class SessionManager;
+
+  enum class RequestType { QUERY, BEGIN, COMMIT, ABORT };
+
+  struct Request {
+    RequestType type_;
+    const AbstractPlanNode *plan_;
+    std::promise<SessionResponse> response_;
+  };
+
+  Session(SessionManager *manager, IsolationLevel isolation_level)
+      : manager_(manager), isolation_level_(isolation_level) {}
+
+  std::future<SessionResponse> Submit(RequestType type, const AbstractPlanNode *plan);
+
+  /** Runs a request, on a thread of the manager. */
+  SessionResponse Run(const Request &request);
+
+  /** Runs a query in the open transaction, or in one of its own. */
+  SessionResponse RunQuery(const AbstractPlanNode *plan);
+
+  SessionManager *const manager_;
+  const IsolationLevel isolation_level_;
+
+  /** The requests not run yet, the one running first; under the latch of the manager */
+  std::deque<Request> requests_;
+  /** The context of the query running, for Cancel; under the latch of the manager */
+  ExecutorContext *running_{nullptr};
+  /** The open transaction, nullptr if there is none; only the thread running a request of the session touches it */
+  Transaction *txn_{nullptr};
+};
+
+/** What a SessionManager did, since it was made. */
+struct SessionManagerStats {
+  uint64_t sessions_opened_{0};
+  /** the sessions OpenSession refused, as there were max_sessions_ open */
+  uint64_t sessions_refused_{0};
+  uint64_t requests_run_{0};
+  /** the requests refused, as there were max_queued_requests_ queued */
+  uint64_t requests_refused_{0};
+};
+
+/**
+ * SessionManager runs the requests of many Sessions on a fixed pool of threads, so that the throughput of the
+ * instance grows with the clients that use it at once, and many more clients may be connected than there are threads.
+ * A thread takes the session that has waited the longest, runs the first request of it, and puts the session back at
+ * the end if it has more, so that a client with a long pipeline of requests does not hold up the others.
+ *
+ * Admission control refuses the sessions past max_sessions_, and the requests past max_queued_requests_, rather than
+ * letting them queue without bound: a refused request gets a response that is not ok_ at once, and the client backs
+ * off. The memory the queries of all sessions hold at once may be limited as well, by a MemoryManager that they share.
+ *
+ * Each query runs in an ExecutorContext of its own, in the transaction of its session, on the catalog and managers of
+ * the instance. The manager has to outlive its sessions.
+ */
+class SessionManager {
+ public:
+  /**
+   * Creates a manager and starts its threads.
+   * @param num_threads the threads that run the requests
+   * @param memory_manager the manager the queries take their memory from, on top of their budgets; nullptr for
+   * just the budgets
+   */
+  SessionManager(Catalog *catalog, BufferPoolManager *bpm, TransactionManager *txn_mgr, LockManager *lock_mgr,
+                 size_t num_threads, SessionLimits limits = {}, MemoryManager *memory_manager = nullptr);
+
+  DISALLOW_COPY_AND_MOVE(SessionManager);
+
+  /** Runs the requests queued, then stops and joins the threads */
+  ~SessionManager();
+
+  /**
+   * Opens a session.
+   * @param isolation_level the isolation level of its transactions
+   * @return the session, nullptr if max_sessions_ are open
+   */
+  std::shared_ptr<Session> OpenSession(IsolationLevel isolation_level = IsolationLevel::REPEATABLE_READ);
+
+  /** @return the engine the queries run on, e.g. to enable its result cache before the first one */
+  ExecutionEngine *GetExecutionEngine() { return &engine_; }
+
+  /** @return the sessions open now */
+  size_t GetSessionCount();
+
+  SessionManagerStats GetStats();
+
+ private:
+  friend class Session;
+
+  void WorkerLoop();
+
+  Catalog *const catalog_;
+  BufferPoolManager *const bpm_;
+  TransactionManager *const txn_mgr_;
+  LockManager *const lock_mgr_;
+  const SessionLimits limits_;
+  MemoryManager *const memory_manager_;
+  ExecutionEngine engine_;
+
+  /** Guards the rest, and the requests of the sessions */
+  std::mutex latch_;
+  std::condition_variable work_cv_;
+  /** The sessions with requests to run, none of which is running; a thread holds on to the one it runs */
+  std::deque<std::shared_ptr<Session>> runnable_;
+  size_t num_sessions_{0};
+  size_t num_queued_{0};
+  SessionManagerStats stats_;
+  bool stop_{false};
+  std::vector<std::thread> threads_;
+};
+
+}  // namespace bustub
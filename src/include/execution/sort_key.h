@@ -0,0 +1,56 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// sort_key.h
+//
+// Identification: src/include/execution/sort_key.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "catalog/schema.h"
+#include "execution/plans/sort_plan.h"
+#include "storage/table/tuple.h"
+
+namespace bustub {
+
+/**
+ * SortKeyEncoder makes normalized keys: the ORDER BY keys of a tuple encoded into bytes whose memcmp order is the
+ * order of the tuples, so that a sort compares two tuples with a memcmp instead of Value by Value. Every key is a byte
+ * that is 1 for a NULL, which sorts after any value, and 0 otherwise, followed by the value: an integer big-endian with
+ * its sign bit flipped, a DECIMAL as the bits of a double that order as it does, a VARCHAR as its bytes with every 0
+ * byte escaped as 0 0xFF, and a 0 0 after them. No key is a prefix of another, so that the bytes of a DESC key can
+ * just be inverted.
+ */
+class SortKeyEncoder {
+ public:
+  /** @param order_bys the directions and expressions of the keys */
+  explicit SortKeyEncoder(const std::vector<std::pair<OrderByType, const AbstractExpression *>> &order_bys)
+      : order_bys_(order_bys) {}
+
+  /** Appends the normalized key of a tuple of the schema to key. */
+  void Encode(const Tuple &tuple, const Schema *schema, std::string *key) const;
+
+  /** Appends the normalized form of a value, of its bytes inverted if descending, to key. */
+  static void EncodeValue(const Value &value, bool descending, std::string *key);
+
+  /** @return the first 8 bytes of a key as a big-endian integer, padded with zeros, which orders as the keys do */
+  static uint64_t Prefix(const char *key, size_t length);
+
+  /** @return less than, equal to or greater than 0 as the left key sorts before, with or after the right one */
+  static int Compare(const char *left, size_t left_length, const char *right, size_t right_length);
+
+ private:
+  const std::vector<std::pair<OrderByType, const AbstractExpression *>> &order_bys_;
+};
+
+}  // namespace bustub
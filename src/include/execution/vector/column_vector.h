@@ -0,0 +1,128 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// column_vector.h
+//
+// Identification: src/include/execution/vector/column_vector.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "common/macros.h"
+#include "common/memory_arena.h"
+#include "type/type_id.h"
+#include "type/value.h"
+
+namespace bustub {
+
+/**
+ * A VARCHAR value of a ColumnVector. The bytes are owned by the vector, and length counts the terminating NUL the
+ * way the length of a VARCHAR Value does.
+ */
+struct StringSlice {
+  const char *data_;
+  uint32_t length_;
+};
+
+/**
+ * ColumnVector holds up to capacity values of a single column, one after the other in a typed array: int8_t for
+ * BOOLEAN and TINYINT, int16_t for SMALLINT, int32_t for INTEGER, int64_t for BIGINT, double for DECIMAL, uint64_t for
+ * TIMESTAMP and StringSlice for VARCHAR. Whether a row is null is kept in a validity bitmap next to the array, so the
+ * slot of a null row holds no particular value; the bytes of VARCHAR values live in an arena of the vector.
+ */
+class ColumnVector {
+ public:
+  /**
+   * Creates a vector of capacity rows, all of them valid.
+   * @param type the type of the column
+   * @param capacity the number of rows the vector has room for
+   */
+  ColumnVector(TypeId type, size_t capacity);
+
+  ColumnVector(const ColumnVector &) = delete;
+  ColumnVector &operator=(const ColumnVector &) = delete;
+  ColumnVector(ColumnVector &&) = default;
+  ColumnVector &operator=(ColumnVector &&) = default;
+
+  /** @return the size in bytes of the slot of a value of type in a vector */
+  static size_t GetWidth(TypeId type);
+
+  /** @return the type of the column */
+  TypeId GetType() const { return type_; }
+
+  /** @return the number of rows the vector has room for */
+  size_t GetCapacity() const { return capacity_; }
+
+  /** @return the typed array of the vector; T has to be the type the column's values are kept as */
+  template <typename T>
+  T *GetData() {
+    BUSTUB_ASSERT(sizeof(T) == width_, "T is not the type the column's values are kept as");
+    return reinterpret_cast<T *>(data_.get());
+  }
+
+  template <typename T>
+  const T *GetData() const {
+    BUSTUB_ASSERT(sizeof(T) == width_, "T is not the type the column's values are kept as");
+    return reinterpret_cast<const T *>(data_.get());
+  }
+
+  /** @return the validity bitmap, one bit per row; a set bit is a row that is not null */
+  const uint64_t *GetValidity() const { return validity_.data(); }
+
+  /** @return true if the row is not null */
+  bool IsValid(size_t row) const { return ((validity_[row / 64] >> (row % 64)) & 1) != 0; }
+
+  /** Marks the row as valid or as null */
+  void SetValid(size_t row, bool valid) {
+    if (valid) {
+      validity_[row / 64] |= uint64_t{1} << (row % 64);
+    } else {
+      validity_[row / 64] &= ~(uint64_t{1} << (row % 64));
+    }
+  }
+
+  /**
+   * Copies the bytes of a VARCHAR value into the vector and makes it the value of the row.
+   * @param length the length of the value, counting its terminating NUL
+   */
+  void SetString(size_t row, const char *data, uint32_t length);
+
+  /** Makes a value, null or not, the value of the row; its type has to be the column's */
+  void SetValue(size_t row, const Value &value);
+
+  /**
+   * Copies rows of another vector of the type into consecutive rows of this one, e.g. the live rows of a chunk, or the
+   * rows of the matches of a join, some of which may repeat.
+   * @param source the vector to copy from
+   * @param rows the rows of source to copy, or nullptr for its first count rows
+   * @param count the number of rows to copy
+   * @param offset the row of this vector that the first of them is copied to
+   */
+  void Gather(const ColumnVector &source, const uint32_t *rows, size_t count, size_t offset = 0);
+
+  /** @return the value of the row, which owns a copy of the bytes of a VARCHAR */
+  Value GetValue(size_t row) const;
+
+  /** Marks every row as valid again and releases the bytes of the VARCHAR values */
+  void Reset();
+
+ private:
+  TypeId type_;
+  size_t capacity_;
+  size_t width_;
+  // 8-byte words, so that every typed array is aligned
+  std::unique_ptr<uint64_t[]> data_;
+  std::vector<uint64_t> validity_;
+  // in a unique_ptr, as the arena cannot be moved and slices point into its blocks
+  std::unique_ptr<MemoryArena> arena_;
+};
+
+}  // namespace bustub
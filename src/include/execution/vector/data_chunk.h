@@ -0,0 +1,131 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// data_chunk.h
+//
+// Identification: src/include/execution/vector/data_chunk.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "catalog/schema.h"
+#include "common/macros.h"
+#include "execution/vector/column_vector.h"
+#include "storage/table/tuple.h"
+
+namespace bustub {
+
+/**
+ * DataChunk is a batch of rows of a schema, kept column by column: a ColumnVector per column of the schema, all of
+ * the same capacity. It is what operators of a vectorized engine pass to each other instead of single tuples.
+ *
+ * A chunk can carry a selection vector, the ascending list of its rows that are still live after e.g. a filter, so
+ * that rows are dropped without moving the rows around them. Without a selection vector, every row is live.
+ */
+class DataChunk {
+ public:
+  static constexpr size_t DEFAULT_CAPACITY = 1024;
+
+  /**
+   * Creates an empty chunk.
+   * @param schema the schema of the rows, which has to outlive the chunk
+   * @param capacity the number of rows the chunk has room for
+   */
+  explicit DataChunk(const Schema *schema, size_t capacity = DEFAULT_CAPACITY);
+
+  DISALLOW_COPY_AND_MOVE(DataChunk);
+
+  /** @return the schema of the rows */
+  const Schema *GetSchema() const { return schema_; }
+
+  /** @return the number of columns */
+  size_t GetColumnCount() const { return columns_.size(); }
+
+  /** @return the vector of a column */
+  ColumnVector &GetColumn(size_t column_idx) { return columns_[column_idx]; }
+  const ColumnVector &GetColumn(size_t column_idx) const { return columns_[column_idx]; }
+
+  /** @return the number of rows in the chunk, whether they are selected or not */
+  size_t GetSize() const { return size_; }
+
+  /** Sets the number of rows, for callers that fill the vectors themselves */
+  void SetSize(size_t size) {
+    BUSTUB_ASSERT(size <= capacity_, "a chunk cannot hold more rows than its capacity");
+    size_ = size;
+  }
+
+  /** @return the number of rows the chunk has room for */
+  size_t GetCapacity() const { return capacity_; }
+
+  /** @return true if there is no room for another row */
+  bool IsFull() const { return size_ == capacity_; }
+
+  /**
+   * Decodes a tuple of the chunk's schema into the next row, straight from the serialized bytes of the tuple. A
+   * VARCHAR column of the tuple must not be toasted.
+   * @return false if the chunk is full
+   */
+  bool Append(const Tuple &tuple);
+
+  /**
+   * Decodes just some columns of a tuple of the chunk's schema into the next row, and makes the others null, e.g. the
+   * columns that a scan reads of the tuples of its table.
+   * @param tuple the tuple, whose columns among columns must not be toasted
+   * @param columns the indexes of the columns to decode
+   * @return false if the chunk is full
+   */
+  bool Append(const Tuple &tuple, const std::vector<uint32_t> &columns);
+
+  /** @return the row as a tuple of the chunk's schema */
+  Tuple GetTuple(size_t row) const;
+
+  /** Appends the selected rows as tuples, in order */
+  void GetTuples(std::vector<Tuple> *tuples) const;
+
+  /** @return true if the chunk carries a selection vector */
+  bool HasSelection() const { return has_selection_; }
+
+  /**
+   * Narrows the live rows down to some of the rows.
+   * @param selection the rows, ascending; it may only narrow an existing selection further
+   */
+  void SetSelection(std::vector<uint32_t> selection);
+
+  /** @return the selection vector; only meaningful if HasSelection */
+  const std::vector<uint32_t> &GetSelection() const { return selection_; }
+
+  /** Makes every row live again */
+  void ClearSelection() {
+    has_selection_ = false;
+    selection_.clear();
+  }
+
+  /** @return the number of live rows */
+  size_t GetSelectedCount() const { return has_selection_ ? selection_.size() : size_; }
+
+  /** @return the row the i-th live row is */
+  uint32_t GetSelectedRow(size_t i) const { return has_selection_ ? selection_[i] : static_cast<uint32_t>(i); }
+
+  /** Empties the chunk for the next batch, keeping its memory */
+  void Reset();
+
+ private:
+  /** Decodes a column of the serialized bytes of a tuple of the chunk's schema into the next row */
+  void DecodeColumn(const char *data, uint32_t column_idx);
+
+  const Schema *schema_;
+  size_t capacity_;
+  size_t size_{0};
+  std::vector<ColumnVector> columns_;
+  bool has_selection_{false};
+  std::vector<uint32_t> selection_;
+};
+
+}  // namespace bustub
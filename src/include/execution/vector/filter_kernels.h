@@ -0,0 +1,395 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// filter_kernels.h
+//
+// Identification: src/include/execution/vector/filter_kernels.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <immintrin.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <type_traits>
+
+#include "execution/vector/column_vector.h"
+#include "type/type_id.h"
+#include "type/type_util.h"
+#include "type/value.h"
+
+namespace bustub {
+
+/**
+ * A filter kernel selects the rows of a column vector for which a comparison with a constant, or with the same rows
+ * of a second vector of the same type, holds. Rows that are null on either side are never selected.
+ *
+ * @param left the vector on the left of the comparison
+ * @param right the vector on the right, nullptr to compare left with constant
+ * @param constant the right side of the comparison if right is nullptr; if it is null, no row is selected
+ * @param selection the rows to look at, in ascending order, or nullptr to look at the first count rows
+ * @param count the number of rows to look at
+ * @param[out] out the selected rows in ascending order, room for count of them
+ * @return the number of selected rows
+ */
+using FilterKernel = size_t (*)(const ColumnVector &left, const ColumnVector *right, const Value &constant,
+                                const uint32_t *selection, size_t count, uint32_t *out);
+
+namespace filter {
+
+enum class Predicate { EQ, NE, LT, LE, GT, GE };
+
+/** The predicate of an op such as std::less<>. */
+template <typename Op>
+struct PredicateOf;
+template <>
+struct PredicateOf<std::equal_to<>> {
+  static constexpr Predicate VALUE = Predicate::EQ;
+};
+template <>
+struct PredicateOf<std::not_equal_to<>> {
+  static constexpr Predicate VALUE = Predicate::NE;
+};
+template <>
+struct PredicateOf<std::less<>> {
+  static constexpr Predicate VALUE = Predicate::LT;
+};
+template <>
+struct PredicateOf<std::less_equal<>> {
+  static constexpr Predicate VALUE = Predicate::LE;
+};
+template <>
+struct PredicateOf<std::greater<>> {
+  static constexpr Predicate VALUE = Predicate::GT;
+};
+template <>
+struct PredicateOf<std::greater_equal<>> {
+  static constexpr Predicate VALUE = Predicate::GE;
+};
+
+/** @return x p y */
+template <Predicate P, typename T>
+inline bool Apply(T x, T y) {
+  switch (P) {
+    case Predicate::EQ:
+      return x == y;
+    case Predicate::NE:
+      return x != y;
+    case Predicate::LT:
+      return x < y;
+    case Predicate::LE:
+      return x <= y;
+    case Predicate::GT:
+      return x > y;
+    case Predicate::GE:
+      return x >= y;
+  }
+  return false;
+}
+
+/** @return x p y for VARCHARs, compared the way VarlenType compares them */
+template <Predicate P>
+inline bool Apply(StringSlice x, StringSlice y) {
+  return Apply<P>(TypeUtil::CompareStrings(x.data_, x.length_ - 1, y.data_, y.length_ - 1), 0);
+}
+
+/**
+ * Compares blocks of 64 rows with SIMD instructions, where the CPU the tree is built for has them. Compare returns the
+ * bitmap of the rows p holds for, row i in bit i; Simd<T>::AVAILABLE is false for types that go through the scalar
+ * loop of CompareBlock.
+ */
+template <typename T>
+struct Simd {
+  static constexpr bool AVAILABLE = false;
+  template <Predicate P, bool constant>
+  static uint64_t Compare(const T *left, const T *right, T value) {
+    return 0;
+  }
+};
+
+#if defined(__AVX512F__)
+
+/** @return the _MM_CMPINT_* predicate of p */
+template <Predicate P>
+constexpr int IntPredicate() {
+  switch (P) {
+    case Predicate::EQ:
+      return _MM_CMPINT_EQ;
+    case Predicate::NE:
+      return _MM_CMPINT_NE;
+    case Predicate::LT:
+      return _MM_CMPINT_LT;
+    case Predicate::LE:
+      return _MM_CMPINT_LE;
+    case Predicate::GT:
+      return _MM_CMPINT_NLE;
+    case Predicate::GE:
+      return _MM_CMPINT_NLT;
+  }
+  return _MM_CMPINT_EQ;
+}
+
+#endif
+
+#if defined(__AVX2__) || defined(__AVX512F__)
+
+/** @return the _CMP_* predicate of p, which agrees with the C++ operator on NaNs */
+template <Predicate P>
+constexpr int FloatPredicate() {
+  switch (P) {
+    case Predicate::EQ:
+      return _CMP_EQ_OQ;
+    case Predicate::NE:
+      return _CMP_NEQ_UQ;
+    case Predicate::LT:
+      return _CMP_LT_OQ;
+    case Predicate::LE:
+      return _CMP_LE_OQ;
+    case Predicate::GT:
+      return _CMP_GT_OQ;
+    case Predicate::GE:
+      return _CMP_GE_OQ;
+  }
+  return _CMP_EQ_OQ;
+}
+
+#endif
+
+#if defined(__AVX512F__)
+
+// An AVX-512 comparison of a vector of a type's lanes yields the bitmap of the lanes directly
+#define BUSTUB_SIMD_512(TYPE, LANES, SET1, LOAD, CMP, PREDICATE)                                      \
+  template <>                                                                                        \
+  struct Simd<TYPE> {                                                                                \
+    static constexpr bool AVAILABLE = true;                                                          \
+    template <Predicate P, bool constant>                                                            \
+    static uint64_t Compare(const TYPE *left, const TYPE *right, TYPE value) {                       \
+      constexpr int predicate = PREDICATE<P>();                                                      \
+      auto broadcast = SET1(value);                                                                  \
+      uint64_t mask = 0;                                                                             \
+      for (int i = 0; i < 64; i += (LANES)) {                                                        \
+        auto r = constant ? broadcast : LOAD(right + i);                                             \
+        mask |= static_cast<uint64_t>(CMP(LOAD(left + i), r, predicate)) << i; /* NOLINT */          \
+      }                                                                                              \
+      return mask;                                                                                   \
+    }                                                                                                \
+  }
+
+#if defined(__AVX512BW__)
+BUSTUB_SIMD_512(int8_t, 64, _mm512_set1_epi8, _mm512_loadu_si512, _mm512_cmp_epi8_mask, IntPredicate);
+BUSTUB_SIMD_512(int16_t, 32, _mm512_set1_epi16, _mm512_loadu_si512, _mm512_cmp_epi16_mask, IntPredicate);
+#endif
+BUSTUB_SIMD_512(int32_t, 16, _mm512_set1_epi32, _mm512_loadu_si512, _mm512_cmp_epi32_mask, IntPredicate);
+BUSTUB_SIMD_512(int64_t, 8, _mm512_set1_epi64, _mm512_loadu_si512, _mm512_cmp_epi64_mask, IntPredicate);
+BUSTUB_SIMD_512(uint64_t, 8, _mm512_set1_epi64, _mm512_loadu_si512, _mm512_cmp_epu64_mask, IntPredicate);
+BUSTUB_SIMD_512(double, 8, _mm512_set1_pd, _mm512_loadu_pd, _mm512_cmp_pd_mask, FloatPredicate);
+
+#undef BUSTUB_SIMD_512
+
+#elif defined(__AVX2__)
+
+/**
+ * AVX2 compares integers for equality and "greater than" only; the other predicates swap the operands or negate the
+ * result, and the lanes are gathered into a bitmap with movemask.
+ */
+template <Predicate P>
+inline __m256i CompareInts(__m256i x, __m256i y, __m256i (*eq)(__m256i, __m256i), __m256i (*gt)(__m256i, __m256i)) {
+  const __m256i ones = _mm256_set1_epi32(-1);
+  switch (P) {
+    case Predicate::EQ:
+      return eq(x, y);
+    case Predicate::NE:
+      return _mm256_xor_si256(eq(x, y), ones);
+    case Predicate::LT:
+      return gt(y, x);
+    case Predicate::LE:
+      return _mm256_xor_si256(gt(x, y), ones);
+    case Predicate::GT:
+      return gt(x, y);
+    case Predicate::GE:
+      return _mm256_xor_si256(gt(y, x), ones);
+  }
+  return eq(x, y);
+}
+
+inline __m256i Eq32(__m256i x, __m256i y) { return _mm256_cmpeq_epi32(x, y); }
+inline __m256i Gt32(__m256i x, __m256i y) { return _mm256_cmpgt_epi32(x, y); }
+inline __m256i Eq64(__m256i x, __m256i y) { return _mm256_cmpeq_epi64(x, y); }
+inline __m256i Gt64(__m256i x, __m256i y) { return _mm256_cmpgt_epi64(x, y); }
+
+template <>
+struct Simd<int32_t> {
+  static constexpr bool AVAILABLE = true;
+  template <Predicate P, bool constant>
+  static uint64_t Compare(const int32_t *left, const int32_t *right, int32_t value) {
+    __m256i broadcast = _mm256_set1_epi32(value);
+    uint64_t mask = 0;
+    for (int i = 0; i < 64; i += 8) {
+      __m256i l = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(left + i));
+      __m256i r = constant ? broadcast : _mm256_loadu_si256(reinterpret_cast<const __m256i *>(right + i));
+      __m256i lanes = CompareInts<P>(l, r, Eq32, Gt32);
+      mask |= static_cast<uint64_t>(_mm256_movemask_ps(_mm256_castsi256_ps(lanes))) << i;
+    }
+    return mask;
+  }
+};
+
+template <>
+struct Simd<int64_t> {
+  static constexpr bool AVAILABLE = true;
+  template <Predicate P, bool constant>
+  static uint64_t Compare(const int64_t *left, const int64_t *right, int64_t value) {
+    __m256i broadcast = _mm256_set1_epi64x(value);
+    uint64_t mask = 0;
+    for (int i = 0; i < 64; i += 4) {
+      __m256i l = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(left + i));
+      __m256i r = constant ? broadcast : _mm256_loadu_si256(reinterpret_cast<const __m256i *>(right + i));
+      __m256i lanes = CompareInts<P>(l, r, Eq64, Gt64);
+      mask |= static_cast<uint64_t>(_mm256_movemask_pd(_mm256_castsi256_pd(lanes))) << i;
+    }
+    return mask;
+  }
+};
+
+template <>
+struct Simd<double> {
+  static constexpr bool AVAILABLE = true;
+  template <Predicate P, bool constant>
+  static uint64_t Compare(const double *left, const double *right, double value) {
+    __m256d broadcast = _mm256_set1_pd(value);
+    uint64_t mask = 0;
+    for (int i = 0; i < 64; i += 4) {
+      __m256d r = constant ? broadcast : _mm256_loadu_pd(right + i);
+      constexpr int predicate = FloatPredicate<P>();
+      __m256d lanes = _mm256_cmp_pd(_mm256_loadu_pd(left + i), r, predicate);
+      mask |= static_cast<uint64_t>(_mm256_movemask_pd(lanes)) << i;
+    }
+    return mask;
+  }
+};
+
+#endif
+
+/** @return the bitmap of the count rows (at most 64) of left p right, or of left p value if constant */
+template <typename T, Predicate P, bool constant>
+inline uint64_t CompareBlock(const T *left, const T *right, T value, size_t count) {
+  if constexpr (Simd<T>::AVAILABLE) {
+    if (count == 64) {
+      return Simd<T>::template Compare<P, constant>(left, right, value);
+    }
+  }
+  uint64_t mask = 0;
+  for (size_t i = 0; i < count; i++) {
+    mask |= static_cast<uint64_t>(Apply<P>(left[i], constant ? value : right[i])) << i;
+  }
+  return mask;
+}
+
+/** Appends the rows of the bits set in mask, offset by base. @return the number of rows appended */
+inline size_t AppendRows(uint64_t mask, uint32_t base, uint32_t *out) {
+  size_t count = 0;
+  while (mask != 0) {
+    out[count++] = base + static_cast<uint32_t>(__builtin_ctzll(mask));
+    mask &= mask - 1;
+  }
+  return count;
+}
+
+/** @return the value of a constant the way vectors of its type keep it */
+template <typename T>
+inline T NativeValue(const Value &value) {
+  if constexpr (std::is_same_v<T, StringSlice>) {
+    return StringSlice{value.GetData(), value.GetLength()};
+  } else {
+    return value.GetAs<T>();
+  }
+}
+
+/** The FilterKernel of p over vectors of T */
+template <typename T, Predicate P>
+size_t Filter(const ColumnVector &left, const ColumnVector *right, const Value &constant, const uint32_t *selection,
+              size_t count, uint32_t *out) {
+  if (right == nullptr && constant.IsNull()) {
+    return 0;
+  }
+  const T *l = left.GetData<T>();
+  const T *r = right == nullptr ? nullptr : right->GetData<T>();
+  T value = right == nullptr ? NativeValue<T>(constant) : T{};
+  size_t selected = 0;
+
+  // VARCHAR slices of null rows point nowhere, so they go row by row, as do rows picked by a selection vector
+  if (selection != nullptr || std::is_same_v<T, StringSlice>) {
+    for (size_t i = 0; i < count; i++) {
+      uint32_t row = selection == nullptr ? static_cast<uint32_t>(i) : selection[i];
+      bool keep = left.IsValid(row);
+      if (r == nullptr) {
+        keep = keep && Apply<P>(l[row], value);
+      } else {
+        keep = keep && right->IsValid(row) && Apply<P>(l[row], r[row]);
+      }
+      out[selected] = row;
+      selected += keep ? 1 : 0;
+    }
+    return selected;
+  }
+
+  // otherwise blocks of 64 rows are compared at once and masked with the words of the validity bitmaps
+  const uint64_t *left_validity = left.GetValidity();
+  const uint64_t *right_validity = right == nullptr ? nullptr : right->GetValidity();
+  for (size_t base = 0; base < count; base += 64) {
+    size_t block = std::min<size_t>(64, count - base);
+    uint64_t mask = r == nullptr ? CompareBlock<T, P, true>(l + base, nullptr, value, block)
+                                 : CompareBlock<T, P, false>(l + base, r + base, value, block);
+    mask &= left_validity[base / 64];
+    if (right_validity != nullptr) {
+      mask &= right_validity[base / 64];
+    }
+    if (block < 64) {
+      mask &= (uint64_t{1} << block) - 1;
+    }
+    selected += AppendRows(mask, static_cast<uint32_t>(base), out + selected);
+  }
+  return selected;
+}
+
+template <Predicate P>
+inline FilterKernel Bind(TypeId left, TypeId right) {
+  if (left != right) {
+    return nullptr;
+  }
+  switch (left) {
+    case TypeId::BOOLEAN:
+    case TypeId::TINYINT:
+      return &Filter<int8_t, P>;
+    case TypeId::SMALLINT:
+      return &Filter<int16_t, P>;
+    case TypeId::INTEGER:
+      return &Filter<int32_t, P>;
+    case TypeId::BIGINT:
+      return &Filter<int64_t, P>;
+    case TypeId::DECIMAL:
+      return &Filter<double, P>;
+    case TypeId::TIMESTAMP:
+      return &Filter<uint64_t, P>;
+    case TypeId::VARCHAR:
+      return &Filter<StringSlice, P>;
+    default:
+      return nullptr;
+  }
+}
+
+}  // namespace filter
+
+/** @return the filter kernel of left op right, for an op such as std::less<>, nullptr if the types differ */
+template <typename Op>
+inline FilterKernel BindFilter(TypeId left, TypeId right) {
+  return filter::Bind<filter::PredicateOf<Op>::VALUE>(left, right);
+}
+
+}  // namespace bustub
@@ -0,0 +1,45 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// hash_kernels.h
+//
+// Identification: src/include/execution/vector/hash_kernels.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "common/util/hash_util.h"
+#include "execution/vector/column_vector.h"
+#include "execution/vector/data_chunk.h"
+
+namespace bustub {
+
+/**
+ * Hashes rows of a column vector a column at a time, each row as HashUtil::HashValue hashes its value, so that a batch
+ * and a row at a time agree: the integer types hash alike and a null row hashes to HashUtil::NULL_HASH.
+ * @param column the vector
+ * @param selection the rows to hash, or nullptr for the first count rows
+ * @param count the number of rows to hash
+ * @param[in,out] hashes a hash per row hashed, in the order of selection; with combine, the hash of each row is
+ * combined into the one there, as HashUtil::CombineHashes(hashes[i], hash), rather than replacing it
+ * @param combine whether to combine the hashes into hashes rather than store them
+ */
+void HashColumn(const ColumnVector &column, const uint32_t *selection, size_t count, hash_t *hashes, bool combine);
+
+/**
+ * Hashes the live rows of a chunk by the values of some of its columns, as std::hash<HashJoinKey> hashes a key of
+ * those values, one column after the other.
+ * @param chunk the chunk
+ * @param columns the indexes of the columns of the key
+ * @param[out] hashes a hash per live row, room for chunk.GetSelectedCount() of them
+ */
+void HashChunk(const DataChunk &chunk, const std::vector<uint32_t> &columns, hash_t *hashes);
+
+}  // namespace bustub
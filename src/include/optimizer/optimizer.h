@@ -0,0 +1,169 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// optimizer.h
+//
+// Identification: src/include/optimizer/optimizer.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "catalog/catalog.h"
+#include "common/macros.h"
+#include "execution/expressions/abstract_expression.h"
+#include "execution/expressions/column_value_expression.h"
+#include "execution/plans/abstract_plan.h"
+#include "execution/plans/index_scan_plan.h"
+#include "execution/plans/seq_scan_plan.h"
+
+namespace bustub {
+
+/**
+ * Optimizer rewrites a plan tree into one that produces the same rows for less work. It applies its rules bottom-up,
+ * to each node once its children have been rewritten:
+ *
+ * - expression simplification: the predicates and output columns of scans, nested loop joins and projections have
+ *   their constant subexpressions folded into constants, and the conjuncts that are true dropped; subexpressions that
+ *   are the same, such as a column read by the predicate and by the output schema, become one shared node, which the
+ *   executors evaluate once per row for all the output columns that are made of it;
+ * - predicate pushdown: the predicate of a nested loop join that only refers to one of its sides is moved into the
+ *   scan of that side, which filters the rows before the join sees them;
+ * - limit pushdown: a limit is moved below the projections under it, so that a limit over a sort reaches the sort and
+ *   is run as a top-N;
+ * - projection pruning: a projection over a sequential scan is folded into the output schema of the scan, which then
+ *   builds only the columns the projection outputs;
+ * - scan selection: a sequential scan whose predicate compares an indexed column with a constant or a parameter is
+ *   turned into an index scan of the key range the predicate holds in, if it is covered by the key of the index, which
+ *   the scan then reads instead of the table heap, or if the statistics say the range is a small part of the table; a
+ *   scan without a range is turned into an index-only scan of a narrow index that covers it;
+ * - join selection: a nested loop join on the equality of a column of each side is turned into a nested index join
+ *   when its inner side is a table with an index on the column and its outer side is much smaller, and into a hash
+ *   join that builds on the smaller side otherwise.
+ *
+ * The sizes of the sides come from EstimateRows, which works from the statistics that Catalog::Analyze collected, and
+ * falls back on fixed guesses for tables that were never analyzed.
+ *
+ * The nodes, schemas and expressions that the optimizer makes are owned by it, so it has to outlive the plans it
+ * returns; the nodes of the input that it keeps are shared with them, and are left untouched.
+ */
+class Optimizer {
+ public:
+  /** The number of rows a table that was never analyzed is taken to have */
+  static constexpr double DEFAULT_ROW_COUNT = 1000;
+  /** How many times smaller than the inner side the outer side of a nested index join has to be */
+  static constexpr double INDEX_JOIN_RATIO = 4;
+  /** The largest fraction of the rows of a table that an index scan that looks them up in the heap is chosen for */
+  static constexpr double INDEX_SCAN_SELECTIVITY = 0.1;
+
+  /** @param catalog the catalog of the tables the plans read */
+  explicit Optimizer(Catalog *catalog) : catalog_(catalog) {}
+
+  DISALLOW_COPY_AND_MOVE(Optimizer);
+
+  /**
+   * @param plan the plan to optimize
+   * @return the optimized plan, which is the input plan if no rule applied to it
+   */
+  const AbstractPlanNode *Optimize(const AbstractPlanNode *plan);
+
+  /** @return the estimated number of rows the plan produces */
+  double EstimateRows(const AbstractPlanNode *plan) const;
+
+  /**
+   * @return the expression with its constant subexpressions folded, and its subexpressions shared with the equal ones
+   * of the expressions simplified before it for the same plan node; the expression itself if nothing in it changed
+   */
+  const AbstractExpression *Simplify(const AbstractExpression *expr);
+
+ private:
+  /** Maps a column of an expression to the expression it is replaced with, or to nullptr if it cannot be */
+  using ColumnMap = std::function<const AbstractExpression *(const ColumnValueExpression *column)>;
+  /** A rule, which returns the node it is given if it does not apply to it */
+  using Rule = const AbstractPlanNode *(Optimizer::*)(const AbstractPlanNode *plan);
+
+  /** @return the plan with the rule applied to each of its nodes, bottom-up */
+  const AbstractPlanNode *Transform(const AbstractPlanNode *plan, Rule rule);
+
+  /** @return the plan node rebuilt over the given children, or nullptr if it is of a type that is not rebuilt */
+  const AbstractPlanNode *WithChildren(const AbstractPlanNode *plan, std::vector<const AbstractPlanNode *> children);
+
+  /** The logical rules and the choice of joins, which see the scans before SelectScan turns them into index scans */
+  const AbstractPlanNode *RewriteNode(const AbstractPlanNode *plan);
+  const AbstractPlanNode *SimplifyNode(const AbstractPlanNode *plan);
+  const AbstractPlanNode *PushDownJoinPredicate(const AbstractPlanNode *plan);
+  const AbstractPlanNode *PushDownLimit(const AbstractPlanNode *plan);
+  const AbstractPlanNode *PruneProjection(const AbstractPlanNode *plan);
+  const AbstractPlanNode *SelectScan(const AbstractPlanNode *plan);
+  const AbstractPlanNode *SelectJoin(const AbstractPlanNode *plan);
+
+  /**
+   * @return a copy of the expression whose columns are replaced by the map, or nullptr if the expression or one of its
+   * columns cannot be rewritten; the expression itself if nothing in it changed
+   */
+  const AbstractExpression *Rewrite(const AbstractExpression *expr, const ColumnMap &map);
+
+  /** @return the schema with the expressions of its columns simplified, the schema itself if none changed */
+  const Schema *SimplifySchema(const Schema *schema);
+
+  /** @return the node equal to the expression that was simplified first, whose children are shared already */
+  const AbstractExpression *Intern(const AbstractExpression *expr);
+
+  /** @return the expression of the output column of a scan, as one over the columns of its table */
+  const AbstractExpression *ScanColumn(const SeqScanPlanNode *scan, uint32_t col_idx);
+
+  /** @return a column of the given side of a join, owned by the optimizer */
+  const AbstractExpression *MakeColumn(uint32_t tuple_idx, uint32_t col_idx, TypeId type);
+
+  /** @return the expression with the sides of the join its columns are of swapped */
+  const AbstractExpression *Flip(const AbstractExpression *expr);
+
+  /**
+   * @return the nested index join of outer with the table inner scans, on outer_key = inner_key, or nullptr if inner
+   * has no index on the key or outer is not small enough
+   * @param flip true if outer is the right side of the join, whose columns are to be swapped with the left's
+   */
+  const AbstractPlanNode *MakeIndexJoin(const AbstractPlanNode *join, const AbstractPlanNode *outer,
+                                        const AbstractPlanNode *inner, const AbstractExpression *outer_key,
+                                        const AbstractExpression *inner_key, bool flip);
+
+  /** @return a schema of the columns of the template, each computed by the expression of the same position */
+  const Schema *MakeSchema(const Schema *like, const std::vector<const AbstractExpression *> &exprs);
+
+  /** @return the range of keys of an index of the key columns that the predicate bounds, the default if none */
+  static IndexKeyRange KeyRangeOf(const AbstractExpression *predicate, const std::vector<uint32_t> &key_attrs);
+
+  /** @return the selectivity of the predicate of a scan that is to read a range of an index */
+  double EstimateRangeSelectivity(const AbstractExpression *predicate, const TableMetadata *table_info) const;
+
+  /** @return the fraction of the rows of the table that the predicate over its columns holds for */
+  double EstimateSelectivity(const AbstractExpression *predicate, const TableMetadata *table_info) const;
+
+  template <typename T>
+  const T *Own(std::unique_ptr<T> owned) {
+    const T *raw = owned.get();
+    Keep(std::move(owned));
+    return raw;
+  }
+  void Keep(std::unique_ptr<AbstractPlanNode> plan) { plans_.push_back(std::move(plan)); }
+  void Keep(std::unique_ptr<AbstractExpression> expr) { exprs_.push_back(std::move(expr)); }
+  void Keep(std::unique_ptr<Schema> schema) { schemas_.push_back(std::move(schema)); }
+
+  Catalog *catalog_;
+  std::vector<std::unique_ptr<AbstractPlanNode>> plans_;
+  std::vector<std::unique_ptr<AbstractExpression>> exprs_;
+  std::vector<std::unique_ptr<Schema>> schemas_;
+  /** The simplified expressions of the plan node being simplified, by what they compute */
+  std::unordered_map<std::string, const AbstractExpression *> interned_;
+};
+
+}  // namespace bustub
@@ -12,7 +12,12 @@
 
 #pragma once
 
+#include <algorithm>
 #include <memory>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "common/macros.h"
 
 namespace bustub {
 
@@ -22,16 +27,13 @@ namespace bustub {
 template <typename T>
 class Matrix {
  protected:
-  // TODO(P0): Add implementation
-  Matrix(int r, int c) {}
+  Matrix(int r, int c) : rows(r), cols(c), linear(new T[static_cast<size_t>(r) * c]()) {}
 
   // # of rows in the matrix
   int rows;
   // # of Columns in the matrix
   int cols;
-  // Flattened array containing the elements of the matrix
-  // TODO(P0) : Allocate the array in the constructor. Don't forget to free up
-  // the array in the destructor.
+  // Flattened array containing the elements of the matrix, row after row
   T *linear;
 
  public:
@@ -50,61 +52,85 @@ class Matrix {
   // Sets the matrix elements based on the array arr
   virtual void MatImport(T *arr) = 0;
 
-  // TODO(P0): Add implementation
-  virtual ~Matrix() = default;
+  DISALLOW_COPY_AND_MOVE(Matrix);
+
+  virtual ~Matrix() { delete[] linear; }
 };
 
+template <typename T>
+class RowMatrixOperations;
+
 template <typename T>
 class RowMatrix : public Matrix<T> {
  public:
-  // TODO(P0): Add implementation
-  RowMatrix(int r, int c) : Matrix<T>(r, c) {}
+  RowMatrix(int r, int c) : Matrix<T>(r, c), data_(new T *[r]) {
+    for (int i = 0; i < r; i++) {
+      data_[i] = this->linear + static_cast<size_t>(i) * c;
+    }
+  }
 
-  // TODO(P0): Add implementation
-  int GetRows() override { return 0; }
+  int GetRows() override { return this->rows; }
 
-  // TODO(P0): Add implementation
-  int GetColumns() override { return 0; }
+  int GetColumns() override { return this->cols; }
 
-  // TODO(P0): Add implementation
   T GetElem(int i, int j) override { return data_[i][j]; }
 
-  // TODO(P0): Add implementation
-  void SetElem(int i, int j, T val) override {}
+  void SetElem(int i, int j, T val) override { data_[i][j] = val; }
+
+  void MatImport(T *arr) override { std::copy(arr, arr + Size(), this->linear); }
 
-  // TODO(P0): Add implementation
-  void MatImport(T *arr) override {}
+  // Return the flattened array of the elements, row after row, for the kernels that run over it
+  T *GetData() { return this->linear; }
+  const T *GetData() const { return this->linear; }
 
-  // TODO(P0): Add implementation
-  ~RowMatrix() override = default;
+  ~RowMatrix() override { delete[] data_; }
 
  private:
-  // 2D array containing the elements of the matrix in row-major format
-  // TODO(P0): Allocate the array of row pointers in the constructor. Use these pointers
-  // to point to corresponding elements of the 'linear' array.
-  // Don't forget to free up the array in the destructor.
+  friend class RowMatrixOperations<T>;
+
+  size_t Size() const { return static_cast<size_t>(this->rows) * this->cols; }
+
+  // 2D array containing the elements of the matrix in row-major format; each row points into the 'linear' array
   T **data_;
 };
 
+/*
+ * The operations on RowMatrix. The ones that take unique_ptrs allocate their result; the ones that take an output
+ * matrix write into it, so that a caller that runs them over and over, e.g. in a UDF, reuses the one it has.
+ *
+ * The kernels run over the flattened arrays rather than through GetElem/SetElem. The product goes tile by tile, so
+ * that the rows of mat2 a tile reads stay in the cache while the rows of mat1 go over them, and its inner loop runs
+ * along the rows of mat2 and of the output, which the compiler vectorizes. It may run on more than one thread, each of
+ * which computes its own bands of rows of the output.
+ */
 template <typename T>
 class RowMatrixOperations {
  public:
+  // The rows, inner dimension, and columns of a tile of the product
+  static constexpr int TILE_ROWS = 32;
+  static constexpr int TILE_INNER = 128;
+  static constexpr int TILE_COLUMNS = 256;
+
   // Compute (mat1 + mat2) and return the result.
   // Return nullptr if dimensions mismatch for input matrices.
   static std::unique_ptr<RowMatrix<T>> AddMatrices(std::unique_ptr<RowMatrix<T>> mat1,
                                                    std::unique_ptr<RowMatrix<T>> mat2) {
-    // TODO(P0): Add code
-
-    return std::unique_ptr<RowMatrix<T>>(nullptr);
+    auto result = std::make_unique<RowMatrix<T>>(mat1->rows, mat1->cols);
+    if (!Add(*mat1, *mat2, result.get())) {
+      return std::unique_ptr<RowMatrix<T>>(nullptr);
+    }
+    return result;
   }
 
   // Compute matrix multiplication (mat1 * mat2) and return the result.
   // Return nullptr if dimensions mismatch for input matrices.
   static std::unique_ptr<RowMatrix<T>> MultiplyMatrices(std::unique_ptr<RowMatrix<T>> mat1,
                                                         std::unique_ptr<RowMatrix<T>> mat2) {
-    // TODO(P0): Add code
-
-    return std::unique_ptr<RowMatrix<T>>(nullptr);
+    auto result = std::make_unique<RowMatrix<T>>(mat1->rows, mat2->cols);
+    if (!Multiply(*mat1, *mat2, result.get())) {
+      return std::unique_ptr<RowMatrix<T>>(nullptr);
+    }
+    return result;
   }
 
   // Simplified GEMM (general matrix multiply) operation
@@ -112,9 +138,112 @@ class RowMatrixOperations {
   static std::unique_ptr<RowMatrix<T>> GemmMatrices(std::unique_ptr<RowMatrix<T>> matA,
                                                     std::unique_ptr<RowMatrix<T>> matB,
                                                     std::unique_ptr<RowMatrix<T>> matC) {
-    // TODO(P0): Add code
+    // the product accumulates into matC, which is ours
+    if (!Gemm(*matA, *matB, *matC, matC.get())) {
+      return std::unique_ptr<RowMatrix<T>>(nullptr);
+    }
+    return matC;
+  }
+
+  // Compute (mat1 + mat2) into out, which may be mat1 or mat2.
+  // Return false if dimensions mismatch, and leave out as it was.
+  static bool Add(const RowMatrix<T> &mat1, const RowMatrix<T> &mat2, RowMatrix<T> *out) {
+    if (!SameShape(mat1, mat2) || !SameShape(mat1, *out)) {
+      return false;
+    }
+    const T *a = mat1.GetData();
+    const T *b = mat2.GetData();
+    T *c = out->GetData();
+    for (size_t i = 0, n = mat1.Size(); i < n; i++) {
+      c[i] = a[i] + b[i];
+    }
+    return true;
+  }
+
+  // Compute (mat1 * mat2) into out, on up to num_threads threads.
+  // Return false if dimensions mismatch, or out is one of the inputs, and leave out as it was.
+  static bool Multiply(const RowMatrix<T> &mat1, const RowMatrix<T> &mat2, RowMatrix<T> *out,
+                       size_t num_threads = 1) {
+    if (!CanMultiply(mat1, mat2, *out)) {
+      return false;
+    }
+    std::fill(out->GetData(), out->GetData() + out->Size(), T());
+    MultiplyAdd(mat1, mat2, out, num_threads);
+    return true;
+  }
+
+  // Compute (matA * matB + matC) into out, on up to num_threads threads; out may be matC, to accumulate into it.
+  // Return false if dimensions mismatch, or out is matA or matB, and leave out as it was.
+  static bool Gemm(const RowMatrix<T> &matA, const RowMatrix<T> &matB, const RowMatrix<T> &matC, RowMatrix<T> *out,
+                   size_t num_threads = 1) {
+    if (!CanMultiply(matA, matB, *out) || !SameShape(matC, *out)) {
+      return false;
+    }
+    if (&matC != out) {
+      std::copy(matC.GetData(), matC.GetData() + matC.Size(), out->GetData());
+    }
+    MultiplyAdd(matA, matB, out, num_threads);
+    return true;
+  }
+
+ private:
+  static bool SameShape(const RowMatrix<T> &mat1, const RowMatrix<T> &mat2) {
+    return mat1.rows == mat2.rows && mat1.cols == mat2.cols;
+  }
+
+  static bool CanMultiply(const RowMatrix<T> &mat1, const RowMatrix<T> &mat2, const RowMatrix<T> &out) {
+    return mat1.cols == mat2.rows && out.rows == mat1.rows && out.cols == mat2.cols && &out != &mat1 && &out != &mat2;
+  }
+
+  // Add (mat1 * mat2) to out, splitting the bands of TILE_ROWS rows of out among the threads.
+  static void MultiplyAdd(const RowMatrix<T> &mat1, const RowMatrix<T> &mat2, RowMatrix<T> *out,
+                          size_t num_threads) {
+    const int num_bands = (mat1.rows + TILE_ROWS - 1) / TILE_ROWS;
+    num_threads = std::min(num_threads, static_cast<size_t>(num_bands));
+    if (num_threads <= 1) {
+      MultiplyAddBands(mat1, mat2, out, 0, num_bands, 1);
+      return;
+    }
+    std::vector<std::thread> threads;
+    threads.reserve(num_threads - 1);
+    for (size_t t = 1; t < num_threads; t++) {
+      threads.emplace_back([&, t] { MultiplyAddBands(mat1, mat2, out, t, num_bands, num_threads); });
+    }
+    MultiplyAddBands(mat1, mat2, out, 0, num_bands, num_threads);
+    for (std::thread &thread : threads) {
+      thread.join();
+    }
+  }
 
-    return std::unique_ptr<RowMatrix<T>>(nullptr);
+  // Add (mat1 * mat2) to the bands first, first + stride, ... of out.
+  static void MultiplyAddBands(const RowMatrix<T> &mat1, const RowMatrix<T> &mat2, RowMatrix<T> *out, size_t first,
+                               int num_bands, size_t stride) {
+    const int n = mat1.cols;
+    const int m = mat2.cols;
+    const T *a = mat1.GetData();
+    const T *b = mat2.GetData();
+    T *c = out->GetData();
+    for (auto band = static_cast<int>(first); band < num_bands; band += static_cast<int>(stride)) {
+      const int row_begin = band * TILE_ROWS;
+      const int row_end = std::min(row_begin + TILE_ROWS, mat1.rows);
+      for (int col_begin = 0; col_begin < m; col_begin += TILE_COLUMNS) {
+        const int col_end = std::min(col_begin + TILE_COLUMNS, m);
+        for (int k_begin = 0; k_begin < n; k_begin += TILE_INNER) {
+          const int k_end = std::min(k_begin + TILE_INNER, n);
+          for (int i = row_begin; i < row_end; i++) {
+            T *c_row = c + static_cast<size_t>(i) * m;
+            const T *a_row = a + static_cast<size_t>(i) * n;
+            for (int k = k_begin; k < k_end; k++) {
+              const T a_ik = a_row[k];
+              const T *b_row = b + static_cast<size_t>(k) * m;
+              for (int j = col_begin; j < col_end; j++) {
+                c_row[j] += a_ik * b_row[j];
+              }
+            }
+          }
+        }
+      }
+    }
   }
 };
 }  // namespace bustub
@@ -0,0 +1,104 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// backup_manager.h
+//
+// Identification: src/include/recovery/backup_manager.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "recovery/checkpoint_manager.h"
+#include "recovery/log_manager.h"
+#include "storage/disk/disk_manager.h"
+
+namespace bustub {
+
+/** What a backup copied. */
+struct BackupStats {
+  /** The pages of the database as the backup ended its scan */
+  size_t num_pages_{0};
+  /** The pages read through the buffer pool, the others being known to be unchanged by their checksums */
+  size_t pages_read_{0};
+  /** The pages written to the backup */
+  size_t pages_copied_{0};
+  /** The bytes of the log written to the backup */
+  int64_t log_bytes_{0};
+  /** The last record of the log in the backup, which a restore recovers up to */
+  lsn_t end_lsn_{INVALID_LSN};
+};
+
+/**
+ * BackupManager takes online backups of the pages of the default tablespace while the transactions go on. A backup
+ * starts with a fuzzy checkpoint, and ships the log from its restart point on into the backup as it is flushed; it
+ * then copies the pages one at a time, each under its read latch, through a small ring of frames so that the scan does
+ * not push the working set out of the buffer pool, and flushes the log once it is done. The copies of the pages are
+ * from different moments, but each is of a moment after the restart point and before the end of the log in the
+ * backup, so the recovery of a restored backup, which reads the log from its start, brings every page to the end of
+ * it; there is no need to hold the writers off, nor to keep copies of the pages they change meanwhile.
+ *
+ * An incremental backup is taken on top of another, its base, and copies only the pages whose checksum differs from the
+ * one they had in the base: each backup keeps the checksums of all of the pages in a manifest. The pages whose checksum
+ * on disk is the one of the base are not even read, as the changes made to them since are in the log of the backup;
+ * the others are read, and copied if the checksum of what is read differs. The page LSN would not do, as the index
+ * pages have none. Restore lays a full backup and the incremental ones on top of it, in order, into a new database
+ * file, with the log of the last one, which LogRecovery then recovers as after a crash.
+ */
+class BackupManager {
+ public:
+  BackupManager(DiskManager *disk_manager, BufferPoolManager *buffer_pool_manager, LogManager *log_manager,
+                CheckpointManager *checkpoint_manager)
+      : disk_manager_(disk_manager),
+        buffer_pool_manager_(buffer_pool_manager),
+        log_manager_(log_manager),
+        checkpoint_manager_(checkpoint_manager) {}
+
+  /**
+   * Takes a backup into a directory, which is created.
+   * @param directory where the backup goes
+   * @param base the directory of the backup to take an incremental one on top of, empty for a full backup
+   * @param[out] stats what the backup copied, if not nullptr
+   * @return false if logging is off, the base cannot be read, or the backup cannot be written, as when a checkpoint
+   * recycled the log before it was shipped
+   */
+  bool Backup(const std::string &directory, const std::string &base = "", BackupStats *stats = nullptr);
+
+  /**
+   * Lays backups into a new database file, and its log, for LogRecovery to recover.
+   * @param backups the directories of a full backup and of the incremental ones taken on top of it, in order
+   * @param db_file the database file, which must not exist yet
+   * @return false if a backup cannot be read, or is not on top of the one before it
+   */
+  static bool Restore(const std::vector<std::string> &backups, const std::string &db_file);
+
+ private:
+  /** What a backup keeps of the database, to take the next one on top of it. */
+  struct Manifest {
+    /** The end of the log of the backup this one is on top of, INVALID_LSN for a full backup */
+    lsn_t base_end_lsn_{INVALID_LSN};
+    lsn_t end_lsn_{INVALID_LSN};
+    /** The checksums of the pages as they are in the backup, with the ones it is on top of, by page id */
+    std::vector<uint32_t> checksums_;
+  };
+
+  static constexpr uint32_t MANIFEST_MAGIC = 0x42414b50;
+
+  static bool ReadManifest(const std::string &directory, Manifest *manifest);
+  static bool WriteManifest(const std::string &directory, const Manifest &manifest);
+
+  DiskManager *disk_manager_;
+  BufferPoolManager *buffer_pool_manager_;
+  LogManager *log_manager_;
+  CheckpointManager *checkpoint_manager_;
+};
+
+}  // namespace bustub
@@ -19,7 +19,13 @@
 namespace bustub {
 
 /**
- * CheckpointManager creates consistent checkpoints by blocking all other transactions temporarily.
+ * CheckpointManager creates consistent checkpoints by blocking all other transactions temporarily, or fuzzy ones, as
+ * in ARIES, that block none. A fuzzy checkpoint writes a begin record, and then an end record with the active
+ * transaction table and the dirty page table, as of some moment in between, without writing back any page; the
+ * background flusher of the buffer pool writes the pages back over time, and recovery starts redo at the smallest
+ * recovery LSN in the dirty page table of the last complete checkpoint. Once the end record is on disk, the offset of
+ * the log that restart reads from, before that LSN and the first record of any transaction running, goes to the
+ * master record.
  */
 class CheckpointManager {
  public:
@@ -34,10 +40,20 @@ class CheckpointManager {
   void BeginCheckpoint();
   void EndCheckpoint();
 
+  /**
+   * Takes a fuzzy checkpoint, while the transactions go on.
+   * @return the LSN of its begin record
+   */
+  lsn_t FuzzyCheckpoint();
+
+  /** @return the end record of the last fuzzy checkpoint, whose tables it holds */
+  const LogRecord &GetLastCheckpoint() const { return last_checkpoint_; }
+
  private:
   TransactionManager *transaction_manager_ __attribute__((__unused__));
   LogManager *log_manager_ __attribute__((__unused__));
   BufferPoolManager *buffer_pool_manager_ __attribute__((__unused__));
+  LogRecord last_checkpoint_;
 };
 
 }  // namespace bustub
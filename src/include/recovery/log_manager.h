@@ -13,10 +13,19 @@
 #pragma once
 
 #include <algorithm>
+#include <atomic>
+#include <chrono>              // NOLINT
 #include <condition_variable>  // NOLINT
-#include <future>              // NOLINT
+#include <deque>
+#include <functional>
+#include <future>  // NOLINT
+#include <map>
 #include <mutex>               // NOLINT
+#include <thread>  // NOLINT
+#include <utility>
 
+#include "common/contention.h"
+#include "common/latency_histogram.h"
 #include "recovery/log_record.h"
 #include "storage/disk/disk_manager.h"
 
@@ -25,18 +34,56 @@ namespace bustub {
 /**
  * LogManager maintains a separate thread that is awakened whenever the log buffer is full or whenever a timeout
  * happens. When the thread is awakened, the log buffer's content is written into the disk log file.
+ *
+ * The appends take no latch: each reserves the LSN of its record and the bytes it takes in the log buffer with a
+ * single compare-and-swap on reserved_, which holds both, and serializes its record into them in parallel with the
+ * others; it then adds the bytes to completed_. A flush seals the buffer by setting the SEALED bit of the offset,
+ * which no reservation gets past, waits until the bytes reserved before it are completed, which makes them a
+ * contiguous prefix of the buffer, and swaps the buffers, reopening the new one before it writes the old one out. Only
+ * an append that finds the buffer full, or sealed, takes latch_, to flush or to wait for the flush going on.
+ *
+ * The commits are flushed in groups: a committing transaction wakes the flush thread and waits for the persistent lsn
+ * to reach its record, and the flush thread writes all the records appended by then with one write. It holds a flush
+ * that a commit asked for back by up to group_commit_delay_, or until the buffer is half full, so that the commits
+ * that come meanwhile join the group; the delay grows while the groups have more than one commit, and shrinks to none
+ * while they do not, so that a commit alone is not held back.
+ *
+ * With compression, a flush compresses the records it writes into a block, laid out as in log_record.h, which it
+ * writes in place of them if that is smaller; the offsets of the log are those of the blocks.
+ *
+ * The log is shipped to the sinks added to it, as to the replicas that follow it: each flush hands them the bytes it
+ * wrote, once they are on disk, in the order of the log.
  */
 class LogManager {
  public:
-  explicit LogManager(DiskManager *disk_manager)
-      : next_lsn_(0), persistent_lsn_(INVALID_LSN), disk_manager_(disk_manager) {
+  /**
+   * Takes the bytes of the log at offset as they are shipped. A stretch may end in the middle of a record, which the
+   * next one goes on with. It is called under the latch of the flushes, so it has to return quickly.
+   */
+  using LogSink = std::function<void(int64_t offset, const char *data, int size)>;
+
+  /**
+   * @param compress_log whether the flushes compress the records they write
+   */
+  explicit LogManager(DiskManager *disk_manager, bool compress_log = false)
+      : persistent_lsn_(INVALID_LSN),
+        compress_log_(compress_log),
+        buffer_offset_(disk_manager->GetLogEnd()),
+        disk_manager_(disk_manager) {
     log_buffer_ = new char[LOG_BUFFER_SIZE];
     flush_buffer_ = new char[LOG_BUFFER_SIZE];
+    if (compress_log_) {
+      block_buffers_[0] = new char[LOG_BUFFER_SIZE];
+      block_buffers_[1] = new char[LOG_BUFFER_SIZE];
+    }
   }
 
   ~LogManager() {
+    StopFlushThread();
     delete[] log_buffer_;
     delete[] flush_buffer_;
+    delete[] block_buffers_[0];
+    delete[] block_buffers_[1];
     log_buffer_ = nullptr;
     flush_buffer_ = nullptr;
   }
@@ -46,29 +93,145 @@ class LogManager {
 
   lsn_t AppendLogRecord(LogRecord *log_record);
 
-  inline lsn_t GetNextLSN() { return next_lsn_; }
+  /** Writes the records appended so far to disk, and waits until they are. */
+  void Flush();
+
+  /**
+   * Blocks until the log records up to and including lsn are on disk, waking the flush thread to write them, or
+   * writing them if it is not running; returns at once for INVALID_LSN. A transaction that committed waits here before
+   * it is acknowledged.
+   */
+  void WaitForPersistent(lsn_t lsn);
+
+  /**
+   * Has the log records up to and including lsn written to disk within delay, without waiting for them, as an
+   * asynchronous commit returns; writes them at once if the flush thread is not running.
+   */
+  void FlushWithin(lsn_t lsn, std::chrono::milliseconds delay);
+
+  /**
+   * Sets the restart point: once the checkpoint whose end record is checkpoint_lsn is on disk, writes to the master
+   * record the offset of a point of the log at or before oldest_lsn, the oldest record that restart may need.
+   */
+  void WriteRestartPoint(lsn_t checkpoint_lsn, lsn_t oldest_lsn);
+
+  /** Makes the LSNs go on from lsn, after those of the log that recovery read; before any record is appended. */
+  void SetNextLSN(lsn_t lsn);
+
+  /**
+   * Ships the log from offset on to sink: what is on disk already at once, and then what each flush writes, until the
+   * sink is removed.
+   * @return the id of the sink, or -1 if the log at offset was recycled
+   */
+  int AddLogSink(int64_t offset, LogSink sink);
+
+  /** Stops shipping the log to a sink; it is not called again once this returns. */
+  void RemoveLogSink(int sink_id);
+
+  inline lsn_t GetNextLSN() { return static_cast<lsn_t>(reserved_ >> LSN_SHIFT); }
   inline lsn_t GetPersistentLSN() { return persistent_lsn_; }
-  inline void SetPersistentLSN(lsn_t lsn) { persistent_lsn_ = lsn; }
+  inline void SetPersistentLSN(lsn_t lsn) {
+    {
+      auto lock = persistent_latch_site_->Acquire(&persistent_latch_);
+      persistent_lsn_ = lsn;
+    }
+    persistent_cv_.notify_all();
+  }
   inline char *GetLogBuffer() { return log_buffer_; }
 
- private:
-  // TODO(students): you may add your own member variables
+  /** @return the latencies of the flushes of the log buffer, from sealing it to its records being persistent */
+  LatencySnapshot GetFlushLatency() const { return flush_latency_.Snapshot(); }
+
+  /** @return how long the flush thread holds a flush back for more commits to join it now */
+  inline std::chrono::microseconds GetGroupCommitDelay() {
+    std::scoped_lock lock(latch_);
+    return group_commit_delay_;
+  }
+
+  /** The fewest bytes a flush compresses; fewer are written as they are */
+  static constexpr int MIN_COMPRESS_SIZE = 256;
+
+  /** The bounds of the delay of a group commit, past none */
+  static constexpr std::chrono::microseconds MIN_GROUP_COMMIT_DELAY{50};
+  static constexpr std::chrono::microseconds MAX_GROUP_COMMIT_DELAY{1000};
 
-  /** The atomic counter which records the next log sequence number. */
-  std::atomic<lsn_t> next_lsn_;
+ private:
+  /** The next LSN is kept in the high bits of reserved_, and the bytes of the log buffer reserved in the low ones */
+  static constexpr int LSN_SHIFT = 32;
+  static constexpr uint64_t OFFSET_MASK = (uint64_t{1} << LSN_SHIFT) - 1;
+  /** Set in the offset while the buffer is being swapped; it is larger than any buffer, so no record fits after it */
+  static constexpr uint64_t SEALED = uint64_t{1} << 31;
+
+  /** Swaps the buffers and writes the one that was filled out, under latch_. */
+  void FlushBuffer();
+
+  /** @return true once half of the log buffer is reserved */
+  bool HalfFull() const { return (reserved_ & OFFSET_MASK) >= static_cast<uint64_t>(LOG_BUFFER_SIZE / 2); }
+
+  /** Sets the delay of the next group commit from the number of commits in the last one, under latch_. */
+  void AdaptGroupCommitDelay(uint32_t group);
+
+  /**
+   * Compresses the records of the flush buffer into a block, under latch_.
+   * @return the block, or nullptr if it would not be smaller than the records
+   */
+  char *CompressBlock(uint32_t size, uint32_t *block_size);
+
+  /** Writes a record into the log buffer, in the layout described in log_record.h */
+  static void SerializeLogRecord(const LogRecord &log_record, char *data);
+
+  /** The next LSN and the bytes of the log buffer reserved so far, as described above. */
+  std::atomic<uint64_t> reserved_{0};
+  /** The bytes of the log buffer the records reserved so far were serialized into. */
+  std::atomic<uint64_t> completed_{0};
   /** The log records before and including the persistent lsn have been written to disk. */
   std::atomic<lsn_t> persistent_lsn_;
 
   char *log_buffer_;
   char *flush_buffer_;
 
-  std::mutex latch_;
-
-  std::thread *flush_thread_ __attribute__((__unused__));
+  /** The buffers the flushes compress into, in turn, as the disk manager takes no buffer twice in a row */
+  bool compress_log_;
+  char *block_buffers_[2] = {nullptr, nullptr};
+  int next_block_buffer_{0};
 
+  /** Serializes the flushes, and guards the flush thread and its requests. */
+  std::mutex latch_;
+  /** Where the waits for latch_ and persistent_latch_ are counted, of the appends, commits and flushes */
+  ContentionSite *latch_site_{ContentionProfiler::Site("log_manager.latch")};
+  ContentionSite *persistent_latch_site_{ContentionProfiler::Site("log_manager.persistent_latch")};
+
+  std::thread *flush_thread_{nullptr};
+  bool stop_flush_{false};
+  bool flush_requested_{false};
+  /** The commits that asked for a flush since the last one, and how long the next one waits for more */
+  std::atomic<uint32_t> commit_waiters_{0};
+  std::chrono::microseconds group_commit_delay_{0};
+  /** The time by which the asynchronous commits not yet on disk are to be, if there are any */
+  std::chrono::steady_clock::time_point flush_deadline_{std::chrono::steady_clock::time_point::max()};
+
+  /**
+   * The offset of the log file the log buffer starts at and the LSN of its first record, under latch_, and those of
+   * the buffers written since the oldest one a restart point may still go back to.
+   */
+  int64_t buffer_offset_;
+  lsn_t buffer_first_lsn_{0};
+  std::deque<std::pair<lsn_t, int64_t>> flushed_buffers_;
+
+  /** The sinks the log is shipped to, by id, under latch_ */
+  std::map<int, LogSink> log_sinks_;
+  int next_sink_id_{0};
+
+  LatencyHistogram flush_latency_;
+
+  /** Wakes the flush thread before its timeout. */
   std::condition_variable cv_;
 
-  DiskManager *disk_manager_ __attribute__((__unused__));
+  /** Guards the waits for the persistent lsn, apart from latch_ that a flush holds as it writes */
+  std::mutex persistent_latch_;
+  std::condition_variable persistent_cv_;
+
+  DiskManager *disk_manager_;
 };
 
 }  // namespace bustub
@@ -14,11 +14,15 @@
 
 #include <cassert>
 #include <string>
+#include <utility>
+#include <vector>
 
 #include "common/config.h"
 #include "storage/table/tuple.h"
 
 namespace bustub {
+using index_oid_t = uint32_t;
+
 /** The type of the log record. */
 enum class LogRecordType {
   INVALID = 0,
@@ -32,6 +36,18 @@ enum class LogRecordType {
   ABORT,
   /** Creating a new page in the table heap. */
   NEWPAGE,
+  /** Inserting a batch of tuples into a page. */
+  INSERTBATCH,
+  /** The start of a fuzzy checkpoint, and its end, with the tables it took. */
+  BEGINCHECKPOINT,
+  ENDCHECKPOINT,
+  /** A compensation log record, of the undo of a record of a transaction that is rolled back at restart. */
+  CLR,
+  /**
+   * Inserting an entry into an index, and deleting one, logged as the operation rather than by the pages it changes.
+   */
+  INDEXINSERT,
+  INDEXDELETE,
 };
 
 /**
@@ -49,14 +65,40 @@ enum class LogRecordType {
  *----------------------------------------------------------------
  * | HEADER | tuple_rid | tuple_size | tuple_data(char[] array) |
  *---------------------------------------------------------------
- * For update type log record
- *-----------------------------------------------------------------------------------
- * | HEADER | tuple_rid | tuple_size | old_tuple_data | tuple_size | new_tuple_data |
- *-----------------------------------------------------------------------------------
+ * For update type log record, of the byte ranges of the tuple that changed, at offsets of the old tuple
+ *-----------------------------------------------------------------------------------------------------------
+ * | HEADER | tuple_rid | delta_size | old_size | new_size | range_count | offset | old_length | new_length |
+ *-----------------------------------------------------------------------------------------------------------
+ *--------------------------------------
+ * | old_bytes | new_bytes | offset | ... |
+ *--------------------------------------
  * For new page type log record
  *--------------------------
  * | HEADER | prev_page_id |
  *--------------------------
+ * For insert batch type log record, of tuples of a single page
+ *-------------------------------------------------------------------------------
+ * | HEADER | count | tuple_rid | tuple_size | tuple_data(char[] array) | ... |
+ *-------------------------------------------------------------------------------
+ * For end checkpoint type log record, of the active transaction table and the dirty page table; a begin checkpoint
+ * record is just the header
+ *-----------------------------------------------------------------------------------------------------
+ * | HEADER | txn_count | txn_id | last_lsn | ... | page_count | page_id | rec_lsn | ... |
+ *-----------------------------------------------------------------------------------------------------
+ * For index type log record (including indexinsert, indexdelete), of the entry of the key for the RID
+ *---------------------------------------------------------------
+ * | HEADER | index_oid | rid | key_size | key_data(char[] array) |
+ *---------------------------------------------------------------
+ * For compensation type log record, followed by the body of the record it undid, laid out as above
+ *------------------------------------------------------------------
+ * | HEADER | undo_next_lsn | undone_type | body of the undone record |
+ *------------------------------------------------------------------
+ *
+ * A log manager that compresses the log writes each flush as a block in place of the records, which starts with
+ * COMPRESSED_BLOCK where a record would start with its size; the records are the raw_size bytes it decompresses to
+ *----------------------------------------------------------------------------
+ * | COMPRESSED_BLOCK | raw_size | stored_size | compressed records (stored_size) |
+ *----------------------------------------------------------------------------
  */
 class LogRecord {
   friend class LogManager;
@@ -69,33 +111,46 @@ class LogRecord {
   LogRecord(txn_id_t txn_id, lsn_t prev_lsn, LogRecordType log_record_type)
       : size_(HEADER_SIZE), txn_id_(txn_id), prev_lsn_(prev_lsn), log_record_type_(log_record_type) {}
 
-  // constructor for INSERT/DELETE type
+  // constructor for INSERT/DELETE type; the record is a view of the tuple, which has to outlive it
   LogRecord(txn_id_t txn_id, lsn_t prev_lsn, LogRecordType log_record_type, const RID &rid, const Tuple &tuple)
       : txn_id_(txn_id), prev_lsn_(prev_lsn), log_record_type_(log_record_type) {
     if (log_record_type == LogRecordType::INSERT) {
       insert_rid_ = rid;
-      insert_tuple_ = tuple;
+      insert_tuple_ = tuple.AsView();
     } else {
       assert(log_record_type == LogRecordType::APPLYDELETE || log_record_type == LogRecordType::MARKDELETE ||
              log_record_type == LogRecordType::ROLLBACKDELETE);
       delete_rid_ = rid;
-      delete_tuple_ = tuple;
+      delete_tuple_ = tuple.AsView();
     }
     // calculate log record size
     size_ = HEADER_SIZE + sizeof(RID) + sizeof(int32_t) + tuple.GetLength();
   }
 
-  // constructor for UPDATE type
+  // constructor for UPDATE type; the record holds the bytes in which the tuples differ rather than both of them
   LogRecord(txn_id_t txn_id, lsn_t prev_lsn, LogRecordType log_record_type, const RID &update_rid,
             const Tuple &old_tuple, const Tuple &new_tuple)
       : txn_id_(txn_id),
         prev_lsn_(prev_lsn),
         log_record_type_(log_record_type),
         update_rid_(update_rid),
-        old_tuple_(old_tuple),
-        new_tuple_(new_tuple) {
+        update_delta_(EncodeUpdate(old_tuple, new_tuple)) {
     // calculate log record size
-    size_ = HEADER_SIZE + sizeof(RID) + old_tuple.GetLength() + new_tuple.GetLength() + 2 * sizeof(int32_t);
+    size_ = HEADER_SIZE + sizeof(RID) + sizeof(int32_t) + update_delta_.GetLength();
+  }
+
+  // constructor for INSERTBATCH type; the record holds views of the tuples, which have to outlive it
+  LogRecord(txn_id_t txn_id, lsn_t prev_lsn, std::vector<RID> &&rids, std::vector<Tuple> &&tuples)
+      : txn_id_(txn_id),
+        prev_lsn_(prev_lsn),
+        log_record_type_(LogRecordType::INSERTBATCH),
+        insert_rids_(std::move(rids)),
+        insert_tuples_(std::move(tuples)) {
+    assert(insert_rids_.size() == insert_tuples_.size());
+    size_ = HEADER_SIZE + sizeof(uint32_t);
+    for (const Tuple &tuple : insert_tuples_) {
+      size_ += sizeof(RID) + sizeof(int32_t) + tuple.GetLength();
+    }
   }
 
   // constructor for NEWPAGE type
@@ -110,8 +165,74 @@ class LogRecord {
     size_ = HEADER_SIZE + sizeof(page_id_t) * 2;
   }
 
+  // constructor for INDEXINSERT/INDEXDELETE type; the record is a view of the key, which has to outlive it
+  LogRecord(txn_id_t txn_id, lsn_t prev_lsn, LogRecordType log_record_type, index_oid_t index_oid, const RID &rid,
+            const Tuple &key)
+      : txn_id_(txn_id),
+        prev_lsn_(prev_lsn),
+        log_record_type_(log_record_type),
+        index_oid_(index_oid),
+        index_rid_(rid),
+        index_key_(key.AsView()) {
+    assert(log_record_type == LogRecordType::INDEXINSERT || log_record_type == LogRecordType::INDEXDELETE);
+    size_ = HEADER_SIZE + sizeof(index_oid_t) + sizeof(RID) + sizeof(int32_t) + key.GetLength();
+  }
+
+  // constructor for ENDCHECKPOINT type
+  LogRecord(std::vector<std::pair<txn_id_t, lsn_t>> &&active_txns,
+            std::vector<std::pair<page_id_t, lsn_t>> &&dirty_pages)
+      : log_record_type_(LogRecordType::ENDCHECKPOINT),
+        active_txns_(std::move(active_txns)),
+        dirty_pages_(std::move(dirty_pages)) {
+    size_ = HEADER_SIZE + 2 * sizeof(uint32_t) + (sizeof(txn_id_t) + sizeof(lsn_t)) * active_txns_.size() +
+            (sizeof(page_id_t) + sizeof(lsn_t)) * dirty_pages_.size();
+  }
+
+  /**
+   * A compensation record of the undo of a record; redo repeats the undo, and undo goes on from undo_next_lsn, the
+   * record of the transaction before the undone one, so that no record is undone twice.
+   */
+  LogRecord(txn_id_t txn_id, lsn_t prev_lsn, lsn_t undo_next_lsn, const LogRecord &undone)
+      : size_(undone.size_ + sizeof(lsn_t) + sizeof(LogRecordType)),
+        txn_id_(txn_id),
+        prev_lsn_(prev_lsn),
+        log_record_type_(LogRecordType::CLR),
+        delete_rid_(undone.delete_rid_),
+        delete_tuple_(undone.delete_tuple_.AsView()),
+        insert_rid_(undone.insert_rid_),
+        insert_tuple_(undone.insert_tuple_.AsView()),
+        insert_rids_(undone.insert_rids_),
+        update_rid_(undone.update_rid_),
+        update_delta_(undone.update_delta_.AsView()),
+        index_oid_(undone.index_oid_),
+        index_rid_(undone.index_rid_),
+        index_key_(undone.index_key_.AsView()),
+        undo_next_lsn_(undo_next_lsn),
+        undone_type_(undone.log_record_type_) {
+    insert_tuples_.reserve(undone.insert_tuples_.size());
+    for (const Tuple &tuple : undone.insert_tuples_) {
+      insert_tuples_.push_back(tuple.AsView());
+    }
+  }
+
   ~LogRecord() = default;
 
+  /** @return the byte ranges in which new_tuple differs from old_tuple, as an update record logs them */
+  static Tuple EncodeUpdate(const Tuple &old_tuple, const Tuple &new_tuple);
+
+  /**
+   * Applies the byte ranges of an update to a version of the tuple: to the old one for the new one, as redo does, or
+   * the other way round, as undo does.
+   * @param delta the byte ranges, from EncodeUpdate
+   * @param from the version of the tuple the update is applied to
+   * @param undo whether from is the new version
+   * @param[out] to the other version
+   */
+  static void ApplyUpdate(const Tuple &delta, const Tuple &from, bool undo, Tuple *to);
+
+  /** The most unchanged bytes between two changed ranges that an update logs as one range, as a range header takes */
+  static constexpr uint32_t UPDATE_RANGE_GAP = 3 * sizeof(uint32_t);
+
   inline Tuple &GetDeleteTuple() { return delete_tuple_; }
 
   inline RID &GetDeleteRID() { return delete_rid_; }
@@ -120,14 +241,36 @@ class LogRecord {
 
   inline RID &GetInsertRID() { return insert_rid_; }
 
-  inline Tuple &GetOriginalTuple() { return old_tuple_; }
+  inline std::vector<Tuple> &GetInsertTuples() { return insert_tuples_; }
 
-  inline Tuple &GetUpdateTuple() { return new_tuple_; }
+  inline std::vector<RID> &GetInsertRIDs() { return insert_rids_; }
+
+  /** @return the byte ranges an update changed, in the layout described above */
+  inline Tuple &GetUpdateDelta() { return update_delta_; }
 
   inline RID &GetUpdateRID() { return update_rid_; }
 
   inline page_id_t GetNewPageRecord() { return prev_page_id_; }
 
+  /** @return the index of an index record, and its entry */
+  inline index_oid_t GetIndexOid() { return index_oid_; }
+
+  inline RID &GetIndexRID() { return index_rid_; }
+
+  inline Tuple &GetIndexKey() { return index_key_; }
+
+  /** @return the running transactions of a checkpoint, with the LSNs of their last records */
+  inline std::vector<std::pair<txn_id_t, lsn_t>> &GetActiveTransactions() { return active_txns_; }
+
+  /** @return the dirty pages of a checkpoint, with their recovery LSNs */
+  inline std::vector<std::pair<page_id_t, lsn_t>> &GetDirtyPages() { return dirty_pages_; }
+
+  /** @return the record of the transaction that undo goes on from after a compensation record */
+  inline lsn_t GetUndoNextLSN() { return undo_next_lsn_; }
+
+  /** @return the type of the record a compensation record undid */
+  inline LogRecordType GetUndoneType() { return undone_type_; }
+
   inline int32_t GetSize() { return size_; }
 
   inline lsn_t GetLSN() { return lsn_; }
@@ -168,15 +311,35 @@ class LogRecord {
   RID insert_rid_;
   Tuple insert_tuple_;
 
+  // case2b: for a batch of inserts
+  std::vector<RID> insert_rids_;
+  std::vector<Tuple> insert_tuples_;
+
   // case3: for update operation
   RID update_rid_;
-  Tuple old_tuple_;
-  Tuple new_tuple_;
+  Tuple update_delta_;
 
   // case4: for new page operation
   page_id_t prev_page_id_{INVALID_PAGE_ID};
   page_id_t page_id_{INVALID_PAGE_ID};
+
+  // case4b: for index operation
+  index_oid_t index_oid_{0};
+  RID index_rid_;
+  Tuple index_key_;
+
+  // case5: for end checkpoint
+  std::vector<std::pair<txn_id_t, lsn_t>> active_txns_;
+  std::vector<std::pair<page_id_t, lsn_t>> dirty_pages_;
+
+  lsn_t undo_next_lsn_{INVALID_LSN};
+  LogRecordType undone_type_{LogRecordType::INVALID};
   static const int HEADER_SIZE = 20;
+
+ public:
+  /** Starts a compressed block of the log, where a record starts with its size, which is never negative */
+  static constexpr int32_t COMPRESSED_BLOCK = -1;
+  static constexpr int BLOCK_HEADER_SIZE = 3 * sizeof(int32_t);
 };  // namespace bustub
 
 }  // namespace bustub
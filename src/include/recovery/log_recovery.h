@@ -13,45 +13,275 @@
 #pragma once
 
 #include <algorithm>
-#include <mutex>  // NOLINT
+#include <condition_variable>  // NOLINT
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>   // NOLINT
+#include <thread>  // NOLINT
 #include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
 
 #include "buffer/buffer_pool_manager.h"
 #include "concurrency/lock_manager.h"
+#include "concurrency/transaction.h"
+#include "recovery/log_manager.h"
 #include "recovery/log_record.h"
+#include "storage/page/table_page.h"
 
 namespace bustub {
 
+class Catalog;
+
 /**
- * Read log file from disk, redo and undo.
+ * Read log file from disk, redo and undo, as in ARIES.
+ *
+ * The analysis pass reads the log from the offset in the master record, which the last fuzzy checkpoint set before
+ * the oldest record restart may need, or from the start if there was none; it rebuilds the transactions that did not
+ * finish and the dirty page table, seeded by the tables of the checkpoint, and Redo starts at the smallest recovery
+ * LSN in it. The log is read in chunks of REDO_READ_SIZE, the next one while one is parsed, and a compressed block of
+ * it is decompressed as the scan reaches it.
+ *
+ * Redo hands the records, by the hash of the page they change, to num_workers threads; each thread applies the
+ * records of its pages in the order of their LSNs, and skips those the page already has, by the dirty page table and
+ * then by its LSN. The tuples of the records are views of the chunk they were read into, which the records keep until
+ * they are applied, rather than copies. As the records of a page all go to one thread, in the order of the log, the
+ * pages are redone in parallel without latching one another.
+ *
+ * The index records are logical, of the entries rather than of the index pages, which have no LSN. With a catalog,
+ * Redo replays the ones the analysis pass read, in the order of the log, once the pages are redone, rather than the
+ * indexes being rebuilt; an insert of an entry that is there or a delete of one that is not changes nothing, so the
+ * entries end up as the last record of each says, whatever the index held on disk. A fuzzy checkpoint writes back the
+ * index pages before it moves the restart point past their changes.
+ *
+ * Undo then rolls back the transactions that neither committed nor aborted, the latest record of any of them first.
+ * With a log manager, it logs a compensation record for each record it undoes, whose undo next LSN skips the record
+ * at the next restart, and an abort record once a transaction is rolled back, so that a crash during undo does not
+ * undo anything twice.
+ *
+ * With a lock manager, the analysis pass locks the rows each of those transactions changed, exclusively, on behalf of
+ * a Transaction of the same id, which it registers as running for the checkpoints to take; the new transactions, whose
+ * ids TransactionManager::SetNextTxnId starts past GetNextTxnId, may then begin right after Redo, while
+ * UndoInBackground rolls the losers back on a thread of its own, and let go of the rows of each as it is rolled back.
+ * The rows are locked alone, as the log does not say which table each is of, so a table lock does not wait for them.
  */
 class LogRecovery {
  public:
-  LogRecovery(DiskManager *disk_manager, BufferPoolManager *buffer_pool_manager)
-      : disk_manager_(disk_manager), buffer_pool_manager_(buffer_pool_manager), offset_(0) {
+  /**
+   * @param num_workers the threads that redo the pages, or 0 for as many as there are cores, up to MAX_REDO_WORKERS
+   * @param log_manager the log the compensation records are appended to, nullptr to write none
+   */
+  LogRecovery(DiskManager *disk_manager, BufferPoolManager *buffer_pool_manager, size_t num_workers = 0,
+              LogManager *log_manager = nullptr)
+      : disk_manager_(disk_manager),
+        buffer_pool_manager_(buffer_pool_manager),
+        log_manager_(log_manager),
+        offset_(0) {
     log_buffer_ = new char[LOG_BUFFER_SIZE];
+    num_workers_ = num_workers != 0
+                       ? num_workers
+                       : std::clamp<size_t>(std::thread::hardware_concurrency(), 1, MAX_REDO_WORKERS);
   }
 
   ~LogRecovery() {
+    WaitForUndo();
+    // the losers that were not rolled back let go of their rows all the same
+    while (!losers_.empty()) {
+      ReleaseLoser(losers_.begin()->first);
+    }
     delete[] log_buffer_;
     log_buffer_ = nullptr;
   }
 
+  /**
+   * @param catalog the catalog whose indexes the index records are replayed into and rolled back in, nullptr to
+   * skip them
+   */
+  void SetCatalog(Catalog *catalog) { catalog_ = catalog; }
+
+  /** @param lock_manager the lock manager the rows of the losers are locked in until undo, nullptr to lock none */
+  void SetLockManager(LockManager *lock_manager) { lock_manager_ = lock_manager; }
+
+  /** Runs the analysis pass, and then redoes the log from the smallest recovery LSN, and the index records. */
   void Redo();
+
+  /**
+   * Redoes the records of a stretch of the log, as a replica does with the log shipped to it: all of them, by the page
+   * LSNs alone, on the redo threads; returns once they are applied. The tuples of the records are views of data.
+   * @param[out] last_lsn the LSN of the last record redone, left as it is if there was none
+   * @return the bytes of the records redone, short of a record the end of data cuts off
+   */
+  int RedoStream(const std::shared_ptr<const char[]> &data, int size, lsn_t *last_lsn);
   void Undo();
+
+  /** Runs Undo on a thread of its own, for the new transactions to run meanwhile. */
+  void UndoInBackground();
+
+  /** Waits for the Undo UndoInBackground started, if any, to finish. */
+  void WaitForUndo();
   bool DeserializeLogRecord(const char *data, LogRecord *log_record);
 
+  /**
+   * Deserializes a log record whose tuples are views of data, which has to outlive the record.
+   * @return false at the end of the log
+   */
+  bool DeserializeLogRecordView(const char *data, LogRecord *log_record);
+
+  /** @return the dirty page table the analysis pass rebuilt, with the recovery LSNs of the pages */
+  const std::unordered_map<page_id_t, lsn_t> &GetDirtyPageTable() const { return dirty_pages_; }
+
+  /** @return the offset of the log the analysis pass read from */
+  int64_t GetRestartOffset() const { return restart_offset_; }
+
+  /** @return the id past the largest one of a transaction in the log the analysis pass read */
+  txn_id_t GetNextTxnId() const { return next_txn_id_; }
+
+  /** The bytes read from the log at a time */
+  static constexpr int REDO_READ_SIZE = 256 * PAGE_SIZE;
+
+  /** The most threads Redo uses by default */
+  static constexpr size_t MAX_REDO_WORKERS = 8;
+
+  /** The records a redo thread is handed at a time */
+  static constexpr size_t REDO_BATCH_SIZE = 256;
+
  private:
-  DiskManager *disk_manager_ __attribute__((__unused__));
-  BufferPoolManager *buffer_pool_manager_ __attribute__((__unused__));
+  /**
+   * A record for a redo thread to apply to one of its pages; a NEWPAGE record goes to the new page and the one before.
+   * It keeps the chunk of the log its tuples are views of.
+   */
+  struct RedoItem {
+    page_id_t page_id_;
+    LogRecord record_;
+    std::shared_ptr<const char[]> chunk_;
+  };
+
+  /** The records handed to a redo thread, a batch at a time */
+  struct RedoQueue {
+    std::mutex latch_;
+    std::condition_variable cv_;
+    std::deque<std::vector<RedoItem>> batches_;
+    bool done_{false};
+  };
+
+  /** A record of the log as it is read, at its offset, with the chunk its tuples are views of */
+  using LogVisitor = std::function<void(LogRecord *record, int64_t offset, const std::shared_ptr<const char[]> &chunk)>;
+
+  /** Deserializes a record, with its tuples copied or as views of data. */
+  bool Deserialize(const char *data, LogRecord *log_record, bool view);
+
+  /**
+   * Reads the chunk of the log at offset into the end of a new buffer, which leaves LOG_BUFFER_SIZE bytes before it
+   * for the start of a record the chunk before cut off.
+   * @return the buffer, nullptr past the end of the log
+   */
+  std::shared_ptr<char[]> ReadChunk(int64_t offset);
+
+  /**
+   * Visits the records from start to end of data, which is at offset of the log, those of a compressed block as views
+   * of the block they are decompressed into, and at its offset.
+   * @param[out] end_of_log set if the log ends before end
+   * @return where the first record or block end cuts off starts
+   */
+  const char *VisitRecords(const std::shared_ptr<const char[]> &data, const char *start, const char *end,
+                           int64_t offset, const LogVisitor &visit, bool *end_of_log);
+
+  /** Reads the record of an LSN the analysis pass read, from its offset, or from the block at its offset. */
+  bool ReadRecord(lsn_t lsn, LogRecord *record);
+
+  /** Reads the log from offset to its end, a chunk ahead, and visits each record in turn. */
+  void ScanLog(int64_t offset, const LogVisitor &visit);
+
+  /** Rebuilds the transactions that did not finish, the dirty page table, and the offsets of the records. */
+  void Analyze();
+
+  /** @return the rows a record changes, or whose change a compensation record reverses */
+  static std::vector<RID> RowsOf(const LogRecord &record);
+
+  /** Locks the rows of the transactions that did not finish, and registers them as running, with a lock manager. */
+  void LockLosers();
+
+  /** Lets go of the rows of a loser that was rolled back, and of its registration. */
+  void ReleaseLoser(txn_id_t txn_id);
+
+  /**
+   * @return the page a record changes, or INVALID_PAGE_ID, and for a NEWPAGE record the page before the new one, whose
+   * link to it the record sets
+   */
+  static std::pair<page_id_t, page_id_t> PagesOf(const LogRecord &record);
+
+  /**
+   * Hands the records scan visits to the redo threads by their pages, the ones the dirty page table says may not have
+   * them if by_dirty_pages, and waits until they are applied.
+   */
+  void DispatchRedo(const std::function<void(const LogVisitor &)> &scan, bool by_dirty_pages);
+
+  /** Applies the records of a queue until Redo read the whole log. */
+  void RunRedoWorker(RedoQueue *queue);
+
+  /** Applies a record to a page that does not have it yet, by the page LSN. */
+  void RedoRecord(page_id_t page_id, LogRecord *record);
+
+  /** Reverses on a page the change of a record of the given type, as undo or the redo of its compensation does. */
+  static void UndoOnPage(TablePage *table_page, LogRecordType type, LogRecord *record);
+
+  /** Applies an update to the tuple on a page from the byte ranges it logged, or reverses it. */
+  static void UpdateOnPage(TablePage *table_page, LogRecord *record, bool undo);
+
+  /** Reverses a record of a transaction that did not finish, logging its compensation if there is a log manager. */
+  void UndoRecord(LogRecord *record);
+
+  /** Logs the compensation of a record undo reverses, if there is a log manager. @return its LSN, or INVALID_LSN */
+  lsn_t LogCompensation(LogRecord *record);
+
+  /** @return true for an index record, or the compensation of one */
+  static bool IsIndexRecord(const LogRecord &record);
+
+  /** Keeps a copy of an index record to be replayed once the pages are redone. */
+  void KeepIndexRecord(const LogRecord &record);
+
+  /** Replays the index records kept, in the order of the log, and drops them. */
+  void RedoIndexRecords();
+
+  /** Inserts the entry of an index record into its index, or deletes it, as type says. */
+  void ApplyIndexRecord(LogRecordType type, LogRecord *record);
+
+  DiskManager *disk_manager_;
+  BufferPoolManager *buffer_pool_manager_;
+  LogManager *log_manager_;
+  Catalog *catalog_{nullptr};
+  LockManager *lock_manager_{nullptr};
+  size_t num_workers_;
 
   /** Maintain active transactions and its corresponding latest lsn. */
   std::unordered_map<txn_id_t, lsn_t> active_txn_;
   /** Mapping the log sequence number to log file offset for undos. */
-  std::unordered_map<lsn_t, int> lsn_mapping_;
+  std::unordered_map<lsn_t, int64_t> lsn_mapping_;
+  /** The index records read, with their keys copied, to be replayed once the pages are redone */
+  std::vector<LogRecord> index_records_;
+  /** The pages that may not have all the records of the log, with the LSN of the first one they may not have */
+  std::unordered_map<page_id_t, lsn_t> dirty_pages_;
+  /** The offset the analysis pass read the log from, and that of the smallest recovery LSN */
+  int64_t restart_offset_{0};
+  int64_t redo_offset_{0};
+  /** The LSN after the last one of the log */
+  lsn_t next_lsn_{0};
+  txn_id_t next_txn_id_{0};
+
+  /** The first record of each transaction the analysis pass read and did not see finish, and the rows it changed */
+  std::unordered_map<txn_id_t, std::pair<lsn_t, std::unordered_set<RID>>> txn_rows_;
+  /** The transactions that did not finish, holding the locks of their rows until undo rolls them back */
+  std::unordered_map<txn_id_t, std::unique_ptr<Transaction>> losers_;
+  std::thread *undo_thread_{nullptr};
 
-  int offset_ __attribute__((__unused__));
+  /** The offset of the log file the log buffer was read from */
+  int64_t offset_;
   char *log_buffer_;
+  /** The block of the log undo last read a record from, decompressed, and its offset */
+  std::vector<char> block_;
+  int64_t block_offset_{-1};
 };
 
 }  // namespace bustub
@@ -0,0 +1,122 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// log_replica.h
+//
+// Identification: src/include/recovery/log_replica.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <chrono>              // NOLINT
+#include <condition_variable>  // NOLINT
+#include <cstdint>
+#include <deque>
+#include <mutex>  // NOLINT
+#include <shared_mutex>
+#include <thread>  // NOLINT
+#include <utility>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "recovery/log_manager.h"
+#include "recovery/log_recovery.h"
+
+namespace bustub {
+
+/**
+ * A point-in-time copy of how far a replica is behind the log it follows.
+ */
+struct ReplicationStats {
+  /** The LSN of the last record the replica redid, INVALID_LSN before any */
+  lsn_t applied_lsn_{INVALID_LSN};
+  /** The offset of the log the replica received up to */
+  int64_t received_offset_{0};
+  /** The offset of the log the replica redid up to */
+  int64_t applied_offset_{0};
+  /** How long the oldest of the log received but not yet redone has waited, 0 once the replica caught up */
+  uint64_t lag_us_{0};
+
+  /** @return the bytes of the log received but not yet redone */
+  int64_t LagBytes() const { return received_offset_ - applied_offset_; }
+};
+
+/**
+ * LogReplica keeps a read-only copy of the database of a primary up to date from the log the primary ships it. The
+ * pages of the copy are in a buffer pool of its own, over a disk manager of its own; the log is redone into them as
+ * it comes, by a thread of the replica, on the redo threads of LogRecovery, by the page LSNs.
+ *
+ * Redo holds the replica latch exclusively while it applies the log that came since it last did, and the readers hold
+ * it shared, so a reader sees every page as of the same point of the log, GetStats().applied_lsn_, and no page
+ * changes under it. As the log is redone as it was written, that point may be in the middle of a transaction, whose
+ * changes so far it sees.
+ */
+class LogReplica {
+ public:
+  /**
+   * @param buffer_pool_manager the buffer pool of the copy, which the replica alone writes
+   * @param num_workers the redo threads, or 0 for as many as LogRecovery uses by default
+   */
+  explicit LogReplica(BufferPoolManager *buffer_pool_manager, size_t num_workers = 0)
+      : recovery_(nullptr, buffer_pool_manager, num_workers) {}
+
+  ~LogReplica() { Stop(); }
+
+  /**
+   * Follows the log of a primary from offset on, as of where the copy was taken.
+   * @return false if the primary recycled the log at offset, and the copy has to be taken anew
+   */
+  bool Follow(LogManager *primary, int64_t offset = 0);
+
+  /** Stops following the primary, once the log received so far is redone. */
+  void Stop();
+
+  /** Takes the log the primary shipped, and queues it to be redone. */
+  void Receive(int64_t offset, const char *data, int size);
+
+  /** @return a hold on the replica latch, under which the pages read as of the same point of the log */
+  std::shared_lock<std::shared_mutex> BeginRead() { return std::shared_lock(replica_latch_); }
+
+  /**
+   * Waits until the replica redid the log up to and including lsn, as a read that has to see a commit does.
+   * @return false if it did not within timeout
+   */
+  bool WaitForLSN(lsn_t lsn, std::chrono::milliseconds timeout);
+
+  /** @return how far the replica is behind the log it received */
+  ReplicationStats GetStats();
+
+ private:
+  /** Redoes the log as it is received, until Stop. */
+  void RunRedo();
+
+  LogRecovery recovery_;
+
+  /** Guards what follows, apart from the pages */
+  std::mutex latch_;
+  /** Wakes the redo thread as log is received, and the waits for an LSN as it is redone */
+  std::condition_variable received_cv_;
+  std::condition_variable applied_cv_;
+
+  LogManager *primary_{nullptr};
+  int sink_id_{-1};
+  std::thread *redo_thread_{nullptr};
+  bool stop_{false};
+
+  /** The log received and not yet handed to redo */
+  std::vector<char> pending_;
+  /** The offset the log received ends at, and when the stretches of it before each offset came */
+  int64_t received_offset_{0};
+  std::deque<std::pair<int64_t, std::chrono::steady_clock::time_point>> arrivals_;
+  int64_t applied_offset_{0};
+  lsn_t applied_lsn_{INVALID_LSN};
+
+  /** Held shared by the readers of the pages, and exclusively by redo */
+  std::shared_mutex replica_latch_;
+};
+
+}  // namespace bustub
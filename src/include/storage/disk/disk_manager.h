@@ -12,28 +12,131 @@
 
 #pragma once
 
+#include <array>
 #include <atomic>
 #include <fstream>
 #include <future>  // NOLINT
+#include <memory>
+#include <mutex>  // NOLINT
 #include <string>
+#include <utility>
+#include <vector>
 
 #include "common/config.h"
+#include "common/latency_histogram.h"
+#include "common/macros.h"
+#include "storage/disk/io_engine.h"
+#include "storage/disk/page_trace.h"
+#include "storage/disk/tablespace.h"
 
 namespace bustub {
 
 /**
  * DiskManager takes care of the allocation and deallocation of pages within a database. It performs the reading and
  * writing of pages to and from disk, providing a logical file layer within the context of a database management system.
+ *
+ * Pages live in tablespaces, database files that may sit on different devices and each have their own I/O queue. The
+ * database file the disk manager is created with is the default tablespace; more can be added with AddTablespace.
+ * The high TABLESPACE_ID_BITS bits of a page id name its tablespace, so the page ids of the default tablespace are
+ * the same as they were before there were tablespaces.
+ *
+ * The log is a run of segment files of LOG_SEGMENT_SIZE bytes, <db>.log.<n> holding the bytes of the log from offset
+ * n * LOG_SEGMENT_SIZE on, so that the offsets of the log go on growing while its files do not. A segment gets its
+ * blocks when it is made, without growing its size, which stays where the log ends; the segments before the master
+ * record, which restart does not read again, are emptied and renamed to be the next ones, up to MAX_SPARE_LOG_SEGMENTS
+ * of them, rather than deleted. <db>.log holds the master record and the first segment in use; the log starts anew,
+ * without segments, where it is not there.
+ *
+ * The disk manager counts the pages and bytes it reads and writes and the log bytes it writes, and keeps the latencies
+ * of them; StartPageTrace has it record every page it reads or writes, and every page the buffer pools on top of it
+ * are asked for, in a PageTrace file.
+ *
+ * A tablespace may move its cold extents out to an object store (see EnableTiering and OffloadExtent), which keeps
+ * the local files to the pages in use.
  */
 class DiskManager {
  public:
+  /** The number of high bits of a page id that name its tablespace; the sign bit stays clear. */
+  static constexpr int TABLESPACE_ID_BITS = 4;
+  /** The number of tablespaces a disk manager can have. */
+  static constexpr tablespace_id_t MAX_TABLESPACES = 1 << TABLESPACE_ID_BITS;
+  /** The segments emptied for reuse that are kept at most; the others are deleted. */
+  static constexpr int MAX_SPARE_LOG_SEGMENTS = 4;
+  /** The tablespace of the database file the disk manager was created with. */
+  static constexpr tablespace_id_t DEFAULT_TABLESPACE = 0;
+  /** The number of pages a tablespace can hold. */
+  static constexpr page_id_t MAX_PAGES_PER_TABLESPACE = page_id_t{1} << (31 - TABLESPACE_ID_BITS);
+
+  /**
+   * @param tablespace_id the tablespace
+   * @param local_page_id the id of the page within its tablespace
+   * @return the page id
+   */
+  static page_id_t MakePageId(tablespace_id_t tablespace_id, page_id_t local_page_id) {
+    return tablespace_id * MAX_PAGES_PER_TABLESPACE + local_page_id;
+  }
+
+  /** @return the tablespace the page lives in */
+  static tablespace_id_t GetTablespaceId(page_id_t page_id) { return page_id / MAX_PAGES_PER_TABLESPACE; }
+
+  /** @return the id of the page within its tablespace */
+  static page_id_t GetLocalPageId(page_id_t page_id) { return page_id % MAX_PAGES_PER_TABLESPACE; }
+
   /**
    * Creates a new disk manager that writes to the specified database file.
    * @param db_file the file name of the database file to write to
+   * @param io_engine how page reads and writes are carried out
+   * @param direct_io true to open the database file with O_DIRECT, so that pages are cached by the buffer pool only
+   * and not in the OS page cache as well
+   * @param compress_pages true to store pages compressed where that saves space; the buffer pool still sees them
+   * uncompressed
+   */
+  explicit DiskManager(const std::string &db_file, IoEngineType io_engine = IoEngineType::SYNC,
+                       bool direct_io = false, bool compress_pages = false);
+
+  ~DiskManager();
+
+  DISALLOW_COPY_AND_MOVE(DiskManager);
+
+  /**
+   * Adds a tablespace, opening its database file or creating it if it does not exist. The ids of tablespaces are not
+   * stored anywhere; a database that is opened again has to add its tablespaces with the same ids as before.
+   * @param tablespace_id the id of the new tablespace, between 1 and MAX_TABLESPACES - 1
+   * @param db_file the database file of the tablespace, e.g. on another device
+   * @param io_engine how page reads and writes of the tablespace are carried out
+   * @param direct_io true to open the database file with O_DIRECT
+   * @param compress_pages true to store pages compressed where that saves space
+   * @return false if the id is out of range or taken
    */
-  explicit DiskManager(const std::string &db_file);
+  bool AddTablespace(tablespace_id_t tablespace_id, const std::string &db_file,
+                     IoEngineType io_engine = IoEngineType::SYNC, bool direct_io = false, bool compress_pages = false);
 
-  ~DiskManager() = default;
+  /** @return true if the tablespace has been added */
+  bool HasTablespace(tablespace_id_t tablespace_id) const { return FindTablespace(tablespace_id) != nullptr; }
+
+  /**
+   * Lets the cold extents of a tablespace move out to an object store, with a local cache of the ones read back; see
+   * Tablespace::EnableTiering. Call it before the first I/O on the tablespace, and again with the same store each
+   * time the database is opened once extents are out.
+   * @param store the object store, which has to outlive the disk manager
+   * @param cache_file the cache file of the extents read back, e.g. on a local SSD
+   * @param cache_extents the extents of TieredStorage::EXTENT_PAGES pages the cache holds at most
+   * @return false if the tablespace has not been added, or has tiering enabled already
+   */
+  bool EnableTiering(tablespace_id_t tablespace_id, ObjectStore *store, const std::string &cache_file,
+                     size_t cache_extents);
+
+  /**
+   * Moves the extent a page is in out to the object store of its tablespace, e.g. as it holds historical data that
+   * is seldom read; a write of a page of it brings it back. The buffer pool API does not change: a read of a page of
+   * it gets it from the store, or from the cache of the extents read back.
+   * @param page_id a page of the extent
+   * @return false if the tablespace has no tiering, or the extent is out already, or is not all allocated yet
+   */
+  bool OffloadExtent(page_id_t page_id);
+
+  /** @return true if the page is out in the object store of its tablespace */
+  bool IsOffloaded(page_id_t page_id) const { return GetTablespace(page_id)->IsOffloaded(GetLocalPageId(page_id)); }
 
   /**
    * Shut down the disk manager and close all the file resources.
@@ -48,14 +151,91 @@ class DiskManager {
   void WritePage(page_id_t page_id, const char *page_data);
 
   /**
-   * Read a page from the database file.
+   * Read a page from the database file, verifying its checksum.
    * @param page_id id of the page
    * @param[out] page_data output buffer
    */
   void ReadPage(page_id_t page_id, char *page_data);
 
   /**
-   * Flush the entire log buffer into disk.
+   * Starts writing several pages. With an asynchronous I/O engine the writes are in flight together, and the writes
+   * to different tablespaces always are. Under O_DIRECT,
+   * page data that is not PAGE_SIZE aligned goes through a bounce buffer and the call only returns once the batch is
+   * done; buffer pool frames are aligned.
+   * @param pages each page id with its raw page data, which must stay untouched until the writes have completed
+   * @return a future that becomes ready once every write has completed, holding false if any failed
+   */
+  std::future<bool> WritePagesAsync(const std::vector<std::pair<page_id_t, const char *>> &pages);
+
+  /**
+   * Starts reading several pages. With an asynchronous I/O engine the reads are in flight together. Each page is
+   * checked against the checksum it was last written with when the future is waited for.
+   * @param pages each page id with the buffer to read it into
+   * @return a future that becomes ready once every read has completed, holding false if any failed or any page does
+   * not match its checksum
+   */
+  std::future<bool> ReadPagesAsync(const std::vector<std::pair<page_id_t, char *>> &pages);
+
+  /**
+   * Writes several pages as WritePagesAsync does, and waits for them; the wait is recorded as a write latency.
+   * @param pages each page id with its raw page data
+   * @return false if any write failed
+   */
+  bool WritePages(const std::vector<std::pair<page_id_t, const char *>> &pages);
+
+  /**
+   * Reads several pages as ReadPagesAsync does, and waits for them; the wait is recorded as a read latency.
+   * @param pages each page id with the buffer to read it into
+   * @return false if any read failed or any page does not match its checksum
+   */
+  bool ReadPages(const std::vector<std::pair<page_id_t, char *>> &pages);
+
+  /**
+   * Reads consecutive pages, which are contiguous in the file if they were allocated as one extent, with as few
+   * vectored reads as possible.
+   * @param first_page_id the first page to read
+   * @param count the number of pages to read
+   * @param buffers count buffers to read the pages into, one per page
+   * @return false if any read failed or any page does not match its checksum
+   */
+  bool ReadPages(page_id_t first_page_id, size_t count, char *const *buffers);
+
+  /**
+   * Maps the database file of the default tablespace into memory, read only, for MmapBufferPoolManager. Pages must
+   * not be written while the file is mapped; the mapping goes away with ShutDown.
+   * @return false if the file could not be mapped
+   */
+  bool MapReadOnly();
+
+  /**
+   * @param page_id id of the page
+   * @return the page in the mapping of the file, nullptr if it is not mapped, past the end of the mapping or stored
+   * compressed, in which case it has to be read with ReadPage
+   */
+  const char *GetMappedPage(page_id_t page_id);
+
+  /**
+   * Checks page data against the checksum the page was last written with, counting a failure if it does not match.
+   * @param page_id id of the page
+   * @param page_data the data of the page
+   * @return false if the checksum is known and does not match
+   */
+  bool VerifyPage(page_id_t page_id, const char *page_data);
+
+  /**
+   * @param page_id id of the page
+   * @return the checksum the page was last written with, as PageChecksums::Compute gives it, 0 if it is not known
+   */
+  uint32_t GetPageChecksum(page_id_t page_id);
+
+  /** @return the number of pages handed out in the default tablespace, i.e. its highest page id plus one */
+  page_id_t GetNumPages() const { return GetNumPages(DEFAULT_TABLESPACE); }
+
+  /** @return the number of pages handed out in the tablespace, i.e. its highest local page id plus one */
+  page_id_t GetNumPages(tablespace_id_t tablespace_id) const;
+
+  /**
+   * Flush the entire log buffer into disk, at the end of the log, going on into the next segment as one fills.
    * @param log_data raw log data
    * @param size size of log entry
    */
@@ -65,32 +245,110 @@ class DiskManager {
    * Read a log entry from the log file.
    * @param[out] log_data output buffer
    * @param size size of the log entry
-   * @param offset offset of the log entry in the file
-   * @return true if the read was successful, false otherwise
+   * @param offset offset of the log entry in the log, across its segments
+   * @return true if the read was successful, false otherwise, as past the end of the log or before the segments in use
    */
-  bool ReadLog(char *log_data, int size, int offset);
+  bool ReadLog(char *log_data, int size, int64_t offset);
+
+  /** @return the offset of the end of the log, where the next write goes */
+  int64_t GetLogEnd();
+
+  /** @return the offset of the first byte of the log still on disk */
+  int64_t GetLogStart();
 
   /**
-   * Allocate a page on disk.
+   * Writes the master record, the offset of the log that restart reads it from, which the last fuzzy checkpoint set,
+   * and recycles the segments before it.
+   */
+  void WriteMasterRecord(int64_t offset);
+
+  /** @return the offset of the log in the master record, 0 if there is none */
+  int64_t ReadMasterRecord();
+
+  /**
+   * Allocate a page on disk in the default tablespace, reusing a deallocated page if there is one.
+   * @return the id of the allocated page
+   */
+  page_id_t AllocatePage() { return AllocatePage(DEFAULT_TABLESPACE); }
+
+  /**
+   * Allocate a page on disk in the given tablespace, reusing a deallocated page of it if there is one.
+   * @param tablespace_id the tablespace, which must have been added
    * @return the id of the allocated page
    */
-  page_id_t AllocatePage();
+  page_id_t AllocatePage(tablespace_id_t tablespace_id);
+
+  /**
+   * Allocate an extent of fresh pages that are contiguous in the database file, so that reading them in order turns
+   * into large sequential reads.
+   * @param num_pages the size of the extent, a power of two no larger than FileLayout::PAGES_PER_RUN
+   * @param tablespace_id the tablespace, which must have been added
+   * @return the id of the first page of the extent; the others follow it
+   */
+  page_id_t AllocateExtent(size_t num_pages, tablespace_id_t tablespace_id = DEFAULT_TABLESPACE);
 
   /**
-   * Deallocate a page on disk.
+   * Deallocate a page on disk, so that a later AllocatePage may hand it out again.
    * @param page_id id of the page to deallocate
    */
   void DeallocatePage(page_id_t page_id);
 
+  /** @return the number of pages read that did not match their checksum, e.g. torn or corrupted ones */
+  int GetNumChecksumFailures() const;
+
+  /** @return the number of deallocated pages waiting to be reused, in all tablespaces */
+  size_t GetNumFreePages() const;
+
   /** @return the number of disk flushes */
   int GetNumFlushes() const;
 
+  /** @return the number of bytes of log written */
+  uint64_t GetNumLogBytesWritten() const { return num_log_bytes_written_; }
+
   /** @return true iff the in-memory content has not been flushed yet */
   bool GetFlushState() const;
 
   /** @return the number of disk writes */
   int GetNumWrites() const;
 
+  /** @return the number of page reads */
+  int GetNumReads() const { return num_reads_; }
+
+  /** @return the number of bytes of page data read, which compression brings below PAGE_SIZE per read */
+  uint64_t GetNumBytesRead() const;
+
+  /** @return the number of bytes of page data written, which compression brings below PAGE_SIZE per write */
+  uint64_t GetNumBytesWritten() const;
+
+  /** @return true if the database file of the default tablespace was opened with O_DIRECT */
+  bool UsesDirectIo() const;
+
+  /** @return the latencies of the page reads that were waited for, a batch of pages counting as one */
+  LatencySnapshot GetReadLatency() const { return read_latency_.Snapshot(); }
+
+  /** @return the latencies of the page writes that were waited for, a batch of pages counting as one */
+  LatencySnapshot GetWriteLatency() const { return write_latency_.Snapshot(); }
+
+  /** @return the latencies of WriteLog, from the write of a log buffer to its flush to the OS */
+  LatencySnapshot GetLogWriteLatency() const { return log_write_latency_.Snapshot(); }
+
+  /**
+   * Starts recording the page reads and writes, and the fetches TracePageAccess is told of, in a file.
+   * @param file_name the file of the trace, which is replaced if it exists
+   * @return false if a trace is running already or the file cannot be written
+   */
+  bool StartPageTrace(const std::string &file_name);
+
+  /** Stops the page trace, if one is running, writing out what it has buffered. */
+  void StopPageTrace();
+
+  /** Records an access to a page in the page trace, if one is running. */
+  void TracePageAccess(page_id_t page_id, PageAccessType type) {
+    if (PageTrace *trace = page_trace_.load(std::memory_order_acquire); trace != nullptr) {
+      trace->Record(page_id, type);
+    }
+  }
+
   /**
    * Sets the future which is used to check for non-blocking flushes.
    * @param f the non-blocking flush check
@@ -102,17 +360,52 @@ class DiskManager {
 
  private:
   int GetFileSize(const std::string &file_name);
+
+  /** @return the name of the file of a segment of the log */
+  std::string LogSegmentName(int64_t segment) const { return log_name_ + "." + std::to_string(segment); }
+
+  /** Makes log_io_ write to a segment, reusing the file of a spare one or making a new one, under log_latch_. */
+  void OpenLogSegment(int64_t segment);
+
+  /** Writes the master record and the first segment in use to log_name_, under log_latch_. */
+  void WriteLogControl();
+
+  /** @return the tablespace, nullptr if it has not been added */
+  Tablespace *FindTablespace(tablespace_id_t tablespace_id) const;
+
+  /** @return the tablespace the page lives in; throws if it has not been added */
+  Tablespace *GetTablespace(page_id_t page_id) const;
+
   // stream to write log file
   std::fstream log_io_;
+  /** Guards the segments of the log and the offsets below. */
+  std::mutex log_latch_;
+  /** The segment log_io_ writes to, the first one in use, and the last one that has a file, spare ones included */
+  int64_t log_segment_{-1};
+  int64_t first_log_segment_{0};
+  int64_t last_log_segment_{-1};
+  /** The offset of the end of the log, and the one in the master record */
+  int64_t log_end_{0};
+  int64_t master_offset_{0};
   std::string log_name_;
-  // stream to write db file
-  std::fstream db_io_;
   std::string file_name_;
-  std::atomic<page_id_t> next_page_id_;
-  int num_flushes_;
-  int num_writes_;
-  bool flush_log_;
+  // the tablespaces by id; entries are only ever set, under tablespaces_latch_, and stay until the disk manager goes
+  std::array<std::atomic<Tablespace *>, MAX_TABLESPACES> tablespaces_{};
+  std::mutex tablespaces_latch_;
+  std::atomic<int> num_flushes_;
+  std::atomic<int> num_writes_;
+  std::atomic<int> num_reads_{0};
+  std::atomic<uint64_t> num_log_bytes_written_{0};
+  std::atomic<bool> flush_log_;
+  // the running page trace, and the ones stopped, which live as long as the disk manager for the threads that may
+  // still be recording in them
+  std::atomic<PageTrace *> page_trace_{nullptr};
+  std::vector<std::unique_ptr<PageTrace>> page_traces_;
+  std::mutex page_trace_latch_;
   std::future<void> *flush_log_f_;
+  LatencyHistogram read_latency_;
+  LatencyHistogram write_latency_;
+  LatencyHistogram log_write_latency_;
 };
 
 }  // namespace bustub
@@ -0,0 +1,99 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// file_layout.h
+//
+// Identification: src/include/storage/disk/file_layout.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <sys/types.h>
+
+#include <cstdint>
+
+#include "common/config.h"
+
+namespace bustub {
+
+/**
+ * FileLayout places pages in a database file. The file is a sequence of runs of PAGES_PER_RUN pages, and every run
+ * is preceded by its header pages:
+ *
+ *  | map page | checksum pages | stored size pages | tier pages | page 0 | ... | page PAGES_PER_RUN - 1 |
+ *
+ * The map page holds one free bit per page of the run (see FreeSpaceMap), the checksum pages one CRC-32C per page
+ * (see PageChecksums), the stored size pages one byte per page, which tells how many sectors of a compressed page
+ * are in use, and the tier pages one byte per page, which tells whether the page was moved out to the object store
+ * of the tablespace (see TieredStorage). Page ids stay dense; only their offsets skip the header pages. Header pages
+ * that were never written read as zeroes, i.e. as "no page free", "no checksum known", "not compressed" and "in the
+ * file".
+ */
+class FileLayout {
+ public:
+  /** The number of pages in a run, as many as the map page of the run has bits. */
+  static constexpr size_t PAGES_PER_RUN = PAGE_SIZE * 8;
+  /** The number of checksum pages in a run header. */
+  static constexpr size_t CHECKSUM_PAGES_PER_RUN = PAGES_PER_RUN * sizeof(uint32_t) / PAGE_SIZE;
+  /** The number of stored size pages in a run header. */
+  static constexpr size_t STORED_SIZE_PAGES_PER_RUN = PAGES_PER_RUN * sizeof(uint8_t) / PAGE_SIZE;
+  /** The number of tier pages in a run header. */
+  static constexpr size_t TIER_PAGES_PER_RUN = PAGES_PER_RUN * sizeof(uint8_t) / PAGE_SIZE;
+  /** The number of header pages in front of each run. */
+  static constexpr size_t HEADER_PAGES_PER_RUN =
+      1 + CHECKSUM_PAGES_PER_RUN + STORED_SIZE_PAGES_PER_RUN + TIER_PAGES_PER_RUN;
+  /** The unit in which compressed pages take up space. */
+  static constexpr size_t SECTOR_SIZE = 512;
+
+  /** @return the offset of the given page in the database file */
+  static off_t PageOffset(page_id_t page_id) {
+    auto id = static_cast<off_t>(page_id);
+    return (id + (id / PAGES_PER_RUN + 1) * HEADER_PAGES_PER_RUN) * PAGE_SIZE;
+  }
+
+  /** @return the offset of the map page of the given run */
+  static off_t MapPageOffset(size_t run) { return static_cast<off_t>(run * RUN_SIZE) * PAGE_SIZE; }
+
+  /** @return the offset of the given checksum page, counting the checksum pages of all runs */
+  static off_t ChecksumPageOffset(size_t checksum_page) {
+    size_t run = checksum_page / CHECKSUM_PAGES_PER_RUN;
+    return static_cast<off_t>(run * RUN_SIZE + 1 + checksum_page % CHECKSUM_PAGES_PER_RUN) * PAGE_SIZE;
+  }
+
+  /** @return the offset of the given stored size page, counting the stored size pages of all runs */
+  static off_t StoredSizePageOffset(size_t size_page) {
+    size_t run = size_page / STORED_SIZE_PAGES_PER_RUN;
+    size_t index = 1 + CHECKSUM_PAGES_PER_RUN + size_page % STORED_SIZE_PAGES_PER_RUN;
+    return static_cast<off_t>(run * RUN_SIZE + index) * PAGE_SIZE;
+  }
+
+  /** @return the offset of the given tier page, counting the tier pages of all runs */
+  static off_t TierPageOffset(size_t tier_page) {
+    size_t run = tier_page / TIER_PAGES_PER_RUN;
+    size_t index = 1 + CHECKSUM_PAGES_PER_RUN + STORED_SIZE_PAGES_PER_RUN + tier_page % TIER_PAGES_PER_RUN;
+    return static_cast<off_t>(run * RUN_SIZE + index) * PAGE_SIZE;
+  }
+
+  /** @return the number of runs needed to hold the given number of pages */
+  static size_t NumRuns(page_id_t num_pages) {
+    return (static_cast<size_t>(num_pages) + PAGES_PER_RUN - 1) / PAGES_PER_RUN;
+  }
+
+  /** @return the number of pages a database file of the given size holds, not counting header pages */
+  static page_id_t NumPagesInFile(off_t file_size) {
+    auto pages = static_cast<size_t>((file_size + PAGE_SIZE - 1) / PAGE_SIZE);
+    size_t last = pages % RUN_SIZE;
+    size_t last_pages = last > HEADER_PAGES_PER_RUN ? last - HEADER_PAGES_PER_RUN : 0;
+    return static_cast<page_id_t>(pages / RUN_SIZE * PAGES_PER_RUN + last_pages);
+  }
+
+ private:
+  /** A run with its header pages. */
+  static constexpr size_t RUN_SIZE = HEADER_PAGES_PER_RUN + PAGES_PER_RUN;
+};
+
+}  // namespace bustub
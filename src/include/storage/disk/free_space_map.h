@@ -0,0 +1,125 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// free_space_map.h
+//
+// Identification: src/include/storage/disk/free_space_map.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>  // NOLINT
+#include <vector>
+
+#include "common/config.h"
+#include "storage/disk/file_layout.h"
+
+namespace bustub {
+
+/**
+ * FreeSpaceMap keeps track of the deallocated pages of a database file so that AllocatePage can hand them out again.
+ *
+ * The map is a bitmap, one bit per page, set while the page is free. It is kept in the map pages of the database
+ * file, one in front of every run of pages (see FileLayout).
+ *
+ * Pages past the highest page id handed out so far are not in the map. Allocating one of those only bumps an atomic
+ * counter, so concurrent inserts only take the latch of the map when there are free pages to reuse.
+ */
+class FreeSpaceMap {
+ public:
+  /**
+   * @param num_pages the number of pages handed out before, e.g. the number of pages in the database file; the next
+   * fresh page id
+   */
+  explicit FreeSpaceMap(page_id_t num_pages);
+
+  /**
+   * Reads a map page in as it was stored on disk; only for setting up the map.
+   * @param map_page the index of the map page
+   * @param data the contents of the map page
+   */
+  void LoadMapPage(size_t map_page, const char *data);
+
+  /** @return the number of pages handed out so far, i.e. the next fresh page id */
+  page_id_t NumPages() const { return next_page_id_.load(); }
+
+  /** @return the number of map pages that cover the pages handed out so far */
+  size_t NumMapPages() const;
+
+  /** @return a free page, the lowest one, or a fresh page id if no page is free */
+  page_id_t Allocate();
+
+  /**
+   * Hands out an extent of fresh pages, contiguous in the file. The extent starts at a multiple of its size, so that
+   * an extent of a power of two pages up to PAGES_PER_RUN never straddles the header pages of a run; the fresh pages
+   * skipped to get there are marked as free.
+   * @param num_pages the size of the extent, a power of two no larger than FileLayout::PAGES_PER_RUN
+   * @return the first page of the extent
+   */
+  page_id_t AllocateExtent(size_t num_pages);
+
+  /**
+   * Marks a page as free.
+   * @param page_id the page
+   * @return false if the page was never handed out or is free already
+   */
+  bool Deallocate(page_id_t page_id);
+
+  /** @return the number of free pages */
+  size_t NumFree() const { return num_free_.load(std::memory_order_relaxed); }
+
+  /** @return true if the map changed since it was last written out */
+  bool IsDirty() const { return flushed_version_.load() != version_.load(); }
+
+  /**
+   * Copies out the map pages that changed since they were last written.
+   * @param[out] map_pages the indexes of the changed map pages
+   * @param[out] data PAGE_SIZE bytes per changed map page
+   * @return the version of the map the copies belong to, to be passed to MarkFlushed
+   */
+  uint64_t CollectDirty(std::vector<size_t> *map_pages, std::vector<char> *data);
+
+  /**
+   * Records that the map pages collected for a version have been written.
+   * @param version what CollectDirty returned
+   */
+  void MarkFlushed(uint64_t version);
+
+  /**
+   * Records that writing the collected map pages failed, so that they are written again next time.
+   * @param map_pages the map pages CollectDirty returned
+   */
+  void MarkDirty(const std::vector<size_t> &map_pages);
+
+ private:
+  static constexpr size_t WORDS_PER_MAP_PAGE = PAGE_SIZE / sizeof(uint64_t);
+
+  /** Grows the bitmap to cover the given word. The caller holds latch_. */
+  void Cover(size_t word);
+
+  /** The next fresh page id. */
+  std::atomic<page_id_t> next_page_id_;
+  /** The number of bits set in free_bits_. Only changed under latch_. */
+  std::atomic<size_t> num_free_{0};
+  /** Bumped under latch_ on every change of the bitmap. */
+  std::atomic<uint64_t> version_{0};
+  /** The version last written to disk. */
+  std::atomic<uint64_t> flushed_version_{0};
+
+  /** Protects everything below. */
+  std::mutex latch_;
+  /** One bit per page, set while the page is free; a whole number of map pages. */
+  std::vector<uint64_t> free_bits_;
+  /** Per map page, whether it changed since it was last written. */
+  std::vector<bool> dirty_;
+  /** No word before this one has a bit set. */
+  size_t scan_from_ = 0;
+};
+
+}  // namespace bustub
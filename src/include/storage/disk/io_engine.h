@@ -0,0 +1,221 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// io_engine.h
+//
+// Identification: src/include/storage/disk/io_engine.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <sys/types.h>
+#include <sys/uio.h>
+
+#include <atomic>
+#include <condition_variable>  // NOLINT
+#include <cstdint>
+#include <deque>
+#include <future>  // NOLINT
+#include <memory>
+#include <mutex>  // NOLINT
+#include <thread>  // NOLINT
+#include <utility>
+#include <vector>
+
+#include "common/macros.h"
+
+namespace bustub {
+
+/** The ways an IoEngine can carry out its requests. */
+enum class IoEngineType {
+  /** On the submitting thread, one request after the other. */
+  SYNC,
+  /** With pread/pwrite on a pool of worker threads. */
+  THREAD_POOL,
+  /** Through an io_uring; falls back to THREAD_POOL where io_uring is not available. */
+  IO_URING
+};
+
+/** One read or write of a contiguous range of a file, from or into one buffer or, vectored, several. */
+struct IoRequest {
+  /** True for a write, false for a read. */
+  bool is_write_;
+  /** The file to read or write. */
+  int fd_;
+  /** Where in the file the range starts. */
+  off_t offset_;
+  /** The memory to read into or write from. */
+  char *data_;
+  /** The length of the range in bytes. */
+  size_t length_;
+  /** If set, keeps data_ alive until the request has completed, for buffers nobody else waits on. */
+  std::shared_ptr<char> buffer_owner_ = nullptr;
+  /** If not empty, the buffers of a vectored request in the order they cover the range; data_ is then unused. */
+  std::vector<iovec> iovecs_ = {};
+};
+
+/**
+ * IoEngine carries out batches of file reads and writes, possibly many at once. A read that runs past the end of
+ * the file zero-fills the rest of its buffer.
+ */
+class IoEngine {
+ public:
+  virtual ~IoEngine() = default;
+
+  /**
+   * Starts a batch of requests. The requests of a batch may complete in any order, so they must not overlap.
+   * @param requests the requests to carry out
+   * @return a future that becomes ready once every request has completed, holding false if any of them failed
+   */
+  virtual std::future<bool> Submit(const std::vector<IoRequest> &requests) = 0;
+
+  /**
+   * Creates an engine of the given type.
+   * @param type how the requests are carried out
+   * @param queue_depth how many requests the engine keeps in flight at most
+   * @return the engine
+   */
+  static std::unique_ptr<IoEngine> Create(IoEngineType type, size_t queue_depth);
+
+ protected:
+  /** Completion state shared by the requests of one batch. */
+  struct Batch {
+    explicit Batch(size_t size) : remaining_(size) {}
+    std::atomic<size_t> remaining_;
+    std::atomic<bool> ok_{true};
+    std::promise<bool> done_;
+  };
+
+  /**
+   * Records that one request of the batch has completed, fulfilling the batch's promise if it was the last one.
+   * @param batch the batch the request belongs to
+   * @param ok false if the request failed
+   */
+  static void Complete(Batch *batch, bool ok);
+
+  /**
+   * Carries out (the rest of) a request with blocking system calls.
+   * @param request the request
+   * @param done how many bytes of the request have been transferred already
+   * @return false if the request failed
+   */
+  static bool PerformSync(const IoRequest &request, size_t done = 0);
+};
+
+/**
+ * SyncIoEngine carries out each batch right away, on the submitting thread.
+ */
+class SyncIoEngine : public IoEngine {
+ public:
+  std::future<bool> Submit(const std::vector<IoRequest> &requests) override;
+};
+
+/**
+ * ThreadPoolIoEngine hands requests to a fixed pool of threads that do blocking pread/pwrite, so that up to one
+ * request per thread is in flight.
+ */
+class ThreadPoolIoEngine : public IoEngine {
+ public:
+  /**
+   * @param num_threads the number of worker threads
+   */
+  explicit ThreadPoolIoEngine(size_t num_threads);
+
+  ~ThreadPoolIoEngine() override;
+
+  DISALLOW_COPY_AND_MOVE(ThreadPoolIoEngine);
+
+  std::future<bool> Submit(const std::vector<IoRequest> &requests) override;
+
+ private:
+  /** Body of the worker threads. */
+  void Work();
+
+  std::vector<std::thread> workers_;
+  /** Requests not picked up by a worker yet. */
+  std::deque<std::pair<IoRequest, std::shared_ptr<Batch>>> queue_;
+  /** Cleared to stop the workers. */
+  bool running_ = true;
+  /** Protects queue_ and running_. */
+  std::mutex latch_;
+  /** Wakes workers up for new requests or to stop. */
+  std::condition_variable cv_;
+};
+
+/**
+ * IoUringIoEngine submits requests to an io_uring, up to the queue depth at a time. A reaper thread waits for the
+ * completions; requests the kernel only partly carried out are finished with blocking calls. The io_uring system
+ * calls are issued directly, so no liburing is needed.
+ */
+class IoUringIoEngine : public IoEngine {
+ public:
+  /**
+   * Sets up the io_uring. Check IsAvailable afterwards: the kernel may not support io_uring, or forbid it.
+   * @param queue_depth the number of submission queue entries
+   */
+  explicit IoUringIoEngine(size_t queue_depth);
+
+  ~IoUringIoEngine() override;
+
+  DISALLOW_COPY_AND_MOVE(IoUringIoEngine);
+
+  /** @return true if the io_uring was set up */
+  bool IsAvailable() const { return ring_fd_ >= 0; }
+
+  std::future<bool> Submit(const std::vector<IoRequest> &requests) override;
+
+ private:
+  /** A request in flight; its address is the user data of its submission queue entry. */
+  struct Operation {
+    IoRequest request_;
+    std::shared_ptr<Batch> batch_;
+  };
+
+  /**
+   * Queues an entry in the submission ring. The caller holds latch_ and has made sure there is room.
+   * @param op the request, or nullptr for the no-op that stops the reaper
+   */
+  void PushEntry(Operation *op);
+
+  /**
+   * Hands queued entries to the kernel.
+   * @param count the number of entries queued since the last call
+   */
+  void Enter(unsigned count);
+
+  /** Body of the reaper thread. */
+  void Reap();
+
+  int ring_fd_ = -1;
+  unsigned sq_entries_ = 0;
+  /** The mappings of the rings and the submission entries, with their lengths. */
+  void *sq_ring_ = nullptr;
+  size_t sq_ring_size_ = 0;
+  void *cq_ring_ = nullptr;
+  size_t cq_ring_size_ = 0;
+  void *sqes_ = nullptr;
+  size_t sqes_size_ = 0;
+  /** Pointers into the submission ring. */
+  unsigned *sq_tail_ = nullptr;
+  unsigned *sq_mask_ = nullptr;
+  unsigned *sq_array_ = nullptr;
+  /** Pointers into the completion ring. */
+  unsigned *cq_head_ = nullptr;
+  unsigned *cq_tail_ = nullptr;
+  unsigned *cq_mask_ = nullptr;
+  void *cqes_ = nullptr;
+
+  std::unique_ptr<std::thread> reaper_;
+  /** Requests submitted and not completed yet, never more than sq_entries_ so that the completion ring fits all. */
+  size_t in_flight_ = 0;
+  /** Serializes submissions, and protects in_flight_. */
+  std::mutex latch_;
+  /** Signalled whenever a request completes. */
+  std::condition_variable completed_cv_;
+};
+
+}  // namespace bustub
@@ -0,0 +1,81 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// object_store.h
+//
+// Identification: src/include/storage/disk/object_store.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "common/macros.h"
+
+namespace bustub {
+
+/**
+ * ObjectStore keeps whole objects by key, as the buckets of an S3-compatible service do: an object is put, got and
+ * deleted as a whole, and a put replaces it. A Tablespace offloads its cold extents to one (see TieredStorage).
+ */
+class ObjectStore {
+ public:
+  virtual ~ObjectStore() = default;
+
+  /**
+   * @param key the key of the object
+   * @param data the bytes of the object
+   * @param size the number of bytes
+   * @return false if the object could not be stored
+   */
+  virtual bool Put(const std::string &key, const char *data, size_t size) = 0;
+
+  /**
+   * @param key the key of the object
+   * @param[out] data the bytes of the object
+   * @return false if there is no such object, or it could not be read
+   */
+  virtual bool Get(const std::string &key, std::vector<char> *data) = 0;
+
+  /** @return false if there was no such object */
+  virtual bool Delete(const std::string &key) = 0;
+};
+
+/**
+ * DirectoryObjectStore keeps each object as a file of a directory, e.g. one that a bucket is mounted at, or a local
+ * one in tests. A put writes a file next to the object and renames it over it, so that a get never sees half of one.
+ */
+class DirectoryObjectStore : public ObjectStore {
+ public:
+  /** @param directory the directory of the objects, which has to exist */
+  explicit DirectoryObjectStore(std::string directory) : directory_(std::move(directory)) {}
+
+  DISALLOW_COPY_AND_MOVE(DirectoryObjectStore);
+
+  bool Put(const std::string &key, const char *data, size_t size) override;
+
+  bool Get(const std::string &key, std::vector<char> *data) override;
+
+  bool Delete(const std::string &key) override;
+
+  /** @return the number of Puts and Gets that succeeded */
+  uint64_t GetNumPuts() const { return num_puts_; }
+  uint64_t GetNumGets() const { return num_gets_; }
+
+ private:
+  std::string PathOf(const std::string &key) const { return directory_ + "/" + key; }
+
+  const std::string directory_;
+  std::atomic<uint64_t> num_puts_{0};
+  std::atomic<uint64_t> num_gets_{0};
+};
+
+}  // namespace bustub
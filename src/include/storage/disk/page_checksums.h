@@ -0,0 +1,32 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// page_checksums.h
+//
+// Identification: src/include/storage/disk/page_checksums.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstdint>
+
+#include "storage/disk/page_metadata.h"
+
+namespace bustub {
+
+/**
+ * PageChecksums holds the CRC-32C of every page of a database file as it was last written, so that reads can be
+ * verified without touching the disk twice. The checksums are kept in the checksum pages of the file (see
+ * FileLayout). A checksum of 0 means "unknown", e.g. a page that was never written; such pages are not verified.
+ */
+class PageChecksums : public PageMetadata<uint32_t> {
+ public:
+  /** @return the checksum of a page; never 0 */
+  static uint32_t Compute(const char *page_data);
+};
+
+}  // namespace bustub
@@ -0,0 +1,50 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// page_compressor.h
+//
+// Identification: src/include/storage/disk/page_compressor.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstddef>
+
+namespace bustub {
+
+/**
+ * PageCompressor is a byte-oriented LZ77 compressor in the style of the LZ4 block format: fast, greedy, with a single
+ * hash probe per position. It aims at the repetitive content of pages (padding, repeated column values, free space)
+ * and trades compression ratio for speed.
+ *
+ * A compressed block is a sequence of (literals, match) pairs. Each starts with a token byte whose high nibble is the
+ * number of literals and whose low nibble is the match length minus 4, a nibble of 15 meaning that bytes of up to 255
+ * follow to extend it. The literals come next, then the match as a two-byte offset back into the output. The last
+ * pair has literals only.
+ */
+class PageCompressor {
+ public:
+  /**
+   * @param src the data to compress
+   * @param src_size the size of the data
+   * @param[out] dst where the compressed data goes
+   * @param dst_capacity how many bytes dst holds
+   * @return the size of the compressed data, or 0 if it would not fit in dst_capacity
+   */
+  static size_t Compress(const char *src, size_t src_size, char *dst, size_t dst_capacity);
+
+  /**
+   * @param src the compressed data
+   * @param src_size the size of the compressed data
+   * @param[out] dst where the data goes
+   * @param dst_size the size of the data, exactly
+   * @return false if src is not a valid compressed block of dst_size bytes
+   */
+  static bool Decompress(const char *src, size_t src_size, char *dst, size_t dst_size);
+};
+
+}  // namespace bustub
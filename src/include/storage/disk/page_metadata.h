@@ -0,0 +1,94 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// page_metadata.h
+//
+// Identification: src/include/storage/disk/page_metadata.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>  // NOLINT
+#include <vector>
+
+#include "common/config.h"
+
+namespace bustub {
+
+/**
+ * PageMetadata holds one fixed-size entry per page of a database file, all of it in memory, and keeps track of which
+ * of the metadata pages it is stored in have changed. An entry of 0 means "unknown"; that is also what metadata pages
+ * that were never written read as.
+ *
+ * @tparam T the type of an entry
+ */
+template <typename T>
+class PageMetadata {
+ public:
+  /** The number of entries a metadata page holds. */
+  static constexpr size_t ENTRIES_PER_PAGE = PAGE_SIZE / sizeof(T);
+
+  /**
+   * Reads a metadata page in as it was stored on disk; only for setting up the metadata.
+   * @param metadata_page the index of the metadata page
+   * @param data the contents of the metadata page
+   */
+  void LoadMetadataPage(size_t metadata_page, const char *data);
+
+  /** @return the entry of the page, 0 if it was never set */
+  T Get(page_id_t page_id);
+
+  /**
+   * @param page_id the page
+   * @param value the new entry of the page
+   * @return the entry the page had before
+   */
+  T Set(page_id_t page_id, T value);
+
+  /** @return true if entries changed since they were last written out */
+  bool IsDirty() const { return flushed_version_.load() != version_.load(); }
+
+  /**
+   * Copies out the metadata pages that changed since they were last written.
+   * @param[out] metadata_pages the indexes of the changed metadata pages
+   * @param[out] data PAGE_SIZE bytes per changed metadata page
+   * @return the version of the metadata the copies belong to, to be passed to MarkFlushed
+   */
+  uint64_t CollectDirty(std::vector<size_t> *metadata_pages, std::vector<char> *data);
+
+  /**
+   * Records that the metadata pages collected for a version have been written.
+   * @param version what CollectDirty returned
+   */
+  void MarkFlushed(uint64_t version);
+
+  /**
+   * Records that writing the collected metadata pages failed, so that they are written again next time.
+   * @param metadata_pages the metadata pages CollectDirty returned
+   */
+  void MarkDirty(const std::vector<size_t> &metadata_pages);
+
+ private:
+  /** Grows the entries to cover the given metadata page. The caller holds latch_. */
+  void Cover(size_t metadata_page);
+
+  /** Bumped under latch_ on every change of an entry. */
+  std::atomic<uint64_t> version_{0};
+  /** The version last written to disk. */
+  std::atomic<uint64_t> flushed_version_{0};
+
+  /** Protects everything below. */
+  std::mutex latch_;
+  /** One entry per page; a whole number of metadata pages. */
+  std::vector<T> entries_;
+  /** Per metadata page, whether it changed since it was last written. */
+  std::vector<bool> dirty_;
+};
+
+}  // namespace bustub
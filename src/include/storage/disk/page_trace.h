@@ -0,0 +1,104 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// page_trace.h
+//
+// Identification: src/include/storage/disk/page_trace.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <chrono>  // NOLINT
+#include <cstdint>
+#include <fstream>
+#include <mutex>  // NOLINT
+#include <string>
+#include <vector>
+
+#include "common/config.h"
+#include "common/macros.h"
+
+namespace bustub {
+
+/** What happened to a page, as a PageTrace records it. */
+enum class PageAccessType : uint8_t {
+  /** The buffer pool was asked for the page, whether it had it or not */
+  FETCH,
+  /** The page was read from disk */
+  READ,
+  /** The page was written to disk */
+  WRITE,
+};
+
+/** One record of a page trace, as it is stored in the file. */
+struct PageAccess {
+  /** The time of the access, in nanoseconds since the trace started */
+  uint64_t timestamp_ns_;
+  page_id_t page_id_;
+  PageAccessType type_;
+  uint8_t padding_[3]{};
+};
+
+static_assert(sizeof(PageAccess) == 16, "the records of a page trace are stored as they are");
+
+/**
+ * PageTrace records the accesses to pages in a binary file, for replaying them offline against other replacement
+ * policies and prefetchers. The file is a header of MAGIC and then one PageAccess after the other, in the byte order
+ * of the machine; Load reads it back.
+ *
+ * The records are buffered under a latch and written out BUFFER_RECORDS at a time, so a trace costs the accesses a
+ * latch and a copy each while it runs, and nothing once it is closed.
+ */
+class PageTrace {
+ public:
+  /** The first bytes of a trace file, which name its format */
+  static constexpr char MAGIC[8] = {'B', 'T', 'P', 'G', 'T', 'R', 'C', '1'};
+  /** The records buffered before they are written out */
+  static constexpr size_t BUFFER_RECORDS = 4096;
+
+  /** Opens the file of the trace, replacing it if there is one; IsOpen tells whether that worked. */
+  explicit PageTrace(const std::string &file_name);
+
+  ~PageTrace() { Close(); }
+
+  DISALLOW_COPY_AND_MOVE(PageTrace);
+
+  /** @return true if the trace records what it is given */
+  bool IsOpen();
+
+  /** Records an access to a page, unless the trace is closed. */
+  void Record(page_id_t page_id, PageAccessType type);
+
+  /** Writes out the records buffered so far. */
+  void Flush();
+
+  /** Writes out the records buffered so far and closes the file; the trace records nothing after. */
+  void Close();
+
+  /** @return the number of accesses recorded */
+  uint64_t GetNumRecords();
+
+  /**
+   * Reads a trace file back.
+   * @param file_name the file a PageTrace wrote
+   * @param[out] accesses the records of the file, in the order they were recorded
+   * @return false if the file cannot be read or is not a page trace
+   */
+  static bool Load(const std::string &file_name, std::vector<PageAccess> *accesses);
+
+ private:
+  /** Writes out the buffer, under latch_ */
+  void FlushBuffer();
+
+  std::mutex latch_;
+  std::ofstream out_;
+  const std::chrono::steady_clock::time_point start_;
+  std::vector<PageAccess> buffer_;
+  uint64_t num_records_{0};
+};
+
+}  // namespace bustub
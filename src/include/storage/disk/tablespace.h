@@ -0,0 +1,222 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// tablespace.h
+//
+// Identification: src/include/storage/disk/tablespace.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <atomic>
+#include <future>  // NOLINT
+#include <memory>
+#include <mutex>  // NOLINT
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "common/config.h"
+#include "common/macros.h"
+#include "common/rwlatch.h"
+#include "storage/disk/file_layout.h"
+#include "storage/disk/free_space_map.h"
+#include "storage/disk/io_engine.h"
+#include "storage/disk/page_checksums.h"
+#include "storage/disk/page_metadata.h"
+#include "storage/disk/tiered_storage.h"
+
+namespace bustub {
+
+/**
+ * Tablespace is one database file with the pages stored in it: their free space map, checksums and compressed sizes,
+ * and an I/O engine of its own, so that files on different devices do not queue behind each other. Page ids here are
+ * local to the file; DiskManager maps global page ids to a tablespace and a local page id.
+ *
+ * With tiering enabled, the extents of the file that went cold can be moved out to an object store, which gives their
+ * space in the file back to the file system; the tier pages of the file tell which pages are out. A read of them gets
+ * them from the object store, through the cache of a TieredStorage, and a write of one brings its extent back into
+ * the file first, so that the pages written to are local again. Moving an extent out waits for the I/O on the file
+ * in flight, which is why the reads and writes of a tablespace with tiering hold tier_latch_ until they complete.
+ */
+class Tablespace {
+ public:
+  /**
+   * Opens the database file, creating it if it does not exist, and reads its header pages in.
+   * @param file_name the database file
+   * @param io_engine how page reads and writes are carried out
+   * @param direct_io true to open the file with O_DIRECT
+   * @param compress_pages true to store pages compressed where that saves space
+   */
+  Tablespace(std::string file_name, IoEngineType io_engine, bool direct_io, bool compress_pages);
+
+  ~Tablespace();
+
+  DISALLOW_COPY_AND_MOVE(Tablespace);
+
+  /** Writes out the header pages that changed and closes the file. */
+  void Close();
+
+  /** See DiskManager::WritePagesAsync. */
+  std::future<bool> WritePagesAsync(const std::vector<std::pair<page_id_t, const char *>> &pages);
+
+  /** See DiskManager::ReadPagesAsync. */
+  std::future<bool> ReadPagesAsync(const std::vector<std::pair<page_id_t, char *>> &pages);
+
+  /** See DiskManager::MapReadOnly. */
+  bool MapReadOnly();
+
+  /** See DiskManager::GetMappedPage. */
+  const char *GetMappedPage(page_id_t page_id);
+
+  /** See DiskManager::VerifyPage. */
+  bool VerifyPage(page_id_t page_id, const char *page_data);
+
+  /** See DiskManager::GetPageChecksum. */
+  uint32_t GetPageChecksum(page_id_t page_id) { return page_checksums_.Get(page_id); }
+
+  /**
+   * Enables tiering, before any I/O on the file. A file whose extents were moved out before is opened again with
+   * the same object store, as its tier pages say the pages are there.
+   * @param store the object store of the cold extents, which has to outlive the tablespace
+   * @param cache_file the cache of extents read back, on a local SSD; see TieredStorage
+   * @param cache_extents the extents the cache holds at most
+   * @return false if tiering is enabled already
+   */
+  bool EnableTiering(ObjectStore *store, const std::string &cache_file, size_t cache_extents);
+
+  /**
+   * Moves an extent out to the object store, and gives its space in the file back to the file system.
+   * @param extent the index of the extent, its first page over TieredStorage::EXTENT_PAGES
+   * @return false if tiering is not enabled, the extent is out already or not all in the file yet, or it could not
+   * be stored
+   */
+  bool OffloadExtent(size_t extent);
+
+  /** @return true if the page was moved out to the object store */
+  bool IsOffloaded(page_id_t page_id) { return tiers_.Get(page_id) != 0; }
+
+  /** @return the tiered storage, nullptr if tiering is not enabled */
+  TieredStorage *GetTieredStorage() { return tiered_.get(); }
+
+  /** @return a free page of the file, or a fresh one */
+  page_id_t AllocatePage() { return free_space_map_->Allocate(); }
+
+  /**
+   * @param num_pages the size of the extent, see FreeSpaceMap::AllocateExtent
+   * @return the first page of an extent of fresh pages that are contiguous in the file
+   */
+  page_id_t AllocateExtent(size_t num_pages) { return free_space_map_->AllocateExtent(num_pages); }
+
+  /**
+   * @param page_id the page to give back
+   * @return false if the page was never handed out or is free already
+   */
+  bool DeallocatePage(page_id_t page_id) { return free_space_map_->Deallocate(page_id); }
+
+  /** @return the number of pages handed out, i.e. the highest page id plus one */
+  page_id_t GetNumPages() const { return free_space_map_->NumPages(); }
+
+  /** @return the number of deallocated pages waiting to be reused */
+  size_t GetNumFreePages() const { return free_space_map_->NumFree(); }
+
+  /** @return the number of pages read that did not match their checksum */
+  int GetNumChecksumFailures() const { return num_checksum_failures_; }
+
+  /** @return the number of bytes of page data written */
+  uint64_t GetNumBytesWritten() const { return num_bytes_written_; }
+
+  /** @return the number of bytes of page data read */
+  uint64_t GetNumBytesRead() const { return num_bytes_read_; }
+
+  /** @return true if the file was opened with O_DIRECT */
+  bool UsesDirectIo() const { return direct_io_; }
+
+  /** @return the name of the database file */
+  const std::string &GetFileName() const { return file_name_; }
+
+ private:
+  /**
+   * Submits page reads or writes to the I/O engine, bouncing buffers O_DIRECT cannot use.
+   * @param requests the reads and writes, none longer than a page
+   * @return a future for the batch
+   */
+  std::future<bool> SubmitPages(const std::vector<IoRequest> &requests);
+
+  /**
+   * Compresses a page into the image that is stored for it: the size of the compressed data, the data and padding.
+   * @param page_data the page
+   * @param[out] image PAGE_SIZE bytes for the image
+   * @return the size of the image, a whole number of sectors, or PAGE_SIZE if the page is better stored as it is
+   */
+  size_t CompressPage(const char *page_data, char *image) const;
+
+  /**
+   * Turns a stored image back into the page, in place.
+   * @param[in,out] page_data the image as read, then the page
+   * @param stored the size of the image
+   * @return false if the image is corrupt
+   */
+  static bool DecompressPage(char *page_data, size_t stored);
+
+  /** @return the key of the object of an extent */
+  std::string ExtentKey(size_t extent) const;
+
+  /**
+   * Brings the extents that are out back into the file, under tier_latch_ held exclusively; see WritePagesAsync.
+   * @return false if one could not be got from the object store
+   */
+  bool RecallExtents(const std::vector<size_t> &extents);
+
+  /**
+   * Holds tier_latch_ shared until an I/O has completed, if tiering is enabled.
+   * @param done the future of the I/O, submitted under the latch
+   * @return a future for the I/O, which lets go of the latch as it completes, on a thread of its own
+   */
+  std::future<bool> ReleaseTierLatchAfter(std::future<bool> done);
+
+  /** Reads the free space map and the page checksums in from the header pages of the file. */
+  void LoadHeaderPages();
+
+  /**
+   * Writes out the map and checksum pages that changed. Page writes call this first, so that no page reaches the disk
+   * before its map page says it is in use and its checksum page knows its checksum.
+   */
+  void FlushHeaderPages();
+
+  std::string file_name_;
+  // descriptor of the file; pread/pwrite on it need no latch even when several buffer pool instances share it
+  int fd_ = -1;
+  // whether fd_ was opened with O_DIRECT
+  bool direct_io_ = false;
+  // whether pages are written compressed where that saves space
+  bool compress_pages_;
+  // the read-only mapping of the file, if any
+  char *mapping_ = nullptr;
+  size_t mapping_size_ = 0;
+  // carries out the page I/O on fd_
+  std::unique_ptr<IoEngine> io_engine_;
+  // which pages of the file are free; it also hands out fresh page ids
+  std::unique_ptr<FreeSpaceMap> free_space_map_;
+  // the checksums the pages of the file were last written with
+  PageChecksums page_checksums_;
+  // per page, how many sectors its compressed image takes up; 0 for pages stored as they are
+  PageMetadata<uint8_t> stored_sizes_;
+  // per page, 1 if it was moved out to the object store of the tiered storage
+  PageMetadata<uint8_t> tiers_;
+  // the object store and cache of the extents moved out, nullptr if tiering is not enabled
+  std::unique_ptr<TieredStorage> tiered_;
+  // held shared by the I/O on the file while tiering is enabled, exclusively while an extent moves out or back in
+  ReaderWriterLatch tier_latch_{"tablespace.tier_latch"};
+  // serializes writing out header pages
+  std::mutex header_pages_latch_;
+  std::atomic<int> num_checksum_failures_{0};
+  std::atomic<uint64_t> num_bytes_written_{0};
+  std::atomic<uint64_t> num_bytes_read_{0};
+};
+
+}  // namespace bustub
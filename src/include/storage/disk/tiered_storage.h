@@ -0,0 +1,118 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// tiered_storage.h
+//
+// Identification: src/include/storage/disk/tiered_storage.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <future>  // NOLINT
+#include <list>
+#include <mutex>  // NOLINT
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "common/config.h"
+#include "common/macros.h"
+#include "storage/disk/object_store.h"
+
+namespace bustub {
+
+/**
+ * TieredStorage is where a Tablespace keeps its extents that went cold: EXTENT_PAGES pages, contiguous in the file,
+ * which are moved out to an ObjectStore as one object each, and read back through a cache file on a local SSD that
+ * holds the extents read most recently. An extent is stored as the bytes of its pages in the database file, i.e. as
+ * their compressed images where they are compressed; the tablespace keeps their checksums and sizes.
+ *
+ * A read of pages of an extent that is not in the cache gets the whole object on a thread of its own and puts it in
+ * the cache, evicting the extent least recently read if the cache is full, so that the reads of the pages next to it
+ * are local. The cache file is scratch space: it is emptied when the storage is made, and removed with it.
+ */
+class TieredStorage {
+ public:
+  /** The pages of an extent; an extent starts at a page id that is a multiple of it. */
+  static constexpr size_t EXTENT_PAGES = 64;
+  /** The bytes of an extent. */
+  static constexpr size_t EXTENT_SIZE = EXTENT_PAGES * PAGE_SIZE;
+
+  /**
+   * @param store the store of the extents, which has to outlive the storage
+   * @param cache_file the cache file, which is replaced if it exists
+   * @param cache_extents the extents the cache holds at most
+   */
+  TieredStorage(ObjectStore *store, std::string cache_file, size_t cache_extents);
+
+  /** Closes and removes the cache file */
+  ~TieredStorage();
+
+  DISALLOW_COPY_AND_MOVE(TieredStorage);
+
+  /**
+   * Stores an extent in the object store.
+   * @param key the key of its object
+   * @param extent the EXTENT_SIZE bytes of the extent
+   * @return false if the store did not take it
+   */
+  bool Offload(const std::string &key, const char *extent);
+
+  /**
+   * Reads pages of an extent, from the cache, or from the object store on a thread of its own.
+   * @param key the key of the object of the extent
+   * @param pages for each page, its index in the extent and the PAGE_SIZE bytes to read it into, which have to stay
+   * valid until the future is ready
+   * @return a future for the reads, false if the extent could not be got
+   */
+  std::future<bool> ReadPages(const std::string &key, std::vector<std::pair<size_t, char *>> pages);
+
+  /**
+   * Reads a whole extent, e.g. to bring it back into the file.
+   * @param[out] extent the EXTENT_SIZE bytes of the extent
+   * @return false if the extent could not be got
+   */
+  bool ReadExtent(const std::string &key, char *extent);
+
+  /** Deletes the object of an extent and drops it from the cache, once it is back in the file. */
+  void Remove(const std::string &key);
+
+  /** @return the reads of extents found in the cache, and those that had to get the extent from the store */
+  uint64_t GetNumCacheHits() const { return num_cache_hits_; }
+  uint64_t GetNumCacheMisses() const { return num_cache_misses_; }
+
+ private:
+  /** @return true if the extent is in the cache, in which case the pages are read from it */
+  bool ReadCached(const std::string &key, const std::vector<std::pair<size_t, char *>> &pages);
+
+  /** Puts an extent into the cache, evicting the one least recently read if it is full. */
+  void AddToCache(const std::string &key, const char *extent);
+
+  /** Drops an extent from the cache, if it is there. */
+  void DropFromCache(const std::string &key);
+
+  ObjectStore *const store_;
+  const std::string cache_file_;
+  const size_t cache_extents_;
+  int cache_fd_{-1};
+
+  /** Guards the rest, and the I/O on the cache file, so that no slot is read while it is written */
+  std::mutex latch_;
+  /** The keys of the extents in the cache, the most recently read first */
+  std::list<std::string> lru_;
+  /** By key, the slot of the cache file of an extent and its place in lru_ */
+  std::unordered_map<std::string, std::pair<size_t, std::list<std::string>::iterator>> slots_;
+  /** The slots of the cache file no extent is in */
+  std::vector<size_t> free_slots_;
+  std::atomic<uint64_t> num_cache_hits_{0};
+  std::atomic<uint64_t> num_cache_misses_{0};
+};
+
+}  // namespace bustub
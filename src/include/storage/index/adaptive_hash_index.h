@@ -0,0 +1,171 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// adaptive_hash_index.h
+//
+// Identification: src/include/storage/index/adaptive_hash_index.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <vector>
+
+#include "common/config.h"
+#include "container/hash/hash_function.h"
+
+namespace bustub {
+
+/** What the adaptive hash index of a BPlusTree did, since it was enabled. */
+struct AdaptiveHashStats {
+  /** the lookups answered from an entry, without descending */
+  uint64_t hits_{0};
+  /** the lookups that descended, as the key had no entry or its entry was stale */
+  uint64_t misses_{0};
+  /** the entries made for keys that turned hot */
+  uint64_t installs_{0};
+};
+
+/**
+ * AdaptiveHashIndex remembers where in the leaves of a B+ tree the keys that are looked up often are: the leaf page,
+ * the slot of the key in it, and the version of the leaf's frame (see Page::ReadVersion) that the slot was read at.
+ * BPlusTree::GetValue checks it first, and goes straight to the leaf if the key has an entry; the leaf is used only if
+ * its version is still the one of the entry, i.e. no writer latched it since, so that the slot still holds the key.
+ *
+ * Keys turn hot on their own: every descent counts its key in a small table of counters, by hash, and a key whose
+ * counter reaches HOT_LOOKUPS gets an entry. The counters are halved every few descents, so that keys that are no
+ * longer looked up cool off again. Entries are direct mapped, by the hash of their key, so a hot key takes the entry
+ * of the one before it.
+ *
+ * An insert or remove on a leaf, and a split or redistribution of it, latch the leaf and so make its entries stale,
+ * which the version check catches. A merge deletes a leaf, which may then be reused by anything, so it invalidates
+ * every entry at once by moving the epoch on: an entry is good only for the epoch it was made in, and a lookup that
+ * sees the epoch move while it reads the leaf does not use what it read.
+ */
+template <typename KeyType, typename KeyComparator>
+class AdaptiveHashIndex {
+ public:
+  /** Where a key was found */
+  struct Location {
+    page_id_t page_id_{INVALID_PAGE_ID};
+    int slot_{0};
+    uint64_t version_{0};
+  };
+
+  /** The descents of a key, within a round of aging, that make it hot */
+  static constexpr uint8_t HOT_LOOKUPS = 4;
+
+  /**
+   * @param max_entries the keys that have entries at once, rounded up to a power of two
+   */
+  AdaptiveHashIndex(size_t max_entries, const KeyComparator &comparator) : comparator_(comparator) {
+    size_t capacity = 1;
+    while (capacity < max_entries) {
+      capacity <<= 1;
+    }
+    mask_ = capacity - 1;
+    entries_.resize(capacity);
+    counters_ = std::make_unique<std::atomic<uint8_t>[]>(capacity * COUNTERS_PER_ENTRY);
+    for (size_t i = 0; i < capacity * COUNTERS_PER_ENTRY; i++) {
+      counters_[i] = 0;
+    }
+  }
+
+  /** @return the epoch to pass to Find, and to check again once the leaf was read */
+  uint64_t GetEpoch() const { return epoch_.load(std::memory_order_acquire); }
+
+  /**
+   * @param epoch what GetEpoch returned before
+   * @return true if the key has an entry made in the epoch, which is copied to location
+   */
+  bool Find(const KeyType &key, uint64_t hash, uint64_t epoch, Location *location) {
+    const size_t index = hash & mask_;
+    const Entry &entry = entries_[index];
+    std::lock_guard<std::mutex> guard(latches_[index % NUM_LATCHES]);
+    if (entry.epoch_ != epoch + 1 || comparator_(entry.key_, key) != 0) {
+      return false;
+    }
+    *location = entry.location_;
+    return true;
+  }
+
+  /**
+   * Counts a descent to a key that was found, and makes an entry for it if it turned hot.
+   * @param epoch what GetEpoch returned before the descent started, so that a leaf merged meanwhile is not entered
+   */
+  void RecordDescent(const KeyType &key, uint64_t hash, uint64_t epoch, const Location &location) {
+    misses_.fetch_add(1, std::memory_order_relaxed);
+    if (descents_.fetch_add(1, std::memory_order_relaxed) % ((mask_ + 1) * COUNTERS_PER_ENTRY) == 0) {
+      Age();
+    }
+    std::atomic<uint8_t> &counter = counters_[hash & (((mask_ + 1) * COUNTERS_PER_ENTRY) - 1)];
+    uint8_t count = counter.load(std::memory_order_relaxed);
+    if (count < HOT_LOOKUPS - 1) {
+      counter.compare_exchange_weak(count, count + 1, std::memory_order_relaxed);
+      return;
+    }
+    const size_t index = hash & mask_;
+    Entry &entry = entries_[index];
+    std::lock_guard<std::mutex> guard(latches_[index % NUM_LATCHES]);
+    entry.key_ = key;
+    entry.location_ = location;
+    entry.epoch_ = epoch + 1;
+    installs_.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  /** Counts a lookup answered from an entry. */
+  void RecordHit() { hits_.fetch_add(1, std::memory_order_relaxed); }
+
+  /** Makes every entry stale, before a leaf of the tree is deleted. */
+  void InvalidateAll() { epoch_.fetch_add(1, std::memory_order_acq_rel); }
+
+  AdaptiveHashStats GetStats() const {
+    AdaptiveHashStats stats;
+    stats.hits_ = hits_.load(std::memory_order_relaxed);
+    stats.misses_ = misses_.load(std::memory_order_relaxed);
+    stats.installs_ = installs_.load(std::memory_order_relaxed);
+    return stats;
+  }
+
+  /** @return the hash that Find and RecordDescent take for the key */
+  static uint64_t Hash(const KeyType &key) { return HashFunction<KeyType>().GetHash(key); }
+
+ private:
+  /** The counters per entry, so that keys that map to the same entry are mostly counted apart */
+  static constexpr size_t COUNTERS_PER_ENTRY = 4;
+  static constexpr size_t NUM_LATCHES = 64;
+
+  struct Entry {
+    KeyType key_;
+    Location location_;
+    /** the epoch the entry was made in, plus one; 0 for none */
+    uint64_t epoch_{0};
+  };
+
+  /** Halves the counters; racing increments may get lost, which only delays a key turning hot */
+  void Age() {
+    for (size_t i = 0; i < (mask_ + 1) * COUNTERS_PER_ENTRY; i++) {
+      counters_[i].store(counters_[i].load(std::memory_order_relaxed) / 2, std::memory_order_relaxed);
+    }
+  }
+
+  KeyComparator comparator_;
+  size_t mask_;
+  std::vector<Entry> entries_;
+  std::mutex latches_[NUM_LATCHES];
+  std::unique_ptr<std::atomic<uint8_t>[]> counters_;
+  std::atomic<uint64_t> descents_{1};
+  std::atomic<uint64_t> epoch_{0};
+  std::atomic<uint64_t> hits_{0};
+  std::atomic<uint64_t> misses_{0};
+  std::atomic<uint64_t> installs_{0};
+};
+
+}  // namespace bustub
@@ -0,0 +1,65 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// art_index.h
+//
+// Identification: src/include/storage/index/art_index.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "container/art/adaptive_radix_tree.h"
+#include "storage/index/index.h"
+#include "storage/table/table_heap.h"
+
+namespace bustub {
+
+#define ART_INDEX_TYPE ARTIndex<KeyType, ValueType, KeyComparator>
+
+/**
+ * ARTIndex is an index backed by an AdaptiveRadixTree, for hot secondary indexes that are worth keeping in memory. It
+ * goes through no buffer pool, so nothing of it is on disk: it starts out empty and has to be built from its table
+ * again after a restart, see BuildFromTableHeap.
+ *
+ * The tree is keyed by the normalized form of the KeyType (see GenericKey::SetFromKeyNormalized), whatever the
+ * metadata asks for. The key of a non-unique index is followed by the RID of the entry, so the entries of a key sit
+ * next to each other, ordered by RID, and ScanKey finds all of them with a single prefix scan.
+ */
+template <typename KeyType, typename ValueType, typename KeyComparator>
+class ARTIndex : public Index {
+ public:
+  explicit ARTIndex(IndexMetadata *metadata);
+
+  ~ARTIndex() override = default;
+
+  void InsertEntry(const Tuple &key, RID rid, Transaction *transaction) override;
+
+  void DeleteEntry(const Tuple &key, RID rid, Transaction *transaction) override;
+
+  void ScanKey(const Tuple &key, std::vector<RID> *result, Transaction *transaction) override;
+
+  /**
+   * Inserts an entry for every tuple of a table, to build the index again after a restart.
+   * @param table_heap the table the index is on
+   * @param table_schema the schema of the tuples of the table
+   * @param transaction the transaction to scan the table in
+   */
+  void BuildFromTableHeap(TableHeap *table_heap, const Schema &table_schema, Transaction *transaction);
+
+ protected:
+  // builds the index key of an entry, with the RID appended if the index is not unique
+  std::string MakeKey(const Tuple &key, const RID &rid) const;
+
+  const bool unique_;
+  // container
+  AdaptiveRadixTree<ValueType> container_;
+};
+
+}  // namespace bustub
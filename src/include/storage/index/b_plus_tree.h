@@ -10,11 +10,17 @@
 //===----------------------------------------------------------------------===//
 #pragma once
 
+#include <atomic>
+#include <deque>
+#include <memory>
 #include <queue>
 #include <string>
+#include <utility>
 #include <vector>
 
+#include "common/rwlatch.h"
 #include "concurrency/transaction.h"
+#include "storage/index/adaptive_hash_index.h"
 #include "storage/index/index_iterator.h"
 #include "storage/page/b_plus_tree_internal_page.h"
 #include "storage/page/b_plus_tree_leaf_page.h"
@@ -28,15 +34,30 @@ namespace bustub {
  *
  * Implementation of simple b+ tree data structure where internal pages direct
  * the search and leaf pages contain actual data.
- * (1) We only support unique key
+ * (1) We only support unique key; BPlusTreeIndex appends RIDs to the keys of a
+ *     non-unique index to make them unique
  * (2) support insert & remove
  * (3) The structure should shrink and grow dynamically
  * (4) Implement index iterator for range scan
+ *
+ * Concurrent operations crab latches down the tree. Iterators hold read
+ * latches only, and point lookups take none at all: they read the pages
+ * optimistically and validate their versions (see Page::ReadVersion), and only
+ * fall back to read latches if writers keep getting in the way. Inserts and
+ * removes first descend optimistically with read latches and write latch only
+ * the leaf; when that leaf would split or fall below its min size, they start
+ * over pessimistically, write latching the path and letting go of the
+ * ancestors above the lowest node that cannot split or underflow. root_latch_
+ * guards root_page_id_: it is held shared until the root page is latched, and
+ * exclusively for as long as a pessimistic operation may still replace the
+ * root. With an adaptive hash index (see EnableAdaptiveHashIndex), lookups of
+ * hot keys go straight to the slot of their leaf instead of descending.
  */
 INDEX_TEMPLATE_ARGUMENTS
 class BPlusTree {
   using InternalPage = BPlusTreeInternalPage<KeyType, page_id_t, KeyComparator>;
   using LeafPage = BPlusTreeLeafPage<KeyType, ValueType, KeyComparator>;
+  using AdaptiveHash = AdaptiveHashIndex<KeyType, KeyComparator>;
 
  public:
   explicit BPlusTree(std::string name, BufferPoolManager *buffer_pool_manager, const KeyComparator &comparator,
@@ -45,20 +66,48 @@ class BPlusTree {
   // Returns true if this B+ tree has no keys and values.
   bool IsEmpty() const;
 
+  // Reattach this (new) B+ tree to the pages of the tree of its name, by the root page id the header page records for
+  // it, e.g. after a restart. Returns false if the header page has no record of the name.
+  bool Reopen();
+
   // Insert a key-value pair into this B+ tree.
   bool Insert(const KeyType &key, const ValueType &value, Transaction *transaction = nullptr);
 
   // Remove a key and its value from this B+ tree.
   void Remove(const KeyType &key, Transaction *transaction = nullptr);
 
+  // Make removes lazy: a leaf is merged or redistributed only once it falls below merge_threshold pairs rather than
+  // below its min size, so that most removes stay on their leaf. 0, the default, rebalances eagerly.
+  void SetLazyMergeThreshold(int merge_threshold);
+
+  // Merge or redistribute the leaves that lazy removes left below their min size, in one pass over the leaf chain.
+  // Safe to run alongside other operations, e.g. from a background thread.
+  void Compact(Transaction *transaction = nullptr);
+
+  // Keep an adaptive hash index of up to max_entries hot keys, which GetValue looks in before it descends; 0 drops it.
+  // Not safe to call while other threads use the tree.
+  void EnableAdaptiveHashIndex(size_t max_entries);
+
+  // what the adaptive hash index did, all zeros if there is none
+  AdaptiveHashStats GetAdaptiveHashStats() const;
+
   // return the value associated with a given key
   bool GetValue(const KeyType &key, std::vector<ValueType> *result, Transaction *transaction = nullptr);
 
+  // Build this (empty) B+ tree from pairs sorted by strictly increasing key, filling nodes about fill_factor full.
+  bool BulkLoad(const std::vector<std::pair<KeyType, ValueType>> &pairs, double fill_factor = 1.0,
+                Transaction *transaction = nullptr);
+
   // index iterator
   INDEXITERATOR_TYPE begin();
   INDEXITERATOR_TYPE Begin(const KeyType &key);
   INDEXITERATOR_TYPE end();
 
+  // reverse index iterator, from the last pair (or the last one up to key) towards the first
+  REVERSE_INDEXITERATOR_TYPE rbegin();
+  REVERSE_INDEXITERATOR_TYPE RBegin(const KeyType &key);
+  REVERSE_INDEXITERATOR_TYPE rend();
+
   void Print(BufferPoolManager *bpm) {
     ToString(reinterpret_cast<BPlusTreePage *>(bpm->FetchPage(root_page_id_)->GetData()), bpm);
   }
@@ -77,28 +126,106 @@ class BPlusTree {
   // read data from file and remove one by one
   void RemoveFromFile(const std::string &file_name, Transaction *transaction = nullptr);
   // expose for test purpose
+  // the leaf is returned pinned but not latched, or nullptr if the tree is empty
   Page *FindLeafPage(const KeyType &key, bool leftMost = false);
 
  private:
+  // COMPACT rebalances leaves that lazy removes (REMOVE) left below their min size
+  enum class Operation { INSERT, REMOVE, COMPACT };
+
+  // fetches a page of the tree, throwing an "out of memory" exception if every frame is pinned
+  Page *FetchTreePage(page_id_t page_id);
+
+  // the optimistic lookups GetValue tries before it falls back to read latches
+  static constexpr int MAX_OPTIMISTIC_READS = 8;
+
+  // looks a key up without latching, validating the page versions instead; false if a writer got in the way. If the
+  // key is found and location is not nullptr, where it was found is recorded there for the adaptive hash index.
+  bool TryOptimisticLookup(const KeyType &key, ValueType *value, bool *found,
+                           typename AdaptiveHash::Location *location = nullptr);
+
+  // looks a key up at the leaf slot its adaptive hash index entry points at; false if it has none, or the leaf changed
+  bool TryAdaptiveLookup(const KeyType &key, uint64_t hash, uint64_t epoch, ValueType *value);
+
+  // crabs read latches down to the leaf, which is returned pinned and read latched, or nullptr if the tree is empty
+  Page *FindLeafPageRead(const KeyType &key, bool left_most, bool right_most = false);
+
+  // for reverse iterators: finds the leaf that a key is in, and the index of the last pair before the key there
+  typename REVERSE_INDEXITERATOR_TYPE::FindPairBefore FindPairBeforeFn();
+
+  // write latches a leaf to point it back at the leaf before it
+  void LinkPrevLeaf(page_id_t leaf_page_id, page_id_t prev_page_id);
+
+  // crabs read latches down to the leaf and write latches only that, trading the leaf's read latch while its parent
+  // (or root_latch_ for a root leaf) is still held; returns nullptr if the tree is empty
+  Page *FindLeafPageOptimistic(const KeyType &key, bool *is_root);
+
+  // crabs write latches down to the leaf, called with root_latch_ held exclusively on a tree that is not empty; the
+  // latched pages are appended to latched, and ancestors are let go of as soon as a node is safe for op
+  Page *FindLeafPagePessimistic(const KeyType &key, Operation op, std::deque<Page *> *latched, bool *root_latched);
+
+  // true if op on the key cannot split or underflow the node, so its ancestors do not need to stay latched
+  bool IsSafe(BPlusTreePage *node, Operation op, const KeyType &key) const;
+
+  // the size below which op merges or redistributes a node that is not the root: the min size, except for leaves
+  // under lazy removes
+  int MinSizeFor(const BPlusTreePage *node, Operation op) const;
+
+  // unlatches and unpins the pages of a pessimistic descent, and root_latch_ if it is still held
+  void ReleaseLatched(std::deque<Page *> *latched, bool *root_latched, bool is_dirty);
+
+  // one level of a tree built by BulkLoad: the node being filled, and what the level still has to spread evenly over
+  // its remaining nodes
+  struct BulkLevel {
+    Page *page;
+    int room;
+    size_t nodes_left;
+    size_t entries_left;
+  };
+
+  // how many nodes of the given min and max size to spread count entries over, filling them about fill_factor full
+  static size_t BulkNumNodes(size_t count, double fill_factor, int min_size, int max_size);
+
+  // finishes the node being filled on a level and starts its next one, appending it to its parent, which is started as
+  // well if the current one is full
+  void BulkStartNode(std::vector<BulkLevel> *levels, size_t level, const KeyType &first_key,
+                     BufferAccessStrategy *strategy);
+
   void StartNewTree(const KeyType &key, const ValueType &value);
 
+  // the right-most leaf, write latched, if key belongs into it; nullptr if it does not or there is none
+  Page *FindRightmostLeafPage(const KeyType &key);
+
+  // inserts into a write latched leaf found without the pessimistic descent, unless that would split it, and lets go
+  // of the leaf; returns false, leaving result alone, if the leaf would have to be split
+  bool InsertIfSafe(Page *page, const KeyType &key, const ValueType &value, bool *result);
+
+  // the pessimistic insert, for when the optimistic one finds the leaf full
   bool InsertIntoLeaf(const KeyType &key, const ValueType &value, Transaction *transaction = nullptr);
 
+  // the pessimistic remove, for when the optimistic one would leave the leaf below its min size
+  void RemoveFromLeaf(const KeyType &key, Transaction *transaction = nullptr);
+
+  // merges or redistributes the leaf at the end of a pessimistic descent for op, and the ancestors that underflow in
+  // turn, then lets go of the descent's latches
+  void RebalanceLatched(Operation op, std::deque<Page *> *latched, bool *root_latched);
+
+  // append is passed on from Split, and makes the parent split unevenly too if new_node is its last child
   void InsertIntoParent(BPlusTreePage *old_node, const KeyType &key, BPlusTreePage *new_node,
-                        Transaction *transaction = nullptr);
+                        Transaction *transaction = nullptr, bool append = false);
 
+  // with append set, the node is split for an append at its end, and keeps most of its entries
   template <typename N>
-  N *Split(N *node);
+  N *Split(N *node, bool append = false);
 
   template <typename N>
-  bool CoalesceOrRedistribute(N *node, Transaction *transaction = nullptr);
+  bool CoalesceOrRedistribute(Page *node_page, Operation op, std::vector<page_id_t> *deleted_pages);
 
   template <typename N>
-  bool Coalesce(N **neighbor_node, N **node, BPlusTreeInternalPage<KeyType, page_id_t, KeyComparator> **parent,
-                int index, Transaction *transaction = nullptr);
+  void Coalesce(N *neighbor_node, N *node, InternalPage *parent, int index, std::vector<page_id_t> *deleted_pages);
 
   template <typename N>
-  void Redistribute(N *neighbor_node, N *node, int index);
+  void Redistribute(N *neighbor_node, N *node, InternalPage *parent, int index);
 
   bool AdjustRoot(BPlusTreePage *node);
 
@@ -111,11 +238,19 @@ class BPlusTree {
 
   // member variable
   std::string index_name_;
-  page_id_t root_page_id_;
+  std::atomic<page_id_t> root_page_id_;
   BufferPoolManager *buffer_pool_manager_;
   KeyComparator comparator_;
   int leaf_max_size_;
   int internal_max_size_;
+  // see SetLazyMergeThreshold
+  std::atomic<int> leaf_merge_threshold_{0};
+  // The right-most leaf, where ascending inserts go without descending from the root. It only changes while that leaf
+  // is write latched, so it is still the right-most one if the cache still points at it once it is latched.
+  std::atomic<page_id_t> rightmost_leaf_page_id_{INVALID_PAGE_ID};
+  // see EnableAdaptiveHashIndex; nullptr if there is none
+  std::unique_ptr<AdaptiveHash> adaptive_hash_;
+  ReaderWriterLatch root_latch_{"b_plus_tree.root_latch"};
 };
 
 }  // namespace bustub
@@ -11,39 +11,217 @@
 
 #pragma once
 
+#include <atomic>
 #include <map>
 #include <string>
+#include <utility>
 #include <vector>
 
+#include "common/rwlatch.h"
 #include "storage/index/b_plus_tree.h"
 #include "storage/index/index.h"
 
 namespace bustub {
 
+class LockManager;
+
 #define BPLUSTREE_INDEX_TYPE BPlusTreeIndex<KeyType, ValueType, KeyComparator>
 
+/**
+ * Index over a B+ tree. The tree only holds unique keys, so a non-unique index (see IndexMetadata::IsUnique) makes
+ * its keys unique by appending the RID of each entry to them, which needs sizeof(RID) bytes of the KeyType beyond the
+ * key tuple. The entries of a key then sit next to each other in the tree, ordered by RID, and ScanKey finds all of
+ * them with a single descent.
+ *
+ * An index that has a lock manager (see SetLockManager) locks key ranges for SERIALIZABLE transactions, by next-key
+ * locking: the lock of an entry covers the gap from the entry before it as well, and the end of the index covers the
+ * gap after the last entry. A scan locks every entry it reads shared, and the first one past its range, so that the
+ * gaps of its range stay locked until it commits. An insert locks its entry exclusive, and then the entry after it for
+ * an instant, which waits for any scan whose range it inserts into. A delete locks both its entry and the one after it
+ * exclusive until it commits, as the entry after it covers the deleted one's gap from then on. The leaf a scan is on
+ * stays latched only if the lock is granted at once; otherwise the scan lets go of it to wait, and looks its position
+ * up again after.
+ *
+ * An index with a delta (see EnableDelta) is write-optimized: inserts and deletes go into an in-memory delta, sorted by
+ * key, rather than into the tree, and the delta is merged into the tree in key order once it is full, so that the
+ * writes to a leaf come together rather than each reading and writing a leaf of its own. ScanKey looks in both. A scan
+ * that begins an iterator merges the delta first, and so do the writes of transactions that lock key ranges, which go
+ * to the tree itself. A thread that holds an iterator of the index must not begin another while the delta has entries,
+ * as the merge may wait for the leaf it holds.
+ */
 INDEX_TEMPLATE_ARGUMENTS
 class BPlusTreeIndex : public Index {
  public:
   BPlusTreeIndex(IndexMetadata *metadata, BufferPoolManager *buffer_pool_manager);
 
+  /** Merges the delta, if there is one. */
+  ~BPlusTreeIndex() override;
+
   void InsertEntry(const Tuple &key, RID rid, Transaction *transaction) override;
 
   void DeleteEntry(const Tuple &key, RID rid, Transaction *transaction) override;
 
   void ScanKey(const Tuple &key, std::vector<RID> *result, Transaction *transaction) override;
 
+  /**
+   * Looks the keys up in key order rather than the order they are given in: from the leaf the last lookup ended on if
+   * the next key is in it as well, and from the root only when it is not, so that a batch of keys costs about a
+   * descent per leaf they are in rather than one per key.
+   */
+  void ScanKeys(const std::vector<Tuple> &keys, std::vector<std::vector<RID>> *results,
+                Transaction *transaction) override;
+
+  bool IsOrdered() const override { return true; }
+
+  /**
+   * Builds the (empty) index from many entries at once, see BPlusTree::BulkLoad; for building the index over a
+   * populated table. Entries that are not sorted by key yet are sorted here first.
+   * @return false if the index is not empty or two entries have the same key (the same key and RID if the index is
+   * not unique)
+   */
+  bool BulkLoadEntries(const std::vector<std::pair<Tuple, RID>> &entries, double fill_factor, Transaction *transaction);
+
+  /**
+   * Builds the index with BulkLoadEntries if it is empty and the transaction locks no key ranges, and inserts the
+   * entries one by one in key order if not, so that each insert descends to the leaf of the one before it or the next.
+   */
+  void InsertEntries(const std::vector<std::pair<Tuple, RID>> &entries, Transaction *transaction) override;
+
+  /** Deletes the entries one by one in key order, as InsertEntries inserts them. */
+  void DeleteEntries(const std::vector<std::pair<Tuple, RID>> &entries, Transaction *transaction) override;
+
+  /**
+   * Makes inserts and deletes go into a delta in memory, which is merged into the tree once it holds max_entries
+   * entries; 0 merges the delta and writes to the tree again.
+   */
+  void EnableDelta(size_t max_entries);
+
+  /** Applies the writes of the delta to the tree, in key order, and empties it. */
+  void MergeDelta();
+
+  /** @return the entries of the delta, each the last write of its key */
+  size_t GetDeltaSize();
+
+  /** Makes unique point lookups look in an adaptive hash index of hot keys first, see BPlusTree. */
+  void EnableAdaptiveHashIndex(size_t max_entries) { container_.EnableAdaptiveHashIndex(max_entries); }
+
+  AdaptiveHashStats GetAdaptiveHashStats() const { return container_.GetAdaptiveHashStats(); }
+
+  /**
+   * Reattaches the (new) index to the tree it was built as before, see BPlusTree::Reopen.
+   * @return false if the header page has no record of the index
+   */
+  bool Reopen() { return container_.Reopen(); }
+
+  /**
+   * Makes the index lock the key ranges that SERIALIZABLE transactions read and write, under the oid of the index.
+   * Entries inserted before take no locks, as the ones of CreateIndex.
+   */
+  void SetLockManager(LockManager *lock_manager, index_oid_t index_oid) {
+    lock_manager_ = lock_manager;
+    index_oid_ = index_oid;
+  }
+
+  /**
+   * Locks the entry an iterator is on shared, and with it the gap of keys before it, or the end of the index if the
+   * iterator is at the end, if the transaction locks key ranges. A scan calls this for each position it reaches,
+   * before it reads the entry there. If the lock has to be waited for, the iterator lets go of its leaf meanwhile, and
+   * is moved to the first entry after the key the scan came from, or at it if inclusive, which is locked in turn.
+   * @param from the key the scan came from, nullptr if it started at the beginning of the index
+   * @throw TransactionAbortException if the transaction was aborted as it waited
+   */
+  void LockScanPosition(INDEXITERATOR_TYPE *iterator, const KeyType *from, bool inclusive, Transaction *transaction);
+
   INDEXITERATOR_TYPE GetBeginIterator();
 
+  // the iterator a scan that let go of its leaf goes on with: at the first entry after from, or at it if inclusive,
+  // or at the beginning of the index if from is nullptr
+  INDEXITERATOR_TYPE GetResumeIterator(const KeyType *from, bool inclusive);
+
+  // for a non-unique index, the RID suffix of key is compared as well, see MakeKey
   INDEXITERATOR_TYPE GetBeginIterator(const KeyType &key);
 
   INDEXITERATOR_TYPE GetEndIterator();
 
+  // the key of the tree that the entries of a key tuple start at, to begin an iterator at
+  KeyType MakeSearchKey(const Tuple &key) const;
+
+  // compares the key columns of two keys of the tree, whatever RIDs they carry
+  int CompareKeyColumns(const KeyType &lhs, const KeyType &rhs) const { return comparator_.CompareColumns(lhs, rhs); }
+
  protected:
-  // comparator for key
+  // the last write of a key in the delta: a delete of the entry of the tree, an insert, or a delete and an insert
+  struct DeltaEntry {
+    bool remove_;
+    bool insert_;
+    RID rid_;
+  };
+
+  struct KeyLess {
+    const KeyComparator *comparator_;
+    bool operator()(const KeyType &lhs, const KeyType &rhs) const { return (*comparator_)(lhs, rhs) < 0; }
+  };
+
+  // true if the writes of the transaction go into the delta
+  bool WritesToDelta(Transaction *transaction) const { return max_delta_entries_ > 0 && !LocksKeyRanges(transaction); }
+
+  // writes an entry into the delta, merging it if it is full then
+  void WriteDelta(const KeyType &index_key, RID rid, bool insert);
+
+  // MergeDelta, with the latch of the delta held
+  void MergeDeltaLocked();
+
+  // ScanKey, of the entries of the tree and of the delta together
+  void ScanKeyWithDelta(const Tuple &key, std::vector<RID> *result);
+
+  // builds the index key of an entry, with the RID appended if the index is not unique
+  KeyType MakeKey(const Tuple &key, const RID &rid) const;
+
+  // the index keys of entries, sorted, each with the RID of its entry
+  std::vector<std::pair<KeyType, RID>> SortedKeys(const std::vector<std::pair<Tuple, RID>> &entries) const;
+
+  // sorts pairs by their first, an index key, keeping pairs of equal keys in order: by the prefixes of the keys, see
+  // GenericComparator::Prefix, with a radix sort, then by the comparator where prefixes tie; or by the comparator
+  // alone if a key has no prefix
+  template <typename Pair>
+  void SortByKey(std::vector<Pair> *pairs) const;
+
+  // InsertEntry and DeleteEntry, of an index key already built
+  void InsertKey(const KeyType &index_key, RID rid, Transaction *transaction);
+  void DeleteKey(const KeyType &index_key, Transaction *transaction);
+
+  // true if the transaction locks the key ranges it reads and writes, see SetLockManager
+  bool LocksKeyRanges(Transaction *transaction) const {
+    return lock_manager_ != nullptr && transaction != nullptr &&
+           transaction->GetIsolationLevel() == IsolationLevel::SERIALIZABLE &&
+           transaction->GetState() == TransactionState::GROWING;
+  }
+
+  // the RID the key range that ends at an entry is locked under, the end of the index's if the entry is nullptr
+  RID KeyRangeRid(const KeyType *key) const;
+
+  // the entry after a key, nullptr if the key is the last; the leaf is let go of before it returns
+  const KeyType *NextKey(const KeyType &key, KeyType *next);
+
+  // locks the key range that ends at an entry exclusive, throwing if the transaction is aborted
+  void LockForWrite(const KeyType *key, bool instant, Transaction *transaction);
+
+  // locks the key range that ends at the entry after a key exclusive, as it is once the lock is granted
+  void LockNextKey(const KeyType &key, bool instant, Transaction *transaction);
+
+  const bool unique_;
+  // comparator for key, comparing the RID suffixes as well if the index is not unique
   KeyComparator comparator_;
   // container
   BPlusTree<KeyType, ValueType, KeyComparator> container_;
+  // the lock manager key ranges are locked with, nullptr if they are not
+  LockManager *lock_manager_{nullptr};
+  index_oid_t index_oid_{0};
+  // the writes not merged into the tree yet, in key order; under delta_latch_
+  std::map<KeyType, DeltaEntry, KeyLess> delta_;
+  // the entries the delta is merged at, 0 if the index has no delta; read without the latch
+  std::atomic<size_t> max_delta_entries_{0};
+  ReaderWriterLatch delta_latch_{"b_plus_tree_index.delta_latch"};
 };
 
 }  // namespace bustub
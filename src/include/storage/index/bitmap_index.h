@@ -0,0 +1,73 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// bitmap_index.h
+//
+// Identification: src/include/storage/index/bitmap_index.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "container/bitmap/roaring_bitmap.h"
+#include "storage/index/index.h"
+
+namespace bustub {
+
+/**
+ * BitmapIndex keeps a RoaringBitmap of the RIDs of the rows of each distinct key, for columns of few distinct values
+ * (a region, a status, a flag) whose keys a B+ tree would repeat for every row. The bitmaps of the keys of several
+ * conditions are unioned and intersected before any row is read (see BitmapScanExecutor), and the RIDs that are left
+ * come out of the bitmap in page order, so the rows of a page are read one after the other.
+ *
+ * A RID is the bitmap value (page id << 32 | slot), see ToBitmapValue. The keys are the bytes of the key tuples, so a
+ * key to look up has to be a tuple of the key schema, of values of the types of its columns. Like ARTIndex, the index
+ * goes through no buffer pool: it is in memory only, and is built from its table again after a restart.
+ */
+class BitmapIndex : public Index {
+ public:
+  explicit BitmapIndex(IndexMetadata *metadata) : Index(metadata) {}
+
+  ~BitmapIndex() override = default;
+
+  void InsertEntry(const Tuple &key, RID rid, Transaction *transaction) override;
+
+  void DeleteEntry(const Tuple &key, RID rid, Transaction *transaction) override;
+
+  void ScanKey(const Tuple &key, std::vector<RID> *result, Transaction *transaction) override;
+
+  /** @return the RIDs of the rows of any of the keys, the union of the bitmaps of each */
+  RoaringBitmap GetBitmap(const std::vector<Tuple> &keys);
+
+  /** @return the number of distinct keys that have rows */
+  size_t GetKeyCount();
+
+  /** @return the bytes the bitmaps take */
+  size_t GetMemoryUsage();
+
+  static uint64_t ToBitmapValue(const RID &rid) {
+    return static_cast<uint64_t>(static_cast<uint32_t>(rid.GetPageId())) << 32 | rid.GetSlotNum();
+  }
+
+  static RID ToRid(uint64_t value) {
+    return RID(static_cast<page_id_t>(static_cast<uint32_t>(value >> 32)), static_cast<uint32_t>(value));
+  }
+
+ private:
+  static std::string KeyOf(const Tuple &key) { return std::string(key.GetData(), key.GetLength()); }
+
+  /** Guards bitmaps_ */
+  std::shared_mutex latch_;
+  /** The bitmap of each key that has rows */
+  std::unordered_map<std::string, RoaringBitmap> bitmaps_;
+};
+
+}  // namespace bustub
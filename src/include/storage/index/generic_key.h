@@ -12,9 +12,17 @@
 
 #pragma once
 
+#include <algorithm>
+#include <cstdint>
 #include <cstring>
+#include <memory>
+#include <type_traits>
+#include <vector>
 
+#include "common/exception.h"
+#include "common/rid.h"
 #include "storage/table/tuple.h"
+#include "type/limits.h"
 #include "type/value.h"
 
 namespace bustub {
@@ -32,7 +40,97 @@ class GenericKey {
   inline void SetFromKey(const Tuple &tuple) {
     // intialize to 0
     memset(data_, 0, KeySize);
-    memcpy(data_, tuple.GetData(), tuple.GetLength());
+    // the null bitmap at the end of the tuple is cut off if the key leaves no room for it
+    memcpy(data_, tuple.GetData(), std::min<size_t>(tuple.GetLength(), KeySize));
+  }
+
+  // Writes the key in an order preserving form instead, in which keys compare like their values under plain memcmp.
+  // Every column starts with a flag byte, 0 for NULL (which sorts first) and 1 otherwise, followed for non-NULLs by:
+  // integers big endian with the sign bit flipped, doubles with the sign bit flipped (all bits if negative),
+  // timestamps big endian, and VARCHARs with 0x00 escaped as 0x00 0xFF and ended by 0x00 0x00. Throws if that takes
+  // more than max_size bytes. Such keys cannot be read back with ToValue.
+  inline void SetFromKeyNormalized(const Tuple &tuple, const Schema *key_schema, size_t max_size = KeySize) {
+    memset(data_, 0, KeySize);
+    size_t pos = 0;
+    auto put = [&](uint8_t byte) {
+      if (pos >= max_size) {
+        throw Exception(ExceptionType::OUT_OF_RANGE, "the normalized key does not fit");
+      }
+      data_[pos++] = static_cast<char>(byte);
+    };
+    auto put_big_endian = [&](uint64_t bits, size_t width) {
+      for (size_t i = width; i-- > 0;) {
+        put(static_cast<uint8_t>(bits >> (8 * i)));
+      }
+    };
+    auto put_signed = [&](int64_t v, size_t width) {
+      put_big_endian(static_cast<uint64_t>(v) ^ (uint64_t{1} << (8 * width - 1)), width);
+    };
+
+    for (uint32_t i = 0; i < key_schema->GetColumnCount(); i++) {
+      Value value = tuple.GetValue(key_schema, i);
+      if (value.IsNull()) {
+        put(0);
+        continue;
+      }
+      put(1);
+      switch (value.GetTypeId()) {
+        case TypeId::BOOLEAN:
+        case TypeId::TINYINT:
+          put_signed(value.GetAs<int8_t>(), sizeof(int8_t));
+          break;
+        case TypeId::SMALLINT:
+          put_signed(value.GetAs<int16_t>(), sizeof(int16_t));
+          break;
+        case TypeId::INTEGER:
+          put_signed(value.GetAs<int32_t>(), sizeof(int32_t));
+          break;
+        case TypeId::BIGINT:
+          put_signed(value.GetAs<int64_t>(), sizeof(int64_t));
+          break;
+        case TypeId::DECIMAL: {
+          uint64_t bits;
+          double d = value.GetAs<double>();
+          // -0.0 equals 0.0, so it is written as 0.0
+          if (d == 0) {
+            d = 0;
+          }
+          memcpy(&bits, &d, sizeof(bits));
+          put_big_endian((bits >> 63) != 0 ? ~bits : bits ^ (uint64_t{1} << 63), sizeof(bits));
+          break;
+        }
+        case TypeId::TIMESTAMP:
+          put_big_endian(value.GetAs<uint64_t>(), sizeof(uint64_t));
+          break;
+        default: {
+          // without the terminating '\0' a VARCHAR value carries
+          const char *str = value.GetData();
+          for (uint32_t j = 0; j + 1 < value.GetLength(); j++) {
+            put(static_cast<uint8_t>(str[j]));
+            if (str[j] == 0) {
+              put(0xFF);
+            }
+          }
+          put(0);
+          put(0);
+          break;
+        }
+      }
+    }
+  }
+
+  // Non-unique indexes make every key unique by storing the RID of the entry in the last bytes of the key, which the
+  // key tuple has to leave free
+  inline void SetRid(const RID &rid) {
+    static_assert(KeySize >= sizeof(RID), "the key is too small to hold a RID");
+    memcpy(data_ + KeySize - sizeof(RID), &rid, sizeof(RID));
+  }
+
+  inline RID GetRid() const {
+    static_assert(KeySize >= sizeof(RID), "the key is too small to hold a RID");
+    RID rid;
+    memcpy(&rid, data_ + KeySize - sizeof(RID), sizeof(RID));
+    return rid;
   }
 
   // NOTE: for test purpose only
@@ -72,35 +170,210 @@ class GenericKey {
 
 /**
  * Function object returns true if lhs < rhs, used for trees
+ *
+ * The comparator plans the comparison once, from the key schema: fixed width
+ * columns are compared right in the bytes of the keys, and only VARCHAR
+ * columns are deserialized into Values. Like Value comparisons, a NULL is
+ * neither less nor greater than anything.
  */
 template <size_t KeySize>
 class GenericComparator {
  public:
   inline int operator()(const GenericKey<KeySize> &lhs, const GenericKey<KeySize> &rhs) const {
-    uint32_t column_count = key_schema_->GetColumnCount();
-
-    for (uint32_t i = 0; i < column_count; i++) {
-      Value lhs_value = (lhs.ToValue(key_schema_, i));
-      Value rhs_value = (rhs.ToValue(key_schema_, i));
+    int cmp = CompareColumns(lhs, rhs);
+    if (cmp != 0) {
+      return cmp;
+    }
+    if constexpr (KeySize >= sizeof(RID)) {
+      if (rid_suffixed_) {
+        RID lhs_rid = lhs.GetRid();
+        RID rhs_rid = rhs.GetRid();
+        if (lhs_rid.GetPageId() != rhs_rid.GetPageId()) {
+          return lhs_rid.GetPageId() < rhs_rid.GetPageId() ? -1 : 1;
+        }
+        if (lhs_rid.GetSlotNum() != rhs_rid.GetSlotNum()) {
+          return lhs_rid.GetSlotNum() < rhs_rid.GetSlotNum() ? -1 : 1;
+        }
+      }
+    }
+    // equals
+    return 0;
+  }
 
-      if (lhs_value.CompareLessThan(rhs_value) == CmpBool::CmpTrue) {
-        return -1;
+  // compares the key columns only, leaving out the RID suffix
+  inline int CompareColumns(const GenericKey<KeySize> &lhs, const GenericKey<KeySize> &rhs) const {
+    if (normalized_) {
+      int cmp = memcmp(lhs.data_, rhs.data_, rid_suffixed_ ? KeySize - sizeof(RID) : KeySize);
+      return (cmp > 0) - (cmp < 0);
+    }
+    for (const ColumnPlan &column : *plan_) {
+      const char *lhs_data = lhs.data_ + column.offset_;
+      const char *rhs_data = rhs.data_ + column.offset_;
+      int cmp;
+      switch (column.type_) {
+        case TypeId::BOOLEAN:
+          cmp = CompareRaw<int8_t>(lhs_data, rhs_data, BUSTUB_BOOLEAN_NULL);
+          break;
+        case TypeId::TINYINT:
+          cmp = CompareRaw<int8_t>(lhs_data, rhs_data, BUSTUB_INT8_NULL);
+          break;
+        case TypeId::SMALLINT:
+          cmp = CompareRaw<int16_t>(lhs_data, rhs_data, BUSTUB_INT16_NULL);
+          break;
+        case TypeId::INTEGER:
+          cmp = CompareRaw<int32_t>(lhs_data, rhs_data, BUSTUB_INT32_NULL);
+          break;
+        case TypeId::BIGINT:
+          cmp = CompareRaw<int64_t>(lhs_data, rhs_data, BUSTUB_INT64_NULL);
+          break;
+        case TypeId::DECIMAL:
+          cmp = CompareRaw<double>(lhs_data, rhs_data, BUSTUB_DECIMAL_NULL);
+          break;
+        case TypeId::TIMESTAMP:
+          cmp = CompareRaw<uint64_t>(lhs_data, rhs_data, BUSTUB_TIMESTAMP_NULL);
+          break;
+        default:
+          cmp = CompareValues(lhs, rhs, column.column_idx_);
+          break;
       }
-      if (lhs_value.CompareGreaterThan(rhs_value) == CmpBool::CmpTrue) {
-        return 1;
+      if (cmp != 0) {
+        return cmp;
       }
     }
-    // equals
     return 0;
   }
 
-  GenericComparator(const GenericComparator &other) : key_schema_{other.key_schema_} {}
+  // writes the leading bytes of the key columns to prefix, as a big-endian integer that orders as the keys do, for a
+  // radix sort: the first 8 bytes of a normalized key, or else the integer columns the key starts with, each with its
+  // sign bit flipped, as many as fit. Keys whose prefixes tie may still differ. Returns false if the key has no such
+  // bytes, e.g. it starts with a VARCHAR, or a NULL, which is neither less nor greater than anything
+  inline bool Prefix(const GenericKey<KeySize> &key, uint64_t *prefix) const {
+    *prefix = 0;
+    if (normalized_) {
+      const size_t length = std::min<size_t>(rid_suffixed_ ? KeySize - sizeof(RID) : KeySize, sizeof(uint64_t));
+      for (size_t i = 0; i < length; i++) {
+        *prefix |= static_cast<uint64_t>(static_cast<uint8_t>(key.data_[i])) << (8 * (sizeof(uint64_t) - 1 - i));
+      }
+      return length > 0;
+    }
+    size_t free_bits = 64;
+    for (const ColumnPlan &column : *plan_) {
+      const char *data = key.data_ + column.offset_;
+      uint64_t bits;
+      size_t width;
+      switch (column.type_) {
+        case TypeId::TINYINT:
+          width = sizeof(int8_t);
+          bits = PrefixBits<int8_t>(data, BUSTUB_INT8_NULL);
+          break;
+        case TypeId::SMALLINT:
+          width = sizeof(int16_t);
+          bits = PrefixBits<int16_t>(data, BUSTUB_INT16_NULL);
+          break;
+        case TypeId::INTEGER:
+          width = sizeof(int32_t);
+          bits = PrefixBits<int32_t>(data, BUSTUB_INT32_NULL);
+          break;
+        case TypeId::BIGINT:
+          width = sizeof(int64_t);
+          bits = PrefixBits<int64_t>(data, BUSTUB_INT64_NULL);
+          break;
+        default:
+          return free_bits < 64;
+      }
+      if (width * 8 > free_bits || column.offset_ + width > KeySize) {
+        break;
+      }
+      if (bits == 0) {
+        return false;
+      }
+      free_bits -= width * 8;
+      *prefix |= bits << free_bits;
+    }
+    return free_bits < 64;
+  }
+
+  // true if the keys are a single integer column as wide as the key, which compares like the integer the bytes of the
+  // key hold natively
+  inline bool IsIntegerKey() const { return integer_key_; }
+
+  GenericComparator(const GenericComparator &other)
+      : key_schema_{other.key_schema_},
+        plan_{other.plan_},
+        rid_suffixed_{other.rid_suffixed_},
+        normalized_{other.normalized_},
+        integer_key_{other.integer_key_} {}
 
-  // constructor
-  explicit GenericComparator(Schema *key_schema) : key_schema_(key_schema) {}
+  // constructor; rid_suffixed breaks ties between equal keys by the RIDs they carry, see GenericKey::SetRid, and
+  // normalized compares keys written by GenericKey::SetFromKeyNormalized
+  explicit GenericComparator(Schema *key_schema, bool rid_suffixed = false, bool normalized = false)
+      : key_schema_(key_schema), rid_suffixed_(rid_suffixed), normalized_(normalized) {
+    auto plan = std::make_shared<std::vector<ColumnPlan>>();
+    // memcmp is all it takes for normalized keys
+    for (uint32_t i = 0; i < key_schema->GetColumnCount() && !normalized; i++) {
+      const Column &column = key_schema->GetColumn(i);
+      plan->push_back({i, column.GetOffset(), column.IsInlined() ? column.GetType() : TypeId::VARCHAR});
+    }
+    plan_ = std::move(plan);
+    if (!rid_suffixed && !normalized && key_schema->GetColumnCount() == 1) {
+      TypeId type = key_schema->GetColumn(0).GetType();
+      integer_key_ = (type == TypeId::INTEGER && KeySize == sizeof(int32_t)) ||
+                     (type == TypeId::BIGINT && KeySize == sizeof(int64_t));
+    }
+  }
 
  private:
+  // how to compare one column of the keys
+  struct ColumnPlan {
+    uint32_t column_idx_;
+    uint32_t offset_;
+    TypeId type_;
+  };
+
+  template <typename T>
+  static inline int CompareRaw(const char *lhs_data, const char *rhs_data, T null_value) {
+    T lhs_value;
+    T rhs_value;
+    memcpy(&lhs_value, lhs_data, sizeof(T));
+    memcpy(&rhs_value, rhs_data, sizeof(T));
+    if (lhs_value == null_value || rhs_value == null_value) {
+      return 0;
+    }
+    return (lhs_value > rhs_value) - (lhs_value < rhs_value);
+  }
+
+  // the bits of an integer of a key with its sign bit flipped, which order as the integers do; 0 for a NULL, which is
+  // the least integer of its type
+  template <typename T>
+  static inline uint64_t PrefixBits(const char *data, T null_value) {
+    T value;
+    memcpy(&value, data, sizeof(T));
+    if (value == null_value) {
+      return 0;
+    }
+    using Unsigned = std::make_unsigned_t<T>;
+    return static_cast<Unsigned>(static_cast<Unsigned>(value) ^ (Unsigned{1} << (sizeof(T) * 8 - 1)));
+  }
+
+  inline int CompareValues(const GenericKey<KeySize> &lhs, const GenericKey<KeySize> &rhs, uint32_t column_idx) const {
+    Value lhs_value = (lhs.ToValue(key_schema_, column_idx));
+    Value rhs_value = (rhs.ToValue(key_schema_, column_idx));
+
+    if (lhs_value.CompareLessThan(rhs_value) == CmpBool::CmpTrue) {
+      return -1;
+    }
+    if (lhs_value.CompareGreaterThan(rhs_value) == CmpBool::CmpTrue) {
+      return 1;
+    }
+    return 0;
+  }
+
   Schema *key_schema_;
+  // shared by the copies of a comparator, which are made all the time
+  std::shared_ptr<const std::vector<ColumnPlan>> plan_;
+  bool rid_suffixed_;
+  bool normalized_;
+  bool integer_key_{false};
 };
 
 }  // namespace bustub
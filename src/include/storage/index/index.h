@@ -37,8 +37,12 @@ class IndexMetadata {
   IndexMetadata() = delete;
 
   IndexMetadata(std::string index_name, std::string table_name, const Schema *tuple_schema,
-                std::vector<uint32_t> key_attrs)
-      : name_(std::move(index_name)), table_name_(std::move(table_name)), key_attrs_(std::move(key_attrs)) {
+                std::vector<uint32_t> key_attrs, bool is_unique = true, bool normalized_keys = false)
+      : name_(std::move(index_name)),
+        table_name_(std::move(table_name)),
+        key_attrs_(std::move(key_attrs)),
+        is_unique_(is_unique),
+        normalized_keys_(normalized_keys) {
     key_schema_ = Schema::CopySchema(tuple_schema, key_attrs_);
   }
 
@@ -56,6 +60,13 @@ class IndexMetadata {
   // because it uses the member of catalog::Schema which is not known here
   uint32_t GetIndexColumnCount() const { return static_cast<uint32_t>(key_attrs_.size()); }
 
+  // Returns false if several entries may have the same key, as on a secondary index of a non-unique column
+  inline bool IsUnique() const { return is_unique_; }
+
+  // Returns true if the index stores its keys in an order preserving form that compares with memcmp, see
+  // GenericKey::SetFromKeyNormalized
+  inline bool HasNormalizedKeys() const { return normalized_keys_; }
+
   //  Returns the mapping relation between indexed columns  and base table
   //  columns
   inline const std::vector<uint32_t> &GetKeyAttrs() const { return key_attrs_; }
@@ -78,6 +89,8 @@ class IndexMetadata {
   std::string table_name_;
   // The mapping relation between key schema and tuple schema
   const std::vector<uint32_t> key_attrs_;
+  const bool is_unique_;
+  const bool normalized_keys_;
   // schema of the indexed key
   Schema *key_schema_;
 };
@@ -132,11 +145,41 @@ class Index {
   // designed for secondary indexes.
   virtual void InsertEntry(const Tuple &key, RID rid, Transaction *transaction) = 0;
 
+  // insert many entries at once, e.g. those of the rows of a bulk load; an index that is cheaper to build in a batch
+  // (e.g. a B+ tree, from the bottom up) overrides this instead of inserting the entries one by one
+  virtual void InsertEntries(const std::vector<std::pair<Tuple, RID>> &entries, Transaction *transaction) {
+    for (const auto &entry : entries) {
+      InsertEntry(entry.first, entry.second, transaction);
+    }
+  }
+
   // delete the index entry linked to given tuple
   virtual void DeleteEntry(const Tuple &key, RID rid, Transaction *transaction) = 0;
 
+  // delete many entries at once, e.g. those a statement deleted; an index whose changes are cheaper in key order
+  // (e.g. a B+ tree) overrides this instead of deleting the entries in the order they are given in
+  virtual void DeleteEntries(const std::vector<std::pair<Tuple, RID>> &entries, Transaction *transaction) {
+    for (const auto &entry : entries) {
+      DeleteEntry(entry.first, entry.second, transaction);
+    }
+  }
+
   virtual void ScanKey(const Tuple &key, std::vector<RID> *result, Transaction *transaction) = 0;
 
+  // look up many keys at once, results[i] getting the RIDs of keys[i]; an index whose lookups are cheaper in key
+  // order (e.g. a B+ tree) overrides this instead of looking the keys up one by one
+  virtual void ScanKeys(const std::vector<Tuple> &keys, std::vector<std::vector<RID>> *results,
+                        Transaction *transaction) {
+    results->assign(keys.size(), {});
+    for (size_t i = 0; i < keys.size(); i++) {
+      ScanKey(keys[i], &(*results)[i], transaction);
+    }
+  }
+
+  // true if the entries can be read in key order, and so by key range, as an IndexScanExecutor does; the others can
+  // only be looked up by key
+  virtual bool IsOrdered() const { return false; }
+
  private:
   //===--------------------------------------------------------------------===//
   //  Data members
@@ -13,31 +13,166 @@
  * For range scan of b+ tree
  */
 #pragma once
+#include <functional>
+#include <vector>
+
 #include "storage/page/b_plus_tree_leaf_page.h"
 
 namespace bustub {
 
 #define INDEXITERATOR_TYPE IndexIterator<KeyType, ValueType, KeyComparator>
+#define REVERSE_INDEXITERATOR_TYPE ReverseIndexIterator<KeyType, ValueType, KeyComparator>
 
+/**
+ * Iterates over the pairs of a B+ tree in key order.
+ *
+ * The iterator keeps the leaf it is on pinned and read latched, and moves on to the next leaf by latching it before
+ * letting go of the current one. Leaves are therefore always latched left to right, which is the order the tree
+ * latches siblings in when it coalesces or redistributes leaves. An iterator that is not moved keeps its leaf latched,
+ * so it should not outlive the scan it is used for.
+ *
+ * Whenever the iterator enters a leaf, it asks the buffer pool to prefetch the next one, so that long scans do not
+ * wait on a read per leaf. NextBatch hands out the rest of a leaf at once, for scans that would otherwise pay for a
+ * call per pair.
+ */
 INDEX_TEMPLATE_ARGUMENTS
 class IndexIterator {
+  using LeafPage = BPlusTreeLeafPage<KeyType, ValueType, KeyComparator>;
+
  public:
-  // you may define your own constructor based on your member variables
-  IndexIterator();
+  /** Creates the end iterator. */
+  IndexIterator() = default;
+
+  /**
+   * Creates an iterator positioned on a pair of a leaf, or the end iterator if the leaf has no pair at or after index.
+   * @param buffer_pool_manager the buffer pool of the tree
+   * @param page the leaf page, pinned and read latched, which the iterator takes over
+   * @param index the index of the pair in the leaf
+   */
+  IndexIterator(BufferPoolManager *buffer_pool_manager, Page *page, int index);
   ~IndexIterator();
 
+  IndexIterator(const IndexIterator &) = delete;
+  IndexIterator &operator=(const IndexIterator &) = delete;
+  IndexIterator(IndexIterator &&other) noexcept;
+  IndexIterator &operator=(IndexIterator &&other) noexcept;
+
   bool isEnd();
 
   const MappingType &operator*();
 
   IndexIterator &operator++();
 
-  bool operator==(const IndexIterator &itr) const { throw std::runtime_error("unimplemented"); }
+  /**
+   * Hands out the pairs from the current one to the end of its leaf, and moves on to the first pair of the next leaf.
+   * @param[out] batch the pairs, replacing what it held before
+   * @return false if the iterator was at the end already, in which case the batch is empty
+   */
+  bool NextBatch(std::vector<MappingType> *batch);
+
+  /**
+   * Moves to the first pair at or after a key, if that is in the current leaf, so that a run of lookups in ascending
+   * key order can go on from the leaf of the last one instead of descending from the root for each.
+   * @return false if the iterator is at the end or the key is past the last key of its leaf, which it stays on then
+   */
+  bool SeekInLeaf(const KeyType &key, const KeyComparator &comparator);
+
+  bool operator==(const IndexIterator &itr) const {
+    if (page_ == nullptr || itr.page_ == nullptr) {
+      return page_ == itr.page_;
+    }
+    return page_->GetPageId() == itr.page_->GetPageId() && index_ == itr.index_;
+  }
 
-  bool operator!=(const IndexIterator &itr) const { throw std::runtime_error("unimplemented"); }
+  bool operator!=(const IndexIterator &itr) const { return !(*this == itr); }
 
  private:
-  // add your own private member variables here
+  /** Moves to the next leaf while the current one has no pair at index_. */
+  void SkipExhaustedLeaves();
+
+  /** Asks the buffer pool to read the leaf after the current one in the background. */
+  void PrefetchNextLeaf();
+
+  /** Unlatches and unpins the current leaf. */
+  void Release();
+
+  BufferPoolManager *buffer_pool_manager_{nullptr};
+  // nullptr for the end iterator
+  Page *page_{nullptr};
+  LeafPage *leaf_{nullptr};
+  int index_{0};
+  // leaves store their keys compressed, so the pair handed out is a copy
+  MappingType item_;
+};
+
+/**
+ * Iterates over the pairs of a B+ tree in descending key order.
+ *
+ * Like IndexIterator, the iterator keeps its leaf pinned and read latched. Leaves are latched left to right by
+ * everybody else though, so waiting for the previous leaf while holding this one could deadlock with a writer that
+ * holds the previous leaf and waits for this one. The previous leaf is therefore only taken if its latch is free right
+ * away and it still links to this leaf; otherwise the iterator lets go of its leaf and looks up the pair before the
+ * first key of that leaf from the root.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+class ReverseIndexIterator {
+  using LeafPage = BPlusTreeLeafPage<KeyType, ValueType, KeyComparator>;
+
+ public:
+  /**
+   * Looks up the leaf a key belongs in, returned pinned and read latched (nullptr if the tree is empty), and sets
+   * index to the last pair before the key there, -1 if there is none.
+   */
+  using FindPairBefore = std::function<Page *(const KeyType &key, int *index)>;
+
+  /** Creates the end iterator. */
+  ReverseIndexIterator() = default;
+
+  /**
+   * Creates an iterator positioned on a pair of a leaf, or on the last pair before the leaf if index is -1.
+   * @param buffer_pool_manager the buffer pool of the tree
+   * @param find_pair_before how to look up a position again from the root
+   * @param page the leaf page, pinned and read latched, which the iterator takes over
+   * @param index the index of the pair in the leaf
+   */
+  ReverseIndexIterator(BufferPoolManager *buffer_pool_manager, FindPairBefore find_pair_before, Page *page, int index);
+  ~ReverseIndexIterator();
+
+  ReverseIndexIterator(const ReverseIndexIterator &) = delete;
+  ReverseIndexIterator &operator=(const ReverseIndexIterator &) = delete;
+  ReverseIndexIterator(ReverseIndexIterator &&other) noexcept;
+  ReverseIndexIterator &operator=(ReverseIndexIterator &&other) noexcept;
+
+  bool isEnd() { return page_ == nullptr; }
+
+  const MappingType &operator*();
+
+  /** Moves to the previous pair. */
+  ReverseIndexIterator &operator++();
+
+  bool operator==(const ReverseIndexIterator &itr) const {
+    if (page_ == nullptr || itr.page_ == nullptr) {
+      return page_ == itr.page_;
+    }
+    return page_->GetPageId() == itr.page_->GetPageId() && index_ == itr.index_;
+  }
+
+  bool operator!=(const ReverseIndexIterator &itr) const { return !(*this == itr); }
+
+ private:
+  /** Moves to previous leaves while the current one has no pair at index_. */
+  void SkipExhaustedLeaves();
+
+  /** Unlatches and unpins the current leaf. */
+  void Release();
+
+  BufferPoolManager *buffer_pool_manager_{nullptr};
+  FindPairBefore find_pair_before_;
+  // nullptr for the end iterator
+  Page *page_{nullptr};
+  LeafPage *leaf_{nullptr};
+  int index_{-1};
+  MappingType item_;
 };
 
 }  // namespace bustub
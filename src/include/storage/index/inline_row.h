@@ -0,0 +1,52 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// inline_row.h
+//
+// Identification: src/include/storage/index/inline_row.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+
+#include "storage/table/tuple.h"
+
+namespace bustub {
+
+/**
+ * InlineRow is a value of a B+ tree that is a whole tuple rather than the RID of one, for the trees of clustered
+ * tables (see ClusteredTable), whose leaves hold their rows. Like GenericKey it is of a fixed size, which the template
+ * argument gives, so that leaf pages copy it as they do a RID; a tuple of up to RowSize - 4 bytes fits.
+ */
+template <size_t RowSize>
+class InlineRow {
+ public:
+  /** The longest tuple a row holds */
+  static constexpr uint32_t MAX_TUPLE_SIZE = RowSize - sizeof(uint32_t);
+
+  /** @return true if the tuple fits a row */
+  static bool Fits(const Tuple &tuple) { return tuple.GetLength() <= MAX_TUPLE_SIZE; }
+
+  /** Copies a tuple that fits into the row. */
+  inline void SetFromTuple(const Tuple &tuple) {
+    size_ = tuple.GetLength();
+    memcpy(data_, tuple.GetData(), size_);
+  }
+
+  /** @return a view of the tuple in the row, valid for as long as the row is */
+  inline Tuple AsTuple(const RID &rid) { return Tuple(rid, data_, size_); }
+
+  inline uint32_t GetSize() const { return size_; }
+
+ private:
+  uint32_t size_{0};
+  char data_[MAX_TUPLE_SIZE];
+};
+
+}  // namespace bustub
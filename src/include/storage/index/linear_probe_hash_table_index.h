@@ -14,6 +14,7 @@
 
 #include <map>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "container/hash/hash_function.h"
@@ -38,7 +39,27 @@ class LinearProbeHashTableIndex : public Index {
 
   void ScanKey(const Tuple &key, std::vector<RID> *result, Transaction *transaction) override;
 
+  /** Looks the keys up pinning each block page once per batch, see LinearProbeHashTable::GetValues. */
+  void ScanKeys(const std::vector<Tuple> &keys, std::vector<std::vector<RID>> *results,
+                Transaction *transaction) override;
+
+  /**
+   * Inserts many entries at once, see LinearProbeHashTable::BulkInsert; for building the index over a populated table.
+   * @param entries the key tuples, as for InsertEntry, and their RIDs
+   * @param transaction the current transaction
+   * @return the number of entries inserted
+   */
+  size_t BulkInsertEntries(const std::vector<std::pair<Tuple, RID>> &entries, Transaction *transaction);
+
+  /** Inserts the entries with BulkInsertEntries. */
+  void InsertEntries(const std::vector<std::pair<Tuple, RID>> &entries, Transaction *transaction) override {
+    BulkInsertEntries(entries, transaction);
+  }
+
  protected:
+  // builds the index key of a key tuple, normalized if the metadata asks for it
+  KeyType MakeKey(const Tuple &key) const;
+
   // comparator for key
   KeyComparator comparator_;
   // container
@@ -19,6 +19,7 @@ namespace bustub {
 #define B_PLUS_TREE_INTERNAL_PAGE_TYPE BPlusTreeInternalPage<KeyType, ValueType, KeyComparator>
 #define INTERNAL_PAGE_HEADER_SIZE 24
 #define INTERNAL_PAGE_SIZE ((PAGE_SIZE - INTERNAL_PAGE_HEADER_SIZE) / (sizeof(MappingType)))
+#define INTERNAL_PAGE_CAPACITY ((PAGE_SIZE - INTERNAL_PAGE_HEADER_SIZE) / (sizeof(KeyType) + sizeof(ValueType)))
 /**
  * Store n indexed keys and n+1 child pointers (page_id) within internal page.
  * Pointer PAGE_ID(i) points to a subtree in which all keys K satisfy:
@@ -28,9 +29,13 @@ namespace bustub {
  * should ignore the first key.
  *
  * Internal page format (keys are stored in increasing order):
- *  --------------------------------------------------------------------------
- * | HEADER | KEY(1)+PAGE_ID(1) | KEY(2)+PAGE_ID(2) | ... | KEY(n)+PAGE_ID(n) |
- *  --------------------------------------------------------------------------
+ *  ------------------------------------------------------------------------
+ * | HEADER | KEY(1) | KEY(2) | ... | KEY(c) | PAGE_ID(1) | ... | PAGE_ID(c) |
+ *  ------------------------------------------------------------------------
+ * where c is INTERNAL_PAGE_CAPACITY. Keeping the keys apart from the child page
+ * ids packs more of them into each cache line a lookup touches. A lookup on a
+ * key of a single INTEGER (GenericKey<4>) or BIGINT (GenericKey<8>) column,
+ * see GenericComparator::IsIntegerKey, compares the keys as integers directly.
  */
 INDEX_TEMPLATE_ARGUMENTS
 class BPlusTreeInternalPage : public BPlusTreePage {
@@ -52,15 +57,32 @@ class BPlusTreeInternalPage : public BPlusTreePage {
   // Split and Merge utility methods
   void MoveAllTo(BPlusTreeInternalPage *recipient, const KeyType &middle_key, BufferPoolManager *buffer_pool_manager);
   void MoveHalfTo(BPlusTreeInternalPage *recipient, BufferPoolManager *buffer_pool_manager);
+  void MoveTailTo(BPlusTreeInternalPage *recipient, int count, BufferPoolManager *buffer_pool_manager);
   void MoveFirstToEndOf(BPlusTreeInternalPage *recipient, const KeyType &middle_key,
                         BufferPoolManager *buffer_pool_manager);
   void MoveLastToFrontOf(BPlusTreeInternalPage *recipient, const KeyType &middle_key,
                          BufferPoolManager *buffer_pool_manager);
 
+  // Bulk load utility method: appends a child that sorts after every key of the page, and that already has this page
+  // as its parent
+  void Append(const KeyType &key, const ValueType &value);
+
  private:
-  void CopyNFrom(MappingType *items, int size, BufferPoolManager *buffer_pool_manager);
+  KeyType *Keys() { return reinterpret_cast<KeyType *>(data_); }
+  const KeyType *Keys() const { return reinterpret_cast<const KeyType *>(data_); }
+  ValueType *Values() { return reinterpret_cast<ValueType *>(data_ + INTERNAL_PAGE_CAPACITY * sizeof(KeyType)); }
+  const ValueType *Values() const {
+    return reinterpret_cast<const ValueType *>(data_ + INTERNAL_PAGE_CAPACITY * sizeof(KeyType));
+  }
+
+  // the index of the first key in [1, size) that is greater than key, for keys that are integers of IntType
+  template <typename IntType>
+  int IntegerUpperBound(const KeyType &key) const;
+
+  void CopyNFrom(const KeyType *keys, const ValueType *values, int size, BufferPoolManager *buffer_pool_manager);
   void CopyLastFrom(const MappingType &pair, BufferPoolManager *buffer_pool_manager);
   void CopyFirstFrom(const MappingType &pair, BufferPoolManager *buffer_pool_manager);
-  MappingType array[0];
+  void Adopt(page_id_t child_page_id, BufferPoolManager *buffer_pool_manager);
+  char data_[0];
 };
 }  // namespace bustub
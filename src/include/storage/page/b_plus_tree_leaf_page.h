@@ -18,26 +18,38 @@
 namespace bustub {
 
 #define B_PLUS_TREE_LEAF_PAGE_TYPE BPlusTreeLeafPage<KeyType, ValueType, KeyComparator>
-#define LEAF_PAGE_HEADER_SIZE 28
-#define LEAF_PAGE_SIZE ((PAGE_SIZE - LEAF_PAGE_HEADER_SIZE) / sizeof(MappingType))
+#define LEAF_PAGE_HEADER_SIZE 36
+// the space for pairs, after the header and the bytes that all keys of the page have in common
+#define LEAF_PAGE_SLOT_SPACE (PAGE_SIZE - LEAF_PAGE_HEADER_SIZE - sizeof(KeyType))
+// how many pairs fit if their keys have no bytes in common
+#define LEAF_PAGE_UNCOMPRESSED_SIZE (LEAF_PAGE_SLOT_SPACE / sizeof(MappingType))
+// up to this size, either half of a leaf that ran out of room takes any further key after a split
+#define LEAF_PAGE_SIZE (2 * (LEAF_PAGE_UNCOMPRESSED_SIZE - 1))
 
 /**
  * Store indexed key and record id(record id = page id combined with slot id,
  * see include/common/rid.h for detailed implementation) together within leaf
  * page. Only support unique key.
  *
+ * Keys are prefix and suffix compressed: the leading and trailing bytes that
+ * all keys of the page have in common (e.g. the zero padding of a GenericKey)
+ * are stored once, in CommonKey, and every slot holds just the bytes in
+ * between. A new key that has fewer bytes in common with the others widens
+ * all slots, so a page is full when its pairs take up the slot space, not at a
+ * fixed count; HasRoomFor tells whether a key still fits.
+ *
  * Leaf page format (keys are stored in order):
- *  ----------------------------------------------------------------------
- * | HEADER | KEY(1) + RID(1) | KEY(2) + RID(2) | ... | KEY(n) + RID(n)
- *  ----------------------------------------------------------------------
+ *  ---------------------------------------------------------------------------------
+ * | HEADER | CommonKey | KEY(1) middle + RID(1) | ... | KEY(n) middle + RID(n)
+ *  ---------------------------------------------------------------------------------
  *
- *  Header format (size in byte, 28 bytes in total):
+ *  Header format (size in byte, 36 bytes in total):
  *  ---------------------------------------------------------------------
  * | PageType (4) | LSN (4) | CurrentSize (4) | MaxSize (4) |
  *  ---------------------------------------------------------------------
- *  -----------------------------------------------
- * | ParentPageId (4) | PageId (4) | NextPageId (4)
- *  -----------------------------------------------
+ *  ---------------------------------------------------------------------------------------------
+ * | ParentPageId (4) | PageId (4) | NextPageId (4) | PrevPageId (4) | PrefixSize (2) | SuffixSize (2)
+ *  ---------------------------------------------------------------------------------------------
  */
 INDEX_TEMPLATE_ARGUMENTS
 class BPlusTreeLeafPage : public BPlusTreePage {
@@ -48,9 +60,17 @@ class BPlusTreeLeafPage : public BPlusTreePage {
   // helper methods
   page_id_t GetNextPageId() const;
   void SetNextPageId(page_id_t next_page_id);
+  page_id_t GetPrevPageId() const;
+  void SetPrevPageId(page_id_t prev_page_id);
   KeyType KeyAt(int index) const;
   int KeyIndex(const KeyType &key, const KeyComparator &comparator) const;
-  const MappingType &GetItem(int index);
+  MappingType GetItem(int index) const;
+  // true if the key fits into the page, which is not the same for all keys
+  bool HasRoomFor(const KeyType &key) const;
+  // true if the pairs of the other page fit into this one
+  bool HasRoomForAll(const BPlusTreeLeafPage *other) const;
+  // how many of the items a leaf could hold at the very least, going by the bytes the keys of all of them share
+  static int MaxSizeFor(const MappingType *items, int size);
 
   // insert and delete methods
   int Insert(const KeyType &key, const ValueType &value, const KeyComparator &comparator);
@@ -59,15 +79,41 @@ class BPlusTreeLeafPage : public BPlusTreePage {
 
   // Split and Merge utility methods
   void MoveHalfTo(BPlusTreeLeafPage *recipient);
+  void MoveTailTo(BPlusTreeLeafPage *recipient, int count);
   void MoveAllTo(BPlusTreeLeafPage *recipient);
   void MoveFirstToEndOf(BPlusTreeLeafPage *recipient);
   void MoveLastToFrontOf(BPlusTreeLeafPage *recipient);
 
+  // Bulk load utility method: appends items that sort after every key of the page
+  void Append(const MappingType *items, int size);
+
  private:
-  void CopyNFrom(MappingType *items, int size);
+  void CopyNFrom(const MappingType *items, int size);
   void CopyLastFrom(const MappingType &item);
   void CopyFirstFrom(const MappingType &item);
+
+  // Compression helpers
+  static int KeyWidth(int prefix_size, int suffix_size);
+  static void NarrowCommonBytes(const KeyType &common_key, const KeyType &key, int *prefix_size, int *suffix_size);
+  static bool Fits(int size, int prefix_size, int suffix_size);
+  char *SlotAt(int index) { return slots_ + index * (KeyWidth(prefix_size_, suffix_size_) + sizeof(ValueType)); }
+  const char *SlotAt(int index) const {
+    return slots_ + index * (KeyWidth(prefix_size_, suffix_size_) + sizeof(ValueType));
+  }
+  void WriteSlot(int index, const KeyType &key, const ValueType &value);
+  // narrows the common bytes down to those the key shares, so that it can be stored
+  void PrepareFor(const KeyType &key);
+  // lays the slots out again for other common bytes, which they all have to share
+  void Reencode(int prefix_size, int suffix_size);
+  // shrinks the slots to the bytes the keys that are left actually differ in
+  void Compact();
+
   page_id_t next_page_id_;
-  MappingType array[0];
+  page_id_t prev_page_id_;
+  // with a single key, both cover all of CommonKey
+  uint16_t prefix_size_;
+  uint16_t suffix_size_;
+  KeyType common_key_;
+  char slots_[0];
 };
 }  // namespace bustub
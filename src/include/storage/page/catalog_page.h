@@ -0,0 +1,55 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// catalog_page.h
+//
+// Identification: src/include/storage/page/catalog_page.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstring>
+
+#include "storage/page/page.h"
+
+namespace bustub {
+
+/**
+ * A persistent Catalog keeps its metadata, serialized, in a chain of catalog pages, whose first page the header page
+ * records. Each page holds the next part of the bytes.
+ *
+ * Format (size in byte):
+ *  -------------------------------------------------
+ * | NextPageId (4) | Size (4) | Payload (Size) ... |
+ *  -------------------------------------------------
+ */
+class CatalogPage : public Page {
+ public:
+  static constexpr size_t HEADER_SIZE = 8;
+  static constexpr size_t PAYLOAD_SIZE = PAGE_SIZE - HEADER_SIZE;
+
+  void Init() {
+    SetNextPageId(INVALID_PAGE_ID);
+    SetPayload(nullptr, 0);
+  }
+
+  page_id_t GetNextPageId() { return *reinterpret_cast<page_id_t *>(GetData()); }
+  void SetNextPageId(page_id_t next_page_id) { memcpy(GetData(), &next_page_id, sizeof(page_id_t)); }
+
+  uint32_t GetSize() { return *reinterpret_cast<uint32_t *>(GetData() + sizeof(page_id_t)); }
+  const char *GetPayload() { return GetData() + HEADER_SIZE; }
+
+  /** Replaces the payload with size bytes, at most PAYLOAD_SIZE */
+  void SetPayload(const char *payload, uint32_t size) {
+    memcpy(GetData() + sizeof(page_id_t), &size, sizeof(uint32_t));
+    if (size != 0) {
+      memcpy(GetData() + HEADER_SIZE, payload, size);
+    }
+  }
+};
+
+}  // namespace bustub
@@ -12,7 +12,7 @@
 
 #pragma once
 
-#include <atomic>
+#include <cstdint>
 #include <utility>
 #include <vector>
 
@@ -26,12 +26,20 @@ namespace bustub {
  * non-unique keys.
  *
  * Block page format (keys are stored in order):
- *  ----------------------------------------------------------------
- * | KEY(1) + VALUE(1) | KEY(2) + VALUE(2) | ... | KEY(n) + VALUE(n)
- *  ----------------------------------------------------------------
+ *  ------------------------------------------------------------------------------------------------
+ * | CONTROL(1) ... CONTROL(n) | HASH(1) ... HASH(n) | KEY(1) + VALUE(1) | ... | KEY(n) + VALUE(n)
+ *  ------------------------------------------------------------------------------------------------
  *
  *  Here '+' means concatenation.
  *
+ * The control byte of a slot is 0 while the slot was never occupied, 1 for a
+ * tombstone, and 0x80 | tag for a pair, where the tag is 7 bits of the hash of
+ * its key. A probe compares the control bytes of BLOCK_GROUP_SIZE slots at
+ * once, with SSE2 where it is available, and only looks at the keys of the
+ * slots whose tag matches.
+ *
+ * The 32 bit hash of each key is kept as well, so that moving pairs to a table
+ * of another size does not hash the keys again.
  */
 template <typename KeyType, typename ValueType, typename KeyComparator>
 class HashTableBlockPage {
@@ -39,6 +47,16 @@ class HashTableBlockPage {
   // Delete all constructor / destructor to ensure memory safety
   HashTableBlockPage() = delete;
 
+  /** The result of MatchGroup, one bit per slot of the group, the first slot in the lowest bit. */
+  struct GroupMatch {
+    // readable slots with the tag looked for
+    uint32_t match_;
+    // slots that were never occupied
+    uint32_t empty_;
+    // tombstones
+    uint32_t deleted_;
+  };
+
   /**
    * Gets the key at an index in the block.
    *
@@ -57,18 +75,31 @@ class HashTableBlockPage {
 
   /**
    * Attempts to insert a key and value into an index in the block.
-   * The insert is thread safe. It uses compare and swap to claim the index,
-   * and then writes the key and value into the index, and then marks the
-   * index as readable.
+   * The caller holds the write latch of the page.
    *
    * @param bucket_ind index to write the key and value to
    * @param key key to insert
    * @param value value to insert
+   * @param hash the hash of the key, see HashAt
    * @return If the value is inserted successfully, it returns true. If the
    * index is marked as readable before the key and value can be inserted,
    * Insert returns false.
    */
-  bool Insert(slot_offset_t bucket_ind, const KeyType &key, const ValueType &value);
+  bool Insert(slot_offset_t bucket_ind, const KeyType &key, const ValueType &value, uint32_t hash);
+
+  /**
+   * Gets the hash stored with the pair at an index in the block.
+   *
+   * @param bucket_ind the index of a readable slot
+   * @return the 32 bit hash of the key, as given to Insert
+   */
+  uint32_t HashAt(slot_offset_t bucket_ind) const { return hashes_[bucket_ind]; }
+
+  /**
+   * @param hash the hash of a key
+   * @return the 7 bit tag the control byte of its slot holds, the top bits of the hash
+   */
+  static uint8_t Tag(uint32_t hash) { return static_cast<uint8_t>(hash >> 25); }
 
   /**
    * Removes a key and value at index.
@@ -93,11 +124,24 @@ class HashTableBlockPage {
    */
   bool IsReadable(slot_offset_t bucket_ind) const;
 
+  /**
+   * Classifies the BLOCK_GROUP_SIZE slots from an index on by their control bytes, all at once. Slots past the end of
+   * the block are left out of every mask.
+   *
+   * @param bucket_ind the first slot of the group
+   * @param tag the tag looked for
+   * @return the slots of the group that hold a pair with the tag, that are empty and that are tombstones
+   */
+  GroupMatch MatchGroup(slot_offset_t bucket_ind, uint8_t tag) const;
+
  private:
-  std::atomic_char occupied_[(BLOCK_ARRAY_SIZE - 1) / 8 + 1];
+  static constexpr uint8_t EMPTY = 0;
+  static constexpr uint8_t DELETED = 1;
+  static constexpr uint8_t READABLE = 0x80;
 
-  // 0 if tombstone/brand new (never occupied), 1 otherwise.
-  std::atomic_char readable_[(BLOCK_ARRAY_SIZE - 1) / 8 + 1];
+  // one control byte per slot; a new page is all zeroes, i.e. all slots empty
+  uint8_t control_[BLOCK_ARRAY_SIZE + BLOCK_GROUP_SIZE - 1];
+  uint32_t hashes_[BLOCK_ARRAY_SIZE];
   MappingType array_[0];
 };
 
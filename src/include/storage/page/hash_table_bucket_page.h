@@ -0,0 +1,118 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// hash_table_bucket_page.h
+//
+// Identification: src/include/storage/page/hash_table_bucket_page.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "common/config.h"
+#include "storage/index/int_comparator.h"
+#include "storage/page/hash_table_page_defs.h"
+
+namespace bustub {
+/**
+ * Store indexed key and value together within a bucket page of an extendible
+ * hash table. Supports non-unique keys.
+ *
+ * The pairs are packed at the front of the page in no particular order;
+ * removing a pair moves the last one into its place.
+ *
+ * Bucket page format:
+ *  -------------------------------------------------------------------------
+ * | NumPairs(4) | Reserved(4) | KEY(1) + VALUE(1) | ... | KEY(n) + VALUE(n)
+ *  -------------------------------------------------------------------------
+ *
+ *  Here '+' means concatenation.
+ */
+template <typename KeyType, typename ValueType, typename KeyComparator>
+class HashTableBucketPage {
+ public:
+  // Delete all constructor / destructor to ensure memory safety
+  HashTableBucketPage() = delete;
+
+  /**
+   * Collects the values stored for a key.
+   *
+   * @param key the key to look up
+   * @param cmp the comparator for keys
+   * @param[out] result the values are appended here
+   * @return true if at least one value was found
+   */
+  bool GetValue(const KeyType &key, KeyComparator cmp, std::vector<ValueType> *result) const;
+
+  /**
+   * @return true if the key and value are stored in the bucket
+   */
+  bool Contains(const KeyType &key, const ValueType &value, KeyComparator cmp) const;
+
+  /**
+   * Appends a pair. The caller checks that the bucket is not full and the pair not in it yet.
+   *
+   * @param key key to insert
+   * @param value value to insert
+   */
+  void Insert(const KeyType &key, const ValueType &value);
+
+  /**
+   * Removes a key and value.
+   *
+   * @param key the key of the pair
+   * @param value the value of the pair
+   * @param cmp the comparator for keys
+   * @return true if the pair was in the bucket
+   */
+  bool Remove(const KeyType &key, const ValueType &value, KeyComparator cmp);
+
+  /**
+   * Removes the pair at an index, moving the last pair into its place.
+   *
+   * @param bucket_ind the index of the pair, below NumPairs
+   */
+  void RemoveAt(uint32_t bucket_ind);
+
+  /**
+   * @param bucket_ind the index of a pair, below NumPairs
+   * @return the key of the pair
+   */
+  KeyType KeyAt(uint32_t bucket_ind) const { return array_[bucket_ind].first; }
+
+  /**
+   * @param bucket_ind the index of a pair, below NumPairs
+   * @return the value of the pair
+   */
+  ValueType ValueAt(uint32_t bucket_ind) const { return array_[bucket_ind].second; }
+
+  /**
+   * @return the number of pairs in the bucket
+   */
+  uint32_t NumPairs() const { return num_pairs_; }
+
+  /**
+   * @return true if no further pair fits into the bucket
+   */
+  bool IsFull() const { return num_pairs_ == BUCKET_ARRAY_SIZE; }
+
+  /**
+   * @return true if the bucket holds no pair
+   */
+  bool IsEmpty() const { return num_pairs_ == 0; }
+
+ private:
+  // a new page is all zeroes, i.e. an empty bucket
+  uint32_t num_pairs_;
+  uint32_t reserved_;
+  MappingType array_[0];
+};
+
+}  // namespace bustub
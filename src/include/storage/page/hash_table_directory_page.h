@@ -0,0 +1,138 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// hash_table_directory_page.h
+//
+// Identification: src/include/storage/page/hash_table_directory_page.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstdint>
+
+#include "common/config.h"
+#include "storage/page/hash_table_page_defs.h"
+
+namespace bustub {
+
+/**
+ * Directory Page for extendible hash table.
+ *
+ * The directory has 2^GlobalDepth entries; the low GlobalDepth bits of the hash of a key are the index of the entry
+ * that names the bucket page of the key. A bucket with local depth d holds the keys that agree in their low d bits,
+ * so 2^(GlobalDepth - d) entries point to it.
+ *
+ * Directory format (size in byte):
+ * --------------------------------------------------------------------------------------------
+ * | LSN (4) | PageId(4) | GlobalDepth(4) | LocalDepths(512) | BucketPageIds(2048) | Free(1524)
+ * --------------------------------------------------------------------------------------------
+ */
+class HashTableDirectoryPage {
+ public:
+  /**
+   * @return the page ID of this page
+   */
+  page_id_t GetPageId() const { return page_id_; }
+
+  /**
+   * Sets the page ID of this page
+   *
+   * @param page_id the page id for the page id field to be set to
+   */
+  void SetPageId(page_id_t page_id) { page_id_ = page_id; }
+
+  /**
+   * @return the lsn of this page
+   */
+  lsn_t GetLSN() const { return lsn_; }
+
+  /**
+   * Sets the LSN of this page
+   *
+   * @param lsn the log sequence number for the lsn field to be set to
+   */
+  void SetLSN(lsn_t lsn) { lsn_ = lsn; }
+
+  /**
+   * @return the number of hash bits the directory indexes by
+   */
+  uint32_t GetGlobalDepth() const { return global_depth_; }
+
+  /**
+   * @return a mask of the low GlobalDepth bits, which turns a hash into a directory index
+   */
+  uint32_t GetGlobalDepthMask() const { return (1U << global_depth_) - 1; }
+
+  /**
+   * @return the number of directory entries, 2^GlobalDepth
+   */
+  uint32_t Size() const { return 1U << global_depth_; }
+
+  /**
+   * Doubles the directory. The new upper half is a copy of the lower half, so every key still maps to its bucket.
+   */
+  void IncrGlobalDepth();
+
+  /**
+   * Halves the directory, dropping its upper half. Only valid if CanShrink.
+   */
+  void DecrGlobalDepth();
+
+  /**
+   * @return true if every bucket has a local depth below the global depth, so the upper half of the directory is a
+   * copy of the lower half
+   */
+  bool CanShrink() const;
+
+  /**
+   * @param bucket_idx a directory index
+   * @return the page id of the bucket the entry points to
+   */
+  page_id_t GetBucketPageId(uint32_t bucket_idx) const { return bucket_page_ids_[bucket_idx]; }
+
+  /**
+   * Points a directory entry to a bucket page.
+   *
+   * @param bucket_idx a directory index
+   * @param bucket_page_id the page id of the bucket
+   */
+  void SetBucketPageId(uint32_t bucket_idx, page_id_t bucket_page_id) { bucket_page_ids_[bucket_idx] = bucket_page_id; }
+
+  /**
+   * @param bucket_idx a directory index
+   * @return the local depth of the bucket the entry points to
+   */
+  uint32_t GetLocalDepth(uint32_t bucket_idx) const { return local_depths_[bucket_idx]; }
+
+  /**
+   * Sets the local depth recorded in a directory entry.
+   *
+   * @param bucket_idx a directory index
+   * @param local_depth the local depth of the bucket the entry points to
+   */
+  void SetLocalDepth(uint32_t bucket_idx, uint32_t local_depth) {
+    local_depths_[bucket_idx] = static_cast<uint8_t>(local_depth);
+  }
+
+  /**
+   * @param bucket_idx a directory index whose bucket has a local depth above 0
+   * @return the index of the entry for the bucket's split image, the one that differs in the highest bit of the
+   * bucket's local depth
+   */
+  uint32_t GetSplitImageIndex(uint32_t bucket_idx) const {
+    return bucket_idx ^ (1U << (local_depths_[bucket_idx] - 1));
+  }
+
+ private:
+  lsn_t lsn_;
+  page_id_t page_id_;
+  uint32_t global_depth_;
+  uint8_t local_depths_[DIRECTORY_ARRAY_SIZE];
+  page_id_t bucket_page_ids_[DIRECTORY_ARRAY_SIZE];
+};
+
+}  // namespace bustub
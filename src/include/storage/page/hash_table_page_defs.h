@@ -14,11 +14,24 @@
 
 #define MappingType std::pair<KeyType, ValueType>
 
-/** BLOCK_ARRAY_SIZE is the number of (key, value) pairs that can be stored in   * a block page. It is an approximate
- * calculation based on the size of MappingType (which is a std::pair of KeyType and ValueType). For each key/value
- * pair, we need two additional bits for occupied_ and readable_. 4 * PAGE_SIZE / (4 * sizeof (MappingType) + 1) =
- * PAGE_SIZE/(sizeof (MappingType) + 0.25) because 0.25 bytes = 2 bits is the space required to maintain the occupied
- * and readable flags for a key value pair.*/
-#define BLOCK_ARRAY_SIZE (4 * PAGE_SIZE / (4 * sizeof(MappingType) + 1))
+/** BLOCK_ARRAY_SIZE is the number of (key, value) pairs that can be stored in a block page. Each pair takes
+ * sizeof(MappingType) bytes, 4 bytes for the hash of its key and one control byte, which says whether the slot is
+ * empty, a tombstone, or readable and holds 7 bits of the hash. The control bytes are padded with BLOCK_GROUP_SIZE - 1
+ * bytes so that a group of them can be loaded at any slot; the 32 bytes reserved cover that padding and the alignment
+ * of the pairs.*/
+#define BLOCK_ARRAY_SIZE ((PAGE_SIZE - 32) / (sizeof(MappingType) + 5))
+
+/** The number of control bytes a block page probe compares at once. */
+#define BLOCK_GROUP_SIZE 16
 
 #define HASH_TABLE_BLOCK_TYPE HashTableBlockPage<KeyType, ValueType, KeyComparator>
+
+/** BUCKET_ARRAY_SIZE is the number of (key, value) pairs that fit into a bucket page of an extendible hash table, after
+ * its 8 byte header. Pairs are kept packed at the front of the page, so no flags are needed per pair. */
+#define BUCKET_ARRAY_SIZE ((PAGE_SIZE - 8) / sizeof(MappingType))
+
+#define HASH_TABLE_BUCKET_TYPE HashTableBucketPage<KeyType, ValueType, KeyComparator>
+
+/** The number of directory entries a directory page of an extendible hash table has room for, 2^MAX_GLOBAL_DEPTH. */
+#define DIRECTORY_ARRAY_SIZE 512
+#define MAX_GLOBAL_DEPTH 9
@@ -0,0 +1,67 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// overflow_page.h
+//
+// Identification: src/include/storage/page/overflow_page.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstring>
+
+#include "storage/page/page.h"
+
+namespace bustub {
+
+/**
+ * Overflow page format: a page of a chain that holds a value too large to be kept in its tuple, a piece of the value
+ * per page.
+ *  ---------------------------------------------------------
+ *  | PageId (4) | NextPageId (4) | DataSize (4) | DATA ... |
+ *  ---------------------------------------------------------
+ */
+class OverflowPage : public Page {
+ public:
+  static constexpr size_t SIZE_OVERFLOW_PAGE_HEADER = 12;
+  /** the bytes of a value each page holds */
+  static constexpr size_t CAPACITY = PAGE_SIZE - SIZE_OVERFLOW_PAGE_HEADER;
+
+  /**
+   * Initialize the page with a piece of a value, as the last page of its chain.
+   * @param page_id the page ID of this page
+   * @param data the piece
+   * @param size the length of the piece, at most CAPACITY
+   */
+  void Init(page_id_t page_id, const char *data, uint32_t size) {
+    memcpy(GetData(), &page_id, sizeof(page_id_t));
+    SetNextPageId(INVALID_PAGE_ID);
+    memcpy(GetData() + OFFSET_DATA_SIZE, &size, sizeof(uint32_t));
+    memcpy(GetData() + SIZE_OVERFLOW_PAGE_HEADER, data, size);
+  }
+
+  /** @return the page ID of the next page of the chain, INVALID_PAGE_ID for the last one */
+  page_id_t GetNextPageId() { return *reinterpret_cast<page_id_t *>(GetData() + OFFSET_NEXT_PAGE_ID); }
+
+  void SetNextPageId(page_id_t next_page_id) {
+    memcpy(GetData() + OFFSET_NEXT_PAGE_ID, &next_page_id, sizeof(page_id_t));
+  }
+
+  /** @return the length of the piece of the value in this page */
+  uint32_t GetDataSize() { return *reinterpret_cast<uint32_t *>(GetData() + OFFSET_DATA_SIZE); }
+
+  /** @return the piece of the value in this page */
+  const char *GetPiece() { return GetData() + SIZE_OVERFLOW_PAGE_HEADER; }
+
+ private:
+  static_assert(sizeof(page_id_t) == 4);
+
+  static constexpr size_t OFFSET_NEXT_PAGE_ID = 4;
+  static constexpr size_t OFFSET_DATA_SIZE = 8;
+};
+
+}  // namespace bustub
@@ -12,6 +12,8 @@
 
 #pragma once
 
+#include <algorithm>
+#include <atomic>
 #include <cstring>
 #include <iostream>
 
@@ -27,11 +29,12 @@ namespace bustub {
  */
 class Page {
   // There is book-keeping information inside the page that should only be relevant to the buffer pool manager.
-  friend class BufferPoolManager;
+  friend class BufferPoolManagerInstance;
+  friend class MmapBufferPoolManager;
 
  public:
-  /** Constructor. Zeros out the page data. */
-  Page() { ResetMemory(); }
+  /** Constructor. The page has no data until the buffer pool hands it a frame. */
+  Page() = default;
 
   /** Default destructor. */
   ~Page() = default;
@@ -43,16 +46,24 @@ class Page {
   inline page_id_t GetPageId() { return page_id_; }
 
   /** @return the pin count of this page */
-  inline int GetPinCount() { return pin_count_; }
+  inline int GetPinCount() { return std::max(pin_count_.load(), 0); }
 
   /** @return true if the page in memory has been modified from the page on disk, false otherwise */
   inline bool IsDirty() { return is_dirty_; }
 
-  /** Acquire the page write latch. */
-  inline void WLatch() { rwlatch_.WLock(); }
+  /** Acquire the page write latch. The version is odd while it is held. */
+  inline void WLatch() {
+    rwlatch_.WLock();
+    version_.fetch_add(1, std::memory_order_relaxed);
+    // the writes to the data may not be seen before the version is
+    std::atomic_thread_fence(std::memory_order_release);
+  }
 
   /** Release the page write latch. */
-  inline void WUnlatch() { rwlatch_.WUnlock(); }
+  inline void WUnlatch() {
+    version_.fetch_add(1, std::memory_order_release);
+    rwlatch_.WUnlock();
+  }
 
   /** Acquire the page read latch. */
   inline void RLatch() { rwlatch_.RLock(); }
@@ -60,11 +71,45 @@ class Page {
   /** Release the page read latch. */
   inline void RUnlatch() { rwlatch_.RUnlock(); }
 
+  /** Acquire the page read latch if that does not mean waiting. @return true if the latch was acquired */
+  inline bool TryRLatch() { return rwlatch_.TryRLock(); }
+
+  /**
+   * Starts an optimistic read, which takes no latch and writes nothing shared: the reader records the version, reads
+   * the data, and keeps what it read only if ValidateVersion then says no writer latched the page in between. What it
+   * reads before that may be torn, so it must not be trusted any further than staying within the page. The page has to
+   * stay pinned for the whole read.
+   * @param[out] version the version to validate the read against
+   * @return false if a writer holds the latch, in which case the read is bound to fail
+   */
+  inline bool ReadVersion(uint64_t *version) {
+    *version = version_.load(std::memory_order_acquire);
+    return (*version & 1) == 0;
+  }
+
+  /** @return true if no writer has latched the page since ReadVersion returned version, so the read is consistent */
+  inline bool ValidateVersion(uint64_t version) {
+    // the reads of the data may not be done after the version is read again
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return version_.load(std::memory_order_relaxed) == version;
+  }
+
   /** @return the page LSN. */
   inline lsn_t GetLSN() { return *reinterpret_cast<lsn_t *>(GetData() + OFFSET_LSN); }
 
-  /** Sets the page LSN. */
-  inline void SetLSN(lsn_t lsn) { memcpy(GetData() + OFFSET_LSN, &lsn, sizeof(lsn_t)); }
+  /** Sets the page LSN, which is the recovery LSN as well if it is the first change since the page was clean. */
+  inline void SetLSN(lsn_t lsn) {
+    memcpy(GetData() + OFFSET_LSN, &lsn, sizeof(lsn_t));
+    if (rec_lsn_ == INVALID_LSN) {
+      rec_lsn_ = lsn;
+    }
+  }
+
+  /**
+   * @return the recovery LSN of the page: that of the first log record of a change since the page was last written
+   * back, from which redo has to start for it; INVALID_LSN if it has no logged change since
+   */
+  inline lsn_t GetRecLSN() { return rec_lsn_; }
 
  protected:
   static_assert(sizeof(page_id_t) == 4);
@@ -78,16 +123,23 @@ class Page {
   /** Zeroes out the data that is held within the page. */
   inline void ResetMemory() { memset(data_, OFFSET_PAGE_START, PAGE_SIZE); }
 
-  /** The actual data that is stored within a page. */
-  char data_[PAGE_SIZE]{};
-  /** The ID of this page. */
-  page_id_t page_id_ = INVALID_PAGE_ID;
-  /** The pin count of this page. */
-  int pin_count_ = 0;
+  /** The actual data that is stored within a page: a PAGE_SIZE frame in the buffer pool's arena. */
+  char *data_{nullptr};
+  /** The ID of this page. Atomic because buffer pool hits read it without the buffer pool latch. */
+  std::atomic<page_id_t> page_id_{INVALID_PAGE_ID};
+  /**
+   * The pin count of this page. Hits pin with a CAS and no latch; the buffer pool parks the count at -1 while the
+   * frame is free or being repurposed, which makes such CASes fail.
+   */
+  std::atomic<int> pin_count_{0};
   /** True if the page is dirty, i.e. it is different from its corresponding page on disk. */
-  bool is_dirty_ = false;
+  std::atomic<bool> is_dirty_{false};
+  /** The recovery LSN, set under the write latch with the page LSN and reset as the page is written back. */
+  std::atomic<lsn_t> rec_lsn_{INVALID_LSN};
   /** Page latch. */
-  ReaderWriterLatch rwlatch_;
+  ReaderWriterLatch rwlatch_{"page.latch"};
+  /** Bumped as the write latch is acquired and released, for optimistic reads: odd while a writer holds it. */
+  std::atomic<uint64_t> version_{0};
 };
 
 }  // namespace bustub
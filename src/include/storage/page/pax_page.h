@@ -0,0 +1,161 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// pax_page.h
+//
+// Identification: src/include/storage/page/pax_page.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstring>
+#include <vector>
+
+#include "catalog/schema.h"
+#include "common/rid.h"
+#include "storage/page/page.h"
+#include "storage/table/tuple.h"
+#include "type/value.h"
+
+namespace bustub {
+
+/**
+ * Where the minipages of a schema go in a PaxPage. All pages of a table share the layout, so it is computed once from
+ * the schema rather than stored in every page.
+ */
+struct PaxLayout {
+  /**
+   * The room a page keeps per row for the data of each VARCHAR column. VARCHAR columns do not declare a length, so it
+   * is only an estimate, which sets how many rows a page is laid out for; the data itself takes the room it needs.
+   */
+  static constexpr uint32_t VARCHAR_ESTIMATE = 32;
+
+  /** @return the layout of the pages of a table of the schema */
+  static PaxLayout For(const Schema &schema);
+
+  /** the number of rows a page has room for */
+  uint32_t capacity_;
+  /** the offset of each column's minipage, and the bytes each row takes in it */
+  std::vector<uint32_t> offsets_;
+  std::vector<uint32_t> widths_;
+  /** the end of the last minipage, where the free space for VARCHAR data starts */
+  uint32_t minipages_end_;
+};
+
+/**
+ * PAX page format: the rows of the page are split up by column, and each column is kept in a minipage of its own, so
+ * that a scan of a few columns reads just their minipages.
+ *  ----------------------------------------------------------------------------------------
+ *  | HEADER | DELETED BITMAP | MINIPAGE 0 | ... | MINIPAGE n-1 | ... FREE ... | VARCHAR DATA |
+ *  ----------------------------------------------------------------------------------------
+ *                                                                             ^
+ *                                                                             free space pointer
+ *
+ *  Header format (size in bytes):
+ *  ------------------------------------------------------------------------------------------
+ *  | PageId (4) | LSN (4) | PrevPageId (4) | NextPageId (4) | FreeSpacePointer (4) | RowCount (4) |
+ *  ------------------------------------------------------------------------------------------
+ *
+ * A minipage of a fixed-length column holds the serialized values one after the other. The minipage of a VARCHAR
+ * column holds the offset of each value's serialized form (size + data) in the VARCHAR data, which grows down from
+ * the end of the page. Rows are only ever appended; a delete sets the row's bit in the bitmap.
+ *
+ * The VARCHAR data of a column is dictionary encoded per page: a value that the column already has in the page is
+ * not stored again, and the row gets the offset of the stored one. The offsets are thus codes, and two rows of a
+ * column in a page have the same code iff their values are equal, which lets a scan compare or group the values of
+ * a page by their codes. Low-cardinality columns take up a few bytes of VARCHAR data per page only.
+ */
+class PaxPage : public Page {
+ public:
+  static constexpr size_t SIZE_PAX_PAGE_HEADER = 24;
+
+  /** Initialize the PaxPage header. */
+  void Init(page_id_t page_id, page_id_t prev_page_id);
+
+  /** @return the page ID of this page */
+  page_id_t GetPaxPageId() { return *reinterpret_cast<page_id_t *>(GetData()); }
+
+  /** @return the page ID of the next page of the table */
+  page_id_t GetNextPageId() { return *reinterpret_cast<page_id_t *>(GetData() + OFFSET_NEXT_PAGE_ID); }
+
+  /** Set the page id of the next page in the table. */
+  void SetNextPageId(page_id_t next_page_id) {
+    memcpy(GetData() + OFFSET_NEXT_PAGE_ID, &next_page_id, sizeof(page_id_t));
+  }
+
+  /** @return the number of rows in this page, deleted ones included */
+  uint32_t GetRowCount() { return *reinterpret_cast<uint32_t *>(GetData() + OFFSET_ROW_COUNT); }
+
+  /**
+   * Append a tuple to the page.
+   * @param tuple tuple to insert
+   * @param schema the schema of the tuple
+   * @param layout the layout of the schema
+   * @param[out] rid rid of the inserted tuple
+   * @return true if the insert is successful (i.e. there is enough space)
+   */
+  bool InsertTuple(const Tuple &tuple, const Schema &schema, const PaxLayout &layout, RID *rid);
+
+  /** Mark a row as deleted. @return true if the row exists and was not deleted yet */
+  bool MarkDelete(uint32_t row);
+
+  /** @return true if the row has been deleted */
+  bool IsDeleted(uint32_t row) { return (GetData()[SIZE_PAX_PAGE_HEADER + row / 8] & (1 << (row % 8))) != 0; }
+
+  /**
+   * Read a single column of a row.
+   * @param row the row, which has to be in the page
+   * @param column_idx the column
+   * @param schema the schema of the table
+   * @param layout the layout of the schema
+   * @return the value of the column
+   */
+  Value GetValue(uint32_t row, uint32_t column_idx, const Schema &schema, const PaxLayout &layout);
+
+  /**
+   * @return the code of the value of a VARCHAR column of a row in the page's dictionary of the column; nulls share a
+   * code too, so the caller leaves them out of comparisons
+   */
+  uint32_t GetCode(uint32_t row, uint32_t column_idx, const PaxLayout &layout) {
+    uint32_t code;
+    memcpy(&code, GetData() + layout.offsets_[column_idx] + row * layout.widths_[column_idx], sizeof(uint32_t));
+    return code;
+  }
+
+  /**
+   * Looks a value up in the page's dictionary of a VARCHAR column, e.g. the constant of a predicate, once per page.
+   * @param[out] code the code of the value, if the column has it in the page
+   * @return true if some row of the column, deleted or not, has the value in the page
+   */
+  bool FindCode(uint32_t column_idx, const Value &value, const PaxLayout &layout, uint32_t *code);
+
+  /**
+   * Read a whole row.
+   * @param rid rid of the row
+   * @param schema the schema of the table
+   * @param layout the layout of the schema
+   * @param[out] tuple the row, as a tuple of the schema
+   * @return true if the row exists and is not deleted
+   */
+  bool GetTuple(const RID &rid, const Schema &schema, const PaxLayout &layout, Tuple *tuple);
+
+ private:
+  static_assert(sizeof(page_id_t) == 4);
+
+  static constexpr size_t OFFSET_PREV_PAGE_ID = 8;
+  static constexpr size_t OFFSET_NEXT_PAGE_ID = 12;
+  static constexpr size_t OFFSET_FREE_SPACE = 16;
+  static constexpr size_t OFFSET_ROW_COUNT = 20;
+
+  uint32_t GetFreeSpacePointer() { return *reinterpret_cast<uint32_t *>(GetData() + OFFSET_FREE_SPACE); }
+  void SetFreeSpacePointer(uint32_t free_space_pointer) {
+    memcpy(GetData() + OFFSET_FREE_SPACE, &free_space_pointer, sizeof(uint32_t));
+  }
+  void SetRowCount(uint32_t row_count) { memcpy(GetData() + OFFSET_ROW_COUNT, &row_count, sizeof(uint32_t)); }
+};
+
+}  // namespace bustub
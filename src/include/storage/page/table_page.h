@@ -13,6 +13,7 @@
 #pragma once
 
 #include <cstring>
+#include <vector>
 
 #include "common/rid.h"
 #include "concurrency/lock_manager.h"
@@ -40,6 +41,12 @@ namespace bustub {
  *  | TupleCount (4) | Tuple_1 offset (4) | Tuple_1 size (4) | ... |
  *  ----------------------------------------------------------------
  *
+ * A delete empties the slot of its tuple and leaves the bytes of the tuple behind as a hole among the inserted tuples.
+ * Compact squeezes the holes out, and the empty slots at the end of the slot array; an insert or update that only
+ * fits with the holes gone compacts the page first.
+ *
+ * The changes made with a transaction are locked and logged while logging is enabled; those made without one, as redo
+ * makes them, are neither.
  */
 class TablePage : public Page {
  public:
@@ -79,9 +86,44 @@ class TablePage : public Page {
    * @param txn transaction performing the insert
    * @param lock_manager the lock manager
    * @param log_manager the log manager
+   * @param oid the table of the page, whose lock may cover the record's
    * @return true if the insert is successful (i.e. there is enough space)
    */
-  bool InsertTuple(const Tuple &tuple, RID *rid, Transaction *txn, LockManager *lock_manager, LogManager *log_manager);
+  bool InsertTuple(const Tuple &tuple, RID *rid, Transaction *txn, LockManager *lock_manager, LogManager *log_manager,
+                   table_oid_t oid = INVALID_TABLE_OID);
+
+  /**
+   * Insert as many tuples of a batch as fit into the page, in order, under a single log record.
+   * @param tuples the batch
+   * @param begin the first tuple of the batch to insert
+   * @param[out] rids the rids of the inserted tuples are appended here
+   * @param txn transaction performing the insert
+   * @param lock_manager the lock manager
+   * @param log_manager the log manager
+   * @param oid the table of the page, whose lock may cover the record's
+   * @return the number of tuples that were inserted
+   */
+  size_t InsertTuples(const std::vector<Tuple> &tuples, size_t begin, std::vector<RID> *rids, Transaction *txn,
+                      LockManager *lock_manager, LogManager *log_manager, table_oid_t oid = INVALID_TABLE_OID);
+
+  /** @return the size of the largest tuple that InsertTuple can fit into this page, compacting it if need be */
+  uint32_t GetMaxInsertSize() {
+    uint32_t free_space = GetFreeSpaceRemaining() + GetDeadSize();
+    return free_space > SIZE_TUPLE ? free_space - SIZE_TUPLE : 0;
+  }
+
+  /** @return the number of bytes Compact would reclaim */
+  uint32_t GetReclaimableSize();
+
+  /**
+   * Move the tuples of the page together, and drop the empty slots at the end of the slot array. The rids of the
+   * tuples that are left do not change.
+   * @return the number of bytes reclaimed
+   */
+  uint32_t Compact();
+
+  /** @return true if the page holds no tuples, deleted or not */
+  bool IsEmpty();
 
   /**
    * Mark a tuple as deleted. This does not actually delete the tuple.
@@ -89,9 +131,11 @@ class TablePage : public Page {
    * @param txn transaction performing the delete
    * @param lock_manager the lock manager
    * @param log_manager the log manager
+   * @param oid the table of the page, whose lock may cover the record's
    * @return true if marking the tuple as deleted is successful (i.e the tuple exists)
    */
-  bool MarkDelete(const RID &rid, Transaction *txn, LockManager *lock_manager, LogManager *log_manager);
+  bool MarkDelete(const RID &rid, Transaction *txn, LockManager *lock_manager, LogManager *log_manager,
+                  table_oid_t oid = INVALID_TABLE_OID);
 
   /**
    * Update a tuple.
@@ -101,13 +145,17 @@ class TablePage : public Page {
    * @param txn transaction performing the update
    * @param lock_manager the lock manager
    * @param log_manager the log manager
+   * @param oid the table of the page, whose lock may cover the record's
    * @return true if updating the tuple succeeded
    */
   bool UpdateTuple(const Tuple &new_tuple, Tuple *old_tuple, const RID &rid, Transaction *txn,
-                   LockManager *lock_manager, LogManager *log_manager);
+                   LockManager *lock_manager, LogManager *log_manager, table_oid_t oid = INVALID_TABLE_OID);
 
-  /** To be called on commit or abort. Actually perform the delete or rollback an insert. */
-  void ApplyDelete(const RID &rid, Transaction *txn, LogManager *log_manager);
+  /**
+   * To be called on commit or abort. Actually perform the delete or rollback an insert.
+   * @param[out] deleted if not null, a copy of the tuple that is deleted
+   */
+  void ApplyDelete(const RID &rid, Transaction *txn, LogManager *log_manager, Tuple *deleted = nullptr);
 
   /** To be called on abort. Rollback a delete, i.e. this reverses a MarkDelete. */
   void RollbackDelete(const RID &rid, Transaction *txn, LogManager *log_manager);
@@ -118,9 +166,23 @@ class TablePage : public Page {
    * @param[out] tuple the tuple that was read
    * @param txn transaction performing the read
    * @param lock_manager the lock manager
+   * @param oid the table of the page, whose lock may cover the record's
+   * @return true if the read is successful (i.e. the tuple exists)
+   */
+  bool GetTuple(const RID &rid, Tuple *tuple, Transaction *txn, LockManager *lock_manager,
+                table_oid_t oid = INVALID_TABLE_OID);
+
+  /**
+   * Read a tuple from a table without copying it, the way GetTuple does.
+   * @param rid rid of the tuple to read
+   * @param[out] tuple a view of the tuple in this page, good for as long as the page stays pinned and latched
+   * @param txn transaction performing the read
+   * @param lock_manager the lock manager
+   * @param oid the table of the page, whose lock may cover the record's
    * @return true if the read is successful (i.e. the tuple exists)
    */
-  bool GetTuple(const RID &rid, Tuple *tuple, Transaction *txn, LockManager *lock_manager);
+  bool GetTupleView(const RID &rid, Tuple *tuple, Transaction *txn, LockManager *lock_manager,
+                    table_oid_t oid = INVALID_TABLE_OID);
 
   /** @return the rid of the first tuple in this page */
 
@@ -137,9 +199,35 @@ class TablePage : public Page {
    */
   bool GetNextTupleRid(const RID &cur_rid, RID *next_rid);
 
+  /**
+   * Read a tuple from the page as it is, without locking it, for the versions of the tuple MVCC keeps.
+   * @param rid rid of the tuple to read
+   * @param[out] tuple a view of the tuple in this page, as for GetTupleView
+   * @param[out] deleted whether the tuple is marked as deleted
+   * @return false if the slot holds no tuple
+   */
+  bool ReadTuple(const RID &rid, Tuple *tuple, bool *deleted);
+
+  /**
+   * @note returned tuple count may be an overestimate because some slots may be empty
+   * @return at least the number of tuples in this page
+   */
+  uint32_t GetTupleCount() { return *reinterpret_cast<uint32_t *>(GetData() + OFFSET_TUPLE_COUNT); }
+
  private:
   static_assert(sizeof(page_id_t) == 4);
 
+  /**
+   * Copy a tuple into the page, without logging it. With logging on, the tuple is locked for txn, in a slot that no
+   * other transaction locks, see LockManager::LockNewTuple.
+   * @param tuple tuple to insert
+   * @param first_slot the first slot that may be free
+   * @param[out] rid rid of the inserted tuple
+   * @return true if there is enough space, and a slot to lock
+   */
+  bool PlaceTuple(const Tuple &tuple, uint32_t first_slot, RID *rid, Transaction *txn, LockManager *lock_manager,
+                  table_oid_t oid);
+
   static constexpr size_t SIZE_TABLE_PAGE_HEADER = 24;
   static constexpr size_t SIZE_TUPLE = 8;
   static constexpr size_t OFFSET_PREV_PAGE_ID = 8;
@@ -157,12 +245,6 @@ class TablePage : public Page {
     memcpy(GetData() + OFFSET_FREE_SPACE, &free_space_pointer, sizeof(uint32_t));
   }
 
-  /**
-   * @note returned tuple count may be an overestimate because some slots may be empty
-   * @return at least the number of tuples in this page
-   */
-  uint32_t GetTupleCount() { return *reinterpret_cast<uint32_t *>(GetData() + OFFSET_TUPLE_COUNT); }
-
   /** Set the number of tuples in this page. */
   void SetTupleCount(uint32_t tuple_count) { memcpy(GetData() + OFFSET_TUPLE_COUNT, &tuple_count, sizeof(uint32_t)); }
 
@@ -170,6 +252,12 @@ class TablePage : public Page {
     return GetFreeSpacePointer() - SIZE_TABLE_PAGE_HEADER - SIZE_TUPLE * GetTupleCount();
   }
 
+  /** @return the number of bytes of the holes that deletes left among the inserted tuples */
+  uint32_t GetDeadSize();
+
+  /** @return the number of empty slots at the end of the slot array */
+  uint32_t GetTrailingEmptySlots();
+
   /** @return tuple offset at slot slot_num */
   uint32_t GetTupleOffsetAtSlot(uint32_t slot_num) {
     return *reinterpret_cast<uint32_t *>(GetData() + OFFSET_TUPLE_OFFSET + SIZE_TUPLE * slot_num);
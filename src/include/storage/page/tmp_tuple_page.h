@@ -1,33 +1,76 @@
 #pragma once
 
+#include <cstring>
+#include <vector>
+
 #include "storage/page/page.h"
 #include "storage/table/tmp_tuple.h"
 #include "storage/table/tuple.h"
 
 namespace bustub {
 
-// To pass the test cases for this class, you must follow the existing TmpTuplePage format and implement the
-// existing functions exactly as they are! It may be helpful to look at TablePage.
-// Remember that this task is optional, you get full credit if you finish the next task.
-
 /**
  * TmpTuplePage format:
  *
  * Sizes are in bytes.
  * | PageId (4) | LSN (4) | FreeSpace (4) | (free space) | TupleSize2 | TupleData2 | TupleSize1 | TupleData1 |
  *
- * We choose this format because DeserializeExpression expects to read Size followed by Data.
+ * We choose this format because DeserializeExpression expects to read Size followed by Data. FreeSpace is the offset
+ * of the last tuple inserted, so the tuples run from it to the end of the page, the newest first.
  */
 class TmpTuplePage : public Page {
  public:
-  void Init(page_id_t page_id, uint32_t page_size) {}
+  void Init(page_id_t page_id, uint32_t page_size) {
+    memcpy(GetData() + OFFSET_PAGE_ID, &page_id, sizeof(page_id_t));
+    SetLSN(INVALID_LSN);
+    SetFreeSpacePointer(page_size);
+  }
+
+  page_id_t GetTablePageId() { return *reinterpret_cast<page_id_t *>(GetData() + OFFSET_PAGE_ID); }
 
-  page_id_t GetTablePageId() { return INVALID_PAGE_ID; }
+  /**
+   * Inserts a tuple at the end of the free space.
+   * @param[out] out where the tuple is
+   * @return false if the page does not have room for the tuple
+   */
+  bool Insert(const Tuple &tuple, TmpTuple *out) {
+    uint32_t size = sizeof(uint32_t) + tuple.GetLength();
+    uint32_t free_space_pointer = GetFreeSpacePointer();
+    if (free_space_pointer < SIZE_HEADER + size) {
+      return false;
+    }
+    free_space_pointer -= size;
+    tuple.SerializeTo(GetData() + free_space_pointer);
+    SetFreeSpacePointer(free_space_pointer);
+    *out = TmpTuple(GetTablePageId(), free_space_pointer);
+    return true;
+  }
 
-  bool Insert(const Tuple &tuple, TmpTuple *out) { return false; }
+  /** @param[out] tuple the tuple that Insert put where tmp_tuple is */
+  void Get(const TmpTuple &tmp_tuple, Tuple *tuple) { tuple->DeserializeFrom(GetData() + tmp_tuple.GetOffset()); }
+
+  /** Appends the tuples of a page of page_size bytes to the vector, the newest first. */
+  void GetTuples(uint32_t page_size, std::vector<Tuple> *tuples) {
+    for (uint32_t offset = GetFreeSpacePointer(); offset < page_size;) {
+      tuples->emplace_back();
+      Get(TmpTuple(GetTablePageId(), offset), &tuples->back());
+      offset += sizeof(uint32_t) + tuples->back().GetLength();
+    }
+  }
+
+  /** @return the largest tuple an empty page of page_size bytes has room for */
+  static uint32_t MaxTupleSize(uint32_t page_size) { return page_size - SIZE_HEADER - sizeof(uint32_t); }
 
  private:
   static_assert(sizeof(page_id_t) == 4);
+  static constexpr size_t OFFSET_PAGE_ID = 0;
+  static constexpr size_t OFFSET_FREE_SPACE = 8;
+  static constexpr size_t SIZE_HEADER = 12;
+
+  uint32_t GetFreeSpacePointer() { return *reinterpret_cast<uint32_t *>(GetData() + OFFSET_FREE_SPACE); }
+  void SetFreeSpacePointer(uint32_t free_space_pointer) {
+    memcpy(GetData() + OFFSET_FREE_SPACE, &free_space_pointer, sizeof(uint32_t));
+  }
 };
 
 }  // namespace bustub
@@ -0,0 +1,166 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// clustered_table.h
+//
+// Identification: src/include/storage/table/clustered_table.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "catalog/schema.h"
+#include "common/rid.h"
+#include "concurrency/transaction.h"
+#include "storage/index/b_plus_tree.h"
+#include "storage/index/inline_row.h"
+#include "storage/table/tuple.h"
+#include "storage/table/zone_map.h"
+
+namespace bustub {
+
+/**
+ * ClusteredTable is an index-organized table: its rows are kept in the leaves of a B+ tree, by the value of an integer
+ * primary key, rather than in a heap that an index points into. A read of a row by its key is a lookup in the tree,
+ * and a scan of a range of keys reads just the leaves of the range, in key order, with no heap page to fetch for
+ * either. The keys are unique; a row whose key is in the table already is not inserted.
+ *
+ * A row's RID is its key (see RidOf), as a row moves between leaves when they split or merge, so that the entries of
+ * the secondary indexes of the table stay valid until the key changes, and a lookup through them is one in the tree.
+ *
+ * The rows are InlineRows of the leaves, so a tuple takes MAX_TUPLE_SIZE bytes at most. As with a PaxTableHeap, the
+ * changes are neither logged nor undone when the transaction that made them aborts, and the rows are not locked; an
+ * update is a delete and an insert, between which a concurrent reader does not see the row.
+ */
+class ClusteredTable {
+ public:
+  using Row = InlineRow<256>;
+  using Tree = BPlusTree<GenericKey<8>, Row, GenericComparator<8>>;
+
+  /** The longest tuple the table holds */
+  static constexpr uint32_t MAX_TUPLE_SIZE = Row::MAX_TUPLE_SIZE;
+
+  /**
+   * Creates the tree of a table, which is empty until the first insert, or Reopen.
+   * @param schema the schema of the table, which has to outlive it
+   * @param key_idx the column of the primary key, of an integer type
+   * @param oid the oid of the table in the catalog, which names the tree
+   */
+  ClusteredTable(BufferPoolManager *buffer_pool_manager, const Schema *schema, uint32_t key_idx, table_oid_t oid);
+
+  /** Reattaches the table to the tree it had before, see BPlusTree::Reopen. @return false if it had none */
+  bool Reopen() { return tree_.Reopen(); }
+
+  /** @return true if a column of the type can be the primary key */
+  static bool IsKeyType(TypeId type) {
+    return type == TypeId::TINYINT || type == TypeId::SMALLINT || type == TypeId::INTEGER || type == TypeId::BIGINT;
+  }
+
+  /** @return the RID of the row of a key */
+  static RID RidOf(int64_t key) { return RID(key); }
+
+  /** @return the column of the primary key */
+  uint32_t GetKeyIdx() const { return key_idx_; }
+
+  /**
+   * Insert a tuple into the table.
+   * @param tuple tuple to insert, of a key that is not NULL
+   * @param[out] rid the rid of the inserted tuple
+   * @param txn the transaction performing the insert
+   * @return true iff the insert is successful, i.e. the tuple fits and no row has its key
+   */
+  bool InsertTuple(const Tuple &tuple, RID *rid, Transaction *txn);
+
+  /**
+   * Delete a tuple.
+   * @param rid rid of the tuple to delete
+   * @param txn the transaction performing the delete
+   * @return true iff the delete is successful (i.e the tuple exists)
+   */
+  bool MarkDelete(const RID &rid, Transaction *txn);
+
+  /**
+   * Replaces a row of the table, which moves to the key of the new tuple.
+   * @param tuple the new tuple
+   * @param rid the rid of the row to replace
+   * @param[out] new_rid the rid of the new tuple, that of its key
+   * @param txn the transaction performing the update
+   * @return true iff the update is successful, i.e. the row exists, the tuple fits and no other row has its key
+   */
+  bool UpdateTuple(const Tuple &tuple, const RID &rid, RID *new_rid, Transaction *txn);
+
+  /**
+   * Read a tuple from the table, by a lookup of its key.
+   * @param rid rid of the tuple to read
+   * @param[out] tuple a copy of the row
+   * @param txn transaction performing the read
+   * @return true if the read was successful (i.e. the tuple exists)
+   */
+  bool GetTuple(const RID &rid, Tuple *tuple, Transaction *txn);
+
+  /** @return the tree the rows are kept in */
+  Tree *GetTree() { return &tree_; }
+
+  /** @return the key of a value of the key column, std::nullopt if it is NULL */
+  static std::optional<int64_t> KeyOf(const Value &value);
+
+  /** @return the tree key of an integer key */
+  static GenericKey<8> TreeKey(int64_t key) {
+    GenericKey<8> tree_key;
+    tree_key.SetFromInteger(key);
+    return tree_key;
+  }
+
+ private:
+  const Schema *schema_;
+  uint32_t key_idx_;
+  /** The schema of the tree's keys, a single BIGINT, which the comparator keeps a pointer to */
+  Schema key_schema_;
+  Tree tree_;
+};
+
+/**
+ * ClusteredTableScanner reads the rows of a ClusteredTable in key order, from the first key of a range to the last.
+ * It copies out the rows of a leaf at a time and lets go of the leaf before it hands out any of them, so that the
+ * caller may change the table between rows, as a delete of the rows it scans does; a leaf is looked up again by the
+ * key after the last row of the one before.
+ */
+class ClusteredTableScanner {
+ public:
+  /**
+   * @param table the table to scan
+   * @param range a range of a column that the rows are after, which the scan reads just the keys of if it is of the
+   * primary key; the bounds are inclusive
+   */
+  explicit ClusteredTableScanner(ClusteredTable *table, const std::optional<ZoneRange> &range = std::nullopt);
+
+  /**
+   * Reads the next row of the range.
+   * @param[out] tuple a view of the row, valid until the next call
+   * @return false once there are no more rows
+   */
+  bool Next(Tuple *tuple);
+
+ private:
+  /** Copies out the rows of the leaf of next_key_ on. @return false if there are none left */
+  bool ReadLeaf();
+
+  ClusteredTable *table_;
+  /** The first key not read yet, and the last key of the range */
+  int64_t next_key_;
+  int64_t max_key_;
+  bool done_{false};
+  std::vector<std::pair<GenericKey<8>, ClusteredTable::Row>> rows_;
+  size_t position_{0};
+};
+
+}  // namespace bustub
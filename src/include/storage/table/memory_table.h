@@ -0,0 +1,102 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// memory_table.h
+//
+// Identification: src/include/storage/table/memory_table.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <shared_mutex>
+#include <vector>
+
+#include "common/rid.h"
+#include "concurrency/transaction.h"
+#include "storage/table/tuple.h"
+
+namespace bustub {
+
+/**
+ * MemoryTable is a table whose rows are on the heap rather than in pages, for small tables that are read far more
+ * often than they are written, such as the inner tables of index joins: a read is a view of the row, with no page to
+ * fetch, latch and unpin. Each row is allocated once and stays where it is until the table is destroyed, so a view of
+ * it stays valid even once it is deleted. The rows are kept in chunks of ROWS_PER_CHUNK, and a row's RID is its chunk
+ * and its place in it. Rows are appended and deleted in place; there are no updates.
+ *
+ * As with a PaxTableHeap, the changes are neither logged nor undone when the transaction that made them aborts, and
+ * the rows are gone once the process ends; the catalog does not write in-memory tables out.
+ */
+class MemoryTable {
+ public:
+  /** The rows a chunk holds */
+  static constexpr uint32_t ROWS_PER_CHUNK = 1024;
+
+  MemoryTable() = default;
+
+  /**
+   * Insert a tuple into the table.
+   * @param tuple tuple to insert
+   * @param[out] rid the rid of the inserted tuple
+   * @param txn the transaction performing the insert
+   * @return true iff the insert is successful
+   */
+  bool InsertTuple(const Tuple &tuple, RID *rid, Transaction *txn);
+
+  /**
+   * Delete a tuple.
+   * @param rid rid of the tuple to delete
+   * @param txn the transaction performing the delete
+   * @return true iff the delete is successful (i.e the tuple exists)
+   */
+  bool MarkDelete(const RID &rid, Transaction *txn);
+
+  /**
+   * Read a tuple from the table.
+   * @param rid rid of the tuple to read
+   * @param[out] tuple a view of the row, valid for as long as the table is
+   * @param txn transaction performing the read
+   * @return true if the read was successful (i.e. the tuple exists)
+   */
+  bool GetTuple(const RID &rid, Tuple *tuple, Transaction *txn);
+
+  /**
+   * Reads the first row at or after position that is not deleted, as a scan does.
+   * @param[in,out] position the place of the row to read from, moved past the row read
+   * @param[out] tuple a view of the row
+   * @return false once there are no more rows
+   */
+  bool Next(uint64_t *position, Tuple *tuple);
+
+  /** @return the rows inserted, deleted ones included */
+  uint64_t GetRowCount() const { return row_count_.load(std::memory_order_acquire); }
+
+ private:
+  struct Row {
+    std::unique_ptr<char[]> data_;
+    uint32_t size_{0};
+    std::atomic<bool> deleted_{false};
+  };
+
+  static RID RidOf(uint64_t position) {
+    return RID(static_cast<page_id_t>(position / ROWS_PER_CHUNK), static_cast<uint32_t>(position % ROWS_PER_CHUNK));
+  }
+
+  /** @return the row at a position below the row count, under the latch */
+  Row &RowAt(uint64_t position) { return chunks_[position / ROWS_PER_CHUNK][position % ROWS_PER_CHUNK]; }
+
+  /** Held shared to read the chunks, and exclusively to append a row, which may add one */
+  std::shared_mutex latch_;
+  std::vector<std::unique_ptr<Row[]>> chunks_;
+  /** The rows appended, which a row is counted in once it is written */
+  std::atomic<uint64_t> row_count_{0};
+};
+
+}  // namespace bustub
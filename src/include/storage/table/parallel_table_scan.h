@@ -0,0 +1,96 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// parallel_table_scan.h
+//
+// Identification: src/include/storage/table/parallel_table_scan.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <utility>
+#include <vector>
+
+#include "common/config.h"
+#include "common/macros.h"
+#include "common/util/morsel_queue.h"
+#include "storage/table/table_heap.h"
+
+namespace bustub {
+
+/**
+ * ParallelTableScan splits a scan of a TableHeap into morsels of consecutive pages, which worker threads claim through
+ * a MorselQueue until none are left: each worker the morsels of a stretch of the table of its own first, and then
+ * those it steals from the others; a worker scans the pages of its morsel with a TablePageScanner of its own. No two
+ * morsels share a page, and together they cover the pages the table had when the scan was created, in the order of
+ * its list; pages linked after that are not scanned. A scan of a single worker hands out the morsels in order.
+ *
+ * Given the NUMA nodes of its workers, a scan of a table whose buffer pool places pages on nodes (see
+ * ParallelBufferPoolManager) makes its morsels of the pages of one node each, in the order of the list, and hands
+ * those of a node to the workers on it first, so that a worker mostly reads memory of its own node. It falls back to
+ * morsels of consecutive pages when a node that has pages of the table has no workers.
+ *
+ *   ParallelTableScan scan(table, ParallelTableScan::PAGES_PER_MORSEL, nullptr, num_workers);
+ *   // in worker w
+ *   std::vector<page_id_t> morsel;
+ *   while (scan.NextMorsel(&morsel, w)) {
+ *     TablePageScanner scanner(table, txn, morsel, strategy);
+ *     ...
+ *   }
+ */
+class ParallelTableScan {
+ public:
+  /**
+   * The pages of a morsel; a quarter of an extent, so that a morsel is read sequentially and a table of a few
+   * extents still keeps several workers busy.
+   */
+  static constexpr size_t PAGES_PER_MORSEL = TABLE_HEAP_EXTENT_SIZE / 4;
+
+  /**
+   * @param table_heap the table to scan
+   * @param pages_per_morsel the pages of each morsel, but the last
+   * @param strategy the access strategy of the walk over the table that finds its pages, if no insert has run it yet
+   * @param num_workers the number of workers that the morsels are split between
+   * @param worker_nodes the NUMA node of each worker, -1 if it is not known; empty if none are
+   */
+  explicit ParallelTableScan(TableHeap *table_heap, size_t pages_per_morsel = PAGES_PER_MORSEL,
+                             BufferAccessStrategy *strategy = nullptr, size_t num_workers = 1,
+                             const std::vector<int> &worker_nodes = {});
+
+  DISALLOW_COPY_AND_MOVE(ParallelTableScan);
+
+  /**
+   * Claims the next morsel of a worker; safe to call from many threads at once.
+   * @param[out] page_ids the pages of the morsel, in the order of the table
+   * @param worker the worker that claims it
+   * @return false once every morsel has been claimed
+   */
+  bool NextMorsel(std::vector<page_id_t> *page_ids, size_t worker = 0);
+
+  /** @return the number of morsels of the scan */
+  size_t GetMorselCount() const { return morsel_starts_.size() - 1; }
+
+  /** @return the pages the morsels cover, one morsel after the other */
+  const std::vector<page_id_t> &GetPageIds() const { return page_ids_; }
+
+ private:
+  /**
+   * Splits page_ids_ into morsels, of the pages of a node each if the workers can be given those of their nodes.
+   * @return the morsels each worker starts out with
+   */
+  std::vector<std::pair<size_t, size_t>> SplitMorsels(BufferPoolManager *bpm, size_t num_workers,
+                                                      const std::vector<int> &worker_nodes);
+
+  const size_t pages_per_morsel_;
+  /** The pages of the morsels, one morsel after the other */
+  std::vector<page_id_t> page_ids_;
+  /** Where each morsel starts in page_ids_, and then its end */
+  std::vector<size_t> morsel_starts_;
+  MorselQueue morsels_;
+};
+
+}  // namespace bustub
@@ -0,0 +1,151 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// partitioned_table.h
+//
+// Identification: src/include/storage/table/partitioned_table.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <algorithm>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "catalog/schema.h"
+#include "storage/table/table_heap.h"
+#include "storage/table/zone_map.h"
+
+namespace bustub {
+
+/** How the rows of a partitioned table are spread over its partitions, by the value of their partition key. */
+enum class PartitionMethod { HASH, RANGE };
+
+/**
+ * The partitions of a table and the column that picks a row's. A HASH scheme spreads the rows evenly over
+ * num_partitions_ by the hash of the key. A RANGE scheme has an ascending list of bounds that split the keys into one
+ * more partition than there are bounds: partition i holds the keys from bounds_[i - 1] on and below bounds_[i], the
+ * first one all the keys below bounds_[0] and the last one all those from the last bound on. A NULL key is in the
+ * first partition either way.
+ */
+struct PartitionScheme {
+  PartitionMethod method_{PartitionMethod::HASH};
+  uint32_t key_idx_{0};
+  size_t num_partitions_{1};
+  std::vector<Value> bounds_;
+
+  /** @return a scheme of num_partitions partitions by the hash of the column at key_idx */
+  static PartitionScheme Hash(uint32_t key_idx, size_t num_partitions) {
+    return {PartitionMethod::HASH, key_idx, std::max<size_t>(num_partitions, 1), {}};
+  }
+
+  /** @return a scheme of the ranges of the column at key_idx that the ascending bounds split its values into */
+  static PartitionScheme Range(uint32_t key_idx, std::vector<Value> bounds) {
+    size_t num_partitions = bounds.size() + 1;
+    return {PartitionMethod::RANGE, key_idx, num_partitions, std::move(bounds)};
+  }
+};
+
+/**
+ * PartitionedTable is a table whose rows are kept in a TableHeap per partition, each of pages of its own, which a
+ * row goes to by its partition key (see PartitionScheme). A scan whose predicate bounds the key reads only the
+ * partitions the bound does not rule out, and the partitions can be scanned apart, each by a worker of its own.
+ *
+ * The heaps share the oid of the table, under which their rows are locked. A RID names a page of one of the heaps,
+ * which HeapOf finds from a map of the pages of every heap; the map is refreshed from the heaps when a page is not in
+ * it yet, i.e. once per page that an insert added since the last time.
+ *
+ * A partition can be truncated as a whole, which frees its pages rather than deleting its rows one by one, e.g. the
+ * oldest range of a table of a time series that is past its retention. It has to be the only thing that uses the
+ * partition while it does: any other transaction that wrote to the partition has ended, and no scan of it is open.
+ * The writes to it of the transaction that truncates it go with it, and are neither applied nor undone at its end.
+ */
+class PartitionedTable {
+ public:
+  /**
+   * Creates the heaps of the partitions of a new table.
+   * @param schema the schema of the table, which has to outlive it
+   * @param scheme the partitions of the table
+   * @param oid the oid of the table in the catalog
+   * @param txn the transaction that creates the table
+   */
+  PartitionedTable(BufferPoolManager *buffer_pool_manager, LockManager *lock_manager, LogManager *log_manager,
+                   const Schema *schema, PartitionScheme scheme, table_oid_t oid, Transaction *txn);
+
+  /**
+   * Reattaches the heaps of the partitions of a table that was created before.
+   * @param first_page_ids the first page of the heap of each partition, in order
+   */
+  PartitionedTable(BufferPoolManager *buffer_pool_manager, LockManager *lock_manager, LogManager *log_manager,
+                   const Schema *schema, PartitionScheme scheme, table_oid_t oid,
+                   const std::vector<page_id_t> &first_page_ids);
+
+  /** @return the partitions of the table */
+  const PartitionScheme &GetScheme() const { return scheme_; }
+
+  /** @return the number of partitions */
+  size_t GetPartitionCount() const { return partitions_.size(); }
+
+  /** @return the heap of a partition */
+  TableHeap *GetPartition(size_t partition) const { return partitions_[partition].get(); }
+
+  /** @return the heaps of all the partitions, in order */
+  std::vector<TableHeap *> GetPartitions() const;
+
+  /** @return the partition of a key */
+  size_t PartitionOf(const Value &key) const;
+
+  /** @return the partition of a row of the table */
+  size_t PartitionOf(const Tuple &tuple) const { return PartitionOf(tuple.GetValue(schema_, scheme_.key_idx_)); }
+
+  /**
+   * @param range a range of a column that the rows a scan is after are within
+   * @return the partitions that may hold such rows, in order: those of the range if it is of the partition key, of
+   * an equal key if the scheme is HASH, and all of them otherwise
+   */
+  std::vector<size_t> PartitionsOf(const ZoneRange &range) const;
+
+  /** @return the heap of the partition that a row is in, nullptr if its page is of none of them */
+  TableHeap *HeapOf(const RID &rid);
+
+  /**
+   * Read a tuple from the heap of its partition, as TableHeap::GetTuple does.
+   * @return true if the read was successful (i.e. the tuple exists)
+   */
+  bool GetTuple(const RID &rid, Tuple *tuple, Transaction *txn);
+
+  /**
+   * Empties a partition, whose heap is replaced by a new one, and frees the pages of the old heap and the overflow
+   * chains of its toasted values.
+   * @param partition the partition to truncate
+   * @param txn the transaction that truncates it
+   */
+  void Truncate(size_t partition, Transaction *txn);
+
+ private:
+  /** @return a heap for a partition, a new one if first_page_id is INVALID_PAGE_ID */
+  std::unique_ptr<TableHeap> MakeHeap(page_id_t first_page_id, Transaction *txn);
+
+  BufferPoolManager *buffer_pool_manager_;
+  LockManager *lock_manager_;
+  LogManager *log_manager_;
+  const Schema *schema_;
+  PartitionScheme scheme_;
+  table_oid_t oid_;
+  std::vector<std::unique_ptr<TableHeap>> partitions_;
+
+  /** Guards page_partitions_ */
+  std::mutex page_latch_;
+  /** The partition of each page of the heaps, as of the last refresh */
+  std::unordered_map<page_id_t, size_t> page_partitions_;
+};
+
+}  // namespace bustub
@@ -0,0 +1,73 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// pax_column_scanner.h
+//
+// Identification: src/include/storage/table/pax_column_scanner.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <vector>
+
+#include "buffer/buffer_access_strategy.h"
+#include "common/macros.h"
+#include "storage/page/pax_page.h"
+#include "type/value.h"
+
+namespace bustub {
+
+class PaxTableHeap;
+
+/**
+ * PaxColumnScanner scans some of the columns of a PaxTableHeap: it reads just their minipages, and never builds the
+ * rest of a row. The page it is at stays pinned until the scanner moves past it, and is read latched within Next only.
+ */
+class PaxColumnScanner {
+ public:
+  /**
+   * @param table_heap the table to scan
+   * @param column_idxs the columns to read, by their index in the schema of the table
+   * @param strategy the access strategy the scan reads pages through, nullptr for the shared pool
+   */
+  PaxColumnScanner(PaxTableHeap *table_heap, std::vector<uint32_t> column_idxs,
+                   BufferAccessStrategy *strategy = nullptr);
+
+  ~PaxColumnScanner();
+
+  DISALLOW_COPY_AND_MOVE(PaxColumnScanner);
+
+  /**
+   * Moves on to the next row that is not deleted.
+   * @param[out] rid the rid of the row
+   * @param[out] values the values of the columns of the scan, in the order they were given in
+   * @return false at the end of the table
+   */
+  bool Next(RID *rid, std::vector<Value> *values);
+
+  /**
+   * Moves on to the next row that is not deleted, like Next, and also hands out the codes of its VARCHAR values in
+   * the dictionaries of their page (see PaxPage). Codes of rows of the same page, which rid tells, compare like the
+   * values they stand for, so that e.g. a group-by can map each code of a page to its group once.
+   * @param[out] codes the codes of the columns of the scan, in the order they were given in; 0 for inlined columns
+   */
+  bool Next(RID *rid, std::vector<Value> *values, std::vector<uint32_t> *codes);
+
+ private:
+  /** Unpins the current page and pins the next one, or none at the end of the table. */
+  void MoveToPage(page_id_t page_id);
+
+  PaxTableHeap *table_heap_;
+  const std::vector<uint32_t> column_idxs_;
+  BufferAccessStrategy *strategy_;
+  /** the page the scanner is at, pinned; nullptr at the end of the table */
+  PaxPage *page_{nullptr};
+  /** the row of page_ to look at next */
+  uint32_t row_{0};
+};
+
+}  // namespace bustub
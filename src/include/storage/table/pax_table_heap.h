@@ -0,0 +1,95 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// pax_table_heap.h
+//
+// Identification: src/include/storage/table/pax_table_heap.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <mutex>  // NOLINT
+
+#include "buffer/buffer_pool_manager.h"
+#include "catalog/schema.h"
+#include "concurrency/transaction.h"
+#include "storage/page/pax_page.h"
+#include "storage/table/tuple.h"
+
+namespace bustub {
+
+/**
+ * PaxTableHeap is a table whose pages are PaxPages: a doubly-linked list of pages in which every column of the rows
+ * of a page is kept in a minipage of its own, for scans that read a few columns of wide tables (see
+ * PaxColumnScanner). Rows are appended to the last page and deleted in place; there are no updates.
+ *
+ * A PAX table is meant for data that is loaded and then analyzed, and its changes are neither logged nor undone when
+ * the transaction that made them aborts.
+ */
+class PaxTableHeap {
+  friend class PaxColumnScanner;
+
+ public:
+  /**
+   * Create a table heap. (create table)
+   * @param buffer_pool_manager the buffer pool manager
+   * @param schema the schema of the table, which has to outlive the heap
+   */
+  PaxTableHeap(BufferPoolManager *buffer_pool_manager, const Schema *schema);
+
+  /**
+   * Open a table heap.
+   * @param buffer_pool_manager the buffer pool manager
+   * @param schema the schema of the table, which has to outlive the heap
+   * @param first_page_id the id of the first page
+   */
+  PaxTableHeap(BufferPoolManager *buffer_pool_manager, const Schema *schema, page_id_t first_page_id);
+
+  /**
+   * Insert a tuple into the table.
+   * @param tuple tuple to insert, of the schema of the table
+   * @param[out] rid the rid of the inserted tuple
+   * @param txn the transaction performing the insert
+   * @param strategy the access strategy of a bulk load, nullptr to go through the shared pool
+   * @return true iff the insert is successful
+   */
+  bool InsertTuple(const Tuple &tuple, RID *rid, Transaction *txn, BufferAccessStrategy *strategy = nullptr);
+
+  /**
+   * Delete a tuple.
+   * @param rid rid of the tuple to delete
+   * @param txn the transaction performing the delete
+   * @return true iff the delete is successful (i.e the tuple exists)
+   */
+  bool MarkDelete(const RID &rid, Transaction *txn);
+
+  /**
+   * Read a tuple from the table.
+   * @param rid rid of the tuple to read
+   * @param[out] tuple the tuple, of the schema of the table
+   * @param txn transaction performing the read
+   * @return true if the read was successful (i.e. the tuple exists)
+   */
+  bool GetTuple(const RID &rid, Tuple *tuple, Transaction *txn);
+
+  /** @return the id of the first page of this table */
+  inline page_id_t GetFirstPageId() const { return first_page_id_; }
+
+  /** @return the layout of the pages of this table */
+  inline const PaxLayout &GetLayout() const { return layout_; }
+
+ private:
+  BufferPoolManager *buffer_pool_manager_;
+  const Schema *schema_;
+  const PaxLayout layout_;
+  page_id_t first_page_id_{};
+  /** rows are only appended to the last page, under this latch */
+  std::mutex append_latch_;
+  page_id_t last_page_id_{INVALID_PAGE_ID};
+};
+
+}  // namespace bustub
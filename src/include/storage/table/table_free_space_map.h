@@ -0,0 +1,55 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// table_free_space_map.h
+//
+// Identification: src/include/storage/table/table_free_space_map.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <mutex>  // NOLINT
+#include <set>
+#include <unordered_map>
+
+#include "common/config.h"
+
+namespace bustub {
+
+/**
+ * TableFreeSpaceMap tracks how large a tuple each page of a table heap can still take, so that an insert goes straight
+ * to a page with room for it instead of walking the table. Pages are kept in buckets of BUCKET_WIDTH bytes; a page is
+ * only handed out from a bucket whose every page has room, so a page is never tried in vain unless its free space
+ * shrank after it was recorded. The map is a hint: callers check the page they are handed and record what they find.
+ * It is not to be confused with the FreeSpaceMap of a tablespace, which tracks deallocated pages.
+ */
+class TableFreeSpaceMap {
+ public:
+  static constexpr uint32_t BUCKET_WIDTH = 16;
+  static constexpr uint32_t NUM_BUCKETS = PAGE_SIZE / BUCKET_WIDTH;
+
+  /**
+   * Records the size of the largest tuple that fits into a page.
+   * @param page_id the page
+   * @param max_insert_size what TablePage::GetMaxInsertSize returns for it
+   */
+  void Update(page_id_t page_id, uint32_t max_insert_size);
+
+  /**
+   * @param size the size of the tuple to insert
+   * @return the page with the least room that fits a tuple of that size, INVALID_PAGE_ID if there is none
+   */
+  page_id_t Find(uint32_t size);
+
+ private:
+  std::mutex latch_;
+  // the pages of each bucket, by page id so that the front of the table fills up first
+  std::set<page_id_t> buckets_[NUM_BUCKETS];
+  std::unordered_map<page_id_t, uint32_t> bucket_of_;
+};
+
+}  // namespace bustub
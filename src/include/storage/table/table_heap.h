@@ -12,20 +12,81 @@
 
 #pragma once
 
+#include <array>
+#include <atomic>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <vector>
+
 #include "buffer/buffer_pool_manager.h"
 #include "recovery/log_manager.h"
 #include "storage/page/table_page.h"
+#include "storage/table/table_free_space_map.h"
 #include "storage/table/table_iterator.h"
+#include "storage/table/toast_store.h"
 #include "storage/table/tuple.h"
+#include "storage/table/tid_table.h"
+#include "storage/table/version_store.h"
+#include "storage/table/zone_map.h"
 
 namespace bustub {
 
+/** What a vacuum of a table did. */
+struct VacuumStats {
+  /** the pages looked at */
+  size_t pages_{0};
+  /** the pages that had something to reclaim */
+  size_t compacted_pages_{0};
+  /** the pages left without tuples, whose space inserts get to from the free space map */
+  size_t empty_pages_{0};
+  size_t reclaimed_bytes_{0};
+
+  VacuumStats &operator+=(const VacuumStats &other) {
+    pages_ += other.pages_;
+    compacted_pages_ += other.compacted_pages_;
+    empty_pages_ += other.empty_pages_;
+    reclaimed_bytes_ += other.reclaimed_bytes_;
+    return *this;
+  }
+};
+
+/**
+ * TableWriteObserver is told what each transaction wrote to a table as the transaction commits, e.g. to bring a
+ * materialized view of the table up to date (see MaterializedView), and may be told as it aborts too.
+ */
+class TableWriteObserver {
+ public:
+  virtual ~TableWriteObserver() = default;
+
+  /**
+   * Called as a transaction that wrote to the table commits, once it is sure to, while the tuples it wrote are still
+   * locked and those it deleted are still in their pages (see TableHeap::ReadWrittenTuple).
+   * @param records the write records of the transaction of the table, in the order they were written in
+   */
+  virtual void OnCommit(const std::vector<const TableWriteRecord *> &records) = 0;
+
+  /**
+   * Called as a transaction that wrote to the table aborts, before its writes are rolled back, so that the tuples it
+   * wrote are still in their pages; does nothing unless overridden.
+   * @param txn the transaction
+   * @param records the write records of the transaction of the table, in the order they were written in
+   */
+  virtual void OnAbort(Transaction * /*txn*/, const std::vector<const TableWriteRecord *> & /*records*/) {}
+};
+
 /**
  * TableHeap represents a physical table on disk.
- * This is just a doubly-linked list of pages.
+ * This is just a doubly-linked list of pages. The pages are allocated in extents of TABLE_HEAP_EXTENT_SIZE pages that
+ * are contiguous on disk, so that a scan, which follows the list, reads the file sequentially.
+ * Inserts find a page with room through a TableFreeSpaceMap, which is built by a walk over the table on the first
+ * insert and kept in memory only, and new pages are appended at the end of the list without walking it. The same walk
+ * records the pages in the order of the list, which a ParallelTableScan hands out to its workers in morsels.
+ * A table may keep a ZoneMap of some of its columns, which scans skip pages by, and a ToastStore, which keeps the large
+ * VARCHAR values of its tuples in overflow chains.
  */
 class TableHeap {
   friend class TableIterator;
+  friend class TablePageScanner;
 
  public:
   ~TableHeap() = default;
@@ -51,13 +112,39 @@ class TableHeap {
             Transaction *txn);
 
   /**
-   * Insert a tuple into the table. If the tuple is too large (>= page_size), return false.
+   * Insert a tuple into the table. If the tuple is too large (>= page_size), even with its large values moved out if
+   * the table has a ToastStore, return false.
    * @param tuple tuple to insert
    * @param[out] rid the rid of the inserted tuple
    * @param txn the transaction performing the insert
+   * @param strategy the access strategy of a bulk load, nullptr to go through the shared pool
    * @return true iff the insert is successful
    */
-  bool InsertTuple(const Tuple &tuple, RID *rid, Transaction *txn);
+  bool InsertTuple(const Tuple &tuple, RID *rid, Transaction *txn, BufferAccessStrategy *strategy = nullptr);
+
+  /**
+   * Insert a batch of tuples into the table. Each page is filled with as many of them as fit under a single latch
+   * acquisition and log record.
+   * @param tuples the tuples to insert, none of which may be too large for a page, as for InsertTuple
+   * @param[out] rids the rids of the inserted tuples, in the order of tuples
+   * @param txn the transaction performing the insert
+   * @param strategy the access strategy of a bulk load, nullptr to go through the shared pool
+   * @return true iff all tuples were inserted; those in rids were, if not
+   */
+  bool InsertTuples(const std::vector<Tuple> &tuples, std::vector<RID> *rids, Transaction *txn,
+                    BufferAccessStrategy *strategy = nullptr);
+
+  /**
+   * Append a batch of tuples to the table in new pages of its own, for a bulk load. The pages are filled while nobody
+   * else can reach them, without locks or log records, and are then linked to the end of the table at once, so that
+   * loaders running at the same time only meet on the last page, once per batch. The tuples are in no transaction,
+   * and the pages outlive a crash only once they are flushed.
+   * @param tuples the tuples to append, none of which may be too large for a page, as for InsertTuple
+   * @param[out] rids the rids of the appended tuples, in the order of tuples
+   * @param strategy the access strategy of the bulk load, nullptr to go through the shared pool
+   * @return true iff all tuples were appended; those in rids were, if not
+   */
+  bool AppendTuples(const std::vector<Tuple> &tuples, std::vector<RID> *rids, BufferAccessStrategy *strategy = nullptr);
 
   /**
    * Mark the tuple as deleted. The actual delete will occur when ApplyDelete is called.
@@ -67,6 +154,15 @@ class TableHeap {
    */
   bool MarkDelete(const RID &rid, Transaction *txn);  // for delete
 
+  /**
+   * Mark a batch of tuples as deleted, a page at a time: the tuples of each page are marked under a single latch
+   * acquisition, their log records appended back to back.
+   * @param rids resource ids of the tuples to delete, in any order
+   * @param txn transaction performing the delete
+   * @return true iff all the deletes are successful; on the first that is not, the rest of the batch is left alone
+   */
+  bool MarkDeletes(const std::vector<RID> &rids, Transaction *txn);
+
   /**
    * if the new tuple is too large to fit in the old page, return false (will delete and insert)
    * @param tuple new tuple
@@ -76,6 +172,18 @@ class TableHeap {
    */
   bool UpdateTuple(const Tuple &tuple, const RID &rid, Transaction *txn);
 
+  /**
+   * Update a batch of tuples, a page at a time, as MarkDeletes does.
+   * @param tuples the new values of the tuples
+   * @param rids the rids of the old tuples, in any order
+   * @param txn transaction performing the update
+   * @param[out] updated whether each tuple was updated; one that was not while the transaction is still running did
+   * not fit in its page (will delete and insert, as for UpdateTuple)
+   * @return false if a page could not be fetched, which aborts the transaction
+   */
+  bool UpdateTuples(const std::vector<Tuple> &tuples, const std::vector<RID> &rids, Transaction *txn,
+                    std::vector<bool> *updated);
+
   /**
    * Called on Commit/Abort to actually delete a tuple or rollback an insert.
    * @param rid rid of the tuple to delete
@@ -83,6 +191,12 @@ class TableHeap {
    */
   void ApplyDelete(const RID &rid, Transaction *txn);
 
+  /**
+   * Called on commit of an update, to free what the version it replaced kept out of its page.
+   * @param old_tuple the replaced version, as the update left it in the write set
+   */
+  void ApplyUpdate(const Tuple &old_tuple);
+
   /**
    * Called on abort to rollback a delete.
    * @param rid rid of the deleted tuple.
@@ -91,7 +205,16 @@ class TableHeap {
   void RollbackDelete(const RID &rid, Transaction *txn);
 
   /**
-   * Read a tuple from the table.
+   * Compact some pages of the table (see TablePage::Compact), going on from where the last call left off, so that a
+   * vacuum of a large table can be spread over many calls. Each page is write latched only while it is compacted.
+   * @param max_pages the most pages to look at
+   * @param[out] stats what the vacuum did is added here
+   * @return true if the vacuum reached the end of the table, in which case the next call starts over
+   */
+  bool Vacuum(size_t max_pages, VacuumStats *stats);
+
+  /**
+   * Read a tuple from the table, with its toasted values read back in.
    * @param rid rid of the tuple to read
    * @param tuple output variable for the tuple
    * @param txn transaction performing the read
@@ -99,8 +222,12 @@ class TableHeap {
    */
   bool GetTuple(const RID &rid, Tuple *tuple, Transaction *txn);
 
-  /** @return the begin iterator of this table */
-  TableIterator Begin(Transaction *txn);
+  /**
+   * @param txn the transaction performing the scan
+   * @param strategy the access strategy of a bulk scan, nullptr to go through the shared pool
+   * @return the begin iterator of this table
+   */
+  TableIterator Begin(Transaction *txn, BufferAccessStrategy *strategy = nullptr);
 
   /** @return the end iterator of this table */
   TableIterator End();
@@ -108,11 +235,229 @@ class TableHeap {
   /** @return the id of the first page of this table */
   inline page_id_t GetFirstPageId() const { return first_page_id_; }
 
+  /** @return the buffer pool the pages of the table are in */
+  BufferPoolManager *GetBufferPoolManager() { return buffer_pool_manager_; }
+
+  /** Sets the oid of the table in the catalog, under which the records locked through the heap lock their table */
+  void SetTableOid(table_oid_t oid) { table_oid_ = oid; }
+
+  /** @return the oid of the table, INVALID_TABLE_OID if the heap is not in a catalog */
+  table_oid_t GetTableOid() const { return table_oid_; }
+
+  /**
+   * @param strategy the access strategy of the walk over the table that finds its pages, if no insert has run it yet
+   * @return the ids of the pages of this table, in the order of its list
+   */
+  std::vector<page_id_t> GetPageIds(BufferAccessStrategy *strategy = nullptr);
+
+  /**
+   * Picks a random subset of the pages of this table, each page with the same probability, for a scan that reads
+   * a sample of the table rather than all of it.
+   * @param fraction the probability of each page to be picked, in [0, 1]
+   * @param seed the seed of the picks; the same seed picks the same pages of the same list
+   * @param strategy the access strategy of the walk over the table that finds its pages, if none has run yet
+   * @return the ids of the pages picked, in the order of the list of this table
+   */
+  std::vector<page_id_t> GetSampledPageIds(double fraction, uint64_t seed, BufferAccessStrategy *strategy = nullptr);
+
+  /**
+   * Starts keeping zones of some columns, from a walk over the table. This has to happen before the table is written
+   * to by more than the caller, and only once.
+   * @param schema the schema of the table, which has to outlive the heap
+   * @param column_idxs the columns to keep zones of
+   * @param txn the transaction the walk reads the table in
+   */
+  void CreateZoneMap(const Schema *schema, const std::vector<uint32_t> &column_idxs, Transaction *txn);
+
+  /** @return the zone map of this table, nullptr if it keeps none */
+  inline ZoneMap *GetZoneMap() const { return zone_map_.get(); }
+
+  /**
+   * Starts moving the large values of the tuples written from now on out of them, into overflow chains. This has to
+   * happen before the table is written to by more than the caller, and only once.
+   * @param schema the schema of the table, which has to outlive the heap
+   */
+  void EnableToast(const Schema *schema);
+
+  /**
+   * @return the toast store of this table, nullptr if it has none; the tuples that TablePageScanner hands out may
+   * have toasted values, which are read through it
+   */
+  inline ToastStore *GetToastStore() const { return toast_.get(); }
+
+  /**
+   * @return the older versions of the tuples of this table, which the writes of transactions that a
+   * TransactionManager began keep, for the SNAPSHOT transactions that GetTuple and TablePageScanner read them for
+   */
+  inline VersionStore *GetVersionStore() { return &versions_; }
+
+  /** @return the TIDs of the tuples of this table, which the OPTIMISTIC transactions read and validate */
+  inline TidTable *GetTidTable() { return &tids_; }
+
+  /**
+   * Makes an observer be told of the writes of each transaction to the table as it commits. This has to happen before
+   * the table is written to by more than the caller, and the observer has to outlive the heap.
+   */
+  void AddWriteObserver(TableWriteObserver *observer) { write_observers_.push_back(observer); }
+
+  /** @return the observers of the writes to the table */
+  inline const std::vector<TableWriteObserver *> &GetWriteObservers() const { return write_observers_; }
+
+  /**
+   * @return a count that changes whenever the rows of the table may have: a transaction that wrote to the table bumps
+   * it as it commits or aborts, before others may read its writes, as do appends, which are in no transaction (see
+   * ResultCache). The counts are drawn from a clock of the process, so no two heaps ever have the same one, and a heap
+   * made in place of another, as of a truncated partition, is told apart from it.
+   */
+  inline uint64_t GetModificationCount() const { return modification_count_.load(std::memory_order_acquire); }
+
+  /** Bumps the modification count, see GetModificationCount. */
+  inline void BumpModificationCount() { modification_count_.store(NextModificationCount(), std::memory_order_release); }
+
+  /**
+   * Reads a tuple as its page has it, without locking it, for a TableWriteObserver: the tuple a committing
+   * transaction wrote, or the one it deleted, which stays in its page until the commit applies the delete.
+   * @param[out] tuple the tuple, with its toasted values read back in
+   * @param[out] deleted whether the tuple is marked deleted
+   * @return false if the slot holds no tuple
+   */
+  bool ReadWrittenTuple(const RID &rid, Tuple *tuple, bool *deleted);
+
+  /** @return true if the updates and deletes of the transaction are kept in its write set until it commits */
+  static bool IsBuffered(Transaction *txn) {
+    return txn->GetIsolationLevel() == IsolationLevel::OPTIMISTIC && !txn->IsValidated() &&
+           txn->GetState() != TransactionState::ABORTED;
+  }
+
  private:
+  /** @return true if the writes of the transaction keep the versions they replace */
+  static bool IsVersioned(Transaction *txn) {
+    return txn->GetReadTs() != INVALID_TS && txn->GetState() != TransactionState::ABORTED;
+  }
+
+  /**
+   * Aborts a SNAPSHOT transaction that is about to write a tuple another transaction wrote since its snapshot, under
+   * the write latch of the page of the tuple.
+   * @return false if the transaction was aborted
+   */
+  bool CheckWriteConflict(const RID &rid, Transaction *txn);
+
+  /**
+   * Locks the rows a transaction is about to read, or to write if exclusive, before their pages are latched, so that a
+   * wait for a lock does not hold a latch the holder of the lock needs to roll back, as undo after a restart does; the
+   * TablePage then finds them locked. It locks what TablePage would: nothing without logging or a transaction.
+   * @return false if a lock was not granted, and the transaction aborted
+   */
+  bool LockRows(const std::vector<RID> &rids, Transaction *txn, bool exclusive);
+
+  /**
+   * Locks the table INTENTION_EXCLUSIVE for a transaction about to insert, before a page is latched, for the same
+   * reason; the rows themselves are only locked once they have slots, see LockManager::LockNewTuple.
+   * @return false if the lock was not granted, and the transaction aborted
+   */
+  bool LockForInsert(Transaction *txn);
+
+  /** Pushes the version before a write of the transaction, nullptr for an insert, under the write latch of the page */
+  void AppendVersion(const RID &rid, Transaction *txn, const Tuple *before);
+
+  /**
+   * Marks a tuple of a write latched page as deleted, keeping the version it had.
+   * @return false if the tuple could not be marked, or the transaction was aborted on a write conflict
+   */
+  bool MarkVersionedDelete(TablePage *page, const RID &rid, Transaction *txn);
+
+  /**
+   * Reads a tuple for an OPTIMISTIC transaction: the one it wrote last, if it did, or the one in the page otherwise,
+   * whose TID goes into its read set.
+   */
+  bool GetOptimisticTuple(const RID &rid, Tuple *tuple, Transaction *txn);
+
+  /**
+   * Creates the next page of the current extent, allocating a new extent if it is used up.
+   * @param[out] page_id the id of the new page
+   * @param strategy the access strategy to take the frame from, if any
+   * @return nullptr if no frame was left for the page
+   */
+  Page *NewTablePage(page_id_t *page_id, BufferAccessStrategy *strategy);
+
+  /**
+   * Inserts a tuple the way InsertTuple does, once its large values have been moved out.
+   * @param stored the tuple to store in the page
+   * @param tuple the tuple as it was given, which the zone map takes in
+   */
+  bool InsertStoredTuple(const Tuple &stored, const Tuple &tuple, RID *rid, Transaction *txn,
+                         BufferAccessStrategy *strategy);
+
+  /** Inserts a batch the way InsertTuples does, once the large values of its tuples have been moved out. */
+  bool InsertStoredTuples(const std::vector<Tuple> &stored, const std::vector<Tuple> &tuples, std::vector<RID> *rids,
+                          Transaction *txn, BufferAccessStrategy *strategy);
+
+  /**
+   * Inserts as many tuples of a batch as fit into a write latched page, and records them.
+   * @return the number of tuples that were inserted
+   */
+  size_t FillPage(TablePage *page, const std::vector<Tuple> &stored, const std::vector<Tuple> &tuples, size_t begin,
+                  std::vector<RID> *rids, Transaction *txn);
+
+  /**
+   * Links pages that were filled by AppendTuples, chained to each other already, after the last page of the table.
+   * @param page_ids the pages, in the order of their chain
+   * @param max_insert_sizes the room left in each of them
+   * @param tuples the tuples appended to them, as they were given, which the zone map takes in
+   * @param rids the rids of the tuples
+   * @param strategy the access strategy of the bulk load
+   * @return false if the last page of the table could not be fetched
+   */
+  bool LinkPages(const std::vector<page_id_t> &page_ids, const std::vector<uint32_t> &max_insert_sizes,
+                 const std::vector<Tuple> &tuples, const std::vector<RID> &rids, BufferAccessStrategy *strategy);
+
+  /** Records the free space of every page of the table, the order of the pages, and which of them is the last one. */
+  void BuildFreeSpaceMap(BufferAccessStrategy *strategy);
+
+  /** Records a page that was just linked to the end of the table, while the page before it is write latched. */
+  void AddPage(page_id_t page_id);
+
+  /** @return the slot of insert_hints_ of the calling thread */
+  static size_t InsertHintSlot();
+
+  /** Hints are kept for that many threads; threads whose ids hash alike share one. */
+  static constexpr size_t NUM_INSERT_HINTS = 16;
+
   BufferPoolManager *buffer_pool_manager_;
   LockManager *lock_manager_;
   LogManager *log_manager_;
+  table_oid_t table_oid_{INVALID_TABLE_OID};
   page_id_t first_page_id_{};
+  /** The next page of the current extent to hand out, and the end of the extent. */
+  page_id_t next_extent_page_id_{INVALID_PAGE_ID};
+  page_id_t extent_end_{INVALID_PAGE_ID};
+  /** Protects the current extent. */
+  std::mutex extent_latch_;
+  TableFreeSpaceMap free_space_map_;
+  std::once_flag free_space_map_built_;
+  /** The end of the list; it only moves on while the page it points at is latched. */
+  std::atomic<page_id_t> last_page_id_{INVALID_PAGE_ID};
+  /** The pages of the table in the order of the list, known once the free space map is built. */
+  std::vector<page_id_t> page_ids_;
+  std::mutex page_ids_latch_;
+  /** The page each thread inserted into last, where its next insert goes first, so that threads fill pages apart. */
+  std::array<std::atomic<page_id_t>, NUM_INSERT_HINTS> insert_hints_;
+  /** Where the next call to Vacuum starts, INVALID_PAGE_ID for the first page; under vacuum_latch_. */
+  page_id_t vacuum_cursor_{INVALID_PAGE_ID};
+  std::mutex vacuum_latch_;
+  /** Widened under the write latch of the page a tuple is written to. */
+  std::unique_ptr<ZoneMap> zone_map_;
+  std::unique_ptr<ToastStore> toast_;
+  std::vector<TableWriteObserver *> write_observers_;
+  /** the clock the modification counts of the heaps are drawn from */
+  static std::atomic<uint64_t> modification_clock;
+  static uint64_t NextModificationCount() { return modification_clock.fetch_add(1, std::memory_order_relaxed) + 1; }
+  std::atomic<uint64_t> modification_count_{NextModificationCount()};
+  VersionStore versions_;
+  TidTable tids_;
+  /** The synchronized TablePageScanners of the table that are running, and the page one of them last moved to. */
+  std::atomic<size_t> sync_scans_{0};
+  std::atomic<page_id_t> sync_scan_page_{INVALID_PAGE_ID};
 };
 
 }  // namespace bustub
@@ -0,0 +1,160 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// table_page_scanner.h
+//
+// Identification: src/include/storage/table/table_page_scanner.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <functional>
+#include <memory>
+#include <optional>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "buffer/buffer_access_strategy.h"
+#include "common/macros.h"
+#include "concurrency/transaction.h"
+#include "storage/page/table_page.h"
+#include "storage/table/tuple.h"
+#include "storage/table/zone_map.h"
+
+namespace bustub {
+
+class TableHeap;
+
+/**
+ * TablePageScanner scans a TableHeap without copying its tuples. Unlike TableIterator, it hands out views of the
+ * tuples in the page it is at, which it keeps pinned, and read latched from the first Next call of a batch until
+ * Release; a consumer copies out just the tuples it keeps. The scanner has to be released before anything that may
+ * write latch the page runs, e.g. before the scan hands a tuple to the executor above it.
+ *
+ * A scan that is only after rows within some ranges of columns skips the pages that the table's ZoneMap rules out,
+ * without reading them; a consumer still checks the rows it is handed. A scan may also be given a filter of the rows,
+ * e.g. a compiled predicate, which it runs on the tuples in the page and skips the ones it is false for, so that the
+ * consumer is only handed the rows that pass. A scan of a morsel of a ParallelTableScan reads
+ * just the pages of the morsel.
+ *
+ * A scan of a SNAPSHOT transaction hands out the versions of the tuples it sees, as the VersionStore of the table
+ * finds them, without locking them; it finds the versions of the tuples of a page that have version chains every time
+ * it latches the page, and reads the others from the page. A scan of an OPTIMISTIC transaction takes no locks either,
+ * and records the TIDs of the tuples it reads in the read set of the transaction; it does not see the updates and
+ * deletes the transaction keeps in its write set, nor records the tuples it does not find, so that it does not catch
+ * the phantoms that other transactions insert.
+ *
+ * A synchronized scan (see Synchronized) shares its reads with the other synchronized scans of the table that are
+ * running: it starts at the page they last moved to rather than at the first one, and wraps around at the end of the
+ * table, so that it reads the pages right after them, while they are still in the buffer pool, rather than reading
+ * the table again from the start.
+ */
+class TablePageScanner {
+ public:
+  /**
+   * @param table_heap the table to scan
+   * @param txn the transaction the scan runs in
+   * @param strategy the access strategy the scan reads pages through, nullptr for the shared pool
+   * @param ranges ranges of columns the zone map of the table covers, which the rows the scan is after are within
+   */
+  TablePageScanner(TableHeap *table_heap, Transaction *txn, BufferAccessStrategy *strategy = nullptr,
+                   std::vector<ZoneRange> ranges = {});
+
+  /**
+   * @param table_heap the table to scan
+   * @param txn the transaction the scan runs in
+   * @param page_ids the pages to scan, in this order, instead of the whole table
+   * @param strategy the access strategy the scan reads pages through, nullptr for the shared pool
+   */
+  TablePageScanner(TableHeap *table_heap, Transaction *txn, std::vector<page_id_t> page_ids,
+                   BufferAccessStrategy *strategy = nullptr);
+
+  ~TablePageScanner();
+
+  DISALLOW_COPY_AND_MOVE(TablePageScanner);
+
+  /**
+   * Scans the whole table as a synchronized scan. The scan starts at the page the synchronized scans of the table in
+   * progress last moved to, if there are any and the table has at least 1 / SYNC_SCAN_POOL_FRACTION of the pages of
+   * the buffer pool, and goes over the pages the table had then, wrapping around at the end; otherwise it scans it
+   * from the first page, as the constructor does.
+   * @param table_heap the table to scan
+   * @param txn the transaction the scan runs in
+   * @param strategy the access strategy the scan reads pages through, nullptr for the shared pool
+   */
+  static std::unique_ptr<TablePageScanner> Synchronized(TableHeap *table_heap, Transaction *txn,
+                                                        BufferAccessStrategy *strategy = nullptr);
+
+  /** A smaller table is read again rather than joined mid-way, as its pages are likely in the pool anyway */
+  static constexpr size_t SYNC_SCAN_POOL_FRACTION = 4;
+
+  /**
+   * Moves on to the next tuple, latching the page it is at if the scanner was released.
+   * @param[out] view a view of the tuple, good until the next call to Next or Release
+   * @return false at the end of the table
+   */
+  bool Next(Tuple *view);
+
+  /**
+   * @param filter the filter to run on the views of the tuples before they are handed out; the ones it is false for are
+   * skipped, nullptr for none
+   */
+  void SetFilter(std::function<bool(const Tuple &)> filter) { filter_ = std::move(filter); }
+
+  /** Lets go of the latch on the page the scanner is at; it stays pinned until the scanner moves past it. */
+  void Release();
+
+ private:
+  /** Unpins the current page and pins the next one, or none at the end of the table. */
+  void MoveToPage(page_id_t page_id);
+
+  /** @return the first page at or after page_id that the zone map does not rule out */
+  page_id_t NextCandidate(page_id_t page_id);
+
+  /** @return the page to scan after page_, INVALID_PAGE_ID if it is the last one */
+  page_id_t PageAfter();
+
+  /** Read latches page_, and finds the versions of its tuples a snapshot scan sees. */
+  void Latch();
+
+  /** Moves a snapshot scan on to the next version in page_ it sees, or to the next page if there is none. */
+  bool NextVersion(Tuple *view);
+
+  /** @return true if the transaction reads the versions of its snapshot */
+  static bool IsSnapshot(Transaction *txn);
+
+  /** Reads the tuple at rid_ in page_, locking it or recording its TID. */
+  bool ReadView(Tuple *view);
+
+  /** @return true if the transaction reads without locks, and validates its reads as it commits */
+  static bool IsOptimistic(Transaction *txn);
+
+  TableHeap *table_heap_;
+  Transaction *txn_;
+  BufferAccessStrategy *strategy_;
+  const std::vector<ZoneRange> ranges_;
+  std::function<bool(const Tuple &)> filter_;
+  /** the pages of a morsel, and the position of page_ in them, if the scanner is not following the list */
+  const std::vector<page_id_t> morsel_;
+  const bool in_morsel_{false};
+  size_t position_{0};
+  /** whether the scanner tells the table the pages it moves to, for the synchronized scans that start after it */
+  bool synchronized_{false};
+  /** the page the scanner is at, pinned; nullptr at the end of the table */
+  TablePage *page_{nullptr};
+  bool latched_{false};
+  /** the tuple last handed out, of an invalid page before the first tuple of page_ */
+  RID rid_{};
+  /** whether the scan reads the versions of the snapshot of txn_, and the ones of the tuples of page_ with chains */
+  const bool snapshot_;
+  /** whether the scan records the tuples it reads in the read set of txn_ instead of locking them */
+  const bool optimistic_;
+  std::unordered_map<uint32_t, std::optional<Tuple>> page_versions_;
+};
+
+}  // namespace bustub
@@ -0,0 +1,72 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// table_vacuum.h
+//
+// Identification: src/include/storage/table/table_vacuum.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <condition_variable>  // NOLINT
+#include <memory>
+#include <mutex>   // NOLINT
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "common/macros.h"
+#include "storage/table/table_heap.h"
+
+namespace bustub {
+
+/**
+ * TableVacuum compacts the pages of some tables in the background. Every VACUUM_INTERVAL it vacuums up to
+ * VACUUM_PAGES_PER_ROUND pages of each table, going on where it left off, so that it never holds up foreground
+ * queries for longer than a page takes; a table is vacuumed from its first page again once a pass has reached its end.
+ */
+class TableVacuum {
+ public:
+  TableVacuum() = default;
+
+  /** Stops the background thread, if it is running. */
+  ~TableVacuum();
+
+  DISALLOW_COPY_AND_MOVE(TableVacuum);
+
+  /** Adds a table to vacuum; it has to be removed, or the vacuum stopped, before it goes away. */
+  void AddTable(TableHeap *table);
+
+  /** Removes a table; it is not vacuumed any more once this returns. */
+  void RemoveTable(TableHeap *table);
+
+  /** Starts the background thread. */
+  void Start();
+
+  /** Stops the background thread, after the round it may be in. */
+  void Stop();
+
+  /**
+   * Runs a single round, in the caller's thread.
+   * @return what the round did
+   */
+  VacuumStats RunOnce();
+
+  /** @return what all rounds together did */
+  VacuumStats GetStats();
+
+ private:
+  /** Protects tables_, stats_ and running_; held for the whole of a round. */
+  std::mutex latch_;
+  std::vector<TableHeap *> tables_;
+  VacuumStats stats_;
+  std::unique_ptr<std::thread> thread_;
+  bool running_{false};
+  /** Wakes the thread up early when it is being stopped. */
+  std::condition_variable cv_;
+};
+
+}  // namespace bustub
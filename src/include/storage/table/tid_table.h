@@ -0,0 +1,76 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// tid_table.h
+//
+// Identification: src/include/storage/table/tid_table.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <shared_mutex>
+#include <unordered_map>
+
+#include "common/macros.h"
+#include "common/rid.h"
+
+namespace bustub {
+
+/**
+ * TidTable keeps the TID words of the tuples of a TableHeap, for the OPTIMISTIC transactions, as in Silo. The TID of a
+ * tuple changes with every write of it, so that a transaction that read the tuple can tell at commit whether it is
+ * still the version it read; its top bit locks the tuple while a committing transaction installs its writes.
+ *
+ * The words live beside the pages rather than in the tuple format, one per tuple that was written since the first
+ * optimistic read of the table; a tuple without one has the TID 0. A TID changes under the write latch of the page of
+ * its tuple, together with the tuple, so that a reader under the read latch sees both as of the same moment.
+ */
+class TidTable {
+ public:
+  /** The bit of a TID that is set while the tuple is locked */
+  static constexpr uint64_t LOCK_BIT = uint64_t{1} << 63;
+
+  TidTable() = default;
+
+  DISALLOW_COPY_AND_MOVE(TidTable);
+
+  ~TidTable() = default;
+
+  /**
+   * Has the writes of the tuples change their TIDs from now on, before the first optimistic read of the table; until
+   * then no transaction reads the TIDs, and the writes leave them alone.
+   */
+  void Activate() {
+    if (!active_.load()) {
+      active_.store(true);
+    }
+  }
+
+  /** @return the TID of the tuple at rid */
+  uint64_t Get(const RID &rid);
+
+  /** Moves the TID of the tuple at rid on, as it is written, under the write latch of its page */
+  void Bump(const RID &rid);
+
+  /**
+   * Locks the tuple at rid, for a committing transaction to install its write.
+   * @return false if another transaction holds it locked
+   */
+  bool TryLock(const RID &rid);
+
+  /** Sets the TID of the tuple at rid, and unlocks it; or just unlocks it, if tid is 0 */
+  void Unlock(const RID &rid, uint64_t tid = 0);
+
+ private:
+  std::atomic<bool> active_{false};
+  std::shared_mutex latch_;
+  std::unordered_map<RID, uint64_t> tids_;
+};
+
+}  // namespace bustub
@@ -4,8 +4,7 @@
 
 namespace bustub {
 
-// Document this class! What does it represent?
-
+/** TmpTuple is where a tuple is in a TmpTuplePage: the page, and the offset of its size in it. */
 class TmpTuple {
  public:
   TmpTuple(page_id_t page_id, size_t offset) : page_id_(page_id), offset_(offset) {}
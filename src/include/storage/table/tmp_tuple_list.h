@@ -0,0 +1,76 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// tmp_tuple_list.h
+//
+// Identification: src/include/storage/table/tmp_tuple_list.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <atomic>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "common/macros.h"
+#include "storage/page/tmp_tuple_page.h"
+#include "storage/table/tuple.h"
+
+namespace bustub {
+
+/**
+ * TmpTupleList is a list of tuples that an executor spills, in TmpTuplePages of the buffer pool, so that e.g. a hash
+ * join can hold more tuples than fit its memory. Appending pins a page only while the tuple is written, and reading
+ * only while the tuples of a page are copied out, so that a list holds no frame in between. The pages are deleted with
+ * the list.
+ */
+class TmpTupleList {
+ public:
+  /**
+   * @param bpm the buffer pool of the temp pages
+   * @param spilled_bytes a counter to add the bytes of the tuples appended to, e.g. of the query; nullptr if none
+   */
+  explicit TmpTupleList(BufferPoolManager *bpm, std::atomic<uint64_t> *spilled_bytes = nullptr)
+      : bpm_(bpm), spilled_bytes_(spilled_bytes) {}
+
+  DISALLOW_COPY_AND_MOVE(TmpTupleList);
+
+  ~TmpTupleList();
+
+  /** Appends a tuple; throws OUT_OF_MEMORY if the buffer pool has no frame left for a new page. */
+  void Append(const Tuple &tuple);
+
+  /** @return the number of tuples appended */
+  size_t GetSize() const { return size_; }
+
+  /** @return the number of bytes of the tuples appended */
+  size_t GetTupleBytes() const { return tuple_bytes_; }
+
+  /** Reads the tuples of a list back, a page at a time, in the order they were appended. */
+  class Reader {
+   public:
+    explicit Reader(const TmpTupleList *list) : list_(list) {}
+
+    /** @return false when every tuple of the list has been read */
+    bool Next(Tuple *tuple);
+
+   private:
+    const TmpTupleList *list_;
+    size_t next_page_{0};
+    std::vector<Tuple> tuples_;
+    size_t next_tuple_{0};
+  };
+
+ private:
+  BufferPoolManager *bpm_;
+  std::atomic<uint64_t> *spilled_bytes_;
+  std::vector<page_id_t> page_ids_;
+  size_t size_{0};
+  size_t tuple_bytes_{0};
+};
+
+}  // namespace bustub
@@ -0,0 +1,94 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// toast_store.h
+//
+// Identification: src/include/storage/table/toast_store.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "catalog/schema.h"
+#include "storage/table/tuple.h"
+#include "type/value.h"
+
+namespace bustub {
+
+/** Where a toasted value is: the first page of its overflow chain, and its serialized length. */
+struct ToastPointer {
+  page_id_t first_page_id_;
+  uint32_t length_;
+};
+
+/**
+ * ToastStore keeps the large VARCHAR values of a table's tuples out of the tuples, in chains of OverflowPages, the way
+ * TOAST does. A tuple larger than TOAST_TUPLE_THRESHOLD has its largest values moved out one after the other until it
+ * is no larger, or has nothing left to move; the tuple stored in the page keeps a ToastPointer in their place.
+ *
+ * Values are fetched lazily, column by column, so that a scan that does not read a toasted column never reads its
+ * overflow pages. A chain is written once, before its tuple is, and never changed; it is freed when its tuple is
+ * deleted for good, or replaced by a committed update.
+ */
+class ToastStore {
+ public:
+  /** Tuples larger than this have their largest values moved out. */
+  static constexpr uint32_t TOAST_TUPLE_THRESHOLD = PAGE_SIZE / 4;
+
+  /**
+   * @param buffer_pool_manager the buffer pool manager the overflow pages come from
+   * @param schema the schema of the table, which has to outlive the store
+   */
+  ToastStore(BufferPoolManager *buffer_pool_manager, const Schema *schema)
+      : buffer_pool_manager_(buffer_pool_manager), schema_(schema) {}
+
+  /**
+   * Moves the large values of a tuple out, if it is larger than TOAST_TUPLE_THRESHOLD.
+   * @param tuple the tuple to store
+   * @param[out] stored the tuple to store instead, if any value was moved out
+   * @return false if the tuple is small enough as it is, has toasted values already, or no overflow page could be
+   * had; nothing is moved out then
+   */
+  bool Toast(const Tuple &tuple, Tuple *stored);
+
+  /** @return true if any value of a tuple of the table is toasted */
+  bool IsToasted(const Tuple &tuple) const;
+
+  /** @return the value of a column of a tuple of the table, read from its overflow chain if it is toasted */
+  Value GetValue(const Tuple &tuple, uint32_t column_idx);
+
+  /**
+   * Reads every value of a tuple of the table.
+   * @param tuple a tuple of the table
+   * @param[out] detoasted the tuple with none of its values toasted, with the rid of tuple
+   */
+  void Detoast(const Tuple &tuple, Tuple *detoasted);
+
+  /** Frees the overflow chains of the toasted values of a tuple of the table. */
+  void Free(const Tuple &tuple);
+
+ private:
+  /** @return the pointer to a toasted value of a tuple */
+  ToastPointer GetPointer(const Tuple &tuple, uint32_t column_idx) const;
+
+  /** @return the first page of a new chain that holds data, INVALID_PAGE_ID if no page could be had */
+  page_id_t WriteChain(const char *data, uint32_t size);
+
+  /** @return the data of a chain */
+  std::string ReadChain(const ToastPointer &pointer);
+
+  /** Deletes the pages of a chain. */
+  void FreeChain(page_id_t first_page_id);
+
+  BufferPoolManager *buffer_pool_manager_;
+  const Schema *schema_;
+};
+
+}  // namespace bustub
@@ -12,10 +12,13 @@
 
 #pragma once
 
+#include <cstring>
 #include <string>
+#include <string_view>
 #include <vector>
 
 #include "catalog/schema.h"
+#include "common/memory_tracker.h"
 #include "common/rid.h"
 #include "type/value.h"
 
@@ -23,9 +26,16 @@ namespace bustub {
 
 /**
  * Tuple format:
- * ---------------------------------------------------------------------
- * | FIXED-SIZE or VARIED-SIZED OFFSET | PAYLOAD OF VARIED-SIZED FIELD |
- * ---------------------------------------------------------------------
+ * ---------------------------------------------------------------------------------
+ * | FIXED-SIZE or VARIED-SIZED OFFSET | PAYLOAD OF VARIED-SIZED FIELD | NULL BITMAP |
+ * ---------------------------------------------------------------------------------
+ *
+ * The null bitmap has a bit per column, set for the columns that are null, so that IsNull reads a bit instead of the
+ * value. It comes last, so that the offsets of the columns stay those of the schema and a key tuple copied into a
+ * GenericKey keeps its values at the front. Null values are still serialized as their type's null sentinel.
+ *
+ * A tuple either owns its data or is a view of data it does not own, e.g. of a tuple in a pinned and latched page;
+ * a view is only valid for as long as that data is, and copies of it are views too.
  */
 class Tuple {
   friend class TablePage;
@@ -34,29 +44,56 @@ class Tuple {
 
   friend class TableIterator;
 
+  friend class ToastStore;
+
+  friend class LogRecord;
+
+  friend class TupleBuilder;
+
  public:
+  /** The length a VARCHAR value is stored with when it is kept out of the tuple, followed by a ToastPointer. */
+  static constexpr uint32_t TOASTED_LENGTH = BUSTUB_VALUE_NULL - 1;
+
   // Default constructor (to create a dummy tuple)
   Tuple() = default;
 
   // constructor for table heap tuple
   explicit Tuple(RID rid) : rid_(rid) {}
 
-  // constructor for creating a new tuple based on input value
-  Tuple(std::vector<Value> values, const Schema *schema);
+  // constructor for creating a new tuple based on input value; TupleBuilder makes many tuples of a schema faster
+  Tuple(const std::vector<Value> &values, const Schema *schema);
+
+  // constructor for creating a new tuple based on input value, as a view of data allocated from arena
+  Tuple(const std::vector<Value> &values, const Schema *schema, MemoryArena *arena);
+
+  // constructor for a view of size bytes of data that the tuple does not own
+  Tuple(RID rid, char *data, uint32_t size) : rid_(rid), size_(size), data_(data) {}
 
   // copy constructor, deep copy
   Tuple(const Tuple &other);
 
-  // assign operator, deep copy
+  // move constructor, takes over the data of other and leaves it empty
+  Tuple(Tuple &&other) noexcept;
+
+  // assign operator, deep copy into the buffer of this tuple if it is large enough
   Tuple &operator=(const Tuple &other);
 
+  // move assign operator, takes over the data of other and leaves it empty
+  Tuple &operator=(Tuple &&other) noexcept;
+
   ~Tuple() {
-    if (allocated_) {
-      delete[] data_;
-    }
-    allocated_ = false;
+    FreeData();
     data_ = nullptr;
   }
+
+  // a view of the data of this tuple, valid for as long as this tuple is and does not change
+  inline Tuple AsView() const { return Tuple(rid_, data_, size_); }
+
+  // deep copy of other, even if it is a view, into the buffer of this tuple if it is large enough
+  void CopyFrom(const Tuple &other) {
+    rid_ = other.rid_;
+    CopyData(other.data_, other.size_);
+  }
   // serialize tuple data
   void SerializeTo(char *storage) const;
 
@@ -66,6 +103,9 @@ class Tuple {
   // return RID of current tuple
   inline RID GetRid() const { return rid_; }
 
+  // set the RID of a tuple that was not read from a TableHeap
+  inline void SetRid(const RID &rid) { rid_ = rid; }
+
   // Get the address of this tuple in the table's backing store
   inline char *GetData() const { return data_; }
 
@@ -76,14 +116,42 @@ class Tuple {
   // checks the schema to see how to return the Value.
   Value GetValue(const Schema *schema, uint32_t column_idx) const;
 
+  /**
+   * Reads an inlined column in place, as the C++ type its values are stored as: int8_t for BOOLEAN and TINYINT,
+   * int16_t for SMALLINT, int32_t for INTEGER, int64_t for BIGINT, double for DECIMAL and uint64_t for TIMESTAMP. No
+   * Value is made; a null reads as its type's null sentinel, and IsNull tells it apart.
+   */
+  template <typename T>
+  T GetAs(const Schema *schema, uint32_t column_idx) const {
+    BUSTUB_ASSERT(schema->GetType(column_idx) != TypeId::VARCHAR, "a VARCHAR is read with GetStringView");
+    T value;
+    memcpy(&value, data_ + schema->GetOffset(column_idx), sizeof(T));
+    return value;
+  }
+
+  /** @return the bytes of a VARCHAR column in place, without its terminating NUL; empty for a null */
+  std::string_view GetStringView(const Schema *schema, uint32_t column_idx) const;
+
   // Generates a key tuple given schemas and attributes
-  Tuple KeyFromTuple(const Schema &schema, const Schema &key_schema, const std::vector<uint32_t> &key_attrs);
+  Tuple KeyFromTuple(const Schema &schema, const Schema &key_schema, const std::vector<uint32_t> &key_attrs) const;
 
   // Is the column value null ?
+  /**
+   * @return true if the value of a column is kept out of the tuple, in an overflow chain of its table, in which case
+   * it is read through the table's ToastStore rather than GetValue
+   */
+  bool IsToasted(const Schema *schema, uint32_t column_idx) const {
+    return schema->GetType(column_idx) == TypeId::VARCHAR &&
+           *reinterpret_cast<const uint32_t *>(GetDataPtr(schema, column_idx)) == TOASTED_LENGTH;
+  }
+
   inline bool IsNull(const Schema *schema, uint32_t column_idx) const {
-    Value value = GetValue(schema, column_idx);
-    return value.IsNull();
+    const char *bitmap = data_ + size_ - NullBitmapSize(schema);
+    return ((bitmap[column_idx / 8] >> (column_idx % 8)) & 1) != 0;
   }
+
+  /** @return the size in bytes of the null bitmap of a tuple of the schema */
+  static uint32_t NullBitmapSize(const Schema *schema) { return (schema->GetColumnCount() + 7) / 8; }
   inline bool IsAllocated() { return allocated_; }
 
   std::string ToString(const Schema *schema) const;
@@ -92,9 +160,35 @@ class Tuple {
   // Get the starting storage address of specific column
   const char *GetDataPtr(const Schema *schema, uint32_t column_idx) const;
 
+  // the size of a tuple of the values
+  static uint32_t SizeOf(const std::vector<Value> &values, const Schema *schema);
+
+  // serializes the values into size bytes of data
+  static void Serialize(const std::vector<Value> &values, const Schema *schema, char *data, uint32_t size);
+
+  // makes the tuple own a copy of size bytes of data, reusing its buffer if it owns one that is large enough
+  void CopyData(const char *data, uint32_t size);
+
+  // allocates a buffer of capacity_ bytes for the tuple to own, accounted for as TUPLES memory
+  void AllocateData() {
+    MemoryTracker::AllocateLocal(MemoryCategory::TUPLES, capacity_);
+    data_ = new char[capacity_];
+    allocated_ = true;
+  }
+
+  // frees the buffer the tuple owns, if it owns one
+  void FreeData() {
+    if (allocated_) {
+      MemoryTracker::FreeLocal(MemoryCategory::TUPLES, capacity_);
+      delete[] data_;
+    }
+    allocated_ = false;
+  }
+
   bool allocated_{false};  // is allocated?
   RID rid_{};              // if pointing to the table heap, the rid is valid
   uint32_t size_{0};
+  uint32_t capacity_{0};  // the size of the buffer, if allocated
   char *data_{nullptr};
 };
 
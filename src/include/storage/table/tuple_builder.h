@@ -0,0 +1,79 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// tuple_builder.h
+//
+// Identification: src/include/storage/table/tuple_builder.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <vector>
+
+#include "catalog/schema.h"
+#include "common/memory_arena.h"
+#include "storage/table/tuple.h"
+#include "type/value.h"
+
+namespace bustub {
+
+/**
+ * TupleBuilder serializes rows of one schema into tuples, for callers that make many of them, e.g. an insert. The
+ * layout of the schema is worked out once, when the builder is made: the type, offset and width of every column, and
+ * where the null bitmap goes. Building a tuple then sizes it from the lengths of its VARCHARs alone, and writes each
+ * column straight to its place in one pass, copying the bytes of its value without going through the virtual
+ * Value::SerializeTo, and without clearing the tuple first.
+ *
+ * The tuples are laid out exactly as by Tuple(values, schema), and can be written into a buffer the caller provides,
+ * e.g. one from an arena or the free space of a page. A builder holds no state of its own beyond the layout, so one
+ * may be shared by threads. The schema has to outlive it.
+ */
+class TupleBuilder {
+ public:
+  explicit TupleBuilder(const Schema *schema);
+
+  /** @return the size of the tuple of the values, one per column of the schema */
+  uint32_t SizeOf(const std::vector<Value> &values) const;
+
+  /**
+   * Serializes the values into a buffer.
+   * @param buffer where the tuple goes, e.g. memory of an arena or of a page
+   * @param capacity the bytes the buffer has room for
+   * @return the size of the tuple, or 0 if it does not fit, in which case nothing is written
+   */
+  uint32_t Build(const std::vector<Value> &values, char *buffer, uint32_t capacity) const;
+
+  /** @return a tuple of the values that owns its data */
+  Tuple Build(const std::vector<Value> &values) const;
+
+  /** @return a tuple of the values, as a view of data allocated from arena */
+  Tuple Build(const std::vector<Value> &values, MemoryArena *arena) const;
+
+  const Schema *GetSchema() const { return schema_; }
+
+ private:
+  /** Where a column goes in the tuple */
+  struct ColumnLayout {
+    uint32_t offset_;
+    /** the bytes it takes inline: its value's, or those of the slot that holds the offset of a VARCHAR's data */
+    uint32_t width_;
+    bool inlined_;
+  };
+
+  /** Writes the tuple of the values into size bytes of data, size being what SizeOf returned for them. */
+  void Serialize(const std::vector<Value> &values, char *data, uint32_t size) const;
+
+  const Schema *schema_;
+  std::vector<ColumnLayout> columns_;
+  /** the indexes of the VARCHAR columns, the only ones whose values change the size of a tuple */
+  std::vector<uint32_t> varlen_columns_;
+  /** the size of a tuple without the data of its VARCHARs */
+  uint32_t fixed_size_;
+  uint32_t bitmap_size_;
+};
+
+}  // namespace bustub
@@ -0,0 +1,112 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// version_store.h
+//
+// Identification: src/include/storage/table/version_store.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <deque>
+#include <optional>
+#include <shared_mutex>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "common/config.h"
+#include "common/macros.h"
+#include "common/rid.h"
+#include "concurrency/transaction.h"
+#include "storage/page/table_page.h"
+#include "storage/table/tuple.h"
+
+namespace bustub {
+
+/**
+ * VersionStore keeps the older versions of the tuples of a TableHeap, for multi-version concurrency control. The pages
+ * hold the newest version of every tuple, which may not be committed yet. Each write of a transaction that a
+ * TransactionManager began pushes an undo record, with the version before the write, on the version chain of its
+ * tuple, so that a SNAPSHOT transaction can undo the writes it does not see, newest first. A tuple without a chain is
+ * the same for every transaction.
+ *
+ * A chain is changed under the write latch of the page of its tuple, together with the tuple, and read under its read
+ * latch, so that a reader sees both as of the same moment. The records of a transaction get its commit timestamp as it
+ * commits, and are dropped if it aborts, once the pages no longer hold its writes. Collect drops the records no
+ * snapshot reaches any more: every transaction stops at a record committed at or before its snapshot, so the ones from
+ * the newest record committed at or before the oldest snapshot on are never undone again.
+ */
+class VersionStore {
+ public:
+  /** An undo record, of the version of a tuple before a write */
+  struct UndoLog {
+    txn_id_t writer_;
+    /** The timestamp the write was committed at, INVALID_TS until it is */
+    timestamp_t commit_ts_;
+    /** false if the write inserted the tuple */
+    bool existed_;
+    Tuple before_;
+  };
+
+  VersionStore() = default;
+
+  DISALLOW_COPY_AND_MOVE(VersionStore);
+
+  ~VersionStore() = default;
+
+  /** Pushes the undo record of a write of the tuple at rid, under the write latch of its page */
+  void Append(const RID &rid, txn_id_t writer, bool existed, const Tuple &before);
+
+  /**
+   * @return true if the SNAPSHOT transaction may not write the tuple at rid, as its newest version was written by
+   * another transaction that did not commit, or committed after the snapshot of txn; under the latch of its page
+   */
+  bool IsWriteConflict(const RID &rid, Transaction *txn);
+
+  /** Stamps the undo records of a committing transaction for the tuple at rid with its commit timestamp */
+  void Commit(const RID &rid, txn_id_t writer, timestamp_t commit_ts);
+
+  /** Drops the newest undo record of an aborted transaction for the tuple at rid, once the write was rolled back */
+  void Abort(const RID &rid, txn_id_t writer);
+
+  /**
+   * Finds the version of the tuple at rid that a transaction sees, under the latch of its page.
+   * @param current the tuple in the page, nullptr if the slot holds none or a deleted one
+   * @param[out] version a copy of the version the transaction sees
+   * @return false if the transaction sees no tuple at rid
+   */
+  bool GetVersion(const RID &rid, const Tuple *current, Transaction *txn, Tuple *version);
+
+  /**
+   * Finds the versions the transaction sees of the tuples of a page that have chains, under the latch of the page.
+   * @param[out] versions the versions by slot, std::nullopt for the tuples the transaction does not see
+   */
+  void GetPageVersions(TablePage *page, Transaction *txn, std::unordered_map<uint32_t, std::optional<Tuple>> *versions);
+
+  /** Drops the undo records that no transaction reading at or after the watermark undoes any more */
+  void Collect(timestamp_t watermark);
+
+  /** @return the undo records kept */
+  size_t GetVersionCount();
+
+ private:
+  /** The undo records of a tuple, oldest first */
+  using Chain = std::vector<UndoLog>;
+
+  /** @return true if the version as of the tuple in the page, undone back to what the transaction sees, exists */
+  static bool Resolve(const Chain &chain, const Tuple *current, Transaction *txn, Tuple *version);
+
+  std::shared_mutex latch_;
+  /** The chains of the tuples of each page, by slot */
+  std::unordered_map<page_id_t, std::unordered_map<uint32_t, Chain>> chains_;
+  /** The tuples that got committed records, and their commit timestamps, in commit order, for Collect */
+  std::deque<std::pair<timestamp_t, RID>> committed_;
+  size_t version_count_{0};
+};
+
+}  // namespace bustub
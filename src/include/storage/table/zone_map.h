@@ -0,0 +1,92 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// zone_map.h
+//
+// Identification: src/include/storage/table/zone_map.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <mutex>  // NOLINT
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
+#include "catalog/schema.h"
+#include "common/config.h"
+#include "storage/table/tuple.h"
+#include "type/value.h"
+
+namespace bustub {
+
+/**
+ * The values of a column a scan is after: those between min_ and max_, inclusive, where a bound that is not set does
+ * not bound them.
+ */
+struct ZoneRange {
+  uint32_t column_idx_;
+  std::optional<Value> min_;
+  std::optional<Value> max_;
+};
+
+/**
+ * ZoneMap keeps the smallest and largest value of some columns in each page of a TableHeap, so that a scan can skip
+ * the pages that cannot hold a row it is after without reading them. It is kept in memory only, next to the table,
+ * and knows the pages in the order of the table's list.
+ *
+ * The zones only ever widen: deletes do not shrink them, which makes a zone a bound of the values in a page rather
+ * than their exact range, and append-mostly tables, whose pages hold rows of a narrow range each, the best fit.
+ */
+class ZoneMap {
+ public:
+  /**
+   * Creates a zone map without pages.
+   * @param schema the schema of the table, which has to outlive the map
+   * @param column_idxs the columns to keep zones of
+   */
+  ZoneMap(const Schema *schema, std::vector<uint32_t> column_idxs);
+
+  /** Adds a page at the end of the table, with an empty zone. */
+  void AddPage(page_id_t page_id);
+
+  /** Widens the zone of a page to take in a tuple that was written to it. */
+  void Update(page_id_t page_id, const Tuple &tuple);
+
+  /** @return true if the map keeps zones of the column */
+  bool Covers(uint32_t column_idx) const;
+
+  /**
+   * @param page_id a page of the table, or INVALID_PAGE_ID at the end of the table
+   * @param ranges ranges of columns the map covers, all of which a row has to be within
+   * @return the first page of the table at or after page_id that may hold such a row, INVALID_PAGE_ID if there is none
+   */
+  page_id_t NextCandidate(page_id_t page_id, const std::vector<ZoneRange> &ranges);
+
+ private:
+  /** The values of the columns in a page; a column of only NULLs, or of no rows, has none. */
+  struct Zone {
+    std::vector<std::optional<Value>> min_;
+    std::vector<std::optional<Value>> max_;
+  };
+
+  /** @return true if a row of the zone may be within all of the ranges */
+  bool MayMatch(const Zone &zone, const std::vector<ZoneRange> &ranges) const;
+
+  /** @return the position of a column in column_idxs_ */
+  size_t PositionOf(uint32_t column_idx) const;
+
+  const Schema *schema_;
+  const std::vector<uint32_t> column_idxs_;
+  std::mutex latch_;
+  /** the pages in the order of the table, with their zones */
+  std::vector<page_id_t> pages_;
+  std::vector<Zone> zones_;
+  std::unordered_map<page_id_t, size_t> position_;
+};
+
+}  // namespace bustub
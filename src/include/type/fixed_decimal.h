@@ -0,0 +1,199 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// fixed_decimal.h
+//
+// Identification: src/include/type/fixed_decimal.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <string>
+#include <type_traits>
+
+#include "common/exception.h"
+#include "type/value.h"
+
+namespace bustub {
+
+namespace decimal {
+
+/** The most digits a FixedDecimal can have, which is what fits a 128-bit integer */
+static constexpr int MAX_PRECISION = 38;
+
+/** @return 10^n */
+constexpr __int128 Pow10(int n) {
+  __int128 result = 1;
+  for (int i = 0; i < n; i++) {
+    result *= 10;
+  }
+  return result;
+}
+
+/** The integer a decimal of the precision is kept as: an int64_t for up to 18 digits, a __int128 beyond */
+template <int Precision>
+using StorageOf = std::conditional_t<Precision <= 18, int64_t, __int128>;
+
+}  // namespace decimal
+
+/**
+ * FixedDecimal<Precision, Scale> is an exact DECIMAL(Precision, Scale): a number of at most Precision digits, Scale of
+ * them after the point, kept as the integer number of 10^-Scale it is. The DECIMAL Values are doubles, which round
+ * e.g. money as they add it up; a FixedDecimal does not, and its add and multiply are a single checked integer
+ * instruction, resolved at compile time.
+ *
+ * Operations that would leave the precision return false instead of a result, as the __builtin_*_overflow they are
+ * made of do. A SUM is best accumulated in a FixedDecimal<decimal::MAX_PRECISION, Scale>, which Widen makes.
+ */
+template <int Precision, int Scale>
+class FixedDecimal {
+  static_assert(0 < Precision && Precision <= decimal::MAX_PRECISION, "a decimal has between 1 and 38 digits");
+  static_assert(0 <= Scale && Scale <= Precision, "a decimal cannot have more digits after the point than it has");
+
+ public:
+  using StorageType = decimal::StorageOf<Precision>;
+  /** The unscaled value of 1 */
+  static constexpr StorageType FACTOR = static_cast<StorageType>(decimal::Pow10(Scale));
+  /** The unscaled values are within (-LIMIT, LIMIT) */
+  static constexpr StorageType LIMIT = static_cast<StorageType>(decimal::Pow10(Precision));
+
+  /** Creates a zero */
+  FixedDecimal() = default;
+
+  /** @return false if the unscaled value has more than Precision digits */
+  static bool FromUnscaled(StorageType unscaled, FixedDecimal *result) {
+    if (!InRange(unscaled)) {
+      return false;
+    }
+    result->unscaled_ = unscaled;
+    return true;
+  }
+
+  /** Converts a double, rounded to the nearest 10^-Scale. @return false if it does not fit the precision */
+  static bool FromDouble(double value, FixedDecimal *result) {
+    double scaled = std::round(value * static_cast<double>(FACTOR));
+    if (!(std::fabs(scaled) < static_cast<double>(LIMIT))) {
+      return false;
+    }
+    return FromUnscaled(static_cast<StorageType>(scaled), result);
+  }
+
+  /**
+   * Converts an INTEGER, BIGINT or DECIMAL Value; a DECIMAL is rounded to the nearest 10^-Scale.
+   * @return false if the value is null or does not fit the precision
+   */
+  static bool FromValue(const Value &value, FixedDecimal *result) {
+    if (value.IsNull()) {
+      return false;
+    }
+    switch (value.GetTypeId()) {
+      case TypeId::INTEGER:
+      case TypeId::BIGINT: {
+        StorageType unscaled;
+        auto integer = value.GetTypeId() == TypeId::INTEGER ? value.GetAs<int32_t>() : value.GetAs<int64_t>();
+        return !__builtin_mul_overflow(integer, FACTOR, &unscaled) && FromUnscaled(unscaled, result);
+      }
+      case TypeId::DECIMAL:
+        return FromDouble(value.GetAs<double>(), result);
+      default:
+        throw Exception(ExceptionType::INCOMPATIBLE_TYPE, "only numbers can be made decimals");
+    }
+  }
+
+  /** @return the integer number of 10^-Scale the decimal is */
+  StorageType GetUnscaled() const { return unscaled_; }
+
+  /** @return the nearest double */
+  double ToDouble() const { return static_cast<double>(unscaled_) / static_cast<double>(FACTOR); }
+
+  /** @return the decimal as a DECIMAL Value, which is a double */
+  Value ToValue() const { return Value(TypeId::DECIMAL, ToDouble()); }
+
+  /** @return the decimal with all of its Scale digits after the point, e.g. "-12.30" for -12.3 of scale 2 */
+  std::string ToString() const {
+    using Unsigned = std::make_unsigned_t<StorageType>;
+    Unsigned magnitude = unscaled_ < 0 ? -static_cast<Unsigned>(unscaled_) : static_cast<Unsigned>(unscaled_);
+    std::string digits;
+    for (int i = 0; magnitude != 0 || i <= Scale; i++) {
+      if (i == Scale && Scale != 0) {
+        digits.push_back('.');
+      }
+      digits.push_back(static_cast<char>('0' + magnitude % 10));
+      magnitude /= 10;
+    }
+    if (unscaled_ < 0) {
+      digits.push_back('-');
+    }
+    return std::string(digits.rbegin(), digits.rend());
+  }
+
+  /** @return false if this + other leaves the precision */
+  bool Add(FixedDecimal other, FixedDecimal *result) const {
+    StorageType sum;
+    return !__builtin_add_overflow(unscaled_, other.unscaled_, &sum) && FromUnscaled(sum, result);
+  }
+
+  /** @return false if this - other leaves the precision */
+  bool Subtract(FixedDecimal other, FixedDecimal *result) const {
+    StorageType difference;
+    return !__builtin_sub_overflow(unscaled_, other.unscaled_, &difference) && FromUnscaled(difference, result);
+  }
+
+  /** The product of a DECIMAL(Precision, Scale) and a DECIMAL(P, S), which is exact, as far as the digits go */
+  template <int P, int S>
+  using ProductType = FixedDecimal<std::min(Precision + P, decimal::MAX_PRECISION), Scale + S>;
+
+  /** @return false if this * other leaves the precision of the product */
+  template <int P, int S>
+  bool Multiply(FixedDecimal<P, S> other, ProductType<P, S> *result) const {
+    using Product = typename ProductType<P, S>::StorageType;
+    Product product;
+    return !__builtin_mul_overflow(static_cast<Product>(unscaled_), static_cast<Product>(other.GetUnscaled()),
+                                   &product) &&
+           ProductType<P, S>::FromUnscaled(product, result);
+  }
+
+  /** @return false if the count is not positive; otherwise this / count, rounded half away from zero, e.g. an AVG */
+  bool Divide(int64_t count, FixedDecimal *result) const {
+    if (count <= 0) {
+      return false;
+    }
+    StorageType quotient = unscaled_ / count;
+    StorageType remainder = unscaled_ % count;
+    if (2 * (remainder < 0 ? -remainder : remainder) >= count) {
+      quotient += unscaled_ < 0 ? -1 : 1;
+    }
+    result->unscaled_ = quotient;
+    return true;
+  }
+
+  /** @return the decimal with more digits, which always fits */
+  template <int P = decimal::MAX_PRECISION>
+  FixedDecimal<P, Scale> Widen() const {
+    static_assert(P >= Precision, "widening cannot drop digits");
+    FixedDecimal<P, Scale> result;
+    FixedDecimal<P, Scale>::FromUnscaled(unscaled_, &result);
+    return result;
+  }
+
+  bool operator==(const FixedDecimal &other) const { return unscaled_ == other.unscaled_; }
+  bool operator!=(const FixedDecimal &other) const { return unscaled_ != other.unscaled_; }
+  bool operator<(const FixedDecimal &other) const { return unscaled_ < other.unscaled_; }
+  bool operator<=(const FixedDecimal &other) const { return unscaled_ <= other.unscaled_; }
+  bool operator>(const FixedDecimal &other) const { return unscaled_ > other.unscaled_; }
+  bool operator>=(const FixedDecimal &other) const { return unscaled_ >= other.unscaled_; }
+
+ private:
+  static bool InRange(StorageType unscaled) { return -LIMIT < unscaled && unscaled < LIMIT; }
+
+  StorageType unscaled_{0};
+};
+
+}  // namespace bustub
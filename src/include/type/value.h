@@ -16,6 +16,7 @@
 #include <string>
 #include <utility>
 
+#include "common/memory_arena.h"
 #include "type/limits.h"
 #include "type/type.h"
 
@@ -39,9 +40,21 @@ class Value {
   friend class TimestampType;
   friend class BooleanType;
   friend class VarlenType;
+  // reads the values it serializes in place
+  friend class TupleBuilder;
 
  public:
-  explicit Value(const TypeId type) : manage_data_(false), type_id_(type) { size_.len_ = BUSTUB_VALUE_NULL; }
+  /**
+   * Owned VARCHAR values of up to this many bytes, the terminating NUL included, are kept inside the Value instead of
+   * on the heap, so that making and copying them allocates nothing.
+   */
+  static constexpr uint32_t INLINE_LENGTH = 16;
+  /** The number of leading bytes of a longer VARCHAR that are kept next to its pointer, to decide comparisons early */
+  static constexpr uint32_t PREFIX_LENGTH = INLINE_LENGTH - sizeof(char *);
+
+  explicit Value(const TypeId type) : manage_data_(false), inlined_(false), type_id_(type) {
+    size_.len_ = BUSTUB_VALUE_NULL;
+  }
   // BOOLEAN and TINYINT
   Value(TypeId type, int8_t i);
   // DECIMAL
@@ -57,6 +70,8 @@ class Value {
   Value(TypeId type, uint64_t i);
   // VARCHAR
   Value(TypeId type, const char *data, uint32_t len, bool manage_data);
+  // VARCHAR whose data is copied into arena; the value does not own it, and is valid for as long as the arena is
+  Value(TypeId type, const char *data, uint32_t len, MemoryArena *arena);
   Value(TypeId type, const std::string &data);
 
   Value() : Value(TypeId::INVALID) {}
@@ -68,6 +83,7 @@ class Value {
     std::swap(first.value_, second.value_);
     std::swap(first.size_, second.size_);
     std::swap(first.manage_data_, second.manage_data_);
+    std::swap(first.inlined_, second.inlined_);
     std::swap(first.type_id_, second.type_id_);
   }
   // check whether value is integer
@@ -149,6 +165,8 @@ class Value {
     uint64_t timestamp_;
     char *varlen_;
     const char *const_varlen_;
+    // a short VARCHAR itself, or the pointer of a longer one followed by its prefix
+    char inline_[INLINE_LENGTH];
   } value_;
 
   union {
@@ -156,7 +174,14 @@ class Value {
     TypeId elem_type_id_;
   } size_;
 
+  // Returns the first min(length, PREFIX_LENGTH) bytes of a non-null VARCHAR, which are in the Value either way
+  const char *GetPrefix() const { return inlined_ ? value_.inline_ : value_.inline_ + sizeof(char *); }
+  // Sets the pointer of a VARCHAR that is not inlined, and copies its prefix next to it
+  void SetVarlen(const char *data, uint32_t len);
+
   bool manage_data_;
+  // Whether a VARCHAR is kept in value_.inline_ rather than behind value_.varlen_
+  bool inlined_;
   // The data type
   TypeId type_id_;
 };
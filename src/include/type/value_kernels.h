@@ -0,0 +1,198 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// value_kernels.h
+//
+// Identification: src/include/type/value_kernels.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <type_traits>
+
+#include "common/exception.h"
+#include "common/macros.h"
+#include "type/value.h"
+#include "type/value_factory.h"
+
+namespace bustub {
+
+/**
+ * Kernels compare and combine two Values of the same fixed-width numeric type (INTEGER, BIGINT or DECIMAL) inline,
+ * with the type known at compile time, instead of through the virtual methods of Type that Value dispatches to. They
+ * return what the Value methods would, NULLs and overflow included.
+ *
+ * A caller binds a kernel once, when it knows the types of its operands, e.g. when an expression is built, and calls
+ * it for every row; Bind* returns nullptr for types without a kernel, for which the caller keeps to the Value methods.
+ */
+using CompareKernel = CmpBool (*)(const Value &left, const Value &right);
+using ArithmeticKernel = Value (*)(const Value &left, const Value &right);
+
+namespace kernel {
+
+/** The C++ type a Value of a fixed-width numeric type keeps its value as. */
+template <TypeId T>
+struct NativeType;
+template <>
+struct NativeType<TypeId::INTEGER> {
+  using type = int32_t;
+};
+template <>
+struct NativeType<TypeId::BIGINT> {
+  using type = int64_t;
+};
+template <>
+struct NativeType<TypeId::DECIMAL> {
+  using type = double;
+};
+template <TypeId T>
+using NativeTypeT = typename NativeType<T>::type;
+
+/** @return left op right, for an op such as std::less */
+template <TypeId T, typename Op>
+inline CmpBool Compare(const Value &left, const Value &right) {
+  BUSTUB_ASSERT(left.GetTypeId() == T && right.GetTypeId() == T, "the kernel is bound to another type");
+  if (left.IsNull() || right.IsNull()) {
+    return CmpBool::CmpNull;
+  }
+  return Op{}(left.GetAs<NativeTypeT<T>>(), right.GetAs<NativeTypeT<T>>()) ? CmpBool::CmpTrue : CmpBool::CmpFalse;
+}
+
+/** The ops of Arithmetic, with the overflow checks of the integer types. */
+struct AddOp {
+  template <typename N>
+  static bool Apply(N x, N y, N *result) {
+    if constexpr (std::is_integral_v<N>) {
+      return !__builtin_add_overflow(x, y, result);
+    }
+    *result = x + y;
+    return true;
+  }
+};
+struct SubtractOp {
+  template <typename N>
+  static bool Apply(N x, N y, N *result) {
+    if constexpr (std::is_integral_v<N>) {
+      return !__builtin_sub_overflow(x, y, result);
+    }
+    *result = x - y;
+    return true;
+  }
+};
+struct MultiplyOp {
+  template <typename N>
+  static bool Apply(N x, N y, N *result) {
+    if constexpr (std::is_integral_v<N>) {
+      return !__builtin_mul_overflow(x, y, result);
+    }
+    *result = x * y;
+    return true;
+  }
+};
+
+/** @return left op right, NULL if either is NULL */
+template <TypeId T, typename Op>
+inline Value Arithmetic(const Value &left, const Value &right) {
+  BUSTUB_ASSERT(left.GetTypeId() == T && right.GetTypeId() == T, "the kernel is bound to another type");
+  if (left.IsNull() || right.IsNull()) {
+    return ValueFactory::GetNullValueByType(T);
+  }
+  NativeTypeT<T> result;
+  if (!Op::Apply(left.GetAs<NativeTypeT<T>>(), right.GetAs<NativeTypeT<T>>(), &result)) {
+    throw Exception(ExceptionType::OUT_OF_RANGE, "Numeric value out of range.");
+  }
+  return Value(T, result);
+}
+
+/** @return the smaller of left and right if is_min, the larger otherwise, NULL if either is NULL */
+template <TypeId T, bool is_min>
+inline Value MinMax(const Value &left, const Value &right) {
+  BUSTUB_ASSERT(left.GetTypeId() == T && right.GetTypeId() == T, "the kernel is bound to another type");
+  if (left.IsNull() || right.IsNull()) {
+    return ValueFactory::GetNullValueByType(T);
+  }
+  auto x = left.GetAs<NativeTypeT<T>>();
+  auto y = right.GetAs<NativeTypeT<T>>();
+  return Value(T, (x <= y) == is_min ? x : y);
+}
+
+/** @return Kernel<TypeId> of the type of both operands, nullptr if they differ or have no kernel */
+template <template <TypeId> typename Kernel, typename Fn>
+inline Fn Bind(TypeId left, TypeId right) {
+  if (left != right) {
+    return nullptr;
+  }
+  switch (left) {
+    case TypeId::INTEGER:
+      return &Kernel<TypeId::INTEGER>::Run;
+    case TypeId::BIGINT:
+      return &Kernel<TypeId::BIGINT>::Run;
+    case TypeId::DECIMAL:
+      return &Kernel<TypeId::DECIMAL>::Run;
+    default:
+      return nullptr;
+  }
+}
+
+template <typename Op>
+struct CompareOf {
+  template <TypeId T>
+  struct Kernel {
+    static CmpBool Run(const Value &left, const Value &right) { return Compare<T, Op>(left, right); }
+  };
+};
+template <typename Op>
+struct ArithmeticOf {
+  template <TypeId T>
+  struct Kernel {
+    static Value Run(const Value &left, const Value &right) { return Arithmetic<T, Op>(left, right); }
+  };
+};
+template <bool is_min>
+struct MinMaxOf {
+  template <TypeId T>
+  struct Kernel {
+    static Value Run(const Value &left, const Value &right) { return MinMax<T, is_min>(left, right); }
+  };
+};
+
+}  // namespace kernel
+
+/** @return the kernel of left op right, for an op such as std::less<>, nullptr if the types have none */
+template <typename Op>
+inline CompareKernel BindCompare(TypeId left, TypeId right) {
+  return kernel::Bind<kernel::CompareOf<Op>::template Kernel, CompareKernel>(left, right);
+}
+
+/** @return the kernel of Value::Add, nullptr if the types have none */
+inline ArithmeticKernel BindAdd(TypeId left, TypeId right) {
+  return kernel::Bind<kernel::ArithmeticOf<kernel::AddOp>::Kernel, ArithmeticKernel>(left, right);
+}
+
+/** @return the kernel of Value::Subtract, nullptr if the types have none */
+inline ArithmeticKernel BindSubtract(TypeId left, TypeId right) {
+  return kernel::Bind<kernel::ArithmeticOf<kernel::SubtractOp>::Kernel, ArithmeticKernel>(left, right);
+}
+
+/** @return the kernel of Value::Multiply, nullptr if the types have none */
+inline ArithmeticKernel BindMultiply(TypeId left, TypeId right) {
+  return kernel::Bind<kernel::ArithmeticOf<kernel::MultiplyOp>::Kernel, ArithmeticKernel>(left, right);
+}
+
+/** @return the kernel of Value::Min, nullptr if the types have none */
+inline ArithmeticKernel BindMin(TypeId left, TypeId right) {
+  return kernel::Bind<kernel::MinMaxOf<true>::Kernel, ArithmeticKernel>(left, right);
+}
+
+/** @return the kernel of Value::Max, nullptr if the types have none */
+inline ArithmeticKernel BindMax(TypeId left, TypeId right) {
+  return kernel::Bind<kernel::MinMaxOf<false>::Kernel, ArithmeticKernel>(left, right);
+}
+
+}  // namespace bustub
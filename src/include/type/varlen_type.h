@@ -59,5 +59,9 @@ class VarlenType : public Type {
 
   // Create a copy of this value
   Value Copy(const Value &val) const override;
+
+ private:
+  // Compares two non-null VARCHARs like TypeUtil::CompareStrings, from their prefixes when those differ
+  static int CompareVarchars(const Value &left, const Value &right);
 };
 }  // namespace bustub
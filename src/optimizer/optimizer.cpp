@@ -0,0 +1,756 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// optimizer.cpp
+//
+// Identification: src/optimizer/optimizer.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "optimizer/optimizer.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <utility>
+
+#include "common/exception.h"
+#include "execution/expressions/arithmetic_expression.h"
+#include "execution/expressions/comparison_expression.h"
+#include "execution/expressions/conjunction_expression.h"
+#include "execution/expressions/constant_value_expression.h"
+#include "execution/expressions/parameter_value_expression.h"
+#include "execution/plans/aggregation_plan.h"
+#include "execution/plans/delete_plan.h"
+#include "execution/plans/distinct_plan.h"
+#include "execution/plans/hash_join_plan.h"
+#include "execution/plans/index_scan_plan.h"
+#include "execution/plans/insert_plan.h"
+#include "execution/plans/limit_plan.h"
+#include "execution/plans/nested_index_join_plan.h"
+#include "execution/plans/nested_loop_join_plan.h"
+#include "execution/plans/projection_plan.h"
+#include "execution/plans/sample_scan_plan.h"
+#include "execution/plans/sort_plan.h"
+#include "execution/plans/update_plan.h"
+
+namespace bustub {
+
+namespace {
+
+/** @return true if every column of the expression is of the given side of a join, and it has at least one */
+bool RefersOnlyTo(const AbstractExpression *expr, uint32_t tuple_idx, bool *has_column) {
+  if (const auto *column = dynamic_cast<const ColumnValueExpression *>(expr); column != nullptr) {
+    *has_column = true;
+    return column->GetTupleIdx() == tuple_idx;
+  }
+  for (const AbstractExpression *child : expr->GetChildren()) {
+    if (!RefersOnlyTo(child, tuple_idx, has_column)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool IsOfSide(const AbstractExpression *expr, uint32_t tuple_idx) {
+  bool has_column = false;
+  return RefersOnlyTo(expr, tuple_idx, &has_column) && has_column;
+}
+
+bool IsConstant(const AbstractExpression *expr) {
+  return dynamic_cast<const ConstantValueExpression *>(expr) != nullptr ||
+         dynamic_cast<const ParameterValueExpression *>(expr) != nullptr;
+}
+
+bool IsInteger(TypeId type) {
+  return type == TypeId::TINYINT || type == TypeId::SMALLINT || type == TypeId::INTEGER || type == TypeId::BIGINT;
+}
+
+/** @return true if the expression is a constant of the value true */
+bool IsTrue(const AbstractExpression *expr) {
+  if (dynamic_cast<const ConstantValueExpression *>(expr) == nullptr || expr->GetReturnType() != TypeId::BOOLEAN) {
+    return false;
+  }
+  Value value = expr->Evaluate(nullptr, nullptr);
+  return !value.IsNull() && value.GetAs<bool>();
+}
+
+/** @return true if the expression is a constant of the value false */
+bool IsFalse(const AbstractExpression *expr) {
+  if (dynamic_cast<const ConstantValueExpression *>(expr) == nullptr || expr->GetReturnType() != TypeId::BOOLEAN) {
+    return false;
+  }
+  Value value = expr->Evaluate(nullptr, nullptr);
+  return !value.IsNull() && !value.GetAs<bool>();
+}
+
+/** @return the comparison of (right comp_type left) that is the same as (left comp_type right) */
+ComparisonType Mirror(ComparisonType comp_type) {
+  switch (comp_type) {
+    case ComparisonType::LessThan:
+      return ComparisonType::GreaterThan;
+    case ComparisonType::LessThanOrEqual:
+      return ComparisonType::GreaterThanOrEqual;
+    case ComparisonType::GreaterThan:
+      return ComparisonType::LessThan;
+    case ComparisonType::GreaterThanOrEqual:
+      return ComparisonType::LessThanOrEqual;
+    default:
+      return comp_type;
+  }
+}
+
+}  // namespace
+
+const AbstractPlanNode *Optimizer::Optimize(const AbstractPlanNode *plan) {
+  plan = Transform(plan, &Optimizer::SimplifyNode);
+  return Transform(Transform(plan, &Optimizer::RewriteNode), &Optimizer::SelectScan);
+}
+
+const AbstractPlanNode *Optimizer::Transform(const AbstractPlanNode *plan, Rule rule) {
+  std::vector<const AbstractPlanNode *> children;
+  bool changed = false;
+  for (const AbstractPlanNode *child : plan->GetChildren()) {
+    children.push_back(Transform(child, rule));
+    changed = changed || children.back() != child;
+  }
+  if (changed) {
+    const AbstractPlanNode *rebuilt = WithChildren(plan, std::move(children));
+    if (rebuilt == nullptr) {
+      return plan;
+    }
+    plan = rebuilt;
+  }
+  return (this->*rule)(plan);
+}
+
+const AbstractPlanNode *Optimizer::WithChildren(const AbstractPlanNode *plan,
+                                                std::vector<const AbstractPlanNode *> children) {
+  const Schema *output = plan->OutputSchema();
+  switch (plan->GetType()) {
+    case PlanType::Projection:
+      return Own(std::make_unique<ProjectionPlanNode>(output, children[0]));
+    case PlanType::Distinct:
+      return Own(std::make_unique<DistinctPlanNode>(output, children[0]));
+    case PlanType::Limit: {
+      const auto *limit = dynamic_cast<const LimitPlanNode *>(plan);
+      return Own(std::make_unique<LimitPlanNode>(output, children[0], limit->GetLimit(), limit->GetOffset()));
+    }
+    case PlanType::Sort: {
+      auto order_bys = dynamic_cast<const SortPlanNode *>(plan)->GetOrderBys();
+      return Own(std::make_unique<SortPlanNode>(output, children[0], std::move(order_bys)));
+    }
+    case PlanType::Aggregation: {
+      const auto *agg = dynamic_cast<const AggregationPlanNode *>(plan);
+      auto group_bys = agg->GetGroupBys();
+      auto aggregates = agg->GetAggregates();
+      auto agg_types = agg->GetAggregateTypes();
+      auto percentiles = agg->GetPercentiles();
+      return Own(std::make_unique<AggregationPlanNode>(output, children[0], agg->GetHaving(), std::move(group_bys),
+                                                       std::move(aggregates), std::move(agg_types),
+                                                       agg->GetNumThreads(), std::move(percentiles)));
+    }
+    case PlanType::NestedLoopJoin: {
+      const auto *join = dynamic_cast<const NestedLoopJoinPlanNode *>(plan);
+      return Own(std::make_unique<NestedLoopJoinPlanNode>(output, std::move(children), join->Predicate()));
+    }
+    case PlanType::HashJoin: {
+      const auto *join = dynamic_cast<const HashJoinPlanNode *>(plan);
+      auto left_keys = join->GetLeftKeys();
+      auto right_keys = join->GetRightKeys();
+      return Own(std::make_unique<HashJoinPlanNode>(output, std::move(children), std::move(left_keys),
+                                                    std::move(right_keys), join->GetNumThreads(),
+                                                    join->GetJoinType()));
+    }
+    case PlanType::NestedIndexJoin: {
+      const auto *join = dynamic_cast<const NestedIndexJoinPlanNode *>(plan);
+      return Own(std::make_unique<NestedIndexJoinPlanNode>(output, std::move(children), join->Predicate(),
+                                                           join->GetInnerTableOid(), join->GetIndexName(),
+                                                           join->OuterTableSchema(), join->InnerTableSchema(),
+                                                           join->GetJoinType()));
+    }
+    case PlanType::Insert:
+      return Own(std::make_unique<InsertPlanNode>(children[0], dynamic_cast<const InsertPlanNode *>(plan)->TableOid()));
+    case PlanType::Delete:
+      return Own(std::make_unique<DeletePlanNode>(children[0], dynamic_cast<const DeletePlanNode *>(plan)->TableOid()));
+    case PlanType::Update: {
+      const auto *update = dynamic_cast<const UpdatePlanNode *>(plan);
+      return Own(std::make_unique<UpdatePlanNode>(children[0], update->TableOid(), *update->GetUpdateAttr()));
+    }
+    default:
+      return nullptr;
+  }
+}
+
+const AbstractPlanNode *Optimizer::RewriteNode(const AbstractPlanNode *plan) {
+  switch (plan->GetType()) {
+    case PlanType::Projection:
+      return PruneProjection(plan);
+    case PlanType::Limit:
+      return PushDownLimit(plan);
+    case PlanType::NestedLoopJoin:
+      return SelectJoin(PushDownJoinPredicate(plan));
+    default:
+      return plan;
+  }
+}
+
+const AbstractPlanNode *Optimizer::SimplifyNode(const AbstractPlanNode *plan) {
+  // a node evaluates the expressions of its own only, so sharing ones with other nodes would gain nothing
+  interned_.clear();
+  switch (plan->GetType()) {
+    case PlanType::SeqScan: {
+      const auto *scan = dynamic_cast<const SeqScanPlanNode *>(plan);
+      const AbstractExpression *predicate = Simplify(scan->GetPredicate());
+      const Schema *output = SimplifySchema(scan->OutputSchema());
+      if (IsTrue(predicate)) {
+        predicate = nullptr;
+      }
+      if (predicate == scan->GetPredicate() && output == scan->OutputSchema()) {
+        return plan;
+      }
+      return Own(std::make_unique<SeqScanPlanNode>(output, predicate, scan->GetTableOid()));
+    }
+    case PlanType::NestedLoopJoin: {
+      const auto *join = dynamic_cast<const NestedLoopJoinPlanNode *>(plan);
+      const AbstractExpression *predicate = Simplify(join->Predicate());
+      const Schema *output = SimplifySchema(join->OutputSchema());
+      if (IsTrue(predicate)) {
+        predicate = nullptr;
+      }
+      if (predicate == join->Predicate() && output == join->OutputSchema()) {
+        return plan;
+      }
+      std::vector<const AbstractPlanNode *> children = join->GetChildren();
+      return Own(std::make_unique<NestedLoopJoinPlanNode>(output, std::move(children), predicate));
+    }
+    case PlanType::Projection: {
+      const auto *projection = dynamic_cast<const ProjectionPlanNode *>(plan);
+      const Schema *output = SimplifySchema(projection->OutputSchema());
+      if (output == projection->OutputSchema()) {
+        return plan;
+      }
+      return Own(std::make_unique<ProjectionPlanNode>(output, projection->GetChildPlan()));
+    }
+    default:
+      return plan;
+  }
+}
+
+const AbstractPlanNode *Optimizer::PushDownJoinPredicate(const AbstractPlanNode *plan) {
+  const auto *join = dynamic_cast<const NestedLoopJoinPlanNode *>(plan);
+  const AbstractExpression *predicate = join->Predicate();
+  if (predicate == nullptr) {
+    return plan;
+  }
+  for (uint32_t side = 0; side < 2; side++) {
+    const auto *scan = dynamic_cast<const SeqScanPlanNode *>(join->GetChildAt(side));
+    if (!IsOfSide(predicate, side) || scan == nullptr || scan->GetPredicate() != nullptr) {
+      continue;
+    }
+    const AbstractExpression *scan_predicate =
+        Rewrite(predicate, [&](const ColumnValueExpression *column) { return ScanColumn(scan, column->GetColIdx()); });
+    if (scan_predicate == nullptr) {
+      return plan;
+    }
+    std::vector<const AbstractPlanNode *> children = join->GetChildren();
+    children[side] = Own(std::make_unique<SeqScanPlanNode>(scan->OutputSchema(), scan_predicate, scan->GetTableOid()));
+    return Own(std::make_unique<NestedLoopJoinPlanNode>(join->OutputSchema(), std::move(children), nullptr));
+  }
+  return plan;
+}
+
+const AbstractPlanNode *Optimizer::PushDownLimit(const AbstractPlanNode *plan) {
+  const auto *limit = dynamic_cast<const LimitPlanNode *>(plan);
+  const auto *projection = dynamic_cast<const ProjectionPlanNode *>(limit->GetChildPlan());
+  if (projection == nullptr) {
+    return plan;
+  }
+  // a projection makes one row of each row of its child, so it makes as many of the first rows of its child as the
+  // limit lets through
+  const AbstractPlanNode *child = projection->GetChildPlan();
+  const AbstractPlanNode *pushed = PushDownLimit(
+      Own(std::make_unique<LimitPlanNode>(child->OutputSchema(), child, limit->GetLimit(), limit->GetOffset())));
+  return Own(std::make_unique<ProjectionPlanNode>(projection->OutputSchema(), pushed));
+}
+
+const AbstractPlanNode *Optimizer::PruneProjection(const AbstractPlanNode *plan) {
+  const auto *projection = dynamic_cast<const ProjectionPlanNode *>(plan);
+  const auto *scan = dynamic_cast<const SeqScanPlanNode *>(projection->GetChildPlan());
+  if (scan == nullptr) {
+    return plan;
+  }
+  const Schema *output = projection->OutputSchema();
+  uint32_t scan_columns = scan->OutputSchema()->GetColumnCount();
+  ColumnMap map = [&](const ColumnValueExpression *column) -> const AbstractExpression * {
+    return column->GetColIdx() < scan_columns ? ScanColumn(scan, column->GetColIdx()) : nullptr;
+  };
+  std::vector<const AbstractExpression *> exprs;
+  for (uint32_t i = 0; i < output->GetColumnCount(); i++) {
+    const AbstractExpression *expr = output->GetColumn(i).GetExpr();
+    exprs.push_back(expr == nullptr ? (i < scan_columns ? ScanColumn(scan, i) : nullptr) : Rewrite(expr, map));
+    if (exprs.back() == nullptr) {
+      return plan;
+    }
+  }
+  return Own(std::make_unique<SeqScanPlanNode>(MakeSchema(output, exprs), scan->GetPredicate(), scan->GetTableOid()));
+}
+
+const AbstractPlanNode *Optimizer::SelectScan(const AbstractPlanNode *plan) {
+  const auto *scan = dynamic_cast<const SeqScanPlanNode *>(plan);
+  if (scan == nullptr) {
+    return plan;
+  }
+  TableMetadata *table_info = catalog_->GetTable(scan->GetTableOid());
+  const Schema *output = scan->OutputSchema();
+  const AbstractExpression *predicate = scan->GetPredicate();
+  std::vector<IndexInfo *> indexes = catalog_->GetTableIndexes(table_info->name_);
+  // the indexes that the predicate bounds the keys of are tried before those that would be read in whole
+  for (bool ranged : {true, false}) {
+    for (IndexInfo *index_info : indexes) {
+      // an index being built does not have all the rows yet
+      if (!index_info->IsValid()) {
+        continue;
+      }
+      const Index *index = index_info->index_.get();
+      const IndexMetadata *metadata = index->GetMetadata();
+      const std::vector<uint32_t> &key_attrs = metadata->GetKeyAttrs();
+      IndexKeyRange range = KeyRangeOf(predicate, key_attrs);
+      bool has_range = range.lower_ != nullptr || range.upper_ != nullptr;
+      if (has_range != ranged || (!index->IsOrdered() && !range.IsEquality())) {
+        continue;
+      }
+
+      // a covered scan reads the keys only; but the keys of an index that is not much narrower than its table are
+      // not worth reading in whole in place of the heap
+      if (!metadata->HasNormalizedKeys() && (ranged || key_attrs.size() * 2 <= table_info->schema_.GetColumnCount())) {
+        ColumnMap map = [&](const ColumnValueExpression *column) -> const AbstractExpression * {
+          auto key = std::find(key_attrs.begin(), key_attrs.end(), column->GetColIdx());
+          if (key == key_attrs.end()) {
+            return nullptr;
+          }
+          return MakeColumn(0, static_cast<uint32_t>(key - key_attrs.begin()), column->GetReturnType());
+        };
+        std::vector<const AbstractExpression *> exprs;
+        for (uint32_t i = 0; i < output->GetColumnCount(); i++) {
+          exprs.push_back(Rewrite(ScanColumn(scan, i), map));
+          if (exprs.back() == nullptr) {
+            break;
+          }
+        }
+        const AbstractExpression *key_predicate = predicate == nullptr ? nullptr : Rewrite(predicate, map);
+        if (!exprs.empty() && exprs.back() != nullptr && (predicate == nullptr || key_predicate != nullptr)) {
+          return Own(std::make_unique<IndexScanPlanNode>(MakeSchema(output, exprs), key_predicate,
+                                                         index_info->index_oid_, true, range));
+        }
+      }
+
+      // every row of the range is looked up in the heap, one page at a time, which only pays for few of them
+      if (ranged && EstimateRangeSelectivity(predicate, table_info) <= INDEX_SCAN_SELECTIVITY) {
+        std::vector<const AbstractExpression *> exprs;
+        for (uint32_t i = 0; i < output->GetColumnCount(); i++) {
+          exprs.push_back(ScanColumn(scan, i));
+        }
+        return Own(std::make_unique<IndexScanPlanNode>(MakeSchema(output, exprs), predicate, index_info->index_oid_,
+                                                       false, range));
+      }
+    }
+  }
+  return plan;
+}
+
+IndexKeyRange Optimizer::KeyRangeOf(const AbstractExpression *predicate, const std::vector<uint32_t> &key_attrs) {
+  const auto *comparison = dynamic_cast<const ComparisonExpression *>(predicate);
+  if (comparison == nullptr || key_attrs.size() != 1) {
+    return {};
+  }
+  const AbstractExpression *left = comparison->GetChildAt(0);
+  const AbstractExpression *right = comparison->GetChildAt(1);
+  ComparisonType comp_type = comparison->GetComparisonType();
+  if (IsConstant(left)) {
+    std::swap(left, right);
+    comp_type = Mirror(comp_type);
+  }
+  const auto *column = dynamic_cast<const ColumnValueExpression *>(left);
+  if (column == nullptr || column->GetColIdx() != key_attrs[0] || !IsConstant(right)) {
+    return {};
+  }
+  // a bound of another type is cast to the type of the key, which only keeps its order for integers
+  TypeId column_type = column->GetReturnType();
+  TypeId bound_type = right->GetReturnType();
+  if (column_type != bound_type && !(IsInteger(column_type) && IsInteger(bound_type))) {
+    return {};
+  }
+  switch (comp_type) {
+    case ComparisonType::Equal:
+      return {right, true, right, true};
+    case ComparisonType::LessThan:
+      return {nullptr, true, right, false};
+    case ComparisonType::LessThanOrEqual:
+      return {nullptr, true, right, true};
+    case ComparisonType::GreaterThan:
+      return {right, false, nullptr, true};
+    case ComparisonType::GreaterThanOrEqual:
+      return {right, true, nullptr, true};
+    default:
+      return {};
+  }
+}
+
+double Optimizer::EstimateRangeSelectivity(const AbstractExpression *predicate, const TableMetadata *table_info) const {
+  // without statistics, an equality is taken to pick out few rows, and a range not
+  const auto *comparison = dynamic_cast<const ComparisonExpression *>(predicate);
+  if (table_info->statistics_ == nullptr && comparison != nullptr &&
+      comparison->GetComparisonType() == ComparisonType::Equal) {
+    return 0;
+  }
+  return EstimateSelectivity(predicate, table_info);
+}
+
+const AbstractPlanNode *Optimizer::SelectJoin(const AbstractPlanNode *plan) {
+  const auto *join = dynamic_cast<const NestedLoopJoinPlanNode *>(plan);
+  const auto *predicate = dynamic_cast<const ComparisonExpression *>(join->Predicate());
+  if (predicate == nullptr || predicate->GetComparisonType() != ComparisonType::Equal) {
+    return plan;
+  }
+  const AbstractExpression *left_key = predicate->GetChildAt(0);
+  const AbstractExpression *right_key = predicate->GetChildAt(1);
+  if (!IsOfSide(left_key, 0) || !IsOfSide(right_key, 1)) {
+    std::swap(left_key, right_key);
+    if (!IsOfSide(left_key, 0) || !IsOfSide(right_key, 1)) {
+      return plan;
+    }
+  }
+  const AbstractPlanNode *left = join->GetLeftPlan();
+  const AbstractPlanNode *right = join->GetRightPlan();
+
+  if (const AbstractPlanNode *index_join = MakeIndexJoin(join, left, right, left_key, right_key, false);
+      index_join != nullptr) {
+    return index_join;
+  }
+  if (const AbstractPlanNode *index_join = MakeIndexJoin(join, right, left, right_key, left_key, true);
+      index_join != nullptr) {
+    return index_join;
+  }
+
+  // the hash table is built of the left side, which is to be the smaller one
+  if (EstimateRows(left) <= EstimateRows(right)) {
+    return Own(std::make_unique<HashJoinPlanNode>(join->OutputSchema(), std::vector{left, right},
+                                                  std::vector{left_key}, std::vector{right_key}));
+  }
+  const Schema *output = join->OutputSchema();
+  std::vector<const AbstractExpression *> exprs;
+  for (const Column &column : output->GetColumns()) {
+    exprs.push_back(column.GetExpr() == nullptr ? nullptr : Flip(column.GetExpr()));
+    if (exprs.back() == nullptr) {
+      return plan;
+    }
+  }
+  return Own(std::make_unique<HashJoinPlanNode>(MakeSchema(output, exprs), std::vector{right, left},
+                                                std::vector{Flip(right_key)}, std::vector{Flip(left_key)}));
+}
+
+const AbstractPlanNode *Optimizer::MakeIndexJoin(const AbstractPlanNode *join, const AbstractPlanNode *outer,
+                                                 const AbstractPlanNode *inner, const AbstractExpression *outer_key,
+                                                 const AbstractExpression *inner_key, bool flip) {
+  const auto *scan = dynamic_cast<const SeqScanPlanNode *>(inner);
+  const auto *inner_column = dynamic_cast<const ColumnValueExpression *>(inner_key);
+  // the inner side is looked up in the index alone, so there is no predicate of its scan to apply to it
+  if (scan == nullptr || scan->GetPredicate() != nullptr || inner_column == nullptr ||
+      EstimateRows(outer) * INDEX_JOIN_RATIO >= EstimateRows(inner)) {
+    return nullptr;
+  }
+  const auto *table_column = dynamic_cast<const ColumnValueExpression *>(ScanColumn(scan, inner_column->GetColIdx()));
+  if (table_column == nullptr) {
+    return nullptr;
+  }
+  TableMetadata *table_info = catalog_->GetTable(scan->GetTableOid());
+  IndexInfo *index = nullptr;
+  for (IndexInfo *index_info : catalog_->GetTableIndexes(table_info->name_)) {
+    if (index_info->IsValid() &&
+        index_info->index_->GetKeyAttrs() == std::vector<uint32_t>{table_column->GetColIdx()}) {
+      index = index_info;
+      break;
+    }
+  }
+  if (index == nullptr) {
+    return nullptr;
+  }
+
+  // the outer side is the left one of the index join, and its inner tuples are those of the table, not of the scan
+  ColumnMap map = [&](const ColumnValueExpression *column) -> const AbstractExpression * {
+    if (column->GetTupleIdx() == 0) {
+      return column;
+    }
+    return Rewrite(ScanColumn(scan, column->GetColIdx()), [&](const ColumnValueExpression *table_column) {
+      return MakeColumn(1, table_column->GetColIdx(), table_column->GetReturnType());
+    });
+  };
+  const Schema *output = join->OutputSchema();
+  std::vector<const AbstractExpression *> exprs;
+  for (const Column &column : output->GetColumns()) {
+    const AbstractExpression *expr = column.GetExpr();
+    exprs.push_back(expr == nullptr ? nullptr : Rewrite(flip ? Flip(expr) : expr, map));
+    if (exprs.back() == nullptr) {
+      return nullptr;
+    }
+  }
+  const AbstractExpression *key = flip ? Flip(outer_key) : outer_key;
+  const auto *predicate = Own(std::make_unique<ComparisonExpression>(
+      key, MakeColumn(1, table_column->GetColIdx(), table_column->GetReturnType()), ComparisonType::Equal));
+  return Own(std::make_unique<NestedIndexJoinPlanNode>(MakeSchema(output, exprs), std::vector{outer}, predicate,
+                                                       table_info->oid_, index->name_, outer->OutputSchema(),
+                                                       &table_info->schema_));
+}
+
+const AbstractExpression *Optimizer::Rewrite(const AbstractExpression *expr, const ColumnMap &map) {
+  if (const auto *column = dynamic_cast<const ColumnValueExpression *>(expr); column != nullptr) {
+    return map(column);
+  }
+  if (IsConstant(expr)) {
+    return expr;
+  }
+  const auto *comparison = dynamic_cast<const ComparisonExpression *>(expr);
+  if (comparison == nullptr) {
+    return nullptr;
+  }
+  const AbstractExpression *left = Rewrite(comparison->GetChildAt(0), map);
+  const AbstractExpression *right = Rewrite(comparison->GetChildAt(1), map);
+  if (left == nullptr || right == nullptr) {
+    return nullptr;
+  }
+  if (left == comparison->GetChildAt(0) && right == comparison->GetChildAt(1)) {
+    return expr;
+  }
+  return Own(std::make_unique<ComparisonExpression>(left, right, comparison->GetComparisonType()));
+}
+
+const AbstractExpression *Optimizer::Simplify(const AbstractExpression *expr) {
+  if (expr == nullptr) {
+    return nullptr;
+  }
+  const auto *comparison = dynamic_cast<const ComparisonExpression *>(expr);
+  const auto *arithmetic = dynamic_cast<const ArithmeticExpression *>(expr);
+  const auto *conjunction = dynamic_cast<const ConjunctionExpression *>(expr);
+  if (comparison == nullptr && arithmetic == nullptr && conjunction == nullptr) {
+    // a leaf, or an expression over aggregates, which is kept as it is
+    return expr->GetChildren().empty() ? Intern(expr) : expr;
+  }
+  std::vector<const AbstractExpression *> children;
+  bool changed = false;
+  for (const AbstractExpression *child : expr->GetChildren()) {
+    const AbstractExpression *simplified = Simplify(child);
+    changed = changed || simplified != child;
+    // a conjunct that is true does not change the conjunction, and one that is false makes it false
+    if (conjunction != nullptr && IsTrue(simplified)) {
+      changed = true;
+      continue;
+    }
+    if (conjunction != nullptr && IsFalse(simplified)) {
+      return Intern(simplified);
+    }
+    children.push_back(simplified);
+  }
+  if (conjunction != nullptr && children.size() == 1) {
+    return children[0];
+  }
+  if (conjunction != nullptr && children.empty()) {
+    return Intern(Own(std::make_unique<ConstantValueExpression>(ValueFactory::GetBooleanValue(true))));
+  }
+  if (changed) {
+    if (comparison != nullptr) {
+      expr = Own(std::make_unique<ComparisonExpression>(children[0], children[1], comparison->GetComparisonType()));
+    } else if (arithmetic != nullptr) {
+      expr = Own(std::make_unique<ArithmeticExpression>(children[0], children[1], arithmetic->GetArithmeticType()));
+    } else {
+      expr = Own(std::make_unique<ConjunctionExpression>(std::move(children)));
+    }
+  }
+  bool constant = std::all_of(expr->GetChildren().begin(), expr->GetChildren().end(), [](const AbstractExpression *c) {
+    return dynamic_cast<const ConstantValueExpression *>(c) != nullptr;
+  });
+  if (constant) {
+    // an expression that fails, e.g. a division by zero, is left to fail when it is run
+    try {
+      expr = Own(std::make_unique<ConstantValueExpression>(expr->Evaluate(nullptr, nullptr)));
+    } catch (const Exception &) {
+    }
+  }
+  return Intern(expr);
+}
+
+const AbstractExpression *Optimizer::Intern(const AbstractExpression *expr) {
+  std::string key;
+  if (const auto *column = dynamic_cast<const ColumnValueExpression *>(expr); column != nullptr) {
+    key = "col " + std::to_string(column->GetTupleIdx()) + " " + std::to_string(column->GetColIdx());
+  } else if (dynamic_cast<const ConstantValueExpression *>(expr) != nullptr) {
+    // the text of a DECIMAL is rounded, so only the constants whose text is exact are shared
+    Value value = expr->Evaluate(nullptr, nullptr);
+    if (value.IsNull() || value.GetTypeId() == TypeId::DECIMAL || value.GetTypeId() == TypeId::TIMESTAMP) {
+      return expr;
+    }
+    key = "const " + value.ToString();
+  } else if (const auto *comparison = dynamic_cast<const ComparisonExpression *>(expr); comparison != nullptr) {
+    key = "cmp " + std::to_string(static_cast<int>(comparison->GetComparisonType()));
+  } else if (const auto *arithmetic = dynamic_cast<const ArithmeticExpression *>(expr); arithmetic != nullptr) {
+    key = "arith " + std::to_string(static_cast<int>(arithmetic->GetArithmeticType()));
+  } else if (dynamic_cast<const ConjunctionExpression *>(expr) != nullptr) {
+    key = "and";
+  } else {
+    return expr;
+  }
+  // the children are shared already, so equal expressions have the same ones
+  key += " " + std::to_string(static_cast<int>(expr->GetReturnType()));
+  for (const AbstractExpression *child : expr->GetChildren()) {
+    key += " " + std::to_string(reinterpret_cast<uintptr_t>(child));
+  }
+  return interned_.emplace(std::move(key), expr).first->second;
+}
+
+const Schema *Optimizer::SimplifySchema(const Schema *schema) {
+  std::vector<const AbstractExpression *> exprs;
+  bool changed = false;
+  for (const Column &column : schema->GetColumns()) {
+    exprs.push_back(Simplify(column.GetExpr()));
+    changed = changed || exprs.back() != column.GetExpr();
+  }
+  return changed ? MakeSchema(schema, exprs) : schema;
+}
+
+const AbstractExpression *Optimizer::ScanColumn(const SeqScanPlanNode *scan, uint32_t col_idx) {
+  const Column &column = scan->OutputSchema()->GetColumn(col_idx);
+  // an output column of a scan that does not say what it is made of is the column of the table at its position
+  return column.GetExpr() != nullptr ? column.GetExpr() : MakeColumn(0, col_idx, column.GetType());
+}
+
+const AbstractExpression *Optimizer::MakeColumn(uint32_t tuple_idx, uint32_t col_idx, TypeId type) {
+  return Own(std::make_unique<ColumnValueExpression>(tuple_idx, col_idx, type));
+}
+
+const AbstractExpression *Optimizer::Flip(const AbstractExpression *expr) {
+  return Rewrite(expr, [&](const ColumnValueExpression *column) {
+    return MakeColumn(1 - column->GetTupleIdx(), column->GetColIdx(), column->GetReturnType());
+  });
+}
+
+const Schema *Optimizer::MakeSchema(const Schema *like, const std::vector<const AbstractExpression *> &exprs) {
+  std::vector<Column> columns;
+  for (uint32_t i = 0; i < like->GetColumnCount(); i++) {
+    const Column &column = like->GetColumn(i);
+    if (column.IsInlined()) {
+      columns.emplace_back(column.GetName(), column.GetType(), exprs[i]);
+    } else {
+      columns.emplace_back(column.GetName(), column.GetType(), column.GetLength(), exprs[i]);
+    }
+  }
+  return Own(std::make_unique<Schema>(columns));
+}
+
+double Optimizer::EstimateRows(const AbstractPlanNode *plan) const {
+  switch (plan->GetType()) {
+    case PlanType::SeqScan: {
+      const auto *scan = dynamic_cast<const SeqScanPlanNode *>(plan);
+      TableMetadata *table_info = catalog_->GetTable(scan->GetTableOid());
+      double rows = table_info->statistics_ != nullptr ? table_info->statistics_->GetRowCount() : DEFAULT_ROW_COUNT;
+      return rows * EstimateSelectivity(scan->GetPredicate(), table_info);
+    }
+    case PlanType::SampleScan: {
+      const auto *scan = dynamic_cast<const SampleScanPlanNode *>(plan);
+      TableMetadata *table_info = catalog_->GetTable(scan->GetTableOid());
+      double rows = table_info->statistics_ != nullptr ? table_info->statistics_->GetRowCount() : DEFAULT_ROW_COUNT;
+      return rows * scan->GetFraction() * EstimateSelectivity(scan->GetPredicate(), table_info);
+    }
+    case PlanType::IndexScan: {
+      const auto *scan = dynamic_cast<const IndexScanPlanNode *>(plan);
+      TableMetadata *table_info = catalog_->GetTable(catalog_->GetIndex(scan->GetIndexOid())->table_name_);
+      double rows = table_info->statistics_ != nullptr ? table_info->statistics_->GetRowCount() : DEFAULT_ROW_COUNT;
+      if (!scan->IsIndexOnly()) {
+        return rows * EstimateSelectivity(scan->GetPredicate(), table_info);
+      }
+      // the predicate is over the columns of the key, which the statistics of the table do not know as such
+      return scan->GetPredicate() != nullptr ? rows * ColumnStatistics::DEFAULT_SELECTIVITY : rows;
+    }
+    case PlanType::Limit: {
+      const auto *limit = dynamic_cast<const LimitPlanNode *>(plan);
+      double rows = std::max(EstimateRows(limit->GetChildPlan()) - static_cast<double>(limit->GetOffset()), 0.0);
+      return std::min(rows, static_cast<double>(limit->GetLimit()));
+    }
+    case PlanType::Aggregation:
+      // an aggregation without groups makes a single row, and one with them at most a row per row of its child
+      if (dynamic_cast<const AggregationPlanNode *>(plan)->GetGroupBys().empty()) {
+        return 1;
+      }
+      return EstimateRows(plan->GetChildAt(0));
+    case PlanType::NestedLoopJoin: {
+      double left = EstimateRows(plan->GetChildAt(0));
+      double right = EstimateRows(plan->GetChildAt(1));
+      // a join on an equality is taken to match each row of its larger side once
+      if (dynamic_cast<const NestedLoopJoinPlanNode *>(plan)->Predicate() == nullptr) {
+        return left * right;
+      }
+      return std::max(left, right);
+    }
+    case PlanType::HashJoin:
+      // a SEMI or an ANTI join makes each row of its outer side once at most
+      if (dynamic_cast<const HashJoinPlanNode *>(plan)->GetJoinType() != JoinType::INNER) {
+        return EstimateRows(plan->GetChildAt(1));
+      }
+      return std::max(EstimateRows(plan->GetChildAt(0)), EstimateRows(plan->GetChildAt(1)));
+    default:
+      return plan->GetChildren().empty() ? DEFAULT_ROW_COUNT : EstimateRows(plan->GetChildAt(0));
+  }
+}
+
+double Optimizer::EstimateSelectivity(const AbstractExpression *predicate, const TableMetadata *table_info) const {
+  if (predicate == nullptr) {
+    return 1;
+  }
+  const auto *comparison = dynamic_cast<const ComparisonExpression *>(predicate);
+  if (comparison == nullptr || table_info->statistics_ == nullptr) {
+    return ColumnStatistics::DEFAULT_SELECTIVITY;
+  }
+  const AbstractExpression *left = comparison->GetChildAt(0);
+  const AbstractExpression *right = comparison->GetChildAt(1);
+  ComparisonType comp_type = comparison->GetComparisonType();
+  if (IsConstant(left)) {
+    std::swap(left, right);
+    comp_type = Mirror(comp_type);
+  }
+  const auto *column = dynamic_cast<const ColumnValueExpression *>(left);
+  if (column == nullptr || !IsConstant(right) || column->GetColIdx() >= table_info->schema_.GetColumnCount()) {
+    return ColumnStatistics::DEFAULT_SELECTIVITY;
+  }
+  Value value = right->Evaluate(nullptr, nullptr);
+  if (value.IsNull()) {
+    return 0;
+  }
+  const ColumnStatistics &stats = table_info->statistics_->GetColumn(column->GetColIdx());
+  double non_null = 1 - stats.GetNullFraction();
+  double selectivity;
+  switch (comp_type) {
+    case ComparisonType::Equal:
+      selectivity = stats.EstimateEquals(value);
+      break;
+    case ComparisonType::NotEqual:
+      selectivity = non_null - stats.EstimateEquals(value);
+      break;
+    case ComparisonType::LessThan:
+      selectivity = stats.EstimateLessThan(value);
+      break;
+    case ComparisonType::LessThanOrEqual:
+      selectivity = stats.EstimateLessThan(value) + stats.EstimateEquals(value);
+      break;
+    case ComparisonType::GreaterThan:
+      selectivity = non_null - stats.EstimateLessThan(value) - stats.EstimateEquals(value);
+      break;
+    default:
+      selectivity = non_null - stats.EstimateLessThan(value);
+      break;
+  }
+  return std::clamp(selectivity, 0.0, 1.0);
+}
+
+}  // namespace bustub
@@ -0,0 +1,203 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// backup_manager.cpp
+//
+// Identification: src/recovery/backup_manager.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "recovery/backup_manager.h"
+
+#include <filesystem>
+#include <fstream>
+#include <memory>
+
+#include "buffer/buffer_access_strategy.h"
+#include "common/logger.h"
+#include "storage/disk/page_checksums.h"
+
+namespace bustub {
+
+namespace {
+
+const char *const MANIFEST_FILE = "manifest";
+const char *const PAGES_FILE = "pages";
+const char *const LOG_FILE = "log";
+
+std::string PathOf(const std::string &directory, const char *file) {
+  return (std::filesystem::path(directory) / file).string();
+}
+
+}  // namespace
+
+bool BackupManager::Backup(const std::string &directory, const std::string &base, BackupStats *stats) {
+  if (log_manager_ == nullptr || !enable_logging) {
+    LOG_WARN("an online backup needs the log");
+    return false;
+  }
+  Manifest manifest;
+  Manifest base_manifest;
+  if (!base.empty()) {
+    if (!ReadManifest(base, &base_manifest)) {
+      return false;
+    }
+    manifest.base_end_lsn_ = base_manifest.end_lsn_;
+  }
+  std::error_code error;
+  std::filesystem::create_directories(directory, error);
+  std::ofstream pages_out(PathOf(directory, PAGES_FILE), std::ios::binary | std::ios::trunc);
+  std::ofstream log_out(PathOf(directory, LOG_FILE), std::ios::binary | std::ios::trunc);
+  if (error || !pages_out || !log_out) {
+    LOG_WARN("cannot write a backup to %s", directory.c_str());
+    return false;
+  }
+
+  // every change from the restart point of the checkpoint on reaches the backup through the log
+  checkpoint_manager_->FuzzyCheckpoint();
+  BackupStats result;
+  int sink_id = log_manager_->AddLogSink(disk_manager_->ReadMasterRecord(), [&](int64_t, const char *data, int size) {
+    log_out.write(data, size);
+    result.log_bytes_ += size;
+  });
+  if (sink_id < 0) {
+    LOG_WARN("the log was recycled before the backup shipped it");
+    return false;
+  }
+
+  BufferAccessStrategy strategy(BufferAccessStrategy::BulkRingSize(buffer_pool_manager_->GetPoolSize()));
+  auto data = std::make_unique<char[]>(PAGE_SIZE);
+  bool ok = true;
+  // the pages allocated as the scan goes on are scanned as well, as the index pages are not created by the log
+  page_id_t page_id = 0;
+  for (; page_id < disk_manager_->GetNumPages(); page_id++) {
+    manifest.checksums_.resize(page_id + 1);
+    uint32_t base_checksum = static_cast<size_t>(page_id) < base_manifest.checksums_.size()
+                                 ? base_manifest.checksums_[page_id]
+                                 : 0;
+    // the page on disk is the one of the base, and the changes it has in the buffer pool are in the log
+    if (base_checksum != 0 && disk_manager_->GetPageChecksum(page_id) == base_checksum) {
+      manifest.checksums_[page_id] = base_checksum;
+      continue;
+    }
+    Page *page = buffer_pool_manager_->FetchPageWithStrategy(page_id, &strategy);
+    if (page == nullptr) {
+      LOG_WARN("the backup found no frame for page %d", page_id);
+      ok = false;
+      break;
+    }
+    page->RLatch();
+    memcpy(data.get(), page->GetData(), PAGE_SIZE);
+    page->RUnlatch();
+    buffer_pool_manager_->UnpinPage(page_id, false);
+    result.pages_read_++;
+    uint32_t checksum = PageChecksums::Compute(data.get());
+    manifest.checksums_[page_id] = checksum;
+    if (checksum == base_checksum) {
+      continue;
+    }
+    pages_out.write(reinterpret_cast<const char *>(&page_id), sizeof(page_id));
+    pages_out.write(data.get(), PAGE_SIZE);
+    result.pages_copied_++;
+  }
+
+  // the log up to the last change of any page copied, which is before the next LSN now
+  manifest.end_lsn_ = log_manager_->GetNextLSN() - 1;
+  log_manager_->Flush();
+  log_manager_->RemoveLogSink(sink_id);
+  pages_out.close();
+  log_out.close();
+  ok = ok && pages_out && log_out && WriteManifest(directory, manifest);
+  result.num_pages_ = page_id;
+  result.end_lsn_ = manifest.end_lsn_;
+  if (stats != nullptr) {
+    *stats = result;
+  }
+  return ok;
+}
+
+bool BackupManager::Restore(const std::vector<std::string> &backups, const std::string &db_file) {
+  if (backups.empty()) {
+    return false;
+  }
+  std::vector<Manifest> manifests(backups.size());
+  for (size_t i = 0; i < backups.size(); i++) {
+    if (!ReadManifest(backups[i], &manifests[i])) {
+      return false;
+    }
+    lsn_t base_end_lsn = i == 0 ? INVALID_LSN : manifests[i - 1].end_lsn_;
+    if (manifests[i].base_end_lsn_ != base_end_lsn) {
+      LOG_WARN("backup %s is not on top of the one before it", backups[i].c_str());
+      return false;
+    }
+  }
+
+  DiskManager disk_manager(db_file);
+  bool ok = true;
+  // the pages the backups do not hold, as the ones allocated and freed, are left zeroed
+  auto num_pages = static_cast<page_id_t>(manifests.back().checksums_.size());
+  while (disk_manager.GetNumPages() < num_pages) {
+    disk_manager.AllocatePage();
+  }
+  auto data = std::make_unique<char[]>(PAGE_SIZE);
+  for (const std::string &backup : backups) {
+    std::ifstream pages_in(PathOf(backup, PAGES_FILE), std::ios::binary);
+    page_id_t page_id;
+    while (pages_in.read(reinterpret_cast<char *>(&page_id), sizeof(page_id))) {
+      if (!pages_in.read(data.get(), PAGE_SIZE) || page_id < 0 || page_id >= num_pages) {
+        ok = false;
+        break;
+      }
+      disk_manager.WritePage(page_id, data.get());
+    }
+  }
+
+  // the log goes from the start of the new one, where recovery reads it from without a master record; the disk
+  // manager takes no buffer twice in a row
+  std::ifstream log_in(PathOf(backups.back(), LOG_FILE), std::ios::binary);
+  std::vector<char> buffers[2] = {std::vector<char>(LOG_BUFFER_SIZE), std::vector<char>(LOG_BUFFER_SIZE)};
+  for (int next = 0; log_in; next ^= 1) {
+    log_in.read(buffers[next].data(), LOG_BUFFER_SIZE);
+    if (log_in.gcount() > 0) {
+      disk_manager.WriteLog(buffers[next].data(), static_cast<int>(log_in.gcount()));
+    }
+  }
+  disk_manager.ShutDown();
+  return ok;
+}
+
+bool BackupManager::ReadManifest(const std::string &directory, Manifest *manifest) {
+  std::ifstream in(PathOf(directory, MANIFEST_FILE), std::ios::binary);
+  uint32_t magic = 0;
+  uint32_t num_pages = 0;
+  in.read(reinterpret_cast<char *>(&magic), sizeof(magic));
+  in.read(reinterpret_cast<char *>(&manifest->base_end_lsn_), sizeof(manifest->base_end_lsn_));
+  in.read(reinterpret_cast<char *>(&manifest->end_lsn_), sizeof(manifest->end_lsn_));
+  in.read(reinterpret_cast<char *>(&num_pages), sizeof(num_pages));
+  if (!in || magic != MANIFEST_MAGIC) {
+    LOG_WARN("%s holds no backup", directory.c_str());
+    return false;
+  }
+  manifest->checksums_.resize(num_pages);
+  in.read(reinterpret_cast<char *>(manifest->checksums_.data()), num_pages * sizeof(uint32_t));
+  return static_cast<bool>(in);
+}
+
+bool BackupManager::WriteManifest(const std::string &directory, const Manifest &manifest) {
+  // written last, so that a directory with a manifest holds a whole backup
+  std::ofstream out(PathOf(directory, MANIFEST_FILE), std::ios::binary | std::ios::trunc);
+  uint32_t magic = MANIFEST_MAGIC;
+  auto num_pages = static_cast<uint32_t>(manifest.checksums_.size());
+  out.write(reinterpret_cast<const char *>(&magic), sizeof(magic));
+  out.write(reinterpret_cast<const char *>(&manifest.base_end_lsn_), sizeof(manifest.base_end_lsn_));
+  out.write(reinterpret_cast<const char *>(&manifest.end_lsn_), sizeof(manifest.end_lsn_));
+  out.write(reinterpret_cast<const char *>(&num_pages), sizeof(num_pages));
+  out.write(reinterpret_cast<const char *>(manifest.checksums_.data()), num_pages * sizeof(uint32_t));
+  out.close();
+  return static_cast<bool>(out);
+}
+
+}  // namespace bustub
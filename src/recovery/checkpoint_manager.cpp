@@ -12,6 +12,8 @@
 
 #include "recovery/checkpoint_manager.h"
 
+#include <utility>
+
 namespace bustub {
 
 void CheckpointManager::BeginCheckpoint() {
@@ -24,4 +26,39 @@ void CheckpointManager::EndCheckpoint() {
   // Allow transactions to resume, completing the checkpoint.
 }
 
+lsn_t CheckpointManager::FuzzyCheckpoint() {
+  LogRecord begin(INVALID_TXN_ID, INVALID_LSN, LogRecordType::BEGINCHECKPOINT);
+  lsn_t begin_lsn = log_manager_ != nullptr ? log_manager_->AppendLogRecord(&begin) : INVALID_LSN;
+  // the tables are taken a shard and a pool instance at a time while the writes go on; the changes they miss are
+  // logged after the begin record, from which the analysis of recovery reads the log
+  lsn_t oldest_lsn = TransactionManager::GetOldestActiveLSN();
+  LogRecord end(TransactionManager::GetActiveTransactionTable(), buffer_pool_manager_->GetDirtyPageTable());
+  if (log_manager_ != nullptr) {
+    // the pages changed without a page record, as the index pages are, are written back for the restart point to
+    // pass their changes, once the log of the changes is
+    if (enable_logging) {
+      log_manager_->WaitForPersistent(begin_lsn);
+      for (const auto &[page_id, rec_lsn] : end.GetDirtyPages()) {
+        if (rec_lsn == INVALID_LSN) {
+          buffer_pool_manager_->FlushPage(page_id);
+        }
+      }
+    }
+    lsn_t end_lsn = log_manager_->AppendLogRecord(&end);
+    // restart reads the log from the oldest record it may need: the checkpoint, the first change of a page that was
+    // not written back since, or the first record of a transaction that may have to be rolled back
+    if (oldest_lsn == INVALID_LSN || begin_lsn < oldest_lsn) {
+      oldest_lsn = begin_lsn;
+    }
+    for (const auto &[page_id, rec_lsn] : end.GetDirtyPages()) {
+      if (rec_lsn != INVALID_LSN && rec_lsn < oldest_lsn) {
+        oldest_lsn = rec_lsn;
+      }
+    }
+    log_manager_->WriteRestartPoint(end_lsn, oldest_lsn);
+  }
+  last_checkpoint_ = std::move(end);
+  return begin_lsn;
+}
+
 }  // namespace bustub
@@ -12,6 +12,13 @@
 
 #include "recovery/log_manager.h"
 
+#include <cstring>
+#include <iterator>
+#include <utility>
+
+#include "common/tracer.h"
+#include "storage/disk/page_compressor.h"
+
 namespace bustub {
 /*
  * set enable_logging = true
@@ -22,33 +29,334 @@ namespace bustub {
  *
  * This thread runs forever until system shutdown/StopFlushThread
  */
-void LogManager::RunFlushThread() {}
+void LogManager::RunFlushThread() {
+  std::scoped_lock lock(latch_);
+  if (flush_thread_ != nullptr) {
+    return;
+  }
+  enable_logging = true;
+  stop_flush_ = false;
+  flush_thread_ = new std::thread([this] {
+    auto flush_lock = latch_site_->Acquire(&latch_);
+    while (!stop_flush_) {
+      // the deadline of the asynchronous commits may come sooner as the thread waits, which they wake it to see
+      auto timeout = std::chrono::steady_clock::now() + log_timeout;
+      while (!flush_requested_ && !stop_flush_) {
+        auto deadline = std::min<std::chrono::steady_clock::time_point>(timeout, flush_deadline_);
+        if (std::chrono::steady_clock::now() >= deadline) {
+          break;
+        }
+        cv_.wait_until(flush_lock, deadline);
+      }
+      // a commit asked for the flush: the ones that come soon after wait for it too, unless the buffer fills first
+      if (flush_requested_ && group_commit_delay_.count() > 0) {
+        cv_.wait_for(flush_lock, group_commit_delay_, [this] { return stop_flush_ || HalfFull(); });
+      }
+      flush_requested_ = false;
+      flush_deadline_ = std::chrono::steady_clock::time_point::max();
+      uint32_t group = commit_waiters_.exchange(0);
+      FlushBuffer();
+      AdaptGroupCommitDelay(group);
+    }
+    // the thread may be stopped before it ever reached the loop, and the records appended since its last flush are
+    // written all the same
+    FlushBuffer();
+  });
+}
 
 /*
  * Stop and join the flush thread, set enable_logging = false
  */
-void LogManager::StopFlushThread() {}
+void LogManager::StopFlushThread() {
+  std::thread *flush_thread;
+  {
+    std::scoped_lock lock(latch_);
+    if (flush_thread_ == nullptr) {
+      return;
+    }
+    stop_flush_ = true;
+    flush_thread = flush_thread_;
+  }
+  cv_.notify_one();
+  // the thread writes what is left in the buffer as it stops
+  flush_thread->join();
+  delete flush_thread;
+  std::scoped_lock lock(latch_);
+  flush_thread_ = nullptr;
+  enable_logging = false;
+}
 
 /*
  * append a log record into log buffer
  * you MUST set the log record's lsn within this method
  * @return: lsn that is assigned to this log record
- *
- *
- * example below
- * // First, serialize the must have fields(20 bytes in total)
- * log_record.lsn_ = next_lsn_++;
- * memcpy(log_buffer_ + offset_, &log_record, 20);
- * int pos = offset_ + 20;
- *
- * if (log_record.log_record_type_ == LogRecordType::INSERT) {
- *    memcpy(log_buffer_ + pos, &log_record.insert_rid_, sizeof(RID));
- *    pos += sizeof(RID);
- *    // we have provided serialize function for tuple class
- *    log_record.insert_tuple_.SerializeTo(log_buffer_ + pos);
- *  }
- *
  */
-lsn_t LogManager::AppendLogRecord(LogRecord *log_record) { return INVALID_LSN; }
+lsn_t LogManager::AppendLogRecord(LogRecord *log_record) {
+  auto size = static_cast<uint64_t>(log_record->size_);
+  BUSTUB_ASSERT(size <= static_cast<uint64_t>(LOG_BUFFER_SIZE), "log record larger than the log buffer");
+  uint64_t reserved = reserved_.load();
+  while (true) {
+    // a sealed offset is past the end of any buffer, so the append waits for the flush that sealed it
+    if ((reserved & OFFSET_MASK) + size > static_cast<uint64_t>(LOG_BUFFER_SIZE)) {
+      {
+        auto lock = latch_site_->Acquire(&latch_);
+        if ((reserved_.load() & OFFSET_MASK) + size > static_cast<uint64_t>(LOG_BUFFER_SIZE)) {
+          FlushBuffer();
+        }
+      }
+      reserved = reserved_.load();
+      continue;
+    }
+    if (reserved_.compare_exchange_weak(reserved, reserved + (uint64_t{1} << LSN_SHIFT) + size)) {
+      break;
+    }
+  }
+  log_record->lsn_ = static_cast<lsn_t>(reserved >> LSN_SHIFT);
+  // the buffer is not swapped until the bytes reserved in it are completed, so it is the one reserved in
+  SerializeLogRecord(*log_record, log_buffer_ + (reserved & OFFSET_MASK));
+  completed_.fetch_add(size);
+  // the flush thread that holds a group of commits back writes it once the buffer is half full
+  uint64_t half = LOG_BUFFER_SIZE / 2;
+  if ((reserved & OFFSET_MASK) < half && (reserved & OFFSET_MASK) + size >= half) {
+    cv_.notify_one();
+  }
+  return log_record->lsn_;
+}
+
+void LogManager::Flush() {
+  auto lock = latch_site_->Acquire(&latch_);
+  FlushBuffer();
+}
+
+void LogManager::WaitForPersistent(lsn_t lsn) {
+  if (persistent_lsn_ >= lsn) {
+    return;
+  }
+  {
+    auto lock = latch_site_->Acquire(&latch_);
+    if (flush_thread_ == nullptr) {
+      FlushBuffer();
+    } else {
+      // the commits that ask while a flush is going on are written together by the next one
+      flush_requested_ = true;
+      commit_waiters_++;
+      cv_.notify_one();
+    }
+  }
+  auto lock = persistent_latch_site_->Acquire(&persistent_latch_);
+  persistent_cv_.wait(lock, [this, lsn] { return persistent_lsn_ >= lsn; });
+}
+
+void LogManager::FlushWithin(lsn_t lsn, std::chrono::milliseconds delay) {
+  if (persistent_lsn_ >= lsn) {
+    return;
+  }
+  auto lock = latch_site_->Acquire(&latch_);
+  if (flush_thread_ == nullptr) {
+    FlushBuffer();
+    return;
+  }
+  // the flush thread waits until the earliest deadline of the records it is to write, which it is woken to see
+  auto deadline = std::chrono::steady_clock::now() + delay;
+  if (deadline < flush_deadline_) {
+    flush_deadline_ = deadline;
+    cv_.notify_one();
+  }
+}
+
+void LogManager::WriteRestartPoint(lsn_t checkpoint_lsn, lsn_t oldest_lsn) {
+  WaitForPersistent(checkpoint_lsn);
+  int64_t offset = 0;
+  {
+    std::scoped_lock lock(latch_);
+    auto after = std::upper_bound(flushed_buffers_.begin(), flushed_buffers_.end(), oldest_lsn,
+                                  [](lsn_t lsn, const auto &buffer) { return lsn < buffer.first; });
+    if (oldest_lsn >= buffer_first_lsn_) {
+      offset = buffer_offset_;
+    } else if (after != flushed_buffers_.begin()) {
+      offset = std::prev(after)->second;
+    }
+    // the oldest record a restart needs only ever moves forward, so the buffers before it are not needed again; one
+    // older than the buffers of this run is read from the start of the log
+    if (after != flushed_buffers_.begin()) {
+      flushed_buffers_.erase(flushed_buffers_.begin(), std::prev(after));
+    }
+  }
+  disk_manager_->WriteMasterRecord(offset);
+}
+
+void LogManager::SetNextLSN(lsn_t lsn) {
+  std::scoped_lock lock(latch_);
+  BUSTUB_ASSERT((reserved_ & OFFSET_MASK) == 0 && flushed_buffers_.empty(), "records were appended before recovery");
+  reserved_ = static_cast<uint64_t>(lsn) << LSN_SHIFT;
+  buffer_first_lsn_ = lsn;
+}
+
+int LogManager::AddLogSink(int64_t offset, LogSink sink) {
+  std::scoped_lock lock(latch_);
+  if (offset < disk_manager_->GetLogStart()) {
+    return -1;
+  }
+  // no flush gets in between the log read here and the sink being added
+  char *buffer = new char[LOG_BUFFER_SIZE];
+  while (offset < buffer_offset_) {
+    auto size = static_cast<int>(std::min<int64_t>(LOG_BUFFER_SIZE, buffer_offset_ - offset));
+    if (!disk_manager_->ReadLog(buffer, size, offset)) {
+      break;
+    }
+    sink(offset, buffer, size);
+    offset += size;
+  }
+  delete[] buffer;
+  log_sinks_.emplace(next_sink_id_, std::move(sink));
+  return next_sink_id_++;
+}
+
+void LogManager::RemoveLogSink(int sink_id) {
+  std::scoped_lock lock(latch_);
+  log_sinks_.erase(sink_id);
+}
+
+void LogManager::FlushBuffer() {
+  auto start = std::chrono::steady_clock::now();
+  uint64_t reserved = reserved_.fetch_or(SEALED);
+  uint64_t end = reserved & OFFSET_MASK;
+  if (end == 0) {
+    reserved_ = reserved;
+    return;
+  }
+  while (completed_.load() != end) {
+    std::this_thread::yield();
+  }
+  std::swap(log_buffer_, flush_buffer_);
+  completed_ = 0;
+  // the appends go on into the other buffer while this one is written
+  reserved_ = reserved & ~OFFSET_MASK;
+  uint32_t size = end;
+  char *written = compress_log_ ? CompressBlock(end, &size) : nullptr;
+  if (written == nullptr) {
+    written = flush_buffer_;
+  }
+  flushed_buffers_.emplace_back(buffer_first_lsn_, buffer_offset_);
+  buffer_offset_ += size;
+  buffer_first_lsn_ = static_cast<lsn_t>(reserved >> LSN_SHIFT);
+  disk_manager_->WriteLog(written, static_cast<int>(size));
+  auto last_lsn = static_cast<lsn_t>(reserved >> LSN_SHIFT) - 1;
+  {
+    auto lock = persistent_latch_site_->Acquire(&persistent_latch_);
+    if (persistent_lsn_ < last_lsn) {
+      persistent_lsn_ = last_lsn;
+    }
+  }
+  persistent_cv_.notify_all();
+  auto end_time = std::chrono::steady_clock::now();
+  flush_latency_.Record(end_time - start);
+  Tracer::AddSpan("log_flush", "log", start, end_time, "bytes", size);
+  for (auto &[sink_id, sink] : log_sinks_) {
+    sink(buffer_offset_ - size, written, static_cast<int>(size));
+  }
+}
+
+char *LogManager::CompressBlock(uint32_t size, uint32_t *block_size) {
+  if (size < static_cast<uint32_t>(MIN_COMPRESS_SIZE)) {
+    return nullptr;
+  }
+  char *block = block_buffers_[next_block_buffer_];
+  size_t stored = PageCompressor::Compress(flush_buffer_, size, block + LogRecord::BLOCK_HEADER_SIZE,
+                                           size - LogRecord::BLOCK_HEADER_SIZE - 1);
+  if (stored == 0) {
+    return nullptr;
+  }
+  next_block_buffer_ ^= 1;
+  int32_t header[] = {LogRecord::COMPRESSED_BLOCK, static_cast<int32_t>(size), static_cast<int32_t>(stored)};
+  memcpy(block, header, sizeof(header));
+  *block_size = LogRecord::BLOCK_HEADER_SIZE + stored;
+  return block;
+}
+
+void LogManager::AdaptGroupCommitDelay(uint32_t group) {
+  // a group of more than one commit means they come faster than a flush takes, and waiting a little longer batches
+  // more of them into one write; a commit alone is not held back for others that do not come
+  if (group > 1) {
+    group_commit_delay_ = std::min(std::max(group_commit_delay_ * 2, MIN_GROUP_COMMIT_DELAY), MAX_GROUP_COMMIT_DELAY);
+  } else if (group_commit_delay_ > MIN_GROUP_COMMIT_DELAY) {
+    group_commit_delay_ /= 2;
+  } else {
+    group_commit_delay_ = std::chrono::microseconds(0);
+  }
+}
+
+void LogManager::SerializeLogRecord(const LogRecord &log_record, char *data) {
+  // the header is the first five fields of the record, as they are laid out in it
+  memcpy(data, &log_record, LogRecord::HEADER_SIZE);
+  char *pos = data + LogRecord::HEADER_SIZE;
+  auto write_tuple = [&pos](const RID &rid, const Tuple &tuple) {
+    memcpy(pos, &rid, sizeof(RID));
+    pos += sizeof(RID);
+    tuple.SerializeTo(pos);
+    pos += sizeof(int32_t) + tuple.GetLength();
+  };
+  LogRecordType type = log_record.log_record_type_;
+  if (type == LogRecordType::CLR) {
+    memcpy(pos, &log_record.undo_next_lsn_, sizeof(lsn_t));
+    memcpy(pos + sizeof(lsn_t), &log_record.undone_type_, sizeof(LogRecordType));
+    pos += sizeof(lsn_t) + sizeof(LogRecordType);
+    type = log_record.undone_type_;
+  }
+  switch (type) {
+    case LogRecordType::INSERT:
+      write_tuple(log_record.insert_rid_, log_record.insert_tuple_);
+      break;
+    case LogRecordType::MARKDELETE:
+    case LogRecordType::APPLYDELETE:
+    case LogRecordType::ROLLBACKDELETE:
+      write_tuple(log_record.delete_rid_, log_record.delete_tuple_);
+      break;
+    case LogRecordType::UPDATE:
+      write_tuple(log_record.update_rid_, log_record.update_delta_);
+      break;
+    case LogRecordType::INDEXINSERT:
+    case LogRecordType::INDEXDELETE:
+      memcpy(pos, &log_record.index_oid_, sizeof(index_oid_t));
+      pos += sizeof(index_oid_t);
+      write_tuple(log_record.index_rid_, log_record.index_key_);
+      break;
+    case LogRecordType::NEWPAGE:
+      memcpy(pos, &log_record.prev_page_id_, sizeof(page_id_t));
+      memcpy(pos + sizeof(page_id_t), &log_record.page_id_, sizeof(page_id_t));
+      break;
+    case LogRecordType::INSERTBATCH: {
+      auto count = static_cast<uint32_t>(log_record.insert_rids_.size());
+      memcpy(pos, &count, sizeof(uint32_t));
+      pos += sizeof(uint32_t);
+      for (uint32_t i = 0; i < count; i++) {
+        write_tuple(log_record.insert_rids_[i], log_record.insert_tuples_[i]);
+      }
+      break;
+    }
+    case LogRecordType::ENDCHECKPOINT: {
+      auto txn_count = static_cast<uint32_t>(log_record.active_txns_.size());
+      memcpy(pos, &txn_count, sizeof(uint32_t));
+      pos += sizeof(uint32_t);
+      for (const auto &[txn_id, last_lsn] : log_record.active_txns_) {
+        memcpy(pos, &txn_id, sizeof(txn_id_t));
+        memcpy(pos + sizeof(txn_id_t), &last_lsn, sizeof(lsn_t));
+        pos += sizeof(txn_id_t) + sizeof(lsn_t);
+      }
+      auto page_count = static_cast<uint32_t>(log_record.dirty_pages_.size());
+      memcpy(pos, &page_count, sizeof(uint32_t));
+      pos += sizeof(uint32_t);
+      for (const auto &[page_id, rec_lsn] : log_record.dirty_pages_) {
+        memcpy(pos, &page_id, sizeof(page_id_t));
+        memcpy(pos + sizeof(page_id_t), &rec_lsn, sizeof(lsn_t));
+        pos += sizeof(page_id_t) + sizeof(lsn_t);
+      }
+      break;
+    }
+    default:
+      // BEGIN, COMMIT, ABORT and BEGINCHECKPOINT are the header alone
+      break;
+  }
+}
 
 }  // namespace bustub
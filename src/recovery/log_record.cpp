@@ -0,0 +1,135 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// log_record.cpp
+//
+// Identification: src/recovery/log_record.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "recovery/log_record.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace bustub {
+
+namespace {
+
+/** A range of bytes an update changed: at offset of the old tuple, old_length bytes became new_length */
+struct UpdateRange {
+  uint32_t offset_;
+  uint32_t old_length_;
+  uint32_t new_length_;
+};
+
+void Append(std::vector<char> *bytes, uint32_t value) {
+  const auto *data = reinterpret_cast<const char *>(&value);
+  bytes->insert(bytes->end(), data, data + sizeof(uint32_t));
+}
+
+uint32_t Read(const char **pos) {
+  uint32_t value;
+  memcpy(&value, *pos, sizeof(uint32_t));
+  *pos += sizeof(uint32_t);
+  return value;
+}
+
+}  // namespace
+
+Tuple LogRecord::EncodeUpdate(const Tuple &old_tuple, const Tuple &new_tuple) {
+  const char *old_data = old_tuple.GetData();
+  const char *new_data = new_tuple.GetData();
+  uint32_t old_size = old_tuple.GetLength();
+  uint32_t new_size = new_tuple.GetLength();
+  uint32_t common = std::min(old_size, new_size);
+  uint32_t prefix = 0;
+  while (prefix < common && old_data[prefix] == new_data[prefix]) {
+    prefix++;
+  }
+  uint32_t suffix = 0;
+  while (suffix < common - prefix && old_data[old_size - suffix - 1] == new_data[new_size - suffix - 1]) {
+    suffix++;
+  }
+
+  std::vector<UpdateRange> ranges;
+  if (old_size != new_size) {
+    // the columns after a value whose length changed move, so the bytes in between are logged whole
+    ranges.push_back({prefix, old_size - prefix - suffix, new_size - prefix - suffix});
+  } else {
+    // the tuple keeps its layout: each run of changed bytes is a range, unless the gap to the next is smaller than
+    // the header of a range
+    uint32_t end = old_size - suffix;
+    uint32_t i = prefix;
+    while (i < end) {
+      uint32_t start = i;
+      uint32_t last = i;
+      while (i < end && i - last <= UPDATE_RANGE_GAP) {
+        if (old_data[i] != new_data[i]) {
+          last = i;
+        }
+        i++;
+      }
+      ranges.push_back({start, last + 1 - start, last + 1 - start});
+      i = last + 1;
+      while (i < end && old_data[i] == new_data[i]) {
+        i++;
+      }
+    }
+  }
+
+  std::vector<char> bytes;
+  Append(&bytes, old_size);
+  Append(&bytes, new_size);
+  Append(&bytes, static_cast<uint32_t>(ranges.size()));
+  for (const UpdateRange &range : ranges) {
+    Append(&bytes, range.offset_);
+    Append(&bytes, range.old_length_);
+    Append(&bytes, range.new_length_);
+    bytes.insert(bytes.end(), old_data + range.offset_, old_data + range.offset_ + range.old_length_);
+    bytes.insert(bytes.end(), new_data + range.offset_, new_data + range.offset_ + range.new_length_);
+  }
+  Tuple delta;
+  delta.CopyData(bytes.data(), bytes.size());
+  return delta;
+}
+
+void LogRecord::ApplyUpdate(const Tuple &delta, const Tuple &from, bool undo, Tuple *to) {
+  const char *pos = delta.GetData();
+  uint32_t old_size = Read(&pos);
+  uint32_t new_size = Read(&pos);
+  uint32_t range_count = Read(&pos);
+  BUSTUB_ASSERT(from.GetLength() == (undo ? new_size : old_size), "an update applied to another version of a tuple");
+  std::vector<char> bytes;
+  bytes.reserve(undo ? old_size : new_size);
+  const char *from_data = from.GetData();
+  // the offsets are those of the old tuple, which the ranges before one shift in the new tuple
+  uint32_t copied = 0;
+  int64_t shift = 0;
+  for (uint32_t i = 0; i < range_count; i++) {
+    uint32_t offset = Read(&pos);
+    uint32_t old_length = Read(&pos);
+    uint32_t new_length = Read(&pos);
+    const char *old_bytes = pos;
+    const char *new_bytes = pos + old_length;
+    pos += old_length + new_length;
+    uint32_t from_offset = undo ? static_cast<uint32_t>(offset + shift) : offset;
+    bytes.insert(bytes.end(), from_data + copied, from_data + from_offset);
+    if (undo) {
+      bytes.insert(bytes.end(), old_bytes, old_bytes + old_length);
+      copied = from_offset + new_length;
+    } else {
+      bytes.insert(bytes.end(), new_bytes, new_bytes + new_length);
+      copied = from_offset + old_length;
+    }
+    shift += static_cast<int64_t>(new_length) - old_length;
+  }
+  bytes.insert(bytes.end(), from_data + copied, from_data + from.GetLength());
+  to->CopyData(bytes.data(), bytes.size());
+  to->rid_ = from.rid_;
+}
+
+}  // namespace bustub
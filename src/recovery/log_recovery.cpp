@@ -12,6 +12,15 @@
 
 #include "recovery/log_recovery.h"
 
+#include <cstring>
+#include <future>  // NOLINT
+#include <queue>
+#include <unordered_set>
+#include <utility>
+
+#include "catalog/catalog.h"
+#include "concurrency/transaction_manager.h"
+#include "storage/disk/page_compressor.h"
 #include "storage/page/table_page.h"
 
 namespace bustub {
@@ -20,21 +29,721 @@ namespace bustub {
  * @return: true means deserialize succeed, otherwise can't deserialize cause
  * incomplete log record
  */
-bool LogRecovery::DeserializeLogRecord(const char *data, LogRecord *log_record) { return false; }
+bool LogRecovery::DeserializeLogRecord(const char *data, LogRecord *log_record) {
+  return Deserialize(data, log_record, false);
+}
+
+bool LogRecovery::DeserializeLogRecordView(const char *data, LogRecord *log_record) {
+  return Deserialize(data, log_record, true);
+}
+
+bool LogRecovery::Deserialize(const char *data, LogRecord *log_record, bool view) {
+  *log_record = LogRecord();
+  memcpy(&log_record->size_, data, sizeof(int32_t));
+  memcpy(&log_record->lsn_, data + 4, sizeof(lsn_t));
+  memcpy(&log_record->txn_id_, data + 8, sizeof(txn_id_t));
+  memcpy(&log_record->prev_lsn_, data + 12, sizeof(lsn_t));
+  memcpy(&log_record->log_record_type_, data + 16, sizeof(LogRecordType));
+  // the log ends where the file does, which reads as zeros
+  if (log_record->size_ < LogRecord::HEADER_SIZE || log_record->log_record_type_ == LogRecordType::INVALID) {
+    return false;
+  }
+  const char *pos = data + LogRecord::HEADER_SIZE;
+  auto read_tuple = [&pos, view](RID *rid, Tuple *tuple) {
+    memcpy(rid, pos, sizeof(RID));
+    pos += sizeof(RID);
+    if (view) {
+      uint32_t size;
+      memcpy(&size, pos, sizeof(uint32_t));
+      *tuple = Tuple(RID(), const_cast<char *>(pos + sizeof(int32_t)), size);
+    } else {
+      tuple->DeserializeFrom(pos);
+    }
+    pos += sizeof(int32_t) + tuple->GetLength();
+  };
+  LogRecordType type = log_record->log_record_type_;
+  if (type == LogRecordType::CLR) {
+    memcpy(&log_record->undo_next_lsn_, pos, sizeof(lsn_t));
+    memcpy(&log_record->undone_type_, pos + sizeof(lsn_t), sizeof(LogRecordType));
+    pos += sizeof(lsn_t) + sizeof(LogRecordType);
+    type = log_record->undone_type_;
+  }
+  switch (type) {
+    case LogRecordType::INSERT:
+      read_tuple(&log_record->insert_rid_, &log_record->insert_tuple_);
+      break;
+    case LogRecordType::MARKDELETE:
+    case LogRecordType::APPLYDELETE:
+    case LogRecordType::ROLLBACKDELETE:
+      read_tuple(&log_record->delete_rid_, &log_record->delete_tuple_);
+      break;
+    case LogRecordType::UPDATE:
+      read_tuple(&log_record->update_rid_, &log_record->update_delta_);
+      break;
+    case LogRecordType::INDEXINSERT:
+    case LogRecordType::INDEXDELETE:
+      memcpy(&log_record->index_oid_, pos, sizeof(index_oid_t));
+      pos += sizeof(index_oid_t);
+      read_tuple(&log_record->index_rid_, &log_record->index_key_);
+      break;
+    case LogRecordType::NEWPAGE:
+      memcpy(&log_record->prev_page_id_, pos, sizeof(page_id_t));
+      memcpy(&log_record->page_id_, pos + sizeof(page_id_t), sizeof(page_id_t));
+      break;
+    case LogRecordType::INSERTBATCH: {
+      uint32_t count;
+      memcpy(&count, pos, sizeof(uint32_t));
+      pos += sizeof(uint32_t);
+      log_record->insert_rids_.resize(count);
+      log_record->insert_tuples_.resize(count);
+      for (uint32_t i = 0; i < count; i++) {
+        read_tuple(&log_record->insert_rids_[i], &log_record->insert_tuples_[i]);
+      }
+      break;
+    }
+    case LogRecordType::ENDCHECKPOINT: {
+      uint32_t txn_count;
+      memcpy(&txn_count, pos, sizeof(uint32_t));
+      pos += sizeof(uint32_t);
+      log_record->active_txns_.resize(txn_count);
+      for (auto &[txn_id, last_lsn] : log_record->active_txns_) {
+        memcpy(&txn_id, pos, sizeof(txn_id_t));
+        memcpy(&last_lsn, pos + sizeof(txn_id_t), sizeof(lsn_t));
+        pos += sizeof(txn_id_t) + sizeof(lsn_t);
+      }
+      uint32_t page_count;
+      memcpy(&page_count, pos, sizeof(uint32_t));
+      pos += sizeof(uint32_t);
+      log_record->dirty_pages_.resize(page_count);
+      for (auto &[page_id, rec_lsn] : log_record->dirty_pages_) {
+        memcpy(&page_id, pos, sizeof(page_id_t));
+        memcpy(&rec_lsn, pos + sizeof(page_id_t), sizeof(lsn_t));
+        pos += sizeof(page_id_t) + sizeof(lsn_t);
+      }
+      break;
+    }
+    default:
+      break;
+  }
+  return true;
+}
+
+std::shared_ptr<char[]> LogRecovery::ReadChunk(int64_t offset) {
+  std::shared_ptr<char[]> chunk(new char[LOG_BUFFER_SIZE + REDO_READ_SIZE]);
+  if (!disk_manager_->ReadLog(chunk.get() + LOG_BUFFER_SIZE, REDO_READ_SIZE, offset)) {
+    return nullptr;
+  }
+  return chunk;
+}
+
+void LogRecovery::ScanLog(int64_t offset, const LogVisitor &visit) {
+  bool end_of_log = false;
+  // the log is read a chunk ahead of the one being parsed; a record cut off by the end of a chunk is carried in front
+  // of the next one
+  int64_t chunk_offset = offset;
+  int carry = 0;
+  std::shared_ptr<char[]> chunk = ReadChunk(chunk_offset);
+  while (!end_of_log && chunk != nullptr) {
+    std::future<std::shared_ptr<char[]>> next =
+        std::async(std::launch::async, [this, chunk_offset] { return ReadChunk(chunk_offset + REDO_READ_SIZE); });
+    std::shared_ptr<const char[]> view = chunk;
+    const char *end = chunk.get() + LOG_BUFFER_SIZE + REDO_READ_SIZE;
+    const char *pos =
+        VisitRecords(view, chunk.get() + LOG_BUFFER_SIZE - carry, end, chunk_offset - carry, visit, &end_of_log);
+    carry = static_cast<int>(end - pos);
+    BUSTUB_ASSERT(carry <= LOG_BUFFER_SIZE || end_of_log, "log record larger than the log buffer");
+    chunk_offset += REDO_READ_SIZE;
+
+    std::shared_ptr<char[]> read = next.get();
+    if (read != nullptr && !end_of_log) {
+      memcpy(read.get() + LOG_BUFFER_SIZE - carry, pos, carry);
+    }
+    chunk = std::move(read);
+  }
+}
+
+const char *LogRecovery::VisitRecords(const std::shared_ptr<const char[]> &data, const char *start, const char *end,
+                                      int64_t offset, const LogVisitor &visit, bool *end_of_log) {
+  const char *pos = start;
+  LogRecord record;
+  while (pos + sizeof(int32_t) <= end) {
+    int32_t size;
+    memcpy(&size, pos, sizeof(int32_t));
+    if (size == LogRecord::COMPRESSED_BLOCK) {
+      if (pos + LogRecord::BLOCK_HEADER_SIZE > end) {
+        break;
+      }
+      int32_t raw_size;
+      int32_t stored_size;
+      memcpy(&raw_size, pos + sizeof(int32_t), sizeof(int32_t));
+      memcpy(&stored_size, pos + 2 * sizeof(int32_t), sizeof(int32_t));
+      if (raw_size <= 0 || raw_size > LOG_BUFFER_SIZE || stored_size <= 0 || stored_size >= raw_size) {
+        *end_of_log = true;
+        break;
+      }
+      if (pos + LogRecord::BLOCK_HEADER_SIZE + stored_size > end) {
+        break;
+      }
+      // the records of a block are views of the block they are decompressed into, and at its offset
+      std::shared_ptr<char[]> block(new char[raw_size]);
+      if (!PageCompressor::Decompress(pos + LogRecord::BLOCK_HEADER_SIZE, stored_size, block.get(), raw_size)) {
+        *end_of_log = true;
+        break;
+      }
+      std::shared_ptr<const char[]> view = block;
+      for (const char *in = block.get(); in + LogRecord::HEADER_SIZE <= block.get() + raw_size; in += record.size_) {
+        if (!DeserializeLogRecordView(in, &record)) {
+          break;
+        }
+        visit(&record, offset + (pos - start), view);
+      }
+      pos += LogRecord::BLOCK_HEADER_SIZE + stored_size;
+      continue;
+    }
+    if (pos + LogRecord::HEADER_SIZE > end || pos + size > end) {
+      break;
+    }
+    if (!DeserializeLogRecordView(pos, &record)) {
+      *end_of_log = true;
+      break;
+    }
+    visit(&record, offset + (pos - start), data);
+    pos += size;
+  }
+  return pos;
+}
+
+bool LogRecovery::ReadRecord(lsn_t lsn, LogRecord *record) {
+  offset_ = lsn_mapping_.at(lsn);
+  if (!disk_manager_->ReadLog(log_buffer_, LOG_BUFFER_SIZE, offset_)) {
+    return false;
+  }
+  int32_t size;
+  memcpy(&size, log_buffer_, sizeof(int32_t));
+  if (size != LogRecord::COMPRESSED_BLOCK) {
+    return DeserializeLogRecord(log_buffer_, record);
+  }
+  // undo goes back through the records of a block one after another, so the block is kept decompressed
+  if (offset_ != block_offset_) {
+    int32_t raw_size;
+    int32_t stored_size;
+    memcpy(&raw_size, log_buffer_ + sizeof(int32_t), sizeof(int32_t));
+    memcpy(&stored_size, log_buffer_ + 2 * sizeof(int32_t), sizeof(int32_t));
+    block_.resize(raw_size);
+    if (!PageCompressor::Decompress(log_buffer_ + LogRecord::BLOCK_HEADER_SIZE, stored_size, block_.data(),
+                                    raw_size)) {
+      return false;
+    }
+    block_offset_ = offset_;
+  }
+  for (size_t pos = 0; pos + LogRecord::HEADER_SIZE <= block_.size(); pos += record->size_) {
+    if (!DeserializeLogRecord(block_.data() + pos, record)) {
+      return false;
+    }
+    if (record->lsn_ == lsn) {
+      return true;
+    }
+  }
+  return false;
+}
+
+std::pair<page_id_t, page_id_t> LogRecovery::PagesOf(const LogRecord &record) {
+  LogRecordType type =
+      record.log_record_type_ == LogRecordType::CLR ? record.undone_type_ : record.log_record_type_;
+  switch (type) {
+    case LogRecordType::INSERT:
+      return {record.insert_rid_.GetPageId(), INVALID_PAGE_ID};
+    case LogRecordType::MARKDELETE:
+    case LogRecordType::APPLYDELETE:
+    case LogRecordType::ROLLBACKDELETE:
+      return {record.delete_rid_.GetPageId(), INVALID_PAGE_ID};
+    case LogRecordType::UPDATE:
+      return {record.update_rid_.GetPageId(), INVALID_PAGE_ID};
+    case LogRecordType::INSERTBATCH:
+      return {record.insert_rids_.front().GetPageId(), INVALID_PAGE_ID};
+    case LogRecordType::NEWPAGE:
+      return {record.page_id_, record.prev_page_id_};
+    default:
+      return {INVALID_PAGE_ID, INVALID_PAGE_ID};
+  }
+}
+
+/*
+ *analysis phase: read the log from the restart point to its end, building the active_txn_ table, the dirty page
+ *table and the lsn_mapping_ table
+ */
+void LogRecovery::Analyze() {
+  restart_offset_ = disk_manager_->ReadMasterRecord();
+  std::unordered_set<txn_id_t> finished;
+  lsn_t checkpoint_lsn = INVALID_LSN;
+  ScanLog(restart_offset_, [&](LogRecord *record, int64_t offset, const std::shared_ptr<const char[]> & /*chunk*/) {
+    lsn_mapping_[record->lsn_] = offset;
+    next_lsn_ = record->lsn_ + 1;
+    if (IsIndexRecord(*record)) {
+      KeepIndexRecord(*record);
+    }
+    if (record->txn_id_ != INVALID_TXN_ID) {
+      next_txn_id_ = std::max(next_txn_id_, record->txn_id_ + 1);
+    }
+    switch (record->log_record_type_) {
+      case LogRecordType::BEGINCHECKPOINT:
+        checkpoint_lsn = record->lsn_;
+        return;
+      case LogRecordType::ENDCHECKPOINT: {
+        // a transaction the checkpoint took running may have finished since, as the log after its begin record says
+        for (const auto &[txn_id, last_lsn] : record->active_txns_) {
+          if (finished.count(txn_id) == 0) {
+            active_txn_.emplace(txn_id, last_lsn);
+          }
+        }
+        // a page changed before the checkpoint that it did not take dirty was written back since
+        std::unordered_map<page_id_t, lsn_t> dirty_pages(record->dirty_pages_.begin(), record->dirty_pages_.end());
+        for (const auto &[page_id, rec_lsn] : dirty_pages_) {
+          if (rec_lsn >= checkpoint_lsn) {
+            auto [it, inserted] = dirty_pages.emplace(page_id, rec_lsn);
+            it->second = std::min(it->second, rec_lsn);
+          }
+        }
+        dirty_pages_ = std::move(dirty_pages);
+        return;
+      }
+      case LogRecordType::COMMIT:
+      case LogRecordType::ABORT:
+        active_txn_.erase(record->txn_id_);
+        txn_rows_.erase(record->txn_id_);
+        finished.insert(record->txn_id_);
+        return;
+      default:
+        break;
+    }
+    if (record->txn_id_ != INVALID_TXN_ID) {
+      active_txn_[record->txn_id_] = record->lsn_;
+      finished.erase(record->txn_id_);
+      if (lock_manager_ != nullptr) {
+        auto &rows = txn_rows_.try_emplace(record->txn_id_, record->lsn_, std::unordered_set<RID>{}).first->second;
+        for (const RID &rid : RowsOf(*record)) {
+          rows.second.insert(rid);
+        }
+      }
+    }
+    auto [page_id, prev_page_id] = PagesOf(*record);
+    for (page_id_t changed : {page_id, prev_page_id}) {
+      if (changed != INVALID_PAGE_ID) {
+        dirty_pages_.emplace(changed, record->lsn_);
+      }
+    }
+  });
+
+  redo_offset_ = restart_offset_;
+  auto oldest = std::min_element(dirty_pages_.begin(), dirty_pages_.end(),
+                                 [](const auto &a, const auto &b) { return a.second < b.second; });
+  if (oldest != dirty_pages_.end()) {
+    auto it = lsn_mapping_.find(oldest->second);
+    if (it != lsn_mapping_.end()) {
+      redo_offset_ = it->second;
+    }
+  }
+  // the compensation records of undo follow the log that was read
+  if (log_manager_ != nullptr) {
+    log_manager_->SetNextLSN(next_lsn_);
+  }
+  LockLosers();
+}
+
+std::vector<RID> LogRecovery::RowsOf(const LogRecord &record) {
+  LogRecordType type =
+      record.log_record_type_ == LogRecordType::CLR ? record.undone_type_ : record.log_record_type_;
+  switch (type) {
+    case LogRecordType::INSERT:
+      return {record.insert_rid_};
+    case LogRecordType::INSERTBATCH:
+      return record.insert_rids_;
+    case LogRecordType::MARKDELETE:
+    case LogRecordType::APPLYDELETE:
+    case LogRecordType::ROLLBACKDELETE:
+      return {record.delete_rid_};
+    case LogRecordType::UPDATE:
+      return {record.update_rid_};
+    case LogRecordType::INDEXINSERT:
+    case LogRecordType::INDEXDELETE:
+      return {record.index_rid_};
+    default:
+      return {};
+  }
+}
+
+void LogRecovery::LockLosers() {
+  if (lock_manager_ != nullptr) {
+    for (const auto &[txn_id, last_lsn] : active_txn_) {
+      auto loser = std::make_unique<Transaction>(txn_id);
+      // a loser the checkpoint took but that changed nothing since the restart point has no rows here
+      auto rows = txn_rows_.find(txn_id);
+      if (rows != txn_rows_.end()) {
+        loser->SetPrevLSN(rows->second.first);
+        for (const RID &rid : rows->second.second) {
+          lock_manager_->LockExclusive(loser.get(), rid);
+        }
+      }
+      loser->SetPrevLSN(last_lsn);
+      TransactionManager::txn_registry.Register(loser.get());
+      losers_[txn_id] = std::move(loser);
+    }
+  }
+  txn_rows_.clear();
+}
+
+void LogRecovery::ReleaseLoser(txn_id_t txn_id) {
+  auto loser = losers_.find(txn_id);
+  if (loser == losers_.end()) {
+    return;
+  }
+  Transaction *txn = loser->second.get();
+  TransactionManager::txn_registry.Unregister(txn_id);
+  txn->SetState(TransactionState::ABORTED);
+  while (!txn->GetExclusiveLockSet()->empty()) {
+    RID rid = *txn->GetExclusiveLockSet()->begin();
+    lock_manager_->Unlock(txn, rid);
+  }
+  losers_.erase(loser);
+}
 
 /*
  *redo phase on TABLE PAGE level(table/table_page.h)
- *read log file from the beginning to end (you must prefetch log records into
- *log buffer to reduce unnecessary I/O operations), remember to compare page's
- *LSN with log_record's sequence number, and also build active_txn_ table &
- *lsn_mapping_ table
+ *read log file from the smallest recovery LSN of the dirty page table to the end, and apply to each page the records
+ *it may not have, remembering to compare page's LSN with log_record's sequence number
  */
-void LogRecovery::Redo() {}
+void LogRecovery::Redo() {
+  Analyze();
+  DispatchRedo([this](const LogVisitor &visit) { ScanLog(redo_offset_, visit); }, true);
+  RedoIndexRecords();
+}
+
+int LogRecovery::RedoStream(const std::shared_ptr<const char[]> &data, int size, lsn_t *last_lsn) {
+  const char *pos = data.get();
+  DispatchRedo(
+      [&](const LogVisitor &visit) {
+        bool end_of_log = false;
+        pos = VisitRecords(
+            data, data.get(), data.get() + size, 0,
+            [&](LogRecord *record, int64_t offset, const std::shared_ptr<const char[]> &chunk) {
+              if (IsIndexRecord(*record)) {
+                KeepIndexRecord(*record);
+              }
+              visit(record, offset, chunk);
+              *last_lsn = record->lsn_;
+            },
+            &end_of_log);
+      },
+      false);
+  RedoIndexRecords();
+  return static_cast<int>(pos - data.get());
+}
+
+bool LogRecovery::IsIndexRecord(const LogRecord &record) {
+  LogRecordType type =
+      record.log_record_type_ == LogRecordType::CLR ? record.undone_type_ : record.log_record_type_;
+  return type == LogRecordType::INDEXINSERT || type == LogRecordType::INDEXDELETE;
+}
+
+void LogRecovery::KeepIndexRecord(const LogRecord &record) {
+  if (catalog_ == nullptr) {
+    return;
+  }
+  LogRecord &kept = index_records_.emplace_back(record);
+  kept.index_key_ = Tuple();
+  kept.index_key_.CopyFrom(record.index_key_);
+}
+
+void LogRecovery::RedoIndexRecords() {
+  for (LogRecord &record : index_records_) {
+    if (record.log_record_type_ != LogRecordType::CLR) {
+      ApplyIndexRecord(record.log_record_type_, &record);
+    } else {
+      // history is repeated, undo included
+      ApplyIndexRecord(record.undone_type_ == LogRecordType::INDEXINSERT ? LogRecordType::INDEXDELETE
+                                                                        : LogRecordType::INDEXINSERT,
+                       &record);
+    }
+  }
+  index_records_.clear();
+}
+
+void LogRecovery::ApplyIndexRecord(LogRecordType type, LogRecord *record) {
+  IndexInfo *index_info = catalog_ == nullptr ? nullptr : catalog_->GetIndex(record->index_oid_);
+  if (index_info == nullptr) {
+    return;
+  }
+  if (type == LogRecordType::INDEXINSERT) {
+    index_info->index_->InsertEntry(record->index_key_, record->index_rid_, nullptr);
+  } else {
+    index_info->index_->DeleteEntry(record->index_key_, record->index_rid_, nullptr);
+  }
+}
+
+void LogRecovery::DispatchRedo(const std::function<void(const LogVisitor &)> &scan, bool by_dirty_pages) {
+  std::vector<RedoQueue> queues(num_workers_);
+  std::vector<std::thread> workers;
+  workers.reserve(num_workers_);
+  for (RedoQueue &queue : queues) {
+    workers.emplace_back([this, &queue] { RunRedoWorker(&queue); });
+  }
+  auto hand_over = [&queues](size_t worker, std::vector<RedoItem> *batch) {
+    {
+      std::scoped_lock lock(queues[worker].latch_);
+      queues[worker].batches_.push_back(std::move(*batch));
+    }
+    queues[worker].cv_.notify_one();
+    batch->clear();
+  };
+
+  std::vector<std::vector<RedoItem>> batches(num_workers_);
+  scan([&](LogRecord *record, int64_t /*offset*/, const std::shared_ptr<const char[]> &chunk) {
+    auto [page_id, prev_page_id] = PagesOf(*record);
+    for (page_id_t changed : {prev_page_id, page_id}) {
+      if (changed == INVALID_PAGE_ID) {
+        continue;
+      }
+      // a page that is not dirty, or was dirtied after the record, was written back with it
+      if (by_dirty_pages) {
+        auto it = dirty_pages_.find(changed);
+        if (it == dirty_pages_.end() || record->lsn_ < it->second) {
+          continue;
+        }
+      }
+      size_t worker = changed % num_workers_;
+      batches[worker].push_back(RedoItem{changed, *record, chunk});
+      if (batches[worker].size() >= REDO_BATCH_SIZE) {
+        hand_over(worker, &batches[worker]);
+      }
+    }
+  });
+  for (size_t i = 0; i < num_workers_; i++) {
+    if (!batches[i].empty()) {
+      hand_over(i, &batches[i]);
+    }
+  }
+
+  for (RedoQueue &queue : queues) {
+    {
+      std::scoped_lock lock(queue.latch_);
+      queue.done_ = true;
+    }
+    queue.cv_.notify_one();
+  }
+  for (std::thread &worker : workers) {
+    worker.join();
+  }
+}
+
+void LogRecovery::RunRedoWorker(RedoQueue *queue) {
+  while (true) {
+    std::vector<RedoItem> batch;
+    {
+      std::unique_lock lock(queue->latch_);
+      queue->cv_.wait(lock, [queue] { return queue->done_ || !queue->batches_.empty(); });
+      if (queue->batches_.empty()) {
+        return;
+      }
+      batch = std::move(queue->batches_.front());
+      queue->batches_.pop_front();
+    }
+    for (RedoItem &item : batch) {
+      RedoRecord(item.page_id_, &item.record_);
+    }
+  }
+}
+
+void LogRecovery::RedoRecord(page_id_t page_id, LogRecord *record) {
+  Page *page = buffer_pool_manager_->FetchPage(page_id);
+  BUSTUB_ASSERT(page != nullptr, "no frame to redo a page in");
+  auto *table_page = reinterpret_cast<TablePage *>(page);
+  page->WLatch();
+  // a page that was never written back is all zeros, LSN included, which the record that made it may have too; a page
+  // that is as that record left it is made the same again
+  bool new_page = record->log_record_type_ == LogRecordType::NEWPAGE && page_id == record->page_id_;
+  bool redo = new_page ? page->GetLSN() <= record->lsn_ : page->GetLSN() < record->lsn_;
+  if (redo) {
+    RID rid;
+    switch (record->log_record_type_) {
+      case LogRecordType::INSERT:
+        table_page->InsertTuple(record->insert_tuple_, &rid, nullptr, nullptr, nullptr);
+        BUSTUB_ASSERT(rid == record->insert_rid_, "redo placed a tuple elsewhere");
+        break;
+      case LogRecordType::INSERTBATCH: {
+        std::vector<RID> rids;
+        table_page->InsertTuples(record->insert_tuples_, 0, &rids, nullptr, nullptr, nullptr);
+        BUSTUB_ASSERT(rids == record->insert_rids_, "redo placed a batch elsewhere");
+        break;
+      }
+      case LogRecordType::MARKDELETE:
+        table_page->MarkDelete(record->delete_rid_, nullptr, nullptr, nullptr);
+        break;
+      case LogRecordType::APPLYDELETE:
+        table_page->ApplyDelete(record->delete_rid_, nullptr, nullptr);
+        break;
+      case LogRecordType::ROLLBACKDELETE:
+        table_page->RollbackDelete(record->delete_rid_, nullptr, nullptr);
+        break;
+      case LogRecordType::UPDATE:
+        UpdateOnPage(table_page, record, false);
+        break;
+      case LogRecordType::NEWPAGE:
+        if (new_page) {
+          table_page->Init(page_id, PAGE_SIZE, record->prev_page_id_, nullptr, nullptr);
+        } else {
+          // the link from the page before is not logged on its own
+          table_page->SetNextPageId(record->page_id_);
+        }
+        break;
+      case LogRecordType::CLR:
+        // history is repeated, undo included
+        UndoOnPage(table_page, record->undone_type_, record);
+        break;
+      default:
+        break;
+    }
+    page->SetLSN(record->lsn_);
+  }
+  page->WUnlatch();
+  buffer_pool_manager_->UnpinPage(page_id, redo);
+}
 
 /*
  *undo phase on TABLE PAGE level(table/table_page.h)
- *iterate through active txn map and undo each operation
+ *roll back the transactions of the active txn map together, the latest record of any of them first; a compensation
+ *record is not undone, but tells the record of its transaction to go on from
  */
-void LogRecovery::Undo() {}
+void LogRecovery::Undo() {
+  std::priority_queue<std::pair<lsn_t, txn_id_t>> to_undo;
+  for (const auto &[txn_id, last_lsn] : active_txn_) {
+    to_undo.emplace(last_lsn, txn_id);
+  }
+  LogRecord record;
+  while (!to_undo.empty()) {
+    auto [lsn, txn_id] = to_undo.top();
+    to_undo.pop();
+    bool read = ReadRecord(lsn, &record);
+    BUSTUB_ASSERT(read, "a record the analysis read is gone");
+    lsn_t next_lsn;
+    if (record.log_record_type_ == LogRecordType::CLR) {
+      next_lsn = record.undo_next_lsn_;
+    } else {
+      UndoRecord(&record);
+      next_lsn = record.prev_lsn_;
+    }
+    if (next_lsn != INVALID_LSN) {
+      to_undo.emplace(next_lsn, txn_id);
+      continue;
+    }
+    if (log_manager_ != nullptr) {
+      LogRecord abort_record(txn_id, active_txn_.at(txn_id), LogRecordType::ABORT);
+      log_manager_->AppendLogRecord(&abort_record);
+    }
+    // the rows of a loser are let go of once it is rolled back, rather than when all are
+    ReleaseLoser(txn_id);
+  }
+  if (log_manager_ != nullptr) {
+    log_manager_->Flush();
+  }
+  active_txn_.clear();
+  lsn_mapping_.clear();
+  dirty_pages_.clear();
+  block_.clear();
+  block_offset_ = -1;
+}
+
+void LogRecovery::UndoInBackground() {
+  WaitForUndo();
+  undo_thread_ = new std::thread(&LogRecovery::Undo, this);
+}
+
+void LogRecovery::WaitForUndo() {
+  if (undo_thread_ != nullptr) {
+    undo_thread_->join();
+    delete undo_thread_;
+    undo_thread_ = nullptr;
+  }
+}
+
+void LogRecovery::UndoOnPage(TablePage *table_page, LogRecordType type, LogRecord *record) {
+  RID rid;
+  switch (type) {
+    case LogRecordType::INSERT:
+      table_page->ApplyDelete(record->insert_rid_, nullptr, nullptr);
+      break;
+    case LogRecordType::INSERTBATCH:
+      for (const RID &insert_rid : record->insert_rids_) {
+        table_page->ApplyDelete(insert_rid, nullptr, nullptr);
+      }
+      break;
+    case LogRecordType::MARKDELETE:
+      table_page->RollbackDelete(record->delete_rid_, nullptr, nullptr);
+      break;
+    case LogRecordType::APPLYDELETE:
+      table_page->InsertTuple(record->delete_tuple_, &rid, nullptr, nullptr, nullptr);
+      break;
+    case LogRecordType::ROLLBACKDELETE:
+      table_page->MarkDelete(record->delete_rid_, nullptr, nullptr, nullptr);
+      break;
+    case LogRecordType::UPDATE:
+      UpdateOnPage(table_page, record, true);
+      break;
+    default:
+      break;
+  }
+}
+
+void LogRecovery::UpdateOnPage(TablePage *table_page, LogRecord *record, bool undo) {
+  Tuple current;
+  bool deleted;
+  bool read = table_page->ReadTuple(record->update_rid_, &current, &deleted);
+  BUSTUB_ASSERT(read, "the tuple of an update is gone");
+  Tuple updated;
+  LogRecord::ApplyUpdate(record->update_delta_, current, undo, &updated);
+  Tuple replaced;
+  table_page->UpdateTuple(updated, &replaced, record->update_rid_, nullptr, nullptr, nullptr);
+}
+
+void LogRecovery::UndoRecord(LogRecord *record) {
+  if (IsIndexRecord(*record)) {
+    LogCompensation(record);
+    ApplyIndexRecord(record->log_record_type_ == LogRecordType::INDEXINSERT ? LogRecordType::INDEXDELETE
+                                                                            : LogRecordType::INDEXINSERT,
+                     record);
+    return;
+  }
+  page_id_t page_id = PagesOf(*record).first;
+  // a new page is left in the table, empty
+  if (page_id == INVALID_PAGE_ID || record->log_record_type_ == LogRecordType::NEWPAGE) {
+    return;
+  }
+  Page *page = buffer_pool_manager_->FetchPage(page_id);
+  BUSTUB_ASSERT(page != nullptr, "no frame to undo a page in");
+  auto *table_page = reinterpret_cast<TablePage *>(page);
+  page->WLatch();
+  // the compensation is logged before the page has it, and the page takes its LSN
+  lsn_t clr_lsn = LogCompensation(record);
+  if (clr_lsn != INVALID_LSN) {
+    page->SetLSN(clr_lsn);
+  }
+  UndoOnPage(table_page, record->log_record_type_, record);
+  page->WUnlatch();
+  buffer_pool_manager_->UnpinPage(page_id, true);
+}
+
+lsn_t LogRecovery::LogCompensation(LogRecord *record) {
+  if (log_manager_ == nullptr) {
+    return INVALID_LSN;
+  }
+  lsn_t &last_lsn = active_txn_.at(record->txn_id_);
+  LogRecord clr(record->txn_id_, last_lsn, record->prev_lsn_, *record);
+  last_lsn = log_manager_->AppendLogRecord(&clr);
+  // a checkpoint taken while undo runs in the background finds the loser at its compensation
+  auto loser = losers_.find(record->txn_id_);
+  if (loser != losers_.end()) {
+    loser->second->SetPrevLSN(last_lsn);
+  }
+  return last_lsn;
+}
 
 }  // namespace bustub
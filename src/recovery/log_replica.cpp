@@ -0,0 +1,135 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// log_replica.cpp
+//
+// Identification: src/recovery/log_replica.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "recovery/log_replica.h"
+
+#include <cstring>
+#include <memory>
+
+namespace bustub {
+
+bool LogReplica::Follow(LogManager *primary, int64_t offset) {
+  Stop();
+  {
+    std::scoped_lock lock(latch_);
+    stop_ = false;
+    pending_.clear();
+    arrivals_.clear();
+    received_offset_ = offset;
+    applied_offset_ = offset;
+  }
+  redo_thread_ = new std::thread(&LogReplica::RunRedo, this);
+  sink_id_ = primary->AddLogSink(
+      offset, [this](int64_t shipped_offset, const char *data, int size) { Receive(shipped_offset, data, size); });
+  if (sink_id_ < 0) {
+    Stop();
+    return false;
+  }
+  primary_ = primary;
+  return true;
+}
+
+void LogReplica::Stop() {
+  if (primary_ != nullptr) {
+    primary_->RemoveLogSink(sink_id_);
+    primary_ = nullptr;
+    sink_id_ = -1;
+  }
+  if (redo_thread_ == nullptr) {
+    return;
+  }
+  {
+    std::scoped_lock lock(latch_);
+    stop_ = true;
+  }
+  received_cv_.notify_one();
+  redo_thread_->join();
+  delete redo_thread_;
+  redo_thread_ = nullptr;
+}
+
+void LogReplica::Receive(int64_t offset, const char *data, int size) {
+  {
+    std::scoped_lock lock(latch_);
+    // a stretch that overlaps what came before goes on from its end
+    if (offset + size <= received_offset_) {
+      return;
+    }
+    BUSTUB_ASSERT(offset <= received_offset_, "a gap in the log shipped to a replica");
+    auto skip = static_cast<int>(received_offset_ - offset);
+    pending_.insert(pending_.end(), data + skip, data + size);
+    received_offset_ = offset + size;
+    arrivals_.emplace_back(received_offset_, std::chrono::steady_clock::now());
+  }
+  received_cv_.notify_one();
+}
+
+bool LogReplica::WaitForLSN(lsn_t lsn, std::chrono::milliseconds timeout) {
+  std::unique_lock lock(latch_);
+  return applied_cv_.wait_for(lock, timeout,
+                              [this, lsn] { return applied_lsn_ != INVALID_LSN && applied_lsn_ >= lsn; });
+}
+
+ReplicationStats LogReplica::GetStats() {
+  std::scoped_lock lock(latch_);
+  ReplicationStats stats;
+  stats.applied_lsn_ = applied_lsn_;
+  stats.received_offset_ = received_offset_;
+  stats.applied_offset_ = applied_offset_;
+  if (!arrivals_.empty()) {
+    stats.lag_us_ = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() -
+                                                                          arrivals_.front().second)
+                        .count();
+  }
+  return stats;
+}
+
+void LogReplica::RunRedo() {
+  // the start of a record the log received so far cuts off, which the next stretch goes on with
+  std::vector<char> carry;
+  while (true) {
+    std::vector<char> received;
+    {
+      std::unique_lock lock(latch_);
+      received_cv_.wait(lock, [this] { return stop_ || !pending_.empty(); });
+      if (pending_.empty()) {
+        return;
+      }
+      received.swap(pending_);
+    }
+    // all the log that came while the last stretch was redone is redone at once
+    auto size = static_cast<int>(carry.size() + received.size());
+    std::shared_ptr<char[]> data(new char[size]);
+    memcpy(data.get(), carry.data(), carry.size());
+    memcpy(data.get() + carry.size(), received.data(), received.size());
+    lsn_t last_lsn = INVALID_LSN;
+    int redone;
+    {
+      std::unique_lock hold(replica_latch_);
+      redone = recovery_.RedoStream(data, size, &last_lsn);
+    }
+    carry.assign(data.get() + redone, data.get() + size);
+    {
+      std::scoped_lock lock(latch_);
+      applied_offset_ += redone;
+      if (last_lsn != INVALID_LSN) {
+        applied_lsn_ = last_lsn;
+      }
+      while (!arrivals_.empty() && arrivals_.front().first <= applied_offset_) {
+        arrivals_.pop_front();
+      }
+    }
+    applied_cv_.notify_all();
+  }
+}
+
+}  // namespace bustub
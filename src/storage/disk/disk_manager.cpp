@@ -10,15 +10,22 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <fcntl.h>
+#include <linux/falloc.h>
 #include <sys/stat.h>
+#include <unistd.h>
+#include <algorithm>
 #include <cassert>
+#include <cstdio>
 #include <cstring>
+#include <filesystem>
 #include <iostream>
 #include <string>
 #include <thread>  // NOLINT
 
 #include "common/exception.h"
 #include "common/logger.h"
+#include "common/tracer.h"
 #include "storage/disk/disk_manager.h"
 
 namespace bustub {
@@ -29,8 +36,12 @@ static char *buffer_used;
  * Constructor: open/create a single database file & log file
  * @input db_file: database file name
  */
-DiskManager::DiskManager(const std::string &db_file)
-    : file_name_(db_file), next_page_id_(0), num_flushes_(0), num_writes_(0), flush_log_(false), flush_log_f_(nullptr) {
+DiskManager::DiskManager(const std::string &db_file, IoEngineType io_engine, bool direct_io, bool compress_pages)
+    : file_name_(db_file),
+      num_flushes_(0),
+      num_writes_(0),
+      flush_log_(false),
+      flush_log_f_(nullptr) {
   std::string::size_type n = file_name_.rfind('.');
   if (n == std::string::npos) {
     LOG_DEBUG("wrong file format");
@@ -38,41 +49,103 @@ DiskManager::DiskManager(const std::string &db_file)
   }
   log_name_ = file_name_.substr(0, n) + ".log";
 
-  log_io_.open(log_name_, std::ios::binary | std::ios::in | std::ios::app | std::ios::out);
-  // directory or file does not exist
-  if (!log_io_.is_open()) {
-    log_io_.clear();
-    // create a new file
-    log_io_.open(log_name_, std::ios::binary | std::ios::trunc | std::ios::app | std::ios::out);
-    log_io_.close();
-    // reopen with original mode
-    log_io_.open(log_name_, std::ios::binary | std::ios::in | std::ios::app | std::ios::out);
-    if (!log_io_.is_open()) {
+  std::ifstream control(log_name_, std::ios::binary);
+  bool new_log = !control.read(reinterpret_cast<char *>(&master_offset_), sizeof(int64_t)) ||
+                 !control.read(reinterpret_cast<char *>(&first_log_segment_), sizeof(int64_t));
+  control.close();
+  if (new_log) {
+    master_offset_ = 0;
+    first_log_segment_ = 0;
+    WriteLogControl();
+    if (GetFileSize(log_name_) < 0) {
       throw Exception("can't open dblog file");
     }
   }
-
-  db_io_.open(db_file, std::ios::binary | std::ios::in | std::ios::out);
-  // directory or file does not exist
-  if (!db_io_.is_open()) {
-    db_io_.clear();
-    // create a new file
-    db_io_.open(db_file, std::ios::binary | std::ios::trunc | std::ios::out);
-    db_io_.close();
-    // reopen with original mode
-    db_io_.open(db_file, std::ios::binary | std::ios::in | std::ios::out);
-    if (!db_io_.is_open()) {
-      throw Exception("can't open db file");
+  // the log ends where the last segment that is not empty does; the segments of an earlier log, or before the first
+  // one in use, which a crash left as they were being recycled, go
+  log_end_ = first_log_segment_ * LOG_SEGMENT_SIZE;
+  std::filesystem::path log_path(log_name_);
+  std::filesystem::path log_dir = log_path.has_parent_path() ? log_path.parent_path() : ".";
+  std::string prefix = log_path.filename().string() + ".";
+  std::error_code error;
+  for (const auto &entry : std::filesystem::directory_iterator(log_dir, error)) {
+    std::string name = entry.path().filename().string();
+    if (name.compare(0, prefix.size(), prefix) != 0 || name.size() == prefix.size() ||
+        name.find_first_not_of("0123456789", prefix.size()) != std::string::npos) {
+      continue;
+    }
+    int64_t segment = std::stoll(name.substr(prefix.size()));
+    if (new_log || segment < first_log_segment_) {
+      std::filesystem::remove(entry.path(), error);
+      continue;
+    }
+    last_log_segment_ = std::max(last_log_segment_, segment);
+    int size = GetFileSize(entry.path().string());
+    if (size > 0) {
+      log_end_ = std::max(log_end_, segment * LOG_SEGMENT_SIZE + size);
     }
   }
+
+  tablespaces_[DEFAULT_TABLESPACE] = new Tablespace(db_file, io_engine, direct_io, compress_pages);
   buffer_used = nullptr;
 }
 
+DiskManager::~DiskManager() {
+  for (auto &tablespace : tablespaces_) {
+    delete tablespace.load();
+  }
+}
+
+bool DiskManager::AddTablespace(tablespace_id_t tablespace_id, const std::string &db_file, IoEngineType io_engine,
+                                bool direct_io, bool compress_pages) {
+  if (tablespace_id <= DEFAULT_TABLESPACE || tablespace_id >= MAX_TABLESPACES) {
+    return false;
+  }
+  std::scoped_lock latch{tablespaces_latch_};
+  if (tablespaces_[tablespace_id] != nullptr) {
+    return false;
+  }
+  tablespaces_[tablespace_id] = new Tablespace(db_file, io_engine, direct_io, compress_pages);
+  return true;
+}
+
+bool DiskManager::EnableTiering(tablespace_id_t tablespace_id, ObjectStore *store, const std::string &cache_file,
+                                size_t cache_extents) {
+  Tablespace *tablespace = FindTablespace(tablespace_id);
+  return tablespace != nullptr && tablespace->EnableTiering(store, cache_file, cache_extents);
+}
+
+bool DiskManager::OffloadExtent(page_id_t page_id) {
+  return GetTablespace(page_id)->OffloadExtent(
+      static_cast<size_t>(GetLocalPageId(page_id)) / TieredStorage::EXTENT_PAGES);
+}
+
+Tablespace *DiskManager::FindTablespace(tablespace_id_t tablespace_id) const {
+  if (tablespace_id < 0 || tablespace_id >= MAX_TABLESPACES) {
+    return nullptr;
+  }
+  return tablespaces_[tablespace_id].load();
+}
+
+Tablespace *DiskManager::GetTablespace(page_id_t page_id) const {
+  Tablespace *tablespace = page_id < 0 ? nullptr : FindTablespace(GetTablespaceId(page_id));
+  if (tablespace == nullptr) {
+    throw Exception(ExceptionType::OUT_OF_RANGE, "page " + std::to_string(page_id) + " is in no tablespace");
+  }
+  return tablespace;
+}
+
 /**
  * Close all file streams
  */
 void DiskManager::ShutDown() {
-  db_io_.close();
+  StopPageTrace();
+  for (auto &tablespace : tablespaces_) {
+    if (Tablespace *open = tablespace.load(); open != nullptr) {
+      open->Close();
+    }
+  }
+  std::scoped_lock lock(log_latch_);
   log_io_.close();
 }
 
@@ -80,45 +153,122 @@ void DiskManager::ShutDown() {
  * Write the contents of the specified page into disk file
  */
 void DiskManager::WritePage(page_id_t page_id, const char *page_data) {
-  size_t offset = static_cast<size_t>(page_id) * PAGE_SIZE;
-  // set write cursor to offset
-  num_writes_ += 1;
-  db_io_.seekp(offset);
-  db_io_.write(page_data, PAGE_SIZE);
-  // check for I/O error
-  if (db_io_.bad()) {
+  // pwrite hands the page to the OS right away, like the flush after every write used to
+  if (!WritePages({{page_id, page_data}})) {
     LOG_DEBUG("I/O error while writing");
-    return;
   }
-  // needs to flush to keep disk file in sync
-  db_io_.flush();
 }
 
 /**
- * Read the contents of the specified page into the given memory area
+ * Splits a batch of pages by tablespace, turning the page ids into local ones, and starts each part of it.
+ * @param pages the batch
+ * @param start called with a tablespace and its part of the batch
+ * @return a future for all parts
  */
-void DiskManager::ReadPage(page_id_t page_id, char *page_data) {
-  int offset = page_id * PAGE_SIZE;
-  // check if read beyond file length
-  if (offset > GetFileSize(file_name_)) {
-    LOG_DEBUG("I/O error reading past end of file");
-    // std::cerr << "I/O error while reading" << std::endl;
-  } else {
-    // set read cursor to offset
-    db_io_.seekp(offset);
-    db_io_.read(page_data, PAGE_SIZE);
-    if (db_io_.bad()) {
-      LOG_DEBUG("I/O error while reading");
-      return;
+template <typename Data, typename Start>
+static std::future<bool> StartPerTablespace(const std::vector<std::pair<page_id_t, Data>> &pages, Start start) {
+  std::vector<std::vector<std::pair<page_id_t, Data>>> parts(DiskManager::MAX_TABLESPACES);
+  size_t num_parts = 0;
+  tablespace_id_t last = DiskManager::DEFAULT_TABLESPACE;
+  for (const auto &[page_id, data] : pages) {
+    last = DiskManager::GetTablespaceId(page_id);
+    num_parts += parts[last].empty() ? 1 : 0;
+    parts[last].emplace_back(DiskManager::GetLocalPageId(page_id), data);
+  }
+  if (num_parts <= 1) {
+    // the common case: the whole batch goes to one tablespace
+    return start(last, parts[last]);
+  }
+
+  std::vector<std::future<bool>> started;
+  for (tablespace_id_t tablespace_id = 0; tablespace_id < DiskManager::MAX_TABLESPACES; ++tablespace_id) {
+    if (!parts[tablespace_id].empty()) {
+      started.push_back(start(tablespace_id, parts[tablespace_id]));
     }
-    // if file ends before reading PAGE_SIZE
-    int read_count = db_io_.gcount();
-    if (read_count < PAGE_SIZE) {
-      LOG_DEBUG("Read less than a page");
-      db_io_.clear();
-      // std::cerr << "Read less than a page" << std::endl;
-      memset(page_data + read_count, 0, PAGE_SIZE - read_count);
+  }
+  return std::async(std::launch::deferred, [started = std::move(started)]() mutable {
+    bool ok = true;
+    for (auto &part : started) {
+      ok = part.get() && ok;
     }
+    return ok;
+  });
+}
+
+std::future<bool> DiskManager::WritePagesAsync(const std::vector<std::pair<page_id_t, const char *>> &pages) {
+  for (const auto &page : pages) {
+    GetTablespace(page.first);
+  }
+  num_writes_ += static_cast<int>(pages.size());
+  for (const auto &page : pages) {
+    TracePageAccess(page.first, PageAccessType::WRITE);
+  }
+  return StartPerTablespace(pages, [this](tablespace_id_t tablespace_id, const auto &part) {
+    return FindTablespace(tablespace_id)->WritePagesAsync(part);
+  });
+}
+
+std::future<bool> DiskManager::ReadPagesAsync(const std::vector<std::pair<page_id_t, char *>> &pages) {
+  for (const auto &page : pages) {
+    GetTablespace(page.first);
+  }
+  num_reads_ += static_cast<int>(pages.size());
+  for (const auto &page : pages) {
+    TracePageAccess(page.first, PageAccessType::READ);
+  }
+  return StartPerTablespace(pages, [this](tablespace_id_t tablespace_id, const auto &part) {
+    return FindTablespace(tablespace_id)->ReadPagesAsync(part);
+  });
+}
+
+bool DiskManager::ReadPages(page_id_t first_page_id, size_t count, char *const *buffers) {
+  std::vector<std::pair<page_id_t, char *>> pages;
+  pages.reserve(count);
+  for (size_t i = 0; i < count; ++i) {
+    pages.emplace_back(first_page_id + static_cast<page_id_t>(i), buffers[i]);
+  }
+  // the tablespace merges the reads of adjacent pages into vectored ones
+  return ReadPages(pages);
+}
+
+bool DiskManager::WritePages(const std::vector<std::pair<page_id_t, const char *>> &pages) {
+  ScopedLatency latency(&write_latency_);
+  TraceSpan span("write_pages", "disk");
+  span.SetArg("pages", static_cast<int64_t>(pages.size()));
+  return WritePagesAsync(pages).get();
+}
+
+bool DiskManager::ReadPages(const std::vector<std::pair<page_id_t, char *>> &pages) {
+  ScopedLatency latency(&read_latency_);
+  TraceSpan span("read_pages", "disk");
+  span.SetArg("pages", static_cast<int64_t>(pages.size()));
+  return ReadPagesAsync(pages).get();
+}
+
+bool DiskManager::VerifyPage(page_id_t page_id, const char *page_data) {
+  return GetTablespace(page_id)->VerifyPage(GetLocalPageId(page_id), page_data);
+}
+
+uint32_t DiskManager::GetPageChecksum(page_id_t page_id) {
+  return GetTablespace(page_id)->GetPageChecksum(GetLocalPageId(page_id));
+}
+
+bool DiskManager::MapReadOnly() { return tablespaces_[DEFAULT_TABLESPACE].load()->MapReadOnly(); }
+
+const char *DiskManager::GetMappedPage(page_id_t page_id) {
+  if (page_id < 0 || GetTablespaceId(page_id) != DEFAULT_TABLESPACE) {
+    return nullptr;
+  }
+  return tablespaces_[DEFAULT_TABLESPACE].load()->GetMappedPage(page_id);
+}
+
+/**
+ * Read the contents of the specified page into the given memory area
+ */
+void DiskManager::ReadPage(page_id_t page_id, char *page_data) {
+  // a page past the end of the file, or only partly in it, reads as zeroes where the file ends
+  if (!ReadPages({{page_id, page_data}})) {
+    LOG_DEBUG("I/O error while reading");
   }
 }
 
@@ -143,13 +293,27 @@ void DiskManager::WriteLog(char *log_data, int size) {
   }
 
   num_flushes_ += 1;
-  // sequence write
-  log_io_.write(log_data, size);
-
-  // check for I/O error
-  if (log_io_.bad()) {
-    LOG_DEBUG("I/O error while writing log");
-    return;
+  num_log_bytes_written_ += size;
+  ScopedLatency latency(&log_write_latency_);
+  TraceSpan span("write_log", "disk");
+  span.SetArg("bytes", size);
+  std::scoped_lock lock(log_latch_);
+  // sequence write, into the next segment once one is full
+  while (size > 0) {
+    int64_t segment = log_end_ / LOG_SEGMENT_SIZE;
+    if (segment != log_segment_ || !log_io_.is_open()) {
+      OpenLogSegment(segment);
+    }
+    auto count = static_cast<int>(std::min<int64_t>(size, (segment + 1) * LOG_SEGMENT_SIZE - log_end_));
+    log_io_.write(log_data, count);
+    // check for I/O error
+    if (log_io_.bad()) {
+      LOG_DEBUG("I/O error while writing log");
+      return;
+    }
+    log_data += count;
+    size -= count;
+    log_end_ += count;
   }
   // needs to flush to keep disk file in sync
   log_io_.flush();
@@ -161,41 +325,153 @@ void DiskManager::WriteLog(char *log_data, int size) {
  * Always read from the beginning and perform sequence read
  * @return: false means already reach the end
  */
-bool DiskManager::ReadLog(char *log_data, int size, int offset) {
-  if (offset >= GetFileSize(log_name_)) {
-    // LOG_DEBUG("end of log file");
-    // LOG_DEBUG("file size is %d", GetFileSize(log_name_));
+bool DiskManager::ReadLog(char *log_data, int size, int64_t offset) {
+  std::scoped_lock lock(log_latch_);
+  if (offset >= log_end_) {
     return false;
   }
-  log_io_.seekp(offset);
-  log_io_.read(log_data, size);
-
-  if (log_io_.bad()) {
-    LOG_DEBUG("I/O error while reading log");
+  if (offset < first_log_segment_ * LOG_SEGMENT_SIZE) {
+    LOG_DEBUG("read of a recycled segment of the log");
     return false;
   }
   // if log file ends before reading "size"
-  int read_count = log_io_.gcount();
-  if (read_count < size) {
-    log_io_.clear();
-    memset(log_data + read_count, 0, size - read_count);
+  auto count = static_cast<int>(std::min<int64_t>(size, log_end_ - offset));
+  memset(log_data + count, 0, size - count);
+  while (count > 0) {
+    int64_t segment = offset / LOG_SEGMENT_SIZE;
+    auto in_segment = static_cast<int>(std::min<int64_t>(count, (segment + 1) * LOG_SEGMENT_SIZE - offset));
+    std::ifstream segment_io(LogSegmentName(segment), std::ios::binary);
+    segment_io.seekg(offset - segment * LOG_SEGMENT_SIZE);
+    segment_io.read(log_data, in_segment);
+    if (segment_io.gcount() != in_segment) {
+      LOG_DEBUG("I/O error while reading log");
+      return false;
+    }
+    log_data += in_segment;
+    offset += in_segment;
+    count -= in_segment;
   }
-
   return true;
 }
 
+int64_t DiskManager::GetLogEnd() {
+  std::scoped_lock lock(log_latch_);
+  return log_end_;
+}
+
+int64_t DiskManager::GetLogStart() {
+  std::scoped_lock lock(log_latch_);
+  return first_log_segment_ * LOG_SEGMENT_SIZE;
+}
+
+void DiskManager::WriteMasterRecord(int64_t offset) {
+  std::scoped_lock lock(log_latch_);
+  master_offset_ = offset;
+  int64_t first_log_segment = first_log_segment_;
+  first_log_segment_ = std::max(first_log_segment_, std::min(offset, log_end_) / LOG_SEGMENT_SIZE);
+  // the segments are not in use once the master record says so, and only then are they emptied
+  WriteLogControl();
+  int spare_segments = static_cast<int>(last_log_segment_ - std::max(log_segment_, log_end_ / LOG_SEGMENT_SIZE));
+  for (int64_t segment = first_log_segment; segment < first_log_segment_; segment++) {
+    std::string name = LogSegmentName(segment);
+    if (segment == log_segment_) {
+      log_io_.close();
+      log_segment_ = -1;
+    }
+    if (spare_segments >= MAX_SPARE_LOG_SEGMENTS) {
+      std::remove(name.c_str());
+      continue;
+    }
+    // emptied before it is renamed, so that a crash in between leaves no segment past the end with old records
+    truncate(name.c_str(), 0);
+    std::string spare = LogSegmentName(++last_log_segment_);
+    if (std::rename(name.c_str(), spare.c_str()) != 0) {
+      LOG_DEBUG("I/O error while recycling a segment of the log");
+      last_log_segment_--;
+      continue;
+    }
+    spare_segments++;
+  }
+}
+
+int64_t DiskManager::ReadMasterRecord() {
+  std::scoped_lock lock(log_latch_);
+  return master_offset_;
+}
+
+void DiskManager::OpenLogSegment(int64_t segment) {
+  log_io_.close();
+  log_io_.clear();
+  std::string name = LogSegmentName(segment);
+  if (segment > last_log_segment_) {
+    last_log_segment_ = segment;
+  }
+  // the blocks of the segment are allocated up front, which leaves its size, and so the end of the log, as it is
+  int fd = open(name.c_str(), O_WRONLY | O_CREAT, 0644);
+  if (fd >= 0) {
+    if (GetFileSize(name) == 0) {
+      fallocate(fd, FALLOC_FL_KEEP_SIZE, 0, LOG_SEGMENT_SIZE);
+    }
+    close(fd);
+  }
+  log_io_.open(name, std::ios::binary | std::ios::app | std::ios::out);
+  if (!log_io_.is_open()) {
+    throw Exception("can't open dblog file");
+  }
+  log_segment_ = segment;
+}
+
+void DiskManager::WriteLogControl() {
+  std::ofstream control(log_name_, std::ios::binary | std::ios::trunc);
+  control.write(reinterpret_cast<const char *>(&master_offset_), sizeof(int64_t));
+  control.write(reinterpret_cast<const char *>(&first_log_segment_), sizeof(int64_t));
+  control.flush();
+  if (control.bad()) {
+    LOG_DEBUG("I/O error while writing the master record");
+  }
+}
+
 /**
  * Allocate new page (operations like create index/table)
  * For now just keep an increasing counter
  */
-page_id_t DiskManager::AllocatePage() { return next_page_id_++; }
+page_id_t DiskManager::AllocatePage(tablespace_id_t tablespace_id) {
+  Tablespace *tablespace = FindTablespace(tablespace_id);
+  if (tablespace == nullptr) {
+    throw Exception(ExceptionType::OUT_OF_RANGE, "no tablespace " + std::to_string(tablespace_id));
+  }
+  page_id_t local_page_id = tablespace->AllocatePage();
+  if (local_page_id >= MAX_PAGES_PER_TABLESPACE) {
+    tablespace->DeallocatePage(local_page_id);
+    throw Exception(ExceptionType::OUT_OF_RANGE, "tablespace " + std::to_string(tablespace_id) + " is full");
+  }
+  return MakePageId(tablespace_id, local_page_id);
+}
+
+page_id_t DiskManager::AllocateExtent(size_t num_pages, tablespace_id_t tablespace_id) {
+  BUSTUB_ASSERT(num_pages > 0 && num_pages <= FileLayout::PAGES_PER_RUN && (num_pages & (num_pages - 1)) == 0,
+                "an extent is a power of two pages, no more than a run");
+  Tablespace *tablespace = FindTablespace(tablespace_id);
+  if (tablespace == nullptr) {
+    throw Exception(ExceptionType::OUT_OF_RANGE, "no tablespace " + std::to_string(tablespace_id));
+  }
+  page_id_t first = tablespace->AllocateExtent(num_pages);
+  if (first + static_cast<page_id_t>(num_pages) > MAX_PAGES_PER_TABLESPACE) {
+    throw Exception(ExceptionType::OUT_OF_RANGE, "tablespace " + std::to_string(tablespace_id) + " is full");
+  }
+  return MakePageId(tablespace_id, first);
+}
 
 /**
  * Deallocate page (operations like drop index/table)
- * Need bitmap in header page for tracking pages
- * This does not actually need to do anything for now.
+ * The free space map persists the page as free with the next page write or at shut down.
  */
-void DiskManager::DeallocatePage(__attribute__((unused)) page_id_t page_id) {}
+void DiskManager::DeallocatePage(page_id_t page_id) {
+  Tablespace *tablespace = page_id < 0 ? nullptr : FindTablespace(GetTablespaceId(page_id));
+  if (tablespace == nullptr || !tablespace->DeallocatePage(GetLocalPageId(page_id))) {
+    LOG_DEBUG("deallocating page %d, which is not allocated", page_id);
+  }
+}
 
 /**
  * Returns number of flushes made so far
@@ -207,6 +483,77 @@ int DiskManager::GetNumFlushes() const { return num_flushes_; }
  */
 int DiskManager::GetNumWrites() const { return num_writes_; }
 
+page_id_t DiskManager::GetNumPages(tablespace_id_t tablespace_id) const {
+  Tablespace *tablespace = FindTablespace(tablespace_id);
+  return tablespace == nullptr ? 0 : tablespace->GetNumPages();
+}
+
+int DiskManager::GetNumChecksumFailures() const {
+  int failures = 0;
+  for (const auto &tablespace : tablespaces_) {
+    if (Tablespace *open = tablespace.load(); open != nullptr) {
+      failures += open->GetNumChecksumFailures();
+    }
+  }
+  return failures;
+}
+
+size_t DiskManager::GetNumFreePages() const {
+  size_t free_pages = 0;
+  for (const auto &tablespace : tablespaces_) {
+    if (Tablespace *open = tablespace.load(); open != nullptr) {
+      free_pages += open->GetNumFreePages();
+    }
+  }
+  return free_pages;
+}
+
+uint64_t DiskManager::GetNumBytesWritten() const {
+  uint64_t bytes = 0;
+  for (const auto &tablespace : tablespaces_) {
+    if (Tablespace *open = tablespace.load(); open != nullptr) {
+      bytes += open->GetNumBytesWritten();
+    }
+  }
+  return bytes;
+}
+
+uint64_t DiskManager::GetNumBytesRead() const {
+  uint64_t bytes = 0;
+  for (const auto &tablespace : tablespaces_) {
+    if (Tablespace *open = tablespace.load(); open != nullptr) {
+      bytes += open->GetNumBytesRead();
+    }
+  }
+  return bytes;
+}
+
+bool DiskManager::StartPageTrace(const std::string &file_name) {
+  std::scoped_lock latch{page_trace_latch_};
+  if (page_trace_.load() != nullptr) {
+    return false;
+  }
+  auto trace = std::make_unique<PageTrace>(file_name);
+  if (!trace->IsOpen()) {
+    return false;
+  }
+  page_trace_.store(trace.get(), std::memory_order_release);
+  page_traces_.push_back(std::move(trace));
+  return true;
+}
+
+void DiskManager::StopPageTrace() {
+  std::scoped_lock latch{page_trace_latch_};
+  if (PageTrace *trace = page_trace_.exchange(nullptr); trace != nullptr) {
+    trace->Close();
+  }
+}
+
+bool DiskManager::UsesDirectIo() const {
+  Tablespace *tablespace = FindTablespace(DEFAULT_TABLESPACE);
+  return tablespace != nullptr && tablespace->UsesDirectIo();
+}
+
 /**
  * Returns true if the log is currently being flushed
  */
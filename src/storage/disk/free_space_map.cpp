@@ -0,0 +1,134 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// free_space_map.cpp
+//
+// Identification: src/storage/disk/free_space_map.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/disk/free_space_map.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace bustub {
+
+FreeSpaceMap::FreeSpaceMap(page_id_t num_pages) : next_page_id_(num_pages) {}
+
+size_t FreeSpaceMap::NumMapPages() const { return FileLayout::NumRuns(next_page_id_.load()); }
+
+void FreeSpaceMap::Cover(size_t word) {
+  if (word >= free_bits_.size()) {
+    size_t map_pages = word / WORDS_PER_MAP_PAGE + 1;
+    free_bits_.resize(map_pages * WORDS_PER_MAP_PAGE, 0);
+    dirty_.resize(map_pages, false);
+  }
+}
+
+void FreeSpaceMap::LoadMapPage(size_t map_page, const char *data) {
+  std::scoped_lock latch{latch_};
+  size_t first_word = map_page * WORDS_PER_MAP_PAGE;
+  Cover(first_word);
+  memcpy(&free_bits_[first_word], data, PAGE_SIZE);
+
+  // bits past the pages that exist are left over from a file that was cut short
+  auto num_pages = static_cast<size_t>(next_page_id_.load());
+  size_t size = 0;
+  for (size_t i = 0; i < WORDS_PER_MAP_PAGE; ++i) {
+    size_t first_page = (first_word + i) * 64;
+    uint64_t &word = free_bits_[first_word + i];
+    if (first_page >= num_pages) {
+      word = 0;
+    } else if (num_pages - first_page < 64) {
+      word &= (uint64_t{1} << (num_pages - first_page)) - 1;
+    }
+    size += __builtin_popcountll(word);
+  }
+  num_free_ += size;
+  scan_from_ = 0;
+}
+
+page_id_t FreeSpaceMap::Allocate() {
+  if (num_free_.load(std::memory_order_relaxed) > 0) {
+    std::scoped_lock latch{latch_};
+    for (size_t i = scan_from_; i < free_bits_.size(); ++i) {
+      if (free_bits_[i] != 0) {
+        auto bit = static_cast<size_t>(__builtin_ctzll(free_bits_[i]));
+        free_bits_[i] &= free_bits_[i] - 1;
+        dirty_[i / WORDS_PER_MAP_PAGE] = true;
+        --num_free_;
+        ++version_;
+        scan_from_ = i;
+        return static_cast<page_id_t>(i * 64 + bit);
+      }
+    }
+    scan_from_ = free_bits_.size();
+  }
+  return next_page_id_++;
+}
+
+page_id_t FreeSpaceMap::AllocateExtent(size_t num_pages) {
+  auto size = static_cast<page_id_t>(num_pages);
+  page_id_t skipped_from = next_page_id_.load();
+  page_id_t first;
+  do {
+    first = (skipped_from + size - 1) / size * size;
+  } while (!next_page_id_.compare_exchange_weak(skipped_from, first + size));
+  for (page_id_t page_id = skipped_from; page_id < first; ++page_id) {
+    Deallocate(page_id);
+  }
+  return first;
+}
+
+bool FreeSpaceMap::Deallocate(page_id_t page_id) {
+  if (page_id < 0 || page_id >= next_page_id_.load()) {
+    return false;
+  }
+  auto word = static_cast<size_t>(page_id) / 64;
+  uint64_t mask = uint64_t{1} << (static_cast<size_t>(page_id) % 64);
+  std::scoped_lock latch{latch_};
+  Cover(word);
+  if ((free_bits_[word] & mask) != 0) {
+    return false;
+  }
+  free_bits_[word] |= mask;
+  dirty_[word / WORDS_PER_MAP_PAGE] = true;
+  ++num_free_;
+  ++version_;
+  scan_from_ = std::min(scan_from_, word);
+  return true;
+}
+
+uint64_t FreeSpaceMap::CollectDirty(std::vector<size_t> *map_pages, std::vector<char> *data) {
+  std::scoped_lock latch{latch_};
+  map_pages->clear();
+  data->clear();
+  for (size_t i = 0; i < dirty_.size(); ++i) {
+    if (dirty_[i]) {
+      dirty_[i] = false;
+      map_pages->push_back(i);
+      const auto *bits = reinterpret_cast<const char *>(&free_bits_[i * WORDS_PER_MAP_PAGE]);
+      data->insert(data->end(), bits, bits + PAGE_SIZE);
+    }
+  }
+  return version_.load();
+}
+
+void FreeSpaceMap::MarkFlushed(uint64_t version) {
+  uint64_t flushed = flushed_version_.load();
+  while (flushed < version && !flushed_version_.compare_exchange_weak(flushed, version)) {
+  }
+}
+
+void FreeSpaceMap::MarkDirty(const std::vector<size_t> &map_pages) {
+  std::scoped_lock latch{latch_};
+  for (size_t map_page : map_pages) {
+    dirty_[map_page] = true;
+  }
+}
+
+}  // namespace bustub
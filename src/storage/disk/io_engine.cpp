@@ -0,0 +1,371 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// io_engine.cpp
+//
+// Identification: src/storage/disk/io_engine.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/disk/io_engine.h"
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+#include "common/exception.h"
+#include "common/logger.h"
+
+#if defined(__linux__) && __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#include <sys/syscall.h>
+#define BUSTUB_HAS_IO_URING 1
+#endif
+
+namespace bustub {
+
+std::unique_ptr<IoEngine> IoEngine::Create(IoEngineType type, size_t queue_depth) {
+  queue_depth = std::max<size_t>(queue_depth, 1);
+  switch (type) {
+    case IoEngineType::SYNC:
+      return std::make_unique<SyncIoEngine>();
+    case IoEngineType::IO_URING: {
+      auto engine = std::make_unique<IoUringIoEngine>(queue_depth);
+      if (engine->IsAvailable()) {
+        return engine;
+      }
+      LOG_INFO("io_uring is not available, falling back to a thread pool");
+      return std::make_unique<ThreadPoolIoEngine>(queue_depth);
+    }
+    case IoEngineType::THREAD_POOL:
+      return std::make_unique<ThreadPoolIoEngine>(queue_depth);
+  }
+  UNREACHABLE("unknown I/O engine type");
+}
+
+void IoEngine::Complete(Batch *batch, bool ok) {
+  if (!ok) {
+    batch->ok_ = false;
+  }
+  if (batch->remaining_.fetch_sub(1) == 1) {
+    batch->done_.set_value(batch->ok_);
+  }
+}
+
+bool IoEngine::PerformSync(const IoRequest &request, size_t done) {
+  // a request with a single buffer is a vectored one with a single iovec
+  std::vector<iovec> iovecs = request.iovecs_;
+  if (iovecs.empty()) {
+    iovecs.push_back({request.data_, request.length_});
+  }
+  while (done < request.length_) {
+    // skip what has been transferred already
+    auto first = iovecs.begin();
+    size_t skip = done;
+    for (; skip >= first->iov_len; ++first) {
+      skip -= first->iov_len;
+    }
+    iovec head = *first;
+    first->iov_base = static_cast<char *>(first->iov_base) + skip;
+    first->iov_len -= skip;
+    off_t offset = request.offset_ + static_cast<off_t>(done);
+    auto count_iovecs = static_cast<int>(iovecs.end() - first);
+    ssize_t count = request.is_write_ ? pwritev(request.fd_, &*first, count_iovecs, offset)
+                                      : preadv(request.fd_, &*first, count_iovecs, offset);
+    if (count == 0 && !request.is_write_) {
+      // end of file: the rest has never been written
+      for (auto rest = first; rest != iovecs.end(); ++rest) {
+        memset(rest->iov_base, 0, rest->iov_len);
+      }
+      return true;
+    }
+    *first = head;
+    if (count < 0) {
+      if (errno == EINTR || errno == EAGAIN) {
+        continue;
+      }
+      LOG_DEBUG("I/O error: %s", strerror(errno));
+      return false;
+    }
+    done += count;
+  }
+  return true;
+}
+
+std::future<bool> SyncIoEngine::Submit(const std::vector<IoRequest> &requests) {
+  std::promise<bool> done;
+  bool ok = true;
+  for (const IoRequest &request : requests) {
+    ok = PerformSync(request) && ok;
+  }
+  done.set_value(ok);
+  return done.get_future();
+}
+
+/*****************************************************************************
+ * THREAD POOL
+ *****************************************************************************/
+
+ThreadPoolIoEngine::ThreadPoolIoEngine(size_t num_threads) {
+  workers_.reserve(num_threads);
+  for (size_t i = 0; i < num_threads; ++i) {
+    workers_.emplace_back(&ThreadPoolIoEngine::Work, this);
+  }
+}
+
+ThreadPoolIoEngine::~ThreadPoolIoEngine() {
+  {
+    std::scoped_lock latch{latch_};
+    running_ = false;
+  }
+  cv_.notify_all();
+  for (auto &worker : workers_) {
+    worker.join();
+  }
+}
+
+std::future<bool> ThreadPoolIoEngine::Submit(const std::vector<IoRequest> &requests) {
+  auto batch = std::make_shared<Batch>(requests.size());
+  auto future = batch->done_.get_future();
+  if (requests.empty()) {
+    batch->done_.set_value(true);
+    return future;
+  }
+  {
+    std::scoped_lock latch{latch_};
+    for (const IoRequest &request : requests) {
+      queue_.emplace_back(request, batch);
+    }
+  }
+  if (requests.size() == 1) {
+    cv_.notify_one();
+  } else {
+    cv_.notify_all();
+  }
+  return future;
+}
+
+void ThreadPoolIoEngine::Work() {
+  std::unique_lock latch{latch_};
+  while (true) {
+    cv_.wait(latch, [this] { return !queue_.empty() || !running_; });
+    // the queue is drained before stopping, so that no batch is left incomplete
+    if (queue_.empty()) {
+      return;
+    }
+    auto [request, batch] = std::move(queue_.front());
+    queue_.pop_front();
+    latch.unlock();
+    Complete(batch.get(), PerformSync(request));
+    latch.lock();
+  }
+}
+
+/*****************************************************************************
+ * IO_URING
+ *****************************************************************************/
+
+#ifdef BUSTUB_HAS_IO_URING
+
+IoUringIoEngine::IoUringIoEngine(size_t queue_depth) {
+  io_uring_params params;
+  memset(&params, 0, sizeof(params));
+  int ring_fd = static_cast<int>(syscall(__NR_io_uring_setup, static_cast<unsigned>(queue_depth), &params));
+  if (ring_fd < 0) {
+    return;
+  }
+
+  sq_entries_ = params.sq_entries;
+  sq_ring_size_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+  cq_ring_size_ = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+  bool single_mmap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+  if (single_mmap) {
+    sq_ring_size_ = cq_ring_size_ = std::max(sq_ring_size_, cq_ring_size_);
+  }
+  sq_ring_ =
+      mmap(nullptr, sq_ring_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd, IORING_OFF_SQ_RING);
+  if (sq_ring_ == MAP_FAILED) {
+    sq_ring_ = nullptr;
+    close(ring_fd);
+    return;
+  }
+  if (single_mmap) {
+    cq_ring_ = sq_ring_;
+  } else {
+    cq_ring_ =
+        mmap(nullptr, cq_ring_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd, IORING_OFF_CQ_RING);
+  }
+  sqes_size_ = params.sq_entries * sizeof(io_uring_sqe);
+  sqes_ = mmap(nullptr, sqes_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd, IORING_OFF_SQES);
+  if (cq_ring_ == MAP_FAILED || sqes_ == MAP_FAILED) {
+    munmap(sq_ring_, sq_ring_size_);
+    if (!single_mmap && cq_ring_ != MAP_FAILED) {
+      munmap(cq_ring_, cq_ring_size_);
+    }
+    if (sqes_ != MAP_FAILED) {
+      munmap(sqes_, sqes_size_);
+    }
+    sq_ring_ = cq_ring_ = sqes_ = nullptr;
+    close(ring_fd);
+    return;
+  }
+
+  auto *sq = static_cast<char *>(sq_ring_);
+  sq_tail_ = reinterpret_cast<unsigned *>(sq + params.sq_off.tail);
+  sq_mask_ = reinterpret_cast<unsigned *>(sq + params.sq_off.ring_mask);
+  sq_array_ = reinterpret_cast<unsigned *>(sq + params.sq_off.array);
+  auto *cq = static_cast<char *>(cq_ring_);
+  cq_head_ = reinterpret_cast<unsigned *>(cq + params.cq_off.head);
+  cq_tail_ = reinterpret_cast<unsigned *>(cq + params.cq_off.tail);
+  cq_mask_ = reinterpret_cast<unsigned *>(cq + params.cq_off.ring_mask);
+  cqes_ = cq + params.cq_off.cqes;
+
+  ring_fd_ = ring_fd;
+  reaper_ = std::make_unique<std::thread>(&IoUringIoEngine::Reap, this);
+}
+
+IoUringIoEngine::~IoUringIoEngine() {
+  if (!IsAvailable()) {
+    return;
+  }
+  {
+    // completions are not ordered, so the stop signal may only go out once nothing else is in flight
+    std::unique_lock latch{latch_};
+    completed_cv_.wait(latch, [this] { return in_flight_ == 0; });
+    PushEntry(nullptr);
+    Enter(1);
+  }
+  reaper_->join();
+  munmap(sqes_, sqes_size_);
+  if (cq_ring_ != sq_ring_) {
+    munmap(cq_ring_, cq_ring_size_);
+  }
+  munmap(sq_ring_, sq_ring_size_);
+  close(ring_fd_);
+}
+
+std::future<bool> IoUringIoEngine::Submit(const std::vector<IoRequest> &requests) {
+  auto batch = std::make_shared<Batch>(requests.size());
+  auto future = batch->done_.get_future();
+  if (requests.empty()) {
+    batch->done_.set_value(true);
+    return future;
+  }
+
+  std::unique_lock latch{latch_};
+  unsigned queued = 0;
+  for (const IoRequest &request : requests) {
+    if (in_flight_ == sq_entries_) {
+      // the ring is full: hand over what is queued, then wait for the reaper to make room
+      Enter(queued);
+      queued = 0;
+      completed_cv_.wait(latch, [this] { return in_flight_ < sq_entries_; });
+    }
+    PushEntry(new Operation{request, batch});
+    ++in_flight_;
+    ++queued;
+  }
+  Enter(queued);
+  return future;
+}
+
+void IoUringIoEngine::PushEntry(Operation *op) {
+  // only submitters, serialized by latch_, move the tail; the kernel only reads it
+  unsigned tail = *sq_tail_;
+  unsigned index = tail & *sq_mask_;
+  auto *sqe = static_cast<io_uring_sqe *>(sqes_) + index;
+  memset(sqe, 0, sizeof(*sqe));
+  if (op == nullptr) {
+    sqe->opcode = IORING_OP_NOP;
+  } else {
+    const IoRequest &request = op->request_;
+    sqe->fd = request.fd_;
+    sqe->off = static_cast<uint64_t>(request.offset_);
+    if (request.iovecs_.empty()) {
+      sqe->opcode = request.is_write_ ? IORING_OP_WRITE : IORING_OP_READ;
+      sqe->addr = reinterpret_cast<uint64_t>(request.data_);
+      sqe->len = static_cast<uint32_t>(request.length_);
+    } else {
+      // the iovecs live in the operation until it completes
+      sqe->opcode = request.is_write_ ? IORING_OP_WRITEV : IORING_OP_READV;
+      sqe->addr = reinterpret_cast<uint64_t>(request.iovecs_.data());
+      sqe->len = static_cast<uint32_t>(request.iovecs_.size());
+    }
+  }
+  sqe->user_data = reinterpret_cast<uint64_t>(op);
+  sq_array_[index] = index;
+  __atomic_store_n(sq_tail_, tail + 1, __ATOMIC_RELEASE);
+}
+
+void IoUringIoEngine::Enter(unsigned count) {
+  while (count > 0) {
+    int submitted = static_cast<int>(syscall(__NR_io_uring_enter, ring_fd_, count, 0, 0, nullptr, 0));
+    if (submitted < 0) {
+      if (errno == EINTR || errno == EAGAIN || errno == EBUSY) {
+        continue;
+      }
+      throw Exception(std::string("io_uring_enter failed: ") + strerror(errno));
+    }
+    count -= submitted;
+  }
+}
+
+void IoUringIoEngine::Reap() {
+  while (true) {
+    // the reaper is the only consumer, so it alone moves the head
+    unsigned head = *cq_head_;
+    if (head == __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE)) {
+      syscall(__NR_io_uring_enter, ring_fd_, 0, 1, IORING_ENTER_GETEVENTS, nullptr, 0);
+      continue;
+    }
+    auto *cqe = static_cast<io_uring_cqe *>(cqes_) + (head & *cq_mask_);
+    auto *op = reinterpret_cast<Operation *>(cqe->user_data);
+    int result = cqe->res;
+    __atomic_store_n(cq_head_, head + 1, __ATOMIC_RELEASE);
+    if (op == nullptr) {
+      return;
+    }
+
+    bool ok;
+    if (result < 0) {
+      // transient failures are retried synchronously, anything else is reported
+      ok = (result == -EAGAIN || result == -EINTR) && PerformSync(op->request_);
+    } else {
+      // a short transfer is the end of the file for reads, and has to be resumed for writes
+      ok = PerformSync(op->request_, static_cast<size_t>(result));
+    }
+    Complete(op->batch_.get(), ok);
+    delete op;
+    {
+      std::scoped_lock latch{latch_};
+      --in_flight_;
+    }
+    completed_cv_.notify_all();
+  }
+}
+
+#else
+
+IoUringIoEngine::IoUringIoEngine(size_t queue_depth) {}
+
+IoUringIoEngine::~IoUringIoEngine() = default;
+
+std::future<bool> IoUringIoEngine::Submit(const std::vector<IoRequest> &requests) {
+  UNREACHABLE("io_uring is not available on this platform");
+}
+
+void IoUringIoEngine::PushEntry(Operation *op) {}
+
+void IoUringIoEngine::Enter(unsigned count) {}
+
+void IoUringIoEngine::Reap() {}
+
+#endif
+
+}  // namespace bustub
@@ -0,0 +1,55 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// object_store.cpp
+//
+// Identification: src/storage/disk/object_store.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/disk/object_store.h"
+
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+
+namespace bustub {
+
+bool DirectoryObjectStore::Put(const std::string &key, const char *data, size_t size) {
+  std::string path = PathOf(key);
+  std::string temp_path = path + ".part";
+  {
+    std::ofstream out(temp_path, std::ios::binary | std::ios::trunc);
+    out.write(data, static_cast<std::streamsize>(size));
+    if (!out.good()) {
+      std::remove(temp_path.c_str());
+      return false;
+    }
+  }
+  if (std::rename(temp_path.c_str(), path.c_str()) != 0) {
+    std::remove(temp_path.c_str());
+    return false;
+  }
+  num_puts_++;
+  return true;
+}
+
+bool DirectoryObjectStore::Get(const std::string &key, std::vector<char> *data) {
+  std::ifstream in(PathOf(key), std::ios::binary);
+  if (!in.is_open()) {
+    return false;
+  }
+  data->assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+  if (in.bad()) {
+    return false;
+  }
+  num_gets_++;
+  return true;
+}
+
+bool DirectoryObjectStore::Delete(const std::string &key) { return std::remove(PathOf(key).c_str()) == 0; }
+
+}  // namespace bustub
@@ -0,0 +1,25 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// page_checksums.cpp
+//
+// Identification: src/storage/disk/page_checksums.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/disk/page_checksums.h"
+
+#include "common/util/crc32c.h"
+
+namespace bustub {
+
+uint32_t PageChecksums::Compute(const char *page_data) {
+  uint32_t checksum = Crc32c::Compute(page_data, PAGE_SIZE);
+  // 0 is taken to mean "unknown"
+  return checksum != 0 ? checksum : 1;
+}
+
+}  // namespace bustub
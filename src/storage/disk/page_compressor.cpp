@@ -0,0 +1,176 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// page_compressor.cpp
+//
+// Identification: src/storage/disk/page_compressor.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/disk/page_compressor.h"
+
+#include <array>
+#include <cstdint>
+#include <cstring>
+
+namespace bustub {
+
+namespace {
+
+constexpr size_t MIN_MATCH = 4;
+constexpr size_t MAX_OFFSET = 65535;
+constexpr size_t HASH_BITS = 12;
+
+uint32_t Read32(const char *p) {
+  uint32_t value;
+  memcpy(&value, p, sizeof(value));
+  return value;
+}
+
+size_t Hash(uint32_t value) { return (value * 2654435761U) >> (32 - HASH_BITS); }
+
+/** Appends a nibble overflow, a run of 255s and a final byte. @return false if dst is full */
+bool WriteLength(size_t length, char *dst, size_t capacity, size_t *out) {
+  for (; length >= 255; length -= 255) {
+    if (*out == capacity) {
+      return false;
+    }
+    dst[(*out)++] = static_cast<char>(255);
+  }
+  if (*out == capacity) {
+    return false;
+  }
+  dst[(*out)++] = static_cast<char>(length);
+  return true;
+}
+
+/** Appends one (literals, match) pair; a match length of 0 marks the last pair, which has literals only. */
+bool WriteSequence(const char *literals, size_t num_literals, size_t offset, size_t match_length, char *dst,
+                   size_t capacity, size_t *out) {
+  if (*out == capacity) {
+    return false;
+  }
+  size_t token = *out;
+  ++*out;
+  uint8_t literal_nibble = num_literals < 15 ? num_literals : 15;
+  if (num_literals >= 15 && !WriteLength(num_literals - 15, dst, capacity, out)) {
+    return false;
+  }
+  if (capacity - *out < num_literals) {
+    return false;
+  }
+  memcpy(dst + *out, literals, num_literals);
+  *out += num_literals;
+
+  uint8_t match_nibble = 0;
+  if (match_length != 0) {
+    if (capacity - *out < 2) {
+      return false;
+    }
+    dst[(*out)++] = static_cast<char>(offset & 0xFF);
+    dst[(*out)++] = static_cast<char>(offset >> 8);
+    size_t extra = match_length - MIN_MATCH;
+    match_nibble = extra < 15 ? extra : 15;
+    if (extra >= 15 && !WriteLength(extra - 15, dst, capacity, out)) {
+      return false;
+    }
+  }
+  dst[token] = static_cast<char>((literal_nibble << 4) | match_nibble);
+  return true;
+}
+
+/** Reads a nibble overflow. @return false if src ends first */
+bool ReadLength(const uint8_t *src, size_t size, size_t *in, size_t *length) {
+  uint8_t byte;
+  do {
+    if (*in == size) {
+      return false;
+    }
+    byte = src[(*in)++];
+    *length += byte;
+  } while (byte == 255);
+  return true;
+}
+
+}  // namespace
+
+size_t PageCompressor::Compress(const char *src, size_t src_size, char *dst, size_t dst_capacity) {
+  std::array<int32_t, size_t{1} << HASH_BITS> table;
+  table.fill(-1);
+  size_t out = 0;
+  size_t anchor = 0;
+  size_t pos = 0;
+  while (pos + MIN_MATCH <= src_size) {
+    uint32_t value = Read32(src + pos);
+    size_t slot = Hash(value);
+    int32_t candidate = table[slot];
+    table[slot] = static_cast<int32_t>(pos);
+    if (candidate < 0 || pos - candidate > MAX_OFFSET || Read32(src + candidate) != value) {
+      ++pos;
+      continue;
+    }
+    size_t match_length = MIN_MATCH;
+    while (pos + match_length < src_size && src[candidate + match_length] == src[pos + match_length]) {
+      ++match_length;
+    }
+    if (!WriteSequence(src + anchor, pos - anchor, pos - candidate, match_length, dst, dst_capacity, &out)) {
+      return 0;
+    }
+    pos += match_length;
+    anchor = pos;
+  }
+  if (!WriteSequence(src + anchor, src_size - anchor, 0, 0, dst, dst_capacity, &out)) {
+    return 0;
+  }
+  return out;
+}
+
+bool PageCompressor::Decompress(const char *src, size_t src_size, char *dst, size_t dst_size) {
+  const auto *in_bytes = reinterpret_cast<const uint8_t *>(src);
+  size_t in = 0;
+  size_t out = 0;
+  while (in < src_size) {
+    uint8_t token = in_bytes[in++];
+    size_t num_literals = token >> 4;
+    if (num_literals == 15 && !ReadLength(in_bytes, src_size, &in, &num_literals)) {
+      return false;
+    }
+    if (src_size - in < num_literals || dst_size - out < num_literals) {
+      return false;
+    }
+    memcpy(dst + out, src + in, num_literals);
+    in += num_literals;
+    out += num_literals;
+    if (in == src_size) {
+      break;
+    }
+
+    if (src_size - in < 2) {
+      return false;
+    }
+    size_t offset = in_bytes[in] | (static_cast<size_t>(in_bytes[in + 1]) << 8);
+    in += 2;
+    size_t match_length = token & 0xF;
+    if (match_length == 15 && !ReadLength(in_bytes, src_size, &in, &match_length)) {
+      return false;
+    }
+    match_length += MIN_MATCH;
+    if (offset == 0 || offset > out || dst_size - out < match_length) {
+      return false;
+    }
+    // byte by byte, since the match may overlap the bytes it produces
+    for (size_t i = 0; i < match_length; ++i, ++out) {
+      dst[out] = dst[out - offset];
+    }
+    // the last pair has literals only, so a block never ends with a match
+    if (in == src_size) {
+      return false;
+    }
+  }
+  return out == dst_size;
+}
+
+}  // namespace bustub
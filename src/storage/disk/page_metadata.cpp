@@ -0,0 +1,90 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// page_metadata.cpp
+//
+// Identification: src/storage/disk/page_metadata.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/disk/page_metadata.h"
+
+#include <cstring>
+
+namespace bustub {
+
+template <typename T>
+void PageMetadata<T>::Cover(size_t metadata_page) {
+  if (dirty_.size() <= metadata_page) {
+    entries_.resize((metadata_page + 1) * ENTRIES_PER_PAGE, 0);
+    dirty_.resize(metadata_page + 1, false);
+  }
+}
+
+template <typename T>
+void PageMetadata<T>::LoadMetadataPage(size_t metadata_page, const char *data) {
+  std::scoped_lock latch{latch_};
+  Cover(metadata_page);
+  memcpy(&entries_[metadata_page * ENTRIES_PER_PAGE], data, PAGE_SIZE);
+}
+
+template <typename T>
+T PageMetadata<T>::Get(page_id_t page_id) {
+  auto index = static_cast<size_t>(page_id);
+  std::scoped_lock latch{latch_};
+  return index < entries_.size() ? entries_[index] : 0;
+}
+
+template <typename T>
+T PageMetadata<T>::Set(page_id_t page_id, T value) {
+  auto index = static_cast<size_t>(page_id);
+  size_t metadata_page = index / ENTRIES_PER_PAGE;
+  std::scoped_lock latch{latch_};
+  Cover(metadata_page);
+  T old_value = entries_[index];
+  if (old_value != value) {
+    entries_[index] = value;
+    dirty_[metadata_page] = true;
+    ++version_;
+  }
+  return old_value;
+}
+
+template <typename T>
+uint64_t PageMetadata<T>::CollectDirty(std::vector<size_t> *metadata_pages, std::vector<char> *data) {
+  std::scoped_lock latch{latch_};
+  metadata_pages->clear();
+  data->clear();
+  for (size_t i = 0; i < dirty_.size(); ++i) {
+    if (dirty_[i]) {
+      dirty_[i] = false;
+      metadata_pages->push_back(i);
+      const auto *bytes = reinterpret_cast<const char *>(&entries_[i * ENTRIES_PER_PAGE]);
+      data->insert(data->end(), bytes, bytes + PAGE_SIZE);
+    }
+  }
+  return version_.load();
+}
+
+template <typename T>
+void PageMetadata<T>::MarkFlushed(uint64_t version) {
+  uint64_t flushed = flushed_version_.load();
+  while (flushed < version && !flushed_version_.compare_exchange_weak(flushed, version)) {
+  }
+}
+
+template <typename T>
+void PageMetadata<T>::MarkDirty(const std::vector<size_t> &metadata_pages) {
+  std::scoped_lock latch{latch_};
+  for (size_t metadata_page : metadata_pages) {
+    dirty_[metadata_page] = true;
+  }
+}
+
+template class PageMetadata<uint8_t>;
+template class PageMetadata<uint32_t>;
+
+}  // namespace bustub
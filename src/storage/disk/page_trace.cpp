@@ -0,0 +1,92 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// page_trace.cpp
+//
+// Identification: src/storage/disk/page_trace.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/disk/page_trace.h"
+
+#include <cstring>
+
+#include "common/logger.h"
+
+namespace bustub {
+
+PageTrace::PageTrace(const std::string &file_name)
+    : out_(file_name, std::ios::binary | std::ios::trunc), start_(std::chrono::steady_clock::now()) {
+  out_.write(MAGIC, sizeof(MAGIC));
+  buffer_.reserve(BUFFER_RECORDS);
+}
+
+bool PageTrace::IsOpen() {
+  std::scoped_lock latch{latch_};
+  return out_.is_open() && out_.good();
+}
+
+void PageTrace::Record(page_id_t page_id, PageAccessType type) {
+  auto timestamp = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start_);
+  std::scoped_lock latch{latch_};
+  if (!out_.is_open()) {
+    return;
+  }
+  buffer_.push_back({static_cast<uint64_t>(timestamp.count()), page_id, type});
+  num_records_++;
+  if (buffer_.size() >= BUFFER_RECORDS) {
+    FlushBuffer();
+  }
+}
+
+void PageTrace::Flush() {
+  std::scoped_lock latch{latch_};
+  FlushBuffer();
+  out_.flush();
+}
+
+void PageTrace::Close() {
+  std::scoped_lock latch{latch_};
+  if (!out_.is_open()) {
+    return;
+  }
+  FlushBuffer();
+  out_.close();
+}
+
+uint64_t PageTrace::GetNumRecords() {
+  std::scoped_lock latch{latch_};
+  return num_records_;
+}
+
+void PageTrace::FlushBuffer() {
+  if (buffer_.empty() || !out_.is_open()) {
+    return;
+  }
+  out_.write(reinterpret_cast<const char *>(buffer_.data()),
+             static_cast<std::streamsize>(buffer_.size() * sizeof(PageAccess)));
+  if (out_.bad()) {
+    LOG_DEBUG("I/O error while writing the page trace");
+  }
+  buffer_.clear();
+}
+
+bool PageTrace::Load(const std::string &file_name, std::vector<PageAccess> *accesses) {
+  std::ifstream in(file_name, std::ios::binary);
+  char magic[sizeof(MAGIC)];
+  if (!in.read(magic, sizeof(magic)) || std::memcmp(magic, MAGIC, sizeof(MAGIC)) != 0) {
+    return false;
+  }
+  accesses->clear();
+  PageAccess access;
+  while (in.read(reinterpret_cast<char *>(&access), sizeof(access))) {
+    accesses->push_back(access);
+  }
+  // a trace cut short by a crash ends in part of a record, which is dropped
+  return true;
+}
+
+}  // namespace bustub
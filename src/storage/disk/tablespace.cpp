@@ -0,0 +1,542 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// tablespace.cpp
+//
+// Identification: src/storage/disk/tablespace.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/disk/tablespace.h"
+
+#include <fcntl.h>
+#include <linux/falloc.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <string>
+#include <utility>
+
+#include "common/exception.h"
+#include "common/logger.h"
+#include "storage/disk/page_compressor.h"
+
+namespace bustub {
+
+/** The alignment O_DIRECT needs for buffers, offsets and lengths; the logical block size of common devices. */
+static constexpr size_t DIRECT_IO_ALIGNMENT = 4096;
+
+/** The most buffers a vectored request gathers, i.e. 512KB of 4KB pages. */
+static constexpr size_t MAX_IOVECS = 128;
+
+/**
+ * Merges requests for adjacent ranges of the file into vectored requests, so that a scan over consecutive pages turns
+ * into a few large transfers.
+ * @param requests the requests of a batch, which do not overlap
+ * @return the merged requests, in the order of the file
+ */
+static std::vector<IoRequest> Coalesce(const std::vector<IoRequest> &requests) {
+  if (requests.size() < 2) {
+    return requests;
+  }
+  std::vector<size_t> order(requests.size());
+  for (size_t i = 0; i < order.size(); ++i) {
+    order[i] = i;
+  }
+  std::sort(order.begin(), order.end(),
+            [&requests](size_t a, size_t b) { return requests[a].offset_ < requests[b].offset_; });
+
+  std::vector<IoRequest> merged;
+  for (size_t i : order) {
+    const IoRequest &request = requests[i];
+    if (!merged.empty()) {
+      IoRequest &last = merged.back();
+      bool adjacent = last.is_write_ == request.is_write_ && last.fd_ == request.fd_ &&
+                      last.offset_ + static_cast<off_t>(last.length_) == request.offset_;
+      bool same_owner = last.buffer_owner_ == nullptr || request.buffer_owner_ == nullptr ||
+                        last.buffer_owner_ == request.buffer_owner_;
+      if (adjacent && same_owner && last.iovecs_.size() < MAX_IOVECS) {
+        if (last.iovecs_.empty()) {
+          last.iovecs_.push_back({last.data_, last.length_});
+        }
+        last.iovecs_.push_back({request.data_, request.length_});
+        last.length_ += request.length_;
+        if (last.buffer_owner_ == nullptr) {
+          last.buffer_owner_ = request.buffer_owner_;
+        }
+        continue;
+      }
+    }
+    merged.push_back(request);
+  }
+  return merged;
+}
+
+Tablespace::Tablespace(std::string file_name, IoEngineType io_engine, bool direct_io, bool compress_pages)
+    : file_name_(std::move(file_name)),
+      compress_pages_(compress_pages),
+      io_engine_(IoEngine::Create(io_engine, IO_QUEUE_DEPTH)) {
+  // create the file if it does not exist
+  if (direct_io) {
+    fd_ = open(file_name_.c_str(), O_RDWR | O_CREAT | O_DIRECT, 0644);
+    direct_io_ = fd_ >= 0;
+    if (fd_ < 0 && errno == EINVAL) {
+      // e.g. tmpfs does not support O_DIRECT
+      LOG_INFO("O_DIRECT is not supported for %s, using buffered I/O", file_name_.c_str());
+    }
+  }
+  if (fd_ < 0) {
+    fd_ = open(file_name_.c_str(), O_RDWR | O_CREAT, 0644);
+  }
+  if (fd_ < 0) {
+    throw Exception("can't open db file");
+  }
+  LoadHeaderPages();
+}
+
+Tablespace::~Tablespace() { Close(); }
+
+void Tablespace::Close() {
+  if (mapping_ != nullptr) {
+    munmap(mapping_, mapping_size_);
+    mapping_ = nullptr;
+  }
+  if (fd_ >= 0) {
+    FlushHeaderPages();
+    close(fd_);
+    fd_ = -1;
+  }
+}
+
+void Tablespace::LoadHeaderPages() {
+  struct stat stat_buf;
+  off_t file_size = fstat(fd_, &stat_buf) == 0 ? stat_buf.st_size : 0;
+  free_space_map_ = std::make_unique<FreeSpaceMap>(FileLayout::NumPagesInFile(file_size));
+
+  // all header pages of the runs in use, in one batch
+  size_t num_runs = free_space_map_->NumMapPages();
+  if (num_runs == 0) {
+    return;
+  }
+  size_t num_checksum_pages = num_runs * FileLayout::CHECKSUM_PAGES_PER_RUN;
+  size_t num_size_pages = num_runs * FileLayout::STORED_SIZE_PAGES_PER_RUN;
+  size_t num_tier_pages = num_runs * FileLayout::TIER_PAGES_PER_RUN;
+  std::vector<off_t> offsets;
+  for (size_t i = 0; i < num_runs; ++i) {
+    offsets.push_back(FileLayout::MapPageOffset(i));
+  }
+  for (size_t i = 0; i < num_checksum_pages; ++i) {
+    offsets.push_back(FileLayout::ChecksumPageOffset(i));
+  }
+  for (size_t i = 0; i < num_size_pages; ++i) {
+    offsets.push_back(FileLayout::StoredSizePageOffset(i));
+  }
+  for (size_t i = 0; i < num_tier_pages; ++i) {
+    offsets.push_back(FileLayout::TierPageOffset(i));
+  }
+  std::vector<char> data(offsets.size() * PAGE_SIZE);
+  std::vector<IoRequest> reads;
+  for (size_t i = 0; i < offsets.size(); ++i) {
+    reads.push_back({false, fd_, offsets[i], &data[i * PAGE_SIZE], static_cast<size_t>(PAGE_SIZE)});
+  }
+  if (!SubmitPages(reads).get()) {
+    LOG_DEBUG("I/O error while reading the header pages");
+    return;
+  }
+
+  const char *next = data.data();
+  for (size_t i = 0; i < num_runs; ++i, next += PAGE_SIZE) {
+    free_space_map_->LoadMapPage(i, next);
+  }
+  for (size_t i = 0; i < num_checksum_pages; ++i, next += PAGE_SIZE) {
+    page_checksums_.LoadMetadataPage(i, next);
+  }
+  for (size_t i = 0; i < num_size_pages; ++i, next += PAGE_SIZE) {
+    stored_sizes_.LoadMetadataPage(i, next);
+  }
+  for (size_t i = 0; i < num_tier_pages; ++i, next += PAGE_SIZE) {
+    tiers_.LoadMetadataPage(i, next);
+  }
+}
+
+void Tablespace::FlushHeaderPages() {
+  if (!free_space_map_->IsDirty() && !page_checksums_.IsDirty() && !stored_sizes_.IsDirty() && !tiers_.IsDirty()) {
+    return;
+  }
+  // whoever flushes while we wait takes our changes along
+  std::scoped_lock latch{header_pages_latch_};
+  std::vector<size_t> map_pages;
+  std::vector<char> map_data;
+  uint64_t map_version = free_space_map_->CollectDirty(&map_pages, &map_data);
+  std::vector<size_t> checksum_pages;
+  std::vector<char> checksum_data;
+  uint64_t checksum_version = page_checksums_.CollectDirty(&checksum_pages, &checksum_data);
+  std::vector<size_t> size_pages;
+  std::vector<char> size_data;
+  uint64_t size_version = stored_sizes_.CollectDirty(&size_pages, &size_data);
+  std::vector<size_t> tier_pages;
+  std::vector<char> tier_data;
+  uint64_t tier_version = tiers_.CollectDirty(&tier_pages, &tier_data);
+
+  std::vector<IoRequest> writes;
+  auto add_writes = [&](const std::vector<size_t> &header_pages, std::vector<char> *data, off_t (*offset)(size_t)) {
+    for (size_t i = 0; i < header_pages.size(); ++i) {
+      writes.push_back(
+          {true, fd_, offset(header_pages[i]), &(*data)[i * PAGE_SIZE], static_cast<size_t>(PAGE_SIZE)});
+    }
+  };
+  add_writes(map_pages, &map_data, &FileLayout::MapPageOffset);
+  add_writes(checksum_pages, &checksum_data, &FileLayout::ChecksumPageOffset);
+  add_writes(size_pages, &size_data, &FileLayout::StoredSizePageOffset);
+  add_writes(tier_pages, &tier_data, &FileLayout::TierPageOffset);
+  if (!writes.empty() && !SubmitPages(writes).get()) {
+    LOG_DEBUG("I/O error while writing the header pages");
+    free_space_map_->MarkDirty(map_pages);
+    page_checksums_.MarkDirty(checksum_pages);
+    stored_sizes_.MarkDirty(size_pages);
+    tiers_.MarkDirty(tier_pages);
+    return;
+  }
+  free_space_map_->MarkFlushed(map_version);
+  page_checksums_.MarkFlushed(checksum_version);
+  stored_sizes_.MarkFlushed(size_version);
+  tiers_.MarkFlushed(tier_version);
+}
+
+std::future<bool> Tablespace::WritePagesAsync(const std::vector<std::pair<page_id_t, const char *>> &pages) {
+  if (tiered_ != nullptr) {
+    // the pages written to are hot again, so the extents of those that are out come back into the file first
+    while (true) {
+      tier_latch_.RLock();
+      std::vector<size_t> extents;
+      for (const auto &page : pages) {
+        if (tiers_.Get(page.first) != 0) {
+          extents.push_back(page.first / TieredStorage::EXTENT_PAGES);
+        }
+      }
+      if (extents.empty()) {
+        break;
+      }
+      tier_latch_.RUnlock();
+      tier_latch_.WLock();
+      bool recalled = RecallExtents(extents);
+      tier_latch_.WUnlock();
+      if (!recalled) {
+        std::promise<bool> failed;
+        failed.set_value(false);
+        return failed.get_future();
+      }
+    }
+  }
+
+  // the compressed images of the pages, kept alive by the requests until they have completed
+  std::shared_ptr<char> images;
+  if (compress_pages_ && !pages.empty()) {
+    images.reset(static_cast<char *>(std::aligned_alloc(PAGE_SIZE, pages.size() * PAGE_SIZE)), &std::free);
+    if (images == nullptr) {
+      throw Exception(ExceptionType::OUT_OF_MEMORY, "cannot allocate compressed page images");
+    }
+  }
+
+  std::vector<IoRequest> writes;
+  writes.reserve(pages.size());
+  for (const auto &[page_id, page_data] : pages) {
+    off_t offset = FileLayout::PageOffset(page_id);
+    bool written_before = page_checksums_.Set(page_id, PageChecksums::Compute(page_data)) != 0;
+    char *image = images == nullptr ? nullptr : images.get() + writes.size() * PAGE_SIZE;
+    size_t stored = image == nullptr ? PAGE_SIZE : CompressPage(page_data, image);
+    if (stored == PAGE_SIZE) {
+      stored_sizes_.Set(page_id, 0);
+      // the engine only reads from the buffer of a write
+      writes.push_back({true, fd_, offset, const_cast<char *>(page_data), static_cast<size_t>(PAGE_SIZE)});
+      continue;
+    }
+
+    auto sectors = static_cast<uint8_t>(stored / FileLayout::SECTOR_SIZE);
+    uint8_t old_sectors = stored_sizes_.Set(page_id, sectors);
+    writes.push_back({true, fd_, offset, image, stored, images});
+    if (written_before && (old_sectors == 0 || old_sectors > sectors)) {
+      // give the sectors the page no longer needs back to the file system; this is what shrinks the file
+      fallocate(fd_, FALLOC_FL_PUNCH_HOLE | FALLOC_FL_KEEP_SIZE, offset + static_cast<off_t>(stored),
+                static_cast<off_t>(PAGE_SIZE - stored));
+    }
+  }
+  // a page that is torn on its way to disk then does not match the checksum already there
+  FlushHeaderPages();
+  for (const IoRequest &write : writes) {
+    num_bytes_written_ += write.length_;
+  }
+  return ReleaseTierLatchAfter(SubmitPages(writes));
+}
+
+std::future<bool> Tablespace::ReadPagesAsync(const std::vector<std::pair<page_id_t, char *>> &pages) {
+  if (tiered_ != nullptr) {
+    tier_latch_.RLock();
+  }
+  std::vector<IoRequest> reads;
+  reads.reserve(pages.size());
+  // per page, the size of its compressed image, 0 if it is not compressed
+  std::vector<size_t> stored(pages.size(), 0);
+  // by extent, the pages that are out in the object store, with their index in the extent
+  std::map<size_t, std::vector<std::pair<size_t, char *>>> offloaded;
+  for (size_t i = 0; i < pages.size(); ++i) {
+    stored[i] = stored_sizes_.Get(pages[i].first) * FileLayout::SECTOR_SIZE;
+    if (tiers_.Get(pages[i].first) != 0) {
+      auto index = static_cast<size_t>(pages[i].first);
+      offloaded[index / TieredStorage::EXTENT_PAGES].emplace_back(index % TieredStorage::EXTENT_PAGES,
+                                                                  pages[i].second);
+      continue;
+    }
+    size_t length = stored[i] != 0 ? stored[i] : PAGE_SIZE;
+    reads.push_back({false, fd_, FileLayout::PageOffset(pages[i].first), pages[i].second, length});
+    num_bytes_read_ += length;
+  }
+  std::future<bool> done = SubmitPages(reads);
+  if (!offloaded.empty()) {
+    if (tiered_ == nullptr) {
+      LOG_WARN("pages of %s are in an object store, but tiering is not enabled", file_name_.c_str());
+      done = std::async(std::launch::deferred, [] { return false; });
+    } else {
+      // the extents are got while the pages in the file are read
+      std::vector<std::future<bool>> fetches;
+      for (auto &[extent, extent_pages] : offloaded) {
+        fetches.push_back(tiered_->ReadPages(ExtentKey(extent), std::move(extent_pages)));
+      }
+      done = std::async(std::launch::deferred, [done = std::move(done), fetches = std::move(fetches)]() mutable {
+        bool ok = done.get();
+        for (auto &fetch : fetches) {
+          ok = fetch.get() && ok;
+        }
+        return ok;
+      });
+    }
+  }
+  done = ReleaseTierLatchAfter(std::move(done));
+  // decompressed and verified by whoever waits for the reads, once they have completed
+  return std::async(std::launch::deferred, [this, pages, stored, done = std::move(done)]() mutable {
+    bool ok = done.get();
+    for (size_t i = 0; i < pages.size(); ++i) {
+      const auto &[page_id, page_data] = pages[i];
+      if (stored[i] != 0 && !DecompressPage(page_data, stored[i])) {
+        LOG_WARN("page %d cannot be decompressed", page_id);
+        ++num_checksum_failures_;
+        ok = false;
+        continue;
+      }
+      ok = VerifyPage(page_id, page_data) && ok;
+    }
+    return ok;
+  });
+}
+
+bool Tablespace::VerifyPage(page_id_t page_id, const char *page_data) {
+  uint32_t expected = page_checksums_.Get(page_id);
+  if (expected != 0 && expected != PageChecksums::Compute(page_data)) {
+    LOG_WARN("page %d does not match its checksum", page_id);
+    ++num_checksum_failures_;
+    return false;
+  }
+  return true;
+}
+
+bool Tablespace::MapReadOnly() {
+  if (mapping_ != nullptr) {
+    return true;
+  }
+  struct stat stat_buf;
+  if (fstat(fd_, &stat_buf) != 0 || stat_buf.st_size == 0) {
+    return false;
+  }
+  void *mapping = mmap(nullptr, stat_buf.st_size, PROT_READ, MAP_SHARED, fd_, 0);
+  if (mapping == MAP_FAILED) {
+    LOG_DEBUG("cannot map %s: %s", file_name_.c_str(), strerror(errno));
+    return false;
+  }
+  mapping_ = static_cast<char *>(mapping);
+  mapping_size_ = stat_buf.st_size;
+  return true;
+}
+
+const char *Tablespace::GetMappedPage(page_id_t page_id) {
+  auto offset = static_cast<size_t>(FileLayout::PageOffset(page_id));
+  // a compressed page has to be decompressed into a frame of its own
+  if (mapping_ == nullptr || offset + PAGE_SIZE > mapping_size_ || stored_sizes_.Get(page_id) != 0 ||
+      tiers_.Get(page_id) != 0) {
+    return nullptr;
+  }
+  return mapping_ + offset;
+}
+
+bool Tablespace::EnableTiering(ObjectStore *store, const std::string &cache_file, size_t cache_extents) {
+  if (tiered_ != nullptr) {
+    return false;
+  }
+  tiered_ = std::make_unique<TieredStorage>(store, cache_file, cache_extents);
+  return true;
+}
+
+std::string Tablespace::ExtentKey(size_t extent) const {
+  size_t slash = file_name_.rfind('/');
+  std::string base = slash == std::string::npos ? file_name_ : file_name_.substr(slash + 1);
+  return base + ".extent." + std::to_string(extent);
+}
+
+bool Tablespace::OffloadExtent(size_t extent) {
+  auto first_page_id = static_cast<page_id_t>(extent * TieredStorage::EXTENT_PAGES);
+  if (tiered_ == nullptr || first_page_id + static_cast<page_id_t>(TieredStorage::EXTENT_PAGES) > GetNumPages()) {
+    return false;
+  }
+  std::unique_ptr<char, decltype(&std::free)> data(
+      static_cast<char *>(std::aligned_alloc(PAGE_SIZE, TieredStorage::EXTENT_SIZE)), &std::free);
+  if (data == nullptr) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "cannot allocate an extent buffer");
+  }
+  tier_latch_.WLock();
+  bool offloaded = false;
+  if (tiers_.Get(first_page_id) == 0) {
+    // the pages as they are stored, compressed or not, which their stored sizes and checksums go on describing
+    std::vector<IoRequest> reads;
+    for (size_t i = 0; i < TieredStorage::EXTENT_PAGES; ++i) {
+      reads.push_back({false, fd_, FileLayout::PageOffset(first_page_id + static_cast<page_id_t>(i)),
+                       data.get() + i * PAGE_SIZE, static_cast<size_t>(PAGE_SIZE)});
+    }
+    if (SubmitPages(reads).get() && tiered_->Offload(ExtentKey(extent), data.get())) {
+      for (size_t i = 0; i < TieredStorage::EXTENT_PAGES; ++i) {
+        tiers_.Set(first_page_id + static_cast<page_id_t>(i), 1);
+      }
+      // the tier pages have to say that the pages are out before their space goes
+      FlushHeaderPages();
+      if (!tiers_.IsDirty()) {
+        fallocate(fd_, FALLOC_FL_PUNCH_HOLE | FALLOC_FL_KEEP_SIZE, FileLayout::PageOffset(first_page_id),
+                  static_cast<off_t>(TieredStorage::EXTENT_SIZE));
+      }
+      offloaded = true;
+    }
+  }
+  tier_latch_.WUnlock();
+  return offloaded;
+}
+
+bool Tablespace::RecallExtents(const std::vector<size_t> &extents) {
+  std::unique_ptr<char, decltype(&std::free)> data(
+      static_cast<char *>(std::aligned_alloc(PAGE_SIZE, TieredStorage::EXTENT_SIZE)), &std::free);
+  if (data == nullptr) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "cannot allocate an extent buffer");
+  }
+  for (size_t extent : extents) {
+    auto first_page_id = static_cast<page_id_t>(extent * TieredStorage::EXTENT_PAGES);
+    if (tiers_.Get(first_page_id) == 0) {
+      // brought back by a write of another of its pages meanwhile
+      continue;
+    }
+    std::string key = ExtentKey(extent);
+    if (!tiered_->ReadExtent(key, data.get())) {
+      return false;
+    }
+    std::vector<IoRequest> writes;
+    for (size_t i = 0; i < TieredStorage::EXTENT_PAGES; ++i) {
+      writes.push_back({true, fd_, FileLayout::PageOffset(first_page_id + static_cast<page_id_t>(i)),
+                        data.get() + i * PAGE_SIZE, static_cast<size_t>(PAGE_SIZE)});
+    }
+    if (!SubmitPages(writes).get()) {
+      return false;
+    }
+    for (size_t i = 0; i < TieredStorage::EXTENT_PAGES; ++i) {
+      tiers_.Set(first_page_id + static_cast<page_id_t>(i), 0);
+    }
+    // the object goes only once the tier pages say the pages are back in the file
+    FlushHeaderPages();
+    if (!tiers_.IsDirty()) {
+      tiered_->Remove(key);
+    }
+  }
+  return true;
+}
+
+std::future<bool> Tablespace::ReleaseTierLatchAfter(std::future<bool> done) {
+  if (tiered_ == nullptr) {
+    return done;
+  }
+  return std::async(std::launch::async, [this, done = std::move(done)]() mutable {
+    bool ok = done.get();
+    tier_latch_.RUnlock();
+    return ok;
+  });
+}
+
+size_t Tablespace::CompressPage(const char *page_data, char *image) const {
+  // what O_DIRECT transfers have to be a multiple of
+  size_t unit = direct_io_ ? DIRECT_IO_ALIGNMENT : FileLayout::SECTOR_SIZE;
+  if (PAGE_SIZE <= unit) {
+    return PAGE_SIZE;
+  }
+  // only worth it if at least one unit is saved
+  uint32_t size = PageCompressor::Compress(page_data, PAGE_SIZE, image + sizeof(uint32_t),
+                                           PAGE_SIZE - unit - sizeof(uint32_t));
+  if (size == 0) {
+    return PAGE_SIZE;
+  }
+  memcpy(image, &size, sizeof(size));
+  size_t stored = (sizeof(size) + size + unit - 1) / unit * unit;
+  memset(image + sizeof(size) + size, 0, stored - sizeof(size) - size);
+  return stored;
+}
+
+bool Tablespace::DecompressPage(char *page_data, size_t stored) {
+  uint32_t size;
+  memcpy(&size, page_data, sizeof(size));
+  if (size > stored - sizeof(size)) {
+    return false;
+  }
+  std::vector<char> image(page_data + sizeof(size), page_data + sizeof(size) + size);
+  return PageCompressor::Decompress(image.data(), size, page_data, PAGE_SIZE);
+}
+
+std::future<bool> Tablespace::SubmitPages(const std::vector<IoRequest> &requests) {
+  auto is_unaligned = [](const IoRequest &request) {
+    return reinterpret_cast<uintptr_t>(request.data_) % PAGE_SIZE != 0;
+  };
+  size_t num_unaligned =
+      direct_io_ ? static_cast<size_t>(std::count_if(requests.begin(), requests.end(), is_unaligned)) : 0;
+  if (num_unaligned == 0) {
+    return io_engine_->Submit(Coalesce(requests));
+  }
+
+  std::unique_ptr<char, decltype(&std::free)> bounce(
+      static_cast<char *>(std::aligned_alloc(PAGE_SIZE, num_unaligned * PAGE_SIZE)), &std::free);
+  if (bounce == nullptr) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "cannot allocate an O_DIRECT bounce buffer");
+  }
+  std::vector<IoRequest> bounced_requests = requests;
+  size_t bounced = 0;
+  for (IoRequest &request : bounced_requests) {
+    if (is_unaligned(request)) {
+      char *data = bounce.get() + bounced++ * PAGE_SIZE;
+      if (request.is_write_) {
+        memcpy(data, request.data_, request.length_);
+      }
+      request.data_ = data;
+    }
+  }
+
+  // the bounce buffer must outlive the I/O, so this batch is waited for here
+  std::promise<bool> done;
+  done.set_value(io_engine_->Submit(Coalesce(bounced_requests)).get());
+  for (size_t i = 0; i < requests.size(); ++i) {
+    if (!requests[i].is_write_ && requests[i].data_ != bounced_requests[i].data_) {
+      memcpy(requests[i].data_, bounced_requests[i].data_, requests[i].length_);
+    }
+  }
+  return done.get_future();
+}
+
+
+}  // namespace bustub
@@ -0,0 +1,133 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// tiered_storage.cpp
+//
+// Identification: src/storage/disk/tiered_storage.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/disk/tiered_storage.h"
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <cstdio>
+#include <cstring>
+
+#include "common/exception.h"
+#include "common/logger.h"
+
+namespace bustub {
+
+TieredStorage::TieredStorage(ObjectStore *store, std::string cache_file, size_t cache_extents)
+    : store_(store), cache_file_(std::move(cache_file)), cache_extents_(cache_extents) {
+  cache_fd_ = open(cache_file_.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+  if (cache_fd_ < 0) {
+    throw Exception("can't open the tier cache file");
+  }
+  for (size_t slot = cache_extents_; slot > 0; --slot) {
+    free_slots_.push_back(slot - 1);
+  }
+}
+
+TieredStorage::~TieredStorage() {
+  close(cache_fd_);
+  std::remove(cache_file_.c_str());
+}
+
+bool TieredStorage::Offload(const std::string &key, const char *extent) {
+  // a stale copy of an extent that was recalled and offloaded again must not be read
+  DropFromCache(key);
+  return store_->Put(key, extent, EXTENT_SIZE);
+}
+
+std::future<bool> TieredStorage::ReadPages(const std::string &key, std::vector<std::pair<size_t, char *>> pages) {
+  if (ReadCached(key, pages)) {
+    num_cache_hits_++;
+    std::promise<bool> done;
+    done.set_value(true);
+    return done.get_future();
+  }
+  num_cache_misses_++;
+  return std::async(std::launch::async, [this, key, pages = std::move(pages)] {
+    std::vector<char> extent;
+    if (!store_->Get(key, &extent) || extent.size() != EXTENT_SIZE) {
+      LOG_WARN("cannot get the extent %s from the object store", key.c_str());
+      return false;
+    }
+    for (const auto &[index, page_data] : pages) {
+      memcpy(page_data, extent.data() + index * PAGE_SIZE, PAGE_SIZE);
+    }
+    AddToCache(key, extent.data());
+    return true;
+  });
+}
+
+bool TieredStorage::ReadExtent(const std::string &key, char *extent) {
+  std::vector<std::pair<size_t, char *>> pages;
+  for (size_t i = 0; i < EXTENT_PAGES; ++i) {
+    pages.emplace_back(i, extent + i * PAGE_SIZE);
+  }
+  return ReadPages(key, std::move(pages)).get();
+}
+
+void TieredStorage::Remove(const std::string &key) {
+  DropFromCache(key);
+  store_->Delete(key);
+}
+
+bool TieredStorage::ReadCached(const std::string &key, const std::vector<std::pair<size_t, char *>> &pages) {
+  std::scoped_lock latch{latch_};
+  auto it = slots_.find(key);
+  if (it == slots_.end()) {
+    return false;
+  }
+  auto offset = static_cast<off_t>(it->second.first * EXTENT_SIZE);
+  for (const auto &[index, page_data] : pages) {
+    if (pread(cache_fd_, page_data, PAGE_SIZE, offset + static_cast<off_t>(index * PAGE_SIZE)) != PAGE_SIZE) {
+      return false;
+    }
+  }
+  lru_.splice(lru_.begin(), lru_, it->second.second);
+  return true;
+}
+
+void TieredStorage::AddToCache(const std::string &key, const char *extent) {
+  std::scoped_lock latch{latch_};
+  if (cache_extents_ == 0 || slots_.count(key) != 0) {
+    return;
+  }
+  size_t slot;
+  if (!free_slots_.empty()) {
+    slot = free_slots_.back();
+    free_slots_.pop_back();
+  } else {
+    auto victim = slots_.find(lru_.back());
+    slot = victim->second.first;
+    slots_.erase(victim);
+    lru_.pop_back();
+  }
+  if (pwrite(cache_fd_, extent, EXTENT_SIZE, static_cast<off_t>(slot * EXTENT_SIZE)) !=
+      static_cast<ssize_t>(EXTENT_SIZE)) {
+    free_slots_.push_back(slot);
+    return;
+  }
+  lru_.push_front(key);
+  slots_.emplace(key, std::make_pair(slot, lru_.begin()));
+}
+
+void TieredStorage::DropFromCache(const std::string &key) {
+  std::scoped_lock latch{latch_};
+  auto it = slots_.find(key);
+  if (it == slots_.end()) {
+    return;
+  }
+  free_slots_.push_back(it->second.first);
+  lru_.erase(it->second.second);
+  slots_.erase(it);
+}
+
+}  // namespace bustub
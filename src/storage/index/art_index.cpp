@@ -0,0 +1,88 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// art_index.cpp
+//
+// Identification: src/storage/index/art_index.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <string>
+#include <vector>
+
+#include "storage/index/art_index.h"
+#include "storage/index/generic_key.h"
+#include "storage/table/table_iterator.h"
+
+namespace bustub {
+/*
+ * Constructor
+ */
+template <typename KeyType, typename ValueType, typename KeyComparator>
+ART_INDEX_TYPE::ARTIndex(IndexMetadata *metadata)
+    : Index(metadata),
+      unique_(metadata->IsUnique()),
+      container_(unique_ ? sizeof(KeyType) : sizeof(KeyType) + sizeof(RID)) {}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+std::string ART_INDEX_TYPE::MakeKey(const Tuple &key, const RID &rid) const {
+  KeyType index_key;
+  index_key.SetFromKeyNormalized(key, GetKeySchema());
+  std::string bytes(index_key.data_, sizeof(KeyType));
+  if (!unique_) {
+    // big-endian, with the sign bit of the page id flipped, so that the entries of a key are ordered by RID
+    auto page_id = static_cast<uint32_t>(rid.GetPageId()) ^ 0x80000000U;
+    uint32_t slot_num = rid.GetSlotNum();
+    for (int shift = 24; shift >= 0; shift -= 8) {
+      bytes.push_back(static_cast<char>(page_id >> shift));
+    }
+    for (int shift = 24; shift >= 0; shift -= 8) {
+      bytes.push_back(static_cast<char>(slot_num >> shift));
+    }
+  }
+  return bytes;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+void ART_INDEX_TYPE::InsertEntry(const Tuple &key, RID rid, Transaction *transaction) {
+  container_.Insert(MakeKey(key, rid), rid);
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+void ART_INDEX_TYPE::DeleteEntry(const Tuple &key, RID rid, Transaction *transaction) {
+  container_.Remove(MakeKey(key, rid));
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+void ART_INDEX_TYPE::ScanKey(const Tuple &key, std::vector<RID> *result, Transaction *transaction) {
+  std::string index_key = MakeKey(key, RID());
+  if (unique_) {
+    RID rid;
+    if (container_.GetValue(index_key, &rid)) {
+      result->push_back(rid);
+    }
+    return;
+  }
+  // all entries of the key start with its normalized form
+  index_key.resize(sizeof(KeyType));
+  container_.ScanPrefix(index_key, result);
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+void ART_INDEX_TYPE::BuildFromTableHeap(TableHeap *table_heap, const Schema &table_schema, Transaction *transaction) {
+  for (auto iterator = table_heap->Begin(transaction); iterator != table_heap->End(); ++iterator) {
+    Tuple key = iterator->KeyFromTuple(table_schema, *GetKeySchema(), GetKeyAttrs());
+    InsertEntry(key, iterator->GetRid(), transaction);
+  }
+}
+
+template class ARTIndex<GenericKey<4>, RID, GenericComparator<4>>;
+template class ARTIndex<GenericKey<8>, RID, GenericComparator<8>>;
+template class ARTIndex<GenericKey<16>, RID, GenericComparator<16>>;
+template class ARTIndex<GenericKey<32>, RID, GenericComparator<32>>;
+template class ARTIndex<GenericKey<64>, RID, GenericComparator<64>>;
+
+}  // namespace bustub
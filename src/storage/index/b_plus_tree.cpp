@@ -9,7 +9,10 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <algorithm>
 #include <string>
+#include <type_traits>
+#include <utility>
 
 #include "common/exception.h"
 #include "common/rid.h"
@@ -24,14 +27,17 @@ BPLUSTREE_TYPE::BPlusTree(std::string name, BufferPoolManager *buffer_pool_manag
       root_page_id_(INVALID_PAGE_ID),
       buffer_pool_manager_(buffer_pool_manager),
       comparator_(comparator),
-      leaf_max_size_(leaf_max_size),
-      internal_max_size_(internal_max_size) {}
+      leaf_max_size_(std::min<int>(leaf_max_size, LEAF_PAGE_SIZE)),
+      // an internal page holds one child more than its max size before it is split
+      internal_max_size_(std::min<int>(internal_max_size, (PAGE_SIZE - INTERNAL_PAGE_HEADER_SIZE) /
+                                                                  sizeof(std::pair<KeyType, page_id_t>) -
+                                                              1)) {}
 
 /*
  * Helper function to decide whether current b+tree is empty
  */
 INDEX_TEMPLATE_ARGUMENTS
-bool BPLUSTREE_TYPE::IsEmpty() const { return true; }
+bool BPLUSTREE_TYPE::IsEmpty() const { return root_page_id_ == INVALID_PAGE_ID; }
 /*****************************************************************************
  * SEARCH
  *****************************************************************************/
@@ -42,7 +48,45 @@ bool BPLUSTREE_TYPE::IsEmpty() const { return true; }
  */
 INDEX_TEMPLATE_ARGUMENTS
 bool BPLUSTREE_TYPE::GetValue(const KeyType &key, std::vector<ValueType> *result, Transaction *transaction) {
-  return false;
+  AdaptiveHash *adaptive_hash = adaptive_hash_.get();
+  uint64_t hash = 0;
+  uint64_t epoch = 0;
+  if (adaptive_hash != nullptr) {
+    hash = AdaptiveHash::Hash(key);
+    epoch = adaptive_hash->GetEpoch();
+    ValueType value;
+    if (TryAdaptiveLookup(key, hash, epoch, &value)) {
+      result->push_back(value);
+      return true;
+    }
+  }
+  for (int attempt = 0; attempt < MAX_OPTIMISTIC_READS; attempt++) {
+    ValueType value;
+    bool found;
+    typename AdaptiveHash::Location location;
+    if (TryOptimisticLookup(key, &value, &found, adaptive_hash != nullptr ? &location : nullptr)) {
+      if (found) {
+        result->push_back(value);
+        if (adaptive_hash != nullptr) {
+          adaptive_hash->RecordDescent(key, hash, epoch, location);
+        }
+      }
+      return found;
+    }
+  }
+  // writers kept getting in the way, so wait for them on the latches
+  Page *page = FindLeafPageRead(key, false);
+  if (page == nullptr) {
+    return false;
+  }
+  ValueType value;
+  bool found = reinterpret_cast<LeafPage *>(page->GetData())->Lookup(key, &value, comparator_);
+  if (found) {
+    result->push_back(value);
+  }
+  page->RUnlatch();
+  buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+  return found;
 }
 
 /*****************************************************************************
@@ -56,7 +100,64 @@ bool BPLUSTREE_TYPE::GetValue(const KeyType &key, std::vector<ValueType> *result
  * keys return false, otherwise return true.
  */
 INDEX_TEMPLATE_ARGUMENTS
-bool BPLUSTREE_TYPE::Insert(const KeyType &key, const ValueType &value, Transaction *transaction) { return false; }
+bool BPLUSTREE_TYPE::Insert(const KeyType &key, const ValueType &value, Transaction *transaction) {
+  bool result;
+  // ascending keys all go into the right-most leaf, which is found without a descent
+  Page *page = FindRightmostLeafPage(key);
+  if (page != nullptr && InsertIfSafe(page, key, value, &result)) {
+    return result;
+  }
+  bool is_root;
+  page = FindLeafPageOptimistic(key, &is_root);
+  if (page != nullptr && InsertIfSafe(page, key, value, &result)) {
+    return result;
+  }
+  // the leaf has to be split, or there is no leaf yet
+  return InsertIntoLeaf(key, value, transaction);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+Page *BPLUSTREE_TYPE::FindRightmostLeafPage(const KeyType &key) {
+  page_id_t page_id = rightmost_leaf_page_id_;
+  if (page_id == INVALID_PAGE_ID) {
+    return nullptr;
+  }
+  Page *page = buffer_pool_manager_->FetchPage(page_id);
+  if (page == nullptr) {
+    return nullptr;
+  }
+  page->WLatch();
+  // the page may have stopped being the right-most leaf, or even a page of the tree, before it was latched
+  auto *leaf = reinterpret_cast<LeafPage *>(page->GetData());
+  if (rightmost_leaf_page_id_ == page_id && leaf->GetSize() > 0 && comparator_(key, leaf->KeyAt(0)) >= 0) {
+    return page;
+  }
+  page->WUnlatch();
+  buffer_pool_manager_->UnpinPage(page_id, false);
+  return nullptr;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+bool BPLUSTREE_TYPE::InsertIfSafe(Page *page, const KeyType &key, const ValueType &value, bool *result) {
+  auto *leaf = reinterpret_cast<LeafPage *>(page->GetData());
+  ValueType existing;
+  if (leaf->Lookup(key, &existing, comparator_)) {
+    page->WUnlatch();
+    buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+    *result = false;
+    return true;
+  }
+  if (IsSafe(leaf, Operation::INSERT, key)) {
+    leaf->Insert(key, value, comparator_);
+    page->WUnlatch();
+    buffer_pool_manager_->UnpinPage(page->GetPageId(), true);
+    *result = true;
+    return true;
+  }
+  page->WUnlatch();
+  buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+  return false;
+}
 /*
  * Insert constant key & value pair into an empty tree
  * User needs to first ask for new page from buffer pool manager(NOTICE: throw
@@ -64,7 +165,20 @@ bool BPLUSTREE_TYPE::Insert(const KeyType &key, const ValueType &value, Transact
  * tree's root page id and insert entry directly into leaf page.
  */
 INDEX_TEMPLATE_ARGUMENTS
-void BPLUSTREE_TYPE::StartNewTree(const KeyType &key, const ValueType &value) {}
+void BPLUSTREE_TYPE::StartNewTree(const KeyType &key, const ValueType &value) {
+  page_id_t page_id;
+  Page *page = buffer_pool_manager_->NewPage(&page_id);
+  if (page == nullptr) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "cannot allocate a root page");
+  }
+  auto *leaf = reinterpret_cast<LeafPage *>(page->GetData());
+  leaf->Init(page_id, INVALID_PAGE_ID, leaf_max_size_);
+  leaf->Insert(key, value, comparator_);
+  root_page_id_ = page_id;
+  rightmost_leaf_page_id_ = page_id;
+  UpdateRootPageId(1);
+  buffer_pool_manager_->UnpinPage(page_id, true);
+}
 
 /*
  * Insert constant key & value pair into leaf page
@@ -76,7 +190,48 @@ void BPLUSTREE_TYPE::StartNewTree(const KeyType &key, const ValueType &value) {}
  */
 INDEX_TEMPLATE_ARGUMENTS
 bool BPLUSTREE_TYPE::InsertIntoLeaf(const KeyType &key, const ValueType &value, Transaction *transaction) {
-  return false;
+  root_latch_.WLock();
+  bool root_latched = true;
+  if (IsEmpty()) {
+    StartNewTree(key, value);
+    root_latch_.WUnlock();
+    return true;
+  }
+
+  std::deque<Page *> latched;
+  Page *page = FindLeafPagePessimistic(key, Operation::INSERT, &latched, &root_latched);
+  auto *leaf = reinterpret_cast<LeafPage *>(page->GetData());
+  ValueType existing;
+  if (leaf->Lookup(key, &existing, comparator_)) {
+    ReleaseLatched(&latched, &root_latched, false);
+    return false;
+  }
+  // an append to the right-most leaf splits it unevenly, so that the leaves that ascending inserts leave behind are
+  // close to full instead of half empty
+  bool rightmost = leaf->GetNextPageId() == INVALID_PAGE_ID;
+  LeafPage *new_leaf = nullptr;
+  if (!leaf->HasRoomFor(key)) {
+    // the key widens the compressed slots beyond the page: split first, then either half has room for it, as a leaf
+    // that is out of room holds fewer than LEAF_PAGE_SIZE pairs
+    bool append = rightmost && comparator_(key, leaf->KeyAt(leaf->GetSize() - 1)) > 0;
+    new_leaf = Split(leaf, append);
+    (comparator_(key, new_leaf->KeyAt(0)) < 0 ? leaf : new_leaf)->Insert(key, value, comparator_);
+    InsertIntoParent(leaf, new_leaf->KeyAt(0), new_leaf, transaction, append);
+  } else if (leaf->Insert(key, value, comparator_) >= leaf->GetMaxSize()) {
+    // a leaf is split as soon as it is full, so that the next insert always finds room
+    bool append = rightmost && comparator_(key, leaf->KeyAt(leaf->GetSize() - 1)) == 0;
+    new_leaf = Split(leaf, append);
+    InsertIntoParent(leaf, new_leaf->KeyAt(0), new_leaf, transaction, append);
+  }
+  if (new_leaf != nullptr) {
+    if (rightmost) {
+      // the old right-most leaf is still latched
+      rightmost_leaf_page_id_ = new_leaf->GetPageId();
+    }
+    buffer_pool_manager_->UnpinPage(new_leaf->GetPageId(), true);
+  }
+  ReleaseLatched(&latched, &root_latched, true);
+  return true;
 }
 
 /*
@@ -85,11 +240,41 @@ bool BPLUSTREE_TYPE::InsertIntoLeaf(const KeyType &key, const ValueType &value,
  * User needs to first ask for new page from buffer pool manager(NOTICE: throw
  * an "out of memory" exception if returned value is nullptr), then move half
  * of key & value pairs from input page to newly created page
+ * An append split moves only a tenth of them instead: the node will not see
+ * inserts before its last key again.
+ * The new page is returned pinned, and is not latched: it cannot be reached
+ * before the latched node and parent are let go of.
  */
 INDEX_TEMPLATE_ARGUMENTS
 template <typename N>
-N *BPLUSTREE_TYPE::Split(N *node) {
-  return nullptr;
+N *BPLUSTREE_TYPE::Split(N *node, bool append) {
+  page_id_t page_id;
+  Page *page = buffer_pool_manager_->NewPage(&page_id);
+  if (page == nullptr) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "cannot allocate a page to split into");
+  }
+  auto *new_node = reinterpret_cast<N *>(page->GetData());
+  if constexpr (std::is_same_v<N, LeafPage>) {
+    new_node->Init(page_id, node->GetParentPageId(), leaf_max_size_);
+    if (append) {
+      node->MoveTailTo(new_node, std::max(1, node->GetSize() / 10));
+    } else {
+      node->MoveHalfTo(new_node);
+    }
+    new_node->SetNextPageId(node->GetNextPageId());
+    new_node->SetPrevPageId(node->GetPageId());
+    node->SetNextPageId(page_id);
+    LinkPrevLeaf(new_node->GetNextPageId(), page_id);
+  } else {
+    new_node->Init(page_id, node->GetParentPageId(), internal_max_size_);
+    if (append) {
+      // the new node needs two children for a key to separate them by
+      node->MoveTailTo(new_node, std::max(2, node->GetSize() / 10), buffer_pool_manager_);
+    } else {
+      node->MoveHalfTo(new_node, buffer_pool_manager_);
+    }
+  }
+  return new_node;
 }
 
 /*
@@ -100,10 +285,158 @@ N *BPLUSTREE_TYPE::Split(N *node) {
  * User needs to first find the parent page of old_node, parent node must be
  * adjusted to take info of new_node into account. Remember to deal with split
  * recursively if necessary.
+ * The parent is write latched by the caller already, since old_node was not
+ * safe; only a pin is taken on it here.
  */
 INDEX_TEMPLATE_ARGUMENTS
 void BPLUSTREE_TYPE::InsertIntoParent(BPlusTreePage *old_node, const KeyType &key, BPlusTreePage *new_node,
-                                      Transaction *transaction) {}
+                                      Transaction *transaction, bool append) {
+  if (old_node->IsRootPage()) {
+    // root_latch_ is still held, as the root was not safe either
+    page_id_t root_page_id;
+    Page *page = buffer_pool_manager_->NewPage(&root_page_id);
+    if (page == nullptr) {
+      throw Exception(ExceptionType::OUT_OF_MEMORY, "cannot allocate a new root page");
+    }
+    auto *root = reinterpret_cast<InternalPage *>(page->GetData());
+    root->Init(root_page_id, INVALID_PAGE_ID, internal_max_size_);
+    root->PopulateNewRoot(old_node->GetPageId(), key, new_node->GetPageId());
+    old_node->SetParentPageId(root_page_id);
+    new_node->SetParentPageId(root_page_id);
+    root_page_id_ = root_page_id;
+    UpdateRootPageId();
+    buffer_pool_manager_->UnpinPage(root_page_id, true);
+    return;
+  }
+
+  Page *parent_page = FetchTreePage(old_node->GetParentPageId());
+  auto *parent = reinterpret_cast<InternalPage *>(parent_page->GetData());
+  if (parent->InsertNodeAfter(old_node->GetPageId(), key, new_node->GetPageId()) > parent->GetMaxSize()) {
+    append = append && parent->ValueAt(parent->GetSize() - 1) == new_node->GetPageId();
+    InternalPage *new_parent = Split(parent, append);
+    InsertIntoParent(parent, new_parent->KeyAt(0), new_parent, transaction, append);
+    buffer_pool_manager_->UnpinPage(new_parent->GetPageId(), true);
+  }
+  buffer_pool_manager_->UnpinPage(parent_page->GetPageId(), true);
+}
+
+/*****************************************************************************
+ * BULK LOAD
+ *****************************************************************************/
+/*
+ * Build the tree from pairs sorted by strictly increasing key, e.g. the output
+ * of an external sort, instead of inserting them one by one. The leaves are
+ * filled left to right and every internal level on top of them as its children
+ * are started, so no node is ever split. Each level spreads its entries evenly
+ * over as many nodes as filling them fill_factor full takes, but no further
+ * than their min and max size allow; leftover room lets later inserts go in
+ * without splitting right away.
+ * The pages are written through a small ring of frames, and the tree only
+ * becomes visible once the root page id is set.
+ * @return: false if the tree is not empty or the pairs are not sorted, true
+ * otherwise.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+bool BPLUSTREE_TYPE::BulkLoad(const std::vector<std::pair<KeyType, ValueType>> &pairs, double fill_factor,
+                              Transaction *transaction) {
+  for (size_t i = 1; i < pairs.size(); ++i) {
+    if (comparator_(pairs[i - 1].first, pairs[i].first) >= 0) {
+      return false;
+    }
+  }
+  root_latch_.WLock();
+  if (!IsEmpty()) {
+    root_latch_.WUnlock();
+    return false;
+  }
+  if (pairs.empty()) {
+    root_latch_.WUnlock();
+    return true;
+  }
+
+  // the shape of the tree follows from the number of pairs; a leaf is split once it reaches its max size, an
+  // internal page once it exceeds it, and the min sizes are those of BPlusTreePage::GetMinSize
+  std::vector<BulkLevel> levels;
+  // a leaf holds at least as many pairs as fit with just the bytes that all keys have in common left out
+  int leaf_size = std::min(leaf_max_size_ - 1, LeafPage::MaxSizeFor(pairs.data(), pairs.size()));
+  size_t num_nodes = BulkNumNodes(pairs.size(), fill_factor, std::min(leaf_max_size_ / 2, leaf_size), leaf_size);
+  levels.push_back({nullptr, 0, num_nodes, pairs.size()});
+  while (num_nodes > 1) {
+    size_t num_children = num_nodes;
+    num_nodes = BulkNumNodes(num_children, fill_factor, (internal_max_size_ + 1) / 2, internal_max_size_);
+    levels.push_back({nullptr, 0, num_nodes, num_children});
+  }
+
+  BufferAccessStrategy strategy(BufferAccessStrategy::BulkRingSize(buffer_pool_manager_->GetPoolSize()));
+  for (size_t i = 0; i < pairs.size();) {
+    if (levels[0].room == 0) {
+      BulkStartNode(&levels, 0, pairs[i].first, &strategy);
+    }
+    int count = std::min<size_t>(levels[0].room, pairs.size() - i);
+    reinterpret_cast<LeafPage *>(levels[0].page->GetData())->Append(&pairs[i], count);
+    levels[0].room -= count;
+    i += count;
+  }
+  rightmost_leaf_page_id_ = levels[0].page->GetPageId();
+  for (auto &level : levels) {
+    buffer_pool_manager_->UnpinPage(level.page->GetPageId(), true);
+  }
+  root_page_id_ = levels.back().page->GetPageId();
+  UpdateRootPageId(1);
+  root_latch_.WUnlock();
+  return true;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+size_t BPLUSTREE_TYPE::BulkNumNodes(size_t count, double fill_factor, int min_size, int max_size) {
+  max_size = std::max(max_size, 1);
+  min_size = std::clamp(min_size, 1, max_size);
+  auto fill = std::clamp(static_cast<int>(std::clamp(fill_factor, 0.0, 1.0) * max_size), min_size, max_size);
+  // as many nodes as a fill this full takes, as long as none of them ends up below its min size or above its max
+  size_t num_nodes = (count + fill - 1) / fill;
+  num_nodes = std::min(num_nodes, std::max<size_t>(count / min_size, 1));
+  return std::max(num_nodes, (count + max_size - 1) / max_size);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::BulkStartNode(std::vector<BulkLevel> *levels, size_t level, const KeyType &first_key,
+                                   BufferAccessStrategy *strategy) {
+  page_id_t page_id;
+  Page *page = buffer_pool_manager_->NewPageWithStrategy(&page_id, strategy);
+  if (page == nullptr) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "cannot allocate a page to bulk load into");
+  }
+  page_id_t parent_id = INVALID_PAGE_ID;
+  if (level + 1 < levels->size()) {
+    BulkLevel &parent_level = (*levels)[level + 1];
+    if (parent_level.room == 0) {
+      BulkStartNode(levels, level + 1, first_key, strategy);
+    }
+    // the first key of the parent is never looked at, so it may as well be the key of its first child
+    reinterpret_cast<InternalPage *>(parent_level.page->GetData())->Append(first_key, page_id);
+    --parent_level.room;
+    parent_id = parent_level.page->GetPageId();
+  }
+
+  BulkLevel &node_level = (*levels)[level];
+  if (level == 0) {
+    reinterpret_cast<LeafPage *>(page->GetData())->Init(page_id, parent_id, leaf_max_size_);
+  } else {
+    reinterpret_cast<InternalPage *>(page->GetData())->Init(page_id, parent_id, internal_max_size_);
+  }
+  if (node_level.page != nullptr) {
+    if (level == 0) {
+      reinterpret_cast<LeafPage *>(node_level.page->GetData())->SetNextPageId(page_id);
+      reinterpret_cast<LeafPage *>(page->GetData())->SetPrevPageId(node_level.page->GetPageId());
+    }
+    buffer_pool_manager_->UnpinPage(node_level.page->GetPageId(), true);
+  }
+  node_level.page = page;
+  // spread what is left evenly, so that node sizes differ by one at most
+  node_level.room = static_cast<int>((node_level.entries_left + node_level.nodes_left - 1) / node_level.nodes_left);
+  node_level.entries_left -= node_level.room;
+  --node_level.nodes_left;
+}
 
 /*****************************************************************************
  * REMOVE
@@ -116,19 +449,181 @@ void BPLUSTREE_TYPE::InsertIntoParent(BPlusTreePage *old_node, const KeyType &ke
  * necessary.
  */
 INDEX_TEMPLATE_ARGUMENTS
-void BPLUSTREE_TYPE::Remove(const KeyType &key, Transaction *transaction) {}
+void BPLUSTREE_TYPE::Remove(const KeyType &key, Transaction *transaction) {
+  bool is_root;
+  Page *page = FindLeafPageOptimistic(key, &is_root);
+  if (page == nullptr) {
+    return;
+  }
+  auto *leaf = reinterpret_cast<LeafPage *>(page->GetData());
+  ValueType existing;
+  if (!leaf->Lookup(key, &existing, comparator_)) {
+    page->WUnlatch();
+    buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+    return;
+  }
+  // the parent page id of a leaf may be changed under just its parent's latch, so the descent tells whether it is root
+  if (is_root ? leaf->GetSize() > 1 : leaf->GetSize() > MinSizeFor(leaf, Operation::REMOVE)) {
+    leaf->RemoveAndDeleteRecord(key, comparator_);
+    page->WUnlatch();
+    buffer_pool_manager_->UnpinPage(page->GetPageId(), true);
+    return;
+  }
+  page->WUnlatch();
+  buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+  RemoveFromLeaf(key, transaction);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::RemoveFromLeaf(const KeyType &key, Transaction *transaction) {
+  root_latch_.WLock();
+  bool root_latched = true;
+  if (IsEmpty()) {
+    root_latch_.WUnlock();
+    return;
+  }
+
+  std::deque<Page *> latched;
+  Page *page = FindLeafPagePessimistic(key, Operation::REMOVE, &latched, &root_latched);
+  auto *leaf = reinterpret_cast<LeafPage *>(page->GetData());
+  int size = leaf->GetSize();
+  if (leaf->RemoveAndDeleteRecord(key, comparator_) == size) {
+    ReleaseLatched(&latched, &root_latched, false);
+    return;
+  }
+  RebalanceLatched(Operation::REMOVE, &latched, &root_latched);
+}
+
+/*
+ * Merges or redistributes the leaf a pessimistic descent for op ended at, and
+ * its ancestors for as long as merges make them underflow in turn; then lets go
+ * of everything the descent latched.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::RebalanceLatched(Operation op, std::deque<Page *> *latched, bool *root_latched) {
+  // bottom up, letting go of each level before the next one latches a sibling: holding on to a leaf while latching
+  // a page of another subtree would deadlock with a writer descending there and an iterator moving right
+  std::vector<page_id_t> deleted_pages;
+  bool coalesced = CoalesceOrRedistribute<LeafPage>(latched->back(), op, &deleted_pages);
+  // the leaf may be reused for anything once it is deleted, which the version of its frame does not tell
+  if (!deleted_pages.empty() && adaptive_hash_ != nullptr) {
+    adaptive_hash_->InvalidateAll();
+  }
+  do {
+    Page *page = latched->back();
+    latched->pop_back();
+    page->WUnlatch();
+    buffer_pool_manager_->UnpinPage(page->GetPageId(), true);
+    if (coalesced && !latched->empty()) {
+      coalesced = CoalesceOrRedistribute<InternalPage>(latched->back(), op, &deleted_pages);
+    }
+  } while (coalesced && !latched->empty());
+  ReleaseLatched(latched, root_latched, true);
+  // unpinned and unreachable by now, unless an iterator still pins a leaf, which then stays behind in the pool
+  for (page_id_t page_id : deleted_pages) {
+    buffer_pool_manager_->DeletePage(page_id);
+  }
+}
+
+/*
+ * Lazy removes leave leaves below their min size behind. Walk the leaf chain
+ * once, noting the first key of every such leaf, then merge or redistribute
+ * each of them with a pessimistic descent of its own; a leaf that filled up
+ * again in the meantime is left alone.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::Compact(Transaction *transaction) {
+  std::vector<KeyType> underfull_keys;
+  Page *page = FindLeafPageRead(KeyType(), true);
+  while (page != nullptr) {
+    auto *leaf = reinterpret_cast<LeafPage *>(page->GetData());
+    if (!leaf->IsRootPage() && leaf->GetSize() > 0 && leaf->GetSize() < leaf->GetMinSize()) {
+      underfull_keys.push_back(leaf->KeyAt(0));
+    }
+    Page *next_page = nullptr;
+    if (leaf->GetNextPageId() != INVALID_PAGE_ID) {
+      next_page = FetchTreePage(leaf->GetNextPageId());
+      next_page->RLatch();
+    }
+    page->RUnlatch();
+    buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+    page = next_page;
+  }
+
+  for (const KeyType &key : underfull_keys) {
+    root_latch_.WLock();
+    bool root_latched = true;
+    if (IsEmpty()) {
+      root_latch_.WUnlock();
+      return;
+    }
+    std::deque<Page *> latched;
+    FindLeafPagePessimistic(key, Operation::COMPACT, &latched, &root_latched);
+    RebalanceLatched(Operation::COMPACT, &latched, &root_latched);
+  }
+}
 
 /*
  * User needs to first find the sibling of input page. If sibling's size + input
  * page's size > page's max size, then redistribute. Otherwise, merge.
  * Using template N to represent either internal page or leaf page.
- * @return: true means target leaf page should be deleted, false means no
- * deletion happens
+ * The node and its parent are write latched by the caller; the pages that
+ * become empty are collected in deleted_pages, to be deleted once every latch
+ * is let go of. op decides how small the node may get, see MinSizeFor.
+ * @return: true means the node was merged with its sibling, so the parent
+ * lost an entry and has to be looked at next
  */
 INDEX_TEMPLATE_ARGUMENTS
 template <typename N>
-bool BPLUSTREE_TYPE::CoalesceOrRedistribute(N *node, Transaction *transaction) {
-  return false;
+bool BPLUSTREE_TYPE::CoalesceOrRedistribute(Page *node_page, Operation op, std::vector<page_id_t> *deleted_pages) {
+  auto *node = reinterpret_cast<N *>(node_page->GetData());
+  if (node->IsRootPage()) {
+    if (AdjustRoot(node)) {
+      deleted_pages->push_back(node->GetPageId());
+    }
+    return false;
+  }
+  if (node->GetSize() >= MinSizeFor(node, op)) {
+    return false;
+  }
+
+  Page *parent_page = FetchTreePage(node->GetParentPageId());
+  auto *parent = reinterpret_cast<InternalPage *>(parent_page->GetData());
+  int index = parent->ValueIndex(node->GetPageId());
+  // prefer the left sibling, so that a merge moves this node into it
+  int sibling_index = index == 0 ? 1 : index - 1;
+  Page *sibling_page = FetchTreePage(parent->ValueAt(sibling_index));
+  if (std::is_same_v<N, LeafPage> && index != 0) {
+    // iterators latch leaves left to right, so the left sibling has to be latched before this leaf; nobody else can
+    // get to this leaf in between, as its parent stays latched
+    node_page->WUnlatch();
+    sibling_page->WLatch();
+    node_page->WLatch();
+  } else {
+    sibling_page->WLatch();
+  }
+  auto *sibling = reinterpret_cast<N *>(sibling_page->GetData());
+
+  // a leaf has to end up below its max size, an internal page may be at it
+  int merged_size = sibling->GetSize() + node->GetSize();
+  bool coalesce = node->IsLeafPage() ? merged_size < node->GetMaxSize() : merged_size <= node->GetMaxSize();
+  if constexpr (std::is_same_v<N, LeafPage>) {
+    // together, the keys of both leaves may have fewer bytes in common than apart
+    coalesce = coalesce && (index == 0 ? node->HasRoomForAll(sibling) : sibling->HasRoomForAll(node));
+  }
+  if (coalesce) {
+    if (index == 0) {
+      Coalesce(node, sibling, parent, sibling_index, deleted_pages);
+    } else {
+      Coalesce(sibling, node, parent, index, deleted_pages);
+    }
+  } else {
+    Redistribute(sibling, node, parent, index);
+  }
+  sibling_page->WUnlatch();
+  buffer_pool_manager_->UnpinPage(sibling_page->GetPageId(), true);
+  buffer_pool_manager_->UnpinPage(parent_page->GetPageId(), true);
+  return coalesce;
 }
 
 /*
@@ -137,32 +632,65 @@ bool BPLUSTREE_TYPE::CoalesceOrRedistribute(N *node, Transaction *transaction) {
  * take info of deletion into account. Remember to deal with coalesce or
  * redistribute recursively if necessary.
  * Using template N to represent either internal page or leaf page.
- * @param   neighbor_node      sibling page of input "node"
- * @param   node               input from method coalesceOrRedistribute()
- * @param   parent             parent page of input "node"
- * @return  true means parent node should be deleted, false means no deletion
- * happend
+ * @param   neighbor_node      the left one of the two pages, which is kept
+ * @param   node               the right one of the two pages, which is emptied
+ * @param   parent             parent page of both
+ * @param   index              index of node in parent
  */
 INDEX_TEMPLATE_ARGUMENTS
 template <typename N>
-bool BPLUSTREE_TYPE::Coalesce(N **neighbor_node, N **node,
-                              BPlusTreeInternalPage<KeyType, page_id_t, KeyComparator> **parent, int index,
-                              Transaction *transaction) {
-  return false;
+void BPLUSTREE_TYPE::Coalesce(N *neighbor_node, N *node, InternalPage *parent, int index,
+                              std::vector<page_id_t> *deleted_pages) {
+  if constexpr (std::is_same_v<N, LeafPage>) {
+    node->MoveAllTo(neighbor_node);
+    LinkPrevLeaf(neighbor_node->GetNextPageId(), neighbor_node->GetPageId());
+    if (neighbor_node->GetNextPageId() == INVALID_PAGE_ID) {
+      // both leaves are latched, so the cache moves on to the neighbor before node goes away
+      rightmost_leaf_page_id_ = neighbor_node->GetPageId();
+    }
+  } else {
+    node->MoveAllTo(neighbor_node, parent->KeyAt(index), buffer_pool_manager_);
+  }
+  parent->Remove(index);
+  deleted_pages->push_back(node->GetPageId());
 }
 
 /*
  * Redistribute key & value pairs from one page to its sibling page. If index ==
  * 0, move sibling page's first key & value pair into end of input "node",
  * otherwise move sibling page's last key & value pair into head of input
- * "node".
+ * "node". A leaf takes as many pairs as it needs to reach its min size, as
+ * long as the sibling can spare them.
  * Using template N to represent either internal page or leaf page.
  * @param   neighbor_node      sibling page of input "node"
  * @param   node               input from method coalesceOrRedistribute()
+ * @param   parent             parent page of both, whose separator key is updated
+ * @param   index              index of node in parent
  */
 INDEX_TEMPLATE_ARGUMENTS
 template <typename N>
-void BPLUSTREE_TYPE::Redistribute(N *neighbor_node, N *node, int index) {}
+void BPLUSTREE_TYPE::Redistribute(N *neighbor_node, N *node, InternalPage *parent, int index) {
+  if (index == 0) {
+    if constexpr (std::is_same_v<N, LeafPage>) {
+      // a leaf left far below its min size by lazy removes is filled up in one go
+      do {
+        neighbor_node->MoveFirstToEndOf(node);
+      } while (node->GetSize() < node->GetMinSize() && neighbor_node->GetSize() > neighbor_node->GetMinSize());
+    } else {
+      neighbor_node->MoveFirstToEndOf(node, parent->KeyAt(1), buffer_pool_manager_);
+    }
+    parent->SetKeyAt(1, neighbor_node->KeyAt(0));
+  } else {
+    if constexpr (std::is_same_v<N, LeafPage>) {
+      do {
+        neighbor_node->MoveLastToFrontOf(node);
+      } while (node->GetSize() < node->GetMinSize() && neighbor_node->GetSize() > neighbor_node->GetMinSize());
+    } else {
+      neighbor_node->MoveLastToFrontOf(node, parent->KeyAt(index), buffer_pool_manager_);
+    }
+    parent->SetKeyAt(index, node->KeyAt(0));
+  }
+}
 /*
  * Update root page if necessary
  * NOTE: size of root page can be less than min size and this method is only
@@ -172,9 +700,28 @@ void BPLUSTREE_TYPE::Redistribute(N *neighbor_node, N *node, int index) {}
  * case 2: when you delete the last element in whole b+ tree
  * @return : true means root page should be deleted, false means no deletion
  * happend
+ * root_latch_ is held whenever one of the cases applies, as the root was not
+ * safe then.
  */
 INDEX_TEMPLATE_ARGUMENTS
-bool BPLUSTREE_TYPE::AdjustRoot(BPlusTreePage *old_root_node) { return false; }
+bool BPLUSTREE_TYPE::AdjustRoot(BPlusTreePage *old_root_node) {
+  if (!old_root_node->IsLeafPage() && old_root_node->GetSize() == 1) {
+    page_id_t child_page_id = reinterpret_cast<InternalPage *>(old_root_node)->RemoveAndReturnOnlyChild();
+    Page *child_page = FetchTreePage(child_page_id);
+    reinterpret_cast<BPlusTreePage *>(child_page->GetData())->SetParentPageId(INVALID_PAGE_ID);
+    buffer_pool_manager_->UnpinPage(child_page_id, true);
+    root_page_id_ = child_page_id;
+    UpdateRootPageId();
+    return true;
+  }
+  if (old_root_node->IsLeafPage() && old_root_node->GetSize() == 0) {
+    root_page_id_ = INVALID_PAGE_ID;
+    rightmost_leaf_page_id_ = INVALID_PAGE_ID;
+    UpdateRootPageId();
+    return true;
+  }
+  return false;
+}
 
 /*****************************************************************************
  * INDEX ITERATOR
@@ -185,7 +732,13 @@ bool BPLUSTREE_TYPE::AdjustRoot(BPlusTreePage *old_root_node) { return false; }
  * @return : index iterator
  */
 INDEX_TEMPLATE_ARGUMENTS
-INDEXITERATOR_TYPE BPLUSTREE_TYPE::begin() { return INDEXITERATOR_TYPE(); }
+INDEXITERATOR_TYPE BPLUSTREE_TYPE::begin() {
+  Page *page = FindLeafPageRead(KeyType(), true);
+  if (page == nullptr) {
+    return INDEXITERATOR_TYPE();
+  }
+  return INDEXITERATOR_TYPE(buffer_pool_manager_, page, 0);
+}
 
 /*
  * Input parameter is low key, find the leaf page that contains the input key
@@ -193,7 +746,14 @@ INDEXITERATOR_TYPE BPLUSTREE_TYPE::begin() { return INDEXITERATOR_TYPE(); }
  * @return : index iterator
  */
 INDEX_TEMPLATE_ARGUMENTS
-INDEXITERATOR_TYPE BPLUSTREE_TYPE::Begin(const KeyType &key) { return INDEXITERATOR_TYPE(); }
+INDEXITERATOR_TYPE BPLUSTREE_TYPE::Begin(const KeyType &key) {
+  Page *page = FindLeafPageRead(key, false);
+  if (page == nullptr) {
+    return INDEXITERATOR_TYPE();
+  }
+  int index = reinterpret_cast<LeafPage *>(page->GetData())->KeyIndex(key, comparator_);
+  return INDEXITERATOR_TYPE(buffer_pool_manager_, page, index);
+}
 
 /*
  * Input parameter is void, construct an index iterator representing the end
@@ -203,6 +763,60 @@ INDEXITERATOR_TYPE BPLUSTREE_TYPE::Begin(const KeyType &key) { return INDEXITERA
 INDEX_TEMPLATE_ARGUMENTS
 INDEXITERATOR_TYPE BPLUSTREE_TYPE::end() { return INDEXITERATOR_TYPE(); }
 
+/*
+ * Find the rightmost leaf page first, then construct a reverse index iterator
+ * on its last pair
+ * @return : reverse index iterator
+ */
+INDEX_TEMPLATE_ARGUMENTS
+REVERSE_INDEXITERATOR_TYPE BPLUSTREE_TYPE::rbegin() {
+  Page *page = FindLeafPageRead(KeyType(), false, true);
+  if (page == nullptr) {
+    return REVERSE_INDEXITERATOR_TYPE();
+  }
+  int index = reinterpret_cast<LeafPage *>(page->GetData())->GetSize() - 1;
+  return REVERSE_INDEXITERATOR_TYPE(buffer_pool_manager_, FindPairBeforeFn(), page, index);
+}
+
+/*
+ * Input parameter is high key, find the leaf page that contains the input key
+ * first, then construct a reverse index iterator on the last pair whose key is
+ * not greater than it
+ * @return : reverse index iterator
+ */
+INDEX_TEMPLATE_ARGUMENTS
+REVERSE_INDEXITERATOR_TYPE BPLUSTREE_TYPE::RBegin(const KeyType &key) {
+  Page *page = FindLeafPageRead(key, false);
+  if (page == nullptr) {
+    return REVERSE_INDEXITERATOR_TYPE();
+  }
+  auto *leaf = reinterpret_cast<LeafPage *>(page->GetData());
+  int index = leaf->KeyIndex(key, comparator_);
+  if (index == leaf->GetSize() || comparator_(leaf->KeyAt(index), key) != 0) {
+    --index;
+  }
+  return REVERSE_INDEXITERATOR_TYPE(buffer_pool_manager_, FindPairBeforeFn(), page, index);
+}
+
+/*
+ * Construct a reverse index iterator representing the end, i.e. the position
+ * before the first pair
+ * @return : reverse index iterator
+ */
+INDEX_TEMPLATE_ARGUMENTS
+REVERSE_INDEXITERATOR_TYPE BPLUSTREE_TYPE::rend() { return REVERSE_INDEXITERATOR_TYPE(); }
+
+INDEX_TEMPLATE_ARGUMENTS
+typename REVERSE_INDEXITERATOR_TYPE::FindPairBefore BPLUSTREE_TYPE::FindPairBeforeFn() {
+  return [this](const KeyType &key, int *index) {
+    Page *page = FindLeafPageRead(key, false);
+    if (page != nullptr) {
+      *index = reinterpret_cast<LeafPage *>(page->GetData())->KeyIndex(key, comparator_) - 1;
+    }
+    return page;
+  };
+}
+
 /*****************************************************************************
  * UTILITIES AND DEBUG
  *****************************************************************************/
@@ -212,7 +826,278 @@ INDEXITERATOR_TYPE BPLUSTREE_TYPE::end() { return INDEXITERATOR_TYPE(); }
  */
 INDEX_TEMPLATE_ARGUMENTS
 Page *BPLUSTREE_TYPE::FindLeafPage(const KeyType &key, bool leftMost) {
-  throw Exception(ExceptionType::NOT_IMPLEMENTED, "Implement this for test");
+  Page *page = FindLeafPageRead(key, leftMost);
+  if (page != nullptr) {
+    page->RUnlatch();
+  }
+  return page;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+Page *BPLUSTREE_TYPE::FetchTreePage(page_id_t page_id) {
+  Page *page = buffer_pool_manager_->FetchPage(page_id);
+  if (page == nullptr) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "cannot fetch a page of the tree");
+  }
+  return page;
+}
+
+/*
+ * Point a leaf back at the leaf before it. The leaf is write latched here: it
+ * is to the right of the leaves the caller holds, so this is in the left to
+ * right order leaves are always latched in.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::LinkPrevLeaf(page_id_t leaf_page_id, page_id_t prev_page_id) {
+  if (leaf_page_id == INVALID_PAGE_ID) {
+    return;
+  }
+  Page *page = FetchTreePage(leaf_page_id);
+  page->WLatch();
+  reinterpret_cast<LeafPage *>(page->GetData())->SetPrevPageId(prev_page_id);
+  page->WUnlatch();
+  buffer_pool_manager_->UnpinPage(leaf_page_id, true);
+}
+
+/*
+ * Look a key up without latching, validating the version of every page read:
+ * a child is only trusted once its parent is seen unchanged after the child's
+ * version was read, so it was still in the tree then, and the root is checked
+ * against root_page_id_ the same way. A child that was deleted in between may
+ * have been read back in from disk; the buffer pool creates a page that reuses
+ * its id in that frame, see BufferPoolManagerInstance::CreatePage. A node whose
+ * size was torn is not searched at all.
+ * @return : false if a writer got in the way, and the lookup has to be retried
+ */
+INDEX_TEMPLATE_ARGUMENTS
+bool BPLUSTREE_TYPE::TryOptimisticLookup(const KeyType &key, ValueType *value, bool *found,
+                                         typename AdaptiveHash::Location *location) {
+  page_id_t page_id = root_page_id_;
+  if (page_id == INVALID_PAGE_ID) {
+    *found = false;
+    return true;
+  }
+  Page *page = FetchTreePage(page_id);
+  uint64_t version;
+  if (!page->ReadVersion(&version) || root_page_id_ != page_id) {
+    buffer_pool_manager_->UnpinPage(page_id, false);
+    return false;
+  }
+  while (true) {
+    auto *node = reinterpret_cast<BPlusTreePage *>(page->GetData());
+    const bool is_leaf = node->IsLeafPage();
+    const int size = node->GetSize();
+    if (size < (is_leaf ? 0 : 1) || size > (is_leaf ? leaf_max_size_ : internal_max_size_)) {
+      buffer_pool_manager_->UnpinPage(page_id, false);
+      return false;
+    }
+    if (is_leaf) {
+      auto *leaf = reinterpret_cast<LeafPage *>(node);
+      if (location == nullptr) {
+        *found = leaf->Lookup(key, value, comparator_);
+      } else {
+        const int slot = leaf->KeyIndex(key, comparator_);
+        *found = slot < size && comparator_(leaf->KeyAt(slot), key) == 0;
+        if (*found) {
+          *value = leaf->GetItem(slot).second;
+          *location = {page_id, slot, version};
+        }
+      }
+      const bool valid = page->ValidateVersion(version);
+      buffer_pool_manager_->UnpinPage(page_id, false);
+      return valid;
+    }
+    page_id_t child_page_id = reinterpret_cast<InternalPage *>(node)->Lookup(key, comparator_);
+    if (!page->ValidateVersion(version)) {
+      buffer_pool_manager_->UnpinPage(page_id, false);
+      return false;
+    }
+    Page *child_page = FetchTreePage(child_page_id);
+    uint64_t child_version;
+    const bool valid = child_page->ReadVersion(&child_version) && page->ValidateVersion(version);
+    buffer_pool_manager_->UnpinPage(page_id, false);
+    if (!valid) {
+      buffer_pool_manager_->UnpinPage(child_page_id, false);
+      return false;
+    }
+    page = child_page;
+    page_id = child_page_id;
+    version = child_version;
+  }
+}
+
+/*
+ * Go straight to the slot the key's entry points at. The slot still holds the
+ * key if no writer latched the leaf since the entry was made, which its version
+ * tells; the key is compared all the same, in case the leaf was evicted and read
+ * back into a frame that happens to be at the same version. The leaf is still
+ * in the tree if no leaf was deleted since, which the epoch tells.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+bool BPLUSTREE_TYPE::TryAdaptiveLookup(const KeyType &key, uint64_t hash, uint64_t epoch, ValueType *value) {
+  typename AdaptiveHash::Location location;
+  if (!adaptive_hash_->Find(key, hash, epoch, &location)) {
+    return false;
+  }
+  Page *page = buffer_pool_manager_->FetchPage(location.page_id_);
+  if (page == nullptr) {
+    return false;
+  }
+  uint64_t version;
+  bool valid = page->ReadVersion(&version) && version == location.version_;
+  if (valid) {
+    auto *leaf = reinterpret_cast<LeafPage *>(page->GetData());
+    const int size = leaf->GetSize();
+    valid = leaf->IsLeafPage() && location.slot_ < size && size <= leaf_max_size_ &&
+            comparator_(leaf->KeyAt(location.slot_), key) == 0;
+    if (valid) {
+      *value = leaf->GetItem(location.slot_).second;
+    }
+    valid = valid && page->ValidateVersion(version) && adaptive_hash_->GetEpoch() == epoch;
+  }
+  buffer_pool_manager_->UnpinPage(location.page_id_, false);
+  if (valid) {
+    adaptive_hash_->RecordHit();
+  }
+  return valid;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+Page *BPLUSTREE_TYPE::FindLeafPageRead(const KeyType &key, bool left_most, bool right_most) {
+  root_latch_.RLock();
+  if (IsEmpty()) {
+    root_latch_.RUnlock();
+    return nullptr;
+  }
+  Page *page = FetchTreePage(root_page_id_);
+  page->RLatch();
+  root_latch_.RUnlock();
+  auto *node = reinterpret_cast<BPlusTreePage *>(page->GetData());
+  while (!node->IsLeafPage()) {
+    auto *internal = reinterpret_cast<InternalPage *>(node);
+    page_id_t child_page_id = left_most    ? internal->ValueAt(0)
+                              : right_most ? internal->ValueAt(internal->GetSize() - 1)
+                                           : internal->Lookup(key, comparator_);
+    Page *child_page = FetchTreePage(child_page_id);
+    child_page->RLatch();
+    page->RUnlatch();
+    buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+    page = child_page;
+    node = reinterpret_cast<BPlusTreePage *>(page->GetData());
+  }
+  return page;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+Page *BPLUSTREE_TYPE::FindLeafPageOptimistic(const KeyType &key, bool *is_root) {
+  root_latch_.RLock();
+  if (IsEmpty()) {
+    root_latch_.RUnlock();
+    return nullptr;
+  }
+  Page *page = FetchTreePage(root_page_id_);
+  page->RLatch();
+  if (reinterpret_cast<BPlusTreePage *>(page->GetData())->IsLeafPage()) {
+    // the root cannot be split or removed while root_latch_ is held, so the read latch may be traded
+    page->RUnlatch();
+    page->WLatch();
+    root_latch_.RUnlock();
+    *is_root = true;
+    return page;
+  }
+  root_latch_.RUnlock();
+
+  *is_root = false;
+  while (true) {
+    auto *internal = reinterpret_cast<InternalPage *>(page->GetData());
+    Page *child_page = FetchTreePage(internal->Lookup(key, comparator_));
+    child_page->RLatch();
+    if (reinterpret_cast<BPlusTreePage *>(child_page->GetData())->IsLeafPage()) {
+      // nobody can split or merge the leaf while its parent is read latched, so the read latch may be traded
+      child_page->RUnlatch();
+      child_page->WLatch();
+      page->RUnlatch();
+      buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+      return child_page;
+    }
+    page->RUnlatch();
+    buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+    page = child_page;
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+Page *BPLUSTREE_TYPE::FindLeafPagePessimistic(const KeyType &key, Operation op, std::deque<Page *> *latched,
+                                              bool *root_latched) {
+  Page *page = FetchTreePage(root_page_id_);
+  page->WLatch();
+  auto *node = reinterpret_cast<BPlusTreePage *>(page->GetData());
+  if (IsSafe(node, op, key)) {
+    ReleaseLatched(latched, root_latched, false);
+  }
+  latched->push_back(page);
+  while (!node->IsLeafPage()) {
+    Page *child_page = FetchTreePage(reinterpret_cast<InternalPage *>(node)->Lookup(key, comparator_));
+    child_page->WLatch();
+    node = reinterpret_cast<BPlusTreePage *>(child_page->GetData());
+    if (IsSafe(node, op, key)) {
+      ReleaseLatched(latched, root_latched, false);
+    }
+    latched->push_back(child_page);
+  }
+  return latched->back();
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+bool BPLUSTREE_TYPE::IsSafe(BPlusTreePage *node, Operation op, const KeyType &key) const {
+  if (op == Operation::INSERT) {
+    // a leaf splits once it is full or the key does not fit, an internal page once it overflows
+    if (node->IsLeafPage()) {
+      return node->GetSize() + 1 < node->GetMaxSize() && static_cast<LeafPage *>(node)->HasRoomFor(key);
+    }
+    return node->GetSize() < node->GetMaxSize();
+  }
+  if (node->IsRootPage()) {
+    // a root leaf goes away with its last pair, a root internal page with its second to last child
+    return node->IsLeafPage() ? node->GetSize() > 1 : node->GetSize() > 2;
+  }
+  return node->GetSize() > MinSizeFor(node, op);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+int BPLUSTREE_TYPE::MinSizeFor(const BPlusTreePage *node, Operation op) const {
+  int threshold = leaf_merge_threshold_;
+  if (op == Operation::REMOVE && node->IsLeafPage() && threshold > 0) {
+    // an empty leaf is never left behind
+    return std::clamp(threshold, 1, node->GetMinSize());
+  }
+  return node->GetMinSize();
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::SetLazyMergeThreshold(int merge_threshold) { leaf_merge_threshold_ = merge_threshold; }
+
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::EnableAdaptiveHashIndex(size_t max_entries) {
+  adaptive_hash_ = max_entries == 0 ? nullptr : std::make_unique<AdaptiveHash>(max_entries, comparator_);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+AdaptiveHashStats BPLUSTREE_TYPE::GetAdaptiveHashStats() const {
+  return adaptive_hash_ == nullptr ? AdaptiveHashStats{} : adaptive_hash_->GetStats();
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::ReleaseLatched(std::deque<Page *> *latched, bool *root_latched, bool is_dirty) {
+  if (*root_latched) {
+    root_latch_.WUnlock();
+    *root_latched = false;
+  }
+  for (Page *page : *latched) {
+    page->WUnlatch();
+    buffer_pool_manager_->UnpinPage(page->GetPageId(), is_dirty);
+  }
+  latched->clear();
 }
 
 /*
@@ -225,17 +1110,34 @@ Page *BPLUSTREE_TYPE::FindLeafPage(const KeyType &key, bool leftMost) {
  */
 INDEX_TEMPLATE_ARGUMENTS
 void BPLUSTREE_TYPE::UpdateRootPageId(int insert_record) {
-  HeaderPage *header_page = static_cast<HeaderPage *>(buffer_pool_manager_->FetchPage(HEADER_PAGE_ID));
-  if (insert_record != 0) {
-    // create a new record<index_name + root_page_id> in header_page
-    header_page->InsertRecord(index_name_, root_page_id_);
-  } else {
+  Page *page = FetchTreePage(HEADER_PAGE_ID);
+  auto *header_page = static_cast<HeaderPage *>(page);
+  // other trees share the header page
+  page->WLatch();
+  // a tree that became empty and starts over has its record already
+  if (insert_record == 0 || !header_page->InsertRecord(index_name_, root_page_id_)) {
     // update root_page_id in header_page
     header_page->UpdateRecord(index_name_, root_page_id_);
   }
+  page->WUnlatch();
   buffer_pool_manager_->UnpinPage(HEADER_PAGE_ID, true);
 }
 
+INDEX_TEMPLATE_ARGUMENTS
+bool BPLUSTREE_TYPE::Reopen() {
+  Page *page = FetchTreePage(HEADER_PAGE_ID);
+  auto *header_page = static_cast<HeaderPage *>(page);
+  page->RLatch();
+  page_id_t root_page_id;
+  bool found = header_page->GetRootId(index_name_, &root_page_id);
+  page->RUnlatch();
+  buffer_pool_manager_->UnpinPage(HEADER_PAGE_ID, false);
+  if (found) {
+    root_page_id_ = root_page_id;
+  }
+  return found;
+}
+
 /*
  * This method is used for test only
  * Read data from file and insert one by one
@@ -249,8 +1151,11 @@ void BPLUSTREE_TYPE::InsertFromFile(const std::string &file_name, Transaction *t
 
     KeyType index_key;
     index_key.SetFromInteger(key);
-    RID rid(key);
-    Insert(index_key, rid, transaction);
+    // only trees of RIDs are filled from files
+    if constexpr (std::is_same_v<ValueType, RID>) {
+      RID rid(key);
+      Insert(index_key, rid, transaction);
+    }
   }
 }
 /*
@@ -399,4 +1304,6 @@ template class BPlusTree<GenericKey<16>, RID, GenericComparator<16>>;
 template class BPlusTree<GenericKey<32>, RID, GenericComparator<32>>;
 template class BPlusTree<GenericKey<64>, RID, GenericComparator<64>>;
 
+template class BPlusTree<GenericKey<8>, InlineRow<256>, GenericComparator<8>>;
+
 }  // namespace bustub
@@ -9,6 +9,15 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <algorithm>
+#include <limits>
+#include <utility>
+#include <vector>
+
+#include "common/exception.h"
+#include "common/util/radix_sort.h"
+#include "concurrency/lock_manager.h"
+#include "container/hash/hash_function.h"
 #include "storage/index/b_plus_tree_index.h"
 
 namespace bustub {
@@ -18,41 +27,451 @@ namespace bustub {
 INDEX_TEMPLATE_ARGUMENTS
 BPLUSTREE_INDEX_TYPE::BPlusTreeIndex(IndexMetadata *metadata, BufferPoolManager *buffer_pool_manager)
     : Index(metadata),
-      comparator_(metadata->GetKeySchema()),
-      container_(metadata->GetName(), buffer_pool_manager, comparator_) {}
+      unique_(metadata->IsUnique()),
+      comparator_(metadata->GetKeySchema(), !unique_, metadata->HasNormalizedKeys()),
+      container_(metadata->GetName(), buffer_pool_manager, comparator_),
+      delta_(KeyLess{&comparator_}) {
+  if (!unique_ && metadata->GetKeySchema()->GetLength() + sizeof(RID) > sizeof(KeyType)) {
+    throw Exception(ExceptionType::OUT_OF_RANGE, "the key of a non-unique index has no room for the RID");
+  }
+}
 
 INDEX_TEMPLATE_ARGUMENTS
-void BPLUSTREE_INDEX_TYPE::InsertEntry(const Tuple &key, RID rid, Transaction *transaction) {
-  // construct insert index key
+BPLUSTREE_INDEX_TYPE::~BPlusTreeIndex() { MergeDelta(); }
+
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_INDEX_TYPE::EnableDelta(size_t max_entries) {
+  delta_latch_.WLock();
+  max_delta_entries_ = max_entries;
+  if (max_entries == 0) {
+    MergeDeltaLocked();
+  }
+  delta_latch_.WUnlock();
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_INDEX_TYPE::MergeDelta() {
+  delta_latch_.WLock();
+  MergeDeltaLocked();
+  delta_latch_.WUnlock();
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_INDEX_TYPE::MergeDeltaLocked() {
+  // in key order, each write after the first to a leaf finds it in the buffer pool
+  for (const auto &[index_key, entry] : delta_) {
+    if (entry.remove_) {
+      container_.Remove(index_key, nullptr);
+    }
+    if (entry.insert_) {
+      container_.Insert(index_key, entry.rid_, nullptr);
+    }
+  }
+  delta_.clear();
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+size_t BPLUSTREE_INDEX_TYPE::GetDeltaSize() {
+  delta_latch_.RLock();
+  size_t size = delta_.size();
+  delta_latch_.RUnlock();
+  return size;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_INDEX_TYPE::WriteDelta(const KeyType &index_key, RID rid, bool insert) {
+  delta_latch_.WLock();
+  DeltaEntry &entry = delta_.try_emplace(index_key, DeltaEntry{false, false, RID()}).first->second;
+  if (!insert) {
+    entry = DeltaEntry{true, false, RID()};
+  } else if (!entry.insert_) {
+    // an insert of a key the delta inserts already is a duplicate, which the tree would not take either
+    entry.insert_ = true;
+    entry.rid_ = rid;
+  }
+  // a delta disabled as the latch was waited for is merged at once
+  if (delta_.size() >= max_delta_entries_) {
+    MergeDeltaLocked();
+  }
+  delta_latch_.WUnlock();
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+KeyType BPLUSTREE_INDEX_TYPE::MakeKey(const Tuple &key, const RID &rid) const {
   KeyType index_key;
-  index_key.SetFromKey(key);
+  if (GetMetadata()->HasNormalizedKeys()) {
+    index_key.SetFromKeyNormalized(key, GetKeySchema(), unique_ ? sizeof(KeyType) : sizeof(KeyType) - sizeof(RID));
+  } else {
+    index_key.SetFromKey(key);
+  }
+  if constexpr (sizeof(KeyType) >= sizeof(RID)) {
+    if (!unique_) {
+      index_key.SetRid(rid);
+    }
+  }
+  return index_key;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+KeyType BPLUSTREE_INDEX_TYPE::MakeSearchKey(const Tuple &key) const {
+  return MakeKey(key, unique_ ? RID() : RID(std::numeric_limits<page_id_t>::min(), 0));
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+RID BPLUSTREE_INDEX_TYPE::KeyRangeRid(const KeyType *key) const {
+  if (key == nullptr) {
+    return LockManager::EndOfIndexRid(index_oid_);
+  }
+  return LockManager::KeyRangeRid(index_oid_, static_cast<uint32_t>(HashFunction<KeyType>().GetHash(*key)));
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+const KeyType *BPLUSTREE_INDEX_TYPE::NextKey(const KeyType &key, KeyType *next) {
+  auto iterator = container_.Begin(key);
+  if (!iterator.isEnd() && comparator_((*iterator).first, key) == 0) {
+    ++iterator;
+  }
+  if (iterator.isEnd()) {
+    return nullptr;
+  }
+  *next = (*iterator).first;
+  return next;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_INDEX_TYPE::LockForWrite(const KeyType *key, bool instant, Transaction *transaction) {
+  if (!lock_manager_->LockKeyRange(transaction, KeyRangeRid(key), LockMode::EXCLUSIVE, instant)) {
+    throw TransactionAbortException(transaction->GetTransactionId(), AbortReason::DEADLOCK);
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_INDEX_TYPE::LockNextKey(const KeyType &key, bool instant, Transaction *transaction) {
+  KeyType next;
+  const KeyType *locked = NextKey(key, &next);
+  while (true) {
+    LockForWrite(locked, instant, transaction);
+    // another entry may have come in after the key as the lock was waited for, whose range is the one to lock then
+    KeyType current;
+    const KeyType *after = NextKey(key, &current);
+    if (after == nullptr ? locked == nullptr : locked != nullptr && comparator_(*after, *locked) == 0) {
+      return;
+    }
+    next = current;
+    locked = after == nullptr ? nullptr : &next;
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_INDEX_TYPE::InsertEntry(const Tuple &key, RID rid, Transaction *transaction) {
+  InsertKey(MakeKey(key, rid), rid, transaction);
+}
 
-  container_.Insert(index_key, rid, transaction);
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_INDEX_TYPE::InsertKey(const KeyType &index_key, RID rid, Transaction *transaction) {
+  if (WritesToDelta(transaction)) {
+    WriteDelta(index_key, rid, true);
+    return;
+  }
+  if (max_delta_entries_ > 0) {
+    // the write goes after the ones of the delta
+    MergeDelta();
+  }
+  if (!LocksKeyRanges(transaction)) {
+    container_.Insert(index_key, rid, transaction);
+    return;
+  }
+  // the range the entry goes into is checked before the entry is inserted, so that a scan of the range waits for
+  // nothing of this transaction, and once more after, for a scan that went past the entry's place in between
+  LockForWrite(&index_key, false, transaction);
+  LockNextKey(index_key, true, transaction);
+  if (!container_.Insert(index_key, rid, transaction)) {
+    return;
+  }
+  try {
+    LockNextKey(index_key, true, transaction);
+  } catch (TransactionAbortException &) {
+    container_.Remove(index_key, transaction);
+    throw;
+  }
 }
 
 INDEX_TEMPLATE_ARGUMENTS
 void BPLUSTREE_INDEX_TYPE::DeleteEntry(const Tuple &key, RID rid, Transaction *transaction) {
-  // construct delete index key
-  KeyType index_key;
-  index_key.SetFromKey(key);
+  DeleteKey(MakeKey(key, rid), transaction);
+}
 
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_INDEX_TYPE::DeleteKey(const KeyType &index_key, Transaction *transaction) {
+  if (WritesToDelta(transaction)) {
+    WriteDelta(index_key, RID(), false);
+    return;
+  }
+  if (max_delta_entries_ > 0) {
+    MergeDelta();
+  }
+  if (LocksKeyRanges(transaction)) {
+    // the range of the entry after this one takes in the deleted entry's, which has to stay locked till the commit
+    LockForWrite(&index_key, false, transaction);
+    LockNextKey(index_key, false, transaction);
+  }
   container_.Remove(index_key, transaction);
 }
 
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_INDEX_TYPE::LockScanPosition(INDEXITERATOR_TYPE *iterator, const KeyType *from, bool inclusive,
+                                            Transaction *transaction) {
+  if (!LocksKeyRanges(transaction)) {
+    return;
+  }
+  while (true) {
+    KeyType key;
+    bool at_end = iterator->isEnd();
+    if (!at_end) {
+      key = (**iterator).first;
+    }
+    RID range = KeyRangeRid(at_end ? nullptr : &key);
+    if (lock_manager_->TryLockKeyRange(transaction, range, LockMode::SHARED)) {
+      return;
+    }
+    // a writer that holds the range may wait for the latch of the leaf, which is let go of to wait for it
+    *iterator = INDEXITERATOR_TYPE();
+    if (!lock_manager_->LockKeyRange(transaction, range, LockMode::SHARED)) {
+      throw TransactionAbortException(transaction->GetTransactionId(), AbortReason::DEADLOCK);
+    }
+    // the entry may be gone by now, or others may have been inserted before it
+    *iterator = GetResumeIterator(from, inclusive);
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+INDEXITERATOR_TYPE BPLUSTREE_INDEX_TYPE::GetResumeIterator(const KeyType *from, bool inclusive) {
+  if (max_delta_entries_ > 0) {
+    MergeDelta();
+  }
+  INDEXITERATOR_TYPE iterator = from == nullptr ? container_.begin() : container_.Begin(*from);
+  while (from != nullptr && !inclusive && !iterator.isEnd() && comparator_((*iterator).first, *from) == 0) {
+    ++iterator;
+  }
+  return iterator;
+}
+
 INDEX_TEMPLATE_ARGUMENTS
 void BPLUSTREE_INDEX_TYPE::ScanKey(const Tuple &key, std::vector<RID> *result, Transaction *transaction) {
-  // construct scan index key
-  KeyType index_key;
-  index_key.SetFromKey(key);
+  if (WritesToDelta(transaction)) {
+    ScanKeyWithDelta(key, result);
+    return;
+  }
+  if (LocksKeyRanges(transaction)) {
+    if (max_delta_entries_ > 0) {
+      MergeDelta();
+    }
+    // the entries of the key are locked as a scan locks them, with the one after them, so that none is inserted
+    KeyType from = MakeSearchKey(key);
+    const KeyType search_key = from;
+    bool inclusive = true;
+    for (auto iterator = container_.Begin(search_key);; ++iterator) {
+      LockScanPosition(&iterator, &from, inclusive, transaction);
+      if (iterator.isEnd() || comparator_.CompareColumns((*iterator).first, search_key) != 0) {
+        return;
+      }
+      result->push_back((*iterator).second);
+      if (unique_) {
+        return;
+      }
+      from = (*iterator).first;
+      inclusive = false;
+    }
+  }
+  if (unique_) {
+    // construct scan index key
+    KeyType index_key = MakeKey(key, RID());
+    container_.GetValue(index_key, result, transaction);
+    return;
+  }
+
+  // the entries of the key start at the one with the smallest RID, and end where the key columns change
+  KeyType index_key = MakeKey(key, RID(std::numeric_limits<page_id_t>::min(), 0));
+  for (auto iterator = container_.Begin(index_key);
+       !iterator.isEnd() && comparator_.CompareColumns((*iterator).first, index_key) == 0; ++iterator) {
+    result->push_back((*iterator).second);
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_INDEX_TYPE::ScanKeyWithDelta(const Tuple &key, std::vector<RID> *result) {
+  // the entries of the key in the tree and in the delta, both in key order, are merged as they are walked
+  const KeyType search_key = MakeSearchKey(key);
+  auto in_range = [&](const KeyType &index_key) {
+    return unique_ ? comparator_(index_key, search_key) == 0 : comparator_.CompareColumns(index_key, search_key) == 0;
+  };
+  delta_latch_.RLock();
+  auto delta = delta_.lower_bound(search_key);
+  auto iterator = container_.Begin(search_key);
+  while (true) {
+    bool tree_left = !iterator.isEnd() && in_range((*iterator).first);
+    bool delta_left = delta != delta_.end() && in_range(delta->first);
+    if (!tree_left && !delta_left) {
+      break;
+    }
+    int cmp = !tree_left ? 1 : !delta_left ? -1 : comparator_((*iterator).first, delta->first);
+    if (cmp < 0) {
+      result->push_back((*iterator).second);
+    } else if (cmp > 0) {
+      if (delta->second.insert_) {
+        result->push_back(delta->second.rid_);
+      }
+    } else if (!delta->second.remove_) {
+      // an insert of a key the tree has is a duplicate, which leaves the entry of the tree
+      result->push_back((*iterator).second);
+    } else if (delta->second.insert_) {
+      result->push_back(delta->second.rid_);
+    }
+    if (cmp <= 0) {
+      ++iterator;
+    }
+    if (cmp >= 0) {
+      ++delta;
+    }
+  }
+  iterator = INDEXITERATOR_TYPE();
+  delta_latch_.RUnlock();
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_INDEX_TYPE::ScanKeys(const std::vector<Tuple> &keys, std::vector<std::vector<RID>> *results,
+                                    Transaction *transaction) {
+  if (LocksKeyRanges(transaction) || WritesToDelta(transaction)) {
+    // a lookup that locks may let go of its leaf, and one with a delta looks in it as well, so each key is looked up
+    // on its own
+    Index::ScanKeys(keys, results, transaction);
+    return;
+  }
+  results->assign(keys.size(), {});
+  // the entries of a key of a non-unique index start at the one with the smallest RID, as in ScanKey
+  RID first_rid = unique_ ? RID() : RID(std::numeric_limits<page_id_t>::min(), 0);
+  std::vector<std::pair<KeyType, size_t>> order(keys.size());
+  for (size_t i = 0; i < keys.size(); ++i) {
+    order[i] = {MakeKey(keys[i], first_rid), i};
+  }
+  SortByKey(&order);
+
+  INDEXITERATOR_TYPE iterator;
+  for (size_t i = 0; i < order.size(); ++i) {
+    const KeyType &index_key = order[i].first;
+    std::vector<RID> *result = &(*results)[order[i].second];
+    if (i > 0 && comparator_(index_key, order[i - 1].first) == 0) {
+      *result = (*results)[order[i - 1].second];
+      continue;
+    }
+    if (!iterator.SeekInLeaf(index_key, comparator_)) {
+      // let go of the leaf before descending again, as the descent may latch it
+      iterator = INDEXITERATOR_TYPE();
+      iterator = container_.Begin(index_key);
+    }
+    for (; !iterator.isEnd(); ++iterator) {
+      const KeyType &key = (*iterator).first;
+      if (unique_ ? comparator_(key, index_key) != 0 : comparator_.CompareColumns(key, index_key) != 0) {
+        break;
+      }
+      result->push_back((*iterator).second);
+    }
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+bool BPLUSTREE_INDEX_TYPE::BulkLoadEntries(const std::vector<std::pair<Tuple, RID>> &entries, double fill_factor,
+                                           Transaction *transaction) {
+  if (max_delta_entries_ > 0) {
+    MergeDelta();
+  }
+  // construct all index keys, then hand them to the container sorted
+  std::vector<std::pair<KeyType, ValueType>> pairs(entries.size());
+  for (size_t i = 0; i < entries.size(); ++i) {
+    pairs[i].first = MakeKey(entries[i].first, entries[i].second);
+    pairs[i].second = entries[i].second;
+  }
+  auto key_less = [this](const auto &a, const auto &b) { return comparator_(a.first, b.first) < 0; };
+  if (!std::is_sorted(pairs.begin(), pairs.end(), key_less)) {
+    SortByKey(&pairs);
+  }
 
-  container_.GetValue(index_key, result, transaction);
+  return container_.BulkLoad(pairs, fill_factor, transaction);
 }
 
 INDEX_TEMPLATE_ARGUMENTS
-INDEXITERATOR_TYPE BPLUSTREE_INDEX_TYPE::GetBeginIterator() { return container_.begin(); }
+std::vector<std::pair<KeyType, RID>> BPLUSTREE_INDEX_TYPE::SortedKeys(
+    const std::vector<std::pair<Tuple, RID>> &entries) const {
+  std::vector<std::pair<KeyType, RID>> keys(entries.size());
+  for (size_t i = 0; i < entries.size(); ++i) {
+    keys[i] = {MakeKey(entries[i].first, entries[i].second), entries[i].second};
+  }
+  SortByKey(&keys);
+  return keys;
+}
 
 INDEX_TEMPLATE_ARGUMENTS
-INDEXITERATOR_TYPE BPLUSTREE_INDEX_TYPE::GetBeginIterator(const KeyType &key) { return container_.Begin(key); }
+template <typename Pair>
+void BPLUSTREE_INDEX_TYPE::SortByKey(std::vector<Pair> *pairs) const {
+  // the entries that are radix sorted are small, and the pairs are moved to their places once, at the end
+  struct SortEntry {
+    uint64_t prefix_;
+    size_t index_;
+  };
+  std::vector<SortEntry> order(pairs->size());
+  for (size_t i = 0; i < pairs->size(); ++i) {
+    if (!comparator_.Prefix((*pairs)[i].first, &order[i].prefix_)) {
+      std::stable_sort(pairs->begin(), pairs->end(),
+                       [this](const Pair &a, const Pair &b) { return comparator_(a.first, b.first) < 0; });
+      return;
+    }
+    order[i].index_ = i;
+  }
+  RadixSortByPrefix(&order, [this, pairs](const SortEntry &a, const SortEntry &b) {
+    int cmp = comparator_((*pairs)[a.index_].first, (*pairs)[b.index_].first);
+    return cmp < 0 || (cmp == 0 && a.index_ < b.index_);
+  });
+  std::vector<Pair> sorted;
+  sorted.reserve(pairs->size());
+  for (const SortEntry &entry : order) {
+    sorted.push_back(std::move((*pairs)[entry.index_]));
+  }
+  *pairs = std::move(sorted);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_INDEX_TYPE::InsertEntries(const std::vector<std::pair<Tuple, RID>> &entries, Transaction *transaction) {
+  // a tree that is not empty, or entries with duplicate keys, are left to single inserts; a bulk load takes no locks
+  if (!LocksKeyRanges(transaction) && BulkLoadEntries(entries, 1.0, transaction)) {
+    return;
+  }
+  for (const auto &[index_key, rid] : SortedKeys(entries)) {
+    InsertKey(index_key, rid, transaction);
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_INDEX_TYPE::DeleteEntries(const std::vector<std::pair<Tuple, RID>> &entries, Transaction *transaction) {
+  for (const auto &entry : SortedKeys(entries)) {
+    DeleteKey(entry.first, transaction);
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+INDEXITERATOR_TYPE BPLUSTREE_INDEX_TYPE::GetBeginIterator() {
+  if (max_delta_entries_ > 0) {
+    MergeDelta();
+  }
+  return container_.begin();
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+INDEXITERATOR_TYPE BPLUSTREE_INDEX_TYPE::GetBeginIterator(const KeyType &key) {
+  if (max_delta_entries_ > 0) {
+    MergeDelta();
+  }
+  return container_.Begin(key);
+}
 
 INDEX_TEMPLATE_ARGUMENTS
 INDEXITERATOR_TYPE BPLUSTREE_INDEX_TYPE::GetEndIterator() { return container_.end(); }
@@ -0,0 +1,68 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// bitmap_index.cpp
+//
+// Identification: src/storage/index/bitmap_index.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/index/bitmap_index.h"
+
+#include <mutex>  // NOLINT
+
+namespace bustub {
+
+void BitmapIndex::InsertEntry(const Tuple &key, RID rid, Transaction *transaction) {
+  std::unique_lock lock(latch_);
+  bitmaps_[KeyOf(key)].Add(ToBitmapValue(rid));
+}
+
+void BitmapIndex::DeleteEntry(const Tuple &key, RID rid, Transaction *transaction) {
+  std::unique_lock lock(latch_);
+  auto bitmap = bitmaps_.find(KeyOf(key));
+  if (bitmap == bitmaps_.end()) {
+    return;
+  }
+  bitmap->second.Remove(ToBitmapValue(rid));
+  if (bitmap->second.IsEmpty()) {
+    bitmaps_.erase(bitmap);
+  }
+}
+
+void BitmapIndex::ScanKey(const Tuple &key, std::vector<RID> *result, Transaction *transaction) {
+  for (uint64_t value : GetBitmap({key}).ToVector()) {
+    result->push_back(ToRid(value));
+  }
+}
+
+RoaringBitmap BitmapIndex::GetBitmap(const std::vector<Tuple> &keys) {
+  RoaringBitmap result;
+  std::shared_lock lock(latch_);
+  for (const Tuple &key : keys) {
+    auto bitmap = bitmaps_.find(KeyOf(key));
+    if (bitmap != bitmaps_.end()) {
+      result.UnionWith(bitmap->second);
+    }
+  }
+  return result;
+}
+
+size_t BitmapIndex::GetKeyCount() {
+  std::shared_lock lock(latch_);
+  return bitmaps_.size();
+}
+
+size_t BitmapIndex::GetMemoryUsage() {
+  std::shared_lock lock(latch_);
+  size_t bytes = 0;
+  for (const auto &[key, bitmap] : bitmaps_) {
+    bytes += key.size() + bitmap.GetMemoryUsage();
+  }
+  return bytes;
+}
+
+}  // namespace bustub
@@ -2,29 +2,228 @@
  * index_iterator.cpp
  */
 #include <cassert>
+#include <thread>  // NOLINT
+#include <utility>
 
+#include "common/exception.h"
 #include "storage/index/index_iterator.h"
 
 namespace bustub {
 
-/*
- * NOTE: you can change the destructor/constructor method here
- * set your own input parameters
- */
 INDEX_TEMPLATE_ARGUMENTS
-INDEXITERATOR_TYPE::IndexIterator() = default;
+INDEXITERATOR_TYPE::IndexIterator(BufferPoolManager *buffer_pool_manager, Page *page, int index)
+    : buffer_pool_manager_(buffer_pool_manager),
+      page_(page),
+      leaf_(reinterpret_cast<LeafPage *>(page->GetData())),
+      index_(index) {
+  PrefetchNextLeaf();
+  SkipExhaustedLeaves();
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+INDEXITERATOR_TYPE::~IndexIterator() { Release(); }
+
+INDEX_TEMPLATE_ARGUMENTS
+INDEXITERATOR_TYPE::IndexIterator(IndexIterator &&other) noexcept
+    : buffer_pool_manager_(other.buffer_pool_manager_), page_(other.page_), leaf_(other.leaf_), index_(other.index_) {
+  other.page_ = nullptr;
+  other.leaf_ = nullptr;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+INDEXITERATOR_TYPE &INDEXITERATOR_TYPE::operator=(IndexIterator &&other) noexcept {
+  if (this != &other) {
+    Release();
+    buffer_pool_manager_ = other.buffer_pool_manager_;
+    page_ = other.page_;
+    leaf_ = other.leaf_;
+    index_ = other.index_;
+    other.page_ = nullptr;
+    other.leaf_ = nullptr;
+  }
+  return *this;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+bool INDEXITERATOR_TYPE::isEnd() { return page_ == nullptr; }
+
+INDEX_TEMPLATE_ARGUMENTS
+const MappingType &INDEXITERATOR_TYPE::operator*() {
+  assert(page_ != nullptr);
+  item_ = leaf_->GetItem(index_);
+  return item_;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+INDEXITERATOR_TYPE &INDEXITERATOR_TYPE::operator++() {
+  assert(page_ != nullptr);
+  ++index_;
+  SkipExhaustedLeaves();
+  return *this;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+bool INDEXITERATOR_TYPE::NextBatch(std::vector<MappingType> *batch) {
+  batch->clear();
+  if (page_ == nullptr) {
+    return false;
+  }
+  batch->reserve(leaf_->GetSize() - index_);
+  for (; index_ < leaf_->GetSize(); ++index_) {
+    batch->push_back(leaf_->GetItem(index_));
+  }
+  SkipExhaustedLeaves();
+  return true;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+bool INDEXITERATOR_TYPE::SeekInLeaf(const KeyType &key, const KeyComparator &comparator) {
+  if (page_ == nullptr || comparator(key, leaf_->KeyAt(leaf_->GetSize() - 1)) > 0) {
+    return false;
+  }
+  index_ = leaf_->KeyIndex(key, comparator);
+  return true;
+}
 
 INDEX_TEMPLATE_ARGUMENTS
-INDEXITERATOR_TYPE::~IndexIterator() = default;
+void INDEXITERATOR_TYPE::SkipExhaustedLeaves() {
+  while (page_ != nullptr && index_ >= leaf_->GetSize()) {
+    page_id_t next_page_id = leaf_->GetNextPageId();
+    Page *next_page = nullptr;
+    if (next_page_id != INVALID_PAGE_ID) {
+      next_page = buffer_pool_manager_->FetchPage(next_page_id);
+      if (next_page == nullptr) {
+        throw Exception(ExceptionType::OUT_OF_MEMORY, "cannot fetch the next leaf page");
+      }
+      // latch the next leaf before letting go of this one, so it cannot be merged away in between
+      next_page->RLatch();
+    }
+    Release();
+    page_ = next_page;
+    leaf_ = next_page == nullptr ? nullptr : reinterpret_cast<LeafPage *>(next_page->GetData());
+    index_ = 0;
+    PrefetchNextLeaf();
+  }
+}
 
 INDEX_TEMPLATE_ARGUMENTS
-bool INDEXITERATOR_TYPE::isEnd() { throw std::runtime_error("unimplemented"); }
+void INDEXITERATOR_TYPE::PrefetchNextLeaf() {
+  if (page_ != nullptr && leaf_->GetNextPageId() != INVALID_PAGE_ID) {
+    buffer_pool_manager_->PrefetchPages({leaf_->GetNextPageId()});
+  }
+}
 
 INDEX_TEMPLATE_ARGUMENTS
-const MappingType &INDEXITERATOR_TYPE::operator*() { throw std::runtime_error("unimplemented"); }
+void INDEXITERATOR_TYPE::Release() {
+  if (page_ != nullptr) {
+    page_->RUnlatch();
+    buffer_pool_manager_->UnpinPage(page_->GetPageId(), false);
+    page_ = nullptr;
+    leaf_ = nullptr;
+  }
+}
 
 INDEX_TEMPLATE_ARGUMENTS
-INDEXITERATOR_TYPE &INDEXITERATOR_TYPE::operator++() { throw std::runtime_error("unimplemented"); }
+REVERSE_INDEXITERATOR_TYPE::ReverseIndexIterator(BufferPoolManager *buffer_pool_manager,
+                                                 FindPairBefore find_pair_before, Page *page, int index)
+    : buffer_pool_manager_(buffer_pool_manager),
+      find_pair_before_(std::move(find_pair_before)),
+      page_(page),
+      leaf_(reinterpret_cast<LeafPage *>(page->GetData())),
+      index_(index) {
+  SkipExhaustedLeaves();
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+REVERSE_INDEXITERATOR_TYPE::~ReverseIndexIterator() { Release(); }
+
+INDEX_TEMPLATE_ARGUMENTS
+REVERSE_INDEXITERATOR_TYPE::ReverseIndexIterator(ReverseIndexIterator &&other) noexcept
+    : buffer_pool_manager_(other.buffer_pool_manager_),
+      find_pair_before_(std::move(other.find_pair_before_)),
+      page_(other.page_),
+      leaf_(other.leaf_),
+      index_(other.index_) {
+  other.page_ = nullptr;
+  other.leaf_ = nullptr;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+REVERSE_INDEXITERATOR_TYPE &REVERSE_INDEXITERATOR_TYPE::operator=(ReverseIndexIterator &&other) noexcept {
+  if (this != &other) {
+    Release();
+    buffer_pool_manager_ = other.buffer_pool_manager_;
+    find_pair_before_ = std::move(other.find_pair_before_);
+    page_ = other.page_;
+    leaf_ = other.leaf_;
+    index_ = other.index_;
+    other.page_ = nullptr;
+    other.leaf_ = nullptr;
+  }
+  return *this;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+const MappingType &REVERSE_INDEXITERATOR_TYPE::operator*() {
+  assert(page_ != nullptr);
+  item_ = leaf_->GetItem(index_);
+  return item_;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+REVERSE_INDEXITERATOR_TYPE &REVERSE_INDEXITERATOR_TYPE::operator++() {
+  assert(page_ != nullptr);
+  --index_;
+  SkipExhaustedLeaves();
+  return *this;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void REVERSE_INDEXITERATOR_TYPE::SkipExhaustedLeaves() {
+  while (page_ != nullptr && index_ < 0) {
+    page_id_t prev_page_id = leaf_->GetPrevPageId();
+    if (prev_page_id == INVALID_PAGE_ID || leaf_->GetSize() == 0) {
+      Release();
+      return;
+    }
+    // a writer that merges the previous leaf away has to latch this one to relink the leaf after it, so the previous
+    // leaf is still there for as long as this one stays latched
+    Page *prev_page = buffer_pool_manager_->FetchPage(prev_page_id);
+    if (prev_page == nullptr) {
+      throw Exception(ExceptionType::OUT_OF_MEMORY, "cannot fetch the previous leaf page");
+    }
+    auto *prev_leaf = reinterpret_cast<LeafPage *>(prev_page->GetData());
+    if (prev_page->TryRLatch()) {
+      if (prev_leaf->GetNextPageId() == page_->GetPageId()) {
+        Release();
+        page_ = prev_page;
+        leaf_ = prev_leaf;
+        index_ = leaf_->GetSize() - 1;
+        buffer_pool_manager_->PrefetchPages({leaf_->GetPrevPageId()});
+        continue;
+      }
+      prev_page->RUnlatch();
+    }
+    buffer_pool_manager_->UnpinPage(prev_page_id, false);
+
+    // the previous leaf is busy, or was split in the meantime: start over from the root, holding nothing
+    KeyType first_key = leaf_->KeyAt(0);
+    Release();
+    std::this_thread::yield();
+    page_ = find_pair_before_(first_key, &index_);
+    leaf_ = page_ == nullptr ? nullptr : reinterpret_cast<LeafPage *>(page_->GetData());
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void REVERSE_INDEXITERATOR_TYPE::Release() {
+  if (page_ != nullptr) {
+    page_->RUnlatch();
+    buffer_pool_manager_->UnpinPage(page_->GetPageId(), false);
+    page_ = nullptr;
+    leaf_ = nullptr;
+  }
+}
 
 template class IndexIterator<GenericKey<4>, RID, GenericComparator<4>>;
 
@@ -36,4 +235,13 @@ template class IndexIterator<GenericKey<32>, RID, GenericComparator<32>>;
 
 template class IndexIterator<GenericKey<64>, RID, GenericComparator<64>>;
 
+template class ReverseIndexIterator<GenericKey<4>, RID, GenericComparator<4>>;
+template class ReverseIndexIterator<GenericKey<8>, RID, GenericComparator<8>>;
+template class ReverseIndexIterator<GenericKey<16>, RID, GenericComparator<16>>;
+template class ReverseIndexIterator<GenericKey<32>, RID, GenericComparator<32>>;
+template class ReverseIndexIterator<GenericKey<64>, RID, GenericComparator<64>>;
+
+template class IndexIterator<GenericKey<8>, InlineRow<256>, GenericComparator<8>>;
+template class ReverseIndexIterator<GenericKey<8>, InlineRow<256>, GenericComparator<8>>;
+
 }  // namespace bustub
@@ -1,3 +1,4 @@
+#include <utility>
 #include <vector>
 
 #include "storage/index/linear_probe_hash_table_index.h"
@@ -10,14 +11,24 @@ template <typename KeyType, typename ValueType, typename KeyComparator>
 HASH_TABLE_INDEX_TYPE::LinearProbeHashTableIndex(IndexMetadata *metadata, BufferPoolManager *buffer_pool_manager,
                                                  size_t num_buckets, const HashFunction<KeyType> &hash_fn)
     : Index(metadata),
-      comparator_(metadata->GetKeySchema()),
+      comparator_(metadata->GetKeySchema(), false, metadata->HasNormalizedKeys()),
       container_(metadata->GetName(), buffer_pool_manager, comparator_, num_buckets, hash_fn) {}
 
+template <typename KeyType, typename ValueType, typename KeyComparator>
+KeyType HASH_TABLE_INDEX_TYPE::MakeKey(const Tuple &key) const {
+  KeyType index_key;
+  if (GetMetadata()->HasNormalizedKeys()) {
+    index_key.SetFromKeyNormalized(key, GetKeySchema());
+  } else {
+    index_key.SetFromKey(key);
+  }
+  return index_key;
+}
+
 template <typename KeyType, typename ValueType, typename KeyComparator>
 void HASH_TABLE_INDEX_TYPE::InsertEntry(const Tuple &key, RID rid, Transaction *transaction) {
   // construct insert index key
-  KeyType index_key;
-  index_key.SetFromKey(key);
+  KeyType index_key = MakeKey(key);
 
   container_.Insert(transaction, index_key, rid);
 }
@@ -25,8 +36,7 @@ void HASH_TABLE_INDEX_TYPE::InsertEntry(const Tuple &key, RID rid, Transaction *
 template <typename KeyType, typename ValueType, typename KeyComparator>
 void HASH_TABLE_INDEX_TYPE::DeleteEntry(const Tuple &key, RID rid, Transaction *transaction) {
   // construct delete index key
-  KeyType index_key;
-  index_key.SetFromKey(key);
+  KeyType index_key = MakeKey(key);
 
   container_.Remove(transaction, index_key, rid);
 }
@@ -34,11 +44,35 @@ void HASH_TABLE_INDEX_TYPE::DeleteEntry(const Tuple &key, RID rid, Transaction *
 template <typename KeyType, typename ValueType, typename KeyComparator>
 void HASH_TABLE_INDEX_TYPE::ScanKey(const Tuple &key, std::vector<RID> *result, Transaction *transaction) {
   // construct scan index key
-  KeyType index_key;
-  index_key.SetFromKey(key);
+  KeyType index_key = MakeKey(key);
 
   container_.GetValue(transaction, index_key, result);
 }
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+void HASH_TABLE_INDEX_TYPE::ScanKeys(const std::vector<Tuple> &keys, std::vector<std::vector<RID>> *results,
+                                     Transaction *transaction) {
+  std::vector<KeyType> index_keys(keys.size());
+  for (size_t i = 0; i < keys.size(); ++i) {
+    index_keys[i] = MakeKey(keys[i]);
+  }
+  results->assign(keys.size(), {});
+  container_.GetValues(transaction, index_keys, results);
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+size_t HASH_TABLE_INDEX_TYPE::BulkInsertEntries(const std::vector<std::pair<Tuple, RID>> &entries,
+                                                Transaction *transaction) {
+  // construct all index keys, then hand them to the container in one go
+  std::vector<std::pair<KeyType, ValueType>> pairs(entries.size());
+  for (size_t i = 0; i < entries.size(); ++i) {
+    pairs[i].first = MakeKey(entries[i].first);
+    pairs[i].second = entries[i].second;
+  }
+
+  return container_.BulkInsert(transaction, pairs);
+}
+
 template class LinearProbeHashTableIndex<GenericKey<4>, RID, GenericComparator<4>>;
 template class LinearProbeHashTableIndex<GenericKey<8>, RID, GenericComparator<8>>;
 template class LinearProbeHashTableIndex<GenericKey<16>, RID, GenericComparator<16>>;
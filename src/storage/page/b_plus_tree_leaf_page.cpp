@@ -9,7 +9,10 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <algorithm>
+#include <cstring>
 #include <sstream>
+#include <vector>
 
 #include "common/exception.h"
 #include "common/rid.h"
@@ -27,32 +30,61 @@ namespace bustub {
  * next page id and set max size
  */
 INDEX_TEMPLATE_ARGUMENTS
-void B_PLUS_TREE_LEAF_PAGE_TYPE::Init(page_id_t page_id, page_id_t parent_id, int max_size) {}
+void B_PLUS_TREE_LEAF_PAGE_TYPE::Init(page_id_t page_id, page_id_t parent_id, int max_size) {
+  SetPageType(IndexPageType::LEAF_PAGE);
+  SetSize(0);
+  SetPageId(page_id);
+  SetParentPageId(parent_id);
+  SetNextPageId(INVALID_PAGE_ID);
+  SetPrevPageId(INVALID_PAGE_ID);
+  SetMaxSize(max_size);
+  prefix_size_ = sizeof(KeyType);
+  suffix_size_ = sizeof(KeyType);
+}
 
 /**
- * Helper methods to set/get next page id
+ * Helper methods to set/get next page id and prev page id
  */
 INDEX_TEMPLATE_ARGUMENTS
-page_id_t B_PLUS_TREE_LEAF_PAGE_TYPE::GetNextPageId() const { return INVALID_PAGE_ID; }
+page_id_t B_PLUS_TREE_LEAF_PAGE_TYPE::GetNextPageId() const { return next_page_id_; }
+
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_LEAF_PAGE_TYPE::SetNextPageId(page_id_t next_page_id) { next_page_id_ = next_page_id; }
+
+INDEX_TEMPLATE_ARGUMENTS
+page_id_t B_PLUS_TREE_LEAF_PAGE_TYPE::GetPrevPageId() const { return prev_page_id_; }
 
 INDEX_TEMPLATE_ARGUMENTS
-void B_PLUS_TREE_LEAF_PAGE_TYPE::SetNextPageId(page_id_t next_page_id) {}
+void B_PLUS_TREE_LEAF_PAGE_TYPE::SetPrevPageId(page_id_t prev_page_id) { prev_page_id_ = prev_page_id; }
 
 /**
  * Helper method to find the first index i so that array[i].first >= key
  * NOTE: This method is only used when generating index iterator
  */
 INDEX_TEMPLATE_ARGUMENTS
-int B_PLUS_TREE_LEAF_PAGE_TYPE::KeyIndex(const KeyType &key, const KeyComparator &comparator) const { return 0; }
+int B_PLUS_TREE_LEAF_PAGE_TYPE::KeyIndex(const KeyType &key, const KeyComparator &comparator) const {
+  int lo = 0;
+  int hi = GetSize();
+  while (lo < hi) {
+    int mid = lo + (hi - lo) / 2;
+    if (comparator(KeyAt(mid), key) < 0) {
+      lo = mid + 1;
+    } else {
+      hi = mid;
+    }
+  }
+  return lo;
+}
 
 /*
  * Helper method to find and return the key associated with input "index"(a.k.a
  * array offset)
+ * The key is put back together from the common bytes and those of its slot.
  */
 INDEX_TEMPLATE_ARGUMENTS
 KeyType B_PLUS_TREE_LEAF_PAGE_TYPE::KeyAt(int index) const {
-  // replace with your own code
-  KeyType key{};
+  KeyType key = common_key_;
+  memcpy(reinterpret_cast<char *>(&key) + prefix_size_, SlotAt(index), KeyWidth(prefix_size_, suffix_size_));
   return key;
 }
 
@@ -61,9 +93,160 @@ KeyType B_PLUS_TREE_LEAF_PAGE_TYPE::KeyAt(int index) const {
  * "index"(a.k.a array offset)
  */
 INDEX_TEMPLATE_ARGUMENTS
-const MappingType &B_PLUS_TREE_LEAF_PAGE_TYPE::GetItem(int index) {
-  // replace with your own code
-  return array[0];
+MappingType B_PLUS_TREE_LEAF_PAGE_TYPE::GetItem(int index) const {
+  MappingType item;
+  item.first = KeyAt(index);
+  memcpy(&item.second, SlotAt(index) + KeyWidth(prefix_size_, suffix_size_), sizeof(ValueType));
+  return item;
+}
+
+/*
+ * A key that shares fewer bytes with the others than they do among
+ * themselves widens every slot, so whether it fits depends on the key.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+bool B_PLUS_TREE_LEAF_PAGE_TYPE::HasRoomFor(const KeyType &key) const {
+  if (GetSize() == 0) {
+    return true;
+  }
+  int prefix_size = prefix_size_;
+  int suffix_size = suffix_size_;
+  NarrowCommonBytes(common_key_, key, &prefix_size, &suffix_size);
+  return Fits(GetSize() + 1, prefix_size, suffix_size);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+bool B_PLUS_TREE_LEAF_PAGE_TYPE::HasRoomForAll(const BPlusTreeLeafPage *other) const {
+  if (other->GetSize() == 0) {
+    return true;
+  }
+  if (GetSize() == 0) {
+    return Fits(other->GetSize(), other->prefix_size_, other->suffix_size_);
+  }
+  // the other page's keys all share its common bytes, so those are what decides
+  int prefix_size = std::min(prefix_size_, other->prefix_size_);
+  int suffix_size = std::min(suffix_size_, other->suffix_size_);
+  NarrowCommonBytes(common_key_, other->common_key_, &prefix_size, &suffix_size);
+  return Fits(GetSize() + other->GetSize(), prefix_size, suffix_size);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+int B_PLUS_TREE_LEAF_PAGE_TYPE::MaxSizeFor(const MappingType *items, int size) {
+  int prefix_size = sizeof(KeyType);
+  int suffix_size = sizeof(KeyType);
+  for (int i = 1; i < size; ++i) {
+    NarrowCommonBytes(items[0].first, items[i].first, &prefix_size, &suffix_size);
+  }
+  return LEAF_PAGE_SLOT_SPACE / (KeyWidth(prefix_size, suffix_size) + sizeof(ValueType));
+}
+
+/*****************************************************************************
+ * COMPRESSION
+ *****************************************************************************/
+/*
+ * The bytes a slot holds of its key; a single key shares all of them with
+ * itself, and then the common prefix and suffix overlap.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+int B_PLUS_TREE_LEAF_PAGE_TYPE::KeyWidth(int prefix_size, int suffix_size) {
+  return std::max(0, static_cast<int>(sizeof(KeyType)) - prefix_size - suffix_size);
+}
+
+/*
+ * Cut the common prefix and suffix back to the bytes the key shares with the
+ * common key.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_LEAF_PAGE_TYPE::NarrowCommonBytes(const KeyType &common_key, const KeyType &key, int *prefix_size,
+                                                   int *suffix_size) {
+  const auto *common = reinterpret_cast<const char *>(&common_key);
+  const auto *bytes = reinterpret_cast<const char *>(&key);
+  int prefix = 0;
+  while (prefix < *prefix_size && common[prefix] == bytes[prefix]) {
+    ++prefix;
+  }
+  int suffix = 0;
+  int last = sizeof(KeyType) - 1;
+  while (suffix < *suffix_size && common[last - suffix] == bytes[last - suffix]) {
+    ++suffix;
+  }
+  *prefix_size = prefix;
+  *suffix_size = suffix;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+bool B_PLUS_TREE_LEAF_PAGE_TYPE::Fits(int size, int prefix_size, int suffix_size) {
+  return size * (KeyWidth(prefix_size, suffix_size) + sizeof(ValueType)) <= LEAF_PAGE_SLOT_SPACE;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_LEAF_PAGE_TYPE::WriteSlot(int index, const KeyType &key, const ValueType &value) {
+  int width = KeyWidth(prefix_size_, suffix_size_);
+  char *slot = SlotAt(index);
+  memcpy(slot, reinterpret_cast<const char *>(&key) + prefix_size_, width);
+  memcpy(slot + width, &value, sizeof(ValueType));
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_LEAF_PAGE_TYPE::PrepareFor(const KeyType &key) {
+  if (GetSize() == 0) {
+    common_key_ = key;
+    prefix_size_ = sizeof(KeyType);
+    suffix_size_ = sizeof(KeyType);
+    return;
+  }
+  int prefix_size = prefix_size_;
+  int suffix_size = suffix_size_;
+  NarrowCommonBytes(common_key_, key, &prefix_size, &suffix_size);
+  Reencode(prefix_size, suffix_size);
+}
+
+/*
+ * Slots only move up when they widen and down when they shrink, so going
+ * through them from the far end in the first case and from the front in the
+ * second never overwrites one that has not been moved yet.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_LEAF_PAGE_TYPE::Reencode(int prefix_size, int suffix_size) {
+  int old_width = KeyWidth(prefix_size_, suffix_size_);
+  int new_width = KeyWidth(prefix_size, suffix_size);
+  if (old_width == new_width && prefix_size == prefix_size_) {
+    suffix_size_ = suffix_size;
+    return;
+  }
+  auto move_slot = [&](int index) {
+    MappingType item = GetItem(index);
+    char *slot = slots_ + index * (new_width + sizeof(ValueType));
+    memcpy(slot, reinterpret_cast<const char *>(&item.first) + prefix_size, new_width);
+    memcpy(slot + new_width, &item.second, sizeof(ValueType));
+  };
+  if (new_width > old_width) {
+    for (int i = GetSize() - 1; i >= 0; --i) {
+      move_slot(i);
+    }
+  } else {
+    for (int i = 0; i < GetSize(); ++i) {
+      move_slot(i);
+    }
+  }
+  prefix_size_ = prefix_size;
+  suffix_size_ = suffix_size;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_LEAF_PAGE_TYPE::Compact() {
+  if (GetSize() == 0) {
+    return;
+  }
+  KeyType first_key = KeyAt(0);
+  int prefix_size = sizeof(KeyType);
+  int suffix_size = sizeof(KeyType);
+  for (int i = 1; i < GetSize(); ++i) {
+    NarrowCommonBytes(first_key, KeyAt(i), &prefix_size, &suffix_size);
+  }
+  Reencode(prefix_size, suffix_size);
+  // the old common key only agrees with the keys on the bytes they used to have in common
+  common_key_ = first_key;
 }
 
 /*****************************************************************************
@@ -71,11 +254,21 @@ const MappingType &B_PLUS_TREE_LEAF_PAGE_TYPE::GetItem(int index) {
  *****************************************************************************/
 /*
  * Insert key & value pair into leaf page ordered by key
+ * A key that is already in the page is left alone. The caller makes sure that
+ * the key fits, see HasRoomFor.
  * @return  page size after insertion
  */
 INDEX_TEMPLATE_ARGUMENTS
 int B_PLUS_TREE_LEAF_PAGE_TYPE::Insert(const KeyType &key, const ValueType &value, const KeyComparator &comparator) {
-  return 0;
+  int index = KeyIndex(key, comparator);
+  if (index < GetSize() && comparator(KeyAt(index), key) == 0) {
+    return GetSize();
+  }
+  PrepareFor(key);
+  memmove(SlotAt(index + 1), SlotAt(index), SlotAt(GetSize()) - SlotAt(index));
+  WriteSlot(index, key, value);
+  IncreaseSize(1);
+  return GetSize();
 }
 
 /*****************************************************************************
@@ -83,15 +276,52 @@ int B_PLUS_TREE_LEAF_PAGE_TYPE::Insert(const KeyType &key, const ValueType &valu
  *****************************************************************************/
 /*
  * Remove half of key & value pairs from this page to "recipient" page
+ * The upper half moves, and this page keeps the extra pair of an odd size.
+ * The caller links the recipient into the leaf chain, both ways. Both halves are
+ * compressed again, as their keys may well have more bytes in common.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_LEAF_PAGE_TYPE::MoveHalfTo(BPlusTreeLeafPage *recipient) { MoveTailTo(recipient, GetSize() / 2); }
+
+/*
+ * Remove the last count key & value pairs from this page to "recipient" page,
+ * the way MoveHalfTo does.
  */
 INDEX_TEMPLATE_ARGUMENTS
-void B_PLUS_TREE_LEAF_PAGE_TYPE::MoveHalfTo(BPlusTreeLeafPage *recipient) {}
+void B_PLUS_TREE_LEAF_PAGE_TYPE::MoveTailTo(BPlusTreeLeafPage *recipient, int count) {
+  int keep = GetSize() - count;
+  std::vector<MappingType> items;
+  items.reserve(GetSize() - keep);
+  for (int i = keep; i < GetSize(); ++i) {
+    items.push_back(GetItem(i));
+  }
+  recipient->CopyNFrom(items.data(), items.size());
+  SetSize(keep);
+  Compact();
+}
 
 /*
  * Copy starting from items, and copy {size} number of elements into me.
  */
 INDEX_TEMPLATE_ARGUMENTS
-void B_PLUS_TREE_LEAF_PAGE_TYPE::CopyNFrom(MappingType *items, int size) {}
+void B_PLUS_TREE_LEAF_PAGE_TYPE::CopyNFrom(const MappingType *items, int size) {
+  if (size == 0) {
+    return;
+  }
+  if (GetSize() == 0) {
+    common_key_ = items[0].first;
+  }
+  int prefix_size = GetSize() == 0 ? sizeof(KeyType) : prefix_size_;
+  int suffix_size = GetSize() == 0 ? sizeof(KeyType) : suffix_size_;
+  for (int i = 0; i < size; ++i) {
+    NarrowCommonBytes(common_key_, items[i].first, &prefix_size, &suffix_size);
+  }
+  Reencode(prefix_size, suffix_size);
+  for (int i = 0; i < size; ++i) {
+    WriteSlot(GetSize() + i, items[i].first, items[i].second);
+  }
+  IncreaseSize(size);
+}
 
 /*****************************************************************************
  * LOOKUP
@@ -103,7 +333,12 @@ void B_PLUS_TREE_LEAF_PAGE_TYPE::CopyNFrom(MappingType *items, int size) {}
  */
 INDEX_TEMPLATE_ARGUMENTS
 bool B_PLUS_TREE_LEAF_PAGE_TYPE::Lookup(const KeyType &key, ValueType *value, const KeyComparator &comparator) const {
-  return false;
+  int index = KeyIndex(key, comparator);
+  if (index == GetSize() || comparator(KeyAt(index), key) != 0) {
+    return false;
+  }
+  *value = GetItem(index).second;
+  return true;
 }
 
 /*****************************************************************************
@@ -116,7 +351,15 @@ bool B_PLUS_TREE_LEAF_PAGE_TYPE::Lookup(const KeyType &key, ValueType *value, co
  * @return   page size after deletion
  */
 INDEX_TEMPLATE_ARGUMENTS
-int B_PLUS_TREE_LEAF_PAGE_TYPE::RemoveAndDeleteRecord(const KeyType &key, const KeyComparator &comparator) { return 0; }
+int B_PLUS_TREE_LEAF_PAGE_TYPE::RemoveAndDeleteRecord(const KeyType &key, const KeyComparator &comparator) {
+  int index = KeyIndex(key, comparator);
+  if (index == GetSize() || comparator(KeyAt(index), key) != 0) {
+    return GetSize();
+  }
+  memmove(SlotAt(index), SlotAt(index + 1), SlotAt(GetSize()) - SlotAt(index + 1));
+  IncreaseSize(-1);
+  return GetSize();
+}
 
 /*****************************************************************************
  * MERGE
@@ -124,9 +367,20 @@ int B_PLUS_TREE_LEAF_PAGE_TYPE::RemoveAndDeleteRecord(const KeyType &key, const
 /*
  * Remove all of key & value pairs from this page to "recipient" page. Don't forget
  * to update the next_page id in the sibling page
+ * The recipient is the left sibling of this page, and has room for the pairs,
+ * see HasRoomForAll. The caller points the next page back at the recipient.
  */
 INDEX_TEMPLATE_ARGUMENTS
-void B_PLUS_TREE_LEAF_PAGE_TYPE::MoveAllTo(BPlusTreeLeafPage *recipient) {}
+void B_PLUS_TREE_LEAF_PAGE_TYPE::MoveAllTo(BPlusTreeLeafPage *recipient) {
+  std::vector<MappingType> items;
+  items.reserve(GetSize());
+  for (int i = 0; i < GetSize(); ++i) {
+    items.push_back(GetItem(i));
+  }
+  recipient->CopyNFrom(items.data(), items.size());
+  recipient->SetNextPageId(GetNextPageId());
+  SetSize(0);
+}
 
 /*****************************************************************************
  * REDISTRIBUTE
@@ -135,29 +389,57 @@ void B_PLUS_TREE_LEAF_PAGE_TYPE::MoveAllTo(BPlusTreeLeafPage *recipient) {}
  * Remove the first key & value pair from this page to "recipient" page.
  */
 INDEX_TEMPLATE_ARGUMENTS
-void B_PLUS_TREE_LEAF_PAGE_TYPE::MoveFirstToEndOf(BPlusTreeLeafPage *recipient) {}
+void B_PLUS_TREE_LEAF_PAGE_TYPE::MoveFirstToEndOf(BPlusTreeLeafPage *recipient) {
+  recipient->CopyLastFrom(GetItem(0));
+  memmove(SlotAt(0), SlotAt(1), SlotAt(GetSize()) - SlotAt(1));
+  IncreaseSize(-1);
+}
 
 /*
  * Copy the item into the end of my item list. (Append item to my array)
  */
 INDEX_TEMPLATE_ARGUMENTS
-void B_PLUS_TREE_LEAF_PAGE_TYPE::CopyLastFrom(const MappingType &item) {}
+void B_PLUS_TREE_LEAF_PAGE_TYPE::CopyLastFrom(const MappingType &item) {
+  PrepareFor(item.first);
+  WriteSlot(GetSize(), item.first, item.second);
+  IncreaseSize(1);
+}
 
 /*
  * Remove the last key & value pair from this page to "recipient" page.
  */
 INDEX_TEMPLATE_ARGUMENTS
-void B_PLUS_TREE_LEAF_PAGE_TYPE::MoveLastToFrontOf(BPlusTreeLeafPage *recipient) {}
+void B_PLUS_TREE_LEAF_PAGE_TYPE::MoveLastToFrontOf(BPlusTreeLeafPage *recipient) {
+  recipient->CopyFirstFrom(GetItem(GetSize() - 1));
+  IncreaseSize(-1);
+}
 
 /*
  * Insert item at the front of my items. Move items accordingly.
  */
 INDEX_TEMPLATE_ARGUMENTS
-void B_PLUS_TREE_LEAF_PAGE_TYPE::CopyFirstFrom(const MappingType &item) {}
+void B_PLUS_TREE_LEAF_PAGE_TYPE::CopyFirstFrom(const MappingType &item) {
+  PrepareFor(item.first);
+  memmove(SlotAt(1), SlotAt(0), SlotAt(GetSize()) - SlotAt(0));
+  WriteSlot(0, item.first, item.second);
+  IncreaseSize(1);
+}
+
+/*****************************************************************************
+ * BULK LOAD
+ *****************************************************************************/
+/*
+ * Append items to the end of my items; they are sorted, and sort after every
+ * key stored here already.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_LEAF_PAGE_TYPE::Append(const MappingType *items, int size) { CopyNFrom(items, size); }
 
 template class BPlusTreeLeafPage<GenericKey<4>, RID, GenericComparator<4>>;
 template class BPlusTreeLeafPage<GenericKey<8>, RID, GenericComparator<8>>;
 template class BPlusTreeLeafPage<GenericKey<16>, RID, GenericComparator<16>>;
 template class BPlusTreeLeafPage<GenericKey<32>, RID, GenericComparator<32>>;
 template class BPlusTreeLeafPage<GenericKey<64>, RID, GenericComparator<64>>;
+
+template class BPlusTreeLeafPage<GenericKey<8>, InlineRow<256>, GenericComparator<8>>;
 }  // namespace bustub
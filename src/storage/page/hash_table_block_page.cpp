@@ -11,6 +11,11 @@
 //===----------------------------------------------------------------------===//
 
 #include "storage/page/hash_table_block_page.h"
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
 #include "storage/index/generic_key.h"
 
 namespace bustub {
@@ -32,28 +37,59 @@ ValueType HASH_TABLE_BLOCK_TYPE::ValueAt(slot_offset_t bucket_ind) const {
 }
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
-bool HASH_TABLE_BLOCK_TYPE::Insert(slot_offset_t bucket_ind, const KeyType &key, const ValueType &value) {
-  if (readable_[bucket_ind])
+bool HASH_TABLE_BLOCK_TYPE::Insert(slot_offset_t bucket_ind, const KeyType &key, const ValueType &value,
+                                   uint32_t hash) {
+  if (IsReadable(bucket_ind)) {
     return false;
+  }
   array_[bucket_ind] = std::make_pair(key, value);
-  occupied_[bucket_ind] = 1;
-  readable_[bucket_ind] = 1;
+  hashes_[bucket_ind] = hash;
+  control_[bucket_ind] = READABLE | Tag(hash);
   return true;
 }
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
 void HASH_TABLE_BLOCK_TYPE::Remove(slot_offset_t bucket_ind) {
-  readable_[bucket_ind] = 0;
+  if (IsReadable(bucket_ind)) {
+    control_[bucket_ind] = DELETED;
+  }
 }
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
 bool HASH_TABLE_BLOCK_TYPE::IsOccupied(slot_offset_t bucket_ind) const {
-  return occupied_[bucket_ind];
+  return control_[bucket_ind] != EMPTY;
 }
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
 bool HASH_TABLE_BLOCK_TYPE::IsReadable(slot_offset_t bucket_ind) const {
-  return readable_[bucket_ind];
+  return (control_[bucket_ind] & READABLE) != 0;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+typename HASH_TABLE_BLOCK_TYPE::GroupMatch HASH_TABLE_BLOCK_TYPE::MatchGroup(slot_offset_t bucket_ind,
+                                                                             uint8_t tag) const {
+  auto wanted = static_cast<uint8_t>(READABLE | (tag & 0x7F));
+#ifdef __SSE2__
+  __m128i group = _mm_loadu_si128(reinterpret_cast<const __m128i *>(&control_[bucket_ind]));
+  auto match = static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(group, _mm_set1_epi8(wanted))));
+  auto empty = static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(group, _mm_set1_epi8(EMPTY))));
+  auto deleted = static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(group, _mm_set1_epi8(DELETED))));
+#else
+  uint32_t match = 0;
+  uint32_t empty = 0;
+  uint32_t deleted = 0;
+  for (size_t i = 0; i < BLOCK_GROUP_SIZE; ++i) {
+    uint8_t control = control_[bucket_ind + i];
+    match |= static_cast<uint32_t>(control == wanted) << i;
+    empty |= static_cast<uint32_t>(control == EMPTY) << i;
+    deleted |= static_cast<uint32_t>(control == DELETED) << i;
+  }
+#endif
+  // the padding past the last slot reads as empty
+  uint32_t in_block = BLOCK_ARRAY_SIZE - bucket_ind >= BLOCK_GROUP_SIZE
+                          ? (uint32_t{1} << BLOCK_GROUP_SIZE) - 1
+                          : (uint32_t{1} << (BLOCK_ARRAY_SIZE - bucket_ind)) - 1;
+  return {match & in_block, empty & in_block, deleted & in_block};
 }
 
 // DO NOT REMOVE ANYTHING BELOW THIS LINE
@@ -0,0 +1,46 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// hash_table_directory_page.cpp
+//
+// Identification: src/storage/page/hash_table_directory_page.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/page/hash_table_directory_page.h"
+
+#include <cstring>
+
+#include "common/macros.h"
+
+namespace bustub {
+
+void HashTableDirectoryPage::IncrGlobalDepth() {
+  BUSTUB_ASSERT(global_depth_ < MAX_GLOBAL_DEPTH, "the directory has to fit into its page");
+  uint32_t size = Size();
+  memcpy(&local_depths_[size], &local_depths_[0], size * sizeof(local_depths_[0]));
+  memcpy(&bucket_page_ids_[size], &bucket_page_ids_[0], size * sizeof(bucket_page_ids_[0]));
+  ++global_depth_;
+}
+
+void HashTableDirectoryPage::DecrGlobalDepth() {
+  BUSTUB_ASSERT(CanShrink(), "the upper half of the directory has to be a copy of the lower half");
+  --global_depth_;
+}
+
+bool HashTableDirectoryPage::CanShrink() const {
+  if (global_depth_ == 0) {
+    return false;
+  }
+  for (uint32_t i = 0; i < Size(); ++i) {
+    if (local_depths_[i] >= global_depth_) {
+      return false;
+    }
+  }
+  return true;
+}
+
+}  // namespace bustub
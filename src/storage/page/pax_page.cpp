@@ -0,0 +1,171 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// pax_page.cpp
+//
+// Identification: src/storage/page/pax_page.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/page/pax_page.h"
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+namespace bustub {
+
+namespace {
+constexpr uint32_t MINIPAGE_ALIGNMENT = 8;
+
+uint32_t AlignUp(uint32_t offset) {
+  return (offset + MINIPAGE_ALIGNMENT - 1) / MINIPAGE_ALIGNMENT * MINIPAGE_ALIGNMENT;
+}
+}  // namespace
+
+PaxLayout PaxLayout::For(const Schema &schema) {
+  PaxLayout layout;
+  uint32_t row_size = 0;
+  uint32_t varchar_size = 0;
+  for (const Column &column : schema.GetColumns()) {
+    // a VARCHAR column's minipage holds the offsets of its values
+    layout.widths_.push_back(column.GetFixedLength());
+    row_size += column.GetFixedLength();
+    if (!column.IsInlined()) {
+      varchar_size += sizeof(uint32_t) + VARCHAR_ESTIMATE;
+    }
+  }
+
+  // a first guess that ignores the padding of the minipages, and then fewer rows until they fit
+  const uint32_t space = PAGE_SIZE - PaxPage::SIZE_PAX_PAGE_HEADER;
+  layout.capacity_ = std::max<uint32_t>(1, space * 8 / (8 * (row_size + varchar_size) + 1));
+  while (true) {
+    uint32_t offset = PaxPage::SIZE_PAX_PAGE_HEADER + (layout.capacity_ + 7) / 8;
+    layout.offsets_.clear();
+    for (uint32_t width : layout.widths_) {
+      offset = AlignUp(offset);
+      layout.offsets_.push_back(offset);
+      offset += width * layout.capacity_;
+    }
+    layout.minipages_end_ = offset;
+    if (layout.capacity_ == 1 || offset + varchar_size * layout.capacity_ <= PAGE_SIZE) {
+      break;
+    }
+    layout.capacity_--;
+  }
+  BUSTUB_ASSERT(layout.minipages_end_ <= PAGE_SIZE, "a row of the schema does not fit into a page");
+  return layout;
+}
+
+void PaxPage::Init(page_id_t page_id, page_id_t prev_page_id) {
+  memset(GetData(), 0, PAGE_SIZE);
+  memcpy(GetData(), &page_id, sizeof(page_id));
+  SetLSN(INVALID_LSN);
+  memcpy(GetData() + OFFSET_PREV_PAGE_ID, &prev_page_id, sizeof(page_id_t));
+  SetNextPageId(INVALID_PAGE_ID);
+  SetFreeSpacePointer(PAGE_SIZE);
+  SetRowCount(0);
+}
+
+bool PaxPage::InsertTuple(const Tuple &tuple, const Schema &schema, const PaxLayout &layout, RID *rid) {
+  uint32_t row = GetRowCount();
+  if (row >= layout.capacity_) {
+    return false;
+  }
+  std::vector<Value> values;
+  // the codes of the VARCHAR values the page has already, UINT32_MAX for those that have to be stored
+  std::vector<uint32_t> codes(schema.GetColumnCount(), UINT32_MAX);
+  uint32_t varchar_size = 0;
+  for (uint32_t i = 0; i < schema.GetColumnCount(); i++) {
+    values.push_back(tuple.GetValue(&schema, i));
+    if (!schema.GetColumn(i).IsInlined() && !FindCode(i, values.back(), layout, &codes[i])) {
+      uint32_t length = values.back().GetLength();
+      varchar_size += sizeof(uint32_t) + (length == BUSTUB_VALUE_NULL ? 0 : length);
+    }
+  }
+  uint32_t free_space_pointer = GetFreeSpacePointer();
+  if (free_space_pointer < layout.minipages_end_ + varchar_size) {
+    return false;
+  }
+
+  for (uint32_t i = 0; i < values.size(); i++) {
+    char *slot = GetData() + layout.offsets_[i] + row * layout.widths_[i];
+    if (schema.GetColumn(i).IsInlined()) {
+      values[i].SerializeTo(slot);
+      continue;
+    }
+    if (codes[i] == UINT32_MAX) {
+      uint32_t length = values[i].GetLength();
+      free_space_pointer -= sizeof(uint32_t) + (length == BUSTUB_VALUE_NULL ? 0 : length);
+      values[i].SerializeTo(GetData() + free_space_pointer);
+      codes[i] = free_space_pointer;
+    }
+    memcpy(slot, &codes[i], sizeof(uint32_t));
+  }
+  SetFreeSpacePointer(free_space_pointer);
+  SetRowCount(row + 1);
+  rid->Set(GetPaxPageId(), row);
+  return true;
+}
+
+bool PaxPage::MarkDelete(uint32_t row) {
+  if (row >= GetRowCount() || IsDeleted(row)) {
+    return false;
+  }
+  GetData()[SIZE_PAX_PAGE_HEADER + row / 8] |= static_cast<char>(1 << (row % 8));
+  return true;
+}
+
+Value PaxPage::GetValue(uint32_t row, uint32_t column_idx, const Schema &schema, const PaxLayout &layout) {
+  const char *slot = GetData() + layout.offsets_[column_idx] + row * layout.widths_[column_idx];
+  TypeId type = schema.GetColumn(column_idx).GetType();
+  if (schema.GetColumn(column_idx).IsInlined()) {
+    return Value::DeserializeFrom(slot, type);
+  }
+  uint32_t offset = *reinterpret_cast<const uint32_t *>(slot);
+  return Value::DeserializeFrom(GetData() + offset, type);
+}
+
+bool PaxPage::FindCode(uint32_t column_idx, const Value &value, const PaxLayout &layout, uint32_t *code) {
+  uint32_t length = value.GetLength();
+  const char *data = value.IsNull() ? nullptr : value.GetData();
+  // VARCHAR data grows down, so the rows that stored a new value are those with a code below all codes before them,
+  // and every value of the dictionary is compared once
+  uint32_t lowest = PAGE_SIZE;
+  uint32_t row_count = GetRowCount();
+  for (uint32_t row = 0; row < row_count; row++) {
+    uint32_t candidate = GetCode(row, column_idx, layout);
+    if (candidate >= lowest) {
+      continue;
+    }
+    lowest = candidate;
+    uint32_t stored_length;
+    memcpy(&stored_length, GetData() + candidate, sizeof(uint32_t));
+    if (stored_length == length &&
+        (length == BUSTUB_VALUE_NULL || memcmp(GetData() + candidate + sizeof(uint32_t), data, length) == 0)) {
+      *code = candidate;
+      return true;
+    }
+  }
+  return false;
+}
+
+bool PaxPage::GetTuple(const RID &rid, const Schema &schema, const PaxLayout &layout, Tuple *tuple) {
+  uint32_t row = rid.GetSlotNum();
+  if (rid.GetPageId() != GetPaxPageId() || row >= GetRowCount() || IsDeleted(row)) {
+    return false;
+  }
+  std::vector<Value> values;
+  values.reserve(schema.GetColumnCount());
+  for (uint32_t i = 0; i < schema.GetColumnCount(); i++) {
+    values.push_back(GetValue(row, i, schema, layout));
+  }
+  *tuple = Tuple(std::move(values), &schema);
+  tuple->SetRid(rid);
+  return true;
+}
+
+}  // namespace bustub
@@ -12,7 +12,10 @@
 
 #include "storage/page/table_page.h"
 
+#include <algorithm>
 #include <cassert>
+#include <utility>
+#include <vector>
 
 namespace bustub {
 
@@ -21,7 +24,7 @@ void TablePage::Init(page_id_t page_id, uint32_t page_size, page_id_t prev_page_
   // Set the page ID.
   memcpy(GetData(), &page_id, sizeof(page_id));
   // Log that we are creating a new page.
-  if (enable_logging) {
+  if (enable_logging && txn != nullptr) {
     LogRecord log_record =
         LogRecord(txn->GetTransactionId(), txn->GetPrevLSN(), LogRecordType::NEWPAGE, prev_page_id, page_id);
     lsn_t lsn = log_manager->AppendLogRecord(&log_record);
@@ -36,25 +39,78 @@ void TablePage::Init(page_id_t page_id, uint32_t page_size, page_id_t prev_page_
 }
 
 bool TablePage::InsertTuple(const Tuple &tuple, RID *rid, Transaction *txn, LockManager *lock_manager,
-                            LogManager *log_manager) {
+                            LogManager *log_manager, table_oid_t oid) {
+  if (!PlaceTuple(tuple, 0, rid, txn, lock_manager, oid)) {
+    return false;
+  }
+
+  // Write the log record.
+  if (enable_logging && txn != nullptr) {
+    LogRecord log_record(txn->GetTransactionId(), txn->GetPrevLSN(), LogRecordType::INSERT, *rid, tuple);
+    lsn_t lsn = log_manager->AppendLogRecord(&log_record);
+    SetLSN(lsn);
+    txn->SetPrevLSN(lsn);
+  }
+  return true;
+}
+
+size_t TablePage::InsertTuples(const std::vector<Tuple> &tuples, size_t begin, std::vector<RID> *rids,
+                               Transaction *txn, LockManager *lock_manager, LogManager *log_manager,
+                               table_oid_t oid) {
+  size_t first_rid = rids->size();
+  // the slots before the one filled last were all taken when it was searched for
+  uint32_t first_slot = 0;
+  size_t end = begin;
+  RID rid;
+  while (end < tuples.size() && PlaceTuple(tuples[end], first_slot, &rid, txn, lock_manager, oid)) {
+    rids->push_back(rid);
+    first_slot = rid.GetSlotNum() + 1;
+    end++;
+  }
+
+  // Write a single log record for all of them.
+  if (enable_logging && txn != nullptr && end > begin) {
+    std::vector<RID> batch_rids(rids->begin() + first_rid, rids->end());
+    std::vector<Tuple> batch_tuples;
+    batch_tuples.reserve(end - begin);
+    for (size_t i = begin; i < end; i++) {
+      batch_tuples.push_back(tuples[i].AsView());
+    }
+    LogRecord log_record(txn->GetTransactionId(), txn->GetPrevLSN(), std::move(batch_rids), std::move(batch_tuples));
+    lsn_t lsn = log_manager->AppendLogRecord(&log_record);
+    SetLSN(lsn);
+    txn->SetPrevLSN(lsn);
+  }
+  return end - begin;
+}
+
+bool TablePage::PlaceTuple(const Tuple &tuple, uint32_t first_slot, RID *rid, Transaction *txn,
+                           LockManager *lock_manager, table_oid_t oid) {
   BUSTUB_ASSERT(tuple.size_ > 0, "Cannot have empty tuples.");
-  // If there is not enough space, then return false.
+  // If there is not enough space, even with the holes squeezed out, then return false.
   if (GetFreeSpaceRemaining() < tuple.size_ + SIZE_TUPLE) {
-    return false;
+    if (GetFreeSpaceRemaining() + GetDeadSize() < tuple.size_ + SIZE_TUPLE) {
+      return false;
+    }
+    Compact();
+    // only empty slots are dropped, and those before first_slot are all taken
+    first_slot = std::min(first_slot, GetTupleCount());
   }
 
-  // Try to find a free slot to reuse.
+  // Try to find a free slot to reuse, whose RID no other transaction still locks.
+  bool locking = enable_logging && txn != nullptr;
   uint32_t i;
-  for (i = 0; i < GetTupleCount(); i++) {
-    // If the slot is empty, i.e. its tuple has size 0,
-    if (GetTupleSize(i) == 0) {
+  for (i = first_slot; i < GetTupleCount(); i++) {
+    // If the slot is empty, i.e. its tuple has size 0, and its RID is ours to lock,
+    if (GetTupleSize(i) == 0 && (!locking || lock_manager->LockNewTuple(txn, RID(GetTablePageId(), i), oid))) {
       // Then we break out of the loop at index i.
       break;
     }
   }
 
   // If there was no free slot left, and we cannot claim it from the free space, then we give up.
-  if (i == GetTupleCount() && GetFreeSpaceRemaining() < tuple.size_ + SIZE_TUPLE) {
+  if (i == GetTupleCount() && (GetFreeSpaceRemaining() < tuple.size_ + SIZE_TUPLE ||
+                               (locking && !lock_manager->LockNewTuple(txn, RID(GetTablePageId(), i), oid)))) {
     return false;
   }
 
@@ -70,26 +126,15 @@ bool TablePage::InsertTuple(const Tuple &tuple, RID *rid, Transaction *txn, Lock
   if (i == GetTupleCount()) {
     SetTupleCount(GetTupleCount() + 1);
   }
-
-  // Write the log record.
-  if (enable_logging) {
-    BUSTUB_ASSERT(!txn->IsSharedLocked(*rid) && !txn->IsExclusiveLocked(*rid), "A new tuple should not be locked.");
-    // Acquire an exclusive lock on the new tuple.
-    bool locked = lock_manager->LockExclusive(txn, *rid);
-    BUSTUB_ASSERT(locked, "Locking a new tuple should always work.");
-    LogRecord log_record(txn->GetTransactionId(), txn->GetPrevLSN(), LogRecordType::INSERT, *rid, tuple);
-    lsn_t lsn = log_manager->AppendLogRecord(&log_record);
-    SetLSN(lsn);
-    txn->SetPrevLSN(lsn);
-  }
   return true;
 }
 
-bool TablePage::MarkDelete(const RID &rid, Transaction *txn, LockManager *lock_manager, LogManager *log_manager) {
+bool TablePage::MarkDelete(const RID &rid, Transaction *txn, LockManager *lock_manager, LogManager *log_manager,
+                           table_oid_t oid) {
   uint32_t slot_num = rid.GetSlotNum();
   // If the slot number is invalid, abort the transaction.
   if (slot_num >= GetTupleCount()) {
-    if (enable_logging) {
+    if (enable_logging && txn != nullptr) {
       txn->SetState(TransactionState::ABORTED);
     }
     return false;
@@ -98,19 +143,19 @@ bool TablePage::MarkDelete(const RID &rid, Transaction *txn, LockManager *lock_m
   uint32_t tuple_size = GetTupleSize(slot_num);
   // If the tuple is already deleted, abort the transaction.
   if (IsDeleted(tuple_size)) {
-    if (enable_logging) {
+    if (enable_logging && txn != nullptr) {
       txn->SetState(TransactionState::ABORTED);
     }
     return false;
   }
 
-  if (enable_logging) {
+  if (enable_logging && txn != nullptr) {
     // Acquire an exclusive lock, upgrading from a shared lock if necessary.
     if (txn->IsSharedLocked(rid)) {
-      if (!lock_manager->LockUpgrade(txn, rid)) {
+      if (!lock_manager->LockUpgrade(txn, rid, oid)) {
         return false;
       }
-    } else if (!txn->IsExclusiveLocked(rid) && !lock_manager->LockExclusive(txn, rid)) {
+    } else if (!txn->IsExclusiveLocked(rid) && !lock_manager->LockExclusive(txn, rid, oid)) {
       return false;
     }
     Tuple dummy_tuple;
@@ -128,12 +173,12 @@ bool TablePage::MarkDelete(const RID &rid, Transaction *txn, LockManager *lock_m
 }
 
 bool TablePage::UpdateTuple(const Tuple &new_tuple, Tuple *old_tuple, const RID &rid, Transaction *txn,
-                            LockManager *lock_manager, LogManager *log_manager) {
+                            LockManager *lock_manager, LogManager *log_manager, table_oid_t oid) {
   BUSTUB_ASSERT(new_tuple.size_ > 0, "Cannot have empty tuples.");
   uint32_t slot_num = rid.GetSlotNum();
   // If the slot number is invalid, abort the transaction.
   if (slot_num >= GetTupleCount()) {
-    if (enable_logging) {
+    if (enable_logging && txn != nullptr) {
       txn->SetState(TransactionState::ABORTED);
     }
     return false;
@@ -141,34 +186,32 @@ bool TablePage::UpdateTuple(const Tuple &new_tuple, Tuple *old_tuple, const RID
   uint32_t tuple_size = GetTupleSize(slot_num);
   // If the tuple is deleted, abort the transaction.
   if (IsDeleted(tuple_size)) {
-    if (enable_logging) {
+    if (enable_logging && txn != nullptr) {
       txn->SetState(TransactionState::ABORTED);
     }
     return false;
   }
   // If there is not enuogh space to update, we need to update via delete followed by an insert (not enough space).
   if (GetFreeSpaceRemaining() + tuple_size < new_tuple.size_) {
-    return false;
+    if (GetFreeSpaceRemaining() + GetDeadSize() + tuple_size < new_tuple.size_) {
+      return false;
+    }
+    // there is once the holes are squeezed out, which leaves the slot of the tuple where it is
+    Compact();
   }
 
   // Copy out the old value.
   uint32_t tuple_offset = GetTupleOffsetAtSlot(slot_num);
-  old_tuple->size_ = tuple_size;
-  if (old_tuple->allocated_) {
-    delete[] old_tuple->data_;
-  }
-  old_tuple->data_ = new char[old_tuple->size_];
-  memcpy(old_tuple->data_, GetData() + tuple_offset, old_tuple->size_);
+  old_tuple->CopyData(GetData() + tuple_offset, tuple_size);
   old_tuple->rid_ = rid;
-  old_tuple->allocated_ = true;
 
-  if (enable_logging) {
+  if (enable_logging && txn != nullptr) {
     // Acquire an exclusive lock, upgrading from shared if necessary.
     if (txn->IsSharedLocked(rid)) {
-      if (!lock_manager->LockUpgrade(txn, rid)) {
+      if (!lock_manager->LockUpgrade(txn, rid, oid)) {
         return false;
       }
-    } else if (!txn->IsExclusiveLocked(rid) && !lock_manager->LockExclusive(txn, rid)) {
+    } else if (!txn->IsExclusiveLocked(rid) && !lock_manager->LockExclusive(txn, rid, oid)) {
       return false;
     }
     LogRecord log_record(txn->GetTransactionId(), txn->GetPrevLSN(), LogRecordType::UPDATE, rid, *old_tuple, new_tuple);
@@ -197,7 +240,7 @@ bool TablePage::UpdateTuple(const Tuple &new_tuple, Tuple *old_tuple, const RID
   return true;
 }
 
-void TablePage::ApplyDelete(const RID &rid, Transaction *txn, LogManager *log_manager) {
+void TablePage::ApplyDelete(const RID &rid, Transaction *txn, LogManager *log_manager, Tuple *deleted) {
   uint32_t slot_num = rid.GetSlotNum();
   BUSTUB_ASSERT(slot_num < GetTupleCount(), "Cannot have more slots than tuples.");
 
@@ -209,44 +252,80 @@ void TablePage::ApplyDelete(const RID &rid, Transaction *txn, LogManager *log_ma
   }
   // Otherwise we are rolling back an insert.
 
-  // We need to copy out the deleted tuple for undo purposes.
-  Tuple delete_tuple;
-  delete_tuple.size_ = tuple_size;
-  delete_tuple.data_ = new char[delete_tuple.size_];
-  memcpy(delete_tuple.data_, GetData() + tuple_offset, delete_tuple.size_);
-  delete_tuple.rid_ = rid;
-  delete_tuple.allocated_ = true;
-
-  if (enable_logging) {
+  if (enable_logging && txn != nullptr) {
     BUSTUB_ASSERT(txn->IsExclusiveLocked(rid), "We must own the exclusive lock!");
 
+    // The deleted tuple is logged for undo purposes, straight from the page: its bytes are only reclaimed below.
+    Tuple delete_tuple(rid, GetData() + tuple_offset, tuple_size);
     LogRecord log_record(txn->GetTransactionId(), txn->GetPrevLSN(), LogRecordType::APPLYDELETE, rid, delete_tuple);
     lsn_t lsn = log_manager->AppendLogRecord(&log_record);
     SetLSN(lsn);
     txn->SetPrevLSN(lsn);
   }
 
-  uint32_t free_space_pointer = GetFreeSpacePointer();
-  BUSTUB_ASSERT(tuple_offset >= free_space_pointer, "Free space appears before tuples.");
+  if (deleted != nullptr) {
+    deleted->rid_ = rid;
+    deleted->CopyData(GetData() + tuple_offset, tuple_size);
+  }
 
-  memmove(GetData() + free_space_pointer + tuple_size, GetData() + free_space_pointer,
-          tuple_offset - free_space_pointer);
-  SetFreeSpacePointer(free_space_pointer + tuple_size);
+  BUSTUB_ASSERT(tuple_offset >= GetFreeSpacePointer(), "Free space appears before tuples.");
+  // The tuple's bytes stay behind as a hole until the page is compacted, instead of the tuples in front of them being
+  // moved over on every delete.
   SetTupleSize(slot_num, 0);
   SetTupleOffsetAtSlot(slot_num, 0);
+}
 
-  // Update all tuple offsets.
-  for (uint32_t i = 0; i < GetTupleCount(); ++i) {
-    uint32_t tuple_offset_i = GetTupleOffsetAtSlot(i);
-    if (GetTupleSize(i) != 0 && tuple_offset_i < tuple_offset) {
-      SetTupleOffsetAtSlot(i, tuple_offset_i + tuple_size);
+uint32_t TablePage::GetDeadSize() {
+  uint32_t live_size = 0;
+  for (uint32_t i = 0; i < GetTupleCount(); i++) {
+    live_size += UnsetDeletedFlag(GetTupleSize(i));
+  }
+  return PAGE_SIZE - GetFreeSpacePointer() - live_size;
+}
+
+uint32_t TablePage::GetTrailingEmptySlots() {
+  uint32_t count = GetTupleCount();
+  uint32_t i = count;
+  while (i > 0 && GetTupleSize(i - 1) == 0) {
+    i--;
+  }
+  return count - i;
+}
+
+uint32_t TablePage::GetReclaimableSize() { return GetDeadSize() + SIZE_TUPLE * GetTrailingEmptySlots(); }
+
+bool TablePage::IsEmpty() { return GetTupleCount() == GetTrailingEmptySlots(); }
+
+uint32_t TablePage::Compact() {
+  uint32_t free_space = GetFreeSpaceRemaining();
+  SetTupleCount(GetTupleCount() - GetTrailingEmptySlots());
+
+  // Slide the tuples up against the end of the page, the one nearest to it first, so that none is overwritten.
+  std::vector<uint32_t> slots;
+  for (uint32_t i = 0; i < GetTupleCount(); i++) {
+    if (GetTupleSize(i) != 0) {
+      slots.push_back(i);
     }
   }
+  std::sort(slots.begin(), slots.end(),
+            [this](uint32_t a, uint32_t b) { return GetTupleOffsetAtSlot(a) > GetTupleOffsetAtSlot(b); });
+  uint32_t end = PAGE_SIZE;
+  for (uint32_t slot : slots) {
+    uint32_t size = UnsetDeletedFlag(GetTupleSize(slot));
+    uint32_t offset = GetTupleOffsetAtSlot(slot);
+    end -= size;
+    if (end != offset) {
+      memmove(GetData() + end, GetData() + offset, size);
+      SetTupleOffsetAtSlot(slot, end);
+    }
+  }
+  SetFreeSpacePointer(end);
+  return GetFreeSpaceRemaining() - free_space;
 }
 
 void TablePage::RollbackDelete(const RID &rid, Transaction *txn, LogManager *log_manager) {
   // Log the rollback.
-  if (enable_logging) {
+  if (enable_logging && txn != nullptr) {
     BUSTUB_ASSERT(txn->IsExclusiveLocked(rid), "We must own an exclusive lock on the RID.");
     Tuple dummy_tuple;
     LogRecord log_record(txn->GetTransactionId(), txn->GetPrevLSN(), LogRecordType::ROLLBACKDELETE, rid, dummy_tuple);
@@ -265,12 +344,24 @@ void TablePage::RollbackDelete(const RID &rid, Transaction *txn, LogManager *log
   }
 }
 
-bool TablePage::GetTuple(const RID &rid, Tuple *tuple, Transaction *txn, LockManager *lock_manager) {
+bool TablePage::GetTuple(const RID &rid, Tuple *tuple, Transaction *txn, LockManager *lock_manager,
+                         table_oid_t oid) {
+  Tuple view;
+  if (!GetTupleView(rid, &view, txn, lock_manager, oid)) {
+    return false;
+  }
+  // Copy the tuple data into our result, as the view is only good for as long as the page is latched.
+  tuple->CopyFrom(view);
+  return true;
+}
+
+bool TablePage::GetTupleView(const RID &rid, Tuple *tuple, Transaction *txn, LockManager *lock_manager,
+                             table_oid_t oid) {
   // Get the current slot number.
   uint32_t slot_num = rid.GetSlotNum();
   // If somehow we have more slots than tuples, abort the transaction.
   if (slot_num >= GetTupleCount()) {
-    if (enable_logging) {
+    if (enable_logging && txn != nullptr) {
       txn->SetState(TransactionState::ABORTED);
     }
     return false;
@@ -279,29 +370,36 @@ bool TablePage::GetTuple(const RID &rid, Tuple *tuple, Transaction *txn, LockMan
   uint32_t tuple_size = GetTupleSize(slot_num);
   // If the tuple is deleted, abort the transaction.
   if (IsDeleted(tuple_size)) {
-    if (enable_logging) {
+    if (enable_logging && txn != nullptr) {
       txn->SetState(TransactionState::ABORTED);
     }
     return false;
   }
 
   // Otherwise we have a valid tuple, try to acquire at least a shared lock.
-  if (enable_logging) {
-    if (!txn->IsSharedLocked(rid) && !txn->IsExclusiveLocked(rid) && !lock_manager->LockShared(txn, rid)) {
+  if (enable_logging && txn != nullptr) {
+    if (!txn->IsSharedLocked(rid) && !txn->IsExclusiveLocked(rid) && !lock_manager->LockShared(txn, rid, oid)) {
       return false;
     }
   }
 
-  // At this point, we have at least a shared lock on the RID. Copy the tuple data into our result.
-  uint32_t tuple_offset = GetTupleOffsetAtSlot(slot_num);
-  tuple->size_ = tuple_size;
-  if (tuple->allocated_) {
-    delete[] tuple->data_;
-  }
-  tuple->data_ = new char[tuple->size_];
-  memcpy(tuple->data_, GetData() + tuple_offset, tuple->size_);
-  tuple->rid_ = rid;
-  tuple->allocated_ = true;
+  // At this point, we have at least a shared lock on the RID. Point the result at the tuple data.
+  *tuple = Tuple(rid, GetData() + GetTupleOffsetAtSlot(slot_num), tuple_size);
+  return true;
+}
+
+bool TablePage::ReadTuple(const RID &rid, Tuple *tuple, bool *deleted) {
+  uint32_t slot_num = rid.GetSlotNum();
+  if (slot_num >= GetTupleCount()) {
+    return false;
+  }
+  uint32_t tuple_size = GetTupleSize(slot_num);
+  *deleted = IsDeleted(tuple_size);
+  tuple_size = UnsetDeletedFlag(tuple_size);
+  if (tuple_size == 0) {
+    return false;
+  }
+  *tuple = Tuple(rid, GetData() + GetTupleOffsetAtSlot(slot_num), tuple_size);
   return true;
 }
 
@@ -0,0 +1,144 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// clustered_table.cpp
+//
+// Identification: src/storage/table/clustered_table.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/table/clustered_table.h"
+
+#include <cstring>
+
+#include "type/limits.h"
+
+namespace bustub {
+
+ClusteredTable::ClusteredTable(BufferPoolManager *buffer_pool_manager, const Schema *schema, uint32_t key_idx,
+                               table_oid_t oid)
+    : schema_(schema),
+      key_idx_(key_idx),
+      key_schema_(std::vector<Column>{Column("key", TypeId::BIGINT)}),
+      tree_("__clustered_" + std::to_string(oid), buffer_pool_manager, GenericComparator<8>(&key_schema_)) {}
+
+std::optional<int64_t> ClusteredTable::KeyOf(const Value &value) {
+  if (value.IsNull()) {
+    return std::nullopt;
+  }
+  return value.CastAs(TypeId::BIGINT).GetAs<int64_t>();
+}
+
+bool ClusteredTable::InsertTuple(const Tuple &tuple, RID *rid, Transaction *txn) {
+  std::optional<int64_t> key = KeyOf(tuple.GetValue(schema_, key_idx_));
+  if (!key.has_value() || !Row::Fits(tuple)) {
+    return false;
+  }
+  Row row;
+  row.SetFromTuple(tuple);
+  if (!tree_.Insert(TreeKey(*key), row, txn)) {
+    return false;
+  }
+  *rid = RidOf(*key);
+  return true;
+}
+
+bool ClusteredTable::MarkDelete(const RID &rid, Transaction *txn) {
+  GenericKey<8> key = TreeKey(rid.Get());
+  std::vector<Row> rows;
+  if (!tree_.GetValue(key, &rows, txn)) {
+    return false;
+  }
+  tree_.Remove(key, txn);
+  return true;
+}
+
+bool ClusteredTable::UpdateTuple(const Tuple &tuple, const RID &rid, RID *new_rid, Transaction *txn) {
+  std::optional<int64_t> key = KeyOf(tuple.GetValue(schema_, key_idx_));
+  if (!key.has_value() || !Row::Fits(tuple)) {
+    return false;
+  }
+  std::vector<Row> rows;
+  if (!tree_.GetValue(TreeKey(rid.Get()), &rows, txn)) {
+    return false;
+  }
+  // a row that moves to another key must not take one of another row
+  if (*key != rid.Get() && tree_.GetValue(TreeKey(*key), &rows, txn)) {
+    return false;
+  }
+  tree_.Remove(TreeKey(rid.Get()), txn);
+  Row row;
+  row.SetFromTuple(tuple);
+  if (!tree_.Insert(TreeKey(*key), row, txn)) {
+    return false;
+  }
+  *new_rid = RidOf(*key);
+  return true;
+}
+
+bool ClusteredTable::GetTuple(const RID &rid, Tuple *tuple, Transaction *txn) {
+  std::vector<Row> rows;
+  if (!tree_.GetValue(TreeKey(rid.Get()), &rows, txn)) {
+    return false;
+  }
+  tuple->CopyFrom(rows.front().AsTuple(rid));
+  return true;
+}
+
+ClusteredTableScanner::ClusteredTableScanner(ClusteredTable *table, const std::optional<ZoneRange> &range)
+    : table_(table), next_key_(BUSTUB_INT64_MIN), max_key_(BUSTUB_INT64_MAX) {
+  if (!range.has_value() || range->column_idx_ != table->GetKeyIdx()) {
+    return;
+  }
+  // a bound of another type than an integer one, e.g. a DECIMAL, leaves the keys unbounded
+  if (range->min_.has_value() && ClusteredTable::IsKeyType(range->min_->GetTypeId())) {
+    next_key_ = ClusteredTable::KeyOf(*range->min_).value_or(next_key_);
+  }
+  if (range->max_.has_value() && ClusteredTable::IsKeyType(range->max_->GetTypeId())) {
+    max_key_ = ClusteredTable::KeyOf(*range->max_).value_or(max_key_);
+  }
+  done_ = next_key_ > max_key_;
+}
+
+bool ClusteredTableScanner::ReadLeaf() {
+  rows_.clear();
+  position_ = 0;
+  if (done_) {
+    return false;
+  }
+  {
+    // the iterator lets go of the leaf when it goes out of scope, before any row is handed out
+    auto iter = table_->GetTree()->Begin(ClusteredTable::TreeKey(next_key_));
+    if (!iter.NextBatch(&rows_)) {
+      done_ = true;
+      return false;
+    }
+  }
+  int64_t last_key;
+  memcpy(&last_key, rows_.back().first.data_, sizeof(int64_t));
+  done_ = last_key >= max_key_;
+  next_key_ = done_ ? next_key_ : last_key + 1;
+  return true;
+}
+
+bool ClusteredTableScanner::Next(Tuple *tuple) {
+  if (position_ == rows_.size() && !ReadLeaf()) {
+    return false;
+  }
+  auto &[tree_key, row] = rows_[position_++];
+  int64_t key;
+  memcpy(&key, tree_key.data_, sizeof(int64_t));
+  if (key > max_key_) {
+    done_ = true;
+    rows_.clear();
+    position_ = 0;
+    return false;
+  }
+  *tuple = row.AsTuple(ClusteredTable::RidOf(key));
+  return true;
+}
+
+}  // namespace bustub
@@ -0,0 +1,74 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// memory_table.cpp
+//
+// Identification: src/storage/table/memory_table.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/table/memory_table.h"
+
+#include <cstring>
+#include <mutex>  // NOLINT
+
+namespace bustub {
+
+bool MemoryTable::InsertTuple(const Tuple &tuple, RID *rid, Transaction *txn) {
+  // the row is copied before the latch is taken, which only covers appending it
+  auto data = std::make_unique<char[]>(tuple.GetLength());
+  memcpy(data.get(), tuple.GetData(), tuple.GetLength());
+  std::unique_lock lock(latch_);
+  uint64_t position = row_count_.load(std::memory_order_relaxed);
+  if (position / ROWS_PER_CHUNK == chunks_.size()) {
+    chunks_.push_back(std::make_unique<Row[]>(ROWS_PER_CHUNK));
+  }
+  Row &row = RowAt(position);
+  row.data_ = std::move(data);
+  row.size_ = tuple.GetLength();
+  row_count_.store(position + 1, std::memory_order_release);
+  *rid = RidOf(position);
+  return true;
+}
+
+bool MemoryTable::MarkDelete(const RID &rid, Transaction *txn) {
+  uint64_t position = static_cast<uint64_t>(rid.GetPageId()) * ROWS_PER_CHUNK + rid.GetSlotNum();
+  if (rid.GetPageId() < 0 || rid.GetSlotNum() >= ROWS_PER_CHUNK || position >= GetRowCount()) {
+    return false;
+  }
+  std::shared_lock lock(latch_);
+  return !RowAt(position).deleted_.exchange(true);
+}
+
+bool MemoryTable::GetTuple(const RID &rid, Tuple *tuple, Transaction *txn) {
+  uint64_t position = static_cast<uint64_t>(rid.GetPageId()) * ROWS_PER_CHUNK + rid.GetSlotNum();
+  if (rid.GetPageId() < 0 || rid.GetSlotNum() >= ROWS_PER_CHUNK || position >= GetRowCount()) {
+    return false;
+  }
+  std::shared_lock lock(latch_);
+  Row &row = RowAt(position);
+  if (row.deleted_.load()) {
+    return false;
+  }
+  *tuple = Tuple(rid, row.data_.get(), row.size_);
+  return true;
+}
+
+bool MemoryTable::Next(uint64_t *position, Tuple *tuple) {
+  uint64_t row_count = GetRowCount();
+  std::shared_lock lock(latch_);
+  for (; *position < row_count; ++*position) {
+    Row &row = RowAt(*position);
+    if (!row.deleted_.load()) {
+      *tuple = Tuple(RidOf(*position), row.data_.get(), row.size_);
+      ++*position;
+      return true;
+    }
+  }
+  return false;
+}
+
+}  // namespace bustub
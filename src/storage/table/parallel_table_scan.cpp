@@ -0,0 +1,89 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// parallel_table_scan.cpp
+//
+// Identification: src/storage/table/parallel_table_scan.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/table/parallel_table_scan.h"
+
+#include <algorithm>
+#include <map>
+#include <vector>
+
+namespace bustub {
+
+ParallelTableScan::ParallelTableScan(TableHeap *table_heap, size_t pages_per_morsel, BufferAccessStrategy *strategy,
+                                     size_t num_workers, const std::vector<int> &worker_nodes)
+    : pages_per_morsel_(pages_per_morsel),
+      page_ids_(table_heap->GetPageIds(strategy)),
+      morsels_(SplitMorsels(table_heap->GetBufferPoolManager(), num_workers, worker_nodes)) {}
+
+std::vector<std::pair<size_t, size_t>> ParallelTableScan::SplitMorsels(BufferPoolManager *bpm, size_t num_workers,
+                                                                       const std::vector<int> &worker_nodes) {
+  BUSTUB_ASSERT(pages_per_morsel_ > 0, "a morsel has to have pages");
+  BUSTUB_ASSERT(num_workers > 0, "a scan has to have workers");
+  std::vector<std::pair<size_t, size_t>> ranges(num_workers);
+
+  // the pages of each node, in the order of the list, and the workers of each node
+  std::map<int, std::vector<page_id_t>> node_pages;
+  std::map<int, std::vector<size_t>> node_workers;
+  bool by_node = num_workers > 1 && worker_nodes.size() >= num_workers;
+  for (size_t i = 0; by_node && i < page_ids_.size(); i++) {
+    int node = bpm->GetNumaNode(page_ids_[i]);
+    by_node = node >= 0;
+    node_pages[node].push_back(page_ids_[i]);
+  }
+  for (size_t w = 0; by_node && w < num_workers; w++) {
+    node_workers[worker_nodes[w]].push_back(w);
+  }
+  for (const auto &[node, pages] : node_pages) {
+    by_node = by_node && node_workers.count(node) == 1;
+  }
+
+  if (!by_node) {
+    for (size_t start = 0; start < page_ids_.size(); start += pages_per_morsel_) {
+      morsel_starts_.push_back(start);
+    }
+    morsel_starts_.push_back(page_ids_.size());
+    size_t num_morsels = GetMorselCount();
+    for (size_t w = 0; w < num_workers; w++) {
+      ranges[w] = {w * num_morsels / num_workers, (w + 1) * num_morsels / num_workers};
+    }
+    return ranges;
+  }
+
+  // a morsel never spans two nodes, and those of a node are split evenly between its workers
+  page_ids_.clear();
+  for (const auto &[node, pages] : node_pages) {
+    size_t first_morsel = morsel_starts_.size();
+    for (size_t start = 0; start < pages.size(); start += pages_per_morsel_) {
+      morsel_starts_.push_back(page_ids_.size() + start);
+    }
+    page_ids_.insert(page_ids_.end(), pages.begin(), pages.end());
+    size_t num_morsels = morsel_starts_.size() - first_morsel;
+    const std::vector<size_t> &workers = node_workers[node];
+    for (size_t i = 0; i < workers.size(); i++) {
+      ranges[workers[i]] = {first_morsel + i * num_morsels / workers.size(),
+                            first_morsel + (i + 1) * num_morsels / workers.size()};
+    }
+  }
+  morsel_starts_.push_back(page_ids_.size());
+  return ranges;
+}
+
+bool ParallelTableScan::NextMorsel(std::vector<page_id_t> *page_ids, size_t worker) {
+  size_t morsel;
+  if (!morsels_.Next(worker, &morsel)) {
+    return false;
+  }
+  page_ids->assign(page_ids_.begin() + morsel_starts_[morsel], page_ids_.begin() + morsel_starts_[morsel + 1]);
+  return true;
+}
+
+}  // namespace bustub
@@ -0,0 +1,153 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// partitioned_table.cpp
+//
+// Identification: src/storage/table/partitioned_table.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/table/partitioned_table.h"
+
+#include "common/util/hash_util.h"
+#include "storage/table/table_page_scanner.h"
+
+namespace bustub {
+
+PartitionedTable::PartitionedTable(BufferPoolManager *buffer_pool_manager, LockManager *lock_manager,
+                                   LogManager *log_manager, const Schema *schema, PartitionScheme scheme,
+                                   table_oid_t oid, Transaction *txn)
+    : buffer_pool_manager_(buffer_pool_manager),
+      lock_manager_(lock_manager),
+      log_manager_(log_manager),
+      schema_(schema),
+      scheme_(std::move(scheme)),
+      oid_(oid) {
+  for (size_t i = 0; i < scheme_.num_partitions_; i++) {
+    partitions_.push_back(MakeHeap(INVALID_PAGE_ID, txn));
+  }
+}
+
+PartitionedTable::PartitionedTable(BufferPoolManager *buffer_pool_manager, LockManager *lock_manager,
+                                   LogManager *log_manager, const Schema *schema, PartitionScheme scheme,
+                                   table_oid_t oid, const std::vector<page_id_t> &first_page_ids)
+    : buffer_pool_manager_(buffer_pool_manager),
+      lock_manager_(lock_manager),
+      log_manager_(log_manager),
+      schema_(schema),
+      scheme_(std::move(scheme)),
+      oid_(oid) {
+  BUSTUB_ASSERT(first_page_ids.size() == scheme_.num_partitions_, "a heap for every partition");
+  for (page_id_t first_page_id : first_page_ids) {
+    partitions_.push_back(MakeHeap(first_page_id, nullptr));
+  }
+}
+
+std::unique_ptr<TableHeap> PartitionedTable::MakeHeap(page_id_t first_page_id, Transaction *txn) {
+  auto heap = first_page_id == INVALID_PAGE_ID
+                  ? std::make_unique<TableHeap>(buffer_pool_manager_, lock_manager_, log_manager_, txn)
+                  : std::make_unique<TableHeap>(buffer_pool_manager_, lock_manager_, log_manager_, first_page_id);
+  heap->EnableToast(schema_);
+  heap->SetTableOid(oid_);
+  return heap;
+}
+
+std::vector<TableHeap *> PartitionedTable::GetPartitions() const {
+  std::vector<TableHeap *> heaps;
+  heaps.reserve(partitions_.size());
+  for (const auto &heap : partitions_) {
+    heaps.push_back(heap.get());
+  }
+  return heaps;
+}
+
+size_t PartitionedTable::PartitionOf(const Value &key) const {
+  if (key.IsNull()) {
+    return 0;
+  }
+  if (scheme_.method_ == PartitionMethod::HASH) {
+    return HashUtil::HashValue(&key) % partitions_.size();
+  }
+  // the partition is the number of bounds at or below the key
+  auto below = [](const Value &k, const Value &b) { return k.CompareLessThan(b) == CmpBool::CmpTrue; };
+  auto bound = std::upper_bound(scheme_.bounds_.begin(), scheme_.bounds_.end(), key, below);
+  return bound - scheme_.bounds_.begin();
+}
+
+std::vector<size_t> PartitionedTable::PartitionsOf(const ZoneRange &range) const {
+  size_t first = 0;
+  size_t last = partitions_.size() - 1;
+  if (range.column_idx_ == scheme_.key_idx_) {
+    if (scheme_.method_ == PartitionMethod::RANGE) {
+      first = range.min_.has_value() ? PartitionOf(*range.min_) : first;
+      last = range.max_.has_value() ? PartitionOf(*range.max_) : last;
+    } else if (range.min_.has_value() && range.max_.has_value() &&
+               range.min_->CompareEquals(*range.max_) == CmpBool::CmpTrue) {
+      first = PartitionOf(*range.min_);
+      last = first;
+    }
+  }
+  std::vector<size_t> partitions;
+  for (size_t partition = first; partition <= last; partition++) {
+    partitions.push_back(partition);
+  }
+  return partitions;
+}
+
+TableHeap *PartitionedTable::HeapOf(const RID &rid) {
+  std::scoped_lock latch{page_latch_};
+  auto found = page_partitions_.find(rid.GetPageId());
+  if (found == page_partitions_.end()) {
+    for (size_t partition = 0; partition < partitions_.size(); partition++) {
+      for (page_id_t page_id : partitions_[partition]->GetPageIds()) {
+        page_partitions_[page_id] = partition;
+      }
+    }
+    found = page_partitions_.find(rid.GetPageId());
+    if (found == page_partitions_.end()) {
+      return nullptr;
+    }
+  }
+  return partitions_[found->second].get();
+}
+
+bool PartitionedTable::GetTuple(const RID &rid, Tuple *tuple, Transaction *txn) {
+  TableHeap *heap = HeapOf(rid);
+  return heap != nullptr && heap->GetTuple(rid, tuple, txn);
+}
+
+void PartitionedTable::Truncate(size_t partition, Transaction *txn) {
+  TableHeap *heap = partitions_[partition].get();
+  std::vector<page_id_t> page_ids = heap->GetPageIds();
+  ToastStore *toast = heap->GetToastStore();
+  {
+    TablePageScanner scanner(heap, txn, page_ids);
+    Tuple view;
+    while (scanner.Next(&view)) {
+      if (toast->IsToasted(view)) {
+        toast->Free(view);
+      }
+    }
+  }
+  // the writes of the transaction to the partition go with it, rather than being applied or undone when it ends
+  auto write_set = txn->GetWriteSet();
+  write_set->erase(std::remove_if(write_set->begin(), write_set->end(),
+                                  [heap](const TableWriteRecord &item) { return item.table_ == heap; }),
+                   write_set->end());
+  // the new heap is observed as the one it replaces was
+  std::vector<TableWriteObserver *> observers = heap->GetWriteObservers();
+  partitions_[partition] = MakeHeap(INVALID_PAGE_ID, txn);
+  for (TableWriteObserver *observer : observers) {
+    partitions_[partition]->AddWriteObserver(observer);
+  }
+  std::scoped_lock latch{page_latch_};
+  for (page_id_t page_id : page_ids) {
+    page_partitions_.erase(page_id);
+    buffer_pool_manager_->DeletePage(page_id);
+  }
+}
+
+}  // namespace bustub
@@ -0,0 +1,86 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// pax_column_scanner.cpp
+//
+// Identification: src/storage/table/pax_column_scanner.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/table/pax_column_scanner.h"
+
+#include <utility>
+
+#include "storage/table/pax_table_heap.h"
+
+namespace bustub {
+
+PaxColumnScanner::PaxColumnScanner(PaxTableHeap *table_heap, std::vector<uint32_t> column_idxs,
+                                   BufferAccessStrategy *strategy)
+    : table_heap_(table_heap), column_idxs_(std::move(column_idxs)), strategy_(strategy) {
+  MoveToPage(table_heap_->GetFirstPageId());
+}
+
+PaxColumnScanner::~PaxColumnScanner() { MoveToPage(INVALID_PAGE_ID); }
+
+bool PaxColumnScanner::Next(RID *rid, std::vector<Value> *values) { return Next(rid, values, nullptr); }
+
+bool PaxColumnScanner::Next(RID *rid, std::vector<Value> *values, std::vector<uint32_t> *codes) {
+  while (page_ != nullptr) {
+    page_->RLatch();
+    uint32_t row_count = page_->GetRowCount();
+    while (row_ < row_count && page_->IsDeleted(row_)) {
+      row_++;
+    }
+    if (row_ == row_count) {
+      page_id_t next_page_id = page_->GetNextPageId();
+      page_->RUnlatch();
+      MoveToPage(next_page_id);
+      continue;
+    }
+    values->clear();
+    for (uint32_t column_idx : column_idxs_) {
+      values->push_back(page_->GetValue(row_, column_idx, *table_heap_->schema_, table_heap_->layout_));
+    }
+    if (codes != nullptr) {
+      codes->clear();
+      for (uint32_t column_idx : column_idxs_) {
+        bool varchar = table_heap_->schema_->GetType(column_idx) == TypeId::VARCHAR;
+        codes->push_back(varchar ? page_->GetCode(row_, column_idx, table_heap_->layout_) : 0);
+      }
+    }
+    rid->Set(page_->GetPaxPageId(), row_++);
+    page_->RUnlatch();
+    return true;
+  }
+  return false;
+}
+
+void PaxColumnScanner::MoveToPage(page_id_t page_id) {
+  if (page_ == nullptr && page_id == INVALID_PAGE_ID) {
+    // nothing to let go of, e.g. a scanner that ran to the end, which may outlive its table
+    row_ = 0;
+    return;
+  }
+  BufferPoolManager *buffer_pool_manager = table_heap_->buffer_pool_manager_;
+  if (page_ != nullptr) {
+    buffer_pool_manager->UnpinPage(page_->GetPageId(), false);
+    page_ = nullptr;
+  }
+  row_ = 0;
+  if (page_id == INVALID_PAGE_ID) {
+    return;
+  }
+  page_ = static_cast<PaxPage *>(buffer_pool_manager->FetchPageWithStrategy(page_id, strategy_));
+  BUSTUB_ASSERT(page_ != nullptr, "Couldn't fetch a page of the table heap.");
+  // read the page after this one while the rows of this one are being consumed
+  page_->RLatch();
+  page_id_t next_page_id = page_->GetNextPageId();
+  page_->RUnlatch();
+  buffer_pool_manager->PrefetchPages({next_page_id}, strategy_);
+}
+
+}  // namespace bustub
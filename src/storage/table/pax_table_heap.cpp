@@ -0,0 +1,106 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// pax_table_heap.cpp
+//
+// Identification: src/storage/table/pax_table_heap.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/table/pax_table_heap.h"
+
+namespace bustub {
+
+PaxTableHeap::PaxTableHeap(BufferPoolManager *buffer_pool_manager, const Schema *schema)
+    : buffer_pool_manager_(buffer_pool_manager), schema_(schema), layout_(PaxLayout::For(*schema)) {
+  auto first_page = static_cast<PaxPage *>(buffer_pool_manager_->NewPage(&first_page_id_));
+  BUSTUB_ASSERT(first_page != nullptr, "Couldn't create a page for the table heap.");
+  first_page->WLatch();
+  first_page->Init(first_page_id_, INVALID_PAGE_ID);
+  first_page->WUnlatch();
+  buffer_pool_manager_->UnpinPage(first_page_id_, true);
+  last_page_id_ = first_page_id_;
+}
+
+PaxTableHeap::PaxTableHeap(BufferPoolManager *buffer_pool_manager, const Schema *schema, page_id_t first_page_id)
+    : buffer_pool_manager_(buffer_pool_manager),
+      schema_(schema),
+      layout_(PaxLayout::For(*schema)),
+      first_page_id_(first_page_id) {}
+
+bool PaxTableHeap::InsertTuple(const Tuple &tuple, RID *rid, Transaction *txn, BufferAccessStrategy *strategy) {
+  std::scoped_lock latch{append_latch_};
+  // an opened table finds its last page once
+  page_id_t page_id = last_page_id_ == INVALID_PAGE_ID ? first_page_id_ : last_page_id_;
+  auto page = static_cast<PaxPage *>(buffer_pool_manager_->FetchPageWithStrategy(page_id, strategy));
+  while (page != nullptr && page->GetNextPageId() != INVALID_PAGE_ID) {
+    page_id_t next_page_id = page->GetNextPageId();
+    buffer_pool_manager_->UnpinPage(page_id, false);
+    page_id = next_page_id;
+    page = static_cast<PaxPage *>(buffer_pool_manager_->FetchPageWithStrategy(page_id, strategy));
+  }
+  if (page == nullptr) {
+    txn->SetState(TransactionState::ABORTED);
+    return false;
+  }
+  last_page_id_ = page_id;
+
+  page->WLatch();
+  bool inserted = page->InsertTuple(tuple, *schema_, layout_, rid);
+  if (!inserted) {
+    page_id_t new_page_id;
+    auto new_page = static_cast<PaxPage *>(buffer_pool_manager_->NewPageWithStrategy(&new_page_id, strategy));
+    if (new_page == nullptr) {
+      page->WUnlatch();
+      buffer_pool_manager_->UnpinPage(page_id, false);
+      txn->SetState(TransactionState::ABORTED);
+      return false;
+    }
+    new_page->WLatch();
+    new_page->Init(new_page_id, page_id);
+    page->SetNextPageId(new_page_id);
+    page->WUnlatch();
+    buffer_pool_manager_->UnpinPage(page_id, true);
+    page = new_page;
+    page_id = last_page_id_ = new_page_id;
+    inserted = page->InsertTuple(tuple, *schema_, layout_, rid);
+  }
+  page->WUnlatch();
+  buffer_pool_manager_->UnpinPage(page_id, inserted);
+  if (!inserted) {
+    // a row that does not fit into an empty page
+    txn->SetState(TransactionState::ABORTED);
+  }
+  return inserted;
+}
+
+bool PaxTableHeap::MarkDelete(const RID &rid, Transaction *txn) {
+  auto page = static_cast<PaxPage *>(buffer_pool_manager_->FetchPage(rid.GetPageId()));
+  if (page == nullptr) {
+    txn->SetState(TransactionState::ABORTED);
+    return false;
+  }
+  page->WLatch();
+  bool deleted = page->MarkDelete(rid.GetSlotNum());
+  page->WUnlatch();
+  buffer_pool_manager_->UnpinPage(rid.GetPageId(), deleted);
+  return deleted;
+}
+
+bool PaxTableHeap::GetTuple(const RID &rid, Tuple *tuple, Transaction *txn) {
+  auto page = static_cast<PaxPage *>(buffer_pool_manager_->FetchPage(rid.GetPageId()));
+  if (page == nullptr) {
+    txn->SetState(TransactionState::ABORTED);
+    return false;
+  }
+  page->RLatch();
+  bool found = page->GetTuple(rid, *schema_, layout_, tuple);
+  page->RUnlatch();
+  buffer_pool_manager_->UnpinPage(rid.GetPageId(), false);
+  return found;
+}
+
+}  // namespace bustub
@@ -0,0 +1,47 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// table_free_space_map.cpp
+//
+// Identification: src/storage/table/table_free_space_map.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+
+#include "storage/table/table_free_space_map.h"
+
+namespace bustub {
+
+void TableFreeSpaceMap::Update(page_id_t page_id, uint32_t max_insert_size) {
+  // a bucket holds the pages that fit at least bucket * BUCKET_WIDTH bytes
+  uint32_t bucket = std::min(max_insert_size / BUCKET_WIDTH, NUM_BUCKETS - 1);
+  std::scoped_lock latch{latch_};
+  auto it = bucket_of_.find(page_id);
+  if (it != bucket_of_.end()) {
+    if (it->second == bucket) {
+      return;
+    }
+    buckets_[it->second].erase(page_id);
+    it->second = bucket;
+  } else {
+    bucket_of_.emplace(page_id, bucket);
+  }
+  buckets_[bucket].insert(page_id);
+}
+
+page_id_t TableFreeSpaceMap::Find(uint32_t size) {
+  std::scoped_lock latch{latch_};
+  // the first bucket that is certain to fit the tuple
+  for (uint32_t bucket = (size + BUCKET_WIDTH - 1) / BUCKET_WIDTH; bucket < NUM_BUCKETS; bucket++) {
+    if (!buckets_[bucket].empty()) {
+      return *buckets_[bucket].begin();
+    }
+  }
+  return INVALID_PAGE_ID;
+}
+
+}  // namespace bustub
@@ -10,25 +10,41 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <algorithm>
 #include <cassert>
+#include <functional>
+#include <memory>
+#include <random>
+#include <thread>  // NOLINT
+#include <utility>
+#include <vector>
 
 #include "common/logger.h"
 #include "storage/table/table_heap.h"
 
 namespace bustub {
 
+std::atomic<uint64_t> TableHeap::modification_clock{0};
+
 TableHeap::TableHeap(BufferPoolManager *buffer_pool_manager, LockManager *lock_manager, LogManager *log_manager,
                      page_id_t first_page_id)
     : buffer_pool_manager_(buffer_pool_manager),
       lock_manager_(lock_manager),
       log_manager_(log_manager),
-      first_page_id_(first_page_id) {}
+      first_page_id_(first_page_id) {
+  for (auto &hint : insert_hints_) {
+    hint = INVALID_PAGE_ID;
+  }
+}
 
 TableHeap::TableHeap(BufferPoolManager *buffer_pool_manager, LockManager *lock_manager, LogManager *log_manager,
                      Transaction *txn)
     : buffer_pool_manager_(buffer_pool_manager), lock_manager_(lock_manager), log_manager_(log_manager) {
+  for (auto &hint : insert_hints_) {
+    hint = INVALID_PAGE_ID;
+  }
   // Initialize the first table page.
-  auto first_page = reinterpret_cast<TablePage *>(buffer_pool_manager_->NewPage(&first_page_id_));
+  auto first_page = reinterpret_cast<TablePage *>(NewTablePage(&first_page_id_, nullptr));
   BUSTUB_ASSERT(first_page != nullptr, "Couldn't create a page for the table heap.");
   first_page->WLatch();
   first_page->Init(first_page_id_, PAGE_SIZE, INVALID_LSN, log_manager_, txn);
@@ -36,22 +52,82 @@ TableHeap::TableHeap(BufferPoolManager *buffer_pool_manager, LockManager *lock_m
   buffer_pool_manager_->UnpinPage(first_page_id_, true);
 }
 
-bool TableHeap::InsertTuple(const Tuple &tuple, RID *rid, Transaction *txn) {
-  if (tuple.size_ + 32 > PAGE_SIZE) {  // larger than one page size
+bool TableHeap::InsertTuple(const Tuple &tuple, RID *rid, Transaction *txn, BufferAccessStrategy *strategy) {
+  Tuple toasted;
+  if (toast_ == nullptr || !toast_->Toast(tuple, &toasted)) {
+    return InsertStoredTuple(tuple, tuple, rid, txn, strategy);
+  }
+  if (InsertStoredTuple(toasted, tuple, rid, txn, strategy)) {
+    return true;
+  }
+  toast_->Free(toasted);
+  return false;
+}
+
+bool TableHeap::InsertStoredTuple(const Tuple &stored, const Tuple &tuple, RID *rid, Transaction *txn,
+                                  BufferAccessStrategy *strategy) {
+  if (stored.size_ + 32 > PAGE_SIZE) {  // larger than one page size
     txn->SetState(TransactionState::ABORTED);
     return false;
   }
+  if (!LockForInsert(txn)) {
+    return false;
+  }
 
-  auto cur_page = static_cast<TablePage *>(buffer_pool_manager_->FetchPage(first_page_id_));
+  std::call_once(free_space_map_built_, [this, strategy] { BuildFreeSpaceMap(strategy); });
+  // Try the page this thread inserted into last, then the pages that the free space map says have room. A page that
+  // turns out to be full is recorded with what it has left, so it is not handed out for this tuple again.
+  std::atomic<page_id_t> &hint = insert_hints_[InsertHintSlot()];
+  page_id_t page_id = hint;
+  if (page_id == INVALID_PAGE_ID) {
+    page_id = free_space_map_.Find(stored.size_);
+  }
+  while (page_id != INVALID_PAGE_ID) {
+    auto page = static_cast<TablePage *>(buffer_pool_manager_->FetchPageWithStrategy(page_id, strategy));
+    if (page == nullptr) {
+      txn->SetState(TransactionState::ABORTED);
+      return false;
+    }
+    page->WLatch();
+    bool inserted = page->InsertTuple(stored, rid, txn, lock_manager_, log_manager_, table_oid_);
+    if (inserted) {
+      tids_.Bump(*rid);
+    }
+    if (inserted && IsVersioned(txn)) {
+      AppendVersion(*rid, txn, nullptr);
+    }
+    // a page with room may still refuse the tuple, if other transactions lock its free slots, see PlaceTuple
+    bool slots_locked = !inserted && page->GetMaxInsertSize() >= stored.size_;
+    free_space_map_.Update(page_id, page->GetMaxInsertSize());
+    if (inserted && zone_map_ != nullptr) {
+      zone_map_->Update(page_id, tuple);
+    }
+    page->WUnlatch();
+    buffer_pool_manager_->UnpinPage(page_id, inserted);
+    if (inserted) {
+      hint = page_id;
+      txn->GetWriteSet()->emplace_back(*rid, WType::INSERT, Tuple{}, this);
+      return true;
+    }
+    // the map would hand the page out again, so the tuple goes to the end of the table instead
+    if (slots_locked) {
+      break;
+    }
+    page_id = free_space_map_.Find(stored.size_);
+  }
+
+  // No page has room, so the tuple goes into a new page at the end of the table.
+  auto cur_page = static_cast<TablePage *>(buffer_pool_manager_->FetchPageWithStrategy(last_page_id_, strategy));
   if (cur_page == nullptr) {
     txn->SetState(TransactionState::ABORTED);
     return false;
   }
 
   cur_page->WLatch();
-  // Insert into the first page with enough space. If no such page exists, create a new page and insert into that.
+  // Another thread may have appended pages since, so walk on from the last page until one has room.
   // INVARIANT: cur_page is WLatched if you leave the loop normally.
-  while (!cur_page->InsertTuple(tuple, rid, txn, lock_manager_, log_manager_)) {
+  while (!cur_page->InsertTuple(stored, rid, txn, lock_manager_, log_manager_, table_oid_)) {
+    free_space_map_.Update(cur_page->GetTablePageId(), cur_page->GetMaxInsertSize());
     auto next_page_id = cur_page->GetNextPageId();
     // If the next page is a valid page,
     if (next_page_id != INVALID_PAGE_ID) {
@@ -59,11 +135,11 @@ bool TableHeap::InsertTuple(const Tuple &tuple, RID *rid, Transaction *txn) {
       cur_page->WUnlatch();
       buffer_pool_manager_->UnpinPage(cur_page->GetTablePageId(), false);
       // And repeat the process with the next page.
-      cur_page = static_cast<TablePage *>(buffer_pool_manager_->FetchPage(next_page_id));
+      cur_page = static_cast<TablePage *>(buffer_pool_manager_->FetchPageWithStrategy(next_page_id, strategy));
       cur_page->WLatch();
     } else {
       // Otherwise we have run out of valid pages. We need to create a new page.
-      auto new_page = static_cast<TablePage *>(buffer_pool_manager_->NewPage(&next_page_id));
+      auto new_page = static_cast<TablePage *>(NewTablePage(&next_page_id, strategy));
       // If we could not create a new page,
       if (new_page == nullptr) {
         // Then life sucks and we abort the transaction.
@@ -76,6 +152,8 @@ bool TableHeap::InsertTuple(const Tuple &tuple, RID *rid, Transaction *txn) {
       new_page->WLatch();
       cur_page->SetNextPageId(next_page_id);
       new_page->Init(next_page_id, PAGE_SIZE, cur_page->GetTablePageId(), log_manager_, txn);
+      AddPage(next_page_id);
+      last_page_id_ = next_page_id;
       cur_page->WUnlatch();
       buffer_pool_manager_->UnpinPage(cur_page->GetTablePageId(), true);
       cur_page = new_page;
@@ -83,6 +161,15 @@ bool TableHeap::InsertTuple(const Tuple &tuple, RID *rid, Transaction *txn) {
   }
   // This line has caused most of us to double-take and "whoa double unlatch".
   // We are not, in fact, double unlatching. See the invariant above.
+  tids_.Bump(*rid);
+  if (IsVersioned(txn)) {
+    AppendVersion(*rid, txn, nullptr);
+  }
+  free_space_map_.Update(cur_page->GetTablePageId(), cur_page->GetMaxInsertSize());
+  if (zone_map_ != nullptr) {
+    zone_map_->Update(cur_page->GetTablePageId(), tuple);
+  }
+  hint = cur_page->GetTablePageId();
   cur_page->WUnlatch();
   buffer_pool_manager_->UnpinPage(cur_page->GetTablePageId(), true);
   // Update the transaction's write set.
@@ -90,8 +177,370 @@ bool TableHeap::InsertTuple(const Tuple &tuple, RID *rid, Transaction *txn) {
   return true;
 }
 
+bool TableHeap::InsertTuples(const std::vector<Tuple> &tuples, std::vector<RID> *rids, Transaction *txn,
+                             BufferAccessStrategy *strategy) {
+  // the batch is only copied if a tuple of it has large values to move out
+  std::vector<Tuple> toasted;
+  std::vector<bool> is_toasted;
+  for (size_t i = 0; toast_ != nullptr && i < tuples.size(); i++) {
+    Tuple stored;
+    if (toast_->Toast(tuples[i], &stored)) {
+      if (toasted.empty()) {
+        toasted.reserve(tuples.size());
+        is_toasted.resize(tuples.size());
+        for (size_t j = 0; j < i; j++) {
+          toasted.push_back(tuples[j].AsView());
+        }
+      }
+      toasted.push_back(std::move(stored));
+      is_toasted[i] = true;
+    } else if (!toasted.empty()) {
+      toasted.push_back(tuples[i].AsView());
+    }
+  }
+  if (toasted.empty()) {
+    return InsertStoredTuples(tuples, tuples, rids, txn, strategy);
+  }
+  if (InsertStoredTuples(toasted, tuples, rids, txn, strategy)) {
+    return true;
+  }
+  // the tuples that made it in free their chains when the transaction aborts
+  for (size_t i = rids->size(); i < toasted.size(); i++) {
+    if (is_toasted[i]) {
+      toast_->Free(toasted[i]);
+    }
+  }
+  return false;
+}
+
+bool TableHeap::InsertStoredTuples(const std::vector<Tuple> &stored, const std::vector<Tuple> &tuples,
+                                   std::vector<RID> *rids, Transaction *txn, BufferAccessStrategy *strategy) {
+  rids->clear();
+  rids->reserve(stored.size());
+  for (const Tuple &tuple : stored) {
+    if (tuple.size_ + 32 > PAGE_SIZE) {  // larger than one page size
+      txn->SetState(TransactionState::ABORTED);
+      return false;
+    }
+  }
+  if (stored.empty()) {
+    return true;
+  }
+  if (!LockForInsert(txn)) {
+    return false;
+  }
+
+  // The batch fills the page this thread inserted into last and the pages with room first, like single inserts.
+  std::call_once(free_space_map_built_, [this, strategy] { BuildFreeSpaceMap(strategy); });
+  std::atomic<page_id_t> &hint = insert_hints_[InsertHintSlot()];
+  size_t next = 0;
+  page_id_t page_id = hint;
+  if (page_id == INVALID_PAGE_ID) {
+    page_id = free_space_map_.Find(stored[next].size_);
+  }
+  while (page_id != INVALID_PAGE_ID) {
+    auto page = static_cast<TablePage *>(buffer_pool_manager_->FetchPageWithStrategy(page_id, strategy));
+    if (page == nullptr) {
+      txn->SetState(TransactionState::ABORTED);
+      return false;
+    }
+    page->WLatch();
+    size_t inserted = FillPage(page, stored, tuples, next, rids, txn);
+    bool slots_locked = next + inserted < stored.size() && page->GetMaxInsertSize() >= stored[next + inserted].size_;
+    page->WUnlatch();
+    buffer_pool_manager_->UnpinPage(page_id, inserted > 0);
+    if (inserted > 0) {
+      hint = page_id;
+    }
+    next += inserted;
+    if (next == stored.size()) {
+      return true;
+    }
+    // as for a single tuple, a page whose free slots are locked is not gone back to
+    if (slots_locked) {
+      break;
+    }
+    page_id = free_space_map_.Find(stored[next].size_);
+  }
+
+  // The rest goes into new pages at the end of the table.
+  auto cur_page = static_cast<TablePage *>(buffer_pool_manager_->FetchPageWithStrategy(last_page_id_, strategy));
+  if (cur_page == nullptr) {
+    txn->SetState(TransactionState::ABORTED);
+    return false;
+  }
+  cur_page->WLatch();
+  // INVARIANT: cur_page is WLatched if you leave the loop normally.
+  while (true) {
+    bool dirty = FillPage(cur_page, stored, tuples, next, rids, txn) > 0;
+    next = rids->size();
+    if (next == stored.size()) {
+      break;
+    }
+    auto next_page_id = cur_page->GetNextPageId();
+    if (next_page_id != INVALID_PAGE_ID) {
+      cur_page->WUnlatch();
+      buffer_pool_manager_->UnpinPage(cur_page->GetTablePageId(), dirty);
+      cur_page = static_cast<TablePage *>(buffer_pool_manager_->FetchPageWithStrategy(next_page_id, strategy));
+      cur_page->WLatch();
+      continue;
+    }
+    auto new_page = static_cast<TablePage *>(NewTablePage(&next_page_id, strategy));
+    if (new_page == nullptr) {
+      cur_page->WUnlatch();
+      buffer_pool_manager_->UnpinPage(cur_page->GetTablePageId(), dirty);
+      txn->SetState(TransactionState::ABORTED);
+      return false;
+    }
+    new_page->WLatch();
+    cur_page->SetNextPageId(next_page_id);
+    new_page->Init(next_page_id, PAGE_SIZE, cur_page->GetTablePageId(), log_manager_, txn);
+    AddPage(next_page_id);
+    last_page_id_ = next_page_id;
+    cur_page->WUnlatch();
+    buffer_pool_manager_->UnpinPage(cur_page->GetTablePageId(), true);
+    cur_page = new_page;
+  }
+  hint = cur_page->GetTablePageId();
+  cur_page->WUnlatch();
+  buffer_pool_manager_->UnpinPage(cur_page->GetTablePageId(), true);
+  return true;
+}
+
+bool TableHeap::AppendTuples(const std::vector<Tuple> &tuples, std::vector<RID> *rids, BufferAccessStrategy *strategy) {
+  rids->clear();
+  rids->reserve(tuples.size());
+  std::vector<Tuple> stored;
+  std::vector<bool> is_toasted(tuples.size());
+  stored.reserve(tuples.size());
+  bool fits = true;
+  for (size_t i = 0; i < tuples.size(); i++) {
+    Tuple toasted;
+    is_toasted[i] = toast_ != nullptr && toast_->Toast(tuples[i], &toasted);
+    stored.push_back(is_toasted[i] ? std::move(toasted) : tuples[i].AsView());
+    fits = fits && stored.back().size_ + 32 <= PAGE_SIZE;
+  }
+  std::call_once(free_space_map_built_, [this, strategy] { BuildFreeSpaceMap(strategy); });
+
+  // Fill new pages, chained to each other; they are latched only for the background flusher of the pool.
+  std::vector<page_id_t> page_ids;
+  std::vector<uint32_t> max_insert_sizes;
+  TablePage *page = nullptr;
+  size_t next = 0;
+  while (fits && next < stored.size()) {
+    page_id_t page_id;
+    auto new_page = static_cast<TablePage *>(NewTablePage(&page_id, strategy));
+    if (new_page == nullptr) {
+      break;
+    }
+    new_page->WLatch();
+    new_page->Init(page_id, PAGE_SIZE, page_ids.empty() ? INVALID_PAGE_ID : page_ids.back(), nullptr, nullptr);
+    if (page != nullptr) {
+      page->SetNextPageId(page_id);
+      page->WUnlatch();
+      buffer_pool_manager_->UnpinPage(page->GetTablePageId(), true);
+    }
+    page = new_page;
+    next += page->InsertTuples(stored, next, rids, nullptr, nullptr, nullptr, table_oid_);
+    page_ids.push_back(page_id);
+    max_insert_sizes.push_back(page->GetMaxInsertSize());
+  }
+  if (page != nullptr) {
+    page->WUnlatch();
+    buffer_pool_manager_->UnpinPage(page->GetTablePageId(), true);
+  }
+  if (!page_ids.empty() && !LinkPages(page_ids, max_insert_sizes, tuples, *rids, strategy)) {
+    rids->clear();
+  }
+  // the tuples that did not make it in free their chains
+  for (size_t i = rids->size(); i < stored.size(); i++) {
+    if (is_toasted[i]) {
+      toast_->Free(stored[i]);
+    }
+  }
+  if (!rids->empty()) {
+    BumpModificationCount();
+  }
+  return rids->size() == tuples.size();
+}
+
+bool TableHeap::LinkPages(const std::vector<page_id_t> &page_ids, const std::vector<uint32_t> &max_insert_sizes,
+                          const std::vector<Tuple> &tuples, const std::vector<RID> &rids,
+                          BufferAccessStrategy *strategy) {
+  // the end of the table is found as for an insert, from the last page it knows of
+  auto last_page = static_cast<TablePage *>(buffer_pool_manager_->FetchPageWithStrategy(last_page_id_, strategy));
+  if (last_page == nullptr) {
+    return false;
+  }
+  last_page->WLatch();
+  while (last_page->GetNextPageId() != INVALID_PAGE_ID) {
+    page_id_t next_page_id = last_page->GetNextPageId();
+    last_page->WUnlatch();
+    buffer_pool_manager_->UnpinPage(last_page->GetTablePageId(), false);
+    last_page = static_cast<TablePage *>(buffer_pool_manager_->FetchPageWithStrategy(next_page_id, strategy));
+    BUSTUB_ASSERT(last_page != nullptr, "Couldn't fetch a page of the table heap.");
+    last_page->WLatch();
+  }
+  auto first_page = static_cast<TablePage *>(buffer_pool_manager_->FetchPageWithStrategy(page_ids[0], strategy));
+  BUSTUB_ASSERT(first_page != nullptr, "Couldn't fetch a page of the table heap.");
+  first_page->WLatch();
+  first_page->SetPrevPageId(last_page->GetTablePageId());
+  first_page->WUnlatch();
+  buffer_pool_manager_->UnpinPage(page_ids[0], true);
+
+  // the pages are recorded before they can be reached, as a new page of an insert is
+  for (page_id_t page_id : page_ids) {
+    AddPage(page_id);
+  }
+  for (size_t i = 0; i < rids.size(); i++) {
+    tids_.Bump(rids[i]);
+    if (zone_map_ != nullptr) {
+      zone_map_->Update(rids[i].GetPageId(), tuples[i]);
+    }
+  }
+  last_page->SetNextPageId(page_ids[0]);
+  last_page_id_ = page_ids.back();
+  last_page->WUnlatch();
+  buffer_pool_manager_->UnpinPage(last_page->GetTablePageId(), true);
+  for (size_t i = 0; i < page_ids.size(); i++) {
+    free_space_map_.Update(page_ids[i], max_insert_sizes[i]);
+  }
+  return true;
+}
+
+size_t TableHeap::FillPage(TablePage *page, const std::vector<Tuple> &stored, const std::vector<Tuple> &tuples,
+                           size_t begin, std::vector<RID> *rids, Transaction *txn) {
+  size_t inserted = page->InsertTuples(stored, begin, rids, txn, lock_manager_, log_manager_, table_oid_);
+  free_space_map_.Update(page->GetTablePageId(), page->GetMaxInsertSize());
+  for (size_t i = begin; i < begin + inserted; i++) {
+    tids_.Bump(rids->at(i));
+    if (IsVersioned(txn)) {
+      AppendVersion(rids->at(i), txn, nullptr);
+    }
+    if (zone_map_ != nullptr) {
+      zone_map_->Update(page->GetTablePageId(), tuples[i]);
+    }
+    txn->GetWriteSet()->emplace_back(rids->at(i), WType::INSERT, Tuple{}, this);
+  }
+  return inserted;
+}
+
+Page *TableHeap::NewTablePage(page_id_t *page_id, BufferAccessStrategy *strategy) {
+  std::scoped_lock latch{extent_latch_};
+  if (next_extent_page_id_ == extent_end_) {
+    page_id_t first = buffer_pool_manager_->AllocateExtent(TABLE_HEAP_EXTENT_SIZE);
+    if (first == INVALID_PAGE_ID) {
+      return buffer_pool_manager_->NewPageWithStrategy(page_id, strategy);
+    }
+    next_extent_page_id_ = first;
+    extent_end_ = first + TABLE_HEAP_EXTENT_SIZE;
+  }
+  // a page id that found no frame is tried again next time
+  Page *page = buffer_pool_manager_->NewPageWithId(next_extent_page_id_, strategy);
+  if (page != nullptr) {
+    *page_id = next_extent_page_id_++;
+  }
+  return page;
+}
+
+void TableHeap::CreateZoneMap(const Schema *schema, const std::vector<uint32_t> &column_idxs, Transaction *txn) {
+  BUSTUB_ASSERT(zone_map_ == nullptr, "the table keeps a zone map already");
+  auto zone_map = std::make_unique<ZoneMap>(schema, column_idxs);
+  page_id_t page_id = first_page_id_;
+  while (page_id != INVALID_PAGE_ID) {
+    auto page = static_cast<TablePage *>(buffer_pool_manager_->FetchPage(page_id));
+    BUSTUB_ASSERT(page != nullptr, "Couldn't fetch a page of the table heap.");
+    page->RLatch();
+    // every page is added, empty ones too, so that the map knows the whole list
+    zone_map->AddPage(page_id);
+    RID rid;
+    bool found = page->GetFirstTupleRid(&rid);
+    while (found) {
+      Tuple view;
+      if (page->GetTupleView(rid, &view, txn, lock_manager_, table_oid_)) {
+        if (toast_ != nullptr && toast_->IsToasted(view)) {
+          Tuple detoasted;
+          toast_->Detoast(view, &detoasted);
+          zone_map->Update(page_id, detoasted);
+        } else {
+          zone_map->Update(page_id, view);
+        }
+      }
+      RID next_rid;
+      found = page->GetNextTupleRid(rid, &next_rid);
+      rid = next_rid;
+    }
+    page_id_t next_page_id = page->GetNextPageId();
+    page->RUnlatch();
+    buffer_pool_manager_->UnpinPage(page_id, false);
+    page_id = next_page_id;
+  }
+  zone_map_ = std::move(zone_map);
+}
+
+void TableHeap::EnableToast(const Schema *schema) {
+  BUSTUB_ASSERT(toast_ == nullptr, "the table has a toast store already");
+  toast_ = std::make_unique<ToastStore>(buffer_pool_manager_, schema);
+}
+
+void TableHeap::BuildFreeSpaceMap(BufferAccessStrategy *strategy) {
+  page_id_t page_id = first_page_id_;
+  while (page_id != INVALID_PAGE_ID) {
+    auto page = static_cast<TablePage *>(buffer_pool_manager_->FetchPageWithStrategy(page_id, strategy));
+    BUSTUB_ASSERT(page != nullptr, "Couldn't fetch a page of the table heap.");
+    page->RLatch();
+    free_space_map_.Update(page_id, page->GetMaxInsertSize());
+    page_id_t next_page_id = page->GetNextPageId();
+    page->RUnlatch();
+    buffer_pool_manager_->UnpinPage(page_id, false);
+    {
+      std::scoped_lock latch{page_ids_latch_};
+      page_ids_.push_back(page_id);
+    }
+    last_page_id_ = page_id;
+    page_id = next_page_id;
+  }
+}
+
+void TableHeap::AddPage(page_id_t page_id) {
+  if (zone_map_ != nullptr) {
+    zone_map_->AddPage(page_id);
+  }
+  std::scoped_lock latch{page_ids_latch_};
+  page_ids_.push_back(page_id);
+}
+
+std::vector<page_id_t> TableHeap::GetPageIds(BufferAccessStrategy *strategy) {
+  std::call_once(free_space_map_built_, [this, strategy] { BuildFreeSpaceMap(strategy); });
+  std::scoped_lock latch{page_ids_latch_};
+  return page_ids_;
+}
+
+std::vector<page_id_t> TableHeap::GetSampledPageIds(double fraction, uint64_t seed, BufferAccessStrategy *strategy) {
+  std::vector<page_id_t> sampled;
+  std::mt19937_64 random(seed);
+  std::bernoulli_distribution pick(std::clamp(fraction, 0.0, 1.0));
+  for (page_id_t page_id : GetPageIds(strategy)) {
+    if (pick(random)) {
+      sampled.push_back(page_id);
+    }
+  }
+  return sampled;
+}
+
+size_t TableHeap::InsertHintSlot() {
+  return std::hash<std::thread::id>()(std::this_thread::get_id()) % NUM_INSERT_HINTS;
+}
+
 bool TableHeap::MarkDelete(const RID &rid, Transaction *txn) {
+  if (IsBuffered(txn)) {
+    txn->GetWriteSet()->emplace_back(rid, WType::DELETE, Tuple{}, this);
+    return true;
+  }
   // TODO(Amadou): remove empty page
+  if (!LockRows({rid}, txn, true)) {
+    return false;
+  }
   // Find the page which contains the tuple.
   auto page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(rid.GetPageId()));
   // If the page could not be found, then abort the transaction.
@@ -101,15 +550,222 @@ bool TableHeap::MarkDelete(const RID &rid, Transaction *txn) {
   }
   // Otherwise, mark the tuple as deleted.
   page->WLatch();
-  page->MarkDelete(rid, txn, lock_manager_, log_manager_);
+  bool marked = MarkVersionedDelete(page, rid, txn);
   page->WUnlatch();
   buffer_pool_manager_->UnpinPage(page->GetTablePageId(), true);
-  // Update the transaction's write set.
-  txn->GetWriteSet()->emplace_back(rid, WType::DELETE, Tuple{}, this);
+  // Update the transaction's write set, with a delete to apply or roll back only if there was a tuple to mark.
+  if (marked) {
+    txn->GetWriteSet()->emplace_back(rid, WType::DELETE, Tuple{}, this);
+  }
   return true;
 }
 
+bool TableHeap::LockRows(const std::vector<RID> &rids, Transaction *txn, bool exclusive) {
+  if (!enable_logging || txn == nullptr || lock_manager_ == nullptr) {
+    return true;
+  }
+  for (const RID &rid : rids) {
+    if (txn->IsExclusiveLocked(rid) || (!exclusive && txn->IsSharedLocked(rid))) {
+      continue;
+    }
+    bool locked;
+    if (!exclusive) {
+      locked = lock_manager_->LockShared(txn, rid, table_oid_);
+    } else if (txn->IsSharedLocked(rid)) {
+      locked = lock_manager_->LockUpgrade(txn, rid, table_oid_);
+    } else {
+      locked = lock_manager_->LockExclusive(txn, rid, table_oid_);
+    }
+    if (!locked) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool TableHeap::LockForInsert(Transaction *txn) {
+  if (!enable_logging || txn == nullptr || lock_manager_ == nullptr || table_oid_ == INVALID_TABLE_OID) {
+    return true;
+  }
+  return lock_manager_->LockTable(txn, table_oid_, LockMode::INTENTION_EXCLUSIVE);
+}
+
+bool TableHeap::MarkVersionedDelete(TablePage *page, const RID &rid, Transaction *txn) {
+  if (!CheckWriteConflict(rid, txn)) {
+    return false;
+  }
+  // marking the tuple leaves its bytes as they are, so the view is the version before the delete still
+  Tuple before;
+  bool deleted = false;
+  bool versioned = IsVersioned(txn) && page->ReadTuple(rid, &before, &deleted) && !deleted;
+  if (!page->MarkDelete(rid, txn, lock_manager_, log_manager_, table_oid_)) {
+    return false;
+  }
+  tids_.Bump(rid);
+  if (versioned) {
+    AppendVersion(rid, txn, &before);
+  }
+  return true;
+}
+
+bool TableHeap::CheckWriteConflict(const RID &rid, Transaction *txn) {
+  if (txn->GetIsolationLevel() != IsolationLevel::SNAPSHOT || !IsVersioned(txn) ||
+      !versions_.IsWriteConflict(rid, txn)) {
+    return true;
+  }
+  txn->SetState(TransactionState::ABORTED);
+  return false;
+}
+
+void TableHeap::AppendVersion(const RID &rid, Transaction *txn, const Tuple *before) {
+  if (before == nullptr) {
+    versions_.Append(rid, txn->GetTransactionId(), false, Tuple{});
+  } else if (toast_ != nullptr && toast_->IsToasted(*before)) {
+    // the overflow chains of the version are freed as the write commits, so the version keeps the values themselves
+    Tuple detoasted;
+    toast_->Detoast(*before, &detoasted);
+    versions_.Append(rid, txn->GetTransactionId(), true, detoasted);
+  } else {
+    versions_.Append(rid, txn->GetTransactionId(), true, *before);
+  }
+}
+
+/** @return the positions of the rids, ordered by page and then slot, so that the rids of a page come in a run */
+static std::vector<size_t> PageOrder(const std::vector<RID> &rids) {
+  std::vector<size_t> order(rids.size());
+  for (size_t i = 0; i < order.size(); i++) {
+    order[i] = i;
+  }
+  std::sort(order.begin(), order.end(), [&rids](size_t a, size_t b) {
+    if (rids[a].GetPageId() != rids[b].GetPageId()) {
+      return rids[a].GetPageId() < rids[b].GetPageId();
+    }
+    return rids[a].GetSlotNum() < rids[b].GetSlotNum();
+  });
+  return order;
+}
+
+bool TableHeap::MarkDeletes(const std::vector<RID> &rids, Transaction *txn) {
+  if (IsBuffered(txn)) {
+    for (const RID &rid : rids) {
+      txn->GetWriteSet()->emplace_back(rid, WType::DELETE, Tuple{}, this);
+    }
+    return true;
+  }
+  if (!LockRows(rids, txn, true)) {
+    return false;
+  }
+  std::vector<size_t> order = PageOrder(rids);
+  for (size_t begin = 0; begin < order.size();) {
+    page_id_t page_id = rids[order[begin]].GetPageId();
+    auto page = static_cast<TablePage *>(buffer_pool_manager_->FetchPage(page_id));
+    if (page == nullptr) {
+      txn->SetState(TransactionState::ABORTED);
+      return false;
+    }
+    size_t end = begin;
+    bool marked = true;
+    page->WLatch();
+    for (; end < order.size() && rids[order[end]].GetPageId() == page_id; end++) {
+      const RID &rid = rids[order[end]];
+      if (!MarkVersionedDelete(page, rid, txn)) {
+        marked = false;
+        break;
+      }
+      txn->GetWriteSet()->emplace_back(rid, WType::DELETE, Tuple{}, this);
+    }
+    page->WUnlatch();
+    buffer_pool_manager_->UnpinPage(page_id, end > begin);
+    if (!marked) {
+      return false;
+    }
+    begin = end;
+  }
+  return true;
+}
+
+bool TableHeap::UpdateTuples(const std::vector<Tuple> &tuples, const std::vector<RID> &rids, Transaction *txn,
+                             std::vector<bool> *updated) {
+  if (IsBuffered(txn)) {
+    for (size_t i = 0; i < tuples.size(); i++) {
+      txn->GetWriteSet()->emplace_back(rids[i], WType::UPDATE, tuples[i], this);
+    }
+    updated->assign(tuples.size(), true);
+    return true;
+  }
+  updated->assign(tuples.size(), false);
+  if (!LockRows(rids, txn, true)) {
+    return false;
+  }
+  // large values are moved out before any page is latched, as in UpdateTuple
+  std::vector<Tuple> toasted(tuples.size());
+  std::vector<bool> is_toasted(tuples.size(), false);
+  for (size_t i = 0; toast_ != nullptr && i < tuples.size(); i++) {
+    is_toasted[i] = toast_->Toast(tuples[i], &toasted[i]);
+  }
+
+  std::vector<size_t> order = PageOrder(rids);
+  bool fetched = true;
+  bool conflict = false;
+  for (size_t begin = 0; begin < order.size() && !conflict;) {
+    page_id_t page_id = rids[order[begin]].GetPageId();
+    auto page = static_cast<TablePage *>(buffer_pool_manager_->FetchPage(page_id));
+    if (page == nullptr) {
+      txn->SetState(TransactionState::ABORTED);
+      fetched = false;
+      break;
+    }
+    std::vector<std::pair<size_t, Tuple>> old_tuples;
+    size_t end = begin;
+    page->WLatch();
+    for (; end < order.size() && rids[order[end]].GetPageId() == page_id; end++) {
+      size_t i = order[end];
+      Tuple old_tuple;
+      if (!CheckWriteConflict(rids[i], txn)) {
+        conflict = true;
+        break;
+      }
+      if (page->UpdateTuple(is_toasted[i] ? toasted[i] : tuples[i], &old_tuple, rids[i], txn, lock_manager_,
+                            log_manager_, table_oid_)) {
+        (*updated)[i] = true;
+        tids_.Bump(rids[i]);
+        if (IsVersioned(txn)) {
+          AppendVersion(rids[i], txn, &old_tuple);
+        }
+        if (zone_map_ != nullptr) {
+          zone_map_->Update(page_id, tuples[i]);
+        }
+        old_tuples.emplace_back(i, std::move(old_tuple));
+      }
+    }
+    free_space_map_.Update(page_id, page->GetMaxInsertSize());
+    page->WUnlatch();
+    buffer_pool_manager_->UnpinPage(page_id, !old_tuples.empty());
+    for (auto &[i, old_tuple] : old_tuples) {
+      if (txn->GetState() != TransactionState::ABORTED) {
+        txn->GetWriteSet()->emplace_back(rids[i], WType::UPDATE, old_tuple, this);
+      } else if (toast_ != nullptr) {
+        toast_->Free(old_tuple);
+      }
+    }
+    begin = end;
+  }
+  for (size_t i = 0; i < tuples.size(); i++) {
+    if (is_toasted[i] && !(*updated)[i]) {
+      toast_->Free(toasted[i]);
+    }
+  }
+  return fetched && !conflict;
+}
+
 bool TableHeap::UpdateTuple(const Tuple &tuple, const RID &rid, Transaction *txn) {
+  if (IsBuffered(txn)) {
+    txn->GetWriteSet()->emplace_back(rid, WType::UPDATE, tuple, this);
+    return true;
+  }
+  if (!LockRows({rid}, txn, true)) {
+    return false;
+  }
   // Find the page which contains the tuple.
   auto page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(rid.GetPageId()));
   // If the page could not be found, then abort the transaction.
@@ -117,29 +773,61 @@ bool TableHeap::UpdateTuple(const Tuple &tuple, const RID &rid, Transaction *txn
     txn->SetState(TransactionState::ABORTED);
     return false;
   }
+  Tuple toasted;
+  bool is_toasted = toast_ != nullptr && toast_->Toast(tuple, &toasted);
   // Update the tuple; but first save the old value for rollbacks.
   Tuple old_tuple;
   page->WLatch();
-  bool is_updated = page->UpdateTuple(tuple, &old_tuple, rid, txn, lock_manager_, log_manager_);
+  bool is_updated =
+      CheckWriteConflict(rid, txn) &&
+      page->UpdateTuple(is_toasted ? toasted : tuple, &old_tuple, rid, txn, lock_manager_, log_manager_, table_oid_);
+  if (is_updated) {
+    tids_.Bump(rid);
+  }
+  if (is_updated && IsVersioned(txn)) {
+    AppendVersion(rid, txn, &old_tuple);
+  }
+  free_space_map_.Update(rid.GetPageId(), page->GetMaxInsertSize());
+  if (is_updated && zone_map_ != nullptr) {
+    zone_map_->Update(rid.GetPageId(), tuple);
+  }
   page->WUnlatch();
   buffer_pool_manager_->UnpinPage(page->GetTablePageId(), is_updated);
+  if (!is_updated && is_toasted) {
+    toast_->Free(toasted);
+  }
   // Update the transaction's write set.
   if (is_updated && txn->GetState() != TransactionState::ABORTED) {
     txn->GetWriteSet()->emplace_back(rid, WType::UPDATE, old_tuple, this);
+  } else if (is_updated && toast_ != nullptr) {
+    // a rollback puts back an older version, and the version it replaces was never committed
+    toast_->Free(old_tuple);
   }
   return is_updated;
 }
 
+void TableHeap::ApplyUpdate(const Tuple &old_tuple) {
+  if (toast_ != nullptr) {
+    toast_->Free(old_tuple);
+  }
+}
+
 void TableHeap::ApplyDelete(const RID &rid, Transaction *txn) {
   // Find the page which contains the tuple.
   auto page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(rid.GetPageId()));
   BUSTUB_ASSERT(page != nullptr, "Couldn't find a page containing that RID.");
   // Delete the tuple from the page.
+  Tuple deleted;
   page->WLatch();
-  page->ApplyDelete(rid, txn, log_manager_);
+  page->ApplyDelete(rid, txn, log_manager_, toast_ != nullptr ? &deleted : nullptr);
+  tids_.Bump(rid);
+  free_space_map_.Update(rid.GetPageId(), page->GetMaxInsertSize());
   lock_manager_->Unlock(txn, rid);
   page->WUnlatch();
   buffer_pool_manager_->UnpinPage(page->GetTablePageId(), true);
+  if (toast_ != nullptr) {
+    toast_->Free(deleted);
+  }
 }
 
 void TableHeap::RollbackDelete(const RID &rid, Transaction *txn) {
@@ -149,11 +837,58 @@ void TableHeap::RollbackDelete(const RID &rid, Transaction *txn) {
   // Rollback the delete.
   page->WLatch();
   page->RollbackDelete(rid, txn, log_manager_);
+  tids_.Bump(rid);
   page->WUnlatch();
   buffer_pool_manager_->UnpinPage(page->GetTablePageId(), true);
 }
 
+bool TableHeap::Vacuum(size_t max_pages, VacuumStats *stats) {
+  std::scoped_lock latch{vacuum_latch_};
+  page_id_t page_id = vacuum_cursor_ == INVALID_PAGE_ID ? first_page_id_ : vacuum_cursor_;
+  for (size_t i = 0; i < max_pages && page_id != INVALID_PAGE_ID; i++) {
+    auto page = static_cast<TablePage *>(buffer_pool_manager_->FetchPage(page_id));
+    if (page == nullptr) {
+      // every frame is pinned; the vacuum goes on from this page next time
+      break;
+    }
+    // a look under the read latch first, so that pages with nothing to reclaim do not hold up writers
+    page->RLatch();
+    bool reclaimable = page->GetReclaimableSize() > 0;
+    bool empty = page->IsEmpty();
+    page_id_t next_page_id = page->GetNextPageId();
+    page->RUnlatch();
+    uint32_t reclaimed = 0;
+    if (reclaimable) {
+      page->WLatch();
+      reclaimed = page->Compact();
+      empty = page->IsEmpty();
+      free_space_map_.Update(page_id, page->GetMaxInsertSize());
+      next_page_id = page->GetNextPageId();
+      page->WUnlatch();
+    }
+    stats->pages_++;
+    if (reclaimed > 0) {
+      stats->compacted_pages_++;
+      stats->reclaimed_bytes_ += reclaimed;
+    }
+    if (empty) {
+      stats->empty_pages_++;
+    }
+    buffer_pool_manager_->UnpinPage(page_id, reclaimed > 0);
+    page_id = next_page_id;
+  }
+  vacuum_cursor_ = page_id;
+  return page_id == INVALID_PAGE_ID;
+}
+
 bool TableHeap::GetTuple(const RID &rid, Tuple *tuple, Transaction *txn) {
+  if (txn->GetIsolationLevel() == IsolationLevel::OPTIMISTIC) {
+    return GetOptimisticTuple(rid, tuple, txn);
+  }
+  bool snapshot = txn->GetIsolationLevel() == IsolationLevel::SNAPSHOT && txn->GetReadTs() != INVALID_TS;
+  if (!snapshot && !LockRows({rid}, txn, false)) {
+    return false;
+  }
   // Find the page which contains the tuple.
   auto page = static_cast<TablePage *>(buffer_pool_manager_->FetchPage(rid.GetPageId()));
   // If the page could not be found, then abort the transaction.
@@ -161,24 +896,100 @@ bool TableHeap::GetTuple(const RID &rid, Tuple *tuple, Transaction *txn) {
     txn->SetState(TransactionState::ABORTED);
     return false;
   }
-  // Read the tuple from the page.
+  // Read the tuple from the page; a SNAPSHOT transaction reads the version it sees instead, without a lock.
   page->RLatch();
-  bool res = page->GetTuple(rid, tuple, txn, lock_manager_);
+  bool res;
+  if (snapshot) {
+    Tuple view;
+    bool deleted = false;
+    bool in_page = page->ReadTuple(rid, &view, &deleted) && !deleted;
+    res = versions_.GetVersion(rid, in_page ? &view : nullptr, txn, tuple);
+  } else {
+    res = page->GetTuple(rid, tuple, txn, lock_manager_, table_oid_);
+  }
   page->RUnlatch();
   buffer_pool_manager_->UnpinPage(rid.GetPageId(), false);
+  if (res && toast_ != nullptr && toast_->IsToasted(*tuple)) {
+    Tuple detoasted;
+    toast_->Detoast(*tuple, &detoasted);
+    *tuple = std::move(detoasted);
+  }
+  return res;
+}
+
+bool TableHeap::GetOptimisticTuple(const RID &rid, Tuple *tuple, Transaction *txn) {
+  // the transaction reads its own writes, the latest of which is the one to go by
+  auto write_set = txn->GetWriteSet();
+  for (auto item = write_set->rbegin(); IsBuffered(txn) && item != write_set->rend(); ++item) {
+    if (item->table_ != this || !(item->rid_ == rid) || item->wtype_ == WType::INSERT) {
+      continue;
+    }
+    if (item->wtype_ == WType::DELETE) {
+      return false;
+    }
+    *tuple = item->tuple_;
+    return true;
+  }
+  auto page = static_cast<TablePage *>(buffer_pool_manager_->FetchPage(rid.GetPageId()));
+  if (page == nullptr) {
+    txn->SetState(TransactionState::ABORTED);
+    return false;
+  }
+  // the TIDs are kept from before the latch is taken, so that the writes after the read change the one it records
+  tids_.Activate();
+  page->RLatch();
+  Tuple view;
+  bool deleted = false;
+  bool res = page->ReadTuple(rid, &view, &deleted) && !deleted;
+  if (res) {
+    tuple->CopyFrom(view);
+  }
+  txn->GetReadSet()->emplace_back(rid, tids_.Get(rid), this);
+  page->RUnlatch();
+  buffer_pool_manager_->UnpinPage(rid.GetPageId(), false);
+  if (res && toast_ != nullptr && toast_->IsToasted(*tuple)) {
+    Tuple detoasted;
+    toast_->Detoast(*tuple, &detoasted);
+    *tuple = std::move(detoasted);
+  }
+  return res;
+}
+
+bool TableHeap::ReadWrittenTuple(const RID &rid, Tuple *tuple, bool *deleted) {
+  auto page = static_cast<TablePage *>(buffer_pool_manager_->FetchPage(rid.GetPageId()));
+  if (page == nullptr) {
+    return false;
+  }
+  page->RLatch();
+  Tuple view;
+  bool res = page->ReadTuple(rid, &view, deleted);
+  if (res) {
+    tuple->CopyFrom(view);
+  }
+  page->RUnlatch();
+  buffer_pool_manager_->UnpinPage(rid.GetPageId(), false);
+  if (res && toast_ != nullptr && toast_->IsToasted(*tuple)) {
+    Tuple detoasted;
+    toast_->Detoast(*tuple, &detoasted);
+    *tuple = std::move(detoasted);
+  }
   return res;
 }
 
-TableIterator TableHeap::Begin(Transaction *txn) {
+TableIterator TableHeap::Begin(Transaction *txn, BufferAccessStrategy *strategy) {
   // Start an iterator from the first page.
   // TODO(Wuwen): Hacky fix for now. Removing empty pages is a better way to handle this.
   RID rid;
   auto page_id = first_page_id_;
   while (page_id != INVALID_PAGE_ID) {
-    auto page = static_cast<TablePage *>(buffer_pool_manager_->FetchPage(page_id));
+    auto page = static_cast<TablePage *>(buffer_pool_manager_->FetchPageWithStrategy(page_id, strategy));
     page->RLatch();
     // If this fails because there is no tuple, then RID will be the default-constructed value, which means EOF.
     auto found_tuple = page->GetFirstTupleRid(&rid);
+    if (found_tuple) {
+      // the scan will want the next page soon; have it read while this one is being consumed
+      buffer_pool_manager_->PrefetchPages({page->GetNextPageId()}, strategy);
+    }
     page->RUnlatch();
     buffer_pool_manager_->UnpinPage(page_id, false);
     if (found_tuple) {
@@ -186,7 +997,7 @@ TableIterator TableHeap::Begin(Transaction *txn) {
     }
     page_id = page->GetNextPageId();
   }
-  return TableIterator(this, rid, txn);
+  return TableIterator(this, rid, txn, strategy);
 }
 
 TableIterator TableHeap::End() { return TableIterator(this, RID(INVALID_PAGE_ID, 0), nullptr); }
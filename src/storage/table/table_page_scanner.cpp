@@ -0,0 +1,203 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// table_page_scanner.cpp
+//
+// Identification: src/storage/table/table_page_scanner.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/table/table_page_scanner.h"
+
+#include <algorithm>
+#include <utility>
+
+#include "storage/table/table_heap.h"
+
+namespace bustub {
+
+TablePageScanner::TablePageScanner(TableHeap *table_heap, Transaction *txn, BufferAccessStrategy *strategy,
+                                   std::vector<ZoneRange> ranges)
+    : table_heap_(table_heap),
+      txn_(txn),
+      strategy_(strategy),
+      ranges_(std::move(ranges)),
+      snapshot_(IsSnapshot(txn)),
+      optimistic_(IsOptimistic(txn)) {
+  BUSTUB_ASSERT(ranges_.empty() || table_heap_->GetZoneMap() != nullptr, "the table keeps no zone map");
+  MoveToPage(NextCandidate(table_heap_->GetFirstPageId()));
+}
+
+TablePageScanner::TablePageScanner(TableHeap *table_heap, Transaction *txn, std::vector<page_id_t> page_ids,
+                                   BufferAccessStrategy *strategy)
+    : table_heap_(table_heap),
+      txn_(txn),
+      strategy_(strategy),
+      morsel_(std::move(page_ids)),
+      in_morsel_(true),
+      snapshot_(IsSnapshot(txn)),
+      optimistic_(IsOptimistic(txn)) {
+  MoveToPage(morsel_.empty() ? INVALID_PAGE_ID : morsel_[0]);
+}
+
+TablePageScanner::~TablePageScanner() {
+  MoveToPage(INVALID_PAGE_ID);
+  if (synchronized_) {
+    table_heap_->sync_scans_.fetch_sub(1, std::memory_order_relaxed);
+  }
+}
+
+std::unique_ptr<TablePageScanner> TablePageScanner::Synchronized(TableHeap *table_heap, Transaction *txn,
+                                                                 BufferAccessStrategy *strategy) {
+  std::unique_ptr<TablePageScanner> scanner;
+  page_id_t position = table_heap->sync_scan_page_.load(std::memory_order_relaxed);
+  if (table_heap->sync_scans_.load(std::memory_order_relaxed) != 0 && position != INVALID_PAGE_ID) {
+    std::vector<page_id_t> page_ids = table_heap->GetPageIds(strategy);
+    auto start = std::find(page_ids.begin(), page_ids.end(), position);
+    size_t pool_size = table_heap->buffer_pool_manager_->GetPoolSize();
+    if (page_ids.size() >= pool_size / SYNC_SCAN_POOL_FRACTION && start != page_ids.end()) {
+      std::rotate(page_ids.begin(), start, page_ids.end());
+      scanner = std::make_unique<TablePageScanner>(table_heap, txn, std::move(page_ids), strategy);
+    }
+  }
+  if (scanner == nullptr) {
+    scanner = std::make_unique<TablePageScanner>(table_heap, txn, strategy);
+  }
+  scanner->synchronized_ = true;
+  table_heap->sync_scans_.fetch_add(1, std::memory_order_relaxed);
+  return scanner;
+}
+
+bool TablePageScanner::Next(Tuple *view) {
+  while (page_ != nullptr) {
+    if (!latched_) {
+      Latch();
+    }
+    if (snapshot_) {
+      if (NextVersion(view)) {
+        return true;
+      }
+      continue;
+    }
+    RID next_rid;
+    bool found = rid_.GetPageId() == INVALID_PAGE_ID ? page_->GetFirstTupleRid(&next_rid)
+                                                     : page_->GetNextTupleRid(rid_, &next_rid);
+    if (!found) {
+      page_id_t next_page_id = PageAfter();
+      position_++;
+      MoveToPage(next_page_id);
+      continue;
+    }
+    rid_ = next_rid;
+    if (ReadView(view) && (filter_ == nullptr || filter_(*view))) {
+      return true;
+    }
+  }
+  return false;
+}
+
+bool TablePageScanner::NextVersion(Tuple *view) {
+  uint32_t slot = rid_.GetPageId() == INVALID_PAGE_ID ? 0 : rid_.GetSlotNum() + 1;
+  for (; slot < page_->GetTupleCount(); slot++) {
+    rid_.Set(page_->GetTablePageId(), slot);
+    auto version = page_versions_.find(slot);
+    if (version != page_versions_.end()) {
+      if (!version->second.has_value()) {
+        continue;
+      }
+      *view = version->second->AsView();
+    } else {
+      bool deleted = false;
+      if (!page_->ReadTuple(rid_, view, &deleted) || deleted) {
+        continue;
+      }
+    }
+    if (filter_ == nullptr || filter_(*view)) {
+      return true;
+    }
+  }
+  page_id_t next_page_id = PageAfter();
+  position_++;
+  MoveToPage(next_page_id);
+  return false;
+}
+
+bool TablePageScanner::ReadView(Tuple *view) {
+  if (!optimistic_) {
+    return page_->GetTupleView(rid_, view, txn_, table_heap_->lock_manager_, table_heap_->table_oid_);
+  }
+  // an optimistic scan takes no lock, but records the TID of every tuple it reads, the ones the filter drops too
+  bool deleted = false;
+  bool res = page_->ReadTuple(rid_, view, &deleted) && !deleted;
+  txn_->GetReadSet()->emplace_back(rid_, table_heap_->tids_.Get(rid_), table_heap_);
+  return res;
+}
+
+bool TablePageScanner::IsOptimistic(Transaction *txn) {
+  return txn != nullptr && txn->GetIsolationLevel() == IsolationLevel::OPTIMISTIC;
+}
+
+bool TablePageScanner::IsSnapshot(Transaction *txn) {
+  return txn != nullptr && txn->GetIsolationLevel() == IsolationLevel::SNAPSHOT && txn->GetReadTs() != INVALID_TS;
+}
+
+void TablePageScanner::Latch() {
+  if (optimistic_) {
+    table_heap_->tids_.Activate();
+  }
+  page_->RLatch();
+  latched_ = true;
+  // the versions are found again on every latch, as the page may have been written while the scanner let go of it
+  if (snapshot_) {
+    table_heap_->versions_.GetPageVersions(page_, txn_, &page_versions_);
+  }
+}
+
+void TablePageScanner::Release() {
+  if (latched_) {
+    page_->RUnlatch();
+    latched_ = false;
+  }
+}
+
+void TablePageScanner::MoveToPage(page_id_t page_id) {
+  if (page_ == nullptr && page_id == INVALID_PAGE_ID) {
+    // nothing to let go of, e.g. a scanner that ran to the end, which may outlive its table
+    rid_ = RID();
+    return;
+  }
+  BufferPoolManager *buffer_pool_manager = table_heap_->buffer_pool_manager_;
+  if (page_ != nullptr) {
+    Release();
+    buffer_pool_manager->UnpinPage(page_->GetPageId(), false);
+    page_ = nullptr;
+  }
+  rid_ = RID();
+  if (page_id == INVALID_PAGE_ID) {
+    return;
+  }
+  page_ = static_cast<TablePage *>(buffer_pool_manager->FetchPageWithStrategy(page_id, strategy_));
+  BUSTUB_ASSERT(page_ != nullptr, "Couldn't fetch a page of the table heap.");
+  if (synchronized_) {
+    table_heap_->sync_scan_page_.store(page_id, std::memory_order_relaxed);
+  }
+  Latch();
+  // read the page after this one while the tuples of this one are being consumed
+  buffer_pool_manager->PrefetchPages({PageAfter()}, strategy_);
+}
+
+page_id_t TablePageScanner::PageAfter() {
+  if (in_morsel_) {
+    return position_ + 1 < morsel_.size() ? morsel_[position_ + 1] : INVALID_PAGE_ID;
+  }
+  return NextCandidate(page_->GetNextPageId());
+}
+
+page_id_t TablePageScanner::NextCandidate(page_id_t page_id) {
+  return ranges_.empty() ? page_id : table_heap_->GetZoneMap()->NextCandidate(page_id, ranges_);
+}
+
+}  // namespace bustub
@@ -0,0 +1,75 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// table_vacuum.cpp
+//
+// Identification: src/storage/table/table_vacuum.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/table/table_vacuum.h"
+
+#include <algorithm>
+
+namespace bustub {
+
+TableVacuum::~TableVacuum() { Stop(); }
+
+void TableVacuum::AddTable(TableHeap *table) {
+  std::scoped_lock latch{latch_};
+  tables_.push_back(table);
+}
+
+void TableVacuum::RemoveTable(TableHeap *table) {
+  std::scoped_lock latch{latch_};
+  tables_.erase(std::remove(tables_.begin(), tables_.end(), table), tables_.end());
+}
+
+void TableVacuum::Start() {
+  std::scoped_lock latch{latch_};
+  if (running_) {
+    return;
+  }
+  running_ = true;
+  thread_ = std::make_unique<std::thread>([this] {
+    std::unique_lock latch{latch_};
+    while (!cv_.wait_for(latch, vacuum_interval, [this] { return !running_; })) {
+      latch.unlock();
+      RunOnce();
+      latch.lock();
+    }
+  });
+}
+
+void TableVacuum::Stop() {
+  {
+    std::scoped_lock latch{latch_};
+    if (!running_) {
+      return;
+    }
+    running_ = false;
+  }
+  cv_.notify_all();
+  thread_->join();
+  thread_.reset();
+}
+
+VacuumStats TableVacuum::RunOnce() {
+  std::scoped_lock latch{latch_};
+  VacuumStats round;
+  for (TableHeap *table : tables_) {
+    table->Vacuum(vacuum_pages_per_round, &round);
+  }
+  stats_ += round;
+  return round;
+}
+
+VacuumStats TableVacuum::GetStats() {
+  std::scoped_lock latch{latch_};
+  return stats_;
+}
+
+}  // namespace bustub
@@ -0,0 +1,50 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// tid_table.cpp
+//
+// Identification: src/storage/table/tid_table.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/table/tid_table.h"
+
+#include <mutex>  // NOLINT
+
+namespace bustub {
+
+uint64_t TidTable::Get(const RID &rid) {
+  std::shared_lock lock(latch_);
+  auto tid = tids_.find(rid);
+  return tid == tids_.end() ? 0 : tid->second;
+}
+
+void TidTable::Bump(const RID &rid) {
+  if (!active_.load()) {
+    return;
+  }
+  std::unique_lock lock(latch_);
+  uint64_t &tid = tids_[rid];
+  tid = (((tid & ~LOCK_BIT) + 1) & ~LOCK_BIT) | (tid & LOCK_BIT);
+}
+
+bool TidTable::TryLock(const RID &rid) {
+  std::unique_lock lock(latch_);
+  uint64_t &tid = tids_[rid];
+  if ((tid & LOCK_BIT) != 0) {
+    return false;
+  }
+  tid |= LOCK_BIT;
+  return true;
+}
+
+void TidTable::Unlock(const RID &rid, uint64_t tid) {
+  std::unique_lock lock(latch_);
+  uint64_t &word = tids_[rid];
+  word = tid != 0 ? tid & ~LOCK_BIT : word & ~LOCK_BIT;
+}
+
+}  // namespace bustub
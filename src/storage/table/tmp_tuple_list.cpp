@@ -0,0 +1,84 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// tmp_tuple_list.cpp
+//
+// Identification: src/storage/table/tmp_tuple_list.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/table/tmp_tuple_list.h"
+
+#include <algorithm>
+#include <utility>
+
+#include "common/exception.h"
+
+namespace bustub {
+
+TmpTupleList::~TmpTupleList() {
+  for (page_id_t page_id : page_ids_) {
+    bpm_->DeletePage(page_id);
+  }
+}
+
+void TmpTupleList::Append(const Tuple &tuple) {
+  if (tuple.GetLength() > TmpTuplePage::MaxTupleSize(PAGE_SIZE)) {
+    throw Exception(ExceptionType::OUT_OF_RANGE, "the tuple is too large for a temporary page");
+  }
+  if (spilled_bytes_ != nullptr) {
+    spilled_bytes_->fetch_add(tuple.GetLength(), std::memory_order_relaxed);
+  }
+  TmpTuple tmp_tuple(INVALID_PAGE_ID, 0);
+  if (!page_ids_.empty()) {
+    auto *page = reinterpret_cast<TmpTuplePage *>(bpm_->FetchPage(page_ids_.back()));
+    if (page == nullptr) {
+      throw Exception(ExceptionType::OUT_OF_MEMORY, "no frame left to spill a tuple to");
+    }
+    bool inserted = page->Insert(tuple, &tmp_tuple);
+    bpm_->UnpinPage(page_ids_.back(), inserted);
+    if (inserted) {
+      size_++;
+      tuple_bytes_ += tuple.GetLength();
+      return;
+    }
+  }
+
+  page_id_t page_id;
+  auto *page = reinterpret_cast<TmpTuplePage *>(bpm_->NewPage(&page_id));
+  if (page == nullptr) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "no frame left to spill a tuple to");
+  }
+  page_ids_.push_back(page_id);
+  page->Init(page_id, PAGE_SIZE);
+  page->Insert(tuple, &tmp_tuple);
+  bpm_->UnpinPage(page_id, true);
+  size_++;
+  tuple_bytes_ += tuple.GetLength();
+}
+
+bool TmpTupleList::Reader::Next(Tuple *tuple) {
+  while (next_tuple_ == tuples_.size()) {
+    if (next_page_ == list_->page_ids_.size()) {
+      return false;
+    }
+    page_id_t page_id = list_->page_ids_[next_page_++];
+    auto *page = reinterpret_cast<TmpTuplePage *>(list_->bpm_->FetchPage(page_id));
+    if (page == nullptr) {
+      throw Exception(ExceptionType::OUT_OF_MEMORY, "no frame left to read a spilled tuple into");
+    }
+    tuples_.clear();
+    next_tuple_ = 0;
+    page->GetTuples(PAGE_SIZE, &tuples_);
+    list_->bpm_->UnpinPage(page_id, false);
+    // a page has its newest tuple first
+    std::reverse(tuples_.begin(), tuples_.end());
+  }
+  *tuple = std::move(tuples_[next_tuple_++]);
+  return true;
+}
+
+}  // namespace bustub
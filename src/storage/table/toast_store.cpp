@@ -0,0 +1,176 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// toast_store.cpp
+//
+// Identification: src/storage/table/toast_store.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/table/toast_store.h"
+
+#include <algorithm>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "storage/page/overflow_page.h"
+
+namespace bustub {
+
+bool ToastStore::Toast(const Tuple &tuple, Tuple *stored) {
+  // a tuple with toasted values, such as the old version a rollback puts back, is stored as it is
+  if (tuple.GetLength() <= TOAST_TUPLE_THRESHOLD || IsToasted(tuple)) {
+    return false;
+  }
+  std::vector<Value> values;
+  values.reserve(schema_->GetColumnCount());
+  std::vector<uint32_t> candidates;
+  for (uint32_t i = 0; i < schema_->GetColumnCount(); i++) {
+    values.push_back(tuple.GetValue(schema_, i));
+    if (!schema_->GetColumn(i).IsInlined() && !values[i].IsNull() && values[i].GetLength() > sizeof(ToastPointer)) {
+      candidates.push_back(i);
+    }
+  }
+  // the largest values go first, so that as few values as can be are moved out
+  std::sort(candidates.begin(), candidates.end(),
+            [&values](uint32_t a, uint32_t b) { return values[a].GetLength() > values[b].GetLength(); });
+
+  uint32_t size = tuple.GetLength();
+  std::vector<uint32_t> toasted;
+  std::vector<page_id_t> chains;
+  for (uint32_t i : candidates) {
+    if (size <= TOAST_TUPLE_THRESHOLD) {
+      break;
+    }
+    ToastPointer pointer{WriteChain(values[i].GetData(), values[i].GetLength()), values[i].GetLength()};
+    if (pointer.first_page_id_ == INVALID_PAGE_ID) {
+      for (page_id_t chain : chains) {
+        FreeChain(chain);
+      }
+      return false;
+    }
+    chains.push_back(pointer.first_page_id_);
+    size -= values[i].GetLength() - sizeof(ToastPointer);
+    // the pointer takes the place of the value, and its length is marked once the tuple is serialized
+    values[i] = Value(TypeId::VARCHAR, reinterpret_cast<const char *>(&pointer), sizeof(ToastPointer), true);
+    toasted.push_back(i);
+  }
+  if (toasted.empty()) {
+    return false;
+  }
+
+  *stored = Tuple(values, schema_);
+  stored->SetRid(tuple.GetRid());
+  for (uint32_t i : toasted) {
+    uint32_t offset = *reinterpret_cast<uint32_t *>(stored->data_ + schema_->GetColumn(i).GetOffset());
+    memcpy(stored->data_ + offset, &Tuple::TOASTED_LENGTH, sizeof(uint32_t));
+  }
+  return true;
+}
+
+bool ToastStore::IsToasted(const Tuple &tuple) const {
+  for (uint32_t i : schema_->GetUnlinedColumns()) {
+    if (tuple.IsToasted(schema_, i)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+Value ToastStore::GetValue(const Tuple &tuple, uint32_t column_idx) {
+  if (!tuple.IsToasted(schema_, column_idx)) {
+    return tuple.GetValue(schema_, column_idx);
+  }
+  ToastPointer pointer = GetPointer(tuple, column_idx);
+  std::string data = ReadChain(pointer);
+  return Value(schema_->GetColumn(column_idx).GetType(), data.data(), pointer.length_, true);
+}
+
+void ToastStore::Detoast(const Tuple &tuple, Tuple *detoasted) {
+  std::vector<Value> values;
+  values.reserve(schema_->GetColumnCount());
+  for (uint32_t i = 0; i < schema_->GetColumnCount(); i++) {
+    values.push_back(GetValue(tuple, i));
+  }
+  *detoasted = Tuple(values, schema_);
+  detoasted->SetRid(tuple.GetRid());
+}
+
+void ToastStore::Free(const Tuple &tuple) {
+  for (uint32_t i : schema_->GetUnlinedColumns()) {
+    if (tuple.IsToasted(schema_, i)) {
+      FreeChain(GetPointer(tuple, i).first_page_id_);
+    }
+  }
+}
+
+ToastPointer ToastStore::GetPointer(const Tuple &tuple, uint32_t column_idx) const {
+  ToastPointer pointer;
+  memcpy(&pointer, tuple.GetDataPtr(schema_, column_idx) + sizeof(uint32_t), sizeof(ToastPointer));
+  return pointer;
+}
+
+page_id_t ToastStore::WriteChain(const char *data, uint32_t size) {
+  page_id_t first_page_id = INVALID_PAGE_ID;
+  page_id_t prev_page_id = INVALID_PAGE_ID;
+  OverflowPage *prev_page = nullptr;
+  uint32_t written = 0;
+  do {
+    page_id_t page_id;
+    auto page = reinterpret_cast<OverflowPage *>(buffer_pool_manager_->NewPage(&page_id));
+    if (page == nullptr) {
+      if (prev_page != nullptr) {
+        buffer_pool_manager_->UnpinPage(prev_page_id, true);
+        FreeChain(first_page_id);
+      }
+      return INVALID_PAGE_ID;
+    }
+    uint32_t piece = std::min<uint32_t>(OverflowPage::CAPACITY, size - written);
+    page->Init(page_id, data + written, piece);
+    written += piece;
+    if (prev_page == nullptr) {
+      first_page_id = page_id;
+    } else {
+      prev_page->SetNextPageId(page_id);
+      buffer_pool_manager_->UnpinPage(prev_page_id, true);
+    }
+    prev_page = page;
+    prev_page_id = page_id;
+  } while (written < size);
+  buffer_pool_manager_->UnpinPage(prev_page_id, true);
+  return first_page_id;
+}
+
+std::string ToastStore::ReadChain(const ToastPointer &pointer) {
+  std::string data;
+  data.reserve(pointer.length_);
+  page_id_t page_id = pointer.first_page_id_;
+  while (page_id != INVALID_PAGE_ID) {
+    auto page = reinterpret_cast<OverflowPage *>(buffer_pool_manager_->FetchPage(page_id));
+    BUSTUB_ASSERT(page != nullptr, "Couldn't fetch an overflow page.");
+    data.append(page->GetPiece(), page->GetDataSize());
+    page_id_t next_page_id = page->GetNextPageId();
+    buffer_pool_manager_->UnpinPage(page_id, false);
+    page_id = next_page_id;
+  }
+  BUSTUB_ASSERT(data.size() == pointer.length_, "an overflow chain has to hold its value");
+  return data;
+}
+
+void ToastStore::FreeChain(page_id_t first_page_id) {
+  page_id_t page_id = first_page_id;
+  while (page_id != INVALID_PAGE_ID) {
+    auto page = reinterpret_cast<OverflowPage *>(buffer_pool_manager_->FetchPage(page_id));
+    BUSTUB_ASSERT(page != nullptr, "Couldn't fetch an overflow page.");
+    page_id_t next_page_id = page->GetNextPageId();
+    buffer_pool_manager_->UnpinPage(page_id, false);
+    buffer_pool_manager_->DeletePage(page_id);
+    page_id = next_page_id;
+  }
+}
+
+}  // namespace bustub
@@ -21,21 +21,35 @@
 namespace bustub {
 
 // TODO(Amadou): It does not look like nulls are supported. Add a null bitmap?
-Tuple::Tuple(std::vector<Value> values, const Schema *schema) : allocated_(true) {
-  assert(values.size() == schema->GetColumnCount());
-
+Tuple::Tuple(const std::vector<Value> &values, const Schema *schema) {
   // 1. Calculate the size of the tuple.
-  uint32_t tuple_size = schema->GetLength();
-  for (auto &i : schema->GetUnlinedColumns()) {
-    tuple_size += (values[i].GetLength() + sizeof(uint32_t));
-  }
+  size_ = SizeOf(values, schema);
 
   // 2. Allocate memory.
-  size_ = tuple_size;
-  data_ = new char[size_];
-  std::memset(data_, 0, size_);
+  capacity_ = size_;
+  AllocateData();
 
   // 3. Serialize each attribute based on the input value.
+  Serialize(values, schema, data_, size_);
+}
+
+Tuple::Tuple(const std::vector<Value> &values, const Schema *schema, MemoryArena *arena)
+    : size_(SizeOf(values, schema)), data_(arena->Allocate(size_, alignof(uint32_t))) {
+  Serialize(values, schema, data_, size_);
+}
+
+uint32_t Tuple::SizeOf(const std::vector<Value> &values, const Schema *schema) {
+  assert(values.size() == schema->GetColumnCount());
+  uint32_t tuple_size = schema->GetLength();
+  for (auto &i : schema->GetUnlinedColumns()) {
+    // a null VARCHAR is serialized as its length only
+    tuple_size += (values[i].IsNull() ? 0 : values[i].GetLength()) + sizeof(uint32_t);
+  }
+  return tuple_size + NullBitmapSize(schema);
+}
+
+void Tuple::Serialize(const std::vector<Value> &values, const Schema *schema, char *data, uint32_t size) {
+  std::memset(data, 0, size);
   uint32_t column_count = schema->GetColumnCount();
   uint32_t offset = schema->GetLength();
 
@@ -43,60 +57,127 @@ Tuple::Tuple(std::vector<Value> values, const Schema *schema) : allocated_(true)
     const auto &col = schema->GetColumn(i);
     if (!col.IsInlined()) {
       // Serialize relative offset, where the actual varchar data is stored.
-      *reinterpret_cast<uint32_t *>(data_ + col.GetOffset()) = offset;
+      *reinterpret_cast<uint32_t *>(data + col.GetOffset()) = offset;
       // Serialize varchar value, in place (size+data).
-      values[i].SerializeTo(data_ + offset);
-      offset += (values[i].GetLength() + sizeof(uint32_t));
+      values[i].SerializeTo(data + offset);
+      offset += (values[i].IsNull() ? 0 : values[i].GetLength()) + sizeof(uint32_t);
     } else {
-      values[i].SerializeTo(data_ + col.GetOffset());
+      values[i].SerializeTo(data + col.GetOffset());
+    }
+    if (values[i].IsNull()) {
+      data[size - NullBitmapSize(schema) + i / 8] |= static_cast<char>(1 << (i % 8));
     }
   }
 }
 
-Tuple::Tuple(const Tuple &other) : allocated_(other.allocated_), rid_(other.rid_), size_(other.size_) {
-  if (allocated_) {
-    delete[] data_;
-  }
-  if (allocated_) {
+Tuple::Tuple(const Tuple &other) : rid_(other.rid_), size_(other.size_) {
+  if (other.allocated_) {
     // Deep copy.
-    data_ = new char[size_];
-    memcpy(data_, other.data_, size_);
+    CopyData(other.data_, other.size_);
   } else {
     // Shallow copy.
     data_ = other.data_;
   }
 }
 
+Tuple::Tuple(Tuple &&other) noexcept
+    : allocated_(other.allocated_),
+      rid_(other.rid_),
+      size_(other.size_),
+      capacity_(other.capacity_),
+      data_(other.data_) {
+  other.allocated_ = false;
+  other.size_ = 0;
+  other.capacity_ = 0;
+  other.data_ = nullptr;
+}
+
 Tuple &Tuple::operator=(const Tuple &other) {
-  if (allocated_) {
-    delete[] data_;
+  if (this == &other) {
+    return *this;
   }
-  allocated_ = other.allocated_;
   rid_ = other.rid_;
-  size_ = other.size_;
-
-  if (allocated_) {
+  if (other.allocated_) {
     // Deep copy.
-    data_ = new char[size_];
-    memcpy(data_, other.data_, size_);
+    CopyData(other.data_, other.size_);
   } else {
     // Shallow copy.
+    FreeData();
+    capacity_ = 0;
+    size_ = other.size_;
     data_ = other.data_;
   }
+  return *this;
+}
 
+Tuple &Tuple::operator=(Tuple &&other) noexcept {
+  if (this == &other) {
+    return *this;
+  }
+  FreeData();
+  allocated_ = other.allocated_;
+  rid_ = other.rid_;
+  size_ = other.size_;
+  capacity_ = other.capacity_;
+  data_ = other.data_;
+  other.allocated_ = false;
+  other.size_ = 0;
+  other.capacity_ = 0;
+  other.data_ = nullptr;
   return *this;
 }
 
+void Tuple::CopyData(const char *data, uint32_t size) {
+  if (!allocated_ || capacity_ < size) {
+    FreeData();
+    capacity_ = size;
+    AllocateData();
+  }
+  size_ = size;
+  memcpy(data_, data, size);
+}
+
 Value Tuple::GetValue(const Schema *schema, const uint32_t column_idx) const {
   assert(schema);
   assert(data_);
-  const TypeId column_type = schema->GetColumn(column_idx).GetType();
+  // the inlined types are read in place, without going through the deserializer of their Type
+  const TypeId column_type = schema->GetType(column_idx);
+  switch (column_type) {
+    case TypeId::BOOLEAN:
+    case TypeId::TINYINT:
+      return Value(column_type, GetAs<int8_t>(schema, column_idx));
+    case TypeId::SMALLINT:
+      return Value(column_type, GetAs<int16_t>(schema, column_idx));
+    case TypeId::INTEGER:
+      return Value(column_type, GetAs<int32_t>(schema, column_idx));
+    case TypeId::BIGINT:
+      return Value(column_type, GetAs<int64_t>(schema, column_idx));
+    case TypeId::DECIMAL:
+      return Value(column_type, GetAs<double>(schema, column_idx));
+    case TypeId::TIMESTAMP:
+      return Value(column_type, GetAs<uint64_t>(schema, column_idx));
+    default:
+      break;
+  }
+  BUSTUB_ASSERT(!IsToasted(schema, column_idx), "a toasted value is read through the ToastStore of its table");
   const char *data_ptr = GetDataPtr(schema, column_idx);
   // the third parameter "is_inlined" is unused
   return Value::DeserializeFrom(data_ptr, column_type);
 }
 
-Tuple Tuple::KeyFromTuple(const Schema &schema, const Schema &key_schema, const std::vector<uint32_t> &key_attrs) {
+std::string_view Tuple::GetStringView(const Schema *schema, const uint32_t column_idx) const {
+  BUSTUB_ASSERT(!IsToasted(schema, column_idx), "a toasted value is read through the ToastStore of its table");
+  const char *data_ptr = GetDataPtr(schema, column_idx);
+  uint32_t length;
+  memcpy(&length, data_ptr, sizeof(uint32_t));
+  if (length == BUSTUB_VALUE_NULL || length == 0) {
+    return {};
+  }
+  return {data_ptr + sizeof(uint32_t), length - 1};
+}
+
+Tuple Tuple::KeyFromTuple(const Schema &schema, const Schema &key_schema,
+                          const std::vector<uint32_t> &key_attrs) const {
   std::vector<Value> values;
   values.reserve(key_attrs.size());
   for (auto idx : key_attrs) {
@@ -108,14 +189,13 @@ Tuple Tuple::KeyFromTuple(const Schema &schema, const Schema &key_schema, const
 const char *Tuple::GetDataPtr(const Schema *schema, const uint32_t column_idx) const {
   assert(schema);
   assert(data_);
-  const auto &col = schema->GetColumn(column_idx);
-  bool is_inlined = col.IsInlined();
   // For inline type, data is stored where it is.
-  if (is_inlined) {
-    return (data_ + col.GetOffset());
+  const char *column = data_ + schema->GetOffset(column_idx);
+  if (schema->GetType(column_idx) != TypeId::VARCHAR) {
+    return column;
   }
   // We read the relative offset from the tuple data.
-  int32_t offset = *reinterpret_cast<int32_t *>(data_ + col.GetOffset());
+  int32_t offset = *reinterpret_cast<const int32_t *>(column);
   // And return the beginning address of the real data for the VARCHAR type.
   return (data_ + offset);
 }
@@ -153,13 +233,7 @@ void Tuple::SerializeTo(char *storage) const {
 void Tuple::DeserializeFrom(const char *storage) {
   uint32_t size = *reinterpret_cast<const uint32_t *>(storage);
   // Construct a tuple.
-  this->size_ = size;
-  if (this->allocated_) {
-    delete[] this->data_;
-  }
-  this->data_ = new char[this->size_];
-  memcpy(this->data_, storage + sizeof(int32_t), this->size_);
-  this->allocated_ = true;
+  CopyData(storage + sizeof(int32_t), size);
 }
 
 }  // namespace bustub
@@ -0,0 +1,108 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// tuple_builder.cpp
+//
+// Identification: src/storage/table/tuple_builder.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/table/tuple_builder.h"
+
+#include <cassert>
+#include <cstring>
+
+namespace bustub {
+
+TupleBuilder::TupleBuilder(const Schema *schema)
+    : schema_(schema),
+      fixed_size_(schema->GetLength() + Tuple::NullBitmapSize(schema)),
+      bitmap_size_(Tuple::NullBitmapSize(schema)) {
+  columns_.reserve(schema->GetColumnCount());
+  for (const Column &column : schema->GetColumns()) {
+    columns_.push_back(ColumnLayout{column.GetOffset(), column.GetFixedLength(), column.IsInlined()});
+  }
+  varlen_columns_ = schema->GetUnlinedColumns();
+  // a VARCHAR takes its length inline in the payload, even if it is null
+  fixed_size_ += static_cast<uint32_t>(varlen_columns_.size() * sizeof(uint32_t));
+}
+
+uint32_t TupleBuilder::SizeOf(const std::vector<Value> &values) const {
+  assert(values.size() == columns_.size());
+  uint32_t size = fixed_size_;
+  for (uint32_t i : varlen_columns_) {
+    const Value &value = values[i];
+    if (!value.IsNull()) {
+      size += value.size_.len_;
+    }
+  }
+  return size;
+}
+
+uint32_t TupleBuilder::Build(const std::vector<Value> &values, char *buffer, uint32_t capacity) const {
+  uint32_t size = SizeOf(values);
+  if (size > capacity) {
+    return 0;
+  }
+  Serialize(values, buffer, size);
+  return size;
+}
+
+Tuple TupleBuilder::Build(const std::vector<Value> &values) const {
+  Tuple tuple;
+  tuple.size_ = SizeOf(values);
+  tuple.capacity_ = tuple.size_;
+  tuple.AllocateData();
+  Serialize(values, tuple.data_, tuple.size_);
+  return tuple;
+}
+
+Tuple TupleBuilder::Build(const std::vector<Value> &values, MemoryArena *arena) const {
+  uint32_t size = SizeOf(values);
+  char *data = arena->Allocate(size, alignof(uint32_t));
+  Serialize(values, data, size);
+  return Tuple(RID(), data, size);
+}
+
+void TupleBuilder::Serialize(const std::vector<Value> &values, char *data, uint32_t size) const {
+  char *bitmap = data + size - bitmap_size_;
+  std::memset(bitmap, 0, bitmap_size_);
+  uint32_t varlen_offset = schema_->GetLength();
+  for (uint32_t i = 0; i < columns_.size(); i++) {
+    const ColumnLayout &column = columns_[i];
+    const Value &value = values[i];
+    char *dest = data + column.offset_;
+    const bool is_null = value.IsNull();
+    if (is_null) {
+      bitmap[i / 8] |= static_cast<char>(1 << (i % 8));
+    }
+    if (!column.inlined_) {
+      // the offset of the data inline, the rest of its slot zeroed, then the length and the bytes of the data, where
+      // the payload is so far
+      std::memcpy(dest, &varlen_offset, sizeof(uint32_t));
+      std::memset(dest + sizeof(uint32_t), 0, column.width_ - sizeof(uint32_t));
+      const uint32_t length = value.size_.len_;
+      std::memcpy(data + varlen_offset, &length, sizeof(uint32_t));
+      varlen_offset += sizeof(uint32_t);
+      if (!is_null) {
+        std::memcpy(data + varlen_offset, value.inlined_ ? value.value_.inline_ : value.value_.varlen_, length);
+        varlen_offset += length;
+      }
+      continue;
+    }
+    // a fixed size value is the first bytes of value_, a null being its type's sentinel there; a value of a narrower
+    // type than the column leaves the rest of the column zeroed
+    const auto width = static_cast<uint32_t>(Type::GetTypeSize(value.GetTypeId()));
+    if (width >= column.width_) {
+      std::memcpy(dest, &value.value_, column.width_);
+    } else {
+      std::memcpy(dest, &value.value_, width);
+      std::memset(dest + width, 0, column.width_ - width);
+    }
+  }
+}
+
+}  // namespace bustub
@@ -0,0 +1,185 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// version_store.cpp
+//
+// Identification: src/storage/table/version_store.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/table/version_store.h"
+
+#include <iterator>
+#include <mutex>  // NOLINT
+
+namespace bustub {
+
+void VersionStore::Append(const RID &rid, txn_id_t writer, bool existed, const Tuple &before) {
+  std::unique_lock lock(latch_);
+  Chain &chain = chains_[rid.GetPageId()][rid.GetSlotNum()];
+  UndoLog &log = chain.emplace_back(UndoLog{writer, INVALID_TS, existed, Tuple{}});
+  if (existed) {
+    log.before_.CopyFrom(before);
+    log.before_.SetRid(rid);
+  }
+  version_count_++;
+}
+
+bool VersionStore::IsWriteConflict(const RID &rid, Transaction *txn) {
+  std::shared_lock lock(latch_);
+  auto page = chains_.find(rid.GetPageId());
+  if (page == chains_.end()) {
+    return false;
+  }
+  auto chain = page->second.find(rid.GetSlotNum());
+  if (chain == page->second.end() || chain->second.empty()) {
+    return false;
+  }
+  const UndoLog &newest = chain->second.back();
+  if (newest.writer_ == txn->GetTransactionId()) {
+    return false;
+  }
+  return newest.commit_ts_ == INVALID_TS || newest.commit_ts_ > txn->GetReadTs();
+}
+
+void VersionStore::Commit(const RID &rid, txn_id_t writer, timestamp_t commit_ts) {
+  std::unique_lock lock(latch_);
+  auto page = chains_.find(rid.GetPageId());
+  if (page == chains_.end()) {
+    return;
+  }
+  auto chain = page->second.find(rid.GetSlotNum());
+  if (chain == page->second.end()) {
+    return;
+  }
+  bool stamped = false;
+  for (UndoLog &log : chain->second) {
+    if (log.writer_ == writer && log.commit_ts_ == INVALID_TS) {
+      log.commit_ts_ = commit_ts;
+      stamped = true;
+    }
+  }
+  if (stamped) {
+    committed_.emplace_back(commit_ts, rid);
+  }
+}
+
+void VersionStore::Abort(const RID &rid, txn_id_t writer) {
+  std::unique_lock lock(latch_);
+  auto page = chains_.find(rid.GetPageId());
+  if (page == chains_.end()) {
+    return;
+  }
+  auto chain = page->second.find(rid.GetSlotNum());
+  if (chain == page->second.end()) {
+    return;
+  }
+  // the writes are rolled back newest first, and each drops its own record only, so that the older writes of the
+  // transaction stay undone for the readers till they are rolled back too
+  for (auto log = chain->second.rbegin(); log != chain->second.rend(); ++log) {
+    if (log->writer_ == writer) {
+      chain->second.erase(std::next(log).base());
+      version_count_--;
+      break;
+    }
+  }
+  if (chain->second.empty()) {
+    page->second.erase(chain);
+    if (page->second.empty()) {
+      chains_.erase(page);
+    }
+  }
+}
+
+bool VersionStore::Resolve(const Chain &chain, const Tuple *current, Transaction *txn, Tuple *version) {
+  bool exists = current != nullptr;
+  const Tuple *image = current;
+  for (auto log = chain.rbegin(); log != chain.rend(); ++log) {
+    if (log->writer_ == txn->GetTransactionId() ||
+        (log->commit_ts_ != INVALID_TS && log->commit_ts_ <= txn->GetReadTs())) {
+      break;
+    }
+    exists = log->existed_;
+    image = &log->before_;
+  }
+  if (exists) {
+    version->CopyFrom(*image);
+  }
+  return exists;
+}
+
+bool VersionStore::GetVersion(const RID &rid, const Tuple *current, Transaction *txn, Tuple *version) {
+  std::shared_lock lock(latch_);
+  auto page = chains_.find(rid.GetPageId());
+  if (page != chains_.end()) {
+    auto chain = page->second.find(rid.GetSlotNum());
+    if (chain != page->second.end()) {
+      return Resolve(chain->second, current, txn, version);
+    }
+  }
+  if (current != nullptr) {
+    version->CopyFrom(*current);
+  }
+  return current != nullptr;
+}
+
+void VersionStore::GetPageVersions(TablePage *page, Transaction *txn,
+                                   std::unordered_map<uint32_t, std::optional<Tuple>> *versions) {
+  versions->clear();
+  std::shared_lock lock(latch_);
+  auto chains = chains_.find(page->GetTablePageId());
+  if (chains == chains_.end()) {
+    return;
+  }
+  for (const auto &[slot, chain] : chains->second) {
+    Tuple view;
+    bool deleted = false;
+    const bool in_page = page->ReadTuple(RID(page->GetTablePageId(), slot), &view, &deleted) && !deleted;
+    Tuple version;
+    if (Resolve(chain, in_page ? &view : nullptr, txn, &version)) {
+      versions->emplace(slot, std::move(version));
+    } else {
+      versions->emplace(slot, std::nullopt);
+    }
+  }
+}
+
+void VersionStore::Collect(timestamp_t watermark) {
+  std::unique_lock lock(latch_);
+  while (!committed_.empty() && committed_.front().first <= watermark) {
+    RID rid = committed_.front().second;
+    committed_.pop_front();
+    auto page = chains_.find(rid.GetPageId());
+    if (page == chains_.end()) {
+      continue;
+    }
+    auto chain = page->second.find(rid.GetSlotNum());
+    if (chain == page->second.end()) {
+      continue;
+    }
+    Chain &logs = chain->second;
+    size_t drop = logs.size();
+    while (drop > 0 && (logs[drop - 1].commit_ts_ == INVALID_TS || logs[drop - 1].commit_ts_ > watermark)) {
+      drop--;
+    }
+    // records [0, drop) end with one that every transaction stops at, so none of them is undone again
+    logs.erase(logs.begin(), logs.begin() + drop);
+    version_count_ -= drop;
+    if (logs.empty()) {
+      page->second.erase(chain);
+      if (page->second.empty()) {
+        chains_.erase(page);
+      }
+    }
+  }
+}
+
+size_t VersionStore::GetVersionCount() {
+  std::shared_lock lock(latch_);
+  return version_count_;
+}
+
+}  // namespace bustub
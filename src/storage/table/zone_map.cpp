@@ -0,0 +1,103 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// zone_map.cpp
+//
+// Identification: src/storage/table/zone_map.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/table/zone_map.h"
+
+#include <algorithm>
+#include <utility>
+
+namespace bustub {
+
+ZoneMap::ZoneMap(const Schema *schema, std::vector<uint32_t> column_idxs)
+    : schema_(schema), column_idxs_(std::move(column_idxs)) {}
+
+void ZoneMap::AddPage(page_id_t page_id) {
+  std::scoped_lock latch{latch_};
+  if (position_.count(page_id) != 0) {
+    return;
+  }
+  position_[page_id] = pages_.size();
+  pages_.push_back(page_id);
+  zones_.push_back(Zone{std::vector<std::optional<Value>>(column_idxs_.size()),
+                        std::vector<std::optional<Value>>(column_idxs_.size())});
+}
+
+void ZoneMap::Update(page_id_t page_id, const Tuple &tuple) {
+  std::vector<Value> values;
+  values.reserve(column_idxs_.size());
+  for (uint32_t column_idx : column_idxs_) {
+    values.push_back(tuple.GetValue(schema_, column_idx));
+  }
+
+  std::scoped_lock latch{latch_};
+  auto position = position_.find(page_id);
+  BUSTUB_ASSERT(position != position_.end(), "the page has to be added before it is written to");
+  Zone &zone = zones_[position->second];
+  for (size_t i = 0; i < values.size(); i++) {
+    // NULLs satisfy no comparison, so they are left out of the zone
+    if (values[i].IsNull()) {
+      continue;
+    }
+    if (!zone.min_[i].has_value() || values[i].CompareLessThan(*zone.min_[i]) == CmpBool::CmpTrue) {
+      zone.min_[i] = values[i];
+    }
+    if (!zone.max_[i].has_value() || values[i].CompareGreaterThan(*zone.max_[i]) == CmpBool::CmpTrue) {
+      zone.max_[i] = values[i];
+    }
+  }
+}
+
+bool ZoneMap::Covers(uint32_t column_idx) const {
+  return std::find(column_idxs_.begin(), column_idxs_.end(), column_idx) != column_idxs_.end();
+}
+
+page_id_t ZoneMap::NextCandidate(page_id_t page_id, const std::vector<ZoneRange> &ranges) {
+  if (page_id == INVALID_PAGE_ID) {
+    return INVALID_PAGE_ID;
+  }
+  std::scoped_lock latch{latch_};
+  auto position = position_.find(page_id);
+  if (position == position_.end()) {
+    // a page the map does not know of is not skipped
+    return page_id;
+  }
+  for (size_t i = position->second; i < pages_.size(); i++) {
+    if (MayMatch(zones_[i], ranges)) {
+      return pages_[i];
+    }
+  }
+  return INVALID_PAGE_ID;
+}
+
+bool ZoneMap::MayMatch(const Zone &zone, const std::vector<ZoneRange> &ranges) const {
+  for (const ZoneRange &range : ranges) {
+    size_t i = PositionOf(range.column_idx_);
+    if (!zone.min_[i].has_value()) {
+      return false;
+    }
+    if (range.min_.has_value() && zone.max_[i]->CompareLessThan(*range.min_) == CmpBool::CmpTrue) {
+      return false;
+    }
+    if (range.max_.has_value() && zone.min_[i]->CompareGreaterThan(*range.max_) == CmpBool::CmpTrue) {
+      return false;
+    }
+  }
+  return true;
+}
+
+size_t ZoneMap::PositionOf(uint32_t column_idx) const {
+  auto it = std::find(column_idxs_.begin(), column_idxs_.end(), column_idx);
+  BUSTUB_ASSERT(it != column_idxs_.end(), "the map keeps no zones of the column");
+  return it - column_idxs_.begin();
+}
+
+}  // namespace bustub
@@ -10,6 +10,7 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <algorithm>
 #include <cassert>
 #include <string>
 #include <utility>
@@ -22,6 +23,7 @@ Value::Value(const Value &other) {
   type_id_ = other.type_id_;
   size_ = other.size_;
   manage_data_ = other.manage_data_;
+  inlined_ = other.inlined_;
   value_ = other.value_;
   switch (type_id_) {
     case TypeId::VARCHAR:
@@ -29,6 +31,7 @@ Value::Value(const Value &other) {
         value_.varlen_ = nullptr;
       } else {
         if (manage_data_) {
+          // the prefix came along with value_
           value_.varlen_ = new char[size_.len_];
           memcpy(value_.varlen_, other.value_.varlen_, size_.len_);
         } else {
@@ -219,16 +222,20 @@ Value::Value(TypeId type, const char *data, uint32_t len, bool manage_data) : Va
         size_.len_ = BUSTUB_VALUE_NULL;
       } else {
         manage_data_ = manage_data;
-        if (manage_data_) {
+        size_.len_ = len;
+        if (manage_data_ && len <= INLINE_LENGTH) {
+          // a short string needs no memory of its own
+          manage_data_ = false;
+          inlined_ = true;
+          memcpy(value_.inline_, data, len);
+        } else if (manage_data_) {
           assert(len < BUSTUB_VARCHAR_MAX_LEN);
-          value_.varlen_ = new char[len];
-          assert(value_.varlen_ != nullptr);
-          size_.len_ = len;
-          memcpy(value_.varlen_, data, len);
+          char *varlen = new char[len];
+          assert(varlen != nullptr);
+          memcpy(varlen, data, len);
+          SetVarlen(varlen, len);
         } else {
-          // FUCK YOU GCC I do what I want.
-          value_.const_varlen_ = data;
-          size_.len_ = len;
+          SetVarlen(data, len);
         }
       }
       break;
@@ -237,16 +244,29 @@ Value::Value(TypeId type, const char *data, uint32_t len, bool manage_data) : Va
   }
 }
 
+Value::Value(TypeId type, const char *data, uint32_t len, MemoryArena *arena)
+    : Value(type,
+            data == nullptr || len <= INLINE_LENGTH
+                ? data
+                : static_cast<const char *>(memcpy(arena->Allocate(len, 1), data, len)),
+            len, data != nullptr && len <= INLINE_LENGTH) {}
+
 Value::Value(TypeId type, const std::string &data) : Value(type) {
   switch (type) {
     case TypeId::VARCHAR: {
-      manage_data_ = true;
       // TODO(TAs): How to represent a null string here?
       uint32_t len = static_cast<uint32_t>(data.length()) + 1;
-      value_.varlen_ = new char[len];
-      assert(value_.varlen_ != nullptr);
       size_.len_ = len;
-      memcpy(value_.varlen_, data.c_str(), len);
+      if (len <= INLINE_LENGTH) {
+        inlined_ = true;
+        memcpy(value_.inline_, data.c_str(), len);
+        break;
+      }
+      manage_data_ = true;
+      char *varlen = new char[len];
+      assert(varlen != nullptr);
+      memcpy(varlen, data.c_str(), len);
+      SetVarlen(varlen, len);
       break;
     }
     default:
@@ -254,6 +274,13 @@ Value::Value(TypeId type, const std::string &data) : Value(type) {
   }
 }
 
+void Value::SetVarlen(const char *data, uint32_t len) {
+  value_.const_varlen_ = data;
+  if (len != BUSTUB_VARCHAR_MAX_LEN) {
+    memcpy(value_.inline_ + sizeof(char *), data, std::min(len, PREFIX_LENGTH));
+  }
+}
+
 // delete allocated char array space
 Value::~Value() {
   switch (type_id_) {
@@ -24,10 +24,8 @@ namespace bustub {
   const char *str2;                                                           \
   uint32_t len2;                                                              \
   if (right.GetTypeId() == TypeId::VARCHAR) {                                 \
-    str2 = right.GetData();                                                   \
-    len2 = GetLength(right) - 1;                                              \
     /* NOLINTNEXTLINE */                                                      \
-    return GetCmpBool(TypeUtil::CompareStrings(str1, len1, str2, len2) OP 0); \
+    return GetCmpBool(CompareVarchars(left, right) OP 0);                     \
   } else {                                                                    \
     auto r_value = right.CastAs(TypeId::VARCHAR);                             \
     str2 = r_value.GetData();                                                 \
@@ -41,11 +39,25 @@ VarlenType::VarlenType(TypeId type) : Type(type) {}
 VarlenType::~VarlenType() = default;
 
 // Access the raw variable length data
-const char *VarlenType::GetData(const Value &val) const { return val.value_.varlen_; }
+const char *VarlenType::GetData(const Value &val) const {
+  return val.inlined_ ? val.value_.inline_ : val.value_.varlen_;
+}
 
 // Get the length of the variable length data (including the length field)
 uint32_t VarlenType::GetLength(const Value &val) const { return val.size_.len_; }
 
+int VarlenType::CompareVarchars(const Value &left, const Value &right) {
+  auto len1 = static_cast<int>(left.size_.len_ - 1);
+  auto len2 = static_cast<int>(right.size_.len_ - 1);
+  // the prefixes are in the Values themselves, and most strings differ within them
+  auto prefix = std::min({len1, len2, static_cast<int>(Value::PREFIX_LENGTH)});
+  int ret = memcmp(left.GetPrefix(), right.GetPrefix(), prefix);
+  if (ret != 0) {
+    return ret;
+  }
+  return TypeUtil::CompareStrings(left.GetData(), len1, right.GetData(), len2);
+}
+
 CmpBool VarlenType::CompareEquals(const Value &left, const Value &right) const {
   assert(left.CheckComparable(right));
   if (left.IsNull() || right.IsNull()) {
@@ -162,7 +174,7 @@ void VarlenType::SerializeTo(const Value &val, char *storage) const {
     return;
   }
   memcpy(storage, &len, sizeof(uint32_t));
-  memcpy(storage + sizeof(uint32_t), val.value_.varlen_, len);
+  memcpy(storage + sizeof(uint32_t), GetData(val), len);
 }
 
 // Deserialize a value of the given type from the given storage space.
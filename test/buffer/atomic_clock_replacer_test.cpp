@@ -0,0 +1,142 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// atomic_clock_replacer_test.cpp
+//
+// Identification: test/buffer/atomic_clock_replacer_test.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/atomic_clock_replacer.h"
+
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "buffer/clock_replacer.h"
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+// NOLINTNEXTLINE
+TEST(AtomicClockReplacerTest, SampleTest) {
+  AtomicClockReplacer clock_replacer(7);
+
+  clock_replacer.Unpin(1);
+  clock_replacer.Unpin(2);
+  clock_replacer.Unpin(3);
+  clock_replacer.Unpin(4);
+  clock_replacer.Unpin(5);
+  clock_replacer.Unpin(6);
+  clock_replacer.Unpin(1);
+  EXPECT_EQ(6, clock_replacer.Size());
+
+  int value;
+  clock_replacer.Victim(&value);
+  EXPECT_EQ(1, value);
+  clock_replacer.Victim(&value);
+  EXPECT_EQ(2, value);
+  clock_replacer.Victim(&value);
+  EXPECT_EQ(3, value);
+
+  // 3 was taken already, so pinning it has no effect
+  clock_replacer.Pin(3);
+  clock_replacer.Pin(4);
+  EXPECT_EQ(2, clock_replacer.Size());
+
+  clock_replacer.Unpin(4);
+  clock_replacer.Victim(&value);
+  EXPECT_EQ(5, value);
+  clock_replacer.Victim(&value);
+  EXPECT_EQ(6, value);
+  clock_replacer.Victim(&value);
+  EXPECT_EQ(4, value);
+  EXPECT_FALSE(clock_replacer.Victim(&value));
+  EXPECT_EQ(0, clock_replacer.Size());
+}
+
+// NOLINTNEXTLINE
+TEST(AtomicClockReplacerTest, SameVictimsAsClockTest) {
+  constexpr size_t num_pages = 64;
+  AtomicClockReplacer atomic_replacer(num_pages);
+  ClockReplacer replacer(num_pages);
+  uint32_t seed = 17;
+  for (int i = 0; i < 10000; i++) {
+    seed = seed * 1103515245 + 12345;
+    auto frame = static_cast<frame_id_t>((seed >> 8) % num_pages);
+    switch ((seed >> 20) % 3) {
+      case 0:
+        atomic_replacer.Unpin(frame);
+        replacer.Unpin(frame);
+        break;
+      case 1:
+        atomic_replacer.Pin(frame);
+        replacer.Pin(frame);
+        break;
+      default: {
+        frame_id_t expected = -1;
+        frame_id_t victim = -1;
+        bool found = replacer.Victim(&expected);
+        ASSERT_EQ(found, atomic_replacer.Victim(&victim)) << "step " << i;
+        if (found) {
+          ASSERT_EQ(expected, victim) << "step " << i;
+        }
+      }
+    }
+    ASSERT_EQ(replacer.Size(), atomic_replacer.Size());
+  }
+}
+
+// NOLINTNEXTLINE
+TEST(AtomicClockReplacerTest, ConcurrencyTest) {
+  constexpr size_t num_pages = 256;
+  constexpr int num_threads = 8;
+  AtomicClockReplacer replacer(num_pages);
+  for (size_t frame = 0; frame < num_pages; frame++) {
+    replacer.Unpin(static_cast<frame_id_t>(frame));
+  }
+
+  // half of the threads hit frames, and the others take victims and give them back, as misses do. A hit may pin and
+  // unpin a frame that was just taken, which puts it back, so a frame is never taken more often than it was unpinned
+  // (once to begin with), rather than only by one thread at a time
+  std::vector<std::atomic<int64_t>> unpins(num_pages);
+  std::vector<std::atomic<int64_t>> victims(num_pages);
+  for (auto &count : unpins) {
+    count = 1;
+  }
+  std::atomic<bool> twice{false};
+  std::vector<std::thread> threads;
+  for (int t = 0; t < num_threads; t++) {
+    threads.emplace_back([&, t] {
+      for (int i = 0; i < 20000; i++) {
+        frame_id_t frame;
+        if (t % 2 == 0) {
+          frame = static_cast<frame_id_t>((t * 31 + i) % num_pages);
+          replacer.Pin(frame);
+          unpins[frame].fetch_add(1);
+          replacer.Unpin(frame);
+        } else if (replacer.Victim(&frame)) {
+          if (victims[frame].fetch_add(1) + 1 > unpins[frame].load()) {
+            twice = true;
+          }
+          unpins[frame].fetch_add(1);
+          replacer.Unpin(frame);
+        }
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  EXPECT_FALSE(twice);
+  EXPECT_EQ(num_pages, replacer.Size());
+  for (size_t i = 0; i < num_pages; i++) {
+    frame_id_t frame;
+    ASSERT_TRUE(replacer.Victim(&frame));
+  }
+  EXPECT_EQ(0, replacer.Size());
+}
+
+}  // namespace bustub
@@ -10,10 +10,13 @@
 //
 //===----------------------------------------------------------------------===//
 
-#include "buffer/buffer_pool_manager.h"
+#include "buffer/buffer_pool_manager_instance.h"
+#include <algorithm>
 #include <cstdio>
 #include <random>
 #include <string>
+#include <thread>  // NOLINT
+#include <vector>
 #include "gtest/gtest.h"
 
 namespace bustub {
@@ -29,7 +32,7 @@ TEST(BufferPoolManagerTest, BinaryDataTest) {
   std::uniform_int_distribution<char> uniform_dist(0);
 
   auto *disk_manager = new DiskManager(db_name);
-  auto *bpm = new BufferPoolManager(buffer_pool_size, disk_manager);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
 
   page_id_t page_id_temp;
   auto *page0 = bpm->NewPage(&page_id_temp);
@@ -92,7 +95,7 @@ TEST(BufferPoolManagerTest, SampleTest) {
   const size_t buffer_pool_size = 10;
 
   auto *disk_manager = new DiskManager(db_name);
-  auto *bpm = new BufferPoolManager(buffer_pool_size, disk_manager);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
 
   page_id_t page_id_temp;
   auto *page0 = bpm->NewPage(&page_id_temp);
@@ -142,4 +145,403 @@ TEST(BufferPoolManagerTest, SampleTest) {
   delete disk_manager;
 }
 
+// NOLINTNEXTLINE
+// Misses write back and read without the latch; concurrent fetches of the same pages must still see their contents
+TEST(BufferPoolManagerTest, ConcurrentFetchTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 8;
+  const int num_pages = 32;
+  const int num_threads = 8;
+  const int num_fetches = 500;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+
+  for (int i = 0; i < num_pages; ++i) {
+    page_id_t page_id;
+    Page *page = bpm->NewPage(&page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "%d", page_id);
+    EXPECT_TRUE(bpm->UnpinPage(page_id, true));
+  }
+
+  // Every thread pins at most one page at a time, so a fetch can always find a frame.
+  std::vector<std::thread> threads;
+  for (int tid = 0; tid < num_threads; ++tid) {
+    threads.emplace_back([bpm, tid] {
+      std::default_random_engine rng(tid);
+      std::uniform_int_distribution<page_id_t> page_dist(0, num_pages - 1);
+      for (int i = 0; i < num_fetches; ++i) {
+        page_id_t page_id = page_dist(rng);
+        Page *page = bpm->FetchPage(page_id);
+        ASSERT_NE(nullptr, page);
+        EXPECT_EQ(std::to_string(page_id), page->GetData());
+        // dirty some unpins so that evictions have to write back
+        EXPECT_TRUE(bpm->UnpinPage(page_id, i % 2 == 0));
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+// With LRU-K, one pass over many cold pages must not push out pages that are used over and over
+TEST(BufferPoolManagerTest, ScanResistanceTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 10;
+  const page_id_t num_hot_pages = 5;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager, nullptr, ReplacerType::LRU_K);
+
+  page_id_t page_id;
+  for (page_id_t i = 0; i < num_hot_pages; ++i) {
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id));
+    EXPECT_TRUE(bpm->UnpinPage(page_id, true));
+  }
+  for (page_id_t i = 0; i < num_hot_pages; ++i) {
+    ASSERT_NE(nullptr, bpm->FetchPage(i));
+    EXPECT_TRUE(bpm->UnpinPage(i, false));
+  }
+
+  // the scan: pages touched exactly once
+  for (int i = 0; i < 50; ++i) {
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id));
+    EXPECT_TRUE(bpm->UnpinPage(page_id, true));
+  }
+
+  Page *pages = bpm->GetPages();
+  for (page_id_t i = 0; i < num_hot_pages; ++i) {
+    bool cached = false;
+    for (size_t frame = 0; frame < buffer_pool_size; ++frame) {
+      cached = cached || pages[frame].GetPageId() == i;
+    }
+    EXPECT_TRUE(cached) << "hot page " << i << " was evicted by the scan";
+  }
+
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerTest, AccessStrategyTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 10;
+  const page_id_t num_hot_pages = 6;
+  const int num_bulk_pages = 50;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+
+  page_id_t page_id;
+  for (page_id_t i = 0; i < num_hot_pages; ++i) {
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id));
+    EXPECT_TRUE(bpm->UnpinPage(page_id, true));
+  }
+
+  // a bulk load followed by a scan of what it loaded, both confined to a ring of two frames
+  BufferAccessStrategy strategy(2);
+  std::vector<page_id_t> bulk_pages;
+  for (int i = 0; i < num_bulk_pages; ++i) {
+    Page *page = bpm->NewPageWithStrategy(&page_id, &strategy);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "bulk %d", page_id);
+    EXPECT_TRUE(bpm->UnpinPage(page_id, true));
+    bulk_pages.push_back(page_id);
+  }
+  for (page_id_t bulk_page_id : bulk_pages) {
+    Page *page = bpm->FetchPageWithStrategy(bulk_page_id, &strategy);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ("bulk " + std::to_string(bulk_page_id), std::string(page->GetData()));
+    EXPECT_TRUE(bpm->UnpinPage(bulk_page_id, false));
+  }
+
+  Page *pages = bpm->GetPages();
+  for (page_id_t i = 0; i < num_hot_pages; ++i) {
+    bool cached = false;
+    for (size_t frame = 0; frame < buffer_pool_size; ++frame) {
+      cached = cached || pages[frame].GetPageId() == i;
+    }
+    EXPECT_TRUE(cached) << "hot page " << i << " was evicted by the bulk operation";
+  }
+
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerTest, StatsTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 3;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+
+  page_id_t page_id;
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id));
+    EXPECT_TRUE(bpm->UnpinPage(page_id, true));
+  }
+  BufferPoolStats stats = bpm->GetStats();
+  EXPECT_EQ(0, stats.hits_);
+  EXPECT_EQ(0, stats.misses_);
+  EXPECT_EQ(0, stats.evictions_);
+
+  // three hits
+  for (page_id_t i = 0; i < static_cast<page_id_t>(buffer_pool_size); ++i) {
+    ASSERT_NE(nullptr, bpm->FetchPage(i));
+    EXPECT_TRUE(bpm->UnpinPage(i, false));
+  }
+  // three new pages push out the three dirty ones
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id));
+    EXPECT_TRUE(bpm->UnpinPage(page_id, true));
+  }
+  // and a miss, which evicts one of the new (dirty) pages
+  ASSERT_NE(nullptr, bpm->FetchPage(0));
+  EXPECT_TRUE(bpm->UnpinPage(0, false));
+
+  stats = bpm->GetStats();
+  EXPECT_EQ(3, stats.hits_);
+  EXPECT_EQ(1, stats.misses_);
+  EXPECT_EQ(4, stats.evictions_);
+  EXPECT_EQ(4, stats.dirty_writebacks_);
+  EXPECT_DOUBLE_EQ(0.75, stats.HitRatio());
+
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerTest, BatchFetchTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 10;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+
+  // twice as many pages as fit, so that the first ones are only on disk
+  for (size_t i = 0; i < buffer_pool_size * 2; ++i) {
+    page_id_t page_id;
+    Page *page = bpm->NewPage(&page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "page %d", page_id);
+    EXPECT_TRUE(bpm->UnpinPage(page_id, true));
+  }
+
+  // misses, a hit and a duplicate in one batch
+  std::vector<page_id_t> page_ids = {4, 0, 19, 2, 4};
+  std::vector<Page *> pages = bpm->FetchPages(page_ids);
+  ASSERT_EQ(page_ids.size(), pages.size());
+  for (size_t i = 0; i < page_ids.size(); ++i) {
+    ASSERT_NE(nullptr, pages[i]);
+    EXPECT_EQ(page_ids[i], pages[i]->GetPageId());
+    EXPECT_EQ("page " + std::to_string(page_ids[i]), std::string(pages[i]->GetData()));
+  }
+  EXPECT_EQ(pages[0], pages[4]);
+  EXPECT_EQ(2, pages[0]->GetPinCount());
+
+  // 4 frames are pinned, so only 6 of these 8 pages can be brought in
+  std::vector<Page *> more = bpm->FetchPages({5, 6, 7, 8, 9, 10, 11, 12});
+  EXPECT_EQ(6, std::count_if(more.begin(), more.end(), [](Page *page) { return page != nullptr; }));
+  for (Page *page : more) {
+    if (page != nullptr) {
+      EXPECT_TRUE(bpm->UnpinPage(page->GetPageId(), false));
+    }
+  }
+
+  EXPECT_TRUE(bpm->UnpinPages(page_ids, false));
+  EXPECT_EQ(0, pages[0]->GetPinCount());
+  EXPECT_FALSE(bpm->UnpinPages({0}, false));
+
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerTest, ReuseDeletedPageIdTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 10;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+
+  page_id_t page_id;
+  Page *page = bpm->NewPage(&page_id);
+  ASSERT_NE(nullptr, page);
+  snprintf(page->GetData(), PAGE_SIZE, "deleted");
+  EXPECT_TRUE(bpm->UnpinPage(page_id, true));
+  EXPECT_TRUE(bpm->DeletePage(page_id));
+
+  // a reader that got to the page late, e.g. a B+ tree lookup without latches, reads it back in after the delete
+  Page *stale = bpm->FetchPage(page_id);
+  ASSERT_NE(nullptr, stale);
+  uint64_t version;
+  ASSERT_TRUE(stale->ReadVersion(&version));
+
+  // the freed id is handed out again, in the frame of the stale copy rather than a second one
+  page_id_t new_page_id;
+  Page *new_page = bpm->NewPage(&new_page_id);
+  ASSERT_EQ(page_id, new_page_id);
+  EXPECT_EQ(stale, new_page);
+  EXPECT_FALSE(stale->ValidateVersion(version));
+  EXPECT_EQ(2, new_page->GetPinCount());
+  snprintf(new_page->GetData(), PAGE_SIZE, "created");
+  EXPECT_TRUE(bpm->UnpinPage(page_id, false));
+  EXPECT_TRUE(bpm->UnpinPage(page_id, true));
+
+  page = bpm->FetchPage(page_id);
+  ASSERT_NE(nullptr, page);
+  EXPECT_EQ("created", std::string(page->GetData()));
+  EXPECT_TRUE(bpm->UnpinPage(page_id, false));
+
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerTest, PrefetchTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 10;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+
+  // Write out twice as many pages as fit, so that pages 0-9 end up on disk only.
+  for (size_t i = 0; i < buffer_pool_size * 2; ++i) {
+    page_id_t page_id;
+    Page *page = bpm->NewPage(&page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "%d", page_id);
+    EXPECT_TRUE(bpm->UnpinPage(page_id, true));
+  }
+
+  // Scenario: prefetched pages show up in the pool without anybody fetching them, and are left unpinned.
+  bpm->PrefetchPages({0, 1, 2, INVALID_PAGE_ID, 15});
+  Page *pages = bpm->GetPages();
+  auto cached = [&](page_id_t page_id) {
+    for (size_t i = 0; i < buffer_pool_size; ++i) {
+      if (pages[i].GetPageId() == page_id && pages[i].GetPinCount() == 0) {
+        return true;
+      }
+    }
+    return false;
+  };
+  for (int i = 0; i < 500 && !(cached(0) && cached(1) && cached(2)); ++i) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  EXPECT_TRUE(cached(0));
+  EXPECT_TRUE(cached(1));
+  EXPECT_TRUE(cached(2));
+  EXPECT_TRUE(cached(15));
+
+  // Scenario: fetching a prefetched page, even one whose read may still be in flight, returns its contents.
+  bpm->PrefetchPages({3, 4});
+  for (page_id_t page_id = 0; page_id < 5; ++page_id) {
+    Page *page = bpm->FetchPage(page_id);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ(std::to_string(page_id), page->GetData());
+    EXPECT_TRUE(bpm->UnpinPage(page_id, false));
+  }
+
+  // Scenario: prefetching does not keep frames pinned, so all of them can still be taken.
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    page_id_t page_id;
+    EXPECT_NE(nullptr, bpm->NewPage(&page_id));
+  }
+
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerTest, BackgroundFlusherTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 10;
+  const size_t old_clean_target = bg_flush_clean_target;
+  const size_t old_pages_per_round = bg_flush_pages_per_round;
+  bg_flush_clean_target = 6;
+  bg_flush_pages_per_round = 2;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+
+  // Fill the pool with dirty pages and keep page 0 pinned.
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    page_id_t page_id;
+    Page *page = bpm->NewPage(&page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "%d", page_id);
+    if (page_id != 0) {
+      EXPECT_TRUE(bpm->UnpinPage(page_id, true));
+    }
+  }
+  EXPECT_EQ(0, disk_manager->GetNumWrites());
+
+  // Scenario: the flusher cleans unpinned pages until the clean target is met, and leaves the rest dirty.
+  bpm->StartBackgroundFlusher();
+  for (int i = 0; i < 500 && disk_manager->GetNumWrites() < 6; ++i) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  bpm->StopBackgroundFlusher();
+  EXPECT_EQ(6, disk_manager->GetNumWrites());
+
+  size_t clean = 0;
+  Page *pages = bpm->GetPages();
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    if (pages[i].GetPageId() == 0) {
+      EXPECT_EQ(1, pages[i].GetPinCount());
+    } else if (!pages[i].IsDirty()) {
+      ++clean;
+    }
+  }
+  EXPECT_EQ(6, clean);
+
+  // Scenario: evicting a page the flusher already wrote back costs no further write, and its data survives.
+  page_id_t page_id;
+  ASSERT_NE(nullptr, bpm->NewPage(&page_id));
+  EXPECT_EQ(6, disk_manager->GetNumWrites());
+  EXPECT_TRUE(bpm->UnpinPage(page_id, false));
+  for (page_id_t i = 1; i < static_cast<page_id_t>(buffer_pool_size); ++i) {
+    Page *page = bpm->FetchPage(i);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ(std::to_string(i), page->GetData());
+    EXPECT_TRUE(bpm->UnpinPage(i, false));
+  }
+
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+  bg_flush_clean_target = old_clean_target;
+  bg_flush_pages_per_round = old_pages_per_round;
+}
+
 }  // namespace bustub
@@ -0,0 +1,62 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// frame_arena_test.cpp
+//
+// Identification: test/buffer/frame_arena_test.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/frame_arena.h"
+#include <cstdint>
+#include <cstring>
+#include "buffer/buffer_pool_manager_instance.h"
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+// NOLINTNEXTLINE
+TEST(FrameArenaTest, AlignmentTest) {
+  // large enough to be backed by huge pages
+  const size_t num_frames = 2 * HUGE_PAGE_SIZE / PAGE_SIZE + 3;
+  FrameArena arena(num_frames);
+
+  EXPECT_EQ(0, reinterpret_cast<uintptr_t>(arena.GetFrame(0)) % HUGE_PAGE_SIZE);
+  for (size_t i = 0; i < num_frames; ++i) {
+    char *frame = arena.GetFrame(i);
+    ASSERT_EQ(0, reinterpret_cast<uintptr_t>(frame) % PAGE_SIZE);
+    // mapped zeroed, and every byte is usable
+    ASSERT_EQ(0, frame[0]);
+    ASSERT_EQ(0, frame[PAGE_SIZE - 1]);
+    memset(frame, static_cast<int>(i % 128), PAGE_SIZE);
+  }
+  for (size_t i = 0; i < num_frames; ++i) {
+    ASSERT_EQ(static_cast<char>(i % 128), arena.GetFrame(i)[PAGE_SIZE / 2]);
+  }
+}
+
+// NOLINTNEXTLINE
+TEST(FrameArenaTest, BufferPoolFramesTest) {
+  const size_t buffer_pool_size = 10;
+  auto *disk_manager = new DiskManager("test.db");
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+
+  Page *pages = bpm->GetPages();
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    EXPECT_EQ(0, reinterpret_cast<uintptr_t>(pages[i].GetData()) % PAGE_SIZE);
+    if (i > 0) {
+      EXPECT_EQ(pages[i - 1].GetData() + PAGE_SIZE, pages[i].GetData());
+    }
+  }
+
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+}  // namespace bustub
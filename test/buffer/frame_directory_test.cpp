@@ -0,0 +1,100 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// frame_directory_test.cpp
+//
+// Identification: test/buffer/frame_directory_test.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/frame_directory.h"
+#include <algorithm>
+#include <atomic>
+#include <thread>  // NOLINT
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+// NOLINTNEXTLINE
+TEST(FrameDirectoryTest, SampleTest) {
+  FrameDirectory directory(4);
+  frame_id_t frame_id;
+
+  EXPECT_FALSE(directory.Find(0, &frame_id));
+  directory.Insert(0, 3);
+  directory.Insert(7, 1);
+  directory.Insert(1000, 0);
+
+  EXPECT_TRUE(directory.Find(0, &frame_id));
+  EXPECT_EQ(3, frame_id);
+  EXPECT_TRUE(directory.Find(7, &frame_id));
+  EXPECT_EQ(1, frame_id);
+  EXPECT_TRUE(directory.Find(1000, &frame_id));
+  EXPECT_EQ(0, frame_id);
+  EXPECT_FALSE(directory.Find(1, &frame_id));
+
+  EXPECT_TRUE(directory.Erase(7));
+  EXPECT_FALSE(directory.Erase(7));
+  EXPECT_FALSE(directory.Find(7, &frame_id));
+  EXPECT_TRUE(directory.Find(1000, &frame_id));
+
+  directory.Insert(7, 2);
+  EXPECT_TRUE(directory.Find(7, &frame_id));
+  EXPECT_EQ(2, frame_id);
+}
+
+// NOLINTNEXTLINE
+TEST(FrameDirectoryTest, ChurnTest) {
+  // Mimic a buffer pool of 16 frames streaming through many pages: the directory never holds more than 16 entries,
+  // but sees many more inserts and erases than it has slots.
+  const int num_frames = 16;
+  FrameDirectory directory(num_frames);
+  frame_id_t frame_id;
+
+  for (page_id_t page_id = 0; page_id < 10000; ++page_id) {
+    if (page_id >= num_frames) {
+      EXPECT_TRUE(directory.Erase(page_id - num_frames));
+    }
+    directory.Insert(page_id, page_id % num_frames);
+    for (page_id_t resident = std::max(0, page_id - num_frames + 1); resident <= page_id; ++resident) {
+      ASSERT_TRUE(directory.Find(resident, &frame_id));
+      EXPECT_EQ(resident % num_frames, frame_id);
+    }
+    EXPECT_FALSE(directory.Find(page_id + 1, &frame_id));
+  }
+}
+
+// NOLINTNEXTLINE
+TEST(FrameDirectoryTest, ConcurrentFindTest) {
+  // One writer churns through pages while readers keep looking up a page that never leaves.
+  const int num_frames = 8;
+  FrameDirectory directory(num_frames);
+  directory.Insert(0, 7);
+  std::atomic<bool> done{false};
+
+  std::thread writer([&] {
+    for (page_id_t page_id = 1; page_id < 20000; ++page_id) {
+      if (page_id > num_frames - 1) {
+        directory.Erase(page_id - (num_frames - 1));
+      }
+      directory.Insert(page_id, page_id % (num_frames - 1));
+    }
+    done = true;
+  });
+
+  std::thread reader([&] {
+    frame_id_t frame_id;
+    while (!done) {
+      ASSERT_TRUE(directory.Find(0, &frame_id));
+      EXPECT_EQ(7, frame_id);
+    }
+  });
+
+  writer.join();
+  reader.join();
+}
+
+}  // namespace bustub
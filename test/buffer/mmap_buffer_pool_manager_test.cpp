@@ -0,0 +1,89 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// mmap_buffer_pool_manager_test.cpp
+//
+// Identification: test/buffer/mmap_buffer_pool_manager_test.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/mmap_buffer_pool_manager.h"
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+// NOLINTNEXTLINE
+TEST(MmapBufferPoolManagerTest, ReadOnlyTest) {
+  const std::string db_name = "mmap_test.db";
+  remove(db_name.c_str());
+
+  // page 1 compresses, page 0 does not
+  std::vector<char> noise(PAGE_SIZE);
+  std::mt19937 generator(15445);
+  for (char &c : noise) {
+    c = static_cast<char>(generator());
+  }
+  std::vector<char> cold(PAGE_SIZE, 0);
+  snprintf(cold.data(), PAGE_SIZE, "Hello");
+  {
+    DiskManager disk_manager(db_name, IoEngineType::SYNC, false, true);
+    EXPECT_EQ(0, disk_manager.AllocatePage());
+    EXPECT_EQ(1, disk_manager.AllocatePage());
+    disk_manager.WritePage(0, noise.data());
+    disk_manager.WritePage(1, cold.data());
+    disk_manager.ShutDown();
+  }
+
+  DiskManager disk_manager(db_name);
+  MmapBufferPoolManager bpm(&disk_manager);
+  EXPECT_EQ(2, bpm.GetPoolSize());
+
+  // Scenario: uncompressed pages are served straight from the mapping.
+  Page *page0 = bpm.FetchPage(0);
+  ASSERT_NE(nullptr, page0);
+  EXPECT_EQ(0, page0->GetPageId());
+  EXPECT_EQ(disk_manager.GetMappedPage(0), page0->GetData());
+  EXPECT_EQ(0, std::memcmp(page0->GetData(), noise.data(), PAGE_SIZE));
+
+  // Scenario: compressed pages are decompressed into memory of their own.
+  Page *page1 = bpm.FetchPage(1);
+  ASSERT_NE(nullptr, page1);
+  EXPECT_EQ(nullptr, disk_manager.GetMappedPage(1));
+  EXPECT_STREQ("Hello", page1->GetData());
+  EXPECT_EQ(0, disk_manager.GetNumChecksumFailures());
+
+  // Scenario: fetching a page again returns the same page, pinned once more.
+  EXPECT_EQ(page0, bpm.FetchPage(0));
+  EXPECT_EQ(2, page0->GetPinCount());
+  BufferPoolStats stats = bpm.GetStats();
+  EXPECT_EQ(1, stats.hits_);
+  EXPECT_EQ(2, stats.misses_);
+
+  // Scenario: pages can be unpinned, but not as dirty.
+  EXPECT_FALSE(bpm.UnpinPage(0, true));
+  EXPECT_TRUE(bpm.UnpinPage(0, false));
+  EXPECT_TRUE(bpm.UnpinPage(0, false));
+  EXPECT_FALSE(bpm.UnpinPage(0, false));
+  EXPECT_TRUE(bpm.UnpinPage(1, false));
+
+  // Scenario: the pool cannot grow or shrink the file.
+  page_id_t page_id;
+  EXPECT_EQ(nullptr, bpm.NewPage(&page_id));
+  EXPECT_FALSE(bpm.DeletePage(0));
+  EXPECT_EQ(nullptr, bpm.FetchPage(2));
+  EXPECT_EQ(nullptr, bpm.FetchPage(INVALID_PAGE_ID));
+
+  bpm.PrefetchPages({0, 1});
+  disk_manager.ShutDown();
+  remove(db_name.c_str());
+}
+
+}  // namespace bustub
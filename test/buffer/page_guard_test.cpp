@@ -0,0 +1,84 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// page_guard_test.cpp
+//
+// Identification: test/buffer/page_guard_test.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/page_guard.h"
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <utility>
+#include "buffer/buffer_pool_manager_instance.h"
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+// NOLINTNEXTLINE
+TEST(PageGuardTest, SampleTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 5;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+
+  page_id_t page_id;
+  Page *page = bpm->NewPage(&page_id);
+  ASSERT_NE(nullptr, page);
+  EXPECT_TRUE(bpm->UnpinPage(page_id, false));
+
+  {
+    // readers share the page, and leave it clean
+    ReadPageGuard first = bpm->FetchPageRead(page_id);
+    ReadPageGuard second = bpm->FetchPageRead(page_id);
+    ASSERT_TRUE(first.IsValid());
+    EXPECT_EQ(page_id, first.PageId());
+    EXPECT_EQ(2, page->GetPinCount());
+
+    ReadPageGuard moved = std::move(first);
+    EXPECT_FALSE(first.IsValid());  // NOLINT
+    EXPECT_EQ(2, page->GetPinCount());
+    second.Drop();
+    EXPECT_EQ(1, page->GetPinCount());
+  }
+  EXPECT_EQ(0, page->GetPinCount());
+  EXPECT_FALSE(page->IsDirty());
+
+  {
+    // a writer that only reads leaves the page clean too
+    WritePageGuard guard = bpm->FetchPageWrite(page_id);
+    EXPECT_EQ(0, guard.GetData()[0]);
+  }
+  EXPECT_FALSE(page->IsDirty());
+
+  {
+    WritePageGuard guard = bpm->FetchPageWrite(page_id);
+    snprintf(guard.GetDataMut(), PAGE_SIZE, "Hello");
+    EXPECT_EQ(1, page->GetPinCount());
+  }
+  EXPECT_EQ(0, page->GetPinCount());
+  EXPECT_TRUE(page->IsDirty());
+
+  {
+    // moving over a guard releases the page it held first
+    WritePageGuard guard = bpm->FetchPageWrite(page_id);
+    guard = WritePageGuard();
+    EXPECT_EQ(0, page->GetPinCount());
+    ReadPageGuard reader = bpm->FetchPageRead(page_id);
+    EXPECT_EQ(0, strcmp("Hello", reader.GetData()));
+  }
+
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+}  // namespace bustub
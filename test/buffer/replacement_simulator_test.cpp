@@ -0,0 +1,87 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// replacement_simulator_test.cpp
+//
+// Identification: test/buffer/replacement_simulator_test.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <vector>
+
+#include "buffer/replacement_simulator.h"
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+// NOLINTNEXTLINE
+TEST(ReplacementSimulatorTest, SimulateTest) {
+  // page 1 is referenced again and again, then two pages once each
+  ReplacementSimulator simulator({1, 1, 1, 2, 3, 1});
+  EXPECT_EQ(6, simulator.GetNumReferences());
+  EXPECT_EQ(3, simulator.GetNumDistinctPages());
+
+  // LRU-K gives up the pages referenced fewer than K times first, and keeps page 1
+  SimulationResult lru_k = simulator.Run(ReplacerType::LRU_K, 2);
+  EXPECT_EQ(3, lru_k.hits_);
+  EXPECT_EQ(3, lru_k.misses_);
+  EXPECT_DOUBLE_EQ(0.5, lru_k.HitRatio());
+  // as in the buffer pool, a hit leaves the frame where it was in the LRU list, so page 1 goes first
+  SimulationResult lru = simulator.Run(ReplacerType::LRU, 2);
+  EXPECT_EQ(2, lru.hits_);
+  EXPECT_EQ(4, lru.misses_);
+
+  // a pool that holds every page only misses each once, whatever the policy
+  for (ReplacerType type : ALL_REPLACER_TYPES) {
+    SimulationResult result = simulator.Run(type, 3);
+    EXPECT_EQ(type, result.replacer_type_);
+    EXPECT_EQ(3, result.pool_size_);
+    EXPECT_EQ(3, result.misses_);
+  }
+  EXPECT_EQ(6, simulator.Run(ReplacerType::CLOCK, 0).misses_);
+}
+
+// NOLINTNEXTLINE
+TEST(ReplacementSimulatorTest, RunAllTest) {
+  std::vector<page_id_t> references;
+  for (int round = 0; round < 10; round++) {
+    for (page_id_t page_id = 0; page_id < 100; page_id++) {
+      references.push_back(page_id % 10 == 0 ? 0 : page_id);
+    }
+  }
+  ReplacementSimulator simulator(references);
+  std::vector<size_t> pool_sizes{10, 50, 100};
+  std::vector<ReplacerType> types{ALL_REPLACER_TYPES.begin(), ALL_REPLACER_TYPES.end()};
+  std::vector<SimulationResult> results = simulator.RunAll(pool_sizes, types, 4);
+  ASSERT_EQ(pool_sizes.size() * types.size(), results.size());
+  for (size_t i = 0; i < results.size(); i++) {
+    EXPECT_EQ(pool_sizes[i / types.size()], results[i].pool_size_);
+    EXPECT_EQ(types[i % types.size()], results[i].replacer_type_);
+    EXPECT_EQ(references.size(), results[i].hits_ + results[i].misses_);
+    // the same as a run of its own
+    EXPECT_EQ(simulator.Run(results[i].replacer_type_, results[i].pool_size_).hits_, results[i].hits_);
+  }
+  // the hit ratio of a policy does not fall as the pool grows here, and all pages fit in the largest pool
+  for (size_t column = 0; column < types.size(); column++) {
+    EXPECT_LE(results[column].hits_, results[types.size() + column].hits_);
+    EXPECT_EQ(simulator.GetNumDistinctPages(), results[2 * types.size() + column].misses_);
+  }
+}
+
+// NOLINTNEXTLINE
+TEST(ReplacementSimulatorTest, ReferencesTest) {
+  std::vector<PageAccess> accesses{{0, 1, PageAccessType::READ},
+                                   {1, 2, PageAccessType::FETCH},
+                                   {2, 3, PageAccessType::WRITE},
+                                   {3, 4, PageAccessType::FETCH}};
+  EXPECT_EQ((std::vector<page_id_t>{2, 4}), ReplacementSimulator::References(accesses));
+  // a trace of a disk manager without a buffer pool has its reads
+  accesses[1].type_ = PageAccessType::READ;
+  accesses[3].type_ = PageAccessType::WRITE;
+  EXPECT_EQ((std::vector<page_id_t>{1, 2}), ReplacementSimulator::References(accesses));
+}
+
+}  // namespace bustub
@@ -0,0 +1,185 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// bulk_loader_test.cpp
+//
+// Identification: test/catalog/bulk_loader_test.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "buffer/buffer_pool_manager_instance.h"
+#include "catalog/bulk_loader.h"
+#include "concurrency/transaction.h"
+#include "gtest/gtest.h"
+#include "storage/index/generic_key.h"
+#include "type/value_factory.h"
+
+namespace bustub {
+
+class BulkLoaderTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    disk_manager_ = std::make_unique<DiskManager>("bulk_loader_test.db");
+    bpm_ = std::make_unique<BufferPoolManagerInstance>(64, disk_manager_.get());
+    // the B+ tree indexes keep their roots in the header page
+    page_id_t header_page_id;
+    bpm_->NewPage(&header_page_id);
+    bpm_->UnpinPage(header_page_id, true);
+    catalog_ = std::make_unique<Catalog>(bpm_.get(), nullptr, nullptr);
+  }
+
+  void TearDown() override {
+    catalog_.reset();
+    bpm_.reset();
+    disk_manager_->ShutDown();
+    disk_manager_.reset();
+    remove("bulk_loader_test.db");
+  }
+
+  std::unique_ptr<DiskManager> disk_manager_;
+  std::unique_ptr<BufferPoolManagerInstance> bpm_;
+  std::unique_ptr<Catalog> catalog_;
+  Transaction txn_{0};
+};
+
+// NOLINTNEXTLINE
+TEST_F(BulkLoaderTest, CsvTest) {
+  Schema schema({Column("id", TypeId::INTEGER), Column("name", TypeId::VARCHAR, 32), Column("score", TypeId::DECIMAL),
+                 Column("flag", TypeId::BOOLEAN)});
+  TableMetadata *table_info = catalog_->CreateTable(&txn_, "t", schema);
+  std::unique_ptr<Schema> key_schema(Schema::CopySchema(&schema, {0}));
+  IndexInfo *index_info =
+      catalog_->CreateIndex<GenericKey<8>, RID, GenericComparator<8>>(&txn_, "t_id", "t", schema, *key_schema, {0}, 8);
+
+  // two files, one with Windows line ends, of rows with quoted delimiters and quotes and NULLs
+  const int32_t rows_per_file = 5000;
+  std::vector<std::string> files = {"bulk_loader_test_0.csv", "bulk_loader_test_1.csv"};
+  uint64_t bytes = 0;
+  for (size_t file = 0; file < files.size(); file++) {
+    std::ofstream out(files[file], std::ios::binary);
+    std::string line_end = file == 0 ? "\n" : "\r\n";
+    out << "id,name,score,flag" << line_end;
+    for (int32_t i = 0; i < rows_per_file; i++) {
+      int32_t id = static_cast<int32_t>(file) * rows_per_file + i;
+      if (id % 10 == 0) {
+        out << id << ",,," << (id % 2 == 0 ? "true" : "f") << line_end;
+      } else {
+        out << id << ",\"name, \"\"" << id << "\"\"\"," << id / 2.0 << ",0" << line_end;
+      }
+    }
+    bytes += out.tellp();
+  }
+
+  BulkLoadOptions options;
+  options.header_ = true;
+  options.num_threads_ = 4;
+  options.chunk_size_ = 4096;
+  BulkLoadStats stats = BulkLoader(catalog_.get()).Load("t", files, options);
+  EXPECT_EQ(2 * rows_per_file, stats.rows_);
+  EXPECT_EQ(bytes, stats.bytes_);
+  EXPECT_GT(stats.pages_, 0);
+
+  // every row is in the table once, and in the index
+  std::unordered_map<int32_t, RID> rids;
+  for (auto iter = table_info->table_->Begin(&txn_); iter != table_info->table_->End(); ++iter) {
+    int32_t id = iter->GetValue(&schema, 0).GetAs<int32_t>();
+    EXPECT_TRUE(rids.emplace(id, iter->GetRid()).second) << id;
+    if (id % 10 == 0) {
+      EXPECT_TRUE(iter->GetValue(&schema, 1).IsNull());
+      EXPECT_TRUE(iter->GetValue(&schema, 2).IsNull());
+      EXPECT_TRUE(iter->GetValue(&schema, 3).GetAs<bool>());
+    } else {
+      EXPECT_EQ("name, \"" + std::to_string(id) + "\"", iter->GetValue(&schema, 1).ToString());
+      EXPECT_DOUBLE_EQ(id / 2.0, iter->GetValue(&schema, 2).GetAs<double>());
+      EXPECT_FALSE(iter->GetValue(&schema, 3).GetAs<bool>());
+    }
+  }
+  EXPECT_EQ(2 * rows_per_file, rids.size());
+  for (const auto &[id, rid] : rids) {
+    std::vector<RID> result;
+    index_info->index_->ScanKey(Tuple({ValueFactory::GetIntegerValue(id)}, key_schema.get()), &result, &txn_);
+    ASSERT_EQ(1, result.size()) << id;
+    EXPECT_EQ(rid, result[0]);
+  }
+
+  for (const std::string &file : files) {
+    remove(file.c_str());
+  }
+}
+
+// NOLINTNEXTLINE
+TEST_F(BulkLoaderTest, BinaryTest) {
+  Schema schema({Column("id", TypeId::BIGINT), Column("payload", TypeId::VARCHAR, 64)});
+  TableMetadata *table_info = catalog_->CreateTable(&txn_, "t", schema);
+
+  // the table has rows, and its index entries, already, so the index is not built from the bottom up
+  const int64_t num_inserted = 100;
+  for (int64_t id = 0; id < num_inserted; id++) {
+    RID rid;
+    ASSERT_TRUE(table_info->table_->InsertTuple(
+        Tuple({ValueFactory::GetBigIntValue(id), ValueFactory::GetVarcharValue("inserted")}, &schema), &rid, &txn_));
+  }
+  std::unique_ptr<Schema> key_schema(Schema::CopySchema(&schema, {0}));
+  IndexInfo *index_info =
+      catalog_->CreateIndex<GenericKey<8>, RID, GenericComparator<8>>(&txn_, "t_id", "t", schema, *key_schema, {0}, 8);
+
+  const int64_t num_loaded = 20000;
+  std::vector<Tuple> tuples;
+  for (int64_t id = num_inserted; id < num_inserted + num_loaded; id++) {
+    tuples.emplace_back(
+        std::vector<Value>{ValueFactory::GetBigIntValue(id), ValueFactory::GetVarcharValue(std::string(id % 50, 'x'))},
+        &schema);
+  }
+  ASSERT_TRUE(BulkLoader::WriteBinary("bulk_loader_test.bin", tuples));
+
+  BulkLoadOptions options;
+  options.format_ = BulkLoadFormat::BINARY;
+  options.num_threads_ = 3;
+  options.chunk_size_ = 64 << 10;
+  BulkLoadStats stats = BulkLoader(catalog_.get()).Load("t", {"bulk_loader_test.bin"}, options);
+  EXPECT_EQ(num_loaded, stats.rows_);
+
+  size_t count = 0;
+  for (auto iter = table_info->table_->Begin(&txn_); iter != table_info->table_->End(); ++iter) {
+    int64_t id = iter->GetValue(&schema, 0).GetAs<int64_t>();
+    std::string payload = id < num_inserted ? "inserted" : std::string(id % 50, 'x');
+    EXPECT_EQ(payload, iter->GetValue(&schema, 1).ToString());
+    count++;
+  }
+  EXPECT_EQ(num_inserted + num_loaded, count);
+  for (int64_t id = 0; id < num_inserted + num_loaded; id++) {
+    std::vector<RID> result;
+    index_info->index_->ScanKey(Tuple({ValueFactory::GetBigIntValue(id)}, key_schema.get()), &result, &txn_);
+    EXPECT_EQ(1, result.size()) << id;
+  }
+
+  remove("bulk_loader_test.bin");
+}
+
+// NOLINTNEXTLINE
+TEST_F(BulkLoaderTest, BadInputTest) {
+  Schema schema({Column("a", TypeId::INTEGER), Column("b", TypeId::VARCHAR, 16)});
+  catalog_->CreateTable(&txn_, "t", schema);
+  BulkLoader loader(catalog_.get());
+
+  for (const char *line : {"1,x,y", "1", "one,x", "1,\"x", "1,\"x\"y", "99999999999,x"}) {
+    std::ofstream("bulk_loader_test.csv") << "0,fine\n" << line << "\n";
+    EXPECT_THROW(loader.Load("t", {"bulk_loader_test.csv"}), Exception) << line;
+  }
+  EXPECT_THROW(loader.Load("t", {"bulk_loader_test_missing.csv"}), Exception);
+  EXPECT_THROW(loader.Load("t", {"bulk_loader_test.csv"}, {BulkLoadFormat::BINARY}), Exception);
+
+  remove("bulk_loader_test.csv");
+}
+
+}  // namespace bustub
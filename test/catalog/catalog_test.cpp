@@ -10,12 +10,19 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <cmath>
+#include <cstdio>
+#include <memory>
 #include <string>
+#include <thread>  // NOLINT
 #include <unordered_set>
 #include <vector>
 
-#include "buffer/buffer_pool_manager.h"
+#include "buffer/buffer_pool_manager_instance.h"
 #include "catalog/catalog.h"
+#include "concurrency/lock_manager.h"
+#include "concurrency/transaction.h"
+#include "concurrency/transaction_manager.h"
 #include "gtest/gtest.h"
 #include "type/value_factory.h"
 
@@ -24,7 +31,7 @@ namespace bustub {
 // NOLINTNEXTLINE
 TEST(CatalogTest, CreateTableTest) {
   auto disk_manager = new DiskManager("catalog_test.db");
-  auto bpm = new BufferPoolManager(32, disk_manager);
+  auto bpm = new BufferPoolManagerInstance(32, disk_manager);
   auto catalog = new Catalog(bpm, nullptr, nullptr);
   std::string table_name = "potato";
 
@@ -48,4 +55,314 @@ TEST(CatalogTest, CreateTableTest) {
   delete disk_manager;
 }
 
+// NOLINTNEXTLINE
+TEST(CatalogTest, HyperLogLogTest) {
+  for (int64_t distinct : {0, 10, 1000, 100000}) {
+    HyperLogLog hll;
+    // every value is added several times, which does not count
+    for (int repeat = 0; repeat < 3; repeat++) {
+      for (int64_t i = 0; i < distinct; i++) {
+        hll.Add(static_cast<hash_t>(i));
+      }
+    }
+    EXPECT_NEAR(static_cast<double>(distinct), hll.Estimate(), 0.05 * static_cast<double>(distinct) + 0.5);
+  }
+
+  // the merge of two is the HyperLogLog of the union of their hashes
+  HyperLogLog left;
+  HyperLogLog right;
+  HyperLogLog both;
+  for (int64_t i = 0; i < 60000; i++) {
+    left.Add(static_cast<hash_t>(i));
+    both.Add(static_cast<hash_t>(i));
+  }
+  for (int64_t i = 40000; i < 100000; i++) {
+    right.Add(static_cast<hash_t>(i));
+    both.Add(static_cast<hash_t>(i));
+  }
+  left.Merge(right);
+  EXPECT_EQ(both.Estimate(), left.Estimate());
+  EXPECT_NEAR(100000.0, left.Estimate(), 5000.0);
+}
+
+// NOLINTNEXTLINE
+TEST(CatalogTest, AnalyzeTest) {
+  auto disk_manager = new DiskManager("catalog_test.db");
+  auto bpm = new BufferPoolManagerInstance(64, disk_manager);
+  auto lock_manager = new LockManager();
+  auto catalog = new Catalog(bpm, lock_manager, nullptr);
+  auto txn = new Transaction(0);
+  // a is unique, b has ten values and is null in a quarter of the rows, and c is skewed towards "common"
+  Schema schema({Column("a", TypeId::INTEGER), Column("b", TypeId::INTEGER), Column("c", TypeId::VARCHAR, 16)});
+  const int32_t num_rows = 10000;
+
+  for (TableLayout layout : {TableLayout::ROW, TableLayout::PAX}) {
+    std::string table_name = layout == TableLayout::ROW ? "row_table" : "pax_table";
+    TableMetadata *table_info = catalog->CreateTable(txn, table_name, schema, layout);
+    EXPECT_EQ(nullptr, catalog->GetTableStatistics(table_name));
+    for (int32_t i = 0; i < num_rows; i++) {
+      Tuple tuple({Value(TypeId::INTEGER, i),
+                   i % 4 == 0 ? ValueFactory::GetNullValueByType(TypeId::INTEGER) : Value(TypeId::INTEGER, i % 10),
+                   Value(TypeId::VARCHAR, i % 2 == 0 ? std::string("common") : "rare" + std::to_string(i % 100))},
+                  &schema);
+      RID rid;
+      ASSERT_TRUE(layout == TableLayout::ROW ? table_info->table_->InsertTuple(tuple, &rid, txn)
+                                             : table_info->pax_table_->InsertTuple(tuple, &rid, txn));
+    }
+
+    const TableStatistics *stats = catalog->Analyze(txn, table_name, 20, 2000);
+    ASSERT_NE(nullptr, stats);
+    EXPECT_EQ(stats, catalog->GetTableStatistics(table_name));
+    EXPECT_EQ(num_rows, stats->GetRowCount());
+
+    const ColumnStatistics &a = stats->GetColumn(0);
+    EXPECT_EQ(0, a.GetNullFraction());
+    EXPECT_NEAR(num_rows, a.GetDistinctCount(), 0.05 * num_rows);
+    ASSERT_EQ(21, a.GetHistogramBounds().size());
+    // the histogram of the sample splits the range of a evenly
+    EXPECT_NEAR(0.5, a.EstimateLessThan(Value(TypeId::INTEGER, num_rows / 2)), 0.05);
+    EXPECT_NEAR(0.1, a.EstimateLessThan(Value(TypeId::INTEGER, num_rows / 10)), 0.05);
+    EXPECT_EQ(0, a.EstimateLessThan(Value(TypeId::INTEGER, -1)));
+    EXPECT_EQ(1, a.EstimateLessThan(Value(TypeId::INTEGER, num_rows)));
+    EXPECT_EQ(0, a.EstimateEquals(Value(TypeId::INTEGER, num_rows)));
+
+    const ColumnStatistics &b = stats->GetColumn(1);
+    EXPECT_DOUBLE_EQ(0.25, b.GetNullFraction());
+    EXPECT_NEAR(10, b.GetDistinctCount(), 1);
+    EXPECT_NEAR(0.075, b.EstimateEquals(Value(TypeId::INTEGER, 3)), 0.01);
+    EXPECT_EQ(0, b.EstimateEquals(ValueFactory::GetNullValueByType(TypeId::INTEGER)));
+
+    // a value in half of the rows bounds half of the buckets
+    const ColumnStatistics &c = stats->GetColumn(2);
+    EXPECT_NEAR(51, c.GetDistinctCount(), 3);
+    EXPECT_NEAR(0.5, c.EstimateEquals(Value(TypeId::VARCHAR, "common")), 0.1);
+    EXPECT_LT(c.EstimateEquals(Value(TypeId::VARCHAR, "rare1")), 0.05);
+  }
+
+  // a sample of half of the pages is scaled up to the whole table, and unique columns with it
+  const TableStatistics *sampled = catalog->Analyze(txn, "row_table", 20, 2000, 0.5);
+  EXPECT_NEAR(num_rows, sampled->GetRowCount(), 0.05 * num_rows);
+  EXPECT_NEAR(num_rows, sampled->GetColumn(0).GetDistinctCount(), 0.1 * num_rows);
+  EXPECT_NEAR(0.25, sampled->GetColumn(1).GetNullFraction(), 0.01);
+  EXPECT_NEAR(10, sampled->GetColumn(1).GetDistinctCount(), 1);
+  EXPECT_NEAR(0.5, sampled->GetColumn(0).EstimateLessThan(Value(TypeId::INTEGER, num_rows / 2)), 0.2);
+
+  delete txn;
+  delete catalog;
+  delete lock_manager;
+  delete bpm;
+  delete disk_manager;
+  remove("catalog_test.db");
+}
+
+// NOLINTNEXTLINE
+TEST(CatalogTest, OnlineCreateIndexTest) {
+  auto disk_manager = new DiskManager("catalog_online_index_test.db");
+  auto bpm = new BufferPoolManagerInstance(64, disk_manager);
+  auto lock_manager = new LockManager();
+  auto catalog = new Catalog(bpm, lock_manager, nullptr);
+  auto txn = new Transaction(0);
+  Schema schema({Column("a", TypeId::INTEGER), Column("b", TypeId::INTEGER)});
+  std::unique_ptr<Schema> key_schema(Schema::CopySchema(&schema, {0}));
+  TableMetadata *table = catalog->CreateTable(txn, "t", schema);
+  const int32_t num_rows = 5000;
+  const int32_t num_writes = 1000;
+  auto insert = [&](int32_t i) {
+    Tuple tuple({Value(TypeId::INTEGER, i), Value(TypeId::INTEGER, -i)}, &schema);
+    RID rid;
+    ASSERT_TRUE(table->table_->InsertTuple(tuple, &rid, txn));
+    for (IndexInfo *index_info : catalog->GetTableIndexes("t")) {
+      catalog->InsertIndexEntry(index_info, tuple.KeyFromTuple(schema, *key_schema, {0}), rid, txn);
+    }
+  };
+  for (int32_t i = 0; i < num_rows; i++) {
+    insert(i);
+  }
+
+  // rows go on being inserted while the index is built; the ones the scan misses are logged and applied after it
+  std::thread writer([&] {
+    for (int32_t i = num_rows; i < num_rows + num_writes; i++) {
+      insert(i);
+    }
+  });
+  IndexInfo *index_info = catalog->CreateIndex<GenericKey<8>, RID, GenericComparator<8>>(
+      txn, "t_index", "t", schema, *key_schema, {0}, 8, 4);
+  writer.join();
+  EXPECT_TRUE(index_info->IsValid());
+
+  for (int32_t i = 0; i < num_rows + num_writes; i++) {
+    std::vector<RID> rids;
+    index_info->index_->ScanKey(Tuple({Value(TypeId::INTEGER, i)}, key_schema.get()), &rids, txn);
+    ASSERT_EQ(1, rids.size()) << i;
+    Tuple tuple;
+    ASSERT_TRUE(table->table_->GetTuple(rids[0], &tuple, txn));
+    EXPECT_EQ(-i, tuple.GetValue(&schema, 1).GetAs<int32_t>());
+  }
+
+  delete txn;
+  delete catalog;
+  delete lock_manager;
+  delete bpm;
+  disk_manager->ShutDown();
+  delete disk_manager;
+  remove("catalog_online_index_test.db");
+}
+
+// NOLINTNEXTLINE
+TEST(CatalogTest, OnlineCreateIndexAbortTest) {
+  auto disk_manager = new DiskManager("catalog_online_index_abort_test.db");
+  auto bpm = new BufferPoolManagerInstance(64, disk_manager);
+  auto lock_manager = new LockManager();
+  auto txn_mgr = new TransactionManager(lock_manager);
+  auto catalog = new Catalog(bpm, lock_manager, nullptr);
+  auto txn = new Transaction(0);
+  Schema schema({Column("a", TypeId::INTEGER), Column("b", TypeId::INTEGER)});
+  std::unique_ptr<Schema> key_schema(Schema::CopySchema(&schema, {0}));
+  TableMetadata *table = catalog->CreateTable(txn, "t", schema);
+  auto make_tuple = [&schema](int32_t i) {
+    return Tuple({Value(TypeId::INTEGER, i), Value(TypeId::INTEGER, -i)}, &schema);
+  };
+  std::vector<RID> rids(10);
+  for (int32_t i = 0; i < 10; i++) {
+    ASSERT_TRUE(table->table_->InsertTuple(make_tuple(i), &rids[i], txn));
+  }
+
+  // a writer inserts, deletes and updates rows, and is still running as the index is built, whose scan sees its rows
+  Transaction *writer = txn_mgr->Begin();
+  RID inserted;
+  ASSERT_TRUE(table->table_->InsertTuple(make_tuple(100), &inserted, writer));
+  ASSERT_TRUE(table->table_->MarkDelete(rids[1], writer));
+  ASSERT_TRUE(table->table_->UpdateTuple(make_tuple(200), rids[2], writer));
+  ASSERT_TRUE(table->table_->UpdateTuple(make_tuple(300), rids[2], writer));
+  IndexInfo *index_info = catalog->CreateIndex<GenericKey<8>, RID, GenericComparator<8>>(
+      txn, "t_index", "t", schema, *key_schema, {0}, 8);
+  txn_mgr->Abort(writer);
+  delete writer;
+
+  // the index holds the rows as they are once the writer's writes are rolled back
+  auto scan = [&](int32_t i) {
+    std::vector<RID> result;
+    index_info->index_->ScanKey(Tuple({Value(TypeId::INTEGER, i)}, key_schema.get()), &result, txn);
+    return result;
+  };
+  for (int32_t i = 0; i < 10; i++) {
+    ASSERT_EQ(std::vector<RID>{rids[i]}, scan(i)) << i;
+  }
+  EXPECT_TRUE(scan(100).empty());
+  EXPECT_TRUE(scan(200).empty());
+  EXPECT_TRUE(scan(300).empty());
+
+  delete txn;
+  delete catalog;
+  delete txn_mgr;
+  delete lock_manager;
+  delete bpm;
+  disk_manager->ShutDown();
+  delete disk_manager;
+  remove("catalog_online_index_abort_test.db");
+}
+
+// NOLINTNEXTLINE
+TEST(CatalogTest, PersistenceTest) {
+  const std::string db_name = "catalog_persistence_test.db";
+  Schema schema({Column("a", TypeId::INTEGER), Column("b", TypeId::VARCHAR, 16)});
+  std::unique_ptr<Schema> key_schema(Schema::CopySchema(&schema, {0}));
+  auto make_tuple = [&schema](int32_t i) {
+    return Tuple({Value(TypeId::INTEGER, i), Value(TypeId::VARCHAR, "row" + std::to_string(i))}, &schema);
+  };
+  const int32_t num_rows = 2000;
+  auto lock_manager = new LockManager();
+  auto txn = new Transaction(0);
+
+  {
+    auto disk_manager = new DiskManager(db_name);
+    auto bpm = new BufferPoolManagerInstance(32, disk_manager);
+    page_id_t header_page_id;
+    bpm->NewPage(&header_page_id);
+    ASSERT_EQ(HEADER_PAGE_ID, header_page_id);
+    bpm->UnpinPage(header_page_id, true);
+    auto catalog = new Catalog(bpm, lock_manager, nullptr);
+    catalog->Open();
+
+    TableMetadata *row_table = catalog->CreateTable(txn, "row_table", schema);
+    TableMetadata *pax_table = catalog->CreateTable(txn, "pax_table", schema, TableLayout::PAX);
+    for (int32_t i = 0; i < num_rows; i++) {
+      RID rid;
+      ASSERT_TRUE(row_table->table_->InsertTuple(make_tuple(i), &rid, txn));
+      ASSERT_TRUE(pax_table->pax_table_->InsertTuple(make_tuple(i), &rid, txn));
+    }
+    catalog->CreateIndex<GenericKey<8>, RID, GenericComparator<8>>(txn, "row_index", "row_table", schema, *key_schema,
+                                                                   {0}, 8);
+    catalog->Analyze(txn, "row_table");
+
+    bpm->FlushAllPages();
+    delete catalog;
+    delete bpm;
+    disk_manager->ShutDown();
+    delete disk_manager;
+  }
+
+  // after a restart, the tables and the index are found where they were
+  auto disk_manager = new DiskManager(db_name);
+  auto bpm = new BufferPoolManagerInstance(32, disk_manager);
+  auto catalog = new Catalog(bpm, lock_manager, nullptr);
+  catalog->Open();
+  TableMetadata *row_table = catalog->GetTable("row_table");
+  TableMetadata *pax_table = catalog->GetTable("pax_table");
+  EXPECT_EQ(TableLayout::ROW, row_table->layout_);
+  EXPECT_EQ(TableLayout::PAX, pax_table->layout_);
+  EXPECT_EQ(row_table, catalog->GetTable(row_table->oid_));
+  ASSERT_EQ(2, row_table->schema_.GetColumnCount());
+  EXPECT_EQ("b", row_table->schema_.GetColumn(1).GetName());
+  EXPECT_EQ(TypeId::VARCHAR, row_table->schema_.GetColumn(1).GetType());
+
+  int32_t count = 0;
+  for (auto iter = row_table->table_->Begin(txn); iter != row_table->table_->End(); ++iter) {
+    EXPECT_EQ(count, iter->GetValue(&row_table->schema_, 0).GetAs<int32_t>());
+    count++;
+  }
+  EXPECT_EQ(num_rows, count);
+  {
+    PaxColumnScanner scanner(pax_table->pax_table_.get(), {1});
+    RID rid;
+    std::vector<Value> values;
+    count = 0;
+    while (scanner.Next(&rid, &values)) {
+      EXPECT_EQ("row" + std::to_string(count), values[0].ToString());
+      count++;
+    }
+    EXPECT_EQ(num_rows, count);
+  }
+
+  IndexInfo *index_info = catalog->GetIndex("row_index", "row_table");
+  ASSERT_NE(nullptr, index_info);
+  EXPECT_EQ(8, index_info->key_size_);
+  std::vector<RID> rids;
+  index_info->index_->ScanKey(Tuple({Value(TypeId::INTEGER, 1234)}, key_schema.get()), &rids, txn);
+  ASSERT_EQ(1, rids.size());
+  Tuple tuple;
+  ASSERT_TRUE(row_table->table_->GetTuple(rids[0], &tuple, txn));
+  EXPECT_EQ("row1234", tuple.GetValue(&schema, 1).ToString());
+
+  const TableStatistics *stats = catalog->GetTableStatistics("row_table");
+  ASSERT_NE(nullptr, stats);
+  EXPECT_EQ(num_rows, stats->GetRowCount());
+  EXPECT_EQ(StatisticsCollector::DEFAULT_NUM_BUCKETS + 1, stats->GetColumn(1).GetHistogramBounds().size());
+  EXPECT_EQ("row0", stats->GetColumn(1).GetHistogramBounds().front().ToString());
+  EXPECT_EQ(nullptr, catalog->GetTableStatistics("pax_table"));
+
+  // and new tables take new oids
+  TableMetadata *new_table = catalog->CreateTable(txn, "new_table", schema);
+  EXPECT_NE(row_table->oid_, new_table->oid_);
+  EXPECT_NE(pax_table->oid_, new_table->oid_);
+
+  delete catalog;
+  delete bpm;
+  disk_manager->ShutDown();
+  delete disk_manager;
+  delete txn;
+  delete lock_manager;
+  remove(db_name.c_str());
+}
+
 }  // namespace bustub
@@ -0,0 +1,292 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// materialized_view_test.cpp
+//
+// Identification: test/catalog/materialized_view_test.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <cstdio>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "buffer/buffer_pool_manager_instance.h"
+#include "catalog/catalog.h"
+#include "concurrency/transaction_manager.h"
+#include "gtest/gtest.h"
+#include "storage/table/table_iterator.h"
+#include "type/value_factory.h"
+
+namespace bustub {
+
+class MaterializedViewTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    disk_manager_ = std::make_unique<DiskManager>("materialized_view_test.db");
+    bpm_ = std::make_unique<BufferPoolManagerInstance>(64, disk_manager_.get());
+    lock_manager_ = std::make_unique<LockManager>();
+    txn_mgr_ = std::make_unique<TransactionManager>(lock_manager_.get());
+    catalog_ = std::make_unique<Catalog>(bpm_.get(), lock_manager_.get(), nullptr);
+    Transaction *txn = txn_mgr_->Begin();
+    table_info_ = catalog_->CreateTable(txn, "t", schema_);
+    txn_mgr_->Commit(txn);
+    delete txn;
+  }
+
+  void TearDown() override {
+    catalog_.reset();
+    txn_mgr_.reset();
+    bpm_.reset();
+    disk_manager_->ShutDown();
+    disk_manager_.reset();
+    remove("materialized_view_test.db");
+  }
+
+  Tuple Row(int32_t g, int32_t v) {
+    Value value = v < 0 ? ValueFactory::GetNullValueByType(TypeId::INTEGER) : ValueFactory::GetIntegerValue(v);
+    return Tuple({ValueFactory::GetIntegerValue(g), value, ValueFactory::GetDecimalValue(v * 0.5)}, &schema_);
+  }
+
+  /** @return the rows of the view, by their first column, as strings */
+  std::map<std::string, std::vector<std::string>> ViewRows(MaterializedView *view) {
+    Transaction *txn = txn_mgr_->Begin();
+    std::vector<Tuple> tuples;
+    view->Scan(txn, &tuples);
+    txn_mgr_->Commit(txn);
+    delete txn;
+    std::map<std::string, std::vector<std::string>> rows;
+    for (const Tuple &tuple : tuples) {
+      std::vector<std::string> values;
+      for (uint32_t i = 0; i < view->GetSchema().GetColumnCount(); i++) {
+        values.push_back(tuple.GetValue(&view->GetSchema(), i).ToString());
+      }
+      rows[values[0]] = values;
+    }
+    return rows;
+  }
+
+  /** @return the rows of SELECT g, COUNT(v), SUM(v), MIN(v), MAX(v), SUM(d) FROM t GROUP BY g, as strings */
+  std::map<std::string, std::vector<std::string>> Recompute() {
+    std::map<int32_t, std::vector<Tuple>> groups;
+    Transaction *txn = txn_mgr_->Begin();
+    for (auto it = table_info_->table_->Begin(txn); it != table_info_->table_->End(); ++it) {
+      groups[it->GetValue(&schema_, 0).GetAs<int32_t>()].push_back(*it);
+    }
+    txn_mgr_->Commit(txn);
+    delete txn;
+    std::map<std::string, std::vector<std::string>> rows;
+    for (const auto &[g, tuples] : groups) {
+      int32_t count = 0;
+      int32_t sum = 0;
+      int32_t min = BUSTUB_INT32_MAX;
+      int32_t max = BUSTUB_INT32_MIN;
+      double decimal_sum = 0;
+      for (const Tuple &tuple : tuples) {
+        decimal_sum += tuple.GetValue(&schema_, 2).GetAs<double>();
+        Value v = tuple.GetValue(&schema_, 1);
+        if (v.IsNull()) {
+          continue;
+        }
+        count++;
+        sum += v.GetAs<int32_t>();
+        min = std::min(min, v.GetAs<int32_t>());
+        max = std::max(max, v.GetAs<int32_t>());
+      }
+      Value null = ValueFactory::GetNullValueByType(TypeId::INTEGER);
+      std::string key = ValueFactory::GetIntegerValue(g).ToString();
+      rows[key] = {key,
+                   ValueFactory::GetIntegerValue(count).ToString(),
+                   (count == 0 ? null : ValueFactory::GetIntegerValue(sum)).ToString(),
+                   (count == 0 ? null : ValueFactory::GetIntegerValue(min)).ToString(),
+                   (count == 0 ? null : ValueFactory::GetIntegerValue(max)).ToString(),
+                   ValueFactory::GetDecimalValue(decimal_sum).ToString()};
+    }
+    return rows;
+  }
+
+  MaterializedView *CreateView(const std::vector<uint32_t> &group_by_idxs) {
+    Transaction *txn = txn_mgr_->Begin();
+    MaterializedView *view = catalog_->CreateMaterializedView(txn, "v", "t", group_by_idxs,
+                                                              {{AggregationType::CountAggregate, 1},
+                                                               {AggregationType::SumAggregate, 1},
+                                                               {AggregationType::MinAggregate, 1},
+                                                               {AggregationType::MaxAggregate, 1},
+                                                               {AggregationType::SumAggregate, 2}});
+    txn_mgr_->Commit(txn);
+    delete txn;
+    return view;
+  }
+
+  Schema schema_{{Column("g", TypeId::INTEGER), Column("v", TypeId::INTEGER), Column("d", TypeId::DECIMAL)}};
+  std::unique_ptr<DiskManager> disk_manager_;
+  std::unique_ptr<BufferPoolManagerInstance> bpm_;
+  std::unique_ptr<LockManager> lock_manager_;
+  std::unique_ptr<TransactionManager> txn_mgr_;
+  std::unique_ptr<Catalog> catalog_;
+  TableMetadata *table_info_;
+};
+
+// NOLINTNEXTLINE
+TEST_F(MaterializedViewTest, GroupByTest) {
+  TableHeap *table = table_info_->table_.get();
+  std::vector<RID> rids(100);
+  Transaction *txn = txn_mgr_->Begin();
+  for (int32_t i = 0; i < 100; i++) {
+    ASSERT_TRUE(table->InsertTuple(Row(i % 5, i % 7 == 3 ? -1 : i), &rids[i], txn));
+  }
+  txn_mgr_->Commit(txn);
+  delete txn;
+
+  // built by a scan of the rows there are
+  MaterializedView *view = CreateView({0});
+  EXPECT_EQ(view, catalog_->GetMaterializedView("v"));
+  EXPECT_EQ(5, view->GetGroupCount());
+  EXPECT_EQ(Recompute(), ViewRows(view));
+
+  // inserts, updates that move rows between groups, and deletes of the extremes of groups, of a row more than once
+  txn = txn_mgr_->Begin();
+  RID rid;
+  ASSERT_TRUE(table->InsertTuple(Row(7, 1000), &rid, txn));
+  ASSERT_TRUE(table->UpdateTuple(Row(7, 1001), rid, txn));
+  ASSERT_TRUE(table->InsertTuple(Row(1, -5), &rid, txn));
+  ASSERT_TRUE(table->UpdateTuple(Row(2, 500), rids[10], txn));
+  ASSERT_TRUE(table->UpdateTuple(Row(3, 501), rids[10], txn));
+  ASSERT_TRUE(table->MarkDelete(rids[0], txn));
+  ASSERT_TRUE(table->MarkDelete(rids[99], txn));
+  ASSERT_TRUE(table->UpdateTuple(Row(1, -1), rids[96], txn));
+  txn_mgr_->Commit(txn);
+  delete txn;
+  EXPECT_EQ(6, view->GetGroupCount());
+  EXPECT_EQ(Recompute(), ViewRows(view));
+
+  // an aborted transaction leaves the view be
+  auto before = ViewRows(view);
+  txn = txn_mgr_->Begin();
+  ASSERT_TRUE(table->InsertTuple(Row(8, 1), &rid, txn));
+  ASSERT_TRUE(table->MarkDelete(rids[5], txn));
+  ASSERT_TRUE(table->UpdateTuple(Row(0, 2000), rids[20], txn));
+  txn_mgr_->Abort(txn);
+  delete txn;
+  EXPECT_EQ(before, ViewRows(view));
+
+  // a group without rows goes away
+  txn = txn_mgr_->Begin();
+  for (int32_t i = 0; i < 100; i += 5) {
+    if (i != 0) {
+      ASSERT_TRUE(table->MarkDelete(rids[i], txn));
+    }
+  }
+  txn_mgr_->Commit(txn);
+  delete txn;
+  EXPECT_EQ(5, view->GetGroupCount());
+  auto rows = ViewRows(view);
+  EXPECT_EQ(0, rows.count("0"));
+  EXPECT_EQ(Recompute(), rows);
+}
+
+// NOLINTNEXTLINE
+TEST_F(MaterializedViewTest, NoGroupByTest) {
+  TableHeap *table = table_info_->table_.get();
+  MaterializedView *view = CreateView({});
+  Schema view_schema = view->GetSchema();
+  auto scan = [&]() {
+    Transaction *txn = txn_mgr_->Begin();
+    std::vector<Tuple> tuples;
+    view->Scan(txn, &tuples);
+    txn_mgr_->Commit(txn);
+    delete txn;
+    EXPECT_EQ(1, tuples.size());
+    return tuples[0];
+  };
+
+  // the aggregates of no rows, as AggregationExecutor has them
+  Tuple row = scan();
+  EXPECT_EQ(0, row.GetValue(&view_schema, 0).GetAs<int32_t>());
+  for (uint32_t i = 1; i < view_schema.GetColumnCount(); i++) {
+    EXPECT_TRUE(row.GetValue(&view_schema, i).IsNull());
+  }
+
+  std::vector<RID> rids(10);
+  Transaction *txn = txn_mgr_->Begin();
+  for (int32_t i = 0; i < 10; i++) {
+    ASSERT_TRUE(table->InsertTuple(Row(0, i), &rids[i], txn));
+  }
+  txn_mgr_->Commit(txn);
+  delete txn;
+  row = scan();
+  EXPECT_EQ(10, row.GetValue(&view_schema, 0).GetAs<int32_t>());
+  EXPECT_EQ(45, row.GetValue(&view_schema, 1).GetAs<int32_t>());
+  EXPECT_EQ(0, row.GetValue(&view_schema, 2).GetAs<int32_t>());
+  EXPECT_EQ(9, row.GetValue(&view_schema, 3).GetAs<int32_t>());
+  EXPECT_EQ(22.5, row.GetValue(&view_schema, 4).GetAs<double>());
+
+  // taking out both extremes makes them read again
+  txn = txn_mgr_->Begin();
+  ASSERT_TRUE(table->MarkDelete(rids[0], txn));
+  ASSERT_TRUE(table->MarkDelete(rids[9], txn));
+  txn_mgr_->Commit(txn);
+  delete txn;
+  row = scan();
+  EXPECT_EQ(8, row.GetValue(&view_schema, 0).GetAs<int32_t>());
+  EXPECT_EQ(1, row.GetValue(&view_schema, 2).GetAs<int32_t>());
+  EXPECT_EQ(8, row.GetValue(&view_schema, 3).GetAs<int32_t>());
+
+  txn = txn_mgr_->Begin();
+  for (int32_t i = 1; i < 9; i++) {
+    ASSERT_TRUE(table->MarkDelete(rids[i], txn));
+  }
+  txn_mgr_->Commit(txn);
+  delete txn;
+  row = scan();
+  EXPECT_EQ(0, row.GetValue(&view_schema, 0).GetAs<int32_t>());
+  EXPECT_TRUE(row.GetValue(&view_schema, 3).IsNull());
+  EXPECT_EQ(1, view->GetGroupCount());
+}
+
+// NOLINTNEXTLINE
+TEST_F(MaterializedViewTest, ToastedGroupByTest) {
+  // the group-by values are too large for the rows, and are moved to overflow chains
+  Schema schema({Column("g", TypeId::VARCHAR, 8000), Column("v", TypeId::INTEGER)});
+  Transaction *txn = txn_mgr_->Begin();
+  TableMetadata *table_info = catalog_->CreateTable(txn, "wide", schema);
+  for (int32_t i = 0; i < 12; i++) {
+    Tuple tuple({ValueFactory::GetVarcharValue(std::string(6000, static_cast<char>('a' + i % 3))),
+                 ValueFactory::GetIntegerValue(i)},
+                &schema);
+    RID rid;
+    ASSERT_TRUE(table_info->table_->InsertTuple(tuple, &rid, txn));
+  }
+  txn_mgr_->Commit(txn);
+  delete txn;
+
+  // built by a scan of the rows, which groups them by their values as they were inserted
+  txn = txn_mgr_->Begin();
+  MaterializedView *view = catalog_->CreateMaterializedView(txn, "wide_view", "wide", {0},
+                                                            {{AggregationType::CountAggregate, 1},
+                                                             {AggregationType::SumAggregate, 1}});
+  txn_mgr_->Commit(txn);
+  delete txn;
+  ASSERT_EQ(3, view->GetGroupCount());
+  txn = txn_mgr_->Begin();
+  std::vector<Tuple> tuples;
+  view->Scan(txn, &tuples);
+  txn_mgr_->Commit(txn);
+  delete txn;
+  ASSERT_EQ(3, tuples.size());
+  for (const Tuple &tuple : tuples) {
+    std::string g = tuple.GetValue(&view->GetSchema(), 0).ToString();
+    ASSERT_EQ(6000, g.size());
+    int32_t first = g[0] - 'a';
+    EXPECT_EQ(std::string(6000, g[0]), g);
+    EXPECT_EQ(4, tuple.GetValue(&view->GetSchema(), 1).GetAs<int32_t>());
+    EXPECT_EQ(4 * first + 18, tuple.GetValue(&view->GetSchema(), 2).GetAs<int32_t>());
+  }
+}
+
+}  // namespace bustub
@@ -0,0 +1,46 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// bloom_filter_test.cpp
+//
+// Identification: test/common/bloom_filter_test.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <cstdint>
+
+#include "common/util/bloom_filter.h"
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+// NOLINTNEXTLINE
+TEST(BloomFilterTest, FalsePositiveRateTest) {
+  const size_t num_keys = 10000;
+  BloomFilter filter(num_keys);
+  EXPECT_EQ(0, filter.GetByteSize() % CACHE_LINE_SIZE);
+  EXPECT_GE(filter.GetByteSize() * 8, num_keys * BloomFilter::BITS_PER_KEY);
+
+  // the hashes of consecutive integers are consecutive too, which the filter has to cope with
+  for (hash_t key = 0; key < num_keys; key++) {
+    filter.Insert(key);
+  }
+  for (hash_t key = 0; key < num_keys; key++) {
+    ASSERT_TRUE(filter.MayContain(key)) << key;
+  }
+  size_t false_positives = 0;
+  for (hash_t key = num_keys; key < 11 * num_keys; key++) {
+    false_positives += filter.MayContain(key) ? 1 : 0;
+  }
+  EXPECT_LT(false_positives, 10 * num_keys / 100);
+
+  // an empty filter passes nothing
+  BloomFilter empty(0);
+  EXPECT_EQ(CACHE_LINE_SIZE, empty.GetByteSize());
+  EXPECT_FALSE(empty.MayContain(42));
+}
+
+}  // namespace bustub
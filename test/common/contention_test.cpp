@@ -0,0 +1,104 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// contention_test.cpp
+//
+// Identification: test/common/contention_test.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <chrono>  // NOLINT
+#include <sstream>
+#include <string>
+#include <thread>  // NOLINT
+
+#include "common/contention.h"
+#include "common/rwlatch.h"
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+// NOLINTNEXTLINE
+TEST(ContentionTest, SiteTest) {
+  ContentionSite *site = ContentionProfiler::Site("test.mutex");
+  EXPECT_EQ(site, ContentionProfiler::Site("test.mutex"));
+  site->Reset();
+  std::mutex mutex;
+
+  // an acquire that finds the mutex free is not counted
+  { auto lock = site->Acquire(&mutex); }
+  EXPECT_EQ(0, site->GetStats().waits_);
+
+  auto lock = site->Acquire(&mutex);
+  std::thread waiter([&] { auto other = site->Acquire(&mutex); });
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  lock.unlock();
+  waiter.join();
+  ContentionStats stats = site->GetStats();
+  EXPECT_EQ("test.mutex", stats.name_);
+  EXPECT_EQ(1, stats.waits_);
+  EXPECT_LT(0, stats.wait_ns_);
+  EXPECT_EQ(stats.wait_ns_, stats.max_wait_ns_);
+  EXPECT_DOUBLE_EQ(static_cast<double>(stats.wait_ns_), stats.MeanWaitNs());
+
+  // the report has the sites that waited, the longest waited first
+  ContentionProfiler::Site("test.short")->RecordWait(std::chrono::nanoseconds(1));
+  bool seen_mutex = false;
+  uint64_t previous = UINT64_MAX;
+  for (const ContentionStats &reported : ContentionProfiler::Report()) {
+    EXPECT_LT(0, reported.waits_);
+    EXPECT_LE(reported.wait_ns_, previous);
+    previous = reported.wait_ns_;
+    seen_mutex = seen_mutex || reported.name_ == "test.mutex";
+  }
+  EXPECT_TRUE(seen_mutex);
+  std::stringstream dump;
+  ContentionProfiler::Dump(&dump);
+  EXPECT_NE(std::string::npos, dump.str().find("test.mutex: waits 1, waited "));
+  EXPECT_NE(std::string::npos, dump.str().find("test.short: waits 1, waited 0.0 us"));
+
+  ContentionProfiler::Reset();
+  EXPECT_EQ(0, site->GetStats().waits_);
+  EXPECT_EQ(0, site->GetStats().max_wait_ns_);
+}
+
+// NOLINTNEXTLINE
+TEST(ContentionTest, ReaderWriterLatchTest) {
+  ContentionSite *site = ContentionProfiler::Site("test.rwlatch");
+  site->Reset();
+  ReaderWriterLatch latch{"test.rwlatch"};
+
+  // readers share the latch without waiting
+  latch.RLock();
+  latch.RLock();
+  latch.RUnlock();
+  latch.RUnlock();
+  EXPECT_EQ(0, site->GetStats().waits_);
+
+  // a writer waits for a reader, and a reader for a writer
+  latch.RLock();
+  std::thread writer([&] {
+    latch.WLock();
+    latch.WUnlock();
+  });
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  latch.RUnlock();
+  writer.join();
+  EXPECT_EQ(1, site->GetStats().waits_);
+
+  latch.WLock();
+  std::thread reader([&] {
+    latch.RLock();
+    latch.RUnlock();
+  });
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  latch.WUnlock();
+  reader.join();
+  EXPECT_EQ(2, site->GetStats().waits_);
+  EXPECT_LT(0, site->GetStats().wait_ns_);
+}
+
+}  // namespace bustub
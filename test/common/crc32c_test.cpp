@@ -0,0 +1,49 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// crc32c_test.cpp
+//
+// Identification: test/common/crc32c_test.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <string>
+#include <vector>
+
+#include "common/util/crc32c.h"
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+// NOLINTNEXTLINE
+TEST(Crc32cTest, KnownValuesTest) {
+  // check values from RFC 3720, B.4
+  std::vector<char> zeroes(32, 0);
+  std::vector<char> ones(32, static_cast<char>(0xFF));
+  std::vector<char> ascending(32);
+  for (size_t i = 0; i < ascending.size(); ++i) {
+    ascending[i] = static_cast<char>(i);
+  }
+  EXPECT_EQ(0x8A9136AAU, Crc32c::Compute(zeroes.data(), zeroes.size()));
+  EXPECT_EQ(0x62A8AB43U, Crc32c::Compute(ones.data(), ones.size()));
+  EXPECT_EQ(0x46DD794EU, Crc32c::Compute(ascending.data(), ascending.size()));
+
+  std::string digits("123456789");
+  EXPECT_EQ(0xE3069283U, Crc32c::Compute(digits.data(), digits.size()));
+  EXPECT_EQ(0U, Crc32c::Compute(digits.data(), 0));
+}
+
+// NOLINTNEXTLINE
+TEST(Crc32cTest, PiecewiseTest) {
+  std::string text("The quick brown fox jumps over the lazy dog, and then some more to get past a few words.");
+  uint32_t whole = Crc32c::Compute(text.data(), text.size());
+  for (size_t split = 0; split <= text.size(); ++split) {
+    uint32_t head = Crc32c::Compute(text.data(), split);
+    EXPECT_EQ(whole, Crc32c::Compute(text.data() + split, text.size() - split, head));
+  }
+}
+
+}  // namespace bustub
@@ -0,0 +1,89 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// hash_util_test.cpp
+//
+// Identification: test/common/hash_util_test.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#include "common/util/hash_util.h"
+#include "gtest/gtest.h"
+#include "type/value_factory.h"
+
+namespace bustub {
+
+// NOLINTNEXTLINE
+TEST(HashUtilTest, HashBytesTest) {
+  // a word hashes as its 8 bytes do
+  uint64_t word = 0x0123456789abcdefULL;
+  EXPECT_EQ(HashUtil::HashWord(word), HashUtil::HashBytes(reinterpret_cast<const char *>(&word), sizeof(word)));
+
+  // every byte of an input counts, in the lanes of a long one and in its tail, and so does its length
+  std::string bytes(100, 'x');
+  std::unordered_set<hash_t> hashes{HashUtil::HashBytes(bytes.data(), bytes.size())};
+  for (size_t i = 0; i < bytes.size(); i++) {
+    std::string changed = bytes;
+    changed[i] = 'y';
+    EXPECT_TRUE(hashes.insert(HashUtil::HashBytes(changed.data(), changed.size())).second) << i;
+  }
+  for (size_t length = 0; length < bytes.size(); length++) {
+    EXPECT_TRUE(hashes.insert(HashUtil::HashBytes(bytes.data(), length)).second) << length;
+  }
+  std::string zeros(16, '\0');
+  EXPECT_NE(HashUtil::HashBytes(zeros.data(), 8), HashUtil::HashBytes(zeros.data(), 16));
+}
+
+// NOLINTNEXTLINE
+TEST(HashUtilTest, DistributionTest) {
+  // consecutive integers spread evenly over the low bits, which pick the bucket of a power-of-two table
+  const size_t num_buckets = 1024;
+  const size_t num_keys = 64 * num_buckets;
+  std::vector<size_t> buckets(num_buckets, 0);
+  std::unordered_set<hash_t> hashes;
+  for (int32_t key = 0; key < static_cast<int32_t>(num_keys); key++) {
+    Value value = ValueFactory::GetIntegerValue(key);
+    hash_t hash = HashUtil::HashValue(&value);
+    hashes.insert(hash);
+    buckets[hash % num_buckets]++;
+  }
+  EXPECT_EQ(num_keys, hashes.size());
+  for (size_t count : buckets) {
+    EXPECT_LT(count, 3 * num_keys / num_buckets);
+    EXPECT_GT(count, num_keys / num_buckets / 3);
+  }
+}
+
+// NOLINTNEXTLINE
+TEST(HashUtilTest, HashValueTest) {
+  // the integer types hash alike, so that keys of different integer types match in a hash table
+  Value tiny = ValueFactory::GetTinyIntValue(7);
+  Value small = ValueFactory::GetSmallIntValue(7);
+  Value integer = ValueFactory::GetIntegerValue(7);
+  Value big = ValueFactory::GetBigIntValue(7);
+  EXPECT_EQ(HashUtil::HashValue(&integer), HashUtil::HashValue(&tiny));
+  EXPECT_EQ(HashUtil::HashValue(&integer), HashUtil::HashValue(&small));
+  EXPECT_EQ(HashUtil::HashValue(&integer), HashUtil::HashValue(&big));
+  Value other = ValueFactory::GetIntegerValue(8);
+  EXPECT_NE(HashUtil::HashValue(&integer), HashUtil::HashValue(&other));
+
+  Value null_integer = ValueFactory::GetNullValueByType(TypeId::INTEGER);
+  Value null_varchar = ValueFactory::GetNullValueByType(TypeId::VARCHAR);
+  EXPECT_EQ(HashUtil::NULL_HASH, HashUtil::HashValue(&null_integer));
+  EXPECT_EQ(HashUtil::NULL_HASH, HashUtil::HashValue(&null_varchar));
+
+  // combining depends on the order, so that the keys (1, 2) and (2, 1) differ
+  hash_t one = HashUtil::HashValue(&tiny);
+  hash_t two = HashUtil::HashValue(&other);
+  EXPECT_NE(HashUtil::CombineHashes(one, two), HashUtil::CombineHashes(two, one));
+  EXPECT_NE(HashUtil::CombineHashes(0, one), one);
+}
+
+}  // namespace bustub
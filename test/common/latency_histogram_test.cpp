@@ -0,0 +1,126 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// latency_histogram_test.cpp
+//
+// Identification: test/common/latency_histogram_test.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <chrono>  // NOLINT
+#include <cstdio>
+#include <map>
+#include <sstream>
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "common/bustub_instance.h"
+#include "common/latency_histogram.h"
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+// NOLINTNEXTLINE
+TEST(LatencyHistogramTest, BucketTest) {
+  // every latency is in the bucket whose range holds it, and the range is within 1/SUB_BUCKETS of it
+  uint64_t previous_bound = 0;
+  for (size_t bucket = 1; bucket < LatencySnapshot::NUM_BUCKETS; bucket++) {
+    uint64_t bound = LatencySnapshot::BucketUpperBound(bucket);
+    ASSERT_LT(previous_bound, bound) << bucket;
+    EXPECT_EQ(bucket, LatencySnapshot::BucketOf(bound));
+    EXPECT_EQ(bucket, LatencySnapshot::BucketOf(previous_bound + 1));
+    EXPECT_LE(bound - previous_bound, (previous_bound + 1) / LatencySnapshot::SUB_BUCKETS + 1) << bucket;
+    previous_bound = bound;
+  }
+  EXPECT_EQ(LatencySnapshot::MAX_LATENCY_NS, previous_bound);
+  EXPECT_EQ(LatencySnapshot::NUM_BUCKETS - 1, LatencySnapshot::BucketOf(UINT64_MAX));
+}
+
+// NOLINTNEXTLINE
+TEST(LatencyHistogramTest, PercentileTest) {
+  // four threads record 1..10000 us between them, each into the stripe of its own
+  LatencyHistogram histogram;
+  EXPECT_EQ(0, histogram.Snapshot().count_);
+  EXPECT_EQ(0, histogram.Snapshot().PercentileNs(99));
+  std::vector<std::thread> threads;
+  for (int thread = 0; thread < 4; thread++) {
+    threads.emplace_back([&, thread] {
+      for (int64_t us = thread + 1; us <= 10000; us += 4) {
+        histogram.Record(std::chrono::microseconds(us));
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  LatencySnapshot snapshot = histogram.Snapshot();
+  EXPECT_EQ(10000, snapshot.count_);
+  EXPECT_EQ(1000, snapshot.min_ns_);
+  EXPECT_EQ(10000000, snapshot.max_ns_);
+  EXPECT_DOUBLE_EQ(5000500, snapshot.MeanNs());
+  for (double percentile : {50.0, 90.0, 99.0, 99.9}) {
+    auto exact = static_cast<double>(percentile * 100 * 1000);
+    auto estimate = static_cast<double>(snapshot.PercentileNs(percentile));
+    EXPECT_GE(estimate, exact) << percentile;
+    EXPECT_LE(estimate, exact * (1 + 1.0 / LatencySnapshot::SUB_BUCKETS)) << percentile;
+  }
+  EXPECT_EQ(10000000, snapshot.PercentileNs(100));
+
+  // merging two snapshots counts the latencies of both
+  LatencyHistogram other;
+  other.Record(std::chrono::nanoseconds(-5));
+  other.Record(std::chrono::hours(1));
+  snapshot += other.Snapshot();
+  EXPECT_EQ(10002, snapshot.count_);
+  EXPECT_EQ(0, snapshot.min_ns_);
+  EXPECT_EQ(LatencySnapshot::MAX_LATENCY_NS, snapshot.max_ns_);
+  EXPECT_EQ(0, snapshot.PercentileNs(0));
+}
+
+// NOLINTNEXTLINE
+TEST(LatencyHistogramTest, InstanceTest) {
+  auto *instance = new BustubInstance("test.db", 10);
+  page_id_t page_id;
+  ASSERT_NE(nullptr, instance->buffer_pool_manager_->NewPage(&page_id));
+  instance->buffer_pool_manager_->UnpinPage(page_id, true);
+  // the pool of 10 frames evicts the first page, which the last fetch reads back in
+  for (int i = 0; i < 20; i++) {
+    page_id_t other;
+    ASSERT_NE(nullptr, instance->buffer_pool_manager_->NewPage(&other));
+    instance->buffer_pool_manager_->UnpinPage(other, true);
+  }
+  ASSERT_NE(nullptr, instance->buffer_pool_manager_->FetchPage(page_id));
+  ASSERT_NE(nullptr, instance->buffer_pool_manager_->FetchPage(page_id));
+  instance->buffer_pool_manager_->UnpinPage(page_id, false);
+  instance->buffer_pool_manager_->UnpinPage(page_id, false);
+  Transaction *txn = instance->transaction_manager_->Begin();
+  instance->transaction_manager_->Commit(txn);
+  delete txn;
+
+  std::map<std::string, uint64_t> counts;
+  for (const auto &[name, snapshot] : instance->GetLatencies()) {
+    counts[name] = snapshot.count_;
+  }
+  EXPECT_EQ(2, counts["buffer_pool.fetch_page"]);
+  EXPECT_EQ(1, counts["disk.read_page"]);
+  EXPECT_LE(1, counts["disk.write_page"]);
+  EXPECT_EQ(0, counts["lock.wait"]);
+  EXPECT_EQ(1, counts["txn.commit"]);
+  EXPECT_EQ(7, counts.size());
+
+  std::stringstream dump;
+  instance->DumpLatencies(&dump);
+  EXPECT_NE(std::string::npos, dump.str().find("buffer_pool.fetch_page: count 2, mean "));
+  EXPECT_NE(std::string::npos, dump.str().find("txn.commit: count 1, mean "));
+
+  delete instance;
+  remove("test.db");
+  remove("test.log");
+}
+
+}  // namespace bustub
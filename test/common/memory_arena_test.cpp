@@ -0,0 +1,93 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// memory_arena_test.cpp
+//
+// Identification: test/common/memory_arena_test.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "catalog/schema.h"
+#include "common/memory_arena.h"
+#include "gtest/gtest.h"
+#include "storage/table/tuple.h"
+#include "type/value.h"
+
+namespace bustub {
+
+// NOLINTNEXTLINE
+TEST(MemoryArenaTest, AllocateTest) {
+  MemoryArena arena;
+  EXPECT_EQ(0, arena.GetCapacity());
+
+  // small allocations are bumped through one block, aligned as asked for, and do not overlap
+  std::vector<char *> allocations;
+  for (size_t i = 1; i <= 100; i++) {
+    size_t alignment = size_t{1} << (i % 5);
+    char *data = arena.Allocate(i, alignment);
+    EXPECT_EQ(0, reinterpret_cast<uintptr_t>(data) % alignment);
+    memset(data, static_cast<int>(i), i);
+    allocations.push_back(data);
+  }
+  EXPECT_EQ(MemoryArena::BLOCK_SIZE, arena.GetCapacity());
+  for (size_t i = 1; i <= 100; i++) {
+    for (size_t j = 0; j < i; j++) {
+      ASSERT_EQ(static_cast<char>(i), allocations[i - 1][j]);
+    }
+  }
+
+  // a large allocation gets a block of its own, and the next small one still goes into the first block
+  char *large = arena.Allocate(MemoryArena::BLOCK_SIZE, 4096);
+  EXPECT_EQ(0, reinterpret_cast<uintptr_t>(large) % 4096);
+  memset(large, 0, MemoryArena::BLOCK_SIZE);
+  size_t capacity = arena.GetCapacity();
+  EXPECT_GT(capacity, 2 * MemoryArena::BLOCK_SIZE);
+  arena.Allocate(8);
+  EXPECT_EQ(capacity, arena.GetCapacity());
+
+  // filling the block starts another one
+  for (size_t i = 0; i < 2 * MemoryArena::BLOCK_SIZE / 1024; i++) {
+    arena.Allocate(1024);
+  }
+  EXPECT_GT(arena.GetCapacity(), capacity);
+
+  // a reset keeps a single block
+  arena.Reset();
+  EXPECT_EQ(MemoryArena::BLOCK_SIZE, arena.GetCapacity());
+  arena.Allocate(100);
+  EXPECT_EQ(MemoryArena::BLOCK_SIZE, arena.GetCapacity());
+}
+
+// NOLINTNEXTLINE
+TEST(MemoryArenaTest, TupleAndValueTest) {
+  MemoryArena arena;
+  Schema schema({Column("a", TypeId::INTEGER), Column("b", TypeId::VARCHAR, 32)});
+
+  // a tuple built in the arena is a view of its memory
+  Tuple tuple({Value(TypeId::INTEGER, 7), Value(TypeId::VARCHAR, "seven")}, &schema, &arena);
+  EXPECT_FALSE(tuple.IsAllocated());
+  EXPECT_EQ(7, tuple.GetValue(&schema, 0).GetAs<int32_t>());
+  EXPECT_EQ("seven", tuple.GetValue(&schema, 1).ToString());
+  Tuple owned({Value(TypeId::INTEGER, 7), Value(TypeId::VARCHAR, "seven")}, &schema);
+  ASSERT_EQ(owned.GetLength(), tuple.GetLength());
+  EXPECT_EQ(0, memcmp(owned.GetData(), tuple.GetData(), tuple.GetLength()));
+
+  // and so is a VARCHAR value, whose copies share the arena's copy of the string
+  std::string text = "a string in the arena";
+  Value value(TypeId::VARCHAR, text.c_str(), static_cast<uint32_t>(text.size() + 1), &arena);
+  text[0] = 'A';
+  Value copy = value;  // NOLINT
+  EXPECT_EQ("a string in the arena", copy.ToString());
+  EXPECT_EQ(value.GetData(), copy.GetData());
+  EXPECT_TRUE(Value(TypeId::VARCHAR, nullptr, 0, &arena).IsNull());
+}
+
+}  // namespace bustub
@@ -0,0 +1,138 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// memory_tracker_test.cpp
+//
+// Identification: test/common/memory_tracker_test.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <cstdio>
+#include <list>
+#include <sstream>
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "buffer/buffer_pool_manager_instance.h"
+#include "catalog/schema.h"
+#include "common/memory_arena.h"
+#include "common/memory_tracker.h"
+#include "gtest/gtest.h"
+#include "storage/table/tuple.h"
+#include "type/value_factory.h"
+
+namespace bustub {
+
+// NOLINTNEXTLINE
+TEST(MemoryTrackerTest, TrackerTest) {
+  MemoryTracker parent;
+  MemoryTracker child(&parent);
+  child.Allocate(MemoryCategory::SORT, 3000);
+  child.Allocate(MemoryCategory::HASH_JOIN, 500);
+  child.Free(MemoryCategory::SORT, 2000);
+  parent.Allocate(MemoryCategory::CATALOG, 200);
+
+  EXPECT_EQ(1000, child.GetCurrent(MemoryCategory::SORT));
+  EXPECT_EQ(3000, child.GetPeak(MemoryCategory::SORT));
+  EXPECT_EQ(1500, child.GetTotal());
+  EXPECT_EQ(3500, child.GetPeakTotal());
+  // the parent has what the child has, and its own
+  EXPECT_EQ(1000, parent.GetCurrent(MemoryCategory::SORT));
+  EXPECT_EQ(1700, parent.GetTotal());
+  EXPECT_EQ(0, child.GetCurrent(MemoryCategory::CATALOG));
+
+  // the categories that held anything, the most held now first
+  std::vector<MemoryUsage> report = parent.Report();
+  ASSERT_EQ(3, report.size());
+  EXPECT_EQ(MemoryCategory::SORT, report[0].category_);
+  EXPECT_EQ(MemoryCategory::HASH_JOIN, report[1].category_);
+  EXPECT_EQ(MemoryCategory::CATALOG, report[2].category_);
+  EXPECT_EQ(3000, report[0].peak_);
+
+  std::stringstream dump;
+  parent.Dump(&dump);
+  EXPECT_NE(std::string::npos, dump.str().find("sort: 0.00 MiB, peak 0.00 MiB\n"));
+  EXPECT_NE(std::string::npos, dump.str().find("total: "));
+}
+
+// NOLINTNEXTLINE
+TEST(MemoryTrackerTest, LocalTest) {
+  MemoryTracker *global = MemoryTracker::Global();
+  size_t before = global->GetCurrent(MemoryCategory::OTHER);
+  std::thread thread([&] {
+    // a small allocation stays in the batch of the thread, a large one is passed on
+    MemoryTracker::AllocateLocal(MemoryCategory::OTHER, 100);
+    EXPECT_EQ(before, global->GetCurrent(MemoryCategory::OTHER));
+    MemoryTracker::AllocateLocal(MemoryCategory::OTHER, MemoryTracker::LOCAL_BATCH);
+    EXPECT_EQ(before + MemoryTracker::LOCAL_BATCH + 100, global->GetCurrent(MemoryCategory::OTHER));
+    MemoryTracker::FreeLocal(MemoryCategory::OTHER, MemoryTracker::LOCAL_BATCH - 50);
+    EXPECT_EQ(before + MemoryTracker::LOCAL_BATCH + 100, global->GetCurrent(MemoryCategory::OTHER));
+  });
+  thread.join();
+  // the thread passed what was left of its batch on as it exited
+  EXPECT_EQ(before + 150, global->GetCurrent(MemoryCategory::OTHER));
+  global->Free(MemoryCategory::OTHER, 150);
+
+  // the nodes of a container with a TrackedAllocator are accounted for
+  std::thread nodes([&] {
+    std::list<int64_t, TrackedAllocator<int64_t, MemoryCategory::OTHER>> list;
+    for (int i = 0; i < 10000; i++) {
+      list.push_back(i);
+    }
+    EXPECT_LE(before + 10000 * sizeof(int64_t) - MemoryTracker::LOCAL_BATCH, global->GetCurrent(MemoryCategory::OTHER));
+  });
+  nodes.join();
+  EXPECT_EQ(before, global->GetCurrent(MemoryCategory::OTHER));
+}
+
+// NOLINTNEXTLINE
+TEST(MemoryTrackerTest, SubsystemTest) {
+  MemoryTracker *global = MemoryTracker::Global();
+
+  // the frames of a buffer pool are accounted for as long as it lives
+  size_t before = global->GetCurrent(MemoryCategory::BUFFER_POOL);
+  auto *disk_manager = new DiskManager("test.db");
+  auto *bpm = new BufferPoolManagerInstance(64, disk_manager);
+  EXPECT_LE(before + 64 * PAGE_SIZE, global->GetCurrent(MemoryCategory::BUFFER_POOL));
+  delete bpm;
+  delete disk_manager;
+  remove("test.db");
+  EXPECT_EQ(before, global->GetCurrent(MemoryCategory::BUFFER_POOL));
+
+  // the copies of tuples are, in the batch of the thread that makes them, till they are freed
+  std::thread tuples([&] {
+    Column column("a", TypeId::VARCHAR, 100);
+    Schema schema({column});
+    size_t tuples_before = global->GetCurrent(MemoryCategory::TUPLES);
+    std::vector<Tuple> copies;
+    for (int i = 0; i < 1000; i++) {
+      copies.emplace_back(std::vector<Value>{ValueFactory::GetVarcharValue(std::string(100, 'x'))}, &schema);
+    }
+    EXPECT_LE(tuples_before + 1000 * 100 - MemoryTracker::LOCAL_BATCH, global->GetCurrent(MemoryCategory::TUPLES));
+    copies.clear();
+    EXPECT_GE(tuples_before + MemoryTracker::LOCAL_BATCH, global->GetCurrent(MemoryCategory::TUPLES));
+  });
+  tuples.join();
+
+  // the blocks of an arena are, in its own tracker and the global one
+  MemoryTracker query(global);
+  size_t arena_before = global->GetCurrent(MemoryCategory::QUERY_ARENA);
+  {
+    MemoryArena arena(&query);
+    arena.Allocate(100);
+    arena.Allocate(MemoryArena::BLOCK_SIZE);
+    EXPECT_EQ(arena.GetCapacity(), query.GetCurrent(MemoryCategory::QUERY_ARENA));
+    EXPECT_EQ(arena_before + arena.GetCapacity(), global->GetCurrent(MemoryCategory::QUERY_ARENA));
+    arena.Reset();
+    EXPECT_EQ(MemoryArena::BLOCK_SIZE, query.GetCurrent(MemoryCategory::QUERY_ARENA));
+  }
+  EXPECT_EQ(0, query.GetCurrent(MemoryCategory::QUERY_ARENA));
+  EXPECT_LT(MemoryArena::BLOCK_SIZE, query.GetPeak(MemoryCategory::QUERY_ARENA));
+  EXPECT_EQ(arena_before, global->GetCurrent(MemoryCategory::QUERY_ARENA));
+}
+
+}  // namespace bustub
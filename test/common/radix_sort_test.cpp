@@ -0,0 +1,62 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// radix_sort_test.cpp
+//
+// Identification: test/common/radix_sort_test.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include "common/util/radix_sort.h"
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+namespace {
+
+struct Entry {
+  uint64_t prefix_;
+  /** the rest of the key, which only tied prefixes are compared by */
+  uint32_t suffix_;
+  uint32_t index_;
+};
+
+bool TieLess(const Entry &a, const Entry &b) {
+  return a.suffix_ != b.suffix_ ? a.suffix_ < b.suffix_ : a.index_ < b.index_;
+}
+
+}  // namespace
+
+// NOLINTNEXTLINE
+TEST(RadixSortTest, SortTest) {
+  std::mt19937_64 gen(15445);
+  // from too few entries to radix sort to many, and from prefixes that all tie to prefixes that never do; the
+  // prefixes of small integers leave most of their bytes the same, which the sort skips
+  for (size_t num_entries : {10, 100000}) {
+    for (uint64_t mask : {uint64_t{0}, uint64_t{0xFF}, uint64_t{0xFFFF0000FF000000}, ~uint64_t{0}}) {
+      std::vector<Entry> entries(num_entries);
+      for (uint32_t i = 0; i < num_entries; i++) {
+        entries[i] = Entry{gen() & mask, static_cast<uint32_t>(gen() % 4), i};
+      }
+      std::vector<Entry> expected = entries;
+      std::sort(expected.begin(), expected.end(), [](const Entry &a, const Entry &b) {
+        return a.prefix_ != b.prefix_ ? a.prefix_ < b.prefix_ : TieLess(a, b);
+      });
+      RadixSortByPrefix(&entries, TieLess);
+      ASSERT_EQ(expected.size(), entries.size());
+      for (size_t i = 0; i < entries.size(); i++) {
+        ASSERT_EQ(expected[i].index_, entries[i].index_) << "mask " << mask << ", entry " << i;
+      }
+    }
+  }
+}
+
+}  // namespace bustub
@@ -0,0 +1,114 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// tracer_test.cpp
+//
+// Identification: test/common/tracer_test.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <chrono>  // NOLINT
+#include <set>
+#include <sstream>
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "common/tracer.h"
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+// NOLINTNEXTLINE
+TEST(TracerTest, SpanTest) {
+  Tracer::Disable();
+  Tracer::Clear();
+  { TraceSpan span("ignored", "test"); }
+  EXPECT_TRUE(Tracer::GetEvents().empty());
+
+  // three threads each record an outer span around two inner ones, into rings of their own
+  Tracer::Enable();
+  std::vector<std::thread> threads;
+  for (int thread = 0; thread < 3; thread++) {
+    threads.emplace_back([thread] {
+      TraceSpan outer("outer", "test");
+      outer.SetArg("thread", thread);
+      for (int i = 0; i < 2; i++) {
+        TraceSpan inner("inner", "test");
+        std::this_thread::sleep_for(std::chrono::microseconds(100));
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  std::vector<TraceEvent> events = Tracer::GetEvents();
+  ASSERT_EQ(9, events.size());
+  std::set<uint32_t> thread_ids;
+  std::set<int64_t> args;
+  for (size_t i = 0; i < events.size(); i++) {
+    EXPECT_TRUE(i == 0 || events[i - 1].start_ns_ <= events[i].start_ns_);
+    thread_ids.insert(events[i].thread_);
+    if (std::string(events[i].name_) == "outer") {
+      ASSERT_STREQ("thread", events[i].arg_name_);
+      args.insert(events[i].arg_);
+      // the inner spans of the thread lie within its outer one
+      for (const TraceEvent &inner : events) {
+        if (inner.thread_ == events[i].thread_ && std::string(inner.name_) == "inner") {
+          EXPECT_GE(inner.duration_ns_, 100000);
+          EXPECT_GE(inner.start_ns_, events[i].start_ns_);
+          EXPECT_LE(inner.start_ns_ + inner.duration_ns_, events[i].start_ns_ + events[i].duration_ns_);
+        }
+      }
+    } else {
+      EXPECT_EQ(nullptr, events[i].arg_name_);
+    }
+  }
+  EXPECT_EQ(3, thread_ids.size());
+  EXPECT_EQ((std::set<int64_t>{0, 1, 2}), args);
+
+  std::stringstream trace;
+  Tracer::ExportChromeTrace(&trace);
+  std::string json = trace.str();
+  EXPECT_EQ(0, json.rfind("{\"traceEvents\":[", 0));
+  size_t complete_events = 0;
+  for (size_t at = json.find("\"ph\":\"X\""); at != std::string::npos; at = json.find("\"ph\":\"X\"", at + 1)) {
+    complete_events++;
+  }
+  EXPECT_EQ(9, complete_events);
+  EXPECT_NE(std::string::npos, json.find("\"args\":{\"thread\":2}"));
+  Tracer::Disable();
+  Tracer::Clear();
+}
+
+// NOLINTNEXTLINE
+TEST(TracerTest, RingTest) {
+  // a ring keeps the last spans of its thread, and the threads that come after reuse the rings of the ones before
+  Tracer::Enable(4);
+  Tracer::Clear();
+  for (int run = 0; run < 2; run++) {
+    std::thread thread([] {
+      auto start = std::chrono::steady_clock::now();
+      for (int64_t i = 0; i < 10; i++) {
+        Tracer::AddSpan("span", "test", start + std::chrono::microseconds(i), start + std::chrono::microseconds(i + 1),
+                        "i", i);
+      }
+    });
+    thread.join();
+  }
+  std::vector<TraceEvent> events = Tracer::GetEvents();
+  ASSERT_EQ(4, events.size());
+  for (int64_t i = 0; i < 4; i++) {
+    EXPECT_EQ(6 + i, events[i].arg_);
+    EXPECT_EQ(1000, events[i].duration_ns_);
+  }
+  Tracer::Disable();
+  Tracer::Enable();
+  EXPECT_TRUE(Tracer::GetEvents().empty());
+  Tracer::Disable();
+}
+
+}  // namespace bustub
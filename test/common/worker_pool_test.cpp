@@ -0,0 +1,135 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// worker_pool_test.cpp
+//
+// Identification: test/common/worker_pool_test.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <atomic>
+#include <stdexcept>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "common/util/morsel_queue.h"
+#include "common/util/numa.h"
+#include "common/worker_pool.h"
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+// NOLINTNEXTLINE
+TEST(WorkerPoolTest, RunTest) {
+  WorkerPool pool;
+  EXPECT_EQ(0, pool.GetWorkerCount());
+
+  // every worker runs its piece of work once, on a thread other than the caller's
+  for (size_t num_workers : {4, 2, 8}) {
+    std::vector<std::atomic<int>> runs(num_workers);
+    std::atomic<bool> on_caller{false};
+    std::thread::id caller = std::this_thread::get_id();
+    pool.Run(num_workers, [&](size_t worker) {
+      runs[worker]++;
+      on_caller = on_caller || std::this_thread::get_id() == caller;
+    });
+    for (auto &run : runs) {
+      EXPECT_EQ(1, run);
+    }
+    EXPECT_FALSE(on_caller);
+  }
+  // the threads are started as they are first needed, and kept
+  EXPECT_EQ(8, pool.GetWorkerCount());
+
+  // an exception of a worker comes out of Run, once the others are done
+  std::atomic<int> done{0};
+  EXPECT_THROW(pool.Run(4,
+                        [&](size_t worker) {
+                          if (worker == 2) {
+                            throw std::runtime_error("failed");
+                          }
+                          done++;
+                        }),
+               std::runtime_error);
+  EXPECT_EQ(3, done);
+
+  // and the pool runs on after it
+  std::atomic<int> count{0};
+  pool.Run(8, [&](size_t /*worker*/) { count++; });
+  EXPECT_EQ(8, count);
+}
+
+// NOLINTNEXTLINE
+TEST(WorkerPoolTest, CpusTest) {
+  std::vector<int> cpus = WorkerPool::CpusInNumaOrder();
+  ASSERT_FALSE(cpus.empty());
+  std::vector<int> sorted = cpus;
+  std::sort(sorted.begin(), sorted.end());
+  EXPECT_EQ(sorted.end(), std::adjacent_find(sorted.begin(), sorted.end()));
+
+  // the CPUs of a node come together, and a pinned worker is on the node of its CPU
+  ASSERT_GE(Numa::GetNodeCount(), 1);
+  WorkerPool pool;
+  int last_node = -1;
+  for (size_t i = 0; i < cpus.size(); i++) {
+    int node = Numa::GetNodeOfCpu(cpus[i]);
+    EXPECT_EQ(node, pool.GetWorkerNode(i));
+    if (node >= 0) {
+      EXPECT_LE(last_node, node);
+      last_node = node;
+    }
+  }
+  EXPECT_EQ(-1, WorkerPool(false).GetWorkerNode(0));
+}
+
+// NOLINTNEXTLINE
+TEST(WorkerPoolTest, MorselQueueTest) {
+  // a single worker takes the morsels in order
+  {
+    MorselQueue queue(10, 1);
+    size_t morsel;
+    for (size_t i = 0; i < 10; i++) {
+      ASSERT_TRUE(queue.Next(0, &morsel));
+      EXPECT_EQ(i, morsel);
+    }
+    EXPECT_FALSE(queue.Next(0, &morsel));
+  }
+
+  // a worker takes its own stretch from the front, and then steals the others' from the back
+  {
+    MorselQueue queue(8, 2);
+    size_t morsel;
+    std::vector<size_t> taken;
+    while (queue.Next(0, &morsel)) {
+      taken.push_back(morsel);
+    }
+    EXPECT_EQ((std::vector<size_t>{0, 1, 2, 3, 7, 6, 5, 4}), taken);
+    EXPECT_FALSE(queue.Next(1, &morsel));
+  }
+
+  // workers racing for the morsels claim each of them once
+  const size_t num_morsels = 100000;
+  const size_t num_workers = 8;
+  MorselQueue queue(num_morsels, num_workers);
+  std::vector<std::atomic<int>> claims(num_morsels);
+  WorkerPool pool;
+  pool.Run(num_workers, [&](size_t worker) {
+    size_t morsel;
+    // the even workers are slower, and have their morsels stolen
+    while (queue.Next(worker, &morsel)) {
+      claims[morsel]++;
+      if (worker % 2 == 0) {
+        std::this_thread::yield();
+      }
+    }
+  });
+  for (auto &claim : claims) {
+    ASSERT_EQ(1, claim);
+  }
+}
+
+}  // namespace bustub
@@ -2,10 +2,14 @@
  * lock_manager_test.cpp
  */
 
+#include <atomic>
+#include <chrono>  // NOLINT
 #include <random>
 #include <thread>  // NOLINT
+#include <vector>
 
 #include "common/config.h"
+#include "common/contention.h"
 #include "concurrency/lock_manager.h"
 #include "concurrency/transaction_manager.h"
 #include "gtest/gtest.h"
@@ -77,7 +81,7 @@ void BasicTest1() {
     delete txns[i];
   }
 }
-TEST(LockManagerTest, DISABLED_BasicTest) { BasicTest1(); }
+TEST(LockManagerTest, BasicTest) { BasicTest1(); }
 
 void TwoPLTest() {
   LockManager lock_mgr{};
@@ -123,7 +127,7 @@ void TwoPLTest() {
 
   delete txn;
 }
-TEST(LockManagerTest, DISABLED_TwoPLTest) { TwoPLTest(); }
+TEST(LockManagerTest, TwoPLTest) { TwoPLTest(); }
 
 void UpgradeTest() {
   LockManager lock_mgr{};
@@ -150,9 +154,9 @@ void UpgradeTest() {
   txn_mgr.Commit(&txn);
   CheckCommitted(&txn);
 }
-TEST(LockManagerTest, DISABLED_UpgradeLockTest) { UpgradeTest(); }
+TEST(LockManagerTest, UpgradeLockTest) { UpgradeTest(); }
 
-TEST(LockManagerTest, DISABLED_GraphEdgeTest) {
+TEST(LockManagerTest, GraphEdgeTest) {
   LockManager lock_mgr{};
   TransactionManager txn_mgr{&lock_mgr};
   const int num_nodes = 100;
@@ -194,7 +198,7 @@ TEST(LockManagerTest, DISABLED_GraphEdgeTest) {
   }
 }
 
-TEST(LockManagerTest, DISABLED_BasicCycleTest) {
+TEST(LockManagerTest, BasicCycleTest) {
   LockManager lock_mgr{}; /* Use Deadlock detection */
   TransactionManager txn_mgr{&lock_mgr};
 
@@ -211,7 +215,7 @@ TEST(LockManagerTest, DISABLED_BasicCycleTest) {
   EXPECT_EQ(false, lock_mgr.HasCycle(&txn));
 }
 
-TEST(LockManagerTest, DISABLED_BasicDeadlockDetectionTest) {
+TEST(LockManagerTest, BasicDeadlockDetectionTest) {
   LockManager lock_mgr{};
   cycle_detection_interval = std::chrono::milliseconds(500);
   TransactionManager txn_mgr{&lock_mgr};
@@ -267,4 +271,329 @@ TEST(LockManagerTest, DISABLED_BasicDeadlockDetectionTest) {
   delete txn0;
   delete txn1;
 }
+// Exclusive locks on the records of many shards, taken in order by many threads, let each of them in alone
+TEST(LockManagerTest, ExclusiveContentionTest) {
+  LockManager lock_mgr{};
+  TransactionManager txn_mgr{&lock_mgr};
+  const int num_threads = 8;
+  const int num_txns = 100;
+  const int num_rids = 16;
+  std::vector<RID> rids;
+  for (int i = 0; i < num_rids; i++) {
+    rids.emplace_back(i % 4, i);
+  }
+  // written by the holders of the exclusive lock of their record only
+  std::vector<int> counters(num_rids, 0);
+
+  auto task = [&](int seed) {
+    std::mt19937 random(seed);
+    for (int i = 0; i < num_txns; i++) {
+      Transaction *txn = txn_mgr.Begin();
+      // the records are locked in ascending order, so the transactions never deadlock
+      int first = static_cast<int>(random() % num_rids);
+      for (int j = first; j < num_rids; j += 1 + static_cast<int>(random() % 3)) {
+        EXPECT_TRUE(lock_mgr.LockExclusive(txn, rids[j]));
+        counters[j]++;
+      }
+      CheckGrowing(txn);
+      txn_mgr.Commit(txn);
+      CheckTxnLockSize(txn, 0, 0);
+      delete txn;
+    }
+  };
+  std::vector<std::thread> threads;
+  for (int i = 0; i < num_threads; i++) {
+    threads.emplace_back(task, i);
+  }
+  std::vector<int> expected(num_rids, 0);
+  for (int i = 0; i < num_threads; i++) {
+    threads[i].join();
+    // the same choices again, without the locks
+    std::mt19937 random(i);
+    for (int t = 0; t < num_txns; t++) {
+      for (int j = static_cast<int>(random() % num_rids); j < num_rids; j += 1 + static_cast<int>(random() % 3)) {
+        expected[j]++;
+      }
+    }
+  }
+  EXPECT_EQ(expected, counters);
+}
+
+// Two transactions that each lock the record the other one holds, which the policy resolves at request time
+TEST(LockManagerTest, DeadlockPreventionTest) {
+  for (DeadlockPolicy policy : {DeadlockPolicy::WOUND_WAIT, DeadlockPolicy::WAIT_DIE}) {
+    LockManager lock_mgr{policy};
+    TransactionManager txn_mgr{&lock_mgr};
+    RID rid0{0, 0};
+    RID rid1{1, 1};
+    auto *txn0 = txn_mgr.Begin();
+    auto *txn1 = txn_mgr.Begin();
+    EXPECT_TRUE(lock_mgr.LockExclusive(txn0, rid0));
+    EXPECT_TRUE(lock_mgr.LockExclusive(txn1, rid1));
+
+    // the older transaction waits for the younger one, which wound-wait wounds
+    std::thread t0([&] {
+      EXPECT_TRUE(lock_mgr.LockExclusive(txn0, rid1));
+      CheckGrowing(txn0);
+      txn_mgr.Commit(txn0);
+    });
+
+    // the younger transaction dies as it asks for the lock of the older one, or is, or was, wounded
+    try {
+      EXPECT_FALSE(lock_mgr.LockExclusive(txn1, rid0));
+    } catch (TransactionAbortException &e) {
+      EXPECT_EQ(AbortReason::DEADLOCK, e.GetAbortReason());
+    }
+    CheckAborted(txn1);
+    txn_mgr.Abort(txn1);
+    t0.join();
+    CheckCommitted(txn0);
+    CheckTxnLockSize(txn0, 0, 0);
+    CheckTxnLockSize(txn1, 0, 0);
+    delete txn0;
+    delete txn1;
+  }
+}
+
+// A cycle of three transactions, of which the one that did the least work is aborted, rather than the newest one
+TEST(LockManagerTest, DeadlockVictimTest) {
+  LockManager lock_mgr{};
+  TransactionManager txn_mgr{&lock_mgr};
+  std::vector<RID> rids;
+  for (int i = 0; i < 5; i++) {
+    rids.emplace_back(i, i);
+  }
+  std::vector<Transaction *> txns{txn_mgr.Begin(), txn_mgr.Begin(), txn_mgr.Begin()};
+  // txn 0 holds rids[0], txn 1 holds rids[1] and rids[3], txn 2 holds rids[2] and rids[4]
+  EXPECT_TRUE(lock_mgr.LockExclusive(txns[0], rids[0]));
+  EXPECT_TRUE(lock_mgr.LockExclusive(txns[1], rids[1]));
+  EXPECT_TRUE(lock_mgr.LockExclusive(txns[1], rids[3]));
+  EXPECT_TRUE(lock_mgr.LockExclusive(txns[2], rids[2]));
+  EXPECT_TRUE(lock_mgr.LockExclusive(txns[2], rids[4]));
+
+  // and each waits for the next one
+  std::vector<std::thread> threads;
+  for (int i = 0; i < 3; i++) {
+    threads.emplace_back([&, i] {
+      try {
+        EXPECT_TRUE(lock_mgr.LockExclusive(txns[i], rids[(i + 1) % 3]));
+        txn_mgr.Commit(txns[i]);
+      } catch (TransactionAbortException &e) {
+        EXPECT_EQ(AbortReason::DEADLOCK, e.GetAbortReason());
+        txn_mgr.Abort(txns[i]);
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  CheckAborted(txns[0]);
+  CheckCommitted(txns[1]);
+  CheckCommitted(txns[2]);
+  for (Transaction *txn : txns) {
+    CheckTxnLockSize(txn, 0, 0);
+    delete txn;
+  }
+}
+
+// Table locks in the intention modes, which records of the table take implicitly, or do not need under a table lock
+TEST(LockManagerTest, TableLockTest) {
+  EXPECT_TRUE(LockManager::AreCompatible(LockMode::INTENTION_SHARED, LockMode::SHARED_INTENTION_EXCLUSIVE));
+  EXPECT_TRUE(LockManager::AreCompatible(LockMode::INTENTION_EXCLUSIVE, LockMode::INTENTION_EXCLUSIVE));
+  EXPECT_FALSE(LockManager::AreCompatible(LockMode::INTENTION_EXCLUSIVE, LockMode::SHARED));
+  EXPECT_FALSE(LockManager::AreCompatible(LockMode::SHARED_INTENTION_EXCLUSIVE, LockMode::SHARED));
+  EXPECT_FALSE(LockManager::AreCompatible(LockMode::INTENTION_SHARED, LockMode::EXCLUSIVE));
+
+  LockManager lock_mgr{};
+  TransactionManager txn_mgr{&lock_mgr};
+  const table_oid_t oid = 0;
+  RID rid0{0, 0};
+  RID rid1{0, 1};
+  auto *txn0 = txn_mgr.Begin();
+  auto *txn1 = txn_mgr.Begin();
+  auto *txn2 = txn_mgr.Begin();
+
+  // two writers of different records of the table hold it in INTENTION_EXCLUSIVE mode together
+  EXPECT_TRUE(lock_mgr.LockTable(txn0, oid, LockMode::INTENTION_EXCLUSIVE));
+  EXPECT_TRUE(lock_mgr.LockTable(txn1, oid, LockMode::INTENTION_SHARED));
+  EXPECT_TRUE(lock_mgr.LockExclusive(txn0, rid0, oid));
+  EXPECT_TRUE(lock_mgr.LockExclusive(txn1, rid1, oid));
+  EXPECT_EQ(LockMode::INTENTION_EXCLUSIVE, txn1->GetTableLockSet()->at(oid));
+  CheckTxnLockSize(txn1, 0, 1);
+
+  // a scan of the whole table waits for the writers, and then locks none of the records it reads
+  std::atomic<bool> granted{false};
+  std::thread scan([&] {
+    EXPECT_TRUE(lock_mgr.LockTable(txn2, oid, LockMode::SHARED));
+    granted = true;
+    EXPECT_TRUE(lock_mgr.LockShared(txn2, rid0, oid));
+    EXPECT_TRUE(lock_mgr.LockShared(txn2, rid1, oid));
+    CheckTxnLockSize(txn2, 0, 0);
+  });
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  EXPECT_FALSE(granted);
+  txn_mgr.Commit(txn0);
+  txn_mgr.Commit(txn1);
+  scan.join();
+  EXPECT_TRUE(granted);
+  CheckTxnLockSize(txn0, 0, 0);
+  EXPECT_TRUE(txn0->GetTableLockSet()->empty());
+
+  // a record the scan writes upgrades its table lock to SHARED_INTENTION_EXCLUSIVE, which lets readers of single
+  // records in, but not another scan
+  EXPECT_TRUE(lock_mgr.LockExclusive(txn2, rid0, oid));
+  EXPECT_EQ(LockMode::SHARED_INTENTION_EXCLUSIVE, txn2->GetTableLockSet()->at(oid));
+  CheckTxnLockSize(txn2, 0, 1);
+  auto *txn3 = txn_mgr.Begin();
+  EXPECT_TRUE(lock_mgr.LockShared(txn3, rid1, oid));
+  EXPECT_EQ(LockMode::INTENTION_SHARED, txn3->GetTableLockSet()->at(oid));
+  CheckTxnLockSize(txn3, 1, 0);
+  txn_mgr.Commit(txn3);
+  CheckGrowing(txn2);
+  txn_mgr.Commit(txn2);
+  CheckTxnLockSize(txn2, 0, 0);
+  EXPECT_TRUE(txn2->GetTableLockSet()->empty());
+
+  // letting go of an intention lock keeps a transaction growing, of a shared one ends its growing phase
+  auto *txn4 = txn_mgr.Begin();
+  EXPECT_TRUE(lock_mgr.LockTable(txn4, oid, LockMode::INTENTION_SHARED));
+  EXPECT_TRUE(lock_mgr.UnlockTable(txn4, oid));
+  CheckGrowing(txn4);
+  EXPECT_TRUE(lock_mgr.LockTable(txn4, oid, LockMode::SHARED));
+  EXPECT_TRUE(lock_mgr.UnlockTable(txn4, oid));
+  CheckShrinking(txn4);
+  EXPECT_FALSE(lock_mgr.UnlockTable(txn4, oid));
+  txn_mgr.Commit(txn4);
+
+  for (Transaction *txn : {txn0, txn1, txn2, txn3, txn4}) {
+    delete txn;
+  }
+}
+
+// Record locks of a table that are traded for a lock of the table once there are enough of them
+TEST(LockManagerTest, LockEscalationTest) {
+  LockManager lock_mgr{};
+  lock_mgr.SetEscalationThreshold(4);
+  TransactionManager txn_mgr{&lock_mgr};
+  auto *txn0 = txn_mgr.Begin();
+  auto *txn1 = txn_mgr.Begin();
+
+  // a reader of a table escalates to a shared lock, under which it locks no records any more
+  const table_oid_t read_oid = 0;
+  for (uint32_t i = 0; i < 3; i++) {
+    EXPECT_TRUE(lock_mgr.LockShared(txn0, RID{0, i}, read_oid));
+  }
+  CheckTxnLockSize(txn0, 3, 0);
+  EXPECT_TRUE(lock_mgr.LockShared(txn0, RID{0, 3}, read_oid));
+  CheckTxnLockSize(txn0, 0, 0);
+  EXPECT_EQ(LockMode::SHARED, txn0->GetTableLockSet()->at(read_oid));
+  EXPECT_TRUE(lock_mgr.LockShared(txn0, RID{0, 4}, read_oid));
+  CheckTxnLockSize(txn0, 0, 0);
+  CheckGrowing(txn0);
+
+  // a writer keeps its record locks while another transaction writes the table too, and escalates once it is done
+  const table_oid_t write_oid = 1;
+  EXPECT_TRUE(lock_mgr.LockExclusive(txn1, RID{1, 0}, write_oid));
+  for (uint32_t i = 1; i <= 4; i++) {
+    EXPECT_TRUE(lock_mgr.LockExclusive(txn0, RID{1, i}, write_oid));
+  }
+  CheckTxnLockSize(txn0, 0, 4);
+  EXPECT_EQ(LockMode::INTENTION_EXCLUSIVE, txn0->GetTableLockSet()->at(write_oid));
+  txn_mgr.Commit(txn1);
+  for (uint32_t i = 5; i <= 8; i++) {
+    EXPECT_TRUE(lock_mgr.LockExclusive(txn0, RID{1, i}, write_oid));
+  }
+  CheckTxnLockSize(txn0, 0, 0);
+  EXPECT_EQ(LockMode::EXCLUSIVE, txn0->GetTableLockSet()->at(write_oid));
+  EXPECT_TRUE(txn0->GetTableRowLockSet()->empty());
+  CheckGrowing(txn0);
+  txn_mgr.Commit(txn0);
+  EXPECT_TRUE(txn0->GetTableLockSet()->empty());
+  delete txn0;
+  delete txn1;
+}
+
+// The lock of an inserted tuple, which is only taken if nobody holds or waits for its slot
+TEST(LockManagerTest, NewTupleLockTest) {
+  LockManager lock_mgr{};
+  TransactionManager txn_mgr{&lock_mgr};
+  const table_oid_t oid = 0;
+  RID rid0{0, 0};
+  RID rid1{0, 1};
+  auto *txn0 = txn_mgr.Begin();
+  auto *txn1 = txn_mgr.Begin();
+
+  // the slot of a deleted tuple that another transaction still holds is passed over
+  EXPECT_TRUE(lock_mgr.LockShared(txn0, rid0, oid));
+  EXPECT_TRUE(lock_mgr.LockTable(txn1, oid, LockMode::INTENTION_EXCLUSIVE));
+  EXPECT_FALSE(lock_mgr.LockNewTuple(txn1, rid0, oid));
+  CheckTxnLockSize(txn1, 0, 0);
+  EXPECT_TRUE(lock_mgr.LockNewTuple(txn1, rid1, oid));
+  CheckTxnLockSize(txn1, 0, 1);
+  EXPECT_EQ(1, txn1->GetTableRowLockSet()->at(oid).size());
+  CheckGrowing(txn1);
+
+  // a transaction aborted meanwhile still locks the tuple, which its rollback deletes
+  auto *txn2 = txn_mgr.Begin();
+  EXPECT_TRUE(lock_mgr.LockTable(txn2, oid, LockMode::INTENTION_EXCLUSIVE));
+  txn2->SetState(TransactionState::ABORTED);
+  EXPECT_TRUE(lock_mgr.LockNewTuple(txn2, RID{0, 2}, oid));
+  CheckTxnLockSize(txn2, 0, 1);
+  txn_mgr.Abort(txn2);
+  CheckTxnLockSize(txn2, 0, 0);
+
+  txn_mgr.Commit(txn0);
+  txn_mgr.Commit(txn1);
+  CheckTxnLockSize(txn1, 0, 0);
+  for (Transaction *txn : {txn0, txn1, txn2}) {
+    delete txn;
+  }
+}
+
+// NOLINTNEXTLINE
+TEST(LockManagerTest, HotRidTest) {
+  LockManager lock_mgr{};
+  TransactionManager txn_mgr{&lock_mgr};
+  RID hot{3, 3};
+  RID cold{4, 4};
+  ContentionStats before = ContentionProfiler::Site("lock.row")->GetStats();
+  auto *txn0 = txn_mgr.Begin();
+  EXPECT_TRUE(lock_mgr.LockExclusive(txn0, hot));
+  EXPECT_TRUE(lock_mgr.LockExclusive(txn0, cold));
+
+  // two transactions wait for the hot record and one for the cold one, till txn0 lets go of them
+  std::vector<Transaction *> waiters;
+  std::vector<std::thread> threads;
+  for (const RID &rid : {hot, hot, cold}) {
+    Transaction *txn = txn_mgr.Begin();
+    waiters.push_back(txn);
+    threads.emplace_back([&, txn, rid] { EXPECT_TRUE(lock_mgr.LockShared(txn, rid)); });
+  }
+  while (lock_mgr.GetEdgeList().size() < 3) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  txn_mgr.Commit(txn0);
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  std::vector<RowContention> rows = lock_mgr.GetHotRids(10);
+  ASSERT_EQ(2, rows.size());
+  EXPECT_EQ(hot, rows[0].rid_);
+  EXPECT_EQ(2, rows[0].waits_);
+  EXPECT_LE(2 * 10000000, rows[0].wait_ns_);
+  EXPECT_EQ(cold, rows[1].rid_);
+  EXPECT_EQ(1, rows[1].waits_);
+  EXPECT_EQ(1, lock_mgr.GetHotRids(1).size());
+  ContentionStats after = ContentionProfiler::Site("lock.row")->GetStats();
+  EXPECT_EQ(before.waits_ + 3, after.waits_);
+
+  for (Transaction *txn : waiters) {
+    txn_mgr.Commit(txn);
+    delete txn;
+  }
+  delete txn0;
+}
+
 }  // namespace bustub
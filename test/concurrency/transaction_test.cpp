@@ -3,14 +3,16 @@
  */
 
 #include <atomic>
+#include <chrono>  // NOLINT
 #include <cstdio>
 #include <memory>
 #include <random>
 #include <string>
+#include <thread>  // NOLINT
 #include <utility>
 #include <vector>
 
-#include "buffer/buffer_pool_manager.h"
+#include "buffer/buffer_pool_manager_instance.h"
 #include "catalog/table_generator.h"
 #include "concurrency/transaction.h"
 #include "concurrency/transaction_manager.h"
@@ -47,7 +49,7 @@ class TransactionTest : public ::testing::Test {
     ::testing::Test::SetUp();
     // For each test, we create a new DiskManager, BufferPoolManager, TransactionManager, and Catalog.
     disk_manager_ = std::make_unique<DiskManager>("executor_test.db");
-    bpm_ = std::make_unique<BufferPoolManager>(2560, disk_manager_.get());
+    bpm_ = std::make_unique<BufferPoolManagerInstance>(2560, disk_manager_.get());
     page_id_t page_id;
     bpm_->NewPage(&page_id);
     lock_manager_ = std::make_unique<LockManager>();
@@ -251,4 +253,79 @@ TEST_F(TransactionTest, DISABLED_DirtyReadsTest) {
   delete key_schema;
 }
 
+// NOLINTNEXTLINE
+TEST(TransactionRegistryTest, ConcurrentTest) {
+  LockManager lock_manager;
+  TransactionManager txn_mgr(&lock_manager);
+  const size_t running = TransactionManager::txn_registry.Size();
+
+  // the transactions are found while they run, from any thread, and are gone from the registry once they end
+  std::atomic<bool> found{true};
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 4; t++) {
+    threads.emplace_back([&txn_mgr, &found, t] {
+      for (int i = 0; i < 200; i++) {
+        Transaction *txn = txn_mgr.Begin();
+        if (TransactionManager::GetTransaction(txn->GetTransactionId()) != txn) {
+          found = false;
+        }
+        txn_id_t txn_id = txn->GetTransactionId();
+        if ((i + t) % 2 == 0) {
+          txn_mgr.Commit(txn);
+        } else {
+          txn_mgr.Abort(txn);
+        }
+        if (TransactionManager::GetTransaction(txn_id) != nullptr) {
+          found = false;
+        }
+        delete txn;
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  EXPECT_TRUE(found);
+  EXPECT_EQ(running, TransactionManager::txn_registry.Size());
+}
+
+// NOLINTNEXTLINE
+TEST(TransactionPoolTest, ReuseTest) {
+  LockManager lock_manager;
+  TransactionManager txn_mgr(&lock_manager);
+  RID rid{0, 0};
+
+  Transaction *txn = txn_mgr.Begin();
+  txn_id_t txn_id = txn->GetTransactionId();
+  EXPECT_TRUE(lock_manager.LockExclusive(txn, rid));
+  txn->AddIntoDeletedPageSet(1);
+  txn_mgr.Commit(txn);
+  EXPECT_TRUE(txn->GetExclusiveLockSet()->empty());
+  txn_mgr.Release(txn);
+
+  // a released transaction is begun again as a new one, with nothing left of the one before
+  Transaction *reused = txn_mgr.Begin(nullptr, IsolationLevel::READ_COMMITTED);
+  EXPECT_EQ(txn, reused);
+  EXPECT_NE(txn_id, reused->GetTransactionId());
+  EXPECT_EQ(TransactionState::GROWING, reused->GetState());
+  EXPECT_EQ(IsolationLevel::READ_COMMITTED, reused->GetIsolationLevel());
+  EXPECT_EQ(INVALID_TS, reused->GetCommitTs());
+  EXPECT_TRUE(reused->GetDeletedPageSet()->empty());
+  EXPECT_EQ(reused, TransactionManager::GetTransaction(reused->GetTransactionId()));
+  EXPECT_EQ(nullptr, TransactionManager::GetTransaction(txn_id));
+
+  // the lock the transaction held before was let go of, and its request queue is reused for the new one
+  Transaction *other = txn_mgr.Begin();
+  EXPECT_TRUE(lock_manager.LockShared(reused, rid));
+  std::thread blocked([&lock_manager, other, &rid] { EXPECT_TRUE(lock_manager.LockExclusive(other, rid)); });
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  EXPECT_FALSE(other->IsExclusiveLocked(rid));
+  txn_mgr.Abort(reused);
+  blocked.join();
+  EXPECT_TRUE(other->IsExclusiveLocked(rid));
+  txn_mgr.Commit(other);
+  txn_mgr.Release(reused);
+  txn_mgr.Release(other);
+}
+
 }  // namespace bustub
@@ -0,0 +1,235 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// adaptive_radix_tree_test.cpp
+//
+// Identification: test/container/adaptive_radix_tree_test.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <cstdio>
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "buffer/buffer_pool_manager_instance.h"
+#include "catalog/schema.h"
+#include "concurrency/transaction.h"
+#include "container/art/adaptive_radix_tree.h"
+#include "gtest/gtest.h"
+#include "storage/index/art_index.h"
+#include "storage/index/generic_key.h"
+#include "storage/table/table_heap.h"
+
+namespace bustub {
+
+// a big-endian key of size bytes, so that keys order like the integers they are made of
+static std::string MakeKey(uint64_t key, size_t size = 8) {
+  std::string bytes(size, '\0');
+  for (size_t i = 0; i < 8 && i < size; i++) {
+    bytes[size - 1 - i] = static_cast<char>(key >> (8 * i));
+  }
+  return bytes;
+}
+
+// NOLINTNEXTLINE
+TEST(AdaptiveRadixTreeTest, SampleTest) {
+  AdaptiveRadixTree<int> tree(8);
+
+  // insert a few values
+  for (int i = 0; i < 5; i++) {
+    EXPECT_TRUE(tree.Insert(MakeKey(i), i));
+    int value;
+    ASSERT_TRUE(tree.GetValue(MakeKey(i), &value)) << "Failed to insert " << i;
+    EXPECT_EQ(i, value);
+  }
+  EXPECT_EQ(5, tree.Size());
+
+  // duplicate keys and keys of another size are rejected
+  for (int i = 0; i < 5; i++) {
+    EXPECT_FALSE(tree.Insert(MakeKey(i), 2 * i));
+    EXPECT_FALSE(tree.Insert(MakeKey(i, 4), i));
+  }
+
+  // delete some values
+  for (int i = 0; i < 5; i += 2) {
+    EXPECT_TRUE(tree.Remove(MakeKey(i)));
+    EXPECT_FALSE(tree.Remove(MakeKey(i)));
+  }
+  for (int i = 0; i < 5; i++) {
+    int value;
+    EXPECT_EQ(i % 2 == 1, tree.GetValue(MakeKey(i), &value));
+  }
+  EXPECT_EQ(2, tree.Size());
+
+  // look for a key that does not exist
+  int value;
+  EXPECT_FALSE(tree.GetValue(MakeKey(20), &value));
+}
+
+// NOLINTNEXTLINE
+TEST(AdaptiveRadixTreeTest, GrowShrinkTest) {
+  // keys that agree in their first 16 bytes, more than a node stores of its prefix
+  const size_t key_size = 24;
+  AdaptiveRadixTree<int> tree(key_size);
+  auto key = [](int i) { return std::string(16, 'x') + MakeKey(i); };
+
+  // enough keys for every node type, on several levels
+  const int num_keys = 70000;
+  for (int i = 0; i < num_keys; i++) {
+    ASSERT_TRUE(tree.Insert(key(i), i)) << "Failed to insert " << i;
+  }
+  for (int i = 0; i < num_keys; i++) {
+    int value;
+    ASSERT_TRUE(tree.GetValue(key(i), &value)) << "Failed to keep " << i;
+    EXPECT_EQ(i, value);
+  }
+
+  // a key that leaves the shared prefix splits it up
+  std::string other(key_size, 'x');
+  other[12] = 'y';
+  EXPECT_TRUE(tree.Insert(other, -1));
+  int value;
+  EXPECT_TRUE(tree.GetValue(other, &value));
+  EXPECT_EQ(-1, value);
+
+  // prefix scans come back in key order
+  std::vector<int> result;
+  EXPECT_TRUE(tree.ScanPrefix(key(0x100).substr(0, key_size - 1), &result));
+  ASSERT_EQ(256, result.size());
+  for (int i = 0; i < 256; i++) {
+    EXPECT_EQ(0x100 + i, result[i]);
+  }
+  result.clear();
+  EXPECT_TRUE(tree.ScanPrefix(std::string(16, 'x'), &result));
+  ASSERT_EQ(num_keys, result.size());
+  for (int i = 0; i < num_keys; i++) {
+    EXPECT_EQ(i, result[i]);
+  }
+
+  // removing shrinks the nodes again and collapses them into their parents
+  EXPECT_TRUE(tree.Remove(other));
+  for (int i = 0; i < num_keys; i++) {
+    if (i % 7 != 0) {
+      ASSERT_TRUE(tree.Remove(key(i))) << "Failed to remove " << i;
+    }
+  }
+  EXPECT_EQ((num_keys + 6) / 7, tree.Size());
+  for (int i = 0; i < num_keys; i++) {
+    EXPECT_EQ(i % 7 == 0, tree.GetValue(key(i), &value)) << i;
+  }
+  result.clear();
+  tree.ScanPrefix("", &result);
+  ASSERT_EQ(tree.Size(), result.size());
+  for (size_t i = 0; i < result.size(); i++) {
+    EXPECT_EQ(7 * static_cast<int>(i), result[i]);
+  }
+}
+
+// NOLINTNEXTLINE
+TEST(AdaptiveRadixTreeTest, ConcurrentMixTest) {
+  AdaptiveRadixTree<int> tree(8);
+
+  // every thread inserts and removes keys of its own, while the others read them
+  const int num_threads = 4;
+  const int keys_per_thread = 20000;
+  std::vector<std::thread> threads;
+  for (int t = 0; t < num_threads; t++) {
+    threads.emplace_back([&tree, t] {
+      for (int i = t; i < num_threads * keys_per_thread; i += num_threads) {
+        EXPECT_TRUE(tree.Insert(MakeKey(i), i));
+      }
+      for (int i = t; i < num_threads * keys_per_thread; i += 2 * num_threads) {
+        EXPECT_TRUE(tree.Remove(MakeKey(i)));
+      }
+    });
+    threads.emplace_back([&tree] {
+      for (int i = 0; i < num_threads * keys_per_thread; i++) {
+        int value;
+        if (tree.GetValue(MakeKey(i), &value)) {
+          EXPECT_EQ(i, value);
+        }
+      }
+      std::vector<int> result;
+      tree.ScanPrefix(MakeKey(0, 6), &result);
+      for (size_t i = 1; i < result.size(); i++) {
+        EXPECT_LT(result[i - 1], result[i]);
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  for (int i = 0; i < num_threads * keys_per_thread; i++) {
+    int value;
+    EXPECT_EQ(i % (2 * num_threads) >= num_threads, tree.GetValue(MakeKey(i), &value)) << i;
+  }
+}
+
+// NOLINTNEXTLINE
+TEST(AdaptiveRadixTreeTest, IndexTest) {
+  auto *disk_manager = new DiskManager("art_test.db");
+  auto *bpm = new BufferPoolManagerInstance(50, disk_manager);
+  Schema schema({Column("a", TypeId::BIGINT), Column("b", TypeId::INTEGER)});
+  auto *transaction = new Transaction(0);
+  auto *table = new TableHeap(bpm, nullptr, nullptr, transaction);
+
+  // few distinct values of column b with many tuples each
+  const int64_t num_tuples = 1000;
+  const int32_t num_keys = 10;
+  for (int64_t i = 0; i < num_tuples; i++) {
+    RID rid;
+    ASSERT_TRUE(table->InsertTuple(
+        Tuple({Value(TypeId::BIGINT, i), Value(TypeId::INTEGER, static_cast<int32_t>(i % num_keys))}, &schema), &rid,
+        transaction));
+  }
+
+  // the index is built from the table, as after a restart
+  ARTIndex<GenericKey<8>, RID, GenericComparator<8>> index(new IndexMetadata("b_idx", "t", &schema, {1}, false));
+  index.BuildFromTableHeap(table, schema, transaction);
+  Schema *key_schema = index.GetKeySchema();
+  auto key_tuple = [key_schema](int32_t key) { return Tuple({Value(TypeId::INTEGER, key)}, key_schema); };
+  std::vector<RID> rids;
+  for (int32_t key = 0; key < num_keys; key++) {
+    rids.clear();
+    index.ScanKey(key_tuple(key), &rids, nullptr);
+    ASSERT_EQ(num_tuples / num_keys, rids.size());
+    for (const RID &rid : rids) {
+      Tuple tuple;
+      ASSERT_TRUE(table->GetTuple(rid, &tuple, transaction));
+      EXPECT_EQ(key, tuple.GetValue(&schema, 1).GetAs<int32_t>());
+    }
+  }
+
+  // removing an entry leaves the other entries of its key alone
+  rids.clear();
+  index.ScanKey(key_tuple(3), &rids, nullptr);
+  index.DeleteEntry(key_tuple(3), rids[0], nullptr);
+  std::vector<RID> rest;
+  index.ScanKey(key_tuple(3), &rest, nullptr);
+  EXPECT_EQ(std::vector<RID>(rids.begin() + 1, rids.end()), rest);
+
+  // a unique index finds a single entry per key
+  ARTIndex<GenericKey<16>, RID, GenericComparator<16>> unique_index(
+      new IndexMetadata("a_idx", "t", &schema, {0}, true));
+  unique_index.BuildFromTableHeap(table, schema, transaction);
+  Tuple key({Value(TypeId::BIGINT, int64_t{42})}, unique_index.GetKeySchema());
+  rids.clear();
+  unique_index.ScanKey(key, &rids, nullptr);
+  ASSERT_EQ(1, rids.size());
+  Tuple tuple;
+  ASSERT_TRUE(table->GetTuple(rids[0], &tuple, transaction));
+  EXPECT_EQ(42, tuple.GetValue(&schema, 0).GetAs<int64_t>());
+
+  delete table;
+  delete transaction;
+  delete bpm;
+  delete disk_manager;
+  remove("art_test.db");
+}
+
+}  // namespace bustub
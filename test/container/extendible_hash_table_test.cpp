@@ -0,0 +1,225 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// extendible_hash_table_test.cpp
+//
+// Identification: test/container/extendible_hash_table_test.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "buffer/buffer_pool_manager_instance.h"
+#include "common/logger.h"
+#include "container/hash/extendible_hash_table.h"
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+// NOLINTNEXTLINE
+TEST(ExtendibleHashTableTest, SampleTest) {
+  auto *disk_manager = new DiskManager("extendible_test.db");
+  auto *bpm = new BufferPoolManagerInstance(50, disk_manager);
+
+  ExtendibleHashTable<int, int, IntComparator> ht("blah", bpm, IntComparator(), HashFunction<int>());
+
+  // insert a few values
+  for (int i = 0; i < 5; i++) {
+    EXPECT_TRUE(ht.Insert(nullptr, i, i));
+    std::vector<int> res;
+    ht.GetValue(nullptr, i, &res);
+    EXPECT_EQ(1, res.size()) << "Failed to insert " << i << std::endl;
+    EXPECT_EQ(i, res[0]);
+  }
+
+  // duplicate pairs are rejected, other values for the same key are not
+  for (int i = 0; i < 5; i++) {
+    EXPECT_FALSE(ht.Insert(nullptr, i, i));
+    EXPECT_TRUE(ht.Insert(nullptr, i, 2 * i + 1));
+    std::vector<int> res;
+    ht.GetValue(nullptr, i, &res);
+    EXPECT_EQ(2, res.size()) << "Failed to insert " << i << std::endl;
+  }
+
+  // delete some values
+  for (int i = 0; i < 5; i++) {
+    EXPECT_TRUE(ht.Remove(nullptr, i, i));
+    EXPECT_FALSE(ht.Remove(nullptr, i, i));
+    std::vector<int> res;
+    ht.GetValue(nullptr, i, &res);
+    ASSERT_EQ(1, res.size());
+    EXPECT_EQ(2 * i + 1, res[0]);
+  }
+
+  // look for a key that does not exist
+  std::vector<int> res;
+  EXPECT_FALSE(ht.GetValue(nullptr, 20, &res));
+  EXPECT_EQ(0, res.size());
+  ht.VerifyIntegrity();
+
+  delete bpm;
+  delete disk_manager;
+  remove("extendible_test.db");
+}
+
+// NOLINTNEXTLINE
+TEST(ExtendibleHashTableTest, SplitMergeTest) {
+  auto *disk_manager = new DiskManager("extendible_test.db");
+  auto *bpm = new BufferPoolManagerInstance(50, disk_manager);
+
+  ExtendibleHashTable<int, int, IntComparator> ht("blah", bpm, IntComparator(), HashFunction<int>());
+  EXPECT_EQ(0U, ht.GetGlobalDepth());
+
+  // enough pairs for several buckets, so the directory doubles
+  const int num_keys = 5000;
+  for (int i = 0; i < num_keys; i++) {
+    ASSERT_TRUE(ht.Insert(nullptr, i, i)) << "Failed to insert " << i;
+  }
+  EXPECT_GT(ht.GetGlobalDepth(), 0U);
+  ht.VerifyIntegrity();
+  for (int i = 0; i < num_keys; i++) {
+    std::vector<int> res;
+    ht.GetValue(nullptr, i, &res);
+    ASSERT_EQ(1, res.size()) << "Failed to keep " << i;
+    EXPECT_EQ(i, res[0]);
+  }
+
+  // emptying the table merges the buckets back into one and shrinks the directory to nothing
+  for (int i = 0; i < num_keys; i++) {
+    ASSERT_TRUE(ht.Remove(nullptr, i, i)) << "Failed to remove " << i;
+  }
+  ht.VerifyIntegrity();
+  for (int i = 0; i < num_keys; i++) {
+    std::vector<int> res;
+    EXPECT_FALSE(ht.GetValue(nullptr, i, &res));
+  }
+  EXPECT_EQ(0U, ht.GetGlobalDepth());
+
+  delete bpm;
+  delete disk_manager;
+  remove("extendible_test.db");
+}
+
+// NOLINTNEXTLINE
+TEST(ExtendibleHashTableTest, ConcurrentInsertTest) {
+  auto *disk_manager = new DiskManager("extendible_test.db");
+  auto *bpm = new BufferPoolManagerInstance(50, disk_manager);
+
+  ExtendibleHashTable<int, int, IntComparator> ht("blah", bpm, IntComparator(), HashFunction<int>());
+
+  const int num_threads = 4;
+  const int keys_per_thread = 1000;
+  std::vector<std::thread> threads;
+  for (int t = 0; t < num_threads; t++) {
+    threads.emplace_back([&ht, t] {
+      for (int i = t * keys_per_thread; i < (t + 1) * keys_per_thread; i++) {
+        EXPECT_TRUE(ht.Insert(nullptr, i, i));
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  ht.VerifyIntegrity();
+  for (int i = 0; i < num_threads * keys_per_thread; i++) {
+    std::vector<int> res;
+    ht.GetValue(nullptr, i, &res);
+    ASSERT_EQ(1, res.size()) << "Failed to keep " << i;
+  }
+
+  delete bpm;
+  delete disk_manager;
+  remove("extendible_test.db");
+}
+
+// NOLINTNEXTLINE
+TEST(ExtendibleHashTableTest, OptimisticLookupTest) {
+  auto *disk_manager = new DiskManager("extendible_test.db");
+  auto *bpm = new BufferPoolManagerInstance(50, disk_manager);
+
+  ExtendibleHashTable<int, int, IntComparator> ht("blah", bpm, IntComparator(), HashFunction<int>());
+
+  // lookups of the keys that stay run without latches while the others keep splitting and merging buckets
+  const int num_keys = 1000;
+  for (int i = 0; i < num_keys; i++) {
+    EXPECT_TRUE(ht.Insert(nullptr, i, i));
+  }
+  std::atomic<bool> done{false};
+  std::vector<std::thread> readers;
+  for (int t = 0; t < 2; t++) {
+    readers.emplace_back([&] {
+      while (!done) {
+        for (int i = 0; i < num_keys; i++) {
+          std::vector<int> res;
+          ASSERT_TRUE(ht.GetValue(nullptr, i, &res)) << "Failed to find " << i;
+          ASSERT_EQ(1, res.size());
+          ASSERT_EQ(i, res[0]);
+        }
+      }
+    });
+  }
+  for (int round = 0; round < 3; round++) {
+    for (int i = num_keys; i < 3 * num_keys; i++) {
+      EXPECT_TRUE(ht.Insert(nullptr, i, i));
+    }
+    for (int i = num_keys; i < 3 * num_keys; i++) {
+      EXPECT_TRUE(ht.Remove(nullptr, i, i));
+    }
+  }
+  done = true;
+  for (auto &reader : readers) {
+    reader.join();
+  }
+  ht.VerifyIntegrity();
+
+  delete bpm;
+  delete disk_manager;
+  remove("extendible_test.db");
+}
+
+// NOLINTNEXTLINE
+TEST(ExtendibleHashTableTest, GetValuesTest) {
+  auto *disk_manager = new DiskManager("extendible_test.db");
+  auto *bpm = new BufferPoolManagerInstance(10, disk_manager);
+
+  ExtendibleHashTable<int, int, IntComparator> ht("blah", bpm, IntComparator(), HashFunction<int>());
+  const int num_keys = 3000;
+  for (int i = 0; i < num_keys; i++) {
+    EXPECT_TRUE(ht.Insert(nullptr, i, i));
+  }
+  EXPECT_TRUE(ht.Insert(nullptr, 3, -3));
+
+  // keys in a batch of several groups, some twice and some not in the table
+  std::vector<int> keys;
+  for (int i = 0; i < 100; i++) {
+    keys.push_back((i * 7919) % (2 * num_keys));
+  }
+  keys.push_back(3);
+  keys.push_back(3);
+  std::vector<std::vector<int>> results;
+  ht.GetValues(nullptr, keys, &results);
+  ASSERT_EQ(keys.size(), results.size());
+  for (size_t i = 0; i < keys.size(); i++) {
+    std::sort(results[i].begin(), results[i].end());
+    if (keys[i] == 3) {
+      EXPECT_EQ((std::vector<int>{-3, 3}), results[i]);
+    } else if (keys[i] < num_keys) {
+      EXPECT_EQ(std::vector<int>{keys[i]}, results[i]);
+    } else {
+      EXPECT_TRUE(results[i].empty()) << "Found " << keys[i];
+    }
+  }
+
+  delete bpm;
+  delete disk_manager;
+  remove("extendible_test.db");
+}
+
+}  // namespace bustub
@@ -13,7 +13,7 @@
 #include <thread>  // NOLINT
 #include <vector>
 
-#include "buffer/buffer_pool_manager.h"
+#include "buffer/buffer_pool_manager_instance.h"
 #include "common/logger.h"
 #include "gtest/gtest.h"
 #include "storage/disk/disk_manager.h"
@@ -25,7 +25,7 @@ namespace bustub {
 // NOLINTNEXTLINE
 TEST(HashTablePageTest, HeaderPageSampleTest) {
   DiskManager *disk_manager = new DiskManager("test.db");
-  auto *bpm = new BufferPoolManager(5, disk_manager);
+  auto *bpm = new BufferPoolManagerInstance(5, disk_manager);
 
   // get a header page from the BufferPoolManager
   page_id_t header_page_id = INVALID_PAGE_ID;
@@ -63,7 +63,7 @@ TEST(HashTablePageTest, HeaderPageSampleTest) {
 // NOLINTNEXTLINE
 TEST(HashTablePageTest, BlockPageSampleTest) {
   DiskManager *disk_manager = new DiskManager("test.db");
-  auto *bpm = new BufferPoolManager(5, disk_manager);
+  auto *bpm = new BufferPoolManagerInstance(5, disk_manager);
 
   // get a block page from the BufferPoolManager
   page_id_t block_page_id = INVALID_PAGE_ID;
@@ -73,13 +73,16 @@ TEST(HashTablePageTest, BlockPageSampleTest) {
 
   // insert a few (key, value) pairs
   for (unsigned i = 0; i < 10; i++) {
-    block_page->Insert(i, i, i);
+    // hashes whose tags are 0 to 3
+    EXPECT_TRUE(block_page->Insert(i, i, i, (i % 4) << 25 | i));
   }
+  EXPECT_FALSE(block_page->Insert(0, 1, 1, 0));
 
   // check for the inserted pairs
   for (unsigned i = 0; i < 10; i++) {
     EXPECT_EQ(i, block_page->KeyAt(i));
     EXPECT_EQ(i, block_page->ValueAt(i));
+    EXPECT_EQ((i % 4) << 25 | i, block_page->HashAt(i));
   }
 
   // remove a few pairs
@@ -103,6 +106,15 @@ TEST(HashTablePageTest, BlockPageSampleTest) {
     }
   }
 
+  // a probe classifies a group of slots at once: readable ones by tag, tombstones and empty ones
+  auto group = block_page->MatchGroup(0, 2);
+  EXPECT_EQ(0b0000000001000100U, group.match_);
+  EXPECT_EQ(0b1111110000000000U, group.empty_);
+  EXPECT_EQ(0b0000001010101010U, group.deleted_);
+  group = block_page->MatchGroup(4, 0);
+  EXPECT_EQ(0b0000000000010001U, group.match_);
+  EXPECT_EQ(0b1111111111000000U, group.empty_);
+
   // unpin the header page now that we are done
   bpm->UnpinPage(block_page_id, true, nullptr);
   disk_manager->ShutDown();
@@ -10,9 +10,12 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <algorithm>
 #include <thread>  // NOLINT
+#include <utility>
 #include <vector>
 
+#include "buffer/buffer_pool_manager_instance.h"
 #include "common/logger.h"
 #include "container/hash/linear_probe_hash_table.h"
 #include "gtest/gtest.h"
@@ -20,10 +23,16 @@
 
 namespace bustub {
 
+/** @return the number of slots of a block page for the given pairs */
+template <typename KeyType, typename ValueType>
+constexpr int BlockArraySize() {
+  return BLOCK_ARRAY_SIZE;
+}
+
 // NOLINTNEXTLINE
 TEST(HashTableTest, SampleTest) {
   auto *disk_manager = new DiskManager("test.db");
-  auto *bpm = new BufferPoolManager(50, disk_manager);
+  auto *bpm = new BufferPoolManagerInstance(50, disk_manager);
 
   LinearProbeHashTable<int, int, IntComparator> ht("blah", bpm, IntComparator(), 1000, HashFunction<int>());
 
@@ -104,4 +113,218 @@ TEST(HashTableTest, SampleTest) {
   delete bpm;
 }
 
+// NOLINTNEXTLINE
+TEST(HashTableTest, GrowTest) {
+  auto *disk_manager = new DiskManager("test.db");
+  auto *bpm = new BufferPoolManagerInstance(10, disk_manager);
+
+  // three block pages, probed as one array of slots
+  const int num_slots = 3 * BlockArraySize<int, int>();
+  LinearProbeHashTable<int, int, IntComparator> ht("blah", bpm, IntComparator(), num_slots, HashFunction<int>());
+  EXPECT_EQ(static_cast<size_t>(num_slots), ht.GetSize());
+
+  // the table grows as it fills up, and every pair stays visible while it is migrated
+  const int num_keys = 4 * num_slots;
+  for (int i = 0; i < num_keys; i++) {
+    EXPECT_TRUE(ht.Insert(nullptr, i, i)) << "Failed to insert " << i;
+    if (i % 97 == 0) {
+      for (int j = 0; j <= i; j += 13) {
+        std::vector<int> res;
+        EXPECT_TRUE(ht.GetValue(nullptr, j, &res)) << "Lost " << j << " after inserting " << i;
+      }
+    }
+  }
+  EXPECT_LE(static_cast<size_t>(num_keys), ht.GetSize());
+  EXPECT_FALSE(ht.Insert(nullptr, 7, 7));
+  for (int i = 0; i < num_keys; i++) {
+    std::vector<int> res;
+    EXPECT_TRUE(ht.GetValue(nullptr, i, &res));
+    ASSERT_EQ(1, res.size());
+    EXPECT_EQ(i, res[0]);
+  }
+
+  // removed pairs leave tombstones that later inserts reuse
+  for (int i = 0; i < num_keys; i += 2) {
+    EXPECT_TRUE(ht.Remove(nullptr, i, i));
+    EXPECT_FALSE(ht.Remove(nullptr, i, i));
+  }
+  for (int i = 0; i < num_keys; i++) {
+    std::vector<int> res;
+    EXPECT_EQ(i % 2 == 1, ht.GetValue(nullptr, i, &res));
+  }
+
+  // an explicit resize in the middle of removes and inserts
+  size_t size = ht.GetSize();
+  ht.Resize(size);
+  EXPECT_EQ(2 * size, ht.GetSize());
+  for (int i = 0; i < num_keys; i += 2) {
+    EXPECT_TRUE(ht.Insert(nullptr, i, -i));
+    EXPECT_TRUE(ht.Remove(nullptr, i + 1, i + 1));
+  }
+  for (int i = 0; i < num_keys; i++) {
+    std::vector<int> res;
+    EXPECT_EQ(i % 2 == 0, ht.GetValue(nullptr, i, &res));
+    if (i % 2 == 0) {
+      EXPECT_EQ(std::vector<int>{-i}, res);
+    }
+  }
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete disk_manager;
+  delete bpm;
+}
+
+// NOLINTNEXTLINE
+TEST(HashTableTest, ConcurrentTest) {
+  auto *disk_manager = new DiskManager("test.db");
+  auto *bpm = new BufferPoolManagerInstance(50, disk_manager);
+
+  LinearProbeHashTable<int, int, IntComparator> ht("blah", bpm, IntComparator(), 1000, HashFunction<int>());
+
+  // every thread inserts the same keys, with a value of its own, and one of each pair of threads also the value of the
+  // other, so concurrent inserts of the same pair race; the table grows meanwhile
+  const int num_threads = 8;
+  const int num_keys = 2000;
+  std::vector<std::thread> threads;
+  std::vector<int> num_inserted(num_threads, 0);
+  for (int t = 0; t < num_threads; t++) {
+    threads.emplace_back([&, t] {
+      for (int i = 0; i < num_keys; i++) {
+        num_inserted[t] += ht.Insert(nullptr, i, t / 2) ? 1 : 0;
+        if (i % 3 == 0) {
+          std::vector<int> res;
+          EXPECT_TRUE(ht.GetValue(nullptr, i, &res));
+        }
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  int total = 0;
+  for (int n : num_inserted) {
+    total += n;
+  }
+  EXPECT_EQ(num_threads / 2 * num_keys, total);
+  for (int i = 0; i < num_keys; i++) {
+    std::vector<int> res;
+    ht.GetValue(nullptr, i, &res);
+    EXPECT_EQ(static_cast<size_t>(num_threads / 2), res.size()) << "Wrong values for " << i;
+  }
+
+  // concurrent removes of disjoint values
+  threads.clear();
+  for (int t = 0; t < num_threads / 2; t++) {
+    threads.emplace_back([&, t] {
+      for (int i = 0; i < num_keys; i++) {
+        EXPECT_TRUE(ht.Remove(nullptr, i, t));
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  for (int i = 0; i < num_keys; i++) {
+    std::vector<int> res;
+    EXPECT_FALSE(ht.GetValue(nullptr, i, &res));
+  }
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete disk_manager;
+  delete bpm;
+}
+
+// NOLINTNEXTLINE
+TEST(HashTableTest, BulkInsertTest) {
+  auto *disk_manager = new DiskManager("test.db");
+  auto *bpm = new BufferPoolManagerInstance(10, disk_manager);
+
+  LinearProbeHashTable<int, int, IntComparator> ht("blah", bpm, IntComparator(), 100, HashFunction<int>());
+  for (int i = 0; i < 100; i++) {
+    EXPECT_TRUE(ht.Insert(nullptr, i, i));
+  }
+
+  // far more pairs than the table holds, some of them there already and some twice
+  const int num_keys = 20000;
+  std::vector<std::pair<int, int>> pairs;
+  for (int i = 0; i < num_keys; i++) {
+    pairs.emplace_back(i, i);
+    if (i % 10 == 0) {
+      pairs.emplace_back(i, i);
+      pairs.emplace_back(i, -i - 1);
+    }
+  }
+  EXPECT_EQ(static_cast<size_t>(num_keys - 100 + num_keys / 10), ht.BulkInsert(nullptr, pairs));
+  EXPECT_LE(static_cast<size_t>(num_keys), ht.GetSize());
+  for (int i = 0; i < num_keys; i++) {
+    std::vector<int> res;
+    EXPECT_TRUE(ht.GetValue(nullptr, i, &res));
+    EXPECT_EQ(i % 10 == 0 ? 2 : 1, res.size()) << "Wrong values for " << i;
+  }
+
+  // the table works as usual afterwards
+  EXPECT_FALSE(ht.Insert(nullptr, 5, 5));
+  EXPECT_TRUE(ht.Remove(nullptr, 5, 5));
+  EXPECT_TRUE(ht.Insert(nullptr, 5, 6));
+  EXPECT_EQ(0U, ht.BulkInsert(nullptr, {{5, 6}, {7, 7}}));
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete disk_manager;
+  delete bpm;
+}
+
+// NOLINTNEXTLINE
+TEST(HashTableTest, GetValuesTest) {
+  auto *disk_manager = new DiskManager("test.db");
+  auto *bpm = new BufferPoolManagerInstance(10, disk_manager);
+
+  // more block pages than frames, so that the prefetched pages have to be read
+  const int num_keys = 20 * BlockArraySize<int, int>();
+  LinearProbeHashTable<int, int, IntComparator> ht("blah", bpm, IntComparator(), 1000, HashFunction<int>());
+  for (int i = 0; i < num_keys; i++) {
+    EXPECT_TRUE(ht.Insert(nullptr, i, i));
+  }
+  EXPECT_TRUE(ht.Insert(nullptr, 3, -3));
+  // keys in a batch of several groups, some twice and some not in the table, while the table grows
+  ht.Resize(ht.GetSize());
+  std::vector<int> keys;
+  for (int i = 0; i < 100; i++) {
+    keys.push_back((i * 7919) % (2 * num_keys));
+  }
+  keys.push_back(3);
+  keys.push_back(3);
+  std::vector<std::vector<int>> results{{42}};
+  ht.GetValues(nullptr, keys, &results);
+  ASSERT_EQ(keys.size(), results.size());
+  // the values are appended to those there already
+  EXPECT_EQ((std::vector<int>{42, 0}), results[0]);
+  for (size_t i = 1; i < keys.size(); i++) {
+    std::vector<int> expected;
+    ht.GetValue(nullptr, keys[i], &expected);
+    std::sort(results[i].begin(), results[i].end());
+    std::sort(expected.begin(), expected.end());
+    EXPECT_EQ(expected, results[i]) << "Wrong values for " << keys[i];
+    EXPECT_EQ(keys[i] < num_keys ? (keys[i] == 3 ? 2U : 1U) : 0U, results[i].size());
+  }
+
+  // the keys of a batch that start in the same block page pin it once, in each generation
+  std::vector<int> same_keys(64, 7);
+  results.clear();
+  BufferPoolStats before = bpm->GetStats();
+  ht.GetValues(nullptr, same_keys, &results);
+  BufferPoolStats after = bpm->GetStats();
+  EXPECT_GE(4U, after.hits_ + after.misses_ - before.hits_ - before.misses_);
+  for (const auto &result : results) {
+    EXPECT_EQ(std::vector<int>{7}, result);
+  }
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete disk_manager;
+  delete bpm;
+}
+
 }  // namespace bustub
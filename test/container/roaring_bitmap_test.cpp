@@ -0,0 +1,107 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// roaring_bitmap_test.cpp
+//
+// Identification: test/container/roaring_bitmap_test.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <iterator>
+#include <random>
+#include <set>
+#include <vector>
+
+#include "container/bitmap/roaring_bitmap.h"
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+// NOLINTNEXTLINE
+TEST(RoaringBitmapTest, AddRemoveTest) {
+  RoaringBitmap bitmap;
+  std::set<uint64_t> expected;
+  std::mt19937_64 rng(42);
+  // values over a few chunks, dense enough that some of them turn into bitmaps and back
+  for (int i = 0; i < 50000; i++) {
+    uint64_t value = (rng() % 4) << 32 | (rng() % 3) << 16 | (rng() % 8192);
+    if (rng() % 4 == 0) {
+      EXPECT_EQ(bitmap.Remove(value), expected.erase(value) == 1);
+    } else {
+      EXPECT_EQ(bitmap.Add(value), expected.insert(value).second);
+    }
+  }
+  EXPECT_EQ(bitmap.Cardinality(), expected.size());
+  EXPECT_EQ(bitmap.ToVector(), std::vector<uint64_t>(expected.begin(), expected.end()));
+  for (uint64_t value = 0; value < 8192; value++) {
+    EXPECT_EQ(bitmap.Contains(value), expected.count(value) == 1);
+  }
+  for (uint64_t value : expected) {
+    EXPECT_TRUE(bitmap.Remove(value));
+  }
+  EXPECT_TRUE(bitmap.IsEmpty());
+}
+
+// NOLINTNEXTLINE
+TEST(RoaringBitmapTest, IntersectUnionTest) {
+  std::mt19937_64 rng(7);
+  // a dense bitmap, a sparse one, and one of every third value, over the same chunks and some of their own
+  RoaringBitmap dense;
+  RoaringBitmap sparse;
+  RoaringBitmap thirds;
+  std::set<uint64_t> dense_values;
+  std::set<uint64_t> sparse_values;
+  std::set<uint64_t> thirds_values;
+  for (uint64_t value = 0; value < 3 * 65536; value++) {
+    if (rng() % 2 == 0) {
+      dense.Add(value);
+      dense_values.insert(value);
+    }
+    if (rng() % 100 == 0) {
+      sparse.Add(value + 65536);
+      sparse_values.insert(value + 65536);
+    }
+    if (value % 3 == 0) {
+      thirds.Add(value);
+      thirds_values.insert(value);
+    }
+  }
+
+  auto check = [](const RoaringBitmap &bitmap, const std::set<uint64_t> &values) {
+    EXPECT_EQ(bitmap.Cardinality(), values.size());
+    EXPECT_EQ(bitmap.ToVector(), std::vector<uint64_t>(values.begin(), values.end()));
+  };
+  auto intersect = [](const std::set<uint64_t> &lhs, const std::set<uint64_t> &rhs) {
+    std::set<uint64_t> result;
+    std::set_intersection(lhs.begin(), lhs.end(), rhs.begin(), rhs.end(), std::inserter(result, result.end()));
+    return result;
+  };
+  auto unite = [](const std::set<uint64_t> &lhs, const std::set<uint64_t> &rhs) {
+    std::set<uint64_t> result(lhs);
+    result.insert(rhs.begin(), rhs.end());
+    return result;
+  };
+
+  RoaringBitmap dense_and_sparse(dense);
+  dense_and_sparse.IntersectWith(sparse);
+  check(dense_and_sparse, intersect(dense_values, sparse_values));
+  RoaringBitmap dense_and_thirds(dense);
+  dense_and_thirds.IntersectWith(thirds);
+  check(dense_and_thirds, intersect(dense_values, thirds_values));
+  RoaringBitmap sparse_or_thirds(sparse);
+  sparse_or_thirds.UnionWith(thirds);
+  check(sparse_or_thirds, unite(sparse_values, thirds_values));
+  RoaringBitmap all(dense);
+  all.UnionWith(sparse);
+  all.UnionWith(thirds);
+  check(all, unite(unite(dense_values, sparse_values), thirds_values));
+
+  // a bitmap of a dense chunk is smaller than its values
+  EXPECT_LT(dense.GetMemoryUsage(), dense_values.size() * sizeof(uint16_t));
+}
+
+}  // namespace bustub
@@ -0,0 +1,189 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// compiled_predicate_test.cpp
+//
+// Identification: test/execution/compiled_predicate_test.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "catalog/schema.h"
+#include "execution/compiled_predicate.h"
+#include "execution/expressions/arithmetic_expression.h"
+#include "execution/expressions/column_value_expression.h"
+#include "execution/expressions/comparison_expression.h"
+#include "execution/expressions/conjunction_expression.h"
+#include "execution/expressions/constant_value_expression.h"
+#include "execution/expressions/parameter_value_expression.h"
+#include "gtest/gtest.h"
+#include "storage/table/tuple.h"
+#include "type/value_factory.h"
+
+namespace bustub {
+
+// a value of the numeric type, of a small range so that the comparisons go either way, or a NULL now and then
+static Value RandomValue(TypeId type, std::mt19937 *random) {
+  int32_t i = static_cast<int32_t>((*random)() % 11) - 5;
+  if (i == 5) {
+    return ValueFactory::GetNullValueByType(type);
+  }
+  switch (type) {
+    case TypeId::TINYINT:
+      return Value(type, static_cast<int8_t>(i));
+    case TypeId::SMALLINT:
+      return Value(type, static_cast<int16_t>(i));
+    case TypeId::INTEGER:
+      return Value(type, i);
+    case TypeId::BIGINT:
+      return Value(type, static_cast<int64_t>(i));
+    default:
+      return Value(type, i / 2.0);
+  }
+}
+
+// NOLINTNEXTLINE
+TEST(CompiledPredicateTest, MatchesEvaluateTest) {
+  // the last column's null bit is in the second byte of the bitmap
+  std::vector<TypeId> types{TypeId::TINYINT, TypeId::SMALLINT, TypeId::INTEGER, TypeId::BIGINT, TypeId::DECIMAL,
+                            TypeId::INTEGER, TypeId::INTEGER, TypeId::INTEGER, TypeId::BIGINT};
+  std::vector<Column> columns;
+  for (size_t i = 0; i < types.size(); i++) {
+    columns.emplace_back("c" + std::to_string(i), types[i]);
+  }
+  columns.emplace_back("name", TypeId::VARCHAR, 16);
+  Schema schema(columns);
+
+  std::mt19937 random(11);
+  std::vector<Tuple> tuples;
+  for (int i = 0; i < 200; i++) {
+    std::vector<Value> values;
+    for (TypeId type : types) {
+      values.push_back(RandomValue(type, &random));
+    }
+    values.emplace_back(TypeId::VARCHAR, std::to_string(i));
+    tuples.emplace_back(values, &schema);
+  }
+
+  // every comparison of a column with a column or a constant of every type, either way round, holds for the tuples
+  // that Evaluate says it is true for
+  std::vector<std::unique_ptr<AbstractExpression>> operands;
+  for (uint32_t col : {0, 1, 2, 3, 4, 8}) {
+    operands.push_back(std::make_unique<ColumnValueExpression>(0, col, types[col]));
+  }
+  for (TypeId type : {TypeId::TINYINT, TypeId::SMALLINT, TypeId::INTEGER, TypeId::BIGINT, TypeId::DECIMAL}) {
+    operands.push_back(std::make_unique<ConstantValueExpression>(RandomValue(type, &random)));
+  }
+  operands.push_back(std::make_unique<ConstantValueExpression>(ValueFactory::GetNullValueByType(TypeId::INTEGER)));
+  for (const auto &left : operands) {
+    for (const auto &right : operands) {
+      for (ComparisonType comp_type :
+           {ComparisonType::Equal, ComparisonType::NotEqual, ComparisonType::LessThan, ComparisonType::LessThanOrEqual,
+            ComparisonType::GreaterThan, ComparisonType::GreaterThanOrEqual}) {
+        ComparisonExpression predicate(left.get(), right.get(), comp_type);
+        auto compiled = CompiledPredicate::Compile(&predicate, &schema);
+        ASSERT_NE(nullptr, compiled);
+        for (const Tuple &tuple : tuples) {
+          Value expected = predicate.Evaluate(&tuple, &schema);
+          ASSERT_EQ(!expected.IsNull() && expected.GetAs<bool>(), compiled->Evaluate(tuple));
+        }
+      }
+    }
+  }
+}
+
+// NOLINTNEXTLINE
+TEST(CompiledPredicateTest, UnsupportedTest) {
+  Schema schema({Column("a", TypeId::INTEGER), Column("b", TypeId::VARCHAR, 16), Column("c", TypeId::BOOLEAN)});
+  ColumnValueExpression a(0, 0, TypeId::INTEGER);
+  ColumnValueExpression b(0, 1, TypeId::VARCHAR);
+  ColumnValueExpression c(0, 2, TypeId::BOOLEAN);
+  ColumnValueExpression right_a(1, 0, TypeId::INTEGER);
+  ConstantValueExpression name(ValueFactory::GetVarcharValue("x"));
+  ConstantValueExpression one(ValueFactory::GetIntegerValue(1));
+
+  // the predicates that are not comparisons of numeric columns of the tuple and constants are left to Evaluate
+  ComparisonExpression strings(&b, &name, ComparisonType::Equal);
+  EXPECT_EQ(nullptr, CompiledPredicate::Compile(&strings, &schema));
+  ComparisonExpression booleans(&c, &c, ComparisonType::Equal);
+  EXPECT_EQ(nullptr, CompiledPredicate::Compile(&booleans, &schema));
+  ComparisonExpression join(&a, &right_a, ComparisonType::Equal);
+  EXPECT_EQ(nullptr, CompiledPredicate::Compile(&join, &schema));
+  ComparisonExpression nested(&strings, &one, ComparisonType::Equal);
+  EXPECT_EQ(nullptr, CompiledPredicate::Compile(&nested, &schema));
+  EXPECT_EQ(nullptr, CompiledPredicate::Compile(&a, &schema));
+  ComparisonExpression numbers(&a, &one, ComparisonType::Equal);
+  EXPECT_NE(nullptr, CompiledPredicate::Compile(&numbers, &schema));
+}
+
+// NOLINTNEXTLINE
+TEST(CompiledPredicateTest, ParameterTest) {
+  Schema schema({Column("a", TypeId::INTEGER)});
+  std::vector<Value> parameters{ValueFactory::GetIntegerValue(3)};
+  ColumnValueExpression a(0, 0, TypeId::INTEGER);
+  ParameterValueExpression param(&parameters, 0, TypeId::INTEGER);
+  ComparisonExpression predicate(&a, &param, ComparisonType::Equal);
+  Tuple three({ValueFactory::GetIntegerValue(3)}, &schema);
+  Tuple four({ValueFactory::GetIntegerValue(4)}, &schema);
+
+  // the parameter is compiled in with the value it has then
+  auto compiled = CompiledPredicate::Compile(&predicate, &schema);
+  ASSERT_NE(nullptr, compiled);
+  EXPECT_TRUE(compiled->Evaluate(three));
+  parameters[0] = ValueFactory::GetIntegerValue(4);
+  EXPECT_TRUE(compiled->Evaluate(three));
+  compiled = CompiledPredicate::Compile(&predicate, &schema);
+  EXPECT_FALSE(compiled->Evaluate(three));
+  EXPECT_TRUE(compiled->Evaluate(four));
+}
+
+// NOLINTNEXTLINE
+TEST(CompiledPredicateTest, ConjunctionTest) {
+  Schema schema({Column("a", TypeId::INTEGER), Column("b", TypeId::DECIMAL)});
+  ColumnValueExpression a(0, 0, TypeId::INTEGER);
+  ColumnValueExpression b(0, 1, TypeId::DECIMAL);
+  ConstantValueExpression two(ValueFactory::GetIntegerValue(2));
+  ConstantValueExpression five(ValueFactory::GetIntegerValue(5));
+  ConstantValueExpression half(ValueFactory::GetDecimalValue(0.5));
+  ComparisonExpression from(&a, &two, ComparisonType::GreaterThanOrEqual);
+  ComparisonExpression to(&a, &five, ComparisonType::LessThan);
+  ComparisonExpression small(&b, &half, ComparisonType::LessThan);
+  ConjunctionExpression range({&from, &to, &small});
+
+  std::mt19937 random(7);
+  std::vector<Tuple> tuples;
+  for (int i = 0; i < 100; i++) {
+    tuples.emplace_back(
+        std::vector<Value>{RandomValue(TypeId::INTEGER, &random), RandomValue(TypeId::DECIMAL, &random)}, &schema);
+  }
+  // a conjunction of comparisons that compile holds where Evaluate says it is true, and not where it is NULL
+  auto compiled = CompiledPredicate::Compile(&range, &schema);
+  ASSERT_NE(nullptr, compiled);
+  for (const Tuple &tuple : tuples) {
+    Value expected = range.Evaluate(&tuple, &schema);
+    ASSERT_EQ(!expected.IsNull() && expected.GetAs<bool>(), compiled->Evaluate(tuple));
+  }
+
+  // one that compiles not, such as a comparison of an arithmetic expression, keeps the whole conjunction from it
+  ArithmeticExpression product(&a, &b, ArithmeticType::Multiply);
+  EXPECT_EQ(TypeId::DECIMAL, product.GetReturnType());
+  ComparisonExpression cheap(&product, &five, ComparisonType::LessThan);
+  EXPECT_EQ(nullptr, CompiledPredicate::Compile(&cheap, &schema));
+  ConjunctionExpression mixed({&from, &cheap});
+  EXPECT_EQ(nullptr, CompiledPredicate::Compile(&mixed, &schema));
+  Tuple row({ValueFactory::GetIntegerValue(3), ValueFactory::GetDecimalValue(1.5)}, &schema);
+  EXPECT_EQ(4.5, product.Evaluate(&row, &schema).GetAs<double>());
+  EXPECT_TRUE(mixed.Evaluate(&row, &schema).GetAs<bool>());
+  Tuple null_row({ValueFactory::GetNullValueByType(TypeId::INTEGER), ValueFactory::GetDecimalValue(0.0)}, &schema);
+  EXPECT_TRUE(product.Evaluate(&null_row, &schema).IsNull());
+  EXPECT_TRUE(range.Evaluate(&null_row, &schema).IsNull());
+}
+
+}  // namespace bustub
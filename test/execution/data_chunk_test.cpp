@@ -0,0 +1,329 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// data_chunk_test.cpp
+//
+// Identification: test/execution/data_chunk_test.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <string>
+#include <vector>
+
+#include "catalog/schema.h"
+#include "execution/expressions/column_value_expression.h"
+#include "execution/expressions/comparison_expression.h"
+#include "execution/expressions/conjunction_expression.h"
+#include "execution/expressions/constant_value_expression.h"
+#include "execution/plans/hash_join_plan.h"
+#include "execution/vector/data_chunk.h"
+#include "execution/vector/hash_kernels.h"
+#include "gtest/gtest.h"
+#include "storage/table/tuple.h"
+#include "type/value_factory.h"
+
+namespace bustub {
+
+// NOLINTNEXTLINE
+TEST(DataChunkTest, TupleRoundTripTest) {
+  Schema schema({Column("a", TypeId::INTEGER), Column("b", TypeId::BIGINT), Column("c", TypeId::VARCHAR, 32),
+                 Column("d", TypeId::DECIMAL), Column("e", TypeId::BOOLEAN)});
+  const size_t capacity = 100;
+  DataChunk chunk(&schema, capacity);
+  ASSERT_EQ(5, chunk.GetColumnCount());
+
+  // every third row has nulls in all of its columns
+  std::vector<Tuple> tuples;
+  for (int32_t i = 0; i < static_cast<int32_t>(capacity); i++) {
+    std::vector<Value> values;
+    if (i % 3 == 0) {
+      for (const Column &column : schema.GetColumns()) {
+        values.push_back(ValueFactory::GetNullValueByType(column.GetType()));
+      }
+    } else {
+      values = {Value(TypeId::INTEGER, i), Value(TypeId::BIGINT, int64_t{i} * 1000000007),
+                Value(TypeId::VARCHAR, std::string(i % 20, 'x') + std::to_string(i)), Value(TypeId::DECIMAL, i / 4.0),
+                Value(TypeId::BOOLEAN, static_cast<int8_t>(i % 2))};
+    }
+    tuples.emplace_back(values, &schema);
+    ASSERT_TRUE(chunk.Append(tuples.back()));
+  }
+  EXPECT_TRUE(chunk.IsFull());
+  EXPECT_FALSE(chunk.Append(tuples[0]));
+
+  // the typed vectors hold the values, the validity bitmaps the nulls
+  const int32_t *a = chunk.GetColumn(0).GetData<int32_t>();
+  const StringSlice *c = chunk.GetColumn(2).GetData<StringSlice>();
+  for (size_t i = 0; i < capacity; i++) {
+    for (size_t col = 0; col < chunk.GetColumnCount(); col++) {
+      EXPECT_EQ(i % 3 != 0, chunk.GetColumn(col).IsValid(i));
+    }
+    if (i % 3 != 0) {
+      EXPECT_EQ(static_cast<int32_t>(i), a[i]);
+      std::string expected = std::string(i % 20, 'x') + std::to_string(i);
+      EXPECT_EQ(expected.size() + 1, c[i].length_);
+      EXPECT_EQ(expected, std::string(c[i].data_));
+    }
+  }
+
+  // and the rows come back as the tuples they were made of
+  for (size_t i = 0; i < capacity; i++) {
+    Tuple tuple = chunk.GetTuple(i);
+    for (uint32_t col = 0; col < schema.GetColumnCount(); col++) {
+      Value expected = tuples[i].GetValue(&schema, col);
+      Value value = tuple.GetValue(&schema, col);
+      EXPECT_EQ(expected.IsNull(), value.IsNull());
+      if (!expected.IsNull()) {
+        EXPECT_EQ(CmpBool::CmpTrue, expected.CompareEquals(value)) << i << ", " << col;
+      }
+    }
+  }
+
+  // a reset chunk takes a new batch
+  chunk.Reset();
+  EXPECT_EQ(0, chunk.GetSize());
+  ASSERT_TRUE(chunk.Append(tuples[1]));
+  EXPECT_EQ(1, chunk.GetSize());
+  EXPECT_EQ(1, chunk.GetColumn(0).GetData<int32_t>()[0]);
+
+  // a row of some of the columns of a tuple has nulls in the others
+  ASSERT_TRUE(chunk.Append(tuples[2], {0, 2}));
+  EXPECT_EQ(2, chunk.GetSize());
+  EXPECT_EQ(2, chunk.GetColumn(0).GetData<int32_t>()[1]);
+  EXPECT_EQ(std::string("xx2"), std::string(chunk.GetColumn(2).GetData<StringSlice>()[1].data_));
+  for (uint32_t col : {1, 3, 4}) {
+    EXPECT_FALSE(chunk.GetColumn(col).IsValid(1));
+  }
+}
+
+// NOLINTNEXTLINE
+TEST(DataChunkTest, SelectionTest) {
+  Schema schema({Column("a", TypeId::INTEGER)});
+  DataChunk chunk(&schema, 16);
+  ColumnVector &column = chunk.GetColumn(0);
+  for (int32_t i = 0; i < 16; i++) {
+    column.SetValue(i, Value(TypeId::INTEGER, i));
+  }
+  chunk.SetSize(16);
+  EXPECT_FALSE(chunk.HasSelection());
+  EXPECT_EQ(16, chunk.GetSelectedCount());
+
+  // a filter keeps the even rows
+  std::vector<uint32_t> selection;
+  const int32_t *a = column.GetData<int32_t>();
+  for (size_t i = 0; i < chunk.GetSelectedCount(); i++) {
+    uint32_t row = chunk.GetSelectedRow(i);
+    if (a[row] % 2 == 0) {
+      selection.push_back(row);
+    }
+  }
+  chunk.SetSelection(std::move(selection));
+  ASSERT_EQ(8, chunk.GetSelectedCount());
+  for (size_t i = 0; i < chunk.GetSelectedCount(); i++) {
+    EXPECT_EQ(2 * i, chunk.GetSelectedRow(i));
+  }
+
+  // only the selected rows become tuples
+  std::vector<Tuple> tuples;
+  chunk.GetTuples(&tuples);
+  ASSERT_EQ(8, tuples.size());
+  for (size_t i = 0; i < tuples.size(); i++) {
+    EXPECT_EQ(static_cast<int32_t>(2 * i), tuples[i].GetValue(&schema, 0).GetAs<int32_t>());
+  }
+
+  chunk.ClearSelection();
+  EXPECT_EQ(16, chunk.GetSelectedCount());
+}
+
+// a value of the type made of a small number, so that comparisons come out either way
+static Value MakeValue(TypeId type, int32_t i, bool null) {
+  if (null) {
+    return ValueFactory::GetNullValueByType(type);
+  }
+  switch (type) {
+    case TypeId::BOOLEAN:
+      return Value(type, static_cast<int8_t>(i % 2));
+    case TypeId::TINYINT:
+      return Value(type, static_cast<int8_t>(i - 10));
+    case TypeId::SMALLINT:
+      return Value(type, static_cast<int16_t>(i * 100));
+    case TypeId::INTEGER:
+      return Value(type, static_cast<int32_t>(i - 10));
+    case TypeId::BIGINT:
+      return Value(type, static_cast<int64_t>((int64_t{i} << 33) - 7));
+    case TypeId::DECIMAL:
+      return Value(type, i / 2.0 - 3);
+    default:
+      return Value(type, std::string(i % 4, 'a' + i % 3));
+  }
+}
+
+// NOLINTNEXTLINE
+TEST(DataChunkTest, FilterKernelTest) {
+  // TIMESTAMP Values have no Type to compare them through, so the kernels are checked for the other types
+  const std::vector<TypeId> types = {TypeId::BOOLEAN, TypeId::TINYINT, TypeId::SMALLINT, TypeId::INTEGER,
+                                     TypeId::BIGINT,  TypeId::DECIMAL, TypeId::VARCHAR};
+  const std::vector<ComparisonType> comp_types = {ComparisonType::Equal,           ComparisonType::NotEqual,
+                                                  ComparisonType::LessThan,        ComparisonType::LessThanOrEqual,
+                                                  ComparisonType::GreaterThan,     ComparisonType::GreaterThanOrEqual};
+  // more than a block of 64 rows, with a partial block at the end
+  const int32_t num_rows = 200;
+  for (TypeId type : types) {
+    auto column = [type](const std::string &name) {
+      return type == TypeId::VARCHAR ? Column(name, type, 16) : Column(name, type);
+    };
+    Schema schema({column("a"), column("b")});
+    DataChunk chunk(&schema, num_rows);
+    std::vector<Tuple> tuples;
+    for (int32_t i = 0; i < num_rows; i++) {
+      std::vector<Value> values{MakeValue(type, i % 20, i % 13 == 0), MakeValue(type, (i * 7) % 20, i % 11 == 0)};
+      tuples.emplace_back(values, &schema);
+      ASSERT_TRUE(chunk.Append(tuples.back()));
+    }
+
+    ColumnValueExpression a(0, 0, type);
+    ColumnValueExpression b(0, 1, type);
+    ConstantValueExpression constant(MakeValue(type, 9, false));
+    for (ComparisonType comp_type : comp_types) {
+      // a column against a constant on either side, and against another column
+      std::vector<ComparisonExpression> comparisons{{&a, &constant, comp_type}, {&constant, &a, comp_type},
+                                                    {&a, &b, comp_type}};
+      for (const ComparisonExpression &comparison : comparisons) {
+        std::vector<uint32_t> expected;
+        for (int32_t i = 0; i < num_rows; i++) {
+          Value result = comparison.Evaluate(&tuples[i], &schema);
+          if (!result.IsNull() && result.GetAs<bool>()) {
+            expected.push_back(i);
+          }
+        }
+        chunk.ClearSelection();
+        comparison.EvaluateBatch(&chunk);
+        EXPECT_EQ(expected, chunk.GetSelection()) << Type::TypeIdToString(type);
+
+        // a second comparison only looks at the rows the first one selected
+        std::vector<uint32_t> odd;
+        for (uint32_t row : expected) {
+          if (row % 2 == 1) {
+            odd.push_back(row);
+          }
+        }
+        std::vector<uint32_t> odd_rows;
+        for (uint32_t row = 1; row < num_rows; row += 2) {
+          odd_rows.push_back(row);
+        }
+        chunk.ClearSelection();
+        chunk.SetSelection(std::move(odd_rows));
+        comparison.EvaluateBatch(&chunk);
+        EXPECT_EQ(odd, chunk.GetSelection()) << Type::TypeIdToString(type);
+      }
+    }
+
+    // a null constant selects nothing
+    ConstantValueExpression null_constant(MakeValue(type, 0, true));
+    ComparisonExpression null_comparison(&a, &null_constant, ComparisonType::Equal);
+    chunk.ClearSelection();
+    null_comparison.EvaluateBatch(&chunk);
+    EXPECT_EQ(0, chunk.GetSelectedCount());
+  }
+}
+
+// NOLINTNEXTLINE
+TEST(DataChunkTest, ConjunctionTest) {
+  Schema schema({Column("a", TypeId::INTEGER), Column("b", TypeId::BIGINT)});
+  const int32_t num_rows = 200;
+  DataChunk chunk(&schema, num_rows);
+  std::vector<Tuple> tuples;
+  for (int32_t i = 0; i < num_rows; i++) {
+    std::vector<Value> values{MakeValue(TypeId::INTEGER, i % 20, i % 13 == 0),
+                              MakeValue(TypeId::BIGINT, (i * 7) % 20, i % 11 == 0)};
+    tuples.emplace_back(values, &schema);
+    ASSERT_TRUE(chunk.Append(tuples.back()));
+  }
+  ColumnValueExpression a(0, 0, TypeId::INTEGER);
+  ColumnValueExpression b(0, 1, TypeId::BIGINT);
+  ConstantValueExpression low(MakeValue(TypeId::INTEGER, 4, false));
+  ConstantValueExpression high(MakeValue(TypeId::BIGINT, 12, false));
+  ComparisonExpression a_low(&a, &low, ComparisonType::GreaterThan);
+  ComparisonExpression b_high(&b, &high, ComparisonType::LessThanOrEqual);
+  ComparisonExpression a_b(&a, &b, ComparisonType::NotEqual);
+  ConjunctionExpression conjunction({&a_low, &b_high, &a_b});
+
+  // the children narrow the selection down in turn to the rows the conjunction is true for
+  std::vector<uint32_t> expected;
+  for (int32_t i = 0; i < num_rows; i++) {
+    Value result = conjunction.Evaluate(&tuples[i], &schema);
+    if (!result.IsNull() && result.GetAs<bool>()) {
+      expected.push_back(i);
+    }
+  }
+  EXPECT_FALSE(expected.empty());
+  conjunction.EvaluateBatch(&chunk);
+  EXPECT_EQ(expected, chunk.GetSelection());
+}
+
+// NOLINTNEXTLINE
+TEST(DataChunkTest, HashKernelTest) {
+  const std::vector<TypeId> types = {TypeId::BOOLEAN, TypeId::TINYINT, TypeId::SMALLINT, TypeId::INTEGER,
+                                     TypeId::BIGINT,  TypeId::DECIMAL, TypeId::VARCHAR};
+  std::vector<Column> columns;
+  for (size_t col = 0; col < types.size(); col++) {
+    if (types[col] == TypeId::VARCHAR) {
+      columns.emplace_back("c" + std::to_string(col), types[col], 8);
+    } else {
+      columns.emplace_back("c" + std::to_string(col), types[col]);
+    }
+  }
+  Schema schema(columns);
+  const uint32_t num_rows = 100;
+  DataChunk chunk(&schema, num_rows);
+  std::vector<std::vector<Value>> rows(num_rows);
+  for (uint32_t row = 0; row < num_rows; row++) {
+    for (size_t col = 0; col < types.size(); col++) {
+      rows[row].push_back(MakeValue(types[col], static_cast<int32_t>(row), (row + col) % 7 == 0));
+      chunk.GetColumn(col).SetValue(row, rows[row].back());
+    }
+  }
+  chunk.SetSize(num_rows);
+
+  // a batch hashes each row as a hash join hashes the key of its values, over all rows and over a selection of them
+  std::vector<uint32_t> key_columns = {3, 6, 0, 5, 1};
+  auto expect_join_hashes = [&] {
+    std::vector<hash_t> hashes(chunk.GetSelectedCount());
+    HashChunk(chunk, key_columns, hashes.data());
+    for (size_t i = 0; i < chunk.GetSelectedCount(); i++) {
+      HashJoinKey key;
+      for (uint32_t col : key_columns) {
+        key.keys_.push_back(rows[chunk.GetSelectedRow(i)][col]);
+      }
+      EXPECT_EQ(std::hash<HashJoinKey>()(key), hashes[i]) << chunk.GetSelectedRow(i);
+    }
+  };
+  expect_join_hashes();
+  std::vector<uint32_t> selection;
+  for (uint32_t row = 1; row < num_rows; row += 3) {
+    selection.push_back(row);
+  }
+  chunk.SetSelection(std::move(selection));
+  expect_join_hashes();
+
+  // the integer types hash alike, nulls included
+  std::vector<hash_t> tiny(num_rows);
+  std::vector<hash_t> big(num_rows);
+  Schema int_schema({Column("a", TypeId::TINYINT), Column("b", TypeId::BIGINT)});
+  DataChunk ints(&int_schema, num_rows);
+  for (uint32_t row = 0; row < num_rows; row++) {
+    ints.GetColumn(0).SetValue(row, row % 5 == 0 ? ValueFactory::GetNullValueByType(TypeId::TINYINT)
+                                                 : Value(TypeId::TINYINT, static_cast<int8_t>(row)));
+    ints.GetColumn(1).SetValue(row, row % 5 == 0 ? ValueFactory::GetNullValueByType(TypeId::BIGINT)
+                                                 : Value(TypeId::BIGINT, static_cast<int64_t>(row)));
+  }
+  HashColumn(ints.GetColumn(0), nullptr, num_rows, tiny.data(), false);
+  HashColumn(ints.GetColumn(1), nullptr, num_rows, big.data(), false);
+  EXPECT_EQ(tiny, big);
+  EXPECT_EQ(HashUtil::NULL_HASH, tiny[0]);
+}
+
+}  // namespace bustub
@@ -10,30 +10,58 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <algorithm>
+#include <atomic>
 #include <cstdio>
+#include <map>
 #include <memory>
+#include <set>
 #include <string>
+#include <unordered_map>
 #include <unordered_set>
 #include <utility>
 #include <vector>
 
+#include "execution/plans/bitmap_scan_plan.h"
 #include "execution/plans/delete_plan.h"
+#include "execution/plans/distinct_plan.h"
+#include "execution/plans/hash_join_plan.h"
+#include "execution/plans/index_scan_plan.h"
 #include "execution/plans/limit_plan.h"
+#include "execution/plans/merge_join_plan.h"
+#include "execution/plans/nested_index_join_plan.h"
+#include "execution/plans/projection_plan.h"
+#include "execution/plans/sample_scan_plan.h"
+#include "execution/plans/sort_plan.h"
+#include "execution/plans/update_plan.h"
 
-#include "buffer/buffer_pool_manager.h"
+#include "buffer/buffer_pool_manager_instance.h"
 #include "catalog/table_generator.h"
+#include "common/tracer.h"
 #include "concurrency/transaction_manager.h"
 #include "execution/execution_engine.h"
+#include "execution/executor_factory.h"
 #include "execution/executor_context.h"
 #include "execution/executors/aggregation_executor.h"
 #include "execution/executors/insert_executor.h"
+#include "execution/executors/nested_index_join_executor.h"
 #include "execution/executors/nested_loop_join_executor.h"
+#include "execution/executors/seq_scan_executor.h"
+#include "execution/executors/topn_executor.h"
 #include "execution/expressions/aggregate_value_expression.h"
+#include "execution/expressions/arithmetic_expression.h"
 #include "execution/expressions/column_value_expression.h"
 #include "execution/expressions/comparison_expression.h"
+#include "execution/expressions/conjunction_expression.h"
 #include "execution/expressions/constant_value_expression.h"
+#include "execution/expressions/parameter_value_expression.h"
+#include "execution/memory_manager.h"
+#include "execution/pipeline_scheduler.h"
+#include "execution/query_profile.h"
+#include "execution/push_pipeline.h"
 #include "execution/plans/seq_scan_plan.h"
 #include "gtest/gtest.h"
+#include "optimizer/optimizer.h"
 #include "storage/b_plus_tree_test_util.h"  // NOLINT
 #include "storage/table/tuple.h"
 #include "type/value_factory.h"
@@ -47,7 +75,7 @@ class ExecutorTest : public ::testing::Test {
     ::testing::Test::SetUp();
     // For each test, we create a new DiskManager, BufferPoolManager, TransactionManager, and Catalog.
     disk_manager_ = std::make_unique<DiskManager>("executor_test.db");
-    bpm_ = std::make_unique<BufferPoolManager>(32, disk_manager_.get());
+    bpm_ = std::make_unique<BufferPoolManagerInstance>(32, disk_manager_.get());
     page_id_t page_id;
     bpm_->NewPage(&page_id);
     lock_manager_ = std::make_unique<LockManager>();
@@ -98,6 +126,12 @@ class ExecutorTest : public ::testing::Test {
     return allocated_exprs_.back().get();
   }
 
+  const AbstractExpression *MakeParameterValueExpression(const std::vector<Value> *parameters, uint32_t param_idx,
+                                                         TypeId type) {
+    allocated_exprs_.emplace_back(std::make_unique<ParameterValueExpression>(parameters, param_idx, type));
+    return allocated_exprs_.back().get();
+  }
+
   const AbstractExpression *MakeComparisonExpression(const AbstractExpression *lhs, const AbstractExpression *rhs,
                                                      ComparisonType comp_type) {
     allocated_exprs_.emplace_back(std::make_unique<ComparisonExpression>(lhs, rhs, comp_type));
@@ -169,6 +203,807 @@ TEST_F(ExecutorTest, SimpleSeqScanTest) {
   ASSERT_EQ(result_set.size(), 500);
 }
 
+// NOLINTNEXTLINE
+TEST_F(ExecutorTest, StreamingExecuteTest) {
+  // SELECT colA FROM test_1, taken in row by row without a result set
+  auto table_info = GetExecutorContext()->GetCatalog()->GetTable("test_1");
+  auto colA = MakeColumnValueExpression(table_info->schema_, 0, "colA");
+  auto *out_schema = MakeOutputSchema({{"colA", colA}});
+  SeqScanPlanNode scan_plan(out_schema, nullptr, table_info->oid_);
+  int32_t next = 0;
+  auto on_row = [&](Tuple &tuple) {
+    EXPECT_EQ(next++, tuple.GetValue(out_schema, 0).GetAs<int32_t>());
+    return true;
+  };
+  EXPECT_TRUE(GetExecutionEngine()->ExecuteStreaming(&scan_plan, on_row, GetTxn(), GetExecutorContext()));
+  EXPECT_EQ(TEST1_SIZE, next);
+
+  // a callback that has what it needs stops the query, which is not a cancellation
+  next = 0;
+  auto first_ten = [&](Tuple & /*tuple*/) { return ++next < 10; };
+  EXPECT_TRUE(GetExecutionEngine()->ExecuteStreaming(&scan_plan, first_ten, GetTxn(), GetExecutorContext()));
+  EXPECT_EQ(10, next);
+}
+
+// NOLINTNEXTLINE
+TEST_F(ExecutorTest, PreparedStatementTest) {
+  // SELECT colA, colB FROM test_1 WHERE colA = ?, prepared once and run for many values of the parameter
+  auto table_info = GetExecutorContext()->GetCatalog()->GetTable("test_1");
+  auto colA = MakeColumnValueExpression(table_info->schema_, 0, "colA");
+  auto colB = MakeColumnValueExpression(table_info->schema_, 0, "colB");
+  std::vector<Value> parameters(1);
+  auto *param = MakeParameterValueExpression(&parameters, 0, TypeId::INTEGER);
+  auto *predicate = MakeComparisonExpression(colA, param, ComparisonType::Equal);
+  auto *out_schema = MakeOutputSchema({{"colA", colA}, {"colB", colB}});
+  SeqScanPlanNode scan_plan(out_schema, predicate, table_info->oid_);
+
+  auto statement = GetExecutionEngine()->Prepare(&scan_plan, &parameters, GetExecutorContext());
+  for (int32_t a = 0; a < 20; a++) {
+    std::vector<Tuple> result_set;
+    ASSERT_TRUE(statement->Execute({ValueFactory::GetIntegerValue(a * 50)}, &result_set));
+    ASSERT_EQ(1, result_set.size());
+    EXPECT_EQ(a * 50, result_set[0].GetValue(out_schema, 0).GetAs<int32_t>());
+  }
+  size_t num_rows = 0;
+  ASSERT_TRUE(statement->ExecuteStreaming({ValueFactory::GetIntegerValue(static_cast<int32_t>(TEST1_SIZE))},
+                                          [&](Tuple & /*tuple*/) { return ++num_rows > 0; }));
+  EXPECT_EQ(0, num_rows);
+  EXPECT_THROW(statement->Execute({}, nullptr), Exception);
+
+  // an error as the rows are produced goes to the caller, as one in Init does
+  ArithmeticExpression quotient(colA, param, ArithmeticType::Divide);
+  auto *failing_predicate = MakeComparisonExpression(
+      &quotient, MakeConstantValueExpression(ValueFactory::GetIntegerValue(1)), ComparisonType::Equal);
+  SeqScanPlanNode failing_plan(out_schema, failing_predicate, table_info->oid_);
+  auto failing = GetExecutionEngine()->Prepare(&failing_plan, &parameters, GetExecutorContext());
+  std::vector<Tuple> result_set;
+  ASSERT_TRUE(failing->Execute({ValueFactory::GetIntegerValue(1)}, &result_set));
+  EXPECT_EQ(1, result_set.size());
+  EXPECT_THROW(failing->Execute({ValueFactory::GetIntegerValue(0)}, nullptr), Exception);
+}
+
+// NOLINTNEXTLINE
+TEST_F(ExecutorTest, ResultCacheTest) {
+  // SELECT colA, colB FROM cached WHERE colA < ?, run again and again in READ_COMMITTED transactions
+  Schema schema({Column("colA", TypeId::INTEGER), Column("colB", TypeId::INTEGER)});
+  TableMetadata *table_info = GetCatalog()->CreateTable(GetTxn(), "cached", schema);
+  auto insert = [&](int32_t a, bool commit) {
+    Transaction *txn = GetTxnManager()->Begin(nullptr, IsolationLevel::READ_COMMITTED);
+    RID rid;
+    Tuple tuple({ValueFactory::GetIntegerValue(a), ValueFactory::GetIntegerValue(a * 2)}, &schema);
+    ASSERT_TRUE(table_info->table_->InsertTuple(tuple, &rid, txn));
+    if (commit) {
+      GetTxnManager()->Commit(txn);
+    } else {
+      GetTxnManager()->Abort(txn);
+    }
+    delete txn;
+  };
+  for (int32_t a = 0; a < 100; a++) {
+    insert(a, true);
+  }
+  auto colA = MakeColumnValueExpression(schema, 0, "colA");
+  auto colB = MakeColumnValueExpression(schema, 0, "colB");
+  std::vector<Value> parameters(1);
+  auto *param = MakeParameterValueExpression(&parameters, 0, TypeId::INTEGER);
+  auto *predicate = MakeComparisonExpression(colA, param, ComparisonType::LessThan);
+  auto *out_schema = MakeOutputSchema({{"colA", colA}, {"colB", colB}});
+  SeqScanPlanNode scan_plan(out_schema, predicate, table_info->oid_);
+  auto run = [&](int32_t bound, IsolationLevel isolation_level = IsolationLevel::READ_COMMITTED) {
+    Transaction *txn = GetTxnManager()->Begin(nullptr, isolation_level);
+    ExecutorContext exec_ctx(txn, GetCatalog(), GetBPM(), GetTxnManager(), GetLockManager());
+    parameters[0] = ValueFactory::GetIntegerValue(bound);
+    std::vector<Tuple> result_set;
+    EXPECT_TRUE(GetExecutionEngine()->Execute(&scan_plan, &result_set, txn, &exec_ctx));
+    GetTxnManager()->Commit(txn);
+    delete txn;
+    return result_set.size();
+  };
+
+  GetExecutionEngine()->EnableResultCache(1 << 20);
+  ResultCache *cache = GetExecutionEngine()->GetResultCache();
+  EXPECT_EQ(50, run(50));
+  EXPECT_EQ(50, run(50));
+  EXPECT_EQ(60, run(60));
+  EXPECT_EQ(1, cache->GetStats().hits_);
+  EXPECT_EQ(2, cache->GetStats().inserts_);
+
+  // a commit to the table leaves the results stale, an abort too; a transaction that does not lock what it reads, or
+  // that locks it until it ends, does not use the cache
+  insert(10, true);
+  EXPECT_EQ(51, run(50));
+  EXPECT_EQ(51, run(50));
+  EXPECT_EQ(2, cache->GetStats().hits_);
+  insert(20, false);
+  EXPECT_EQ(51, run(50));
+  EXPECT_EQ(51, run(50, IsolationLevel::REPEATABLE_READ));
+  EXPECT_EQ(51, run(50, IsolationLevel::READ_UNCOMMITTED));
+  EXPECT_EQ(2, cache->GetStats().hits_);
+  EXPECT_EQ(4, cache->GetStats().inserts_);
+
+  // a transaction that wrote to the table reads its own writes, and keeps them from the cache
+  Transaction *txn = GetTxnManager()->Begin(nullptr, IsolationLevel::READ_COMMITTED);
+  ExecutorContext exec_ctx(txn, GetCatalog(), GetBPM(), GetTxnManager(), GetLockManager());
+  RID rid;
+  ASSERT_TRUE(table_info->table_->InsertTuple(
+      Tuple({ValueFactory::GetIntegerValue(30), ValueFactory::GetIntegerValue(60)}, &schema), &rid, txn));
+  std::vector<Tuple> result_set;
+  EXPECT_TRUE(GetExecutionEngine()->Execute(&scan_plan, &result_set, txn, &exec_ctx));
+  EXPECT_EQ(52, result_set.size());
+  GetTxnManager()->Abort(txn);
+  delete txn;
+  EXPECT_EQ(4, cache->GetStats().inserts_);
+
+  // the least recently used result goes to make room
+  GetExecutionEngine()->EnableResultCache(1 << 20);
+  EXPECT_EQ(61, run(60));
+  size_t capacity = GetExecutionEngine()->GetResultCache()->GetSize();
+  GetExecutionEngine()->EnableResultCache(capacity + 64);
+  cache = GetExecutionEngine()->GetResultCache();
+  EXPECT_EQ(61, run(60));
+  EXPECT_EQ(51, run(50));
+  EXPECT_EQ(1, cache->GetStats().evictions_);
+  EXPECT_LE(cache->GetSize(), capacity + 64);
+  EXPECT_EQ(51, run(50));
+  EXPECT_EQ(61, run(60));
+  EXPECT_EQ(1, cache->GetStats().hits_);
+}
+
+// NOLINTNEXTLINE
+TEST_F(ExecutorTest, IndexOnlyScanTest) {
+  // CREATE INDEX ON test_1 (colB, colA)
+  TableMetadata *table_info = GetExecutorContext()->GetCatalog()->GetTable("test_1");
+  Schema &schema = table_info->schema_;
+  std::unique_ptr<Schema> key_schema(Schema::CopySchema(&schema, {1, 0}));
+  auto *index_info = GetExecutorContext()->GetCatalog()->CreateIndex<GenericKey<8>, RID, GenericComparator<8>>(
+      GetTxn(), "index1", "test_1", schema, *key_schema, {1, 0}, 8);
+  ASSERT_EQ(index_info, GetExecutorContext()->GetCatalog()->GetIndex("index1", "test_1"));
+
+  // SELECT colA, colD FROM test_1 WHERE colB = 3, through the heap
+  auto *colA = MakeColumnValueExpression(schema, 0, "colA");
+  auto *colB = MakeColumnValueExpression(schema, 0, "colB");
+  auto *colD = MakeColumnValueExpression(schema, 0, "colD");
+  auto *const3 = MakeConstantValueExpression(ValueFactory::GetIntegerValue(3));
+  auto *predicate = MakeComparisonExpression(colB, const3, ComparisonType::Equal);
+  auto *heap_schema = MakeOutputSchema({{"colA", colA}, {"colD", colD}});
+  IndexScanPlanNode heap_plan{heap_schema, predicate, index_info->index_oid_};
+  std::vector<Tuple> heap_result;
+  GetExecutionEngine()->Execute(&heap_plan, &heap_result, GetTxn(), GetExecutorContext());
+
+  // SELECT colA FROM test_1 WHERE colB = 3, from the keys alone; the expressions refer to the key columns
+  auto *key_colA = MakeColumnValueExpression(*key_schema, 0, "colA");
+  auto *key_colB = MakeColumnValueExpression(*key_schema, 0, "colB");
+  auto *key_predicate = MakeComparisonExpression(key_colB, const3, ComparisonType::Equal);
+  auto *key_out_schema = MakeOutputSchema({{"colA", key_colA}});
+  IndexScanPlanNode index_only_plan{key_out_schema, key_predicate, index_info->index_oid_, true};
+  std::vector<Tuple> index_result;
+  GetExecutionEngine()->Execute(&index_only_plan, &index_result, GetTxn(), GetExecutorContext());
+
+  // both come out ordered by colA, the second key column
+  ASSERT_GT(heap_result.size(), 0);
+  ASSERT_EQ(heap_result.size(), index_result.size());
+  for (size_t i = 0; i < index_result.size(); i++) {
+    int32_t a = index_result[i].GetValue(key_out_schema, 0).GetAs<int32_t>();
+    EXPECT_EQ(a, heap_result[i].GetValue(heap_schema, 0).GetAs<int32_t>());
+    if (i > 0) {
+      EXPECT_LT(index_result[i - 1].GetValue(key_out_schema, 0).GetAs<int32_t>(), a);
+    }
+  }
+}
+
+// NOLINTNEXTLINE
+TEST_F(ExecutorTest, IndexScanRangeTest) {
+  // CREATE INDEX ON test_1 (colA)
+  TableMetadata *table_info = GetCatalog()->GetTable("test_1");
+  Schema &schema = table_info->schema_;
+  std::unique_ptr<Schema> key_schema(Schema::CopySchema(&schema, {0}));
+  auto *index_info = GetCatalog()->CreateIndex<GenericKey<8>, RID, GenericComparator<8>>(
+      GetTxn(), "index1", "test_1", schema, *key_schema, {0}, 8);
+  auto *colA = MakeColumnValueExpression(schema, 0, "colA");
+  auto *colB = MakeColumnValueExpression(schema, 0, "colB");
+  auto *out_schema = MakeOutputSchema({{"colA", colA}, {"colB", colB}});
+  auto scan = [&](IndexKeyRange range) {
+    IndexScanPlanNode plan{out_schema, nullptr, index_info->index_oid_, false, range};
+    std::vector<Tuple> result_set;
+    GetExecutionEngine()->Execute(&plan, &result_set, GetTxn(), GetExecutorContext());
+    std::vector<int32_t> values;
+    for (const Tuple &tuple : result_set) {
+      values.push_back(tuple.GetValue(out_schema, 0).GetAs<int32_t>());
+    }
+    return values;
+  };
+  auto range_of = [](int32_t begin, int32_t end) {
+    std::vector<int32_t> values;
+    for (int32_t i = begin; i < end; i++) {
+      values.push_back(i);
+    }
+    return values;
+  };
+
+  // 10 <= colA < 20, 990 < colA, colA <= 4 and colA = 5: the scan stops where the range does
+  auto *const10 = MakeConstantValueExpression(ValueFactory::GetIntegerValue(10));
+  auto *const20 = MakeConstantValueExpression(ValueFactory::GetIntegerValue(20));
+  auto *const990 = MakeConstantValueExpression(ValueFactory::GetIntegerValue(990));
+  EXPECT_EQ(range_of(10, 20), scan({const10, true, const20, false}));
+  EXPECT_EQ(range_of(11, 21), scan({const10, false, const20, true}));
+  EXPECT_EQ(range_of(991, TEST1_SIZE), scan({const990, false, nullptr, true}));
+  EXPECT_EQ(range_of(0, 5), scan({nullptr, true, MakeConstantValueExpression(ValueFactory::GetIntegerValue(4)), true}));
+  EXPECT_EQ(range_of(0, TEST1_SIZE), scan({}));
+  std::vector<Value> params{ValueFactory::GetIntegerValue(5)};
+  auto *param = MakeParameterValueExpression(&params, 0, TypeId::INTEGER);
+  EXPECT_EQ(range_of(5, 6), scan({param, true, param, true}));
+  params[0] = ValueFactory::GetIntegerValue(static_cast<int32_t>(TEST1_SIZE));
+  EXPECT_TRUE(scan({param, true, param, true}).empty());
+
+  // no key compares with a NULL bound, and a bound out of the range of the key type bounds nothing
+  auto *null_bound = MakeConstantValueExpression(ValueFactory::GetNullValueByType(TypeId::INTEGER));
+  EXPECT_TRUE(scan({null_bound, true, const20, true}).empty());
+  auto *huge = MakeConstantValueExpression(ValueFactory::GetBigIntValue(int64_t{1} << 40));
+  EXPECT_EQ(range_of(990, TEST1_SIZE), scan({MakeConstantValueExpression(ValueFactory::GetBigIntValue(990)), true,
+                                             huge, false}));
+}
+
+// NOLINTNEXTLINE
+TEST_F(ExecutorTest, ZoneMapSeqScanTest) {
+  // colA of test_1 is serial, so the zones of its pages do not overlap
+  TableMetadata *table_info = GetCatalog()->GetTable("test_1");
+  GetCatalog()->CreateZoneMap(GetTxn(), "test_1", {0});
+  Schema &schema = table_info->schema_;
+  auto *colA = MakeColumnValueExpression(schema, 0, "colA");
+  auto *colB = MakeColumnValueExpression(schema, 0, "colB");
+  auto *out_schema = MakeOutputSchema({{"colA", colA}, {"colB", colB}});
+
+  // SELECT colA, colB FROM test_1 WHERE colA >= 900, and WHERE 500 > colA
+  auto *const900 = MakeConstantValueExpression(ValueFactory::GetIntegerValue(900));
+  auto *const500 = MakeConstantValueExpression(ValueFactory::GetIntegerValue(500));
+  SeqScanPlanNode plan1{out_schema, MakeComparisonExpression(colA, const900, ComparisonType::GreaterThanOrEqual),
+                        table_info->oid_};
+  SeqScanPlanNode plan2{out_schema, MakeComparisonExpression(const500, colA, ComparisonType::GreaterThan),
+                        table_info->oid_};
+  std::vector<Tuple> result_set;
+  GetExecutionEngine()->Execute(&plan1, &result_set, GetTxn(), GetExecutorContext());
+  ASSERT_EQ(result_set.size(), 100);
+  for (size_t i = 0; i < result_set.size(); i++) {
+    EXPECT_EQ(result_set[i].GetValue(out_schema, 0).GetAs<int32_t>(), 900 + static_cast<int32_t>(i));
+  }
+  result_set.clear();
+  GetExecutionEngine()->Execute(&plan2, &result_set, GetTxn(), GetExecutorContext());
+  ASSERT_EQ(result_set.size(), 500);
+  for (size_t i = 0; i < result_set.size(); i++) {
+    EXPECT_EQ(result_set[i].GetValue(out_schema, 0).GetAs<int32_t>(), static_cast<int32_t>(i));
+  }
+}
+
+// NOLINTNEXTLINE
+TEST_F(ExecutorTest, PaxSeqScanTest) {
+  // CREATE TABLE pax_table (colA INT, colB INT, colC VARCHAR, colD INT) with the PAX layout
+  Schema schema({Column("colA", TypeId::INTEGER), Column("colB", TypeId::INTEGER), Column("colC", TypeId::VARCHAR, 16),
+                 Column("colD", TypeId::INTEGER)});
+  auto table_info = GetCatalog()->CreateTable(GetTxn(), "pax_table", schema, TableLayout::PAX);
+  std::vector<std::vector<Value>> raw_vals;
+  for (int32_t i = 0; i < 1000; i++) {
+    raw_vals.push_back({ValueFactory::GetIntegerValue(i), ValueFactory::GetIntegerValue(2 * i),
+                        ValueFactory::GetVarcharValue("row " + std::to_string(i)), ValueFactory::GetIntegerValue(-i)});
+  }
+  InsertPlanNode insert_plan{std::move(raw_vals), table_info->oid_};
+  GetExecutionEngine()->Execute(&insert_plan, nullptr, GetTxn(), GetExecutorContext());
+
+  // SELECT colA, colB FROM pax_table WHERE colA < 500
+  auto *colA = MakeColumnValueExpression(table_info->schema_, 0, "colA");
+  auto *colB = MakeColumnValueExpression(table_info->schema_, 0, "colB");
+  auto *const500 = MakeConstantValueExpression(ValueFactory::GetIntegerValue(500));
+  auto *predicate = MakeComparisonExpression(colA, const500, ComparisonType::LessThan);
+  auto *out_schema = MakeOutputSchema({{"colA", colA}, {"colB", colB}});
+  SeqScanPlanNode plan{out_schema, predicate, table_info->oid_};
+  std::vector<Tuple> result_set;
+  GetExecutionEngine()->Execute(&plan, &result_set, GetTxn(), GetExecutorContext());
+
+  // the rows come out in insert order, as tuples of just the columns of the output schema
+  ASSERT_EQ(result_set.size(), 500);
+  for (int32_t i = 0; i < 500; i++) {
+    const Tuple &tuple = result_set[i];
+    EXPECT_EQ(tuple.GetValue(out_schema, 0).GetAs<int32_t>(), i);
+    EXPECT_EQ(tuple.GetValue(out_schema, 1).GetAs<int32_t>(), 2 * i);
+    EXPECT_EQ(tuple.GetLength(), out_schema->GetLength() + Tuple::NullBitmapSize(out_schema));
+
+    // the whole row is still there
+    Tuple row;
+    ASSERT_TRUE(table_info->pax_table_->GetTuple(tuple.GetRid(), &row, GetTxn()));
+    EXPECT_EQ(row.GetValue(&table_info->schema_, 2).ToString(), "row " + std::to_string(i));
+    EXPECT_EQ(row.GetValue(&table_info->schema_, 3).GetAs<int32_t>(), -i);
+  }
+}
+
+// NOLINTNEXTLINE
+TEST_F(ExecutorTest, InsertAcrossCreateIndexTest) {
+  // An insert that started before CREATE INDEX, and whose index entries are flushed after it, still fills the index
+  auto *catalog = GetExecutorContext()->GetCatalog();
+  Schema schema({Column("colA", TypeId::INTEGER), Column("colB", TypeId::INTEGER)});
+  auto table_info = catalog->CreateTable(GetTxn(), "late_index_table", schema);
+  std::vector<std::vector<Value>> raw_vals;
+  for (int32_t i = 0; i < 500; i++) {
+    raw_vals.push_back({ValueFactory::GetIntegerValue(i), ValueFactory::GetIntegerValue(-i)});
+  }
+  InsertPlanNode insert_plan{std::move(raw_vals), table_info->oid_};
+  auto executor = ExecutorFactory::CreateExecutor(GetExecutorContext(), &insert_plan);
+  executor->Init();
+  Tuple tuple;
+  RID rid;
+  ASSERT_TRUE(executor->Next(&tuple, &rid));
+
+  std::unique_ptr<Schema> key_schema(Schema::CopySchema(&table_info->schema_, {0}));
+  auto *index_info = catalog->CreateIndex<GenericKey<8>, RID, GenericComparator<8>>(
+      GetTxn(), "late_index", "late_index_table", table_info->schema_, *key_schema, {0}, 8);
+  while (executor->Next(&tuple, &rid)) {
+  }
+
+  for (int32_t i = 0; i < 500; i++) {
+    std::vector<RID> rids;
+    index_info->index_->ScanKey(Tuple({ValueFactory::GetIntegerValue(i)}, key_schema.get()), &rids, GetTxn());
+    ASSERT_EQ(rids.size(), 1) << "key " << i;
+    Tuple row;
+    ASSERT_TRUE(table_info->table_->GetTuple(rids[0], &row, GetTxn()));
+    EXPECT_EQ(row.GetValue(&table_info->schema_, 1).GetAs<int32_t>(), -i);
+  }
+}
+
+// NOLINTNEXTLINE
+TEST_F(ExecutorTest, MemoryTableTest) {
+  // CREATE TABLE memory_table (colA INT, colB VARCHAR), kept in memory
+  auto *catalog = GetExecutorContext()->GetCatalog();
+  Schema schema({Column("colA", TypeId::INTEGER), Column("colB", TypeId::VARCHAR, 16)});
+  auto table_info = catalog->CreateTable(GetTxn(), "memory_table", schema, TableLayout::MEMORY);
+  std::vector<std::vector<Value>> raw_vals;
+  for (int32_t i = 0; i < 100; i++) {
+    raw_vals.push_back({ValueFactory::GetIntegerValue(i), ValueFactory::GetVarcharValue("row " + std::to_string(i))});
+  }
+  InsertPlanNode insert_plan{std::move(raw_vals), table_info->oid_};
+  GetExecutionEngine()->Execute(&insert_plan, nullptr, GetTxn(), GetExecutorContext());
+  EXPECT_EQ(table_info->memory_table_->GetRowCount(), 100);
+
+  // SELECT colA, colB FROM memory_table WHERE colA < 50, in insert order
+  auto *colA = MakeColumnValueExpression(table_info->schema_, 0, "colA");
+  auto *colB = MakeColumnValueExpression(table_info->schema_, 0, "colB");
+  auto *const50 = MakeConstantValueExpression(ValueFactory::GetIntegerValue(50));
+  auto *predicate = MakeComparisonExpression(colA, const50, ComparisonType::LessThan);
+  auto *out_schema = MakeOutputSchema({{"colA", colA}, {"colB", colB}});
+  SeqScanPlanNode scan_plan{out_schema, predicate, table_info->oid_};
+  std::vector<Tuple> result_set;
+  GetExecutionEngine()->Execute(&scan_plan, &result_set, GetTxn(), GetExecutorContext());
+  ASSERT_EQ(result_set.size(), 50);
+  for (int32_t i = 0; i < 50; i++) {
+    EXPECT_EQ(result_set[i].GetValue(out_schema, 0).GetAs<int32_t>(), i);
+    EXPECT_EQ(result_set[i].GetValue(out_schema, 1).ToString(), "row " + std::to_string(i));
+  }
+
+  // SELECT test_1.colA, memory_table.colB FROM test_1 JOIN memory_table ON test_1.colA = memory_table.colA, through an
+  // index over the rows in memory
+  std::unique_ptr<Schema> key_schema(Schema::CopySchema(&table_info->schema_, {0}));
+  catalog->CreateIndex<GenericKey<8>, RID, GenericComparator<8>>(GetTxn(), "memory_index", "memory_table",
+                                                                  table_info->schema_, *key_schema, {0}, 8);
+  auto table1_info = catalog->GetTable("test_1");
+  auto *outer_colA = MakeColumnValueExpression(table1_info->schema_, 0, "colA");
+  auto *outer_schema = MakeOutputSchema({{"colA", outer_colA}});
+  SeqScanPlanNode outer_plan{outer_schema, nullptr, table1_info->oid_};
+  auto *join_outer_colA = MakeColumnValueExpression(*outer_schema, 0, "colA");
+  auto *inner_colA = MakeColumnValueExpression(table_info->schema_, 1, "colA");
+  auto *inner_colB = MakeColumnValueExpression(table_info->schema_, 1, "colB");
+  auto *join_schema = MakeOutputSchema({{"colA", join_outer_colA}, {"colB", inner_colB}});
+  auto *join_predicate = MakeComparisonExpression(join_outer_colA, inner_colA, ComparisonType::Equal);
+  NestedIndexJoinPlanNode join_plan(join_schema, {&outer_plan}, join_predicate, table_info->oid_, "memory_index",
+                                    outer_schema, &table_info->schema_);
+  result_set.clear();
+  GetExecutionEngine()->Execute(&join_plan, &result_set, GetTxn(), GetExecutorContext());
+  ASSERT_EQ(result_set.size(), 100);
+  for (const Tuple &tuple : result_set) {
+    EXPECT_EQ(tuple.GetValue(join_schema, 1).ToString(),
+              "row " + std::to_string(tuple.GetValue(join_schema, 0).GetAs<int32_t>()));
+  }
+
+  // DELETE FROM memory_table WHERE colA < 50
+  DeletePlanNode delete_plan{&scan_plan, table_info->oid_};
+  GetExecutionEngine()->Execute(&delete_plan, nullptr, GetTxn(), GetExecutorContext());
+  SeqScanPlanNode full_scan_plan{out_schema, nullptr, table_info->oid_};
+  result_set.clear();
+  GetExecutionEngine()->Execute(&full_scan_plan, &result_set, GetTxn(), GetExecutorContext());
+  ASSERT_EQ(result_set.size(), 50);
+  EXPECT_EQ(result_set[0].GetValue(out_schema, 0).GetAs<int32_t>(), 50);
+  result_set.clear();
+  GetExecutionEngine()->Execute(&join_plan, &result_set, GetTxn(), GetExecutorContext());
+  EXPECT_EQ(result_set.size(), 50);
+}
+
+// NOLINTNEXTLINE
+TEST_F(ExecutorTest, PartitionedTableTest) {
+  // CREATE TABLE events (ts INT, val INT), partitioned by the ranges of ts below 100, 200, 300, and from 300 on
+  auto *catalog = GetExecutorContext()->GetCatalog();
+  Schema schema({Column("ts", TypeId::INTEGER), Column("val", TypeId::INTEGER)});
+  auto table_info = catalog->CreatePartitionedTable(
+      GetTxn(), "events", schema,
+      PartitionScheme::Range(0, {ValueFactory::GetIntegerValue(100), ValueFactory::GetIntegerValue(200),
+                                 ValueFactory::GetIntegerValue(300)}));
+  std::vector<std::vector<Value>> raw_vals;
+  for (int32_t i = 0; i < 400; i++) {
+    raw_vals.push_back({ValueFactory::GetIntegerValue(i), ValueFactory::GetIntegerValue(i % 10)});
+  }
+  InsertPlanNode insert_plan{std::move(raw_vals), table_info->oid_};
+  GetExecutionEngine()->Execute(&insert_plan, nullptr, GetTxn(), GetExecutorContext());
+  PartitionedTable *partitions = table_info->partitions_.get();
+  auto count_rows = [&](size_t partition) {
+    size_t rows = 0;
+    TableHeap *heap = partitions->GetPartition(partition);
+    for (auto iter = heap->Begin(GetTxn()); iter != heap->End(); ++iter) {
+      rows++;
+    }
+    return rows;
+  };
+  ASSERT_EQ(partitions->GetPartitionCount(), 4);
+  for (size_t partition = 0; partition < 4; partition++) {
+    EXPECT_EQ(count_rows(partition), 100);
+  }
+  Schema *key_schema = ParseCreateStatement("a bigint");
+  auto index_info = catalog->CreateIndex<GenericKey<8>, RID, GenericComparator<8>>(GetTxn(), "ts_index", "events",
+                                                                                   table_info->schema_, *key_schema,
+                                                                                   {0}, 8);
+  auto lookup = [&](int32_t ts) {
+    std::vector<RID> rids;
+    index_info->index_->ScanKey(Tuple({ValueFactory::GetIntegerValue(ts)}, key_schema), &rids, GetTxn());
+    return rids;
+  };
+
+  // SELECT ts, val FROM events WHERE ts >= 250 reads the last two partitions only
+  auto *ts = MakeColumnValueExpression(table_info->schema_, 0, "ts");
+  auto *val = MakeColumnValueExpression(table_info->schema_, 0, "val");
+  auto *out_schema = MakeOutputSchema({{"ts", ts}, {"val", val}});
+  auto *const250 = MakeConstantValueExpression(ValueFactory::GetIntegerValue(250));
+  auto *recent = MakeComparisonExpression(ts, const250, ComparisonType::GreaterThanOrEqual);
+  SeqScanPlanNode recent_plan{out_schema, recent, table_info->oid_};
+  EXPECT_EQ(SeqScanExecutor::ScannedHeaps(table_info, recent).size(), 2);
+  std::vector<Tuple> result_set;
+  GetExecutionEngine()->Execute(&recent_plan, &result_set, GetTxn(), GetExecutorContext());
+  ASSERT_EQ(result_set.size(), 150);
+  for (const Tuple &tuple : result_set) {
+    EXPECT_GE(tuple.GetValue(out_schema, 0).GetAs<int32_t>(), 250);
+  }
+
+  // SELECT val, count(ts) FROM events WHERE ts >= 250 GROUP BY val, a worker per partition
+  const AbstractExpression *scan_ts = MakeColumnValueExpression(*out_schema, 0, "ts");
+  const AbstractExpression *scan_val = MakeColumnValueExpression(*out_schema, 0, "val");
+  const Schema *agg_schema = MakeOutputSchema(
+      {{"val", MakeAggregateValueExpression(true, 0)}, {"count", MakeAggregateValueExpression(false, 0)}});
+  auto count_by_val = [&](size_t num_threads) {
+    AggregationPlanNode agg_plan(agg_schema, &recent_plan, nullptr, {scan_val}, {scan_ts},
+                                 {AggregationType::CountAggregate}, num_threads);
+    std::vector<Tuple> groups;
+    GetExecutionEngine()->Execute(&agg_plan, &groups, GetTxn(), GetExecutorContext());
+    std::map<int32_t, int32_t> counts;
+    for (const Tuple &tuple : groups) {
+      counts[tuple.GetValue(agg_schema, 0).GetAs<int32_t>()] = tuple.GetValue(agg_schema, 1).GetAs<int32_t>();
+    }
+    return counts;
+  };
+  auto counts = count_by_val(1);
+  ASSERT_EQ(counts.size(), 10);
+  EXPECT_EQ(counts[0], 15);
+  EXPECT_EQ(counts, count_by_val(4));
+
+  // UPDATE events SET ts = ts + 1000 WHERE ts < 50 moves the rows to the last partition, and the index follows them
+  auto *const50 = MakeConstantValueExpression(ValueFactory::GetIntegerValue(50));
+  SeqScanPlanNode old_plan{out_schema, MakeComparisonExpression(ts, const50, ComparisonType::LessThan),
+                           table_info->oid_};
+  std::unordered_map<uint32_t, UpdateInfo> update_attrs;
+  update_attrs.emplace(0, UpdateInfo(UpdateType::Add, 1000));
+  UpdatePlanNode update_plan{&old_plan, table_info->oid_, update_attrs};
+  GetExecutionEngine()->Execute(&update_plan, nullptr, GetTxn(), GetExecutorContext());
+  EXPECT_EQ(count_rows(0), 50);
+  EXPECT_EQ(count_rows(3), 150);
+  EXPECT_TRUE(lookup(20).empty());
+  std::vector<RID> rids = lookup(1020);
+  ASSERT_EQ(rids.size(), 1);
+  Tuple indexed_tuple;
+  ASSERT_TRUE(table_info->GetTuple(rids[0], &indexed_tuple, GetTxn()));
+  EXPECT_EQ(indexed_tuple.GetValue(&table_info->schema_, 0).GetAs<int32_t>(), 1020);
+
+  // the first range is dropped as a whole, with the entries of its rows, and takes the rows of its keys again
+  catalog->DropPartition(GetTxn(), "events", 0);
+  EXPECT_EQ(count_rows(0), 0);
+  EXPECT_TRUE(lookup(75).empty());
+  EXPECT_EQ(lookup(175).size(), 1);
+  SeqScanPlanNode full_plan{out_schema, nullptr, table_info->oid_};
+  result_set.clear();
+  GetExecutionEngine()->Execute(&full_plan, &result_set, GetTxn(), GetExecutorContext());
+  EXPECT_EQ(result_set.size(), 350);
+  std::vector<std::vector<Value>> late_vals{{ValueFactory::GetIntegerValue(5), ValueFactory::GetIntegerValue(5)}};
+  InsertPlanNode late_insert_plan{std::move(late_vals), table_info->oid_};
+  GetExecutionEngine()->Execute(&late_insert_plan, nullptr, GetTxn(), GetExecutorContext());
+  EXPECT_EQ(count_rows(0), 1);
+
+  // DELETE FROM events WHERE ts >= 250 deletes from the heap of each row's partition
+  DeletePlanNode delete_plan{&recent_plan, table_info->oid_};
+  GetExecutionEngine()->Execute(&delete_plan, nullptr, GetTxn(), GetExecutorContext());
+  EXPECT_EQ(count_rows(2), 50);
+  EXPECT_EQ(count_rows(3), 0);
+  EXPECT_TRUE(lookup(300).empty());
+  EXPECT_TRUE(lookup(1020).empty());
+
+  // a table partitioned by the hash of its key reads the one partition of an equal key
+  auto hashed_info = catalog->CreatePartitionedTable(GetTxn(), "hashed", schema, PartitionScheme::Hash(0, 4));
+  raw_vals.clear();
+  for (int32_t i = 0; i < 200; i++) {
+    raw_vals.push_back({ValueFactory::GetIntegerValue(i), ValueFactory::GetIntegerValue(i % 10)});
+  }
+  InsertPlanNode hashed_insert_plan{std::move(raw_vals), hashed_info->oid_};
+  GetExecutionEngine()->Execute(&hashed_insert_plan, nullptr, GetTxn(), GetExecutorContext());
+  auto *const42 = MakeConstantValueExpression(ValueFactory::GetIntegerValue(42));
+  auto *equal42 = MakeComparisonExpression(ts, const42, ComparisonType::Equal);
+  EXPECT_EQ(SeqScanExecutor::ScannedHeaps(hashed_info, equal42).size(), 1);
+  EXPECT_EQ(SeqScanExecutor::ScannedHeaps(hashed_info, recent).size(), 4);
+  SeqScanPlanNode hashed_plan{out_schema, equal42, hashed_info->oid_};
+  result_set.clear();
+  GetExecutionEngine()->Execute(&hashed_plan, &result_set, GetTxn(), GetExecutorContext());
+  ASSERT_EQ(result_set.size(), 1);
+  EXPECT_EQ(result_set[0].GetValue(out_schema, 0).GetAs<int32_t>(), 42);
+  delete key_schema;
+}
+
+// NOLINTNEXTLINE
+TEST_F(ExecutorTest, ClusteredTableTest) {
+  // CREATE TABLE accounts (id INT PRIMARY KEY, name VARCHAR), kept in the leaves of a B+ tree by id
+  auto *catalog = GetExecutorContext()->GetCatalog();
+  Schema schema({Column("id", TypeId::INTEGER), Column("name", TypeId::VARCHAR, 32)});
+  auto table_info = catalog->CreateClusteredTable(GetTxn(), "accounts", schema, 0);
+  std::vector<std::vector<Value>> raw_vals;
+  // out of key order, over enough leaves to split them
+  for (int32_t i = 0; i < 1000; i++) {
+    int32_t id = i * 37 % 1000;
+    raw_vals.push_back(
+        {ValueFactory::GetIntegerValue(id), ValueFactory::GetVarcharValue("account " + std::to_string(id))});
+  }
+  InsertPlanNode insert_plan{std::move(raw_vals), table_info->oid_};
+  ASSERT_TRUE(GetExecutionEngine()->Execute(&insert_plan, nullptr, GetTxn(), GetExecutorContext()));
+  // a key that is taken is not inserted again
+  InsertPlanNode duplicate_plan{{{ValueFactory::GetIntegerValue(7), ValueFactory::GetVarcharValue("again")}},
+                                table_info->oid_};
+  GetExecutionEngine()->Execute(&duplicate_plan, nullptr, GetTxn(), GetExecutorContext());
+
+  // SELECT id, name FROM accounts, in key order
+  auto *id = MakeColumnValueExpression(table_info->schema_, 0, "id");
+  auto *name = MakeColumnValueExpression(table_info->schema_, 0, "name");
+  auto *out_schema = MakeOutputSchema({{"id", id}, {"name", name}});
+  SeqScanPlanNode full_scan_plan{out_schema, nullptr, table_info->oid_};
+  std::vector<Tuple> result_set;
+  GetExecutionEngine()->Execute(&full_scan_plan, &result_set, GetTxn(), GetExecutorContext());
+  ASSERT_EQ(result_set.size(), 1000);
+  for (int32_t i = 0; i < 1000; i++) {
+    EXPECT_EQ(result_set[i].GetValue(out_schema, 0).GetAs<int32_t>(), i);
+    EXPECT_EQ(result_set[i].GetValue(out_schema, 1).ToString(), "account " + std::to_string(i));
+  }
+
+  // SELECT id, name FROM accounts WHERE id = 777, and WHERE id >= 990, which read just the leaves of their keys
+  auto *const777 = MakeConstantValueExpression(ValueFactory::GetIntegerValue(777));
+  SeqScanPlanNode point_plan{out_schema, MakeComparisonExpression(id, const777, ComparisonType::Equal),
+                             table_info->oid_};
+  result_set.clear();
+  GetExecutionEngine()->Execute(&point_plan, &result_set, GetTxn(), GetExecutorContext());
+  ASSERT_EQ(result_set.size(), 1);
+  EXPECT_EQ(result_set[0].GetValue(out_schema, 1).ToString(), "account 777");
+  auto *const990 = MakeConstantValueExpression(ValueFactory::GetIntegerValue(990));
+  SeqScanPlanNode range_plan{out_schema, MakeComparisonExpression(id, const990, ComparisonType::GreaterThanOrEqual),
+                             table_info->oid_};
+  result_set.clear();
+  GetExecutionEngine()->Execute(&range_plan, &result_set, GetTxn(), GetExecutorContext());
+  ASSERT_EQ(result_set.size(), 10);
+  EXPECT_EQ(result_set[0].GetValue(out_schema, 0).GetAs<int32_t>(), 990);
+
+  // a secondary index on name points at the rows by their keys
+  Schema *key_schema = ParseCreateStatement("name varchar(32)");
+  auto index_info = catalog->CreateIndex<GenericKey<64>, RID, GenericComparator<64>>(
+      GetTxn(), "name_index", "accounts", table_info->schema_, *key_schema, {1}, 64);
+  auto lookup = [&](const std::string &key) {
+    std::vector<RID> rids;
+    index_info->index_->ScanKey(Tuple({ValueFactory::GetVarcharValue(key)}, key_schema), &rids, GetTxn());
+    Tuple tuple;
+    return rids.size() == 1 && table_info->GetTuple(rids[0], &tuple, GetTxn())
+               ? tuple.GetValue(&table_info->schema_, 0).GetAs<int32_t>()
+               : -1;
+  };
+  EXPECT_EQ(lookup("account 123"), 123);
+
+  // UPDATE accounts SET id = id + 5000 WHERE id < 100, which moves the rows to their new keys
+  auto *const100 = MakeConstantValueExpression(ValueFactory::GetIntegerValue(100));
+  SeqScanPlanNode low_plan{out_schema, MakeComparisonExpression(id, const100, ComparisonType::LessThan),
+                           table_info->oid_};
+  std::unordered_map<uint32_t, UpdateInfo> update_attrs;
+  update_attrs.emplace(0, UpdateInfo(UpdateType::Add, 5000));
+  UpdatePlanNode update_plan{&low_plan, table_info->oid_, update_attrs};
+  ASSERT_TRUE(GetExecutionEngine()->Execute(&update_plan, nullptr, GetTxn(), GetExecutorContext()));
+  EXPECT_EQ(lookup("account 42"), 5042);
+  result_set.clear();
+  GetExecutionEngine()->Execute(&full_scan_plan, &result_set, GetTxn(), GetExecutorContext());
+  ASSERT_EQ(result_set.size(), 1000);
+  EXPECT_EQ(result_set.front().GetValue(out_schema, 0).GetAs<int32_t>(), 100);
+  EXPECT_EQ(result_set.back().GetValue(out_schema, 0).GetAs<int32_t>(), 5099);
+
+  // DELETE FROM accounts WHERE id >= 990, the moved rows included
+  DeletePlanNode delete_plan{&range_plan, table_info->oid_};
+  ASSERT_TRUE(GetExecutionEngine()->Execute(&delete_plan, nullptr, GetTxn(), GetExecutorContext()));
+  result_set.clear();
+  GetExecutionEngine()->Execute(&full_scan_plan, &result_set, GetTxn(), GetExecutorContext());
+  EXPECT_EQ(result_set.size(), 890);
+  EXPECT_EQ(result_set.back().GetValue(out_schema, 0).GetAs<int32_t>(), 989);
+  EXPECT_EQ(lookup("account 995"), -1);
+  delete key_schema;
+}
+
+// NOLINTNEXTLINE
+TEST_F(ExecutorTest, BitmapScanTest) {
+  // CREATE TABLE orders (id INT, region VARCHAR, status INT), with bitmap indexes on region and status
+  auto *catalog = GetExecutorContext()->GetCatalog();
+  Schema schema(
+      {Column("id", TypeId::INTEGER), Column("region", TypeId::VARCHAR, 8), Column("status", TypeId::INTEGER)});
+  auto table_info = catalog->CreateTable(GetTxn(), "orders", schema);
+  const std::vector<std::string> regions{"EU", "US", "APAC", "LATAM"};
+  std::vector<std::vector<Value>> raw_vals;
+  for (int32_t i = 0; i < 1000; i++) {
+    raw_vals.push_back({ValueFactory::GetIntegerValue(i), ValueFactory::GetVarcharValue(regions[i % 4]),
+                        ValueFactory::GetIntegerValue(i % 3)});
+  }
+  InsertPlanNode insert_plan{std::move(raw_vals), table_info->oid_};
+  GetExecutionEngine()->Execute(&insert_plan, nullptr, GetTxn(), GetExecutorContext());
+  std::unique_ptr<Schema> region_schema(Schema::CopySchema(&table_info->schema_, {1}));
+  std::unique_ptr<Schema> status_schema(Schema::CopySchema(&table_info->schema_, {2}));
+  auto *region_index = catalog->CreateBitmapIndex(GetTxn(), "region_index", "orders", table_info->schema_,
+                                                  *region_schema, {1});
+  auto *status_index = catalog->CreateBitmapIndex(GetTxn(), "status_index", "orders", table_info->schema_,
+                                                  *status_schema, {2});
+  EXPECT_EQ(dynamic_cast<BitmapIndex *>(region_index->index_.get())->GetKeyCount(), 4);
+
+  // SELECT id FROM orders WHERE region IN ('EU', 'US') AND status = 1 AND id < 500
+  auto *id = MakeColumnValueExpression(table_info->schema_, 0, "id");
+  auto *out_schema = MakeOutputSchema({{"id", id}});
+  auto *const500 = MakeConstantValueExpression(ValueFactory::GetIntegerValue(500));
+  auto *predicate = MakeComparisonExpression(id, const500, ComparisonType::LessThan);
+  BitmapScanPlanNode scan_plan{
+      out_schema,
+      predicate,
+      table_info->oid_,
+      {{region_index->index_oid_, {{ValueFactory::GetVarcharValue("EU")}, {ValueFactory::GetVarcharValue("US")}}},
+       {status_index->index_oid_, {{ValueFactory::GetIntegerValue(1)}}}}};
+  auto expected = [&](int32_t limit) {
+    std::vector<int32_t> ids;
+    for (int32_t i = 0; i < limit; i++) {
+      if (i % 4 < 2 && i % 3 == 1) {
+        ids.push_back(i);
+      }
+    }
+    return ids;
+  };
+  std::vector<Tuple> result_set;
+  GetExecutionEngine()->Execute(&scan_plan, &result_set, GetTxn(), GetExecutorContext());
+  std::vector<int32_t> ids;
+  for (const Tuple &tuple : result_set) {
+    ids.push_back(tuple.GetValue(out_schema, 0).GetAs<int32_t>());
+  }
+  // the rows come in page order, which is that of the inserts
+  EXPECT_EQ(ids, expected(500));
+
+  // DELETE FROM orders WHERE id < 500, whose rows leave the bitmaps
+  auto *region = MakeColumnValueExpression(table_info->schema_, 0, "region");
+  auto *status = MakeColumnValueExpression(table_info->schema_, 0, "status");
+  auto *row_schema = MakeOutputSchema({{"id", id}, {"region", region}, {"status", status}});
+  SeqScanPlanNode delete_scan_plan{row_schema, predicate, table_info->oid_};
+  DeletePlanNode delete_plan{&delete_scan_plan, table_info->oid_};
+  GetExecutionEngine()->Execute(&delete_plan, nullptr, GetTxn(), GetExecutorContext());
+  BitmapScanPlanNode eu_plan{out_schema, nullptr, table_info->oid_,
+                             {{region_index->index_oid_, {{ValueFactory::GetVarcharValue("EU")}}}}};
+  result_set.clear();
+  GetExecutionEngine()->Execute(&eu_plan, &result_set, GetTxn(), GetExecutorContext());
+  ASSERT_EQ(result_set.size(), 125);
+  EXPECT_EQ(result_set.front().GetValue(out_schema, 0).GetAs<int32_t>(), 500);
+
+  // under REPEATABLE_READ, the scan holds a shared lock of the table, as a sequential scan does
+  ASSERT_EQ(IsolationLevel::REPEATABLE_READ, GetTxn()->GetIsolationLevel());
+  enable_logging = true;
+  auto executor = ExecutorFactory::CreateExecutor(GetExecutorContext(), &eu_plan);
+  executor->Init();
+  enable_logging = false;
+  EXPECT_EQ(LockMode::SHARED, GetTxn()->GetTableLockSet()->at(table_info->oid_));
+}
+
+// NOLINTNEXTLINE
+TEST_F(ExecutorTest, ToastSeqScanTest) {
+  // CREATE TABLE toast_table (colA INT, colB VARCHAR), with values of colB larger than a page
+  Schema schema({Column("colA", TypeId::INTEGER), Column("colB", TypeId::VARCHAR, 16)});
+  auto table_info = GetCatalog()->CreateTable(GetTxn(), "toast_table", schema);
+  auto payload = [](int32_t i) { return std::string(i % 2 == 0 ? 3 * PAGE_SIZE : 10, 'a' + i); };
+  std::vector<std::vector<Value>> raw_vals;
+  for (int32_t i = 0; i < 20; i++) {
+    raw_vals.push_back({ValueFactory::GetIntegerValue(i), ValueFactory::GetVarcharValue(payload(i))});
+  }
+  InsertPlanNode insert_plan{std::move(raw_vals), table_info->oid_};
+  GetExecutionEngine()->Execute(&insert_plan, nullptr, GetTxn(), GetExecutorContext());
+
+  // SELECT colA FROM toast_table WHERE colA < 10 leaves the toasted values alone
+  auto *colA = MakeColumnValueExpression(table_info->schema_, 0, "colA");
+  auto *colB = MakeColumnValueExpression(table_info->schema_, 0, "colB");
+  auto *const10 = MakeConstantValueExpression(ValueFactory::GetIntegerValue(10));
+  auto *predicate = MakeComparisonExpression(colA, const10, ComparisonType::LessThan);
+  auto *colA_schema = MakeOutputSchema({{"colA", colA}});
+  SeqScanPlanNode plan{colA_schema, predicate, table_info->oid_};
+  std::vector<Tuple> result_set;
+  GetExecutionEngine()->Execute(&plan, &result_set, GetTxn(), GetExecutorContext());
+  ASSERT_EQ(result_set.size(), 10);
+  for (int32_t i = 0; i < 10; i++) {
+    EXPECT_EQ(result_set[i].GetValue(colA_schema, 0).GetAs<int32_t>(), i);
+    // of colA alone, which leaves the small values of colB behind too
+    EXPECT_EQ(result_set[i].GetLength(), colA_schema->GetLength() + Tuple::NullBitmapSize(colA_schema));
+  }
+
+  // SELECT colA, colB FROM toast_table reads them back in
+  SeqScanPlanNode full_plan{MakeOutputSchema({{"colA", colA}, {"colB", colB}}), nullptr, table_info->oid_};
+  result_set.clear();
+  GetExecutionEngine()->Execute(&full_plan, &result_set, GetTxn(), GetExecutorContext());
+  ASSERT_EQ(result_set.size(), 20);
+  for (int32_t i = 0; i < 20; i++) {
+    EXPECT_EQ(result_set[i].GetValue(&table_info->schema_, 0).GetAs<int32_t>(), i);
+    EXPECT_EQ(result_set[i].GetValue(&table_info->schema_, 1).ToString(), payload(i));
+  }
+}
+
+// NOLINTNEXTLINE
+TEST_F(ExecutorTest, SampleScanTest) {
+  // SELECT colA FROM test_1 TABLESAMPLE method (fraction) REPEATABLE (seed) WHERE predicate
+  auto table_info = GetCatalog()->GetTable("test_1");
+  auto *colA = MakeColumnValueExpression(table_info->schema_, 0, "colA");
+  auto *out_schema = MakeOutputSchema({{"colA", colA}});
+  auto run = [&](SampleMethod method, double fraction, uint64_t seed, const AbstractExpression *predicate) {
+    SampleScanPlanNode plan{out_schema, predicate, table_info->oid_, method, fraction, seed};
+    std::vector<Tuple> result_set;
+    GetExecutionEngine()->Execute(&plan, &result_set, GetTxn(), GetExecutorContext());
+    std::vector<RID> rids;
+    for (const auto &tuple : result_set) {
+      rids.push_back(tuple.GetRid());
+    }
+    return rids;
+  };
+
+  for (SampleMethod method : {SampleMethod::SYSTEM, SampleMethod::BERNOULLI}) {
+    EXPECT_EQ(TEST1_SIZE, run(method, 1, 0, nullptr).size());
+    EXPECT_TRUE(run(method, 0, 0, nullptr).empty());
+  }
+
+  // rows are picked on their own, the same ones for the same seed, whatever the predicate
+  auto rows = run(SampleMethod::BERNOULLI, 0.3, 1, nullptr);
+  EXPECT_NEAR(0.3 * TEST1_SIZE, rows.size(), 0.06 * TEST1_SIZE);
+  EXPECT_EQ(rows, run(SampleMethod::BERNOULLI, 0.3, 1, nullptr));
+  EXPECT_NE(rows, run(SampleMethod::BERNOULLI, 0.3, 2, nullptr));
+  auto *predicate = MakeComparisonExpression(colA, MakeConstantValueExpression(ValueFactory::GetIntegerValue(500)),
+                                             ComparisonType::LessThan);
+  std::vector<RID> filtered;
+  for (const RID &rid : rows) {
+    Tuple tuple;
+    ASSERT_TRUE(table_info->table_->GetTuple(rid, &tuple, GetTxn()));
+    if (tuple.GetValue(&table_info->schema_, 0).GetAs<int32_t>() < 500) {
+      filtered.push_back(rid);
+    }
+  }
+  EXPECT_EQ(filtered, run(SampleMethod::BERNOULLI, 0.3, 1, predicate));
+
+  // pages are picked whole, and only those are read
+  std::vector<page_id_t> page_ids = table_info->table_->GetSampledPageIds(0.5, 7);
+  std::map<page_id_t, size_t> expected;
+  for (auto iter = table_info->table_->Begin(GetTxn()); iter != table_info->table_->End(); ++iter) {
+    if (std::find(page_ids.begin(), page_ids.end(), iter->GetRid().GetPageId()) != page_ids.end()) {
+      expected[iter->GetRid().GetPageId()]++;
+    }
+  }
+  std::map<page_id_t, size_t> pages;
+  for (const RID &rid : run(SampleMethod::SYSTEM, 0.5, 7, nullptr)) {
+    pages[rid.GetPageId()]++;
+  }
+  EXPECT_EQ(expected, pages);
+}
+
 // NOLINTNEXTLINE
 TEST_F(ExecutorTest, SimpleRawInsertTest) {
   // INSERT INTO empty_table2 VALUES (100, 10), (101, 11), (102, 12)
@@ -273,7 +1108,7 @@ TEST_F(ExecutorTest, SimpleSelectInsertTest) {
 }
 
 // NOLINTNEXTLINE
-TEST_F(ExecutorTest, DISABLED_SimpleRawInsertWithIndexTest) {
+TEST_F(ExecutorTest, SimpleRawInsertWithIndexTest) {
   // INSERT INTO empty_table2 VALUES (100, 10), (101, 11), (102, 12)
   // Create Values to insert
   std::vector<Value> val1{ValueFactory::GetIntegerValue(100), ValueFactory::GetIntegerValue(10)};
@@ -343,7 +1178,57 @@ TEST_F(ExecutorTest, DISABLED_SimpleRawInsertWithIndexTest) {
 }
 
 // NOLINTNEXTLINE
-TEST_F(ExecutorTest, DISABLED_SimpleDeleteTest) {
+TEST_F(ExecutorTest, DeferredIndexUpdateTest) {
+  auto *catalog = GetExecutorContext()->GetCatalog();
+  auto *source_info = catalog->GetTable("test_1");
+  auto *table_info = catalog->GetTable("empty_table2");
+  Schema *key_schema = ParseCreateStatement("a bigint");
+  auto *index_info = catalog->CreateIndex<GenericKey<8>, RID, GenericComparator<8>>(
+      GetTxn(), "index1", "empty_table2", table_info->schema_, *key_schema, {0}, 8);
+  auto lookup = [&](int32_t a) {
+    std::vector<RID> rids;
+    index_info->index_->ScanKey(Tuple({ValueFactory::GetIntegerValue(a)}, key_schema), &rids, GetTxn());
+    return rids;
+  };
+
+  // INSERT INTO empty_table2 SELECT colA, colB FROM test_1, whose index entries go in at the end, in key order
+  auto *colA = MakeColumnValueExpression(source_info->schema_, 0, "colA");
+  auto *colB = MakeColumnValueExpression(source_info->schema_, 0, "colB");
+  auto *source_schema = MakeOutputSchema({{"colA", colA}, {"colB", colB}});
+  SeqScanPlanNode source_plan{source_schema, nullptr, source_info->oid_};
+  InsertPlanNode insert_plan{&source_plan, table_info->oid_};
+  GetExecutionEngine()->Execute(&insert_plan, nullptr, GetTxn(), GetExecutorContext());
+  for (int32_t a = 0; a < static_cast<int32_t>(TEST1_SIZE); a++) {
+    std::vector<RID> rids = lookup(a);
+    ASSERT_EQ(rids.size(), 1);
+    Tuple indexed_tuple;
+    ASSERT_TRUE(table_info->table_->GetTuple(rids[0], &indexed_tuple, GetTxn()));
+    ASSERT_EQ(indexed_tuple.GetValue(&table_info->schema_, 0).GetAs<int32_t>(), a);
+  }
+
+  // UPDATE empty_table2 SET colA = colA + 1: each new key is the old key of another row, which the unique index
+  // only takes because the old entries are all deleted before the new ones are inserted
+  auto *out_colA = MakeColumnValueExpression(table_info->schema_, 0, "colA");
+  auto *out_colB = MakeColumnValueExpression(table_info->schema_, 0, "colB");
+  auto *out_schema = MakeOutputSchema({{"colA", out_colA}, {"colB", out_colB}});
+  SeqScanPlanNode scan_plan{out_schema, nullptr, table_info->oid_};
+  std::unordered_map<uint32_t, UpdateInfo> update_attrs;
+  update_attrs.emplace(0, UpdateInfo(UpdateType::Add, 1));
+  UpdatePlanNode update_plan{&scan_plan, table_info->oid_, update_attrs};
+  GetExecutionEngine()->Execute(&update_plan, nullptr, GetTxn(), GetExecutorContext());
+  ASSERT_TRUE(lookup(0).empty());
+  for (int32_t a = 1; a <= static_cast<int32_t>(TEST1_SIZE); a++) {
+    std::vector<RID> rids = lookup(a);
+    ASSERT_EQ(rids.size(), 1);
+    Tuple indexed_tuple;
+    ASSERT_TRUE(table_info->table_->GetTuple(rids[0], &indexed_tuple, GetTxn()));
+    ASSERT_EQ(indexed_tuple.GetValue(&table_info->schema_, 0).GetAs<int32_t>(), a);
+  }
+  delete key_schema;
+}
+
+// NOLINTNEXTLINE
+TEST_F(ExecutorTest, SimpleDeleteTest) {
   // SELECT colA FROM test_1 WHERE colA == 50
   // DELETE FROM test_1 WHERE colA == 50
   // SELECT colA FROM test_1 WHERE colA == 50
@@ -393,25 +1278,388 @@ TEST_F(ExecutorTest, DISABLED_SimpleDeleteTest) {
 }
 
 // NOLINTNEXTLINE
-TEST_F(ExecutorTest, DISABLED_SimpleNestedLoopJoinTest) {
-  // SELECT test_1.colA, test_1.colB, test_2.col1, test_2.col3 FROM test_1 JOIN test_2 ON test_1.colA = test_2.col1
+TEST_F(ExecutorTest, UpdateTest) {
+  auto *catalog = GetExecutorContext()->GetCatalog();
+  auto table_info = catalog->GetTable("test_1");
+  auto &schema = table_info->schema_;
+  Schema *key_schema = ParseCreateStatement("a bigint");
+  auto index_info = catalog->CreateIndex<GenericKey<8>, RID, GenericComparator<8>>(GetTxn(), "index1", "test_1",
+                                                                                   schema, *key_schema, {0}, 8);
+  auto lookup = [&](int32_t a) {
+    std::vector<RID> rids;
+    index_info->index_->ScanKey(Tuple({ValueFactory::GetIntegerValue(a)}, key_schema), &rids, GetTxn());
+    return rids;
+  };
+
+  auto colA = MakeColumnValueExpression(schema, 0, "colA");
+  auto colB = MakeColumnValueExpression(schema, 0, "colB");
+  auto colC = MakeColumnValueExpression(schema, 0, "colC");
+  auto colD = MakeColumnValueExpression(schema, 0, "colD");
+  auto *out_schema = MakeOutputSchema({{"colA", colA}, {"colB", colB}, {"colC", colC}, {"colD", colD}});
+  auto *const500 = MakeConstantValueExpression(ValueFactory::GetIntegerValue(500));
+  auto *predicate = MakeComparisonExpression(colA, const500, ComparisonType::LessThan);
+  SeqScanPlanNode scan_plan{out_schema, predicate, table_info->oid_};
+  SeqScanPlanNode full_scan_plan{out_schema, nullptr, table_info->oid_};
+
+  // UPDATE test_1 SET colA = colA + 100000, colB = 42 WHERE colA < 500, which spans several batches
+  std::unordered_map<uint32_t, UpdateInfo> update_attrs;
+  update_attrs.emplace(0, UpdateInfo(UpdateType::Add, 100000));
+  update_attrs.emplace(1, UpdateInfo(UpdateType::Set, 42));
+  UpdatePlanNode update_plan{&scan_plan, table_info->oid_, update_attrs};
+  GetExecutionEngine()->Execute(&update_plan, nullptr, GetTxn(), GetExecutorContext());
+
+  std::vector<Tuple> result_set;
+  GetExecutionEngine()->Execute(&full_scan_plan, &result_set, GetTxn(), GetExecutorContext());
+  ASSERT_EQ(result_set.size(), TEST1_SIZE);
+  size_t num_updated = 0;
+  for (const auto &tuple : result_set) {
+    int32_t a = tuple.GetValue(out_schema, 0).GetAs<int32_t>();
+    ASSERT_TRUE(a >= 500);
+    if (a >= 100000) {
+      num_updated++;
+      ASSERT_EQ(tuple.GetValue(out_schema, 1).GetAs<int32_t>(), 42);
+    }
+  }
+  ASSERT_EQ(num_updated, 500);
+  // the index follows the keys
+  for (int32_t a = 0; a < 500; a++) {
+    ASSERT_TRUE(lookup(a).empty());
+    std::vector<RID> rids = lookup(a + 100000);
+    ASSERT_EQ(rids.size(), 1);
+    Tuple indexed_tuple;
+    ASSERT_TRUE(table_info->table_->GetTuple(rids[0], &indexed_tuple, GetTxn()));
+    ASSERT_EQ(indexed_tuple.GetValue(&schema, 0).GetAs<int32_t>(), a + 100000);
+  }
+
+  // DELETE FROM test_1 WHERE colB = 42, in batches too
+  auto *const42 = MakeConstantValueExpression(ValueFactory::GetIntegerValue(42));
+  auto *delete_predicate = MakeComparisonExpression(colB, const42, ComparisonType::Equal);
+  SeqScanPlanNode delete_scan_plan{out_schema, delete_predicate, table_info->oid_};
+  DeletePlanNode delete_plan{&delete_scan_plan, table_info->oid_};
+  GetExecutionEngine()->Execute(&delete_plan, nullptr, GetTxn(), GetExecutorContext());
+
+  result_set.clear();
+  GetExecutionEngine()->Execute(&full_scan_plan, &result_set, GetTxn(), GetExecutorContext());
+  ASSERT_EQ(result_set.size(), TEST1_SIZE - 500);
+  for (int32_t a = 0; a < 500; a++) {
+    ASSERT_TRUE(lookup(a + 100000).empty());
+    ASSERT_EQ(lookup(a + 500).size(), 1);
+  }
+  delete key_schema;
+}
+
+// NOLINTNEXTLINE
+TEST_F(ExecutorTest, HashJoinTest) {
+  // the smaller test_2 is the left side, which the hash table is built of, and test_1 probes it
   std::unique_ptr<AbstractPlanNode> scan_plan1;
   const Schema *out_schema1;
   {
-    auto table_info = GetExecutorContext()->GetCatalog()->GetTable("test_1");
+    auto table_info = GetExecutorContext()->GetCatalog()->GetTable("test_2");
     auto &schema = table_info->schema_;
-    auto colA = MakeColumnValueExpression(schema, 0, "colA");
-    auto colB = MakeColumnValueExpression(schema, 0, "colB");
-    out_schema1 = MakeOutputSchema({{"colA", colA}, {"colB", colB}});
+    auto col1 = MakeColumnValueExpression(schema, 0, "col1");
+    auto col2 = MakeColumnValueExpression(schema, 0, "col2");
+    out_schema1 = MakeOutputSchema({{"col1", col1}, {"col2", col2}});
     scan_plan1 = std::make_unique<SeqScanPlanNode>(out_schema1, nullptr, table_info->oid_);
   }
   std::unique_ptr<AbstractPlanNode> scan_plan2;
   const Schema *out_schema2;
   {
-    auto table_info = GetExecutorContext()->GetCatalog()->GetTable("test_2");
+    auto table_info = GetExecutorContext()->GetCatalog()->GetTable("test_1");
     auto &schema = table_info->schema_;
-    auto col1 = MakeColumnValueExpression(schema, 0, "col1");
-    auto col3 = MakeColumnValueExpression(schema, 0, "col3");
+    auto colA = MakeColumnValueExpression(schema, 0, "colA");
+    auto colB = MakeColumnValueExpression(schema, 0, "colB");
+    out_schema2 = MakeOutputSchema({{"colA", colA}, {"colB", colB}});
+    scan_plan2 = std::make_unique<SeqScanPlanNode>(out_schema2, nullptr, table_info->oid_);
+  }
+  auto col1 = MakeColumnValueExpression(*out_schema1, 0, "col1");
+  auto col2 = MakeColumnValueExpression(*out_schema1, 0, "col2");
+  auto colA = MakeColumnValueExpression(*out_schema2, 1, "colA");
+  auto colB = MakeColumnValueExpression(*out_schema2, 1, "colB");
+  auto *out_final = MakeOutputSchema({{"col1", col1}, {"col2", col2}, {"colA", colA}, {"colB", colB}});
+
+  // the joins come out the same in memory; spilled, when a budget of a few tuples splits the partitions again; in
+  // parallel; in parallel in rounds of partitions, when the budget fits both sides but not all of the output of the
+  // second join; and serially again, when the budget fits the left side but not both
+  std::vector<std::pair<size_t, size_t>> configs{
+      {QUERY_MEMORY_BUDGET, 1}, {256, 1}, {QUERY_MEMORY_BUDGET, 4}, {128 * 1024, 4}, {16 * 1024, 4}};
+  for (auto [budget, num_threads] : configs) {
+    GetExecutorContext()->SetMemoryBudget(budget);
+
+    // SELECT test_2.col1, test_2.col2, test_1.colA, test_1.colB FROM test_2 JOIN test_1 ON test_2.col1 = test_1.colA,
+    // whose SMALLINT and INTEGER keys hash alike
+    {
+      HashJoinPlanNode join_plan{out_final,
+                                 {scan_plan1.get(), scan_plan2.get()},
+                                 std::vector<const AbstractExpression *>{col1},
+                                 std::vector<const AbstractExpression *>{colA},
+                                 num_threads};
+      std::vector<Tuple> result_set;
+      GetExecutionEngine()->Execute(&join_plan, &result_set, GetTxn(), GetExecutorContext());
+      ASSERT_EQ(result_set.size(), TEST2_SIZE);
+      std::unordered_set<int32_t> seen;
+      for (const auto &tuple : result_set) {
+        auto a = tuple.GetValue(out_final, out_final->GetColIdx("colA")).GetAs<int32_t>();
+        ASSERT_EQ(tuple.GetValue(out_final, out_final->GetColIdx("col1")).GetAs<int16_t>(), a);
+        ASSERT_TRUE(seen.insert(a).second);
+      }
+    }
+
+    // ... ON test_2.col2 = test_1.colB, where every left tuple matches many right ones and the null keys match none
+    {
+      std::vector<Tuple> left_tuples;
+      std::vector<Tuple> right_tuples;
+      GetExecutionEngine()->Execute(scan_plan1.get(), &left_tuples, GetTxn(), GetExecutorContext());
+      GetExecutionEngine()->Execute(scan_plan2.get(), &right_tuples, GetTxn(), GetExecutorContext());
+      size_t expected = 0;
+      for (const auto &left : left_tuples) {
+        for (const auto &right : right_tuples) {
+          Value key = left.GetValue(out_schema1, 1);
+          expected += !key.IsNull() && key.CompareEquals(right.GetValue(out_schema2, 1)) == CmpBool::CmpTrue ? 1 : 0;
+        }
+      }
+
+      HashJoinPlanNode join_plan{out_final,
+                                 {scan_plan1.get(), scan_plan2.get()},
+                                 std::vector<const AbstractExpression *>{col2},
+                                 std::vector<const AbstractExpression *>{colB},
+                                 num_threads};
+      std::vector<Tuple> result_set;
+      GetExecutionEngine()->Execute(&join_plan, &result_set, GetTxn(), GetExecutorContext());
+      ASSERT_GT(expected, 0);
+      ASSERT_EQ(result_set.size(), expected);
+      for (const auto &tuple : result_set) {
+        Value key = tuple.GetValue(out_final, out_final->GetColIdx("col2"));
+        ASSERT_FALSE(key.IsNull());
+        ASSERT_EQ(key.GetAs<int32_t>(), tuple.GetValue(out_final, out_final->GetColIdx("colB")).GetAs<int32_t>());
+      }
+    }
+  }
+}
+
+// NOLINTNEXTLINE
+TEST_F(ExecutorTest, SemiAntiJoinTest) {
+  // SELECT col1, col2 FROM test_2 WHERE [NOT] EXISTS (SELECT * FROM test_1 WHERE colB < 5 AND colB = test_2.key):
+  // test_1, whose colB repeats each of its values many times, is the left side, and test_2 the outer one that probes
+  // it; a few rows of test_2 have a null col2
+  auto table1_info = GetCatalog()->GetTable("test_1");
+  auto *out_schema1 = MakeOutputSchema({{"colA", MakeColumnValueExpression(table1_info->schema_, 0, "colA")},
+                                        {"colB", MakeColumnValueExpression(table1_info->schema_, 0, "colB")}});
+  auto *below5 = MakeComparisonExpression(MakeColumnValueExpression(table1_info->schema_, 0, "colB"),
+                                          MakeConstantValueExpression(ValueFactory::GetIntegerValue(5)),
+                                          ComparisonType::LessThan);
+  SeqScanPlanNode scan_plan1(out_schema1, below5, table1_info->oid_);
+  auto table2_info = GetCatalog()->GetTable("test_2");
+  std::vector<std::vector<Value>> null_rows;
+  for (int16_t i = 0; i < 3; i++) {
+    null_rows.push_back({ValueFactory::GetSmallIntValue(TEST2_SIZE + i),
+                         ValueFactory::GetNullValueByType(TypeId::INTEGER), ValueFactory::GetBigIntValue(0),
+                         ValueFactory::GetIntegerValue(0)});
+  }
+  InsertPlanNode insert_plan{std::move(null_rows), table2_info->oid_};
+  GetExecutionEngine()->Execute(&insert_plan, nullptr, GetTxn(), GetExecutorContext());
+  auto *out_schema2 = MakeOutputSchema({{"col1", MakeColumnValueExpression(table2_info->schema_, 0, "col1")},
+                                        {"col2", MakeColumnValueExpression(table2_info->schema_, 0, "col2")}});
+  SeqScanPlanNode scan_plan2(out_schema2, nullptr, table2_info->oid_);
+  auto colB = MakeColumnValueExpression(*out_schema1, 0, "colB");
+  auto col1 = MakeColumnValueExpression(*out_schema2, 1, "col1");
+  auto col2 = MakeColumnValueExpression(*out_schema2, 1, "col2");
+  auto *out_final = MakeOutputSchema({{"col1", col1}, {"col2", col2}});
+
+  // the outer rows each join type keeps, the ones with a null key matching nothing
+  std::vector<Tuple> left_tuples;
+  std::vector<Tuple> right_tuples;
+  GetExecutionEngine()->Execute(&scan_plan1, &left_tuples, GetTxn(), GetExecutorContext());
+  GetExecutionEngine()->Execute(&scan_plan2, &right_tuples, GetTxn(), GetExecutorContext());
+  std::set<int32_t> values_of_b;
+  for (const auto &tuple : left_tuples) {
+    values_of_b.insert(tuple.GetValue(out_schema1, 1).GetAs<int32_t>());
+  }
+  ASSERT_EQ(5, values_of_b.size());
+  auto expected = [&](uint32_t key_idx, JoinType join_type) {
+    std::multiset<int16_t> rows;
+    for (const auto &tuple : right_tuples) {
+      Value key = tuple.GetValue(out_schema2, key_idx);
+      bool matched = !key.IsNull() && values_of_b.count(key.CastAs(TypeId::INTEGER).GetAs<int32_t>()) != 0;
+      if (matched == (join_type == JoinType::SEMI)) {
+        rows.insert(tuple.GetValue(out_schema2, 0).GetAs<int16_t>());
+      }
+    }
+    return rows;
+  };
+  auto col1s = [&](const std::vector<Tuple> &result_set) {
+    std::multiset<int16_t> rows;
+    for (const auto &tuple : result_set) {
+      rows.insert(tuple.GetValue(out_final, 0).GetAs<int16_t>());
+    }
+    return rows;
+  };
+
+  // in memory, spilled, in parallel, and in batches, the hash join makes each outer row once at most
+  std::vector<std::pair<size_t, size_t>> configs{
+      {QUERY_MEMORY_BUDGET, 1}, {256, 1}, {QUERY_MEMORY_BUDGET, 4}, {16 * 1024, 4}};
+  for (JoinType join_type : {JoinType::SEMI, JoinType::ANTI}) {
+    for (uint32_t key_idx : {0, 1}) {
+      const AbstractExpression *right_key = key_idx == 0 ? col1 : col2;
+      auto rows = expected(key_idx, join_type);
+      ASSERT_FALSE(rows.empty());
+      for (auto [budget, num_threads] : configs) {
+        GetExecutorContext()->SetMemoryBudget(budget);
+        HashJoinPlanNode join_plan{out_final,
+                                   {&scan_plan1, &scan_plan2},
+                                   std::vector<const AbstractExpression *>{colB},
+                                   std::vector<const AbstractExpression *>{right_key},
+                                   num_threads,
+                                   join_type};
+        std::vector<Tuple> result_set;
+        GetExecutionEngine()->Execute(&join_plan, &result_set, GetTxn(), GetExecutorContext());
+        EXPECT_EQ(rows, col1s(result_set)) << budget << " " << num_threads;
+      }
+      GetExecutorContext()->SetMemoryBudget(QUERY_MEMORY_BUDGET);
+      HashJoinPlanNode join_plan{out_final,
+                                 {&scan_plan1, &scan_plan2},
+                                 std::vector<const AbstractExpression *>{colB},
+                                 std::vector<const AbstractExpression *>{right_key},
+                                 1,
+                                 join_type};
+      auto executor = ExecutorFactory::CreateExecutor(GetExecutorContext(), &join_plan);
+      executor->Init();
+      DataChunk chunk(out_final, 7);
+      std::vector<Tuple> batch_set;
+      while (executor->NextBatch(&chunk)) {
+        chunk.GetTuples(&batch_set);
+      }
+      EXPECT_EQ(rows, col1s(batch_set));
+
+      // and so does the probe of a push pipeline
+      class CountingSink : public PushStage {
+       public:
+        bool Consume(DataChunk *chunk) override {
+          rows_ += chunk->GetSelectedCount();
+          return true;
+        }
+        size_t rows_{0};
+      };
+      auto pipeline = PushPipeline::Compile(GetExecutorContext(), &join_plan);
+      ASSERT_NE(nullptr, pipeline);
+      CountingSink sink;
+      ASSERT_TRUE(pipeline->Run(&sink));
+      EXPECT_EQ(rows.size(), sink.rows_);
+    }
+  }
+
+  // the nested index join looks the outer keys up in an index of test_1 (colB), all of whose values it matches
+  values_of_b = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9};
+  std::unique_ptr<Schema> key_schema(Schema::CopySchema(&table1_info->schema_, {1}));
+  GetCatalog()->CreateIndex<GenericKey<8>, RID, GenericComparator<8>>(GetTxn(), "index_b", "test_1",
+                                                                      table1_info->schema_, *key_schema, {1}, 8);
+  auto outer_col1 = MakeColumnValueExpression(*out_schema2, 0, "col1");
+  auto outer_col2 = MakeColumnValueExpression(*out_schema2, 0, "col2");
+  auto inner_colB = MakeColumnValueExpression(table1_info->schema_, 1, "colB");
+  auto *outer_final = MakeOutputSchema({{"col1", outer_col1}, {"col2", outer_col2}});
+  for (JoinType join_type : {JoinType::SEMI, JoinType::ANTI}) {
+    for (uint32_t key_idx : {0, 1}) {
+      auto *predicate = MakeComparisonExpression(key_idx == 0 ? outer_col1 : outer_col2, inner_colB,
+                                                 ComparisonType::Equal);
+      NestedIndexJoinPlanNode join_plan(outer_final, {&scan_plan2}, predicate, table1_info->oid_, "index_b",
+                                        out_schema2, &table1_info->schema_, join_type);
+      std::vector<Tuple> result_set;
+      GetExecutionEngine()->Execute(&join_plan, &result_set, GetTxn(), GetExecutorContext());
+      EXPECT_EQ(expected(key_idx, join_type), col1s(result_set));
+    }
+  }
+}
+
+// NOLINTNEXTLINE
+TEST_F(ExecutorTest, JoinKeyFilterPushdownTest) {
+  auto table_info = GetExecutorContext()->GetCatalog()->GetTable("test_1");
+  auto &schema = table_info->schema_;
+  auto colA = MakeColumnValueExpression(schema, 0, "colA");
+  auto colB = MakeColumnValueExpression(schema, 0, "colB");
+  auto *out_schema = MakeOutputSchema({{"colA", colA}, {"colB", colB}});
+  SeqScanPlanNode plan{out_schema, nullptr, table_info->oid_};
+
+  // a build side of ten keys lets about ten of the thousand rows through the scan
+  std::vector<const AbstractExpression *> probe_keys{colA};
+  {
+    JoinKeyFilter filter(10, &probe_keys);
+    for (int32_t i = 0; i < 10; i++) {
+      filter.Insert(std::hash<HashJoinKey>{}(HashJoinKey{{ValueFactory::GetIntegerValue(i * 100)}}));
+    }
+    SeqScanExecutor scan(GetExecutorContext(), &plan);
+    scan.SetJoinKeyFilter(&filter);
+    scan.Init();
+    Tuple tuple;
+    RID rid;
+    std::unordered_set<int32_t> passed;
+    while (scan.Next(&tuple, &rid)) {
+      passed.insert(tuple.GetValue(out_schema, 0).GetAs<int32_t>());
+    }
+    for (int32_t i = 0; i < 10; i++) {
+      EXPECT_EQ(1, passed.count(i * 100));
+    }
+    EXPECT_LT(passed.size(), 30);
+    EXPECT_TRUE(filter.IsEnabled());
+  }
+
+  // one that lets nearly every row through turns itself off
+  {
+    JoinKeyFilter filter(TEST1_SIZE, &probe_keys);
+    for (int32_t i = 0; i < static_cast<int32_t>(JoinKeyFilter::SAMPLE_SIZE); i++) {
+      filter.Insert(std::hash<HashJoinKey>{}(HashJoinKey{{ValueFactory::GetIntegerValue(i)}}));
+    }
+    std::vector<Value> values{ValueFactory::GetIntegerValue(0), ValueFactory::GetIntegerValue(0)};
+    for (int32_t i = 0; i < static_cast<int32_t>(JoinKeyFilter::SAMPLE_SIZE); i++) {
+      values[0] = ValueFactory::GetIntegerValue(i);
+      ASSERT_TRUE(filter.MayMatch(Tuple(values, out_schema), out_schema));
+    }
+    EXPECT_FALSE(filter.IsEnabled());
+  }
+
+  // and a hash join pushes its filter down on its own:
+  // SELECT ... FROM test_1 JOIN test_2 ON colA = col1 WHERE colA < 10
+  auto *predicate = MakeComparisonExpression(colA, MakeConstantValueExpression(ValueFactory::GetIntegerValue(10)),
+                                             ComparisonType::LessThan);
+  SeqScanPlanNode build_plan{out_schema, predicate, table_info->oid_};
+  auto table2_info = GetExecutorContext()->GetCatalog()->GetTable("test_2");
+  auto col1 = MakeColumnValueExpression(table2_info->schema_, 0, "col1");
+  auto col2 = MakeColumnValueExpression(table2_info->schema_, 0, "col2");
+  auto *out_schema2 = MakeOutputSchema({{"col1", col1}, {"col2", col2}});
+  SeqScanPlanNode probe_plan{out_schema2, nullptr, table2_info->oid_};
+  auto join_colA = MakeColumnValueExpression(*out_schema, 0, "colA");
+  auto join_col1 = MakeColumnValueExpression(*out_schema2, 1, "col1");
+  auto *out_final = MakeOutputSchema({{"colA", join_colA}, {"col1", join_col1}});
+  HashJoinPlanNode join_plan{out_final,
+                             {&build_plan, &probe_plan},
+                             std::vector<const AbstractExpression *>{join_colA},
+                             std::vector<const AbstractExpression *>{join_col1}};
+  std::vector<Tuple> result_set;
+  GetExecutionEngine()->Execute(&join_plan, &result_set, GetTxn(), GetExecutorContext());
+  ASSERT_EQ(10, result_set.size());
+  for (const auto &tuple : result_set) {
+    EXPECT_EQ(tuple.GetValue(out_final, 0).GetAs<int32_t>(), tuple.GetValue(out_final, 1).GetAs<int16_t>());
+  }
+}
+
+// NOLINTNEXTLINE
+TEST_F(ExecutorTest, SimpleNestedLoopJoinTest) {
+  // SELECT test_1.colA, test_1.colB, test_2.col1, test_2.col3 FROM test_1 JOIN test_2 ON test_1.colA = test_2.col1
+  std::unique_ptr<AbstractPlanNode> scan_plan1;
+  const Schema *out_schema1;
+  {
+    auto table_info = GetExecutorContext()->GetCatalog()->GetTable("test_1");
+    auto &schema = table_info->schema_;
+    auto colA = MakeColumnValueExpression(schema, 0, "colA");
+    auto colB = MakeColumnValueExpression(schema, 0, "colB");
+    out_schema1 = MakeOutputSchema({{"colA", colA}, {"colB", colB}});
+    scan_plan1 = std::make_unique<SeqScanPlanNode>(out_schema1, nullptr, table_info->oid_);
+  }
+  std::unique_ptr<AbstractPlanNode> scan_plan2;
+  const Schema *out_schema2;
+  {
+    auto table_info = GetExecutorContext()->GetCatalog()->GetTable("test_2");
+    auto &schema = table_info->schema_;
+    auto col1 = MakeColumnValueExpression(schema, 0, "col1");
+    auto col3 = MakeColumnValueExpression(schema, 0, "col3");
     out_schema2 = MakeOutputSchema({{"col1", col1}, {"col3", col3}});
     scan_plan2 = std::make_unique<SeqScanPlanNode>(out_schema2, nullptr, table_info->oid_);
   }
@@ -443,7 +1691,281 @@ TEST_F(ExecutorTest, DISABLED_SimpleNestedLoopJoinTest) {
 }
 
 // NOLINTNEXTLINE
-TEST_F(ExecutorTest, DISABLED_SimpleAggregationTest) {
+TEST_F(ExecutorTest, BlockNestedLoopJoinTest) {
+  // SELECT colA, col1 FROM test_1 JOIN test_2 ON colA < col1, which only a nested loop join can do
+  auto table1_info = GetExecutorContext()->GetCatalog()->GetTable("test_1");
+  auto table2_info = GetExecutorContext()->GetCatalog()->GetTable("test_2");
+  auto colA = MakeColumnValueExpression(table1_info->schema_, 0, "colA");
+  auto *out_schema1 = MakeOutputSchema({{"colA", colA}});
+  SeqScanPlanNode scan_plan1(out_schema1, nullptr, table1_info->oid_);
+  auto col1 = MakeColumnValueExpression(table2_info->schema_, 0, "col1");
+  auto *out_schema2 = MakeOutputSchema({{"col1", col1}});
+  SeqScanPlanNode scan_plan2(out_schema2, nullptr, table2_info->oid_);
+
+  auto left_colA = MakeColumnValueExpression(*out_schema1, 0, "colA");
+  auto right_col1 = MakeColumnValueExpression(*out_schema2, 1, "col1");
+  auto *out_final = MakeOutputSchema({{"colA", left_colA}, {"col1", right_col1}});
+  auto *predicate = MakeComparisonExpression(left_colA, right_col1, ComparisonType::LessThan);
+  NestedLoopJoinPlanNode join_plan(out_final, {&scan_plan1, &scan_plan2}, predicate);
+
+  std::vector<Tuple> lefts;
+  std::vector<Tuple> rights;
+  GetExecutionEngine()->Execute(&scan_plan1, &lefts, GetTxn(), GetExecutorContext());
+  GetExecutionEngine()->Execute(&scan_plan2, &rights, GetTxn(), GetExecutorContext());
+  std::multiset<std::pair<int32_t, int32_t>> expected;
+  for (const auto &left : lefts) {
+    for (const auto &right : rights) {
+      int32_t a = left.GetValue(out_schema1, 0).GetAs<int32_t>();
+      int32_t b = right.GetValue(out_schema2, 0).GetAs<int16_t>();
+      if (a < b) {
+        expected.emplace(a, b);
+      }
+    }
+  }
+  ASSERT_FALSE(expected.empty());
+
+  // with the whole outer side in one block, and in many small ones
+  for (size_t budget : {QUERY_MEMORY_BUDGET, static_cast<size_t>(4096)}) {
+    GetExecutorContext()->SetMemoryBudget(budget);
+    auto left = ExecutorFactory::CreateExecutor(GetExecutorContext(), &scan_plan1);
+    auto right = ExecutorFactory::CreateExecutor(GetExecutorContext(), &scan_plan2);
+    NestedLoopJoinExecutor executor(GetExecutorContext(), &join_plan, std::move(left), std::move(right));
+    executor.Init();
+    std::multiset<std::pair<int32_t, int32_t>> joined;
+    Tuple tuple;
+    RID rid;
+    while (executor.Next(&tuple, &rid)) {
+      joined.emplace(tuple.GetValue(out_final, 0).GetAs<int32_t>(), tuple.GetValue(out_final, 1).GetAs<int16_t>());
+    }
+    EXPECT_EQ(expected, joined) << budget;
+    if (budget == QUERY_MEMORY_BUDGET) {
+      EXPECT_EQ(1, executor.GetNumBlocks());
+    } else {
+      EXPECT_LT(1, executor.GetNumBlocks());
+    }
+  }
+  GetExecutorContext()->SetMemoryBudget(QUERY_MEMORY_BUDGET);
+}
+
+// NOLINTNEXTLINE
+TEST_F(ExecutorTest, NestedIndexJoinTest) {
+  // CREATE INDEX ON test_2 (col1)
+  auto *catalog = GetExecutorContext()->GetCatalog();
+  TableMetadata *table2_info = catalog->GetTable("test_2");
+  Schema &schema2 = table2_info->schema_;
+  std::unique_ptr<Schema> key_schema(Schema::CopySchema(&schema2, {0}));
+  catalog->CreateIndex<GenericKey<8>, RID, GenericComparator<8>>(GetTxn(), "index1", "test_2", schema2, *key_schema,
+                                                                  {0}, 8);
+
+  auto table1_info = catalog->GetTable("test_1");
+  auto colA = MakeColumnValueExpression(table1_info->schema_, 0, "colA");
+  auto colB = MakeColumnValueExpression(table1_info->schema_, 0, "colB");
+  auto *out_schema1 = MakeOutputSchema({{"colA", colA}, {"colB", colB}});
+  SeqScanPlanNode scan_plan(out_schema1, nullptr, table1_info->oid_);
+
+  auto outer_colA = MakeColumnValueExpression(*out_schema1, 0, "colA");
+  auto outer_colB = MakeColumnValueExpression(*out_schema1, 0, "colB");
+  auto inner_col1 = MakeColumnValueExpression(schema2, 1, "col1");
+  auto inner_col2 = MakeColumnValueExpression(schema2, 1, "col2");
+  auto *out_final = MakeOutputSchema({{"colA", outer_colA}, {"colB", outer_colB}, {"col1", inner_col1}});
+
+  // SELECT colA, colB, col1 FROM test_1 JOIN test_2 ON colA = col1, where most of the outer keys match nothing
+  {
+    auto *predicate = MakeComparisonExpression(outer_colA, inner_col1, ComparisonType::Equal);
+    NestedIndexJoinPlanNode join_plan(out_final, {&scan_plan}, predicate, table2_info->oid_, "index1", out_schema1,
+                                      &schema2);
+    std::vector<Tuple> result_set;
+    GetExecutionEngine()->Execute(&join_plan, &result_set, GetTxn(), GetExecutorContext());
+    ASSERT_EQ(result_set.size(), TEST2_SIZE);
+    std::unordered_set<int32_t> seen;
+    for (const auto &tuple : result_set) {
+      auto a = tuple.GetValue(out_final, 0).GetAs<int32_t>();
+      ASSERT_EQ(tuple.GetValue(out_final, 2).GetAs<int16_t>(), a);
+      ASSERT_TRUE(seen.insert(a).second);
+    }
+  }
+
+  // ... ON col1 = colB, with the inner column on the left, where every outer key repeats a hundred times
+  {
+    auto *predicate = MakeComparisonExpression(inner_col1, outer_colB, ComparisonType::Equal);
+    NestedIndexJoinPlanNode join_plan(out_final, {&scan_plan}, predicate, table2_info->oid_, "index1", out_schema1,
+                                      &schema2);
+    std::vector<Tuple> result_set;
+    GetExecutionEngine()->Execute(&join_plan, &result_set, GetTxn(), GetExecutorContext());
+    ASSERT_EQ(result_set.size(), TEST1_SIZE);
+    for (const auto &tuple : result_set) {
+      ASSERT_EQ(tuple.GetValue(out_final, 2).GetAs<int16_t>(), tuple.GetValue(out_final, 1).GetAs<int32_t>());
+    }
+  }
+
+  // an index join needs an equality to look the keys up with
+  auto *predicate = MakeComparisonExpression(outer_colA, inner_col2, ComparisonType::LessThan);
+  NestedIndexJoinPlanNode join_plan(out_final, {&scan_plan}, predicate, table2_info->oid_, "index1", out_schema1,
+                                    &schema2);
+  auto executor = ExecutorFactory::CreateExecutor(GetExecutorContext(), &join_plan);
+  EXPECT_THROW(executor->Init(), Exception);
+}
+
+// NOLINTNEXTLINE
+TEST_F(ExecutorTest, AdaptiveIndexJoinTest) {
+  auto *catalog = GetExecutorContext()->GetCatalog();
+  TableMetadata *table2_info = catalog->GetTable("test_2");
+  Schema &schema2 = table2_info->schema_;
+  std::unique_ptr<Schema> key_schema(Schema::CopySchema(&schema2, {0}));
+  catalog->CreateIndex<GenericKey<8>, RID, GenericComparator<8>>(GetTxn(), "index1", "test_2", schema2, *key_schema,
+                                                                  {0}, 8);
+  // test_2 has a tenth of the rows of test_1, so the join switches a fortieth of the way through the outer side
+  catalog->Analyze(GetTxn(), "test_2");
+
+  auto table1_info = catalog->GetTable("test_1");
+  auto colA = MakeColumnValueExpression(table1_info->schema_, 0, "colA");
+  auto *out_schema1 = MakeOutputSchema({{"colA", colA}});
+  SeqScanPlanNode scan_plan(out_schema1, nullptr, table1_info->oid_);
+  auto outer_colA = MakeColumnValueExpression(*out_schema1, 0, "colA");
+  auto inner_col1 = MakeColumnValueExpression(schema2, 1, "col1");
+  auto *out_final = MakeOutputSchema({{"colA", outer_colA}, {"col1", inner_col1}});
+  auto *predicate = MakeComparisonExpression(outer_colA, inner_col1, ComparisonType::Equal);
+
+  // SELECT colA, col1 FROM test_1 JOIN test_2 ON colA = col1, with the inner table in memory or not
+  for (size_t budget : {QUERY_MEMORY_BUDGET, static_cast<size_t>(64)}) {
+    GetExecutorContext()->SetMemoryBudget(budget);
+    for (JoinType join_type : {JoinType::INNER, JoinType::ANTI}) {
+      const Schema *output = join_type == JoinType::INNER ? out_final : out_schema1;
+      NestedIndexJoinPlanNode join_plan(output, {&scan_plan}, predicate, table2_info->oid_, "index1", out_schema1,
+                                        &schema2, join_type);
+      NestIndexJoinExecutor executor(GetExecutorContext(), &join_plan,
+                                     ExecutorFactory::CreateExecutor(GetExecutorContext(), &scan_plan));
+      executor.Init();
+      Tuple tuple;
+      RID rid;
+      std::unordered_set<int32_t> seen;
+      while (executor.Next(&tuple, &rid)) {
+        auto a = tuple.GetValue(output, 0).GetAs<int32_t>();
+        ASSERT_TRUE(seen.insert(a).second);
+        if (join_type == JoinType::INNER) {
+          ASSERT_EQ(a, tuple.GetValue(output, 1).GetAs<int16_t>());
+        } else {
+          ASSERT_LE(TEST2_SIZE, static_cast<uint32_t>(a));
+        }
+      }
+      EXPECT_EQ(join_type == JoinType::INNER ? TEST2_SIZE : TEST1_SIZE - TEST2_SIZE, seen.size());
+      EXPECT_EQ(TEST1_SIZE, executor.GetOuterRows());
+      EXPECT_EQ(budget == QUERY_MEMORY_BUDGET, executor.IsHashJoin());
+    }
+  }
+  GetExecutorContext()->SetMemoryBudget(QUERY_MEMORY_BUDGET);
+}
+
+// NOLINTNEXTLINE
+TEST_F(ExecutorTest, AdaptiveIndexJoinSnapshotTest) {
+  // CREATE TABLE snapshot_outer (a INT) and snapshot_inner (k INT, v INT), with an index on k, of rows committed
+  // before the reader begins
+  auto *catalog = GetCatalog();
+  auto *outer_info = catalog->CreateTable(GetTxn(), "snapshot_outer", Schema({Column("a", TypeId::INTEGER)}));
+  Schema schema({Column("k", TypeId::INTEGER), Column("v", TypeId::INTEGER)});
+  auto *table_info = catalog->CreateTable(GetTxn(), "snapshot_inner", schema);
+  auto make_row = [&table_info](int32_t k, int32_t v) {
+    return Tuple({ValueFactory::GetIntegerValue(k), ValueFactory::GetIntegerValue(v)}, &table_info->schema_);
+  };
+  Transaction *loader = GetTxnManager()->Begin();
+  RID rid;
+  for (int32_t i = 0; i < 1000; i++) {
+    ASSERT_TRUE(outer_info->table_->InsertTuple(Tuple({ValueFactory::GetIntegerValue(i)}, &outer_info->schema_), &rid,
+                                                loader));
+  }
+  std::vector<RID> rids(10);
+  for (int32_t i = 0; i < 10; i++) {
+    ASSERT_TRUE(table_info->table_->InsertTuple(make_row(i, i), &rids[i], loader));
+  }
+  GetTxnManager()->Commit(loader);
+  delete loader;
+  std::unique_ptr<Schema> key_schema(Schema::CopySchema(&table_info->schema_, {0}));
+  catalog->CreateIndex<GenericKey<8>, RID, GenericComparator<8>>(GetTxn(), "snapshot_index", "snapshot_inner",
+                                                                  table_info->schema_, *key_schema, {0}, 8);
+  catalog->Analyze(GetTxn(), "snapshot_inner");
+
+  // a writer changes every v after the reader began, and commits before the reader's join builds its hash table
+  Transaction *reader = GetTxnManager()->Begin(nullptr, IsolationLevel::SNAPSHOT);
+  Transaction *writer = GetTxnManager()->Begin(nullptr, IsolationLevel::SNAPSHOT);
+  for (int32_t i = 0; i < 10; i++) {
+    ASSERT_TRUE(table_info->table_->UpdateTuple(make_row(i, 100 + i), rids[i], writer));
+  }
+  GetTxnManager()->Commit(writer);
+
+  // SELECT a, v FROM snapshot_outer JOIN snapshot_inner ON a = k, which switches to a hash join early on
+  ExecutorContext reader_ctx(reader, catalog, GetBPM(), GetTxnManager(), GetLockManager());
+  auto *a = MakeColumnValueExpression(outer_info->schema_, 0, "a");
+  auto *out_schema1 = MakeOutputSchema({{"a", a}});
+  SeqScanPlanNode scan_plan(out_schema1, nullptr, outer_info->oid_);
+  auto *outer_a = MakeColumnValueExpression(*out_schema1, 0, "a");
+  auto *inner_k = MakeColumnValueExpression(table_info->schema_, 1, "k");
+  auto *inner_v = MakeColumnValueExpression(table_info->schema_, 1, "v");
+  auto *out_final = MakeOutputSchema({{"a", outer_a}, {"v", inner_v}});
+  auto *predicate = MakeComparisonExpression(outer_a, inner_k, ComparisonType::Equal);
+  NestedIndexJoinPlanNode join_plan(out_final, {&scan_plan}, predicate, table_info->oid_, "snapshot_index",
+                                    out_schema1, &table_info->schema_);
+  NestIndexJoinExecutor executor(&reader_ctx, &join_plan, ExecutorFactory::CreateExecutor(&reader_ctx, &scan_plan));
+  executor.Init();
+  Tuple tuple;
+  size_t rows = 0;
+  while (executor.Next(&tuple, &rid)) {
+    // the reader sees the values of its snapshot, not the writer's
+    EXPECT_EQ(tuple.GetValue(out_final, 0).GetAs<int32_t>(), tuple.GetValue(out_final, 1).GetAs<int32_t>());
+    rows++;
+  }
+  EXPECT_EQ(10, rows);
+  EXPECT_TRUE(executor.IsHashJoin());
+  GetTxnManager()->Commit(reader);
+  delete writer;
+  delete reader;
+}
+
+// NOLINTNEXTLINE
+TEST_F(ExecutorTest, AdaptiveIndexJoinToastTest) {
+  // CREATE TABLE toast_inner (k INT, s VARCHAR), with an index on k, and values of s larger than a page
+  auto *catalog = GetCatalog();
+  Schema schema({Column("k", TypeId::INTEGER), Column("s", TypeId::VARCHAR, 16)});
+  auto *table_info = catalog->CreateTable(GetTxn(), "toast_inner", schema);
+  auto payload = [](int32_t i) { return std::string(i % 2 == 0 ? 3 * PAGE_SIZE : 10, 'a' + i); };
+  std::vector<std::vector<Value>> raw_vals;
+  for (int32_t i = 0; i < 10; i++) {
+    raw_vals.push_back({ValueFactory::GetIntegerValue(i), ValueFactory::GetVarcharValue(payload(i))});
+  }
+  InsertPlanNode insert_plan{std::move(raw_vals), table_info->oid_};
+  GetExecutionEngine()->Execute(&insert_plan, nullptr, GetTxn(), GetExecutorContext());
+  std::unique_ptr<Schema> key_schema(Schema::CopySchema(&table_info->schema_, {0}));
+  catalog->CreateIndex<GenericKey<8>, RID, GenericComparator<8>>(GetTxn(), "toast_index", "toast_inner",
+                                                                  table_info->schema_, *key_schema, {0}, 8);
+  catalog->Analyze(GetTxn(), "toast_inner");
+
+  // SELECT colA, s FROM test_1 JOIN toast_inner ON colA = k, whose hash table holds the values of s read back in
+  auto table1_info = catalog->GetTable("test_1");
+  auto *colA = MakeColumnValueExpression(table1_info->schema_, 0, "colA");
+  auto *out_schema1 = MakeOutputSchema({{"colA", colA}});
+  SeqScanPlanNode scan_plan(out_schema1, nullptr, table1_info->oid_);
+  auto *outer_colA = MakeColumnValueExpression(*out_schema1, 0, "colA");
+  auto *inner_k = MakeColumnValueExpression(table_info->schema_, 1, "k");
+  auto *inner_s = MakeColumnValueExpression(table_info->schema_, 1, "s");
+  auto *out_final = MakeOutputSchema({{"colA", outer_colA}, {"s", inner_s}});
+  auto *predicate = MakeComparisonExpression(outer_colA, inner_k, ComparisonType::Equal);
+  NestedIndexJoinPlanNode join_plan(out_final, {&scan_plan}, predicate, table_info->oid_, "toast_index", out_schema1,
+                                    &table_info->schema_);
+  NestIndexJoinExecutor executor(GetExecutorContext(), &join_plan,
+                                 ExecutorFactory::CreateExecutor(GetExecutorContext(), &scan_plan));
+  executor.Init();
+  Tuple tuple;
+  RID rid;
+  size_t rows = 0;
+  while (executor.Next(&tuple, &rid)) {
+    EXPECT_EQ(tuple.GetValue(out_final, 1).ToString(), payload(tuple.GetValue(out_final, 0).GetAs<int32_t>()));
+    rows++;
+  }
+  EXPECT_EQ(10, rows);
+  EXPECT_TRUE(executor.IsHashJoin());
+}
+
+// NOLINTNEXTLINE
+TEST_F(ExecutorTest, SimpleAggregationTest) {
   // SELECT COUNT(colA), SUM(colA), min(colA), max(colA) from test_1;
   std::unique_ptr<AbstractPlanNode> scan_plan;
   const Schema *scan_schema;
@@ -494,7 +2016,7 @@ TEST_F(ExecutorTest, DISABLED_SimpleAggregationTest) {
 }
 
 // NOLINTNEXTLINE
-TEST_F(ExecutorTest, DISABLED_SimpleGroupByAggregation) {
+TEST_F(ExecutorTest, SimpleGroupByAggregation) {
   // SELECT count(colA), colB, sum(colC) FROM test_1 Group By colB HAVING count(colA) > 100
   std::unique_ptr<AbstractPlanNode> scan_plan;
   const Schema *scan_schema;
@@ -553,4 +2075,1445 @@ TEST_F(ExecutorTest, DISABLED_SimpleGroupByAggregation) {
   }
 }
 
+// NOLINTNEXTLINE
+TEST_F(ExecutorTest, SpillingAggregationTest) {
+  // SELECT colA, count(colB), sum(colB) FROM test_1 GROUP BY colA, with a budget that is a few dozen groups
+  std::unique_ptr<AbstractPlanNode> scan_plan;
+  const Schema *scan_schema;
+  {
+    auto table_info = GetExecutorContext()->GetCatalog()->GetTable("test_1");
+    auto &schema = table_info->schema_;
+    auto colA = MakeColumnValueExpression(schema, 0, "colA");
+    auto colB = MakeColumnValueExpression(schema, 0, "colB");
+    scan_schema = MakeOutputSchema({{"colA", colA}, {"colB", colB}});
+    scan_plan = std::make_unique<SeqScanPlanNode>(scan_schema, nullptr, table_info->oid_);
+  }
+
+  std::unique_ptr<AbstractPlanNode> agg_plan;
+  const Schema *agg_schema;
+  {
+    const AbstractExpression *colA = MakeColumnValueExpression(*scan_schema, 0, "colA");
+    const AbstractExpression *colB = MakeColumnValueExpression(*scan_schema, 0, "colB");
+    std::vector<const AbstractExpression *> group_by_cols{colA};
+    std::vector<const AbstractExpression *> aggregate_cols{colB, colB};
+    std::vector<AggregationType> agg_types{AggregationType::CountAggregate, AggregationType::SumAggregate};
+    const AbstractExpression *groupbyA = MakeAggregateValueExpression(true, 0);
+    const AbstractExpression *countB = MakeAggregateValueExpression(false, 0);
+    const AbstractExpression *sumB = MakeAggregateValueExpression(false, 1);
+    agg_schema = MakeOutputSchema({{"colA", groupbyA}, {"countB", countB}, {"sumB", sumB}});
+    agg_plan = std::make_unique<AggregationPlanNode>(agg_schema, scan_plan.get(), nullptr, std::move(group_by_cols),
+                                                     std::move(aggregate_cols), std::move(agg_types));
+  }
+
+  auto run = [&](size_t memory_budget) {
+    GetExecutorContext()->SetMemoryBudget(memory_budget);
+    std::vector<Tuple> result_set;
+    GetExecutionEngine()->Execute(agg_plan.get(), &result_set, GetTxn(), GetExecutorContext());
+    std::map<int32_t, std::pair<int32_t, int32_t>> groups;
+    for (const auto &tuple : result_set) {
+      auto colA = tuple.GetValue(agg_schema, 0).GetAs<int32_t>();
+      EXPECT_EQ(0, groups.count(colA));
+      groups[colA] = {tuple.GetValue(agg_schema, 1).GetAs<int32_t>(), tuple.GetValue(agg_schema, 2).GetAs<int32_t>()};
+    }
+    return groups;
+  };
+
+  // the groups that spill, and are split again, come out once, as they do in memory
+  auto expected = run(QUERY_MEMORY_BUDGET);
+  ASSERT_EQ(TEST1_SIZE, expected.size());
+  for (const auto &[colA, aggregates] : expected) {
+    EXPECT_EQ(1, aggregates.first) << colA;
+  }
+  EXPECT_EQ(expected, run(2048));
+  EXPECT_EQ(expected, run(1));
+}
+
+// NOLINTNEXTLINE
+TEST_F(ExecutorTest, DistinctTest) {
+  // SELECT DISTINCT colB FROM test_1, and SELECT DISTINCT colA, colB FROM test_1
+  auto table_info = GetExecutorContext()->GetCatalog()->GetTable("test_1");
+  auto &schema = table_info->schema_;
+  auto colA = MakeColumnValueExpression(schema, 0, "colA");
+  auto colB = MakeColumnValueExpression(schema, 0, "colB");
+  auto *b_schema = MakeOutputSchema({{"colB", colB}});
+  auto *ab_schema = MakeOutputSchema({{"colA", colA}, {"colB", colB}});
+  SeqScanPlanNode b_scan(b_schema, nullptr, table_info->oid_);
+  SeqScanPlanNode ab_scan(ab_schema, nullptr, table_info->oid_);
+  DistinctPlanNode b_distinct(b_schema, &b_scan);
+  DistinctPlanNode ab_distinct(ab_schema, &ab_scan);
+
+  // in memory, the values come out in the order they are first seen in, as the scan returns them
+  std::vector<Tuple> scan_set;
+  GetExecutionEngine()->Execute(&b_scan, &scan_set, GetTxn(), GetExecutorContext());
+  std::vector<int32_t> first_seen;
+  for (const auto &tuple : scan_set) {
+    auto value = tuple.GetValue(b_schema, 0).GetAs<int32_t>();
+    if (std::find(first_seen.begin(), first_seen.end(), value) == first_seen.end()) {
+      first_seen.push_back(value);
+    }
+  }
+  ASSERT_EQ(10, first_seen.size());
+  std::vector<Tuple> result_set;
+  GetExecutionEngine()->Execute(&b_distinct, &result_set, GetTxn(), GetExecutorContext());
+  ASSERT_EQ(first_seen.size(), result_set.size());
+  for (size_t i = 0; i < result_set.size(); i++) {
+    EXPECT_EQ(first_seen[i], result_set[i].GetValue(b_schema, 0).GetAs<int32_t>());
+  }
+
+  // a limit takes the first values without the rest of them being looked for
+  LimitPlanNode limit_plan(b_schema, &b_distinct, 3, 0);
+  result_set.clear();
+  GetExecutionEngine()->Execute(&limit_plan, &result_set, GetTxn(), GetExecutorContext());
+  ASSERT_EQ(3, result_set.size());
+  for (size_t i = 0; i < result_set.size(); i++) {
+    EXPECT_EQ(first_seen[i], result_set[i].GetValue(b_schema, 0).GetAs<int32_t>());
+  }
+
+  // the tuples that spill come out once, as they do in memory
+  auto run = [&](const DistinctPlanNode *plan, size_t memory_budget) {
+    GetExecutorContext()->SetMemoryBudget(memory_budget);
+    std::vector<Tuple> distinct_set;
+    GetExecutionEngine()->Execute(plan, &distinct_set, GetTxn(), GetExecutorContext());
+    std::multiset<std::pair<int32_t, int32_t>> values;
+    for (const auto &tuple : distinct_set) {
+      const Schema *output = plan->OutputSchema();
+      int32_t b_value = tuple.GetValue(output, output->GetColumnCount() - 1).GetAs<int32_t>();
+      int32_t a_value = output->GetColumnCount() == 2 ? tuple.GetValue(output, 0).GetAs<int32_t>() : 0;
+      values.emplace(a_value, b_value);
+    }
+    GetExecutorContext()->SetMemoryBudget(QUERY_MEMORY_BUDGET);
+    return values;
+  };
+  auto b_values = run(&b_distinct, QUERY_MEMORY_BUDGET);
+  EXPECT_EQ(10, b_values.size());
+  EXPECT_EQ(b_values, run(&b_distinct, 1));
+  auto ab_values = run(&ab_distinct, QUERY_MEMORY_BUDGET);
+  EXPECT_EQ(TEST1_SIZE, ab_values.size());
+  EXPECT_EQ(ab_values, run(&ab_distinct, 4096));
+  EXPECT_EQ(ab_values, run(&ab_distinct, 1));
+}
+
+// NOLINTNEXTLINE
+TEST_F(ExecutorTest, ParallelAggregationTest) {
+  // SELECT colB, count(colA), sum(colA), min(colA), max(colA) FROM test_1 WHERE colA < 900 GROUP BY colB, and the same
+  // grouped by colA, on one thread and on four
+  std::unique_ptr<AbstractPlanNode> scan_plan;
+  const Schema *scan_schema;
+  const AbstractExpression *predicate;
+  {
+    auto table_info = GetExecutorContext()->GetCatalog()->GetTable("test_1");
+    auto &schema = table_info->schema_;
+    auto colA = MakeColumnValueExpression(schema, 0, "colA");
+    auto colB = MakeColumnValueExpression(schema, 0, "colB");
+    predicate = MakeComparisonExpression(colA, MakeConstantValueExpression(ValueFactory::GetIntegerValue(900)),
+                                         ComparisonType::LessThan);
+    scan_schema = MakeOutputSchema({{"colA", colA}, {"colB", colB}});
+    scan_plan = std::make_unique<SeqScanPlanNode>(scan_schema, predicate, table_info->oid_);
+  }
+
+  const AbstractExpression *colA = MakeColumnValueExpression(*scan_schema, 0, "colA");
+  const AbstractExpression *colB = MakeColumnValueExpression(*scan_schema, 0, "colB");
+  const AbstractExpression *group = MakeAggregateValueExpression(true, 0);
+  std::vector<const AbstractExpression *> aggregates;
+  std::vector<std::pair<std::string, const AbstractExpression *>> columns{{"group", group}};
+  for (uint32_t i = 0; i < 4; i++) {
+    aggregates.push_back(MakeAggregateValueExpression(false, i));
+    columns.emplace_back("agg" + std::to_string(i), aggregates.back());
+  }
+  const Schema *agg_schema = MakeOutputSchema(columns);
+
+  auto run = [&](const AbstractExpression *group_by, size_t num_threads) {
+    AggregationPlanNode agg_plan(agg_schema, scan_plan.get(), nullptr, {group_by}, {colA, colA, colA, colA},
+                                 {AggregationType::CountAggregate, AggregationType::SumAggregate,
+                                  AggregationType::MinAggregate, AggregationType::MaxAggregate},
+                                 num_threads);
+    std::vector<Tuple> result_set;
+    GetExecutionEngine()->Execute(&agg_plan, &result_set, GetTxn(), GetExecutorContext());
+    std::map<int32_t, std::vector<int32_t>> groups;
+    for (const auto &tuple : result_set) {
+      auto key = tuple.GetValue(agg_schema, 0).GetAs<int32_t>();
+      EXPECT_EQ(0, groups.count(key));
+      for (uint32_t i = 1; i <= 4; i++) {
+        groups[key].push_back(tuple.GetValue(agg_schema, i).GetAs<int32_t>());
+      }
+    }
+    return groups;
+  };
+
+  // the partial states of the workers merge into the groups of a single thread
+  auto by_b = run(colB, 1);
+  ASSERT_EQ(10, by_b.size());
+  int32_t total = 0;
+  for (const auto &[colB, aggregates] : by_b) {
+    total += aggregates[0];
+  }
+  EXPECT_EQ(900, total);
+  EXPECT_EQ(by_b, run(colB, 4));
+
+  auto by_a = run(colA, 1);
+  ASSERT_EQ(900, by_a.size());
+  EXPECT_EQ(by_a, run(colA, 4));
+
+  // the workers make the rows of a scan that reorders the columns of the table out of the rows they read
+  {
+    auto table_info = GetExecutorContext()->GetCatalog()->GetTable("test_1");
+    auto &schema = table_info->schema_;
+    const Schema *swapped_schema = MakeOutputSchema({{"colB", MakeColumnValueExpression(schema, 0, "colB")},
+                                                     {"colA", MakeColumnValueExpression(schema, 0, "colA")}});
+    scan_plan = std::make_unique<SeqScanPlanNode>(swapped_schema, predicate, table_info->oid_);
+    colA = MakeColumnValueExpression(*swapped_schema, 0, "colA");
+    colB = MakeColumnValueExpression(*swapped_schema, 0, "colB");
+  }
+  EXPECT_EQ(by_b, run(colB, 1));
+  EXPECT_EQ(by_b, run(colB, 4));
+
+  // groups that do not fit the budget on the workers are aggregated on one thread, spilling
+  GetExecutorContext()->SetMemoryBudget(4096);
+  EXPECT_EQ(by_a, run(colA, 4));
+}
+
+// NOLINTNEXTLINE
+TEST_F(ExecutorTest, ApproxAggregationTest) {
+  // SELECT APPROX_COUNT_DISTINCT(colA), APPROX_COUNT_DISTINCT(colB), APPROX_PERCENTILE(colA, 0.5),
+  // APPROX_PERCENTILE(colA, 0.9) FROM test_1 WHERE colA < bound, on one thread and on four
+  auto run = [&](int32_t bound, size_t num_threads) {
+    auto table_info = GetExecutorContext()->GetCatalog()->GetTable("test_1");
+    auto &schema = table_info->schema_;
+    auto predicate = MakeComparisonExpression(MakeColumnValueExpression(schema, 0, "colA"),
+                                              MakeConstantValueExpression(ValueFactory::GetIntegerValue(bound)),
+                                              ComparisonType::LessThan);
+    const Schema *scan_schema = MakeOutputSchema({{"colA", MakeColumnValueExpression(schema, 0, "colA")},
+                                                  {"colB", MakeColumnValueExpression(schema, 0, "colB")}});
+    SeqScanPlanNode scan_plan(scan_schema, predicate, table_info->oid_);
+
+    const AbstractExpression *colA = MakeColumnValueExpression(*scan_schema, 0, "colA");
+    const AbstractExpression *colB = MakeColumnValueExpression(*scan_schema, 0, "colB");
+    std::vector<std::pair<std::string, const AbstractExpression *>> columns;
+    for (uint32_t i = 0; i < 4; i++) {
+      columns.emplace_back("agg" + std::to_string(i), MakeAggregateValueExpression(false, i));
+    }
+    const Schema *agg_schema = MakeOutputSchema(columns);
+    AggregationPlanNode agg_plan(agg_schema, &scan_plan, nullptr, {}, {colA, colB, colA, colA},
+                                 {AggregationType::ApproxCountDistinctAggregate,
+                                  AggregationType::ApproxCountDistinctAggregate,
+                                  AggregationType::ApproxPercentileAggregate,
+                                  AggregationType::ApproxPercentileAggregate},
+                                 num_threads, {0, 0, 0.5, 0.9});
+    std::vector<Tuple> result_set;
+    GetExecutionEngine()->Execute(&agg_plan, &result_set, GetTxn(), GetExecutorContext());
+    EXPECT_EQ(1, result_set.size());
+    std::vector<Value> values;
+    for (uint32_t i = 0; i < 4; i++) {
+      values.push_back(result_set[0].GetValue(agg_schema, i));
+    }
+    return values;
+  };
+
+  // the sketches of the workers merge into those of a single thread
+  for (size_t num_threads : {1, 4}) {
+    auto values = run(TEST1_SIZE, num_threads);
+    EXPECT_NEAR(TEST1_SIZE, values[0].GetAs<int32_t>(), 0.05 * TEST1_SIZE);
+    EXPECT_EQ(10, values[1].GetAs<int32_t>());
+    EXPECT_NEAR(500, values[2].GetAs<int32_t>(), 15);
+    EXPECT_NEAR(900, values[3].GetAs<int32_t>(), 15);
+  }
+
+  // no input counts no distinct values, and has no percentiles
+  auto values = run(0, 1);
+  EXPECT_EQ(0, values[0].GetAs<int32_t>());
+  EXPECT_TRUE(values[2].IsNull());
+  EXPECT_TRUE(values[3].IsNull());
+}
+
+// NOLINTNEXTLINE
+TEST_F(ExecutorTest, PipelineSchedulerTest) {
+  auto table_info = GetExecutorContext()->GetCatalog()->GetTable("test_1");
+  TableHeap *table = table_info->table_.get();
+  const Schema *schema = &table_info->schema_;
+  const size_t num_workers = 4;
+  PipelineScheduler scheduler(GetExecutorContext(), num_workers);
+
+  // the workers scan every row of the table once, between them
+  std::vector<std::vector<int32_t>> seen(num_workers);
+  ASSERT_TRUE(scheduler.RunScan(table, [&](size_t worker, const std::vector<page_id_t> &morsel) {
+    TablePageScanner scanner(table, GetTxn(), morsel);
+    Tuple view;
+    while (scanner.Next(&view)) {
+      seen[worker].push_back(view.GetValue(schema, 0).GetAs<int32_t>());
+    }
+    return true;
+  }));
+  std::vector<int32_t> all;
+  for (const auto &rows : seen) {
+    all.insert(all.end(), rows.begin(), rows.end());
+  }
+  std::sort(all.begin(), all.end());
+  ASSERT_EQ(TEST1_SIZE, all.size());
+  for (size_t i = 0; i < all.size(); i++) {
+    ASSERT_EQ(static_cast<int32_t>(i), all[i]);
+  }
+
+  // and run every task once; a task that returns false stops the pipeline
+  std::vector<std::atomic<int>> runs(1000);
+  ASSERT_TRUE(scheduler.RunTasks(runs.size(), [&](size_t /*worker*/, size_t task) {
+    runs[task]++;
+    return true;
+  }));
+  for (auto &run : runs) {
+    ASSERT_EQ(1, run);
+  }
+  std::atomic<size_t> run_count{0};
+  EXPECT_FALSE(scheduler.RunTasks(runs.size(), [&](size_t /*worker*/, size_t /*task*/) {
+    run_count++;
+    return false;
+  }));
+  // no worker claims a task after its first, as at most the others' first tasks are running by then
+  EXPECT_LE(run_count, num_workers);
+
+  // a cancelled query stops its pipelines, and its queries have no result
+  GetExecutorContext()->Cancel();
+  EXPECT_THROW(scheduler.RunTasks(runs.size(), [&](size_t /*worker*/, size_t /*task*/) { return true; }), Exception);
+  auto colA = MakeColumnValueExpression(*schema, 0, "colA");
+  auto colB = MakeColumnValueExpression(*schema, 0, "colB");
+  auto *scan_schema = MakeOutputSchema({{"colA", colA}, {"colB", colB}});
+  SeqScanPlanNode scan_plan(scan_schema, nullptr, table_info->oid_);
+  std::vector<Tuple> result_set;
+  EXPECT_FALSE(GetExecutionEngine()->Execute(&scan_plan, &result_set, GetTxn(), GetExecutorContext()));
+  EXPECT_TRUE(result_set.empty());
+  auto *agg_schema = MakeOutputSchema({{"countA", MakeAggregateValueExpression(false, 0)}});
+  AggregationPlanNode agg_plan(agg_schema, &scan_plan, nullptr, {}, {colA}, {AggregationType::CountAggregate},
+                               num_workers);
+  EXPECT_FALSE(GetExecutionEngine()->Execute(&agg_plan, &result_set, GetTxn(), GetExecutorContext()));
+  EXPECT_TRUE(result_set.empty());
+}
+
+// NOLINTNEXTLINE
+TEST_F(ExecutorTest, PushPipelineTest) {
+  // SELECT colB, count(colA), sum(colA) FROM test_2 t JOIN (test_2 u JOIN test_1 ON u.col1 = colA) ON t.col2 = colB
+  // GROUP BY colB, whose joins both probe with the rows of test_1
+  std::unique_ptr<AbstractPlanNode> left_plan;
+  const Schema *left_schema;
+  {
+    auto table_info = GetExecutorContext()->GetCatalog()->GetTable("test_2");
+    auto &schema = table_info->schema_;
+    auto col1 = MakeColumnValueExpression(schema, 0, "col1");
+    auto col2 = MakeColumnValueExpression(schema, 0, "col2");
+    left_schema = MakeOutputSchema({{"col1", col1}, {"col2", col2}});
+    left_plan = std::make_unique<SeqScanPlanNode>(left_schema, nullptr, table_info->oid_);
+  }
+  std::unique_ptr<AbstractPlanNode> scan_plan;
+  const Schema *scan_schema;
+  {
+    auto table_info = GetExecutorContext()->GetCatalog()->GetTable("test_1");
+    auto &schema = table_info->schema_;
+    auto colA = MakeColumnValueExpression(schema, 0, "colA");
+    auto colB = MakeColumnValueExpression(schema, 0, "colB");
+    scan_schema = MakeOutputSchema({{"colA", colA}, {"colB", colB}});
+    scan_plan = std::make_unique<SeqScanPlanNode>(scan_schema, nullptr, table_info->oid_);
+  }
+  auto col1 = MakeColumnValueExpression(*left_schema, 0, "col1");
+  auto col2 = MakeColumnValueExpression(*left_schema, 0, "col2");
+  auto *inner_schema = MakeOutputSchema({{"colA", MakeColumnValueExpression(*scan_schema, 1, "colA")},
+                                         {"colB", MakeColumnValueExpression(*scan_schema, 1, "colB")}});
+  auto scan_colA = MakeColumnValueExpression(*scan_schema, 1, "colA");
+  HashJoinPlanNode inner_join{inner_schema,
+                              {left_plan.get(), scan_plan.get()},
+                              std::vector<const AbstractExpression *>{col1},
+                              std::vector<const AbstractExpression *>{scan_colA},
+                              1};
+  auto *outer_schema = MakeOutputSchema({{"col1", col1},
+                                         {"colA", MakeColumnValueExpression(*inner_schema, 1, "colA")},
+                                         {"colB", MakeColumnValueExpression(*inner_schema, 1, "colB")}});
+  auto inner_colB = MakeColumnValueExpression(*inner_schema, 1, "colB");
+  HashJoinPlanNode outer_join{outer_schema,
+                              {left_plan.get(), &inner_join},
+                              std::vector<const AbstractExpression *>{col2},
+                              std::vector<const AbstractExpression *>{inner_colB},
+                              1};
+
+  // the chain of joins compiles into a pipeline, which pushes its rows into the sink in batches
+  class CountingSink : public PushStage {
+   public:
+    bool Consume(DataChunk *chunk) override {
+      batches_++;
+      rows_ += chunk->GetSelectedCount();
+      return true;
+    }
+    size_t batches_{0};
+    size_t rows_{0};
+  };
+  auto pipeline = PushPipeline::Compile(GetExecutorContext(), &outer_join);
+  ASSERT_NE(nullptr, pipeline);
+  EXPECT_EQ(outer_schema, pipeline->GetOutputSchema());
+  CountingSink sink;
+  ASSERT_TRUE(pipeline->Run(&sink));
+  std::vector<Tuple> join_result;
+  GetExecutionEngine()->Execute(&outer_join, &join_result, GetTxn(), GetExecutorContext());
+  ASSERT_GT(join_result.size(), 0);
+  EXPECT_EQ(join_result.size(), sink.rows_);
+  EXPECT_LT(sink.batches_, sink.rows_);
+
+  const AbstractExpression *colA = MakeColumnValueExpression(*outer_schema, 0, "colA");
+  const AbstractExpression *colB = MakeColumnValueExpression(*outer_schema, 0, "colB");
+  AggregationPlanNode shape_plan(outer_schema, &outer_join, nullptr, {colB}, {colA},
+                                         {AggregationType::CountAggregate});
+  EXPECT_EQ(nullptr, PushPipeline::Compile(GetExecutorContext(), &shape_plan));
+
+  auto *agg_schema = MakeOutputSchema({{"colB", MakeAggregateValueExpression(true, 0)},
+                                       {"countA", MakeAggregateValueExpression(false, 0)},
+                                       {"sumA", MakeAggregateValueExpression(false, 1)}});
+  AggregationPlanNode agg_plan(agg_schema, &outer_join, nullptr, {colB}, {colA, colA},
+                               {AggregationType::CountAggregate, AggregationType::SumAggregate});
+  auto run = [&]() {
+    std::vector<Tuple> result_set;
+    GetExecutionEngine()->Execute(&agg_plan, &result_set, GetTxn(), GetExecutorContext());
+    std::map<int32_t, std::pair<int32_t, int32_t>> groups;
+    for (const auto &tuple : result_set) {
+      groups[tuple.GetValue(agg_schema, 0).GetAs<int32_t>()] = {tuple.GetValue(agg_schema, 1).GetAs<int32_t>(),
+                                                                tuple.GetValue(agg_schema, 2).GetAs<int32_t>()};
+    }
+    return groups;
+  };
+
+  // the aggregation comes out the same pushed, pulled, and pulled again when the build sides outgrow the budget
+  auto pushed = run();
+  ASSERT_FALSE(pushed.empty());
+  int32_t total = 0;
+  for (const auto &[colB, aggregates] : pushed) {
+    total += aggregates.first;
+  }
+  EXPECT_EQ(join_result.size(), total);
+  GetExecutorContext()->SetPushExecution(false);
+  EXPECT_EQ(pushed, run());
+  GetExecutorContext()->SetPushExecution(true);
+  GetExecutorContext()->SetMemoryBudget(256);
+  EXPECT_FALSE(PushPipeline::Compile(GetExecutorContext(), &outer_join)->Run(&sink));
+  EXPECT_EQ(pushed, run());
+}
+
+// NOLINTNEXTLINE
+TEST_F(ExecutorTest, ProfilingTest) {
+  auto table_info = GetExecutorContext()->GetCatalog()->GetTable("test_1");
+  auto &schema = table_info->schema_;
+  auto colA = MakeColumnValueExpression(schema, 0, "colA");
+  auto colB = MakeColumnValueExpression(schema, 0, "colB");
+  auto *out_schema1 = MakeOutputSchema({{"colA", colA}, {"colB", colB}});
+  SeqScanPlanNode scan_plan1{out_schema1, nullptr, table_info->oid_};
+  auto table2_info = GetExecutorContext()->GetCatalog()->GetTable("test_2");
+  auto col1 = MakeColumnValueExpression(table2_info->schema_, 0, "col1");
+  auto col2 = MakeColumnValueExpression(table2_info->schema_, 0, "col2");
+  auto *out_schema2 = MakeOutputSchema({{"col1", col1}, {"col2", col2}});
+  SeqScanPlanNode scan_plan2{out_schema2, nullptr, table2_info->oid_};
+
+  // SELECT col1, colA FROM test_2 JOIN test_1 ON col1 = colA
+  auto join_col1 = MakeColumnValueExpression(*out_schema2, 0, "col1");
+  auto join_colA = MakeColumnValueExpression(*out_schema1, 1, "colA");
+  auto *out_final = MakeOutputSchema({{"col1", join_col1}, {"colA", join_colA}});
+  HashJoinPlanNode join_plan{out_final,
+                             {&scan_plan2, &scan_plan1},
+                             std::vector<const AbstractExpression *>{join_col1},
+                             std::vector<const AbstractExpression *>{join_colA}};
+  {
+    QueryProfile profile;
+    std::vector<Tuple> result_set;
+    GetExecutionEngine()->Execute(&join_plan, &result_set, GetTxn(), GetExecutorContext(), &profile);
+    ASSERT_EQ(TEST2_SIZE, result_set.size());
+    EXPECT_EQ(nullptr, GetExecutorContext()->GetProfile());
+
+    // the report has the shape of the plan, and each node counts the rows it produced
+    OperatorProfile report = profile.GetReport();
+    EXPECT_EQ(PlanType::HashJoin, report.type_);
+    EXPECT_EQ(1, report.executors_);
+    EXPECT_EQ(result_set.size(), report.rows_);
+    ASSERT_EQ(2, report.children_.size());
+    EXPECT_EQ(TEST2_SIZE, report.children_[0].rows_);
+    for (const OperatorProfile &scan : report.children_) {
+      EXPECT_EQ(PlanType::SeqScan, scan.type_);
+      EXPECT_EQ(1, scan.executors_);
+      EXPECT_GT(scan.page_hits_ + scan.page_misses_, 0);
+      EXPECT_LE(scan.wall_ns_, report.wall_ns_);
+    }
+    EXPECT_LE(report.wall_ns_, profile.GetTotalWallNs());
+    EXPECT_NE(std::string::npos, report.ToString().find("  SeqScan (rows=100"));
+  }
+
+  // a sort that a limit folded into a top-N has no executor of its own
+  auto sort_colA = MakeColumnValueExpression(*out_schema1, 0, "colA");
+  SortPlanNode sort_plan{out_schema1, &scan_plan1, {{OrderByType::DESC, sort_colA}}};
+  LimitPlanNode limit_plan{out_schema1, &sort_plan, 10, 0};
+  {
+    QueryProfile profile;
+    std::vector<Tuple> result_set;
+    GetExecutionEngine()->Execute(&limit_plan, &result_set, GetTxn(), GetExecutorContext(), &profile);
+    ASSERT_EQ(10, result_set.size());
+    OperatorProfile report = profile.GetReport();
+    EXPECT_EQ(10, report.rows_);
+    ASSERT_EQ(1, report.children_.size());
+    EXPECT_EQ(0, report.children_[0].executors_);
+    EXPECT_NE(std::string::npos, report.ToString().find("Sort (not run on its own)"));
+  }
+
+  // and one that runs out of memory counts the bytes it spilled
+  size_t memory_budget = GetExecutorContext()->GetMemoryBudget();
+  GetExecutorContext()->SetMemoryBudget(size_t{4} * PAGE_SIZE);
+  {
+    QueryProfile profile;
+    std::vector<Tuple> result_set;
+    GetExecutionEngine()->Execute(&sort_plan, &result_set, GetTxn(), GetExecutorContext(), &profile);
+    ASSERT_EQ(TEST1_SIZE, result_set.size());
+    OperatorProfile report = profile.GetReport();
+    EXPECT_EQ(TEST1_SIZE, report.rows_);
+    EXPECT_GT(report.spilled_bytes_, 0);
+    EXPECT_EQ(0, report.children_[0].spilled_bytes_);
+  }
+  GetExecutorContext()->SetMemoryBudget(memory_budget);
+}
+
+// NOLINTNEXTLINE
+TEST_F(ExecutorTest, TracingTest) {
+  // SELECT col1, colA FROM test_2 JOIN test_1 ON col1 = colA, traced and profiled at once
+  auto table_info = GetExecutorContext()->GetCatalog()->GetTable("test_1");
+  auto *out_schema1 = MakeOutputSchema({{"colA", MakeColumnValueExpression(table_info->schema_, 0, "colA")}});
+  SeqScanPlanNode scan_plan1{out_schema1, nullptr, table_info->oid_};
+  auto table2_info = GetExecutorContext()->GetCatalog()->GetTable("test_2");
+  auto *out_schema2 = MakeOutputSchema({{"col1", MakeColumnValueExpression(table2_info->schema_, 0, "col1")}});
+  SeqScanPlanNode scan_plan2{out_schema2, nullptr, table2_info->oid_};
+  auto join_col1 = MakeColumnValueExpression(*out_schema2, 0, "col1");
+  auto join_colA = MakeColumnValueExpression(*out_schema1, 1, "colA");
+  auto *out_final = MakeOutputSchema({{"col1", join_col1}, {"colA", join_colA}});
+  HashJoinPlanNode join_plan{out_final,
+                             {&scan_plan2, &scan_plan1},
+                             std::vector<const AbstractExpression *>{join_col1},
+                             std::vector<const AbstractExpression *>{join_colA}};
+
+  Tracer::Enable();
+  Tracer::Clear();
+  QueryProfile profile;
+  std::vector<Tuple> result_set;
+  GetExecutionEngine()->Execute(&join_plan, &result_set, GetTxn(), GetExecutorContext(), &profile);
+  Tracer::Disable();
+  ASSERT_EQ(TEST2_SIZE, result_set.size());
+
+  // the query span holds the spans of the executors, on the thread that ran it
+  std::vector<TraceEvent> events = Tracer::GetEvents();
+  auto query = std::find_if(events.begin(), events.end(),
+                            [](const TraceEvent &event) { return std::string(event.name_) == "query"; });
+  ASSERT_NE(events.end(), query);
+  size_t inits = 0;
+  for (const TraceEvent &event : events) {
+    if (std::string(event.category_).rfind("executor.", 0) != 0) {
+      continue;
+    }
+    EXPECT_EQ(query->thread_, event.thread_);
+    EXPECT_GE(event.start_ns_, query->start_ns_);
+    EXPECT_LE(event.start_ns_ + event.duration_ns_, query->start_ns_ + query->duration_ns_);
+    inits += std::string(event.category_) == "executor.Init" ? 1 : 0;
+  }
+  EXPECT_EQ(3, inits);
+  EXPECT_EQ(TEST2_SIZE, profile.GetReport().rows_);
+
+  // a span of a batch has the rows of the batch
+  Tracer::Enable();
+  Tracer::Clear();
+  auto scan = ExecutorFactory::CreateExecutor(GetExecutorContext(), &scan_plan1);
+  scan->Init();
+  DataChunk chunk(out_schema1);
+  size_t rows = 0;
+  while (scan->NextBatch(&chunk)) {
+    rows += chunk.GetSelectedCount();
+  }
+  Tracer::Disable();
+  int64_t traced_rows = 0;
+  for (const TraceEvent &event : Tracer::GetEvents()) {
+    if (std::string(event.category_) == "executor.NextBatch") {
+      EXPECT_STREQ("SeqScan", event.name_);
+      ASSERT_STREQ("rows", event.arg_name_);
+      traced_rows += event.arg_;
+    }
+  }
+  EXPECT_EQ(TEST1_SIZE, rows);
+  EXPECT_EQ(rows, traced_rows);
+
+  // nothing is recorded once tracing is off
+  Tracer::Clear();
+  GetExecutionEngine()->Execute(&join_plan, &result_set, GetTxn(), GetExecutorContext());
+  EXPECT_TRUE(Tracer::GetEvents().empty());
+}
+
+// NOLINTNEXTLINE
+TEST_F(ExecutorTest, SortTest) {
+  std::unique_ptr<AbstractPlanNode> scan_plan;
+  const Schema *scan_schema;
+  {
+    auto table_info = GetExecutorContext()->GetCatalog()->GetTable("test_1");
+    auto &schema = table_info->schema_;
+    auto colA = MakeColumnValueExpression(schema, 0, "colA");
+    auto colB = MakeColumnValueExpression(schema, 0, "colB");
+    scan_schema = MakeOutputSchema({{"colA", colA}, {"colB", colB}});
+    scan_plan = std::make_unique<SeqScanPlanNode>(scan_schema, nullptr, table_info->oid_);
+  }
+  const AbstractExpression *colA = MakeColumnValueExpression(*scan_schema, 0, "colA");
+  const AbstractExpression *colB = MakeColumnValueExpression(*scan_schema, 0, "colB");
+
+  auto run = [&](std::vector<std::pair<OrderByType, const AbstractExpression *>> order_bys) {
+    SortPlanNode sort_plan(scan_schema, scan_plan.get(), std::move(order_bys));
+    std::vector<Tuple> result_set;
+    GetExecutionEngine()->Execute(&sort_plan, &result_set, GetTxn(), GetExecutorContext());
+    std::vector<std::pair<int32_t, int32_t>> rows;
+    for (const auto &tuple : result_set) {
+      // (colB, colA)
+      rows.emplace_back(tuple.GetValue(scan_schema, 1).GetAs<int32_t>(),
+                        tuple.GetValue(scan_schema, 0).GetAs<int32_t>());
+    }
+    return rows;
+  };
+
+  // in memory, in runs that are merged at once, and in runs of a few tuples that take many passes of two-way merges
+  for (size_t memory_budget : {QUERY_MEMORY_BUDGET, size_t{16} * PAGE_SIZE, size_t{256}}) {
+    GetExecutorContext()->SetMemoryBudget(memory_budget);
+
+    // ORDER BY colB, colA DESC
+    auto rows = run({{OrderByType::ASC, colB}, {OrderByType::DESC, colA}});
+    ASSERT_EQ(TEST1_SIZE, rows.size());
+    for (size_t i = 1; i < rows.size(); i++) {
+      ASSERT_TRUE(rows[i - 1].first < rows[i].first ||
+                  (rows[i - 1].first == rows[i].first && rows[i - 1].second > rows[i].second))
+          << memory_budget << ", " << i;
+    }
+
+    // ORDER BY colB DESC keeps the tuples of the same colB in the order of the scan, which is that of colA
+    rows = run({{OrderByType::DESC, colB}});
+    ASSERT_EQ(TEST1_SIZE, rows.size());
+    for (size_t i = 1; i < rows.size(); i++) {
+      ASSERT_TRUE(rows[i - 1].first > rows[i].first ||
+                  (rows[i - 1].first == rows[i].first && rows[i - 1].second < rows[i].second))
+          << memory_budget << ", " << i;
+    }
+  }
+
+  // the NULLs of the nullable col2 of test_2 are the largest values
+  auto table_info = GetExecutorContext()->GetCatalog()->GetTable("test_2");
+  auto col1 = MakeColumnValueExpression(table_info->schema_, 0, "col1");
+  auto col2 = MakeColumnValueExpression(table_info->schema_, 0, "col2");
+  auto *schema2 = MakeOutputSchema({{"col1", col1}, {"col2", col2}});
+  SeqScanPlanNode scan2(schema2, nullptr, table_info->oid_);
+  for (OrderByType type : {OrderByType::ASC, OrderByType::DESC}) {
+    SortPlanNode sort_plan(schema2, &scan2, {{type, MakeColumnValueExpression(*schema2, 0, "col2")}});
+    std::vector<Tuple> result_set;
+    GetExecutionEngine()->Execute(&sort_plan, &result_set, GetTxn(), GetExecutorContext());
+    ASSERT_EQ(TEST2_SIZE, result_set.size());
+    for (size_t i = 1; i < result_set.size(); i++) {
+      Value previous = result_set[i - 1].GetValue(schema2, 1);
+      Value value = result_set[i].GetValue(schema2, 1);
+      const Value &smaller = type == OrderByType::ASC ? previous : value;
+      const Value &larger = type == OrderByType::ASC ? value : previous;
+      ASSERT_TRUE(larger.IsNull() || (!smaller.IsNull() && smaller.GetAs<int32_t>() <= larger.GetAs<int32_t>()));
+    }
+  }
+}
+
+// NOLINTNEXTLINE
+TEST_F(ExecutorTest, SharedMemoryLimitTest) {
+  auto table_info = GetExecutorContext()->GetCatalog()->GetTable("test_1");
+  auto &schema = table_info->schema_;
+  auto colA = MakeColumnValueExpression(schema, 0, "colA");
+  auto colB = MakeColumnValueExpression(schema, 0, "colB");
+  auto colD = MakeColumnValueExpression(schema, 0, "colD");
+  auto *scan_schema = MakeOutputSchema({{"colA", colA}, {"colB", colB}, {"colD", colD}});
+  SeqScanPlanNode scan_plan{scan_schema, nullptr, table_info->oid_};
+  auto sort_colA = MakeColumnValueExpression(*scan_schema, 0, "colA");
+  SortPlanNode sort_plan{scan_schema, &scan_plan, {{OrderByType::DESC, sort_colA}}};
+
+  auto run = [&] {
+    std::vector<Tuple> result_set;
+    GetExecutionEngine()->Execute(&sort_plan, &result_set, GetTxn(), GetExecutorContext());
+    EXPECT_EQ(TEST1_SIZE, result_set.size());
+    for (size_t i = 0; i < result_set.size(); i++) {
+      EXPECT_EQ(static_cast<int32_t>(TEST1_SIZE - 1 - i), result_set[i].GetValue(scan_schema, 0).GetAs<int32_t>());
+    }
+  };
+
+  // the sort fits the budget of its query on its own
+  auto *spilled = GetExecutorContext()->GetSpillCounter();
+  run();
+  EXPECT_EQ(0, spilled->load());
+  EXPECT_GT(GetExecutorContext()->GetPeakMemoryUsage(), MemoryReservation::GRANT_UNIT);
+
+  // but another query holds half of what the manager they share grants, so it spills, and the other query is asked
+  // to give its memory back
+  MemoryManager manager(2 * MemoryReservation::GRANT_UNIT);
+  ExecutorContext other_query(GetTxn(), GetCatalog(), GetExecutorContext()->GetBufferPoolManager(), nullptr, nullptr);
+  other_query.SetMemoryManager(&manager);
+  MemoryReservation other(&other_query);
+  ASSERT_TRUE(other.Resize(MemoryReservation::GRANT_UNIT));
+  GetExecutorContext()->SetMemoryManager(&manager);
+  run();
+  GetExecutorContext()->SetMemoryManager(nullptr);
+  EXPECT_GT(spilled->load(), 0);
+  EXPECT_TRUE(other.IsRevoked());
+  EXPECT_EQ(2 * MemoryReservation::GRANT_UNIT, manager.GetPeakReserved());
+  EXPECT_EQ(MemoryReservation::GRANT_UNIT, manager.GetReserved());
+  EXPECT_EQ(0, GetExecutorContext()->GetMemoryUsage());
+}
+
+// NOLINTNEXTLINE
+TEST_F(ExecutorTest, LimitTest) {
+  // SELECT colA FROM test_1 LIMIT 10 OFFSET 990, and LIMIT 10 OFFSET 995, which has just 5 rows left
+  auto table_info = GetExecutorContext()->GetCatalog()->GetTable("test_1");
+  auto colA = MakeColumnValueExpression(table_info->schema_, 0, "colA");
+  auto *scan_schema = MakeOutputSchema({{"colA", colA}});
+  SeqScanPlanNode scan_plan(scan_schema, nullptr, table_info->oid_);
+  for (size_t offset : {990, 995}) {
+    LimitPlanNode limit_plan(scan_schema, &scan_plan, 10, offset);
+    std::vector<Tuple> result_set;
+    GetExecutionEngine()->Execute(&limit_plan, &result_set, GetTxn(), GetExecutorContext());
+    ASSERT_EQ(TEST1_SIZE - offset, result_set.size());
+    for (size_t i = 0; i < result_set.size(); i++) {
+      EXPECT_EQ(static_cast<int32_t>(offset + i), result_set[i].GetValue(scan_schema, 0).GetAs<int32_t>());
+    }
+  }
+}
+
+// NOLINTNEXTLINE
+TEST_F(ExecutorTest, LimitPushdownTest) {
+  // SELECT colA FROM test_1 LIMIT 10 OFFSET 5, a batch at a time: the scan reads no more than the 15 rows it is told
+  auto table_info = GetExecutorContext()->GetCatalog()->GetTable("test_1");
+  auto &schema = table_info->schema_;
+  auto colA = MakeColumnValueExpression(schema, 0, "colA");
+  auto colB = MakeColumnValueExpression(schema, 0, "colB");
+  auto *scan_schema = MakeOutputSchema({{"colA", colA}, {"colB", colB}});
+  SeqScanPlanNode scan_plan(scan_schema, nullptr, table_info->oid_);
+  LimitPlanNode limit_plan(scan_schema, &scan_plan, 10, 5);
+  {
+    auto executor = ExecutorFactory::CreateExecutor(GetExecutorContext(), &limit_plan);
+    executor->Init();
+    std::vector<Tuple> result_set;
+    DataChunk chunk(scan_schema);
+    while (executor->NextBatch(&chunk)) {
+      chunk.GetTuples(&result_set);
+    }
+    ASSERT_EQ(10, result_set.size());
+    for (size_t i = 0; i < result_set.size(); i++) {
+      EXPECT_EQ(static_cast<int32_t>(5 + i), result_set[i].GetValue(scan_schema, 0).GetAs<int32_t>());
+    }
+
+    auto scan = ExecutorFactory::CreateExecutor(GetExecutorContext(), &scan_plan);
+    scan->SetRowLimit(15);
+    scan->Init();
+    ASSERT_TRUE(scan->NextBatch(&chunk));
+    EXPECT_EQ(15, chunk.GetSelectedCount());
+    EXPECT_FALSE(scan->NextBatch(&chunk));
+  }
+
+  // ... WHERE colB < 5 LIMIT 7, which the scan counts after the predicate, as a batch and a tuple at a time
+  auto *five = MakeConstantValueExpression(ValueFactory::GetIntegerValue(5));
+  auto *predicate = MakeComparisonExpression(colB, five, ComparisonType::LessThan);
+  SeqScanPlanNode filtered_plan(scan_schema, predicate, table_info->oid_);
+  for (bool batch : {true, false}) {
+    auto scan = ExecutorFactory::CreateExecutor(GetExecutorContext(), &filtered_plan);
+    scan->SetRowLimit(7);
+    scan->Init();
+    std::vector<Tuple> result_set;
+    DataChunk chunk(scan_schema, 4);
+    Tuple tuple;
+    RID rid;
+    while (batch ? scan->NextBatch(&chunk) : scan->Next(&tuple, &rid)) {
+      if (batch) {
+        chunk.GetTuples(&result_set);
+      } else {
+        result_set.push_back(tuple);
+      }
+    }
+    ASSERT_EQ(7, result_set.size());
+    for (const auto &result : result_set) {
+      EXPECT_LT(result.GetValue(scan_schema, 1).GetAs<int32_t>(), 5);
+    }
+  }
+
+  // a parallel hash join of test_2 JOIN test_1 ON col2 = colB, which joins all of its partitions in its Init, stops
+  // short of the whole join once it made the 10 tuples of a limit
+  auto test2_info = GetExecutorContext()->GetCatalog()->GetTable("test_2");
+  auto col2 = MakeColumnValueExpression(test2_info->schema_, 0, "col2");
+  auto *left_schema = MakeOutputSchema({{"col2", col2}});
+  SeqScanPlanNode left_plan(left_schema, nullptr, test2_info->oid_);
+  auto left_key = MakeColumnValueExpression(*left_schema, 0, "col2");
+  auto right_key = MakeColumnValueExpression(*scan_schema, 1, "colB");
+  auto *join_schema = MakeOutputSchema({{"col2", left_key}, {"colB", right_key}});
+  HashJoinPlanNode join_plan{join_schema,
+                             {&left_plan, &scan_plan},
+                             std::vector<const AbstractExpression *>{left_key},
+                             std::vector<const AbstractExpression *>{right_key},
+                             4};
+  auto count = [&](size_t row_limit) {
+    auto join = ExecutorFactory::CreateExecutor(GetExecutorContext(), &join_plan);
+    join->SetRowLimit(row_limit);
+    join->Init();
+    size_t joined = 0;
+    Tuple tuple;
+    RID rid;
+    while (join->Next(&tuple, &rid)) {
+      EXPECT_EQ(tuple.GetValue(join_schema, 0).GetAs<int32_t>(), tuple.GetValue(join_schema, 1).GetAs<int32_t>());
+      joined++;
+    }
+    return joined;
+  };
+  size_t full = count(SIZE_MAX);
+  size_t limited = count(10);
+  EXPECT_GE(limited, 10);
+  EXPECT_LT(limited, full);
+
+  LimitPlanNode join_limit(join_schema, &join_plan, 10, 0);
+  std::vector<Tuple> result_set;
+  GetExecutionEngine()->Execute(&join_limit, &result_set, GetTxn(), GetExecutorContext());
+  EXPECT_EQ(10, result_set.size());
+}
+
+// NOLINTNEXTLINE
+TEST_F(ExecutorTest, TopNTest) {
+  // SELECT colA, colB FROM test_1 ORDER BY colB DESC, colA LIMIT k OFFSET m, against the whole sort
+  auto table_info = GetExecutorContext()->GetCatalog()->GetTable("test_1");
+  auto colA = MakeColumnValueExpression(table_info->schema_, 0, "colA");
+  auto colB = MakeColumnValueExpression(table_info->schema_, 0, "colB");
+  auto *scan_schema = MakeOutputSchema({{"colA", colA}, {"colB", colB}});
+  SeqScanPlanNode scan_plan(scan_schema, nullptr, table_info->oid_);
+  SortPlanNode sort_plan(scan_schema, &scan_plan,
+                         {{OrderByType::DESC, MakeColumnValueExpression(*scan_schema, 0, "colB")},
+                          {OrderByType::ASC, MakeColumnValueExpression(*scan_schema, 0, "colA")}});
+  std::vector<Tuple> sorted;
+  GetExecutionEngine()->Execute(&sort_plan, &sorted, GetTxn(), GetExecutorContext());
+  ASSERT_EQ(TEST1_SIZE, sorted.size());
+
+  for (auto [limit, offset] : std::vector<std::pair<size_t, size_t>>{{100, 0}, {10, 5}, {0, 0}, {10, 995}, {2000, 0}}) {
+    LimitPlanNode limit_plan(scan_schema, &sort_plan, limit, offset);
+    // the limit of the sort is fused into a single executor
+    auto executor = ExecutorFactory::CreateExecutor(GetExecutorContext(), &limit_plan);
+    ASSERT_NE(nullptr, dynamic_cast<TopNExecutor *>(executor.get()));
+
+    std::vector<Tuple> result_set;
+    GetExecutionEngine()->Execute(&limit_plan, &result_set, GetTxn(), GetExecutorContext());
+    size_t expected_size = std::min<size_t>(limit, TEST1_SIZE - std::min<size_t>(offset, TEST1_SIZE));
+    ASSERT_EQ(expected_size, result_set.size()) << limit << ", " << offset;
+    for (size_t i = 0; i < result_set.size(); i++) {
+      for (uint32_t col = 0; col < 2; col++) {
+        EXPECT_EQ(sorted[offset + i].GetValue(scan_schema, col).GetAs<int32_t>(),
+                  result_set[i].GetValue(scan_schema, col).GetAs<int32_t>());
+      }
+    }
+  }
+}
+
+// NOLINTNEXTLINE
+TEST_F(ExecutorTest, MergeJoinTest) {
+  // CREATE INDEX ON test_1 (colB, colA), and ON test_2 (col2, col1), whose scans are ordered by colB and col2
+  auto *catalog = GetExecutorContext()->GetCatalog();
+  TableMetadata *table1 = catalog->GetTable("test_1");
+  TableMetadata *table2 = catalog->GetTable("test_2");
+  std::unique_ptr<Schema> key_schema1(Schema::CopySchema(&table1->schema_, {1, 0}));
+  std::unique_ptr<Schema> key_schema2(Schema::CopySchema(&table2->schema_, {1, 0}));
+  auto *index1 = catalog->CreateIndex<GenericKey<8>, RID, GenericComparator<8>>(
+      GetTxn(), "index1", "test_1", table1->schema_, *key_schema1, {1, 0}, 8);
+  auto *index2 = catalog->CreateIndex<GenericKey<8>, RID, GenericComparator<8>>(
+      GetTxn(), "index2", "test_2", table2->schema_, *key_schema2, {1, 0}, 8);
+
+  auto *colA = MakeColumnValueExpression(table1->schema_, 0, "colA");
+  auto *colB = MakeColumnValueExpression(table1->schema_, 0, "colB");
+  auto *col1 = MakeColumnValueExpression(table2->schema_, 0, "col1");
+  auto *col2 = MakeColumnValueExpression(table2->schema_, 0, "col2");
+  auto *schema1 = MakeOutputSchema({{"colA", colA}, {"colB", colB}});
+  auto *schema2 = MakeOutputSchema({{"col1", col1}, {"col2", col2}});
+  auto *out_colA = MakeColumnValueExpression(*schema1, 0, "colA");
+  auto *out_colB = MakeColumnValueExpression(*schema1, 0, "colB");
+  auto *out_col1 = MakeColumnValueExpression(*schema2, 1, "col1");
+  auto *out_col2 = MakeColumnValueExpression(*schema2, 1, "col2");
+  auto *out_schema = MakeOutputSchema({{"colA", out_colA}, {"col1", out_col1}});
+
+  // the pairs of the join that a scan of both tables finds
+  auto expected_pairs = [&](uint32_t left_key, uint32_t right_key) {
+    SeqScanPlanNode scan1(schema1, nullptr, table1->oid_);
+    SeqScanPlanNode scan2(schema2, nullptr, table2->oid_);
+    std::vector<Tuple> left;
+    std::vector<Tuple> right;
+    GetExecutionEngine()->Execute(&scan1, &left, GetTxn(), GetExecutorContext());
+    GetExecutionEngine()->Execute(&scan2, &right, GetTxn(), GetExecutorContext());
+    std::multiset<std::pair<int32_t, int32_t>> pairs;
+    for (const auto &l : left) {
+      for (const auto &r : right) {
+        Value lv = l.GetValue(schema1, left_key);
+        Value rv = r.GetValue(schema2, right_key);
+        if (!lv.IsNull() && !rv.IsNull() && lv.CompareEquals(rv) == CmpBool::CmpTrue) {
+          pairs.emplace(l.GetValue(schema1, 0).GetAs<int32_t>(), r.GetValue(schema2, 0).GetAs<int16_t>());
+        }
+      }
+    }
+    return pairs;
+  };
+  auto join = [&](MergeJoinPlanNode *plan) {
+    std::vector<Tuple> result_set;
+    GetExecutionEngine()->Execute(plan, &result_set, GetTxn(), GetExecutorContext());
+    std::multiset<std::pair<int32_t, int32_t>> pairs;
+    for (const auto &tuple : result_set) {
+      pairs.emplace(tuple.GetValue(out_schema, 0).GetAs<int32_t>(), tuple.GetValue(out_schema, 1).GetAs<int16_t>());
+    }
+    return pairs;
+  };
+
+  // ... ON colB = col2 over the index scans, where many tuples of each side have a key, and the null col2s join none
+  IndexScanPlanNode index_scan1(schema1, nullptr, index1->index_oid_);
+  IndexScanPlanNode index_scan2(schema2, nullptr, index2->index_oid_);
+  MergeJoinPlanNode index_join(out_schema, {&index_scan1, &index_scan2}, {out_colB}, {out_col2});
+  auto expected = expected_pairs(1, 1);
+  ASSERT_GT(expected.size(), TEST2_SIZE);
+  EXPECT_EQ(expected, join(&index_join));
+
+  // ... ON colA = col1 over sorts of the tables, an INTEGER key with a SMALLINT one
+  SeqScanPlanNode scan1(schema1, nullptr, table1->oid_);
+  SeqScanPlanNode scan2(schema2, nullptr, table2->oid_);
+  SortPlanNode sort1(schema1, &scan1, {{OrderByType::ASC, out_colA}});
+  SortPlanNode sort2(schema2, &scan2, {{OrderByType::ASC, out_col1}});
+  MergeJoinPlanNode sort_join(out_schema, {&sort1, &sort2}, {out_colA}, {out_col1});
+  expected = expected_pairs(0, 0);
+  ASSERT_EQ(TEST2_SIZE, expected.size());
+  EXPECT_EQ(expected, join(&sort_join));
+}
+
+// An executor that only works a batch at a time, over a child, whose Next adapts its batches to rows
+class BatchOnlyExecutor : public AbstractExecutor {
+ public:
+  BatchOnlyExecutor(ExecutorContext *exec_ctx, std::unique_ptr<AbstractExecutor> &&child)
+      : AbstractExecutor(exec_ctx), child_(std::move(child)) {}
+
+  void Init() override {
+    child_->Init();
+    ResetBatchRows();
+  }
+
+  bool Next(Tuple *tuple, RID *rid) override { return NextFromBatch(tuple, rid); }
+
+  bool NextBatch(DataChunk *chunk) override { return child_->NextBatch(chunk); }
+
+  const Schema *GetOutputSchema() override { return child_->GetOutputSchema(); }
+
+ private:
+  std::unique_ptr<AbstractExecutor> child_;
+};
+
+// NOLINTNEXTLINE
+TEST_F(ExecutorTest, ProjectionTest) {
+  auto *table_info = GetExecutorContext()->GetCatalog()->GetTable("test_1");
+  auto &schema = table_info->schema_;
+  auto *colA = MakeColumnValueExpression(schema, 0, "colA");
+  auto *colB = MakeColumnValueExpression(schema, 0, "colB");
+  auto *colC = MakeColumnValueExpression(schema, 0, "colC");
+  auto *colD = MakeColumnValueExpression(schema, 0, "colD");
+  auto *full_schema = MakeOutputSchema({{"colA", colA}, {"colB", colB}, {"colC", colC}, {"colD", colD}});
+  SeqScanPlanNode full_scan(full_schema, nullptr, table_info->oid_);
+  std::vector<Tuple> full;
+  GetExecutionEngine()->Execute(&full_scan, &full, GetTxn(), GetExecutorContext());
+  ASSERT_EQ(TEST1_SIZE, full.size());
+
+  // SELECT colD, colA FROM test_1 WHERE colC < 5000, whose scan makes its tuples of the two columns alone
+  auto *predicate = MakeComparisonExpression(colC, MakeConstantValueExpression(ValueFactory::GetIntegerValue(5000)),
+                                             ComparisonType::LessThan);
+  auto *scan_schema = MakeOutputSchema({{"colD", colD}, {"colA", colA}});
+  SeqScanPlanNode scan(scan_schema, predicate, table_info->oid_);
+  std::vector<Tuple> result_set;
+  GetExecutionEngine()->Execute(&scan, &result_set, GetTxn(), GetExecutorContext());
+  size_t next = 0;
+  for (const Tuple &row : full) {
+    if (row.GetValue(full_schema, 2).GetAs<int32_t>() >= 5000) {
+      continue;
+    }
+    ASSERT_LT(next, result_set.size());
+    const Tuple &tuple = result_set[next++];
+    EXPECT_EQ(row.GetValue(full_schema, 3).GetAs<int32_t>(), tuple.GetValue(scan_schema, 0).GetAs<int32_t>());
+    EXPECT_EQ(row.GetValue(full_schema, 0).GetAs<int32_t>(), tuple.GetValue(scan_schema, 1).GetAs<int32_t>());
+    EXPECT_EQ(tuple.GetLength(), scan_schema->GetLength() + Tuple::NullBitmapSize(scan_schema));
+  }
+  EXPECT_EQ(next, result_set.size());
+
+  // SELECT colB, colD < colC FROM (SELECT * FROM test_1), tuple by tuple and a batch at a time
+  auto *proj_colB = MakeColumnValueExpression(*full_schema, 0, "colB");
+  auto *proj_less = MakeComparisonExpression(MakeColumnValueExpression(*full_schema, 0, "colD"),
+                                             MakeColumnValueExpression(*full_schema, 0, "colC"),
+                                             ComparisonType::LessThan);
+  auto *proj_schema = MakeOutputSchema({{"colB", proj_colB}, {"less", proj_less}});
+  ProjectionPlanNode projection(proj_schema, &full_scan);
+  result_set.clear();
+  GetExecutionEngine()->Execute(&projection, &result_set, GetTxn(), GetExecutorContext());
+  ASSERT_EQ(TEST1_SIZE, result_set.size());
+  std::vector<Tuple> batch_set;
+  auto executor = ExecutorFactory::CreateExecutor(GetExecutorContext(), &projection);
+  executor->Init();
+  DataChunk chunk(proj_schema, 7);
+  while (executor->NextBatch(&chunk)) {
+    chunk.GetTuples(&batch_set);
+  }
+  ASSERT_EQ(TEST1_SIZE, batch_set.size());
+  for (size_t i = 0; i < TEST1_SIZE; i++) {
+    int32_t b = full[i].GetValue(full_schema, 1).GetAs<int32_t>();
+    bool less = full[i].GetValue(full_schema, 3).GetAs<int32_t>() < full[i].GetValue(full_schema, 2).GetAs<int32_t>();
+    for (const Tuple *tuple : {&result_set[i], &batch_set[i]}) {
+      EXPECT_EQ(b, tuple->GetValue(proj_schema, 0).GetAs<int32_t>());
+      EXPECT_EQ(less, tuple->GetValue(proj_schema, 1).GetAs<bool>());
+    }
+  }
+}
+
+// NOLINTNEXTLINE
+TEST_F(ExecutorTest, BatchExecutionTest) {
+  auto *catalog = GetExecutorContext()->GetCatalog();
+  TableMetadata *table1 = catalog->GetTable("test_1");
+  TableMetadata *table2 = catalog->GetTable("test_2");
+  auto *colA = MakeColumnValueExpression(table1->schema_, 0, "colA");
+  auto *colB = MakeColumnValueExpression(table1->schema_, 0, "colB");
+  auto *col1 = MakeColumnValueExpression(table2->schema_, 0, "col1");
+  auto *col2 = MakeColumnValueExpression(table2->schema_, 0, "col2");
+  auto *schema1 = MakeOutputSchema({{"colA", colA}, {"colB", colB}});
+  auto *schema2 = MakeOutputSchema({{"col1", col1}, {"col2", col2}});
+
+  // the rows of tuples as strings, sorted, as only the joins' order differs between the two ways
+  auto rows_of = [](const std::vector<Tuple> &tuples, const Schema *schema) {
+    std::vector<std::string> rows;
+    for (const auto &tuple : tuples) {
+      std::string row;
+      for (uint32_t i = 0; i < schema->GetColumnCount(); i++) {
+        row += tuple.GetValue(schema, i).ToString() + "|";
+      }
+      rows.push_back(std::move(row));
+    }
+    std::sort(rows.begin(), rows.end());
+    return rows;
+  };
+  auto run_rows = [&](const AbstractPlanNode *plan) {
+    std::vector<Tuple> result_set;
+    GetExecutionEngine()->Execute(plan, &result_set, GetTxn(), GetExecutorContext());
+    return rows_of(result_set, plan->OutputSchema());
+  };
+  auto run_batches = [&](const AbstractPlanNode *plan, size_t capacity) {
+    auto executor = ExecutorFactory::CreateExecutor(GetExecutorContext(), plan);
+    executor->Init();
+    DataChunk chunk(plan->OutputSchema(), capacity);
+    std::vector<Tuple> result_set;
+    while (executor->NextBatch(&chunk)) {
+      EXPECT_GT(chunk.GetSelectedCount(), 0);
+      EXPECT_LE(chunk.GetSize(), capacity);
+      chunk.GetTuples(&result_set);
+    }
+    return rows_of(result_set, plan->OutputSchema());
+  };
+
+  // SELECT colA, colB FROM test_1 WHERE colA >= 100, in batches of the default size, a few rows, and one row
+  auto *predicate = MakeComparisonExpression(colA, MakeConstantValueExpression(ValueFactory::GetIntegerValue(100)),
+                                             ComparisonType::GreaterThanOrEqual);
+  SeqScanPlanNode filter_scan(schema1, predicate, table1->oid_);
+  auto expected = run_rows(&filter_scan);
+  ASSERT_EQ(TEST1_SIZE - 100, expected.size());
+  for (size_t capacity : {DataChunk::DEFAULT_CAPACITY, size_t{7}, size_t{1}}) {
+    EXPECT_EQ(expected, run_batches(&filter_scan, capacity));
+  }
+
+  // SELECT col1, colB, colA FROM test_2 JOIN test_1 ON col2 = colB, a projection on both sides of many matches each
+  SeqScanPlanNode scan1(schema1, nullptr, table1->oid_);
+  SeqScanPlanNode scan2(schema2, nullptr, table2->oid_);
+  auto *join_col1 = MakeColumnValueExpression(*schema2, 0, "col1");
+  auto *join_col2 = MakeColumnValueExpression(*schema2, 0, "col2");
+  auto *join_colA = MakeColumnValueExpression(*schema1, 1, "colA");
+  auto *join_colB = MakeColumnValueExpression(*schema1, 1, "colB");
+  auto *join_schema = MakeOutputSchema({{"col1", join_col1}, {"colB", join_colB}, {"colA", join_colA}});
+  HashJoinPlanNode join_plan{join_schema,
+                             {&scan2, &scan1},
+                             std::vector<const AbstractExpression *>{join_col2},
+                             std::vector<const AbstractExpression *>{join_colB}};
+  expected = run_rows(&join_plan);
+  ASSERT_GT(expected.size(), DataChunk::DEFAULT_CAPACITY);
+  for (size_t capacity : {DataChunk::DEFAULT_CAPACITY, size_t{7}}) {
+    EXPECT_EQ(expected, run_batches(&join_plan, capacity));
+  }
+
+  // SELECT colB, COUNT(colA), SUM(colA) FROM test_1 GROUP BY colB, which aggregates the batches of its scan
+  std::vector<const AbstractExpression *> group_bys{MakeColumnValueExpression(*schema1, 0, "colB")};
+  std::vector<const AbstractExpression *> aggregates{MakeColumnValueExpression(*schema1, 0, "colA"),
+                                                     MakeColumnValueExpression(*schema1, 0, "colA")};
+  std::vector<AggregationType> agg_types{AggregationType::CountAggregate, AggregationType::SumAggregate};
+  auto *agg_schema = MakeOutputSchema({{"colB", MakeAggregateValueExpression(true, 0)},
+                                       {"countA", MakeAggregateValueExpression(false, 0)},
+                                       {"sumA", MakeAggregateValueExpression(false, 1)}});
+  AggregationPlanNode agg_plan{agg_schema, &scan1, nullptr, std::move(group_bys), std::move(aggregates),
+                               std::move(agg_types)};
+  std::vector<Tuple> result_set;
+  GetExecutionEngine()->Execute(&agg_plan, &result_set, GetTxn(), GetExecutorContext());
+  ASSERT_EQ(10, result_set.size());
+  std::vector<Tuple> rows;
+  GetExecutionEngine()->Execute(&scan1, &rows, GetTxn(), GetExecutorContext());
+  std::map<int32_t, std::pair<int32_t, int32_t>> groups;
+  for (const auto &row : rows) {
+    auto &group = groups[row.GetValue(schema1, 1).GetAs<int32_t>()];
+    group.first++;
+    group.second += row.GetValue(schema1, 0).GetAs<int32_t>();
+  }
+  for (const auto &tuple : result_set) {
+    auto &group = groups[tuple.GetValue(agg_schema, 0).GetAs<int32_t>()];
+    EXPECT_EQ(group.first, tuple.GetValue(agg_schema, 1).GetAs<int32_t>());
+    EXPECT_EQ(group.second, tuple.GetValue(agg_schema, 2).GetAs<int32_t>());
+  }
+  EXPECT_EQ(rows_of(result_set, agg_schema), run_batches(&agg_plan, DataChunk::DEFAULT_CAPACITY));
+
+  // and an executor of batches alone hands out the same rows through Next, also after it is started over
+  BatchOnlyExecutor batch_only(GetExecutorContext(),
+                               ExecutorFactory::CreateExecutor(GetExecutorContext(), &filter_scan));
+  expected = run_rows(&filter_scan);
+  for (int i = 0; i < 2; i++) {
+    batch_only.Init();
+    Tuple tuple;
+    RID rid;
+    std::vector<Tuple> tuples;
+    while (batch_only.Next(&tuple, &rid)) {
+      tuples.push_back(tuple);
+    }
+    EXPECT_EQ(expected, rows_of(tuples, schema1));
+  }
+}
+
+// NOLINTNEXTLINE
+TEST_F(ExecutorTest, AggregationHashTableTest) {
+  // GROUP BY a VARCHAR and a nullable INTEGER: COUNT(c), SUM(c), MIN(d), MAX(d) of an INTEGER c and a DECIMAL d
+  ColumnValueExpression name(0, 0, TypeId::VARCHAR);
+  ColumnValueExpression group(0, 1, TypeId::INTEGER);
+  ColumnValueExpression c(0, 2, TypeId::INTEGER);
+  ColumnValueExpression d(0, 3, TypeId::DECIMAL);
+  std::vector<const AbstractExpression *> group_bys{&name, &group};
+  std::vector<const AbstractExpression *> aggregates{&c, &c, &d, &d};
+  std::vector<AggregationType> agg_types{AggregationType::CountAggregate, AggregationType::SumAggregate,
+                                         AggregationType::MinAggregate, AggregationType::MaxAggregate};
+  SimpleAggregationHashTable table(group_bys, aggregates, agg_types);
+
+  struct Expected {
+    int64_t count_{0};
+    int64_t sum_{0};
+    double min_{0};
+    double max_{0};
+  };
+  std::map<std::pair<std::string, int32_t>, Expected> expected;
+  for (int32_t i = 0; i < 20000; i++) {
+    // long names are not stored inline in their Values, and a group of the null value groups every null
+    std::string group_name = i % 3 == 0 ? "a long name of group " + std::to_string(i % 5) : std::to_string(i % 5);
+    int32_t group_value = i % 11 == 0 ? BUSTUB_INT32_NULL : i % 200;
+    Value c_value = i % 7 == 0 ? ValueFactory::GetNullValueByType(TypeId::INTEGER) : ValueFactory::GetIntegerValue(i);
+    double d_value = (i * 37 % 1001) / 4.0;
+    table.InsertCombine(AggregateKey{{ValueFactory::GetVarcharValue(group_name), Value(TypeId::INTEGER, group_value)}},
+                        AggregateValue{{c_value, c_value, ValueFactory::GetDecimalValue(d_value),
+                                        ValueFactory::GetDecimalValue(d_value)}});
+    auto [entry, inserted] = expected.insert({{group_name, group_value}, Expected{0, 0, d_value, d_value}});
+    if (i % 7 != 0) {
+      entry->second.count_++;
+      entry->second.sum_ += i;
+    }
+    entry->second.min_ = std::min(entry->second.min_, d_value);
+    entry->second.max_ = std::max(entry->second.max_, d_value);
+  }
+
+  ASSERT_EQ(expected.size(), table.GetSize());
+  for (auto it = table.Begin(); it != table.End(); ++it) {
+    AggregateKey key = it.Key();
+    AggregateValue val = it.Val();
+    auto entry = expected.find({key.group_bys_[0].ToString(), key.group_bys_[1].GetAs<int32_t>()});
+    ASSERT_NE(expected.end(), entry);
+    EXPECT_EQ(key.group_bys_[1].GetAs<int32_t>() == BUSTUB_INT32_NULL, key.group_bys_[1].IsNull());
+    EXPECT_EQ(entry->second.count_, val.aggregates_[0].GetAs<int32_t>());
+    // a group of nothing but null inputs sums to NULL
+    EXPECT_EQ(entry->second.count_ == 0, val.aggregates_[1].IsNull());
+    if (entry->second.count_ != 0) {
+      EXPECT_EQ(entry->second.sum_, val.aggregates_[1].GetAs<int32_t>());
+    }
+    EXPECT_EQ(entry->second.min_, val.aggregates_[2].GetAs<double>());
+    EXPECT_EQ(entry->second.max_, val.aggregates_[3].GetAs<double>());
+    expected.erase(entry);
+  }
+  EXPECT_TRUE(expected.empty());
+
+  // a group of an INTEGER key and four aggregates is a record of 48 bytes, next to a slot or two of 8 bytes
+  ColumnValueExpression key(0, 0, TypeId::INTEGER);
+  std::vector<const AbstractExpression *> int_group_bys{&key};
+  SimpleAggregationHashTable int_table(int_group_bys, aggregates, agg_types);
+  for (int32_t i = 0; i < 100000; i++) {
+    Value value = ValueFactory::GetIntegerValue(i);
+    Value decimal = ValueFactory::GetDecimalValue(i);
+    int_table.InsertCombine(AggregateKey{{value}}, AggregateValue{{value, value, decimal, decimal}});
+  }
+  ASSERT_EQ(100000, int_table.GetSize());
+  EXPECT_LT(int_table.GetMemoryUsage() / int_table.GetSize(), 128);
+  int_table.Clear();
+  EXPECT_EQ(0, int_table.GetSize());
+  EXPECT_EQ(int_table.Begin(), int_table.End());
+
+  // SUM(d) of decimals adds them up exactly, where doubles would not, also over partial sums that are merged, and
+  // as a double once an input has more digits after the point than it keeps, or the sum leaves its digits
+  std::vector<const AbstractExpression *> no_group_bys;
+  std::vector<const AbstractExpression *> sums{&d, &d, &d};
+  std::vector<AggregationType> sum_types(3, AggregationType::SumAggregate);
+  SimpleAggregationHashTable sum_table(no_group_bys, sums, sum_types);
+  SimpleAggregationHashTable partial_sum_table(no_group_bys, sums, sum_types);
+  double double_sum = 0;
+  for (int32_t i = 0; i < 1000; i++) {
+    Value tenth = ValueFactory::GetDecimalValue(0.1);
+    Value tiny = ValueFactory::GetDecimalValue(i == 500 ? 1e-9 : 0.1);
+    Value huge = ValueFactory::GetDecimalValue(i == 500 ? 1e13 : 0.1);
+    (i % 2 == 0 ? sum_table : partial_sum_table).InsertCombine(AggregateKey{}, AggregateValue{{tenth, tiny, huge}});
+    double_sum += 0.1;
+  }
+  ASSERT_NE(100.0, double_sum);
+  sum_table.Merge(partial_sum_table, 0);
+  ASSERT_EQ(1, sum_table.GetSize());
+  AggregateValue sum = sum_table.Begin().Val();
+  EXPECT_EQ(100.0, sum.aggregates_[0].GetAs<double>());
+  EXPECT_NEAR(99.9 + 1e-9, sum.aggregates_[1].GetAs<double>(), 1e-12);
+  EXPECT_NEAR(1e13 + 99.9, sum.aggregates_[2].GetAs<double>(), 1);
+}
+
+// NOLINTNEXTLINE
+TEST_F(ExecutorTest, OptimizerRewriteTest) {
+  auto *catalog = GetExecutorContext()->GetCatalog();
+  auto table_info = catalog->GetTable("test_1");
+  Schema &schema = table_info->schema_;
+  auto colA = MakeColumnValueExpression(schema, 0, "colA");
+  auto colB = MakeColumnValueExpression(schema, 0, "colB");
+  auto *scan_schema = MakeOutputSchema({{"colA", colA}, {"colB", colB}});
+  SeqScanPlanNode scan_plan(scan_schema, nullptr, table_info->oid_);
+  Optimizer optimizer(catalog);
+
+  // SELECT colB FROM test_1: the projection is folded into the scan, which then only builds colB
+  auto *out_schema = MakeOutputSchema({{"colB", MakeColumnValueExpression(*scan_schema, 0, "colB")}});
+  ProjectionPlanNode projection_plan(out_schema, &scan_plan);
+  const AbstractPlanNode *optimized = optimizer.Optimize(&projection_plan);
+  ASSERT_EQ(PlanType::SeqScan, optimized->GetType());
+  ASSERT_EQ(1, optimized->OutputSchema()->GetColumnCount());
+  std::vector<Tuple> expected;
+  GetExecutionEngine()->Execute(&projection_plan, &expected, GetTxn(), GetExecutorContext());
+  std::vector<Tuple> result_set;
+  GetExecutionEngine()->Execute(optimized, &result_set, GetTxn(), GetExecutorContext());
+  ASSERT_EQ(expected.size(), result_set.size());
+  for (size_t i = 0; i < result_set.size(); i++) {
+    ASSERT_EQ(expected[i].GetValue(out_schema, 0).GetAs<int32_t>(),
+              result_set[i].GetValue(out_schema, 0).GetAs<int32_t>());
+  }
+
+  // SELECT colB FROM (SELECT colA, colB FROM test_1 ORDER BY colA DESC) LIMIT 10: the limit goes below the projection,
+  // onto the sort, which then runs as a top-N
+  SortPlanNode sort_plan(scan_schema, &scan_plan,
+                         {{OrderByType::DESC, MakeColumnValueExpression(*scan_schema, 0, "colA")}});
+  auto *sorted_schema = MakeOutputSchema({{"colA", MakeColumnValueExpression(*scan_schema, 0, "colA")}});
+  ProjectionPlanNode sorted_projection(sorted_schema, &sort_plan);
+  LimitPlanNode limit_plan(sorted_schema, &sorted_projection, 10, 0);
+  optimized = optimizer.Optimize(&limit_plan);
+  ASSERT_EQ(PlanType::Projection, optimized->GetType());
+  ASSERT_EQ(PlanType::Limit, optimized->GetChildAt(0)->GetType());
+  auto executor = ExecutorFactory::CreateExecutor(GetExecutorContext(), optimized->GetChildAt(0));
+  ASSERT_NE(nullptr, dynamic_cast<TopNExecutor *>(executor.get()));
+  result_set.clear();
+  GetExecutionEngine()->Execute(optimized, &result_set, GetTxn(), GetExecutorContext());
+  ASSERT_EQ(10, result_set.size());
+  for (size_t i = 0; i < result_set.size(); i++) {
+    ASSERT_EQ(static_cast<int32_t>(TEST1_SIZE - 1 - i), result_set[i].GetValue(sorted_schema, 0).GetAs<int32_t>());
+  }
+
+  // SELECT colA FROM test_1 WHERE colA < 500, with an index on colA: the scan reads the keys of the index instead
+  std::unique_ptr<Schema> key_schema(Schema::CopySchema(&schema, {0}));
+  catalog->CreateIndex<GenericKey<8>, RID, GenericComparator<8>>(GetTxn(), "index1", "test_1", schema, *key_schema,
+                                                                  {0}, 8);
+  auto *predicate = MakeComparisonExpression(colA, MakeConstantValueExpression(ValueFactory::GetIntegerValue(500)),
+                                             ComparisonType::LessThan);
+  auto *key_only_schema = MakeOutputSchema({{"colA", colA}});
+  SeqScanPlanNode key_scan_plan(key_only_schema, predicate, table_info->oid_);
+  optimized = optimizer.Optimize(&key_scan_plan);
+  ASSERT_EQ(PlanType::IndexScan, optimized->GetType());
+  ASSERT_TRUE(dynamic_cast<const IndexScanPlanNode *>(optimized)->IsIndexOnly());
+  result_set.clear();
+  GetExecutionEngine()->Execute(optimized, &result_set, GetTxn(), GetExecutorContext());
+  ASSERT_EQ(500, result_set.size());
+  for (size_t i = 0; i < result_set.size(); i++) {
+    ASSERT_EQ(static_cast<int32_t>(i), result_set[i].GetValue(key_only_schema, 0).GetAs<int32_t>());
+  }
+  // a scan that outputs a column the index does not have is left as it is
+  EXPECT_EQ(&scan_plan, optimizer.Optimize(&scan_plan));
+
+  // SELECT colA, colB FROM test_1 WHERE colA = 7: the one row is looked up through the index
+  auto *const7 = MakeConstantValueExpression(ValueFactory::GetIntegerValue(7));
+  SeqScanPlanNode point_plan(scan_schema, MakeComparisonExpression(const7, colA, ComparisonType::Equal),
+                             table_info->oid_);
+  optimized = optimizer.Optimize(&point_plan);
+  ASSERT_EQ(PlanType::IndexScan, optimized->GetType());
+  const auto *index_scan = dynamic_cast<const IndexScanPlanNode *>(optimized);
+  EXPECT_FALSE(index_scan->IsIndexOnly());
+  EXPECT_TRUE(index_scan->GetKeyRange().IsEquality());
+  result_set.clear();
+  GetExecutionEngine()->Execute(optimized, &result_set, GetTxn(), GetExecutorContext());
+  ASSERT_EQ(1, result_set.size());
+  EXPECT_EQ(7, result_set[0].GetValue(scan_schema, 0).GetAs<int32_t>());
+
+  // ... WHERE colA >= 990 is a small range of the table, and WHERE colA < 900 most of it, which is scanned
+  catalog->Analyze(GetTxn(), "test_1");
+  auto *const990 = MakeConstantValueExpression(ValueFactory::GetIntegerValue(990));
+  SeqScanPlanNode range_plan(scan_schema, MakeComparisonExpression(colA, const990, ComparisonType::GreaterThanOrEqual),
+                             table_info->oid_);
+  optimized = optimizer.Optimize(&range_plan);
+  ASSERT_EQ(PlanType::IndexScan, optimized->GetType());
+  result_set.clear();
+  GetExecutionEngine()->Execute(optimized, &result_set, GetTxn(), GetExecutorContext());
+  ASSERT_EQ(10, result_set.size());
+  auto *const900 = MakeConstantValueExpression(ValueFactory::GetIntegerValue(900));
+  SeqScanPlanNode wide_plan(scan_schema, MakeComparisonExpression(colA, const900, ComparisonType::LessThan),
+                            table_info->oid_);
+  EXPECT_EQ(&wide_plan, optimizer.Optimize(&wide_plan));
+}
+
+// NOLINTNEXTLINE
+TEST_F(ExecutorTest, OptimizerSimplifyTest) {
+  auto table_info = GetCatalog()->GetTable("test_1");
+  Schema &schema = table_info->schema_;
+  Optimizer optimizer(GetCatalog());
+
+  // SELECT colA, colA + 1, colA + 1 FROM test_1 WHERE colA < 5 * 10 AND 1 = 1
+  auto *one = MakeConstantValueExpression(ValueFactory::GetIntegerValue(1));
+  auto *ten = MakeConstantValueExpression(ValueFactory::GetIntegerValue(10));
+  ArithmeticExpression fifty(MakeConstantValueExpression(ValueFactory::GetIntegerValue(5)), ten,
+                             ArithmeticType::Multiply);
+  auto *less = MakeComparisonExpression(MakeColumnValueExpression(schema, 0, "colA"), &fifty, ComparisonType::LessThan);
+  auto *always = MakeComparisonExpression(one, MakeConstantValueExpression(ValueFactory::GetIntegerValue(1)),
+                                          ComparisonType::Equal);
+  ConjunctionExpression predicate({less, always});
+  ArithmeticExpression plus_one(MakeColumnValueExpression(schema, 0, "colA"), one, ArithmeticType::Plus);
+  ArithmeticExpression plus_one_again(MakeColumnValueExpression(schema, 0, "colA"), one, ArithmeticType::Plus);
+  auto *out_schema = MakeOutputSchema(
+      {{"colA", MakeColumnValueExpression(schema, 0, "colA")}, {"a", &plus_one}, {"b", &plus_one_again}});
+  SeqScanPlanNode scan_plan(out_schema, &predicate, table_info->oid_);
+  const AbstractPlanNode *optimized = optimizer.Optimize(&scan_plan);
+  ASSERT_EQ(PlanType::SeqScan, optimized->GetType());
+  const auto *scan = dynamic_cast<const SeqScanPlanNode *>(optimized);
+
+  // the conjunct that is true is dropped, and 5 * 10 is folded
+  const auto *comparison = dynamic_cast<const ComparisonExpression *>(scan->GetPredicate());
+  ASSERT_NE(nullptr, comparison);
+  const auto *bound = dynamic_cast<const ConstantValueExpression *>(comparison->GetChildAt(1));
+  ASSERT_NE(nullptr, bound);
+  EXPECT_EQ(50, bound->Evaluate(nullptr, nullptr).GetAs<int32_t>());
+  // colA is one node, in the predicate and in the output, and so is colA + 1
+  const Schema *output = scan->OutputSchema();
+  EXPECT_EQ(comparison->GetChildAt(0), output->GetColumn(0).GetExpr());
+  EXPECT_EQ(output->GetColumn(1).GetExpr(), output->GetColumn(2).GetExpr());
+  EXPECT_EQ(output->GetColumn(0).GetExpr(), output->GetColumn(1).GetExpr()->GetChildAt(0));
+
+  std::vector<Tuple> result_set;
+  GetExecutionEngine()->Execute(optimized, &result_set, GetTxn(), GetExecutorContext());
+  ASSERT_EQ(50, result_set.size());
+  for (const auto &tuple : result_set) {
+    int32_t col_a = tuple.GetValue(output, 0).GetAs<int32_t>();
+    EXPECT_LT(col_a, 50);
+    EXPECT_EQ(col_a + 1, tuple.GetValue(output, 1).GetAs<int32_t>());
+    EXPECT_EQ(col_a + 1, tuple.GetValue(output, 2).GetAs<int32_t>());
+  }
+
+  // a predicate that is always true is dropped, and a division by zero is left to fail when it is run
+  SeqScanPlanNode always_plan(out_schema, always, table_info->oid_);
+  optimized = optimizer.Optimize(&always_plan);
+  ASSERT_EQ(PlanType::SeqScan, optimized->GetType());
+  EXPECT_EQ(nullptr, dynamic_cast<const SeqScanPlanNode *>(optimized)->GetPredicate());
+  ArithmeticExpression by_zero(ten, MakeConstantValueExpression(ValueFactory::GetIntegerValue(0)),
+                               ArithmeticType::Divide);
+  EXPECT_EQ(&by_zero, optimizer.Simplify(&by_zero));
+}
+
+// NOLINTNEXTLINE
+TEST_F(ExecutorTest, OptimizerJoinTest) {
+  auto *catalog = GetExecutorContext()->GetCatalog();
+  catalog->Analyze(GetTxn(), "test_1");
+  catalog->Analyze(GetTxn(), "test_2");
+  TableMetadata *table1_info = catalog->GetTable("test_1");
+  TableMetadata *table2_info = catalog->GetTable("test_2");
+  Schema &schema1 = table1_info->schema_;
+  Schema &schema2 = table2_info->schema_;
+  auto colA = MakeColumnValueExpression(schema1, 0, "colA");
+  auto colB = MakeColumnValueExpression(schema1, 0, "colB");
+  auto *out_schema1 = MakeOutputSchema({{"colA", colA}, {"colB", colB}});
+  SeqScanPlanNode scan_plan1(out_schema1, nullptr, table1_info->oid_);
+  auto col1 = MakeColumnValueExpression(schema2, 0, "col1");
+  auto col2 = MakeColumnValueExpression(schema2, 0, "col2");
+  auto *out_schema2 = MakeOutputSchema({{"col1", col1}, {"col2", col2}});
+  SeqScanPlanNode scan_plan2(out_schema2, nullptr, table2_info->oid_);
+
+  auto left_colA = MakeColumnValueExpression(*out_schema1, 0, "colA");
+  auto left_colB = MakeColumnValueExpression(*out_schema1, 0, "colB");
+  auto right_col1 = MakeColumnValueExpression(*out_schema2, 1, "col1");
+  auto *out_final = MakeOutputSchema({{"colA", left_colA}, {"colB", left_colB}, {"col1", right_col1}});
+  auto *join_predicate = MakeComparisonExpression(left_colA, right_col1, ComparisonType::Equal);
+  Optimizer optimizer(catalog);
+
+  // SELECT colA, colB, col1 FROM test_1 JOIN test_2 ON colA = col1: a hash join that builds on test_2, the smaller side
+  NestedLoopJoinPlanNode join_plan(out_final, {&scan_plan1, &scan_plan2}, join_predicate);
+  const AbstractPlanNode *optimized = optimizer.Optimize(&join_plan);
+  ASSERT_EQ(PlanType::HashJoin, optimized->GetType());
+  ASSERT_EQ(&scan_plan2, optimized->GetChildAt(0));
+  const Schema *optimized_schema = optimized->OutputSchema();
+  std::vector<Tuple> result_set;
+  GetExecutionEngine()->Execute(optimized, &result_set, GetTxn(), GetExecutorContext());
+  ASSERT_EQ(TEST2_SIZE, result_set.size());
+  std::unordered_set<int32_t> seen;
+  for (const auto &tuple : result_set) {
+    auto a = tuple.GetValue(optimized_schema, 0).GetAs<int32_t>();
+    ASSERT_LT(tuple.GetValue(optimized_schema, 1).GetAs<int32_t>(), 10);
+    ASSERT_EQ(a, tuple.GetValue(optimized_schema, 2).GetAs<int16_t>());
+    ASSERT_TRUE(seen.insert(a).second);
+  }
+
+  // ... WHERE colA < 10, with an index on col1: the few rows left of test_1 are looked up in the index of test_2
+  std::unique_ptr<Schema> key_schema(Schema::CopySchema(&schema2, {0}));
+  catalog->CreateIndex<GenericKey<8>, RID, GenericComparator<8>>(GetTxn(), "index1", "test_2", schema2, *key_schema,
+                                                                  {0}, 8);
+  auto *filter = MakeComparisonExpression(colA, MakeConstantValueExpression(ValueFactory::GetIntegerValue(10)),
+                                          ComparisonType::LessThan);
+  SeqScanPlanNode filtered_plan1(out_schema1, filter, table1_info->oid_);
+  NestedLoopJoinPlanNode index_join_plan(out_final, {&filtered_plan1, &scan_plan2}, join_predicate);
+  optimized = optimizer.Optimize(&index_join_plan);
+  ASSERT_EQ(PlanType::NestedIndexJoin, optimized->GetType());
+  optimized_schema = optimized->OutputSchema();
+  result_set.clear();
+  GetExecutionEngine()->Execute(optimized, &result_set, GetTxn(), GetExecutorContext());
+  ASSERT_EQ(10, result_set.size());
+  for (const auto &tuple : result_set) {
+    auto a = tuple.GetValue(optimized_schema, 0).GetAs<int32_t>();
+    ASSERT_LT(a, 10);
+    ASSERT_EQ(a, tuple.GetValue(optimized_schema, 2).GetAs<int16_t>());
+  }
+
+  // ... with the sides the other way round, the index join still has the filtered side as its outer one
+  auto *flipped_final = MakeOutputSchema({{"col1", MakeColumnValueExpression(*out_schema2, 0, "col1")},
+                                          {"colA", MakeColumnValueExpression(*out_schema1, 1, "colA")}});
+  auto *flipped_predicate = MakeComparisonExpression(MakeColumnValueExpression(*out_schema2, 0, "col1"),
+                                                     MakeColumnValueExpression(*out_schema1, 1, "colA"),
+                                                     ComparisonType::Equal);
+  NestedLoopJoinPlanNode flipped_plan(flipped_final, {&scan_plan2, &filtered_plan1}, flipped_predicate);
+  optimized = optimizer.Optimize(&flipped_plan);
+  ASSERT_EQ(PlanType::NestedIndexJoin, optimized->GetType());
+  optimized_schema = optimized->OutputSchema();
+  result_set.clear();
+  GetExecutionEngine()->Execute(optimized, &result_set, GetTxn(), GetExecutorContext());
+  ASSERT_EQ(10, result_set.size());
+  for (const auto &tuple : result_set) {
+    ASSERT_EQ(tuple.GetValue(optimized_schema, 1).GetAs<int32_t>(),
+              tuple.GetValue(optimized_schema, 0).GetAs<int16_t>());
+  }
+
+  // a predicate of one side of a join is moved into the scan of that side
+  NestedLoopJoinPlanNode filter_join_plan(out_final, {&scan_plan1, &scan_plan2},
+                                          MakeComparisonExpression(left_colA, MakeConstantValueExpression(
+                                                                                  ValueFactory::GetIntegerValue(10)),
+                                                                   ComparisonType::LessThan));
+  optimized = optimizer.Optimize(&filter_join_plan);
+  ASSERT_EQ(PlanType::NestedLoopJoin, optimized->GetType());
+  EXPECT_EQ(nullptr, dynamic_cast<const NestedLoopJoinPlanNode *>(optimized)->Predicate());
+  const auto *pushed = dynamic_cast<const SeqScanPlanNode *>(optimized->GetChildAt(0));
+  ASSERT_NE(nullptr, pushed);
+  ASSERT_NE(nullptr, pushed->GetPredicate());
+  EXPECT_NEAR(10, optimizer.EstimateRows(pushed), 5);
+}
+
 }  // namespace bustub
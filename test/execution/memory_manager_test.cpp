@@ -0,0 +1,115 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// memory_manager_test.cpp
+//
+// Identification: test/execution/memory_manager_test.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "execution/memory_manager.h"
+
+#include <memory>
+
+#include "execution/executor_context.h"
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+// NOLINTNEXTLINE
+TEST(MemoryManagerTest, BudgetTest) {
+  ExecutorContext exec_ctx(nullptr, nullptr, nullptr, nullptr, nullptr);
+  exec_ctx.SetMemoryBudget(1000);
+
+  // without a manager, a reservation is held to the budget of the query, and each one to its own; a grant is rounded
+  // up to a whole unit, but not past the budget
+  {
+    MemoryReservation first(&exec_ctx);
+    MemoryReservation second(&exec_ctx);
+    EXPECT_TRUE(first.Resize(600));
+    EXPECT_TRUE(second.Resize(1000));
+    EXPECT_FALSE(first.Resize(1001));
+    EXPECT_EQ(1000, first.GetGranted());
+    EXPECT_EQ(2000, exec_ctx.GetMemoryUsage());
+
+    MemoryReservation part(&exec_ctx, MemoryCategory::OTHER, 100);
+    EXPECT_FALSE(part.Resize(101));
+    EXPECT_TRUE(first.Resize(0));
+    EXPECT_EQ(1000, exec_ctx.GetMemoryUsage());
+  }
+  EXPECT_EQ(0, exec_ctx.GetMemoryUsage());
+  EXPECT_EQ(2000, exec_ctx.GetPeakMemoryUsage());
+}
+
+// NOLINTNEXTLINE
+TEST(MemoryManagerTest, SharedLimitTest) {
+  MemoryManager manager(4 * MemoryReservation::GRANT_UNIT);
+  ExecutorContext first_query(nullptr, nullptr, nullptr, nullptr, nullptr);
+  ExecutorContext second_query(nullptr, nullptr, nullptr, nullptr, nullptr);
+  first_query.SetMemoryManager(&manager);
+  second_query.SetMemoryManager(&manager);
+
+  // memory is taken in whole units, so that growing within one does not go to the manager
+  auto big = std::make_unique<MemoryReservation>(&first_query);
+  EXPECT_TRUE(big->Resize(1));
+  EXPECT_EQ(MemoryReservation::GRANT_UNIT, manager.GetReserved());
+  EXPECT_TRUE(big->Resize(3 * MemoryReservation::GRANT_UNIT));
+  EXPECT_EQ(3 * MemoryReservation::GRANT_UNIT, manager.GetReserved());
+
+  // the second query gets what is left, and is refused more; the first query is then asked to give its memory back
+  MemoryReservation small(&second_query);
+  EXPECT_TRUE(small.Resize(MemoryReservation::GRANT_UNIT));
+  EXPECT_FALSE(small.IsRevoked());
+  EXPECT_FALSE(big->IsRevoked());
+  EXPECT_FALSE(small.Resize(MemoryReservation::GRANT_UNIT + 1));
+  EXPECT_TRUE(big->IsRevoked());
+  EXPECT_EQ(MemoryReservation::GRANT_UNIT, small.GetGranted());
+
+  // a revoked reservation may shrink, but not grow, until it has given everything back
+  EXPECT_TRUE(big->Resize(MemoryReservation::GRANT_UNIT));
+  EXPECT_FALSE(big->Resize(MemoryReservation::GRANT_UNIT + 1));
+  EXPECT_TRUE(big->Resize(0));
+  EXPECT_FALSE(big->IsRevoked());
+  EXPECT_TRUE(small.Resize(3 * MemoryReservation::GRANT_UNIT));
+
+  // a reservation that is destroyed gives its memory back
+  EXPECT_TRUE(big->Resize(MemoryReservation::GRANT_UNIT));
+  big.reset();
+  EXPECT_EQ(3 * MemoryReservation::GRANT_UNIT, manager.GetReserved());
+  EXPECT_EQ(4 * MemoryReservation::GRANT_UNIT, manager.GetPeakReserved());
+  EXPECT_EQ(3 * MemoryReservation::GRANT_UNIT, first_query.GetPeakMemoryUsage());
+  EXPECT_EQ(0, first_query.GetMemoryUsage());
+  EXPECT_EQ(3 * MemoryReservation::GRANT_UNIT, second_query.GetMemoryUsage());
+}
+
+// NOLINTNEXTLINE
+TEST(MemoryManagerTest, TrackerTest) {
+  ExecutorContext exec_ctx(nullptr, nullptr, nullptr, nullptr, nullptr);
+  MemoryTracker *tracker = exec_ctx.GetMemoryTracker();
+  size_t global_before = MemoryTracker::Global()->GetCurrent(MemoryCategory::HASH_JOIN);
+
+  // the grants of a reservation are accounted for by its category, in the query and in the process
+  {
+    MemoryReservation join(&exec_ctx, MemoryCategory::HASH_JOIN);
+    MemoryReservation sort(&exec_ctx, MemoryCategory::SORT);
+    EXPECT_TRUE(join.Resize(1000));
+    EXPECT_TRUE(sort.Resize(3 * MemoryReservation::GRANT_UNIT));
+    EXPECT_EQ(join.GetGranted(), tracker->GetCurrent(MemoryCategory::HASH_JOIN));
+    EXPECT_EQ(3 * MemoryReservation::GRANT_UNIT, tracker->GetCurrent(MemoryCategory::SORT));
+    EXPECT_EQ(global_before + join.GetGranted(), MemoryTracker::Global()->GetCurrent(MemoryCategory::HASH_JOIN));
+    EXPECT_TRUE(sort.Resize(0));
+  }
+  EXPECT_EQ(0, tracker->GetCurrent(MemoryCategory::HASH_JOIN));
+  EXPECT_EQ(3 * MemoryReservation::GRANT_UNIT, tracker->GetPeak(MemoryCategory::SORT));
+  EXPECT_EQ(global_before, MemoryTracker::Global()->GetCurrent(MemoryCategory::HASH_JOIN));
+
+  // so are the blocks of the query's arena
+  exec_ctx.GetArena()->Allocate(8);
+  EXPECT_EQ(MemoryArena::BLOCK_SIZE, tracker->GetCurrent(MemoryCategory::QUERY_ARENA));
+  EXPECT_EQ(MemoryArena::BLOCK_SIZE, tracker->GetTotal());
+}
+
+}  // namespace bustub
@@ -0,0 +1,59 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// quantile_sketch_test.cpp
+//
+// Identification: test/execution/quantile_sketch_test.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "execution/quantile_sketch.h"
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+// NOLINTNEXTLINE
+TEST(QuantileSketchTest, QuantileTest) {
+  const int n = 100000;
+  std::vector<double> values;
+  for (int i = 0; i < n; i++) {
+    values.push_back(i);
+  }
+  std::shuffle(values.begin(), values.end(), std::mt19937(7));
+
+  // the rank of each quantile is off by under 1% of the count, from one sketch or from the merge of four
+  QuantileSketch sketch;
+  std::vector<QuantileSketch> parts(4);
+  for (int i = 0; i < n; i++) {
+    sketch.Insert(values[i]);
+    parts[i % 4].Insert(values[i]);
+  }
+  for (size_t i = 1; i < parts.size(); i++) {
+    parts[0].Merge(parts[i]);
+  }
+  EXPECT_EQ(n, sketch.GetCount());
+  EXPECT_EQ(n, parts[0].GetCount());
+  for (double fraction : {0.0, 0.01, 0.25, 0.5, 0.9, 0.99, 1.0}) {
+    EXPECT_NEAR(fraction * n, sketch.Quantile(fraction), 0.01 * n) << fraction;
+    EXPECT_NEAR(fraction * n, parts[0].Quantile(fraction), 0.01 * n) << fraction;
+  }
+
+  // a few values are kept as they are
+  QuantileSketch few;
+  for (double value : {5.0, 1.0, 3.0}) {
+    few.Insert(value);
+  }
+  EXPECT_EQ(1.0, few.Quantile(0));
+  EXPECT_EQ(3.0, few.Quantile(0.5));
+  EXPECT_EQ(5.0, few.Quantile(1));
+}
+
+}  // namespace bustub
@@ -0,0 +1,168 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// session_manager_test.cpp
+//
+// Identification: test/execution/session_manager_test.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "execution/session_manager.h"
+
+#include <cstdio>
+#include <future>  // NOLINT
+#include <memory>
+#include <thread>  // NOLINT
+#include <utility>
+#include <vector>
+
+#include "buffer/buffer_pool_manager_instance.h"
+#include "execution/expressions/column_value_expression.h"
+#include "execution/plans/insert_plan.h"
+#include "execution/plans/seq_scan_plan.h"
+#include "gtest/gtest.h"
+#include "type/value_factory.h"
+
+namespace bustub {
+
+class SessionManagerTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    disk_manager_ = std::make_unique<DiskManager>("session_manager_test.db");
+    bpm_ = std::make_unique<BufferPoolManagerInstance>(64, disk_manager_.get());
+    lock_manager_ = std::make_unique<LockManager>();
+    txn_mgr_ = std::make_unique<TransactionManager>(lock_manager_.get());
+    catalog_ = std::make_unique<Catalog>(bpm_.get(), lock_manager_.get(), nullptr);
+    Transaction *txn = txn_mgr_->Begin();
+    table_oid_ = catalog_->CreateTable(txn, "t", schema_)->oid_;
+    txn_mgr_->Commit(txn);
+    delete txn;
+    scan_ = std::make_unique<SeqScanPlanNode>(&output_schema_, nullptr, table_oid_);
+  }
+
+  void TearDown() override {
+    catalog_.reset();
+    txn_mgr_.reset();
+    bpm_.reset();
+    disk_manager_->ShutDown();
+    disk_manager_.reset();
+    remove("session_manager_test.db");
+  }
+
+  std::unique_ptr<SessionManager> MakeManager(size_t num_threads, SessionLimits limits = {}) {
+    return std::make_unique<SessionManager>(catalog_.get(), bpm_.get(), txn_mgr_.get(), lock_manager_.get(),
+                                            num_threads, limits);
+  }
+
+  /** @return a plan that inserts a row of a value */
+  const AbstractPlanNode *MakeInsert(int32_t v) {
+    std::vector<std::vector<Value>> rows{{ValueFactory::GetIntegerValue(v)}};
+    plans_.push_back(std::make_unique<InsertPlanNode>(std::move(rows), table_oid_));
+    return plans_.back().get();
+  }
+
+  Schema schema_{{Column("v", TypeId::INTEGER)}};
+  ColumnValueExpression column_{0, 0, TypeId::INTEGER};
+  Schema output_schema_{{Column("v", TypeId::INTEGER, &column_)}};
+  std::unique_ptr<DiskManager> disk_manager_;
+  std::unique_ptr<BufferPoolManagerInstance> bpm_;
+  std::unique_ptr<LockManager> lock_manager_;
+  std::unique_ptr<TransactionManager> txn_mgr_;
+  std::unique_ptr<Catalog> catalog_;
+  table_oid_t table_oid_;
+  std::unique_ptr<SeqScanPlanNode> scan_;
+  std::vector<std::unique_ptr<AbstractPlanNode>> plans_;
+};
+
+// NOLINTNEXTLINE
+TEST_F(SessionManagerTest, PipelineTest) {
+  auto manager = MakeManager(4);
+  const int num_sessions = 8;
+  const int num_inserts = 50;
+  std::vector<std::shared_ptr<Session>> sessions;
+  std::vector<std::future<SessionResponse>> responses;
+  for (int s = 0; s < num_sessions; s++) {
+    sessions.push_back(manager->OpenSession(IsolationLevel::READ_COMMITTED));
+    ASSERT_NE(nullptr, sessions.back());
+  }
+  // every session submits all of its inserts without waiting, then a scan that sees them all, as they run in order
+  std::vector<std::future<SessionResponse>> scans;
+  for (int i = 0; i < num_inserts; i++) {
+    for (int s = 0; s < num_sessions; s++) {
+      responses.push_back(sessions[s]->Query(MakeInsert(s * num_inserts + i)));
+    }
+  }
+  for (int s = 0; s < num_sessions; s++) {
+    scans.push_back(sessions[s]->Query(scan_.get()));
+  }
+  for (auto &response : responses) {
+    SessionResponse r = response.get();
+    EXPECT_TRUE(r.ok_) << r.error_;
+  }
+  for (auto &scan : scans) {
+    SessionResponse r = scan.get();
+    EXPECT_TRUE(r.ok_) << r.error_;
+    EXPECT_LE(static_cast<size_t>(num_inserts), r.rows_.size());
+  }
+  SessionResponse all = sessions[0]->Query(scan_.get()).get();
+  ASSERT_EQ(static_cast<size_t>(num_sessions * num_inserts), all.rows_.size());
+  EXPECT_EQ(num_sessions * (num_inserts + 1) + 1, manager->GetStats().requests_run_);
+}
+
+// NOLINTNEXTLINE
+TEST_F(SessionManagerTest, TransactionTest) {
+  auto manager = MakeManager(2);
+  auto writer = manager->OpenSession();
+  auto reader = manager->OpenSession(IsolationLevel::READ_COMMITTED);
+
+  EXPECT_FALSE(writer->Commit().get().ok_);
+  EXPECT_TRUE(writer->Begin().get().ok_);
+  EXPECT_FALSE(writer->Begin().get().ok_);
+  writer->Query(MakeInsert(1));
+  writer->Query(MakeInsert(2));
+  EXPECT_EQ(2, writer->Query(scan_.get()).get().rows_.size());
+  EXPECT_TRUE(writer->Abort().get().ok_);
+  EXPECT_EQ(0, reader->Query(scan_.get()).get().rows_.size());
+
+  // a transaction left open is aborted with its session
+  writer->Begin();
+  writer->Query(MakeInsert(3));
+  writer->Commit();
+  writer->Begin();
+  EXPECT_TRUE(writer->Query(MakeInsert(4)).get().ok_);
+  writer.reset();
+  // the thread that ran the last request of the session may hold on to it a little longer
+  while (manager->GetSessionCount() > 1) {
+    std::this_thread::yield();
+  }
+  SessionResponse rows = reader->Query(scan_.get()).get();
+  ASSERT_EQ(1, rows.rows_.size());
+  EXPECT_EQ(3, rows.rows_[0].GetValue(&output_schema_, 0).GetAs<int32_t>());
+}
+
+// NOLINTNEXTLINE
+TEST_F(SessionManagerTest, AdmissionTest) {
+  SessionLimits limits;
+  limits.max_sessions_ = 2;
+  limits.max_queued_requests_ = 0;
+  auto manager = MakeManager(1, limits);
+  auto first = manager->OpenSession();
+  auto second = manager->OpenSession();
+  EXPECT_EQ(nullptr, manager->OpenSession());
+  EXPECT_EQ(2, manager->GetSessionCount());
+  second.reset();
+  EXPECT_NE(nullptr, manager->OpenSession());
+
+  // no room for a request
+  SessionResponse response = first->Query(scan_.get()).get();
+  EXPECT_FALSE(response.ok_);
+  SessionManagerStats stats = manager->GetStats();
+  EXPECT_EQ(1, stats.sessions_refused_);
+  EXPECT_EQ(1, stats.requests_refused_);
+  EXPECT_EQ(0, stats.requests_run_);
+}
+
+}  // namespace bustub
@@ -0,0 +1,118 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// sort_key_test.cpp
+//
+// Identification: test/execution/sort_key_test.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "execution/loser_tree.h"
+#include "execution/sort_key.h"
+#include "gtest/gtest.h"
+#include "type/value_factory.h"
+
+namespace bustub {
+
+// a value of the type, of a small range so that there are ties, or a NULL now and then
+static Value RandomValue(TypeId type, std::mt19937 *random) {
+  int32_t i = static_cast<int32_t>((*random)() % 41) - 20;
+  if (i == 20) {
+    return ValueFactory::GetNullValueByType(type);
+  }
+  switch (type) {
+    case TypeId::TINYINT:
+      return Value(type, static_cast<int8_t>(i * 6));
+    case TypeId::SMALLINT:
+      return Value(type, static_cast<int16_t>(i * 1600));
+    case TypeId::INTEGER:
+      return Value(type, static_cast<int32_t>(i * 100000000));
+    case TypeId::BIGINT:
+      return Value(type, static_cast<int64_t>(i) << 58);
+    case TypeId::DECIMAL:
+      return Value(type, i / 3.0);
+    default:
+      // strings that are prefixes of one another
+      return Value(type, std::string(std::abs(i) % 5, static_cast<char>('a' + (i + 20) % 3)));
+  }
+}
+
+// NOLINTNEXTLINE
+TEST(SortKeyTest, OrderTest) {
+  std::mt19937 random(7);
+  for (TypeId type : {TypeId::TINYINT, TypeId::SMALLINT, TypeId::INTEGER, TypeId::BIGINT, TypeId::DECIMAL,
+                      TypeId::VARCHAR}) {
+    for (bool descending : {false, true}) {
+      for (int i = 0; i < 500; i++) {
+        Value left = RandomValue(type, &random);
+        Value right = RandomValue(type, &random);
+        // NULLs are the largest values
+        int expected;
+        if (left.IsNull() || right.IsNull()) {
+          expected = static_cast<int>(left.IsNull()) - static_cast<int>(right.IsNull());
+        } else if (left.CompareLessThan(right) == CmpBool::CmpTrue) {
+          expected = -1;
+        } else {
+          expected = left.CompareEquals(right) == CmpBool::CmpTrue ? 0 : 1;
+        }
+        if (descending) {
+          expected = -expected;
+        }
+
+        std::string left_key;
+        std::string right_key;
+        SortKeyEncoder::EncodeValue(left, descending, &left_key);
+        SortKeyEncoder::EncodeValue(right, descending, &right_key);
+        int result = SortKeyEncoder::Compare(left_key.data(), left_key.size(), right_key.data(), right_key.size());
+        EXPECT_EQ(expected, (result > 0) - (result < 0)) << Type::TypeIdToString(type) << " " << descending;
+      }
+    }
+  }
+}
+
+// NOLINTNEXTLINE
+TEST(SortKeyTest, LoserTreeTest) {
+  // sorted sources of all sizes, some of them empty, merge into a sorted whole
+  std::mt19937 random(11);
+  for (size_t num_sources : {1, 2, 3, 5, 8, 13}) {
+    std::vector<std::vector<int>> sources(num_sources);
+    std::vector<int> expected;
+    for (auto &source : sources) {
+      source.resize(random() % 20);
+      for (int &value : source) {
+        value = static_cast<int>(random() % 50);
+        expected.push_back(value);
+      }
+      std::sort(source.begin(), source.end());
+    }
+    std::sort(expected.begin(), expected.end());
+
+    std::vector<size_t> positions(num_sources, 0);
+    auto less = [&](size_t left, size_t right) {
+      if (positions[left] == sources[left].size()) {
+        return false;
+      }
+      if (positions[right] == sources[right].size()) {
+        return true;
+      }
+      return sources[left][positions[left]] < sources[right][positions[right]];
+    };
+    LoserTree<decltype(less)> tree(num_sources, less);
+    std::vector<int> merged;
+    while (positions[tree.Top()] < sources[tree.Top()].size()) {
+      merged.push_back(sources[tree.Top()][positions[tree.Top()]++]);
+      tree.Replay();
+    }
+    EXPECT_EQ(expected, merged) << num_sources;
+  }
+}
+
+}  // namespace bustub
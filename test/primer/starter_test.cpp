@@ -11,6 +11,8 @@
 //===----------------------------------------------------------------------===//
 
 #include <iostream>
+#include <random>
+#include <vector>
 
 #include "gtest/gtest.h"
 #include "primer/p0_starter.h"
@@ -22,7 +24,7 @@ TEST(StarterTest, SampleTest) {
   EXPECT_EQ(a, 1);
 }
 
-TEST(StarterTest, DISABLED_AddMatricesTest) {
+TEST(StarterTest, AddMatricesTest) {
   std::unique_ptr<RowMatrix<int>> mat1_ptr{new RowMatrix<int>(3, 3)};
   int arr1[9] = {1, 4, 2, 5, 2, -1, 0, 3, 1};
   mat1_ptr->MatImport(&arr1[0]);
@@ -50,7 +52,7 @@ TEST(StarterTest, DISABLED_AddMatricesTest) {
   }
 }
 
-TEST(StarterTest, DISABLED_MultiplyMatricesTest) {
+TEST(StarterTest, MultiplyMatricesTest) {
   // Multiply
   int arr1[6] = {1, 2, 3, 4, 5, 6};
   std::unique_ptr<RowMatrix<int>> mat1_ptr{new RowMatrix<int>(2, 3)};
@@ -79,4 +81,85 @@ TEST(StarterTest, DISABLED_MultiplyMatricesTest) {
     }
   }
 }
+TEST(StarterTest, GemmMatricesTest) {
+  int arr1[6] = {1, 2, 3, 4, 5, 6};
+  std::unique_ptr<RowMatrix<int>> mat1_ptr{new RowMatrix<int>(2, 3)};
+  mat1_ptr->MatImport(&arr1[0]);
+  int arr2[6] = {-2, 1, -2, 2, 2, 3};
+  std::unique_ptr<RowMatrix<int>> mat2_ptr{new RowMatrix<int>(3, 2)};
+  mat2_ptr->MatImport(&arr2[0]);
+  int arr3[4] = {1, 1, 1, 1};
+  std::unique_ptr<RowMatrix<int>> mat3_ptr{new RowMatrix<int>(2, 2)};
+  mat3_ptr->MatImport(&arr3[0]);
+
+  int arr4[4] = {1, 15, -5, 33};
+  std::unique_ptr<RowMatrix<int>> gemm_ptr =
+      RowMatrixOperations<int>::GemmMatrices(move(mat1_ptr), move(mat2_ptr), move(mat3_ptr));
+  for (int i = 0; i < 2; i++) {
+    for (int j = 0; j < 2; j++) {
+      EXPECT_EQ(arr4[i * 2 + j], gemm_ptr->GetElem(i, j));
+    }
+  }
+
+  EXPECT_EQ(nullptr, RowMatrixOperations<int>::MultiplyMatrices(std::make_unique<RowMatrix<int>>(2, 3),
+                                                                std::make_unique<RowMatrix<int>>(2, 3)));
+  EXPECT_EQ(nullptr, RowMatrixOperations<int>::AddMatrices(std::make_unique<RowMatrix<int>>(2, 3),
+                                                           std::make_unique<RowMatrix<int>>(3, 2)));
+}
+
+TEST(StarterTest, KernelTest) {
+  // larger than a tile in every dimension, and not a multiple of one
+  const int rows = 70;
+  const int inner = 150;
+  const int cols = 300;
+  std::mt19937 gen(7);
+  std::uniform_int_distribution<int64_t> dist(-100, 100);
+  auto random_matrix = [&](int r, int c) {
+    auto mat = std::make_unique<RowMatrix<int64_t>>(r, c);
+    for (int i = 0; i < r; i++) {
+      for (int j = 0; j < c; j++) {
+        mat->SetElem(i, j, dist(gen));
+      }
+    }
+    return mat;
+  };
+  auto a = random_matrix(rows, inner);
+  auto b = random_matrix(inner, cols);
+  auto c = random_matrix(rows, cols);
+  std::vector<int64_t> expected(static_cast<size_t>(rows) * cols);
+  for (int i = 0; i < rows; i++) {
+    for (int j = 0; j < cols; j++) {
+      int64_t sum = 0;
+      for (int k = 0; k < inner; k++) {
+        sum += a->GetElem(i, k) * b->GetElem(k, j);
+      }
+      expected[i * cols + j] = sum;
+    }
+  }
+
+  using Ops = RowMatrixOperations<int64_t>;
+  RowMatrix<int64_t> out(rows, cols);
+  for (size_t num_threads : {1, 2, 4}) {
+    ASSERT_TRUE(Ops::Multiply(*a, *b, &out, num_threads));
+    EXPECT_TRUE(std::equal(expected.begin(), expected.end(), out.GetData())) << num_threads << " threads";
+  }
+
+  // accumulate into c in place, then take c back out of it
+  std::vector<int64_t> c_before(c->GetData(), c->GetData() + rows * cols);
+  ASSERT_TRUE(Ops::Gemm(*a, *b, *c, c.get(), 3));
+  for (int i = 0; i < rows * cols; i++) {
+    ASSERT_EQ(expected[i] + c_before[i], c->GetData()[i]);
+  }
+  ASSERT_TRUE(Ops::Add(out, out, &out));
+  for (int i = 0; i < rows * cols; i++) {
+    ASSERT_EQ(2 * expected[i], out.GetData()[i]);
+  }
+
+  // the output may not be one of the factors, and shapes have to match
+  EXPECT_FALSE(Ops::Multiply(*a, *b, a.get()));
+  EXPECT_FALSE(Ops::Multiply(*b, *a, &out));
+  EXPECT_FALSE(Ops::Gemm(*a, *b, *a, &out));
+  EXPECT_FALSE(Ops::Add(*a, *b, &out));
+  EXPECT_EQ(2 * expected[0], out.GetElem(0, 0));
+}
 }  // namespace bustub
@@ -10,24 +10,34 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>  // NOLINT
+#include <filesystem>
 #include <string>
+#include <thread>  // NOLINT
 #include <vector>
 
+#include "buffer/buffer_pool_manager_instance.h"
+#include "catalog/catalog.h"
 #include "common/bustub_instance.h"
 #include "common/config.h"
 #include "concurrency/lock_manager.h"
 #include "concurrency/transaction_manager.h"
 #include "gtest/gtest.h"
 #include "logging/common.h"
+#include "recovery/backup_manager.h"
 #include "recovery/log_recovery.h"
+#include "recovery/log_replica.h"
 #include "storage/table/table_heap.h"
 #include "storage/table/table_iterator.h"
 #include "storage/table/tuple.h"
+#include "type/value_factory.h"
 
 namespace bustub {
 
 // NOLINTNEXTLINE
-TEST(RecoveryTest, DISABLED_RedoTest) {
+TEST(RecoveryTest, RedoTest) {
   remove("test.db");
   remove("test.log");
 
@@ -122,7 +132,7 @@ TEST(RecoveryTest, DISABLED_RedoTest) {
 }
 
 // NOLINTNEXTLINE
-TEST(RecoveryTest, DISABLED_UndoTest) {
+TEST(RecoveryTest, UndoTest) {
   remove("test.db");
   remove("test.log");
   BustubInstance *bustub_instance = new BustubInstance("test.db");
@@ -205,6 +215,55 @@ TEST(RecoveryTest, DISABLED_UndoTest) {
   remove("test.log");
 }
 
+// NOLINTNEXTLINE
+TEST(RecoveryTest, EvictUncommittedTest) {
+  remove("test.db");
+  remove("test.log");
+  auto *bustub_instance = new BustubInstance("test.db");
+  bustub_instance->log_manager_->RunFlushThread();
+
+  Transaction *txn = bustub_instance->transaction_manager_->Begin();
+  auto *test_table = new TableHeap(bustub_instance->buffer_pool_manager_, bustub_instance->lock_manager_,
+                                   bustub_instance->log_manager_, txn);
+  page_id_t first_page_id = test_table->GetFirstPageId();
+  Column col1{"a", TypeId::VARCHAR, 20};
+  Column col2{"b", TypeId::SMALLINT};
+  Schema schema{{col1, col2}};
+  RID rid;
+  ASSERT_TRUE(test_table->InsertTuple(ConstructTuple(&schema), &rid, txn));
+
+  // the new pages evict the dirty page of the insert, which may only reach disk once the insert's log record has
+  for (int i = 0; i < BUFFER_POOL_SIZE; i++) {
+    page_id_t page_id;
+    ASSERT_NE(nullptr, bustub_instance->buffer_pool_manager_->NewPage(&page_id));
+    bustub_instance->buffer_pool_manager_->UnpinPage(page_id, true);
+  }
+  EXPECT_GE(bustub_instance->log_manager_->GetPersistentLSN(), txn->GetPrevLSN());
+
+  LOG_INFO("System crash before commit");
+  delete txn;
+  delete test_table;
+  delete bustub_instance;
+
+  bustub_instance = new BustubInstance("test.db");
+  LogRecovery log_recovery(bustub_instance->disk_manager_, bustub_instance->buffer_pool_manager_);
+  log_recovery.Redo();
+  log_recovery.Undo();
+
+  txn = bustub_instance->transaction_manager_->Begin();
+  test_table = new TableHeap(bustub_instance->buffer_pool_manager_, bustub_instance->lock_manager_,
+                             bustub_instance->log_manager_, first_page_id);
+  Tuple old_tuple;
+  EXPECT_FALSE(test_table->GetTuple(rid, &old_tuple, txn));
+  bustub_instance->transaction_manager_->Commit(txn);
+
+  delete txn;
+  delete test_table;
+  delete bustub_instance;
+  remove("test.db");
+  remove("test.log");
+}
+
 // NOLINTNEXTLINE
 TEST(RecoveryTest, DISABLED_CheckpointTest) {
   remove("test.db");
@@ -248,8 +307,9 @@ TEST(RecoveryTest, DISABLED_CheckpointTest) {
   bustub_instance->checkpoint_manager_->BeginCheckpoint();
   bustub_instance->checkpoint_manager_->EndCheckpoint();
 
-  Page *pages = bustub_instance->buffer_pool_manager_->GetPages();
-  size_t pool_size = bustub_instance->buffer_pool_manager_->GetPoolSize();
+  auto *bpm = dynamic_cast<BufferPoolManagerInstance *>(bustub_instance->buffer_pool_manager_);
+  Page *pages = bpm->GetPages();
+  size_t pool_size = bpm->GetPoolSize();
 
   // make sure that all pages in the buffer pool are marked as non-dirty
   bool all_pages_clean = true;
@@ -314,4 +374,877 @@ TEST(RecoveryTest, DISABLED_CheckpointTest) {
   remove("test.db");
   remove("test.log");
 }
+// NOLINTNEXTLINE
+TEST(RecoveryTest, FuzzyCheckpointTest) {
+  remove("test.db");
+  remove("test.log");
+  auto *bustub_instance = new BustubInstance("test.db");
+  Column col1{"a", TypeId::VARCHAR, 20};
+  Column col2{"b", TypeId::SMALLINT};
+  Schema schema{std::vector<Column>{col1, col2}};
+  Tuple tuple = ConstructTuple(&schema);
+
+  // the checkpoint is taken while a transaction is running, which a blocking one would wait for
+  Transaction *txn = bustub_instance->transaction_manager_->Begin();
+  auto *test_table = new TableHeap(bustub_instance->buffer_pool_manager_, bustub_instance->lock_manager_,
+                                   bustub_instance->log_manager_, txn);
+  for (int i = 0; i < 100; i++) {
+    RID rid;
+    EXPECT_TRUE(test_table->InsertTuple(tuple, &rid, txn));
+  }
+  bustub_instance->checkpoint_manager_->FuzzyCheckpoint();
+
+  // it holds the transaction and the pages it dirtied, none of which was written back
+  LogRecord checkpoint = bustub_instance->checkpoint_manager_->GetLastCheckpoint();
+  EXPECT_EQ(LogRecordType::ENDCHECKPOINT, checkpoint.GetLogRecordType());
+  auto &active_txns = checkpoint.GetActiveTransactions();
+  auto entry = std::make_pair(txn->GetTransactionId(), txn->GetPrevLSN());
+  EXPECT_NE(active_txns.end(), std::find(active_txns.begin(), active_txns.end(), entry));
+  auto &dirty_pages = checkpoint.GetDirtyPages();
+  page_id_t first_page_id = test_table->GetFirstPageId();
+  EXPECT_NE(dirty_pages.end(), std::find_if(dirty_pages.begin(), dirty_pages.end(), [&](const auto &page) {
+              return page.first == first_page_id;
+            }));
+  Page *page = bustub_instance->buffer_pool_manager_->FetchPage(first_page_id);
+  EXPECT_TRUE(page->IsDirty());
+
+  // the recovery LSN of a page is that of its first change since it was written back
+  page->WLatch();
+  page->SetLSN(7);
+  page->SetLSN(9);
+  page->WUnlatch();
+  EXPECT_EQ(7, page->GetRecLSN());
+  bustub_instance->buffer_pool_manager_->UnpinPage(first_page_id, true);
+  bustub_instance->buffer_pool_manager_->FlushPage(first_page_id);
+  EXPECT_EQ(INVALID_LSN, page->GetRecLSN());
+  bustub_instance->transaction_manager_->Commit(txn);
+
+  delete txn;
+  delete test_table;
+  delete bustub_instance;
+  remove("test.db");
+  remove("test.log");
+}
+
+// NOLINTNEXTLINE
+TEST(RecoveryTest, WaitForPersistentTest) {
+  DiskManager disk_manager("test.db");
+  LogManager log_manager(&disk_manager);
+
+  // a committed transaction waits until its commit record, and not just an earlier one, is on disk
+  std::atomic<bool> persistent{false};
+  std::thread waiter([&log_manager, &persistent] {
+    log_manager.WaitForPersistent(5);
+    persistent = true;
+  });
+  log_manager.SetPersistentLSN(3);
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  EXPECT_FALSE(persistent);
+  log_manager.SetPersistentLSN(5);
+  waiter.join();
+  EXPECT_TRUE(persistent);
+  log_manager.WaitForPersistent(INVALID_LSN);
+
+  disk_manager.ShutDown();
+  remove("test.db");
+  remove("test.log");
+}
+
+// NOLINTNEXTLINE
+TEST(RecoveryTest, StopFlushThreadTest) {
+  remove("test.db");
+  remove("test.log");
+  DiskManager disk_manager("test.db");
+  LogManager log_manager(&disk_manager);
+
+  // the flush thread writes the records appended before it stops, however soon after it started that is; another
+  // thread keeps taking the latch of the flushes, so that the stop often takes it before the flush thread first does
+  std::atomic<bool> done{false};
+  std::thread contender([&log_manager, &done] {
+    while (!done) {
+      log_manager.GetGroupCommitDelay();
+    }
+  });
+  for (int i = 0; i < 1000 && !HasFailure(); i++) {
+    LogRecord record(i, INVALID_LSN, LogRecordType::COMMIT);
+    lsn_t lsn = log_manager.AppendLogRecord(&record);
+    log_manager.RunFlushThread();
+    log_manager.StopFlushThread();
+    EXPECT_EQ(lsn, log_manager.GetPersistentLSN());
+  }
+  done = true;
+  contender.join();
+  enable_logging = false;
+
+  disk_manager.ShutDown();
+  remove("test.db");
+  remove("test.log");
+}
+
+// NOLINTNEXTLINE
+TEST(RecoveryTest, ConcurrentAppendTest) {
+  remove("test.db");
+  remove("test.log");
+  DiskManager disk_manager("test.db");
+  LogManager log_manager(&disk_manager);
+  log_manager.RunFlushThread();
+
+  // the appends of the threads fill the buffer several times over, with no latch between them
+  const int num_threads = 4;
+  const int per_thread = 2000;
+  std::vector<std::thread> threads;
+  for (int t = 0; t < num_threads; t++) {
+    threads.emplace_back([&log_manager, t] {
+      for (int i = 0; i < per_thread; i++) {
+        LogRecord record(t, INVALID_LSN, LogRecordType::COMMIT);
+        log_manager.AppendLogRecord(&record);
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  lsn_t last_lsn = num_threads * per_thread - 1;
+  EXPECT_EQ(last_lsn + 1, log_manager.GetNextLSN());
+  log_manager.WaitForPersistent(last_lsn);
+  EXPECT_EQ(last_lsn, log_manager.GetPersistentLSN());
+  log_manager.StopFlushThread();
+  enable_logging = false;
+
+  // the log holds every record once, in the order of their LSNs
+  char header[20];
+  for (lsn_t lsn = 0; lsn <= last_lsn; lsn++) {
+    ASSERT_TRUE(disk_manager.ReadLog(header, sizeof(header), lsn * static_cast<int>(sizeof(header))));
+    EXPECT_EQ(20, *reinterpret_cast<int32_t *>(header));
+    EXPECT_EQ(lsn, *reinterpret_cast<lsn_t *>(header + 4));
+  }
+  EXPECT_FALSE(disk_manager.ReadLog(header, sizeof(header), (last_lsn + 1) * static_cast<int>(sizeof(header))));
+
+  disk_manager.ShutDown();
+  remove("test.db");
+  remove("test.log");
+}
+
+// NOLINTNEXTLINE
+TEST(RecoveryTest, GroupCommitTest) {
+  remove("test.db");
+  remove("test.log");
+  DiskManager disk_manager("test.db");
+  LogManager log_manager(&disk_manager);
+  log_manager.RunFlushThread();
+
+  // the commits that wait together are made durable by fewer writes than there are commits
+  const int num_threads = 8;
+  const int per_thread = 100;
+  std::vector<std::thread> threads;
+  for (int t = 0; t < num_threads; t++) {
+    threads.emplace_back([&log_manager, t] {
+      for (int i = 0; i < per_thread; i++) {
+        LogRecord record(t, INVALID_LSN, LogRecordType::COMMIT);
+        lsn_t lsn = log_manager.AppendLogRecord(&record);
+        log_manager.WaitForPersistent(lsn);
+        EXPECT_LE(lsn, log_manager.GetPersistentLSN());
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  EXPECT_LT(disk_manager.GetNumFlushes(), num_threads * per_thread);
+
+  // a commit alone is no longer held back for others once the groups are of one
+  for (int i = 0; i < 10; i++) {
+    LogRecord record(0, INVALID_LSN, LogRecordType::COMMIT);
+    log_manager.WaitForPersistent(log_manager.AppendLogRecord(&record));
+  }
+  EXPECT_EQ(std::chrono::microseconds(0), log_manager.GetGroupCommitDelay());
+  log_manager.StopFlushThread();
+
+  disk_manager.ShutDown();
+  remove("test.db");
+  remove("test.log");
+}
+
+// NOLINTNEXTLINE
+TEST(RecoveryTest, AsyncCommitTest) {
+  remove("test.db");
+  remove("test.log");
+  auto *bustub_instance = new BustubInstance("test.db");
+  LogManager *log_manager = bustub_instance->log_manager_;
+  log_manager->RunFlushThread();
+  async_commit_delay = std::chrono::milliseconds(20);
+
+  // the commit returns before the flush thread, which would otherwise wait out log_timeout, writes it within the delay
+  Transaction *txn = bustub_instance->transaction_manager_->Begin();
+  txn->SetAsyncCommit(true);
+  LogRecord begin(txn->GetTransactionId(), INVALID_LSN, LogRecordType::BEGIN);
+  txn->SetPrevLSN(log_manager->AppendLogRecord(&begin));
+  bustub_instance->transaction_manager_->Commit(txn);
+  lsn_t commit_lsn = txn->GetPrevLSN();
+  EXPECT_NE(INVALID_LSN, commit_lsn);
+  auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(500);
+  while (log_manager->GetPersistentLSN() < commit_lsn && std::chrono::steady_clock::now() < deadline) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  EXPECT_LE(commit_lsn, log_manager->GetPersistentLSN());
+  delete txn;
+
+  async_commit_delay = std::chrono::milliseconds(10);
+  delete bustub_instance;
+  remove("test.db");
+  remove("test.log");
+}
+
+// NOLINTNEXTLINE
+TEST(RecoveryTest, ParallelRedoTest) {
+  remove("test.db");
+  remove("test.log");
+  auto *bustub_instance = new BustubInstance("test.db");
+  bustub_instance->log_manager_->RunFlushThread();
+  Schema schema{std::vector<Column>{Column{"a", TypeId::INTEGER}, Column{"b", TypeId::VARCHAR, 100}}};
+  auto make_tuple = [&schema](int a) {
+    std::vector<Value> values{ValueFactory::GetIntegerValue(a), ValueFactory::GetVarcharValue(std::string(80, 'x'))};
+    return Tuple{values, &schema};
+  };
+
+  // a committed transaction writes more pages than the buffer pool holds, so that some of them reach the disk before
+  // the crash and others do not; one that did not commit writes over some of its records
+  const int num_tuples = 500;
+  Transaction *txn = bustub_instance->transaction_manager_->Begin();
+  auto *test_table = new TableHeap(bustub_instance->buffer_pool_manager_, bustub_instance->lock_manager_,
+                                   bustub_instance->log_manager_, txn);
+  page_id_t first_page_id = test_table->GetFirstPageId();
+  std::vector<RID> rids(num_tuples);
+  for (int i = 0; i < num_tuples; i++) {
+    ASSERT_TRUE(test_table->InsertTuple(make_tuple(i), &rids[i], txn));
+  }
+  for (int i = 0; i < num_tuples; i += 3) {
+    ASSERT_TRUE(test_table->UpdateTuple(make_tuple(i + num_tuples), rids[i], txn));
+  }
+  for (int i = 0; i < num_tuples; i += 5) {
+    ASSERT_TRUE(test_table->MarkDelete(rids[i], txn));
+  }
+  bustub_instance->transaction_manager_->Commit(txn);
+  delete txn;
+
+  Transaction *loser = bustub_instance->transaction_manager_->Begin();
+  RID lost_rid;
+  ASSERT_TRUE(test_table->InsertTuple(make_tuple(-1), &lost_rid, loser));
+  for (int i = 1; i < num_tuples; i += 7) {
+    if (i % 5 != 0) {
+      ASSERT_TRUE(test_table->MarkDelete(rids[i], loser));
+    }
+  }
+  bustub_instance->log_manager_->Flush();
+  delete loser;
+  delete test_table;
+  delete bustub_instance;
+
+  bustub_instance = new BustubInstance("test.db");
+  LogRecovery log_recovery(bustub_instance->disk_manager_, bustub_instance->buffer_pool_manager_, 4);
+  log_recovery.Redo();
+  log_recovery.Undo();
+
+  // the table holds what the committed transaction left, and nothing of the other
+  txn = bustub_instance->transaction_manager_->Begin();
+  test_table = new TableHeap(bustub_instance->buffer_pool_manager_, bustub_instance->lock_manager_,
+                             bustub_instance->log_manager_, first_page_id);
+  Tuple tuple;
+  for (int i = 0; i < num_tuples; i++) {
+    if (i % 5 == 0) {
+      EXPECT_FALSE(test_table->GetTuple(rids[i], &tuple, txn));
+      continue;
+    }
+    ASSERT_TRUE(test_table->GetTuple(rids[i], &tuple, txn));
+    EXPECT_EQ(i % 3 == 0 ? i + num_tuples : i, tuple.GetValue(&schema, 0).GetAs<int32_t>());
+  }
+  EXPECT_FALSE(test_table->GetTuple(lost_rid, &tuple, txn));
+  bustub_instance->transaction_manager_->Commit(txn);
+  delete txn;
+  delete test_table;
+  delete bustub_instance;
+  remove("test.db");
+  remove("test.log");
+}
+
+// NOLINTNEXTLINE
+TEST(RecoveryTest, LargeLogRedoTest) {
+  remove("test.db");
+  remove("test.log");
+  auto *bustub_instance = new BustubInstance("test.db");
+  bustub_instance->log_manager_->RunFlushThread();
+  Schema schema{std::vector<Column>{Column{"a", TypeId::INTEGER}, Column{"b", TypeId::VARCHAR, 1024}}};
+  // the tuples are of an odd size, so that the records do not tile the chunks the log is read in, and many of them
+  // are cut off by the end of one and carried to the next
+  auto make_tuple = [&schema](int a) {
+    std::string b = std::to_string(a) + std::string(1001, static_cast<char>('a' + a % 26));
+    b.resize(1001);
+    std::vector<Value> values{ValueFactory::GetIntegerValue(a), ValueFactory::GetVarcharValue(b)};
+    return Tuple{values, &schema};
+  };
+
+  // a few chunks of log, redone by several threads, whose records are views of chunks read long before they are
+  // applied
+  const int num_tuples = 4 * LogRecovery::REDO_READ_SIZE / 1000;
+  Transaction *txn = bustub_instance->transaction_manager_->Begin();
+  auto *test_table = new TableHeap(bustub_instance->buffer_pool_manager_, bustub_instance->lock_manager_,
+                                   bustub_instance->log_manager_, txn);
+  page_id_t first_page_id = test_table->GetFirstPageId();
+  std::vector<RID> rids(num_tuples);
+  for (int i = 0; i < num_tuples; i++) {
+    ASSERT_TRUE(test_table->InsertTuple(make_tuple(i), &rids[i], txn));
+  }
+  for (int i = 0; i < num_tuples; i += 4) {
+    ASSERT_TRUE(test_table->UpdateTuple(make_tuple(i + num_tuples), rids[i], txn));
+  }
+  bustub_instance->transaction_manager_->Commit(txn);
+  delete txn;
+  bustub_instance->log_manager_->Flush();
+  EXPECT_GT(bustub_instance->disk_manager_->GetLogEnd(), 4 * LogRecovery::REDO_READ_SIZE);
+  delete test_table;
+  delete bustub_instance;
+
+  bustub_instance = new BustubInstance("test.db");
+  LogRecovery log_recovery(bustub_instance->disk_manager_, bustub_instance->buffer_pool_manager_, 4);
+  log_recovery.Redo();
+  log_recovery.Undo();
+
+  txn = bustub_instance->transaction_manager_->Begin();
+  test_table = new TableHeap(bustub_instance->buffer_pool_manager_, bustub_instance->lock_manager_,
+                             bustub_instance->log_manager_, first_page_id);
+  Tuple tuple;
+  for (int i = 0; i < num_tuples; i++) {
+    ASSERT_TRUE(test_table->GetTuple(rids[i], &tuple, txn)) << i;
+    int a = i % 4 == 0 ? i + num_tuples : i;
+    EXPECT_EQ(a, tuple.GetValue(&schema, 0).GetAs<int32_t>());
+    EXPECT_EQ(make_tuple(a).GetValue(&schema, 1).ToString(), tuple.GetValue(&schema, 1).ToString()) << i;
+  }
+  bustub_instance->transaction_manager_->Commit(txn);
+  delete txn;
+  delete test_table;
+  delete bustub_instance;
+  remove("test.db");
+  remove("test.log");
+}
+
+// NOLINTNEXTLINE
+TEST(RecoveryTest, CompressedLogTest) {
+  Schema schema{std::vector<Column>{Column{"a", TypeId::INTEGER}, Column{"b", TypeId::VARCHAR, 100}}};
+  auto make_tuple = [&schema](int a) {
+    std::vector<Value> values{ValueFactory::GetIntegerValue(a), ValueFactory::GetVarcharValue(std::string(80, 'x'))};
+    return Tuple{values, &schema};
+  };
+
+  // the same transactions, with the log written as it is and compressed: a committed one, and one that did not
+  // commit, which undo reads back from the blocks
+  const int num_tuples = 500;
+  int64_t log_size[2];
+  for (bool compress : {false, true}) {
+    remove("test.db");
+    remove("test.log");
+    auto *bustub_instance = new BustubInstance("test.db", BUFFER_POOL_SIZE, compress);
+    bustub_instance->log_manager_->RunFlushThread();
+    Transaction *txn = bustub_instance->transaction_manager_->Begin();
+    auto *test_table = new TableHeap(bustub_instance->buffer_pool_manager_, bustub_instance->lock_manager_,
+                                     bustub_instance->log_manager_, txn);
+    page_id_t first_page_id = test_table->GetFirstPageId();
+    std::vector<RID> rids(num_tuples);
+    for (int i = 0; i < num_tuples; i++) {
+      ASSERT_TRUE(test_table->InsertTuple(make_tuple(i), &rids[i], txn));
+      if (i % 50 == 0) {
+        bustub_instance->log_manager_->Flush();
+      }
+    }
+    bustub_instance->transaction_manager_->Commit(txn);
+    delete txn;
+    Transaction *loser = bustub_instance->transaction_manager_->Begin();
+    for (int i = 0; i < num_tuples; i += 3) {
+      ASSERT_TRUE(test_table->UpdateTuple(make_tuple(-i), rids[i], loser));
+    }
+    bustub_instance->log_manager_->Flush();
+    log_size[compress ? 1 : 0] = bustub_instance->disk_manager_->GetLogEnd();
+    delete loser;
+    delete test_table;
+    delete bustub_instance;
+
+    bustub_instance = new BustubInstance("test.db");
+    LogRecovery log_recovery(bustub_instance->disk_manager_, bustub_instance->buffer_pool_manager_, 2);
+    log_recovery.Redo();
+    log_recovery.Undo();
+    txn = bustub_instance->transaction_manager_->Begin();
+    test_table = new TableHeap(bustub_instance->buffer_pool_manager_, bustub_instance->lock_manager_,
+                               bustub_instance->log_manager_, first_page_id);
+    Tuple tuple;
+    for (int i = 0; i < num_tuples; i++) {
+      ASSERT_TRUE(test_table->GetTuple(rids[i], &tuple, txn));
+      EXPECT_EQ(i, tuple.GetValue(&schema, 0).GetAs<int32_t>());
+    }
+    bustub_instance->transaction_manager_->Commit(txn);
+    delete txn;
+    delete test_table;
+    delete bustub_instance;
+  }
+  EXPECT_LT(log_size[1] * 2, log_size[0]);
+  remove("test.db");
+  remove("test.log");
+}
+
+// NOLINTNEXTLINE
+TEST(RecoveryTest, ReplicaTest) {
+  remove("test.db");
+  remove("test.log");
+  remove("replica.db");
+  remove("replica.log");
+  auto *bustub_instance = new BustubInstance("test.db", BUFFER_POOL_SIZE, true);
+  bustub_instance->log_manager_->RunFlushThread();
+  Schema schema{std::vector<Column>{Column{"a", TypeId::INTEGER}, Column{"b", TypeId::VARCHAR, 100}}};
+  auto make_tuple = [&schema](int a) {
+    std::vector<Value> values{ValueFactory::GetIntegerValue(a), ValueFactory::GetVarcharValue(std::string(80, 'x'))};
+    return Tuple{values, &schema};
+  };
+
+  // the replica follows the log, compressed, from its start, part of which is on disk before it does, with fewer
+  // frames than the table has pages
+  const int num_tuples = 500;
+  Transaction *txn = bustub_instance->transaction_manager_->Begin();
+  auto *test_table = new TableHeap(bustub_instance->buffer_pool_manager_, bustub_instance->lock_manager_,
+                                   bustub_instance->log_manager_, txn);
+  page_id_t first_page_id = test_table->GetFirstPageId();
+  std::vector<RID> rids(num_tuples);
+  for (int i = 0; i < num_tuples / 2; i++) {
+    ASSERT_TRUE(test_table->InsertTuple(make_tuple(i), &rids[i], txn));
+  }
+  bustub_instance->log_manager_->Flush();
+
+  {
+    DiskManager replica_disk("replica.db");
+    BufferPoolManagerInstance replica_pool(10, &replica_disk);
+    LogReplica replica(&replica_pool, 2);
+    ASSERT_TRUE(replica.Follow(bustub_instance->log_manager_));
+    for (int i = num_tuples / 2; i < num_tuples; i++) {
+      ASSERT_TRUE(test_table->InsertTuple(make_tuple(i), &rids[i], txn));
+    }
+    for (int i = 0; i < num_tuples; i += 3) {
+      ASSERT_TRUE(test_table->UpdateTuple(make_tuple(i + num_tuples), rids[i], txn));
+    }
+    for (int i = 0; i < num_tuples; i += 5) {
+      ASSERT_TRUE(test_table->MarkDelete(rids[i], txn));
+    }
+    bustub_instance->transaction_manager_->Commit(txn);
+    lsn_t commit_lsn = txn->GetPrevLSN();
+
+    // the reads on the replica see the commit once it is redone
+    ASSERT_TRUE(replica.WaitForLSN(commit_lsn, std::chrono::seconds(10)));
+    ReplicationStats stats = replica.GetStats();
+    EXPECT_GE(stats.applied_lsn_, commit_lsn);
+    EXPECT_EQ(0, stats.LagBytes());
+    EXPECT_EQ(0, stats.lag_us_);
+    auto hold = replica.BeginRead();
+    LockManager replica_locks(DeadlockPolicy::WOUND_WAIT);
+    Transaction read_txn(0);
+    TableHeap replica_table(&replica_pool, &replica_locks, nullptr, first_page_id);
+    Tuple tuple;
+    for (int i = 0; i < num_tuples; i++) {
+      if (i % 5 != 0) {
+        ASSERT_TRUE(replica_table.GetTuple(rids[i], &tuple, &read_txn));
+        EXPECT_EQ(i % 3 == 0 ? i + num_tuples : i, tuple.GetValue(&schema, 0).GetAs<int32_t>());
+      }
+    }
+    // a read of a deleted tuple aborts the transaction, so these go last
+    for (int i = 0; i < num_tuples; i += 5) {
+      EXPECT_FALSE(replica_table.GetTuple(rids[i], &tuple, &read_txn));
+    }
+  }
+
+  delete txn;
+  delete test_table;
+  delete bustub_instance;
+  remove("test.db");
+  remove("test.log");
+  remove("replica.db");
+  remove("replica.log");
+}
+
+// NOLINTNEXTLINE
+TEST(RecoveryTest, IndexRedoTest) {
+  remove("test.db");
+  remove("test.log");
+  Schema schema{std::vector<Column>{Column{"a", TypeId::INTEGER}}};
+  std::unique_ptr<Schema> key_schema(Schema::CopySchema(&schema, {0}));
+  auto make_key = [&key_schema](int32_t i) { return Tuple({ValueFactory::GetIntegerValue(i)}, key_schema.get()); };
+  const int32_t num_keys = 50;
+
+  auto *bustub_instance = new BustubInstance("test.db");
+  page_id_t header_page_id;
+  bustub_instance->buffer_pool_manager_->NewPage(&header_page_id);
+  ASSERT_EQ(HEADER_PAGE_ID, header_page_id);
+  bustub_instance->buffer_pool_manager_->UnpinPage(header_page_id, true);
+  bustub_instance->log_manager_->RunFlushThread();
+  auto *catalog =
+      new Catalog(bustub_instance->buffer_pool_manager_, bustub_instance->lock_manager_, bustub_instance->log_manager_);
+  catalog->Open();
+  Transaction *txn = bustub_instance->transaction_manager_->Begin();
+  catalog->CreateTable(txn, "t", schema);
+  IndexInfo *index_info =
+      catalog->CreateIndex<GenericKey<8>, RID, GenericComparator<8>>(txn, "t_a", "t", schema, *key_schema, {0}, 8);
+  bustub_instance->transaction_manager_->Commit(txn);
+  delete txn;
+  bustub_instance->buffer_pool_manager_->FlushAllPages();
+
+  // the entries of a transaction that committed are written back by the checkpoint, those of the one after it and of
+  // one that did not commit are only in the log
+  txn = bustub_instance->transaction_manager_->Begin();
+  for (int32_t i = 0; i < num_keys; i++) {
+    catalog->InsertIndexEntry(index_info, make_key(i), RID(1, i), txn);
+  }
+  bustub_instance->transaction_manager_->Commit(txn);
+  delete txn;
+  bustub_instance->checkpoint_manager_->FuzzyCheckpoint();
+  txn = bustub_instance->transaction_manager_->Begin();
+  for (int32_t i = 40; i < num_keys; i++) {
+    catalog->DeleteIndexEntry(index_info, make_key(i), RID(1, i), txn);
+  }
+  bustub_instance->transaction_manager_->Commit(txn);
+  delete txn;
+  // the loser is not begun by the transaction manager, which would take it as running past the crash
+  Transaction loser(INT32_MAX);
+  for (int32_t i = 0; i < 5; i++) {
+    catalog->DeleteIndexEntry(index_info, make_key(i), RID(1, i), &loser);
+    catalog->InsertIndexEntry(index_info, make_key(100 + i), RID(2, i), &loser);
+  }
+  bustub_instance->log_manager_->Flush();
+  delete catalog;
+  delete bustub_instance;
+
+  // redo replays the entries from the restart point into the index as it was written back, and undo rolls back those
+  // of the loser
+  bustub_instance = new BustubInstance("test.db");
+  catalog =
+      new Catalog(bustub_instance->buffer_pool_manager_, bustub_instance->lock_manager_, bustub_instance->log_manager_);
+  catalog->Open();
+  LogRecovery log_recovery(bustub_instance->disk_manager_, bustub_instance->buffer_pool_manager_, 2,
+                           bustub_instance->log_manager_);
+  log_recovery.SetCatalog(catalog);
+  log_recovery.Redo();
+  EXPECT_GT(log_recovery.GetRestartOffset(), 0);
+  log_recovery.Undo();
+  index_info = catalog->GetIndex("t_a", "t");
+  ASSERT_NE(nullptr, index_info);
+  for (int32_t i = 0; i < num_keys; i++) {
+    std::vector<RID> result;
+    index_info->index_->ScanKey(make_key(i), &result, nullptr);
+    if (i < 40) {
+      ASSERT_EQ(1, result.size());
+      EXPECT_EQ(RID(1, i), result[0]);
+    } else {
+      EXPECT_TRUE(result.empty());
+    }
+  }
+  for (int32_t i = 0; i < 5; i++) {
+    std::vector<RID> result;
+    index_info->index_->ScanKey(make_key(100 + i), &result, nullptr);
+    EXPECT_TRUE(result.empty());
+  }
+  delete catalog;
+  delete bustub_instance;
+
+  remove("test.db");
+  remove("test.log");
+}
+
+// NOLINTNEXTLINE
+TEST(RecoveryTest, CheckpointRestartTest) {
+  remove("test.db");
+  remove("test.log");
+  auto *bustub_instance = new BustubInstance("test.db");
+  bustub_instance->log_manager_->RunFlushThread();
+  Schema schema{std::vector<Column>{Column{"a", TypeId::INTEGER}, Column{"b", TypeId::VARCHAR, 100}}};
+  auto make_tuple = [&schema](int a) {
+    std::vector<Value> values{ValueFactory::GetIntegerValue(a), ValueFactory::GetVarcharValue(std::string(80, 'x'))};
+    return Tuple{values, &schema};
+  };
+
+  // the work of a transaction that committed and was written back comes before the checkpoint; that of one that
+  // committed and of one that did not is not written back
+  const int num_tuples = 100;
+  Transaction *txn = bustub_instance->transaction_manager_->Begin();
+  auto *test_table = new TableHeap(bustub_instance->buffer_pool_manager_, bustub_instance->lock_manager_,
+                                   bustub_instance->log_manager_, txn);
+  page_id_t first_page_id = test_table->GetFirstPageId();
+  std::vector<RID> rids(num_tuples);
+  for (int i = 0; i < num_tuples / 2; i++) {
+    ASSERT_TRUE(test_table->InsertTuple(make_tuple(i), &rids[i], txn));
+  }
+  bustub_instance->transaction_manager_->Commit(txn);
+  delete txn;
+  bustub_instance->buffer_pool_manager_->FlushAllPages();
+
+  txn = bustub_instance->transaction_manager_->Begin();
+  for (int i = num_tuples / 2; i < num_tuples; i++) {
+    ASSERT_TRUE(test_table->InsertTuple(make_tuple(i), &rids[i], txn));
+  }
+  bustub_instance->transaction_manager_->Commit(txn);
+  delete txn;
+
+  Transaction *loser = bustub_instance->transaction_manager_->Begin();
+  RID lost_rid;
+  ASSERT_TRUE(test_table->InsertTuple(make_tuple(-1), &lost_rid, loser));
+  bustub_instance->checkpoint_manager_->FuzzyCheckpoint();
+  for (int i = 0; i < num_tuples; i += 3) {
+    ASSERT_TRUE(test_table->MarkDelete(rids[i], loser));
+  }
+  for (int i = 1; i < num_tuples; i += 3) {
+    ASSERT_TRUE(test_table->UpdateTuple(make_tuple(-i), rids[i], loser));
+  }
+  bustub_instance->log_manager_->Flush();
+  delete loser;
+  delete test_table;
+  delete bustub_instance;
+
+  auto check = [&](BustubInstance *instance) {
+    Transaction *check_txn = instance->transaction_manager_->Begin();
+    TableHeap table(instance->buffer_pool_manager_, instance->lock_manager_, instance->log_manager_, first_page_id);
+    Tuple tuple;
+    for (int i = 0; i < num_tuples; i++) {
+      ASSERT_TRUE(table.GetTuple(rids[i], &tuple, check_txn));
+      EXPECT_EQ(i, tuple.GetValue(&schema, 0).GetAs<int32_t>());
+    }
+    EXPECT_FALSE(table.GetTuple(lost_rid, &tuple, check_txn));
+    instance->transaction_manager_->Commit(check_txn);
+    delete check_txn;
+  };
+
+  // restart reads the log from the checkpoint's restart point, past the work that was written back, rolls back the
+  // transaction that did not commit and logs it; a crash right after, before any page is written back, redoes the
+  // rollback from its compensation records, and undoes nothing again
+  for (int restart = 0; restart < 2; restart++) {
+    bustub_instance = new BustubInstance("test.db");
+    LogRecovery log_recovery(bustub_instance->disk_manager_, bustub_instance->buffer_pool_manager_, 2,
+                             bustub_instance->log_manager_);
+    log_recovery.Redo();
+    EXPECT_GT(log_recovery.GetRestartOffset(), 0);
+    log_recovery.Undo();
+    check(bustub_instance);
+    delete bustub_instance;
+  }
+
+  remove("test.db");
+  remove("test.log");
+}
+
+// NOLINTNEXTLINE
+TEST(RecoveryTest, InstantRestartTest) {
+  remove("test.db");
+  remove("test.log");
+  auto *bustub_instance = new BustubInstance("test.db");
+  bustub_instance->log_manager_->RunFlushThread();
+  Schema schema{std::vector<Column>{Column{"a", TypeId::INTEGER}}};
+  auto make_tuple = [&schema](int a) { return Tuple{std::vector<Value>{ValueFactory::GetIntegerValue(a)}, &schema}; };
+
+  const int num_tuples = 10;
+  Transaction *txn = bustub_instance->transaction_manager_->Begin();
+  auto *test_table = new TableHeap(bustub_instance->buffer_pool_manager_, bustub_instance->lock_manager_,
+                                   bustub_instance->log_manager_, txn);
+  page_id_t first_page_id = test_table->GetFirstPageId();
+  std::vector<RID> rids(num_tuples);
+  for (int i = 0; i < num_tuples; i++) {
+    ASSERT_TRUE(test_table->InsertTuple(make_tuple(i), &rids[i], txn));
+  }
+  bustub_instance->transaction_manager_->Commit(txn);
+  delete txn;
+
+  // the loser is not begun by the transaction manager, which would take it as running past the crash
+  const txn_id_t loser_id = 1000;
+  Transaction loser(loser_id);
+  for (int i = 0; i < num_tuples / 2; i++) {
+    ASSERT_TRUE(test_table->UpdateTuple(make_tuple(-i), rids[i], &loser));
+  }
+  bustub_instance->log_manager_->Flush();
+  delete test_table;
+  delete bustub_instance;
+
+  // the loser holds the rows it changed from the analysis pass on, and the new transactions come after it
+  bustub_instance = new BustubInstance("test.db");
+  LogRecovery log_recovery(bustub_instance->disk_manager_, bustub_instance->buffer_pool_manager_, 2,
+                           bustub_instance->log_manager_);
+  log_recovery.SetLockManager(bustub_instance->lock_manager_);
+  log_recovery.Redo();
+  EXPECT_EQ(loser_id + 1, log_recovery.GetNextTxnId());
+  bustub_instance->transaction_manager_->SetNextTxnId(log_recovery.GetNextTxnId());
+  Transaction *recovered = TransactionManager::GetTransaction(loser_id);
+  ASSERT_NE(nullptr, recovered);
+  EXPECT_TRUE(recovered->IsExclusiveLocked(rids[0]));
+  EXPECT_FALSE(recovered->IsExclusiveLocked(rids[num_tuples - 1]));
+
+  // a transaction reads the rows the loser did not change before undo starts, and waits for those it did
+  bustub_instance->log_manager_->RunFlushThread();
+  TableHeap table(bustub_instance->buffer_pool_manager_, bustub_instance->lock_manager_, bustub_instance->log_manager_,
+                  first_page_id);
+  txn = bustub_instance->transaction_manager_->Begin();
+  EXPECT_GT(txn->GetTransactionId(), loser_id);
+  Tuple tuple;
+  for (int i = num_tuples / 2; i < num_tuples; i++) {
+    ASSERT_TRUE(table.GetTuple(rids[i], &tuple, txn));
+    EXPECT_EQ(i, tuple.GetValue(&schema, 0).GetAs<int32_t>());
+  }
+  log_recovery.UndoInBackground();
+  for (int i = 0; i < num_tuples / 2; i++) {
+    ASSERT_TRUE(table.GetTuple(rids[i], &tuple, txn));
+    EXPECT_EQ(i, tuple.GetValue(&schema, 0).GetAs<int32_t>());
+  }
+  bustub_instance->transaction_manager_->Commit(txn);
+  delete txn;
+  log_recovery.WaitForUndo();
+  EXPECT_EQ(nullptr, TransactionManager::GetTransaction(loser_id));
+  delete bustub_instance;
+
+  remove("test.db");
+  remove("test.log");
+}
+
+// NOLINTNEXTLINE
+TEST(RecoveryTest, UpdateDeltaTest) {
+  Schema schema{std::vector<Column>{Column{"a", TypeId::INTEGER}, Column{"b", TypeId::VARCHAR, 500},
+                                    Column{"c", TypeId::BIGINT}}};
+  auto make_tuple = [&schema](int a, size_t length, int64_t c) {
+    return Tuple{std::vector<Value>{ValueFactory::GetIntegerValue(a),
+                                    ValueFactory::GetVarcharValue(std::string(length, 'x')),
+                                    ValueFactory::GetBigIntValue(c)},
+                 &schema};
+  };
+  auto check = [](const Tuple &old_tuple, const Tuple &new_tuple) {
+    LogRecord record(0, INVALID_LSN, LogRecordType::UPDATE, RID(0, 0), old_tuple, new_tuple);
+    Tuple redone;
+    LogRecord::ApplyUpdate(record.GetUpdateDelta(), old_tuple, false, &redone);
+    EXPECT_EQ(std::string(new_tuple.GetData(), new_tuple.GetLength()),
+              std::string(redone.GetData(), redone.GetLength()));
+    Tuple undone;
+    LogRecord::ApplyUpdate(record.GetUpdateDelta(), new_tuple, true, &undone);
+    EXPECT_EQ(std::string(old_tuple.GetData(), old_tuple.GetLength()),
+              std::string(undone.GetData(), undone.GetLength()));
+    return record.GetSize();
+  };
+
+  // an update of a fixed-size column of a large tuple logs the bytes of the column, not the two tuples
+  Tuple tuple = make_tuple(1, 450, 7);
+  EXPECT_LT(check(tuple, make_tuple(2, 450, 7)), 64);
+  EXPECT_LT(check(tuple, make_tuple(2, 450, 8)), 96);
+  EXPECT_EQ(check(tuple, tuple), check(make_tuple(3, 10, 3), make_tuple(3, 10, 3)));
+  // one whose length changes logs the bytes from the first change to the last
+  check(tuple, make_tuple(1, 300, 7));
+  check(make_tuple(1, 300, 7), make_tuple(5, 450, 9));
+}
+
+// NOLINTNEXTLINE
+TEST(RecoveryTest, BackupTest) {
+  remove("test.db");
+  remove("test.log");
+  std::filesystem::remove_all("backup_full");
+  std::filesystem::remove_all("backup_incremental");
+  auto *bustub_instance = new BustubInstance("test.db");
+  bustub_instance->log_manager_->RunFlushThread();
+  // the rows take up as many pages whatever the page size, so that most of them are left be by the incremental backup
+  Schema schema{std::vector<Column>{Column{"a", TypeId::INTEGER}, Column{"b", TypeId::VARCHAR, PAGE_SIZE / 40}}};
+  auto make_tuple = [&schema](int a) {
+    std::vector<Value> values{ValueFactory::GetIntegerValue(a),
+                              ValueFactory::GetVarcharValue(std::string(PAGE_SIZE / 50, 'x'))};
+    return Tuple{values, &schema};
+  };
+  Transaction *txn = bustub_instance->transaction_manager_->Begin();
+  auto *test_table = new TableHeap(bustub_instance->buffer_pool_manager_, bustub_instance->lock_manager_,
+                                   bustub_instance->log_manager_, txn);
+  page_id_t first_page_id = test_table->GetFirstPageId();
+  bustub_instance->transaction_manager_->Commit(txn);
+  delete txn;
+
+  // transactions of five rows each commit one after the other, before and all through the full backup
+  const int rows_per_txn = 5;
+  std::vector<RID> rids;
+  std::atomic<int> committed{0};
+  std::atomic<bool> stop{false};
+  auto write = [&](int num_txns) {
+    for (int t = 0; (num_txns < 0 || t < num_txns) && !stop; t++) {
+      Transaction *writer = bustub_instance->transaction_manager_->Begin();
+      for (int i = 0; i < rows_per_txn; i++) {
+        rids.emplace_back();
+        ASSERT_TRUE(test_table->InsertTuple(make_tuple(static_cast<int>(rids.size()) - 1), &rids.back(), writer));
+      }
+      bustub_instance->transaction_manager_->Commit(writer);
+      delete writer;
+      committed++;
+    }
+  };
+  write(40);
+  BackupManager backup_manager(bustub_instance->disk_manager_, bustub_instance->buffer_pool_manager_,
+                               bustub_instance->log_manager_, bustub_instance->checkpoint_manager_);
+  std::thread writer_thread(write, -1);
+  while (committed < 50) {
+    std::this_thread::yield();
+  }
+  BackupStats full;
+  ASSERT_TRUE(backup_manager.Backup("backup_full", "", &full));
+  stop = true;
+  writer_thread.join();
+  int committed_before = 50;
+  EXPECT_EQ(full.num_pages_, full.pages_copied_);
+
+  // a few rows change, so that the incremental backup copies a few pages rather than all
+  txn = bustub_instance->transaction_manager_->Begin();
+  for (int i = 0; i < 10; i++) {
+    ASSERT_TRUE(test_table->UpdateTuple(make_tuple(-i), rids[i], txn));
+  }
+  bustub_instance->transaction_manager_->Commit(txn);
+  delete txn;
+  bustub_instance->buffer_pool_manager_->FlushAllPages();
+  BackupStats incremental;
+  ASSERT_TRUE(backup_manager.Backup("backup_incremental", "backup_full", &incremental));
+  EXPECT_GE(incremental.num_pages_, full.num_pages_);
+  EXPECT_LT(incremental.pages_copied_, full.pages_copied_ / 2);
+  EXPECT_LT(incremental.pages_read_, incremental.num_pages_);
+  EXPECT_GT(incremental.end_lsn_, full.end_lsn_);
+  size_t num_rows = rids.size();
+  delete test_table;
+  delete bustub_instance;
+
+  // a restore recovers a prefix of the transactions, all of those that committed before the backup began
+  auto restore = [&](const std::vector<std::string> &backups) {
+    remove("restore.db");
+    remove("restore.log");
+    EXPECT_TRUE(BackupManager::Restore(backups, "restore.db"));
+    auto *instance = new BustubInstance("restore.db");
+    LogRecovery log_recovery(instance->disk_manager_, instance->buffer_pool_manager_, 2, instance->log_manager_);
+    log_recovery.Redo();
+    log_recovery.Undo();
+    Transaction *check_txn = instance->transaction_manager_->Begin();
+    TableHeap table(instance->buffer_pool_manager_, instance->lock_manager_, instance->log_manager_, first_page_id);
+    std::vector<int> values;
+    for (auto iter = table.Begin(check_txn); iter != table.End(); ++iter) {
+      values.push_back(iter->GetValue(&schema, 0).GetAs<int32_t>());
+    }
+    instance->transaction_manager_->Commit(check_txn);
+    delete check_txn;
+    delete instance;
+    remove("restore.db");
+    remove("restore.log");
+    return values;
+  };
+  std::vector<int> values = restore({"backup_full"});
+  EXPECT_EQ(0, values.size() % rows_per_txn);
+  EXPECT_LE(static_cast<size_t>(committed_before * rows_per_txn), values.size());
+  for (size_t i = 0; i < values.size(); i++) {
+    EXPECT_EQ(static_cast<int>(i), values[i]);
+  }
+  values = restore({"backup_full", "backup_incremental"});
+  ASSERT_EQ(num_rows, values.size());
+  for (size_t i = 0; i < values.size(); i++) {
+    EXPECT_EQ(i < 10 ? -static_cast<int>(i) : static_cast<int>(i), values[i]);
+  }
+  EXPECT_FALSE(BackupManager::Restore({"backup_incremental"}, "restore.db"));
+
+  std::filesystem::remove_all("backup_full");
+  std::filesystem::remove_all("backup_incremental");
+  remove("test.db");
+  remove("test.log");
+}
+
 }  // namespace bustub
@@ -2,15 +2,18 @@
  * b_plus_tree_test.cpp
  */
 
+#include <atomic>
 #include <chrono>  // NOLINT
 #include <cstdio>
 #include <functional>
 #include <thread>                   // NOLINT
 #include "b_plus_tree_test_util.h"  // NOLINT
 
-#include "buffer/buffer_pool_manager.h"
+#include "buffer/buffer_pool_manager_instance.h"
+#include "concurrency/transaction_manager.h"
 #include "gtest/gtest.h"
 #include "storage/index/b_plus_tree.h"
+#include "storage/index/b_plus_tree_index.h"
 
 namespace bustub {
 // helper function to launch multiple threads
@@ -92,13 +95,13 @@ void DeleteHelperSplit(BPlusTree<GenericKey<8>, RID, GenericComparator<8>> *tree
   delete transaction;
 }
 
-TEST(BPlusTreeConcurrentTest, DISABLED_InsertTest1) {
+TEST(BPlusTreeConcurrentTest, InsertTest1) {
   // create KeyComparator and index schema
   Schema *key_schema = ParseCreateStatement("a bigint");
   GenericComparator<8> comparator(key_schema);
 
   DiskManager *disk_manager = new DiskManager("test.db");
-  BufferPoolManager *bpm = new BufferPoolManager(50, disk_manager);
+  BufferPoolManager *bpm = new BufferPoolManagerInstance(50, disk_manager);
   // create b+ tree
   BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator);
   // create and fetch header_page
@@ -145,12 +148,12 @@ TEST(BPlusTreeConcurrentTest, DISABLED_InsertTest1) {
   remove("test.log");
 }
 
-TEST(BPlusTreeConcurrentTest, DISABLED_InsertTest2) {
+TEST(BPlusTreeConcurrentTest, InsertTest2) {
   // create KeyComparator and index schema
   Schema *key_schema = ParseCreateStatement("a bigint");
   GenericComparator<8> comparator(key_schema);
   DiskManager *disk_manager = new DiskManager("test.db");
-  BufferPoolManager *bpm = new BufferPoolManager(50, disk_manager);
+  BufferPoolManager *bpm = new BufferPoolManagerInstance(50, disk_manager);
   // create b+ tree
   BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator);
   // create and fetch header_page
@@ -197,13 +200,13 @@ TEST(BPlusTreeConcurrentTest, DISABLED_InsertTest2) {
   remove("test.log");
 }
 
-TEST(BPlusTreeConcurrentTest, DISABLED_DeleteTest1) {
+TEST(BPlusTreeConcurrentTest, DeleteTest1) {
   // create KeyComparator and index schema
   Schema *key_schema = ParseCreateStatement("a bigint");
   GenericComparator<8> comparator(key_schema);
 
   DiskManager *disk_manager = new DiskManager("test.db");
-  BufferPoolManager *bpm = new BufferPoolManager(50, disk_manager);
+  BufferPoolManager *bpm = new BufferPoolManagerInstance(50, disk_manager);
   // create b+ tree
   BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator);
   GenericKey<8> index_key;
@@ -240,13 +243,13 @@ TEST(BPlusTreeConcurrentTest, DISABLED_DeleteTest1) {
   remove("test.log");
 }
 
-TEST(BPlusTreeConcurrentTest, DISABLED_DeleteTest2) {
+TEST(BPlusTreeConcurrentTest, DeleteTest2) {
   // create KeyComparator and index schema
   Schema *key_schema = ParseCreateStatement("a bigint");
   GenericComparator<8> comparator(key_schema);
 
   DiskManager *disk_manager = new DiskManager("test.db");
-  BufferPoolManager *bpm = new BufferPoolManager(50, disk_manager);
+  BufferPoolManager *bpm = new BufferPoolManagerInstance(50, disk_manager);
   // create b+ tree
   BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator);
   GenericKey<8> index_key;
@@ -284,13 +287,13 @@ TEST(BPlusTreeConcurrentTest, DISABLED_DeleteTest2) {
   remove("test.log");
 }
 
-TEST(BPlusTreeConcurrentTest, DISABLED_MixTest) {
+TEST(BPlusTreeConcurrentTest, MixTest) {
   // create KeyComparator and index schema
   Schema *key_schema = ParseCreateStatement("a bigint");
   GenericComparator<8> comparator(key_schema);
 
   DiskManager *disk_manager = new DiskManager("test.db");
-  BufferPoolManager *bpm = new BufferPoolManager(50, disk_manager);
+  BufferPoolManager *bpm = new BufferPoolManagerInstance(50, disk_manager);
   // create b+ tree
   BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator);
   GenericKey<8> index_key;
@@ -330,4 +333,295 @@ TEST(BPlusTreeConcurrentTest, DISABLED_MixTest) {
   remove("test.log");
 }
 
+TEST(BPlusTreeConcurrentTest, SmallNodeMixTest) {
+  // small nodes, so that concurrent inserts and removes keep splitting and merging
+  Schema *key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema);
+
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManagerInstance(256, disk_manager);
+  BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator, 4, 5);
+  GenericKey<8> index_key;
+
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(&page_id);
+  (void)header_page;
+
+  const int64_t scale_factor = 1000;
+  std::vector<int64_t> keys;
+  std::vector<int64_t> remove_keys;
+  for (int64_t key = 1; key <= scale_factor; key++) {
+    keys.push_back(key);
+    if (key % 2 == 0) {
+      remove_keys.push_back(key);
+    }
+  }
+  LaunchParallelTest(4, InsertHelperSplit, &tree, keys, 4);
+  // the even keys go while a scan runs alongside in either direction
+  std::thread scanner([&tree] {
+    int64_t previous = 0;
+    for (auto iterator = tree.begin(); iterator != tree.end(); ++iterator) {
+      int64_t current = (*iterator).second.GetSlotNum();
+      EXPECT_LT(previous, current);
+      previous = current;
+    }
+  });
+  std::thread reverse_scanner([&tree] {
+    int64_t previous = scale_factor + 1;
+    for (auto iterator = tree.rbegin(); iterator != tree.rend(); ++iterator) {
+      int64_t current = (*iterator).second.GetSlotNum();
+      EXPECT_GT(previous, current);
+      previous = current;
+    }
+  });
+  LaunchParallelTest(4, DeleteHelperSplit, &tree, remove_keys, 4);
+  scanner.join();
+  reverse_scanner.join();
+
+  int64_t current_key = 1;
+  for (auto iterator = tree.begin(); iterator != tree.end(); ++iterator) {
+    EXPECT_EQ((*iterator).first.ToString(), current_key);
+    current_key += 2;
+  }
+  EXPECT_EQ(current_key, scale_factor + 1);
+  for (int64_t key = 1; key <= scale_factor; key++) {
+    std::vector<RID> rids;
+    index_key.SetFromInteger(key);
+    EXPECT_EQ(tree.GetValue(index_key, &rids), key % 2 == 1);
+  }
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete key_schema;
+  delete disk_manager;
+  delete bpm;
+  remove("test.db");
+  remove("test.log");
+}
+
+TEST(BPlusTreeConcurrentTest, OptimisticLookupTest) {
+  // lookups of the odd keys, which stay, run without latches while the even keys keep splitting and merging nodes
+  Schema *key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema);
+
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManagerInstance(256, disk_manager);
+  BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator, 4, 5);
+
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(&page_id);
+  (void)header_page;
+
+  const int64_t scale_factor = 1000;
+  std::vector<int64_t> keys;
+  std::vector<int64_t> even_keys;
+  for (int64_t key = 1; key <= scale_factor; key++) {
+    (key % 2 == 0 ? even_keys : keys).push_back(key);
+  }
+  InsertHelper(&tree, keys);
+
+  std::atomic<bool> done{false};
+  std::vector<std::thread> readers;
+  for (int t = 0; t < 2; t++) {
+    readers.emplace_back([&] {
+      GenericKey<8> index_key;
+      while (!done) {
+        for (auto key : keys) {
+          std::vector<RID> rids;
+          index_key.SetFromInteger(key);
+          ASSERT_TRUE(tree.GetValue(index_key, &rids)) << "Failed to find " << key;
+          ASSERT_EQ(key, rids[0].GetSlotNum());
+        }
+      }
+    });
+  }
+  for (int round = 0; round < 3; round++) {
+    LaunchParallelTest(2, InsertHelperSplit, &tree, even_keys, 2);
+    LaunchParallelTest(2, DeleteHelperSplit, &tree, even_keys, 2);
+  }
+  done = true;
+  for (auto &reader : readers) {
+    reader.join();
+  }
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete key_schema;
+  delete disk_manager;
+  delete bpm;
+  remove("test.db");
+  remove("test.log");
+}
+
+TEST(BPlusTreeConcurrentTest, AdaptiveHashTest) {
+  // hot lookups go through the adaptive hash index while the even keys keep splitting and merging the leaves
+  Schema *key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema);
+
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManagerInstance(256, disk_manager);
+  BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator, 4, 5);
+  tree.EnableAdaptiveHashIndex(64);
+  GenericKey<8> index_key;
+
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(&page_id);
+  (void)header_page;
+
+  const int64_t scale_factor = 1000;
+  std::vector<int64_t> keys;
+  std::vector<int64_t> even_keys;
+  for (int64_t key = 1; key <= scale_factor; key++) {
+    (key % 2 == 0 ? even_keys : keys).push_back(key);
+  }
+  InsertHelper(&tree, keys);
+
+  // a handful of keys is looked up over and over, and turns hot
+  const std::vector<int64_t> hot_keys{1, 101, 333, 555, 777, 999};
+  for (int round = 0; round < 10; round++) {
+    for (auto key : hot_keys) {
+      std::vector<RID> rids;
+      index_key.SetFromInteger(key);
+      ASSERT_TRUE(tree.GetValue(index_key, &rids));
+      ASSERT_EQ(key, rids[0].GetSlotNum());
+    }
+  }
+  AdaptiveHashStats stats = tree.GetAdaptiveHashStats();
+  EXPECT_EQ(hot_keys.size(), stats.installs_);
+  EXPECT_EQ(hot_keys.size() * 6, stats.hits_);
+
+  std::atomic<bool> done{false};
+  std::vector<std::thread> readers;
+  for (int t = 0; t < 2; t++) {
+    readers.emplace_back([&] {
+      GenericKey<8> key_of_reader;
+      while (!done) {
+        for (auto key : hot_keys) {
+          std::vector<RID> rids;
+          key_of_reader.SetFromInteger(key);
+          ASSERT_TRUE(tree.GetValue(key_of_reader, &rids)) << "Failed to find " << key;
+          ASSERT_EQ(key, rids[0].GetSlotNum());
+        }
+      }
+    });
+  }
+  for (int round = 0; round < 3; round++) {
+    LaunchParallelTest(2, InsertHelperSplit, &tree, even_keys, 2);
+    LaunchParallelTest(2, DeleteHelperSplit, &tree, even_keys, 2);
+  }
+  done = true;
+  for (auto &reader : readers) {
+    reader.join();
+  }
+
+  // a hot key that is removed is not found through its stale entry
+  index_key.SetFromInteger(555);
+  tree.Remove(index_key);
+  std::vector<RID> rids;
+  EXPECT_FALSE(tree.GetValue(index_key, &rids));
+  for (auto key : keys) {
+    index_key.SetFromInteger(key);
+    EXPECT_EQ(key != 555, tree.GetValue(index_key, &rids));
+  }
+  EXPECT_LT(stats.hits_, tree.GetAdaptiveHashStats().hits_);
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete key_schema;
+  delete disk_manager;
+  delete bpm;
+  remove("test.db");
+  remove("test.log");
+}
+
+TEST(BPlusTreeConcurrentTest, KeyRangeLockTest) {
+  Schema *schema = ParseCreateStatement("a bigint");
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManagerInstance(50, disk_manager);
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(&page_id);
+  (void)header_page;
+
+  LockManager lock_mgr{};
+  TransactionManager txn_mgr{&lock_mgr};
+  BPlusTreeIndex<GenericKey<8>, RID, GenericComparator<8>> index(new IndexMetadata("foo_pk", "foo", schema, {0}),
+                                                                 bpm);
+  auto key_tuple = [&schema](int64_t key) { return Tuple({Value(TypeId::BIGINT, key)}, schema); };
+  for (int64_t key = 10; key <= 40; key += 10) {
+    index.InsertEntry(key_tuple(key), RID(0, key), nullptr);
+  }
+  index.SetLockManager(&lock_mgr, 0);
+
+  // a lookup of a missing key locks the range it would be in, up to 30
+  auto *reader = txn_mgr.Begin(nullptr, IsolationLevel::SERIALIZABLE);
+  std::vector<RID> rids;
+  index.ScanKey(key_tuple(25), &rids, reader);
+  EXPECT_TRUE(rids.empty());
+  EXPECT_EQ(1, reader->GetSharedLockSet()->size());
+
+  // inserts elsewhere go ahead, and hold their own entries only
+  auto *writer = txn_mgr.Begin(nullptr, IsolationLevel::SERIALIZABLE);
+  index.InsertEntry(key_tuple(50), RID(0, 50), writer);
+  index.InsertEntry(key_tuple(15), RID(0, 15), writer);
+  EXPECT_EQ(2, writer->GetExclusiveLockSet()->size());
+  txn_mgr.Commit(writer);
+
+  // an insert into the locked range waits for the reader, which finds no phantom as it looks again
+  std::atomic<bool> inserted{false};
+  std::thread inserter([&] {
+    auto *txn = txn_mgr.Begin(nullptr, IsolationLevel::SERIALIZABLE);
+    index.InsertEntry(key_tuple(27), RID(0, 27), txn);
+    inserted = true;
+    txn_mgr.Commit(txn);
+    delete txn;
+  });
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  EXPECT_FALSE(inserted);
+  index.ScanKey(key_tuple(27), &rids, reader);
+  EXPECT_TRUE(rids.empty());
+  txn_mgr.Commit(reader);
+  inserter.join();
+  EXPECT_TRUE(inserted);
+  index.ScanKey(key_tuple(27), &rids, nullptr);
+  EXPECT_EQ(1, rids.size());
+
+  // a scan locks each entry it reads and the one past its range; deleting the entry past it waits as well
+  auto *scanner = txn_mgr.Begin(nullptr, IsolationLevel::SERIALIZABLE);
+  GenericKey<8> from = index.MakeSearchKey(key_tuple(20));
+  auto iterator = index.GetBeginIterator(from);
+  std::vector<int64_t> scanned;
+  while (true) {
+    index.LockScanPosition(&iterator, &from, scanned.empty(), scanner);
+    if (iterator.isEnd() || (*iterator).second.GetSlotNum() > 30) {
+      break;
+    }
+    scanned.push_back((*iterator).second.GetSlotNum());
+    from = (*iterator).first;
+    ++iterator;
+  }
+  iterator = decltype(iterator)();
+  EXPECT_EQ((std::vector<int64_t>{20, 27, 30}), scanned);
+  EXPECT_EQ(4, scanner->GetSharedLockSet()->size());
+  std::atomic<bool> deleted{false};
+  std::thread deleter([&] {
+    auto *txn = txn_mgr.Begin(nullptr, IsolationLevel::SERIALIZABLE);
+    index.DeleteEntry(key_tuple(40), RID(0, 40), txn);
+    deleted = true;
+    txn_mgr.Commit(txn);
+    delete txn;
+  });
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  EXPECT_FALSE(deleted);
+  txn_mgr.Commit(scanner);
+  deleter.join();
+  EXPECT_TRUE(deleted);
+
+  delete reader;
+  delete writer;
+  delete scanner;
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete schema;
+  delete disk_manager;
+  delete bpm;
+  remove("test.db");
+  remove("test.log");
+}
+
 }  // namespace bustub
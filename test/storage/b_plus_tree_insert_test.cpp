@@ -4,21 +4,26 @@
 
 #include <algorithm>
 #include <cstdio>
+#include <cstring>
+#include <memory>
+#include <random>
+#include <vector>
 
 #include "b_plus_tree_test_util.h"  // NOLINT
-#include "buffer/buffer_pool_manager.h"
+#include "buffer/buffer_pool_manager_instance.h"
 #include "gtest/gtest.h"
 #include "storage/index/b_plus_tree.h"
+#include "storage/index/b_plus_tree_index.h"
 
 namespace bustub {
 
-TEST(BPlusTreeTests, DISABLED_InsertTest1) {
+TEST(BPlusTreeTests, InsertTest1) {
   // create KeyComparator and index schema
   Schema *key_schema = ParseCreateStatement("a bigint");
   GenericComparator<8> comparator(key_schema);
 
   DiskManager *disk_manager = new DiskManager("test.db");
-  BufferPoolManager *bpm = new BufferPoolManager(50, disk_manager);
+  BufferPoolManager *bpm = new BufferPoolManagerInstance(50, disk_manager);
   // create b+ tree
   BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator, 2, 3);
   GenericKey<8> index_key;
@@ -71,13 +76,13 @@ TEST(BPlusTreeTests, DISABLED_InsertTest1) {
   remove("test.log");
 }
 
-TEST(BPlusTreeTests, DISABLED_InsertTest2) {
+TEST(BPlusTreeTests, InsertTest2) {
   // create KeyComparator and index schema
   Schema *key_schema = ParseCreateStatement("a bigint");
   GenericComparator<8> comparator(key_schema);
 
   DiskManager *disk_manager = new DiskManager("test.db");
-  BufferPoolManager *bpm = new BufferPoolManager(50, disk_manager);
+  BufferPoolManager *bpm = new BufferPoolManagerInstance(50, disk_manager);
   // create b+ tree
   BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator);
   GenericKey<8> index_key;
@@ -139,4 +144,659 @@ TEST(BPlusTreeTests, DISABLED_InsertTest2) {
   remove("test.db");
   remove("test.log");
 }
+
+TEST(BPlusTreeTests, BulkLoadTest) {
+  // create KeyComparator and index schema
+  Schema *key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema);
+
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManagerInstance(50, disk_manager);
+  GenericKey<8> index_key;
+  RID rid;
+
+  // create and fetch header_page
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(&page_id);
+  (void)header_page;
+
+  for (double fill_factor : {0.0, 0.7, 1.0}) {
+    for (int64_t num_keys : {1, 3, 7, 1000}) {
+      // create b+ tree
+      BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator, 4, 5);
+      std::vector<std::pair<GenericKey<8>, RID>> pairs;
+      for (int64_t key = 1; key <= num_keys; key++) {
+        index_key.SetFromInteger(2 * key);
+        rid.Set(static_cast<int32_t>(key >> 32), key & 0xFFFFFFFF);
+        pairs.emplace_back(index_key, rid);
+      }
+      std::vector<std::pair<GenericKey<8>, RID>> unsorted(pairs.rbegin(), pairs.rend());
+      if (num_keys > 1) {
+        EXPECT_FALSE(tree.BulkLoad(unsorted, fill_factor));
+      }
+      ASSERT_TRUE(tree.BulkLoad(pairs, fill_factor));
+      EXPECT_FALSE(tree.BulkLoad(pairs, fill_factor));
+
+      int64_t current_key = 1;
+      for (auto iterator = tree.begin(); iterator != tree.end(); ++iterator) {
+        EXPECT_EQ((*iterator).second.GetSlotNum(), current_key);
+        current_key = current_key + 1;
+      }
+      EXPECT_EQ(current_key, num_keys + 1);
+
+      // the loaded nodes split and coalesce like inserted ones
+      for (int64_t key = 1; key <= num_keys; key++) {
+        index_key.SetFromInteger(2 * key - 1);
+        rid.Set(1, key);
+        EXPECT_TRUE(tree.Insert(index_key, rid));
+        if (key % 2 == 0) {
+          index_key.SetFromInteger(2 * key);
+          tree.Remove(index_key);
+        }
+      }
+      std::vector<RID> rids;
+      for (int64_t key = 1; key <= num_keys; key++) {
+        rids.clear();
+        index_key.SetFromInteger(2 * key);
+        EXPECT_EQ(tree.GetValue(index_key, &rids), key % 2 == 1) << "key " << key << " of " << num_keys;
+        rids.clear();
+        index_key.SetFromInteger(2 * key - 1);
+        ASSERT_TRUE(tree.GetValue(index_key, &rids));
+        EXPECT_EQ(rids[0].GetPageId(), 1);
+        EXPECT_EQ(rids[0].GetSlotNum(), key);
+      }
+      for (int64_t key = 1; key <= 2 * num_keys; key++) {
+        index_key.SetFromInteger(key);
+        tree.Remove(index_key);
+      }
+      EXPECT_TRUE(tree.IsEmpty());
+    }
+  }
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete key_schema;
+  delete disk_manager;
+  delete bpm;
+  remove("test.db");
+  remove("test.log");
+}
+
+TEST(BPlusTreeTests, CompressedKeyTest) {
+  // create KeyComparator and index schema; only the first 8 bytes of a key are compared, the others are payload
+  Schema *key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<64> comparator(key_schema);
+
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManagerInstance(50, disk_manager);
+  // create b+ tree
+  BPlusTree<GenericKey<64>, RID, GenericComparator<64>> tree("foo_pk", bpm, comparator);
+  GenericKey<64> index_key;
+  RID rid;
+
+  // create and fetch header_page
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(&page_id);
+  (void)header_page;
+
+  // narrow keys are mostly zero padding; every other key has random bytes all over, which widens the slots of its
+  // leaf once it comes along
+  const int64_t num_keys = 10000;
+  std::vector<GenericKey<64>> keys(num_keys);
+  std::mt19937 rng(15445);
+  for (int64_t key = 0; key < num_keys; key++) {
+    keys[key].SetFromInteger(key);
+    if (key % 2 == 1) {
+      for (size_t i = sizeof(int64_t); i < sizeof(keys[key].data_); i++) {
+        keys[key].data_[i] = static_cast<char>(rng());
+      }
+    }
+  }
+  std::vector<std::pair<GenericKey<64>, RID>> narrow_pairs;
+  for (int64_t key = 0; key < num_keys; key += 2) {
+    rid.Set(0, key);
+    narrow_pairs.emplace_back(keys[key], rid);
+  }
+  ASSERT_TRUE(tree.BulkLoad(narrow_pairs));
+  // the narrow keys fit into leaves of far more pairs than their full width allows
+  int num_leaves = 0;
+  index_key.SetFromInteger(0);
+  Page *page = tree.FindLeafPage(index_key, true);
+  while (page != nullptr) {
+    num_leaves++;
+    page_id_t next_page_id =
+        reinterpret_cast<BPlusTreeLeafPage<GenericKey<64>, RID, GenericComparator<64>> *>(page->GetData())
+            ->GetNextPageId();
+    bpm->UnpinPage(page->GetPageId(), false);
+    page = next_page_id == INVALID_PAGE_ID ? nullptr : bpm->FetchPage(next_page_id);
+  }
+  EXPECT_LT(num_leaves * PAGE_SIZE, narrow_pairs.size() * sizeof(narrow_pairs[0]));
+
+  for (int64_t key = 1; key < num_keys; key += 2) {
+    rid.Set(0, key);
+    ASSERT_TRUE(tree.Insert(keys[key], rid));
+  }
+  // the keys come back byte for byte
+  int64_t current_key = 0;
+  for (auto iterator = tree.begin(); iterator != tree.end(); ++iterator) {
+    ASSERT_EQ(memcmp((*iterator).first.data_, keys[current_key].data_, sizeof(keys[current_key].data_)), 0);
+    EXPECT_EQ((*iterator).second.GetSlotNum(), current_key);
+    current_key = current_key + 1;
+  }
+  EXPECT_EQ(current_key, num_keys);
+
+  // merged leaves hold keys of either kind
+  for (int64_t key = 0; key < num_keys; key += 3) {
+    tree.Remove(keys[key]);
+  }
+  std::vector<RID> rids;
+  for (int64_t key = 0; key < num_keys; key++) {
+    rids.clear();
+    EXPECT_EQ(tree.GetValue(keys[key], &rids), key % 3 != 0);
+  }
+  for (int64_t key = 0; key < num_keys; key++) {
+    tree.Remove(keys[key]);
+  }
+  EXPECT_TRUE(tree.IsEmpty());
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete key_schema;
+  delete disk_manager;
+  delete bpm;
+  remove("test.db");
+  remove("test.log");
+}
+
+TEST(BPlusTreeTests, BatchScanTest) {
+  // create KeyComparator and index schema
+  Schema *key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema);
+
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManagerInstance(50, disk_manager);
+  // create b+ tree
+  BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator, 4, 5);
+  GenericKey<8> index_key;
+  RID rid;
+
+  // create and fetch header_page
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(&page_id);
+  (void)header_page;
+
+  const int64_t num_keys = 1000;
+  for (int64_t key = 1; key <= num_keys; key++) {
+    rid.Set(0, key);
+    index_key.SetFromInteger(key);
+    tree.Insert(index_key, rid);
+  }
+
+  // batches pick up where single steps left off, and cover the rest of the range leaf by leaf
+  int64_t start_key = 500;
+  int64_t current_key = start_key;
+  index_key.SetFromInteger(start_key);
+  auto iterator = tree.Begin(index_key);
+  ++iterator;
+  ++current_key;
+  std::vector<std::pair<GenericKey<8>, RID>> batch;
+  int num_batches = 0;
+  while (iterator.NextBatch(&batch)) {
+    EXPECT_FALSE(batch.empty());
+    EXPECT_LT(batch.size(), 4);
+    for (const auto &pair : batch) {
+      EXPECT_EQ(pair.second.GetSlotNum(), current_key);
+      current_key = current_key + 1;
+    }
+    num_batches++;
+  }
+  EXPECT_TRUE(batch.empty());
+  EXPECT_TRUE(iterator.isEnd());
+  EXPECT_EQ(current_key, num_keys + 1);
+  EXPECT_GT(num_batches, (num_keys - start_key) / 4);
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete key_schema;
+  delete disk_manager;
+  delete bpm;
+  remove("test.db");
+  remove("test.log");
+}
+
+TEST(BPlusTreeTests, ReverseScanTest) {
+  // create KeyComparator and index schema
+  Schema *key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema);
+
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManagerInstance(50, disk_manager);
+  // create b+ tree
+  BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator, 4, 5);
+  GenericKey<8> index_key;
+  RID rid;
+
+  // create and fetch header_page
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(&page_id);
+  (void)header_page;
+
+  EXPECT_TRUE(tree.rbegin() == tree.rend());
+
+  const int64_t num_keys = 1000;
+  for (int64_t key = 2; key <= 2 * num_keys; key += 2) {
+    rid.Set(0, key);
+    index_key.SetFromInteger(key);
+    tree.Insert(index_key, rid);
+  }
+
+  int64_t current_key = 2 * num_keys;
+  for (auto iterator = tree.rbegin(); iterator != tree.rend(); ++iterator) {
+    EXPECT_EQ((*iterator).second.GetSlotNum(), current_key);
+    current_key -= 2;
+  }
+  EXPECT_EQ(current_key, 0);
+
+  // starting at a key that is there, and at one that is not
+  for (int64_t start_key : {1000, 1001}) {
+    current_key = start_key - start_key % 2;
+    index_key.SetFromInteger(start_key);
+    for (auto iterator = tree.RBegin(index_key); !iterator.isEnd(); ++iterator) {
+      EXPECT_EQ((*iterator).second.GetSlotNum(), current_key);
+      current_key -= 2;
+    }
+    EXPECT_EQ(current_key, 0);
+  }
+  index_key.SetFromInteger(1);
+  EXPECT_TRUE(tree.RBegin(index_key) == tree.rend());
+
+  // merges have to keep the leaves linked back to front
+  for (int64_t key = 4; key <= 2 * num_keys; key += 4) {
+    index_key.SetFromInteger(key);
+    tree.Remove(index_key);
+  }
+  current_key = 2 * num_keys - 2;
+  for (auto iterator = tree.rbegin(); iterator != tree.rend(); ++iterator) {
+    EXPECT_EQ((*iterator).second.GetSlotNum(), current_key);
+    current_key -= 4;
+  }
+  EXPECT_EQ(current_key, -2);
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete key_schema;
+  delete disk_manager;
+  delete bpm;
+  remove("test.db");
+  remove("test.log");
+}
+
+TEST(BPlusTreeTests, NonUniqueIndexTest) {
+  Schema *schema = ParseCreateStatement("a bigint");
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManagerInstance(50, disk_manager);
+
+  // create and fetch header_page
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(&page_id);
+  (void)header_page;
+
+  // a key leaves no room for the RID in GenericKey<8>
+  EXPECT_THROW((BPlusTreeIndex<GenericKey<8>, RID, GenericComparator<8>>(
+                   new IndexMetadata("foo_idx", "foo", schema, {0}, false), bpm)),
+               Exception);
+
+  BPlusTreeIndex<GenericKey<16>, RID, GenericComparator<16>> index(
+      new IndexMetadata("foo_idx", "foo", schema, {0}, false), bpm);
+  // few distinct keys with many entries each, enough for the entries of a key to span several leaves
+  const int64_t num_keys = 10;
+  const int64_t num_rids = 500;
+  auto key_tuple = [&schema](int64_t key) { return Tuple({Value(TypeId::BIGINT, key)}, schema); };
+  for (int64_t rid = 0; rid < num_rids; rid++) {
+    for (int64_t key = 0; key < num_keys; key++) {
+      index.InsertEntry(key_tuple(key), RID(static_cast<page_id_t>(rid), key), nullptr);
+    }
+  }
+
+  for (int64_t key = 0; key < num_keys; key++) {
+    std::vector<RID> rids;
+    index.ScanKey(key_tuple(key), &rids, nullptr);
+    ASSERT_EQ(rids.size(), num_rids);
+    for (int64_t rid = 0; rid < num_rids; rid++) {
+      EXPECT_EQ(rids[rid], RID(static_cast<page_id_t>(rid), key));
+    }
+  }
+
+  // removing an entry leaves the other entries of its key alone
+  for (int64_t rid = 0; rid < num_rids; rid += 2) {
+    index.DeleteEntry(key_tuple(3), RID(static_cast<page_id_t>(rid), 3), nullptr);
+  }
+  std::vector<RID> rids;
+  index.ScanKey(key_tuple(3), &rids, nullptr);
+  ASSERT_EQ(rids.size(), num_rids / 2);
+  for (int64_t i = 0; i < num_rids / 2; i++) {
+    EXPECT_EQ(rids[i], RID(static_cast<page_id_t>(2 * i + 1), 3));
+  }
+  rids.clear();
+  index.ScanKey(key_tuple(num_keys), &rids, nullptr);
+  EXPECT_TRUE(rids.empty());
+
+  // a batch of lookups, out of order, with repeats and misses, finds what the lookups one by one do
+  std::vector<Tuple> batch;
+  for (int64_t key = -1; key <= num_keys; key++) {
+    batch.push_back(key_tuple(key));
+    batch.push_back(key_tuple(num_keys - key));
+  }
+  std::vector<std::vector<RID>> results;
+  index.ScanKeys(batch, &results, nullptr);
+  ASSERT_EQ(results.size(), batch.size());
+  for (size_t i = 0; i < batch.size(); i++) {
+    rids.clear();
+    index.ScanKey(batch[i], &rids, nullptr);
+    EXPECT_EQ(results[i], rids);
+  }
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete schema;
+  delete disk_manager;
+  delete bpm;
+  remove("test.db");
+  remove("test.log");
+}
+
+TEST(BPlusTreeTests, DeltaIndexTest) {
+  Schema *schema = ParseCreateStatement("a bigint");
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManagerInstance(50, disk_manager);
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(&page_id);
+  (void)header_page;
+  auto key_tuple = [&schema](int64_t key) { return Tuple({Value(TypeId::BIGINT, key)}, schema); };
+  auto scan = [&key_tuple](Index *index, int64_t key) {
+    std::vector<RID> rids;
+    index->ScanKey(key_tuple(key), &rids, nullptr);
+    return rids;
+  };
+
+  auto index = std::make_unique<BPlusTreeIndex<GenericKey<8>, RID, GenericComparator<8>>>(
+      new IndexMetadata("foo_idx", "foo", schema, {0}), bpm);
+  index->EnableDelta(64);
+  // keys in random order, which the merges write to the tree in key order
+  const int64_t num_keys = 1000;
+  std::vector<int64_t> keys(num_keys);
+  for (int64_t key = 0; key < num_keys; key++) {
+    keys[key] = key;
+  }
+  std::shuffle(keys.begin(), keys.end(), std::mt19937(3));
+  for (int64_t key : keys) {
+    index->InsertEntry(key_tuple(key), RID(static_cast<page_id_t>(key), 0), nullptr);
+  }
+  EXPECT_EQ(num_keys % 64, index->GetDeltaSize());
+  for (int64_t key = 0; key < num_keys; key++) {
+    ASSERT_EQ(std::vector<RID>{RID(static_cast<page_id_t>(key), 0)}, scan(index.get(), key)) << key;
+  }
+
+  // the last write of a key in the delta wins over the tree, as it would in the tree itself
+  index->MergeDelta();
+  index->DeleteEntry(key_tuple(1), RID(), nullptr);
+  index->DeleteEntry(key_tuple(2), RID(), nullptr);
+  index->InsertEntry(key_tuple(2), RID(2, 1), nullptr);
+  index->InsertEntry(key_tuple(3), RID(3, 1), nullptr);
+  index->InsertEntry(key_tuple(num_keys), RID(num_keys, 0), nullptr);
+  index->DeleteEntry(key_tuple(num_keys), RID(), nullptr);
+  EXPECT_EQ(4, index->GetDeltaSize());
+  EXPECT_TRUE(scan(index.get(), 1).empty());
+  EXPECT_EQ(std::vector<RID>{RID(2, 1)}, scan(index.get(), 2));
+  EXPECT_EQ(std::vector<RID>{RID(3, 0)}, scan(index.get(), 3));
+  EXPECT_TRUE(scan(index.get(), num_keys).empty());
+
+  // an iterator sees the delta, as it is merged first
+  int64_t count = 0;
+  for (auto iterator = index->GetBeginIterator(); !iterator.isEnd(); ++iterator) {
+    count++;
+  }
+  EXPECT_EQ(num_keys - 1, count);
+  EXPECT_EQ(0, index->GetDeltaSize());
+  EXPECT_EQ(std::vector<RID>{RID(2, 1)}, scan(index.get(), 2));
+  index.reset();
+
+  // the entries of a key of a non-unique index come from the tree and the delta in RID order
+  auto non_unique = std::make_unique<BPlusTreeIndex<GenericKey<16>, RID, GenericComparator<16>>>(
+      new IndexMetadata("bar_idx", "foo", schema, {0}, false), bpm);
+  for (int rid = 0; rid < 10; rid += 2) {
+    non_unique->InsertEntry(key_tuple(7), RID(rid, 0), nullptr);
+  }
+  non_unique->EnableDelta(100);
+  for (int rid = 1; rid < 10; rid += 2) {
+    non_unique->InsertEntry(key_tuple(7), RID(rid, 0), nullptr);
+  }
+  non_unique->DeleteEntry(key_tuple(7), RID(4, 0), nullptr);
+  non_unique->InsertEntry(key_tuple(8), RID(4, 0), nullptr);
+  std::vector<RID> expected{RID(0, 0), RID(1, 0), RID(2, 0), RID(3, 0), RID(5, 0),
+                            RID(6, 0), RID(7, 0), RID(8, 0), RID(9, 0)};
+  EXPECT_EQ(expected, scan(non_unique.get(), 7));
+  std::vector<std::vector<RID>> results;
+  non_unique->ScanKeys({key_tuple(8), key_tuple(7)}, &results, nullptr);
+  EXPECT_EQ(std::vector<RID>{RID(4, 0)}, results[0]);
+  EXPECT_EQ(expected, results[1]);
+  // writing to the tree again merges the delta
+  non_unique->EnableDelta(0);
+  EXPECT_EQ(0, non_unique->GetDeltaSize());
+  EXPECT_EQ(expected, scan(non_unique.get(), 7));
+  non_unique.reset();
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete schema;
+  delete disk_manager;
+  delete bpm;
+  remove("test.db");
+  remove("test.log");
+}
+
+TEST(BPlusTreeTests, IntegerKeyTest) {
+  // single integer columns are searched as integers in internal pages, negative ones included
+  Schema *int_schema = ParseCreateStatement("a integer");
+  Schema *bigint_schema = ParseCreateStatement("a bigint");
+  GenericComparator<4> int_comparator(int_schema);
+  GenericComparator<8> bigint_comparator(bigint_schema);
+  EXPECT_TRUE(int_comparator.IsIntegerKey());
+  EXPECT_TRUE(bigint_comparator.IsIntegerKey());
+  EXPECT_FALSE(GenericComparator<8>(int_schema).IsIntegerKey());
+
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManagerInstance(50, disk_manager);
+  // small leaves, and internal pages as large as they get, so that lookups go through long runs of keys
+  BPlusTree<GenericKey<4>, RID, GenericComparator<4>> int_tree("foo_pk", bpm, int_comparator, 3);
+  BPlusTree<GenericKey<8>, RID, GenericComparator<8>> bigint_tree("bar_pk", bpm, bigint_comparator, 3);
+
+  // create and fetch header_page
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(&page_id);
+  (void)header_page;
+
+  const int64_t num_keys = 2000;
+  std::vector<int64_t> keys;
+  for (int64_t key = -num_keys; key < num_keys; key += 2) {
+    keys.push_back(key);
+  }
+  std::shuffle(keys.begin(), keys.end(), std::mt19937(15445));
+  auto int_key = [&int_schema](int64_t key) {
+    GenericKey<4> index_key;
+    index_key.SetFromKey(Tuple({Value(TypeId::INTEGER, static_cast<int32_t>(key))}, int_schema));
+    return index_key;
+  };
+  GenericKey<8> bigint_key;
+  RID rid;
+  for (int64_t key : keys) {
+    rid.Set(0, static_cast<uint32_t>(key));
+    EXPECT_TRUE(int_tree.Insert(int_key(key), rid));
+    bigint_key.SetFromInteger(key);
+    EXPECT_TRUE(bigint_tree.Insert(bigint_key, rid));
+  }
+
+  for (int64_t key = -num_keys - 1; key < num_keys; key++) {
+    std::vector<RID> rids;
+    EXPECT_EQ(int_tree.GetValue(int_key(key), &rids), key % 2 == 0);
+    bigint_key.SetFromInteger(key);
+    EXPECT_EQ(bigint_tree.GetValue(bigint_key, &rids), key % 2 == 0);
+    for (const auto &found : rids) {
+      EXPECT_EQ(found.GetSlotNum(), static_cast<uint32_t>(key));
+    }
+  }
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete int_schema;
+  delete bigint_schema;
+  delete disk_manager;
+  delete bpm;
+  remove("test.db");
+  remove("test.log");
+}
+
+TEST(BPlusTreeTests, NormalizedKeyIndexTest) {
+  Schema *schema = ParseCreateStatement("a bigint");
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManagerInstance(50, disk_manager);
+
+  // create and fetch header_page
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(&page_id);
+  (void)header_page;
+
+  BPlusTreeIndex<GenericKey<16>, RID, GenericComparator<16>> index(
+      new IndexMetadata("foo_idx", "foo", schema, {0}, true, true), bpm);
+  auto key_tuple = [&schema](int64_t key) { return Tuple({Value(TypeId::BIGINT, key)}, schema); };
+  std::vector<int64_t> keys;
+  for (int64_t key = -1000; key < 1000; key++) {
+    keys.push_back(key * 7919);
+  }
+  std::shuffle(keys.begin(), keys.end(), std::mt19937(15445));
+  for (int64_t key : keys) {
+    index.InsertEntry(key_tuple(key), RID(0, static_cast<uint32_t>(key + 1000 * 7919)), nullptr);
+  }
+
+  for (int64_t key = -1000; key < 1000; key++) {
+    std::vector<RID> rids;
+    index.ScanKey(key_tuple(key * 7919), &rids, nullptr);
+    ASSERT_EQ(rids.size(), 1);
+    EXPECT_EQ(rids[0].GetSlotNum(), static_cast<uint32_t>((key + 1000) * 7919));
+    rids.clear();
+    index.ScanKey(key_tuple(key * 7919 + 1), &rids, nullptr);
+    EXPECT_TRUE(rids.empty());
+  }
+  // a batch of lookups finds what the lookups one by one do, from the leaves of the keys before them
+  std::vector<Tuple> batch;
+  for (int64_t key : keys) {
+    batch.push_back(key_tuple(key));
+    batch.push_back(key_tuple(key + 1));
+  }
+  std::vector<std::vector<RID>> results;
+  index.ScanKeys(batch, &results, nullptr);
+  ASSERT_EQ(results.size(), batch.size());
+  for (size_t i = 0; i < batch.size(); i++) {
+    ASSERT_EQ(results[i].size(), i % 2 == 0 ? 1 : 0);
+    if (i % 2 == 0) {
+      EXPECT_EQ(results[i][0].GetSlotNum(), static_cast<uint32_t>(keys[i / 2] + 1000 * 7919));
+    }
+  }
+  // the memcmp order of the keys is their numeric order, negative keys first
+  uint32_t previous = 0;
+  int64_t size = 0;
+  for (auto iterator = index.GetBeginIterator(); iterator != index.GetEndIterator(); ++iterator) {
+    uint32_t current = (*iterator).second.GetSlotNum();
+    EXPECT_TRUE(size == 0 || previous < current);
+    previous = current;
+    size++;
+  }
+  EXPECT_EQ(size, keys.size());
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete schema;
+  delete disk_manager;
+  delete bpm;
+  remove("test.db");
+  remove("test.log");
+}
+
+TEST(BPlusTreeTests, AppendSplitTest) {
+  // create KeyComparator and index schema
+  Schema *key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema);
+
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManagerInstance(50, disk_manager);
+  // create b+ tree
+  BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator, 20, 20);
+  GenericKey<8> index_key;
+  RID rid;
+
+  // create and fetch header_page
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(&page_id);
+  (void)header_page;
+
+  auto count_leaves = [&]() {
+    int num_leaves = 0;
+    index_key.SetFromInteger(0);
+    Page *page = tree.FindLeafPage(index_key, true);
+    while (page != nullptr) {
+      auto *leaf = reinterpret_cast<BPlusTreeLeafPage<GenericKey<8>, RID, GenericComparator<8>> *>(page->GetData());
+      num_leaves++;
+      page_id_t next_page_id = leaf->GetNextPageId();
+      bpm->UnpinPage(page->GetPageId(), false);
+      page = next_page_id == INVALID_PAGE_ID ? nullptr : bpm->FetchPage(next_page_id);
+    }
+    return num_leaves;
+  };
+
+  // ascending keys leave the leaves they split off 9/10 full, where even splits would leave them half full
+  const int64_t num_keys = 2000;
+  for (int64_t key = 1; key <= num_keys; key++) {
+    rid.Set(0, key);
+    index_key.SetFromInteger(key);
+    EXPECT_TRUE(tree.Insert(index_key, rid));
+  }
+  int num_leaves = count_leaves();
+  EXPECT_LE(num_leaves, num_keys / 18 + 1);
+
+  // duplicates of keys in the right-most leaf are still rejected
+  index_key.SetFromInteger(num_keys);
+  EXPECT_FALSE(tree.Insert(index_key, rid));
+
+  // removing the last keys merges the right-most leaf away, and appends go on into the leaf that took its place
+  for (int64_t key = num_keys; key > num_keys - 100; key--) {
+    index_key.SetFromInteger(key);
+    tree.Remove(index_key);
+  }
+  for (int64_t key = num_keys - 99; key <= 2 * num_keys; key++) {
+    rid.Set(0, key);
+    index_key.SetFromInteger(key);
+    EXPECT_TRUE(tree.Insert(index_key, rid));
+  }
+  int64_t current_key = 1;
+  for (auto iterator = tree.begin(); iterator != tree.end(); ++iterator) {
+    EXPECT_EQ((*iterator).second.GetSlotNum(), current_key);
+    current_key++;
+  }
+  EXPECT_EQ(current_key, 2 * num_keys + 1);
+  EXPECT_LE(count_leaves(), 2 * num_keys / 18 + 2);
+
+  // a tree emptied out starts over with a new right-most leaf
+  for (int64_t key = 1; key <= 2 * num_keys; key++) {
+    index_key.SetFromInteger(key);
+    tree.Remove(index_key);
+  }
+  EXPECT_TRUE(tree.IsEmpty());
+  for (int64_t key = 1; key <= 100; key++) {
+    rid.Set(0, key);
+    index_key.SetFromInteger(key);
+    EXPECT_TRUE(tree.Insert(index_key, rid));
+  }
+  std::vector<RID> rids;
+  index_key.SetFromInteger(100);
+  EXPECT_TRUE(tree.GetValue(index_key, &rids));
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete key_schema;
+  delete disk_manager;
+  delete bpm;
+  remove("test.db");
+  remove("test.log");
+}
 }  // namespace bustub
@@ -10,11 +10,24 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
 #include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
 
 #include "common/exception.h"
 #include "gtest/gtest.h"
 #include "storage/disk/disk_manager.h"
+#include "storage/disk/file_layout.h"
+#include "storage/disk/object_store.h"
 
 namespace bustub {
 
@@ -58,6 +71,576 @@ TEST(DiskManagerTest, ReadWriteLogTest) {
   remove(db_file.c_str());
 }
 
+// NOLINTNEXTLINE
+TEST(DiskManagerTest, LogSegmentTest) {
+  std::string db_file("test.db");
+  remove(db_file.c_str());
+  remove("test.log");
+  const int chunk = 1024 * 1024;
+  const int num_chunks = static_cast<int>(LOG_SEGMENT_SIZE / chunk) + 1;
+  {
+    DiskManager dm(db_file);
+    // the log buffers are swapped on every flush
+    std::vector<char> buffers[2] = {std::vector<char>(chunk), std::vector<char>(chunk)};
+    for (int i = 0; i < num_chunks; i++) {
+      std::memset(buffers[i % 2].data(), 'a' + i, chunk);
+      dm.WriteLog(buffers[i % 2].data(), chunk);
+    }
+    EXPECT_EQ(static_cast<int64_t>(num_chunks) * chunk, dm.GetLogEnd());
+    EXPECT_EQ(0, dm.GetLogStart());
+
+    // a read across the end of the first segment
+    std::vector<char> buf(2 * chunk);
+    ASSERT_TRUE(dm.ReadLog(buf.data(), 2 * chunk, LOG_SEGMENT_SIZE - chunk));
+    EXPECT_EQ('a' + num_chunks - 2, buf[chunk - 1]);
+    EXPECT_EQ('a' + num_chunks - 1, buf[chunk]);
+
+    // once the master record is past it, the first segment is recycled as a spare
+    dm.WriteMasterRecord(LOG_SEGMENT_SIZE + 10);
+    EXPECT_EQ(LOG_SEGMENT_SIZE, dm.GetLogStart());
+    EXPECT_FALSE(std::ifstream("test.log.0").is_open());
+    EXPECT_TRUE(std::ifstream("test.log.2").is_open());
+    EXPECT_FALSE(dm.ReadLog(buf.data(), chunk, 0));
+    dm.ShutDown();
+  }
+  {
+    // the spare is empty, so the log ends where it did
+    DiskManager dm(db_file);
+    EXPECT_EQ(LOG_SEGMENT_SIZE + 10, dm.ReadMasterRecord());
+    EXPECT_EQ(LOG_SEGMENT_SIZE, dm.GetLogStart());
+    EXPECT_EQ(static_cast<int64_t>(num_chunks) * chunk, dm.GetLogEnd());
+    dm.ShutDown();
+  }
+  remove(db_file.c_str());
+  remove("test.log");
+  remove("test.log.1");
+  remove("test.log.2");
+}
+
+// NOLINTNEXTLINE
+TEST(DiskManagerTest, AsyncBatchTest) {
+  for (IoEngineType engine : {IoEngineType::SYNC, IoEngineType::THREAD_POOL, IoEngineType::IO_URING}) {
+    std::string db_file("test.db");
+    remove(db_file.c_str());
+    DiskManager dm(db_file, engine);
+
+    const size_t num_pages = 64;
+    std::vector<std::vector<char>> data(num_pages, std::vector<char>(PAGE_SIZE));
+    std::vector<std::pair<page_id_t, const char *>> writes;
+    for (size_t i = 0; i < num_pages; ++i) {
+      std::memset(data[i].data(), static_cast<int>('a' + i % 26), PAGE_SIZE);
+      writes.emplace_back(static_cast<page_id_t>(i), data[i].data());
+    }
+    EXPECT_TRUE(dm.WritePagesAsync(writes).get());
+    EXPECT_EQ(num_pages, static_cast<size_t>(dm.GetNumWrites()));
+
+    // read back in reverse, plus one page past the end of the file, which reads as zeroes
+    std::vector<std::vector<char>> buf(num_pages + 1, std::vector<char>(PAGE_SIZE, 'x'));
+    std::vector<std::pair<page_id_t, char *>> reads;
+    for (size_t i = 0; i <= num_pages; ++i) {
+      reads.emplace_back(static_cast<page_id_t>(num_pages - i), buf[i].data());
+    }
+    EXPECT_TRUE(dm.ReadPagesAsync(reads).get());
+    EXPECT_TRUE(std::all_of(buf[0].begin(), buf[0].end(), [](char c) { return c == 0; }));
+    for (size_t i = 1; i <= num_pages; ++i) {
+      EXPECT_EQ(0, std::memcmp(buf[i].data(), data[num_pages - i].data(), PAGE_SIZE));
+    }
+
+    // an empty batch completes right away
+    EXPECT_TRUE(dm.ReadPagesAsync({}).get());
+
+    dm.ShutDown();
+    remove(db_file.c_str());
+  }
+}
+
+// NOLINTNEXTLINE
+TEST(DiskManagerTest, DirectIoTest) {
+  for (IoEngineType engine : {IoEngineType::SYNC, IoEngineType::THREAD_POOL, IoEngineType::IO_URING}) {
+    std::string db_file("test.db");
+    remove(db_file.c_str());
+    // falls back to buffered I/O on file systems without O_DIRECT, which must work all the same
+    DiskManager dm(db_file, engine, true);
+
+    // one page as the buffer pool would hand it in, one that is deliberately misaligned
+    std::unique_ptr<char, decltype(&std::free)> aligned(static_cast<char *>(std::aligned_alloc(PAGE_SIZE, PAGE_SIZE)),
+                                                         &std::free);
+    std::vector<char> unaligned_storage(PAGE_SIZE + 1);
+    char *unaligned = unaligned_storage.data() + 1;
+    std::memset(aligned.get(), 'a', PAGE_SIZE);
+    std::memset(unaligned, 'b', PAGE_SIZE);
+    EXPECT_TRUE(dm.WritePagesAsync({{0, aligned.get()}, {3, unaligned}}).get());
+
+    std::memset(aligned.get(), 0, PAGE_SIZE);
+    std::memset(unaligned, 0, PAGE_SIZE);
+    EXPECT_TRUE(dm.ReadPagesAsync({{3, aligned.get()}, {0, unaligned}}).get());
+    EXPECT_TRUE(std::all_of(aligned.get(), aligned.get() + PAGE_SIZE, [](char c) { return c == 'b'; }));
+    EXPECT_TRUE(std::all_of(unaligned, unaligned + PAGE_SIZE, [](char c) { return c == 'a'; }));
+
+    // pages that were never written, inside and past the end of the file, read as zeroes
+    dm.ReadPage(1, unaligned);
+    EXPECT_TRUE(std::all_of(unaligned, unaligned + PAGE_SIZE, [](char c) { return c == 0; }));
+    dm.ReadPage(7, aligned.get());
+    EXPECT_TRUE(std::all_of(aligned.get(), aligned.get() + PAGE_SIZE, [](char c) { return c == 0; }));
+
+    dm.ShutDown();
+    remove(db_file.c_str());
+  }
+}
+
+// NOLINTNEXTLINE
+TEST(DiskManagerTest, FreePageReuseTest) {
+  std::string db_file("test.db");
+  remove(db_file.c_str());
+  {
+    DiskManager dm(db_file);
+    for (page_id_t i = 0; i < 10; ++i) {
+      EXPECT_EQ(i, dm.AllocatePage());
+    }
+    dm.DeallocatePage(7);
+    dm.DeallocatePage(3);
+    dm.DeallocatePage(3);   // freeing twice does not hand the page out twice
+    dm.DeallocatePage(42);  // never allocated
+    EXPECT_EQ(2, dm.GetNumFreePages());
+
+    // the lowest free page comes first, then fresh ones
+    EXPECT_EQ(3, dm.AllocatePage());
+    EXPECT_EQ(7, dm.AllocatePage());
+    EXPECT_EQ(10, dm.AllocatePage());
+    EXPECT_EQ(0, dm.GetNumFreePages());
+
+    char data[PAGE_SIZE] = {0};
+    std::strncpy(data, "last page", sizeof(data));
+    dm.WritePage(10, data);
+    dm.DeallocatePage(5);
+    dm.ShutDown();
+  }
+
+  // a reopened file knows its pages and which of them are free
+  DiskManager dm(db_file);
+  EXPECT_EQ(1, dm.GetNumFreePages());
+  EXPECT_EQ(5, dm.AllocatePage());
+  EXPECT_EQ(11, dm.AllocatePage());
+  char buf[PAGE_SIZE] = {0};
+  dm.ReadPage(10, buf);
+  EXPECT_STREQ("last page", buf);
+  dm.ShutDown();
+  remove(db_file.c_str());
+}
+
+// NOLINTNEXTLINE
+TEST(DiskManagerTest, FreeSpaceMapLayoutTest) {
+  const auto run = static_cast<page_id_t>(FileLayout::PAGES_PER_RUN);
+  const auto header = static_cast<off_t>(FileLayout::HEADER_PAGES_PER_RUN) * PAGE_SIZE;
+  // every run of pages starts after its map page and its checksum pages
+  EXPECT_EQ(FileLayout::MapPageOffset(0), 0);
+  EXPECT_EQ(FileLayout::ChecksumPageOffset(0), PAGE_SIZE);
+  EXPECT_EQ(FileLayout::PageOffset(0), header);
+  EXPECT_EQ(FileLayout::PageOffset(run - 1) + PAGE_SIZE, FileLayout::MapPageOffset(1));
+  EXPECT_EQ(FileLayout::MapPageOffset(1) + PAGE_SIZE,
+            FileLayout::ChecksumPageOffset(FileLayout::CHECKSUM_PAGES_PER_RUN));
+  EXPECT_EQ(FileLayout::MapPageOffset(1) + header, FileLayout::PageOffset(run));
+
+  EXPECT_EQ(0, FileLayout::NumPagesInFile(0));
+  EXPECT_EQ(0, FileLayout::NumPagesInFile(header));
+  EXPECT_EQ(3, FileLayout::NumPagesInFile(FileLayout::PageOffset(2) + PAGE_SIZE));
+  EXPECT_EQ(run, FileLayout::NumPagesInFile(FileLayout::MapPageOffset(1) + PAGE_SIZE));
+  EXPECT_EQ(run + 1, FileLayout::NumPagesInFile(FileLayout::PageOffset(run) + PAGE_SIZE));
+
+  // a map that covers several map pages
+  FreeSpaceMap map(run + 10);
+  EXPECT_TRUE(map.Deallocate(run + 5));
+  EXPECT_TRUE(map.Deallocate(1));
+  EXPECT_FALSE(map.Deallocate(run + 10));
+  EXPECT_TRUE(map.IsDirty());
+  std::vector<size_t> map_pages;
+  std::vector<char> data;
+  uint64_t version = map.CollectDirty(&map_pages, &data);
+  map.MarkFlushed(version);
+  EXPECT_FALSE(map.IsDirty());
+  EXPECT_EQ((std::vector<size_t>{0, 1}), map_pages);
+
+  // loading the written map pages gives back the same free pages
+  FreeSpaceMap loaded(run + 10);
+  EXPECT_EQ(2, loaded.NumMapPages());
+  loaded.LoadMapPage(0, &data[0]);
+  loaded.LoadMapPage(1, &data[PAGE_SIZE]);
+  EXPECT_EQ(2, loaded.NumFree());
+  EXPECT_EQ(1, loaded.Allocate());
+  EXPECT_EQ(run + 5, loaded.Allocate());
+  EXPECT_EQ(run + 10, loaded.Allocate());
+}
+
+// NOLINTNEXTLINE
+TEST(DiskManagerTest, ChecksumTest) {
+  std::string db_file("test.db");
+  remove(db_file.c_str());
+  char data[PAGE_SIZE] = {0};
+  char buf[PAGE_SIZE] = {0};
+  std::strncpy(data, "A test string.", sizeof(data));
+  {
+    DiskManager dm(db_file);
+    dm.WritePage(0, data);
+    dm.WritePage(1, data);
+    dm.ReadPage(0, buf);
+    EXPECT_EQ(0, dm.GetNumChecksumFailures());
+    // never written, so there is nothing to check against
+    dm.ReadPage(2, buf);
+    EXPECT_EQ(0, dm.GetNumChecksumFailures());
+    dm.ShutDown();
+  }
+
+  // flip a byte of page 1 behind the disk manager's back
+  std::fstream file(db_file, std::ios::binary | std::ios::in | std::ios::out);
+  file.seekp(FileLayout::PageOffset(1) + 100);
+  file.put('X');
+  file.close();
+
+  // the checksums survive reopening the file
+  DiskManager dm(db_file);
+  dm.ReadPage(0, buf);
+  EXPECT_EQ(0, std::memcmp(buf, data, sizeof(buf)));
+  EXPECT_EQ(0, dm.GetNumChecksumFailures());
+  char other[PAGE_SIZE] = {0};
+  EXPECT_FALSE(dm.ReadPagesAsync({{0, buf}, {1, other}}).get());
+  EXPECT_EQ(1, dm.GetNumChecksumFailures());
+
+  // rewriting the page makes it good again
+  dm.WritePage(1, data);
+  EXPECT_TRUE(dm.ReadPagesAsync({{1, buf}}).get());
+  EXPECT_EQ(1, dm.GetNumChecksumFailures());
+  dm.ShutDown();
+  remove(db_file.c_str());
+}
+
+// NOLINTNEXTLINE
+TEST(DiskManagerTest, CompressionTest) {
+  for (IoEngineType engine : {IoEngineType::SYNC, IoEngineType::THREAD_POOL, IoEngineType::IO_URING}) {
+    std::string db_file("test.db");
+    remove(db_file.c_str());
+    std::vector<char> cold(PAGE_SIZE, 0);
+    std::strncpy(cold.data(), "A mostly empty page.", PAGE_SIZE);
+    std::mt19937 generator(15445);
+    std::vector<char> noise(PAGE_SIZE);
+    for (char &c : noise) {
+      c = static_cast<char>(generator());
+    }
+    {
+      DiskManager dm(db_file, engine, false, true);
+      EXPECT_TRUE(dm.WritePagesAsync({{0, cold.data()}, {1, noise.data()}, {2, cold.data()}}).get());
+      // the cold pages take up a sector each, the noise its whole page
+      EXPECT_EQ(PAGE_SIZE + 2 * FileLayout::SECTOR_SIZE, dm.GetNumBytesWritten());
+
+      std::vector<char> buf(3 * PAGE_SIZE, 'x');
+      EXPECT_TRUE(dm.ReadPagesAsync({{0, &buf[0]}, {1, &buf[PAGE_SIZE]}, {2, &buf[2 * PAGE_SIZE]}}).get());
+      EXPECT_EQ(0, std::memcmp(&buf[0], cold.data(), PAGE_SIZE));
+      EXPECT_EQ(0, std::memcmp(&buf[PAGE_SIZE], noise.data(), PAGE_SIZE));
+      EXPECT_EQ(0, std::memcmp(&buf[2 * PAGE_SIZE], cold.data(), PAGE_SIZE));
+
+      // a page that stops compressing is stored as it is again
+      dm.WritePage(0, noise.data());
+      dm.ReadPage(0, &buf[0]);
+      EXPECT_EQ(0, std::memcmp(&buf[0], noise.data(), PAGE_SIZE));
+      dm.ShutDown();
+    }
+
+    // which pages are compressed survives reopening, with or without compression enabled
+    DiskManager dm(db_file, engine);
+    std::vector<char> buf(PAGE_SIZE);
+    dm.ReadPage(2, buf.data());
+    EXPECT_EQ(0, std::memcmp(buf.data(), cold.data(), PAGE_SIZE));
+    dm.ReadPage(0, buf.data());
+    EXPECT_EQ(0, std::memcmp(buf.data(), noise.data(), PAGE_SIZE));
+    EXPECT_EQ(0, dm.GetNumChecksumFailures());
+    dm.ShutDown();
+    remove(db_file.c_str());
+  }
+}
+
+TEST(DiskManagerTest, ExtentTest) {
+  for (IoEngineType engine : {IoEngineType::SYNC, IoEngineType::THREAD_POOL, IoEngineType::IO_URING}) {
+    std::string db_file("test.db");
+    remove(db_file.c_str());
+    DiskManager dm(db_file, engine);
+    for (page_id_t i = 0; i < 3; ++i) {
+      EXPECT_EQ(i, dm.AllocatePage());
+    }
+    // extents are aligned to their size, and the pages skipped are handed out later
+    const size_t extent_size = 64;
+    EXPECT_EQ(64, dm.AllocateExtent(extent_size));
+    EXPECT_EQ(61, dm.GetNumFreePages());
+    EXPECT_EQ(3, dm.AllocatePage());
+    EXPECT_EQ(128, dm.AllocateExtent(extent_size));
+
+    std::vector<char> data(extent_size * PAGE_SIZE);
+    std::vector<std::pair<page_id_t, const char *>> writes;
+    for (size_t i = 0; i < extent_size; ++i) {
+      std::snprintf(&data[i * PAGE_SIZE], PAGE_SIZE, "extent page %zu", i);
+      // written out of order, which must not matter
+      size_t page = (i * 7) % extent_size;
+      writes.emplace_back(64 + page, &data[page * PAGE_SIZE]);
+    }
+    EXPECT_TRUE(dm.WritePagesAsync(writes).get());
+
+    std::vector<char> buf(extent_size * PAGE_SIZE);
+    std::vector<char *> buffers;
+    for (size_t i = 0; i < extent_size; ++i) {
+      buffers.push_back(&buf[i * PAGE_SIZE]);
+    }
+    EXPECT_TRUE(dm.ReadPages(64, extent_size, buffers.data()));
+    EXPECT_EQ(0, std::memcmp(buf.data(), data.data(), buf.size()));
+
+    // a read that runs into the end of the file zero-fills the rest
+    std::fill(buf.begin(), buf.end(), 'x');
+    EXPECT_TRUE(dm.ReadPages(96, extent_size, buffers.data()));
+    EXPECT_EQ(0, std::memcmp(buf.data(), &data[32 * PAGE_SIZE], 32 * PAGE_SIZE));
+    EXPECT_TRUE(std::all_of(buf.begin() + 32 * PAGE_SIZE, buf.end(), [](char c) { return c == 0; }));
+    EXPECT_EQ(0, dm.GetNumChecksumFailures());
+    dm.ShutDown();
+    remove(db_file.c_str());
+  }
+}
+
+TEST(DiskManagerTest, TablespaceTest) {
+  std::string db_file("test.db");
+  std::string index_file("test_index.db");
+  remove(db_file.c_str());
+  remove(index_file.c_str());
+  char heap_data[PAGE_SIZE] = {0};
+  char index_data[PAGE_SIZE] = {0};
+  std::strncpy(heap_data, "heap page", sizeof(heap_data));
+  std::strncpy(index_data, "index page", sizeof(index_data));
+  page_id_t index_page;
+  {
+    DiskManager dm(db_file);
+    EXPECT_FALSE(dm.AddTablespace(DiskManager::DEFAULT_TABLESPACE, index_file));
+    EXPECT_FALSE(dm.AddTablespace(DiskManager::MAX_TABLESPACES, index_file));
+    EXPECT_TRUE(dm.AddTablespace(1, index_file, IoEngineType::THREAD_POOL));
+    EXPECT_FALSE(dm.AddTablespace(1, index_file));
+    EXPECT_TRUE(dm.HasTablespace(1));
+    EXPECT_FALSE(dm.HasTablespace(2));
+    EXPECT_THROW(dm.AllocatePage(2), Exception);
+
+    // page ids of the default tablespace are what they always were
+    EXPECT_EQ(0, dm.AllocatePage());
+    index_page = dm.AllocatePage(1);
+    EXPECT_EQ(DiskManager::MakePageId(1, 0), index_page);
+    EXPECT_EQ(1, DiskManager::GetTablespaceId(index_page));
+    EXPECT_EQ(0, DiskManager::GetLocalPageId(index_page));
+    EXPECT_EQ(1, dm.GetNumPages());
+    EXPECT_EQ(1, dm.GetNumPages(1));
+
+    // one batch for both files
+    EXPECT_TRUE(dm.WritePagesAsync({{0, heap_data}, {index_page, index_data}}).get());
+    char buf[2 * PAGE_SIZE] = {0};
+    EXPECT_TRUE(dm.ReadPagesAsync({{index_page, buf}, {0, buf + PAGE_SIZE}}).get());
+    EXPECT_STREQ("index page", buf);
+    EXPECT_STREQ("heap page", buf + PAGE_SIZE);
+    EXPECT_THROW(dm.ReadPage(DiskManager::MakePageId(2, 0), buf), Exception);
+
+    dm.DeallocatePage(index_page);
+    EXPECT_EQ(1, dm.GetNumFreePages());
+    EXPECT_EQ(index_page, dm.AllocatePage(1));
+    dm.ShutDown();
+  }
+
+  // each page went to the file of its tablespace
+  std::ifstream index_stream(index_file, std::ios::binary);
+  std::vector<char> contents((std::istreambuf_iterator<char>(index_stream)), std::istreambuf_iterator<char>());
+  EXPECT_EQ(static_cast<size_t>(FileLayout::PageOffset(0) + PAGE_SIZE), contents.size());
+  EXPECT_STREQ("index page", &contents[FileLayout::PageOffset(0)]);
+
+  DiskManager dm(db_file);
+  EXPECT_TRUE(dm.AddTablespace(1, index_file));
+  EXPECT_EQ(1, dm.GetNumPages(1));
+  char buf[PAGE_SIZE] = {0};
+  dm.ReadPage(index_page, buf);
+  EXPECT_STREQ("index page", buf);
+  EXPECT_EQ(0, dm.GetNumChecksumFailures());
+  dm.ShutDown();
+  remove(db_file.c_str());
+  remove(index_file.c_str());
+}
+
+// NOLINTNEXTLINE
+TEST(DiskManagerTest, IoStatsTest) {
+  std::string db_file("test.db");
+  remove(db_file.c_str());
+  remove("test.log");
+  DiskManager dm(db_file);
+  char data[PAGE_SIZE] = {0};
+  char buf[PAGE_SIZE];
+  dm.WritePage(0, data);
+  dm.WritePage(1, data);
+  dm.ReadPage(1, buf);
+  char log[100] = {0};
+  dm.WriteLog(log, sizeof(log));
+
+  EXPECT_EQ(2, dm.GetNumWrites());
+  EXPECT_EQ(2 * PAGE_SIZE, dm.GetNumBytesWritten());
+  EXPECT_EQ(1, dm.GetNumReads());
+  EXPECT_EQ(PAGE_SIZE, dm.GetNumBytesRead());
+  EXPECT_EQ(1, dm.GetNumFlushes());
+  EXPECT_EQ(sizeof(log), dm.GetNumLogBytesWritten());
+  EXPECT_EQ(2, dm.GetWriteLatency().count_);
+  EXPECT_EQ(1, dm.GetReadLatency().count_);
+
+  dm.ShutDown();
+  remove(db_file.c_str());
+}
+
+// NOLINTNEXTLINE
+TEST(DiskManagerTest, PageTraceTest) {
+  std::string db_file("test.db");
+  std::string trace_file("test.trace");
+  remove(db_file.c_str());
+  DiskManager dm(db_file);
+  char data[PAGE_SIZE] = {0};
+  dm.WritePage(0, data);  // before the trace, so not in it
+
+  ASSERT_TRUE(dm.StartPageTrace(trace_file));
+  EXPECT_FALSE(dm.StartPageTrace(trace_file));
+  dm.WritePage(3, data);
+  dm.TracePageAccess(3, PageAccessType::FETCH);
+  dm.ReadPage(3, data);
+  dm.StopPageTrace();
+  dm.ReadPage(0, data);  // after the trace
+
+  std::vector<PageAccess> accesses;
+  ASSERT_TRUE(PageTrace::Load(trace_file, &accesses));
+  ASSERT_EQ(3, accesses.size());
+  EXPECT_EQ(PageAccessType::WRITE, accesses[0].type_);
+  EXPECT_EQ(PageAccessType::FETCH, accesses[1].type_);
+  EXPECT_EQ(PageAccessType::READ, accesses[2].type_);
+  for (size_t i = 0; i < accesses.size(); ++i) {
+    EXPECT_EQ(3, accesses[i].page_id_);
+    EXPECT_LE(i == 0 ? 0 : accesses[i - 1].timestamp_ns_, accesses[i].timestamp_ns_);
+  }
+
+  // a trace longer than its buffer is written out as it goes, and a new one replaces the file
+  ASSERT_TRUE(dm.StartPageTrace(trace_file));
+  for (page_id_t page_id = 0; page_id < static_cast<page_id_t>(2 * PageTrace::BUFFER_RECORDS) + 1; ++page_id) {
+    dm.TracePageAccess(page_id, PageAccessType::FETCH);
+  }
+  dm.ShutDown();
+  ASSERT_TRUE(PageTrace::Load(trace_file, &accesses));
+  ASSERT_EQ(2 * PageTrace::BUFFER_RECORDS + 1, accesses.size());
+  EXPECT_EQ(static_cast<page_id_t>(2 * PageTrace::BUFFER_RECORDS), accesses.back().page_id_);
+
+  EXPECT_FALSE(PageTrace::Load(db_file, &accesses));
+  remove(db_file.c_str());
+  remove(trace_file.c_str());
+}
+
+// NOLINTNEXTLINE
+TEST(DiskManagerTest, TieringTest) {
+  std::string db_file("tier_test.db");
+  std::string objects("tier_test_objects");
+  std::string cache_file("tier_test.cache");
+  remove(db_file.c_str());
+  std::filesystem::remove_all(objects);
+  std::filesystem::create_directory(objects);
+  const auto extent = static_cast<page_id_t>(TieredStorage::EXTENT_PAGES);
+  // compressible pages, so that the images moved out are compressed ones
+  auto fill = [](page_id_t page_id, char *data) {
+    memset(data, 0, PAGE_SIZE);
+    snprintf(data, PAGE_SIZE, "page %d", page_id);
+  };
+  char data[PAGE_SIZE];
+  char buf[PAGE_SIZE];
+  DirectoryObjectStore store(objects);
+  {
+    DiskManager dm(db_file, IoEngineType::SYNC, false, true);
+    ASSERT_TRUE(dm.EnableTiering(DiskManager::DEFAULT_TABLESPACE, &store, cache_file, 1));
+    EXPECT_FALSE(dm.EnableTiering(DiskManager::DEFAULT_TABLESPACE, &store, cache_file, 1));
+    for (page_id_t i = 0; i < 3 * extent - 1; ++i) {
+      ASSERT_EQ(i, dm.AllocatePage());
+      fill(i, data);
+      dm.WritePage(i, data);
+    }
+
+    // only whole extents move out, once
+    EXPECT_TRUE(dm.OffloadExtent(extent + 5));
+    EXPECT_FALSE(dm.OffloadExtent(extent));
+    EXPECT_FALSE(dm.OffloadExtent(2 * extent));
+    EXPECT_TRUE(dm.OffloadExtent(0));
+    EXPECT_TRUE(dm.IsOffloaded(0));
+    EXPECT_TRUE(dm.IsOffloaded(2 * extent - 1));
+    EXPECT_FALSE(dm.IsOffloaded(2 * extent));
+    EXPECT_EQ(2, store.GetNumPuts());
+
+    // reads of the pages out go to the store, then to the cache, which holds one extent
+    for (page_id_t i : {extent + 3, extent + 4, page_id_t{1}, extent + 5, 2 * extent + 1}) {
+      dm.ReadPage(i, buf);
+      fill(i, data);
+      EXPECT_EQ(0, memcmp(data, buf, PAGE_SIZE)) << "page " << i;
+    }
+    EXPECT_EQ(3, store.GetNumGets());
+    EXPECT_EQ(0, dm.GetNumChecksumFailures());
+
+    // a write brings the extent back into the file, and the object goes
+    fill(extent + 7, data);
+    data[PAGE_SIZE - 1] = 'x';
+    dm.WritePage(extent + 7, data);
+    EXPECT_FALSE(dm.IsOffloaded(extent));
+    EXPECT_FALSE(std::filesystem::exists(objects + "/" + db_file + ".extent.1"));
+    dm.ReadPage(extent + 7, buf);
+    EXPECT_EQ(0, memcmp(data, buf, PAGE_SIZE));
+    dm.ReadPage(extent + 8, buf);
+    fill(extent + 8, data);
+    EXPECT_EQ(0, memcmp(data, buf, PAGE_SIZE));
+    dm.ShutDown();
+  }
+  {
+    // the tier pages say which extents are out when the file is opened again
+    DiskManager dm(db_file, IoEngineType::SYNC, false, true);
+    EXPECT_TRUE(dm.IsOffloaded(3));
+    EXPECT_FALSE(dm.ReadPages({{3, buf}}));
+    ASSERT_TRUE(dm.EnableTiering(DiskManager::DEFAULT_TABLESPACE, &store, cache_file, 1));
+    ASSERT_TRUE(dm.ReadPages({{3, buf}}));
+    fill(3, data);
+    EXPECT_EQ(0, memcmp(data, buf, PAGE_SIZE));
+    EXPECT_FALSE(dm.IsOffloaded(extent));
+    dm.ShutDown();
+  }
+  remove(db_file.c_str());
+  remove("tier_test.log");
+  std::filesystem::remove_all(objects);
+}
+
+// NOLINTNEXTLINE
+TEST(DiskManagerTest, LargeOffsetTest) {
+  // the first page past 2GB, whose offset does not fit an int, in a sparse file
+  const page_id_t page_id = static_cast<page_id_t>((int64_t{1} << 31) / PAGE_SIZE) + 1;
+  ASSERT_GT(FileLayout::PageOffset(page_id), int64_t{1} << 31);
+  std::string db_file("large_offset_test.db");
+  char buf[PAGE_SIZE] = {0};
+  char data[PAGE_SIZE] = {0};
+  std::strncpy(data, "A page past 2GB.", sizeof(data));
+  data[PAGE_SIZE - 1] = 'x';
+  {
+    DiskManager dm(db_file);
+    dm.WritePage(page_id, data);
+    dm.ReadPage(page_id, buf);
+    EXPECT_EQ(0, std::memcmp(buf, data, PAGE_SIZE));
+    dm.ShutDown();
+  }
+  EXPECT_GT(std::filesystem::file_size(db_file), uint64_t{1} << 31);
+  {
+    // read again from the file rather than from the page cache of the OS, and the page before is zeroes
+    DiskManager dm(db_file);
+    std::memset(buf, 0, sizeof(buf));
+    dm.ReadPage(page_id, buf);
+    EXPECT_EQ(0, std::memcmp(buf, data, PAGE_SIZE));
+    char zeroes[PAGE_SIZE] = {0};
+    dm.ReadPage(page_id - 1, buf);
+    EXPECT_EQ(0, std::memcmp(buf, zeroes, PAGE_SIZE));
+    dm.ShutDown();
+  }
+  remove(db_file.c_str());
+  remove("large_offset_test.log");
+}
+
 TEST(DiskManagerTest, ThrowBadFileTest) { EXPECT_THROW(DiskManager("dev/null\\/foo/bar/baz/test.db"), Exception); }
 
 }  // namespace bustub
@@ -0,0 +1,208 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// generic_key_test.cpp
+//
+// Identification: test/storage/generic_key_test.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <random>
+#include <string>
+#include <vector>
+
+#include "b_plus_tree_test_util.h"  // NOLINT
+#include "gtest/gtest.h"
+#include "storage/index/generic_key.h"
+#include "type/value_factory.h"
+
+namespace bustub {
+
+// NOLINTNEXTLINE
+TEST(GenericKeyTest, ComparatorTest) {
+  // the comparator works on the bytes of the keys, and has to agree with comparing the Values they hold
+  Schema *key_schema = ParseCreateStatement("a smallint,b integer,c bigint,d double,e boolean,f tinyint,g varchar(8)");
+  GenericComparator<64> comparator(key_schema);
+  EXPECT_FALSE(comparator.IsIntegerKey());
+
+  // few distinct values per column, so that most pairs of keys tie on the first columns; NULLs compare equal (but a
+  // Tuple cannot hold a NULL VARCHAR)
+  std::mt19937 gen(15445);
+  std::uniform_int_distribution<int> dist(-2, 2);
+  auto value_of = [&](TypeId type) {
+    int v = dist(gen);
+    if (v == -2 && type != TypeId::VARCHAR) {
+      return ValueFactory::GetNullValueByType(type);
+    }
+    switch (type) {
+      case TypeId::SMALLINT:
+        return Value(type, static_cast<int16_t>(v));
+      case TypeId::INTEGER:
+        return Value(type, static_cast<int32_t>(v));
+      case TypeId::BIGINT:
+        return Value(type, static_cast<int64_t>(v));
+      case TypeId::DECIMAL:
+        return Value(type, v / 2.0);
+      case TypeId::BOOLEAN:
+      case TypeId::TINYINT:
+        return Value(type, static_cast<int8_t>(type == TypeId::BOOLEAN ? v > 0 : v));
+      default:
+        return Value(type, std::string(v + 3, 'x'));
+    }
+  };
+  std::vector<GenericKey<64>> keys(200);
+  for (auto &key : keys) {
+    std::vector<Value> values;
+    for (uint32_t i = 0; i < key_schema->GetColumnCount(); i++) {
+      values.push_back(value_of(key_schema->GetColumn(i).GetType()));
+    }
+    key.SetFromKey(Tuple(values, key_schema));
+  }
+
+  for (const auto &lhs : keys) {
+    for (const auto &rhs : keys) {
+      int expected = 0;
+      for (uint32_t i = 0; i < key_schema->GetColumnCount() && expected == 0; i++) {
+        Value lhs_value = lhs.ToValue(key_schema, i);
+        Value rhs_value = rhs.ToValue(key_schema, i);
+        if (lhs_value.CompareLessThan(rhs_value) == CmpBool::CmpTrue) {
+          expected = -1;
+        } else if (lhs_value.CompareGreaterThan(rhs_value) == CmpBool::CmpTrue) {
+          expected = 1;
+        }
+      }
+      ASSERT_EQ(comparator(lhs, rhs), expected);
+    }
+  }
+
+  delete key_schema;
+}
+
+// NOLINTNEXTLINE
+TEST(GenericKeyTest, NormalizedKeyTest) {
+  // normalized keys compare under memcmp like their values, with NULLs first
+  Schema *key_schema = ParseCreateStatement("a bigint,b varchar(8),c double,d smallint,e tinyint");
+  GenericComparator<64> comparator(key_schema, false, true);
+
+  std::mt19937 gen(15445);
+  std::uniform_int_distribution<int> dist(-3, 3);
+  const std::vector<std::string> strings = {"", std::string("\0", 1), std::string("\0\0", 2), "a",
+                                            std::string("a\0", 2), "ab", "b"};
+  std::vector<Tuple> tuples;
+  for (int n = 0; n < 200; n++) {
+    std::vector<Value> values;
+    for (uint32_t i = 0; i < key_schema->GetColumnCount(); i++) {
+      TypeId type = key_schema->GetColumn(i).GetType();
+      int v = dist(gen);
+      if (v == -3 && type != TypeId::VARCHAR) {
+        values.push_back(ValueFactory::GetNullValueByType(type));
+      } else if (type == TypeId::BIGINT) {
+        values.emplace_back(type, static_cast<int64_t>(v) * 1000000007);
+      } else if (type == TypeId::VARCHAR) {
+        values.emplace_back(type, strings[v + 3]);
+      } else if (type == TypeId::DECIMAL) {
+        values.emplace_back(type, v / 4.0);
+      } else if (type == TypeId::SMALLINT) {
+        values.emplace_back(type, static_cast<int16_t>(v * 1000));
+      } else {
+        values.emplace_back(type, static_cast<int8_t>(v));
+      }
+    }
+    tuples.emplace_back(values, key_schema);
+  }
+  std::vector<GenericKey<64>> keys(tuples.size());
+  for (size_t i = 0; i < tuples.size(); i++) {
+    keys[i].SetFromKeyNormalized(tuples[i], key_schema);
+  }
+
+  for (size_t l = 0; l < tuples.size(); l++) {
+    for (size_t r = 0; r < tuples.size(); r++) {
+      int expected = 0;
+      for (uint32_t i = 0; i < key_schema->GetColumnCount() && expected == 0; i++) {
+        Value lhs_value = tuples[l].GetValue(key_schema, i);
+        Value rhs_value = tuples[r].GetValue(key_schema, i);
+        if (lhs_value.IsNull() || rhs_value.IsNull()) {
+          expected = static_cast<int>(rhs_value.IsNull()) - static_cast<int>(lhs_value.IsNull());
+        } else if (lhs_value.CompareLessThan(rhs_value) == CmpBool::CmpTrue) {
+          expected = -1;
+        } else if (lhs_value.CompareGreaterThan(rhs_value) == CmpBool::CmpTrue) {
+          expected = 1;
+        }
+      }
+      ASSERT_EQ(comparator(keys[l], keys[r]), expected);
+    }
+  }
+
+  // -0.0 equals 0.0, and so does its key
+  Schema *decimal_schema = ParseCreateStatement("a double");
+  GenericKey<16> zero_key;
+  GenericKey<16> negative_zero_key;
+  zero_key.SetFromKeyNormalized(Tuple({Value(TypeId::DECIMAL, 0.0)}, decimal_schema), decimal_schema);
+  negative_zero_key.SetFromKeyNormalized(Tuple({Value(TypeId::DECIMAL, -0.0)}, decimal_schema), decimal_schema);
+  EXPECT_EQ(0, GenericComparator<16>(decimal_schema, false, true)(zero_key, negative_zero_key));
+  delete decimal_schema;
+
+  // a key that needs more room than there is
+  GenericKey<8> small_key;
+  EXPECT_THROW(small_key.SetFromKeyNormalized(tuples[0], key_schema), Exception);
+
+  delete key_schema;
+}
+
+// NOLINTNEXTLINE
+TEST(GenericKeyTest, PrefixTest) {
+  // a prefix orders as the keys do wherever two of them differ, and packs the leading integer columns that fit
+  Schema *key_schema = ParseCreateStatement("a smallint,b integer,c bigint");
+  GenericComparator<32> comparator(key_schema);
+  GenericComparator<32> normalized(key_schema, false, true);
+  std::mt19937 gen(15445);
+  std::uniform_int_distribution<int> dist(-3, 3);
+  std::vector<GenericKey<32>> keys(100);
+  std::vector<GenericKey<32>> normalized_keys(keys.size());
+  for (size_t i = 0; i < keys.size(); i++) {
+    std::vector<Value> values{Value(TypeId::SMALLINT, static_cast<int16_t>(dist(gen) * 1000)),
+                              Value(TypeId::INTEGER, dist(gen) * 100000), Value(TypeId::BIGINT, int64_t{dist(gen)})};
+    Tuple tuple(values, key_schema);
+    keys[i].SetFromKey(tuple);
+    normalized_keys[i].SetFromKeyNormalized(tuple, key_schema);
+  }
+  for (const auto &[cmp, prefix_keys] :
+       {std::make_pair(&comparator, &keys), std::make_pair(&normalized, &normalized_keys)}) {
+    for (const auto &lhs : *prefix_keys) {
+      for (const auto &rhs : *prefix_keys) {
+        uint64_t lhs_prefix;
+        uint64_t rhs_prefix;
+        ASSERT_TRUE(cmp->Prefix(lhs, &lhs_prefix));
+        ASSERT_TRUE(cmp->Prefix(rhs, &rhs_prefix));
+        if (lhs_prefix != rhs_prefix) {
+          ASSERT_EQ(lhs_prefix < rhs_prefix ? -1 : 1, (*cmp)(lhs, rhs));
+        } else {
+          // the first two columns are all that a prefix of these keys holds, either way
+          ASSERT_EQ(lhs.ToValue(key_schema, 1).GetAs<int32_t>(), rhs.ToValue(key_schema, 1).GetAs<int32_t>());
+        }
+      }
+    }
+  }
+
+  // a NULL compares equal to anything, so a key with one has no prefix
+  GenericKey<32> null_key;
+  null_key.SetFromKey(Tuple({ValueFactory::GetNullValueByType(TypeId::SMALLINT), Value(TypeId::INTEGER, 1),
+                             Value(TypeId::BIGINT, int64_t{1})},
+                            key_schema));
+  uint64_t prefix;
+  EXPECT_FALSE(comparator.Prefix(null_key, &prefix));
+  delete key_schema;
+
+  // nor does one that starts with a VARCHAR, unless it is normalized
+  key_schema = ParseCreateStatement("a varchar(8)");
+  GenericComparator<32> varchar_comparator(key_schema);
+  GenericKey<32> varchar_key;
+  varchar_key.SetFromKey(Tuple({Value(TypeId::VARCHAR, "abc")}, key_schema));
+  EXPECT_FALSE(varchar_comparator.Prefix(varchar_key, &prefix));
+  delete key_schema;
+}
+
+}  // namespace bustub
@@ -0,0 +1,88 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// page_compressor_test.cpp
+//
+// Identification: test/storage/page_compressor_test.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <cstring>
+#include <random>
+#include <vector>
+
+#include "common/config.h"
+#include "gtest/gtest.h"
+#include "storage/disk/page_compressor.h"
+
+namespace bustub {
+
+// NOLINTNEXTLINE
+TEST(PageCompressorTest, RoundTripTest) {
+  std::mt19937 generator(15445);
+  std::vector<std::vector<char>> inputs;
+  // empty space, as in a fresh page
+  inputs.emplace_back(PAGE_SIZE, 0);
+  // repeated records with a few varying bytes, as in a table page
+  std::vector<char> records(PAGE_SIZE, 0);
+  for (size_t i = 0; i + 32 <= PAGE_SIZE / 2; i += 32) {
+    std::memcpy(&records[i], "record-of-some-table-xxxxxxxxxx", 31);
+    records[i + 28] = static_cast<char>(i / 32);
+  }
+  inputs.push_back(records);
+  // noise, which does not compress
+  std::vector<char> noise(PAGE_SIZE);
+  for (char &c : noise) {
+    c = static_cast<char>(generator());
+  }
+  inputs.push_back(noise);
+  // tiny inputs
+  inputs.emplace_back();
+  inputs.emplace_back(std::vector<char>{'a', 'b', 'c'});
+
+  for (const auto &input : inputs) {
+    std::vector<char> compressed(input.size() + input.size() / 8 + 16);
+    size_t size = PageCompressor::Compress(input.data(), input.size(), compressed.data(), compressed.size());
+    ASSERT_NE(0, size);
+    std::vector<char> output(input.size());
+    EXPECT_TRUE(PageCompressor::Decompress(compressed.data(), size, output.data(), output.size()));
+    EXPECT_EQ(input, output);
+  }
+
+  // compressible content shrinks a lot, noise does not fit in less than its size
+  std::vector<char> compressed(PAGE_SIZE);
+  EXPECT_LT(PageCompressor::Compress(inputs[0].data(), PAGE_SIZE, compressed.data(), compressed.size()),
+            PAGE_SIZE / 64);
+  EXPECT_LT(PageCompressor::Compress(records.data(), PAGE_SIZE, compressed.data(), compressed.size()), PAGE_SIZE / 4);
+  EXPECT_EQ(0, PageCompressor::Compress(noise.data(), PAGE_SIZE, compressed.data(), PAGE_SIZE - 1));
+}
+
+// NOLINTNEXTLINE
+TEST(PageCompressorTest, CorruptInputTest) {
+  std::vector<char> input(PAGE_SIZE, 'x');
+  std::vector<char> compressed(PAGE_SIZE);
+  size_t size = PageCompressor::Compress(input.data(), input.size(), compressed.data(), compressed.size());
+  ASSERT_NE(0, size);
+  std::vector<char> output(PAGE_SIZE);
+
+  // truncated, or expanding to the wrong size
+  EXPECT_FALSE(PageCompressor::Decompress(compressed.data(), size - 1, output.data(), output.size()));
+  EXPECT_FALSE(PageCompressor::Decompress(compressed.data(), size, output.data(), output.size() - 1));
+  // a match that reaches back before the start of the output
+  const char bad_offset[] = {0x10, 'a', 0x05, 0x00, 0x00};
+  EXPECT_FALSE(PageCompressor::Decompress(bad_offset, sizeof(bad_offset), output.data(), 5));
+  // random garbage never makes it write out of bounds
+  std::mt19937 generator(15445);
+  for (int round = 0; round < 1000; ++round) {
+    std::vector<char> garbage(64);
+    for (char &c : garbage) {
+      c = static_cast<char>(generator());
+    }
+    PageCompressor::Decompress(garbage.data(), garbage.size(), output.data(), 128);
+  }
+}
+
+}  // namespace bustub
@@ -10,8 +10,10 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <cstdio>
 #include <vector>
 
+#include "buffer/buffer_pool_manager_instance.h"
 #include "gtest/gtest.h"
 #include "storage/page/tmp_tuple_page.h"
 #include "type/value_factory.h"
@@ -19,13 +21,16 @@
 namespace bustub {
 
 // NOLINTNEXTLINE
-TEST(TmpTuplePageTest, DISABLED_BasicTest) {
+TEST(TmpTuplePageTest, BasicTest) {
   // There are many ways to do this assignment, and this is only one of them.
   // If you don't like the TmpTuplePage idea, please feel free to delete this test case entirely.
   // You will get full credit as long as you are correctly using a linear probe hash table.
 
-  TmpTuplePage page{};
-  page_id_t page_id = 15445;
+  // the pages of a buffer pool frame its memory, so the page is one of a buffer pool's
+  DiskManager disk_manager("tmp_tuple_page_test.db");
+  BufferPoolManagerInstance bpm(1, &disk_manager);
+  page_id_t page_id;
+  auto &page = *reinterpret_cast<TmpTuplePage *>(bpm.NewPage(&page_id));
   page.Init(page_id, PAGE_SIZE);
 
   char *data = page.GetData();
@@ -43,9 +48,27 @@ TEST(TmpTuplePageTest, DISABLED_BasicTest) {
   TmpTuple tmp_tuple(INVALID_PAGE_ID, 0);
   page.Insert(tuple, &tmp_tuple);
 
-  ASSERT_EQ(*reinterpret_cast<uint32_t *>(data + sizeof(page_id_t) + sizeof(lsn_t)), PAGE_SIZE - 8);
-  ASSERT_EQ(*reinterpret_cast<uint32_t *>(data + PAGE_SIZE - 8), 4);
-  ASSERT_EQ(*reinterpret_cast<uint32_t *>(data + PAGE_SIZE - 4), 123);
+  // the tuple is its integer followed by its null bitmap
+  ASSERT_EQ(*reinterpret_cast<uint32_t *>(data + sizeof(page_id_t) + sizeof(lsn_t)), PAGE_SIZE - 9);
+  ASSERT_EQ(*reinterpret_cast<uint32_t *>(data + PAGE_SIZE - 9), 5);
+  ASSERT_EQ(*reinterpret_cast<uint32_t *>(data + PAGE_SIZE - 5), 123);
+  ASSERT_EQ(tmp_tuple, TmpTuple(page_id, PAGE_SIZE - 9));
+
+  // the page fills up, and gives the tuples back
+  uint32_t count = 1;
+  for (int32_t i = 0; page.Insert(Tuple({ValueFactory::GetIntegerValue(i)}, &schema), &tmp_tuple); i++) {
+    count++;
+  }
+  ASSERT_EQ(count, (PAGE_SIZE - 12) / 9);
+  std::vector<Tuple> tuples;
+  page.GetTuples(PAGE_SIZE, &tuples);
+  ASSERT_EQ(tuples.size(), count);
+  ASSERT_EQ(tuples.front().GetValue(&schema, 0).GetAs<int32_t>(), static_cast<int32_t>(count) - 2);
+  ASSERT_EQ(tuples.back().GetValue(&schema, 0).GetAs<int32_t>(), 123);
+
+  bpm.UnpinPage(page_id, false);
+  disk_manager.ShutDown();
+  remove("tmp_tuple_page_test.db");
 }
 
 }  // namespace bustub
@@ -0,0 +1,221 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// pax_table_heap_test.cpp
+//
+// Identification: test/table/pax_table_heap_test.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <cstdio>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "buffer/buffer_pool_manager_instance.h"
+#include "gtest/gtest.h"
+#include "storage/table/pax_column_scanner.h"
+#include "storage/table/pax_table_heap.h"
+#include "type/value_factory.h"
+
+namespace bustub {
+
+// NOLINTNEXTLINE
+TEST(PaxTableHeapTest, ColumnScanTest) {
+  // a wide table: an id, a name and 38 integer columns
+  std::vector<Column> columns{Column("id", TypeId::BIGINT), Column("name", TypeId::VARCHAR, 32)};
+  for (int i = 0; i < 38; i++) {
+    columns.emplace_back("c" + std::to_string(i), TypeId::INTEGER);
+  }
+  Schema schema(columns);
+  auto make_tuple = [&schema](int64_t id) {
+    std::vector<Value> values{ValueFactory::GetBigIntValue(id),
+                              id % 10 == 0 ? ValueFactory::GetNullValueByType(TypeId::VARCHAR)
+                                           : ValueFactory::GetVarcharValue("name " + std::to_string(id))};
+    for (int32_t i = 0; i < 38; i++) {
+      values.push_back(ValueFactory::GetIntegerValue(static_cast<int32_t>(id) * i));
+    }
+    return Tuple(values, &schema);
+  };
+
+  auto *disk_manager = new DiskManager("test.db");
+  auto *bpm = new BufferPoolManagerInstance(50, disk_manager);
+  auto *transaction = new Transaction(0);
+  auto *table = new PaxTableHeap(bpm, &schema);
+  const PaxLayout &layout = table->GetLayout();
+  EXPECT_GT(layout.capacity_, 1);
+  EXPECT_LE(layout.minipages_end_, PAGE_SIZE);
+
+  // the rows fill the pages in order
+  const int64_t num_rows = 2000;
+  std::vector<RID> rids;
+  for (int64_t id = 0; id < num_rows; id++) {
+    RID rid;
+    ASSERT_TRUE(table->InsertTuple(make_tuple(id), &rid, transaction));
+    EXPECT_TRUE(rids.empty() || rids.back().GetPageId() <= rid.GetPageId());
+    rids.push_back(rid);
+  }
+  EXPECT_EQ(table->GetFirstPageId(), rids.front().GetPageId());
+  EXPECT_NE(rids.front().GetPageId(), rids.back().GetPageId());
+
+  // whole rows come back as they went in
+  for (int64_t id = 0; id < num_rows; id += 7) {
+    Tuple tuple;
+    ASSERT_TRUE(table->GetTuple(rids[id], &tuple, transaction));
+    EXPECT_EQ(rids[id], tuple.GetRid());
+    EXPECT_EQ(id, tuple.GetValue(&schema, 0).GetAs<int64_t>());
+    if (id % 10 == 0) {
+      EXPECT_TRUE(tuple.IsNull(&schema, 1));
+    } else {
+      EXPECT_EQ("name " + std::to_string(id), tuple.GetValue(&schema, 1).ToString());
+    }
+    EXPECT_EQ(id * 37, tuple.GetValue(&schema, 39).GetAs<int32_t>());
+  }
+
+  // deleted rows are skipped by reads and scans
+  for (int64_t id = 0; id < num_rows; id += 3) {
+    ASSERT_TRUE(table->MarkDelete(rids[id], transaction));
+    EXPECT_FALSE(table->MarkDelete(rids[id], transaction));
+  }
+  Tuple tuple;
+  EXPECT_FALSE(table->GetTuple(rids[3], &tuple, transaction));
+
+  // a scan of two columns reads just those, in the order they were asked for
+  {
+    PaxColumnScanner scanner(table, {5, 1});
+    RID rid;
+    std::vector<Value> values;
+    int64_t id = 0;
+    while (scanner.Next(&rid, &values)) {
+      while (id % 3 == 0) {
+        id++;
+      }
+      ASSERT_EQ(2, values.size());
+      EXPECT_EQ(rids[id], rid);
+      EXPECT_EQ(id * 3, values[0].GetAs<int32_t>());
+      EXPECT_EQ(id % 10 == 0, values[1].IsNull());
+      id++;
+    }
+    EXPECT_EQ(num_rows, id);
+  }
+
+  // an opened table appends to its last page
+  auto *reopened = new PaxTableHeap(bpm, &schema, table->GetFirstPageId());
+  RID rid;
+  ASSERT_TRUE(reopened->InsertTuple(make_tuple(num_rows), &rid, transaction));
+  EXPECT_LE(rids.back().GetPageId(), rid.GetPageId());
+  ASSERT_TRUE(table->GetTuple(rid, &tuple, transaction));
+  EXPECT_EQ(num_rows, tuple.GetValue(&schema, 0).GetAs<int64_t>());
+
+  delete reopened;
+  delete table;
+  delete transaction;
+  delete bpm;
+  disk_manager->ShutDown();
+  delete disk_manager;
+  remove("test.db");
+}
+
+// NOLINTNEXTLINE
+TEST(PaxTableHeapTest, DictionaryTest) {
+  // long values of a status column with few distinct values, and a unique name column
+  Schema schema({Column("id", TypeId::INTEGER), Column("status", TypeId::VARCHAR, 128),
+                 Column("name", TypeId::VARCHAR, 32)});
+  const std::vector<std::string> statuses{std::string(100, 'a'), std::string(100, 'b'), std::string(99, 'a')};
+  auto make_tuple = [&](int32_t id) {
+    return Tuple({ValueFactory::GetIntegerValue(id),
+                  id % 17 == 0 ? ValueFactory::GetNullValueByType(TypeId::VARCHAR)
+                               : ValueFactory::GetVarcharValue(statuses[id % 3]),
+                  ValueFactory::GetVarcharValue("n" + std::to_string(id))},
+                 &schema);
+  };
+
+  auto *disk_manager = new DiskManager("test.db");
+  auto *bpm = new BufferPoolManagerInstance(50, disk_manager);
+  auto *transaction = new Transaction(0);
+  auto *table = new PaxTableHeap(bpm, &schema);
+  const PaxLayout &layout = table->GetLayout();
+
+  // the repeated values are stored once per page, so the pages fill up to their capacity
+  const int32_t num_rows = 1000;
+  std::vector<RID> rids;
+  for (int32_t id = 0; id < num_rows; id++) {
+    RID rid;
+    ASSERT_TRUE(table->InsertTuple(make_tuple(id), &rid, transaction));
+    rids.push_back(rid);
+  }
+  EXPECT_EQ(rids.front().GetPageId(), rids[layout.capacity_ - 1].GetPageId());
+  EXPECT_EQ(0, rids[layout.capacity_].GetSlotNum());
+
+  // the values read back as they went in
+  for (int32_t id = 0; id < num_rows; id += 7) {
+    Tuple tuple;
+    ASSERT_TRUE(table->GetTuple(rids[id], &tuple, transaction));
+    if (id % 17 == 0) {
+      EXPECT_TRUE(tuple.IsNull(&schema, 1));
+    } else {
+      EXPECT_EQ(statuses[id % 3], tuple.GetValue(&schema, 1).ToString());
+    }
+    EXPECT_EQ("n" + std::to_string(id), tuple.GetValue(&schema, 2).ToString());
+  }
+
+  // within a page, rows have the same code iff they have the same value
+  {
+    PaxColumnScanner scanner(table, {0, 1, 2});
+    RID rid;
+    std::vector<Value> values;
+    std::vector<uint32_t> codes;
+    std::vector<std::pair<int32_t, uint32_t>> page_rows;
+    auto check_page = [&]() {
+      for (size_t i = 0; i < page_rows.size(); i++) {
+        for (size_t j = 0; j < i; j++) {
+          int32_t a = page_rows[i].first;
+          int32_t b = page_rows[j].first;
+          bool same = (a % 17 == 0) == (b % 17 == 0) && (a % 17 == 0 || a % 3 == b % 3);
+          EXPECT_EQ(same, page_rows[i].second == page_rows[j].second) << a << ", " << b;
+        }
+      }
+      page_rows.clear();
+    };
+    page_id_t page_id = INVALID_PAGE_ID;
+    int32_t count = 0;
+    std::set<uint32_t> name_codes;
+    while (scanner.Next(&rid, &values, &codes)) {
+      ASSERT_EQ(3, codes.size());
+      EXPECT_EQ(0, codes[0]);
+      if (rid.GetPageId() != page_id) {
+        check_page();
+        name_codes.clear();
+        page_id = rid.GetPageId();
+      }
+      page_rows.emplace_back(values[0].GetAs<int32_t>(), codes[1]);
+      // the unique names get codes of their own
+      EXPECT_TRUE(name_codes.insert(codes[2]).second);
+      count++;
+    }
+    check_page();
+    EXPECT_EQ(num_rows, count);
+  }
+
+  // a predicate's constant is looked up once per page
+  auto *page = static_cast<PaxPage *>(bpm->FetchPage(rids[0].GetPageId()));
+  uint32_t code;
+  ASSERT_TRUE(page->FindCode(1, ValueFactory::GetVarcharValue(statuses[1]), layout, &code));
+  EXPECT_EQ(page->GetCode(1, 1, layout), code);
+  EXPECT_FALSE(page->FindCode(1, ValueFactory::GetVarcharValue(std::string(100, 'c')), layout, &code));
+  EXPECT_FALSE(page->FindCode(1, ValueFactory::GetVarcharValue(std::string(101, 'a')), layout, &code));
+  bpm->UnpinPage(page->GetPageId(), false);
+
+  delete table;
+  delete transaction;
+  delete bpm;
+  disk_manager->ShutDown();
+  delete disk_manager;
+  remove("test.db");
+}
+
+}  // namespace bustub
@@ -0,0 +1,897 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// table_heap_test.cpp
+//
+// Identification: test/table/table_heap_test.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <cstdio>
+#include <set>
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "buffer/buffer_pool_manager_instance.h"
+#include "buffer/parallel_buffer_pool_manager.h"
+#include "concurrency/lock_manager.h"
+#include "concurrency/transaction_manager.h"
+#include "gtest/gtest.h"
+#include "storage/table/parallel_table_scan.h"
+#include "storage/table/table_heap.h"
+#include "storage/table/table_page_scanner.h"
+#include "storage/table/table_vacuum.h"
+#include "storage/table/tuple.h"
+
+namespace bustub {
+
+// NOLINTNEXTLINE
+TEST(TableHeapTest, FreeSpaceTest) {
+  Schema schema({Column("a", TypeId::INTEGER), Column("b", TypeId::INTEGER)});
+  auto *transaction = new Transaction(0);
+  auto *disk_manager = new DiskManager("test.db");
+  auto *bpm = new BufferPoolManagerInstance(50, disk_manager);
+  auto *lock_manager = new LockManager();
+  auto *table = new TableHeap(bpm, lock_manager, nullptr, transaction);
+  auto make_tuple = [&schema](int32_t i) {
+    return Tuple({Value(TypeId::INTEGER, i), Value(TypeId::INTEGER, -i)}, &schema);
+  };
+
+  // a single thread fills the pages in the order of the list
+  std::vector<RID> rids;
+  for (int32_t i = 0; i < 2000; i++) {
+    RID rid;
+    ASSERT_TRUE(table->InsertTuple(make_tuple(i), &rid, transaction));
+    EXPECT_TRUE(rids.empty() || rids.back().GetPageId() <= rid.GetPageId());
+    rids.push_back(rid);
+  }
+  page_id_t first_page_id = rids.front().GetPageId();
+  page_id_t last_page_id = rids.back().GetPageId();
+  EXPECT_EQ(first_page_id, table->GetFirstPageId());
+  EXPECT_NE(first_page_id, last_page_id);
+
+  // the thread goes on with the page it inserted into last, even once deletes free space in the first page
+  for (int i = 0; i < 10; i++) {
+    ASSERT_TRUE(table->MarkDelete(rids[i], transaction));
+    table->ApplyDelete(rids[i], transaction);
+  }
+  RID rid;
+  ASSERT_TRUE(table->InsertTuple(make_tuple(2000), &rid, transaction));
+  EXPECT_EQ(last_page_id, rid.GetPageId());
+
+  // a heap opened on the same pages finds that space by itself, as the page with the least room that fits the tuples,
+  // until the page is full again. The room of a page is counted with a slot of its own for each insert, so whether
+  // the last of the deleted tuples fits again depends on the bytes left over at the end of the page, and the page size
+  auto *reopened = new TableHeap(bpm, lock_manager, nullptr, first_page_id);
+  int32_t refilled = 0;
+  while (true) {
+    ASSERT_TRUE(reopened->InsertTuple(make_tuple(refilled), &rid, transaction));
+    if (rid.GetPageId() != first_page_id) {
+      break;
+    }
+    refilled++;
+  }
+  EXPECT_GE(refilled, 9);
+  EXPECT_LE(refilled, 10);
+  EXPECT_EQ(last_page_id, rid.GetPageId());
+
+  delete reopened;
+  delete table;
+  delete lock_manager;
+  delete transaction;
+  delete bpm;
+  delete disk_manager;
+  remove("test.db");
+}
+
+// NOLINTNEXTLINE
+TEST(TableHeapTest, ConcurrentInsertTest) {
+  Schema schema({Column("a", TypeId::INTEGER), Column("b", TypeId::INTEGER)});
+  auto *disk_manager = new DiskManager("test.db");
+  auto *bpm = new BufferPoolManagerInstance(50, disk_manager);
+  auto *transaction = new Transaction(0);
+  auto *table = new TableHeap(bpm, nullptr, nullptr, transaction);
+
+  const int num_threads = 4;
+  const int32_t tuples_per_thread = 2000;
+  std::vector<std::thread> threads;
+  for (int t = 0; t < num_threads; t++) {
+    threads.emplace_back([&, t] {
+      Transaction txn(t + 1);
+      for (int32_t i = 0; i < tuples_per_thread; i++) {
+        RID rid;
+        Tuple tuple({Value(TypeId::INTEGER, t), Value(TypeId::INTEGER, i)}, &schema);
+        EXPECT_TRUE(table->InsertTuple(tuple, &rid, &txn));
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  // every tuple is there once, and the pages are full but for a few at the end
+  std::vector<int32_t> next(num_threads, 0);
+  std::set<page_id_t> pages;
+  for (auto iterator = table->Begin(transaction); iterator != table->End(); ++iterator) {
+    int32_t t = iterator->GetValue(&schema, 0).GetAs<int32_t>();
+    EXPECT_EQ(next[t]++, iterator->GetValue(&schema, 1).GetAs<int32_t>());
+    pages.insert(iterator->GetRid().GetPageId());
+  }
+  EXPECT_EQ(std::vector<int32_t>(num_threads, tuples_per_thread), next);
+  uint32_t tuple_size = Tuple({Value(TypeId::INTEGER, 0), Value(TypeId::INTEGER, 0)}, &schema).GetLength();
+  uint32_t tuples_per_page = (PAGE_SIZE - 24) / (tuple_size + 8);
+  EXPECT_LE(pages.size(), num_threads * tuples_per_thread / tuples_per_page + num_threads + 1);
+
+  delete table;
+  delete transaction;
+  delete bpm;
+  delete disk_manager;
+  remove("test.db");
+}
+
+// NOLINTNEXTLINE
+TEST(TableHeapTest, PageScannerTest) {
+  Schema schema({Column("a", TypeId::INTEGER), Column("b", TypeId::VARCHAR, 16)});
+  auto *transaction = new Transaction(0);
+  auto *disk_manager = new DiskManager("test.db");
+  auto *bpm = new BufferPoolManagerInstance(50, disk_manager);
+  auto *lock_manager = new LockManager();
+  auto *table = new TableHeap(bpm, lock_manager, nullptr, transaction);
+  std::vector<RID> rids;
+  for (int32_t i = 0; i < 1000; i++) {
+    RID rid;
+    ASSERT_TRUE(table->InsertTuple(Tuple({Value(TypeId::INTEGER, i), Value(TypeId::VARCHAR, "abc")}, &schema), &rid,
+                                   transaction));
+    rids.push_back(rid);
+  }
+  for (int i = 0; i < 1000; i += 3) {
+    ASSERT_TRUE(table->MarkDelete(rids[i], transaction));
+  }
+
+  // the scan sees the tuples the iterator sees, as views into their pages
+  {
+    TablePageScanner scanner(table, transaction);
+    auto iterator = table->Begin(transaction);
+    Tuple view;
+    int count = 0;
+    while (scanner.Next(&view)) {
+      ASSERT_NE(table->End(), iterator);
+      EXPECT_FALSE(view.IsAllocated());
+      EXPECT_EQ(iterator->GetRid(), view.GetRid());
+      EXPECT_EQ(iterator->GetValue(&schema, 0).GetAs<int32_t>(), view.GetValue(&schema, 0).GetAs<int32_t>());
+      ++iterator;
+      count++;
+    }
+    EXPECT_EQ(table->End(), iterator);
+    EXPECT_EQ(666, count);
+  }
+
+  // a released scanner lets writers at its page, and goes on after the tuple it handed out last
+  {
+    TablePageScanner scanner(table, transaction);
+    Tuple view;
+    std::vector<int32_t> seen;
+    while (scanner.Next(&view)) {
+      Tuple copy;
+      copy.CopyFrom(view);
+      scanner.Release();
+      EXPECT_TRUE(copy.IsAllocated());
+      int32_t i = copy.GetValue(&schema, 0).GetAs<int32_t>();
+      seen.push_back(i);
+      // the next live tuple goes away before the scanner gets to it
+      if (i % 3 == 1 && i + 1 < 1000) {
+        ASSERT_TRUE(table->MarkDelete(rids[i + 1], transaction));
+      }
+    }
+    ASSERT_EQ(333, seen.size());
+    for (size_t j = 0; j < seen.size(); j++) {
+      EXPECT_EQ(3 * static_cast<int32_t>(j) + 1, seen[j]);
+    }
+  }
+
+  // a filtered scanner hands out just the tuples that pass its filter
+  {
+    TablePageScanner scanner(table, transaction);
+    scanner.SetFilter([&](const Tuple &view) { return view.GetValue(&schema, 0).GetAs<int32_t>() % 2 == 0; });
+    Tuple view;
+    std::vector<int32_t> seen;
+    while (scanner.Next(&view)) {
+      EXPECT_FALSE(view.IsAllocated());
+      seen.push_back(view.GetValue(&schema, 0).GetAs<int32_t>());
+    }
+    ASSERT_EQ(166, seen.size());
+    for (size_t j = 0; j < seen.size(); j++) {
+      EXPECT_EQ(6 * static_cast<int32_t>(j) + 4, seen[j]);
+    }
+  }
+
+  delete table;
+  delete lock_manager;
+  delete transaction;
+  delete bpm;
+  delete disk_manager;
+  remove("test.db");
+}
+
+// NOLINTNEXTLINE
+TEST(TableHeapTest, ZoneMapTest) {
+  Schema schema({Column("time", TypeId::INTEGER), Column("level", TypeId::INTEGER)});
+  auto *transaction = new Transaction(0);
+  auto *disk_manager = new DiskManager("test.db");
+  auto *bpm = new BufferPoolManagerInstance(50, disk_manager);
+  auto *lock_manager = new LockManager();
+  auto *table = new TableHeap(bpm, lock_manager, nullptr, transaction);
+  auto make_tuple = [&schema](int32_t time) {
+    return Tuple({Value(TypeId::INTEGER, time), Value(TypeId::INTEGER, time % 7)}, &schema);
+  };
+
+  // an append-only log, whose pages hold rows of a narrow range of time each
+  for (int32_t time = 0; time < 5000; time++) {
+    RID rid;
+    ASSERT_TRUE(table->InsertTuple(make_tuple(time), &rid, transaction));
+  }
+  table->CreateZoneMap(&schema, {0}, transaction);
+  ZoneMap *zone_map = table->GetZoneMap();
+  ASSERT_NE(nullptr, zone_map);
+  EXPECT_TRUE(zone_map->Covers(0));
+  EXPECT_FALSE(zone_map->Covers(1));
+
+  auto scan = [&](const std::vector<ZoneRange> &ranges, std::set<page_id_t> *pages) {
+    std::vector<int32_t> times;
+    TablePageScanner scanner(table, transaction, nullptr, ranges);
+    Tuple view;
+    while (scanner.Next(&view)) {
+      int32_t time = view.GetValue(&schema, 0).GetAs<int32_t>();
+      if (time >= 2000 && time <= 2100) {
+        times.push_back(time);
+      }
+      pages->insert(view.GetRid().GetPageId());
+    }
+    return times;
+  };
+
+  // a scan of a range of time reads just the pages that may hold it, and finds the same rows as a full scan
+  ZoneRange range{0, Value(TypeId::INTEGER, 2000), Value(TypeId::INTEGER, 2100)};
+  std::set<page_id_t> all_pages;
+  std::set<page_id_t> range_pages;
+  std::vector<int32_t> all_times = scan({}, &all_pages);
+  std::vector<int32_t> range_times = scan({range}, &range_pages);
+  EXPECT_EQ(101, all_times.size());
+  EXPECT_EQ(all_times, range_times);
+  EXPECT_LE(range_pages.size(), 2);
+  EXPECT_GT(all_pages.size(), 2 * range_pages.size());
+  EXPECT_NE(table->GetFirstPageId(), zone_map->NextCandidate(table->GetFirstPageId(), {range}));
+  ZoneRange beyond{0, Value(TypeId::INTEGER, 6000), std::nullopt};
+  EXPECT_EQ(INVALID_PAGE_ID, zone_map->NextCandidate(table->GetFirstPageId(), {beyond}));
+
+  // rows written later widen the zones, of new pages too
+  RID rid;
+  ASSERT_TRUE(table->InsertTuple(make_tuple(2050), &rid, transaction));
+  for (int32_t time = 5000; time < 6000; time++) {
+    ASSERT_TRUE(table->InsertTuple(make_tuple(time), &rid, transaction));
+  }
+  range_pages.clear();
+  range_times = scan({range}, &range_pages);
+  EXPECT_EQ(102, range_times.size());
+  ZoneRange last{0, Value(TypeId::INTEGER, 5999), std::nullopt};
+  EXPECT_EQ(rid.GetPageId(), zone_map->NextCandidate(table->GetFirstPageId(), {last}));
+
+  delete table;
+  delete lock_manager;
+  delete transaction;
+  delete bpm;
+  delete disk_manager;
+  remove("test.db");
+}
+
+// NOLINTNEXTLINE
+TEST(TableHeapTest, InsertTuplesTest) {
+  Schema schema({Column("a", TypeId::INTEGER), Column("b", TypeId::VARCHAR, 16)});
+  auto *transaction = new Transaction(0);
+  auto *disk_manager = new DiskManager("test.db");
+  auto *bpm = new BufferPoolManagerInstance(50, disk_manager);
+  auto *lock_manager = new LockManager();
+  auto *table = new TableHeap(bpm, lock_manager, nullptr, transaction);
+  auto make_batch = [&schema](int32_t begin, int32_t end) {
+    std::vector<Tuple> batch;
+    for (int32_t i = begin; i < end; i++) {
+      batch.emplace_back(std::vector<Value>{Value(TypeId::INTEGER, i), Value(TypeId::VARCHAR, std::to_string(i))},
+                         &schema);
+    }
+    return batch;
+  };
+
+  // a batch fills the pages one after the other, and every tuple is in the write set
+  std::vector<RID> rids;
+  ASSERT_TRUE(table->InsertTuples(make_batch(0, 3000), &rids, transaction));
+  ASSERT_EQ(3000, rids.size());
+  EXPECT_EQ(3000, transaction->GetWriteSet()->size());
+  EXPECT_EQ(table->GetFirstPageId(), rids.front().GetPageId());
+  for (size_t i = 1; i < rids.size(); i++) {
+    EXPECT_TRUE(rids[i - 1].GetPageId() < rids[i].GetPageId() ||
+                (rids[i - 1].GetPageId() == rids[i].GetPageId() && rids[i - 1].GetSlotNum() < rids[i].GetSlotNum()));
+  }
+  EXPECT_NE(rids.front().GetPageId(), rids.back().GetPageId());
+
+  // deletes free slots in the first page, which a later batch reuses before it appends
+  for (int i = 0; i < 5; i++) {
+    ASSERT_TRUE(table->MarkDelete(rids[i], transaction));
+    table->ApplyDelete(rids[i], transaction);
+  }
+  Tuple tuple;
+  EXPECT_FALSE(table->GetTuple(rids[0], &tuple, transaction));
+  auto *reopened = new TableHeap(bpm, lock_manager, nullptr, table->GetFirstPageId());
+  std::vector<RID> more_rids;
+  ASSERT_TRUE(reopened->InsertTuples(make_batch(3000, 3005), &more_rids, transaction));
+  EXPECT_EQ(rids[0], more_rids[0]);
+  EXPECT_EQ(rids[1], more_rids[1]);
+
+  // every tuple reads back
+  for (int32_t i = 5; i < 3000; i++) {
+    ASSERT_TRUE(table->GetTuple(rids[i], &tuple, transaction));
+    EXPECT_EQ(i, tuple.GetValue(&schema, 0).GetAs<int32_t>());
+    EXPECT_EQ(std::to_string(i), tuple.GetValue(&schema, 1).ToString());
+  }
+  ASSERT_TRUE(table->GetTuple(more_rids[4], &tuple, transaction));
+  EXPECT_EQ(3004, tuple.GetValue(&schema, 0).GetAs<int32_t>());
+
+  // a tuple too large for a page fails the batch up front
+  std::vector<Tuple> too_large{Tuple({Value(TypeId::INTEGER, 0), Value(TypeId::VARCHAR, std::string(PAGE_SIZE, 'x'))},
+                                     &schema)};
+  EXPECT_FALSE(table->InsertTuples(too_large, &rids, transaction));
+  EXPECT_TRUE(rids.empty());
+
+  delete reopened;
+  delete table;
+  delete lock_manager;
+  delete transaction;
+  delete bpm;
+  delete disk_manager;
+  remove("test.db");
+}
+
+// NOLINTNEXTLINE
+TEST(TableHeapTest, VacuumTest) {
+  Schema schema({Column("a", TypeId::INTEGER), Column("b", TypeId::VARCHAR, 64)});
+  auto *transaction = new Transaction(0);
+  auto *disk_manager = new DiskManager("test.db");
+  auto *bpm = new BufferPoolManagerInstance(50, disk_manager);
+  auto *table = new TableHeap(bpm, nullptr, nullptr, transaction);
+  auto make_tuple = [&schema](int32_t i) {
+    return Tuple({Value(TypeId::INTEGER, i), Value(TypeId::VARCHAR, std::string(40, 'a' + i % 26))}, &schema);
+  };
+
+  const int32_t num_tuples = 2000;
+  std::vector<RID> rids(num_tuples);
+  for (int32_t i = 0; i < num_tuples; i++) {
+    ASSERT_TRUE(table->InsertTuple(make_tuple(i), &rids[i], transaction));
+  }
+  std::set<page_id_t> pages;
+  for (const RID &rid : rids) {
+    pages.insert(rid.GetPageId());
+  }
+  ASSERT_GT(pages.size(), 4);
+
+  // deleting leaves holes in the pages; the first page loses all of its tuples, the others every other one
+  page_id_t first_page_id = table->GetFirstPageId();
+  for (int32_t i = 0; i < num_tuples; i++) {
+    if (rids[i].GetPageId() == first_page_id || i % 2 == 0) {
+      ASSERT_TRUE(table->MarkDelete(rids[i], transaction));
+      table->ApplyDelete(rids[i], transaction);
+    }
+  }
+
+  // a vacuum pass runs a few pages at a time, going on where it left off
+  VacuumStats stats;
+  size_t rounds = 0;
+  while (!table->Vacuum(2, &stats)) {
+    rounds++;
+  }
+  EXPECT_EQ(pages.size(), stats.pages_);
+  EXPECT_EQ((pages.size() + 1) / 2 - 1, rounds);
+  EXPECT_EQ(pages.size(), stats.compacted_pages_);
+  EXPECT_EQ(1, stats.empty_pages_);
+  EXPECT_GT(stats.reclaimed_bytes_, num_tuples / 2 * 40);
+
+  // there is nothing left to reclaim, and the tuples that are left read back where they were
+  VacuumStats again;
+  EXPECT_TRUE(table->Vacuum(pages.size(), &again));
+  EXPECT_EQ(0, again.compacted_pages_);
+  EXPECT_EQ(0, again.reclaimed_bytes_);
+  Tuple tuple;
+  for (int32_t i = 0; i < num_tuples; i++) {
+    bool deleted = rids[i].GetPageId() == first_page_id || i % 2 == 0;
+    ASSERT_EQ(!deleted, table->GetTuple(rids[i], &tuple, transaction)) << i;
+    if (!deleted) {
+      EXPECT_EQ(i, tuple.GetValue(&schema, 0).GetAs<int32_t>());
+      EXPECT_EQ(std::string(40, 'a' + i % 26), tuple.GetValue(&schema, 1).ToString());
+    }
+  }
+
+  // the reclaimed space is reused before the table grows
+  RID rid;
+  for (int32_t i = 0; i < num_tuples / 4; i++) {
+    ASSERT_TRUE(table->InsertTuple(make_tuple(i), &rid, transaction));
+    EXPECT_EQ(1, pages.count(rid.GetPageId()));
+  }
+
+  // the background vacuum does the same for every table that is added to it
+  for (int32_t i = 0; i < num_tuples; i += 3) {
+    if (table->GetTuple(rids[i], &tuple, transaction)) {
+      ASSERT_TRUE(table->MarkDelete(rids[i], transaction));
+      table->ApplyDelete(rids[i], transaction);
+    }
+  }
+  TableVacuum vacuum;
+  vacuum.AddTable(table);
+  vacuum.Start();
+  while (vacuum.GetStats().reclaimed_bytes_ == 0) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  vacuum.Stop();
+  vacuum.RemoveTable(table);
+  EXPECT_EQ(0, vacuum.RunOnce().pages_);
+
+  delete table;
+  delete transaction;
+  delete bpm;
+  delete disk_manager;
+  remove("test.db");
+}
+
+// NOLINTNEXTLINE
+TEST(TableHeapTest, ToastTest) {
+  Schema schema({Column("a", TypeId::INTEGER), Column("b", TypeId::VARCHAR, 16), Column("c", TypeId::VARCHAR, 16)});
+  auto *transaction = new Transaction(0);
+  auto *disk_manager = new DiskManager("test.db");
+  auto *bpm = new BufferPoolManagerInstance(50, disk_manager);
+  auto *lock_manager = new LockManager();
+  auto *table = new TableHeap(bpm, lock_manager, nullptr, transaction);
+  auto make_tuple = [&schema](int32_t i, size_t b_size, size_t c_size) {
+    return Tuple({Value(TypeId::INTEGER, i), Value(TypeId::VARCHAR, std::string(b_size, 'a' + i % 26)),
+                  Value(TypeId::VARCHAR, std::string(c_size, 'z' - i % 26))},
+                 &schema);
+  };
+
+  // without a toast store, a tuple larger than a page fails
+  RID rid;
+  EXPECT_FALSE(table->InsertTuple(make_tuple(0, 3 * PAGE_SIZE, 10), &rid, transaction));
+  transaction->SetState(TransactionState::GROWING);
+
+  // with one, its large values are moved out of it, the largest first, and read back in
+  table->EnableToast(&schema);
+  ToastStore *toast = table->GetToastStore();
+  std::vector<RID> rids(4);
+  ASSERT_TRUE(table->InsertTuple(make_tuple(0, 3 * PAGE_SIZE, 10), &rids[0], transaction));
+  ASSERT_TRUE(table->InsertTuple(make_tuple(1, 2 * PAGE_SIZE, 3 * PAGE_SIZE), &rids[1], transaction));
+  ASSERT_TRUE(table->InsertTuple(make_tuple(2, PAGE_SIZE / 7, PAGE_SIZE / 6), &rids[2], transaction));
+  ASSERT_TRUE(table->InsertTuple(make_tuple(3, 10, 10), &rids[3], transaction));
+  std::vector<RID> batch_rids;
+  ASSERT_TRUE(table->InsertTuples({make_tuple(4, 10, 10), make_tuple(5, 10, PAGE_SIZE)}, &batch_rids, transaction));
+  rids.insert(rids.end(), batch_rids.begin(), batch_rids.end());
+  const size_t sizes[][2] = {{3 * PAGE_SIZE, 10}, {2 * PAGE_SIZE, 3 * PAGE_SIZE}, {PAGE_SIZE / 7, PAGE_SIZE / 6},
+                             {10, 10},            {10, 10},                     {10, PAGE_SIZE}};
+  for (int32_t i = 0; i < 6; i++) {
+    Tuple tuple;
+    ASSERT_TRUE(table->GetTuple(rids[i], &tuple, transaction));
+    EXPECT_FALSE(toast->IsToasted(tuple));
+    EXPECT_EQ(i, tuple.GetValue(&schema, 0).GetAs<int32_t>());
+    EXPECT_EQ(std::string(sizes[i][0], 'a' + i % 26), tuple.GetValue(&schema, 1).ToString());
+    EXPECT_EQ(std::string(sizes[i][1], 'z' - i % 26), tuple.GetValue(&schema, 2).ToString());
+  }
+
+  // the tuples in the pages keep pointers instead, and only the values asked for are fetched
+  {
+    TablePageScanner scanner(table, transaction);
+    Tuple view;
+    std::vector<std::vector<bool>> toasted;
+    while (scanner.Next(&view)) {
+      toasted.push_back({view.IsToasted(&schema, 1), view.IsToasted(&schema, 2)});
+      EXPECT_LE(view.GetLength(), ToastStore::TOAST_TUPLE_THRESHOLD);
+      EXPECT_EQ(static_cast<int32_t>(toasted.size() - 1), toast->GetValue(view, 0).GetAs<int32_t>());
+    }
+    std::vector<std::vector<bool>> expected{{true, false},  {true, true},   {false, true},
+                                            {false, false}, {false, false}, {false, true}};
+    EXPECT_EQ(expected, toasted);
+  }
+
+  // an update moves the large values of the new version out, and the old version's chains go once it commits
+  ASSERT_TRUE(table->UpdateTuple(make_tuple(1, 10, 4 * PAGE_SIZE), rids[1], transaction));
+  Tuple tuple;
+  ASSERT_TRUE(table->GetTuple(rids[1], &tuple, transaction));
+  EXPECT_EQ(std::string(4 * PAGE_SIZE, 'y'), tuple.GetValue(&schema, 2).ToString());
+  const TableWriteRecord &update = transaction->GetWriteSet()->back();
+  ASSERT_EQ(WType::UPDATE, update.wtype_);
+  EXPECT_TRUE(toast->IsToasted(update.tuple_));
+  table->ApplyUpdate(update.tuple_);
+
+  // a delete frees the chains of its tuple
+  ASSERT_TRUE(table->MarkDelete(rids[0], transaction));
+  table->ApplyDelete(rids[0], transaction);
+  EXPECT_FALSE(table->GetTuple(rids[0], &tuple, transaction));
+  ASSERT_TRUE(table->GetTuple(rids[1], &tuple, transaction));
+  EXPECT_EQ(std::string(4 * PAGE_SIZE, 'y'), tuple.GetValue(&schema, 2).ToString());
+
+  delete table;
+  delete lock_manager;
+  delete transaction;
+  delete bpm;
+  delete disk_manager;
+  remove("test.db");
+}
+
+// NOLINTNEXTLINE
+TEST(TableHeapTest, ParallelScanTest) {
+  Schema schema({Column("a", TypeId::INTEGER), Column("b", TypeId::VARCHAR, 16)});
+  auto *transaction = new Transaction(0);
+  auto *disk_manager = new DiskManager("test.db");
+  auto *bpm = new BufferPoolManagerInstance(50, disk_manager);
+  auto *table = new TableHeap(bpm, nullptr, nullptr, transaction);
+  const int32_t num_tuples = 10000;
+  for (int32_t i = 0; i < num_tuples; i++) {
+    RID rid;
+    Tuple tuple({Value(TypeId::INTEGER, i), Value(TypeId::VARCHAR, std::to_string(i))}, &schema);
+    ASSERT_TRUE(table->InsertTuple(tuple, &rid, transaction));
+  }
+
+  // the pages are known in the order of the list
+  std::vector<page_id_t> page_ids = table->GetPageIds();
+  ASSERT_GT(page_ids.size(), 10);
+  EXPECT_EQ(table->GetFirstPageId(), page_ids.front());
+  for (size_t i = 1; i < page_ids.size(); i++) {
+    auto page = static_cast<TablePage *>(bpm->FetchPage(page_ids[i - 1]));
+    EXPECT_EQ(page_ids[i], page->GetNextPageId());
+    bpm->UnpinPage(page_ids[i - 1], false);
+  }
+
+  // the workers claim disjoint morsels, which together hold every tuple once
+  ParallelTableScan scan(table, 3);
+  EXPECT_EQ((page_ids.size() + 2) / 3, scan.GetMorselCount());
+  const int num_workers = 4;
+  std::vector<std::vector<int32_t>> seen(num_workers);
+  std::vector<size_t> morsels(num_workers);
+  std::vector<std::thread> workers;
+  for (int w = 0; w < num_workers; w++) {
+    workers.emplace_back([&, w] {
+      std::vector<page_id_t> morsel;
+      while (scan.NextMorsel(&morsel)) {
+        EXPECT_LE(morsel.size(), 3);
+        morsels[w]++;
+        TablePageScanner scanner(table, transaction, morsel);
+        Tuple view;
+        while (scanner.Next(&view)) {
+          EXPECT_NE(morsel.end(), std::find(morsel.begin(), morsel.end(), view.GetRid().GetPageId()));
+          seen[w].push_back(view.GetValue(&schema, 0).GetAs<int32_t>());
+        }
+      }
+    });
+  }
+  for (auto &worker : workers) {
+    worker.join();
+  }
+  std::vector<int32_t> all;
+  size_t total_morsels = 0;
+  for (int w = 0; w < num_workers; w++) {
+    all.insert(all.end(), seen[w].begin(), seen[w].end());
+    total_morsels += morsels[w];
+  }
+  EXPECT_EQ(scan.GetMorselCount(), total_morsels);
+  std::sort(all.begin(), all.end());
+  ASSERT_EQ(num_tuples, all.size());
+  for (int32_t i = 0; i < num_tuples; i++) {
+    EXPECT_EQ(i, all[i]);
+  }
+  std::vector<page_id_t> morsel;
+  EXPECT_FALSE(scan.NextMorsel(&morsel));
+
+  // a scanner of no pages finds nothing
+  TablePageScanner empty(table, transaction, std::vector<page_id_t>{});
+  Tuple view;
+  EXPECT_FALSE(empty.Next(&view));
+
+  delete table;
+  delete transaction;
+  delete bpm;
+  delete disk_manager;
+  remove("test.db");
+}
+
+// NOLINTNEXTLINE
+TEST(TableHeapTest, NumaParallelScanTest) {
+  Schema schema({Column("a", TypeId::INTEGER), Column("b", TypeId::VARCHAR, 16)});
+  auto *transaction = new Transaction(0);
+  auto *disk_manager = new DiskManager("test.db");
+  // four instances over two nodes, so that the pages of the table are on both of them
+  auto *bpm = new ParallelBufferPoolManager(4, 50, disk_manager, nullptr, ReplacerType::CLOCK, 2);
+  auto *table = new TableHeap(bpm, nullptr, nullptr, transaction);
+  const int32_t num_tuples = 10000;
+  for (int32_t i = 0; i < num_tuples; i++) {
+    RID rid;
+    Tuple tuple({Value(TypeId::INTEGER, i), Value(TypeId::VARCHAR, std::to_string(i))}, &schema);
+    ASSERT_TRUE(table->InsertTuple(tuple, &rid, transaction));
+  }
+  std::vector<page_id_t> page_ids = table->GetPageIds();
+  for (page_id_t page_id : page_ids) {
+    EXPECT_EQ(static_cast<int>(page_id % 4 % 2), bpm->GetNumaNode(page_id));
+  }
+
+  // each morsel is of the pages of one node, and a worker first gets those of its own node
+  const std::vector<int> worker_nodes{0, 0, 1, 1};
+  ParallelTableScan scan(table, 3, nullptr, worker_nodes.size(), worker_nodes);
+  std::vector<page_id_t> scanned;
+  std::vector<page_id_t> morsel;
+  for (size_t w = 0; w < worker_nodes.size(); w++) {
+    ASSERT_TRUE(scan.NextMorsel(&morsel, w));
+    for (page_id_t page_id : morsel) {
+      EXPECT_EQ(worker_nodes[w], bpm->GetNumaNode(page_id));
+    }
+    scanned.insert(scanned.end(), morsel.begin(), morsel.end());
+  }
+  size_t num_morsels = worker_nodes.size();
+  while (scan.NextMorsel(&morsel, 0)) {
+    ASSERT_FALSE(morsel.empty());
+    EXPECT_LE(morsel.size(), 3);
+    int node = bpm->GetNumaNode(morsel.front());
+    for (page_id_t page_id : morsel) {
+      EXPECT_EQ(node, bpm->GetNumaNode(page_id));
+    }
+    scanned.insert(scanned.end(), morsel.begin(), morsel.end());
+    num_morsels++;
+  }
+  EXPECT_EQ(scan.GetMorselCount(), num_morsels);
+  std::sort(page_ids.begin(), page_ids.end());
+  std::sort(scanned.begin(), scanned.end());
+  EXPECT_EQ(page_ids, scanned);
+
+  // workers of unknown nodes get morsels of consecutive pages
+  ParallelTableScan plain(table, 3, nullptr, 2, {-1, -1});
+  EXPECT_EQ((page_ids.size() + 2) / 3, plain.GetMorselCount());
+
+  delete table;
+  delete transaction;
+  delete bpm;
+  delete disk_manager;
+  remove("test.db");
+}
+
+// NOLINTNEXTLINE
+TEST(TableHeapTest, SynchronizedScanTest) {
+  Schema schema({Column("a", TypeId::INTEGER), Column("b", TypeId::INTEGER)});
+  auto *transaction = new Transaction(0);
+  auto *disk_manager = new DiskManager("test.db");
+  auto *bpm = new BufferPoolManagerInstance(50, disk_manager);
+  auto *table = new TableHeap(bpm, nullptr, nullptr, transaction);
+  auto *small_table = new TableHeap(bpm, nullptr, nullptr, transaction);
+  // a table of more pages than a scan of it may take of the pool, whatever the page size, and one of fewer
+  const int32_t num_tuples = 10 * PAGE_SIZE / 4;
+  for (int32_t i = 0; i < num_tuples; i++) {
+    RID rid;
+    Tuple tuple({Value(TypeId::INTEGER, i), Value(TypeId::INTEGER, -i)}, &schema);
+    ASSERT_TRUE(table->InsertTuple(tuple, &rid, transaction));
+    if (i < num_tuples / 10) {
+      ASSERT_TRUE(small_table->InsertTuple(tuple, &rid, transaction));
+    }
+  }
+  std::vector<page_id_t> page_ids = table->GetPageIds();
+  ASSERT_GE(page_ids.size(), 50 / TablePageScanner::SYNC_SCAN_POOL_FRACTION);
+  ASSERT_LT(small_table->GetPageIds().size(), 50 / TablePageScanner::SYNC_SCAN_POOL_FRACTION);
+
+  // the first scan starts at the first page, as there is nothing to join
+  auto leader = TablePageScanner::Synchronized(table, transaction);
+  Tuple view;
+  ASSERT_TRUE(leader->Next(&view));
+  EXPECT_EQ(0, view.GetValue(&schema, 0).GetAs<int32_t>());
+  const page_id_t middle = page_ids[page_ids.size() / 2];
+  while (view.GetRid().GetPageId() != middle) {
+    ASSERT_TRUE(leader->Next(&view));
+  }
+
+  // the next one starts at the page the first one is at, and wraps around to the pages before it
+  {
+    auto follower = TablePageScanner::Synchronized(table, transaction);
+    std::vector<page_id_t> pages;
+    std::set<int32_t> seen;
+    while (follower->Next(&view)) {
+      if (pages.empty() || pages.back() != view.GetRid().GetPageId()) {
+        pages.push_back(view.GetRid().GetPageId());
+      }
+      EXPECT_TRUE(seen.insert(view.GetValue(&schema, 0).GetAs<int32_t>()).second);
+    }
+    EXPECT_EQ(num_tuples, seen.size());
+    ASSERT_EQ(page_ids.size(), pages.size());
+    EXPECT_EQ(middle, pages.front());
+    std::rotate(page_ids.begin(), page_ids.begin() + page_ids.size() / 2, page_ids.end());
+    EXPECT_EQ(page_ids, pages);
+  }
+
+  // a small table is scanned from the start, joined or not
+  {
+    auto small_leader = TablePageScanner::Synchronized(small_table, transaction);
+    int32_t count = 0;
+    while (count < 500 && small_leader->Next(&view)) {
+      count++;
+    }
+    auto small_follower = TablePageScanner::Synchronized(small_table, transaction);
+    ASSERT_TRUE(small_follower->Next(&view));
+    EXPECT_EQ(0, view.GetValue(&schema, 0).GetAs<int32_t>());
+  }
+
+  // and once the scans are done, a new one starts at the first page again
+  leader.reset();
+  auto scanner = TablePageScanner::Synchronized(table, transaction);
+  ASSERT_TRUE(scanner->Next(&view));
+  EXPECT_EQ(0, view.GetValue(&schema, 0).GetAs<int32_t>());
+  scanner.reset();
+
+  delete small_table;
+  delete table;
+  delete transaction;
+  delete bpm;
+  delete disk_manager;
+  remove("test.db");
+}
+
+// NOLINTNEXTLINE
+TEST(TableHeapTest, SnapshotTest) {
+  Schema schema({Column("a", TypeId::INTEGER)});
+  auto *transaction = new Transaction(0);
+  auto *disk_manager = new DiskManager("test.db");
+  auto *bpm = new BufferPoolManagerInstance(50, disk_manager);
+  auto *lock_manager = new LockManager();
+  auto *txn_mgr = new TransactionManager(lock_manager);
+  auto *table = new TableHeap(bpm, lock_manager, nullptr, transaction);
+  auto make_tuple = [&schema](int32_t i) { return Tuple({Value(TypeId::INTEGER, i)}, &schema); };
+  auto scan = [&](Transaction *txn) {
+    std::multiset<int32_t> values;
+    TablePageScanner scanner(table, txn);
+    Tuple view;
+    while (scanner.Next(&view)) {
+      values.insert(view.GetValue(&schema, 0).GetAs<int32_t>());
+    }
+    return values;
+  };
+
+  // the rows written outside a transaction manager keep no versions
+  std::vector<RID> rids;
+  for (int32_t i = 0; i < 10; i++) {
+    RID rid;
+    ASSERT_TRUE(table->InsertTuple(make_tuple(i), &rid, transaction));
+    rids.push_back(rid);
+  }
+  EXPECT_EQ(0, table->GetVersionStore()->GetVersionCount());
+  std::multiset<int32_t> before = scan(transaction);
+
+  // a reader does not see the writes of a transaction that did not commit, which does see its own
+  auto *reader = txn_mgr->Begin(nullptr, IsolationLevel::SNAPSHOT);
+  auto *writer = txn_mgr->Begin(nullptr, IsolationLevel::SNAPSHOT);
+  ASSERT_TRUE(table->UpdateTuple(make_tuple(100), rids[0], writer));
+  ASSERT_TRUE(table->MarkDelete(rids[1], writer));
+  RID inserted;
+  ASSERT_TRUE(table->InsertTuple(make_tuple(10), &inserted, writer));
+  EXPECT_EQ(3, table->GetVersionStore()->GetVersionCount());
+  Tuple tuple;
+  ASSERT_TRUE(table->GetTuple(rids[0], &tuple, reader));
+  EXPECT_EQ(0, tuple.GetValue(&schema, 0).GetAs<int32_t>());
+  ASSERT_TRUE(table->GetTuple(rids[1], &tuple, reader));
+  EXPECT_FALSE(table->GetTuple(inserted, &tuple, reader));
+  ASSERT_TRUE(table->GetTuple(rids[0], &tuple, writer));
+  EXPECT_EQ(100, tuple.GetValue(&schema, 0).GetAs<int32_t>());
+  EXPECT_FALSE(table->GetTuple(rids[1], &tuple, writer));
+  EXPECT_EQ(before, scan(reader));
+
+  // nor once it committed, as the reader began before; a transaction that begins after sees them all
+  txn_mgr->Commit(writer);
+  EXPECT_EQ(before, scan(reader));
+  auto *later = txn_mgr->Begin(nullptr, IsolationLevel::SNAPSHOT);
+  std::multiset<int32_t> after = before;
+  after.erase(0);
+  after.erase(1);
+  after.insert({100, 10});
+  EXPECT_EQ(after, scan(later));
+
+  // the reader may not write a row that was written after its snapshot, and is aborted
+  EXPECT_FALSE(table->UpdateTuple(make_tuple(200), rids[0], reader));
+  EXPECT_EQ(TransactionState::ABORTED, reader->GetState());
+  txn_mgr->Abort(reader);
+  EXPECT_EQ(3, table->GetVersionStore()->GetVersionCount());
+
+  // once no snapshot reaches the versions, the next commit that writes the table collects them
+  ASSERT_TRUE(table->UpdateTuple(make_tuple(102), rids[2], later));
+  txn_mgr->Commit(later);
+  EXPECT_EQ(txn_mgr->GetWatermark(), later->GetCommitTs());
+  EXPECT_EQ(0, table->GetVersionStore()->GetVersionCount());
+
+  delete later;
+  delete writer;
+  delete reader;
+  delete table;
+  delete txn_mgr;
+  delete lock_manager;
+  delete transaction;
+  delete bpm;
+  delete disk_manager;
+  remove("test.db");
+}
+
+// NOLINTNEXTLINE
+TEST(TableHeapTest, OptimisticTest) {
+  Schema schema({Column("a", TypeId::INTEGER)});
+  auto *transaction = new Transaction(0);
+  auto *disk_manager = new DiskManager("test.db");
+  auto *bpm = new BufferPoolManagerInstance(50, disk_manager);
+  auto *lock_manager = new LockManager();
+  auto *txn_mgr = new TransactionManager(lock_manager);
+  auto *table = new TableHeap(bpm, lock_manager, nullptr, transaction);
+  auto make_tuple = [&schema](int32_t i) { return Tuple({Value(TypeId::INTEGER, i)}, &schema); };
+  auto value_of = [&](const RID &rid, Transaction *txn) {
+    Tuple tuple;
+    return table->GetTuple(rid, &tuple, txn) ? tuple.GetValue(&schema, 0).GetAs<int32_t>() : -1;
+  };
+  std::vector<RID> rids;
+  for (int32_t i = 0; i < 5; i++) {
+    RID rid;
+    ASSERT_TRUE(table->InsertTuple(make_tuple(i), &rid, transaction));
+    rids.push_back(rid);
+  }
+
+  // the writes are kept in the transaction, which reads them back, until it commits; no lock is taken
+  auto *first = txn_mgr->Begin(nullptr, IsolationLevel::OPTIMISTIC);
+  EXPECT_EQ(0, value_of(rids[0], first));
+  ASSERT_TRUE(table->UpdateTuple(make_tuple(11), rids[1], first));
+  ASSERT_TRUE(table->MarkDelete(rids[2], first));
+  EXPECT_EQ(11, value_of(rids[1], first));
+  EXPECT_EQ(-1, value_of(rids[2], first));
+  EXPECT_EQ(1, value_of(rids[1], transaction));
+  EXPECT_EQ(2, value_of(rids[2], transaction));
+  EXPECT_EQ(1, first->GetReadSet()->size());
+  EXPECT_TRUE(first->GetSharedLockSet()->empty());
+  txn_mgr->Commit(first);
+  EXPECT_EQ(11, value_of(rids[1], transaction));
+  EXPECT_EQ(-1, value_of(rids[2], transaction));
+  EXPECT_NE(0, table->GetTidTable()->Get(rids[1]));
+
+  // a transaction that read a tuple written before it commits is aborted, and its writes never reach the table
+  auto *second = txn_mgr->Begin(nullptr, IsolationLevel::OPTIMISTIC);
+  size_t scanned = 0;
+  {
+    TablePageScanner scanner(table, second);
+    Tuple view;
+    while (scanner.Next(&view)) {
+      scanned++;
+    }
+  }
+  EXPECT_EQ(4, scanned);
+  ASSERT_TRUE(table->UpdateTuple(make_tuple(13), rids[3], second));
+  RID inserted;
+  ASSERT_TRUE(table->InsertTuple(make_tuple(5), &inserted, second));
+  ASSERT_TRUE(table->UpdateTuple(make_tuple(10), rids[0], transaction));
+  EXPECT_THROW(txn_mgr->Commit(second), TransactionAbortException);
+  EXPECT_EQ(TransactionState::ABORTED, second->GetState());
+  EXPECT_EQ(3, value_of(rids[3], transaction));
+  EXPECT_EQ(-1, value_of(inserted, transaction));
+
+  // one whose reads are still current commits
+  auto *third = txn_mgr->Begin(nullptr, IsolationLevel::OPTIMISTIC);
+  EXPECT_EQ(10, value_of(rids[0], third));
+  ASSERT_TRUE(table->UpdateTuple(make_tuple(14), rids[4], third));
+  txn_mgr->Commit(third);
+  EXPECT_EQ(14, value_of(rids[4], transaction));
+
+  delete third;
+  delete second;
+  delete first;
+  delete table;
+  delete txn_mgr;
+  delete lock_manager;
+  delete transaction;
+  delete bpm;
+  delete disk_manager;
+  remove("test.db");
+}
+
+}  // namespace bustub
@@ -14,13 +14,16 @@
 #include <cstdio>
 #include <iostream>
 #include <string>
+#include <utility>
 #include <vector>
 
-#include "buffer/buffer_pool_manager.h"
+#include "buffer/buffer_pool_manager_instance.h"
 #include "gtest/gtest.h"
 #include "logging/common.h"
 #include "storage/table/table_heap.h"
 #include "storage/table/tuple.h"
+#include "storage/table/tuple_builder.h"
+#include "type/value_factory.h"
 
 namespace bustub {
 // NOLINTNEXTLINE
@@ -39,7 +42,7 @@ TEST(TupleTest, DISABLED_TableHeapTest) {
   // create transaction
   auto *transaction = new Transaction(0);
   auto *disk_manager = new DiskManager("test.db");
-  auto *buffer_pool_manager = new BufferPoolManager(50, disk_manager);
+  auto *buffer_pool_manager = new BufferPoolManagerInstance(50, disk_manager);
   auto *lock_manager = new LockManager();
   auto *log_manager = new LogManager(disk_manager);
   auto *table = new TableHeap(buffer_pool_manager, lock_manager, log_manager, transaction);
@@ -71,4 +74,171 @@ TEST(TupleTest, DISABLED_TableHeapTest) {
   delete disk_manager;
 }
 
+
+// NOLINTNEXTLINE
+TEST(TupleTest, MoveAndViewTest) {
+  Schema schema({Column("a", TypeId::INTEGER), Column("b", TypeId::VARCHAR, 32)});
+  Tuple tuple({Value(TypeId::INTEGER, 1), Value(TypeId::VARCHAR, "a long enough string")}, &schema);
+  Tuple shorter({Value(TypeId::INTEGER, 2), Value(TypeId::VARCHAR, "short")}, &schema);
+
+  // a move takes the buffer along and leaves an empty tuple behind
+  char *data = tuple.GetData();
+  Tuple moved(std::move(tuple));
+  EXPECT_EQ(data, moved.GetData());
+  EXPECT_TRUE(moved.IsAllocated());
+  EXPECT_EQ(nullptr, tuple.GetData());  // NOLINT
+  EXPECT_EQ(0, tuple.GetLength());      // NOLINT
+  tuple = std::move(moved);
+  EXPECT_EQ(data, tuple.GetData());
+  EXPECT_EQ(1, tuple.GetValue(&schema, 0).GetAs<int32_t>());
+
+  // copying a tuple that fits reuses the buffer
+  tuple = shorter;
+  EXPECT_EQ(data, tuple.GetData());
+  EXPECT_NE(shorter.GetData(), tuple.GetData());
+  EXPECT_EQ(shorter.GetLength(), tuple.GetLength());
+  EXPECT_EQ("short", tuple.GetValue(&schema, 1).ToString());
+
+  // a view shares the data, and so do its copies
+  Tuple view = shorter.AsView();
+  EXPECT_FALSE(view.IsAllocated());
+  EXPECT_EQ(shorter.GetData(), view.GetData());
+  Tuple copy = view;
+  EXPECT_EQ(shorter.GetData(), copy.GetData());
+  EXPECT_EQ(2, copy.GetValue(&schema, 0).GetAs<int32_t>());
+  // while a copy of an owning tuple into a view owns its data
+  view = moved = tuple;
+  EXPECT_TRUE(view.IsAllocated());
+  EXPECT_NE(tuple.GetData(), view.GetData());
+  EXPECT_EQ("short", view.GetValue(&schema, 1).ToString());
+}
+
+// NOLINTNEXTLINE
+TEST(TupleTest, NullBitmapTest) {
+  // more columns than fit into a byte of the bitmap
+  std::vector<Column> columns;
+  for (int i = 0; i < 10; i++) {
+    columns.push_back(i % 2 == 0 ? Column("c" + std::to_string(i), TypeId::INTEGER)
+                                 : Column("c" + std::to_string(i), TypeId::VARCHAR, 16));
+  }
+  Schema schema(columns);
+  std::vector<Value> values;
+  for (int i = 0; i < 10; i++) {
+    TypeId type = schema.GetColumn(i).GetType();
+    if (i % 3 == 0) {
+      values.push_back(ValueFactory::GetNullValueByType(type));
+    } else {
+      values.push_back(type == TypeId::INTEGER ? Value(type, i) : Value(type, std::to_string(i)));
+    }
+  }
+  Tuple tuple(values, &schema);
+  EXPECT_EQ(2, Tuple::NullBitmapSize(&schema));
+
+  // the bitmap and the values agree, and a null VARCHAR takes up its length only
+  uint32_t length = schema.GetLength() + Tuple::NullBitmapSize(&schema);
+  for (uint32_t i = 0; i < 10; i++) {
+    EXPECT_EQ(i % 3 == 0, tuple.IsNull(&schema, i)) << i;
+    EXPECT_EQ(i % 3 == 0, tuple.GetValue(&schema, i).IsNull()) << i;
+    if (i % 2 == 1) {
+      length += sizeof(uint32_t) + (i % 3 == 0 ? 0 : values[i].GetLength());
+    }
+  }
+  EXPECT_EQ(length, tuple.GetLength());
+  EXPECT_EQ(std::to_string(5), tuple.GetValue(&schema, 5).ToString());
+
+  // and survive the copy of a tuple
+  Tuple copy;
+  copy = tuple;
+  for (uint32_t i = 0; i < 10; i++) {
+    EXPECT_EQ(i % 3 == 0, copy.IsNull(&schema, i)) << i;
+  }
+}
+
+// NOLINTNEXTLINE
+TEST(TupleTest, TypedAccessorTest) {
+  Schema schema({Column("a", TypeId::BOOLEAN), Column("b", TypeId::SMALLINT), Column("c", TypeId::VARCHAR, 16),
+                 Column("d", TypeId::INTEGER), Column("e", TypeId::BIGINT), Column("f", TypeId::DECIMAL),
+                 Column("g", TypeId::VARCHAR, 16)});
+  // the offset table agrees with the columns
+  for (uint32_t i = 0; i < schema.GetColumnCount(); i++) {
+    EXPECT_EQ(schema.GetColumn(i).GetOffset(), schema.GetOffset(i));
+    EXPECT_EQ(schema.GetColumn(i).GetType(), schema.GetType(i));
+  }
+
+  Tuple tuple({Value(TypeId::BOOLEAN, static_cast<int8_t>(1)), Value(TypeId::SMALLINT, static_cast<int16_t>(-7)),
+               Value(TypeId::VARCHAR, "hello"), ValueFactory::GetIntegerValue(42),
+               ValueFactory::GetBigIntValue(int64_t{1} << 40), ValueFactory::GetDecimalValue(2.5),
+               ValueFactory::GetNullValueByType(TypeId::VARCHAR)},
+              &schema);
+  EXPECT_EQ(1, tuple.GetAs<int8_t>(&schema, 0));
+  EXPECT_EQ(-7, tuple.GetAs<int16_t>(&schema, 1));
+  EXPECT_EQ("hello", tuple.GetStringView(&schema, 2));
+  EXPECT_EQ(42, tuple.GetAs<int32_t>(&schema, 3));
+  EXPECT_EQ(int64_t{1} << 40, tuple.GetAs<int64_t>(&schema, 4));
+  EXPECT_EQ(2.5, tuple.GetAs<double>(&schema, 5));
+  EXPECT_TRUE(tuple.GetStringView(&schema, 6).empty());
+  EXPECT_TRUE(tuple.IsNull(&schema, 6));
+
+  // GetValue reads the same values
+  EXPECT_EQ(42, tuple.GetValue(&schema, 3).GetAs<int32_t>());
+  EXPECT_EQ("hello", tuple.GetValue(&schema, 2).ToString());
+  EXPECT_TRUE(tuple.GetValue(&schema, 6).IsNull());
+
+  // a null reads as its type's sentinel
+  Tuple nulls({ValueFactory::GetNullValueByType(TypeId::BOOLEAN), ValueFactory::GetNullValueByType(TypeId::SMALLINT),
+               ValueFactory::GetNullValueByType(TypeId::VARCHAR), ValueFactory::GetNullValueByType(TypeId::INTEGER),
+               ValueFactory::GetNullValueByType(TypeId::BIGINT), ValueFactory::GetNullValueByType(TypeId::DECIMAL),
+               ValueFactory::GetNullValueByType(TypeId::VARCHAR)},
+              &schema);
+  EXPECT_EQ(BUSTUB_INT32_NULL, nulls.GetAs<int32_t>(&schema, 3));
+  EXPECT_EQ(BUSTUB_INT64_NULL, nulls.GetAs<int64_t>(&schema, 4));
+  EXPECT_TRUE(nulls.GetValue(&schema, 4).IsNull());
+}
+
+// NOLINTNEXTLINE
+TEST(TupleTest, TupleBuilderTest) {
+  Schema schema({Column("a", TypeId::BOOLEAN), Column("b", TypeId::SMALLINT), Column("c", TypeId::VARCHAR, 64),
+                 Column("d", TypeId::INTEGER), Column("e", TypeId::BIGINT), Column("f", TypeId::DECIMAL),
+                 Column("g", TypeId::VARCHAR, 16), Column("h", TypeId::TINYINT), Column("i", TypeId::VARCHAR, 8)});
+  std::vector<std::vector<Value>> rows;
+  // long and short VARCHARs, which Value keeps behind a pointer and inline respectively, and nulls of every type
+  rows.push_back({Value(TypeId::BOOLEAN, static_cast<int8_t>(1)), Value(TypeId::SMALLINT, static_cast<int16_t>(-7)),
+                  Value(TypeId::VARCHAR, std::string(40, 'x')), ValueFactory::GetIntegerValue(42),
+                  ValueFactory::GetBigIntValue(int64_t{1} << 40), ValueFactory::GetDecimalValue(2.5),
+                  Value(TypeId::VARCHAR, "hi"), Value(TypeId::TINYINT, static_cast<int8_t>(-3)),
+                  Value(TypeId::VARCHAR, "")});
+  std::vector<Value> nulls;
+  for (const Column &column : schema.GetColumns()) {
+    nulls.push_back(ValueFactory::GetNullValueByType(column.GetType()));
+  }
+  rows.push_back(nulls);
+
+  TupleBuilder builder(&schema);
+  MemoryArena arena;
+  for (const auto &values : rows) {
+    Tuple expected(values, &schema);
+    std::string expected_bytes(expected.GetData(), expected.GetLength());
+    EXPECT_EQ(expected.GetLength(), builder.SizeOf(values));
+
+    Tuple owned = builder.Build(values);
+    EXPECT_TRUE(owned.IsAllocated());
+    EXPECT_EQ(expected_bytes, std::string(owned.GetData(), owned.GetLength()));
+    Tuple view = builder.Build(values, &arena);
+    EXPECT_FALSE(view.IsAllocated());
+    EXPECT_EQ(expected_bytes, std::string(view.GetData(), view.GetLength()));
+
+    // straight into a buffer, e.g. of a page, which is left alone if the tuple does not fit
+    std::vector<char> buffer(expected.GetLength(), '#');
+    EXPECT_EQ(0, builder.Build(values, buffer.data(), expected.GetLength() - 1));
+    EXPECT_EQ(std::string(buffer.size(), '#'), std::string(buffer.data(), buffer.size()));
+    EXPECT_EQ(expected.GetLength(), builder.Build(values, buffer.data(), expected.GetLength()));
+    EXPECT_EQ(expected_bytes, std::string(buffer.data(), buffer.size()));
+  }
+  Tuple tuple = builder.Build(rows[0]);
+  EXPECT_EQ(std::string(40, 'x'), tuple.GetValue(&schema, 2).ToString());
+  EXPECT_EQ("hi", tuple.GetStringView(&schema, 6));
+  EXPECT_EQ(-3, tuple.GetAs<int8_t>(&schema, 7));
+  EXPECT_FALSE(tuple.IsNull(&schema, 8));
+}
+
 }  // namespace bustub
@@ -10,13 +10,16 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <memory>
 #include <string>
 #include <utility>
 #include <vector>
 
 #include "common/exception.h"
 #include "gtest/gtest.h"
+#include "type/fixed_decimal.h"
 #include "type/value.h"
+#include "type/value_kernels.h"
 
 namespace bustub {
 //===--------------------------------------------------------------------===//
@@ -95,4 +98,169 @@ TEST(TypeTests, TemplateTest) {
   BPlusTreePage<Value, Value> node;
   node.GetInfo(val1, val2);
 }
+
+// NOLINTNEXTLINE
+TEST(TypeTests, ValueKernelsTest) {
+  // the kernels agree with the Value methods, NULLs included
+  const std::vector<std::vector<Value>> operands = {
+      {Value(TypeId::INTEGER, -7), Value(TypeId::INTEGER, 0), Value(TypeId::INTEGER, 42), Value(TypeId::INTEGER, 42),
+       ValueFactory::GetNullValueByType(TypeId::INTEGER)},
+      {Value(TypeId::BIGINT, -(int64_t{1} << 30)), Value(TypeId::BIGINT, int64_t{3}),
+       Value(TypeId::BIGINT, int64_t{1} << 30), ValueFactory::GetNullValueByType(TypeId::BIGINT)},
+      {Value(TypeId::DECIMAL, -2.5), Value(TypeId::DECIMAL, 0.0), Value(TypeId::DECIMAL, 10.25),
+       ValueFactory::GetNullValueByType(TypeId::DECIMAL)},
+  };
+  for (const auto &values : operands) {
+    TypeId type = values[0].GetTypeId();
+    for (const Value &x : values) {
+      for (const Value &y : values) {
+        EXPECT_EQ(x.CompareEquals(y), BindCompare<std::equal_to<>>(type, type)(x, y));
+        EXPECT_EQ(x.CompareNotEquals(y), BindCompare<std::not_equal_to<>>(type, type)(x, y));
+        EXPECT_EQ(x.CompareLessThan(y), BindCompare<std::less<>>(type, type)(x, y));
+        EXPECT_EQ(x.CompareLessThanEquals(y), BindCompare<std::less_equal<>>(type, type)(x, y));
+        EXPECT_EQ(x.CompareGreaterThan(y), BindCompare<std::greater<>>(type, type)(x, y));
+        EXPECT_EQ(x.CompareGreaterThanEquals(y), BindCompare<std::greater_equal<>>(type, type)(x, y));
+        std::vector<std::pair<Value, Value>> results = {{x.Add(y), BindAdd(type, type)(x, y)},
+                                                        {x.Subtract(y), BindSubtract(type, type)(x, y)},
+                                                        {x.Multiply(y), BindMultiply(type, type)(x, y)},
+                                                        {x.Min(y), BindMin(type, type)(x, y)},
+                                                        {x.Max(y), BindMax(type, type)(x, y)}};
+        for (const auto &[expected, result] : results) {
+          EXPECT_EQ(expected.GetTypeId(), result.GetTypeId());
+          EXPECT_EQ(expected.IsNull(), result.IsNull());
+          if (!expected.IsNull()) {
+            EXPECT_EQ(CmpBool::CmpTrue, expected.CompareEquals(result)) << expected.ToString() << result.ToString();
+          }
+        }
+      }
+    }
+  }
+
+  // integers that overflow are out of range, as they are for the Value methods
+  Value max(TypeId::INTEGER, BUSTUB_INT32_MAX);
+  EXPECT_THROW(max.Add(Value(TypeId::INTEGER, 1)), Exception);
+  EXPECT_THROW(BindAdd(TypeId::INTEGER, TypeId::INTEGER)(max, Value(TypeId::INTEGER, 1)), Exception);
+  EXPECT_THROW(BindMultiply(TypeId::INTEGER, TypeId::INTEGER)(max, Value(TypeId::INTEGER, 2)), Exception);
+  Value min(TypeId::BIGINT, BUSTUB_INT64_MIN);
+  EXPECT_THROW(min.Subtract(Value(TypeId::BIGINT, int64_t{2})), Exception);
+  EXPECT_THROW(BindSubtract(TypeId::BIGINT, TypeId::BIGINT)(min, Value(TypeId::BIGINT, int64_t{2})), Exception);
+
+  // mixed types and the types without kernels are left to the Value methods
+  EXPECT_EQ(nullptr, BindCompare<std::less<>>(TypeId::INTEGER, TypeId::BIGINT));
+  EXPECT_EQ(nullptr, BindAdd(TypeId::VARCHAR, TypeId::VARCHAR));
+  EXPECT_EQ(nullptr, BindMin(TypeId::SMALLINT, TypeId::SMALLINT));
+}
+
+// NOLINTNEXTLINE
+TEST(TypeTests, VarcharInlineTest) {
+  // strings on either side of the inline length, many of them sharing a prefix longer than the kept one
+  std::vector<std::string> strings;
+  for (size_t length = 0; length < 2 * Value::INLINE_LENGTH; length++) {
+    strings.push_back(std::string(length, 'a'));
+    strings.push_back(std::string(length, 'a') + "b");
+    strings.push_back("b" + std::string(length, 'a'));
+  }
+  std::vector<Value> values;
+  for (const std::string &str : strings) {
+    values.emplace_back(TypeId::VARCHAR, str);
+  }
+
+  for (size_t i = 0; i < strings.size(); i++) {
+    // a copy, and a copy of that, outlive the value they are copied from
+    auto copy = std::make_unique<Value>(values[i]);
+    Value copy_of_copy = *copy;
+    copy.reset();
+    EXPECT_EQ(strings[i], copy_of_copy.ToString());
+    EXPECT_EQ(strings[i].size() + 1, copy_of_copy.GetLength());
+
+    // serialized and deserialized, the value is the same
+    std::vector<char> storage(sizeof(uint32_t) + copy_of_copy.GetLength());
+    copy_of_copy.SerializeTo(storage.data());
+    EXPECT_EQ(strings[i], Value::DeserializeFrom(storage.data(), TypeId::VARCHAR).ToString());
+
+    // comparisons come out as they do for std::string, whether the prefixes decide them or not
+    for (size_t j = 0; j < strings.size(); j++) {
+      EXPECT_EQ(GetCmpBool(strings[i] == strings[j]), values[i].CompareEquals(values[j]));
+      EXPECT_EQ(GetCmpBool(strings[i] != strings[j]), values[i].CompareNotEquals(values[j]));
+      EXPECT_EQ(GetCmpBool(strings[i] < strings[j]), values[i].CompareLessThan(values[j])) << strings[i] << strings[j];
+      EXPECT_EQ(GetCmpBool(strings[i] <= strings[j]), values[i].CompareLessThanEquals(values[j]));
+      EXPECT_EQ(GetCmpBool(strings[i] > strings[j]), values[i].CompareGreaterThan(values[j]));
+      EXPECT_EQ(GetCmpBool(strings[i] >= strings[j]), values[i].CompareGreaterThanEquals(values[j]));
+    }
+  }
+
+  // a value that does not own its data still points at it, however short
+  const char *data = "abc";
+  Value view(TypeId::VARCHAR, data, 4, false);
+  EXPECT_EQ(data, view.GetData());
+  Value view_copy = view;
+  EXPECT_EQ(data, view_copy.GetData());
+  EXPECT_EQ(CmpBool::CmpTrue, view.CompareEquals(Value(TypeId::VARCHAR, "abc")));
+
+  // a value swapped with another keeps its string
+  Value left(TypeId::VARCHAR, "short");
+  Value right(TypeId::VARCHAR, std::string(40, 'x'));
+  left = right;
+  right = Value(TypeId::VARCHAR, "tiny");
+  EXPECT_EQ(std::string(40, 'x'), left.ToString());
+  EXPECT_EQ("tiny", right.ToString());
+}
+
+// NOLINTNEXTLINE
+TEST(TypeTests, FixedDecimalTest) {
+  using Money = FixedDecimal<10, 2>;
+  Money price;
+  ASSERT_TRUE(Money::FromDouble(0.1, &price));
+  EXPECT_EQ(10, price.GetUnscaled());
+  EXPECT_EQ("0.10", price.ToString());
+
+  // a sum of cents is exact where the doubles drift
+  auto sum = Money().Widen();
+  double double_sum = 0;
+  for (int i = 0; i < 1000; i++) {
+    ASSERT_TRUE(sum.Add(price.Widen(), &sum));
+    double_sum += 0.1;
+  }
+  EXPECT_EQ("100.00", sum.ToString());
+  EXPECT_NE(100.0, double_sum);
+  decltype(sum) average;
+  ASSERT_TRUE(sum.Divide(1000, &average));
+  EXPECT_TRUE(average == price.Widen());
+
+  // averages round half away from zero
+  Money odd;
+  ASSERT_TRUE(Money::FromUnscaled(-5, &odd));
+  EXPECT_EQ("-0.05", odd.ToString());
+  ASSERT_TRUE(odd.Divide(2, &odd));
+  EXPECT_EQ(-3, odd.GetUnscaled());
+  EXPECT_FALSE(odd.Divide(0, &odd));
+
+  // the product keeps the digits of both factors
+  FixedDecimal<4, 3> rate;
+  ASSERT_TRUE((FixedDecimal<4, 3>::FromDouble(1.075, &rate)));
+  Money::ProductType<4, 3> total;
+  ASSERT_TRUE(price.Multiply(rate, &total));
+  EXPECT_EQ("0.10750", total.ToString());
+
+  // leaving the precision is an overflow, not a rounding
+  Money max;
+  ASSERT_TRUE(Money::FromUnscaled(Money::LIMIT - 1, &max));
+  EXPECT_EQ("99999999.99", max.ToString());
+  Money result;
+  EXPECT_FALSE(max.Add(price, &result));
+  EXPECT_FALSE(Money::FromUnscaled(Money::LIMIT, &result));
+  EXPECT_FALSE(Money::FromDouble(1e9, &result));
+  FixedDecimal<18, 0> big;
+  ASSERT_TRUE((FixedDecimal<18, 0>::FromUnscaled(FixedDecimal<18, 0>::LIMIT - 1, &big)));
+  FixedDecimal<18, 0> big_result;
+  EXPECT_FALSE(big.Add(big, &big_result));
+
+  // and Values convert both ways
+  ASSERT_TRUE(Money::FromValue(Value(TypeId::INTEGER, 42), &result));
+  EXPECT_EQ("42.00", result.ToString());
+  ASSERT_TRUE(Money::FromValue(Value(TypeId::DECIMAL, -1.005), &result));
+  EXPECT_EQ(CmpBool::CmpTrue, result.ToValue().CompareEquals(Value(TypeId::DECIMAL, result.ToDouble())));
+  EXPECT_FALSE(Money::FromValue(Value(TypeId::BIGINT, BUSTUB_INT64_MAX), &result));
+  EXPECT_FALSE(Money::FromValue(ValueFactory::GetNullValueByType(TypeId::INTEGER), &result));
+}
 }  // namespace bustub